@@ -192,8 +192,20 @@ struct _CallyActorPrivate
   GList  *action_list;
 
   GList *children;
+
+  /* the states changed since the last batch of notifications, and the
+   * value of the states that have been notified; see
+   * cally_actor_queue_state_change()
+   */
+  guint64 pending_states;
+  guint64 notified_states;
+  guint64 notified_values;
 };
 
+/* the accessibles with pending state change notifications */
+static GPtrArray *pending_state_changes = NULL;
+static guint state_changes_idle_id = 0;
+
 /**
  * cally_actor_new:
  * @actor: a #ClutterActor
@@ -335,6 +347,9 @@ cally_actor_finalize (GObject *obj)
       priv->children = NULL;
     }
 
+  /* the pending notifications hold a reference */
+  g_assert (priv->pending_states == 0);
+
   G_OBJECT_CLASS (cally_actor_parent_class)->finalize (obj);
 }
 
@@ -579,6 +594,7 @@ cally_actor_real_add_actor (ClutterActor *container,
   AtkObject        *atk_child  = clutter_actor_get_accessible (actor);
   CallyActor        *cally_actor = CALLY_ACTOR (atk_parent);
   CallyActorPrivate *priv       = cally_actor->priv;
+  ClutterActor     *iter;
   gint              index;
 
   g_return_val_if_fail (CLUTTER_IS_CONTAINER (container), 0);
@@ -586,11 +602,17 @@ cally_actor_real_add_actor (ClutterActor *container,
 
   g_object_notify (G_OBJECT (atk_child), "accessible_parent");
 
-  g_list_free (priv->children);
+  /* update the copy of the list of children in place, instead of
+   * copying the whole list for every child that is added
+   */
+  index = 0;
+  for (iter = clutter_actor_get_first_child (container);
+       iter != NULL && iter != actor;
+       iter = clutter_actor_get_next_sibling (iter))
+    index += 1;
 
-  priv->children = clutter_actor_get_children (CLUTTER_ACTOR (container));
+  priv->children = g_list_insert (priv->children, actor, index);
 
-  index = g_list_index (priv->children, actor);
   g_signal_emit_by_name (atk_parent, "children_changed::add",
                          index, atk_child, NULL);
 
@@ -606,6 +628,7 @@ cally_actor_real_remove_actor (ClutterActor *container,
   AtkObject*         atk_parent  = NULL;
   AtkObject         *atk_child   = NULL;
   CallyActorPrivate  *priv        = NULL;
+  GList              *l;
   gint               index;
 
   g_return_val_if_fail (CLUTTER_IS_CONTAINER (container), 0);
@@ -628,14 +651,20 @@ cally_actor_real_remove_actor (ClutterActor *container,
     }
 
   priv = CALLY_ACTOR (atk_parent)->priv;
-  index = g_list_index (priv->children, actor);
-  g_list_free (priv->children);
 
-  priv->children = clutter_actor_get_children (CLUTTER_ACTOR (container));
+  for (l = priv->children, index = 0; l != NULL; l = l->next, index++)
+    {
+      if (l->data == actor)
+        break;
+    }
+
+  if (l != NULL)
+    {
+      priv->children = g_list_delete_link (priv->children, l);
 
-  if (index >= 0 && index <= g_list_length (priv->children))
-    g_signal_emit_by_name (atk_parent, "children_changed::remove",
-                           index, atk_child, NULL);
+      g_signal_emit_by_name (atk_parent, "children_changed::remove",
+                             index, atk_child, NULL);
+    }
 
   return 1;
 }
@@ -998,42 +1027,135 @@ cally_actor_notify_clutter (GObject    *obj,
     klass->notify_clutter (obj, pspec);
 }
 
+static gboolean
+cally_actor_get_state_value (ClutterActor *actor,
+                             AtkState      state)
+{
+  switch (state)
+    {
+    case ATK_STATE_VISIBLE:
+      return CLUTTER_ACTOR_IS_VISIBLE (actor);
+
+    case ATK_STATE_SHOWING:
+      return CLUTTER_ACTOR_IS_MAPPED (actor);
+
+    case ATK_STATE_SENSITIVE:
+      return CLUTTER_ACTOR_IS_REACTIVE (actor);
+
+    default:
+      return FALSE;
+    }
+}
+
+/*
+ * Emits the state changes queued since the last batch: a state that
+ * changed more than once is notified only once, with its current value,
+ * and a state that went back to its previous value is not notified
+ */
+static gboolean
+cally_actor_flush_state_changes (gpointer data)
+{
+  GPtrArray *pending = pending_state_changes;
+  guint i;
+
+  pending_state_changes = NULL;
+  state_changes_idle_id = 0;
+
+  for (i = 0; i < pending->len; i++)
+    {
+      CallyActor *cally_actor = g_ptr_array_index (pending, i);
+      CallyActorPrivate *priv = cally_actor->priv;
+      ClutterActor *actor = CALLY_GET_CLUTTER_ACTOR (cally_actor);
+      guint64 states = priv->pending_states;
+      AtkState state;
+
+      priv->pending_states = 0;
+
+      if (actor == NULL) /* Object is defunct */
+        continue;
+
+      for (state = 0; states != 0; state++, states >>= 1)
+        {
+          guint64 bit = G_GUINT64_CONSTANT (1) << state;
+          gboolean value;
+
+          if ((states & 1) == 0)
+            continue;
+
+          value = cally_actor_get_state_value (actor, state);
+
+          if ((priv->notified_states & bit) != 0 &&
+              ((priv->notified_values & bit) != 0) == value)
+            continue;
+
+          priv->notified_states |= bit;
+          if (value)
+            priv->notified_values |= bit;
+          else
+            priv->notified_values &= ~bit;
+
+          atk_object_notify_state_change (ATK_OBJECT (cally_actor),
+                                          state,
+                                          value);
+        }
+    }
+
+  g_ptr_array_unref (pending);
+
+  return FALSE;
+}
+
+/*
+ * Queues the notification of a change of @state, which is emitted
+ * together with the other state changes in the same main loop
+ * iteration
+ */
+static void
+cally_actor_queue_state_change (CallyActor *cally_actor,
+                                AtkState    state)
+{
+  CallyActorPrivate *priv = cally_actor->priv;
+
+  g_assert (state < 64);
+
+  if (priv->pending_states == 0)
+    {
+      if (pending_state_changes == NULL)
+        pending_state_changes = g_ptr_array_new_with_free_func (g_object_unref);
+
+      g_ptr_array_add (pending_state_changes, g_object_ref (cally_actor));
+
+      if (state_changes_idle_id == 0)
+        state_changes_idle_id = g_idle_add (cally_actor_flush_state_changes, NULL);
+    }
+
+  priv->pending_states |= G_GUINT64_CONSTANT (1) << state;
+}
+
 /*
  * This function is a signal handler for notify signal which gets emitted
  * when a property changes value on the ClutterActor associated with a CallyActor
  *
- * It constructs an AtkPropertyValues structure and emits a "property_changed"
- * signal which causes the user specified AtkPropertyChangeHandler
- * to be called.
+ * It queues the notification of the change of the matching state; see
+ * cally_actor_queue_state_change().
  */
 static void
 cally_actor_real_notify_clutter (GObject    *obj,
                                 GParamSpec *pspec)
 {
-  ClutterActor* actor   = CLUTTER_ACTOR (obj);
   AtkObject*    atk_obj = clutter_actor_get_accessible (CLUTTER_ACTOR(obj));
   AtkState      state;
-  gboolean      value;
 
   if (g_strcmp0 (pspec->name, "visible") == 0)
-    {
-      state = ATK_STATE_VISIBLE;
-      value = CLUTTER_ACTOR_IS_VISIBLE (actor);
-    }
+    state = ATK_STATE_VISIBLE;
   else if (g_strcmp0 (pspec->name, "mapped") == 0)
-    {
-      state = ATK_STATE_SHOWING;
-      value = CLUTTER_ACTOR_IS_MAPPED (actor);
-    }
+    state = ATK_STATE_SHOWING;
   else if (g_strcmp0 (pspec->name, "reactive") == 0)
-    {
-      state = ATK_STATE_SENSITIVE;
-      value = CLUTTER_ACTOR_IS_REACTIVE (actor);
-    }
+    state = ATK_STATE_SENSITIVE;
   else
     return;
 
-  atk_object_notify_state_change (atk_obj, state, value);
+  cally_actor_queue_state_change (CALLY_ACTOR (atk_obj), state);
 }
 
 static void
@@ -543,6 +543,182 @@ _gtk_pango_is_inside_sentence (PangoLayout  *layout,
   return FALSE;
 }
 
+/*
+ * The character offsets of a layout and the byte indices of its lines,
+ * computed the first time they are needed and kept until the layout is
+ * released. ClutterText creates new layouts whenever its contents or
+ * its attributes change, see clutter_text_dirty_cache(), so the index
+ * never needs to be invalidated.
+ */
+typedef struct _CallyTextLayoutIndex
+{
+  /* the byte index of every LAYOUT_INDEX_STRIDE-th character */
+  gint *char_indices;
+  gint n_char_indices;
+
+  /* the byte indices of the start and of the end of each line */
+  gint *line_starts;
+  gint *line_ends;
+  gint n_lines;
+} CallyTextLayoutIndex;
+
+#define LAYOUT_INDEX_STRIDE     64
+
+static void
+cally_text_layout_index_free (gpointer data)
+{
+  CallyTextLayoutIndex *layout_index = data;
+
+  g_free (layout_index->char_indices);
+  g_free (layout_index->line_starts);
+  g_free (layout_index->line_ends);
+
+  g_slice_free (CallyTextLayoutIndex, layout_index);
+}
+
+static const CallyTextLayoutIndex *
+cally_text_get_layout_index (PangoLayout *layout)
+{
+  static GQuark quark_layout_index = 0;
+  CallyTextLayoutIndex *layout_index;
+  const gchar *text, *p;
+  GSList *lines, *l;
+  gint i;
+
+  if (G_UNLIKELY (quark_layout_index == 0))
+    quark_layout_index = g_quark_from_static_string ("cally-text-layout-index");
+
+  layout_index = g_object_get_qdata (G_OBJECT (layout), quark_layout_index);
+  if (layout_index != NULL)
+    return layout_index;
+
+  layout_index = g_slice_new (CallyTextLayoutIndex);
+
+  text = pango_layout_get_text (layout);
+
+  layout_index->n_char_indices =
+    g_utf8_strlen (text, -1) / LAYOUT_INDEX_STRIDE + 1;
+  layout_index->char_indices = g_new (gint, layout_index->n_char_indices);
+
+  for (i = 0, p = text; i < layout_index->n_char_indices; i++)
+    {
+      layout_index->char_indices[i] = p - text;
+
+      if (i + 1 < layout_index->n_char_indices)
+        p = g_utf8_offset_to_pointer (p, LAYOUT_INDEX_STRIDE);
+    }
+
+  lines = pango_layout_get_lines_readonly (layout);
+
+  layout_index->n_lines = g_slist_length (lines);
+  layout_index->line_starts = g_new (gint, layout_index->n_lines);
+  layout_index->line_ends = g_new (gint, layout_index->n_lines);
+
+  for (l = lines, i = 0; l != NULL; l = l->next, i++)
+    {
+      PangoLayoutLine *line = l->data;
+
+      layout_index->line_starts[i] = line->start_index;
+      layout_index->line_ends[i] = line->start_index + line->length;
+    }
+
+  g_object_set_qdata_full (G_OBJECT (layout), quark_layout_index,
+                           layout_index,
+                           cally_text_layout_index_free);
+
+  return layout_index;
+}
+
+/* converts a character offset of @layout to a byte index */
+static gint
+cally_text_layout_offset_to_index (PangoLayout *layout,
+                                   gint         offset)
+{
+  const CallyTextLayoutIndex *layout_index;
+  const gchar *text;
+  gint sample;
+
+  layout_index = cally_text_get_layout_index (layout);
+  text = pango_layout_get_text (layout);
+
+  sample = CLAMP (offset / LAYOUT_INDEX_STRIDE,
+                  0,
+                  layout_index->n_char_indices - 1);
+
+  return g_utf8_offset_to_pointer (text + layout_index->char_indices[sample],
+                                   offset - sample * LAYOUT_INDEX_STRIDE) - text;
+}
+
+/* converts a byte index of @layout to a character offset */
+static gint
+cally_text_layout_index_to_offset (PangoLayout *layout,
+                                   gint         index)
+{
+  const CallyTextLayoutIndex *layout_index;
+  const gchar *text;
+  gint lo, hi;
+
+  layout_index = cally_text_get_layout_index (layout);
+  text = pango_layout_get_text (layout);
+
+  /* find the last sampled character before @index */
+  lo = 0;
+  hi = layout_index->n_char_indices - 1;
+  while (lo < hi)
+    {
+      gint mid = (lo + hi + 1) / 2;
+
+      if (layout_index->char_indices[mid] <= index)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+
+  return lo * LAYOUT_INDEX_STRIDE +
+    g_utf8_pointer_to_offset (text + layout_index->char_indices[lo],
+                              text + index);
+}
+
+/* returns the first line of @layout_index containing the byte @index,
+ * or -1 if there is none
+ */
+static gint
+cally_text_layout_index_find_line (const CallyTextLayoutIndex *layout_index,
+                                   gint                        index)
+{
+  gint lo = 0, hi = layout_index->n_lines;
+
+  while (lo < hi)
+    {
+      gint mid = (lo + hi) / 2;
+
+      if (layout_index->line_ends[mid] < index)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  if (lo < layout_index->n_lines && layout_index->line_starts[lo] <= index)
+    return lo;
+
+  return -1;
+}
+
+/* returns the substring of @layout between two character offsets */
+static gchar *
+cally_text_layout_substring (PangoLayout *layout,
+                             gint         start_offset,
+                             gint         end_offset)
+{
+  const gchar *text = pango_layout_get_text (layout);
+  gint start_index, end_index;
+
+  start_index = cally_text_layout_offset_to_index (layout, start_offset);
+  end_index = cally_text_layout_offset_to_index (layout, end_offset);
+
+  return g_strndup (text + start_index, end_index - start_index);
+}
+
 static void
 pango_layout_get_line_before (PangoLayout     *layout,
                               AtkTextBoundary  boundary_type,
@@ -550,64 +726,41 @@ pango_layout_get_line_before (PangoLayout     *layout,
                               gint            *start_offset,
                               gint            *end_offset)
 {
-  PangoLayoutIter *iter;
-  PangoLayoutLine *line, *prev_line = NULL, *prev_prev_line = NULL;
+  const CallyTextLayoutIndex *layout_index;
   gint index, start_index, end_index;
-  const gchar *text;
-  gboolean found = FALSE;
+  gint line;
 
-  text = pango_layout_get_text (layout);
-  index = g_utf8_offset_to_pointer (text, offset) - text;
-  iter = pango_layout_get_iter (layout);
-  do
-    {
-      line = pango_layout_iter_get_line (iter);
-      start_index = line->start_index;
-      end_index = start_index + line->length;
+  layout_index = cally_text_get_layout_index (layout);
+  index = cally_text_layout_offset_to_index (layout, offset);
+  line = cally_text_layout_index_find_line (layout_index, index);
 
-      if (index >= start_index && index <= end_index)
+  if (line > 0)
+    {
+      switch (boundary_type)
         {
-          /* Found line for offset */
-          if (prev_line)
-            {
-              switch (boundary_type)
-                {
-                case ATK_TEXT_BOUNDARY_LINE_START:
-                  end_index = start_index;
-                  start_index = prev_line->start_index;
-                  break;
-                case ATK_TEXT_BOUNDARY_LINE_END:
-                  if (prev_prev_line)
-                    start_index = prev_prev_line->start_index + prev_prev_line->length;
-                  else
-                    start_index = 0;
-                  end_index = prev_line->start_index + prev_line->length;
-                  break;
-                default:
-                  g_assert_not_reached();
-                }
-            }
+        case ATK_TEXT_BOUNDARY_LINE_START:
+          start_index = layout_index->line_starts[line - 1];
+          end_index = layout_index->line_starts[line];
+          break;
+        case ATK_TEXT_BOUNDARY_LINE_END:
+          if (line > 1)
+            start_index = layout_index->line_ends[line - 2];
           else
-            start_index = end_index = 0;
-
-          found = TRUE;
+            start_index = 0;
+          end_index = layout_index->line_ends[line - 1];
           break;
+        default:
+          g_assert_not_reached();
         }
-
-      prev_prev_line = prev_line;
-      prev_line = line;
     }
-  while (pango_layout_iter_next_line (iter));
-
-  if (!found)
-    {
-      start_index = prev_line->start_index + prev_line->length;
-      end_index = start_index;
-    }
-  pango_layout_iter_free (iter);
+  else if (line == 0)
+    start_index = end_index = 0;
+  else
+    start_index = end_index =
+      layout_index->line_ends[layout_index->n_lines - 1];
 
-  *start_offset = g_utf8_pointer_to_offset (text, text + start_index);
-  *end_offset = g_utf8_pointer_to_offset (text, text + end_index);
+  *start_offset = cally_text_layout_index_to_offset (layout, start_index);
+  *end_offset = cally_text_layout_index_to_offset (layout, end_index);
 }
 
 static void
@@ -617,55 +770,39 @@ pango_layout_get_line_at (PangoLayout     *layout,
                           gint            *start_offset,
                           gint            *end_offset)
 {
-  PangoLayoutIter *iter;
-  PangoLayoutLine *line, *prev_line = NULL;
+  const CallyTextLayoutIndex *layout_index;
   gint index, start_index, end_index;
-  const gchar *text;
-  gboolean found = FALSE;
+  gint line;
 
-  text = pango_layout_get_text (layout);
-  index = g_utf8_offset_to_pointer (text, offset) - text;
-  iter = pango_layout_get_iter (layout);
-  do
+  layout_index = cally_text_get_layout_index (layout);
+  index = cally_text_layout_offset_to_index (layout, offset);
+  line = cally_text_layout_index_find_line (layout_index, index);
+
+  if (line >= 0)
     {
-      line = pango_layout_iter_get_line (iter);
-      start_index = line->start_index;
-      end_index = start_index + line->length;
+      start_index = layout_index->line_starts[line];
+      end_index = layout_index->line_ends[line];
 
-      if (index >= start_index && index <= end_index)
+      switch (boundary_type)
         {
-          /* Found line for offset */
-          switch (boundary_type)
-            {
-            case ATK_TEXT_BOUNDARY_LINE_START:
-              if (pango_layout_iter_next_line (iter))
-                end_index = pango_layout_iter_get_line (iter)->start_index;
-              break;
-            case ATK_TEXT_BOUNDARY_LINE_END:
-              if (prev_line)
-                start_index = prev_line->start_index + prev_line->length;
-              break;
-            default:
-              g_assert_not_reached();
-            }
-
-          found = TRUE;
+        case ATK_TEXT_BOUNDARY_LINE_START:
+          if (line + 1 < layout_index->n_lines)
+            end_index = layout_index->line_starts[line + 1];
+          break;
+        case ATK_TEXT_BOUNDARY_LINE_END:
+          if (line > 0)
+            start_index = layout_index->line_ends[line - 1];
           break;
+        default:
+          g_assert_not_reached();
         }
-
-      prev_line = line;
-    }
-  while (pango_layout_iter_next_line (iter));
-
-  if (!found)
-    {
-      start_index = prev_line->start_index + prev_line->length;
-      end_index = start_index;
     }
-  pango_layout_iter_free (iter);
+  else
+    start_index = end_index =
+      layout_index->line_ends[layout_index->n_lines - 1];
 
-  *start_offset = g_utf8_pointer_to_offset (text, text + start_index);
-  *end_offset = g_utf8_pointer_to_offset (text, text + end_index);
+  *start_offset = cally_text_layout_index_to_offset (layout, start_index);
+  *end_offset = cally_text_layout_index_to_offset (layout, end_index);
 }
 
 static void
@@ -675,64 +812,41 @@ pango_layout_get_line_after (PangoLayout     *layout,
                              gint            *start_offset,
                              gint            *end_offset)
 {
-  PangoLayoutIter *iter;
-  PangoLayoutLine *line, *prev_line = NULL;
+  const CallyTextLayoutIndex *layout_index;
   gint index, start_index, end_index;
-  const gchar *text;
-  gboolean found = FALSE;
+  gint line;
 
-  text = pango_layout_get_text (layout);
-  index = g_utf8_offset_to_pointer (text, offset) - text;
-  iter = pango_layout_get_iter (layout);
-  do
-    {
-      line = pango_layout_iter_get_line (iter);
-      start_index = line->start_index;
-      end_index = start_index + line->length;
+  layout_index = cally_text_get_layout_index (layout);
+  index = cally_text_layout_offset_to_index (layout, offset);
+  line = cally_text_layout_index_find_line (layout_index, index);
 
-      if (index >= start_index && index <= end_index)
+  if (line >= 0 && line + 1 < layout_index->n_lines)
+    {
+      switch (boundary_type)
         {
-          /* Found line for offset */
-          if (pango_layout_iter_next_line (iter))
-            {
-              line = pango_layout_iter_get_line (iter);
-              switch (boundary_type)
-                {
-                case ATK_TEXT_BOUNDARY_LINE_START:
-                  start_index = line->start_index;
-                  if (pango_layout_iter_next_line (iter))
-                    end_index = pango_layout_iter_get_line (iter)->start_index;
-                  else
-                    end_index = start_index + line->length;
-                  break;
-                case ATK_TEXT_BOUNDARY_LINE_END:
-                  start_index = end_index;
-                  end_index = line->start_index + line->length;
-                  break;
-                default:
-                  g_assert_not_reached();
-                }
-            }
+        case ATK_TEXT_BOUNDARY_LINE_START:
+          start_index = layout_index->line_starts[line + 1];
+          if (line + 2 < layout_index->n_lines)
+            end_index = layout_index->line_starts[line + 2];
           else
-            start_index = end_index;
-
-          found = TRUE;
+            end_index = layout_index->line_ends[line + 1];
           break;
+        case ATK_TEXT_BOUNDARY_LINE_END:
+          start_index = layout_index->line_ends[line];
+          end_index = layout_index->line_ends[line + 1];
+          break;
+        default:
+          g_assert_not_reached();
         }
-
-      prev_line = line;
-    }
-  while (pango_layout_iter_next_line (iter));
-
-  if (!found)
-    {
-      start_index = prev_line->start_index + prev_line->length;
-      end_index = start_index;
     }
-  pango_layout_iter_free (iter);
+  else if (line >= 0)
+    start_index = end_index = layout_index->line_ends[line];
+  else
+    start_index = end_index =
+      layout_index->line_ends[layout_index->n_lines - 1];
 
-  *start_offset = g_utf8_pointer_to_offset (text, text + start_index);
-  *end_offset = g_utf8_pointer_to_offset (text, text + end_index);
+  *start_offset = cally_text_layout_index_to_offset (layout, start_index);
+  *end_offset = cally_text_layout_index_to_offset (layout, end_index);
 }
 
 /*
@@ -831,7 +945,7 @@ _gtk_pango_get_text_at (PangoLayout     *layout,
 
   g_assert (start <= end);
 
-  return g_utf8_substring (text, start, end);
+  return cally_text_layout_substring (layout, start, end);
 }
 
 /*
@@ -932,7 +1046,7 @@ _gtk_pango_get_text_before (PangoLayout     *layout,
 
   g_assert (start <= end);
 
-  return g_utf8_substring (text, start, end);
+  return cally_text_layout_substring (layout, start, end);
 }
 
 /*
@@ -1039,7 +1153,7 @@ _gtk_pango_get_text_after (PangoLayout     *layout,
 
   g_assert (start <= end);
 
-  return g_utf8_substring (text, start, end);
+  return cally_text_layout_substring (layout, start, end);
 }
 
 /***** atktext.h ******/
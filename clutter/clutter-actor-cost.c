@@ -0,0 +1,375 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Per-actor paint and layout costs.
+ *
+ * With CLUTTER_PAINT=actor-cost, the time spent painting, allocating
+ * and measuring each actor is accumulated for each path from the root
+ * of the scene graph to the actor; the actors are identified by their
+ * type and name. Each entry holds the number of calls, the total time
+ * and the time spent in the actor itself, excluding its children.
+ *
+ * The report is printed when the main loop started by clutter_main()
+ * returns, or when the process receives SIGUSR1; it contains a table
+ * of the actors sorted by their own cost, and it writes the collapsed
+ * stacks used by the flame graph tools in the temporary directory.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#ifdef G_OS_UNIX
+#include <signal.h>
+#include <unistd.h>
+#include <glib-unix.h>
+#endif
+
+#include "clutter-actor-cost.h"
+
+#include "clutter-actor.h"
+#include "clutter-debug.h"
+#include "clutter-private.h"
+
+typedef struct _CostEntry
+{
+  /* the collapsed stack of the entry, from the root */
+  gchar *path;
+
+  /* the interned label of the actor */
+  const gchar *label;
+
+  ClutterActorCostPhase phase;
+
+  gint64 total_time;
+  gint64 self_time;
+  guint n_calls;
+} CostEntry;
+
+typedef struct _CostFrame
+{
+  CostEntry *entry;
+
+  gint64 start;
+  gint64 children_time;
+} CostFrame;
+
+typedef struct _CostRow
+{
+  const gchar *label;
+
+  ClutterActorCostPhase phase;
+
+  gint64 total_time;
+  gint64 self_time;
+  guint n_calls;
+} CostRow;
+
+static const gchar *phase_roots[CLUTTER_ACTOR_COST_N_PHASES] = {
+  "paint",
+  "layout",
+  "layout",
+};
+
+static const gchar *phase_names[CLUTTER_ACTOR_COST_N_PHASES] = {
+  "paint",
+  "allocate",
+  "size request",
+};
+
+/* path -> CostEntry */
+static GHashTable *cost_entries = NULL;
+
+/* the stack of the actors being measured */
+static GArray *cost_stack = NULL;
+
+static void
+cost_entry_free (gpointer data)
+{
+  CostEntry *entry = data;
+
+  g_free (entry->path);
+  g_slice_free (CostEntry, entry);
+}
+
+#ifdef G_OS_UNIX
+static gboolean
+clutter_actor_cost_dump_cb (gpointer data G_GNUC_UNUSED)
+{
+  _clutter_actor_cost_dump ();
+
+  return G_SOURCE_CONTINUE;
+}
+#endif /* G_OS_UNIX */
+
+/*< private >
+ * _clutter_actor_cost_init:
+ *
+ * Sets up the per-actor profiler.
+ */
+void
+_clutter_actor_cost_init (void)
+{
+  if (cost_entries != NULL)
+    return;
+
+  cost_entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                        NULL,
+                                        cost_entry_free);
+  cost_stack = g_array_new (FALSE, FALSE, sizeof (CostFrame));
+
+#ifdef G_OS_UNIX
+  g_unix_signal_add (SIGUSR1, clutter_actor_cost_dump_cb, NULL);
+#endif
+}
+
+static const gchar *
+clutter_actor_cost_get_label (ClutterActor          *actor,
+                              ClutterActorCostPhase  phase)
+{
+  const gchar *name = clutter_actor_get_name (actor);
+  const gchar *suffix;
+  const gchar *retval;
+  gchar *label;
+
+  /* size requests and allocations share the same stacks */
+  suffix = phase == CLUTTER_ACTOR_COST_SIZE_REQUEST ? " (size request)" : "";
+
+  if (name != NULL)
+    label = g_strdup_printf ("%s '%s'%s", G_OBJECT_TYPE_NAME (actor), name, suffix);
+  else
+    label = g_strconcat (G_OBJECT_TYPE_NAME (actor), suffix, NULL);
+
+  /* the semicolon separates the frames of a collapsed stack */
+  g_strdelimit (label, ";", ':');
+
+  retval = g_intern_string (label);
+  g_free (label);
+
+  return retval;
+}
+
+/*< private >
+ * _clutter_actor_cost_begin:
+ * @actor: a #ClutterActor
+ * @phase: the phase being measured
+ *
+ * Starts measuring @actor; every call must be paired with a call
+ * to _clutter_actor_cost_end().
+ */
+void
+_clutter_actor_cost_begin (ClutterActor          *actor,
+                           ClutterActorCostPhase  phase)
+{
+  const gchar *label, *parent_path;
+  CostEntry *entry;
+  CostFrame frame;
+  gchar *path;
+
+  if (G_UNLIKELY (cost_entries == NULL))
+    _clutter_actor_cost_init ();
+
+  label = clutter_actor_cost_get_label (actor, phase);
+
+  if (cost_stack->len > 0)
+    parent_path = g_array_index (cost_stack, CostFrame, cost_stack->len - 1).entry->path;
+  else
+    parent_path = phase_roots[phase];
+
+  path = g_strconcat (parent_path, ";", label, NULL);
+
+  entry = g_hash_table_lookup (cost_entries, path);
+  if (entry == NULL)
+    {
+      entry = g_slice_new0 (CostEntry);
+      entry->path = path;
+      entry->label = label;
+      entry->phase = phase;
+
+      g_hash_table_insert (cost_entries, entry->path, entry);
+    }
+  else
+    g_free (path);
+
+  frame.entry = entry;
+  frame.children_time = 0;
+
+  /* keep the bookkeeping out of the measured time */
+  frame.start = g_get_monotonic_time ();
+
+  g_array_append_val (cost_stack, frame);
+}
+
+/*< private >
+ * _clutter_actor_cost_end:
+ *
+ * Stops measuring the actor passed to the last call of
+ * _clutter_actor_cost_begin().
+ */
+void
+_clutter_actor_cost_end (void)
+{
+  gint64 now = g_get_monotonic_time ();
+  CostFrame *frame;
+  gint64 elapsed;
+
+  if (cost_stack == NULL || cost_stack->len == 0)
+    return;
+
+  frame = &g_array_index (cost_stack, CostFrame, cost_stack->len - 1);
+
+  elapsed = now - frame->start;
+
+  frame->entry->total_time += elapsed;
+  frame->entry->self_time += elapsed - frame->children_time;
+  frame->entry->n_calls += 1;
+
+  g_array_set_size (cost_stack, cost_stack->len - 1);
+
+  if (cost_stack->len > 0)
+    g_array_index (cost_stack, CostFrame, cost_stack->len - 1).children_time += elapsed;
+}
+
+static gint
+sort_by_self_time (gconstpointer a,
+                   gconstpointer b)
+{
+  const CostRow *row_a = a;
+  const CostRow *row_b = b;
+
+  if (row_a->self_time > row_b->self_time)
+    return -1;
+
+  if (row_a->self_time < row_b->self_time)
+    return 1;
+
+  return 0;
+}
+
+/*< private >
+ * _clutter_actor_cost_dump:
+ *
+ * Prints the costs accumulated so far, and writes them as collapsed
+ * stacks for the flame graph tools.
+ */
+void
+_clutter_actor_cost_dump (void)
+{
+  GHashTable *rows_by_label;
+  GHashTableIter iter;
+  gpointer value;
+  GString *folded;
+  GArray *rows;
+  GError *error;
+  gchar *filename, *basename;
+  guint i;
+
+  if (cost_entries == NULL || g_hash_table_size (cost_entries) == 0)
+    return;
+
+  /* the table merges all the stacks leading to the same kind of actor */
+  rows_by_label = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                         NULL,
+                                         g_free);
+  folded = g_string_new (NULL);
+
+  g_hash_table_iter_init (&iter, cost_entries);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      const CostEntry *entry = value;
+      CostRow *phase_rows;
+      CostRow *row;
+
+      phase_rows = g_hash_table_lookup (rows_by_label, entry->label);
+      if (phase_rows == NULL)
+        {
+          phase_rows = g_new0 (CostRow, CLUTTER_ACTOR_COST_N_PHASES);
+          g_hash_table_insert (rows_by_label, (gpointer) entry->label, phase_rows);
+        }
+
+      row = &phase_rows[entry->phase];
+      row->label = entry->label;
+      row->phase = entry->phase;
+      row->total_time += entry->total_time;
+      row->self_time += entry->self_time;
+      row->n_calls += entry->n_calls;
+
+      g_string_append_printf (folded, "%s %" G_GINT64_FORMAT "\n",
+                              entry->path,
+                              entry->self_time);
+    }
+
+  rows = g_array_new (FALSE, FALSE, sizeof (CostRow));
+
+  g_hash_table_iter_init (&iter, rows_by_label);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      const CostRow *phase_rows = value;
+
+      for (i = 0; i < CLUTTER_ACTOR_COST_N_PHASES; i++)
+        {
+          if (phase_rows[i].n_calls > 0)
+            g_array_append_val (rows, phase_rows[i]);
+        }
+    }
+
+  g_array_sort (rows, sort_by_self_time);
+
+  g_print ("Actor costs, in microseconds:\n");
+  g_print ("%12s %12s %10s  %-12s  %s\n",
+           "self", "total", "calls", "phase", "actor");
+
+  for (i = 0; i < rows->len; i++)
+    {
+      const CostRow *row = &g_array_index (rows, CostRow, i);
+
+      g_print ("%12" G_GINT64_FORMAT " %12" G_GINT64_FORMAT " %10u  %-12s  %s\n",
+               row->self_time,
+               row->total_time,
+               row->n_calls,
+               phase_names[row->phase],
+               row->label);
+    }
+
+#ifdef G_OS_UNIX
+  basename = g_strdup_printf ("clutter-actor-cost-%lu.folded",
+                              (gulong) getpid ());
+#else
+  basename = g_strdup ("clutter-actor-cost.folded");
+#endif
+  filename = g_build_filename (g_get_tmp_dir (), basename, NULL);
+
+  error = NULL;
+  if (g_file_set_contents (filename, folded->str, folded->len, &error))
+    g_print ("Collapsed stacks written to '%s'\n", filename);
+  else
+    {
+      g_warning ("Unable to write the collapsed stacks: %s", error->message);
+      g_error_free (error);
+    }
+
+  g_free (filename);
+  g_free (basename);
+  g_array_unref (rows);
+  g_string_free (folded, TRUE);
+  g_hash_table_unref (rows_by_label);
+}
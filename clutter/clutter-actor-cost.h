@@ -0,0 +1,49 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_ACTOR_COST_H__
+#define __CLUTTER_ACTOR_COST_H__
+
+#include <clutter/clutter-types.h>
+
+G_BEGIN_DECLS
+
+typedef enum {
+  CLUTTER_ACTOR_COST_PAINT,
+  CLUTTER_ACTOR_COST_ALLOCATE,
+  CLUTTER_ACTOR_COST_SIZE_REQUEST,
+
+  CLUTTER_ACTOR_COST_N_PHASES
+} ClutterActorCostPhase;
+
+/* the profiler is enabled by CLUTTER_PAINT=actor-cost */
+#define CLUTTER_ACTOR_COST_ENABLED()    \
+  G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_ACTOR_COST)
+
+void    _clutter_actor_cost_init        (void);
+void    _clutter_actor_cost_begin       (ClutterActor          *actor,
+                                         ClutterActorCostPhase  phase);
+void    _clutter_actor_cost_end         (void);
+void    _clutter_actor_cost_dump        (void);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_ACTOR_COST_H__ */
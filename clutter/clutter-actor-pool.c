@@ -0,0 +1,389 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:clutter-actor-pool
+ * @Title: ClutterActorPool
+ * @Short_Description: A pool of reusable actors
+ *
+ * #ClutterActorPool keeps a number of detached actors of the same type
+ * around, so that they can be reused instead of being destroyed and
+ * created again; this is useful for containers that continuously add
+ * and remove similar children, like lists displaying only their visible
+ * rows.
+ *
+ * An actor returned to the pool using clutter_actor_pool_release() is
+ * removed from its parent, has all its transitions and easing states
+ * removed, and has its position, size request and transformations
+ * reset to their defaults; any other state, like its content, its
+ * children or its actions, is preserved, and it is up to the caller of
+ * clutter_actor_pool_acquire() to update it.
+ *
+ * Pooled actors are never finalized, so they also keep their slot in
+ * the pool of actor identifiers used for picking.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "clutter-actor-pool.h"
+
+#include "clutter-actor-private.h"
+#include "clutter-debug.h"
+#include "clutter-private.h"
+
+struct _ClutterActorPoolPrivate
+{
+  GType actor_type;
+
+  GPtrArray *actors;
+
+  guint max_size;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_ACTOR_TYPE,
+  PROP_MAX_SIZE,
+
+  PROP_LAST
+};
+
+static GParamSpec *obj_props[PROP_LAST] = { NULL, };
+
+G_DEFINE_TYPE (ClutterActorPool, clutter_actor_pool, G_TYPE_OBJECT)
+
+static void
+clutter_actor_pool_trim (ClutterActorPool *pool,
+                         guint             max_size)
+{
+  ClutterActorPoolPrivate *priv = pool->priv;
+
+  while (priv->actors->len > max_size)
+    {
+      ClutterActor *actor;
+
+      actor = g_ptr_array_remove_index (priv->actors, priv->actors->len - 1);
+
+      clutter_actor_destroy (actor);
+      g_object_unref (actor);
+    }
+}
+
+static void
+clutter_actor_pool_dispose (GObject *gobject)
+{
+  ClutterActorPool *pool = CLUTTER_ACTOR_POOL (gobject);
+
+  clutter_actor_pool_trim (pool, 0);
+
+  G_OBJECT_CLASS (clutter_actor_pool_parent_class)->dispose (gobject);
+}
+
+static void
+clutter_actor_pool_finalize (GObject *gobject)
+{
+  ClutterActorPoolPrivate *priv = CLUTTER_ACTOR_POOL (gobject)->priv;
+
+  g_ptr_array_unref (priv->actors);
+
+  G_OBJECT_CLASS (clutter_actor_pool_parent_class)->finalize (gobject);
+}
+
+static void
+clutter_actor_pool_set_property (GObject      *gobject,
+                                 guint         prop_id,
+                                 const GValue *value,
+                                 GParamSpec   *pspec)
+{
+  ClutterActorPool *pool = CLUTTER_ACTOR_POOL (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_ACTOR_TYPE:
+      pool->priv->actor_type = g_value_get_gtype (value);
+      break;
+
+    case PROP_MAX_SIZE:
+      clutter_actor_pool_set_max_size (pool, g_value_get_uint (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+    }
+}
+
+static void
+clutter_actor_pool_get_property (GObject    *gobject,
+                                 guint       prop_id,
+                                 GValue     *value,
+                                 GParamSpec *pspec)
+{
+  ClutterActorPoolPrivate *priv = CLUTTER_ACTOR_POOL (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_ACTOR_TYPE:
+      g_value_set_gtype (value, priv->actor_type);
+      break;
+
+    case PROP_MAX_SIZE:
+      g_value_set_uint (value, priv->max_size);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+    }
+}
+
+static void
+clutter_actor_pool_class_init (ClutterActorPoolClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (ClutterActorPoolPrivate));
+
+  gobject_class->dispose = clutter_actor_pool_dispose;
+  gobject_class->finalize = clutter_actor_pool_finalize;
+  gobject_class->set_property = clutter_actor_pool_set_property;
+  gobject_class->get_property = clutter_actor_pool_get_property;
+
+  /**
+   * ClutterActorPool:actor-type:
+   *
+   * The type of the actors created by the pool.
+   */
+  obj_props[PROP_ACTOR_TYPE] =
+    g_param_spec_gtype ("actor-type",
+                        P_("Actor Type"),
+                        P_("The type of the actors in the pool"),
+                        CLUTTER_TYPE_ACTOR,
+                        G_PARAM_READWRITE |
+                        G_PARAM_CONSTRUCT_ONLY |
+                        G_PARAM_STATIC_STRINGS);
+
+  /**
+   * ClutterActorPool:max-size:
+   *
+   * The maximum number of actors kept by the pool.
+   */
+  obj_props[PROP_MAX_SIZE] =
+    g_param_spec_uint ("max-size",
+                       P_("Maximum Size"),
+                       P_("The maximum number of actors in the pool"),
+                       0, G_MAXUINT,
+                       64,
+                       G_PARAM_READWRITE |
+                       G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
+}
+
+static void
+clutter_actor_pool_init (ClutterActorPool *self)
+{
+  self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, CLUTTER_TYPE_ACTOR_POOL,
+                                            ClutterActorPoolPrivate);
+
+  self->priv->actor_type = CLUTTER_TYPE_ACTOR;
+  self->priv->actors = g_ptr_array_new ();
+  self->priv->max_size = 64;
+}
+
+/**
+ * clutter_actor_pool_new:
+ * @actor_type: the #GType of the actors in the pool; it must be a
+ *   #ClutterActor sub-type
+ * @max_size: the maximum number of actors kept by the pool
+ *
+ * Creates a new #ClutterActorPool.
+ *
+ * Return value: (transfer full): the newly created #ClutterActorPool.
+ *   Use g_object_unref() when done.
+ */
+ClutterActorPool *
+clutter_actor_pool_new (GType actor_type,
+                        guint max_size)
+{
+  g_return_val_if_fail (g_type_is_a (actor_type, CLUTTER_TYPE_ACTOR), NULL);
+  g_return_val_if_fail (!G_TYPE_IS_ABSTRACT (actor_type), NULL);
+
+  return g_object_new (CLUTTER_TYPE_ACTOR_POOL,
+                       "actor-type", actor_type,
+                       "max-size", max_size,
+                       NULL);
+}
+
+/**
+ * clutter_actor_pool_acquire:
+ * @pool: a #ClutterActorPool
+ *
+ * Retrieves an actor from @pool, or creates a new one if @pool is empty.
+ *
+ * Like a newly created actor, the returned actor has a floating
+ * reference, which is taken when adding it to a parent.
+ *
+ * Return value: (transfer full): a #ClutterActor
+ */
+ClutterActor *
+clutter_actor_pool_acquire (ClutterActorPool *pool)
+{
+  ClutterActorPoolPrivate *priv;
+  ClutterActor *actor;
+
+  g_return_val_if_fail (CLUTTER_IS_ACTOR_POOL (pool), NULL);
+
+  priv = pool->priv;
+
+  if (priv->actors->len == 0)
+    return g_object_new (priv->actor_type, NULL);
+
+  actor = g_ptr_array_remove_index (priv->actors, priv->actors->len - 1);
+
+  /* hand our reference over to the new parent */
+  g_object_force_floating (G_OBJECT (actor));
+
+  return actor;
+}
+
+/**
+ * clutter_actor_pool_release:
+ * @pool: a #ClutterActorPool
+ * @actor: a #ClutterActor of the #ClutterActorPool:actor-type type
+ *
+ * Returns @actor to @pool.
+ *
+ * The @actor is removed from its parent and reset, so that it can be
+ * returned by clutter_actor_pool_acquire(); if @pool is full, @actor is
+ * destroyed instead.
+ */
+void
+clutter_actor_pool_release (ClutterActorPool *pool,
+                            ClutterActor     *actor)
+{
+  ClutterActorPoolPrivate *priv;
+  ClutterActor *parent;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR_POOL (pool));
+  g_return_if_fail (CLUTTER_IS_ACTOR (actor));
+
+  priv = pool->priv;
+
+  g_return_if_fail (G_TYPE_CHECK_INSTANCE_TYPE (actor, priv->actor_type));
+
+  if (priv->actors->len >= priv->max_size)
+    {
+      clutter_actor_destroy (actor);
+      return;
+    }
+
+  g_object_ref_sink (actor);
+
+  parent = clutter_actor_get_parent (actor);
+  if (parent != NULL)
+    clutter_actor_remove_child (parent, actor);
+
+  _clutter_actor_reset_for_reuse (actor);
+
+  /* like a new actor, it will be shown when added to a parent */
+  clutter_actor_hide (actor);
+
+  g_ptr_array_add (priv->actors, actor);
+}
+
+/**
+ * clutter_actor_pool_get_actor_type:
+ * @pool: a #ClutterActorPool
+ *
+ * Retrieves the type of the actors in @pool.
+ *
+ * Return value: a #GType
+ */
+GType
+clutter_actor_pool_get_actor_type (ClutterActorPool *pool)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR_POOL (pool), G_TYPE_INVALID);
+
+  return pool->priv->actor_type;
+}
+
+/**
+ * clutter_actor_pool_set_max_size:
+ * @pool: a #ClutterActorPool
+ * @max_size: the maximum number of actors kept by @pool
+ *
+ * Sets the maximum number of actors kept by @pool; if @pool currently
+ * holds more actors, the excess ones are destroyed.
+ */
+void
+clutter_actor_pool_set_max_size (ClutterActorPool *pool,
+                                 guint             max_size)
+{
+  ClutterActorPoolPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR_POOL (pool));
+
+  priv = pool->priv;
+
+  if (priv->max_size == max_size)
+    return;
+
+  priv->max_size = max_size;
+
+  clutter_actor_pool_trim (pool, max_size);
+
+  g_object_notify_by_pspec (G_OBJECT (pool), obj_props[PROP_MAX_SIZE]);
+}
+
+/**
+ * clutter_actor_pool_get_max_size:
+ * @pool: a #ClutterActorPool
+ *
+ * Retrieves the value set using clutter_actor_pool_set_max_size().
+ *
+ * Return value: the maximum number of actors kept by @pool
+ */
+guint
+clutter_actor_pool_get_max_size (ClutterActorPool *pool)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR_POOL (pool), 0);
+
+  return pool->priv->max_size;
+}
+
+/**
+ * clutter_actor_pool_get_size:
+ * @pool: a #ClutterActorPool
+ *
+ * Retrieves the number of actors currently held by @pool.
+ *
+ * Return value: the number of actors in @pool
+ */
+guint
+clutter_actor_pool_get_size (ClutterActorPool *pool)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR_POOL (pool), 0);
+
+  return pool->priv->actors->len;
+}
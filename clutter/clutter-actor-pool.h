@@ -0,0 +1,89 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__CLUTTER_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <clutter/clutter.h> can be included directly."
+#endif
+
+#ifndef __CLUTTER_ACTOR_POOL_H__
+#define __CLUTTER_ACTOR_POOL_H__
+
+#include <clutter/clutter-types.h>
+
+G_BEGIN_DECLS
+
+#define CLUTTER_TYPE_ACTOR_POOL                 (clutter_actor_pool_get_type ())
+#define CLUTTER_ACTOR_POOL(obj)                 (G_TYPE_CHECK_INSTANCE_CAST ((obj), CLUTTER_TYPE_ACTOR_POOL, ClutterActorPool))
+#define CLUTTER_IS_ACTOR_POOL(obj)              (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CLUTTER_TYPE_ACTOR_POOL))
+#define CLUTTER_ACTOR_POOL_CLASS(klass)         (G_TYPE_CHECK_CLASS_CAST ((klass), CLUTTER_TYPE_ACTOR_POOL, ClutterActorPoolClass))
+#define CLUTTER_IS_ACTOR_POOL_CLASS(klass)      (G_TYPE_CHECK_CLASS_TYPE ((klass), CLUTTER_TYPE_ACTOR_POOL))
+#define CLUTTER_ACTOR_POOL_GET_CLASS(obj)       (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_ACTOR_POOL, ClutterActorPoolClass))
+
+typedef struct _ClutterActorPool                ClutterActorPool;
+typedef struct _ClutterActorPoolPrivate         ClutterActorPoolPrivate;
+typedef struct _ClutterActorPoolClass           ClutterActorPoolClass;
+
+/**
+ * ClutterActorPool:
+ *
+ * The <structname>ClutterActorPool</structname> structure contains only
+ * private data, and should be accessed using the provided API.
+ */
+struct _ClutterActorPool
+{
+  /*< private >*/
+  GObject parent_instance;
+
+  ClutterActorPoolPrivate *priv;
+};
+
+/**
+ * ClutterActorPoolClass:
+ *
+ * The <structname>ClutterActorPoolClass</structname> structure contains
+ * only private data.
+ */
+struct _ClutterActorPoolClass
+{
+  /*< private >*/
+  GObjectClass parent_class;
+
+  gpointer _padding[8];
+};
+
+GType clutter_actor_pool_get_type (void) G_GNUC_CONST;
+
+ClutterActorPool *      clutter_actor_pool_new                  (GType             actor_type,
+                                                                 guint             max_size);
+
+ClutterActor *          clutter_actor_pool_acquire              (ClutterActorPool *pool);
+void                    clutter_actor_pool_release              (ClutterActorPool *pool,
+                                                                 ClutterActor     *actor);
+
+GType                   clutter_actor_pool_get_actor_type       (ClutterActorPool *pool);
+void                    clutter_actor_pool_set_max_size         (ClutterActorPool *pool,
+                                                                 guint             max_size);
+guint                   clutter_actor_pool_get_max_size         (ClutterActorPool *pool);
+guint                   clutter_actor_pool_get_size             (ClutterActorPool *pool);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_ACTOR_POOL_H__ */
@@ -32,6 +32,9 @@ G_BEGIN_DECLS
  *   extents of what needs to be redrawn lies within the actors
  *   current allocation. (Only use this for 2D actors though because
  *   any actor with depth may be projected outside of its allocation)
+ * @CLUTTER_REDRAW_TRANSFORM_ONLY: Tells clutter that the redraw has
+ *   been queued because the transformation of the actor changed, and
+ *   that the contents of the actor did not change
  *
  * Flags passed to the clutter_actor_queue_redraw_with_clip ()
  * function
@@ -40,7 +43,8 @@ G_BEGIN_DECLS
  */
 typedef enum
 {
-  CLUTTER_REDRAW_CLIPPED_TO_ALLOCATION  = 1 << 0
+  CLUTTER_REDRAW_CLIPPED_TO_ALLOCATION  = 1 << 0,
+  CLUTTER_REDRAW_TRANSFORM_ONLY         = 1 << 1
 } ClutterRedrawFlags;
 
 /*< private >
@@ -114,6 +118,7 @@ typedef struct _SizeRequest             SizeRequest;
 typedef struct _ClutterLayoutInfo       ClutterLayoutInfo;
 typedef struct _ClutterTransformInfo    ClutterTransformInfo;
 typedef struct _ClutterAnimationInfo    ClutterAnimationInfo;
+typedef struct _ClutterGeometryPick     ClutterGeometryPick;
 
 /* Internal helper struct to represent a point that can be stored in
    either direct pixel coordinates or as a fraction of the actor's
@@ -155,6 +160,8 @@ struct _SizeRequest
  * @y_expand: whether the actor should expand vertically
  * @minimum: the fixed minimum size
  * @natural: the fixed natural size
+ * @layout_meta: the #ClutterLayoutMeta created for the actor by the
+ *   layout manager of its parent, or %NULL; owned by the actor
  *
  * Ancillary layout information for an actor.
  */
@@ -173,6 +180,8 @@ struct _ClutterLayoutInfo
 
   ClutterSize minimum;
   ClutterSize natural;
+
+  ClutterLayoutMeta *layout_meta;
 };
 
 const ClutterLayoutInfo *       _clutter_actor_get_layout_info_or_defaults      (ClutterActor *self);
@@ -257,6 +266,11 @@ void                            _clutter_actor_rerealize
 void                            _clutter_actor_set_opacity_override                     (ClutterActor *self,
                                                                                          gint          opacity);
 gint                            _clutter_actor_get_opacity_override                     (ClutterActor *self);
+
+gboolean                        _clutter_actor_is_damaged                               (ClutterActor *self);
+void                            _clutter_actor_skip_children_pick_index                 (ClutterActor *self);
+const GList *                   _clutter_actor_peek_next_effects                        (ClutterActor *self);
+ClutterEffect *                 _clutter_actor_get_flatten_effect                       (ClutterActor *self);
 void                            _clutter_actor_set_in_clone_paint                       (ClutterActor *self,
                                                                                          gboolean      is_in_clone_paint);
 
@@ -294,6 +308,76 @@ void                            _clutter_actor_pop_clone_paint
 
 guint32                         _clutter_actor_get_pick_id                              (ClutterActor *self);
 
+/*< private >
+ * ClutterGeometryPick:
+ * @projection: the projection matrix of the stage
+ * @viewport: the viewport of the stage
+ * @mode: the #ClutterPickMode
+ * @x: the X coordinate of the pick point, in window coordinates
+ * @y: the Y coordinate of the pick point, in window coordinates
+ * @hit: return location for the picked actor, or %NULL
+ *
+ * The state used by _clutter_actor_geometry_pick().
+ */
+struct _ClutterGeometryPick
+{
+  const CoglMatrix *projection;
+  const float *viewport;
+
+  ClutterPickMode mode;
+
+  float x;
+  float y;
+
+  ClutterActor *hit;
+};
+
+/*< private >
+ * ClutterGeometryPickResult:
+ * @CLUTTER_GEOMETRY_PICK_MISS: the actor is not at the pick point
+ * @CLUTTER_GEOMETRY_PICK_HIT: the actor is at the pick point
+ * @CLUTTER_GEOMETRY_PICK_UNKNOWN: a pick render is needed
+ *
+ * The result of _clutter_actor_geometry_pick_test().
+ */
+typedef enum {
+  CLUTTER_GEOMETRY_PICK_MISS,
+  CLUTTER_GEOMETRY_PICK_HIT,
+  CLUTTER_GEOMETRY_PICK_UNKNOWN
+} ClutterGeometryPickResult;
+
+gboolean                        _clutter_actor_geometry_pick                            (ClutterActor        *self,
+                                                                                         ClutterGeometryPick *pick);
+ClutterGeometryPickResult       _clutter_actor_geometry_pick_test                       (ClutterActor        *self,
+                                                                                         ClutterGeometryPick *pick);
+gboolean                        _clutter_actor_get_pick_region                          (ClutterActor        *self,
+                                                                                         gfloat               x,
+                                                                                         gfloat               y,
+                                                                                         ClutterActorBox     *region);
+gboolean                        _clutter_actor_paints_before                            (ClutterActor        *a,
+                                                                                         ClutterActor        *b);
+
+void                            _clutter_actor_queue_size_relayout                      (ClutterActor *self);
+gboolean                        _clutter_actor_check_size_relayout                      (ClutterActor *self);
+void                            _clutter_actor_reallocate                               (ClutterActor *self);
+guint                           _clutter_actor_get_allocation_serial                    (void);
+guint                           _clutter_actor_get_last_allocation_serial               (ClutterActor *self);
+void                            _clutter_actor_restore_allocation                       (ClutterActor          *self,
+                                                                                         const ClutterActorBox *box);
+void                            _clutter_actor_get_constraint_sources                   (ClutterActor *self,
+                                                                                         GPtrArray    *sources);
+
+void                            _clutter_actor_reset_for_reuse                          (ClutterActor *self);
+
+gint                            _clutter_actor_get_children_age                         (ClutterActor *self);
+
+void                            _clutter_actor_flush_pick_batch                         (void);
+
+void                            _clutter_actor_compute_occlusion                        (ClutterActor        *self,
+                                                                                         const CoglMatrix    *projection,
+                                                                                         const float         *viewport,
+                                                                                         ClutterOcclusion    *occlusion);
+
 void                            _clutter_actor_shader_pre_paint                         (ClutterActor *actor,
                                                                                          gboolean      repeat);
 void                            _clutter_actor_shader_post_paint                        (ClutterActor *actor);
@@ -311,6 +395,35 @@ void                            _clutter_actor_queue_redraw_on_clones
 void                            _clutter_actor_queue_relayout_on_clones                 (ClutterActor *actor);
 void                            _clutter_actor_queue_only_relayout                      (ClutterActor *actor);
 
+GType                           _clutter_actor_get_animatable_value_type                (ClutterActor       *self,
+                                                                                         GParamSpec         *pspec);
+void                            _clutter_actor_set_animatable_float                     (ClutterActor       *self,
+                                                                                         GParamSpec         *pspec,
+                                                                                         gfloat              value);
+void                            _clutter_actor_set_animatable_double                    (ClutterActor       *self,
+                                                                                         GParamSpec         *pspec,
+                                                                                         gdouble             value);
+void                            _clutter_actor_set_animatable_color                     (ClutterActor       *self,
+                                                                                         GParamSpec         *pspec,
+                                                                                         const ClutterColor *value);
+void                            _clutter_actor_set_animatable_point                     (ClutterActor       *self,
+                                                                                         GParamSpec         *pspec,
+                                                                                         const ClutterPoint *value);
+
+gboolean                        _clutter_actor_is_paint_time_property                   (ClutterActor       *self,
+                                                                                         GParamSpec         *pspec);
+void                            _clutter_actor_schedule_paint_transition                (ClutterActor       *self,
+                                                                                         ClutterTransition  *transition,
+                                                                                         GParamSpec         *pspec);
+gboolean                        _clutter_actor_unschedule_paint_transition              (ClutterActor       *self,
+                                                                                         ClutterTransition  *transition);
+void                            _clutter_actor_set_paint_time_value                     (ClutterActor       *self,
+                                                                                         GParamSpec         *pspec,
+                                                                                         gdouble             value);
+
+void                            _clutter_property_transition_update_paint_value         (ClutterTransition  *transition,
+                                                                                         ClutterActor       *actor);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_ACTOR_PRIVATE_H__ */
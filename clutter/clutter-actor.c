@@ -153,6 +153,11 @@
  *     local root of the render tree; any node added to it will be
  *     rendered at the correct position, as defined by the actor's
  *     #ClutterActor:allocation.</para>
+ *     <para>The render tree of an actor is retained between frames, and
+ *     it is only built again after the actor queues a redraw, changes
+ *     its allocation or its paint opacity; actors overriding the
+ *     paint_node virtual function must call clutter_actor_queue_redraw()
+ *     each time the state used to build their paint nodes changes.</para>
  *     <informalexample><programlisting>
  * static void
  * my_actor_paint_node (ClutterActor     *actor,
@@ -594,6 +599,7 @@
 #include "clutter-actor-private.h"
 
 #include "clutter-action.h"
+#include "clutter-actor-cost.h"
 #include "clutter-actor-meta-private.h"
 #include "clutter-animatable.h"
 #include "clutter-color-static.h"
@@ -610,12 +616,15 @@
 #include "clutter-interval.h"
 #include "clutter-main.h"
 #include "clutter-marshal.h"
+#include "clutter-memory.h"
+#include "clutter-model.h"
 #include "clutter-paint-nodes.h"
 #include "clutter-paint-node-private.h"
 #include "clutter-paint-volume-private.h"
 #include "clutter-private.h"
 #include "clutter-profile.h"
 #include "clutter-property-transition.h"
+#include "clutter-redraw-cause.h"
 #include "clutter-scriptable.h"
 #include "clutter-script-private.h"
 #include "clutter-stage-private.h"
@@ -643,43 +652,80 @@ typedef enum {
                               */
 } MapStateChange;
 
-/* 3 entries should be a good compromise, few layout managers
- * will ask for 3 different preferred size in each allocation cycle */
-#define N_CACHED_SIZE_REQUESTS 3
+/* height-for-width layout managers, like ClutterFlowLayout or a wrapping
+ * ClutterBoxLayout, ask for a few different preferred sizes in each
+ * allocation cycle; the entries are recycled in least recently used
+ * order. the size of the cache can be changed at build time */
+#ifndef N_CACHED_SIZE_REQUESTS
+#define N_CACHED_SIZE_REQUESTS 6
+#endif
 
-struct _ClutterActorPrivate
-{
-  /* request mode */
-  ClutterRequestMode request_mode;
+/* the heuristics of CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_CACHING:
+ * an actor is cached after it has been painted without changes for a
+ * number of paints, which doubles every time the cached image has to be
+ * dropped, if it has enough descendants and the area of all the cached
+ * images does not exceed the budget
+ */
+#define CACHE_MIN_STATIC_PAINTS         10
+#define CACHE_MAX_BACKOFF               5
+#define CACHE_MIN_DESCENDANTS           16
+#define CACHE_MAX_AREA                  (4096.f * 2048.f)
 
-  /* our cached size requests for different width / height */
+/* the area of the cached images of all the actors */
+static gfloat cache_total_area = 0.f;
+
+/* the size requests cached by an actor */
+typedef struct _SizeRequestCache
+{
   SizeRequest width_requests[N_CACHED_SIZE_REQUESTS];
   SizeRequest height_requests[N_CACHED_SIZE_REQUESTS];
 
   /* An age of 0 means the entry is not set */
   guint cached_height_age;
   guint cached_width_age;
+} SizeRequestCache;
 
-  /* the bounding box of the actor, relative to the parent's
-   * allocation
-   */
-  ClutterActorBox allocation;
-  ClutterAllocationFlags allocation_flags;
-
-  /* clip, in actor coordinates */
-  ClutterRect clip;
+/* the state of clutter_actor_bind_model() */
+typedef struct _ModelBinding
+{
+  ClutterModel *model;
+  ClutterActorCreateChildFunc create_child_func;
+  gpointer create_child_data;
+  GDestroyNotify create_child_notify;
+} ModelBinding;
 
-  /* the cached transformation matrix; see apply_transform() */
-  CoglMatrix transform;
+/* an axis aligned box in the coordinate space of an actor; the box is
+ * empty when x1 > x2
+ */
+typedef struct _PaintBounds
+{
+  gfloat x1, y1, z1;
+  gfloat x2, y2, z2;
+} PaintBounds;
 
-  guint8 opacity;
-  gint opacity_override;
+/* the level of detail of an actor, allocated by the first call to
+ * clutter_actor_set_lod_threshold() or clutter_actor_set_lod_placeholder()
+ */
+typedef struct _LodInfo
+{
+  /* the size on the stage, in pixels, below which the actor is
+   * painted using its placeholder instead of its contents
+   */
+  gfloat threshold;
+  ClutterContent *placeholder;
 
-  ClutterOffscreenRedirect offscreen_redirect;
+  /* whether the actor was collapsed by the last paint */
+  guint collapsed : 1;
+} LodInfo;
 
-  /* This is an internal effect used to implement the
-     offscreen-redirect property */
-  ClutterEffect *flatten_effect;
+struct _ClutterActorPrivate
+{
+  /* the data used when traversing the scene graph to lay out, pick
+   * and paint the actors is kept together at the start of the
+   * structure; the data that only some actors need is allocated on
+   * demand, in the side structures below or in the layout, transform
+   * and animation info
+   */
 
   /* scene graph */
   ClutterActor *parent;
@@ -698,10 +744,140 @@ struct _ClutterActorPrivate
    */
   gint age;
 
+  /* the children in paint order, kept alongside the list by containers
+   * with many children; see clutter_actor_get_children_index()
+   */
+  GPtrArray *children_index;
+
+  /* an upper bound of the z-position of the children, used to append
+   * without walking the list in insert_child_at_depth()
+   */
+  gfloat children_max_z;
+
+  /* the bounding box of the actor, relative to the parent's
+   * allocation
+   */
+  ClutterActorBox allocation;
+  ClutterAllocationFlags allocation_flags;
+
+  /* the allocation serial of the last change of the allocation; see
+   * _clutter_actor_get_allocation_serial()
+   */
+  guint allocation_serial;
+
+  guint8 opacity;
+  gint opacity_override;
+
+  /* fixed position and sizes */
+  guint position_set                : 1;
+  guint min_width_set               : 1;
+  guint min_height_set              : 1;
+  guint natural_width_set           : 1;
+  guint natural_height_set          : 1;
+  /* cached request is invalid (implies allocation is too) */
+  guint needs_width_request         : 1;
+  /* cached request is invalid (implies allocation is too) */
+  guint needs_height_request        : 1;
+  /* cached allocation is invalid (request has changed, probably) */
+  guint needs_allocation            : 1;
+  guint has_clip                    : 1;
+  guint clip_to_allocation          : 1;
+  guint enable_model_view_transform : 1;
+  guint enable_paint_unmapped       : 1;
+  guint has_pointer                 : 1;
+  guint propagated_one_redraw       : 1;
+  guint paint_volume_valid          : 1;
+  /* the cached paint_volume, and the cached contributions of the
+     children to it, need to be computed again */
+  guint needs_paint_volume_update   : 1;
+  /* children_bounds holds the union of the parent_bounds of all the
+     children, except the ones listed in dirty_children */
+  guint children_bounds_valid       : 1;
+  /* the actor is listed in the dirty_children of its parent */
+  guint in_dirty_children           : 1;
+  guint last_paint_volume_valid     : 1;
+  /* last_paint_volume was computed from the cached stage_transform
+     and paint_volume, and can be kept while both are still valid */
+  guint last_paint_volume_cached    : 1;
+  guint in_clone_paint              : 1;
+  guint transform_valid             : 1;
+  guint stage_transform_valid       : 1;
+  /* the ClutterTransformKind of the cached stage_transform */
+  guint stage_transform_kind        : 3;
+  /* This is TRUE if anything has queued a redraw since we were last
+     painted. In this case effect_to_redraw will point to an effect
+     the redraw was queued from or it will be NULL if the redraw was
+     queued without an effect. */
+  guint is_dirty                    : 1;
+  /* This is TRUE if the contents of the actor, of its children or of
+     its effects changed since we were last painted; unlike is_dirty,
+     it is not set by redraws queued only because the transformation
+     of the actor changed. */
+  guint is_damaged                  : 1;
+  guint bg_color_set                : 1;
+  guint content_box_valid           : 1;
+  guint x_expand_set                : 1;
+  guint y_expand_set                : 1;
+  guint needs_compute_expand        : 1;
+  guint needs_x_expand              : 1;
+  guint needs_y_expand              : 1;
+  guint was_painted                 : 1;
+  guint children_index_valid        : 1;
+
+  /* the cached transformation matrix; see apply_transform() */
+  CoglMatrix transform;
+
+  /* the cached transformation from the coordinate space of the actor
+   * to the coordinate space of its stage, allocated the first time it
+   * is needed; see clutter_actor_get_stage_transform()
+   */
+  CoglMatrix *stage_transform;
+
+  /* request mode */
+  ClutterRequestMode request_mode;
+
+  /* our cached size requests for different width / height, allocated
+   * by the first request
+   */
+  SizeRequestCache *size_requests;
+
+  /* clip, in actor coordinates */
+  ClutterRect clip;
+
+  ClutterOffscreenRedirect offscreen_redirect;
+
+  /* This is an internal effect used to implement the
+     offscreen-redirect property */
+  ClutterEffect *flatten_effect;
+
+  /* the number of consecutive paints in which the actor was not
+     damaged, the number of times the cached image had to be dropped
+     because the actor changed, and the area reserved for the cached
+     image; see clutter_actor_needs_caching() */
+  guint static_paints;
+  guint cache_misses;
+  gfloat cache_area;
+
   gchar *name; /* a non-unique name, used for debugging */
   guint32 id; /* unique id, used for backward compatibility */
 
   gint32 pick_id; /* per-stage unique id, used for picking */
+  gint pick_index_handle; /* the leaf inside the pick index of the stage */
+
+  /* the position of the actor and of the last of its descendants in
+   * the paint order, valid only for the stage paint that has the same
+   * occlusion serial
+   */
+  guint occlusion_serial;
+  guint paint_index;
+  guint paint_index_last;
+
+  /* the render tree built by clutter_actor_paint_node(), retained
+   * until the actor is invalidated, and the paint opacity used to
+   * build it
+   */
+  ClutterPaintNode *paint_node;
+  guint8 paint_node_opacity;
 
   /* a back-pointer to the Pango context that we can use
    * to create pre-configured PangoLayout
@@ -724,6 +900,14 @@ struct _ClutterActorPrivate
   /* delegate object used to allocate the children of this actor */
   ClutterLayoutManager *layout_manager;
 
+  /* the model mapped to the children of this actor, if any; see
+   * clutter_actor_bind_model()
+   */
+  ModelBinding *model_binding;
+
+  /* the level of detail, if any */
+  LodInfo *lod;
+
   /* delegate object used to paint the contents of this actor */
   ClutterContent *content;
 
@@ -752,12 +936,29 @@ struct _ClutterActorPrivate
 
   ClutterPaintVolume paint_volume;
 
+  /* the bounds of the transformed paint volume of the actor in the
+   * coordinate space of the parent, as they were when the parent last
+   * computed its own paint volume; and the bounds of the volumes of
+   * all the children, maintained incrementally, with the children
+   * that changed since then. see clutter_actor_update_children_bounds()
+   */
+  PaintBounds parent_bounds;
+  PaintBounds children_bounds;
+  GPtrArray *dirty_children;
+
   /* NB: This volume isn't relative to this actor, it is in eye
    * coordinates so that it can remain valid after the actor changes.
    */
   ClutterPaintVolume last_paint_volume;
+  /* the view generation of the stage when last_paint_volume was
+   * computed; see last_paint_volume_cached
+   */
+  guint last_paint_volume_view;
 
-  ClutterStageQueueRedrawEntry *queue_redraw_entry;
+  /* the index of the entry of the actor in the redraws queued on the
+   * stage, or -1
+   */
+  gint queue_redraw_entry;
 
   ClutterColor bg_color;
 
@@ -769,48 +970,14 @@ struct _ClutterActorPrivate
   /* a set of clones of the actor */
   GHashTable *clones;
 
+  /* the transitions whose values are computed before painting */
+  GPtrArray *paint_transitions;
+
   /* whether the actor is inside a cloned branch; this
    * value is propagated to all the actor's children
    */
   gulong in_cloned_branch;
 
-  /* bitfields: KEEP AT THE END */
-
-  /* fixed position and sizes */
-  guint position_set                : 1;
-  guint min_width_set               : 1;
-  guint min_height_set              : 1;
-  guint natural_width_set           : 1;
-  guint natural_height_set          : 1;
-  /* cached request is invalid (implies allocation is too) */
-  guint needs_width_request         : 1;
-  /* cached request is invalid (implies allocation is too) */
-  guint needs_height_request        : 1;
-  /* cached allocation is invalid (request has changed, probably) */
-  guint needs_allocation            : 1;
-  guint has_clip                    : 1;
-  guint clip_to_allocation          : 1;
-  guint enable_model_view_transform : 1;
-  guint enable_paint_unmapped       : 1;
-  guint has_pointer                 : 1;
-  guint propagated_one_redraw       : 1;
-  guint paint_volume_valid          : 1;
-  guint last_paint_volume_valid     : 1;
-  guint in_clone_paint              : 1;
-  guint transform_valid             : 1;
-  /* This is TRUE if anything has queued a redraw since we were last
-     painted. In this case effect_to_redraw will point to an effect
-     the redraw was queued from or it will be NULL if the redraw was
-     queued without an effect. */
-  guint is_dirty                    : 1;
-  guint bg_color_set                : 1;
-  guint content_box_valid           : 1;
-  guint x_expand_set                : 1;
-  guint y_expand_set                : 1;
-  guint needs_compute_expand        : 1;
-  guint needs_x_expand              : 1;
-  guint needs_y_expand              : 1;
-  guint was_painted                 : 1;
 };
 
 enum
@@ -923,6 +1090,9 @@ enum
   PROP_MAGNIFICATION_FILTER,
   PROP_CONTENT_REPEAT,
 
+  PROP_LOD_THRESHOLD,
+  PROP_LOD_PLACEHOLDER,
+
   PROP_LAST
 };
 
@@ -960,6 +1130,22 @@ enum
 
 static guint actor_signals[LAST_SIGNAL] = { 0, };
 
+/* the ancestors of the source of the last event, from the source to
+ * the top-level, reused by _clutter_actor_handle_event() until an actor
+ * is added to or removed from a parent; the chain does not hold
+ * references on the actors
+ */
+static GPtrArray *event_chain = NULL;
+static ClutterActor *event_chain_source = NULL;
+static guint event_chain_generation = 0;
+static guint hierarchy_generation = 1;
+static gboolean event_chain_in_use = FALSE;
+
+/* incremented every time the allocation of an actor changes; see
+ * _clutter_actor_get_allocation_serial()
+ */
+static guint allocation_serial = 0;
+
 typedef struct _TransitionClosure
 {
   ClutterActor *actor;
@@ -997,6 +1183,18 @@ static void clutter_actor_set_natural_height_set (ClutterActor *self,
 static void clutter_actor_update_map_state       (ClutterActor  *self,
                                                   MapStateChange change);
 static void clutter_actor_unrealize_not_hiding   (ClutterActor *self);
+static void clutter_actor_real_paint             (ClutterActor *actor);
+static void clutter_actor_allocate_internal      (ClutterActor           *self,
+                                                  const ClutterActorBox  *allocation,
+                                                  ClutterAllocationFlags  flags);
+static void clutter_actor_compute_preferred_width  (ClutterActor *self,
+                                                    gfloat        for_height,
+                                                    gfloat       *min_width_p,
+                                                    gfloat       *natural_width_p);
+static void clutter_actor_compute_preferred_height (ClutterActor *self,
+                                                    gfloat        for_width,
+                                                    gfloat       *min_height_p,
+                                                    gfloat       *natural_height_p);
 
 static void _clutter_actor_get_relative_transformation_matrix (ClutterActor *self,
                                                                ClutterActor *ancestor,
@@ -1014,6 +1212,10 @@ static void on_layout_manager_changed (ClutterLayoutManager *manager,
 
 static inline void clutter_actor_queue_compute_expand (ClutterActor *self);
 
+static inline void clutter_actor_invalidate_paint_node (ClutterActor *self);
+
+static inline void clutter_actor_queue_transform_redraw (ClutterActor *self);
+
 static inline void clutter_actor_set_margin_internal (ClutterActor *self,
                                                       gfloat        margin,
                                                       GParamSpec   *pspec);
@@ -1415,6 +1617,120 @@ clutter_actor_update_map_state (ClutterActor  *self,
 #endif
 }
 
+/* whether a change in the state of @self can change the result of a
+ * pick in %CLUTTER_PICK_REACTIVE mode; non-reactive leaf actors are not
+ * painted when picking only reactive actors
+ */
+#define CLUTTER_ACTOR_AFFECTS_REACTIVE_PICK(a) \
+  (CLUTTER_ACTOR_IS_REACTIVE (a) || (a)->priv->n_children > 0)
+
+/* notifies the stage that the state of @self that is relevant when
+ * picking has changed, e.g. its allocation, transformation or clip
+ */
+static void
+clutter_actor_invalidate_pick (ClutterActor *self)
+{
+  ClutterActor *stage;
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (self))
+    return;
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL)
+    return;
+
+  _clutter_stage_invalidate_pick (CLUTTER_STAGE (stage),
+                                  CLUTTER_ACTOR_AFFECTS_REACTIVE_PICK (self));
+}
+
+/* invalidates the cached transformation to the stage of @self and of
+ * its descendants; the cache of an actor is only valid if the caches
+ * of all its ancestors are, so the walk stops at the actors whose
+ * cache is already invalid
+ */
+static void
+clutter_actor_invalidate_stage_transform (ClutterActor *self)
+{
+  ClutterActor *child;
+
+  if (!self->priv->stage_transform_valid)
+    return;
+
+  self->priv->stage_transform_valid = FALSE;
+  self->priv->last_paint_volume_cached = FALSE;
+
+  for (child = self->priv->first_child;
+       child != NULL;
+       child = child->priv->next_sibling)
+    clutter_actor_invalidate_stage_transform (child);
+}
+
+/* invalidates the cached paint volume of @self and of its ancestors,
+ * and of the clones painting them; the volume of an ancestor is still
+ * valid if the ancestor needs an update already, as the ancestors of
+ * an actor that needs an update are not computed past it
+ */
+static void
+clutter_actor_queue_paint_volume_update (ClutterActor *self)
+{
+  ClutterActor *iter = self;
+
+  iter->priv->needs_paint_volume_update = TRUE;
+
+  while (TRUE)
+    {
+      ClutterActorPrivate *iter_priv = iter->priv;
+      ClutterActorPrivate *parent_priv;
+
+      if (iter_priv->clones != NULL)
+        {
+          GHashTableIter clones;
+          gpointer clone;
+
+          /* a clone can be inside the actors it paints */
+          g_hash_table_iter_init (&clones, iter_priv->clones);
+          while (g_hash_table_iter_next (&clones, &clone, NULL))
+            if (!CLUTTER_ACTOR (clone)->priv->needs_paint_volume_update)
+              clutter_actor_queue_paint_volume_update (clone);
+        }
+
+      if (iter_priv->parent == NULL)
+        break;
+
+      parent_priv = iter_priv->parent->priv;
+
+      /* the parent only needs to look again at the children that
+       * changed since it computed its volume
+       */
+      if (parent_priv->children_bounds_valid && !iter_priv->in_dirty_children)
+        {
+          if (parent_priv->dirty_children == NULL)
+            parent_priv->dirty_children = g_ptr_array_new ();
+
+          g_ptr_array_add (parent_priv->dirty_children, iter);
+          iter_priv->in_dirty_children = TRUE;
+        }
+
+      if (parent_priv->needs_paint_volume_update)
+        break;
+
+      parent_priv->needs_paint_volume_update = TRUE;
+      iter = iter_priv->parent;
+    }
+}
+
+/* invalidates the cached transformation of @self, after a change in
+ * its allocation, in its transformation properties or in its parent
+ */
+static void
+clutter_actor_invalidate_transform (ClutterActor *self)
+{
+  self->priv->transform_valid = FALSE;
+
+  clutter_actor_invalidate_stage_transform (self);
+  clutter_actor_queue_paint_volume_update (self);
+}
+
 static void
 clutter_actor_real_map (ClutterActor *self)
 {
@@ -1428,8 +1744,13 @@ clutter_actor_real_map (ClutterActor *self)
 
   CLUTTER_ACTOR_SET_FLAGS (self, CLUTTER_ACTOR_MAPPED);
 
+  /* unmapped children do not contribute to the paint volume */
+  clutter_actor_queue_paint_volume_update (self);
+
   stage = _clutter_actor_get_stage_internal (self);
   priv->pick_id = _clutter_stage_acquire_pick_id (CLUTTER_STAGE (stage), self);
+  _clutter_stage_invalidate_pick (CLUTTER_STAGE (stage),
+                                  CLUTTER_ACTOR_AFFECTS_REACTIVE_PICK (self));
 
   /* reset the was_painted flag here: unmapped actors are not going to
    * be painted in any case, and this allows us to catch the case of
@@ -1505,11 +1826,14 @@ clutter_actor_real_unmap (ClutterActor *self)
 
   CLUTTER_ACTOR_UNSET_FLAGS (self, CLUTTER_ACTOR_MAPPED);
 
+  clutter_actor_queue_paint_volume_update (self);
+
   /* clear the contents of the last paint volume, so that hiding + moving +
    * showing will not result in the wrong area being repainted
    */
   _clutter_paint_volume_init_static (&priv->last_paint_volume, NULL);
   priv->last_paint_volume_valid = TRUE;
+  priv->last_paint_volume_cached = FALSE;
 
   /* notify on parent mapped after potentially unmapping
    * children, so apps see a bottom-up notification.
@@ -1524,7 +1848,15 @@ clutter_actor_real_unmap (ClutterActor *self)
       stage = CLUTTER_STAGE (_clutter_actor_get_stage_internal (self));
 
       if (stage != NULL)
-        _clutter_stage_release_pick_id (stage, priv->pick_id);
+        {
+          _clutter_stage_release_pick_id (stage, priv->pick_id);
+          _clutter_stage_invalidate_pick (stage,
+                                          CLUTTER_ACTOR_AFFECTS_REACTIVE_PICK (self));
+
+          if (priv->pick_index_handle >= 0)
+            _clutter_stage_remove_from_pick_index (stage,
+                                                   &priv->pick_index_handle);
+        }
 
       priv->pick_id = -1;
 
@@ -1989,45 +2321,166 @@ _clutter_actor_rerealize (ClutterActor    *self,
     clutter_actor_realize (self); /* realize self and all parents */
 }
 
-static void
-clutter_actor_real_pick (ClutterActor       *self,
-			 const ClutterColor *color)
-{
-  /* the default implementation is just to paint a rectangle
-   * with the same size of the actor using the passed color
-   */
-  if (clutter_actor_should_pick_paint (self))
-    {
-      ClutterActorBox box = { 0, };
-      float width, height;
+/* the silhouettes painted by the default pick, in eye coordinates,
+ * waiting to be drawn with a single primitive; see
+ * _clutter_actor_flush_pick_batch()
+ */
+static GArray *pick_batch = NULL;
+static CoglFramebuffer *pick_batch_framebuffer = NULL;
 
-      clutter_actor_get_allocation_box (self, &box);
+/* the silhouettes are drawn directly while running a pick that does
+ * not go through the default implementation, since it can draw in
+ * between them
+ */
+static guint pick_batch_inhibit = 0;
 
-      width = box.x2 - box.x1;
-      height = box.y2 - box.y1;
+/*< private >
+ * _clutter_actor_flush_pick_batch:
+ *
+ * Draws the silhouettes batched by the default implementation of
+ * #ClutterActorClass.pick(); this needs to be called before anything
+ * else draws, or changes the clip, while picking.
+ */
+void
+_clutter_actor_flush_pick_batch (void)
+{
+  static CoglPipeline *pick_pipeline = NULL;
+  CoglPrimitive *prim;
+  CoglMatrix identity;
+  CoglContext *ctx;
 
-      cogl_set_source_color4ub (color->red,
-                                color->green,
-                                color->blue,
-                                color->alpha);
+  if (pick_batch == NULL || pick_batch->len == 0)
+    return;
 
-      cogl_rectangle (0, 0, width, height);
-    }
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
 
-  /* XXX - this thoroughly sucks, but we need to maintain compatibility
-   * with existing container classes that override the pick() virtual
-   * and chain up to the default implementation - otherwise we'll end up
-   * painting our children twice.
-   *
-   * this has to go away for 2.0; hopefully along the pick() itself.
-   */
-  if (CLUTTER_ACTOR_GET_CLASS (self)->pick == clutter_actor_real_pick)
+  /* the pick colors must be written as they are */
+  if (G_UNLIKELY (pick_pipeline == NULL))
     {
-      ClutterActor *iter;
+      pick_pipeline = cogl_pipeline_new (ctx);
+      cogl_pipeline_set_blend (pick_pipeline, "RGBA = ADD (SRC_COLOR, 0)", NULL);
+    }
 
-      for (iter = self->priv->first_child;
-           iter != NULL;
-           iter = iter->priv->next_sibling)
+  prim = cogl_primitive_new_p3c4 (ctx,
+                                  COGL_VERTICES_MODE_TRIANGLES,
+                                  pick_batch->len,
+                                  (CoglVertexP3C4 *) pick_batch->data);
+
+  cogl_matrix_init_identity (&identity);
+
+  cogl_push_matrix ();
+  cogl_set_modelview_matrix (&identity);
+  cogl_framebuffer_draw_primitive (pick_batch_framebuffer, pick_pipeline, prim);
+  cogl_pop_matrix ();
+
+  cogl_object_unref (prim);
+
+  g_array_set_size (pick_batch, 0);
+  pick_batch_framebuffer = NULL;
+}
+
+/* adds the rectangle from (0, 0) to (@width, @height), in the
+ * coordinates of the current modelview, to the batched silhouettes
+ */
+static void
+clutter_actor_batch_pick_rectangle (gfloat              width,
+                                    gfloat              height,
+                                    const ClutterColor *color)
+{
+  static const int corners[6] = { 0, 1, 2, 0, 2, 3 };
+  CoglFramebuffer *framebuffer;
+  CoglVertexP3C4 vertices[4];
+  CoglMatrix modelview;
+  int i;
+
+  framebuffer = cogl_get_draw_framebuffer ();
+  if (framebuffer != pick_batch_framebuffer)
+    _clutter_actor_flush_pick_batch ();
+
+  if (G_UNLIKELY (pick_batch == NULL))
+    pick_batch = g_array_new (FALSE, FALSE, sizeof (CoglVertexP3C4));
+
+  pick_batch_framebuffer = framebuffer;
+
+  cogl_get_modelview_matrix (&modelview);
+
+  for (i = 0; i < 4; i++)
+    {
+      float w = 1.f;
+
+      vertices[i].x = (i == 1 || i == 2) ? width : 0.f;
+      vertices[i].y = (i == 2 || i == 3) ? height : 0.f;
+      vertices[i].z = 0.f;
+
+      cogl_matrix_transform_point (&modelview,
+                                   &vertices[i].x,
+                                   &vertices[i].y,
+                                   &vertices[i].z,
+                                   &w);
+
+      vertices[i].r = color->red;
+      vertices[i].g = color->green;
+      vertices[i].b = color->blue;
+      vertices[i].a = color->alpha;
+    }
+
+  for (i = 0; i < 6; i++)
+    g_array_append_val (pick_batch, vertices[corners[i]]);
+}
+
+/* paints a rectangle with the same size of the actor using @color */
+static void
+clutter_actor_pick_silhouette (ClutterActor       *self,
+                               const ClutterColor *color)
+{
+  ClutterActorBox box = { 0, };
+  float width, height;
+
+  clutter_actor_get_allocation_box (self, &box);
+
+  width = box.x2 - box.x1;
+  height = box.y2 - box.y1;
+
+  /* the silhouettes of all the actors using the default pick
+   * are drawn at once, without textures and blending
+   */
+  if (pick_batch_inhibit == 0)
+    clutter_actor_batch_pick_rectangle (width, height, color);
+  else
+    {
+      cogl_set_source_color4ub (color->red,
+                                color->green,
+                                color->blue,
+                                color->alpha);
+
+      cogl_rectangle (0, 0, width, height);
+    }
+}
+
+static void
+clutter_actor_real_pick (ClutterActor       *self,
+			 const ClutterColor *color)
+{
+  /* the default implementation is just to paint a rectangle
+   * with the same size of the actor using the passed color
+   */
+  if (clutter_actor_should_pick_paint (self))
+    clutter_actor_pick_silhouette (self, color);
+
+  /* XXX - this thoroughly sucks, but we need to maintain compatibility
+   * with existing container classes that override the pick() virtual
+   * and chain up to the default implementation - otherwise we'll end up
+   * painting our children twice.
+   *
+   * this has to go away for 2.0; hopefully along the pick() itself.
+   */
+  if (CLUTTER_ACTOR_GET_CLASS (self)->pick == clutter_actor_real_pick)
+    {
+      ClutterActor *iter;
+
+      for (iter = self->priv->first_child;
+           iter != NULL;
+           iter = iter->priv->next_sibling)
         clutter_actor_paint (iter);
     }
 }
@@ -2058,7307 +2511,10538 @@ clutter_actor_should_pick_paint (ClutterActor *self)
   return FALSE;
 }
 
-static void
-clutter_actor_real_get_preferred_width (ClutterActor *self,
-                                        gfloat        for_height,
-                                        gfloat       *min_width_p,
-                                        gfloat       *natural_width_p)
+/* Checks whether the window coordinates @x, @y fall inside the quad
+ * described by @verts, using the same vertex ordering returned by
+ * clutter_actor_get_abs_allocation_vertices(). Since the projection
+ * of a rectangle is always convex we can simply check that the point
+ * lies on the same side of all four edges.
+ */
+static gboolean
+point_in_projected_quad (const ClutterVertex verts[4],
+                         float               x,
+                         float               y)
 {
-  ClutterActorPrivate *priv = self->priv;
+  static const int order[4] = { 0, 1, 3, 2 };
+  int i, sign = 0;
 
-  if (priv->n_children != 0 &&
-      priv->layout_manager != NULL)
+  for (i = 0; i < 4; i++)
     {
-      ClutterContainer *container = CLUTTER_CONTAINER (self);
+      const ClutterVertex *a = &verts[order[i]];
+      const ClutterVertex *b = &verts[order[(i + 1) % 4]];
+      float cross;
 
-      CLUTTER_NOTE (LAYOUT, "Querying the layout manager '%s'[%p] "
-                    "for the preferred width",
-                    G_OBJECT_TYPE_NAME (priv->layout_manager),
-                    priv->layout_manager);
+      cross = (b->x - a->x) * (y - a->y)
+            - (b->y - a->y) * (x - a->x);
 
-      clutter_layout_manager_get_preferred_width (priv->layout_manager,
-                                                  container,
-                                                  for_height,
-                                                  min_width_p,
-                                                  natural_width_p);
+      if (cross == 0.f)
+        continue;
 
-      return;
+      if (sign == 0)
+        sign = cross > 0.f ? 1 : -1;
+      else if ((cross > 0.f) != (sign > 0))
+        return FALSE;
     }
 
-  /* Default implementation is always 0x0, usually an actor
-   * using this default is relying on someone to set the
-   * request manually
-   */
-  CLUTTER_NOTE (LAYOUT, "Default preferred width: 0, 0");
+  /* a degenerate quad cannot contain anything */
+  return sign != 0;
+}
 
-  if (min_width_p)
-    *min_width_p = 0;
+static gboolean
+geometry_pick_box_contains (const ClutterGeometryPick *pick,
+                            const CoglMatrix          *modelview,
+                            float                      x1,
+                            float                      y1,
+                            float                      x2,
+                            float                      y2)
+{
+  ClutterVertex box[4], verts[4];
 
-  if (natural_width_p)
-    *natural_width_p = 0;
+  box[0].x = x1; box[0].y = y1; box[0].z = 0.f;
+  box[1].x = x2; box[1].y = y1; box[1].z = 0.f;
+  box[2].x = x1; box[2].y = y2; box[2].z = 0.f;
+  box[3].x = x2; box[3].y = y2; box[3].z = 0.f;
+
+  _clutter_util_fully_transform_vertices (modelview,
+                                          pick->projection,
+                                          pick->viewport,
+                                          box,
+                                          verts,
+                                          4);
+
+  /* the GPU pick samples the center of the pixel */
+  return point_in_projected_quad (verts, pick->x + 0.5f, pick->y + 0.5f);
 }
 
-static void
-clutter_actor_real_get_preferred_height (ClutterActor *self,
-                                         gfloat        for_width,
-                                         gfloat       *min_height_p,
-                                         gfloat       *natural_height_p)
+/* Checks whether the pick point lies within the clip of @self, if any */
+static gboolean
+geometry_pick_clip_contains (ClutterActor              *self,
+                             const ClutterGeometryPick *pick,
+                             const CoglMatrix          *modelview)
 {
   ClutterActorPrivate *priv = self->priv;
 
-  if (priv->n_children != 0 &&
-      priv->layout_manager != NULL)
-    {
-      ClutterContainer *container = CLUTTER_CONTAINER (self);
+  if (priv->has_clip)
+    return geometry_pick_box_contains (pick, modelview,
+                                       priv->clip.origin.x,
+                                       priv->clip.origin.y,
+                                       priv->clip.origin.x + priv->clip.size.width,
+                                       priv->clip.origin.y + priv->clip.size.height);
 
-      CLUTTER_NOTE (LAYOUT, "Querying the layout manager '%s'[%p] "
-                    "for the preferred height",
-                    G_OBJECT_TYPE_NAME (priv->layout_manager),
-                    priv->layout_manager);
+  if (priv->clip_to_allocation)
+    return geometry_pick_box_contains (pick, modelview,
+                                       0.f, 0.f,
+                                       clutter_actor_box_get_width (&priv->allocation),
+                                       clutter_actor_box_get_height (&priv->allocation));
 
-      clutter_layout_manager_get_preferred_height (priv->layout_manager,
-                                                   container,
-                                                   for_width,
-                                                   min_height_p,
-                                                   natural_height_p);
+  return TRUE;
+}
 
-      return;
-    }
-  /* Default implementation is always 0x0, usually an actor
-   * using this default is relying on someone to set the
-   * request manually
-   */
-  CLUTTER_NOTE (LAYOUT, "Default preferred height: 0, 0");
+/* Checks whether the silhouette painted by @self in pick mode may
+ * differ from its allocation box, in which case the geometric test
+ * is not reliable any more.
+ */
+static gboolean
+clutter_actor_has_custom_pick (ClutterActor *self)
+{
+  const GList *l;
 
-  if (min_height_p)
-    *min_height_p = 0;
+  if (CLUTTER_ACTOR_GET_CLASS (self)->pick != clutter_actor_real_pick)
+    return TRUE;
 
-  if (natural_height_p)
-    *natural_height_p = 0;
-}
+  if (self->priv->effects == NULL)
+    return FALSE;
 
-static void
-clutter_actor_store_old_geometry (ClutterActor    *self,
-                                  ClutterActorBox *box)
-{
-  *box = self->priv->allocation;
+  for (l = _clutter_meta_group_peek_metas (self->priv->effects);
+       l != NULL;
+       l = l->next)
+    {
+      ClutterEffect *effect = l->data;
+
+      if (clutter_actor_meta_get_enabled (l->data) &&
+          _clutter_effect_has_custom_pick (effect))
+        return TRUE;
+    }
+
+  return FALSE;
 }
 
-static inline void
-clutter_actor_notify_if_geometry_changed (ClutterActor          *self,
-                                          const ClutterActorBox *old)
+static gboolean
+clutter_actor_geometry_pick_internal (ClutterActor        *self,
+                                      const CoglMatrix    *parent_modelview,
+                                      ClutterGeometryPick *pick)
 {
   ClutterActorPrivate *priv = self->priv;
-  GObject *obj = G_OBJECT (self);
+  CoglMatrix modelview;
+  ClutterActor *iter;
+  float width, height;
 
-  g_object_freeze_notify (obj);
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self) || !CLUTTER_ACTOR_IS_MAPPED (self))
+    return TRUE;
 
-  /* to avoid excessive requisition or allocation cycles we
-   * use the cached values.
-   *
-   * - if we don't have an allocation we assume that we need
-   *   to notify anyway
-   * - if we don't have a width or a height request we notify
-   *   width and height
-   * - if we have a valid allocation then we check the old
-   *   bounding box with the current allocation and we notify
-   *   the changes
-   */
-  if (priv->needs_allocation)
-    {
-      g_object_notify_by_pspec (obj, obj_props[PROP_X]);
-      g_object_notify_by_pspec (obj, obj_props[PROP_Y]);
-      g_object_notify_by_pspec (obj, obj_props[PROP_POSITION]);
-      g_object_notify_by_pspec (obj, obj_props[PROP_WIDTH]);
-      g_object_notify_by_pspec (obj, obj_props[PROP_HEIGHT]);
-      g_object_notify_by_pspec (obj, obj_props[PROP_SIZE]);
-    }
-  else if (priv->needs_width_request || priv->needs_height_request)
-    {
-      g_object_notify_by_pspec (obj, obj_props[PROP_WIDTH]);
-      g_object_notify_by_pspec (obj, obj_props[PROP_HEIGHT]);
-      g_object_notify_by_pspec (obj, obj_props[PROP_SIZE]);
-    }
-  else
-    {
-      gfloat x, y;
-      gfloat width, height;
+  modelview = *parent_modelview;
+  if (priv->enable_model_view_transform)
+    _clutter_actor_apply_modelview_transform (self, &modelview);
 
-      x = priv->allocation.x1;
-      y = priv->allocation.y1;
-      width = priv->allocation.x2 - priv->allocation.x1;
-      height = priv->allocation.y2 - priv->allocation.y1;
+  width = priv->allocation.x2 - priv->allocation.x1;
+  height = priv->allocation.y2 - priv->allocation.y1;
 
-      if (x != old->x1)
-        {
-          g_object_notify_by_pspec (obj, obj_props[PROP_X]);
-          g_object_notify_by_pspec (obj, obj_props[PROP_POSITION]);
-        }
+  /* the clip applies to the actor and to all of its children, so we
+   * can discard the whole sub-tree if the point lies outside of it
+   */
+  if (!geometry_pick_clip_contains (self, pick, &modelview))
+    return TRUE;
 
-      if (y != old->y1)
-        {
-          g_object_notify_by_pspec (obj, obj_props[PROP_Y]);
-          g_object_notify_by_pspec (obj, obj_props[PROP_POSITION]);
-        }
+  /* actors overriding the pick() virtual, either directly or through
+   * an effect, can paint any shape; and if they have children, they
+   * control how those are painted as well. we bail out and let the
+   * stage perform a full pick render instead
+   */
+  if (clutter_actor_has_custom_pick (self))
+    {
+      if (priv->n_children != 0 ||
+          geometry_pick_box_contains (pick, &modelview,
+                                      0.f, 0.f,
+                                      width, height))
+        return FALSE;
 
-      if (width != (old->x2 - old->x1))
-        {
-          g_object_notify_by_pspec (obj, obj_props[PROP_WIDTH]);
-          g_object_notify_by_pspec (obj, obj_props[PROP_SIZE]);
-        }
+      return TRUE;
+    }
 
-      if (height != (old->y2 - old->y1))
-        {
-          g_object_notify_by_pspec (obj, obj_props[PROP_HEIGHT]);
-          g_object_notify_by_pspec (obj, obj_props[PROP_SIZE]);
-        }
+  /* children are painted after their parent, in order, which means
+   * that the last child is painted on top of everything else
+   */
+  for (iter = priv->last_child;
+       iter != NULL;
+       iter = iter->priv->prev_sibling)
+    {
+      if (!clutter_actor_geometry_pick_internal (iter, &modelview, pick))
+        return FALSE;
+
+      if (pick->hit != NULL)
+        return TRUE;
     }
 
-  g_object_thaw_notify (obj);
+  if ((pick->mode == CLUTTER_PICK_ALL || CLUTTER_ACTOR_IS_REACTIVE (self)) &&
+      geometry_pick_box_contains (pick, &modelview, 0.f, 0.f, width, height))
+    pick->hit = self;
+
+  return TRUE;
 }
 
 /*< private >
- * clutter_actor_set_allocation_internal:
- * @self: a #ClutterActor
- * @box: a #ClutterActorBox
- * @flags: allocation flags
- *
- * Stores the allocation of @self.
+ * _clutter_actor_geometry_pick:
+ * @self: the top-level #ClutterActor to pick from
+ * @pick: the pick state
  *
- * This function only performs basic storage and property notification.
+ * Walks the scene graph rooted in @self, testing the pick point
+ * against the projected allocation of each actor, in paint order,
+ * without rendering anything.
  *
- * This function should be called by clutter_actor_set_allocation()
- * and by the default implementation of #ClutterActorClass.allocate().
+ * The top-level actor is never picked by this function; if no
+ * child is hit, @pick's hit field is left untouched.
  *
- * Return value: %TRUE if the allocation of the #ClutterActor has been
- *   changed, and %FALSE otherwise
+ * Return value: %FALSE if the scene contains actors whose pick
+ *   silhouette cannot be determined geometrically, and thus a
+ *   pick render is required; %TRUE otherwise
  */
-static inline gboolean
-clutter_actor_set_allocation_internal (ClutterActor           *self,
-                                       const ClutterActorBox  *box,
-                                       ClutterAllocationFlags  flags)
+gboolean
+_clutter_actor_geometry_pick (ClutterActor        *self,
+                              ClutterGeometryPick *pick)
 {
-  ClutterActorPrivate *priv = self->priv;
-  GObject *obj;
-  gboolean x1_changed, y1_changed, x2_changed, y2_changed;
-  gboolean retval;
-  ClutterActorBox old_alloc = { 0, };
-
-  obj = G_OBJECT (self);
+  CoglMatrix modelview;
+  ClutterActor *iter;
 
-  g_object_freeze_notify (obj);
+  cogl_matrix_init_identity (&modelview);
+  _clutter_actor_apply_modelview_transform (self, &modelview);
 
-  clutter_actor_store_old_geometry (self, &old_alloc);
+  for (iter = self->priv->last_child;
+       iter != NULL;
+       iter = iter->priv->prev_sibling)
+    {
+      if (!clutter_actor_geometry_pick_internal (iter, &modelview, pick))
+        return FALSE;
 
-  x1_changed = priv->allocation.x1 != box->x1;
-  y1_changed = priv->allocation.y1 != box->y1;
-  x2_changed = priv->allocation.x2 != box->x2;
-  y2_changed = priv->allocation.y2 != box->y2;
+      if (pick->hit != NULL)
+        break;
+    }
 
-  priv->allocation = *box;
-  priv->allocation_flags = flags;
+  return TRUE;
+}
 
-  /* allocation is authoritative */
-  priv->needs_width_request = FALSE;
-  priv->needs_height_request = FALSE;
-  priv->needs_allocation = FALSE;
+/* Computes the modelview of @self, checking that none of its ancestors
+ * prevents @self from being picked at the pick point
+ */
+static ClutterGeometryPickResult
+geometry_pick_test_ancestors (ClutterActor        *self,
+                              ClutterGeometryPick *pick,
+                              CoglMatrix          *modelview)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterGeometryPickResult res;
 
-  if (x1_changed ||
-      y1_changed ||
-      x2_changed ||
-      y2_changed)
+  if (priv->parent == NULL)
     {
-      CLUTTER_NOTE (LAYOUT, "Allocation for '%s' changed",
-                    _clutter_actor_get_debug_name (self));
+      cogl_matrix_init_identity (modelview);
+      _clutter_actor_apply_modelview_transform (self, modelview);
 
-      priv->transform_valid = FALSE;
-
-      g_object_notify_by_pspec (obj, obj_props[PROP_ALLOCATION]);
+      return CLUTTER_GEOMETRY_PICK_HIT;
+    }
 
-      /* if the allocation changes, so does the content box */
-      if (priv->content != NULL)
-        {
-          priv->content_box_valid = FALSE;
-          g_object_notify_by_pspec (obj, obj_props[PROP_CONTENT_BOX]);
-        }
+  res = geometry_pick_test_ancestors (priv->parent, pick, modelview);
+  if (res != CLUTTER_GEOMETRY_PICK_HIT)
+    return res;
 
-      retval = TRUE;
-    }
-  else
-    retval = FALSE;
+  if (!CLUTTER_ACTOR_IS_MAPPED (self))
+    return CLUTTER_GEOMETRY_PICK_MISS;
 
-  clutter_actor_notify_if_geometry_changed (self, &old_alloc);
+  if (priv->enable_model_view_transform)
+    _clutter_actor_apply_modelview_transform (self, modelview);
 
-  g_object_thaw_notify (obj);
+  if (!geometry_pick_clip_contains (self, pick, modelview))
+    return CLUTTER_GEOMETRY_PICK_MISS;
 
-  return retval;
+  return CLUTTER_GEOMETRY_PICK_HIT;
 }
 
-static void clutter_actor_real_allocate (ClutterActor           *self,
-                                         const ClutterActorBox  *box,
-                                         ClutterAllocationFlags  flags);
-
-static inline void
-clutter_actor_maybe_layout_children (ClutterActor           *self,
-                                     const ClutterActorBox  *allocation,
-                                     ClutterAllocationFlags  flags)
+/*< private >
+ * _clutter_actor_geometry_pick_test:
+ * @self: a #ClutterActor
+ * @pick: the pick state
+ *
+ * Checks whether @self, and only @self, would be painted at the pick
+ * point when performing a pick render, without taking into account
+ * any other actor that may be painted on top of it.
+ *
+ * Return value: the result of the test; %CLUTTER_GEOMETRY_PICK_UNKNOWN
+ *   is returned if @self, or any of its ancestors, overrides the pick()
+ *   virtual function
+ */
+ClutterGeometryPickResult
+_clutter_actor_geometry_pick_test (ClutterActor        *self,
+                                   ClutterGeometryPick *pick)
 {
   ClutterActorPrivate *priv = self->priv;
+  ClutterGeometryPickResult res;
+  CoglMatrix modelview;
+  ClutterActor *iter;
 
-  /* this is going to be a bit hard to follow, so let's put an explanation
-   * here.
-   *
-   * we want ClutterActor to have a default layout manager if the actor was
-   * created using "g_object_new (CLUTTER_TYPE_ACTOR, NULL)".
-   *
-   * we also want any subclass of ClutterActor that does not override the
-   * ::allocate() virtual function to delegate to a layout manager.
-   *
-   * finally, we want to allow people subclassing ClutterActor and overriding
-   * the ::allocate() vfunc to let Clutter delegate to the layout manager.
-   *
-   * on the other hand, we want existing actor subclasses overriding the
-   * ::allocate() virtual function and chaining up to the parent's
-   * implementation to continue working without allocating their children
-   * twice, or without entering an allocation loop.
-   *
-   * for the first two points, we check if the class of the actor is
-   * overridding the ::allocate() virtual function; if it isn't, then we
-   * follow through with checking whether we have children and a layout
-   * manager, and eventually calling clutter_layout_manager_allocate().
-   *
-   * for the third point, we check the CLUTTER_DELEGATE_LAYOUT flag in the
-   * allocation flags that we got passed, and if it is present, we continue
-   * with the check above.
-   *
-   * if neither of these two checks yields a positive result, we just
-   * assume that the ::allocate() virtual function that resulted in this
-   * function being called will also allocate the children of the actor.
-   */
-
-  if (CLUTTER_ACTOR_GET_CLASS (self)->allocate == clutter_actor_real_allocate)
-    goto check_layout;
-
-  if ((flags & CLUTTER_DELEGATE_LAYOUT) != 0)
-    goto check_layout;
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self) || !CLUTTER_ACTOR_IS_MAPPED (self))
+    return CLUTTER_GEOMETRY_PICK_MISS;
 
-  return;
+  if (pick->mode != CLUTTER_PICK_ALL && !CLUTTER_ACTOR_IS_REACTIVE (self))
+    return CLUTTER_GEOMETRY_PICK_MISS;
 
-check_layout:
-  if (priv->n_children != 0 &&
-      priv->layout_manager != NULL)
+  /* ancestors overriding pick() decide how their children are painted */
+  for (iter = priv->parent;
+       iter != NULL && iter->priv->parent != NULL;
+       iter = iter->priv->parent)
     {
-      ClutterContainer *container = CLUTTER_CONTAINER (self);
-      ClutterAllocationFlags children_flags;
-      ClutterActorBox children_box;
+      if (clutter_actor_has_custom_pick (iter))
+        return CLUTTER_GEOMETRY_PICK_UNKNOWN;
+    }
 
-      /* normalize the box passed to the layout manager */
-      children_box.x1 = children_box.y1 = 0.f;
-      children_box.x2 = (allocation->x2 - allocation->x1);
-      children_box.y2 = (allocation->y2 - allocation->y1);
+  res = geometry_pick_test_ancestors (self, pick, &modelview);
+  if (res != CLUTTER_GEOMETRY_PICK_HIT)
+    return res;
 
-      /* remove the DELEGATE_LAYOUT flag; this won't be passed to
-       * the actor's children, since it refers only to the current
-       * actor's allocation.
-       */
-      children_flags = flags;
-      children_flags &= ~CLUTTER_DELEGATE_LAYOUT;
+  if (!geometry_pick_box_contains (pick, &modelview,
+                                   0.f, 0.f,
+                                   clutter_actor_box_get_width (&priv->allocation),
+                                   clutter_actor_box_get_height (&priv->allocation)))
+    return CLUTTER_GEOMETRY_PICK_MISS;
 
-      CLUTTER_NOTE (LAYOUT,
-                    "Allocating %d children of %s "
-                    "at { %.2f, %.2f - %.2f x %.2f } "
-                    "using %s",
-                    priv->n_children,
-                    _clutter_actor_get_debug_name (self),
-                    allocation->x1,
-                    allocation->y1,
-                    (allocation->x2 - allocation->x1),
-                    (allocation->y2 - allocation->y1),
-                    G_OBJECT_TYPE_NAME (priv->layout_manager));
+  if (clutter_actor_has_custom_pick (self))
+    return CLUTTER_GEOMETRY_PICK_UNKNOWN;
 
-      clutter_layout_manager_allocate (priv->layout_manager,
-                                       container,
-                                       &children_box,
-                                       children_flags);
-    }
+  return CLUTTER_GEOMETRY_PICK_HIT;
 }
 
-static void
-clutter_actor_real_allocate (ClutterActor           *self,
-                             const ClutterActorBox  *box,
-                             ClutterAllocationFlags  flags)
+/*< private >
+ * _clutter_actor_paints_before:
+ * @a: a #ClutterActor
+ * @b: a #ClutterActor
+ *
+ * Checks whether @a is painted before @b, when both actors are
+ * inside the same scene graph.
+ *
+ * Return value: %TRUE if @a is painted before @b
+ */
+gboolean
+_clutter_actor_paints_before (ClutterActor *a,
+                              ClutterActor *b)
 {
-  ClutterActorPrivate *priv = self->priv;
-  gboolean changed;
+  ClutterActor *iter;
+  gint depth_a = 0, depth_b = 0;
 
-  g_object_freeze_notify (G_OBJECT (self));
+  if (a == b)
+    return FALSE;
 
-  changed = clutter_actor_set_allocation_internal (self, box, flags);
+  for (iter = a->priv->parent; iter != NULL; iter = iter->priv->parent)
+    depth_a += 1;
 
-  /* we allocate our children before we notify changes in our geometry,
-   * so that people connecting to properties will be able to get valid
-   * data out of the sub-tree of the scene graph that has this actor at
-   * the root.
-   */
-  clutter_actor_maybe_layout_children (self, box, flags);
+  for (iter = b->priv->parent; iter != NULL; iter = iter->priv->parent)
+    depth_b += 1;
 
-  if (changed)
+  /* children are painted after their ancestors */
+  while (depth_a > depth_b)
     {
-      ClutterActorBox signal_box = priv->allocation;
-      ClutterAllocationFlags signal_flags = priv->allocation_flags;
+      a = a->priv->parent;
+      depth_a -= 1;
 
-      g_signal_emit (self, actor_signals[ALLOCATION_CHANGED], 0,
-                     &signal_box,
-                     signal_flags);
+      if (a == b)
+        return FALSE;
     }
 
-  g_object_thaw_notify (G_OBJECT (self));
-}
+  while (depth_b > depth_a)
+    {
+      b = b->priv->parent;
+      depth_b -= 1;
 
-static void
-_clutter_actor_signal_queue_redraw (ClutterActor *self,
-                                    ClutterActor *origin)
-{
-  /* no point in queuing a redraw on a destroyed actor */
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
-    return;
+      if (a == b)
+        return TRUE;
+    }
 
-  /* NB: We can't bail out early here if the actor is hidden in case
-   * the actor bas been cloned. In this case the clone will need to
-   * receive the signal so it can queue its own redraw.
-   */
+  while (a->priv->parent != b->priv->parent)
+    {
+      a = a->priv->parent;
+      b = b->priv->parent;
+    }
 
-  _clutter_actor_queue_redraw_on_clones (self);
+  /* siblings are painted in order */
+  for (iter = a->priv->next_sibling; iter != NULL; iter = iter->priv->next_sibling)
+    {
+      if (iter == b)
+        return TRUE;
+    }
 
-  /* calls klass->queue_redraw in default handler */
-  g_signal_emit (self, actor_signals[QUEUE_REDRAW], 0, origin);
+  return FALSE;
 }
 
-static void
-clutter_actor_real_queue_redraw (ClutterActor *self,
-                                 ClutterActor *origin)
+/* retrieves the window-space rectangle covered by the allocation of
+ * @self, if the transformation of @self keeps it axis-aligned
+ */
+static gboolean
+get_axis_aligned_box (ClutterActor    *self,
+                      ClutterActorBox *box)
 {
-  ClutterActor *parent;
+  ClutterVertex verts[4];
 
-  CLUTTER_NOTE (PAINT, "Redraw queued on '%s' (from: '%s')",
-                _clutter_actor_get_debug_name (self),
-                origin != NULL ? _clutter_actor_get_debug_name (origin)
-                               : "same actor");
+  clutter_actor_get_abs_allocation_vertices (self, verts);
 
-  /* no point in queuing a redraw on a destroyed actor */
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
-    return;
+  if (fabsf (verts[0].y - verts[1].y) > 0.01f ||
+      fabsf (verts[2].y - verts[3].y) > 0.01f ||
+      fabsf (verts[0].x - verts[2].x) > 0.01f ||
+      fabsf (verts[1].x - verts[3].x) > 0.01f)
+    return FALSE;
 
-  /* If the queue redraw is coming from a child then the actor has
-     become dirty and any queued effect is no longer valid */
-  if (self != origin)
-    {
-      self->priv->is_dirty = TRUE;
-      self->priv->effect_to_redraw = NULL;
-    }
+  box->x1 = MIN (verts[0].x, verts[3].x);
+  box->y1 = MIN (verts[0].y, verts[3].y);
+  box->x2 = MAX (verts[0].x, verts[3].x);
+  box->y2 = MAX (verts[0].y, verts[3].y);
 
-  /* If the actor isn't visible, we still had to emit the signal
-   * to allow for a ClutterClone, but the appearance of the parent
-   * won't change so we don't have to propagate up the hierarchy.
-   */
-  if (!CLUTTER_ACTOR_IS_VISIBLE (self))
-    return;
+  return TRUE;
+}
 
-  /* Although we could determine here that a full stage redraw
-   * has already been queued and immediately bail out, we actually
-   * guarantee that we will propagate a queue-redraw signal to our
-   * parent at least once so that it's possible to implement a
-   * container that tracks which of its children have queued a
-   * redraw.
-   */
-  if (self->priv->propagated_one_redraw)
-    {
-      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
-      if (stage != NULL &&
-          _clutter_stage_has_full_redraw_queued (CLUTTER_STAGE (stage)))
-        return;
-    }
+/* removes @occluder from @region, keeping the point inside @region;
+ * returns %FALSE if the point is inside @occluder
+ */
+static gboolean
+subtract_occluder (ClutterActorBox       *region,
+                   const ClutterActorBox *occluder,
+                   gfloat                 x,
+                   gfloat                 y)
+{
+  gfloat areas[4] = { -1.f, -1.f, -1.f, -1.f };
+  gfloat best_area = -1.f;
+  gint i, best = -1;
 
-  self->priv->propagated_one_redraw = TRUE;
+  if (occluder->x2 <= region->x1 || occluder->x1 >= region->x2 ||
+      occluder->y2 <= region->y1 || occluder->y1 >= region->y2)
+    return TRUE;
 
-  /* notify parents, if they are all visible eventually we'll
-   * queue redraw on the stage, which queues the redraw idle.
+  /* we can cut the region on each side of the point that does not
+   * intersect the occluder; we keep the cut with the largest area
    */
-  parent = clutter_actor_get_parent (self);
-  if (parent != NULL)
+  if (occluder->x1 > x)
+    areas[0] = (occluder->x1 - region->x1) * (region->y2 - region->y1);
+  if (occluder->x2 <= x)
+    areas[1] = (region->x2 - occluder->x2) * (region->y2 - region->y1);
+  if (occluder->y1 > y)
+    areas[2] = (region->x2 - region->x1) * (occluder->y1 - region->y1);
+  if (occluder->y2 <= y)
+    areas[3] = (region->x2 - region->x1) * (region->y2 - occluder->y2);
+
+  for (i = 0; i < 4; i++)
     {
-      /* this will go up recursively */
-      _clutter_actor_signal_queue_redraw (parent, origin);
+      if (areas[i] > best_area)
+        {
+          best_area = areas[i];
+          best = i;
+        }
     }
-}
 
-static void
-clutter_actor_real_queue_relayout (ClutterActor *self)
-{
-  ClutterActorPrivate *priv = self->priv;
+  switch (best)
+    {
+    case 0:
+      region->x2 = occluder->x1;
+      break;
 
-  /* no point in queueing a redraw on a destroyed actor */
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
-    return;
+    case 1:
+      region->x1 = occluder->x2;
+      break;
 
-  priv->needs_width_request  = TRUE;
-  priv->needs_height_request = TRUE;
-  priv->needs_allocation     = TRUE;
+    case 2:
+      region->y2 = occluder->y1;
+      break;
 
-  /* reset the cached size requests */
-  memset (priv->width_requests, 0,
-          N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
-  memset (priv->height_requests, 0,
-          N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
+    case 3:
+      region->y1 = occluder->y2;
+      break;
 
-  /* We need to go all the way up the hierarchy */
-  if (priv->parent != NULL)
-    _clutter_actor_queue_only_relayout (priv->parent);
+    default:
+      return FALSE;
+    }
+
+  return TRUE;
 }
 
-/**
- * clutter_actor_apply_relative_transform_to_point:
- * @self: A #ClutterActor
- * @ancestor: (allow-none): A #ClutterActor ancestor, or %NULL to use the
- *   default #ClutterStage
- * @point: A point as #ClutterVertex
- * @vertex: (out caller-allocates): The translated #ClutterVertex
- *
- * Transforms @point in coordinates relative to the actor into
- * ancestor-relative coordinates using the relevant transform
- * stack (i.e. scale, rotation, etc).
- *
- * If @ancestor is %NULL the ancestor will be the #ClutterStage. In
- * this case, the coordinates returned will be the coordinates on
- * the stage before the projection is applied. This is different from
- * the behaviour of clutter_actor_apply_transform_to_point().
- *
- *
+static gboolean
+subtract_subtree (ClutterActor    *stage,
+                  ClutterActor    *subtree,
+                  ClutterActorBox *region,
+                  gfloat           x,
+                  gfloat           y)
+{
+  const ClutterPaintVolume *volume;
+  ClutterPaintVolume stage_volume;
+  ClutterActorBox box;
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (subtree))
+    return TRUE;
+
+  volume = clutter_actor_get_paint_volume (subtree);
+  if (volume == NULL)
+    return FALSE;
+
+  _clutter_paint_volume_copy_static (volume, &stage_volume);
+  _clutter_paint_volume_get_stage_paint_box (&stage_volume,
+                                             CLUTTER_STAGE (stage),
+                                             &box);
+  clutter_paint_volume_free (&stage_volume);
+
+  return subtract_occluder (region, &box, x, y);
+}
+
+/*< private >
+ * _clutter_actor_get_pick_region:
+ * @self: a #ClutterActor, returned by a reactive pick at @x, @y
+ * @x: the X coordinate of the pick, in window coordinates
+ * @y: the Y coordinate of the pick, in window coordinates
+ * @region: (out): return location for the region
+ *
+ * Computes a rectangle containing the pick point, in window coordinates,
+ * inside which a reactive pick is guaranteed to return @self as long
+ * as the pick generation of the stage does not change.
+ *
+ * The rectangle is the part of the allocation of @self that is not
+ * covered by the actors painted after it; it can only be computed if
+ * @self and its ancestors are transformed in a way that keeps their
+ * allocation axis-aligned, and if they use the default pick.
+ *
+ * Return value: %TRUE if the region could be computed
  */
-void
-clutter_actor_apply_relative_transform_to_point (ClutterActor        *self,
-						 ClutterActor        *ancestor,
-						 const ClutterVertex *point,
-						 ClutterVertex       *vertex)
+gboolean
+_clutter_actor_get_pick_region (ClutterActor    *self,
+                                gfloat           x,
+                                gfloat           y,
+                                ClutterActorBox *region)
 {
-  gfloat w;
-  CoglMatrix matrix;
+  ClutterActor *stage, *iter, *child;
+  ClutterActorBox box;
 
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-  g_return_if_fail (ancestor == NULL || CLUTTER_IS_ACTOR (ancestor));
-  g_return_if_fail (point != NULL);
-  g_return_if_fail (vertex != NULL);
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL)
+    return FALSE;
 
-  *vertex = *point;
-  w = 1.0;
+  if (!get_axis_aligned_box (self, region))
+    return FALSE;
 
-  if (ancestor == NULL)
-    ancestor = _clutter_actor_get_stage_internal (self);
+  for (iter = self; iter != NULL; iter = iter->priv->parent)
+    {
+      /* the stage overrides pick() only to paint its children */
+      if (iter != stage && clutter_actor_has_custom_pick (iter))
+        return FALSE;
 
-  if (ancestor == NULL)
+      if (iter->priv->has_clip)
+        return FALSE;
+
+      /* the clip of the ancestors limits the region */
+      if (iter != self && iter->priv->clip_to_allocation)
+        {
+          if (!get_axis_aligned_box (iter, &box))
+            return FALSE;
+
+          region->x1 = MAX (region->x1, box.x1);
+          region->y1 = MAX (region->y1, box.y1);
+          region->x2 = MIN (region->x2, box.x2);
+          region->y2 = MIN (region->y2, box.y2);
+        }
+    }
+
+  /* the children of @self are painted on top of it */
+  for (child = self->priv->first_child;
+       child != NULL;
+       child = child->priv->next_sibling)
     {
-      *vertex = *point;
-      return;
+      if (!subtract_subtree (stage, child, region, x, y))
+        return FALSE;
     }
 
-  _clutter_actor_get_relative_transformation_matrix (self, ancestor, &matrix);
-  cogl_matrix_transform_point (&matrix, &vertex->x, &vertex->y, &vertex->z, &w);
+  /* and so are the later siblings of @self and of its ancestors */
+  for (iter = self; iter != stage; iter = iter->priv->parent)
+    {
+      for (child = iter->priv->next_sibling;
+           child != NULL;
+           child = child->priv->next_sibling)
+        {
+          if (!subtract_subtree (stage, child, region, x, y))
+            return FALSE;
+        }
+    }
+
+  return region->x1 <= x && x < region->x2 &&
+         region->y1 <= y && y < region->y2;
 }
 
-static gboolean
-_clutter_actor_fully_transform_vertices (ClutterActor *self,
-                                         const ClutterVertex *vertices_in,
-                                         ClutterVertex *vertices_out,
-                                         int n_vertices)
+static void
+clutter_actor_real_get_preferred_width (ClutterActor *self,
+                                        gfloat        for_height,
+                                        gfloat       *min_width_p,
+                                        gfloat       *natural_width_p)
 {
-  ClutterActor *stage;
-  CoglMatrix modelview;
-  CoglMatrix projection;
-  float viewport[4];
+  ClutterActorPrivate *priv = self->priv;
 
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
+  if (priv->n_children != 0 &&
+      priv->layout_manager != NULL)
+    {
+      ClutterContainer *container = CLUTTER_CONTAINER (self);
 
-  stage = _clutter_actor_get_stage_internal (self);
+      CLUTTER_NOTE (LAYOUT, "Querying the layout manager '%s'[%p] "
+                    "for the preferred width",
+                    G_OBJECT_TYPE_NAME (priv->layout_manager),
+                    priv->layout_manager);
 
-  /* We really can't do anything meaningful in this case so don't try
-   * to do any transform */
-  if (stage == NULL)
-    return FALSE;
+      clutter_layout_manager_get_preferred_width (priv->layout_manager,
+                                                  container,
+                                                  for_height,
+                                                  min_width_p,
+                                                  natural_width_p);
 
-  /* Note: we pass NULL as the ancestor because we don't just want the modelview
-   * that gets us to stage coordinates, we want to go all the way to eye
-   * coordinates */
-  _clutter_actor_apply_relative_transformation_matrix (self, NULL, &modelview);
+      return;
+    }
 
-  /* Fetch the projection and viewport */
-  _clutter_stage_get_projection_matrix (CLUTTER_STAGE (stage), &projection);
-  _clutter_stage_get_viewport (CLUTTER_STAGE (stage),
-                               &viewport[0],
-                               &viewport[1],
-                               &viewport[2],
-                               &viewport[3]);
+  /* Default implementation is always 0x0, usually an actor
+   * using this default is relying on someone to set the
+   * request manually
+   */
+  CLUTTER_NOTE (LAYOUT, "Default preferred width: 0, 0");
 
-  _clutter_util_fully_transform_vertices (&modelview,
-                                          &projection,
-                                          viewport,
-                                          vertices_in,
-                                          vertices_out,
-                                          n_vertices);
+  if (min_width_p)
+    *min_width_p = 0;
 
-  return TRUE;
+  if (natural_width_p)
+    *natural_width_p = 0;
 }
 
-/**
- * clutter_actor_apply_transform_to_point:
- * @self: A #ClutterActor
- * @point: A point as #ClutterVertex
- * @vertex: (out caller-allocates): The translated #ClutterVertex
- *
- * Transforms @point in coordinates relative to the actor
- * into screen-relative coordinates with the current actor
- * transformation (i.e. scale, rotation, etc)
- *
- *
- **/
-void
-clutter_actor_apply_transform_to_point (ClutterActor        *self,
-                                        const ClutterVertex *point,
-                                        ClutterVertex       *vertex)
+static void
+clutter_actor_real_get_preferred_height (ClutterActor *self,
+                                         gfloat        for_width,
+                                         gfloat       *min_height_p,
+                                         gfloat       *natural_height_p)
 {
-  g_return_if_fail (point != NULL);
-  g_return_if_fail (vertex != NULL);
-  _clutter_actor_fully_transform_vertices (self, point, vertex, 1);
+  ClutterActorPrivate *priv = self->priv;
+
+  if (priv->n_children != 0 &&
+      priv->layout_manager != NULL)
+    {
+      ClutterContainer *container = CLUTTER_CONTAINER (self);
+
+      CLUTTER_NOTE (LAYOUT, "Querying the layout manager '%s'[%p] "
+                    "for the preferred height",
+                    G_OBJECT_TYPE_NAME (priv->layout_manager),
+                    priv->layout_manager);
+
+      clutter_layout_manager_get_preferred_height (priv->layout_manager,
+                                                   container,
+                                                   for_width,
+                                                   min_height_p,
+                                                   natural_height_p);
+
+      return;
+    }
+  /* Default implementation is always 0x0, usually an actor
+   * using this default is relying on someone to set the
+   * request manually
+   */
+  CLUTTER_NOTE (LAYOUT, "Default preferred height: 0, 0");
+
+  if (min_height_p)
+    *min_height_p = 0;
+
+  if (natural_height_p)
+    *natural_height_p = 0;
 }
 
-/*
- * _clutter_actor_get_relative_transformation_matrix:
- * @self: The actor whose coordinate space you want to transform from.
- * @ancestor: The ancestor actor whose coordinate space you want to transform too
- *            or %NULL if you want to transform all the way to eye coordinates.
- * @matrix: A #CoglMatrix to store the transformation
- *
- * This gets a transformation @matrix that will transform coordinates from the
- * coordinate space of @self into the coordinate space of @ancestor.
- *
- * For example if you need a matrix that can transform the local actor
- * coordinates of @self into stage coordinates you would pass the actor's stage
- * pointer as the @ancestor.
- *
- * If you pass %NULL then the transformation will take you all the way through
- * to eye coordinates. This can be useful if you want to extract the entire
- * modelview transform that Clutter applies before applying the projection
- * transformation. If you want to explicitly set a modelview on a CoglFramebuffer
- * using cogl_set_modelview_matrix() for example then you would want a matrix
- * that transforms into eye coordinates.
- *
- * <note><para>This function explicitly initializes the given @matrix. If you just
- * want clutter to multiply a relative transformation with an existing matrix
- * you can use clutter_actor_apply_relative_transformation_matrix()
- * instead.</para></note>
- *
- */
-/* XXX: We should consider caching the stage relative modelview along with
- * the actor itself */
 static void
-_clutter_actor_get_relative_transformation_matrix (ClutterActor *self,
-                                                   ClutterActor *ancestor,
-                                                   CoglMatrix *matrix)
+clutter_actor_store_old_geometry (ClutterActor    *self,
+                                  ClutterActorBox *box)
 {
-  cogl_matrix_init_identity (matrix);
-
-  _clutter_actor_apply_relative_transformation_matrix (self, ancestor, matrix);
+  *box = self->priv->allocation;
 }
 
-/* Project the given @box into stage window coordinates, writing the
- * transformed vertices to @verts[]. */
-static gboolean
-_clutter_actor_transform_and_project_box (ClutterActor          *self,
-					  const ClutterActorBox *box,
-					  ClutterVertex          verts[])
+static inline void
+clutter_actor_notify_if_geometry_changed (ClutterActor          *self,
+                                          const ClutterActorBox *old)
 {
-  ClutterVertex box_vertices[4];
-
-  box_vertices[0].x = box->x1;
-  box_vertices[0].y = box->y1;
-  box_vertices[0].z = 0;
-  box_vertices[1].x = box->x2;
-  box_vertices[1].y = box->y1;
-  box_vertices[1].z = 0;
-  box_vertices[2].x = box->x1;
-  box_vertices[2].y = box->y2;
-  box_vertices[2].z = 0;
-  box_vertices[3].x = box->x2;
-  box_vertices[3].y = box->y2;
-  box_vertices[3].z = 0;
+  ClutterActorPrivate *priv = self->priv;
+  GObject *obj = G_OBJECT (self);
 
-  return
-    _clutter_actor_fully_transform_vertices (self, box_vertices, verts, 4);
-}
+  g_object_freeze_notify (obj);
 
-/**
- * clutter_actor_get_allocation_vertices:
- * @self: A #ClutterActor
- * @ancestor: (allow-none): A #ClutterActor to calculate the vertices
- *   against, or %NULL to use the #ClutterStage
- * @verts: (out) (array fixed-size=4) (element-type Clutter.Vertex): return
- *   location for an array of 4 #ClutterVertex in which to store the result
- *
- * Calculates the transformed coordinates of the four corners of the
- * actor in the plane of @ancestor. The returned vertices relate to
- * the #ClutterActorBox coordinates as follows:
- * <itemizedlist>
- *   <listitem><para>@verts[0] contains (x1, y1)</para></listitem>
- *   <listitem><para>@verts[1] contains (x2, y1)</para></listitem>
- *   <listitem><para>@verts[2] contains (x1, y2)</para></listitem>
- *   <listitem><para>@verts[3] contains (x2, y2)</para></listitem>
- * </itemizedlist>
- *
- * If @ancestor is %NULL the ancestor will be the #ClutterStage. In
- * this case, the coordinates returned will be the coordinates on
- * the stage before the projection is applied. This is different from
- * the behaviour of clutter_actor_get_abs_allocation_vertices().
- *
- *
- */
-void
-clutter_actor_get_allocation_vertices (ClutterActor  *self,
-                                       ClutterActor  *ancestor,
-                                       ClutterVertex  verts[])
-{
-  ClutterActorPrivate *priv;
-  ClutterActorBox box;
-  ClutterVertex vertices[4];
-  CoglMatrix modelview;
+  /* to avoid excessive requisition or allocation cycles we
+   * use the cached values.
+   *
+   * - if we don't have an allocation we assume that we need
+   *   to notify anyway
+   * - if we don't have a width or a height request we notify
+   *   width and height
+   * - if we have a valid allocation then we check the old
+   *   bounding box with the current allocation and we notify
+   *   the changes
+   */
+  if (priv->needs_allocation)
+    {
+      g_object_notify_by_pspec (obj, obj_props[PROP_X]);
+      g_object_notify_by_pspec (obj, obj_props[PROP_Y]);
+      g_object_notify_by_pspec (obj, obj_props[PROP_POSITION]);
+      g_object_notify_by_pspec (obj, obj_props[PROP_WIDTH]);
+      g_object_notify_by_pspec (obj, obj_props[PROP_HEIGHT]);
+      g_object_notify_by_pspec (obj, obj_props[PROP_SIZE]);
+    }
+  else if (priv->needs_width_request || priv->needs_height_request)
+    {
+      g_object_notify_by_pspec (obj, obj_props[PROP_WIDTH]);
+      g_object_notify_by_pspec (obj, obj_props[PROP_HEIGHT]);
+      g_object_notify_by_pspec (obj, obj_props[PROP_SIZE]);
+    }
+  else
+    {
+      gfloat x, y;
+      gfloat width, height;
 
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-  g_return_if_fail (ancestor == NULL || CLUTTER_IS_ACTOR (ancestor));
+      x = priv->allocation.x1;
+      y = priv->allocation.y1;
+      width = priv->allocation.x2 - priv->allocation.x1;
+      height = priv->allocation.y2 - priv->allocation.y1;
 
-  if (ancestor == NULL)
-    ancestor = _clutter_actor_get_stage_internal (self);
+      if (x != old->x1)
+        {
+          g_object_notify_by_pspec (obj, obj_props[PROP_X]);
+          g_object_notify_by_pspec (obj, obj_props[PROP_POSITION]);
+        }
 
-  /* Fallback to a NOP transform if the actor isn't parented under a
-   * stage. */
-  if (ancestor == NULL)
-    ancestor = self;
+      if (y != old->y1)
+        {
+          g_object_notify_by_pspec (obj, obj_props[PROP_Y]);
+          g_object_notify_by_pspec (obj, obj_props[PROP_POSITION]);
+        }
 
-  priv = self->priv;
+      if (width != (old->x2 - old->x1))
+        {
+          g_object_notify_by_pspec (obj, obj_props[PROP_WIDTH]);
+          g_object_notify_by_pspec (obj, obj_props[PROP_SIZE]);
+        }
 
-  /* if the actor needs to be allocated we force a relayout, so that
-   * we will have valid values to use in the transformations */
-  if (priv->needs_allocation)
-    {
-      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
-      if (stage)
-        _clutter_stage_maybe_relayout (stage);
-      else
+      if (height != (old->y2 - old->y1))
         {
-          box.x1 = box.y1 = 0;
-          /* The result isn't really meaningful in this case but at
-           * least try to do something *vaguely* reasonable... */
-          clutter_actor_get_size (self, &box.x2, &box.y2);
+          g_object_notify_by_pspec (obj, obj_props[PROP_HEIGHT]);
+          g_object_notify_by_pspec (obj, obj_props[PROP_SIZE]);
         }
     }
 
-  clutter_actor_get_allocation_box (self, &box);
+  g_object_thaw_notify (obj);
+}
 
-  vertices[0].x = box.x1;
-  vertices[0].y = box.y1;
-  vertices[0].z = 0;
-  vertices[1].x = box.x2;
-  vertices[1].y = box.y1;
-  vertices[1].z = 0;
-  vertices[2].x = box.x1;
-  vertices[2].y = box.y2;
-  vertices[2].z = 0;
-  vertices[3].x = box.x2;
-  vertices[3].y = box.y2;
-  vertices[3].z = 0;
+/* the geometry properties of an actor are notified at every allocation
+ * that changes them; the notifications are queued and dispatched even
+ * when nobody is listening, so they are skipped for actors that have
+ * no GObject::notify handler
+ */
+static inline gboolean
+clutter_actor_has_notify_handlers (ClutterActor *self)
+{
+  static guint notify_signal_id = 0;
 
-  _clutter_actor_get_relative_transformation_matrix (self, ancestor,
-                                                     &modelview);
+  if (G_UNLIKELY (notify_signal_id == 0))
+    notify_signal_id = g_signal_lookup ("notify", G_TYPE_OBJECT);
 
-  cogl_matrix_transform_points (&modelview,
-                                3,
-                                sizeof (ClutterVertex),
-                                vertices,
-                                sizeof (ClutterVertex),
-                                vertices,
-                                4);
+  if (G_OBJECT_GET_CLASS (self)->notify != NULL)
+    return TRUE;
+
+  return g_signal_has_handler_pending (self, notify_signal_id, 0, TRUE);
 }
 
-/**
- * clutter_actor_get_abs_allocation_vertices:
- * @self: A #ClutterActor
- * @verts: (out) (array fixed-size=4): Pointer to a location of an array
- *   of 4 #ClutterVertex where to store the result.
+/*< private >
+ * _clutter_actor_get_allocation_serial:
  *
- * Calculates the transformed screen coordinates of the four corners of
- * the actor; the returned vertices relate to the #ClutterActorBox
- * coordinates  as follows:
- * <itemizedlist>
- *   <listitem><para>v[0] contains (x1, y1)</para></listitem>
- *   <listitem><para>v[1] contains (x2, y1)</para></listitem>
- *   <listitem><para>v[2] contains (x1, y2)</para></listitem>
- *   <listitem><para>v[3] contains (x2, y2)</para></listitem>
- * </itemizedlist>
+ * Retrieves a counter that is incremented every time the allocation
+ * of an actor changes, which can be used to check whether anything
+ * moved during a relayout without tracking each actor.
+ *
+ * Return value: the allocation serial
+ */
+guint
+_clutter_actor_get_allocation_serial (void)
+{
+  return allocation_serial;
+}
+
+/*< private >
+ * _clutter_actor_get_last_allocation_serial:
+ * @self: a #ClutterActor
  *
+ * Retrieves the allocation serial of the last change of the
+ * allocation of @self.
  *
+ * Return value: the allocation serial, or 0 if the allocation of
+ *   @self never changed
  */
-void
-clutter_actor_get_abs_allocation_vertices (ClutterActor  *self,
-                                           ClutterVertex  verts[])
+guint
+_clutter_actor_get_last_allocation_serial (ClutterActor *self)
 {
-  ClutterActorPrivate *priv;
-  ClutterActorBox actor_space_allocation;
+  return self->priv->allocation_serial;
+}
 
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+/*< private >
+ * _clutter_actor_get_constraint_sources:
+ * @self: a #ClutterActor
+ * @sources: an array of #ClutterActor
+ *
+ * Adds the sources of the enabled constraints of @self to @sources;
+ * see _clutter_constraint_get_source().
+ */
+void
+_clutter_actor_get_constraint_sources (ClutterActor *self,
+                                       GPtrArray    *sources)
+{
+  const GList *l;
 
-  priv = self->priv;
+  if (self->priv->constraints == NULL)
+    return;
 
-  /* if the actor needs to be allocated we force a relayout, so that
-   * the actor allocation box will be valid for
-   * _clutter_actor_transform_and_project_box()
-   */
-  if (priv->needs_allocation)
+  for (l = _clutter_meta_group_peek_metas (self->priv->constraints);
+       l != NULL;
+       l = l->next)
     {
-      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
-      /* There's nothing meaningful we can do now */
-      if (!stage)
-        return;
+      ClutterActor *source;
 
-      _clutter_stage_maybe_relayout (stage);
-    }
+      if (!clutter_actor_meta_get_enabled (l->data))
+        continue;
 
-  /* NB: _clutter_actor_transform_and_project_box expects a box in the actor's
-   * own coordinate space... */
-  actor_space_allocation.x1 = 0;
-  actor_space_allocation.y1 = 0;
-  actor_space_allocation.x2 = priv->allocation.x2 - priv->allocation.x1;
-  actor_space_allocation.y2 = priv->allocation.y2 - priv->allocation.y1;
-  _clutter_actor_transform_and_project_box (self,
-					    &actor_space_allocation,
-					    verts);
+      source = _clutter_constraint_get_source (l->data);
+      if (source != NULL)
+        g_ptr_array_add (sources, source);
+    }
 }
 
-static void
-clutter_actor_real_apply_transform (ClutterActor  *self,
-                                    ClutterMatrix *matrix)
+/*< private >
+ * clutter_actor_set_allocation_internal:
+ * @self: a #ClutterActor
+ * @box: a #ClutterActorBox
+ * @flags: allocation flags
+ *
+ * Stores the allocation of @self.
+ *
+ * This function only performs basic storage and property notification.
+ *
+ * This function should be called by clutter_actor_set_allocation()
+ * and by the default implementation of #ClutterActorClass.allocate().
+ *
+ * Return value: %TRUE if the allocation of the #ClutterActor has been
+ *   changed, and %FALSE otherwise
+ */
+static inline gboolean
+clutter_actor_set_allocation_internal (ClutterActor           *self,
+                                       const ClutterActorBox  *box,
+                                       ClutterAllocationFlags  flags)
 {
   ClutterActorPrivate *priv = self->priv;
-  CoglMatrix *transform = &priv->transform;
-  const ClutterTransformInfo *info;
-  float pivot_x = 0.f, pivot_y = 0.f;
+  GObject *obj;
+  gboolean x1_changed, y1_changed, x2_changed, y2_changed;
+  gboolean notify;
+  gboolean retval;
+  ClutterActorBox old_alloc = { 0, };
 
-  /* we already have a cached transformation */
-  if (priv->transform_valid)
-    goto multiply_and_return;
+  obj = G_OBJECT (self);
 
-  info = _clutter_actor_get_transform_info_or_defaults (self);
+  notify = clutter_actor_has_notify_handlers (self);
+  if (notify)
+    g_object_freeze_notify (obj);
 
-  /* compute the pivot point given the allocated size */
-  pivot_x = (priv->allocation.x2 - priv->allocation.x1)
-          * info->pivot.x;
-  pivot_y = (priv->allocation.y2 - priv->allocation.y1)
-          * info->pivot.y;
-
-  CLUTTER_NOTE (PAINT,
-                "Allocation: (%.2f, %2.f), "
-                "pivot: (%.2f, %.2f), "
-                "translation: (%.2f, %.2f) -> "
-                "new origin: (%.2f, %.2f)",
-                priv->allocation.x1, priv->allocation.y1,
-                info->pivot.x, info->pivot.y,
-                info->translation.x, info->translation.y,
-                priv->allocation.x1 + pivot_x + info->translation.x,
-                priv->allocation.y1 + pivot_y + info->translation.y);
+  clutter_actor_store_old_geometry (self, &old_alloc);
 
-  /* we apply the :child-transform from the parent actor, if we have one */
-  if (priv->parent != NULL)
-    {
-      const ClutterTransformInfo *parent_info;
+  x1_changed = priv->allocation.x1 != box->x1;
+  y1_changed = priv->allocation.y1 != box->y1;
+  x2_changed = priv->allocation.x2 != box->x2;
+  y2_changed = priv->allocation.y2 != box->y2;
 
-      parent_info = _clutter_actor_get_transform_info_or_defaults (priv->parent);
-      clutter_matrix_init_from_matrix (transform, &(parent_info->child_transform));
-    }
-  else
-    clutter_matrix_init_identity (transform);
+  priv->allocation = *box;
+  priv->allocation_flags = flags;
 
-  /* if we have an overriding transformation, we use that, and get out */
-  if (info->transform_set)
-    {
-      /* we still need to apply the :allocation's origin and :pivot-point
-       * translations, since :transform is relative to the actor's coordinate
-       * space, and to the pivot point
-       */
-      cogl_matrix_translate (transform,
-                             priv->allocation.x1 + pivot_x,
-                             priv->allocation.y1 + pivot_y,
-                             info->pivot_z);
-      cogl_matrix_multiply (transform, transform, &info->transform);
-      goto roll_back_pivot;
-    }
+  /* allocation is authoritative */
+  priv->needs_width_request = FALSE;
+  priv->needs_height_request = FALSE;
+  priv->needs_allocation = FALSE;
 
-  /* basic translation: :allocation's origin and :z-position; instead
-   * of decomposing the pivot and translation info separate operations,
-   * we just compose everything into a single translation
-   */
-  cogl_matrix_translate (transform,
-                         priv->allocation.x1 + pivot_x + info->translation.x,
-                         priv->allocation.y1 + pivot_y + info->translation.y,
-                         info->z_position + info->pivot_z + info->translation.z);
+  /* actors do not have a paint volume while they need an allocation */
+  clutter_actor_queue_paint_volume_update (self);
 
-  /* because the rotation involves translations, we must scale
-   * before applying the rotations (if we apply the scale after
-   * the rotations, the translations included in the rotation are
-   * not scaled and so the entire object will move on the screen
-   * as a result of rotating it).
-   */
-  if (info->scale_x != 1.0 ||
-      info->scale_y != 1.0 ||
-      info->scale_z != 1.0)
+  if (x1_changed ||
+      y1_changed ||
+      x2_changed ||
+      y2_changed)
     {
-      cogl_matrix_scale (transform,
-                         info->scale_x,
-                         info->scale_y,
-                         info->scale_z);
-    }
-
-  if (info->rz_angle)
-    cogl_matrix_rotate (transform, info->rz_angle, 0.0, 0.0, 1.0);
-
-  if (info->ry_angle)
-    cogl_matrix_rotate (transform, info->ry_angle, 0.0, 1.0, 0.0);
+      CLUTTER_NOTE (LAYOUT, "Allocation for '%s' changed",
+                    _clutter_actor_get_debug_name (self));
 
-  if (info->rx_angle)
-    cogl_matrix_rotate (transform, info->rx_angle, 1.0, 0.0, 0.0);
+      clutter_actor_invalidate_transform (self);
+      clutter_actor_invalidate_pick (self);
+      clutter_actor_invalidate_paint_node (self);
 
-roll_back_pivot:
-  /* roll back the pivot translation */
-  if (pivot_x != 0.f || pivot_y != 0.f || info->pivot_z != 0.f)
-    cogl_matrix_translate (transform, -pivot_x, -pivot_y, -info->pivot_z);
+      priv->allocation_serial = ++allocation_serial;
 
-  /* we have a valid modelview */
-  priv->transform_valid = TRUE;
+      /* a new size changes the contents, even if the redraw was only
+       * queued on the parent
+       */
+      if (clutter_actor_box_get_width (&old_alloc) != clutter_actor_box_get_width (box) ||
+          clutter_actor_box_get_height (&old_alloc) != clutter_actor_box_get_height (box))
+        {
+          priv->is_dirty = TRUE;
+          priv->is_damaged = TRUE;
+          priv->effect_to_redraw = NULL;
+        }
 
-multiply_and_return:
-  cogl_matrix_multiply (matrix, matrix, &priv->transform);
-}
+      if (notify)
+        g_object_notify_by_pspec (obj, obj_props[PROP_ALLOCATION]);
 
-/* Applies the transforms associated with this actor to the given
- * matrix. */
-void
-_clutter_actor_apply_modelview_transform (ClutterActor  *self,
-                                          ClutterMatrix *matrix)
-{
-  CLUTTER_ACTOR_GET_CLASS (self)->apply_transform (self, matrix);
-}
+      /* if the allocation changes, so does the content box */
+      if (priv->content != NULL)
+        {
+          priv->content_box_valid = FALSE;
 
-/*
- * clutter_actor_apply_relative_transformation_matrix:
- * @self: The actor whose coordinate space you want to transform from.
- * @ancestor: The ancestor actor whose coordinate space you want to transform too
- *            or %NULL if you want to transform all the way to eye coordinates.
- * @matrix: A #ClutterMatrix to apply the transformation too.
- *
- * This multiplies a transform with @matrix that will transform coordinates
- * from the coordinate space of @self into the coordinate space of @ancestor.
- *
- * For example if you need a matrix that can transform the local actor
- * coordinates of @self into stage coordinates you would pass the actor's stage
- * pointer as the @ancestor.
- *
- * If you pass %NULL then the transformation will take you all the way through
- * to eye coordinates. This can be useful if you want to extract the entire
- * modelview transform that Clutter applies before applying the projection
- * transformation. If you want to explicitly set a modelview on a CoglFramebuffer
- * using cogl_set_modelview_matrix() for example then you would want a matrix
- * that transforms into eye coordinates.
- *
- * <note>This function doesn't initialize the given @matrix, it simply
- * multiplies the requested transformation matrix with the existing contents of
- * @matrix. You can use cogl_matrix_init_identity() to initialize the @matrix
- * before calling this function, or you can use
- * clutter_actor_get_relative_transformation_matrix() instead.</note>
- */
-void
-_clutter_actor_apply_relative_transformation_matrix (ClutterActor *self,
-                                                     ClutterActor *ancestor,
-                                                     CoglMatrix *matrix)
-{
-  ClutterActor *parent;
+          if (notify)
+            g_object_notify_by_pspec (obj, obj_props[PROP_CONTENT_BOX]);
+        }
 
-  /* Note we terminate before ever calling stage->apply_transform()
-   * since that would conceptually be relative to the underlying
-   * window OpenGL coordinates so we'd need a special @ancestor
-   * value to represent the fake parent of the stage. */
-  if (self == ancestor)
-    return;
+      retval = TRUE;
+    }
+  else
+    retval = FALSE;
 
-  parent = clutter_actor_get_parent (self);
+  if (notify)
+    {
+      clutter_actor_notify_if_geometry_changed (self, &old_alloc);
 
-  if (parent != NULL)
-    _clutter_actor_apply_relative_transformation_matrix (parent, ancestor,
-                                                         matrix);
+      g_object_thaw_notify (obj);
+    }
 
-  _clutter_actor_apply_modelview_transform (self, matrix);
+  return retval;
 }
 
-static void
-_clutter_actor_draw_paint_volume_full (ClutterActor *self,
-                                       ClutterPaintVolume *pv,
-                                       const char *label,
-                                       const CoglColor *color)
+static void clutter_actor_real_allocate (ClutterActor           *self,
+                                         const ClutterActorBox  *box,
+                                         ClutterAllocationFlags  flags);
+
+static inline void
+clutter_actor_maybe_layout_children (ClutterActor           *self,
+                                     const ClutterActorBox  *allocation,
+                                     ClutterAllocationFlags  flags)
 {
-  static CoglPipeline *outline = NULL;
-  CoglPrimitive *prim;
-  ClutterVertex line_ends[12 * 2];
-  int n_vertices;
-  CoglContext *ctx =
-    clutter_backend_get_cogl_context (clutter_get_default_backend ());
-  /* XXX: at some point we'll query this from the stage but we can't
-   * do that until the osx backend uses Cogl natively. */
-  CoglFramebuffer *fb = cogl_get_draw_framebuffer ();
+  ClutterActorPrivate *priv = self->priv;
 
-  if (outline == NULL)
-    outline = cogl_pipeline_new (ctx);
+  /* this is going to be a bit hard to follow, so let's put an explanation
+   * here.
+   *
+   * we want ClutterActor to have a default layout manager if the actor was
+   * created using "g_object_new (CLUTTER_TYPE_ACTOR, NULL)".
+   *
+   * we also want any subclass of ClutterActor that does not override the
+   * ::allocate() virtual function to delegate to a layout manager.
+   *
+   * finally, we want to allow people subclassing ClutterActor and overriding
+   * the ::allocate() vfunc to let Clutter delegate to the layout manager.
+   *
+   * on the other hand, we want existing actor subclasses overriding the
+   * ::allocate() virtual function and chaining up to the parent's
+   * implementation to continue working without allocating their children
+   * twice, or without entering an allocation loop.
+   *
+   * for the first two points, we check if the class of the actor is
+   * overridding the ::allocate() virtual function; if it isn't, then we
+   * follow through with checking whether we have children and a layout
+   * manager, and eventually calling clutter_layout_manager_allocate().
+   *
+   * for the third point, we check the CLUTTER_DELEGATE_LAYOUT flag in the
+   * allocation flags that we got passed, and if it is present, we continue
+   * with the check above.
+   *
+   * if neither of these two checks yields a positive result, we just
+   * assume that the ::allocate() virtual function that resulted in this
+   * function being called will also allocate the children of the actor.
+   */
 
-  _clutter_paint_volume_complete (pv);
+  if (CLUTTER_ACTOR_GET_CLASS (self)->allocate == clutter_actor_real_allocate)
+    goto check_layout;
 
-  n_vertices = pv->is_2d ? 4 * 2 : 12 * 2;
+  if ((flags & CLUTTER_DELEGATE_LAYOUT) != 0)
+    goto check_layout;
 
-  /* Front face */
-  line_ends[0] = pv->vertices[0]; line_ends[1] = pv->vertices[1];
-  line_ends[2] = pv->vertices[1]; line_ends[3] = pv->vertices[2];
-  line_ends[4] = pv->vertices[2]; line_ends[5] = pv->vertices[3];
-  line_ends[6] = pv->vertices[3]; line_ends[7] = pv->vertices[0];
+  return;
 
-  if (!pv->is_2d)
+check_layout:
+  if (priv->n_children != 0 &&
+      priv->layout_manager != NULL)
     {
-      /* Back face */
-      line_ends[8] = pv->vertices[4]; line_ends[9] = pv->vertices[5];
-      line_ends[10] = pv->vertices[5]; line_ends[11] = pv->vertices[6];
-      line_ends[12] = pv->vertices[6]; line_ends[13] = pv->vertices[7];
-      line_ends[14] = pv->vertices[7]; line_ends[15] = pv->vertices[4];
-
-      /* Lines connecting front face to back face */
-      line_ends[16] = pv->vertices[0]; line_ends[17] = pv->vertices[4];
-      line_ends[18] = pv->vertices[1]; line_ends[19] = pv->vertices[5];
-      line_ends[20] = pv->vertices[2]; line_ends[21] = pv->vertices[6];
-      line_ends[22] = pv->vertices[3]; line_ends[23] = pv->vertices[7];
-    }
-
-  prim = cogl_primitive_new_p3 (ctx, COGL_VERTICES_MODE_LINES,
-                                n_vertices,
-                                (CoglVertexP3 *)line_ends);
+      ClutterContainer *container = CLUTTER_CONTAINER (self);
+      ClutterAllocationFlags children_flags;
+      ClutterActorBox children_box;
 
-  cogl_pipeline_set_color (outline, color);
-  cogl_framebuffer_draw_primitive (fb, outline, prim);
-  cogl_object_unref (prim);
+      /* normalize the box passed to the layout manager */
+      children_box.x1 = children_box.y1 = 0.f;
+      children_box.x2 = (allocation->x2 - allocation->x1);
+      children_box.y2 = (allocation->y2 - allocation->y1);
 
-  if (label)
-    {
-      PangoLayout *layout;
-      layout = pango_layout_new (clutter_actor_get_pango_context (self));
-      pango_layout_set_text (layout, label, -1);
-      cogl_pango_render_layout (layout,
-                                pv->vertices[0].x,
-                                pv->vertices[0].y,
-                                color,
-                                0);
-      g_object_unref (layout);
+      /* remove the DELEGATE_LAYOUT flag; this won't be passed to
+       * the actor's children, since it refers only to the current
+       * actor's allocation.
+       */
+      children_flags = flags;
+      children_flags &= ~CLUTTER_DELEGATE_LAYOUT;
+
+      CLUTTER_NOTE (LAYOUT,
+                    "Allocating %d children of %s "
+                    "at { %.2f, %.2f - %.2f x %.2f } "
+                    "using %s",
+                    priv->n_children,
+                    _clutter_actor_get_debug_name (self),
+                    allocation->x1,
+                    allocation->y1,
+                    (allocation->x2 - allocation->x1),
+                    (allocation->y2 - allocation->y1),
+                    G_OBJECT_TYPE_NAME (priv->layout_manager));
+
+      clutter_layout_manager_allocate (priv->layout_manager,
+                                       container,
+                                       &children_box,
+                                       children_flags);
     }
 }
 
 static void
-_clutter_actor_draw_paint_volume (ClutterActor *self)
+clutter_actor_real_allocate (ClutterActor           *self,
+                             const ClutterActorBox  *box,
+                             ClutterAllocationFlags  flags)
 {
-  ClutterPaintVolume *pv;
-  CoglColor color;
-
-  pv = _clutter_actor_get_paint_volume_mutable (self);
-  if (!pv)
-    {
-      gfloat width, height;
-      ClutterPaintVolume fake_pv;
+  ClutterActorPrivate *priv = self->priv;
+  gboolean changed;
 
-      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
-      _clutter_paint_volume_init_static (&fake_pv, stage);
+  g_object_freeze_notify (G_OBJECT (self));
 
-      clutter_actor_get_size (self, &width, &height);
-      clutter_paint_volume_set_width (&fake_pv, width);
-      clutter_paint_volume_set_height (&fake_pv, height);
+  changed = clutter_actor_set_allocation_internal (self, box, flags);
 
-      cogl_color_init_from_4f (&color, 0, 0, 1, 1);
-      _clutter_actor_draw_paint_volume_full (self, &fake_pv,
-                                             _clutter_actor_get_debug_name (self),
-                                             &color);
+  /* we allocate our children before we notify changes in our geometry,
+   * so that people connecting to properties will be able to get valid
+   * data out of the sub-tree of the scene graph that has this actor at
+   * the root.
+   */
+  clutter_actor_maybe_layout_children (self, box, flags);
 
-      clutter_paint_volume_free (&fake_pv);
-    }
-  else
+  if (changed &&
+      g_signal_has_handler_pending (self, actor_signals[ALLOCATION_CHANGED],
+                                    0, FALSE))
     {
-      cogl_color_init_from_4f (&color, 0, 1, 0, 1);
-      _clutter_actor_draw_paint_volume_full (self, pv,
-                                             _clutter_actor_get_debug_name (self),
-                                             &color);
+      ClutterActorBox signal_box = priv->allocation;
+      ClutterAllocationFlags signal_flags = priv->allocation_flags;
+
+      g_signal_emit (self, actor_signals[ALLOCATION_CHANGED], 0,
+                     &signal_box,
+                     signal_flags);
     }
+
+  g_object_thaw_notify (G_OBJECT (self));
 }
 
 static void
-_clutter_actor_paint_cull_result (ClutterActor *self,
-                                  gboolean success,
-                                  ClutterCullResult result)
+_clutter_actor_signal_queue_redraw (ClutterActor *self,
+                                    ClutterActor *origin)
 {
-  ClutterPaintVolume *pv;
-  CoglColor color;
-
-  if (success)
-    {
-      if (result == CLUTTER_CULL_RESULT_IN)
-        cogl_color_init_from_4f (&color, 0, 1, 0, 1);
-      else if (result == CLUTTER_CULL_RESULT_OUT)
-        cogl_color_init_from_4f (&color, 0, 0, 1, 1);
-      else
-        cogl_color_init_from_4f (&color, 0, 1, 1, 1);
-    }
-  else
-    cogl_color_init_from_4f (&color, 1, 1, 1, 1);
-
-  if (success && (pv = _clutter_actor_get_paint_volume_mutable (self)))
-    _clutter_actor_draw_paint_volume_full (self, pv,
-                                           _clutter_actor_get_debug_name (self),
-                                           &color);
-  else
-    {
-      PangoLayout *layout;
-      char *label =
-        g_strdup_printf ("CULL FAILURE: %s", _clutter_actor_get_debug_name (self));
-      cogl_color_init_from_4f (&color, 1, 1, 1, 1);
-      cogl_set_source_color (&color);
+  /* no point in queuing a redraw on a destroyed actor */
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return;
 
-      layout = pango_layout_new (clutter_actor_get_pango_context (self));
-      pango_layout_set_text (layout, label, -1);
-      cogl_pango_render_layout (layout,
-                                0,
-                                0,
-                                &color,
-                                0);
-      g_free (label);
-      g_object_unref (layout);
-    }
-}
+  /* NB: We can't bail out early here if the actor is hidden in case
+   * the actor bas been cloned. In this case the clone will need to
+   * receive the signal so it can queue its own redraw.
+   */
 
-static int clone_paint_level = 0;
+  _clutter_actor_queue_redraw_on_clones (self);
 
-void
-_clutter_actor_push_clone_paint (void)
-{
-  clone_paint_level++;
+  /* calls klass->queue_redraw in default handler */
+  g_signal_emit (self, actor_signals[QUEUE_REDRAW], 0, origin);
 }
 
-void
-_clutter_actor_pop_clone_paint (void)
+static void
+clutter_actor_real_queue_redraw (ClutterActor *self,
+                                 ClutterActor *origin)
 {
-  clone_paint_level--;
-}
+  ClutterActor *parent;
 
-static gboolean
-in_clone_paint (void)
-{
-  return clone_paint_level > 0;
-}
+  CLUTTER_NOTE (PAINT, "Redraw queued on '%s' (from: '%s')",
+                _clutter_actor_get_debug_name (self),
+                origin != NULL ? _clutter_actor_get_debug_name (origin)
+                               : "same actor");
 
-/* Returns TRUE if the actor can be ignored */
-/* FIXME: we should return a ClutterCullResult, and
- * clutter_actor_paint should understand that a CLUTTER_CULL_RESULT_IN
- * means there's no point in trying to cull descendants of the current
- * node. */
-static gboolean
-cull_actor (ClutterActor *self, ClutterCullResult *result_out)
-{
-  ClutterActorPrivate *priv = self->priv;
-  ClutterActor *stage;
-  const ClutterPlane *stage_clip;
+  /* no point in queuing a redraw on a destroyed actor */
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return;
 
-  if (!priv->last_paint_volume_valid)
+  /* If the queue redraw is coming from a child then the actor has
+     become dirty and any queued effect is no longer valid */
+  if (self != origin)
     {
-      CLUTTER_NOTE (CLIPPING, "Bail from cull_actor without culling (%s): "
-                    "->last_paint_volume_valid == FALSE",
-                    _clutter_actor_get_debug_name (self));
-      return FALSE;
+      self->priv->is_dirty = TRUE;
+      self->priv->is_damaged = TRUE;
+      self->priv->effect_to_redraw = NULL;
     }
 
-  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_DISABLE_CULLING))
-    return FALSE;
+  /* If the actor isn't visible, we still had to emit the signal
+   * to allow for a ClutterClone, but the appearance of the parent
+   * won't change so we don't have to propagate up the hierarchy.
+   */
+  if (!CLUTTER_ACTOR_IS_VISIBLE (self))
+    return;
 
-  stage = _clutter_actor_get_stage_internal (self);
-  stage_clip = _clutter_stage_get_clip (CLUTTER_STAGE (stage));
-  if (G_UNLIKELY (!stage_clip))
+  /* Although we could determine here that a full stage redraw
+   * has already been queued and immediately bail out, we actually
+   * guarantee that we will propagate a queue-redraw signal to our
+   * parent at least once so that it's possible to implement a
+   * container that tracks which of its children have queued a
+   * redraw.
+   */
+  if (self->priv->propagated_one_redraw)
     {
-      CLUTTER_NOTE (CLIPPING, "Bail from cull_actor without culling (%s): "
-                    "No stage clip set",
-                    _clutter_actor_get_debug_name (self));
-      return FALSE;
+      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+      if (stage != NULL &&
+          _clutter_stage_has_full_redraw_queued (CLUTTER_STAGE (stage)))
+        return;
     }
 
-  if (cogl_get_draw_framebuffer () !=
-      _clutter_stage_get_active_framebuffer (CLUTTER_STAGE (stage)))
+  self->priv->propagated_one_redraw = TRUE;
+
+  /* notify parents, if they are all visible eventually we'll
+   * queue redraw on the stage, which queues the redraw idle.
+   */
+  parent = clutter_actor_get_parent (self);
+  if (parent != NULL)
     {
-      CLUTTER_NOTE (CLIPPING, "Bail from cull_actor without culling (%s): "
-                    "Current framebuffer doesn't correspond to stage",
-                    _clutter_actor_get_debug_name (self));
-      return FALSE;
+      /* this will go up recursively */
+      _clutter_actor_signal_queue_redraw (parent, origin);
     }
-
-  *result_out =
-    _clutter_paint_volume_cull (&priv->last_paint_volume, stage_clip);
-  return TRUE;
 }
 
 static void
-_clutter_actor_update_last_paint_volume (ClutterActor *self)
+clutter_actor_real_queue_relayout (ClutterActor *self)
 {
   ClutterActorPrivate *priv = self->priv;
-  const ClutterPaintVolume *pv;
 
-  if (priv->last_paint_volume_valid)
-    {
-      clutter_paint_volume_free (&priv->last_paint_volume);
-      priv->last_paint_volume_valid = FALSE;
-    }
+  /* no point in queueing a redraw on a destroyed actor */
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return;
 
-  pv = clutter_actor_get_paint_volume (self);
-  if (!pv)
-    {
-      CLUTTER_NOTE (CLIPPING, "Bail from update_last_paint_volume (%s): "
-                    "Actor failed to report a paint volume",
-                    _clutter_actor_get_debug_name (self));
-      return;
-    }
+  priv->needs_width_request  = TRUE;
+  priv->needs_height_request = TRUE;
+  priv->needs_allocation     = TRUE;
 
-  _clutter_paint_volume_copy_static (pv, &priv->last_paint_volume);
+  clutter_actor_queue_paint_volume_update (self);
 
-  _clutter_paint_volume_transform_relative (&priv->last_paint_volume,
-                                            NULL); /* eye coordinates */
+  /* reset the cached size requests */
+  if (priv->size_requests != NULL)
+    {
+      memset (priv->size_requests->width_requests, 0,
+              N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
+      memset (priv->size_requests->height_requests, 0,
+              N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
+    }
 
-  priv->last_paint_volume_valid = TRUE;
+  /* We need to go all the way up the hierarchy */
+  if (priv->parent != NULL)
+    _clutter_actor_queue_only_relayout (priv->parent);
 }
 
-guint32
-_clutter_actor_get_pick_id (ClutterActor *self)
+/**
+ * clutter_actor_apply_relative_transform_to_point:
+ * @self: A #ClutterActor
+ * @ancestor: (allow-none): A #ClutterActor ancestor, or %NULL to use the
+ *   default #ClutterStage
+ * @point: A point as #ClutterVertex
+ * @vertex: (out caller-allocates): The translated #ClutterVertex
+ *
+ * Transforms @point in coordinates relative to the actor into
+ * ancestor-relative coordinates using the relevant transform
+ * stack (i.e. scale, rotation, etc).
+ *
+ * If @ancestor is %NULL the ancestor will be the #ClutterStage. In
+ * this case, the coordinates returned will be the coordinates on
+ * the stage before the projection is applied. This is different from
+ * the behaviour of clutter_actor_apply_transform_to_point().
+ *
+ *
+ */
+void
+clutter_actor_apply_relative_transform_to_point (ClutterActor        *self,
+						 ClutterActor        *ancestor,
+						 const ClutterVertex *point,
+						 ClutterVertex       *vertex)
 {
-  if (self->priv->pick_id < 0)
-    return 0;
+  gfloat w;
+  CoglMatrix matrix;
 
-  return self->priv->pick_id;
-}
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (ancestor == NULL || CLUTTER_IS_ACTOR (ancestor));
+  g_return_if_fail (point != NULL);
+  g_return_if_fail (vertex != NULL);
 
-/* This is the same as clutter_actor_add_effect except that it doesn't
-   queue a redraw and it doesn't notify on the effect property */
-static void
-_clutter_actor_add_effect_internal (ClutterActor  *self,
-                                    ClutterEffect *effect)
-{
-  ClutterActorPrivate *priv = self->priv;
+  *vertex = *point;
+  w = 1.0;
 
-  if (priv->effects == NULL)
+  if (ancestor == NULL)
+    ancestor = _clutter_actor_get_stage_internal (self);
+
+  if (ancestor == NULL)
     {
-      priv->effects = g_object_new (CLUTTER_TYPE_META_GROUP, NULL);
-      priv->effects->actor = self;
+      *vertex = *point;
+      return;
     }
 
-  _clutter_meta_group_add_meta (priv->effects, CLUTTER_ACTOR_META (effect));
+  _clutter_actor_get_relative_transformation_matrix (self, ancestor, &matrix);
+  cogl_matrix_transform_point (&matrix, &vertex->x, &vertex->y, &vertex->z, &w);
 }
 
-/* This is the same as clutter_actor_remove_effect except that it doesn't
-   queue a redraw and it doesn't notify on the effect property */
-static void
-_clutter_actor_remove_effect_internal (ClutterActor  *self,
-                                       ClutterEffect *effect)
+static gboolean
+_clutter_actor_fully_transform_vertices (ClutterActor *self,
+                                         const ClutterVertex *vertices_in,
+                                         ClutterVertex *vertices_out,
+                                         int n_vertices)
 {
-  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *stage;
+  CoglMatrix modelview;
+  CoglMatrix projection;
+  float viewport[4];
 
-  if (priv->effects == NULL)
-    return;
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
 
-  _clutter_meta_group_remove_meta (priv->effects, CLUTTER_ACTOR_META (effect));
+  stage = _clutter_actor_get_stage_internal (self);
 
-  if (_clutter_meta_group_peek_metas (priv->effects) == NULL)
-    g_clear_object (&priv->effects);
-}
+  /* We really can't do anything meaningful in this case so don't try
+   * to do any transform */
+  if (stage == NULL)
+    return FALSE;
 
-static gboolean
-needs_flatten_effect (ClutterActor *self)
-{
-  ClutterActorPrivate *priv = self->priv;
+  /* Note: we pass NULL as the ancestor because we don't just want the modelview
+   * that gets us to stage coordinates, we want to go all the way to eye
+   * coordinates */
+  _clutter_actor_apply_relative_transformation_matrix (self, NULL, &modelview);
 
-  if (G_UNLIKELY (clutter_paint_debug_flags &
-                  CLUTTER_DEBUG_DISABLE_OFFSCREEN_REDIRECT))
-    return FALSE;
+  /* Fetch the projection and viewport */
+  _clutter_stage_get_projection_matrix (CLUTTER_STAGE (stage), &projection);
+  _clutter_stage_get_viewport (CLUTTER_STAGE (stage),
+                               &viewport[0],
+                               &viewport[1],
+                               &viewport[2],
+                               &viewport[3]);
 
-  if (priv->offscreen_redirect & CLUTTER_OFFSCREEN_REDIRECT_ALWAYS)
-    return TRUE;
-  else if (priv->offscreen_redirect & CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_OPACITY)
-    {
-      if (clutter_actor_get_paint_opacity (self) < 255 &&
-          clutter_actor_has_overlaps (self))
-        return TRUE;
-    }
+  _clutter_util_fully_transform_vertices (&modelview,
+                                          &projection,
+                                          viewport,
+                                          vertices_in,
+                                          vertices_out,
+                                          n_vertices);
 
-  return FALSE;
+  return TRUE;
 }
 
-static void
-add_or_remove_flatten_effect (ClutterActor *self)
+/**
+ * clutter_actor_apply_transform_to_point:
+ * @self: A #ClutterActor
+ * @point: A point as #ClutterVertex
+ * @vertex: (out caller-allocates): The translated #ClutterVertex
+ *
+ * Transforms @point in coordinates relative to the actor
+ * into screen-relative coordinates with the current actor
+ * transformation (i.e. scale, rotation, etc)
+ *
+ *
+ **/
+void
+clutter_actor_apply_transform_to_point (ClutterActor        *self,
+                                        const ClutterVertex *point,
+                                        ClutterVertex       *vertex)
 {
-  ClutterActorPrivate *priv = self->priv;
-
-  /* Add or remove the flatten effect depending on the
-     offscreen-redirect property. */
-  if (needs_flatten_effect (self))
-    {
-      if (priv->flatten_effect == NULL)
-        {
-          ClutterActorMeta *actor_meta;
-          gint priority;
-
-          priv->flatten_effect = _clutter_flatten_effect_new ();
-          /* Keep a reference to the effect so that we can queue
-             redraws from it */
-          g_object_ref_sink (priv->flatten_effect);
-
-          /* Set the priority of the effect to high so that it will
-             always be applied to the actor first. It uses an internal
-             priority so that it won't be visible to applications */
-          actor_meta = CLUTTER_ACTOR_META (priv->flatten_effect);
-          priority = CLUTTER_ACTOR_META_PRIORITY_INTERNAL_HIGH;
-          _clutter_actor_meta_set_priority (actor_meta, priority);
-
-          /* This will add the effect without queueing a redraw */
-          _clutter_actor_add_effect_internal (self, priv->flatten_effect);
-        }
-    }
-  else
-    {
-      if (priv->flatten_effect != NULL)
-        {
-          /* Destroy the effect so that it will lose its fbo cache of
-             the actor */
-          _clutter_actor_remove_effect_internal (self, priv->flatten_effect);
-          g_clear_object (&priv->flatten_effect);
-        }
-    }
+  g_return_if_fail (point != NULL);
+  g_return_if_fail (vertex != NULL);
+  _clutter_actor_fully_transform_vertices (self, point, vertex, 1);
 }
 
+/*
+ * _clutter_actor_get_relative_transformation_matrix:
+ * @self: The actor whose coordinate space you want to transform from.
+ * @ancestor: The ancestor actor whose coordinate space you want to transform too
+ *            or %NULL if you want to transform all the way to eye coordinates.
+ * @matrix: A #CoglMatrix to store the transformation
+ *
+ * This gets a transformation @matrix that will transform coordinates from the
+ * coordinate space of @self into the coordinate space of @ancestor.
+ *
+ * For example if you need a matrix that can transform the local actor
+ * coordinates of @self into stage coordinates you would pass the actor's stage
+ * pointer as the @ancestor.
+ *
+ * If you pass %NULL then the transformation will take you all the way through
+ * to eye coordinates. This can be useful if you want to extract the entire
+ * modelview transform that Clutter applies before applying the projection
+ * transformation. If you want to explicitly set a modelview on a CoglFramebuffer
+ * using cogl_set_modelview_matrix() for example then you would want a matrix
+ * that transforms into eye coordinates.
+ *
+ * <note><para>This function explicitly initializes the given @matrix. If you just
+ * want clutter to multiply a relative transformation with an existing matrix
+ * you can use clutter_actor_apply_relative_transformation_matrix()
+ * instead.</para></note>
+ *
+ */
+/* XXX: We should consider caching the stage relative modelview along with
+ * the actor itself */
 static void
-clutter_actor_real_paint (ClutterActor *actor)
+_clutter_actor_get_relative_transformation_matrix (ClutterActor *self,
+                                                   ClutterActor *ancestor,
+                                                   CoglMatrix *matrix)
 {
-  ClutterActorPrivate *priv = actor->priv;
-  ClutterActor *iter;
-
-  for (iter = priv->first_child;
-       iter != NULL;
-       iter = iter->priv->next_sibling)
-    {
-      CLUTTER_NOTE (PAINT, "Painting %s, child of %s, at { %.2f, %.2f - %.2f x %.2f }",
-                    _clutter_actor_get_debug_name (iter),
-                    _clutter_actor_get_debug_name (actor),
-                    iter->priv->allocation.x1,
-                    iter->priv->allocation.y1,
-                    iter->priv->allocation.x2 - iter->priv->allocation.x1,
-                    iter->priv->allocation.y2 - iter->priv->allocation.y1);
+  cogl_matrix_init_identity (matrix);
 
-      clutter_actor_paint (iter);
-    }
+  _clutter_actor_apply_relative_transformation_matrix (self, ancestor, matrix);
 }
 
+/* Project the given @box into stage window coordinates, writing the
+ * transformed vertices to @verts[]. */
 static gboolean
-clutter_actor_paint_node (ClutterActor     *actor,
-                          ClutterPaintNode *root)
+_clutter_actor_transform_and_project_box (ClutterActor          *self,
+					  const ClutterActorBox *box,
+					  ClutterVertex          verts[])
 {
-  ClutterActorPrivate *priv = actor->priv;
+  ClutterVertex box_vertices[4];
 
-  if (root == NULL)
-    return FALSE;
+  box_vertices[0].x = box->x1;
+  box_vertices[0].y = box->y1;
+  box_vertices[0].z = 0;
+  box_vertices[1].x = box->x2;
+  box_vertices[1].y = box->y1;
+  box_vertices[1].z = 0;
+  box_vertices[2].x = box->x1;
+  box_vertices[2].y = box->y2;
+  box_vertices[2].z = 0;
+  box_vertices[3].x = box->x2;
+  box_vertices[3].y = box->y2;
+  box_vertices[3].z = 0;
 
-  if (priv->bg_color_set &&
-      !clutter_color_equal (&priv->bg_color, CLUTTER_COLOR_Transparent))
-    {
-      ClutterPaintNode *node;
-      ClutterColor bg_color;
-      ClutterActorBox box;
+  return
+    _clutter_actor_fully_transform_vertices (self, box_vertices, verts, 4);
+}
 
-      box.x1 = 0.f;
-      box.y1 = 0.f;
-      box.x2 = clutter_actor_box_get_width (&priv->allocation);
-      box.y2 = clutter_actor_box_get_height (&priv->allocation);
-
-      bg_color = priv->bg_color;
-      bg_color.alpha = clutter_actor_get_paint_opacity_internal (actor)
-                     * priv->bg_color.alpha
-                     / 255;
+/**
+ * clutter_actor_get_allocation_vertices:
+ * @self: A #ClutterActor
+ * @ancestor: (allow-none): A #ClutterActor to calculate the vertices
+ *   against, or %NULL to use the #ClutterStage
+ * @verts: (out) (array fixed-size=4) (element-type Clutter.Vertex): return
+ *   location for an array of 4 #ClutterVertex in which to store the result
+ *
+ * Calculates the transformed coordinates of the four corners of the
+ * actor in the plane of @ancestor. The returned vertices relate to
+ * the #ClutterActorBox coordinates as follows:
+ * <itemizedlist>
+ *   <listitem><para>@verts[0] contains (x1, y1)</para></listitem>
+ *   <listitem><para>@verts[1] contains (x2, y1)</para></listitem>
+ *   <listitem><para>@verts[2] contains (x1, y2)</para></listitem>
+ *   <listitem><para>@verts[3] contains (x2, y2)</para></listitem>
+ * </itemizedlist>
+ *
+ * If @ancestor is %NULL the ancestor will be the #ClutterStage. In
+ * this case, the coordinates returned will be the coordinates on
+ * the stage before the projection is applied. This is different from
+ * the behaviour of clutter_actor_get_abs_allocation_vertices().
+ *
+ *
+ */
+void
+clutter_actor_get_allocation_vertices (ClutterActor  *self,
+                                       ClutterActor  *ancestor,
+                                       ClutterVertex  verts[])
+{
+  ClutterActorPrivate *priv;
+  ClutterActorBox box;
+  ClutterVertex vertices[4];
+  CoglMatrix modelview;
 
-      node = clutter_color_node_new (&bg_color);
-      clutter_paint_node_set_name (node, "backgroundColor");
-      clutter_paint_node_add_rectangle (node, &box);
-      clutter_paint_node_add_child (root, node);
-      clutter_paint_node_unref (node);
-    }
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (ancestor == NULL || CLUTTER_IS_ACTOR (ancestor));
 
-  if (priv->content != NULL)
-    _clutter_content_paint_content (priv->content, actor, root);
+  if (ancestor == NULL)
+    ancestor = _clutter_actor_get_stage_internal (self);
 
-  if (CLUTTER_ACTOR_GET_CLASS (actor)->paint_node != NULL)
-    CLUTTER_ACTOR_GET_CLASS (actor)->paint_node (actor, root);
+  /* Fallback to a NOP transform if the actor isn't parented under a
+   * stage. */
+  if (ancestor == NULL)
+    ancestor = self;
 
-  if (clutter_paint_node_get_n_children (root) == 0)
-    return FALSE;
+  priv = self->priv;
 
-#ifdef CLUTTER_ENABLE_DEBUG
-  if (CLUTTER_HAS_DEBUG (PAINT))
+  /* if the actor needs to be allocated we force a relayout, so that
+   * we will have valid values to use in the transformations */
+  if (priv->needs_allocation)
     {
-      /* dump the tree only if we have one */
-      _clutter_paint_node_dump_tree (root);
+      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+      if (stage)
+        _clutter_stage_maybe_relayout (stage);
+      else
+        {
+          box.x1 = box.y1 = 0;
+          /* The result isn't really meaningful in this case but at
+           * least try to do something *vaguely* reasonable... */
+          clutter_actor_get_size (self, &box.x2, &box.y2);
+        }
     }
-#endif /* CLUTTER_ENABLE_DEBUG */
 
-  _clutter_paint_node_paint (root);
+  clutter_actor_get_allocation_box (self, &box);
 
-  return TRUE;
+  vertices[0].x = box.x1;
+  vertices[0].y = box.y1;
+  vertices[0].z = 0;
+  vertices[1].x = box.x2;
+  vertices[1].y = box.y1;
+  vertices[1].z = 0;
+  vertices[2].x = box.x1;
+  vertices[2].y = box.y2;
+  vertices[2].z = 0;
+  vertices[3].x = box.x2;
+  vertices[3].y = box.y2;
+  vertices[3].z = 0;
+
+  _clutter_actor_get_relative_transformation_matrix (self, ancestor,
+                                                     &modelview);
+
+  cogl_matrix_transform_points (&modelview,
+                                3,
+                                sizeof (ClutterVertex),
+                                vertices,
+                                sizeof (ClutterVertex),
+                                vertices,
+                                4);
 }
 
 /**
- * clutter_actor_paint:
+ * clutter_actor_get_abs_allocation_vertices:
  * @self: A #ClutterActor
+ * @verts: (out) (array fixed-size=4): Pointer to a location of an array
+ *   of 4 #ClutterVertex where to store the result.
  *
- * Renders the actor to display.
- *
- * This function should not be called directly by applications.
- * Call clutter_actor_queue_redraw() to queue paints, instead.
- *
- * This function is context-aware, and will either cause a
- * regular paint or a pick paint.
+ * Calculates the transformed screen coordinates of the four corners of
+ * the actor; the returned vertices relate to the #ClutterActorBox
+ * coordinates  as follows:
+ * <itemizedlist>
+ *   <listitem><para>v[0] contains (x1, y1)</para></listitem>
+ *   <listitem><para>v[1] contains (x2, y1)</para></listitem>
+ *   <listitem><para>v[2] contains (x1, y2)</para></listitem>
+ *   <listitem><para>v[3] contains (x2, y2)</para></listitem>
+ * </itemizedlist>
  *
- * This function will emit the #ClutterActor::paint signal or
- * the #ClutterActor::pick signal, depending on the context.
  *
- * This function does not paint the actor if the actor is set to 0,
- * unless it is performing a pick paint.
  */
 void
-clutter_actor_paint (ClutterActor *self)
+clutter_actor_get_abs_allocation_vertices (ClutterActor  *self,
+                                           ClutterVertex  verts[])
 {
   ClutterActorPrivate *priv;
-  ClutterPickMode pick_mode;
-  gboolean clip_set = FALSE;
-
-  CLUTTER_STATIC_COUNTER (actor_paint_counter,
-                          "Actor real-paint counter",
-                          "Increments each time any actor is painted",
-                          0 /* no application private data */);
-  CLUTTER_STATIC_COUNTER (actor_pick_counter,
-                          "Actor pick-paint counter",
-                          "Increments each time any actor is painted "
-                          "for picking",
-                          0 /* no application private data */);
+  ClutterActorBox actor_space_allocation;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
-    return;
-
   priv = self->priv;
 
-  pick_mode = _clutter_context_get_pick_mode ();
-
-  if (pick_mode == CLUTTER_PICK_NONE)
-    priv->propagated_one_redraw = FALSE;
-
-  /* It's an important optimization that we consider painting of
-   * actors with 0 opacity to be a NOP... */
-  if (pick_mode == CLUTTER_PICK_NONE &&
-      /* ignore top-levels, since they might be transparent */
-      !CLUTTER_ACTOR_IS_TOPLEVEL (self) &&
-      /* Use the override opacity if its been set */
-      ((priv->opacity_override >= 0) ?
-       priv->opacity_override : priv->opacity) == 0)
-    return;
-
-  /* if we aren't paintable (not in a toplevel with all
-   * parents paintable) then do nothing.
+  /* if the actor needs to be allocated we force a relayout, so that
+   * the actor allocation box will be valid for
+   * _clutter_actor_transform_and_project_box()
    */
-  if (!CLUTTER_ACTOR_IS_MAPPED (self))
-    return;
+  if (priv->needs_allocation)
+    {
+      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+      /* There's nothing meaningful we can do now */
+      if (!stage)
+        return;
 
-  /* mark that we are in the paint process */
-  CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IN_PAINT);
+      _clutter_stage_maybe_relayout (stage);
+    }
 
-  cogl_push_matrix();
+  /* NB: _clutter_actor_transform_and_project_box expects a box in the actor's
+   * own coordinate space... */
+  actor_space_allocation.x1 = 0;
+  actor_space_allocation.y1 = 0;
+  actor_space_allocation.x2 = priv->allocation.x2 - priv->allocation.x1;
+  actor_space_allocation.y2 = priv->allocation.y2 - priv->allocation.y1;
+  _clutter_actor_transform_and_project_box (self,
+					    &actor_space_allocation,
+					    verts);
+}
 
-  if (priv->enable_model_view_transform)
-    {
-      CoglMatrix matrix;
+static void
+clutter_actor_real_apply_transform (ClutterActor  *self,
+                                    ClutterMatrix *matrix)
+{
+  ClutterActorPrivate *priv = self->priv;
+  CoglMatrix *transform = &priv->transform;
+  const ClutterTransformInfo *info;
+  float pivot_x = 0.f, pivot_y = 0.f;
 
-      /* XXX: It could be better to cache the modelview with the actor
-       * instead of progressively building up the transformations on
-       * the matrix stack every time we paint. */
-      cogl_get_modelview_matrix (&matrix);
-      _clutter_actor_apply_modelview_transform (self, &matrix);
+  /* we already have a cached transformation */
+  if (priv->transform_valid)
+    goto multiply_and_return;
 
-#ifdef CLUTTER_ENABLE_DEBUG
-      /* Catch when out-of-band transforms have been made by actors not as part
-       * of an apply_transform vfunc... */
-      if (G_UNLIKELY (clutter_debug_flags & CLUTTER_DEBUG_OOB_TRANSFORMS))
-        {
-          CoglMatrix expected_matrix;
+  info = _clutter_actor_get_transform_info_or_defaults (self);
 
-          _clutter_actor_get_relative_transformation_matrix (self, NULL,
-                                                             &expected_matrix);
+  /* compute the pivot point given the allocated size */
+  pivot_x = (priv->allocation.x2 - priv->allocation.x1)
+          * info->pivot.x;
+  pivot_y = (priv->allocation.y2 - priv->allocation.y1)
+          * info->pivot.y;
 
-          if (!cogl_matrix_equal (&matrix, &expected_matrix))
-            {
-              GString *buf = g_string_sized_new (1024);
-              ClutterActor *parent;
+  CLUTTER_NOTE (PAINT,
+                "Allocation: (%.2f, %2.f), "
+                "pivot: (%.2f, %.2f), "
+                "translation: (%.2f, %.2f) -> "
+                "new origin: (%.2f, %.2f)",
+                priv->allocation.x1, priv->allocation.y1,
+                info->pivot.x, info->pivot.y,
+                info->translation.x, info->translation.y,
+                priv->allocation.x1 + pivot_x + info->translation.x,
+                priv->allocation.y1 + pivot_y + info->translation.y);
 
-              parent = self;
-              while (parent != NULL)
-                {
-                  g_string_append (buf, _clutter_actor_get_debug_name (parent));
+  /* we apply the :child-transform from the parent actor, if we have one */
+  if (priv->parent != NULL)
+    {
+      const ClutterTransformInfo *parent_info;
 
-                  if (parent->priv->parent != NULL)
-                    g_string_append (buf, "->");
+      parent_info = _clutter_actor_get_transform_info_or_defaults (priv->parent);
+      clutter_matrix_init_from_matrix (transform, &(parent_info->child_transform));
+    }
+  else
+    clutter_matrix_init_identity (transform);
 
-                  parent = parent->priv->parent;
-                }
-
-              g_warning ("Unexpected transform found when painting actor "
-                         "\"%s\". This will be caused by one of the actor's "
-                         "ancestors (%s) using the Cogl API directly to transform "
-                         "children instead of using ::apply_transform().",
-                         _clutter_actor_get_debug_name (self),
-                         buf->str);
-
-              g_string_free (buf, TRUE);
-            }
-        }
-#endif /* CLUTTER_ENABLE_DEBUG */
-
-      cogl_set_modelview_matrix (&matrix);
+  /* if we have an overriding transformation, we use that, and get out */
+  if (info->transform_set)
+    {
+      /* we still need to apply the :allocation's origin and :pivot-point
+       * translations, since :transform is relative to the actor's coordinate
+       * space, and to the pivot point
+       */
+      cogl_matrix_translate (transform,
+                             priv->allocation.x1 + pivot_x,
+                             priv->allocation.y1 + pivot_y,
+                             info->pivot_z);
+      cogl_matrix_multiply (transform, transform, &info->transform);
+      goto roll_back_pivot;
     }
 
-  if (priv->has_clip)
+  /* basic translation: :allocation's origin and :z-position; instead
+   * of decomposing the pivot and translation info separate operations,
+   * we just compose everything into a single translation
+   */
+  cogl_matrix_translate (transform,
+                         priv->allocation.x1 + pivot_x + info->translation.x,
+                         priv->allocation.y1 + pivot_y + info->translation.y,
+                         info->z_position + info->pivot_z + info->translation.z);
+
+  /* because the rotation involves translations, we must scale
+   * before applying the rotations (if we apply the scale after
+   * the rotations, the translations included in the rotation are
+   * not scaled and so the entire object will move on the screen
+   * as a result of rotating it).
+   */
+  if (info->scale_x != 1.0 ||
+      info->scale_y != 1.0 ||
+      info->scale_z != 1.0)
     {
-      cogl_clip_push_rectangle (priv->clip.origin.x,
-                                priv->clip.origin.y,
-                                priv->clip.origin.x + priv->clip.size.width,
-                                priv->clip.origin.y + priv->clip.size.height);
-      clip_set = TRUE;
+      cogl_matrix_scale (transform,
+                         info->scale_x,
+                         info->scale_y,
+                         info->scale_z);
     }
-  else if (priv->clip_to_allocation)
-    {
-      gfloat width, height;
 
-      width  = priv->allocation.x2 - priv->allocation.x1;
-      height = priv->allocation.y2 - priv->allocation.y1;
+  if (info->rz_angle)
+    cogl_matrix_rotate (transform, info->rz_angle, 0.0, 0.0, 1.0);
 
-      cogl_clip_push_rectangle (0, 0, width, height);
-      clip_set = TRUE;
-    }
+  if (info->ry_angle)
+    cogl_matrix_rotate (transform, info->ry_angle, 0.0, 1.0, 0.0);
 
-  if (pick_mode == CLUTTER_PICK_NONE)
-    {
-      CLUTTER_COUNTER_INC (_clutter_uprof_context, actor_paint_counter);
+  if (info->rx_angle)
+    cogl_matrix_rotate (transform, info->rx_angle, 1.0, 0.0, 0.0);
 
-      /* We check whether we need to add the flatten effect before
-         each paint so that we can avoid having a mechanism for
-         applications to notify when the value of the
-         has_overlaps virtual changes. */
-      add_or_remove_flatten_effect (self);
-    }
-  else
-    CLUTTER_COUNTER_INC (_clutter_uprof_context, actor_pick_counter);
+roll_back_pivot:
+  /* roll back the pivot translation */
+  if (pivot_x != 0.f || pivot_y != 0.f || info->pivot_z != 0.f)
+    cogl_matrix_translate (transform, -pivot_x, -pivot_y, -info->pivot_z);
 
-  /* We save the current paint volume so that the next time the
-   * actor queues a redraw we can constrain the redraw to just
-   * cover the union of the new bounding box and the old.
-   *
-   * We also fetch the current paint volume to perform culling so
-   * we can avoid painting actors outside the current clip region.
-   *
-   * If we are painting inside a clone, we should neither update
-   * the paint volume or use it to cull painting, since the paint
-   * box represents the location of the source actor on the
-   * screen.
-   *
-   * XXX: We are starting to do a lot of vertex transforms on
-   * the CPU in a typical paint, so at some point we should
-   * audit these and consider caching some things.
-   *
-   * NB: We don't perform culling while picking at this point because
-   * clutter-stage.c doesn't setup the clipping planes appropriately.
-   *
-   * NB: We don't want to update the last-paint-volume during picking
-   * because the last-paint-volume is used to determine the old screen
-   * space location of an actor that has moved so we can know the
-   * minimal region to redraw to clear an old view of the actor. If we
-   * update this during picking then by the time we come around to
-   * paint then the last-paint-volume would likely represent the new
-   * actor position not the old.
-   */
-  if (!in_clone_paint () && pick_mode == CLUTTER_PICK_NONE)
-    {
-      gboolean success;
-      /* annoyingly gcc warns if uninitialized even though
-       * the initialization is redundant :-( */
-      ClutterCullResult result = CLUTTER_CULL_RESULT_IN;
+  /* we have a valid modelview */
+  priv->transform_valid = TRUE;
 
-      if (G_LIKELY ((clutter_paint_debug_flags &
-                     (CLUTTER_DEBUG_DISABLE_CULLING |
-                      CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS)) !=
-                    (CLUTTER_DEBUG_DISABLE_CULLING |
-                     CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS)))
-        _clutter_actor_update_last_paint_volume (self);
+multiply_and_return:
+  cogl_matrix_multiply (matrix, matrix, &priv->transform);
+}
 
-      success = cull_actor (self, &result);
+/* Applies the transforms associated with this actor to the given
+ * matrix. */
+void
+_clutter_actor_apply_modelview_transform (ClutterActor  *self,
+                                          ClutterMatrix *matrix)
+{
+  CLUTTER_ACTOR_GET_CLASS (self)->apply_transform (self, matrix);
+}
 
-      if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_REDRAWS))
-        _clutter_actor_paint_cull_result (self, success, result);
-      else if (result == CLUTTER_CULL_RESULT_OUT && success)
-        goto done;
-    }
+static CoglMatrix *
+clutter_actor_alloc_stage_transform (void)
+{
+  _clutter_memory_account (CLUTTER_MEMORY_ACTORS, sizeof (CoglMatrix), 0);
 
-  if (priv->effects == NULL)
-    priv->next_effect_to_paint = NULL;
+  return g_slice_new (CoglMatrix);
+}
+
+/* Retrieves the transformation from the coordinate space of @self to
+ * the coordinate space of its stage, computing it from the cached
+ * transformation of the parent if needed. Returns %NULL if @self is
+ * not on a stage, or if @self or one of its ancestors overrides
+ * apply_transform(): the overridden transformations can depend on a
+ * state that does not invalidate the cache, like the allocation of
+ * the source of a #ClutterClone.
+ */
+static const CoglMatrix *
+clutter_actor_get_stage_transform (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  const CoglMatrix *parent_transform;
+
+  if (priv->stage_transform_valid)
+    return priv->stage_transform;
+
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self))
+    {
+      if (priv->stage_transform == NULL)
+        priv->stage_transform = clutter_actor_alloc_stage_transform ();
+
+      cogl_matrix_init_identity (priv->stage_transform);
+    }
   else
-    priv->next_effect_to_paint = _clutter_meta_group_peek_metas (priv->effects);
+    {
+      if (priv->parent == NULL)
+        return NULL;
 
-  clutter_actor_continue_paint (self);
+      if (CLUTTER_ACTOR_GET_CLASS (self)->apply_transform != clutter_actor_real_apply_transform)
+        return NULL;
 
-  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_PAINT_VOLUMES &&
-                  pick_mode == CLUTTER_PICK_NONE))
-    _clutter_actor_draw_paint_volume (self);
+      parent_transform = clutter_actor_get_stage_transform (priv->parent);
+      if (parent_transform == NULL)
+        return NULL;
 
-done:
-  /* If we make it here then the actor has run through a complete
-     paint run including all the effects so it's no longer dirty */
-  if (pick_mode == CLUTTER_PICK_NONE)
-    priv->is_dirty = FALSE;
+      if (priv->stage_transform == NULL)
+        priv->stage_transform = clutter_actor_alloc_stage_transform ();
 
-  if (clip_set)
-    cogl_clip_pop();
+      *priv->stage_transform = *parent_transform;
+      _clutter_actor_apply_modelview_transform (self, priv->stage_transform);
+    }
 
-  cogl_pop_matrix();
+  priv->stage_transform_kind =
+    _clutter_util_matrix_classify (priv->stage_transform);
+  priv->stage_transform_valid = TRUE;
 
-  /* paint sequence complete */
-  CLUTTER_UNSET_PRIVATE_FLAGS (self, CLUTTER_IN_PAINT);
+  return priv->stage_transform;
 }
 
-/**
- * clutter_actor_continue_paint:
- * @self: A #ClutterActor
+/*
+ * clutter_actor_apply_relative_transformation_matrix:
+ * @self: The actor whose coordinate space you want to transform from.
+ * @ancestor: The ancestor actor whose coordinate space you want to transform too
+ *            or %NULL if you want to transform all the way to eye coordinates.
+ * @matrix: A #ClutterMatrix to apply the transformation too.
  *
- * Run the next stage of the paint sequence. This function should only
- * be called within the implementation of the ‘run’ virtual of a
- * #ClutterEffect. It will cause the run method of the next effect to
- * be applied, or it will paint the actual actor if the current effect
- * is the last effect in the chain.
+ * This multiplies a transform with @matrix that will transform coordinates
+ * from the coordinate space of @self into the coordinate space of @ancestor.
+ *
+ * For example if you need a matrix that can transform the local actor
+ * coordinates of @self into stage coordinates you would pass the actor's stage
+ * pointer as the @ancestor.
  *
+ * If you pass %NULL then the transformation will take you all the way through
+ * to eye coordinates. This can be useful if you want to extract the entire
+ * modelview transform that Clutter applies before applying the projection
+ * transformation. If you want to explicitly set a modelview on a CoglFramebuffer
+ * using cogl_set_modelview_matrix() for example then you would want a matrix
+ * that transforms into eye coordinates.
  *
+ * <note>This function doesn't initialize the given @matrix, it simply
+ * multiplies the requested transformation matrix with the existing contents of
+ * @matrix. You can use cogl_matrix_init_identity() to initialize the @matrix
+ * before calling this function, or you can use
+ * clutter_actor_get_relative_transformation_matrix() instead.</note>
  */
 void
-clutter_actor_continue_paint (ClutterActor *self)
+_clutter_actor_apply_relative_transformation_matrix (ClutterActor *self,
+                                                     ClutterActor *ancestor,
+                                                     CoglMatrix *matrix)
 {
-  ClutterActorPrivate *priv;
-
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-  /* This should only be called from with in the ‘run’ implementation
-     of a ClutterEffect */
-  g_return_if_fail (CLUTTER_ACTOR_IN_PAINT (self));
-
-  priv = self->priv;
+  ClutterActor *parent;
 
-  /* Skip any effects that are disabled */
-  while (priv->next_effect_to_paint &&
-         !clutter_actor_meta_get_enabled (priv->next_effect_to_paint->data))
-    priv->next_effect_to_paint = priv->next_effect_to_paint->next;
+  /* Note we terminate before ever calling stage->apply_transform()
+   * since that would conceptually be relative to the underlying
+   * window OpenGL coordinates so we'd need a special @ancestor
+   * value to represent the fake parent of the stage. */
+  if (self == ancestor)
+    return;
 
-  /* If this has come from the last effect then we'll just paint the
-     actual actor */
-  if (priv->next_effect_to_paint == NULL)
+  /* the transformations to the stage, and to eye coordinates, are
+   * cached; the other ancestors need a walk up the hierarchy
+   */
+  if (ancestor == NULL || CLUTTER_ACTOR_IS_TOPLEVEL (ancestor))
     {
-      if (_clutter_context_get_pick_mode () == CLUTTER_PICK_NONE)
-        {
-          ClutterPaintNode *dummy;
-
-          /* XXX - this will go away in 2.0, when we can get rid of this
-           * stuff and switch to a pure retained render tree of PaintNodes
-           * for the entire frame, starting from the Stage; the paint()
-           * virtual function can then be called directly.
-           */
-          dummy = _clutter_dummy_node_new (self);
-          clutter_paint_node_set_name (dummy, "Root");
-
-          /* XXX - for 1.12, we use the return value of paint_node() to
-           * decide whether we should emit the ::paint signal.
-           */
-          clutter_actor_paint_node (self, dummy);
-          clutter_paint_node_unref (dummy);
-
-          CLUTTER_ACTOR_GET_CLASS (self)->paint (self);
+      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+      const CoglMatrix *stage_transform;
 
-          /* the actor was painted at least once */
-          priv->was_painted = TRUE;
-        }
-      else
+      if (stage != NULL && (ancestor == NULL || ancestor == stage))
         {
-          ClutterColor col = { 0, };
+          stage_transform = clutter_actor_get_stage_transform (self);
 
-          _clutter_id_to_color (_clutter_actor_get_pick_id (self), &col);
+          if (stage_transform != NULL)
+            {
+              if (ancestor == NULL)
+                _clutter_actor_apply_modelview_transform (stage, matrix);
 
-          /* Actor will then paint silhouette of itself in supplied
-           * color.  See clutter_stage_get_actor_at_pos() for where
-           * picking is enabled.
-           *
-           * XXX:2.0 - Call the pick() virtual directly
-           */
-          CLUTTER_ACTOR_GET_CLASS (self)->pick (self, &col);
+              switch (self->priv->stage_transform_kind)
+                {
+                case CLUTTER_TRANSFORM_IDENTITY:
+                  break;
+
+                case CLUTTER_TRANSFORM_TRANSLATE:
+                  cogl_matrix_translate (matrix,
+                                         stage_transform->xw,
+                                         stage_transform->yw,
+                                         stage_transform->zw);
+                  break;
+
+                default:
+                  cogl_matrix_multiply (matrix, matrix, stage_transform);
+                  break;
+                }
+
+              return;
+            }
         }
     }
-  else
-    {
-      ClutterEffect *old_current_effect;
-      ClutterEffectPaintFlags run_flags = 0;
 
-      /* Cache the current effect so that we can put it back before
-         returning */
-      old_current_effect = priv->current_effect;
-
-      priv->current_effect = priv->next_effect_to_paint->data;
-      priv->next_effect_to_paint = priv->next_effect_to_paint->next;
-
-      if (_clutter_context_get_pick_mode () == CLUTTER_PICK_NONE)
-        {
-          if (priv->is_dirty)
-            {
-              /* If there's an effect queued with this redraw then all
-                 effects up to that one will be considered dirty. It
-                 is expected the queued effect will paint the cached
-                 image and not call clutter_actor_continue_paint again
-                 (although it should work ok if it does) */
-              if (priv->effect_to_redraw == NULL ||
-                  priv->current_effect != priv->effect_to_redraw)
-                run_flags |= CLUTTER_EFFECT_PAINT_ACTOR_DIRTY;
-            }
-
-          _clutter_effect_paint (priv->current_effect, run_flags);
-        }
-      else
-        {
-          /* We can't determine when an actor has been modified since
-             its last pick so lets just assume it has always been
-             modified */
-          run_flags |= CLUTTER_EFFECT_PAINT_ACTOR_DIRTY;
+  parent = clutter_actor_get_parent (self);
 
-          _clutter_effect_pick (priv->current_effect, run_flags);
-        }
+  if (parent != NULL)
+    _clutter_actor_apply_relative_transformation_matrix (parent, ancestor,
+                                                         matrix);
 
-      priv->current_effect = old_current_effect;
-    }
+  _clutter_actor_apply_modelview_transform (self, matrix);
 }
 
 static void
-_clutter_actor_stop_transitions (ClutterActor *self)
+_clutter_actor_draw_paint_volume_full (ClutterActor *self,
+                                       ClutterPaintVolume *pv,
+                                       const char *label,
+                                       const CoglColor *color)
 {
-  const ClutterAnimationInfo *info;
-  GHashTableIter iter;
-  gpointer value;
+  static CoglPipeline *outline = NULL;
+  CoglPrimitive *prim;
+  ClutterVertex line_ends[12 * 2];
+  int n_vertices;
+  CoglContext *ctx =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  /* XXX: at some point we'll query this from the stage but we can't
+   * do that until the osx backend uses Cogl natively. */
+  CoglFramebuffer *fb = cogl_get_draw_framebuffer ();
 
-  info = _clutter_actor_get_animation_info_or_defaults (self);
-  if (info->transitions == NULL)
-    return;
+  if (outline == NULL)
+    outline = cogl_pipeline_new (ctx);
 
-  g_hash_table_iter_init (&iter, info->transitions);
-  while (g_hash_table_iter_next (&iter, NULL, &value))
+  _clutter_paint_volume_complete (pv);
+
+  n_vertices = pv->is_2d ? 4 * 2 : 12 * 2;
+
+  /* Front face */
+  line_ends[0] = pv->vertices[0]; line_ends[1] = pv->vertices[1];
+  line_ends[2] = pv->vertices[1]; line_ends[3] = pv->vertices[2];
+  line_ends[4] = pv->vertices[2]; line_ends[5] = pv->vertices[3];
+  line_ends[6] = pv->vertices[3]; line_ends[7] = pv->vertices[0];
+
+  if (!pv->is_2d)
     {
-      TransitionClosure *closure = value;
+      /* Back face */
+      line_ends[8] = pv->vertices[4]; line_ends[9] = pv->vertices[5];
+      line_ends[10] = pv->vertices[5]; line_ends[11] = pv->vertices[6];
+      line_ends[12] = pv->vertices[6]; line_ends[13] = pv->vertices[7];
+      line_ends[14] = pv->vertices[7]; line_ends[15] = pv->vertices[4];
 
-      /* implicit transitions, and automatically managed explicit ones,
-       * should be removed at this point
-       */
-      if (closure->is_implicit ||
-          clutter_transition_get_remove_on_complete (closure->transition))
-        {
-          g_hash_table_iter_remove (&iter);
-        }
-      else
-        {
-          /* otherwise we stop it, and the transition will be removed
-           * later, either by the actor's destruction or by explicit
-           * removal
-           */
-          clutter_timeline_stop (CLUTTER_TIMELINE (closure->transition));
-        }
+      /* Lines connecting front face to back face */
+      line_ends[16] = pv->vertices[0]; line_ends[17] = pv->vertices[4];
+      line_ends[18] = pv->vertices[1]; line_ends[19] = pv->vertices[5];
+      line_ends[20] = pv->vertices[2]; line_ends[21] = pv->vertices[6];
+      line_ends[22] = pv->vertices[3]; line_ends[23] = pv->vertices[7];
     }
-}
 
-static ClutterActorTraverseVisitFlags
-invalidate_queue_redraw_entry (ClutterActor *self,
-                               int           depth,
-                               gpointer      user_data)
-{
-  ClutterActorPrivate *priv = self->priv;
+  prim = cogl_primitive_new_p3 (ctx, COGL_VERTICES_MODE_LINES,
+                                n_vertices,
+                                (CoglVertexP3 *)line_ends);
+
+  cogl_pipeline_set_color (outline, color);
+  cogl_framebuffer_draw_primitive (fb, outline, prim);
+  cogl_object_unref (prim);
 
-  if (priv->queue_redraw_entry != NULL)
+  if (label)
     {
-      _clutter_stage_queue_redraw_entry_invalidate (priv->queue_redraw_entry);
-      priv->queue_redraw_entry = NULL;
+      PangoLayout *layout;
+      layout = pango_layout_new (clutter_actor_get_pango_context (self));
+      pango_layout_set_text (layout, label, -1);
+      cogl_pango_render_layout (layout,
+                                pv->vertices[0].x,
+                                pv->vertices[0].y,
+                                color,
+                                0);
+      g_object_unref (layout);
     }
-
-  return CLUTTER_ACTOR_TRAVERSE_VISIT_CONTINUE;
 }
 
-static inline void
-remove_child (ClutterActor *self,
-              ClutterActor *child)
+static void
+_clutter_actor_draw_paint_volume (ClutterActor *self)
 {
-  ClutterActor *prev_sibling, *next_sibling;
-
-  prev_sibling = child->priv->prev_sibling;
-  next_sibling = child->priv->next_sibling;
+  ClutterPaintVolume *pv;
+  CoglColor color;
 
-  if (prev_sibling != NULL)
-    prev_sibling->priv->next_sibling = next_sibling;
+  pv = _clutter_actor_get_paint_volume_mutable (self);
+  if (!pv)
+    {
+      gfloat width, height;
+      ClutterPaintVolume fake_pv;
 
-  if (next_sibling != NULL)
-    next_sibling->priv->prev_sibling = prev_sibling;
+      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+      _clutter_paint_volume_init_static (&fake_pv, stage);
 
-  if (self->priv->first_child == child)
-    self->priv->first_child = next_sibling;
+      clutter_actor_get_size (self, &width, &height);
+      clutter_paint_volume_set_width (&fake_pv, width);
+      clutter_paint_volume_set_height (&fake_pv, height);
 
-  if (self->priv->last_child == child)
-    self->priv->last_child = prev_sibling;
+      cogl_color_init_from_4f (&color, 0, 0, 1, 1);
+      _clutter_actor_draw_paint_volume_full (self, &fake_pv,
+                                             _clutter_actor_get_debug_name (self),
+                                             &color);
 
-  child->priv->parent = NULL;
-  child->priv->prev_sibling = NULL;
-  child->priv->next_sibling = NULL;
+      clutter_paint_volume_free (&fake_pv);
+    }
+  else
+    {
+      cogl_color_init_from_4f (&color, 0, 1, 0, 1);
+      _clutter_actor_draw_paint_volume_full (self, pv,
+                                             _clutter_actor_get_debug_name (self),
+                                             &color);
+    }
 }
 
-typedef enum {
-  REMOVE_CHILD_DESTROY_META       = 1 << 0,
-  REMOVE_CHILD_EMIT_PARENT_SET    = 1 << 1,
-  REMOVE_CHILD_EMIT_ACTOR_REMOVED = 1 << 2,
-  REMOVE_CHILD_CHECK_STATE        = 1 << 3,
-  REMOVE_CHILD_FLUSH_QUEUE        = 1 << 4,
-  REMOVE_CHILD_NOTIFY_FIRST_LAST  = 1 << 5,
-  REMOVE_CHILD_STOP_TRANSITIONS   = 1 << 6,
-
-  /* default flags for public API */
-  REMOVE_CHILD_DEFAULT_FLAGS      = REMOVE_CHILD_STOP_TRANSITIONS |
-                                    REMOVE_CHILD_DESTROY_META |
-                                    REMOVE_CHILD_EMIT_PARENT_SET |
-                                    REMOVE_CHILD_EMIT_ACTOR_REMOVED |
-                                    REMOVE_CHILD_CHECK_STATE |
-                                    REMOVE_CHILD_FLUSH_QUEUE |
-                                    REMOVE_CHILD_NOTIFY_FIRST_LAST
-} ClutterActorRemoveChildFlags;
-
-/*< private >
- * clutter_actor_remove_child_internal:
- * @self: a #ClutterActor
- * @child: the child of @self that has to be removed
- * @flags: control the removal operations
- *
- * Removes @child from the list of children of @self.
- */
 static void
-clutter_actor_remove_child_internal (ClutterActor                 *self,
-                                     ClutterActor                 *child,
-                                     ClutterActorRemoveChildFlags  flags)
+_clutter_actor_paint_cull_result (ClutterActor *self,
+                                  gboolean success,
+                                  ClutterCullResult result)
 {
-  ClutterActor *old_first, *old_last;
-  gboolean destroy_meta, emit_parent_set, emit_actor_removed, check_state;
-  gboolean flush_queue;
-  gboolean notify_first_last;
-  gboolean was_mapped;
-  gboolean stop_transitions;
-  GObject *obj;
-
-  destroy_meta = (flags & REMOVE_CHILD_DESTROY_META) != 0;
-  emit_parent_set = (flags & REMOVE_CHILD_EMIT_PARENT_SET) != 0;
-  emit_actor_removed = (flags & REMOVE_CHILD_EMIT_ACTOR_REMOVED) != 0;
-  check_state = (flags & REMOVE_CHILD_CHECK_STATE) != 0;
-  flush_queue = (flags & REMOVE_CHILD_FLUSH_QUEUE) != 0;
-  notify_first_last = (flags & REMOVE_CHILD_NOTIFY_FIRST_LAST) != 0;
-  stop_transitions = (flags & REMOVE_CHILD_STOP_TRANSITIONS) != 0;
-
-  obj = G_OBJECT (self);
-  g_object_freeze_notify (obj);
-
-  if (stop_transitions)
-    _clutter_actor_stop_transitions (child);
-
-  if (destroy_meta)
-    clutter_container_destroy_child_meta (CLUTTER_CONTAINER (self), child);
+  ClutterPaintVolume *pv;
+  CoglColor color;
 
-  if (check_state)
+  if (success)
     {
-      was_mapped = CLUTTER_ACTOR_IS_MAPPED (child);
-
-      /* we need to unrealize *before* we set parent_actor to NULL,
-       * because in an unrealize method actors are dissociating from the
-       * stage, which means they need to be able to
-       * clutter_actor_get_stage().
-       *
-       * yhis should unmap and unrealize, unless we're reparenting.
-       */
-      clutter_actor_update_map_state (child, MAP_STATE_MAKE_UNREALIZED);
+      if (result == CLUTTER_CULL_RESULT_IN)
+        cogl_color_init_from_4f (&color, 0, 1, 0, 1);
+      else if (result == CLUTTER_CULL_RESULT_OUT)
+        cogl_color_init_from_4f (&color, 0, 0, 1, 1);
+      else
+        cogl_color_init_from_4f (&color, 0, 1, 1, 1);
     }
   else
-    was_mapped = FALSE;
+    cogl_color_init_from_4f (&color, 1, 1, 1, 1);
 
-  if (flush_queue)
+  if (success && (pv = _clutter_actor_get_paint_volume_mutable (self)))
+    _clutter_actor_draw_paint_volume_full (self, pv,
+                                           _clutter_actor_get_debug_name (self),
+                                           &color);
+  else
     {
-      /* We take this opportunity to invalidate any queue redraw entry
-       * associated with the actor and descendants since we won't be able to
-       * determine the appropriate stage after this.
-       *
-       * we do this after we updated the mapped state because actors might
-       * end up queueing redraws inside their mapped/unmapped virtual
-       * functions, and if we invalidate the redraw entry we could end up
-       * with an inconsistent state and weird memory corruption. see
-       * bugs:
-       *
-       *   http://bugzilla.clutter-project.org/show_bug.cgi?id=2621
-       *   https://bugzilla.gnome.org/show_bug.cgi?id=652036
-       */
-      _clutter_actor_traverse (child,
-                               0,
-                               invalidate_queue_redraw_entry,
-                               NULL,
-                               NULL);
+      PangoLayout *layout;
+      char *label =
+        g_strdup_printf ("CULL FAILURE: %s", _clutter_actor_get_debug_name (self));
+      cogl_color_init_from_4f (&color, 1, 1, 1, 1);
+      cogl_set_source_color (&color);
+
+      layout = pango_layout_new (clutter_actor_get_pango_context (self));
+      pango_layout_set_text (layout, label, -1);
+      cogl_pango_render_layout (layout,
+                                0,
+                                0,
+                                &color,
+                                0);
+      g_free (label);
+      g_object_unref (layout);
     }
+}
 
-  old_first = self->priv->first_child;
-  old_last = self->priv->last_child;
+static int clone_paint_level = 0;
 
-  remove_child (self, child);
+void
+_clutter_actor_push_clone_paint (void)
+{
+  clone_paint_level++;
+}
 
-  self->priv->n_children -= 1;
+void
+_clutter_actor_pop_clone_paint (void)
+{
+  clone_paint_level--;
+}
 
-  self->priv->age += 1;
+static gboolean
+in_clone_paint (void)
+{
+  return clone_paint_level > 0;
+}
 
-  /* if the child that got removed was visible and set to
-   * expand then we want to reset the parent's state in
-   * case the child was the only thing that was making it
-   * expand.
-   */
-  if (CLUTTER_ACTOR_IS_VISIBLE (child) &&
-      (child->priv->needs_compute_expand ||
-       child->priv->needs_x_expand ||
-       child->priv->needs_y_expand))
-    {
-      clutter_actor_queue_compute_expand (self);
-    }
+/* the tolerance, in pixels, used to decide whether a projected
+ * rectangle is still aligned to the axes of the window
+ */
+#define OCCLUDER_EPSILON        0.01f
 
-  /* clutter_actor_reparent() will emit ::parent-set for us */
-  if (emit_parent_set && !CLUTTER_ACTOR_IN_REPARENT (child))
-    g_signal_emit (child, actor_signals[PARENT_SET], 0, self);
+/* The window-space rectangles of the clips pushed while painting,
+ * each one already intersected with the clips of its ancestors
+ */
+typedef struct _ClutterPaintClip
+{
+  CoglFramebuffer *framebuffer;
+  ClutterActorBox box;
+  guint is_valid : 1;
+} ClutterPaintClip;
 
-  /* if the child was mapped then we need to relayout ourselves to account
-   * for the removed child
-   */
-  if (was_mapped)
-    clutter_actor_queue_relayout (self);
+static GArray *paint_clips = NULL;
 
-  /* we need to emit the signal before dropping the reference */
-  if (emit_actor_removed)
-    g_signal_emit_by_name (self, "actor-removed", child);
+/* Projects a clip rectangle in window coordinates, storing the pixels
+ * it touches inside @window_box; we can only use a scissor if the
+ * rectangle is still aligned to the axes and its edges fall on pixel
+ * boundaries, otherwise the result would be different from the one of
+ * a clip drawn by Cogl
+ */
+static gboolean
+project_clip_box (const CoglMatrix      *modelview,
+                  const CoglMatrix      *projection,
+                  const float           *viewport,
+                  const ClutterActorBox *box,
+                  ClutterActorBox       *window_box)
+{
+  ClutterVertex box_vertices[4], verts[4];
+  float x1, y1, x2, y2;
+  int i;
 
-  if (notify_first_last)
+  box_vertices[0].x = box->x1; box_vertices[0].y = box->y1; box_vertices[0].z = 0.f;
+  box_vertices[1].x = box->x2; box_vertices[1].y = box->y1; box_vertices[1].z = 0.f;
+  box_vertices[2].x = box->x1; box_vertices[2].y = box->y2; box_vertices[2].z = 0.f;
+  box_vertices[3].x = box->x2; box_vertices[3].y = box->y2; box_vertices[3].z = 0.f;
+
+  _clutter_util_fully_transform_vertices (modelview,
+                                          projection,
+                                          viewport,
+                                          box_vertices,
+                                          verts,
+                                          4);
+
+  x1 = x2 = verts[0].x;
+  y1 = y2 = verts[0].y;
+
+  for (i = 1; i < 4; i++)
     {
-      if (old_first != self->priv->first_child)
-        g_object_notify_by_pspec (obj, obj_props[PROP_FIRST_CHILD]);
+      x1 = MIN (x1, verts[i].x);
+      y1 = MIN (y1, verts[i].y);
+      x2 = MAX (x2, verts[i].x);
+      y2 = MAX (y2, verts[i].y);
+    }
 
-      if (old_last != self->priv->last_child)
-        g_object_notify_by_pspec (obj, obj_props[PROP_LAST_CHILD]);
+  if (fabsf (verts[0].y - verts[1].y) > OCCLUDER_EPSILON ||
+      fabsf (verts[2].y - verts[3].y) > OCCLUDER_EPSILON ||
+      fabsf (verts[0].x - verts[2].x) > OCCLUDER_EPSILON ||
+      fabsf (verts[1].x - verts[3].x) > OCCLUDER_EPSILON)
+    {
+      window_box->x1 = floorf (x1);
+      window_box->y1 = floorf (y1);
+      window_box->x2 = ceilf (x2);
+      window_box->y2 = ceilf (y2);
+
+      return FALSE;
     }
 
-  g_object_thaw_notify (obj);
+  window_box->x1 = roundf (x1);
+  window_box->y1 = roundf (y1);
+  window_box->x2 = roundf (x2);
+  window_box->y2 = roundf (y2);
 
-  /* remove the reference we acquired in clutter_actor_add_child() */
-  g_object_unref (child);
+  return fabsf (window_box->x1 - x1) <= OCCLUDER_EPSILON &&
+         fabsf (window_box->y1 - y1) <= OCCLUDER_EPSILON &&
+         fabsf (window_box->x2 - x2) <= OCCLUDER_EPSILON &&
+         fabsf (window_box->y2 - y2) <= OCCLUDER_EPSILON;
 }
 
-static const ClutterTransformInfo default_transform_info = {
-  0.0,                          /* rotation-x */
-  0.0,                          /* rotation-y */
-  0.0,                          /* rotation-z */
+static const ClutterPaintClip *
+clutter_actor_peek_paint_clip (void)
+{
+  if (paint_clips == NULL || paint_clips->len == 0)
+    return NULL;
 
-  1.0, 1.0, 1.0,                /* scale */
+  return &g_array_index (paint_clips, ClutterPaintClip, paint_clips->len - 1);
+}
 
-  CLUTTER_VERTEX_INIT_ZERO,     /* translation */
+/* Pushes @box, in the coordinates of the current modelview, on the
+ * Cogl clip stack. Rectangles that map onto whole pixels of the window
+ * use a scissor, which does not need to go through the journal or the
+ * stencil buffer
+ */
+static void
+clutter_actor_push_paint_clip (const ClutterActorBox *box)
+{
+  const ClutterPaintClip *parent_clip;
+  ClutterPaintClip clip;
+  CoglMatrix modelview, projection;
+  float viewport[4];
 
-  0.f,                          /* z-position */
+  if (G_UNLIKELY (paint_clips == NULL))
+    paint_clips = g_array_new (FALSE, FALSE, sizeof (ClutterPaintClip));
 
-  CLUTTER_POINT_INIT_ZERO,      /* pivot */
-  0.f,                          /* pivot-z */
+  /* the batched silhouettes are outside of the new clip */
+  _clutter_actor_flush_pick_batch ();
 
-  CLUTTER_MATRIX_INIT_IDENTITY,
-  FALSE,                        /* transform */
-  CLUTTER_MATRIX_INIT_IDENTITY,
-  FALSE,                        /* child-transform */
-};
+  clip.framebuffer = cogl_get_draw_framebuffer ();
+  clip.is_valid = FALSE;
 
-/*< private >
- * _clutter_actor_get_transform_info_or_defaults:
- * @self: a #ClutterActor
- *
- * Retrieves the ClutterTransformInfo structure associated to an actor.
- *
- * If the actor does not have a ClutterTransformInfo structure associated
- * to it, then the default structure will be returned.
- *
- * This function should only be used for getters.
- *
- * Return value: a const pointer to the ClutterTransformInfo structure
- */
-const ClutterTransformInfo *
-_clutter_actor_get_transform_info_or_defaults (ClutterActor *self)
-{
-  ClutterTransformInfo *info;
+  parent_clip = clutter_actor_peek_paint_clip ();
+  if (parent_clip != NULL && parent_clip->framebuffer != clip.framebuffer)
+    parent_clip = NULL;
 
-  info = g_object_get_qdata (G_OBJECT (self), quark_actor_transform_info);
-  if (info != NULL)
-    return info;
+  cogl_get_modelview_matrix (&modelview);
+  cogl_get_projection_matrix (&projection);
+  cogl_get_viewport (viewport);
 
-  return &default_transform_info;
+  if (project_clip_box (&modelview, &projection, viewport, box, &clip.box))
+    {
+      cogl_clip_push_window_rectangle (clip.box.x1, clip.box.y1,
+                                       MAX (clip.box.x2 - clip.box.x1, 0),
+                                       MAX (clip.box.y2 - clip.box.y1, 0));
+      clip.is_valid = TRUE;
+    }
+  else
+    {
+      cogl_clip_push_rectangle (box->x1, box->y1, box->x2, box->y2);
+
+      /* the bounding box of the projected rectangle is still a
+       * conservative clip, as long as none of its vertices ends
+       * up behind the eye
+       */
+      clip.is_valid =
+        _clutter_util_matrix_classify (&modelview) != CLUTTER_TRANSFORM_GENERAL;
+    }
+
+  /* the effective clip is the intersection with the parent's one */
+  if (parent_clip != NULL && parent_clip->is_valid)
+    {
+      if (clip.is_valid)
+        {
+          clip.box.x1 = MAX (clip.box.x1, parent_clip->box.x1);
+          clip.box.y1 = MAX (clip.box.y1, parent_clip->box.y1);
+          clip.box.x2 = MIN (clip.box.x2, parent_clip->box.x2);
+          clip.box.y2 = MIN (clip.box.y2, parent_clip->box.y2);
+        }
+      else
+        clip = *parent_clip;
+    }
+
+  g_array_append_val (paint_clips, clip);
 }
 
 static void
-clutter_transform_info_free (gpointer data)
+clutter_actor_pop_paint_clip (void)
 {
-  if (data != NULL)
-    g_slice_free (ClutterTransformInfo, data);
+  g_assert (paint_clips != NULL && paint_clips->len > 0);
+
+  g_array_set_size (paint_clips, paint_clips->len - 1);
+
+  _clutter_actor_flush_pick_batch ();
+
+  cogl_clip_pop ();
 }
 
-/*< private >
- * _clutter_actor_get_transform_info:
- * @self: a #ClutterActor
- *
- * Retrieves a pointer to the ClutterTransformInfo structure.
- *
- * If the actor does not have a ClutterTransformInfo associated to it, one
- * will be created and initialized to the default values.
- *
- * This function should be used for setters.
- *
- * For getters, you should use _clutter_actor_get_transform_info_or_defaults()
- * instead.
- *
- * Return value: (transfer none): a pointer to the ClutterTransformInfo
- *   structure
- */
-ClutterTransformInfo *
-_clutter_actor_get_transform_info (ClutterActor *self)
+/* Returns TRUE if the actor can be ignored */
+/* FIXME: we should return a ClutterCullResult, and
+ * clutter_actor_paint should understand that a CLUTTER_CULL_RESULT_IN
+ * means there's no point in trying to cull descendants of the current
+ * node. */
+static gboolean
+cull_actor (ClutterActor *self, ClutterCullResult *result_out)
 {
-  ClutterTransformInfo *info;
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *stage;
+  const ClutterPlane *stage_clip;
 
-  info = g_object_get_qdata (G_OBJECT (self), quark_actor_transform_info);
-  if (info == NULL)
+  if (!priv->last_paint_volume_valid)
     {
-      info = g_slice_new (ClutterTransformInfo);
+      CLUTTER_NOTE (CLIPPING, "Bail from cull_actor without culling (%s): "
+                    "->last_paint_volume_valid == FALSE",
+                    _clutter_actor_get_debug_name (self));
+      return FALSE;
+    }
 
-      *info = default_transform_info;
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_DISABLE_CULLING))
+    return FALSE;
 
-      g_object_set_qdata_full (G_OBJECT (self), quark_actor_transform_info,
-                               info,
-                               clutter_transform_info_free);
+  stage = _clutter_actor_get_stage_internal (self);
+  stage_clip = _clutter_stage_get_clip (CLUTTER_STAGE (stage));
+  if (G_UNLIKELY (!stage_clip))
+    {
+      CLUTTER_NOTE (CLIPPING, "Bail from cull_actor without culling (%s): "
+                    "No stage clip set",
+                    _clutter_actor_get_debug_name (self));
+      return FALSE;
     }
 
-  return info;
-}
+  if (cogl_get_draw_framebuffer () !=
+      _clutter_stage_get_active_framebuffer (CLUTTER_STAGE (stage)))
+    {
+      CLUTTER_NOTE (CLIPPING, "Bail from cull_actor without culling (%s): "
+                    "Current framebuffer doesn't correspond to stage",
+                    _clutter_actor_get_debug_name (self));
+      return FALSE;
+    }
 
-static inline void
-clutter_actor_set_pivot_point_internal (ClutterActor       *self,
-                                        const ClutterPoint *pivot)
-{
-  ClutterTransformInfo *info;
+  *result_out =
+    _clutter_paint_volume_cull (&priv->last_paint_volume, stage_clip);
 
-  info = _clutter_actor_get_transform_info (self);
-  info->pivot = *pivot;
+  /* the scissors pushed by the actor and its ancestors while drawing
+   * on the stage are already in stage coordinates
+   */
+  if (*result_out != CLUTTER_CULL_RESULT_OUT)
+    {
+      const ClutterPaintClip *clip = clutter_actor_peek_paint_clip ();
 
-  self->priv->transform_valid = FALSE;
+      if (clip != NULL && clip->is_valid &&
+          clip->framebuffer == cogl_get_draw_framebuffer ())
+        {
+          ClutterActorBox box;
 
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT]);
+          _clutter_paint_volume_get_stage_paint_box (&priv->last_paint_volume,
+                                                     CLUTTER_STAGE (stage),
+                                                     &box);
 
-  clutter_actor_queue_redraw (self);
+          if (box.x2 <= clip->box.x1 || box.x1 >= clip->box.x2 ||
+              box.y2 <= clip->box.y1 || box.y1 >= clip->box.y2)
+            {
+              CLUTTER_NOTE (CLIPPING, "Culling actor '%s' outside of the "
+                            "clip of its ancestors",
+                            _clutter_actor_get_debug_name (self));
+              *result_out = CLUTTER_CULL_RESULT_OUT;
+            }
+        }
+    }
+
+  return TRUE;
 }
 
-static inline void
-clutter_actor_set_pivot_point_z_internal (ClutterActor *self,
-                                          float         pivot_z)
+/* Projects the opaque box of an actor in window coordinates; since
+ * occluders must be conservative, we only accept rectangles that are
+ * still aligned to the axes, and we shrink them to the pixels that are
+ * fully covered
+ */
+static gboolean
+project_occluder_box (const CoglMatrix      *modelview,
+                      const CoglMatrix      *projection,
+                      const float           *viewport,
+                      const ClutterActorBox *box,
+                      ClutterActorBox       *occluder_box)
 {
-  ClutterTransformInfo *info;
+  ClutterVertex box_vertices[4], verts[4];
 
-  info = _clutter_actor_get_transform_info (self);
-  info->pivot_z = pivot_z;
+  box_vertices[0].x = box->x1; box_vertices[0].y = box->y1; box_vertices[0].z = 0.f;
+  box_vertices[1].x = box->x2; box_vertices[1].y = box->y1; box_vertices[1].z = 0.f;
+  box_vertices[2].x = box->x1; box_vertices[2].y = box->y2; box_vertices[2].z = 0.f;
+  box_vertices[3].x = box->x2; box_vertices[3].y = box->y2; box_vertices[3].z = 0.f;
 
-  self->priv->transform_valid = FALSE;
+  _clutter_util_fully_transform_vertices (modelview,
+                                          projection,
+                                          viewport,
+                                          box_vertices,
+                                          verts,
+                                          4);
+
+  if (fabsf (verts[0].y - verts[1].y) > OCCLUDER_EPSILON ||
+      fabsf (verts[2].y - verts[3].y) > OCCLUDER_EPSILON ||
+      fabsf (verts[0].x - verts[2].x) > OCCLUDER_EPSILON ||
+      fabsf (verts[1].x - verts[3].x) > OCCLUDER_EPSILON)
+    return FALSE;
 
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT_Z]);
+  occluder_box->x1 = ceilf (MIN (verts[0].x, verts[1].x) - OCCLUDER_EPSILON);
+  occluder_box->y1 = ceilf (MIN (verts[0].y, verts[2].y) - OCCLUDER_EPSILON);
+  occluder_box->x2 = floorf (MAX (verts[0].x, verts[1].x) + OCCLUDER_EPSILON);
+  occluder_box->y2 = floorf (MAX (verts[0].y, verts[2].y) + OCCLUDER_EPSILON);
 
-  clutter_actor_queue_redraw (self);
+  return occluder_box->x2 > occluder_box->x1 &&
+         occluder_box->y2 > occluder_box->y1;
 }
 
-/*< private >
- * clutter_actor_set_translation_internal:
- * @self: a #ClutterActor
- * @axis: the axis of the translation to change
- * @angle: the translation as a value along @axis
- *
- * Sets the translation on the given @axis
- */
+/* Keeps the largest CLUTTER_MAX_OCCLUDERS opaque areas */
 static void
-clutter_actor_set_translation_internal (ClutterActor *self,
-                                        gfloat        value,
-                                        GParamSpec   *pspec)
+clutter_occlusion_add (ClutterOcclusion      *occlusion,
+                       const ClutterActorBox *box,
+                       guint                  paint_index)
 {
-  GObject *obj = G_OBJECT (self);
-  ClutterTransformInfo *info;
+  ClutterOccluder *occluder;
+  float area, min_area;
+  guint i;
 
-  info = _clutter_actor_get_transform_info (self);
+  area = clutter_actor_box_get_area (box);
 
-  if (pspec == obj_props[PROP_TRANSLATION_X])
-    info->translation.x = value;
-  else if (pspec == obj_props[PROP_TRANSLATION_Y])
-    info->translation.y = value;
-  else if (pspec == obj_props[PROP_TRANSLATION_Z])
-    info->translation.z = value;
+  if (occlusion->n_occluders < CLUTTER_MAX_OCCLUDERS)
+    occluder = &occlusion->occluders[occlusion->n_occluders++];
   else
-    g_assert_not_reached ();
+    {
+      occluder = NULL;
+      min_area = area;
 
-  self->priv->transform_valid = FALSE;
-  clutter_actor_queue_redraw (self);
-  g_object_notify_by_pspec (obj, pspec);
+      for (i = 0; i < occlusion->n_occluders; i++)
+        {
+          float occluder_area;
+
+          occluder_area = clutter_actor_box_get_area (&occlusion->occluders[i].box);
+          if (occluder_area < min_area)
+            {
+              occluder = &occlusion->occluders[i];
+              min_area = occluder_area;
+            }
+        }
+
+      if (occluder == NULL)
+        return;
+    }
+
+  occluder->box = *box;
+  occluder->paint_index = paint_index;
 }
 
-static inline void
-clutter_actor_set_translation_factor (ClutterActor      *self,
-                                      ClutterRotateAxis  axis,
-                                      gdouble            value)
+static void
+clutter_actor_compute_occlusion_internal (ClutterActor     *self,
+                                          const CoglMatrix *parent_modelview,
+                                          const CoglMatrix *projection,
+                                          const float      *viewport,
+                                          gboolean          can_occlude,
+                                          guint            *paint_index,
+                                          ClutterOcclusion *occlusion)
 {
-  const ClutterTransformInfo *info;
-  const float *translate_p = NULL;
-  GParamSpec *pspec = NULL;
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorClass *klass = CLUTTER_ACTOR_GET_CLASS (self);
+  CoglMatrix modelview;
+  ClutterActorBox box;
+  guint8 opacity;
 
-  info = _clutter_actor_get_transform_info_or_defaults (self);
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self) || !CLUTTER_ACTOR_IS_MAPPED (self))
+    return;
 
-  switch (axis)
-    {
-    case CLUTTER_X_AXIS:
-      pspec = obj_props[PROP_TRANSLATION_X];
-      translate_p = &info->translation.x;
-      break;
+  opacity = priv->opacity_override >= 0 ? priv->opacity_override
+                                        : priv->opacity;
 
-    case CLUTTER_Y_AXIS:
-      pspec = obj_props[PROP_TRANSLATION_Y];
-      translate_p = &info->translation.y;
-      break;
+  /* see clutter_actor_paint(): fully transparent actors are skipped */
+  if (!CLUTTER_ACTOR_IS_TOPLEVEL (self) && opacity == 0)
+    return;
 
-    case CLUTTER_Z_AXIS:
-      pspec = obj_props[PROP_TRANSLATION_Z];
-      translate_p = &info->translation.z;
-      break;
-    }
+  modelview = *parent_modelview;
+  if (priv->enable_model_view_transform)
+    _clutter_actor_apply_modelview_transform (self, &modelview);
 
-  g_assert (pspec != NULL);
-  g_assert (translate_p != NULL);
+  priv->occlusion_serial = occlusion->serial;
+  priv->paint_index = (*paint_index)++;
 
-  _clutter_actor_create_transition (self, pspec, *translate_p, value);
-}
+  /* the opacity is inherited, and clips and effects change the way
+   * the whole sub-tree is painted
+   */
+  if (opacity != 255 ||
+      priv->has_clip ||
+      priv->clip_to_allocation ||
+      priv->effects != NULL ||
+      (priv->offscreen_redirect & CLUTTER_OFFSCREEN_REDIRECT_ALWAYS) != 0)
+    can_occlude = FALSE;
+
+  /* we can only know the paint order of the children of an actor
+   * if it uses the default paint sequence
+   */
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) ||
+      klass->paint == clutter_actor_real_paint)
+    {
+      ClutterActor *iter;
 
-/**
- * clutter_actor_set_translation:
- * @self: a #ClutterActor
- * @translate_x: the translation along the X axis
- * @translate_y: the translation along the Y axis
- * @translate_z: the translation along the Z axis
- *
- * Sets an additional translation transformation on a #ClutterActor,
- * relative to the #ClutterActor:pivot-point.
- *
- *
- */
-void
-clutter_actor_set_translation (ClutterActor *self,
-                               gfloat        translate_x,
-                               gfloat        translate_y,
-                               gfloat        translate_z)
-{
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+      for (iter = priv->first_child;
+           iter != NULL;
+           iter = iter->priv->next_sibling)
+        clutter_actor_compute_occlusion_internal (iter, &modelview,
+                                                  projection,
+                                                  viewport,
+                                                  can_occlude,
+                                                  paint_index,
+                                                  occlusion);
+    }
 
-  g_object_freeze_notify (G_OBJECT (self));
+  priv->paint_index_last = *paint_index - 1;
 
-  clutter_actor_set_translation_factor (self, CLUTTER_X_AXIS, translate_x);
-  clutter_actor_set_translation_factor (self, CLUTTER_Y_AXIS, translate_y);
-  clutter_actor_set_translation_factor (self, CLUTTER_Z_AXIS, translate_z);
+  /* the top-level is painted first, so it cannot hide anything */
+  if (!can_occlude || CLUTTER_ACTOR_IS_TOPLEVEL (self))
+    return;
 
-  g_object_thaw_notify (G_OBJECT (self));
+  if (klass->get_opaque_box == NULL || !klass->get_opaque_box (self, &box))
+    return;
+
+  if (project_occluder_box (&modelview, projection, viewport, &box, &box))
+    clutter_occlusion_add (occlusion, &box, priv->paint_index);
 }
 
-/**
- * clutter_actor_get_translation:
- * @self: a #ClutterActor
- * @translate_x: (out) (allow-none): return location for the X component
- *   of the translation, or %NULL
- * @translate_y: (out) (allow-none): return location for the Y component
- *   of the translation, or %NULL
- * @translate_z: (out) (allow-none): return location for the Z component
- *   of the translation, or %NULL
- *
- * Retrieves the translation set using clutter_actor_set_translation().
- *
- *
+/*< private >
+ * _clutter_actor_compute_occlusion:
+ * @self: the top-level #ClutterActor
+ * @projection: the projection matrix of the stage
+ * @viewport: the viewport of the stage
+ * @occlusion: the occlusion state, with its serial already set
+ *
+ * Walks the scene graph rooted in @self in paint order, storing the
+ * position of each actor inside the paint sequence and collecting the
+ * largest areas of the window that are covered by opaque actors.
+ *
+ * While painting, actors whose paint box is entirely covered by an
+ * opaque area that is painted after them can be skipped.
  */
 void
-clutter_actor_get_translation (ClutterActor *self,
-                               gfloat       *translate_x,
-                               gfloat       *translate_y,
-                               gfloat       *translate_z)
+_clutter_actor_compute_occlusion (ClutterActor     *self,
+                                  const CoglMatrix *projection,
+                                  const float      *viewport,
+                                  ClutterOcclusion *occlusion)
 {
-  const ClutterTransformInfo *info;
-
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-
-  info = _clutter_actor_get_transform_info_or_defaults (self);
-
-  if (translate_x != NULL)
-    *translate_x = info->translation.x;
+  CoglMatrix modelview;
+  guint paint_index = 0;
 
-  if (translate_y != NULL)
-    *translate_y = info->translation.y;
+  occlusion->n_occluders = 0;
 
-  if (translate_z != NULL)
-    *translate_z = info->translation.z;
+  cogl_matrix_init_identity (&modelview);
+  clutter_actor_compute_occlusion_internal (self, &modelview,
+                                            projection,
+                                            viewport,
+                                            TRUE,
+                                            &paint_index,
+                                            occlusion);
 }
 
-/*< private >
- * clutter_actor_set_rotation_angle_internal:
- * @self: a #ClutterActor
- * @angle: the angle of rotation
- * @pspec: the #GParamSpec of the property
- *
- * Sets the rotation angle on the given axis without affecting the
- * rotation center point.
+/* Returns TRUE if the actor, and all of its children, are hidden
+ * behind an opaque actor that is painted after them
  */
-static inline void
-clutter_actor_set_rotation_angle_internal (ClutterActor *self,
-                                           gdouble       angle,
-                                           GParamSpec   *pspec)
+static gboolean
+occlude_actor (ClutterActor *self)
 {
-  ClutterTransformInfo *info;
+  ClutterActorPrivate *priv = self->priv;
+  const ClutterOcclusion *occlusion;
+  ClutterActorBox box;
+  ClutterActor *stage;
+  guint i;
 
-  info = _clutter_actor_get_transform_info (self);
+  if (!priv->last_paint_volume_valid)
+    return FALSE;
 
-  if (pspec == obj_props[PROP_ROTATION_ANGLE_X])
-    info->rx_angle = angle;
-  else if (pspec == obj_props[PROP_ROTATION_ANGLE_Y])
-    info->ry_angle = angle;
-  else if (pspec == obj_props[PROP_ROTATION_ANGLE_Z])
-    info->rz_angle = angle;
-  else
-    g_assert_not_reached ();
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_DISABLE_CULLING))
+    return FALSE;
 
-  self->priv->transform_valid = FALSE;
+  stage = _clutter_actor_get_stage_internal (self);
+  occlusion = _clutter_stage_get_occlusion (CLUTTER_STAGE (stage));
+  if (occlusion->n_occluders == 0 ||
+      priv->occlusion_serial != occlusion->serial)
+    return FALSE;
 
-  clutter_actor_queue_redraw (self);
+  if (cogl_get_draw_framebuffer () !=
+      _clutter_stage_get_active_framebuffer (CLUTTER_STAGE (stage)))
+    return FALSE;
 
-  g_object_notify_by_pspec (G_OBJECT (self), pspec);
+  _clutter_paint_volume_get_stage_paint_box (&priv->last_paint_volume,
+                                             CLUTTER_STAGE (stage),
+                                             &box);
+
+  for (i = 0; i < occlusion->n_occluders; i++)
+    {
+      const ClutterOccluder *occluder = &occlusion->occluders[i];
+
+      if (occluder->paint_index > priv->paint_index_last &&
+          occluder->box.x1 <= box.x1 &&
+          occluder->box.y1 <= box.y1 &&
+          occluder->box.x2 >= box.x2 &&
+          occluder->box.y2 >= box.y2)
+        {
+          CLUTTER_NOTE (CLIPPING, "Skipping occluded actor '%s'",
+                        _clutter_actor_get_debug_name (self));
+          return TRUE;
+        }
+    }
+
+  return FALSE;
 }
 
-/**
- * clutter_actor_set_rotation_angle:
- * @self: a #ClutterActor
- * @axis: the axis to set the angle one
- * @angle: the angle of rotation, in degrees
- *
- * Sets the @angle of rotation of a #ClutterActor on the given @axis.
- *
- * This function is a convenience for setting the rotation properties
- * #ClutterActor:rotation-angle-x, #ClutterActor:rotation-angle-y,
- * and #ClutterActor:rotation-angle-z.
- *
- * The center of rotation is established by the #ClutterActor:pivot-point
- * property.
- *
- *
+/* Keeps the pick index of the stage in sync with the projected
+ * allocation of a reactive actor; this is called when painting,
+ * like _clutter_actor_update_last_paint_volume()
  */
-void
-clutter_actor_set_rotation_angle (ClutterActor      *self,
-                                  ClutterRotateAxis  axis,
-                                  gdouble            angle)
+static void
+_clutter_actor_update_pick_index (ClutterActor *self)
 {
-  const ClutterTransformInfo *info;
-  const double *cur_angle_p = NULL;
-  GParamSpec *pspec = NULL;
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox box, stage_box;
+  ClutterVertex verts[4];
+  ClutterActor *stage;
+  int i;
 
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  /* the stage is picked when nothing else is */
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self))
+    return;
 
-  info = _clutter_actor_get_transform_info_or_defaults (self);
+  if (!CLUTTER_ACTOR_IS_REACTIVE (self) && priv->pick_index_handle < 0)
+    return;
 
-  switch (axis)
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL)
+    return;
+
+  if (!CLUTTER_ACTOR_IS_REACTIVE (self))
     {
-    case CLUTTER_X_AXIS:
-      cur_angle_p = &info->rx_angle;
-      pspec = obj_props[PROP_ROTATION_ANGLE_X];
-      break;
+      _clutter_stage_remove_from_pick_index (CLUTTER_STAGE (stage),
+                                             &priv->pick_index_handle);
+      return;
+    }
 
-    case CLUTTER_Y_AXIS:
-      cur_angle_p = &info->ry_angle;
-      pspec = obj_props[PROP_ROTATION_ANGLE_Y];
-      break;
+  box.x1 = 0.f;
+  box.y1 = 0.f;
+  box.x2 = clutter_actor_box_get_width (&priv->allocation);
+  box.y2 = clutter_actor_box_get_height (&priv->allocation);
 
-    case CLUTTER_Z_AXIS:
-      cur_angle_p = &info->rz_angle;
-      pspec = obj_props[PROP_ROTATION_ANGLE_Z];
-      break;
+  /* if we are painting directly on the stage, the current modelview
+   * already contains the transformation of the actor; otherwise we
+   * need to compute it from the scene graph
+   */
+  if (priv->enable_model_view_transform &&
+      cogl_get_draw_framebuffer () ==
+      _clutter_stage_get_active_framebuffer (CLUTTER_STAGE (stage)))
+    {
+      ClutterVertex box_vertices[4];
+      CoglMatrix modelview, projection;
+      float viewport[4];
+
+      box_vertices[0].x = box.x1; box_vertices[0].y = box.y1; box_vertices[0].z = 0.f;
+      box_vertices[1].x = box.x2; box_vertices[1].y = box.y1; box_vertices[1].z = 0.f;
+      box_vertices[2].x = box.x1; box_vertices[2].y = box.y2; box_vertices[2].z = 0.f;
+      box_vertices[3].x = box.x2; box_vertices[3].y = box.y2; box_vertices[3].z = 0.f;
+
+      cogl_get_modelview_matrix (&modelview);
+      _clutter_stage_get_projection_matrix (CLUTTER_STAGE (stage), &projection);
+      _clutter_stage_get_viewport (CLUTTER_STAGE (stage),
+                                   &viewport[0],
+                                   &viewport[1],
+                                   &viewport[2],
+                                   &viewport[3]);
+
+      _clutter_util_fully_transform_vertices (&modelview,
+                                              &projection,
+                                              viewport,
+                                              box_vertices,
+                                              verts,
+                                              4);
     }
+  else if (!_clutter_actor_transform_and_project_box (self, &box, verts))
+    return;
 
-  g_assert (pspec != NULL);
-  g_assert (cur_angle_p != NULL);
+  stage_box.x1 = stage_box.x2 = verts[0].x;
+  stage_box.y1 = stage_box.y2 = verts[0].y;
 
-  _clutter_actor_create_transition (self, pspec, *cur_angle_p, angle);
+  for (i = 1; i < 4; i++)
+    {
+      stage_box.x1 = MIN (stage_box.x1, verts[i].x);
+      stage_box.y1 = MIN (stage_box.y1, verts[i].y);
+      stage_box.x2 = MAX (stage_box.x2, verts[i].x);
+      stage_box.y2 = MAX (stage_box.y2, verts[i].y);
+    }
+
+  _clutter_stage_update_pick_index (CLUTTER_STAGE (stage), self,
+                                    &priv->pick_index_handle,
+                                    &stage_box);
 }
 
-/**
- * clutter_actor_get_rotation_angle:
- * @self: a #ClutterActor
- * @axis: the axis of the rotation
- *
- * Retrieves the angle of rotation set by clutter_actor_set_rotation_angle().
- *
- * Return value: the angle of rotation, in degrees
- *
- *
- */
-gdouble
-clutter_actor_get_rotation_angle (ClutterActor      *self,
-                                  ClutterRotateAxis  axis)
+static void
+_clutter_actor_update_last_paint_volume (ClutterActor *self)
 {
-  const ClutterTransformInfo *info;
-  gdouble retval;
+  ClutterActorPrivate *priv = self->priv;
+  const ClutterPaintVolume *pv;
+  ClutterActor *stage;
+  guint view_generation = 0;
 
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0.0);
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage != NULL)
+    view_generation = _clutter_stage_get_view_generation (CLUTTER_STAGE (stage));
 
-  info = _clutter_actor_get_transform_info_or_defaults (self);
+  /* the volume in eye coordinates only changes with the paint volume,
+   * with the transformation to the stage, and with the view of the
+   * stage; if none of them changed since the last paint, we can avoid
+   * transforming the volume again
+   */
+  pv = clutter_actor_get_paint_volume (self);
+  if (pv != NULL &&
+      priv->last_paint_volume_valid &&
+      priv->last_paint_volume_cached &&
+      priv->stage_transform_valid &&
+      priv->last_paint_volume_view == view_generation)
+    return;
 
-  switch (axis)
+  if (priv->last_paint_volume_valid)
     {
-    case CLUTTER_X_AXIS:
-      retval = info->rx_angle;
-      break;
-
-    case CLUTTER_Y_AXIS:
-      retval = info->ry_angle;
-      break;
+      clutter_paint_volume_free (&priv->last_paint_volume);
+      priv->last_paint_volume_valid = FALSE;
+    }
 
-    case CLUTTER_Z_AXIS:
-      retval = info->rz_angle;
-      break;
+  priv->last_paint_volume_cached = FALSE;
 
-    default:
-      g_warn_if_reached ();
-      retval = 0.0;
-      break;
+  if (!pv)
+    {
+      CLUTTER_NOTE (CLIPPING, "Bail from update_last_paint_volume (%s): "
+                    "Actor failed to report a paint volume",
+                    _clutter_actor_get_debug_name (self));
+      return;
     }
 
-  return retval;
-}
-
-static void
-clutter_actor_set_scale_factor_internal (ClutterActor *self,
-                                         double factor,
-                                         GParamSpec *pspec)
-{
-  GObject *obj = G_OBJECT (self);
-  ClutterTransformInfo *info;
+  _clutter_paint_volume_copy_static (pv, &priv->last_paint_volume);
 
-  info = _clutter_actor_get_transform_info (self);
+  _clutter_paint_volume_transform_relative (&priv->last_paint_volume,
+                                            NULL); /* eye coordinates */
 
-  if (pspec == obj_props[PROP_SCALE_X])
-    info->scale_x = factor;
-  else if (pspec == obj_props[PROP_SCALE_Y])
-    info->scale_y = factor;
-  else if (pspec == obj_props[PROP_SCALE_Z])
-    info->scale_z = factor;
-  else
-    g_assert_not_reached ();
+  priv->last_paint_volume_valid = TRUE;
 
-  self->priv->transform_valid = FALSE;
-  clutter_actor_queue_redraw (self);
-  g_object_notify_by_pspec (obj, pspec);
+  /* the transformation is only cached, and invalidated, when it does
+   * not depend on an overridden apply_transform()
+   */
+  priv->last_paint_volume_cached = priv->stage_transform_valid;
+  priv->last_paint_volume_view = view_generation;
 }
 
-static inline void
-clutter_actor_set_scale_factor (ClutterActor      *self,
-                                ClutterRotateAxis  axis,
-                                gdouble            factor)
+guint32
+_clutter_actor_get_pick_id (ClutterActor *self)
 {
-  const ClutterTransformInfo *info;
-  const double *scale_p = NULL;
-  GParamSpec *pspec = NULL;
+  if (self->priv->pick_id < 0)
+    return 0;
 
-  info = _clutter_actor_get_transform_info_or_defaults (self);
+  return self->priv->pick_id;
+}
 
-  switch (axis)
+/* This is the same as clutter_actor_add_effect except that it doesn't
+   queue a redraw and it doesn't notify on the effect property */
+static void
+_clutter_actor_add_effect_internal (ClutterActor  *self,
+                                    ClutterEffect *effect)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (priv->effects == NULL)
     {
-    case CLUTTER_X_AXIS:
-      pspec = obj_props[PROP_SCALE_X];
-      scale_p = &info->scale_x;
-      break;
+      priv->effects = g_object_new (CLUTTER_TYPE_META_GROUP, NULL);
+      priv->effects->actor = self;
+    }
 
-    case CLUTTER_Y_AXIS:
-      pspec = obj_props[PROP_SCALE_Y];
-      scale_p = &info->scale_y;
-      break;
+  _clutter_meta_group_add_meta (priv->effects, CLUTTER_ACTOR_META (effect));
+}
 
-    case CLUTTER_Z_AXIS:
-      pspec = obj_props[PROP_SCALE_Z];
-      scale_p = &info->scale_z;
-      break;
-    }
+/* This is the same as clutter_actor_remove_effect except that it doesn't
+   queue a redraw and it doesn't notify on the effect property */
+static void
+_clutter_actor_remove_effect_internal (ClutterActor  *self,
+                                       ClutterEffect *effect)
+{
+  ClutterActorPrivate *priv = self->priv;
 
-  g_assert (pspec != NULL);
-  g_assert (scale_p != NULL);
+  if (priv->effects == NULL)
+    return;
 
-  _clutter_actor_create_transition (self, pspec, *scale_p, factor);
+  _clutter_meta_group_remove_meta (priv->effects, CLUTTER_ACTOR_META (effect));
+
+  if (_clutter_meta_group_peek_metas (priv->effects) == NULL)
+    g_clear_object (&priv->effects);
 }
 
 static void
-clutter_actor_set_clip_rect (ClutterActor      *self,
-                             const ClutterRect *clip)
+clutter_actor_release_cache_area (ClutterActor *self)
 {
   ClutterActorPrivate *priv = self->priv;
-  GObject *obj = G_OBJECT (self);
 
-  if (clip != NULL)
+  if (priv->cache_area > 0.f)
     {
-      priv->clip = *clip;
-      priv->has_clip = TRUE;
+      cache_total_area = MAX (cache_total_area - priv->cache_area, 0.f);
+      priv->cache_area = 0.f;
     }
-  else
-    priv->has_clip = FALSE;
+}
 
-  clutter_actor_queue_redraw (self);
+static guint
+clutter_actor_count_descendants (ClutterActor *self,
+                                 guint         max_count)
+{
+  ClutterActor *iter;
+  guint count = 0;
 
-  g_object_notify_by_pspec (obj, obj_props[PROP_CLIP_RECT]);
-  g_object_notify_by_pspec (obj, obj_props[PROP_HAS_CLIP]);
+  for (iter = self->priv->first_child;
+       iter != NULL && count < max_count;
+       iter = iter->priv->next_sibling)
+    {
+      count += 1;
+      count += clutter_actor_count_descendants (iter, max_count - count);
+    }
+
+  return count;
 }
 
-static void
-clutter_actor_set_property (GObject      *object,
-			    guint         prop_id,
-			    const GValue *value,
-			    GParamSpec   *pspec)
+static gboolean
+clutter_actor_needs_caching (ClutterActor *self)
 {
-  ClutterActor *actor = CLUTTER_ACTOR (object);
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox box;
+  guint min_static_paints;
+  gfloat area;
 
-  switch (prop_id)
+  if (priv->is_damaged)
     {
-    case PROP_X:
-      clutter_actor_set_x (actor, g_value_get_float (value));
-      break;
+      /* the cached image is not valid any more; painting it again
+       * would mean painting the actor twice, so we drop it and wait
+       * longer before caching the actor again
+       */
+      if (priv->cache_area > 0.f)
+        {
+          CLUTTER_NOTE (PAINT, "Dropping the cached image of '%s'",
+                        _clutter_actor_get_debug_name (self));
 
-    case PROP_Y:
-      clutter_actor_set_y (actor, g_value_get_float (value));
-      break;
+          clutter_actor_release_cache_area (self);
+          priv->cache_misses = MIN (priv->cache_misses + 1,
+                                    CACHE_MAX_BACKOFF);
+        }
 
-    case PROP_POSITION:
-      {
-        const ClutterPoint *pos = g_value_get_boxed (value);
+      priv->static_paints = 0;
 
-        if (pos != NULL)
-          clutter_actor_set_position (actor, pos->x, pos->y);
-        else
-          clutter_actor_set_fixed_position_set (actor, FALSE);
-      }
-      break;
+      return FALSE;
+    }
 
-    case PROP_WIDTH:
-      clutter_actor_set_width (actor, g_value_get_float (value));
-      break;
+  if (priv->cache_area > 0.f)
+    return TRUE;
 
-    case PROP_HEIGHT:
-      clutter_actor_set_height (actor, g_value_get_float (value));
-      break;
+  min_static_paints = CACHE_MIN_STATIC_PAINTS << priv->cache_misses;
+  if (priv->static_paints < min_static_paints)
+    {
+      priv->static_paints += 1;
+      return FALSE;
+    }
 
-    case PROP_SIZE:
-      {
-        const ClutterSize *size = g_value_get_boxed (value);
+  if (clutter_actor_count_descendants (self, CACHE_MIN_DESCENDANTS) <
+      CACHE_MIN_DESCENDANTS)
+    return FALSE;
 
-        if (size != NULL)
-          clutter_actor_set_size (actor, size->width, size->height);
-        else
-          clutter_actor_set_size (actor, -1, -1);
-      }
-      break;
+  if (!clutter_actor_get_paint_box (self, &box))
+    return FALSE;
 
-    case PROP_FIXED_X:
-      clutter_actor_set_x (actor, g_value_get_float (value));
-      break;
+  area = MAX (clutter_actor_box_get_area (&box), 1.f);
+  if (cache_total_area + area > CACHE_MAX_AREA)
+    return FALSE;
 
-    case PROP_FIXED_Y:
-      clutter_actor_set_y (actor, g_value_get_float (value));
-      break;
+  CLUTTER_NOTE (PAINT, "Caching the image of '%s' (%.0f pixels)",
+                _clutter_actor_get_debug_name (self),
+                area);
 
-    case PROP_FIXED_POSITION_SET:
-      clutter_actor_set_fixed_position_set (actor, g_value_get_boolean (value));
-      break;
+  priv->cache_area = area;
+  cache_total_area += area;
 
-    case PROP_MIN_WIDTH:
-      clutter_actor_set_min_width (actor, g_value_get_float (value));
-      break;
+  return TRUE;
+}
 
-    case PROP_MIN_HEIGHT:
-      clutter_actor_set_min_height (actor, g_value_get_float (value));
-      break;
+static gboolean
+needs_flatten_effect (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  gboolean needs_caching = FALSE;
 
-    case PROP_NATURAL_WIDTH:
-      clutter_actor_set_natural_width (actor, g_value_get_float (value));
-      break;
+  if (G_UNLIKELY (clutter_paint_debug_flags &
+                  CLUTTER_DEBUG_DISABLE_OFFSCREEN_REDIRECT))
+    {
+      clutter_actor_release_cache_area (self);
+      return FALSE;
+    }
 
-    case PROP_NATURAL_HEIGHT:
-      clutter_actor_set_natural_height (actor, g_value_get_float (value));
-      break;
+  /* the paint counting needs to happen on every paint */
+  if (priv->offscreen_redirect & CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_CACHING)
+    needs_caching = clutter_actor_needs_caching (self);
+  else
+    clutter_actor_release_cache_area (self);
 
-    case PROP_MIN_WIDTH_SET:
-      clutter_actor_set_min_width_set (actor, g_value_get_boolean (value));
-      break;
+  if (priv->offscreen_redirect & CLUTTER_OFFSCREEN_REDIRECT_ALWAYS)
+    return TRUE;
+  else if (priv->offscreen_redirect & CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_OPACITY)
+    {
+      if (clutter_actor_get_paint_opacity (self) < 255 &&
+          clutter_actor_has_overlaps (self))
+        return TRUE;
+    }
 
-    case PROP_MIN_HEIGHT_SET:
-      clutter_actor_set_min_height_set (actor, g_value_get_boolean (value));
-      break;
+  return needs_caching;
+}
 
-    case PROP_NATURAL_WIDTH_SET:
-      clutter_actor_set_natural_width_set (actor, g_value_get_boolean (value));
-      break;
+static void
+add_or_remove_flatten_effect (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
 
-    case PROP_NATURAL_HEIGHT_SET:
-      clutter_actor_set_natural_height_set (actor, g_value_get_boolean (value));
-      break;
-
-    case PROP_REQUEST_MODE:
-      clutter_actor_set_request_mode (actor, g_value_get_enum (value));
-      break;
+  /* Add or remove the flatten effect depending on the
+     offscreen-redirect property. */
+  if (needs_flatten_effect (self))
+    {
+      if (priv->flatten_effect == NULL)
+        {
+          ClutterActorMeta *actor_meta;
+          gint priority;
 
-    case PROP_Z_POSITION:
-      clutter_actor_set_z_position (actor, g_value_get_float (value));
-      break;
+          priv->flatten_effect = _clutter_flatten_effect_new ();
+          /* Keep a reference to the effect so that we can queue
+             redraws from it */
+          g_object_ref_sink (priv->flatten_effect);
 
-    case PROP_OPACITY:
-      clutter_actor_set_opacity (actor, g_value_get_uint (value));
-      break;
+          /* Set the priority of the effect to high so that it will
+             always be applied to the actor first. It uses an internal
+             priority so that it won't be visible to applications */
+          actor_meta = CLUTTER_ACTOR_META (priv->flatten_effect);
+          priority = CLUTTER_ACTOR_META_PRIORITY_INTERNAL_HIGH;
+          _clutter_actor_meta_set_priority (actor_meta, priority);
 
-    case PROP_OFFSCREEN_REDIRECT:
-      clutter_actor_set_offscreen_redirect (actor, g_value_get_enum (value));
-      break;
+          /* This will add the effect without queueing a redraw */
+          _clutter_actor_add_effect_internal (self, priv->flatten_effect);
+        }
+    }
+  else
+    {
+      if (priv->flatten_effect != NULL)
+        {
+          /* Destroy the effect so that it will lose its fbo cache of
+             the actor */
+          _clutter_actor_remove_effect_internal (self, priv->flatten_effect);
+          g_clear_object (&priv->flatten_effect);
+        }
+    }
+}
 
-    case PROP_NAME:
-      clutter_actor_set_name (actor, g_value_get_string (value));
-      break;
+static void
+clutter_actor_real_paint (ClutterActor *actor)
+{
+  ClutterActorPrivate *priv = actor->priv;
+  ClutterActor *iter;
 
-    case PROP_VISIBLE:
-      if (g_value_get_boolean (value) == TRUE)
-	clutter_actor_show (actor);
-      else
-	clutter_actor_hide (actor);
-      break;
+  for (iter = priv->first_child;
+       iter != NULL;
+       iter = iter->priv->next_sibling)
+    {
+      CLUTTER_NOTE (PAINT, "Painting %s, child of %s, at { %.2f, %.2f - %.2f x %.2f }",
+                    _clutter_actor_get_debug_name (iter),
+                    _clutter_actor_get_debug_name (actor),
+                    iter->priv->allocation.x1,
+                    iter->priv->allocation.y1,
+                    iter->priv->allocation.x2 - iter->priv->allocation.x1,
+                    iter->priv->allocation.y2 - iter->priv->allocation.y1);
 
-    case PROP_PIVOT_POINT:
-      {
-        const ClutterPoint *pivot = g_value_get_boxed (value);
+      clutter_actor_paint (iter);
+    }
+}
 
-        if (pivot == NULL)
-          pivot = clutter_point_zero ();
+static gboolean
+clutter_actor_real_get_opaque_box (ClutterActor    *self,
+                                   ClutterActorBox *box)
+{
+  ClutterActorPrivate *priv = self->priv;
 
-        clutter_actor_set_pivot_point (actor, pivot->x, pivot->y);
-      }
-      break;
+  /* the background color covers the whole allocation */
+  if (priv->bg_color_set && priv->bg_color.alpha == 255)
+    {
+      box->x1 = 0.f;
+      box->y1 = 0.f;
+      box->x2 = clutter_actor_box_get_width (&priv->allocation);
+      box->y2 = clutter_actor_box_get_height (&priv->allocation);
 
-    case PROP_PIVOT_POINT_Z:
-      clutter_actor_set_pivot_point_z (actor, g_value_get_float (value));
-      break;
+      return TRUE;
+    }
 
-    case PROP_TRANSLATION_X:
-      clutter_actor_set_translation_factor (actor, CLUTTER_X_AXIS,
-                                            g_value_get_float (value));
-      break;
+  if (priv->content != NULL && _clutter_content_is_opaque (priv->content))
+    {
+      clutter_actor_get_content_box (self, box);
 
-    case PROP_TRANSLATION_Y:
-      clutter_actor_set_translation_factor (actor, CLUTTER_Y_AXIS,
-                                            g_value_get_float (value));
-      break;
+      return TRUE;
+    }
 
-    case PROP_TRANSLATION_Z:
-      clutter_actor_set_translation_factor (actor, CLUTTER_Z_AXIS,
-                                            g_value_get_float (value));
-      break;
+  return FALSE;
+}
 
-    case PROP_SCALE_X:
-      clutter_actor_set_scale_factor (actor, CLUTTER_X_AXIS,
-                                      g_value_get_double (value));
-      break;
+/* Drops the retained render tree of @self, so that it is built
+ * again the next time the actor is painted
+ */
+static inline void
+clutter_actor_invalidate_paint_node (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
 
-    case PROP_SCALE_Y:
-      clutter_actor_set_scale_factor (actor, CLUTTER_Y_AXIS,
-                                      g_value_get_double (value));
-      break;
+  if (priv->paint_node != NULL)
+    {
+      clutter_paint_node_unref (priv->paint_node);
+      priv->paint_node = NULL;
+    }
+}
 
-    case PROP_SCALE_Z:
-      clutter_actor_set_scale_factor (actor, CLUTTER_Z_AXIS,
-                                      g_value_get_double (value));
-      break;
+static void
+clutter_actor_add_background_node (ClutterActor     *actor,
+                                   ClutterPaintNode *root)
+{
+  ClutterActorPrivate *priv = actor->priv;
 
-    case PROP_CLIP_RECT:
-      clutter_actor_set_clip_rect (actor, g_value_get_boxed (value));
-      break;
+  if (priv->bg_color_set &&
+      !clutter_color_equal (&priv->bg_color, CLUTTER_COLOR_Transparent))
+    {
+      ClutterPaintNode *node;
+      ClutterColor bg_color;
+      ClutterActorBox box;
 
-    case PROP_CLIP_TO_ALLOCATION:
-      clutter_actor_set_clip_to_allocation (actor, g_value_get_boolean (value));
-      break;
+      box.x1 = 0.f;
+      box.y1 = 0.f;
+      box.x2 = clutter_actor_box_get_width (&priv->allocation);
+      box.y2 = clutter_actor_box_get_height (&priv->allocation);
 
-    case PROP_REACTIVE:
-      clutter_actor_set_reactive (actor, g_value_get_boolean (value));
-      break;
+      bg_color = priv->bg_color;
+      bg_color.alpha = clutter_actor_get_paint_opacity_internal (actor)
+                     * priv->bg_color.alpha
+                     / 255;
 
-    case PROP_ROTATION_ANGLE_X:
-      clutter_actor_set_rotation_angle (actor,
-                                        CLUTTER_X_AXIS,
-                                        g_value_get_double (value));
-      break;
+      node = clutter_color_node_new (&bg_color);
+      clutter_paint_node_set_name (node, "backgroundColor");
+      clutter_paint_node_add_rectangle (node, &box);
+      clutter_paint_node_add_child (root, node);
+      clutter_paint_node_unref (node);
+    }
+}
 
-    case PROP_ROTATION_ANGLE_Y:
-      clutter_actor_set_rotation_angle (actor,
-                                        CLUTTER_Y_AXIS,
-                                        g_value_get_double (value));
-      break;
+static void
+clutter_actor_build_paint_node (ClutterActor     *actor,
+                                ClutterPaintNode *root)
+{
+  ClutterActorPrivate *priv = actor->priv;
 
-    case PROP_ROTATION_ANGLE_Z:
-      clutter_actor_set_rotation_angle (actor,
-                                        CLUTTER_Z_AXIS,
-                                        g_value_get_double (value));
-      break;
+  clutter_actor_add_background_node (actor, root);
 
-    case PROP_TRANSFORM:
-      clutter_actor_set_transform (actor, g_value_get_boxed (value));
-      break;
+  if (priv->content != NULL)
+    _clutter_content_paint_content (priv->content, actor, root);
 
-    case PROP_CHILD_TRANSFORM:
-      clutter_actor_set_child_transform (actor, g_value_get_boxed (value));
-      break;
+  if (CLUTTER_ACTOR_GET_CLASS (actor)->paint_node != NULL)
+    CLUTTER_ACTOR_GET_CLASS (actor)->paint_node (actor, root);
+}
 
-    case PROP_TEXT_DIRECTION:
-      clutter_actor_set_text_direction (actor, g_value_get_enum (value));
-      break;
+static gboolean
+clutter_actor_paint_node (ClutterActor *actor)
+{
+  ClutterActorPrivate *priv = actor->priv;
+  ClutterPaintNode *root;
+  guint8 paint_opacity;
 
-    case PROP_ACTIONS:
-      clutter_actor_add_action (actor, g_value_get_object (value));
-      break;
+  /* the sources of a clone are painted with a different opacity, so
+   * we build a temporary render tree instead of trashing the one we
+   * retain for the normal paint
+   */
+  if (in_clone_paint ())
+    {
+      gboolean res;
 
-    case PROP_CONSTRAINTS:
-      clutter_actor_add_constraint (actor, g_value_get_object (value));
-      break;
+      root = _clutter_dummy_node_new (actor);
+      clutter_paint_node_set_name (root, "Root");
 
-    case PROP_EFFECT:
-      clutter_actor_add_effect (actor, g_value_get_object (value));
-      break;
+      clutter_actor_build_paint_node (actor, root);
 
-    case PROP_LAYOUT_MANAGER:
-      clutter_actor_set_layout_manager (actor, g_value_get_object (value));
-      break;
+      res = clutter_paint_node_get_n_children (root) != 0;
+      if (res)
+        _clutter_paint_node_paint (root);
 
-    case PROP_X_EXPAND:
-      clutter_actor_set_x_expand (actor, g_value_get_boolean (value));
-      break;
+      clutter_paint_node_unref (root);
 
-    case PROP_Y_EXPAND:
-      clutter_actor_set_y_expand (actor, g_value_get_boolean (value));
-      break;
+      return res;
+    }
 
-    case PROP_X_ALIGN:
-      clutter_actor_set_x_align (actor, g_value_get_enum (value));
-      break;
+  /* the paint opacity depends on the ancestors of the actor, which
+   * will not queue a redraw on us when their opacity changes
+   */
+  paint_opacity = clutter_actor_get_paint_opacity_internal (actor);
+  if (priv->paint_node != NULL && priv->paint_node_opacity != paint_opacity)
+    clutter_actor_invalidate_paint_node (actor);
 
-    case PROP_Y_ALIGN:
-      clutter_actor_set_y_align (actor, g_value_get_enum (value));
-      break;
+  /* some contents only paint what is visible on the stage */
+  if (priv->paint_node != NULL &&
+      priv->content != NULL &&
+      _clutter_content_is_view_dependent (priv->content))
+    clutter_actor_invalidate_paint_node (actor);
 
-    case PROP_MARGIN_TOP:
-      clutter_actor_set_margin_top (actor, g_value_get_float (value));
-      break;
+  if (priv->paint_node == NULL)
+    {
+      priv->paint_node = _clutter_dummy_node_new (actor);
+      clutter_paint_node_set_name (priv->paint_node, "Root");
 
-    case PROP_MARGIN_BOTTOM:
-      clutter_actor_set_margin_bottom (actor, g_value_get_float (value));
-      break;
+      clutter_actor_build_paint_node (actor, priv->paint_node);
+      priv->paint_node_opacity = paint_opacity;
+    }
 
-    case PROP_MARGIN_LEFT:
-      clutter_actor_set_margin_left (actor, g_value_get_float (value));
-      break;
+  root = priv->paint_node;
 
-    case PROP_MARGIN_RIGHT:
-      clutter_actor_set_margin_right (actor, g_value_get_float (value));
-      break;
+  if (clutter_paint_node_get_n_children (root) == 0)
+    return FALSE;
 
-    case PROP_BACKGROUND_COLOR:
-      clutter_actor_set_background_color (actor, g_value_get_boxed (value));
-      break;
+#ifdef CLUTTER_ENABLE_DEBUG
+  if (CLUTTER_HAS_DEBUG (PAINT))
+    {
+      /* dump the tree only if we have one */
+      _clutter_paint_node_dump_tree (root);
+    }
+#endif /* CLUTTER_ENABLE_DEBUG */
 
-    case PROP_CONTENT:
-      clutter_actor_set_content (actor, g_value_get_object (value));
-      break;
+  _clutter_paint_node_paint (root);
 
-    case PROP_CONTENT_GRAVITY:
-      clutter_actor_set_content_gravity (actor, g_value_get_enum (value));
-      break;
+  return TRUE;
+}
 
-    case PROP_MINIFICATION_FILTER:
-      clutter_actor_set_content_scaling_filters (actor,
-                                                 g_value_get_enum (value),
-                                                 actor->priv->mag_filter);
-      break;
+/* checks whether @self is smaller on the stage than its LOD threshold,
+ * using the paint volume that was just updated for culling
+ */
+static gboolean
+clutter_actor_should_collapse (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox box;
+  ClutterActor *stage;
 
-    case PROP_MAGNIFICATION_FILTER:
-      clutter_actor_set_content_scaling_filters (actor,
-                                                 actor->priv->min_filter,
-                                                 g_value_get_enum (value));
-      break;
+  if (priv->lod == NULL ||
+      priv->lod->threshold <= 0.f ||
+      !priv->last_paint_volume_valid)
+    return FALSE;
 
-    case PROP_CONTENT_REPEAT:
-      clutter_actor_set_content_repeat (actor, g_value_get_flags (value));
-      break;
+  /* the paint box is relative to the stage, so it is not meaningful
+   * when painting inside an offscreen buffer
+   */
+  stage = _clutter_actor_get_stage_internal (self);
+  if (cogl_get_draw_framebuffer () !=
+      _clutter_stage_get_active_framebuffer (CLUTTER_STAGE (stage)))
+    return FALSE;
 
-    default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
-      break;
-    }
+  _clutter_paint_volume_get_stage_paint_box (&priv->last_paint_volume,
+                                             CLUTTER_STAGE (stage),
+                                             &box);
+
+  return box.x2 - box.x1 < priv->lod->threshold &&
+         box.y2 - box.y1 < priv->lod->threshold;
 }
 
+/* paints the placeholder of a collapsed actor, in place of its
+ * effects, its contents and its children
+ */
 static void
-clutter_actor_get_property (GObject    *object,
-			    guint       prop_id,
-			    GValue     *value,
-			    GParamSpec *pspec)
+clutter_actor_paint_collapsed (ClutterActor    *self,
+                               ClutterPickMode  pick_mode)
 {
-  ClutterActor *actor = CLUTTER_ACTOR (object);
-  ClutterActorPrivate *priv = actor->priv;
+  ClutterActorPrivate *priv = self->priv;
+  ClutterPaintNode *root;
 
-  switch (prop_id)
+  if (pick_mode != CLUTTER_PICK_NONE)
     {
-    case PROP_X:
-      g_value_set_float (value, clutter_actor_get_x (actor));
-      break;
+      if (clutter_actor_should_pick_paint (self))
+        {
+          ClutterColor col = { 0, };
 
-    case PROP_Y:
-      g_value_set_float (value, clutter_actor_get_y (actor));
-      break;
+          _clutter_id_to_color (_clutter_actor_get_pick_id (self), &col);
+          clutter_actor_pick_silhouette (self, &col);
+        }
 
-    case PROP_POSITION:
-      {
-        ClutterPoint position;
+      return;
+    }
 
-        clutter_point_init (&position,
-                            clutter_actor_get_x (actor),
-                            clutter_actor_get_y (actor));
-        g_value_set_boxed (value, &position);
-      }
-      break;
+  root = _clutter_dummy_node_new (self);
+  clutter_paint_node_set_name (root, "Placeholder");
 
-    case PROP_WIDTH:
-      g_value_set_float (value, clutter_actor_get_width (actor));
-      break;
+  clutter_actor_add_background_node (self, root);
 
-    case PROP_HEIGHT:
-      g_value_set_float (value, clutter_actor_get_height (actor));
-      break;
+  if (priv->lod->placeholder != NULL)
+    _clutter_content_paint_content (priv->lod->placeholder, self, root);
 
-    case PROP_SIZE:
-      {
-        ClutterSize size;
+  if (clutter_paint_node_get_n_children (root) != 0)
+    _clutter_paint_node_paint (root);
 
-        clutter_size_init (&size,
-                           clutter_actor_get_width (actor),
-                           clutter_actor_get_height (actor));
-        g_value_set_boxed (value, &size);
-      }
-      break;
+  clutter_paint_node_unref (root);
 
-    case PROP_FIXED_X:
-      {
-        const ClutterLayoutInfo *info;
+  priv->was_painted = TRUE;
+}
 
-        info = _clutter_actor_get_layout_info_or_defaults (actor);
-        g_value_set_float (value, info->fixed_pos.x);
-      }
-      break;
+/**
+ * clutter_actor_paint:
+ * @self: A #ClutterActor
+ *
+ * Renders the actor to display.
+ *
+ * This function should not be called directly by applications.
+ * Call clutter_actor_queue_redraw() to queue paints, instead.
+ *
+ * This function is context-aware, and will either cause a
+ * regular paint or a pick paint.
+ *
+ * This function will emit the #ClutterActor::paint signal or
+ * the #ClutterActor::pick signal, depending on the context.
+ *
+ * This function does not paint the actor if the actor is set to 0,
+ * unless it is performing a pick paint.
+ */
+void
+clutter_actor_paint (ClutterActor *self)
+{
+  ClutterActorPrivate *priv;
+  ClutterPickMode pick_mode;
+  gboolean clip_set = FALSE;
+  gboolean measure_cost;
 
-    case PROP_FIXED_Y:
-      {
-        const ClutterLayoutInfo *info;
+  CLUTTER_STATIC_COUNTER (actor_paint_counter,
+                          "Actor real-paint counter",
+                          "Increments each time any actor is painted",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (actor_pick_counter,
+                          "Actor pick-paint counter",
+                          "Increments each time any actor is painted "
+                          "for picking",
+                          0 /* no application private data */);
 
-        info = _clutter_actor_get_layout_info_or_defaults (actor);
-        g_value_set_float (value, info->fixed_pos.y);
-      }
-      break;
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-    case PROP_FIXED_POSITION_SET:
-      g_value_set_boolean (value, priv->position_set);
-      break;
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return;
 
-    case PROP_MIN_WIDTH:
-      {
-        const ClutterLayoutInfo *info;
+  priv = self->priv;
 
-        info = _clutter_actor_get_layout_info_or_defaults (actor);
-        g_value_set_float (value, info->minimum.width);
-      }
-      break;
+  pick_mode = _clutter_context_get_pick_mode ();
 
-    case PROP_MIN_HEIGHT:
-      {
-        const ClutterLayoutInfo *info;
+  if (pick_mode == CLUTTER_PICK_NONE)
+    priv->propagated_one_redraw = FALSE;
 
-        info = _clutter_actor_get_layout_info_or_defaults (actor);
-        g_value_set_float (value, info->minimum.height);
-      }
-      break;
+  /* It's an important optimization that we consider painting of
+   * actors with 0 opacity to be a NOP... */
+  if (pick_mode == CLUTTER_PICK_NONE &&
+      /* ignore top-levels, since they might be transparent */
+      !CLUTTER_ACTOR_IS_TOPLEVEL (self) &&
+      /* Use the override opacity if its been set */
+      ((priv->opacity_override >= 0) ?
+       priv->opacity_override : priv->opacity) == 0)
+    {
+      /* transparent actors can still be picked, but we are not going
+       * to update their position inside the pick index
+       */
+      if (!in_clone_paint () && CLUTTER_ACTOR_IS_MAPPED (self))
+        {
+          ClutterActor *stage = _clutter_actor_get_stage_internal (self);
 
-    case PROP_NATURAL_WIDTH:
-      {
-        const ClutterLayoutInfo *info;
+          if (stage != NULL)
+            _clutter_stage_invalidate_pick_index (CLUTTER_STAGE (stage));
+        }
 
-        info = _clutter_actor_get_layout_info_or_defaults (actor);
-        g_value_set_float (value, info->natural.width);
-      }
-      break;
+      return;
+    }
 
-    case PROP_NATURAL_HEIGHT:
-      {
-        const ClutterLayoutInfo *info;
+  /* if we aren't paintable (not in a toplevel with all
+   * parents paintable) then do nothing.
+   */
+  if (!CLUTTER_ACTOR_IS_MAPPED (self))
+    return;
 
-        info = _clutter_actor_get_layout_info_or_defaults (actor);
-        g_value_set_float (value, info->natural.height);
-      }
-      break;
+  /* mark that we are in the paint process */
+  CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IN_PAINT);
 
-    case PROP_MIN_WIDTH_SET:
-      g_value_set_boolean (value, priv->min_width_set);
-      break;
+  measure_cost = CLUTTER_ACTOR_COST_ENABLED () && pick_mode == CLUTTER_PICK_NONE;
+  if (measure_cost)
+    _clutter_actor_cost_begin (self, CLUTTER_ACTOR_COST_PAINT);
 
-    case PROP_MIN_HEIGHT_SET:
-      g_value_set_boolean (value, priv->min_height_set);
-      break;
+  cogl_push_matrix();
 
-    case PROP_NATURAL_WIDTH_SET:
-      g_value_set_boolean (value, priv->natural_width_set);
-      break;
+  if (priv->enable_model_view_transform)
+    {
+      CoglMatrix matrix;
 
-    case PROP_NATURAL_HEIGHT_SET:
-      g_value_set_boolean (value, priv->natural_height_set);
-      break;
+      /* XXX: It could be better to cache the modelview with the actor
+       * instead of progressively building up the transformations on
+       * the matrix stack every time we paint. */
+      cogl_get_modelview_matrix (&matrix);
+      _clutter_actor_apply_modelview_transform (self, &matrix);
 
-    case PROP_REQUEST_MODE:
-      g_value_set_enum (value, priv->request_mode);
-      break;
+#ifdef CLUTTER_ENABLE_DEBUG
+      /* Catch when out-of-band transforms have been made by actors not as part
+       * of an apply_transform vfunc... */
+      if (G_UNLIKELY (clutter_debug_flags & CLUTTER_DEBUG_OOB_TRANSFORMS))
+        {
+          CoglMatrix expected_matrix;
 
-    case PROP_ALLOCATION:
-      g_value_set_boxed (value, &priv->allocation);
-      break;
+          _clutter_actor_get_relative_transformation_matrix (self, NULL,
+                                                             &expected_matrix);
 
-    case PROP_Z_POSITION:
-      g_value_set_float (value, clutter_actor_get_z_position (actor));
-      break;
+          if (!cogl_matrix_equal (&matrix, &expected_matrix))
+            {
+              GString *buf = g_string_sized_new (1024);
+              ClutterActor *parent;
 
-    case PROP_OPACITY:
-      g_value_set_uint (value, priv->opacity);
-      break;
+              parent = self;
+              while (parent != NULL)
+                {
+                  g_string_append (buf, _clutter_actor_get_debug_name (parent));
 
-    case PROP_OFFSCREEN_REDIRECT:
-      g_value_set_flags (value, priv->offscreen_redirect);
-      break;
+                  if (parent->priv->parent != NULL)
+                    g_string_append (buf, "->");
 
-    case PROP_NAME:
-      g_value_set_string (value, priv->name);
-      break;
+                  parent = parent->priv->parent;
+                }
 
-    case PROP_VISIBLE:
-      g_value_set_boolean (value, CLUTTER_ACTOR_IS_VISIBLE (actor));
-      break;
+              g_warning ("Unexpected transform found when painting actor "
+                         "\"%s\". This will be caused by one of the actor's "
+                         "ancestors (%s) using the Cogl API directly to transform "
+                         "children instead of using ::apply_transform().",
+                         _clutter_actor_get_debug_name (self),
+                         buf->str);
 
-    case PROP_MAPPED:
-      g_value_set_boolean (value, CLUTTER_ACTOR_IS_MAPPED (actor));
-      break;
+              g_string_free (buf, TRUE);
+            }
+        }
+#endif /* CLUTTER_ENABLE_DEBUG */
 
-    case PROP_REALIZED:
-      g_value_set_boolean (value, CLUTTER_ACTOR_IS_REALIZED (actor));
-      break;
+      cogl_set_modelview_matrix (&matrix);
+    }
 
-    case PROP_HAS_CLIP:
-      g_value_set_boolean (value, priv->has_clip);
-      break;
+  if (priv->has_clip)
+    {
+      ClutterActorBox clip_box;
 
-    case PROP_CLIP_RECT:
-      g_value_set_boxed (value, &priv->clip);
-      break;
+      clip_box.x1 = priv->clip.origin.x;
+      clip_box.y1 = priv->clip.origin.y;
+      clip_box.x2 = priv->clip.origin.x + priv->clip.size.width;
+      clip_box.y2 = priv->clip.origin.y + priv->clip.size.height;
 
-    case PROP_CLIP_TO_ALLOCATION:
-      g_value_set_boolean (value, priv->clip_to_allocation);
-      break;
+      clutter_actor_push_paint_clip (&clip_box);
+      clip_set = TRUE;
+    }
+  else if (priv->clip_to_allocation)
+    {
+      ClutterActorBox clip_box;
 
-    case PROP_PIVOT_POINT:
-      {
-        const ClutterTransformInfo *info;
+      clip_box.x1 = 0.f;
+      clip_box.y1 = 0.f;
+      clip_box.x2 = priv->allocation.x2 - priv->allocation.x1;
+      clip_box.y2 = priv->allocation.y2 - priv->allocation.y1;
 
-        info = _clutter_actor_get_transform_info_or_defaults (actor);
-        g_value_set_boxed (value, &info->pivot);
-      }
-      break;
+      clutter_actor_push_paint_clip (&clip_box);
+      clip_set = TRUE;
+    }
 
-    case PROP_PIVOT_POINT_Z:
-      {
-        const ClutterTransformInfo *info;
+  if (pick_mode == CLUTTER_PICK_NONE)
+    {
+      CLUTTER_COUNTER_INC (_clutter_uprof_context, actor_paint_counter);
 
-        info = _clutter_actor_get_transform_info_or_defaults (actor);
-        g_value_set_float (value, info->pivot_z);
-      }
-      break;
+      /* We check whether we need to add the flatten effect before
+         each paint so that we can avoid having a mechanism for
+         applications to notify when the value of the
+         has_overlaps virtual changes. */
+      add_or_remove_flatten_effect (self);
+    }
+  else
+    CLUTTER_COUNTER_INC (_clutter_uprof_context, actor_pick_counter);
 
-    case PROP_TRANSLATION_X:
-      {
-        const ClutterTransformInfo *info;
+  /* We save the current paint volume so that the next time the
+   * actor queues a redraw we can constrain the redraw to just
+   * cover the union of the new bounding box and the old.
+   *
+   * We also fetch the current paint volume to perform culling so
+   * we can avoid painting actors outside the current clip region.
+   *
+   * If we are painting inside a clone, we should neither update
+   * the paint volume or use it to cull painting, since the paint
+   * box represents the location of the source actor on the
+   * screen.
+   *
+   * XXX: We are starting to do a lot of vertex transforms on
+   * the CPU in a typical paint, so at some point we should
+   * audit these and consider caching some things.
+   *
+   * NB: We don't perform culling while picking at this point because
+   * clutter-stage.c doesn't setup the clipping planes appropriately.
+   *
+   * NB: We don't want to update the last-paint-volume during picking
+   * because the last-paint-volume is used to determine the old screen
+   * space location of an actor that has moved so we can know the
+   * minimal region to redraw to clear an old view of the actor. If we
+   * update this during picking then by the time we come around to
+   * paint then the last-paint-volume would likely represent the new
+   * actor position not the old.
+   */
+  if (!in_clone_paint () && pick_mode == CLUTTER_PICK_NONE)
+    {
+      gboolean success;
+      /* annoyingly gcc warns if uninitialized even though
+       * the initialization is redundant :-( */
+      ClutterCullResult result = CLUTTER_CULL_RESULT_IN;
 
-        info = _clutter_actor_get_transform_info_or_defaults (actor);
-        g_value_set_float (value, info->translation.x);
-      }
-      break;
+      if (G_LIKELY ((clutter_paint_debug_flags &
+                     (CLUTTER_DEBUG_DISABLE_CULLING |
+                      CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS)) !=
+                    (CLUTTER_DEBUG_DISABLE_CULLING |
+                     CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS)))
+        _clutter_actor_update_last_paint_volume (self);
 
-    case PROP_TRANSLATION_Y:
-      {
-        const ClutterTransformInfo *info;
+      _clutter_actor_update_pick_index (self);
 
-        info = _clutter_actor_get_transform_info_or_defaults (actor);
-        g_value_set_float (value, info->translation.y);
-      }
-      break;
+      success = cull_actor (self, &result);
 
-    case PROP_TRANSLATION_Z:
-      {
-        const ClutterTransformInfo *info;
+      if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_REDRAWS))
+        _clutter_actor_paint_cull_result (self, success, result);
+      else if (result == CLUTTER_CULL_RESULT_OUT && success)
+        {
+          _clutter_actor_skip_children_pick_index (self);
+          goto done;
+        }
+      else if (occlude_actor (self))
+        {
+          _clutter_actor_skip_children_pick_index (self);
+          goto done;
+        }
 
-        info = _clutter_actor_get_transform_info_or_defaults (actor);
-        g_value_set_float (value, info->translation.z);
-      }
-      break;
+      if (priv->lod != NULL)
+        {
+          priv->lod->collapsed = clutter_actor_should_collapse (self);
 
-    case PROP_SCALE_X:
-      {
-        const ClutterTransformInfo *info;
+          /* the children are not painted, so their position inside
+           * the pick index is not updated either
+           */
+          if (priv->lod->collapsed)
+            _clutter_actor_skip_children_pick_index (self);
+        }
+    }
 
-        info = _clutter_actor_get_transform_info_or_defaults (actor);
-        g_value_set_double (value, info->scale_x);
-      }
-      break;
+  /* the sources of the clones are painted at the size of the clone,
+   * so we do not collapse them; picking uses the state of the last paint
+   */
+  if (priv->lod != NULL && priv->lod->collapsed && !in_clone_paint ())
+    {
+      clutter_actor_paint_collapsed (self, pick_mode);
+      goto done;
+    }
 
-    case PROP_SCALE_Y:
-      {
-        const ClutterTransformInfo *info;
+  if (priv->effects == NULL)
+    priv->next_effect_to_paint = NULL;
+  else
+    priv->next_effect_to_paint = _clutter_meta_group_peek_metas (priv->effects);
 
-        info = _clutter_actor_get_transform_info_or_defaults (actor);
-        g_value_set_double (value, info->scale_y);
-      }
-      break;
+  clutter_actor_continue_paint (self);
 
-    case PROP_SCALE_Z:
-      {
-        const ClutterTransformInfo *info;
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_PAINT_VOLUMES &&
+                  pick_mode == CLUTTER_PICK_NONE))
+    _clutter_actor_draw_paint_volume (self);
 
-        info = _clutter_actor_get_transform_info_or_defaults (actor);
-        g_value_set_double (value, info->scale_z);
-      }
-      break;
+done:
+  /* If we make it here then the actor has run through a complete
+     paint run including all the effects so it's no longer dirty */
+  if (pick_mode == CLUTTER_PICK_NONE)
+    {
+      priv->is_dirty = FALSE;
+      priv->is_damaged = FALSE;
+    }
 
-    case PROP_ROTATION_ANGLE_X:
-      {
-        const ClutterTransformInfo *info;
+  if (clip_set)
+    clutter_actor_pop_paint_clip ();
 
-        info = _clutter_actor_get_transform_info_or_defaults (actor);
-        g_value_set_double (value, info->rx_angle);
-      }
-      break;
+  cogl_pop_matrix();
 
-    case PROP_ROTATION_ANGLE_Y:
-      {
-        const ClutterTransformInfo *info;
+  if (measure_cost)
+    _clutter_actor_cost_end ();
 
-        info = _clutter_actor_get_transform_info_or_defaults (actor);
-        g_value_set_double (value, info->ry_angle);
-      }
-      break;
+  /* paint sequence complete */
+  CLUTTER_UNSET_PRIVATE_FLAGS (self, CLUTTER_IN_PAINT);
+}
 
-    case PROP_ROTATION_ANGLE_Z:
-      {
-        const ClutterTransformInfo *info;
+/**
+ * clutter_actor_continue_paint:
+ * @self: A #ClutterActor
+ *
+ * Run the next stage of the paint sequence. This function should only
+ * be called within the implementation of the ‘run’ virtual of a
+ * #ClutterEffect. It will cause the run method of the next effect to
+ * be applied, or it will paint the actual actor if the current effect
+ * is the last effect in the chain.
+ *
+ *
+ */
+void
+clutter_actor_continue_paint (ClutterActor *self)
+{
+  ClutterActorPrivate *priv;
 
-        info = _clutter_actor_get_transform_info_or_defaults (actor);
-        g_value_set_double (value, info->rz_angle);
-      }
-      break;
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  /* This should only be called from with in the ‘run’ implementation
+     of a ClutterEffect */
+  g_return_if_fail (CLUTTER_ACTOR_IN_PAINT (self));
 
-    case PROP_TRANSFORM:
-      {
-        ClutterMatrix m;
+  priv = self->priv;
 
-        clutter_actor_get_transform (actor, &m);
-        g_value_set_boxed (value, &m);
-      }
-      break;
+  /* Skip any effects that are disabled */
+  while (priv->next_effect_to_paint &&
+         !clutter_actor_meta_get_enabled (priv->next_effect_to_paint->data))
+    priv->next_effect_to_paint = priv->next_effect_to_paint->next;
 
-    case PROP_TRANSFORM_SET:
-      {
-        const ClutterTransformInfo *info;
+  /* If this has come from the last effect then we'll just paint the
+     actual actor */
+  if (priv->next_effect_to_paint == NULL)
+    {
+      if (_clutter_context_get_pick_mode () == CLUTTER_PICK_NONE)
+        {
+          /* XXX - the render tree of each actor is retained, but the
+           * paint() virtual function still paints the children; this
+           * will go away in 2.0, when we can switch to a pure retained
+           * render tree of PaintNodes for the entire frame, starting
+           * from the Stage.
+           *
+           * XXX - for 1.12, we use the return value of paint_node() to
+           * decide whether we should emit the ::paint signal.
+           */
+          clutter_actor_paint_node (self);
 
-        info = _clutter_actor_get_transform_info_or_defaults (actor);
-        g_value_set_boolean (value, info->transform_set);
-      }
-      break;
+          CLUTTER_ACTOR_GET_CLASS (self)->paint (self);
 
-    case PROP_CHILD_TRANSFORM:
-      {
-        ClutterMatrix m;
+          /* the actor was painted at least once */
+          priv->was_painted = TRUE;
+        }
+      else
+        {
+          ClutterColor col = { 0, };
 
-        clutter_actor_get_child_transform (actor, &m);
-        g_value_set_boxed (value, &m);
-      }
-      break;
+          _clutter_id_to_color (_clutter_actor_get_pick_id (self), &col);
 
-    case PROP_CHILD_TRANSFORM_SET:
-      {
-        const ClutterTransformInfo *info;
-
-        info = _clutter_actor_get_transform_info_or_defaults (actor);
-        g_value_set_boolean (value, info->child_transform_set);
-      }
-      break;
+          /* Actor will then paint silhouette of itself in supplied
+           * color.  See clutter_stage_get_actor_at_pos() for where
+           * picking is enabled.
+           *
+           * XXX:2.0 - Call the pick() virtual directly
+           */
+          if (CLUTTER_ACTOR_GET_CLASS (self)->pick == clutter_actor_real_pick ||
+              CLUTTER_ACTOR_IS_TOPLEVEL (self))
+            CLUTTER_ACTOR_GET_CLASS (self)->pick (self, &col);
+          else
+            {
+              _clutter_actor_flush_pick_batch ();
+              pick_batch_inhibit += 1;
 
-    case PROP_TEXT_DIRECTION:
-      g_value_set_enum (value, priv->text_direction);
-      break;
+              CLUTTER_ACTOR_GET_CLASS (self)->pick (self, &col);
 
-    case PROP_HAS_POINTER:
-      g_value_set_boolean (value, priv->has_pointer);
-      break;
+              pick_batch_inhibit -= 1;
+            }
+        }
+    }
+  else
+    {
+      ClutterEffect *old_current_effect;
+      ClutterEffectPaintFlags run_flags = 0;
 
-    case PROP_LAYOUT_MANAGER:
-      g_value_set_object (value, priv->layout_manager);
-      break;
+      /* Cache the current effect so that we can put it back before
+         returning */
+      old_current_effect = priv->current_effect;
 
-    case PROP_X_EXPAND:
-      {
-        const ClutterLayoutInfo *info;
+      priv->current_effect = priv->next_effect_to_paint->data;
+      priv->next_effect_to_paint = priv->next_effect_to_paint->next;
 
-        info = _clutter_actor_get_layout_info_or_defaults (actor);
-        g_value_set_boolean (value, info->x_expand);
-      }
-      break;
+      if (_clutter_context_get_pick_mode () == CLUTTER_PICK_NONE)
+        {
+          if (priv->is_dirty)
+            {
+              /* If there's an effect queued with this redraw then all
+                 effects up to that one will be considered dirty. It
+                 is expected the queued effect will paint the cached
+                 image and not call clutter_actor_continue_paint again
+                 (although it should work ok if it does) */
+              if (priv->effect_to_redraw == NULL ||
+                  priv->current_effect != priv->effect_to_redraw)
+                run_flags |= CLUTTER_EFFECT_PAINT_ACTOR_DIRTY;
+            }
 
-    case PROP_Y_EXPAND:
-      {
-        const ClutterLayoutInfo *info;
+          _clutter_effect_paint (priv->current_effect, run_flags);
+        }
+      else
+        {
+          /* We can't determine when an actor has been modified since
+             its last pick so lets just assume it has always been
+             modified */
+          run_flags |= CLUTTER_EFFECT_PAINT_ACTOR_DIRTY;
 
-        info = _clutter_actor_get_layout_info_or_defaults (actor);
-        g_value_set_boolean (value, info->y_expand);
-      }
-      break;
+          if (_clutter_effect_has_custom_pick (priv->current_effect))
+            {
+              _clutter_actor_flush_pick_batch ();
+              pick_batch_inhibit += 1;
 
-    case PROP_X_ALIGN:
-      {
-        const ClutterLayoutInfo *info;
+              _clutter_effect_pick (priv->current_effect, run_flags);
 
-        info = _clutter_actor_get_layout_info_or_defaults (actor);
-        g_value_set_enum (value, info->x_align);
-      }
-      break;
+              pick_batch_inhibit -= 1;
+            }
+          else
+            _clutter_effect_pick (priv->current_effect, run_flags);
+        }
 
-    case PROP_Y_ALIGN:
-      {
-        const ClutterLayoutInfo *info;
+      priv->current_effect = old_current_effect;
+    }
+}
 
-        info = _clutter_actor_get_layout_info_or_defaults (actor);
-        g_value_set_enum (value, info->y_align);
-      }
-      break;
+static void
+_clutter_actor_stop_transitions (ClutterActor *self)
+{
+  const ClutterAnimationInfo *info;
+  GHashTableIter iter;
+  gpointer value;
 
-    case PROP_MARGIN_TOP:
-      {
-        const ClutterLayoutInfo *info;
+  info = _clutter_actor_get_animation_info_or_defaults (self);
+  if (info->transitions == NULL)
+    return;
 
-        info = _clutter_actor_get_layout_info_or_defaults (actor);
-        g_value_set_float (value, info->margin.top);
-      }
-      break;
+  g_hash_table_iter_init (&iter, info->transitions);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      TransitionClosure *closure = value;
 
-    case PROP_MARGIN_BOTTOM:
-      {
-        const ClutterLayoutInfo *info;
+      /* implicit transitions, and automatically managed explicit ones,
+       * should be removed at this point
+       */
+      if (closure->is_implicit ||
+          clutter_transition_get_remove_on_complete (closure->transition))
+        {
+          g_hash_table_iter_remove (&iter);
+        }
+      else
+        {
+          /* otherwise we stop it, and the transition will be removed
+           * later, either by the actor's destruction or by explicit
+           * removal
+           */
+          clutter_timeline_stop (CLUTTER_TIMELINE (closure->transition));
+        }
+    }
+}
 
-        info = _clutter_actor_get_layout_info_or_defaults (actor);
-        g_value_set_float (value, info->margin.bottom);
-      }
-      break;
+static ClutterActorTraverseVisitFlags
+invalidate_queue_redraw_entry (ClutterActor *self,
+                               int           depth,
+                               gpointer      user_data)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterStage *stage = user_data;
 
-    case PROP_MARGIN_LEFT:
-      {
-        const ClutterLayoutInfo *info;
+  if (priv->queue_redraw_entry != -1)
+    {
+      if (stage != NULL)
+        _clutter_stage_queue_redraw_entry_invalidate (stage,
+                                                      priv->queue_redraw_entry);
 
-        info = _clutter_actor_get_layout_info_or_defaults (actor);
-        g_value_set_float (value, info->margin.left);
-      }
-      break;
+      priv->queue_redraw_entry = -1;
+    }
 
-    case PROP_MARGIN_RIGHT:
-      {
-        const ClutterLayoutInfo *info;
+  return CLUTTER_ACTOR_TRAVERSE_VISIT_CONTINUE;
+}
 
-        info = _clutter_actor_get_layout_info_or_defaults (actor);
-        g_value_set_float (value, info->margin.right);
-      }
-      break;
+/* containers with at least this many children keep an array of their
+ * children alongside the list, so that accessing a child by its index
+ * does not need to walk the list
+ */
+#define CHILDREN_INDEX_THRESHOLD        64
 
-    case PROP_BACKGROUND_COLOR_SET:
-      g_value_set_boolean (value, priv->bg_color_set);
-      break;
+/* returns the array of the children of @self, building it if needed,
+ * or %NULL if @self does not have enough children to need one
+ */
+static GPtrArray *
+clutter_actor_get_children_index (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *iter;
 
-    case PROP_BACKGROUND_COLOR:
-      g_value_set_boxed (value, &priv->bg_color);
-      break;
+  if (priv->n_children < CHILDREN_INDEX_THRESHOLD)
+    return NULL;
 
-    case PROP_FIRST_CHILD:
-      g_value_set_object (value, priv->first_child);
-      break;
+  if (priv->children_index_valid)
+    return priv->children_index;
 
-    case PROP_LAST_CHILD:
-      g_value_set_object (value, priv->last_child);
-      break;
+  if (priv->children_index == NULL)
+    priv->children_index = g_ptr_array_sized_new (priv->n_children);
+  else
+    g_ptr_array_set_size (priv->children_index, 0);
 
-    case PROP_CONTENT:
-      g_value_set_object (value, priv->content);
-      break;
+  for (iter = priv->first_child;
+       iter != NULL;
+       iter = iter->priv->next_sibling)
+    g_ptr_array_add (priv->children_index, iter);
 
-    case PROP_CONTENT_GRAVITY:
-      g_value_set_enum (value, priv->content_gravity);
-      break;
+  priv->children_index_valid = TRUE;
 
-    case PROP_CONTENT_BOX:
-      {
-        ClutterActorBox box = { 0, };
+  return priv->children_index;
+}
 
-        clutter_actor_get_content_box (actor, &box);
-        g_value_set_boxed (value, &box);
-      }
-      break;
+/* updates the array of the children of @self after @child has been
+ * inserted at @index_ inside the list; a negative @index_ means that
+ * the position is not known
+ */
+static void
+clutter_actor_children_index_insert (ClutterActor *self,
+                                     ClutterActor *child,
+                                     gint          index_)
+{
+  ClutterActorPrivate *priv = self->priv;
+  GPtrArray *children = priv->children_index;
+  guint len;
 
-    case PROP_MINIFICATION_FILTER:
-      g_value_set_enum (value, priv->min_filter);
-      break;
+  if (!priv->children_index_valid)
+    return;
 
-    case PROP_MAGNIFICATION_FILTER:
-      g_value_set_enum (value, priv->mag_filter);
-      break;
+  len = children->len;
 
-    case PROP_CONTENT_REPEAT:
-      g_value_set_flags (value, priv->content_repeat);
-      break;
+  if (child->priv->next_sibling == NULL)
+    index_ = len;
 
-    default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
-      break;
+  /* prepending is done in a loop often enough that rebuilding the
+   * array once, when it is needed, is cheaper than moving it every
+   * time
+   */
+  if (index_ <= 0 || (guint) index_ > len)
+    {
+      priv->children_index_valid = FALSE;
+      return;
     }
+
+  g_ptr_array_set_size (children, len + 1);
+
+  if ((guint) index_ < len)
+    memmove (children->pdata + index_ + 1,
+             children->pdata + index_,
+             (len - index_) * sizeof (gpointer));
+
+  children->pdata[index_] = child;
 }
 
+/* updates the array of the children of @self before @child is
+ * removed from the list
+ */
 static void
-clutter_actor_dispose (GObject *object)
+clutter_actor_children_index_remove (ClutterActor *self,
+                                     ClutterActor *child)
 {
-  ClutterActor *self = CLUTTER_ACTOR (object);
   ClutterActorPrivate *priv = self->priv;
+  GPtrArray *children = priv->children_index;
+  guint i;
 
-  CLUTTER_NOTE (MISC, "Disposing of object (id=%d) of type '%s' (ref_count:%d)",
-		priv->id,
-		g_type_name (G_OBJECT_TYPE (self)),
-                object->ref_count);
-
-  g_signal_emit (self, actor_signals[DESTROY], 0);
+  if (!priv->children_index_valid)
+    return;
 
-  /* avoid recursing when called from clutter_actor_destroy() */
-  if (priv->parent != NULL)
+  if (child == priv->last_child)
     {
-      ClutterActor *parent = priv->parent;
-
-      clutter_actor_remove_child_internal (parent, self,
-                                           REMOVE_CHILD_DEFAULT_FLAGS);
+      g_ptr_array_set_size (children, children->len - 1);
+      return;
     }
 
-  /* parent must be gone at this point */
-  g_assert (priv->parent == NULL);
-
-  if (!CLUTTER_ACTOR_IS_TOPLEVEL (self))
+  /* see clutter_actor_children_index_insert() */
+  if (child == priv->first_child)
     {
-      /* can't be mapped or realized with no parent */
-      g_assert (!CLUTTER_ACTOR_IS_MAPPED (self));
-      g_assert (!CLUTTER_ACTOR_IS_REALIZED (self));
+      priv->children_index_valid = FALSE;
+      return;
     }
 
-  g_clear_object (&priv->pango_context);
-  g_clear_object (&priv->actions);
-  g_clear_object (&priv->constraints);
-  g_clear_object (&priv->effects);
-  g_clear_object (&priv->flatten_effect);
-
-  if (priv->layout_manager != NULL)
+  for (i = 1; i < children->len; i++)
     {
-      clutter_layout_manager_set_container (priv->layout_manager, NULL);
-      g_clear_object (&priv->layout_manager);
-    }
-
-  if (priv->content != NULL)
-    {
-      _clutter_content_detached (priv->content, self);
-      g_clear_object (&priv->content);
-    }
-
-  if (priv->clones != NULL)
-    {
-      g_hash_table_unref (priv->clones);
-      priv->clones = NULL;
+      if (children->pdata[i] == child)
+        {
+          g_ptr_array_remove_index (children, i);
+          return;
+        }
     }
 
-  G_OBJECT_CLASS (clutter_actor_parent_class)->dispose (object);
+  priv->children_index_valid = FALSE;
 }
 
-static void
-clutter_actor_finalize (GObject *object)
+static inline void
+paint_bounds_init_empty (PaintBounds *bounds)
 {
-  ClutterActorPrivate *priv = CLUTTER_ACTOR (object)->priv;
-
-  CLUTTER_NOTE (MISC, "Finalize actor (name='%s', id=%d) of type '%s'",
-                priv->name != NULL ? priv->name : "<none>",
-		priv->id,
-		g_type_name (G_OBJECT_TYPE (object)));
-
-  clutter_actor_restore_easing_state (CLUTTER_ACTOR (object));
-
-  _clutter_context_release_id (priv->id);
-
-  g_free (priv->name);
-
-#ifdef CLUTTER_ENABLE_DEBUG
-  g_free (priv->debug_name);
-#endif
-
-  G_OBJECT_CLASS (clutter_actor_parent_class)->finalize (object);
+  bounds->x1 = bounds->y1 = bounds->z1 = G_MAXFLOAT;
+  bounds->x2 = bounds->y2 = bounds->z2 = -G_MAXFLOAT;
 }
 
-
-/**
- * clutter_actor_get_accessible:
- * @self: a #ClutterActor
- *
- * Returns the accessible object that describes the actor to an
- * assistive technology.
- *
- * If no class-specific #AtkObject implementation is available for the
- * actor instance in question, it will inherit an #AtkObject
- * implementation from the first ancestor class for which such an
- * implementation is defined.
- *
- * The documentation of the <ulink
- * url="http://developer.gnome.org/doc/API/2.0/atk/index.html">ATK</ulink>
- * library contains more information about accessible objects and
- * their uses.
- *
- * Returns: (transfer none): the #AtkObject associated with @actor
- */
-AtkObject *
-clutter_actor_get_accessible (ClutterActor *self)
+static inline gboolean
+paint_bounds_is_empty (const PaintBounds *bounds)
 {
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
-
-  return CLUTTER_ACTOR_GET_CLASS (self)->get_accessible (self);
+  return bounds->x1 > bounds->x2;
 }
 
-static AtkObject *
-clutter_actor_real_get_accessible (ClutterActor *actor)
+static inline void
+paint_bounds_union (PaintBounds       *bounds,
+                    const PaintBounds *other)
 {
-  return atk_gobject_accessible_for_object (G_OBJECT (actor));
+  bounds->x1 = MIN (bounds->x1, other->x1);
+  bounds->y1 = MIN (bounds->y1, other->y1);
+  bounds->z1 = MIN (bounds->z1, other->z1);
+  bounds->x2 = MAX (bounds->x2, other->x2);
+  bounds->y2 = MAX (bounds->y2, other->y2);
+  bounds->z2 = MAX (bounds->z2, other->z2);
 }
 
-static AtkObject *
-_clutter_actor_ref_accessible (AtkImplementor *implementor)
+/* checks whether @bounds, which includes @old_bounds, would still be
+ * the union of the same boxes after replacing @old_bounds with
+ * @new_bounds and growing it; this is not the case if @old_bounds
+ * touches a side of @bounds that @new_bounds does not reach anymore
+ */
+static inline gboolean
+paint_bounds_can_replace (const PaintBounds *bounds,
+                          const PaintBounds *old_bounds,
+                          const PaintBounds *new_bounds)
 {
-  AtkObject *accessible;
+  gboolean has_new = !paint_bounds_is_empty (new_bounds);
 
-  accessible = clutter_actor_get_accessible (CLUTTER_ACTOR (implementor));
-  if (accessible != NULL)
-    g_object_ref (accessible);
+  if (paint_bounds_is_empty (old_bounds))
+    return TRUE;
 
-  return accessible;
+  return (old_bounds->x1 > bounds->x1 || (has_new && new_bounds->x1 <= old_bounds->x1)) &&
+         (old_bounds->y1 > bounds->y1 || (has_new && new_bounds->y1 <= old_bounds->y1)) &&
+         (old_bounds->z1 > bounds->z1 || (has_new && new_bounds->z1 <= old_bounds->z1)) &&
+         (old_bounds->x2 < bounds->x2 || (has_new && new_bounds->x2 >= old_bounds->x2)) &&
+         (old_bounds->y2 < bounds->y2 || (has_new && new_bounds->y2 >= old_bounds->y2)) &&
+         (old_bounds->z2 < bounds->z2 || (has_new && new_bounds->z2 >= old_bounds->z2));
 }
 
+/* drops the union of the paint volumes of the children of @self, so
+ * that the next paint volume update computes it from scratch
+ */
 static void
-atk_implementor_iface_init (AtkImplementorIface *iface)
-{
-  iface->ref_accessible = _clutter_actor_ref_accessible;
-}
-
-static gboolean
-clutter_actor_update_default_paint_volume (ClutterActor       *self,
-                                           ClutterPaintVolume *volume)
+clutter_actor_clear_children_bounds (ClutterActor *self)
 {
   ClutterActorPrivate *priv = self->priv;
-  gboolean res = TRUE;
+  guint i;
 
-  /* we start from the allocation */
-  clutter_paint_volume_set_width (volume,
-                                  priv->allocation.x2 - priv->allocation.x1);
-  clutter_paint_volume_set_height (volume,
-                                   priv->allocation.y2 - priv->allocation.y1);
+  priv->children_bounds_valid = FALSE;
 
-  /* if the actor has a clip set then we have a pretty definite
-   * size for the paint volume: the actor cannot possibly paint
-   * outside the clip region.
-   */
-  if (priv->clip_to_allocation)
-    {
-      /* the allocation has already been set, so we just flip the
-       * return value
-       */
-      res = TRUE;
-    }
-  else
+  if (priv->dirty_children == NULL)
+    return;
+
+  for (i = 0; i < priv->dirty_children->len; i++)
     {
-      ClutterActor *child;
+      ClutterActor *child = g_ptr_array_index (priv->dirty_children, i);
 
-      if (priv->has_clip &&
-          priv->clip.size.width >= 0 &&
-          priv->clip.size.height >= 0)
-        {
-          ClutterVertex origin;
+      child->priv->in_dirty_children = FALSE;
+    }
 
-          origin.x = priv->clip.origin.x;
-          origin.y = priv->clip.origin.y;
-          origin.z = 0;
+  g_ptr_array_set_size (priv->dirty_children, 0);
+}
 
-          clutter_paint_volume_set_origin (volume, &origin);
-          clutter_paint_volume_set_width (volume, priv->clip.size.width);
-          clutter_paint_volume_set_height (volume, priv->clip.size.height);
+/* drops the contribution of @child to the paint volume of @self,
+ * before removing it
+ */
+static void
+clutter_actor_forget_child_bounds (ClutterActor *self,
+                                   ClutterActor *child)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorPrivate *child_priv = child->priv;
+  PaintBounds empty;
 
-          res = TRUE;
-        }
+  if (child_priv->in_dirty_children)
+    {
+      g_ptr_array_remove_fast (priv->dirty_children, child);
+      child_priv->in_dirty_children = FALSE;
+    }
 
-      /* if we don't have children we just bail out here... */
-      if (priv->n_children == 0)
-        return res;
+  paint_bounds_init_empty (&empty);
 
-      /* ...but if we have children then we ask for their paint volume in
-       * our coordinates. if any of our children replies that it doesn't
-       * have a paint volume, we bail out
-       */
-      for (child = priv->first_child;
-           child != NULL;
-           child = child->priv->next_sibling)
-        {
-          const ClutterPaintVolume *child_volume;
+  if (priv->children_bounds_valid &&
+      !paint_bounds_can_replace (&priv->children_bounds,
+                                 &child_priv->parent_bounds,
+                                 &empty))
+    clutter_actor_clear_children_bounds (self);
 
-          if (!CLUTTER_ACTOR_IS_MAPPED (child))
-            continue;
+  child_priv->parent_bounds = empty;
 
-          child_volume = clutter_actor_get_transformed_paint_volume (child, self);
-          if (child_volume == NULL)
-            {
-              res = FALSE;
-              break;
-            }
+  clutter_actor_queue_paint_volume_update (self);
+}
 
-          clutter_paint_volume_union (volume, child_volume);
-          res = TRUE;
-        }
-    }
+static inline void
+remove_child (ClutterActor *self,
+              ClutterActor *child)
+{
+  ClutterActor *prev_sibling, *next_sibling;
 
-  return res;
+  prev_sibling = child->priv->prev_sibling;
+  next_sibling = child->priv->next_sibling;
 
-}
+  if (prev_sibling != NULL)
+    prev_sibling->priv->next_sibling = next_sibling;
 
-static gboolean
-clutter_actor_real_get_paint_volume (ClutterActor       *self,
-                                     ClutterPaintVolume *volume)
-{
-  ClutterActorClass *klass;
-  gboolean res;
+  if (next_sibling != NULL)
+    next_sibling->priv->prev_sibling = prev_sibling;
 
-  klass = CLUTTER_ACTOR_GET_CLASS (self);
+  if (self->priv->first_child == child)
+    self->priv->first_child = next_sibling;
 
-  /* XXX - this thoroughly sucks, but we don't want to penalize users
-   * who use ClutterActor as a "new ClutterGroup" by forcing a full-stage
-   * redraw. This should go away in 2.0.
-   */
-  if (klass->paint == clutter_actor_real_paint &&
-      klass->get_paint_volume == clutter_actor_real_get_paint_volume)
-    {
-      res = TRUE;
-    }
-  else
-    {
-      /* this is the default return value: we cannot know if a class
-       * is going to paint outside its allocation, so we take the
-       * conservative approach.
-       */
-      res = FALSE;
-    }
+  if (self->priv->last_child == child)
+    self->priv->last_child = prev_sibling;
 
-  /* update_default_paint_volume() should only fail if one of the children
-   * reported an invalid, or no, paint volume
-   */
-  if (!clutter_actor_update_default_paint_volume (self, volume))
-    return FALSE;
+  child->priv->parent = NULL;
+  child->priv->prev_sibling = NULL;
+  child->priv->next_sibling = NULL;
 
-  return res;
+  /* the transformation depends on the :child-transform of the parent */
+  clutter_actor_invalidate_transform (child);
 }
 
-/**
- * clutter_actor_get_default_paint_volume:
+typedef enum {
+  REMOVE_CHILD_DESTROY_META       = 1 << 0,
+  REMOVE_CHILD_EMIT_PARENT_SET    = 1 << 1,
+  REMOVE_CHILD_EMIT_ACTOR_REMOVED = 1 << 2,
+  REMOVE_CHILD_CHECK_STATE        = 1 << 3,
+  REMOVE_CHILD_FLUSH_QUEUE        = 1 << 4,
+  REMOVE_CHILD_NOTIFY_FIRST_LAST  = 1 << 5,
+  REMOVE_CHILD_STOP_TRANSITIONS   = 1 << 6,
+
+  /* default flags for public API */
+  REMOVE_CHILD_DEFAULT_FLAGS      = REMOVE_CHILD_STOP_TRANSITIONS |
+                                    REMOVE_CHILD_DESTROY_META |
+                                    REMOVE_CHILD_EMIT_PARENT_SET |
+                                    REMOVE_CHILD_EMIT_ACTOR_REMOVED |
+                                    REMOVE_CHILD_CHECK_STATE |
+                                    REMOVE_CHILD_FLUSH_QUEUE |
+                                    REMOVE_CHILD_NOTIFY_FIRST_LAST
+} ClutterActorRemoveChildFlags;
+
+/*< private >
+ * clutter_actor_remove_child_internal:
  * @self: a #ClutterActor
+ * @child: the child of @self that has to be removed
+ * @flags: control the removal operations
  *
- * Retrieves the default paint volume for @self.
- *
- * This function provides the same #ClutterPaintVolume that would be
- * computed by the default implementation inside #ClutterActor of the
- * #ClutterActorClass.get_paint_volume() virtual function.
- *
- * This function should only be used by #ClutterActor subclasses that
- * cannot chain up to the parent implementation when computing their
- * paint volume.
- *
- * Return value: (transfer none): a pointer to the default
- *   #ClutterPaintVolume, relative to the #ClutterActor, or %NULL if
- *   the actor could not compute a valid paint volume. The returned value
- *   is not guaranteed to be stable across multiple frames, so if you
- *   want to retain it, you will need to copy it using
- *   clutter_paint_volume_copy().
- *
- *
+ * Removes @child from the list of children of @self.
  */
-const ClutterPaintVolume *
-clutter_actor_get_default_paint_volume (ClutterActor *self)
+static void
+clutter_actor_remove_child_internal (ClutterActor                 *self,
+                                     ClutterActor                 *child,
+                                     ClutterActorRemoveChildFlags  flags)
 {
-  ClutterPaintVolume volume;
-  ClutterPaintVolume *res;
-
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
+  ClutterActor *old_first, *old_last;
+  gboolean destroy_meta, emit_parent_set, emit_actor_removed, check_state;
+  gboolean flush_queue;
+  gboolean notify_first_last;
+  gboolean was_mapped;
+  gboolean stop_transitions;
+  GObject *obj;
 
-  res = NULL;
-  _clutter_paint_volume_init_static (&volume, self);
-  if (clutter_actor_update_default_paint_volume (self, &volume))
+  destroy_meta = (flags & REMOVE_CHILD_DESTROY_META) != 0;
+  emit_parent_set = (flags & REMOVE_CHILD_EMIT_PARENT_SET) != 0;
+  emit_actor_removed = (flags & REMOVE_CHILD_EMIT_ACTOR_REMOVED) != 0;
+  check_state = (flags & REMOVE_CHILD_CHECK_STATE) != 0;
+  flush_queue = (flags & REMOVE_CHILD_FLUSH_QUEUE) != 0;
+  notify_first_last = (flags & REMOVE_CHILD_NOTIFY_FIRST_LAST) != 0;
+  stop_transitions = (flags & REMOVE_CHILD_STOP_TRANSITIONS) != 0;
+
+  obj = G_OBJECT (self);
+  g_object_freeze_notify (obj);
+
+  /* the cached event chains are not valid any more */
+  hierarchy_generation += 1;
+
+  if (stop_transitions)
+    _clutter_actor_stop_transitions (child);
+
+  if (destroy_meta)
+    clutter_container_destroy_child_meta (CLUTTER_CONTAINER (self), child);
+
+  if (check_state)
     {
-      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+      was_mapped = CLUTTER_ACTOR_IS_MAPPED (child);
 
-      if (stage != NULL)
-        {
-          res = _clutter_stage_paint_volume_stack_allocate (CLUTTER_STAGE (stage));
-          _clutter_paint_volume_copy_static (&volume, res);
-        }
+      /* we need to unrealize *before* we set parent_actor to NULL,
+       * because in an unrealize method actors are dissociating from the
+       * stage, which means they need to be able to
+       * clutter_actor_get_stage().
+       *
+       * yhis should unmap and unrealize, unless we're reparenting.
+       */
+      clutter_actor_update_map_state (child, MAP_STATE_MAKE_UNREALIZED);
     }
+  else
+    was_mapped = FALSE;
 
-  clutter_paint_volume_free (&volume);
+  if (flush_queue)
+    {
+      /* We take this opportunity to invalidate any queue redraw entry
+       * associated with the actor and descendants since we won't be able to
+       * determine the appropriate stage after this.
+       *
+       * we do this after we updated the mapped state because actors might
+       * end up queueing redraws inside their mapped/unmapped virtual
+       * functions, and if we invalidate the redraw entry we could end up
+       * with an inconsistent state and weird memory corruption. see
+       * bugs:
+       *
+       *   http://bugzilla.clutter-project.org/show_bug.cgi?id=2621
+       *   https://bugzilla.gnome.org/show_bug.cgi?id=652036
+       */
+      _clutter_actor_traverse (child,
+                               0,
+                               invalidate_queue_redraw_entry,
+                               NULL,
+                               _clutter_actor_get_stage_internal (child));
+    }
 
-  return res;
+  old_first = self->priv->first_child;
+  old_last = self->priv->last_child;
+
+  /* if the child is still mapped, we are changing the paint order */
+  clutter_actor_invalidate_pick (child);
+
+  clutter_actor_children_index_remove (self, child);
+  clutter_actor_forget_child_bounds (self, child);
+  remove_child (self, child);
+
+  self->priv->n_children -= 1;
+
+  self->priv->age += 1;
+
+  /* if the child that got removed was visible and set to
+   * expand then we want to reset the parent's state in
+   * case the child was the only thing that was making it
+   * expand.
+   */
+  if (CLUTTER_ACTOR_IS_VISIBLE (child) &&
+      (child->priv->needs_compute_expand ||
+       child->priv->needs_x_expand ||
+       child->priv->needs_y_expand))
+    {
+      clutter_actor_queue_compute_expand (self);
+    }
+
+  /* clutter_actor_reparent() will emit ::parent-set for us */
+  if (emit_parent_set && !CLUTTER_ACTOR_IN_REPARENT (child))
+    g_signal_emit (child, actor_signals[PARENT_SET], 0, self);
+
+  /* if the child was mapped then we need to relayout ourselves to account
+   * for the removed child
+   */
+  if (was_mapped)
+    clutter_actor_queue_relayout (self);
+
+  /* we need to emit the signal before dropping the reference */
+  if (emit_actor_removed)
+    g_signal_emit_by_name (self, "actor-removed", child);
+
+  if (notify_first_last)
+    {
+      if (old_first != self->priv->first_child)
+        g_object_notify_by_pspec (obj, obj_props[PROP_FIRST_CHILD]);
+
+      if (old_last != self->priv->last_child)
+        g_object_notify_by_pspec (obj, obj_props[PROP_LAST_CHILD]);
+    }
+
+  g_object_thaw_notify (obj);
+
+  /* remove the reference we acquired in clutter_actor_add_child() */
+  g_object_unref (child);
 }
 
-static gboolean
-clutter_actor_real_has_overlaps (ClutterActor *self)
+static const ClutterTransformInfo default_transform_info = {
+  0.0,                          /* rotation-x */
+  0.0,                          /* rotation-y */
+  0.0,                          /* rotation-z */
+
+  1.0, 1.0, 1.0,                /* scale */
+
+  CLUTTER_VERTEX_INIT_ZERO,     /* translation */
+
+  0.f,                          /* z-position */
+
+  CLUTTER_POINT_INIT_ZERO,      /* pivot */
+  0.f,                          /* pivot-z */
+
+  CLUTTER_MATRIX_INIT_IDENTITY,
+  FALSE,                        /* transform */
+  CLUTTER_MATRIX_INIT_IDENTITY,
+  FALSE,                        /* child-transform */
+};
+
+/*< private >
+ * _clutter_actor_get_transform_info_or_defaults:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the ClutterTransformInfo structure associated to an actor.
+ *
+ * If the actor does not have a ClutterTransformInfo structure associated
+ * to it, then the default structure will be returned.
+ *
+ * This function should only be used for getters.
+ *
+ * Return value: a const pointer to the ClutterTransformInfo structure
+ */
+const ClutterTransformInfo *
+_clutter_actor_get_transform_info_or_defaults (ClutterActor *self)
 {
-  /* By default we'll assume that all actors need an offscreen redirect to get
-   * the correct opacity. Actors such as ClutterTexture that would never need
-   * an offscreen redirect can override this to return FALSE. */
-  return TRUE;
+  ClutterTransformInfo *info;
+
+  info = g_object_get_qdata (G_OBJECT (self), quark_actor_transform_info);
+  if (info != NULL)
+    return info;
+
+  return &default_transform_info;
 }
 
 static void
-clutter_actor_real_destroy (ClutterActor *actor)
+clutter_transform_info_free (gpointer data)
 {
-  ClutterActorIter iter;
-
-  g_object_freeze_notify (G_OBJECT (actor));
-
-  clutter_actor_iter_init (&iter, actor);
-  while (clutter_actor_iter_next (&iter, NULL))
-    clutter_actor_iter_destroy (&iter);
+  if (data != NULL)
+    {
+      g_slice_free (ClutterTransformInfo, data);
 
-  g_object_thaw_notify (G_OBJECT (actor));
+      _clutter_memory_account (CLUTTER_MEMORY_ACTORS,
+                               -(gssize) sizeof (ClutterTransformInfo),
+                               0);
+    }
 }
 
-static GObject *
-clutter_actor_constructor (GType gtype,
-                           guint n_props,
-                           GObjectConstructParam *props)
+/*< private >
+ * _clutter_actor_get_transform_info:
+ * @self: a #ClutterActor
+ *
+ * Retrieves a pointer to the ClutterTransformInfo structure.
+ *
+ * If the actor does not have a ClutterTransformInfo associated to it, one
+ * will be created and initialized to the default values.
+ *
+ * This function should be used for setters.
+ *
+ * For getters, you should use _clutter_actor_get_transform_info_or_defaults()
+ * instead.
+ *
+ * Return value: (transfer none): a pointer to the ClutterTransformInfo
+ *   structure
+ */
+ClutterTransformInfo *
+_clutter_actor_get_transform_info (ClutterActor *self)
 {
-  GObjectClass *gobject_class;
-  ClutterActor *self;
-  GObject *retval;
-
-  gobject_class = G_OBJECT_CLASS (clutter_actor_parent_class);
-  retval = gobject_class->constructor (gtype, n_props, props);
-  self = CLUTTER_ACTOR (retval);
+  ClutterTransformInfo *info;
 
-  if (self->priv->layout_manager == NULL)
+  info = g_object_get_qdata (G_OBJECT (self), quark_actor_transform_info);
+  if (info == NULL)
     {
-      ClutterLayoutManager *default_layout;
+      info = g_slice_new (ClutterTransformInfo);
 
-      CLUTTER_NOTE (LAYOUT, "Creating default layout manager");
+      *info = default_transform_info;
 
-      default_layout = clutter_fixed_layout_new ();
-      clutter_actor_set_layout_manager (self, default_layout);
+      _clutter_memory_account (CLUTTER_MEMORY_ACTORS,
+                               sizeof (ClutterTransformInfo),
+                               0);
+
+      g_object_set_qdata_full (G_OBJECT (self), quark_actor_transform_info,
+                               info,
+                               clutter_transform_info_free);
     }
 
-  return retval;
+  return info;
 }
 
-static void
-clutter_actor_class_init (ClutterActorClass *klass)
+static inline void
+clutter_actor_set_pivot_point_internal (ClutterActor       *self,
+                                        const ClutterPoint *pivot)
 {
-  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  ClutterTransformInfo *info;
 
-  quark_actor_layout_info = g_quark_from_static_string ("-clutter-actor-layout-info");
-  quark_actor_transform_info = g_quark_from_static_string ("-clutter-actor-transform-info");
-  quark_actor_animation_info = g_quark_from_static_string ("-clutter-actor-animation-info");
+  info = _clutter_actor_get_transform_info (self);
+  info->pivot = *pivot;
 
-  object_class->constructor = clutter_actor_constructor;
-  object_class->set_property = clutter_actor_set_property;
-  object_class->get_property = clutter_actor_get_property;
-  object_class->dispose = clutter_actor_dispose;
-  object_class->finalize = clutter_actor_finalize;
+  clutter_actor_invalidate_transform (self);
+  clutter_actor_invalidate_pick (self);
 
-  klass->show = clutter_actor_real_show;
-  klass->show_all = clutter_actor_show;
-  klass->hide = clutter_actor_real_hide;
-  klass->hide_all = clutter_actor_hide;
-  klass->map = clutter_actor_real_map;
-  klass->unmap = clutter_actor_real_unmap;
-  klass->unrealize = clutter_actor_real_unrealize;
-  klass->pick = clutter_actor_real_pick;
-  klass->get_preferred_width = clutter_actor_real_get_preferred_width;
-  klass->get_preferred_height = clutter_actor_real_get_preferred_height;
-  klass->allocate = clutter_actor_real_allocate;
-  klass->queue_redraw = clutter_actor_real_queue_redraw;
-  klass->queue_relayout = clutter_actor_real_queue_relayout;
-  klass->apply_transform = clutter_actor_real_apply_transform;
-  klass->get_accessible = clutter_actor_real_get_accessible;
-  klass->get_paint_volume = clutter_actor_real_get_paint_volume;
-  klass->has_overlaps = clutter_actor_real_has_overlaps;
-  klass->paint = clutter_actor_real_paint;
-  klass->destroy = clutter_actor_real_destroy;
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT]);
 
-  g_type_class_add_private (klass, sizeof (ClutterActorPrivate));
+  clutter_actor_queue_transform_redraw (self);
+}
 
-  /**
-   * ClutterActor:x:
-   *
-   * X coordinate of the actor in pixels. If written, forces a fixed
-   * position for the actor. If read, returns the fixed position if any,
-   * otherwise the allocation if available, otherwise 0.
-   *
-   * The #ClutterActor:x property is animatable.
-   */
-  obj_props[PROP_X] =
-    g_param_spec_float ("x",
-                        P_("X coordinate"),
-                        P_("X coordinate of the actor"),
-                        -G_MAXFLOAT, G_MAXFLOAT,
-                        0.0,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+static inline void
+clutter_actor_set_pivot_point_z_internal (ClutterActor *self,
+                                          float         pivot_z)
+{
+  ClutterTransformInfo *info;
 
-  /**
-   * ClutterActor:y:
-   *
-   * Y coordinate of the actor in pixels. If written, forces a fixed
-   * position for the actor.  If read, returns the fixed position if
-   * any, otherwise the allocation if available, otherwise 0.
-   *
-   * The #ClutterActor:y property is animatable.
-   */
-  obj_props[PROP_Y] =
-    g_param_spec_float ("y",
-                        P_("Y coordinate"),
-                        P_("Y coordinate of the actor"),
-                        -G_MAXFLOAT, G_MAXFLOAT,
-                        0.0,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+  info = _clutter_actor_get_transform_info (self);
+  info->pivot_z = pivot_z;
 
-  /**
-   * ClutterActor:position:
-   *
-   * The position of the origin of the actor.
-   *
-   * This property is a shorthand for setting and getting the
-   * #ClutterActor:x and #ClutterActor:y properties at the same
-   * time.
-   *
-   * The #ClutterActor:position property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_POSITION] =
-    g_param_spec_boxed ("position",
-                        P_("Position"),
-                        P_("The position of the origin of the actor"),
-                        CLUTTER_TYPE_POINT,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+  clutter_actor_invalidate_transform (self);
+  clutter_actor_invalidate_pick (self);
 
-  /**
-   * ClutterActor:width:
-   *
-   * Width of the actor (in pixels). If written, forces the minimum and
-   * natural size request of the actor to the given width. If read, returns
-   * the allocated width if available, otherwise the width request.
-   *
-   * The #ClutterActor:width property is animatable.
-   */
-  obj_props[PROP_WIDTH] =
-    g_param_spec_float ("width",
-                        P_("Width"),
-                        P_("Width of the actor"),
-                        0.0, G_MAXFLOAT,
-                        0.0,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT_Z]);
 
-  /**
-   * ClutterActor:height:
-   *
-   * Height of the actor (in pixels).  If written, forces the minimum and
-   * natural size request of the actor to the given height. If read, returns
-   * the allocated height if available, otherwise the height request.
-   *
-   * The #ClutterActor:height property is animatable.
-   */
-  obj_props[PROP_HEIGHT] =
-    g_param_spec_float ("height",
-                        P_("Height"),
-                        P_("Height of the actor"),
-                        0.0, G_MAXFLOAT,
-                        0.0,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+  clutter_actor_queue_transform_redraw (self);
+}
 
-  /**
-   * ClutterActor:size:
-   *
-   * The size of the actor.
-   *
-   * This property is a shorthand for setting and getting the
-   * #ClutterActor:width and #ClutterActor:height at the same time.
-   *
-   * The #ClutterActor:size property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_SIZE] =
-    g_param_spec_boxed ("size",
-                        P_("Size"),
-                        P_("The size of the actor"),
-                        CLUTTER_TYPE_SIZE,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+/*< private >
+ * clutter_actor_set_translation_internal:
+ * @self: a #ClutterActor
+ * @axis: the axis of the translation to change
+ * @angle: the translation as a value along @axis
+ *
+ * Sets the translation on the given @axis
+ */
+static void
+clutter_actor_set_translation_internal (ClutterActor *self,
+                                        gfloat        value,
+                                        GParamSpec   *pspec)
+{
+  GObject *obj = G_OBJECT (self);
+  ClutterTransformInfo *info;
 
-  /**
-   * ClutterActor:fixed-x:
-   *
-   * The fixed X position of the actor in pixels.
-   *
-   * Writing this property sets #ClutterActor:fixed-position-set
-   * property as well, as a side effect
-   *
-   *
-   */
-  obj_props[PROP_FIXED_X] =
-    g_param_spec_float ("fixed-x",
-                        P_("Fixed X"),
-                        P_("Forced X position of the actor"),
-                        -G_MAXFLOAT, G_MAXFLOAT,
-                        0.0,
-                        CLUTTER_PARAM_READWRITE);
+  info = _clutter_actor_get_transform_info (self);
 
-  /**
-   * ClutterActor:fixed-y:
-   *
-   * The fixed Y position of the actor in pixels.
-   *
-   * Writing this property sets the #ClutterActor:fixed-position-set
-   * property as well, as a side effect
-   *
-   *
-   */
-  obj_props[PROP_FIXED_Y] =
-    g_param_spec_float ("fixed-y",
-                        P_("Fixed Y"),
-                        P_("Forced Y position of the actor"),
-                        -G_MAXFLOAT, G_MAXFLOAT,
-                        0,
-                        CLUTTER_PARAM_READWRITE);
+  if (pspec == obj_props[PROP_TRANSLATION_X])
+    info->translation.x = value;
+  else if (pspec == obj_props[PROP_TRANSLATION_Y])
+    info->translation.y = value;
+  else if (pspec == obj_props[PROP_TRANSLATION_Z])
+    info->translation.z = value;
+  else
+    g_assert_not_reached ();
 
-  /**
-   * ClutterActor:fixed-position-set:
-   *
-   * This flag controls whether the #ClutterActor:fixed-x and
-   * #ClutterActor:fixed-y properties are used
-   *
-   *
-   */
-  obj_props[PROP_FIXED_POSITION_SET] =
-    g_param_spec_boolean ("fixed-position-set",
-                          P_("Fixed position set"),
-                          P_("Whether to use fixed positioning for the actor"),
-                          FALSE,
-                          CLUTTER_PARAM_READWRITE);
+  clutter_actor_invalidate_transform (self);
+  clutter_actor_invalidate_pick (self);
+  clutter_actor_queue_transform_redraw (self);
+  g_object_notify_by_pspec (obj, pspec);
+}
 
-  /**
-   * ClutterActor:min-width:
-   *
-   * A forced minimum width request for the actor, in pixels
-   *
-   * Writing this property sets the #ClutterActor:min-width-set property
-   * as well, as a side effect.
-   *
-   *This property overrides the usual width request of the actor.
-   *
-   *
-   */
-  obj_props[PROP_MIN_WIDTH] =
-    g_param_spec_float ("min-width",
-                        P_("Min Width"),
-                        P_("Forced minimum width request for the actor"),
-                        0.0, G_MAXFLOAT,
-                        0.0,
-                        CLUTTER_PARAM_READWRITE);
+static inline void
+clutter_actor_set_translation_factor (ClutterActor      *self,
+                                      ClutterRotateAxis  axis,
+                                      gdouble            value)
+{
+  const ClutterTransformInfo *info;
+  const float *translate_p = NULL;
+  GParamSpec *pspec = NULL;
 
-  /**
-   * ClutterActor:min-height:
-   *
-   * A forced minimum height request for the actor, in pixels
-   *
-   * Writing this property sets the #ClutterActor:min-height-set property
-   * as well, as a side effect. This property overrides the usual height
-   * request of the actor.
-   *
-   *
-   */
-  obj_props[PROP_MIN_HEIGHT] =
-    g_param_spec_float ("min-height",
-                        P_("Min Height"),
-                        P_("Forced minimum height request for the actor"),
-                        0.0, G_MAXFLOAT,
-                        0.0,
-                        CLUTTER_PARAM_READWRITE);
+  info = _clutter_actor_get_transform_info_or_defaults (self);
 
-  /**
-   * ClutterActor:natural-width:
-   *
-   * A forced natural width request for the actor, in pixels
-   *
-   * Writing this property sets the #ClutterActor:natural-width-set
-   * property as well, as a side effect. This property overrides the
-   * usual width request of the actor
-   *
-   *
-   */
-  obj_props[PROP_NATURAL_WIDTH] =
-    g_param_spec_float ("natural-width",
-                        P_("Natural Width"),
-                        P_("Forced natural width request for the actor"),
-                        0.0, G_MAXFLOAT,
-                        0.0,
-                        CLUTTER_PARAM_READWRITE);
-
-  /**
-   * ClutterActor:natural-height:
-   *
-   * A forced natural height request for the actor, in pixels
-   *
-   * Writing this property sets the #ClutterActor:natural-height-set
-   * property as well, as a side effect. This property overrides the
-   * usual height request of the actor
-   *
-   *
-   */
-  obj_props[PROP_NATURAL_HEIGHT] =
-    g_param_spec_float ("natural-height",
-                        P_("Natural Height"),
-                        P_("Forced natural height request for the actor"),
-                        0.0, G_MAXFLOAT,
-                        0.0,
-                        CLUTTER_PARAM_READWRITE);
+  switch (axis)
+    {
+    case CLUTTER_X_AXIS:
+      pspec = obj_props[PROP_TRANSLATION_X];
+      translate_p = &info->translation.x;
+      break;
 
-  /**
-   * ClutterActor:min-width-set:
-   *
-   * This flag controls whether the #ClutterActor:min-width property
-   * is used
-   *
-   *
-   */
-  obj_props[PROP_MIN_WIDTH_SET] =
-    g_param_spec_boolean ("min-width-set",
-                          P_("Minimum width set"),
-                          P_("Whether to use the min-width property"),
-                          FALSE,
-                          CLUTTER_PARAM_READWRITE);
+    case CLUTTER_Y_AXIS:
+      pspec = obj_props[PROP_TRANSLATION_Y];
+      translate_p = &info->translation.y;
+      break;
 
-  /**
-   * ClutterActor:min-height-set:
-   *
-   * This flag controls whether the #ClutterActor:min-height property
-   * is used
-   *
-   *
-   */
-  obj_props[PROP_MIN_HEIGHT_SET] =
-    g_param_spec_boolean ("min-height-set",
-                          P_("Minimum height set"),
-                          P_("Whether to use the min-height property"),
-                          FALSE,
-                          CLUTTER_PARAM_READWRITE);
+    case CLUTTER_Z_AXIS:
+      pspec = obj_props[PROP_TRANSLATION_Z];
+      translate_p = &info->translation.z;
+      break;
+    }
 
-  /**
-   * ClutterActor:natural-width-set:
-   *
-   * This flag controls whether the #ClutterActor:natural-width property
-   * is used
-   *
-   *
-   */
-  obj_props[PROP_NATURAL_WIDTH_SET] =
-    g_param_spec_boolean ("natural-width-set",
-                          P_("Natural width set"),
-                          P_("Whether to use the natural-width property"),
-                          FALSE,
-                          CLUTTER_PARAM_READWRITE);
+  g_assert (pspec != NULL);
+  g_assert (translate_p != NULL);
 
-  /**
-   * ClutterActor:natural-height-set:
-   *
-   * This flag controls whether the #ClutterActor:natural-height property
-   * is used
-   *
-   *
-   */
-  obj_props[PROP_NATURAL_HEIGHT_SET] =
-    g_param_spec_boolean ("natural-height-set",
-                          P_("Natural height set"),
-                          P_("Whether to use the natural-height property"),
-                          FALSE,
-                          CLUTTER_PARAM_READWRITE);
+  _clutter_actor_create_transition (self, pspec, *translate_p, value);
+}
 
-  /**
-   * ClutterActor:allocation:
-   *
-   * The allocation for the actor, in pixels
-   *
-   * This is property is read-only, but you might monitor it to know when an
-   * actor moves or resizes
-   *
-   *
-   */
-  obj_props[PROP_ALLOCATION] =
-    g_param_spec_boxed ("allocation",
-                        P_("Allocation"),
-                        P_("The actor's allocation"),
-                        CLUTTER_TYPE_ACTOR_BOX,
-                        G_PARAM_READABLE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+/**
+ * clutter_actor_set_translation:
+ * @self: a #ClutterActor
+ * @translate_x: the translation along the X axis
+ * @translate_y: the translation along the Y axis
+ * @translate_z: the translation along the Z axis
+ *
+ * Sets an additional translation transformation on a #ClutterActor,
+ * relative to the #ClutterActor:pivot-point.
+ *
+ *
+ */
+void
+clutter_actor_set_translation (ClutterActor *self,
+                               gfloat        translate_x,
+                               gfloat        translate_y,
+                               gfloat        translate_z)
+{
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  /**
-   * ClutterActor:request-mode:
-   *
-   * Request mode for the #ClutterActor. The request mode determines the
-   * type of geometry management used by the actor, either height for width
-   * (the default) or width for height.
-   *
-   * For actors implementing height for width, the parent container should get
-   * the preferred width first, and then the preferred height for that width.
-   *
-   * For actors implementing width for height, the parent container should get
-   * the preferred height first, and then the preferred width for that height.
-   *
-   * For instance:
-   *
-   * |[
-   *   ClutterRequestMode mode;
-   *   gfloat natural_width, min_width;
-   *   gfloat natural_height, min_height;
-   *
-   *   mode = clutter_actor_get_request_mode (child);
-   *   if (mode == CLUTTER_REQUEST_HEIGHT_FOR_WIDTH)
-   *     {
-   *       clutter_actor_get_preferred_width (child, -1,
-   *                                          &amp;min_width,
-   *                                          &amp;natural_width);
-   *       clutter_actor_get_preferred_height (child, natural_width,
-   *                                           &amp;min_height,
-   *                                           &amp;natural_height);
-   *     }
-   *   else
-   *     {
-   *       clutter_actor_get_preferred_height (child, -1,
-   *                                           &amp;min_height,
-   *                                           &amp;natural_height);
-   *       clutter_actor_get_preferred_width (child, natural_height,
-   *                                          &amp;min_width,
-   *                                          &amp;natural_width);
-   *     }
-   * ]|
-   *
-   * will retrieve the minimum and natural width and height depending on the
-   * preferred request mode of the #ClutterActor "child".
-   *
-   * The clutter_actor_get_preferred_size() function will implement this
-   * check for you.
-   *
-   *
-   */
-  obj_props[PROP_REQUEST_MODE] =
-    g_param_spec_enum ("request-mode",
-                       P_("Request Mode"),
-                       P_("The actor's request mode"),
-                       CLUTTER_TYPE_REQUEST_MODE,
-                       CLUTTER_REQUEST_HEIGHT_FOR_WIDTH,
-                       CLUTTER_PARAM_READWRITE);
+  g_object_freeze_notify (G_OBJECT (self));
 
-  /**
-   * ClutterActor:z-position:
-   *
-   * The actor's position on the Z axis, relative to the parent's
-   * transformations.
-   *
-   * Positive values will bring the actor's position nearer to the user,
-   * whereas negative values will bring the actor's position farther from
-   * the user.
-   *
-   * The #ClutterActor:z-position does not affect the paint or allocation
-   * order.
-   *
-   * The #ClutterActor:z-position property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_Z_POSITION] =
-    g_param_spec_float ("z-position",
-                        P_("Z Position"),
-                        P_("The actor's position on the Z axis"),
-                        -G_MAXFLOAT, G_MAXFLOAT,
-                        0.0f,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+  clutter_actor_set_translation_factor (self, CLUTTER_X_AXIS, translate_x);
+  clutter_actor_set_translation_factor (self, CLUTTER_Y_AXIS, translate_y);
+  clutter_actor_set_translation_factor (self, CLUTTER_Z_AXIS, translate_z);
 
-  /**
-   * ClutterActor:opacity:
-   *
-   * Opacity of an actor, between 0 (fully transparent) and
-   * 255 (fully opaque)
-   *
-   * The #ClutterActor:opacity property is animatable.
-   */
-  obj_props[PROP_OPACITY] =
-    g_param_spec_uint ("opacity",
-                       P_("Opacity"),
-                       P_("Opacity of an actor"),
-                       0, 255,
-                       255,
-                       G_PARAM_READWRITE |
-                       G_PARAM_STATIC_STRINGS |
-                       CLUTTER_PARAM_ANIMATABLE);
+  g_object_thaw_notify (G_OBJECT (self));
+}
 
-  /**
-   * ClutterActor:offscreen-redirect:
-   *
-   * Determines the conditions in which the actor will be redirected
-   * to an offscreen framebuffer while being painted. For example this
-   * can be used to cache an actor in a framebuffer or for improved
-   * handling of transparent actors. See
-   * clutter_actor_set_offscreen_redirect() for details.
-   *
-   *
-   */
-  obj_props[PROP_OFFSCREEN_REDIRECT] =
-    g_param_spec_flags ("offscreen-redirect",
-                        P_("Offscreen redirect"),
-                        P_("Flags controlling when to flatten the actor into a single image"),
-                        CLUTTER_TYPE_OFFSCREEN_REDIRECT,
-                        0,
-                        CLUTTER_PARAM_READWRITE);
-
-  /**
-   * ClutterActor:visible:
-   *
-   * Whether the actor is set to be visible or not
-   *
-   * See also #ClutterActor:mapped
-   */
-  obj_props[PROP_VISIBLE] =
-    g_param_spec_boolean ("visible",
-                          P_("Visible"),
-                          P_("Whether the actor is visible or not"),
-                          TRUE,
-                          CLUTTER_PARAM_READWRITE);
+/**
+ * clutter_actor_get_translation:
+ * @self: a #ClutterActor
+ * @translate_x: (out) (allow-none): return location for the X component
+ *   of the translation, or %NULL
+ * @translate_y: (out) (allow-none): return location for the Y component
+ *   of the translation, or %NULL
+ * @translate_z: (out) (allow-none): return location for the Z component
+ *   of the translation, or %NULL
+ *
+ * Retrieves the translation set using clutter_actor_set_translation().
+ *
+ *
+ */
+void
+clutter_actor_get_translation (ClutterActor *self,
+                               gfloat       *translate_x,
+                               gfloat       *translate_y,
+                               gfloat       *translate_z)
+{
+  const ClutterTransformInfo *info;
 
-  /**
-   * ClutterActor:mapped:
-   *
-   * Whether the actor is mapped (will be painted when the stage
-   * to which it belongs is mapped)
-   *
-   *
-   */
-  obj_props[PROP_MAPPED] =
-    g_param_spec_boolean ("mapped",
-                          P_("Mapped"),
-                          P_("Whether the actor will be painted"),
-                          FALSE,
-                          CLUTTER_PARAM_READABLE);
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  /**
-   * ClutterActor:realized:
-   *
-   * Whether the actor has been realized
-   *
-   *
-   */
-  obj_props[PROP_REALIZED] =
-    g_param_spec_boolean ("realized",
-                          P_("Realized"),
-                          P_("Whether the actor has been realized"),
-                          FALSE,
-                          CLUTTER_PARAM_READABLE);
+  info = _clutter_actor_get_transform_info_or_defaults (self);
 
-  /**
-   * ClutterActor:reactive:
-   *
-   * Whether the actor is reactive to events or not
-   *
-   * Only reactive actors will emit event-related signals
-   *
-   *
-   */
-  obj_props[PROP_REACTIVE] =
-    g_param_spec_boolean ("reactive",
-                          P_("Reactive"),
-                          P_("Whether the actor is reactive to events"),
-                          FALSE,
-                          CLUTTER_PARAM_READWRITE);
+  if (translate_x != NULL)
+    *translate_x = info->translation.x;
 
-  /**
-   * ClutterActor:has-clip:
-   *
-   * Whether the actor has the #ClutterActor:clip property set or not
-   */
-  obj_props[PROP_HAS_CLIP] =
-    g_param_spec_boolean ("has-clip",
-                          P_("Has Clip"),
-                          P_("Whether the actor has a clip set"),
-                          FALSE,
-                          CLUTTER_PARAM_READABLE);
+  if (translate_y != NULL)
+    *translate_y = info->translation.y;
 
-  /**
-   * ClutterActor:clip-rect:
-   *
-   * The visible region of the actor, in actor-relative coordinates,
-   * expressed as a #ClutterRect.
-   *
-   * Setting this property to %NULL will unset the existing clip.
-   *
-   * Setting this property will change the #ClutterActor:has-clip
-   * property as a side effect.
-   *
-   *
-   */
-  obj_props[PROP_CLIP_RECT] =
-    g_param_spec_boxed ("clip-rect",
-                        P_("Clip Rectangle"),
-                        P_("The visible region of the actor"),
-                        CLUTTER_TYPE_RECT,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS);
+  if (translate_z != NULL)
+    *translate_z = info->translation.z;
+}
 
-  /**
-   * ClutterActor:name:
-   *
-   * The name of the actor
-   *
-   *
-   */
-  obj_props[PROP_NAME] =
-    g_param_spec_string ("name",
-                         P_("Name"),
-                         P_("Name of the actor"),
-                         NULL,
-                         CLUTTER_PARAM_READWRITE);
+/*< private >
+ * clutter_actor_set_rotation_angle_internal:
+ * @self: a #ClutterActor
+ * @angle: the angle of rotation
+ * @pspec: the #GParamSpec of the property
+ *
+ * Sets the rotation angle on the given axis without affecting the
+ * rotation center point.
+ */
+static inline void
+clutter_actor_set_rotation_angle_internal (ClutterActor *self,
+                                           gdouble       angle,
+                                           GParamSpec   *pspec)
+{
+  ClutterTransformInfo *info;
 
-  /**
-   * ClutterActor:pivot-point:
-   *
-   * The point around which the scaling and rotation transformations occur.
-   *
-   * The pivot point is expressed in normalized coordinates space, with (0, 0)
-   * being the top left corner of the actor and (1, 1) the bottom right corner
-   * of the actor.
-   *
-   * The default pivot point is located at (0, 0).
-   *
-   * The #ClutterActor:pivot-point property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_PIVOT_POINT] =
-    g_param_spec_boxed ("pivot-point",
-                        P_("Pivot Point"),
-                        P_("The point around which the scaling and rotation occur"),
-                        CLUTTER_TYPE_POINT,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+  info = _clutter_actor_get_transform_info (self);
 
-  /**
-   * ClutterActor:pivot-point-z:
-   *
-   * The Z component of the #ClutterActor:pivot-point, expressed as a value
-   * along the Z axis.
-   *
-   * The #ClutterActor:pivot-point-z property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_PIVOT_POINT_Z] =
-    g_param_spec_float ("pivot-point-z",
-                        P_("Pivot Point Z"),
-                        P_("Z component of the pivot point"),
-                        -G_MAXFLOAT, G_MAXFLOAT,
-                        0.f,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+  if (pspec == obj_props[PROP_ROTATION_ANGLE_X])
+    info->rx_angle = angle;
+  else if (pspec == obj_props[PROP_ROTATION_ANGLE_Y])
+    info->ry_angle = angle;
+  else if (pspec == obj_props[PROP_ROTATION_ANGLE_Z])
+    info->rz_angle = angle;
+  else
+    g_assert_not_reached ();
 
-  /**
-   * ClutterActor:scale-x:
-   *
-   * The horizontal scale of the actor.
-   *
-   * The #ClutterActor:scale-x property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_SCALE_X] =
-    g_param_spec_double ("scale-x",
-                         P_("Scale X"),
-                         P_("Scale factor on the X axis"),
-                         0.0, G_MAXDOUBLE,
-                         1.0,
-                         G_PARAM_READWRITE |
-                         G_PARAM_STATIC_STRINGS |
-                         CLUTTER_PARAM_ANIMATABLE);
+  clutter_actor_invalidate_transform (self);
+  clutter_actor_invalidate_pick (self);
 
-  /**
-   * ClutterActor:scale-y:
-   *
-   * The vertical scale of the actor.
-   *
-   * The #ClutterActor:scale-y property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_SCALE_Y] =
-    g_param_spec_double ("scale-y",
-                         P_("Scale Y"),
-                         P_("Scale factor on the Y axis"),
-                         0.0, G_MAXDOUBLE,
-                         1.0,
-                         G_PARAM_READWRITE |
-                         G_PARAM_STATIC_STRINGS |
-                         CLUTTER_PARAM_ANIMATABLE);
+  clutter_actor_queue_transform_redraw (self);
 
-  /**
-   * ClutterActor:scale-z:
-   *
-   * The scale factor of the actor along the Z axis.
-   *
-   * The #ClutterActor:scale-y property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_SCALE_Z] =
-    g_param_spec_double ("scale-z",
-                         P_("Scale Z"),
-                         P_("Scale factor on the Z axis"),
-                         0.0, G_MAXDOUBLE,
-                         1.0,
-                         G_PARAM_READWRITE |
-                         G_PARAM_STATIC_STRINGS |
-                         CLUTTER_PARAM_ANIMATABLE);
+  g_object_notify_by_pspec (G_OBJECT (self), pspec);
+}
 
-  /**
-   * ClutterActor:rotation-angle-x:
-   *
-   * The rotation angle on the X axis.
-   *
-   * The #ClutterActor:rotation-angle-x property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_ROTATION_ANGLE_X] =
-    g_param_spec_double ("rotation-angle-x",
-                         P_("Rotation Angle X"),
-                         P_("The rotation angle on the X axis"),
-                         -G_MAXDOUBLE, G_MAXDOUBLE,
-                         0.0,
-                         G_PARAM_READWRITE |
-                         G_PARAM_STATIC_STRINGS |
-                         CLUTTER_PARAM_ANIMATABLE);
+/**
+ * clutter_actor_set_rotation_angle:
+ * @self: a #ClutterActor
+ * @axis: the axis to set the angle one
+ * @angle: the angle of rotation, in degrees
+ *
+ * Sets the @angle of rotation of a #ClutterActor on the given @axis.
+ *
+ * This function is a convenience for setting the rotation properties
+ * #ClutterActor:rotation-angle-x, #ClutterActor:rotation-angle-y,
+ * and #ClutterActor:rotation-angle-z.
+ *
+ * The center of rotation is established by the #ClutterActor:pivot-point
+ * property.
+ *
+ *
+ */
+void
+clutter_actor_set_rotation_angle (ClutterActor      *self,
+                                  ClutterRotateAxis  axis,
+                                  gdouble            angle)
+{
+  const ClutterTransformInfo *info;
+  const double *cur_angle_p = NULL;
+  GParamSpec *pspec = NULL;
 
-  /**
-   * ClutterActor:rotation-angle-y:
-   *
-   * The rotation angle on the Y axis
-   *
-   * The #ClutterActor:rotation-angle-y property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_ROTATION_ANGLE_Y] =
-    g_param_spec_double ("rotation-angle-y",
-                         P_("Rotation Angle Y"),
-                         P_("The rotation angle on the Y axis"),
-                         -G_MAXDOUBLE, G_MAXDOUBLE,
-                         0.0,
-                         G_PARAM_READWRITE |
-                         G_PARAM_STATIC_STRINGS |
-                         CLUTTER_PARAM_ANIMATABLE);
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  /**
-   * ClutterActor:rotation-angle-z:
-   *
-   * The rotation angle on the Z axis
-   *
-   * The #ClutterActor:rotation-angle-z property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_ROTATION_ANGLE_Z] =
-    g_param_spec_double ("rotation-angle-z",
-                         P_("Rotation Angle Z"),
-                         P_("The rotation angle on the Z axis"),
-                         -G_MAXDOUBLE, G_MAXDOUBLE,
-                         0.0,
-                         G_PARAM_READWRITE |
-                         G_PARAM_STATIC_STRINGS |
-                         CLUTTER_PARAM_ANIMATABLE);
+  info = _clutter_actor_get_transform_info_or_defaults (self);
 
-  /**
-   * ClutterActor:translation-x:
-   *
-   * An additional translation applied along the X axis, relative
-   * to the actor's #ClutterActor:pivot-point.
-   *
-   * The #ClutterActor:translation-x property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_TRANSLATION_X] =
-    g_param_spec_float ("translation-x",
-                        P_("Translation X"),
-                        P_("Translation along the X axis"),
-                        -G_MAXFLOAT, G_MAXFLOAT,
-                        0.f,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+  switch (axis)
+    {
+    case CLUTTER_X_AXIS:
+      cur_angle_p = &info->rx_angle;
+      pspec = obj_props[PROP_ROTATION_ANGLE_X];
+      break;
 
-  /**
-   * ClutterActor:translation-y:
-   *
-   * An additional translation applied along the Y axis, relative
-   * to the actor's #ClutterActor:pivot-point.
-   *
-   * The #ClutterActor:translation-y property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_TRANSLATION_Y] =
-    g_param_spec_float ("translation-y",
-                        P_("Translation Y"),
-                        P_("Translation along the Y axis"),
-                        -G_MAXFLOAT, G_MAXFLOAT,
-                        0.f,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+    case CLUTTER_Y_AXIS:
+      cur_angle_p = &info->ry_angle;
+      pspec = obj_props[PROP_ROTATION_ANGLE_Y];
+      break;
 
-  /**
-   * ClutterActor:translation-z:
-   *
-   * An additional translation applied along the Z axis, relative
-   * to the actor's #ClutterActor:pivot-point.
-   *
-   * The #ClutterActor:translation-z property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_TRANSLATION_Z] =
-    g_param_spec_float ("translation-z",
-                        P_("Translation Z"),
-                        P_("Translation along the Z axis"),
-                        -G_MAXFLOAT, G_MAXFLOAT,
-                        0.f,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+    case CLUTTER_Z_AXIS:
+      cur_angle_p = &info->rz_angle;
+      pspec = obj_props[PROP_ROTATION_ANGLE_Z];
+      break;
+    }
 
-  /**
-   * ClutterActor:transform:
-   *
-   * Overrides the transformations of a #ClutterActor with a custom
-   * matrix.
-   *
-   * The matrix specified by the #ClutterActor:transform property is
-   * applied to the actor and its children relative to the actor's
-   * #ClutterActor:allocation and #ClutterActor:pivot-point.
-   *
-   * Application code should rarely need to use this function directly.
-   *
-   * Setting this property with a #ClutterMatrix will set the
-   * #ClutterActor:transform-set property to %TRUE as a side effect;
-   * setting this property with %NULL will set the
-   * #ClutterActor:transform-set property to %FALSE.
-   *
-   * The #ClutterActor:transform property is animatable.
-   */
-  obj_props[PROP_TRANSFORM] =
-    g_param_spec_boxed ("transform",
-                        P_("Transform"),
-                        P_("Transformation matrix"),
-                        CLUTTER_TYPE_MATRIX,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+  g_assert (pspec != NULL);
+  g_assert (cur_angle_p != NULL);
 
-  /**
-   * ClutterActor:transform-set:
-   *
-   * Whether the #ClutterActor:transform property is set.
-   */
-  obj_props[PROP_TRANSFORM_SET] =
-    g_param_spec_boolean ("transform-set",
-                          P_("Transform Set"),
-                          P_("Whether the transform property is set"),
-                          FALSE,
-                          G_PARAM_READABLE |
-                          G_PARAM_STATIC_STRINGS);
+  _clutter_actor_create_transition (self, pspec, *cur_angle_p, angle);
+}
 
-  /**
-   * ClutterActor:child-transform:
-   *
-   * Applies a transformation matrix on each child of an actor.
-   *
-   * Setting this property with a #ClutterMatrix will set the
-   * #ClutterActor:child-transform-set property to %TRUE as a side effect;
-   * setting this property with %NULL will set the
-   * #ClutterActor:child-transform-set property to %FALSE.
-   *
-   * The #ClutterActor:child-transform property is animatable.
-   */
-  obj_props[PROP_CHILD_TRANSFORM] =
-    g_param_spec_boxed ("child-transform",
-                        P_("Child Transform"),
-                        P_("Children transformation matrix"),
-                        CLUTTER_TYPE_MATRIX,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+/**
+ * clutter_actor_get_rotation_angle:
+ * @self: a #ClutterActor
+ * @axis: the axis of the rotation
+ *
+ * Retrieves the angle of rotation set by clutter_actor_set_rotation_angle().
+ *
+ * Return value: the angle of rotation, in degrees
+ *
+ *
+ */
+gdouble
+clutter_actor_get_rotation_angle (ClutterActor      *self,
+                                  ClutterRotateAxis  axis)
+{
+  const ClutterTransformInfo *info;
+  gdouble retval;
 
-  /**
-   * ClutterActor:child-transform-set:
-   *
-   * Whether the #ClutterActor:child-transform property is set.
-   *
-   *
-   */
-  obj_props[PROP_CHILD_TRANSFORM_SET] =
-    g_param_spec_boolean ("child-transform-set",
-                          P_("Child Transform Set"),
-                          P_("Whether the child-transform property is set"),
-                          FALSE,
-                          G_PARAM_READABLE |
-                          G_PARAM_STATIC_STRINGS);
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0.0);
 
-  /**
-   * ClutterActor:clip-to-allocation:
-   *
-   * Whether the clip region should track the allocated area
-   * of the actor.
-   *
-   * This property is ignored if a clip area has been explicitly
-   * set using clutter_actor_set_clip().
-   *
-   *
-   */
-  obj_props[PROP_CLIP_TO_ALLOCATION] =
-    g_param_spec_boolean ("clip-to-allocation",
-                          P_("Clip to Allocation"),
-                          P_("Sets the clip region to track the actor's allocation"),
-                          FALSE,
-                          CLUTTER_PARAM_READWRITE);
+  info = _clutter_actor_get_transform_info_or_defaults (self);
 
-  /**
-   * ClutterActor:text-direction:
-   *
-   * The direction of the text inside a #ClutterActor.
-   *
-   *
-   */
-  obj_props[PROP_TEXT_DIRECTION] =
-    g_param_spec_enum ("text-direction",
-                       P_("Text Direction"),
-                       P_("Direction of the text"),
-                       CLUTTER_TYPE_TEXT_DIRECTION,
-                       CLUTTER_TEXT_DIRECTION_LTR,
-                       CLUTTER_PARAM_READWRITE);
+  switch (axis)
+    {
+    case CLUTTER_X_AXIS:
+      retval = info->rx_angle;
+      break;
 
-  /**
-   * ClutterActor:has-pointer:
-   *
-   * Whether the actor contains the pointer of a #ClutterInputDevice
-   * or not.
-   *
-   *
-   */
-  obj_props[PROP_HAS_POINTER] =
-    g_param_spec_boolean ("has-pointer",
-                          P_("Has Pointer"),
-                          P_("Whether the actor contains the pointer of an input device"),
-                          FALSE,
-                          CLUTTER_PARAM_READABLE);
+    case CLUTTER_Y_AXIS:
+      retval = info->ry_angle;
+      break;
 
-  /**
-   * ClutterActor:actions:
-   *
-   * Adds a #ClutterAction to the actor
-   *
-   *
-   */
-  obj_props[PROP_ACTIONS] =
-    g_param_spec_object ("actions",
-                         P_("Actions"),
-                         P_("Adds an action to the actor"),
-                         CLUTTER_TYPE_ACTION,
-                         CLUTTER_PARAM_WRITABLE);
+    case CLUTTER_Z_AXIS:
+      retval = info->rz_angle;
+      break;
 
-  /**
-   * ClutterActor:constraints:
-   *
-   * Adds a #ClutterConstraint to the actor
-   *
-   *
-   */
-  obj_props[PROP_CONSTRAINTS] =
-    g_param_spec_object ("constraints",
-                         P_("Constraints"),
-                         P_("Adds a constraint to the actor"),
-                         CLUTTER_TYPE_CONSTRAINT,
-                         CLUTTER_PARAM_WRITABLE);
+    default:
+      g_warn_if_reached ();
+      retval = 0.0;
+      break;
+    }
 
-  /**
-   * ClutterActor:effect:
-   *
-   * Adds #ClutterEffect to the list of effects be applied on a #ClutterActor
-   *
-   *
-   */
-  obj_props[PROP_EFFECT] =
-    g_param_spec_object ("effect",
-                         P_("Effect"),
-                         P_("Add an effect to be applied on the actor"),
-                         CLUTTER_TYPE_EFFECT,
-                         CLUTTER_PARAM_WRITABLE);
+  return retval;
+}
 
-  /**
-   * ClutterActor:layout-manager:
-   *
-   * A delegate object for controlling the layout of the children of
-   * an actor.
-   *
-   *
-   */
-  obj_props[PROP_LAYOUT_MANAGER] =
-    g_param_spec_object ("layout-manager",
-                         P_("Layout Manager"),
-                         P_("The object controlling the layout of an actor's children"),
-                         CLUTTER_TYPE_LAYOUT_MANAGER,
-                         CLUTTER_PARAM_READWRITE);
+static void
+clutter_actor_set_scale_factor_internal (ClutterActor *self,
+                                         double factor,
+                                         GParamSpec *pspec)
+{
+  GObject *obj = G_OBJECT (self);
+  ClutterTransformInfo *info;
 
-  /**
-   * ClutterActor:x-expand:
-   *
-   * Whether a layout manager should assign more space to the actor on
-   * the X axis.
-   *
-   *
-   */
-  obj_props[PROP_X_EXPAND] =
-    g_param_spec_boolean ("x-expand",
-                          P_("X Expand"),
-                          P_("Whether extra horizontal space should be assigned to the actor"),
-                          FALSE,
-                          G_PARAM_READWRITE |
-                          G_PARAM_STATIC_STRINGS);
+  info = _clutter_actor_get_transform_info (self);
 
-  /**
-   * ClutterActor:y-expand:
-   *
-   * Whether a layout manager should assign more space to the actor on
-   * the Y axis.
-   *
-   *
-   */
-  obj_props[PROP_Y_EXPAND] =
-    g_param_spec_boolean ("y-expand",
-                          P_("Y Expand"),
-                          P_("Whether extra vertical space should be assigned to the actor"),
-                          FALSE,
-                          G_PARAM_READWRITE |
-                          G_PARAM_STATIC_STRINGS);
+  if (pspec == obj_props[PROP_SCALE_X])
+    info->scale_x = factor;
+  else if (pspec == obj_props[PROP_SCALE_Y])
+    info->scale_y = factor;
+  else if (pspec == obj_props[PROP_SCALE_Z])
+    info->scale_z = factor;
+  else
+    g_assert_not_reached ();
 
-  /**
-   * ClutterActor:x-align:
-   *
-   * The alignment of an actor on the X axis, if the actor has been given
-   * extra space for its allocation. See also the #ClutterActor:x-expand
-   * property.
-   *
-   *
-   */
-  obj_props[PROP_X_ALIGN] =
-    g_param_spec_enum ("x-align",
-                       P_("X Alignment"),
-                       P_("The alignment of the actor on the X axis within its allocation"),
-                       CLUTTER_TYPE_ACTOR_ALIGN,
-                       CLUTTER_ACTOR_ALIGN_FILL,
-                       CLUTTER_PARAM_READWRITE);
+  clutter_actor_invalidate_transform (self);
+  clutter_actor_invalidate_pick (self);
+  clutter_actor_queue_transform_redraw (self);
+  g_object_notify_by_pspec (obj, pspec);
+}
 
-  /**
-   * ClutterActor:y-align:
-   *
-   * The alignment of an actor on the Y axis, if the actor has been given
-   * extra space for its allocation.
-   *
-   *
-   */
-  obj_props[PROP_Y_ALIGN] =
-    g_param_spec_enum ("y-align",
-                       P_("Y Alignment"),
-                       P_("The alignment of the actor on the Y axis within its allocation"),
-                       CLUTTER_TYPE_ACTOR_ALIGN,
-                       CLUTTER_ACTOR_ALIGN_FILL,
-                       CLUTTER_PARAM_READWRITE);
+static inline void
+clutter_actor_set_scale_factor (ClutterActor      *self,
+                                ClutterRotateAxis  axis,
+                                gdouble            factor)
+{
+  const ClutterTransformInfo *info;
+  const double *scale_p = NULL;
+  GParamSpec *pspec = NULL;
 
-  /**
-   * ClutterActor:margin-top:
-   *
-   * The margin (in pixels) from the top of the actor.
-   *
-   * This property adds a margin to the actor's preferred size; the margin
-   * will be automatically taken into account when allocating the actor.
-   *
-   * The #ClutterActor:margin-top property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_MARGIN_TOP] =
-    g_param_spec_float ("margin-top",
-                        P_("Margin Top"),
-                        P_("Extra space at the top"),
-                        0.0, G_MAXFLOAT,
-                        0.0,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+  info = _clutter_actor_get_transform_info_or_defaults (self);
 
-  /**
-   * ClutterActor:margin-bottom:
-   *
-   * The margin (in pixels) from the bottom of the actor.
-   *
-   * This property adds a margin to the actor's preferred size; the margin
-   * will be automatically taken into account when allocating the actor.
-   *
-   * The #ClutterActor:margin-bottom property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_MARGIN_BOTTOM] =
-    g_param_spec_float ("margin-bottom",
-                        P_("Margin Bottom"),
-                        P_("Extra space at the bottom"),
-                        0.0, G_MAXFLOAT,
-                        0.0,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+  switch (axis)
+    {
+    case CLUTTER_X_AXIS:
+      pspec = obj_props[PROP_SCALE_X];
+      scale_p = &info->scale_x;
+      break;
 
-  /**
-   * ClutterActor:margin-left:
-   *
-   * The margin (in pixels) from the left of the actor.
-   *
-   * This property adds a margin to the actor's preferred size; the margin
-   * will be automatically taken into account when allocating the actor.
-   *
-   * The #ClutterActor:margin-left property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_MARGIN_LEFT] =
-    g_param_spec_float ("margin-left",
-                        P_("Margin Left"),
-                        P_("Extra space at the left"),
-                        0.0, G_MAXFLOAT,
-                        0.0,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+    case CLUTTER_Y_AXIS:
+      pspec = obj_props[PROP_SCALE_Y];
+      scale_p = &info->scale_y;
+      break;
 
-  /**
-   * ClutterActor:margin-right:
-   *
-   * The margin (in pixels) from the right of the actor.
-   *
-   * This property adds a margin to the actor's preferred size; the margin
-   * will be automatically taken into account when allocating the actor.
-   *
-   * The #ClutterActor:margin-right property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_MARGIN_RIGHT] =
-    g_param_spec_float ("margin-right",
-                        P_("Margin Right"),
-                        P_("Extra space at the right"),
-                        0.0, G_MAXFLOAT,
-                        0.0,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+    case CLUTTER_Z_AXIS:
+      pspec = obj_props[PROP_SCALE_Z];
+      scale_p = &info->scale_z;
+      break;
+    }
 
-  /**
-   * ClutterActor:background-color-set:
-   *
-   * Whether the #ClutterActor:background-color property has been set.
-   *
-   *
-   */
-  obj_props[PROP_BACKGROUND_COLOR_SET] =
-    g_param_spec_boolean ("background-color-set",
-                          P_("Background Color Set"),
-                          P_("Whether the background color is set"),
-                          FALSE,
-                          CLUTTER_PARAM_READABLE);
+  g_assert (pspec != NULL);
+  g_assert (scale_p != NULL);
 
-  /**
-   * ClutterActor:background-color:
-   *
-   * Paints a solid fill of the actor's allocation using the specified
-   * color.
-   *
-   * The #ClutterActor:background-color property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_BACKGROUND_COLOR] =
-    clutter_param_spec_color ("background-color",
-                              P_("Background color"),
-                              P_("The actor's background color"),
-                              CLUTTER_COLOR_Transparent,
-                              G_PARAM_READWRITE |
-                              G_PARAM_STATIC_STRINGS |
-                              CLUTTER_PARAM_ANIMATABLE);
+  _clutter_actor_create_transition (self, pspec, *scale_p, factor);
+}
 
-  /**
-   * ClutterActor:first-child:
-   *
-   * The actor's first child.
-   *
-   *
-   */
-  obj_props[PROP_FIRST_CHILD] =
-    g_param_spec_object ("first-child",
-                         P_("First Child"),
-                         P_("The actor's first child"),
-                         CLUTTER_TYPE_ACTOR,
-                         CLUTTER_PARAM_READABLE);
+static void
+clutter_actor_set_clip_rect (ClutterActor      *self,
+                             const ClutterRect *clip)
+{
+  ClutterActorPrivate *priv = self->priv;
+  GObject *obj = G_OBJECT (self);
 
-  /**
-   * ClutterActor:last-child:
-   *
-   * The actor's last child.
-   *
-   *
-   */
-  obj_props[PROP_LAST_CHILD] =
-    g_param_spec_object ("last-child",
-                         P_("Last Child"),
-                         P_("The actor's last child"),
-                         CLUTTER_TYPE_ACTOR,
-                         CLUTTER_PARAM_READABLE);
+  if (clip != NULL)
+    {
+      priv->clip = *clip;
+      priv->has_clip = TRUE;
+    }
+  else
+    priv->has_clip = FALSE;
 
-  /**
-   * ClutterActor:content:
-   *
-   * The #ClutterContent implementation that controls the content
-   * of the actor.
-   *
-   *
-   */
-  obj_props[PROP_CONTENT] =
-    g_param_spec_object ("content",
-                         P_("Content"),
-                         P_("Delegate object for painting the actor's content"),
-                         CLUTTER_TYPE_CONTENT,
-                         CLUTTER_PARAM_READWRITE);
+  clutter_actor_queue_redraw (self);
 
-  /**
-   * ClutterActor:content-gravity:
-   *
-   * The alignment that should be honoured by the #ClutterContent
-   * set with the #ClutterActor:content property.
-   *
-   * Changing the value of this property will change the bounding box of
-   * the content; you can use the #ClutterActor:content-box property to
-   * get the position and size of the content within the actor's
-   * allocation.
-   *
-   * This property is meaningful only for #ClutterContent implementations
-   * that have a preferred size, and if the preferred size is smaller than
-   * the actor's allocation.
-   *
-   * The #ClutterActor:content-gravity property is animatable.
-   *
-   *
-   */
-  obj_props[PROP_CONTENT_GRAVITY] =
-    g_param_spec_enum ("content-gravity",
-                       P_("Content Gravity"),
-                       P_("Alignment of the actor's content"),
-                       CLUTTER_TYPE_CONTENT_GRAVITY,
-                       CLUTTER_CONTENT_GRAVITY_RESIZE_FILL,
-                       CLUTTER_PARAM_READWRITE);
+  g_object_notify_by_pspec (obj, obj_props[PROP_CLIP_RECT]);
+  g_object_notify_by_pspec (obj, obj_props[PROP_HAS_CLIP]);
+}
 
-  /**
-   * ClutterActor:content-box:
-   *
-   * The bounding box for the #ClutterContent used by the actor.
-   *
-   * The value of this property is controlled by the #ClutterActor:allocation
-   * and #ClutterActor:content-gravity properties of #ClutterActor.
-   *
-   * The bounding box for the content is guaranteed to never exceed the
-   * allocation's of the actor.
-   *
-   *
+static void
+clutter_actor_set_property (GObject      *object,
+			    guint         prop_id,
+			    const GValue *value,
+			    GParamSpec   *pspec)
+{
+  ClutterActor *actor = CLUTTER_ACTOR (object);
+  const gchar *old_cause = _clutter_redraw_cause;
+
+  /* the redraws queued by the setters are caused by the property,
+   * which is also how the transitions change the actor
    */
-  obj_props[PROP_CONTENT_BOX] =
-    g_param_spec_boxed ("content-box",
-                        P_("Content Box"),
-                        P_("The bounding box of the actor's content"),
-                        CLUTTER_TYPE_ACTOR_BOX,
-                        G_PARAM_READABLE |
-                        G_PARAM_STATIC_STRINGS |
-                        CLUTTER_PARAM_ANIMATABLE);
+  _clutter_redraw_cause = pspec->name;
 
-  obj_props[PROP_MINIFICATION_FILTER] =
-    g_param_spec_enum ("minification-filter",
-                       P_("Minification Filter"),
-                       P_("The filter used when reducing the size of the content"),
-                       CLUTTER_TYPE_SCALING_FILTER,
-                       CLUTTER_SCALING_FILTER_LINEAR,
-                       CLUTTER_PARAM_READWRITE);
+  switch (prop_id)
+    {
+    case PROP_X:
+      clutter_actor_set_x (actor, g_value_get_float (value));
+      break;
 
-  obj_props[PROP_MAGNIFICATION_FILTER] =
-    g_param_spec_enum ("magnification-filter",
-                       P_("Magnification Filter"),
-                       P_("The filter used when increasing the size of the content"),
-                       CLUTTER_TYPE_SCALING_FILTER,
-                       CLUTTER_SCALING_FILTER_LINEAR,
-                       CLUTTER_PARAM_READWRITE);
+    case PROP_Y:
+      clutter_actor_set_y (actor, g_value_get_float (value));
+      break;
 
-  /**
-   * ClutterActor:content-repeat:
-   *
-   * The repeat policy for the actor's #ClutterActor:content.
-   *
-   *
-   */
-  obj_props[PROP_CONTENT_REPEAT] =
-    g_param_spec_flags ("content-repeat",
-                        P_("Content Repeat"),
-                        P_("The repeat policy for the actor's content"),
-                        CLUTTER_TYPE_CONTENT_REPEAT,
-                        CLUTTER_REPEAT_NONE,
-                        G_PARAM_READWRITE |
-                        G_PARAM_STATIC_STRINGS);
+    case PROP_POSITION:
+      {
+        const ClutterPoint *pos = g_value_get_boxed (value);
 
-  g_object_class_install_properties (object_class, PROP_LAST, obj_props);
+        if (pos != NULL)
+          clutter_actor_set_position (actor, pos->x, pos->y);
+        else
+          clutter_actor_set_fixed_position_set (actor, FALSE);
+      }
+      break;
 
-  /**
-   * ClutterActor::destroy:
-   * @actor: the #ClutterActor which emitted the signal
-   *
-   * The ::destroy signal notifies that all references held on the
-   * actor which emitted it should be released.
-   *
-   * The ::destroy signal should be used by all holders of a reference
-   * on @actor.
-   *
-   * This signal might result in the finalization of the #ClutterActor
-   * if all references are released.
-   *
-   * Composite actors and actors implementing the #ClutterContainer
-   * interface should override the default implementation of the
-   * class handler of this signal and call clutter_actor_destroy() on
-   * their children. When overriding the default class handler, it is
-   * required to chain up to the parent's implementation.
-   *
-   *
-   */
-  actor_signals[DESTROY] =
-    g_signal_new (I_("destroy"),
-		  G_TYPE_FROM_CLASS (object_class),
-                  G_SIGNAL_RUN_CLEANUP | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
-		  G_STRUCT_OFFSET (ClutterActorClass, destroy),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__VOID,
-		  G_TYPE_NONE, 0);
-  /**
-   * ClutterActor::show:
-   * @actor: the object which received the signal
-   *
-   * The ::show signal is emitted when an actor is visible and
-   * rendered on the stage.
-   *
-   *
-   */
-  actor_signals[SHOW] =
-    g_signal_new (I_("show"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_FIRST,
-		  G_STRUCT_OFFSET (ClutterActorClass, show),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__VOID,
-		  G_TYPE_NONE, 0);
-  /**
-   * ClutterActor::hide:
-   * @actor: the object which received the signal
-   *
-   * The ::hide signal is emitted when an actor is no longer rendered
-   * on the stage.
-   *
-   *
-   */
-  actor_signals[HIDE] =
-    g_signal_new (I_("hide"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_FIRST,
-		  G_STRUCT_OFFSET (ClutterActorClass, hide),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__VOID,
-		  G_TYPE_NONE, 0);
-  /**
-   * ClutterActor::parent-set:
-   * @actor: the object which received the signal
-   * @old_parent: (allow-none): the previous parent of the actor, or %NULL
-   *
-   * This signal is emitted when the parent of the actor changes.
-   *
-   *
-   */
-  actor_signals[PARENT_SET] =
-    g_signal_new (I_("parent-set"),
-                  G_TYPE_FROM_CLASS (object_class),
-                  G_SIGNAL_RUN_LAST,
-                  G_STRUCT_OFFSET (ClutterActorClass, parent_set),
-                  NULL, NULL,
-                  _clutter_marshal_VOID__OBJECT,
-                  G_TYPE_NONE, 1,
-                  CLUTTER_TYPE_ACTOR);
+    case PROP_WIDTH:
+      clutter_actor_set_width (actor, g_value_get_float (value));
+      break;
 
-  /**
-   * ClutterActor::queue-redraw:
-   * @actor: the actor we're bubbling the redraw request through
-   * @origin: the actor which initiated the redraw request
-   *
-   * The ::queue_redraw signal is emitted when clutter_actor_queue_redraw()
-   * is called on @origin.
-   *
-   * The default implementation for #ClutterActor chains up to the
-   * parent actor and queues a redraw on the parent, thus "bubbling"
-   * the redraw queue up through the actor graph. The default
-   * implementation for #ClutterStage queues a clutter_stage_ensure_redraw()
-   * in a main loop idle handler.
-   *
-   * Note that the @origin actor may be the stage, or a container; it
-   * does not have to be a leaf node in the actor graph.
-   *
-   * Toolkits embedding a #ClutterStage which require a redraw and
-   * relayout cycle can stop the emission of this signal using the
-   * GSignal API, redraw the UI and then call clutter_stage_ensure_redraw()
-   * themselves, like:
-   *
-   * |[
-   *   static void
-   *   on_redraw_complete (gpointer data)
-   *   {
-   *     ClutterStage *stage = data;
-   *
-   *     /&ast; execute the Clutter drawing pipeline &ast;/
-   *     clutter_stage_ensure_redraw (stage);
-   *   }
-   *
-   *   static void
-   *   on_stage_queue_redraw (ClutterStage *stage)
-   *   {
-   *     /&ast; this prevents the default handler to run &ast;/
-   *     g_signal_stop_emission_by_name (stage, "queue-redraw");
-   *
-   *     /&ast; queue a redraw with the host toolkit and call
-   *      &ast; a function when the redraw has been completed
-   *      &ast;/
-   *     queue_a_redraw (G_CALLBACK (on_redraw_complete), stage);
-   *   }
-   * ]|
-   *
-   * <note><para>This signal is emitted before the Clutter paint
-   * pipeline is executed. If you want to know when the pipeline has
-   * been completed you should connect to the ::paint signal on the
-   * Stage with g_signal_connect_after().</para></note>
-   *
-   *
-   */
-  actor_signals[QUEUE_REDRAW] =
-    g_signal_new (I_("queue-redraw"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST |
-                  G_SIGNAL_NO_HOOKS,
-		  G_STRUCT_OFFSET (ClutterActorClass, queue_redraw),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__OBJECT,
-		  G_TYPE_NONE, 1,
-                  CLUTTER_TYPE_ACTOR);
+    case PROP_HEIGHT:
+      clutter_actor_set_height (actor, g_value_get_float (value));
+      break;
 
-  /**
-   * ClutterActor::queue-relayout:
-   * @actor: the actor being queued for relayout
-   *
-   * The ::queue_layout signal is emitted when clutter_actor_queue_relayout()
-   * is called on an actor.
-   *
-   * The default implementation for #ClutterActor chains up to the
-   * parent actor and queues a relayout on the parent, thus "bubbling"
-   * the relayout queue up through the actor graph.
-   *
-   * The main purpose of this signal is to allow relayout to be propagated
-   * properly in the procense of #ClutterClone actors. Applications will
-   * not normally need to connect to this signal.
-   *
-   *
-   */
-  actor_signals[QUEUE_RELAYOUT] =
-    g_signal_new (I_("queue-relayout"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST |
-                  G_SIGNAL_NO_HOOKS,
-		  G_STRUCT_OFFSET (ClutterActorClass, queue_relayout),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__VOID,
-		  G_TYPE_NONE, 0);
+    case PROP_SIZE:
+      {
+        const ClutterSize *size = g_value_get_boxed (value);
 
-  /**
-   * ClutterActor::event:
-   * @actor: the actor which received the event
-   * @event: a #ClutterEvent
-   *
-   * The ::event signal is emitted each time an event is received
-   * by the @actor. This signal will be emitted on every actor,
-   * following the hierarchy chain, until it reaches the top-level
-   * container (the #ClutterStage).
-   *
-   * Return value: %TRUE if the event has been handled by the actor,
-   *   or %FALSE to continue the emission.
-   *
-   *
-   */
-  actor_signals[EVENT] =
-    g_signal_new (I_("event"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterActorClass, event),
-		  _clutter_boolean_handled_accumulator, NULL,
-		  _clutter_marshal_BOOLEAN__BOXED,
-		  G_TYPE_BOOLEAN, 1,
-		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
-  /**
-   * ClutterActor::button-press-event:
-   * @actor: the actor which received the event
-   * @event: (type ClutterButtonEvent): a #ClutterButtonEvent
-   *
-   * The ::button-press-event signal is emitted each time a mouse button
-   * is pressed on @actor.
-   *
-   * Return value: %TRUE if the event has been handled by the actor,
-   *   or %FALSE to continue the emission.
-   *
-   *
-   */
-  actor_signals[BUTTON_PRESS_EVENT] =
-    g_signal_new (I_("button-press-event"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterActorClass, button_press_event),
-		  _clutter_boolean_handled_accumulator, NULL,
-		  _clutter_marshal_BOOLEAN__BOXED,
-		  G_TYPE_BOOLEAN, 1,
-		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
-  /**
-   * ClutterActor::button-release-event:
-   * @actor: the actor which received the event
-   * @event: (type ClutterButtonEvent): a #ClutterButtonEvent
-   *
-   * The ::button-release-event signal is emitted each time a mouse button
-   * is released on @actor.
-   *
-   * Return value: %TRUE if the event has been handled by the actor,
-   *   or %FALSE to continue the emission.
-   *
-   *
-   */
-  actor_signals[BUTTON_RELEASE_EVENT] =
-    g_signal_new (I_("button-release-event"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterActorClass, button_release_event),
-		  _clutter_boolean_handled_accumulator, NULL,
-		  _clutter_marshal_BOOLEAN__BOXED,
-		  G_TYPE_BOOLEAN, 1,
-		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
-  /**
-   * ClutterActor::scroll-event:
-   * @actor: the actor which received the event
-   * @event: (type ClutterScrollEvent): a #ClutterScrollEvent
-   *
-   * The ::scroll-event signal is emitted each time the mouse is
-   * scrolled on @actor
-   *
-   * Return value: %TRUE if the event has been handled by the actor,
-   *   or %FALSE to continue the emission.
-   *
-   *
-   */
-  actor_signals[SCROLL_EVENT] =
-    g_signal_new (I_("scroll-event"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterActorClass, scroll_event),
-		  _clutter_boolean_handled_accumulator, NULL,
-		  _clutter_marshal_BOOLEAN__BOXED,
-		  G_TYPE_BOOLEAN, 1,
-		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
-  /**
-   * ClutterActor::key-press-event:
-   * @actor: the actor which received the event
-   * @event: (type ClutterKeyEvent): a #ClutterKeyEvent
-   *
-   * The ::key-press-event signal is emitted each time a keyboard button
-   * is pressed while @actor has key focus (see clutter_stage_set_key_focus()).
-   *
-   * Return value: %TRUE if the event has been handled by the actor,
-   *   or %FALSE to continue the emission.
-   *
-   *
+        if (size != NULL)
+          clutter_actor_set_size (actor, size->width, size->height);
+        else
+          clutter_actor_set_size (actor, -1, -1);
+      }
+      break;
+
+    case PROP_FIXED_X:
+      clutter_actor_set_x (actor, g_value_get_float (value));
+      break;
+
+    case PROP_FIXED_Y:
+      clutter_actor_set_y (actor, g_value_get_float (value));
+      break;
+
+    case PROP_FIXED_POSITION_SET:
+      clutter_actor_set_fixed_position_set (actor, g_value_get_boolean (value));
+      break;
+
+    case PROP_MIN_WIDTH:
+      clutter_actor_set_min_width (actor, g_value_get_float (value));
+      break;
+
+    case PROP_MIN_HEIGHT:
+      clutter_actor_set_min_height (actor, g_value_get_float (value));
+      break;
+
+    case PROP_NATURAL_WIDTH:
+      clutter_actor_set_natural_width (actor, g_value_get_float (value));
+      break;
+
+    case PROP_NATURAL_HEIGHT:
+      clutter_actor_set_natural_height (actor, g_value_get_float (value));
+      break;
+
+    case PROP_MIN_WIDTH_SET:
+      clutter_actor_set_min_width_set (actor, g_value_get_boolean (value));
+      break;
+
+    case PROP_MIN_HEIGHT_SET:
+      clutter_actor_set_min_height_set (actor, g_value_get_boolean (value));
+      break;
+
+    case PROP_NATURAL_WIDTH_SET:
+      clutter_actor_set_natural_width_set (actor, g_value_get_boolean (value));
+      break;
+
+    case PROP_NATURAL_HEIGHT_SET:
+      clutter_actor_set_natural_height_set (actor, g_value_get_boolean (value));
+      break;
+
+    case PROP_REQUEST_MODE:
+      clutter_actor_set_request_mode (actor, g_value_get_enum (value));
+      break;
+
+    case PROP_Z_POSITION:
+      clutter_actor_set_z_position (actor, g_value_get_float (value));
+      break;
+
+    case PROP_OPACITY:
+      clutter_actor_set_opacity (actor, g_value_get_uint (value));
+      break;
+
+    case PROP_OFFSCREEN_REDIRECT:
+      clutter_actor_set_offscreen_redirect (actor, g_value_get_enum (value));
+      break;
+
+    case PROP_NAME:
+      clutter_actor_set_name (actor, g_value_get_string (value));
+      break;
+
+    case PROP_VISIBLE:
+      if (g_value_get_boolean (value) == TRUE)
+	clutter_actor_show (actor);
+      else
+	clutter_actor_hide (actor);
+      break;
+
+    case PROP_PIVOT_POINT:
+      {
+        const ClutterPoint *pivot = g_value_get_boxed (value);
+
+        if (pivot == NULL)
+          pivot = clutter_point_zero ();
+
+        clutter_actor_set_pivot_point (actor, pivot->x, pivot->y);
+      }
+      break;
+
+    case PROP_PIVOT_POINT_Z:
+      clutter_actor_set_pivot_point_z (actor, g_value_get_float (value));
+      break;
+
+    case PROP_TRANSLATION_X:
+      clutter_actor_set_translation_factor (actor, CLUTTER_X_AXIS,
+                                            g_value_get_float (value));
+      break;
+
+    case PROP_TRANSLATION_Y:
+      clutter_actor_set_translation_factor (actor, CLUTTER_Y_AXIS,
+                                            g_value_get_float (value));
+      break;
+
+    case PROP_TRANSLATION_Z:
+      clutter_actor_set_translation_factor (actor, CLUTTER_Z_AXIS,
+                                            g_value_get_float (value));
+      break;
+
+    case PROP_SCALE_X:
+      clutter_actor_set_scale_factor (actor, CLUTTER_X_AXIS,
+                                      g_value_get_double (value));
+      break;
+
+    case PROP_SCALE_Y:
+      clutter_actor_set_scale_factor (actor, CLUTTER_Y_AXIS,
+                                      g_value_get_double (value));
+      break;
+
+    case PROP_SCALE_Z:
+      clutter_actor_set_scale_factor (actor, CLUTTER_Z_AXIS,
+                                      g_value_get_double (value));
+      break;
+
+    case PROP_CLIP_RECT:
+      clutter_actor_set_clip_rect (actor, g_value_get_boxed (value));
+      break;
+
+    case PROP_CLIP_TO_ALLOCATION:
+      clutter_actor_set_clip_to_allocation (actor, g_value_get_boolean (value));
+      break;
+
+    case PROP_REACTIVE:
+      clutter_actor_set_reactive (actor, g_value_get_boolean (value));
+      break;
+
+    case PROP_ROTATION_ANGLE_X:
+      clutter_actor_set_rotation_angle (actor,
+                                        CLUTTER_X_AXIS,
+                                        g_value_get_double (value));
+      break;
+
+    case PROP_ROTATION_ANGLE_Y:
+      clutter_actor_set_rotation_angle (actor,
+                                        CLUTTER_Y_AXIS,
+                                        g_value_get_double (value));
+      break;
+
+    case PROP_ROTATION_ANGLE_Z:
+      clutter_actor_set_rotation_angle (actor,
+                                        CLUTTER_Z_AXIS,
+                                        g_value_get_double (value));
+      break;
+
+    case PROP_TRANSFORM:
+      clutter_actor_set_transform (actor, g_value_get_boxed (value));
+      break;
+
+    case PROP_CHILD_TRANSFORM:
+      clutter_actor_set_child_transform (actor, g_value_get_boxed (value));
+      break;
+
+    case PROP_TEXT_DIRECTION:
+      clutter_actor_set_text_direction (actor, g_value_get_enum (value));
+      break;
+
+    case PROP_ACTIONS:
+      clutter_actor_add_action (actor, g_value_get_object (value));
+      break;
+
+    case PROP_CONSTRAINTS:
+      clutter_actor_add_constraint (actor, g_value_get_object (value));
+      break;
+
+    case PROP_EFFECT:
+      clutter_actor_add_effect (actor, g_value_get_object (value));
+      break;
+
+    case PROP_LAYOUT_MANAGER:
+      clutter_actor_set_layout_manager (actor, g_value_get_object (value));
+      break;
+
+    case PROP_X_EXPAND:
+      clutter_actor_set_x_expand (actor, g_value_get_boolean (value));
+      break;
+
+    case PROP_Y_EXPAND:
+      clutter_actor_set_y_expand (actor, g_value_get_boolean (value));
+      break;
+
+    case PROP_X_ALIGN:
+      clutter_actor_set_x_align (actor, g_value_get_enum (value));
+      break;
+
+    case PROP_Y_ALIGN:
+      clutter_actor_set_y_align (actor, g_value_get_enum (value));
+      break;
+
+    case PROP_MARGIN_TOP:
+      clutter_actor_set_margin_top (actor, g_value_get_float (value));
+      break;
+
+    case PROP_MARGIN_BOTTOM:
+      clutter_actor_set_margin_bottom (actor, g_value_get_float (value));
+      break;
+
+    case PROP_MARGIN_LEFT:
+      clutter_actor_set_margin_left (actor, g_value_get_float (value));
+      break;
+
+    case PROP_MARGIN_RIGHT:
+      clutter_actor_set_margin_right (actor, g_value_get_float (value));
+      break;
+
+    case PROP_BACKGROUND_COLOR:
+      clutter_actor_set_background_color (actor, g_value_get_boxed (value));
+      break;
+
+    case PROP_CONTENT:
+      clutter_actor_set_content (actor, g_value_get_object (value));
+      break;
+
+    case PROP_CONTENT_GRAVITY:
+      clutter_actor_set_content_gravity (actor, g_value_get_enum (value));
+      break;
+
+    case PROP_MINIFICATION_FILTER:
+      clutter_actor_set_content_scaling_filters (actor,
+                                                 g_value_get_enum (value),
+                                                 actor->priv->mag_filter);
+      break;
+
+    case PROP_MAGNIFICATION_FILTER:
+      clutter_actor_set_content_scaling_filters (actor,
+                                                 actor->priv->min_filter,
+                                                 g_value_get_enum (value));
+      break;
+
+    case PROP_CONTENT_REPEAT:
+      clutter_actor_set_content_repeat (actor, g_value_get_flags (value));
+      break;
+
+    case PROP_LOD_THRESHOLD:
+      clutter_actor_set_lod_threshold (actor, g_value_get_float (value));
+      break;
+
+    case PROP_LOD_PLACEHOLDER:
+      clutter_actor_set_lod_placeholder (actor, g_value_get_object (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+
+  _clutter_redraw_cause = old_cause;
+}
+
+static void
+clutter_actor_get_property (GObject    *object,
+			    guint       prop_id,
+			    GValue     *value,
+			    GParamSpec *pspec)
+{
+  ClutterActor *actor = CLUTTER_ACTOR (object);
+  ClutterActorPrivate *priv = actor->priv;
+
+  switch (prop_id)
+    {
+    case PROP_X:
+      g_value_set_float (value, clutter_actor_get_x (actor));
+      break;
+
+    case PROP_Y:
+      g_value_set_float (value, clutter_actor_get_y (actor));
+      break;
+
+    case PROP_POSITION:
+      {
+        ClutterPoint position;
+
+        clutter_point_init (&position,
+                            clutter_actor_get_x (actor),
+                            clutter_actor_get_y (actor));
+        g_value_set_boxed (value, &position);
+      }
+      break;
+
+    case PROP_WIDTH:
+      g_value_set_float (value, clutter_actor_get_width (actor));
+      break;
+
+    case PROP_HEIGHT:
+      g_value_set_float (value, clutter_actor_get_height (actor));
+      break;
+
+    case PROP_SIZE:
+      {
+        ClutterSize size;
+
+        clutter_size_init (&size,
+                           clutter_actor_get_width (actor),
+                           clutter_actor_get_height (actor));
+        g_value_set_boxed (value, &size);
+      }
+      break;
+
+    case PROP_FIXED_X:
+      {
+        const ClutterLayoutInfo *info;
+
+        info = _clutter_actor_get_layout_info_or_defaults (actor);
+        g_value_set_float (value, info->fixed_pos.x);
+      }
+      break;
+
+    case PROP_FIXED_Y:
+      {
+        const ClutterLayoutInfo *info;
+
+        info = _clutter_actor_get_layout_info_or_defaults (actor);
+        g_value_set_float (value, info->fixed_pos.y);
+      }
+      break;
+
+    case PROP_FIXED_POSITION_SET:
+      g_value_set_boolean (value, priv->position_set);
+      break;
+
+    case PROP_MIN_WIDTH:
+      {
+        const ClutterLayoutInfo *info;
+
+        info = _clutter_actor_get_layout_info_or_defaults (actor);
+        g_value_set_float (value, info->minimum.width);
+      }
+      break;
+
+    case PROP_MIN_HEIGHT:
+      {
+        const ClutterLayoutInfo *info;
+
+        info = _clutter_actor_get_layout_info_or_defaults (actor);
+        g_value_set_float (value, info->minimum.height);
+      }
+      break;
+
+    case PROP_NATURAL_WIDTH:
+      {
+        const ClutterLayoutInfo *info;
+
+        info = _clutter_actor_get_layout_info_or_defaults (actor);
+        g_value_set_float (value, info->natural.width);
+      }
+      break;
+
+    case PROP_NATURAL_HEIGHT:
+      {
+        const ClutterLayoutInfo *info;
+
+        info = _clutter_actor_get_layout_info_or_defaults (actor);
+        g_value_set_float (value, info->natural.height);
+      }
+      break;
+
+    case PROP_MIN_WIDTH_SET:
+      g_value_set_boolean (value, priv->min_width_set);
+      break;
+
+    case PROP_MIN_HEIGHT_SET:
+      g_value_set_boolean (value, priv->min_height_set);
+      break;
+
+    case PROP_NATURAL_WIDTH_SET:
+      g_value_set_boolean (value, priv->natural_width_set);
+      break;
+
+    case PROP_NATURAL_HEIGHT_SET:
+      g_value_set_boolean (value, priv->natural_height_set);
+      break;
+
+    case PROP_REQUEST_MODE:
+      g_value_set_enum (value, priv->request_mode);
+      break;
+
+    case PROP_ALLOCATION:
+      g_value_set_boxed (value, &priv->allocation);
+      break;
+
+    case PROP_Z_POSITION:
+      g_value_set_float (value, clutter_actor_get_z_position (actor));
+      break;
+
+    case PROP_OPACITY:
+      g_value_set_uint (value, priv->opacity);
+      break;
+
+    case PROP_OFFSCREEN_REDIRECT:
+      g_value_set_flags (value, priv->offscreen_redirect);
+      break;
+
+    case PROP_NAME:
+      g_value_set_string (value, priv->name);
+      break;
+
+    case PROP_VISIBLE:
+      g_value_set_boolean (value, CLUTTER_ACTOR_IS_VISIBLE (actor));
+      break;
+
+    case PROP_MAPPED:
+      g_value_set_boolean (value, CLUTTER_ACTOR_IS_MAPPED (actor));
+      break;
+
+    case PROP_REALIZED:
+      g_value_set_boolean (value, CLUTTER_ACTOR_IS_REALIZED (actor));
+      break;
+
+    case PROP_HAS_CLIP:
+      g_value_set_boolean (value, priv->has_clip);
+      break;
+
+    case PROP_CLIP_RECT:
+      g_value_set_boxed (value, &priv->clip);
+      break;
+
+    case PROP_CLIP_TO_ALLOCATION:
+      g_value_set_boolean (value, priv->clip_to_allocation);
+      break;
+
+    case PROP_PIVOT_POINT:
+      {
+        const ClutterTransformInfo *info;
+
+        info = _clutter_actor_get_transform_info_or_defaults (actor);
+        g_value_set_boxed (value, &info->pivot);
+      }
+      break;
+
+    case PROP_PIVOT_POINT_Z:
+      {
+        const ClutterTransformInfo *info;
+
+        info = _clutter_actor_get_transform_info_or_defaults (actor);
+        g_value_set_float (value, info->pivot_z);
+      }
+      break;
+
+    case PROP_TRANSLATION_X:
+      {
+        const ClutterTransformInfo *info;
+
+        info = _clutter_actor_get_transform_info_or_defaults (actor);
+        g_value_set_float (value, info->translation.x);
+      }
+      break;
+
+    case PROP_TRANSLATION_Y:
+      {
+        const ClutterTransformInfo *info;
+
+        info = _clutter_actor_get_transform_info_or_defaults (actor);
+        g_value_set_float (value, info->translation.y);
+      }
+      break;
+
+    case PROP_TRANSLATION_Z:
+      {
+        const ClutterTransformInfo *info;
+
+        info = _clutter_actor_get_transform_info_or_defaults (actor);
+        g_value_set_float (value, info->translation.z);
+      }
+      break;
+
+    case PROP_SCALE_X:
+      {
+        const ClutterTransformInfo *info;
+
+        info = _clutter_actor_get_transform_info_or_defaults (actor);
+        g_value_set_double (value, info->scale_x);
+      }
+      break;
+
+    case PROP_SCALE_Y:
+      {
+        const ClutterTransformInfo *info;
+
+        info = _clutter_actor_get_transform_info_or_defaults (actor);
+        g_value_set_double (value, info->scale_y);
+      }
+      break;
+
+    case PROP_SCALE_Z:
+      {
+        const ClutterTransformInfo *info;
+
+        info = _clutter_actor_get_transform_info_or_defaults (actor);
+        g_value_set_double (value, info->scale_z);
+      }
+      break;
+
+    case PROP_ROTATION_ANGLE_X:
+      {
+        const ClutterTransformInfo *info;
+
+        info = _clutter_actor_get_transform_info_or_defaults (actor);
+        g_value_set_double (value, info->rx_angle);
+      }
+      break;
+
+    case PROP_ROTATION_ANGLE_Y:
+      {
+        const ClutterTransformInfo *info;
+
+        info = _clutter_actor_get_transform_info_or_defaults (actor);
+        g_value_set_double (value, info->ry_angle);
+      }
+      break;
+
+    case PROP_ROTATION_ANGLE_Z:
+      {
+        const ClutterTransformInfo *info;
+
+        info = _clutter_actor_get_transform_info_or_defaults (actor);
+        g_value_set_double (value, info->rz_angle);
+      }
+      break;
+
+    case PROP_TRANSFORM:
+      {
+        ClutterMatrix m;
+
+        clutter_actor_get_transform (actor, &m);
+        g_value_set_boxed (value, &m);
+      }
+      break;
+
+    case PROP_TRANSFORM_SET:
+      {
+        const ClutterTransformInfo *info;
+
+        info = _clutter_actor_get_transform_info_or_defaults (actor);
+        g_value_set_boolean (value, info->transform_set);
+      }
+      break;
+
+    case PROP_CHILD_TRANSFORM:
+      {
+        ClutterMatrix m;
+
+        clutter_actor_get_child_transform (actor, &m);
+        g_value_set_boxed (value, &m);
+      }
+      break;
+
+    case PROP_CHILD_TRANSFORM_SET:
+      {
+        const ClutterTransformInfo *info;
+
+        info = _clutter_actor_get_transform_info_or_defaults (actor);
+        g_value_set_boolean (value, info->child_transform_set);
+      }
+      break;
+
+    case PROP_TEXT_DIRECTION:
+      g_value_set_enum (value, priv->text_direction);
+      break;
+
+    case PROP_HAS_POINTER:
+      g_value_set_boolean (value, priv->has_pointer);
+      break;
+
+    case PROP_LAYOUT_MANAGER:
+      g_value_set_object (value, priv->layout_manager);
+      break;
+
+    case PROP_X_EXPAND:
+      {
+        const ClutterLayoutInfo *info;
+
+        info = _clutter_actor_get_layout_info_or_defaults (actor);
+        g_value_set_boolean (value, info->x_expand);
+      }
+      break;
+
+    case PROP_Y_EXPAND:
+      {
+        const ClutterLayoutInfo *info;
+
+        info = _clutter_actor_get_layout_info_or_defaults (actor);
+        g_value_set_boolean (value, info->y_expand);
+      }
+      break;
+
+    case PROP_X_ALIGN:
+      {
+        const ClutterLayoutInfo *info;
+
+        info = _clutter_actor_get_layout_info_or_defaults (actor);
+        g_value_set_enum (value, info->x_align);
+      }
+      break;
+
+    case PROP_Y_ALIGN:
+      {
+        const ClutterLayoutInfo *info;
+
+        info = _clutter_actor_get_layout_info_or_defaults (actor);
+        g_value_set_enum (value, info->y_align);
+      }
+      break;
+
+    case PROP_MARGIN_TOP:
+      {
+        const ClutterLayoutInfo *info;
+
+        info = _clutter_actor_get_layout_info_or_defaults (actor);
+        g_value_set_float (value, info->margin.top);
+      }
+      break;
+
+    case PROP_MARGIN_BOTTOM:
+      {
+        const ClutterLayoutInfo *info;
+
+        info = _clutter_actor_get_layout_info_or_defaults (actor);
+        g_value_set_float (value, info->margin.bottom);
+      }
+      break;
+
+    case PROP_MARGIN_LEFT:
+      {
+        const ClutterLayoutInfo *info;
+
+        info = _clutter_actor_get_layout_info_or_defaults (actor);
+        g_value_set_float (value, info->margin.left);
+      }
+      break;
+
+    case PROP_MARGIN_RIGHT:
+      {
+        const ClutterLayoutInfo *info;
+
+        info = _clutter_actor_get_layout_info_or_defaults (actor);
+        g_value_set_float (value, info->margin.right);
+      }
+      break;
+
+    case PROP_BACKGROUND_COLOR_SET:
+      g_value_set_boolean (value, priv->bg_color_set);
+      break;
+
+    case PROP_BACKGROUND_COLOR:
+      g_value_set_boxed (value, &priv->bg_color);
+      break;
+
+    case PROP_FIRST_CHILD:
+      g_value_set_object (value, priv->first_child);
+      break;
+
+    case PROP_LAST_CHILD:
+      g_value_set_object (value, priv->last_child);
+      break;
+
+    case PROP_CONTENT:
+      g_value_set_object (value, priv->content);
+      break;
+
+    case PROP_CONTENT_GRAVITY:
+      g_value_set_enum (value, priv->content_gravity);
+      break;
+
+    case PROP_CONTENT_BOX:
+      {
+        ClutterActorBox box = { 0, };
+
+        clutter_actor_get_content_box (actor, &box);
+        g_value_set_boxed (value, &box);
+      }
+      break;
+
+    case PROP_MINIFICATION_FILTER:
+      g_value_set_enum (value, priv->min_filter);
+      break;
+
+    case PROP_MAGNIFICATION_FILTER:
+      g_value_set_enum (value, priv->mag_filter);
+      break;
+
+    case PROP_CONTENT_REPEAT:
+      g_value_set_flags (value, priv->content_repeat);
+      break;
+
+    case PROP_LOD_THRESHOLD:
+      g_value_set_float (value, clutter_actor_get_lod_threshold (actor));
+      break;
+
+    case PROP_LOD_PLACEHOLDER:
+      g_value_set_object (value, clutter_actor_get_lod_placeholder (actor));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_actor_dispose (GObject *object)
+{
+  ClutterActor *self = CLUTTER_ACTOR (object);
+  ClutterActorPrivate *priv = self->priv;
+
+  CLUTTER_NOTE (MISC, "Disposing of object (id=%d) of type '%s' (ref_count:%d)",
+		priv->id,
+		g_type_name (G_OBJECT_TYPE (self)),
+                object->ref_count);
+
+  if (priv->model_binding != NULL)
+    clutter_actor_bind_model (self, NULL, NULL, NULL, NULL);
+
+  g_signal_emit (self, actor_signals[DESTROY], 0);
+
+  /* avoid recursing when called from clutter_actor_destroy() */
+  if (priv->parent != NULL)
+    {
+      ClutterActor *parent = priv->parent;
+
+      clutter_actor_remove_child_internal (parent, self,
+                                           REMOVE_CHILD_DEFAULT_FLAGS);
+    }
+
+  /* parent must be gone at this point */
+  g_assert (priv->parent == NULL);
+
+  if (!CLUTTER_ACTOR_IS_TOPLEVEL (self))
+    {
+      /* can't be mapped or realized with no parent */
+      g_assert (!CLUTTER_ACTOR_IS_MAPPED (self));
+      g_assert (!CLUTTER_ACTOR_IS_REALIZED (self));
+    }
+
+  g_clear_object (&priv->pango_context);
+  g_clear_object (&priv->actions);
+  g_clear_object (&priv->constraints);
+  g_clear_object (&priv->effects);
+  g_clear_object (&priv->flatten_effect);
+  clutter_actor_release_cache_area (self);
+
+  if (priv->layout_manager != NULL)
+    {
+      clutter_layout_manager_set_container (priv->layout_manager, NULL);
+      g_clear_object (&priv->layout_manager);
+    }
+
+  if (priv->content != NULL)
+    {
+      _clutter_content_detached (priv->content, self);
+      g_clear_object (&priv->content);
+    }
+
+  if (priv->lod != NULL && priv->lod->placeholder != NULL)
+    {
+      _clutter_content_detached (priv->lod->placeholder, self);
+      g_clear_object (&priv->lod->placeholder);
+    }
+
+  clutter_actor_invalidate_paint_node (self);
+
+  if (priv->clones != NULL)
+    {
+      g_hash_table_unref (priv->clones);
+      priv->clones = NULL;
+    }
+
+  /* the transitions will not commit their values on a dead actor */
+  if (priv->paint_transitions != NULL)
+    {
+      g_ptr_array_unref (priv->paint_transitions);
+      priv->paint_transitions = NULL;
+    }
+
+  G_OBJECT_CLASS (clutter_actor_parent_class)->dispose (object);
+}
+
+static void
+clutter_actor_finalize (GObject *object)
+{
+  ClutterActorPrivate *priv = CLUTTER_ACTOR (object)->priv;
+
+  CLUTTER_NOTE (MISC, "Finalize actor (name='%s', id=%d) of type '%s'",
+                priv->name != NULL ? priv->name : "<none>",
+		priv->id,
+		g_type_name (G_OBJECT_TYPE (object)));
+
+  clutter_actor_restore_easing_state (CLUTTER_ACTOR (object));
+
+  _clutter_context_release_id (priv->id);
+
+  if (priv->paint_transitions != NULL)
+    g_ptr_array_unref (priv->paint_transitions);
+
+  if (priv->children_index != NULL)
+    g_ptr_array_unref (priv->children_index);
+
+  if (priv->dirty_children != NULL)
+    g_ptr_array_unref (priv->dirty_children);
+
+  g_free (priv->name);
+
+#ifdef CLUTTER_ENABLE_DEBUG
+  g_free (priv->debug_name);
+#endif
+
+  if (priv->size_requests != NULL)
+    {
+      g_slice_free (SizeRequestCache, priv->size_requests);
+      _clutter_memory_account (CLUTTER_MEMORY_ACTORS,
+                               -(gssize) sizeof (SizeRequestCache),
+                               0);
+    }
+
+  if (priv->stage_transform != NULL)
+    {
+      g_slice_free (CoglMatrix, priv->stage_transform);
+      _clutter_memory_account (CLUTTER_MEMORY_ACTORS,
+                               -(gssize) sizeof (CoglMatrix),
+                               0);
+    }
+
+  if (priv->lod != NULL)
+    {
+      g_slice_free (LodInfo, priv->lod);
+      _clutter_memory_account (CLUTTER_MEMORY_ACTORS,
+                               -(gssize) sizeof (LodInfo),
+                               0);
+    }
+
+  _clutter_memory_account (CLUTTER_MEMORY_ACTORS,
+                           -(gssize) sizeof (ClutterActorPrivate),
+                           -1);
+
+  G_OBJECT_CLASS (clutter_actor_parent_class)->finalize (object);
+}
+
+
+/**
+ * clutter_actor_get_accessible:
+ * @self: a #ClutterActor
+ *
+ * Returns the accessible object that describes the actor to an
+ * assistive technology.
+ *
+ * If no class-specific #AtkObject implementation is available for the
+ * actor instance in question, it will inherit an #AtkObject
+ * implementation from the first ancestor class for which such an
+ * implementation is defined.
+ *
+ * The documentation of the <ulink
+ * url="http://developer.gnome.org/doc/API/2.0/atk/index.html">ATK</ulink>
+ * library contains more information about accessible objects and
+ * their uses.
+ *
+ * Returns: (transfer none): the #AtkObject associated with @actor
+ */
+AtkObject *
+clutter_actor_get_accessible (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
+
+  return CLUTTER_ACTOR_GET_CLASS (self)->get_accessible (self);
+}
+
+static AtkObject *
+clutter_actor_real_get_accessible (ClutterActor *actor)
+{
+  _clutter_accessibility_ensure_initialized ();
+
+  return atk_gobject_accessible_for_object (G_OBJECT (actor));
+}
+
+static AtkObject *
+_clutter_actor_ref_accessible (AtkImplementor *implementor)
+{
+  AtkObject *accessible;
+
+  accessible = clutter_actor_get_accessible (CLUTTER_ACTOR (implementor));
+  if (accessible != NULL)
+    g_object_ref (accessible);
+
+  return accessible;
+}
+
+static void
+atk_implementor_iface_init (AtkImplementorIface *iface)
+{
+  iface->ref_accessible = _clutter_actor_ref_accessible;
+}
+
+/* retrieves the bounds of the paint volume of @child, in the coordinate
+ * space of @self; unmapped children have empty bounds
+ */
+static gboolean
+clutter_actor_get_child_bounds (ClutterActor *self,
+                                ClutterActor *child,
+                                PaintBounds  *bounds)
+{
+  const ClutterPaintVolume *child_volume;
+  ClutterPaintVolume aligned_volume;
+
+  paint_bounds_init_empty (bounds);
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (child))
+    return TRUE;
+
+  child_volume = clutter_actor_get_transformed_paint_volume (child, self);
+  if (child_volume == NULL)
+    return FALSE;
+
+  if (child_volume->is_empty)
+    return TRUE;
+
+  if (!child_volume->is_axis_aligned)
+    {
+      _clutter_paint_volume_copy_static (child_volume, &aligned_volume);
+      _clutter_paint_volume_axis_align (&aligned_volume);
+      child_volume = &aligned_volume;
+    }
+
+  bounds->x1 = child_volume->vertices[0].x;
+  bounds->y1 = child_volume->vertices[0].y;
+  bounds->z1 = child_volume->vertices[0].z;
+  bounds->x2 = child_volume->vertices[1].x;
+  bounds->y2 = child_volume->vertices[3].y;
+  bounds->z2 = child_volume->vertices[4].z;
+
+  return TRUE;
+}
+
+/* updates the union of the paint volumes of the children of @self.
+ *
+ * the union is kept between updates, and only the children that changed
+ * since the last update are looked at: a child growing just grows the
+ * union, while the union is computed again from all the children only
+ * if a child that was on one of its sides shrinks or goes away
+ */
+static gboolean
+clutter_actor_update_children_bounds (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *child;
+
+  if (priv->children_bounds_valid && priv->dirty_children != NULL)
+    {
+      GPtrArray *dirty_children = priv->dirty_children;
+      guint i;
+
+      for (i = 0; i < dirty_children->len; i++)
+        {
+          PaintBounds old_bounds;
+
+          child = g_ptr_array_index (dirty_children, i);
+          child->priv->in_dirty_children = FALSE;
+
+          if (!priv->children_bounds_valid)
+            continue;
+
+          old_bounds = child->priv->parent_bounds;
+
+          if (!clutter_actor_get_child_bounds (self, child, &child->priv->parent_bounds) ||
+              !paint_bounds_can_replace (&priv->children_bounds,
+                                         &old_bounds,
+                                         &child->priv->parent_bounds))
+            {
+              priv->children_bounds_valid = FALSE;
+              continue;
+            }
+
+          paint_bounds_union (&priv->children_bounds, &child->priv->parent_bounds);
+        }
+
+      g_ptr_array_set_size (dirty_children, 0);
+
+      if (priv->children_bounds_valid)
+        return TRUE;
+
+      CLUTTER_NOTE (CLIPPING, "Computing the paint volume of the children "
+                    "of '%s' again",
+                    _clutter_actor_get_debug_name (self));
+    }
+  else if (priv->children_bounds_valid)
+    return TRUE;
+
+  /* if any of our children replies that it doesn't have a paint
+   * volume, we bail out
+   */
+  paint_bounds_init_empty (&priv->children_bounds);
+
+  for (child = priv->first_child;
+       child != NULL;
+       child = child->priv->next_sibling)
+    {
+      if (!clutter_actor_get_child_bounds (self, child, &child->priv->parent_bounds))
+        return FALSE;
+
+      paint_bounds_union (&priv->children_bounds, &child->priv->parent_bounds);
+    }
+
+  priv->children_bounds_valid = TRUE;
+
+  return TRUE;
+}
+
+static gboolean
+clutter_actor_update_default_paint_volume (ClutterActor       *self,
+                                           ClutterPaintVolume *volume)
+{
+  ClutterActorPrivate *priv = self->priv;
+  gboolean res = TRUE;
+
+  /* we start from the allocation */
+  clutter_paint_volume_set_width (volume,
+                                  priv->allocation.x2 - priv->allocation.x1);
+  clutter_paint_volume_set_height (volume,
+                                   priv->allocation.y2 - priv->allocation.y1);
+
+  /* if the actor has a clip set then we have a pretty definite
+   * size for the paint volume: the actor cannot possibly paint
+   * outside the clip region.
+   */
+  if (priv->clip_to_allocation)
+    {
+      /* the allocation has already been set, so we just flip the
+       * return value
+       */
+      res = TRUE;
+    }
+  else
+    {
+      if (priv->has_clip &&
+          priv->clip.size.width >= 0 &&
+          priv->clip.size.height >= 0)
+        {
+          ClutterVertex origin;
+
+          origin.x = priv->clip.origin.x;
+          origin.y = priv->clip.origin.y;
+          origin.z = 0;
+
+          clutter_paint_volume_set_origin (volume, &origin);
+          clutter_paint_volume_set_width (volume, priv->clip.size.width);
+          clutter_paint_volume_set_height (volume, priv->clip.size.height);
+
+          res = TRUE;
+        }
+
+      /* if we don't have children we just bail out here... */
+      if (priv->n_children == 0)
+        return res;
+
+      /* ...but if we have children then we need their paint volume in
+       * our coordinates
+       */
+      if (!clutter_actor_update_children_bounds (self))
+        return FALSE;
+
+      if (!paint_bounds_is_empty (&priv->children_bounds))
+        {
+          const PaintBounds *bounds = &priv->children_bounds;
+          ClutterPaintVolume children_volume;
+          ClutterVertex origin;
+
+          _clutter_paint_volume_init_static (&children_volume, self);
+
+          origin.x = bounds->x1;
+          origin.y = bounds->y1;
+          origin.z = bounds->z1;
+
+          clutter_paint_volume_set_origin (&children_volume, &origin);
+          clutter_paint_volume_set_width (&children_volume, bounds->x2 - bounds->x1);
+          clutter_paint_volume_set_height (&children_volume, bounds->y2 - bounds->y1);
+          clutter_paint_volume_set_depth (&children_volume, bounds->z2 - bounds->z1);
+
+          clutter_paint_volume_union (volume, &children_volume);
+        }
+
+      res = TRUE;
+    }
+
+  return res;
+
+}
+
+static gboolean
+clutter_actor_real_get_paint_volume (ClutterActor       *self,
+                                     ClutterPaintVolume *volume)
+{
+  ClutterActorClass *klass;
+  gboolean res;
+
+  klass = CLUTTER_ACTOR_GET_CLASS (self);
+
+  /* XXX - this thoroughly sucks, but we don't want to penalize users
+   * who use ClutterActor as a "new ClutterGroup" by forcing a full-stage
+   * redraw. This should go away in 2.0.
+   */
+  if (klass->paint == clutter_actor_real_paint &&
+      klass->get_paint_volume == clutter_actor_real_get_paint_volume)
+    {
+      res = TRUE;
+    }
+  else
+    {
+      /* this is the default return value: we cannot know if a class
+       * is going to paint outside its allocation, so we take the
+       * conservative approach.
+       */
+      res = FALSE;
+    }
+
+  /* update_default_paint_volume() should only fail if one of the children
+   * reported an invalid, or no, paint volume
+   */
+  if (!clutter_actor_update_default_paint_volume (self, volume))
+    return FALSE;
+
+  return res;
+}
+
+/**
+ * clutter_actor_get_default_paint_volume:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the default paint volume for @self.
+ *
+ * This function provides the same #ClutterPaintVolume that would be
+ * computed by the default implementation inside #ClutterActor of the
+ * #ClutterActorClass.get_paint_volume() virtual function.
+ *
+ * This function should only be used by #ClutterActor subclasses that
+ * cannot chain up to the parent implementation when computing their
+ * paint volume.
+ *
+ * Return value: (transfer none): a pointer to the default
+ *   #ClutterPaintVolume, relative to the #ClutterActor, or %NULL if
+ *   the actor could not compute a valid paint volume. The returned value
+ *   is not guaranteed to be stable across multiple frames, so if you
+ *   want to retain it, you will need to copy it using
+ *   clutter_paint_volume_copy().
+ *
+ *
+ */
+const ClutterPaintVolume *
+clutter_actor_get_default_paint_volume (ClutterActor *self)
+{
+  ClutterPaintVolume volume;
+  ClutterPaintVolume *res;
+
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
+
+  res = NULL;
+  _clutter_paint_volume_init_static (&volume, self);
+  if (clutter_actor_update_default_paint_volume (self, &volume))
+    {
+      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+
+      if (stage != NULL)
+        {
+          res = _clutter_stage_paint_volume_stack_allocate (CLUTTER_STAGE (stage));
+          _clutter_paint_volume_copy_static (&volume, res);
+        }
+    }
+
+  clutter_paint_volume_free (&volume);
+
+  return res;
+}
+
+static gboolean
+clutter_actor_real_has_overlaps (ClutterActor *self)
+{
+  /* By default we'll assume that all actors need an offscreen redirect to get
+   * the correct opacity. Actors such as ClutterTexture that would never need
+   * an offscreen redirect can override this to return FALSE. */
+  return TRUE;
+}
+
+static void
+clutter_actor_real_destroy (ClutterActor *actor)
+{
+  ClutterActorIter iter;
+
+  g_object_freeze_notify (G_OBJECT (actor));
+
+  clutter_actor_iter_init (&iter, actor);
+  while (clutter_actor_iter_next (&iter, NULL))
+    clutter_actor_iter_destroy (&iter);
+
+  g_object_thaw_notify (G_OBJECT (actor));
+}
+
+static GObject *
+clutter_actor_constructor (GType gtype,
+                           guint n_props,
+                           GObjectConstructParam *props)
+{
+  GObjectClass *gobject_class;
+  ClutterActor *self;
+  GObject *retval;
+
+  gobject_class = G_OBJECT_CLASS (clutter_actor_parent_class);
+  retval = gobject_class->constructor (gtype, n_props, props);
+  self = CLUTTER_ACTOR (retval);
+
+  if (self->priv->layout_manager == NULL)
+    {
+      ClutterLayoutManager *default_layout;
+
+      CLUTTER_NOTE (LAYOUT, "Creating default layout manager");
+
+      default_layout = clutter_fixed_layout_new ();
+      clutter_actor_set_layout_manager (self, default_layout);
+    }
+
+  return retval;
+}
+
+static void
+clutter_actor_class_init (ClutterActorClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  quark_actor_layout_info = g_quark_from_static_string ("-clutter-actor-layout-info");
+  quark_actor_transform_info = g_quark_from_static_string ("-clutter-actor-transform-info");
+  quark_actor_animation_info = g_quark_from_static_string ("-clutter-actor-animation-info");
+
+  object_class->constructor = clutter_actor_constructor;
+  object_class->set_property = clutter_actor_set_property;
+  object_class->get_property = clutter_actor_get_property;
+  object_class->dispose = clutter_actor_dispose;
+  object_class->finalize = clutter_actor_finalize;
+
+  klass->show = clutter_actor_real_show;
+  klass->show_all = clutter_actor_show;
+  klass->hide = clutter_actor_real_hide;
+  klass->hide_all = clutter_actor_hide;
+  klass->map = clutter_actor_real_map;
+  klass->unmap = clutter_actor_real_unmap;
+  klass->unrealize = clutter_actor_real_unrealize;
+  klass->pick = clutter_actor_real_pick;
+  klass->get_preferred_width = clutter_actor_real_get_preferred_width;
+  klass->get_preferred_height = clutter_actor_real_get_preferred_height;
+  klass->allocate = clutter_actor_real_allocate;
+  klass->queue_redraw = clutter_actor_real_queue_redraw;
+  klass->queue_relayout = clutter_actor_real_queue_relayout;
+  klass->apply_transform = clutter_actor_real_apply_transform;
+  klass->get_accessible = clutter_actor_real_get_accessible;
+  klass->get_paint_volume = clutter_actor_real_get_paint_volume;
+  klass->has_overlaps = clutter_actor_real_has_overlaps;
+  klass->paint = clutter_actor_real_paint;
+  klass->get_opaque_box = clutter_actor_real_get_opaque_box;
+  klass->destroy = clutter_actor_real_destroy;
+
+  g_type_class_add_private (klass, sizeof (ClutterActorPrivate));
+
+  /**
+   * ClutterActor:x:
+   *
+   * X coordinate of the actor in pixels. If written, forces a fixed
+   * position for the actor. If read, returns the fixed position if any,
+   * otherwise the allocation if available, otherwise 0.
+   *
+   * The #ClutterActor:x property is animatable.
+   */
+  obj_props[PROP_X] =
+    g_param_spec_float ("x",
+                        P_("X coordinate"),
+                        P_("X coordinate of the actor"),
+                        -G_MAXFLOAT, G_MAXFLOAT,
+                        0.0,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:y:
+   *
+   * Y coordinate of the actor in pixels. If written, forces a fixed
+   * position for the actor.  If read, returns the fixed position if
+   * any, otherwise the allocation if available, otherwise 0.
+   *
+   * The #ClutterActor:y property is animatable.
+   */
+  obj_props[PROP_Y] =
+    g_param_spec_float ("y",
+                        P_("Y coordinate"),
+                        P_("Y coordinate of the actor"),
+                        -G_MAXFLOAT, G_MAXFLOAT,
+                        0.0,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:position:
+   *
+   * The position of the origin of the actor.
+   *
+   * This property is a shorthand for setting and getting the
+   * #ClutterActor:x and #ClutterActor:y properties at the same
+   * time.
+   *
+   * The #ClutterActor:position property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_POSITION] =
+    g_param_spec_boxed ("position",
+                        P_("Position"),
+                        P_("The position of the origin of the actor"),
+                        CLUTTER_TYPE_POINT,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:width:
+   *
+   * Width of the actor (in pixels). If written, forces the minimum and
+   * natural size request of the actor to the given width. If read, returns
+   * the allocated width if available, otherwise the width request.
+   *
+   * The #ClutterActor:width property is animatable.
+   */
+  obj_props[PROP_WIDTH] =
+    g_param_spec_float ("width",
+                        P_("Width"),
+                        P_("Width of the actor"),
+                        0.0, G_MAXFLOAT,
+                        0.0,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:height:
+   *
+   * Height of the actor (in pixels).  If written, forces the minimum and
+   * natural size request of the actor to the given height. If read, returns
+   * the allocated height if available, otherwise the height request.
+   *
+   * The #ClutterActor:height property is animatable.
+   */
+  obj_props[PROP_HEIGHT] =
+    g_param_spec_float ("height",
+                        P_("Height"),
+                        P_("Height of the actor"),
+                        0.0, G_MAXFLOAT,
+                        0.0,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:size:
+   *
+   * The size of the actor.
+   *
+   * This property is a shorthand for setting and getting the
+   * #ClutterActor:width and #ClutterActor:height at the same time.
+   *
+   * The #ClutterActor:size property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_SIZE] =
+    g_param_spec_boxed ("size",
+                        P_("Size"),
+                        P_("The size of the actor"),
+                        CLUTTER_TYPE_SIZE,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:fixed-x:
+   *
+   * The fixed X position of the actor in pixels.
+   *
+   * Writing this property sets #ClutterActor:fixed-position-set
+   * property as well, as a side effect
+   *
+   *
+   */
+  obj_props[PROP_FIXED_X] =
+    g_param_spec_float ("fixed-x",
+                        P_("Fixed X"),
+                        P_("Forced X position of the actor"),
+                        -G_MAXFLOAT, G_MAXFLOAT,
+                        0.0,
+                        CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:fixed-y:
+   *
+   * The fixed Y position of the actor in pixels.
+   *
+   * Writing this property sets the #ClutterActor:fixed-position-set
+   * property as well, as a side effect
+   *
+   *
+   */
+  obj_props[PROP_FIXED_Y] =
+    g_param_spec_float ("fixed-y",
+                        P_("Fixed Y"),
+                        P_("Forced Y position of the actor"),
+                        -G_MAXFLOAT, G_MAXFLOAT,
+                        0,
+                        CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:fixed-position-set:
+   *
+   * This flag controls whether the #ClutterActor:fixed-x and
+   * #ClutterActor:fixed-y properties are used
+   *
+   *
+   */
+  obj_props[PROP_FIXED_POSITION_SET] =
+    g_param_spec_boolean ("fixed-position-set",
+                          P_("Fixed position set"),
+                          P_("Whether to use fixed positioning for the actor"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:min-width:
+   *
+   * A forced minimum width request for the actor, in pixels
+   *
+   * Writing this property sets the #ClutterActor:min-width-set property
+   * as well, as a side effect.
+   *
+   *This property overrides the usual width request of the actor.
+   *
+   *
+   */
+  obj_props[PROP_MIN_WIDTH] =
+    g_param_spec_float ("min-width",
+                        P_("Min Width"),
+                        P_("Forced minimum width request for the actor"),
+                        0.0, G_MAXFLOAT,
+                        0.0,
+                        CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:min-height:
+   *
+   * A forced minimum height request for the actor, in pixels
+   *
+   * Writing this property sets the #ClutterActor:min-height-set property
+   * as well, as a side effect. This property overrides the usual height
+   * request of the actor.
+   *
+   *
+   */
+  obj_props[PROP_MIN_HEIGHT] =
+    g_param_spec_float ("min-height",
+                        P_("Min Height"),
+                        P_("Forced minimum height request for the actor"),
+                        0.0, G_MAXFLOAT,
+                        0.0,
+                        CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:natural-width:
+   *
+   * A forced natural width request for the actor, in pixels
+   *
+   * Writing this property sets the #ClutterActor:natural-width-set
+   * property as well, as a side effect. This property overrides the
+   * usual width request of the actor
+   *
+   *
+   */
+  obj_props[PROP_NATURAL_WIDTH] =
+    g_param_spec_float ("natural-width",
+                        P_("Natural Width"),
+                        P_("Forced natural width request for the actor"),
+                        0.0, G_MAXFLOAT,
+                        0.0,
+                        CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:natural-height:
+   *
+   * A forced natural height request for the actor, in pixels
+   *
+   * Writing this property sets the #ClutterActor:natural-height-set
+   * property as well, as a side effect. This property overrides the
+   * usual height request of the actor
+   *
+   *
+   */
+  obj_props[PROP_NATURAL_HEIGHT] =
+    g_param_spec_float ("natural-height",
+                        P_("Natural Height"),
+                        P_("Forced natural height request for the actor"),
+                        0.0, G_MAXFLOAT,
+                        0.0,
+                        CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:min-width-set:
+   *
+   * This flag controls whether the #ClutterActor:min-width property
+   * is used
+   *
+   *
+   */
+  obj_props[PROP_MIN_WIDTH_SET] =
+    g_param_spec_boolean ("min-width-set",
+                          P_("Minimum width set"),
+                          P_("Whether to use the min-width property"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:min-height-set:
+   *
+   * This flag controls whether the #ClutterActor:min-height property
+   * is used
+   *
+   *
+   */
+  obj_props[PROP_MIN_HEIGHT_SET] =
+    g_param_spec_boolean ("min-height-set",
+                          P_("Minimum height set"),
+                          P_("Whether to use the min-height property"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:natural-width-set:
+   *
+   * This flag controls whether the #ClutterActor:natural-width property
+   * is used
+   *
+   *
+   */
+  obj_props[PROP_NATURAL_WIDTH_SET] =
+    g_param_spec_boolean ("natural-width-set",
+                          P_("Natural width set"),
+                          P_("Whether to use the natural-width property"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:natural-height-set:
+   *
+   * This flag controls whether the #ClutterActor:natural-height property
+   * is used
+   *
+   *
+   */
+  obj_props[PROP_NATURAL_HEIGHT_SET] =
+    g_param_spec_boolean ("natural-height-set",
+                          P_("Natural height set"),
+                          P_("Whether to use the natural-height property"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:allocation:
+   *
+   * The allocation for the actor, in pixels
+   *
+   * This is property is read-only, but you might monitor it to know when an
+   * actor moves or resizes
+   *
+   *
+   */
+  obj_props[PROP_ALLOCATION] =
+    g_param_spec_boxed ("allocation",
+                        P_("Allocation"),
+                        P_("The actor's allocation"),
+                        CLUTTER_TYPE_ACTOR_BOX,
+                        G_PARAM_READABLE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:request-mode:
+   *
+   * Request mode for the #ClutterActor. The request mode determines the
+   * type of geometry management used by the actor, either height for width
+   * (the default) or width for height.
+   *
+   * For actors implementing height for width, the parent container should get
+   * the preferred width first, and then the preferred height for that width.
+   *
+   * For actors implementing width for height, the parent container should get
+   * the preferred height first, and then the preferred width for that height.
+   *
+   * For instance:
+   *
+   * |[
+   *   ClutterRequestMode mode;
+   *   gfloat natural_width, min_width;
+   *   gfloat natural_height, min_height;
+   *
+   *   mode = clutter_actor_get_request_mode (child);
+   *   if (mode == CLUTTER_REQUEST_HEIGHT_FOR_WIDTH)
+   *     {
+   *       clutter_actor_get_preferred_width (child, -1,
+   *                                          &amp;min_width,
+   *                                          &amp;natural_width);
+   *       clutter_actor_get_preferred_height (child, natural_width,
+   *                                           &amp;min_height,
+   *                                           &amp;natural_height);
+   *     }
+   *   else
+   *     {
+   *       clutter_actor_get_preferred_height (child, -1,
+   *                                           &amp;min_height,
+   *                                           &amp;natural_height);
+   *       clutter_actor_get_preferred_width (child, natural_height,
+   *                                          &amp;min_width,
+   *                                          &amp;natural_width);
+   *     }
+   * ]|
+   *
+   * will retrieve the minimum and natural width and height depending on the
+   * preferred request mode of the #ClutterActor "child".
+   *
+   * The clutter_actor_get_preferred_size() function will implement this
+   * check for you.
+   *
+   *
+   */
+  obj_props[PROP_REQUEST_MODE] =
+    g_param_spec_enum ("request-mode",
+                       P_("Request Mode"),
+                       P_("The actor's request mode"),
+                       CLUTTER_TYPE_REQUEST_MODE,
+                       CLUTTER_REQUEST_HEIGHT_FOR_WIDTH,
+                       CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:z-position:
+   *
+   * The actor's position on the Z axis, relative to the parent's
+   * transformations.
+   *
+   * Positive values will bring the actor's position nearer to the user,
+   * whereas negative values will bring the actor's position farther from
+   * the user.
+   *
+   * The #ClutterActor:z-position does not affect the paint or allocation
+   * order.
+   *
+   * The #ClutterActor:z-position property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_Z_POSITION] =
+    g_param_spec_float ("z-position",
+                        P_("Z Position"),
+                        P_("The actor's position on the Z axis"),
+                        -G_MAXFLOAT, G_MAXFLOAT,
+                        0.0f,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:opacity:
+   *
+   * Opacity of an actor, between 0 (fully transparent) and
+   * 255 (fully opaque)
+   *
+   * The #ClutterActor:opacity property is animatable.
+   */
+  obj_props[PROP_OPACITY] =
+    g_param_spec_uint ("opacity",
+                       P_("Opacity"),
+                       P_("Opacity of an actor"),
+                       0, 255,
+                       255,
+                       G_PARAM_READWRITE |
+                       G_PARAM_STATIC_STRINGS |
+                       CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:offscreen-redirect:
+   *
+   * Determines the conditions in which the actor will be redirected
+   * to an offscreen framebuffer while being painted. For example this
+   * can be used to cache an actor in a framebuffer or for improved
+   * handling of transparent actors. See
+   * clutter_actor_set_offscreen_redirect() for details.
+   *
+   *
+   */
+  obj_props[PROP_OFFSCREEN_REDIRECT] =
+    g_param_spec_flags ("offscreen-redirect",
+                        P_("Offscreen redirect"),
+                        P_("Flags controlling when to flatten the actor into a single image"),
+                        CLUTTER_TYPE_OFFSCREEN_REDIRECT,
+                        0,
+                        CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:visible:
+   *
+   * Whether the actor is set to be visible or not
+   *
+   * See also #ClutterActor:mapped
+   */
+  obj_props[PROP_VISIBLE] =
+    g_param_spec_boolean ("visible",
+                          P_("Visible"),
+                          P_("Whether the actor is visible or not"),
+                          TRUE,
+                          CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:mapped:
+   *
+   * Whether the actor is mapped (will be painted when the stage
+   * to which it belongs is mapped)
+   *
+   *
+   */
+  obj_props[PROP_MAPPED] =
+    g_param_spec_boolean ("mapped",
+                          P_("Mapped"),
+                          P_("Whether the actor will be painted"),
+                          FALSE,
+                          CLUTTER_PARAM_READABLE);
+
+  /**
+   * ClutterActor:realized:
+   *
+   * Whether the actor has been realized
+   *
+   *
+   */
+  obj_props[PROP_REALIZED] =
+    g_param_spec_boolean ("realized",
+                          P_("Realized"),
+                          P_("Whether the actor has been realized"),
+                          FALSE,
+                          CLUTTER_PARAM_READABLE);
+
+  /**
+   * ClutterActor:reactive:
+   *
+   * Whether the actor is reactive to events or not
+   *
+   * Only reactive actors will emit event-related signals
+   *
+   *
+   */
+  obj_props[PROP_REACTIVE] =
+    g_param_spec_boolean ("reactive",
+                          P_("Reactive"),
+                          P_("Whether the actor is reactive to events"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:has-clip:
+   *
+   * Whether the actor has the #ClutterActor:clip property set or not
+   */
+  obj_props[PROP_HAS_CLIP] =
+    g_param_spec_boolean ("has-clip",
+                          P_("Has Clip"),
+                          P_("Whether the actor has a clip set"),
+                          FALSE,
+                          CLUTTER_PARAM_READABLE);
+
+  /**
+   * ClutterActor:clip-rect:
+   *
+   * The visible region of the actor, in actor-relative coordinates,
+   * expressed as a #ClutterRect.
+   *
+   * Setting this property to %NULL will unset the existing clip.
+   *
+   * Setting this property will change the #ClutterActor:has-clip
+   * property as a side effect.
+   *
+   *
+   */
+  obj_props[PROP_CLIP_RECT] =
+    g_param_spec_boxed ("clip-rect",
+                        P_("Clip Rectangle"),
+                        P_("The visible region of the actor"),
+                        CLUTTER_TYPE_RECT,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS);
+
+  /**
+   * ClutterActor:name:
+   *
+   * The name of the actor
+   *
+   *
+   */
+  obj_props[PROP_NAME] =
+    g_param_spec_string ("name",
+                         P_("Name"),
+                         P_("Name of the actor"),
+                         NULL,
+                         CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:pivot-point:
+   *
+   * The point around which the scaling and rotation transformations occur.
+   *
+   * The pivot point is expressed in normalized coordinates space, with (0, 0)
+   * being the top left corner of the actor and (1, 1) the bottom right corner
+   * of the actor.
+   *
+   * The default pivot point is located at (0, 0).
+   *
+   * The #ClutterActor:pivot-point property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_PIVOT_POINT] =
+    g_param_spec_boxed ("pivot-point",
+                        P_("Pivot Point"),
+                        P_("The point around which the scaling and rotation occur"),
+                        CLUTTER_TYPE_POINT,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:pivot-point-z:
+   *
+   * The Z component of the #ClutterActor:pivot-point, expressed as a value
+   * along the Z axis.
+   *
+   * The #ClutterActor:pivot-point-z property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_PIVOT_POINT_Z] =
+    g_param_spec_float ("pivot-point-z",
+                        P_("Pivot Point Z"),
+                        P_("Z component of the pivot point"),
+                        -G_MAXFLOAT, G_MAXFLOAT,
+                        0.f,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:scale-x:
+   *
+   * The horizontal scale of the actor.
+   *
+   * The #ClutterActor:scale-x property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_SCALE_X] =
+    g_param_spec_double ("scale-x",
+                         P_("Scale X"),
+                         P_("Scale factor on the X axis"),
+                         0.0, G_MAXDOUBLE,
+                         1.0,
+                         G_PARAM_READWRITE |
+                         G_PARAM_STATIC_STRINGS |
+                         CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:scale-y:
+   *
+   * The vertical scale of the actor.
+   *
+   * The #ClutterActor:scale-y property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_SCALE_Y] =
+    g_param_spec_double ("scale-y",
+                         P_("Scale Y"),
+                         P_("Scale factor on the Y axis"),
+                         0.0, G_MAXDOUBLE,
+                         1.0,
+                         G_PARAM_READWRITE |
+                         G_PARAM_STATIC_STRINGS |
+                         CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:scale-z:
+   *
+   * The scale factor of the actor along the Z axis.
+   *
+   * The #ClutterActor:scale-y property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_SCALE_Z] =
+    g_param_spec_double ("scale-z",
+                         P_("Scale Z"),
+                         P_("Scale factor on the Z axis"),
+                         0.0, G_MAXDOUBLE,
+                         1.0,
+                         G_PARAM_READWRITE |
+                         G_PARAM_STATIC_STRINGS |
+                         CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:rotation-angle-x:
+   *
+   * The rotation angle on the X axis.
+   *
+   * The #ClutterActor:rotation-angle-x property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_ROTATION_ANGLE_X] =
+    g_param_spec_double ("rotation-angle-x",
+                         P_("Rotation Angle X"),
+                         P_("The rotation angle on the X axis"),
+                         -G_MAXDOUBLE, G_MAXDOUBLE,
+                         0.0,
+                         G_PARAM_READWRITE |
+                         G_PARAM_STATIC_STRINGS |
+                         CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:rotation-angle-y:
+   *
+   * The rotation angle on the Y axis
+   *
+   * The #ClutterActor:rotation-angle-y property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_ROTATION_ANGLE_Y] =
+    g_param_spec_double ("rotation-angle-y",
+                         P_("Rotation Angle Y"),
+                         P_("The rotation angle on the Y axis"),
+                         -G_MAXDOUBLE, G_MAXDOUBLE,
+                         0.0,
+                         G_PARAM_READWRITE |
+                         G_PARAM_STATIC_STRINGS |
+                         CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:rotation-angle-z:
+   *
+   * The rotation angle on the Z axis
+   *
+   * The #ClutterActor:rotation-angle-z property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_ROTATION_ANGLE_Z] =
+    g_param_spec_double ("rotation-angle-z",
+                         P_("Rotation Angle Z"),
+                         P_("The rotation angle on the Z axis"),
+                         -G_MAXDOUBLE, G_MAXDOUBLE,
+                         0.0,
+                         G_PARAM_READWRITE |
+                         G_PARAM_STATIC_STRINGS |
+                         CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:translation-x:
+   *
+   * An additional translation applied along the X axis, relative
+   * to the actor's #ClutterActor:pivot-point.
+   *
+   * The #ClutterActor:translation-x property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_TRANSLATION_X] =
+    g_param_spec_float ("translation-x",
+                        P_("Translation X"),
+                        P_("Translation along the X axis"),
+                        -G_MAXFLOAT, G_MAXFLOAT,
+                        0.f,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:translation-y:
+   *
+   * An additional translation applied along the Y axis, relative
+   * to the actor's #ClutterActor:pivot-point.
+   *
+   * The #ClutterActor:translation-y property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_TRANSLATION_Y] =
+    g_param_spec_float ("translation-y",
+                        P_("Translation Y"),
+                        P_("Translation along the Y axis"),
+                        -G_MAXFLOAT, G_MAXFLOAT,
+                        0.f,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:translation-z:
+   *
+   * An additional translation applied along the Z axis, relative
+   * to the actor's #ClutterActor:pivot-point.
+   *
+   * The #ClutterActor:translation-z property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_TRANSLATION_Z] =
+    g_param_spec_float ("translation-z",
+                        P_("Translation Z"),
+                        P_("Translation along the Z axis"),
+                        -G_MAXFLOAT, G_MAXFLOAT,
+                        0.f,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:transform:
+   *
+   * Overrides the transformations of a #ClutterActor with a custom
+   * matrix.
+   *
+   * The matrix specified by the #ClutterActor:transform property is
+   * applied to the actor and its children relative to the actor's
+   * #ClutterActor:allocation and #ClutterActor:pivot-point.
+   *
+   * Application code should rarely need to use this function directly.
+   *
+   * Setting this property with a #ClutterMatrix will set the
+   * #ClutterActor:transform-set property to %TRUE as a side effect;
+   * setting this property with %NULL will set the
+   * #ClutterActor:transform-set property to %FALSE.
+   *
+   * The #ClutterActor:transform property is animatable.
+   */
+  obj_props[PROP_TRANSFORM] =
+    g_param_spec_boxed ("transform",
+                        P_("Transform"),
+                        P_("Transformation matrix"),
+                        CLUTTER_TYPE_MATRIX,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:transform-set:
+   *
+   * Whether the #ClutterActor:transform property is set.
+   */
+  obj_props[PROP_TRANSFORM_SET] =
+    g_param_spec_boolean ("transform-set",
+                          P_("Transform Set"),
+                          P_("Whether the transform property is set"),
+                          FALSE,
+                          G_PARAM_READABLE |
+                          G_PARAM_STATIC_STRINGS);
+
+  /**
+   * ClutterActor:child-transform:
+   *
+   * Applies a transformation matrix on each child of an actor.
+   *
+   * Setting this property with a #ClutterMatrix will set the
+   * #ClutterActor:child-transform-set property to %TRUE as a side effect;
+   * setting this property with %NULL will set the
+   * #ClutterActor:child-transform-set property to %FALSE.
+   *
+   * The #ClutterActor:child-transform property is animatable.
+   */
+  obj_props[PROP_CHILD_TRANSFORM] =
+    g_param_spec_boxed ("child-transform",
+                        P_("Child Transform"),
+                        P_("Children transformation matrix"),
+                        CLUTTER_TYPE_MATRIX,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:child-transform-set:
+   *
+   * Whether the #ClutterActor:child-transform property is set.
+   *
+   *
+   */
+  obj_props[PROP_CHILD_TRANSFORM_SET] =
+    g_param_spec_boolean ("child-transform-set",
+                          P_("Child Transform Set"),
+                          P_("Whether the child-transform property is set"),
+                          FALSE,
+                          G_PARAM_READABLE |
+                          G_PARAM_STATIC_STRINGS);
+
+  /**
+   * ClutterActor:clip-to-allocation:
+   *
+   * Whether the clip region should track the allocated area
+   * of the actor.
+   *
+   * This property is ignored if a clip area has been explicitly
+   * set using clutter_actor_set_clip().
+   *
+   *
+   */
+  obj_props[PROP_CLIP_TO_ALLOCATION] =
+    g_param_spec_boolean ("clip-to-allocation",
+                          P_("Clip to Allocation"),
+                          P_("Sets the clip region to track the actor's allocation"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:text-direction:
+   *
+   * The direction of the text inside a #ClutterActor.
+   *
+   *
+   */
+  obj_props[PROP_TEXT_DIRECTION] =
+    g_param_spec_enum ("text-direction",
+                       P_("Text Direction"),
+                       P_("Direction of the text"),
+                       CLUTTER_TYPE_TEXT_DIRECTION,
+                       CLUTTER_TEXT_DIRECTION_LTR,
+                       CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:has-pointer:
+   *
+   * Whether the actor contains the pointer of a #ClutterInputDevice
+   * or not.
+   *
+   *
+   */
+  obj_props[PROP_HAS_POINTER] =
+    g_param_spec_boolean ("has-pointer",
+                          P_("Has Pointer"),
+                          P_("Whether the actor contains the pointer of an input device"),
+                          FALSE,
+                          CLUTTER_PARAM_READABLE);
+
+  /**
+   * ClutterActor:actions:
+   *
+   * Adds a #ClutterAction to the actor
+   *
+   *
+   */
+  obj_props[PROP_ACTIONS] =
+    g_param_spec_object ("actions",
+                         P_("Actions"),
+                         P_("Adds an action to the actor"),
+                         CLUTTER_TYPE_ACTION,
+                         CLUTTER_PARAM_WRITABLE);
+
+  /**
+   * ClutterActor:constraints:
+   *
+   * Adds a #ClutterConstraint to the actor
+   *
+   *
+   */
+  obj_props[PROP_CONSTRAINTS] =
+    g_param_spec_object ("constraints",
+                         P_("Constraints"),
+                         P_("Adds a constraint to the actor"),
+                         CLUTTER_TYPE_CONSTRAINT,
+                         CLUTTER_PARAM_WRITABLE);
+
+  /**
+   * ClutterActor:effect:
+   *
+   * Adds #ClutterEffect to the list of effects be applied on a #ClutterActor
+   *
+   *
+   */
+  obj_props[PROP_EFFECT] =
+    g_param_spec_object ("effect",
+                         P_("Effect"),
+                         P_("Add an effect to be applied on the actor"),
+                         CLUTTER_TYPE_EFFECT,
+                         CLUTTER_PARAM_WRITABLE);
+
+  /**
+   * ClutterActor:layout-manager:
+   *
+   * A delegate object for controlling the layout of the children of
+   * an actor.
+   *
+   *
+   */
+  obj_props[PROP_LAYOUT_MANAGER] =
+    g_param_spec_object ("layout-manager",
+                         P_("Layout Manager"),
+                         P_("The object controlling the layout of an actor's children"),
+                         CLUTTER_TYPE_LAYOUT_MANAGER,
+                         CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:x-expand:
+   *
+   * Whether a layout manager should assign more space to the actor on
+   * the X axis.
+   *
+   *
+   */
+  obj_props[PROP_X_EXPAND] =
+    g_param_spec_boolean ("x-expand",
+                          P_("X Expand"),
+                          P_("Whether extra horizontal space should be assigned to the actor"),
+                          FALSE,
+                          G_PARAM_READWRITE |
+                          G_PARAM_STATIC_STRINGS);
+
+  /**
+   * ClutterActor:y-expand:
+   *
+   * Whether a layout manager should assign more space to the actor on
+   * the Y axis.
+   *
+   *
+   */
+  obj_props[PROP_Y_EXPAND] =
+    g_param_spec_boolean ("y-expand",
+                          P_("Y Expand"),
+                          P_("Whether extra vertical space should be assigned to the actor"),
+                          FALSE,
+                          G_PARAM_READWRITE |
+                          G_PARAM_STATIC_STRINGS);
+
+  /**
+   * ClutterActor:x-align:
+   *
+   * The alignment of an actor on the X axis, if the actor has been given
+   * extra space for its allocation. See also the #ClutterActor:x-expand
+   * property.
+   *
+   *
+   */
+  obj_props[PROP_X_ALIGN] =
+    g_param_spec_enum ("x-align",
+                       P_("X Alignment"),
+                       P_("The alignment of the actor on the X axis within its allocation"),
+                       CLUTTER_TYPE_ACTOR_ALIGN,
+                       CLUTTER_ACTOR_ALIGN_FILL,
+                       CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:y-align:
+   *
+   * The alignment of an actor on the Y axis, if the actor has been given
+   * extra space for its allocation.
+   *
+   *
+   */
+  obj_props[PROP_Y_ALIGN] =
+    g_param_spec_enum ("y-align",
+                       P_("Y Alignment"),
+                       P_("The alignment of the actor on the Y axis within its allocation"),
+                       CLUTTER_TYPE_ACTOR_ALIGN,
+                       CLUTTER_ACTOR_ALIGN_FILL,
+                       CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:margin-top:
+   *
+   * The margin (in pixels) from the top of the actor.
+   *
+   * This property adds a margin to the actor's preferred size; the margin
+   * will be automatically taken into account when allocating the actor.
+   *
+   * The #ClutterActor:margin-top property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_MARGIN_TOP] =
+    g_param_spec_float ("margin-top",
+                        P_("Margin Top"),
+                        P_("Extra space at the top"),
+                        0.0, G_MAXFLOAT,
+                        0.0,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:margin-bottom:
+   *
+   * The margin (in pixels) from the bottom of the actor.
+   *
+   * This property adds a margin to the actor's preferred size; the margin
+   * will be automatically taken into account when allocating the actor.
+   *
+   * The #ClutterActor:margin-bottom property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_MARGIN_BOTTOM] =
+    g_param_spec_float ("margin-bottom",
+                        P_("Margin Bottom"),
+                        P_("Extra space at the bottom"),
+                        0.0, G_MAXFLOAT,
+                        0.0,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:margin-left:
+   *
+   * The margin (in pixels) from the left of the actor.
+   *
+   * This property adds a margin to the actor's preferred size; the margin
+   * will be automatically taken into account when allocating the actor.
+   *
+   * The #ClutterActor:margin-left property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_MARGIN_LEFT] =
+    g_param_spec_float ("margin-left",
+                        P_("Margin Left"),
+                        P_("Extra space at the left"),
+                        0.0, G_MAXFLOAT,
+                        0.0,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:margin-right:
+   *
+   * The margin (in pixels) from the right of the actor.
+   *
+   * This property adds a margin to the actor's preferred size; the margin
+   * will be automatically taken into account when allocating the actor.
+   *
+   * The #ClutterActor:margin-right property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_MARGIN_RIGHT] =
+    g_param_spec_float ("margin-right",
+                        P_("Margin Right"),
+                        P_("Extra space at the right"),
+                        0.0, G_MAXFLOAT,
+                        0.0,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:background-color-set:
+   *
+   * Whether the #ClutterActor:background-color property has been set.
+   *
+   *
+   */
+  obj_props[PROP_BACKGROUND_COLOR_SET] =
+    g_param_spec_boolean ("background-color-set",
+                          P_("Background Color Set"),
+                          P_("Whether the background color is set"),
+                          FALSE,
+                          CLUTTER_PARAM_READABLE);
+
+  /**
+   * ClutterActor:background-color:
+   *
+   * Paints a solid fill of the actor's allocation using the specified
+   * color.
+   *
+   * The #ClutterActor:background-color property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_BACKGROUND_COLOR] =
+    clutter_param_spec_color ("background-color",
+                              P_("Background color"),
+                              P_("The actor's background color"),
+                              CLUTTER_COLOR_Transparent,
+                              G_PARAM_READWRITE |
+                              G_PARAM_STATIC_STRINGS |
+                              CLUTTER_PARAM_ANIMATABLE);
+
+  /**
+   * ClutterActor:first-child:
+   *
+   * The actor's first child.
+   *
+   *
+   */
+  obj_props[PROP_FIRST_CHILD] =
+    g_param_spec_object ("first-child",
+                         P_("First Child"),
+                         P_("The actor's first child"),
+                         CLUTTER_TYPE_ACTOR,
+                         CLUTTER_PARAM_READABLE);
+
+  /**
+   * ClutterActor:last-child:
+   *
+   * The actor's last child.
+   *
+   *
+   */
+  obj_props[PROP_LAST_CHILD] =
+    g_param_spec_object ("last-child",
+                         P_("Last Child"),
+                         P_("The actor's last child"),
+                         CLUTTER_TYPE_ACTOR,
+                         CLUTTER_PARAM_READABLE);
+
+  /**
+   * ClutterActor:content:
+   *
+   * The #ClutterContent implementation that controls the content
+   * of the actor.
+   *
+   *
+   */
+  obj_props[PROP_CONTENT] =
+    g_param_spec_object ("content",
+                         P_("Content"),
+                         P_("Delegate object for painting the actor's content"),
+                         CLUTTER_TYPE_CONTENT,
+                         CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:content-gravity:
+   *
+   * The alignment that should be honoured by the #ClutterContent
+   * set with the #ClutterActor:content property.
+   *
+   * Changing the value of this property will change the bounding box of
+   * the content; you can use the #ClutterActor:content-box property to
+   * get the position and size of the content within the actor's
+   * allocation.
+   *
+   * This property is meaningful only for #ClutterContent implementations
+   * that have a preferred size, and if the preferred size is smaller than
+   * the actor's allocation.
+   *
+   * The #ClutterActor:content-gravity property is animatable.
+   *
+   *
+   */
+  obj_props[PROP_CONTENT_GRAVITY] =
+    g_param_spec_enum ("content-gravity",
+                       P_("Content Gravity"),
+                       P_("Alignment of the actor's content"),
+                       CLUTTER_TYPE_CONTENT_GRAVITY,
+                       CLUTTER_CONTENT_GRAVITY_RESIZE_FILL,
+                       CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:content-box:
+   *
+   * The bounding box for the #ClutterContent used by the actor.
+   *
+   * The value of this property is controlled by the #ClutterActor:allocation
+   * and #ClutterActor:content-gravity properties of #ClutterActor.
+   *
+   * The bounding box for the content is guaranteed to never exceed the
+   * allocation's of the actor.
+   *
+   *
+   */
+  obj_props[PROP_CONTENT_BOX] =
+    g_param_spec_boxed ("content-box",
+                        P_("Content Box"),
+                        P_("The bounding box of the actor's content"),
+                        CLUTTER_TYPE_ACTOR_BOX,
+                        G_PARAM_READABLE |
+                        G_PARAM_STATIC_STRINGS |
+                        CLUTTER_PARAM_ANIMATABLE);
+
+  obj_props[PROP_MINIFICATION_FILTER] =
+    g_param_spec_enum ("minification-filter",
+                       P_("Minification Filter"),
+                       P_("The filter used when reducing the size of the content"),
+                       CLUTTER_TYPE_SCALING_FILTER,
+                       CLUTTER_SCALING_FILTER_LINEAR,
+                       CLUTTER_PARAM_READWRITE);
+
+  obj_props[PROP_MAGNIFICATION_FILTER] =
+    g_param_spec_enum ("magnification-filter",
+                       P_("Magnification Filter"),
+                       P_("The filter used when increasing the size of the content"),
+                       CLUTTER_TYPE_SCALING_FILTER,
+                       CLUTTER_SCALING_FILTER_LINEAR,
+                       CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:content-repeat:
+   *
+   * The repeat policy for the actor's #ClutterActor:content.
+   *
+   *
+   */
+  obj_props[PROP_CONTENT_REPEAT] =
+    g_param_spec_flags ("content-repeat",
+                        P_("Content Repeat"),
+                        P_("The repeat policy for the actor's content"),
+                        CLUTTER_TYPE_CONTENT_REPEAT,
+                        CLUTTER_REPEAT_NONE,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS);
+
+  /**
+   * ClutterActor:lod-threshold:
+   *
+   * The size on the stage, in pixels, below which the actor and its
+   * children are replaced by the #ClutterActor:lod-placeholder, or
+   * 0 to always paint the actor.
+   *
+   * See clutter_actor_set_lod_threshold().
+   */
+  obj_props[PROP_LOD_THRESHOLD] =
+    g_param_spec_float ("lod-threshold",
+                        P_("LOD Threshold"),
+                        P_("The size below which the actor is painted using its placeholder"),
+                        0.f, G_MAXFLOAT,
+                        0.f,
+                        CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterActor:lod-placeholder:
+   *
+   * The #ClutterContent painted instead of the actor and its children
+   * when the actor is smaller than the #ClutterActor:lod-threshold.
+   */
+  obj_props[PROP_LOD_PLACEHOLDER] =
+    g_param_spec_object ("lod-placeholder",
+                         P_("LOD Placeholder"),
+                         P_("The content painted when the actor is smaller than the LOD threshold"),
+                         CLUTTER_TYPE_CONTENT,
+                         CLUTTER_PARAM_READWRITE);
+
+  g_object_class_install_properties (object_class, PROP_LAST, obj_props);
+
+  /**
+   * ClutterActor::destroy:
+   * @actor: the #ClutterActor which emitted the signal
+   *
+   * The ::destroy signal notifies that all references held on the
+   * actor which emitted it should be released.
+   *
+   * The ::destroy signal should be used by all holders of a reference
+   * on @actor.
+   *
+   * This signal might result in the finalization of the #ClutterActor
+   * if all references are released.
+   *
+   * Composite actors and actors implementing the #ClutterContainer
+   * interface should override the default implementation of the
+   * class handler of this signal and call clutter_actor_destroy() on
+   * their children. When overriding the default class handler, it is
+   * required to chain up to the parent's implementation.
+   *
+   *
+   */
+  actor_signals[DESTROY] =
+    g_signal_new (I_("destroy"),
+		  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_CLEANUP | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+		  G_STRUCT_OFFSET (ClutterActorClass, destroy),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__VOID,
+		  G_TYPE_NONE, 0);
+  /**
+   * ClutterActor::show:
+   * @actor: the object which received the signal
+   *
+   * The ::show signal is emitted when an actor is visible and
+   * rendered on the stage.
+   *
+   *
+   */
+  actor_signals[SHOW] =
+    g_signal_new (I_("show"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_FIRST,
+		  G_STRUCT_OFFSET (ClutterActorClass, show),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__VOID,
+		  G_TYPE_NONE, 0);
+  /**
+   * ClutterActor::hide:
+   * @actor: the object which received the signal
+   *
+   * The ::hide signal is emitted when an actor is no longer rendered
+   * on the stage.
+   *
+   *
+   */
+  actor_signals[HIDE] =
+    g_signal_new (I_("hide"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_FIRST,
+		  G_STRUCT_OFFSET (ClutterActorClass, hide),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__VOID,
+		  G_TYPE_NONE, 0);
+  /**
+   * ClutterActor::parent-set:
+   * @actor: the object which received the signal
+   * @old_parent: (allow-none): the previous parent of the actor, or %NULL
+   *
+   * This signal is emitted when the parent of the actor changes.
+   *
+   *
+   */
+  actor_signals[PARENT_SET] =
+    g_signal_new (I_("parent-set"),
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_LAST,
+                  G_STRUCT_OFFSET (ClutterActorClass, parent_set),
+                  NULL, NULL,
+                  _clutter_marshal_VOID__OBJECT,
+                  G_TYPE_NONE, 1,
+                  CLUTTER_TYPE_ACTOR);
+
+  /**
+   * ClutterActor::queue-redraw:
+   * @actor: the actor we're bubbling the redraw request through
+   * @origin: the actor which initiated the redraw request
+   *
+   * The ::queue_redraw signal is emitted when clutter_actor_queue_redraw()
+   * is called on @origin.
+   *
+   * The default implementation for #ClutterActor chains up to the
+   * parent actor and queues a redraw on the parent, thus "bubbling"
+   * the redraw queue up through the actor graph. The default
+   * implementation for #ClutterStage queues a clutter_stage_ensure_redraw()
+   * in a main loop idle handler.
+   *
+   * Note that the @origin actor may be the stage, or a container; it
+   * does not have to be a leaf node in the actor graph.
+   *
+   * Toolkits embedding a #ClutterStage which require a redraw and
+   * relayout cycle can stop the emission of this signal using the
+   * GSignal API, redraw the UI and then call clutter_stage_ensure_redraw()
+   * themselves, like:
+   *
+   * |[
+   *   static void
+   *   on_redraw_complete (gpointer data)
+   *   {
+   *     ClutterStage *stage = data;
+   *
+   *     /&ast; execute the Clutter drawing pipeline &ast;/
+   *     clutter_stage_ensure_redraw (stage);
+   *   }
+   *
+   *   static void
+   *   on_stage_queue_redraw (ClutterStage *stage)
+   *   {
+   *     /&ast; this prevents the default handler to run &ast;/
+   *     g_signal_stop_emission_by_name (stage, "queue-redraw");
+   *
+   *     /&ast; queue a redraw with the host toolkit and call
+   *      &ast; a function when the redraw has been completed
+   *      &ast;/
+   *     queue_a_redraw (G_CALLBACK (on_redraw_complete), stage);
+   *   }
+   * ]|
+   *
+   * <note><para>This signal is emitted before the Clutter paint
+   * pipeline is executed. If you want to know when the pipeline has
+   * been completed you should connect to the ::paint signal on the
+   * Stage with g_signal_connect_after().</para></note>
+   *
+   *
+   */
+  actor_signals[QUEUE_REDRAW] =
+    g_signal_new (I_("queue-redraw"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST |
+                  G_SIGNAL_NO_HOOKS,
+		  G_STRUCT_OFFSET (ClutterActorClass, queue_redraw),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__OBJECT,
+		  G_TYPE_NONE, 1,
+                  CLUTTER_TYPE_ACTOR);
+
+  /**
+   * ClutterActor::queue-relayout:
+   * @actor: the actor being queued for relayout
+   *
+   * The ::queue_layout signal is emitted when clutter_actor_queue_relayout()
+   * is called on an actor.
+   *
+   * The default implementation for #ClutterActor chains up to the
+   * parent actor and queues a relayout on the parent, thus "bubbling"
+   * the relayout queue up through the actor graph.
+   *
+   * The main purpose of this signal is to allow relayout to be propagated
+   * properly in the procense of #ClutterClone actors. Applications will
+   * not normally need to connect to this signal.
+   *
+   *
+   */
+  actor_signals[QUEUE_RELAYOUT] =
+    g_signal_new (I_("queue-relayout"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST |
+                  G_SIGNAL_NO_HOOKS,
+		  G_STRUCT_OFFSET (ClutterActorClass, queue_relayout),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__VOID,
+		  G_TYPE_NONE, 0);
+
+  /**
+   * ClutterActor::event:
+   * @actor: the actor which received the event
+   * @event: a #ClutterEvent
+   *
+   * The ::event signal is emitted each time an event is received
+   * by the @actor. This signal will be emitted on every actor,
+   * following the hierarchy chain, until it reaches the top-level
+   * container (the #ClutterStage).
+   *
+   * Return value: %TRUE if the event has been handled by the actor,
+   *   or %FALSE to continue the emission.
+   *
+   *
+   */
+  actor_signals[EVENT] =
+    g_signal_new (I_("event"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterActorClass, event),
+		  _clutter_boolean_handled_accumulator, NULL,
+		  _clutter_marshal_BOOLEAN__BOXED,
+		  G_TYPE_BOOLEAN, 1,
+		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+  /**
+   * ClutterActor::button-press-event:
+   * @actor: the actor which received the event
+   * @event: (type ClutterButtonEvent): a #ClutterButtonEvent
+   *
+   * The ::button-press-event signal is emitted each time a mouse button
+   * is pressed on @actor.
+   *
+   * Return value: %TRUE if the event has been handled by the actor,
+   *   or %FALSE to continue the emission.
+   *
+   *
+   */
+  actor_signals[BUTTON_PRESS_EVENT] =
+    g_signal_new (I_("button-press-event"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterActorClass, button_press_event),
+		  _clutter_boolean_handled_accumulator, NULL,
+		  _clutter_marshal_BOOLEAN__BOXED,
+		  G_TYPE_BOOLEAN, 1,
+		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+  /**
+   * ClutterActor::button-release-event:
+   * @actor: the actor which received the event
+   * @event: (type ClutterButtonEvent): a #ClutterButtonEvent
+   *
+   * The ::button-release-event signal is emitted each time a mouse button
+   * is released on @actor.
+   *
+   * Return value: %TRUE if the event has been handled by the actor,
+   *   or %FALSE to continue the emission.
+   *
+   *
+   */
+  actor_signals[BUTTON_RELEASE_EVENT] =
+    g_signal_new (I_("button-release-event"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterActorClass, button_release_event),
+		  _clutter_boolean_handled_accumulator, NULL,
+		  _clutter_marshal_BOOLEAN__BOXED,
+		  G_TYPE_BOOLEAN, 1,
+		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+  /**
+   * ClutterActor::scroll-event:
+   * @actor: the actor which received the event
+   * @event: (type ClutterScrollEvent): a #ClutterScrollEvent
+   *
+   * The ::scroll-event signal is emitted each time the mouse is
+   * scrolled on @actor
+   *
+   * Return value: %TRUE if the event has been handled by the actor,
+   *   or %FALSE to continue the emission.
+   *
+   *
+   */
+  actor_signals[SCROLL_EVENT] =
+    g_signal_new (I_("scroll-event"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterActorClass, scroll_event),
+		  _clutter_boolean_handled_accumulator, NULL,
+		  _clutter_marshal_BOOLEAN__BOXED,
+		  G_TYPE_BOOLEAN, 1,
+		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+  /**
+   * ClutterActor::key-press-event:
+   * @actor: the actor which received the event
+   * @event: (type ClutterKeyEvent): a #ClutterKeyEvent
+   *
+   * The ::key-press-event signal is emitted each time a keyboard button
+   * is pressed while @actor has key focus (see clutter_stage_set_key_focus()).
+   *
+   * Return value: %TRUE if the event has been handled by the actor,
+   *   or %FALSE to continue the emission.
+   *
+   *
+   */
+  actor_signals[KEY_PRESS_EVENT] =
+    g_signal_new (I_("key-press-event"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterActorClass, key_press_event),
+		  _clutter_boolean_handled_accumulator, NULL,
+		  _clutter_marshal_BOOLEAN__BOXED,
+		  G_TYPE_BOOLEAN, 1,
+		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+  /**
+   * ClutterActor::key-release-event:
+   * @actor: the actor which received the event
+   * @event: (type ClutterKeyEvent): a #ClutterKeyEvent
+   *
+   * The ::key-release-event signal is emitted each time a keyboard button
+   * is released while @actor has key focus (see
+   * clutter_stage_set_key_focus()).
+   *
+   * Return value: %TRUE if the event has been handled by the actor,
+   *   or %FALSE to continue the emission.
+   *
+   *
+   */
+  actor_signals[KEY_RELEASE_EVENT] =
+    g_signal_new (I_("key-release-event"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterActorClass, key_release_event),
+		  _clutter_boolean_handled_accumulator, NULL,
+		  _clutter_marshal_BOOLEAN__BOXED,
+		  G_TYPE_BOOLEAN, 1,
+		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+  /**
+   * ClutterActor::motion-event:
+   * @actor: the actor which received the event
+   * @event: (type ClutterMotionEvent): a #ClutterMotionEvent
+   *
+   * The ::motion-event signal is emitted each time the mouse pointer is
+   * moved over @actor.
+   *
+   * Return value: %TRUE if the event has been handled by the actor,
+   *   or %FALSE to continue the emission.
+   *
+   *
+   */
+  actor_signals[MOTION_EVENT] =
+    g_signal_new (I_("motion-event"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterActorClass, motion_event),
+		  _clutter_boolean_handled_accumulator, NULL,
+		  _clutter_marshal_BOOLEAN__BOXED,
+		  G_TYPE_BOOLEAN, 1,
+		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+  /**
+   * ClutterActor::key-focus-in:
+   * @actor: the actor which now has key focus
+   *
+   * The ::key-focus-in signal is emitted when @actor receives key focus.
+   *
+   *
+   */
+  actor_signals[KEY_FOCUS_IN] =
+    g_signal_new (I_("key-focus-in"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterActorClass, key_focus_in),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__VOID,
+		  G_TYPE_NONE, 0);
+
+  /**
+   * ClutterActor::key-focus-out:
+   * @actor: the actor which now has key focus
+   *
+   * The ::key-focus-out signal is emitted when @actor loses key focus.
+   *
+   *
+   */
+  actor_signals[KEY_FOCUS_OUT] =
+    g_signal_new (I_("key-focus-out"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterActorClass, key_focus_out),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__VOID,
+		  G_TYPE_NONE, 0);
+
+  /**
+   * ClutterActor::enter-event:
+   * @actor: the actor which the pointer has entered.
+   * @event: (type ClutterCrossingEvent): a #ClutterCrossingEvent
+   *
+   * The ::enter-event signal is emitted when the pointer enters the @actor
+   *
+   * Return value: %TRUE if the event has been handled by the actor,
+   *   or %FALSE to continue the emission.
+   *
+   *
+   */
+  actor_signals[ENTER_EVENT] =
+    g_signal_new (I_("enter-event"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterActorClass, enter_event),
+		  _clutter_boolean_handled_accumulator, NULL,
+		  _clutter_marshal_BOOLEAN__BOXED,
+		  G_TYPE_BOOLEAN, 1,
+		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+  /**
+   * ClutterActor::leave-event:
+   * @actor: the actor which the pointer has left
+   * @event: (type ClutterCrossingEvent): a #ClutterCrossingEvent
+   *
+   * The ::leave-event signal is emitted when the pointer leaves the @actor.
+   *
+   * Return value: %TRUE if the event has been handled by the actor,
+   *   or %FALSE to continue the emission.
+   *
+   *
+   */
+  actor_signals[LEAVE_EVENT] =
+    g_signal_new (I_("leave-event"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterActorClass, leave_event),
+		  _clutter_boolean_handled_accumulator, NULL,
+		  _clutter_marshal_BOOLEAN__BOXED,
+		  G_TYPE_BOOLEAN, 1,
+		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+  /**
+   * ClutterActor::captured-event:
+   * @actor: the actor which received the signal
+   * @event: a #ClutterEvent
+   *
+   * The ::captured-event signal is emitted when an event is captured
+   * by Clutter. This signal will be emitted starting from the top-level
+   * container (the #ClutterStage) to the actor which received the event
+   * going down the hierarchy. This signal can be used to intercept every
+   * event before the specialized events (like
+   * ClutterActor::button-press-event or ::key-released-event) are
+   * emitted.
+   *
+   * Return value: %TRUE if the event has been handled by the actor,
+   *   or %FALSE to continue the emission.
+   *
+   *
+   */
+  actor_signals[CAPTURED_EVENT] =
+    g_signal_new (I_("captured-event"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterActorClass, captured_event),
+		  _clutter_boolean_handled_accumulator, NULL,
+		  _clutter_marshal_BOOLEAN__BOXED,
+		  G_TYPE_BOOLEAN, 1,
+		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+  /**
+   * ClutterActor::realize:
+   * @actor: the #ClutterActor that received the signal
+   *
+   * The ::realize signal is emitted each time an actor is being
+   * realized.
+   *
+   *
+   */
+  actor_signals[REALIZE] =
+    g_signal_new (I_("realize"),
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_LAST,
+                  G_STRUCT_OFFSET (ClutterActorClass, realize),
+                  NULL, NULL,
+                  _clutter_marshal_VOID__VOID,
+                  G_TYPE_NONE, 0);
+  /**
+   * ClutterActor::unrealize:
+   * @actor: the #ClutterActor that received the signal
+   *
+   * The ::unrealize signal is emitted each time an actor is being
+   * unrealized.
+   *
+   *
+   */
+  actor_signals[UNREALIZE] =
+    g_signal_new (I_("unrealize"),
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_LAST,
+                  G_STRUCT_OFFSET (ClutterActorClass, unrealize),
+                  NULL, NULL,
+                  _clutter_marshal_VOID__VOID,
+                  G_TYPE_NONE, 0);
+
+  /**
+   * ClutterActor::allocation-changed:
+   * @actor: the #ClutterActor that emitted the signal
+   * @box: a #ClutterActorBox with the new allocation
+   * @flags: #ClutterAllocationFlags for the allocation
+   *
+   * The ::allocation-changed signal is emitted when the
+   * #ClutterActor:allocation property changes. Usually, application
+   * code should just use the notifications for the :allocation property
+   * but if you want to track the allocation flags as well, for instance
+   * to know whether the absolute origin of @actor changed, then you might
+   * want use this signal instead.
+   *
+   *
+   */
+  actor_signals[ALLOCATION_CHANGED] =
+    g_signal_new (I_("allocation-changed"),
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  _clutter_marshal_VOID__BOXED_FLAGS,
+                  G_TYPE_NONE, 2,
+                  CLUTTER_TYPE_ACTOR_BOX | G_SIGNAL_TYPE_STATIC_SCOPE,
+                  CLUTTER_TYPE_ALLOCATION_FLAGS);
+
+  /**
+   * ClutterActor::transitions-completed:
+   * @actor: a #ClutterActor
+   *
+   * The ::transitions-completed signal is emitted once all transitions
+   * involving @actor are complete.
+   *
+   *
+   */
+  actor_signals[TRANSITIONS_COMPLETED] =
+    g_signal_new (I_("transitions-completed"),
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  _clutter_marshal_VOID__VOID,
+                  G_TYPE_NONE, 0);
+
+  /**
+   * ClutterActor::transition-stopped:
+   * @actor: a #ClutterActor
+   * @name: the name of the transition
+   * @is_finished: whether the transition was finished, or stopped
+   *
+   * The ::transition-stopped signal is emitted once a transition
+   * is stopped; a transition is stopped once it reached its total
+   * duration (including eventual repeats), it has been stopped
+   * using clutter_timeline_stop(), or it has been removed from the
+   * transitions applied on @actor, using clutter_actor_remove_transition().
+   *
+   *
+   */
+  actor_signals[TRANSITION_STOPPED] =
+    g_signal_new (I_("transition-stopped"),
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE |
+                  G_SIGNAL_NO_HOOKS | G_SIGNAL_DETAILED,
+                  0,
+                  NULL, NULL,
+                  _clutter_marshal_VOID__STRING_BOOLEAN,
+                  G_TYPE_NONE, 2,
+                  G_TYPE_STRING,
+                  G_TYPE_BOOLEAN);
+
+  /**
+   * ClutterActor::touch-event:
+   * @actor: a #ClutterActor
+   *
+   * The ::touch-event signal is emitted each time a touch
+   * begin/end/update/cancel event.
+   *
+   *
+   */
+  actor_signals[TOUCH_EVENT] =
+    g_signal_new (I_("touch-event"),
+		  G_TYPE_FROM_CLASS (object_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterActorClass, touch_event),
+		  _clutter_boolean_handled_accumulator, NULL,
+		  _clutter_marshal_BOOLEAN__BOXED,
+		  G_TYPE_BOOLEAN, 1,
+		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+}
+
+static void
+clutter_actor_init (ClutterActor *self)
+{
+  ClutterActorPrivate *priv;
+
+  self->priv = priv = CLUTTER_ACTOR_GET_PRIVATE (self);
+
+  _clutter_memory_account (CLUTTER_MEMORY_ACTORS,
+                           sizeof (ClutterActorPrivate),
+                           1);
+
+  priv->id = _clutter_context_acquire_id (self);
+  priv->pick_id = -1;
+  priv->pick_index_handle = -1;
+  priv->queue_redraw_entry = -1;
+
+  priv->opacity = 255;
+
+  CLUTTER_ACTOR_SET_FLAGS (self, CLUTTER_ACTOR_VISIBLE);
+
+  priv->needs_width_request = TRUE;
+  priv->needs_height_request = TRUE;
+  priv->needs_allocation = TRUE;
+  priv->needs_paint_volume_update = TRUE;
+  paint_bounds_init_empty (&priv->parent_bounds);
+
+
+  priv->opacity_override = -1;
+  priv->enable_model_view_transform = TRUE;
+
+  /* Initialize an empty paint volume to start with */
+  _clutter_paint_volume_init_static (&priv->last_paint_volume, NULL);
+  priv->last_paint_volume_valid = TRUE;
+
+  priv->transform_valid = FALSE;
+
+  /* the default is to stretch the content, to match the
+   * current behaviour of basically all actors. also, it's
+   * the easiest thing to compute.
+   */
+  priv->content_gravity = CLUTTER_CONTENT_GRAVITY_RESIZE_FILL;
+  priv->min_filter = CLUTTER_SCALING_FILTER_LINEAR;
+  priv->mag_filter = CLUTTER_SCALING_FILTER_LINEAR;
+
+  /* this flag will be set to TRUE if the actor gets a child
+   * or if the [xy]-expand flags are explicitly set; until
+   * then, the actor does not need to expand.
+   *
+   * this also allows us to avoid computing the expand flag
+   * when building up a scene.
+   */
+  priv->needs_compute_expand = FALSE;
+
+  clutter_actor_save_easing_state (self);
+  clutter_actor_set_easing_duration (self, 0);
+}
+
+/**
+ * clutter_actor_new:
+ *
+ * Creates a new #ClutterActor.
+ *
+ * A newly created actor has a floating reference, which will be sunk
+ * when it is added to another actor.
+ *
+ * Return value: the newly created #ClutterActor
+ *
+ *
+ */
+ClutterActor *
+clutter_actor_new (void)
+{
+  return g_object_new (CLUTTER_TYPE_ACTOR, NULL);
+}
+
+/**
+ * clutter_actor_destroy:
+ * @self: a #ClutterActor
+ *
+ * Destroys an actor.  When an actor is destroyed, it will break any
+ * references it holds to other objects.  If the actor is inside a
+ * container, the actor will be removed.
+ *
+ * When you destroy a container, its children will be destroyed as well.
+ *
+ * Note: you cannot destroy the #ClutterStage returned by
+ * clutter_stage_get_default().
+ */
+void
+clutter_actor_destroy (ClutterActor *self)
+{
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  g_object_ref (self);
+
+  /* avoid recursion while destroying */
+  if (!CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    {
+      CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IN_DESTRUCTION);
+
+      g_object_run_dispose (G_OBJECT (self));
+
+      CLUTTER_UNSET_PRIVATE_FLAGS (self, CLUTTER_IN_DESTRUCTION);
+    }
+
+  g_object_unref (self);
+}
+
+void
+_clutter_actor_finish_queue_redraw (ClutterActor *self,
+                                    ClutterPaintVolume *clip)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterPaintVolume *pv;
+  gboolean clipped;
+
+  /* Remove queue entry early in the process, otherwise a new
+     queue_redraw() during signal handling could put back this
+     object in the stage redraw list (but the entry is freed as
+     soon as we return from this function, causing a segfault
+     later)
+  */
+  priv->queue_redraw_entry = -1;
+
+  /* the transitions evaluated on paint have queued this redraw; we
+   * update their values now, so that the clip covers the position
+   * at which the actor is going to be painted
+   */
+  if (priv->paint_transitions != NULL)
+    {
+      guint i;
+
+      for (i = 0; i < priv->paint_transitions->len; i++)
+        _clutter_property_transition_update_paint_value (g_ptr_array_index (priv->paint_transitions, i),
+                                                         self);
+    }
+
+  /* If we've been explicitly passed a clip volume then there's
+   * nothing more to calculate, but otherwise the only thing we know
+   * is that the change is constrained to the given actor.
+   *
+   * The idea is that if we know the paint volume for where the actor
+   * was last drawn (in eye coordinates) and we also have the paint
+   * volume for where it will be drawn next (in actor coordinates)
+   * then if we queue a redraw for both these volumes that will cover
+   * everything that needs to be redrawn to clear the old view and
+   * show the latest view of the actor.
+   *
+   * Don't clip this redraw if we don't know what position we had for
+   * the previous redraw since we don't know where to set the clip so
+   * it will clear the actor as it is currently.
+   */
+  if (clip)
+    {
+      _clutter_actor_set_queue_redraw_clip (self, clip);
+      clipped = TRUE;
+    }
+  else if (G_LIKELY (priv->last_paint_volume_valid))
+    {
+      pv = _clutter_actor_get_paint_volume_mutable (self);
+      if (pv)
+        {
+          ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+
+          /* make sure we redraw the actors old position... */
+          _clutter_actor_set_queue_redraw_clip (stage,
+                                                &priv->last_paint_volume);
+          _clutter_actor_signal_queue_redraw (stage, stage);
+          _clutter_actor_set_queue_redraw_clip (stage, NULL);
+
+          /* XXX: Ideally the redraw signal would take a clip volume
+           * argument, but that would be an ABI break. Until we can
+           * break the ABI we pass the argument out-of-band
+           */
+
+          /* setup the clip for the actors new position... */
+          _clutter_actor_set_queue_redraw_clip (self, pv);
+          clipped = TRUE;
+        }
+      else
+        clipped = FALSE;
+    }
+  else
+    clipped = FALSE;
+
+  _clutter_actor_signal_queue_redraw (self, self);
+
+  /* Just in case anyone is manually firing redraw signals without
+   * using the public queue_redraw() API we are careful to ensure that
+   * our out-of-band clip member is cleared before returning...
+   *
+   * Note: A NULL clip denotes a full-stage, un-clipped redraw
    */
-  actor_signals[KEY_PRESS_EVENT] =
-    g_signal_new (I_("key-press-event"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterActorClass, key_press_event),
-		  _clutter_boolean_handled_accumulator, NULL,
-		  _clutter_marshal_BOOLEAN__BOXED,
-		  G_TYPE_BOOLEAN, 1,
-		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
-  /**
-   * ClutterActor::key-release-event:
-   * @actor: the actor which received the event
-   * @event: (type ClutterKeyEvent): a #ClutterKeyEvent
+  if (G_LIKELY (clipped))
+    _clutter_actor_set_queue_redraw_clip (self, NULL);
+}
+
+static void
+_clutter_actor_get_allocation_clip (ClutterActor *self,
+                                    ClutterActorBox *clip)
+{
+  ClutterActorBox allocation;
+
+  /* XXX: we don't care if we get an out of date allocation here
+   * because clutter_actor_queue_redraw_with_clip knows to ignore
+   * the clip if the actor's allocation is invalid.
    *
-   * The ::key-release-event signal is emitted each time a keyboard button
-   * is released while @actor has key focus (see
-   * clutter_stage_set_key_focus()).
+   * This is noted because clutter_actor_get_allocation_box does some
+   * unnecessary work to support buggy code with a comment suggesting
+   * that it could be changed later which would be good for this use
+   * case!
+   */
+  clutter_actor_get_allocation_box (self, &allocation);
+
+  /* NB: clutter_actor_queue_redraw_with_clip expects a box in the
+   * actor's own coordinate space but the allocation is in parent
+   * coordinates */
+  clip->x1 = 0;
+  clip->y1 = 0;
+  clip->x2 = allocation.x2 - allocation.x1;
+  clip->y2 = allocation.y2 - allocation.y1;
+}
+
+void
+_clutter_actor_queue_redraw_full (ClutterActor       *self,
+                                  ClutterRedrawFlags  flags,
+                                  ClutterPaintVolume *volume,
+                                  ClutterEffect      *effect)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterPaintVolume allocation_pv;
+  ClutterPaintVolume *pv;
+  gboolean should_free_pv;
+  ClutterActor *stage;
+
+  /* Here's an outline of the actor queue redraw mechanism:
    *
-   * Return value: %TRUE if the event has been handled by the actor,
-   *   or %FALSE to continue the emission.
+   * The process starts in one of the following two functions which
+   * are wrappers for this function:
    *
+   *   clutter_actor_queue_redraw()
+   *   _clutter_actor_queue_redraw_with_clip()
    *
-   */
-  actor_signals[KEY_RELEASE_EVENT] =
-    g_signal_new (I_("key-release-event"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterActorClass, key_release_event),
-		  _clutter_boolean_handled_accumulator, NULL,
-		  _clutter_marshal_BOOLEAN__BOXED,
-		  G_TYPE_BOOLEAN, 1,
-		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
-  /**
-   * ClutterActor::motion-event:
-   * @actor: the actor which received the event
-   * @event: (type ClutterMotionEvent): a #ClutterMotionEvent
+   * additionally, an effect can queue a redraw by wrapping this
+   * function in clutter_effect_queue_repaint().
    *
-   * The ::motion-event signal is emitted each time the mouse pointer is
-   * moved over @actor.
+   * This functions queues an entry in a list associated with the
+   * stage which is a list of actors that queued a redraw while
+   * updating the timelines, performing layouting and processing other
+   * mainloop sources before the next paint starts.
    *
-   * Return value: %TRUE if the event has been handled by the actor,
-   *   or %FALSE to continue the emission.
+   * We aim to minimize the processing done at this point because
+   * there is a good chance other events will happen while updating
+   * the scenegraph that would invalidate any expensive work we might
+   * otherwise try to do here. For example we don't try and resolve
+   * the screen space bounding box of an actor at this stage so as to
+   * minimize how much of the screen redraw because it's possible
+   * something else will happen which will force a full redraw anyway.
+   *
+   * When all updates are complete and we come to paint the stage then
+   * we iterate this list and actually emit the "queue-redraw" signals
+   * for each of the listed actors which will bubble up to the stage
+   * for each actor and at that point we will transform the actors
+   * paint volume into screen coordinates to determine the clip region
+   * for what needs to be redrawn in the next paint.
+   *
+   * Besides minimizing redundant work another reason for this
+   * deferred design is that it's more likely we will be able to
+   * determine the paint volume of an actor once we've finished
+   * updating the scenegraph because its allocation should be up to
+   * date. NB: If we can't determine an actors paint volume then we
+   * can't automatically queue a clipped redraw which can make a big
+   * difference to performance.
+   *
+   * So the control flow goes like this:
+   * One of clutter_actor_queue_redraw(),
+   *        _clutter_actor_queue_redraw_with_clip(),
+   *     or clutter_effect_queue_repaint()
+   *
+   * then control moves to:
+   *   _clutter_stage_queue_actor_redraw()
+   *
+   * later during _clutter_stage_do_update(), once relayouting is done
+   * and the scenegraph has been updated we will call:
+   * _clutter_stage_finish_queue_redraws().
+   *
+   * _clutter_stage_finish_queue_redraws() will call
+   * _clutter_actor_finish_queue_redraw() for each listed actor.
    *
+   * Note: actors *are* allowed to queue further redraws during this
+   * process (considering clone actors or texture_new_from_actor which
+   * respond to their source queueing a redraw by queuing a redraw
+   * themselves). We repeat the process until the list is empty.
+   *
+   * This will result in the "queue-redraw" signal being fired for
+   * each actor which will pass control to the default signal handler:
+   * clutter_actor_real_queue_redraw()
    *
+   * This will bubble up to the stages handler:
+   * clutter_stage_real_queue_redraw()
+   *
+   * clutter_stage_real_queue_redraw() will transform the actors paint
+   * volume into screen space and add it as a clip region for the next
+   * paint.
    */
-  actor_signals[MOTION_EVENT] =
-    g_signal_new (I_("motion-event"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterActorClass, motion_event),
-		  _clutter_boolean_handled_accumulator, NULL,
-		  _clutter_marshal_BOOLEAN__BOXED,
-		  G_TYPE_BOOLEAN, 1,
-		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
 
-  /**
-   * ClutterActor::key-focus-in:
-   * @actor: the actor which now has key focus
-   *
-   * The ::key-focus-in signal is emitted when @actor receives key focus.
-   *
-   *
-   */
-  actor_signals[KEY_FOCUS_IN] =
-    g_signal_new (I_("key-focus-in"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterActorClass, key_focus_in),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__VOID,
-		  G_TYPE_NONE, 0);
+  /* the render tree of the actor is built again on the next paint;
+   * we do this before checking whether the redraw can be ignored,
+   * since the state of the actor has changed regardless. effects
+   * queueing a repaint do not change what the actor itself paints
+   */
+  if (effect == NULL)
+    clutter_actor_invalidate_paint_node (self);
+
+  /* whatever changed might change the paint volume as well, including
+   * the parameters of an effect
+   */
+  clutter_actor_queue_paint_volume_update (self);
+
+  /* ignore queueing a redraw for actors being destroyed */
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return;
+
+  /* we can ignore unmapped actors, unless they have at least one
+   * mapped clone or they are inside a cloned branch of the scene
+   * graph, as unmapped actors will simply be left unpainted.
+   *
+   * this allows us to ignore redraws queued on leaf nodes when one
+   * of their parents has been hidden
+   */
+  if (!CLUTTER_ACTOR_IS_MAPPED (self) &&
+      self->priv->in_cloned_branch == 0 &&
+      !clutter_actor_has_mapped_clones (self))
+    {
+      CLUTTER_NOTE (PAINT,
+                    "Skipping queue_redraw('%s'): mapped=%s, "
+                    "mapped_clones=%s, "
+                    "in_cloned_branch=%s\n",
+                    _clutter_actor_get_debug_name (self),
+                    CLUTTER_ACTOR_IS_MAPPED (self) ? "yes" : "no",
+                    clutter_actor_has_mapped_clones (self) ? "yes" : "no",
+                    self->priv->in_cloned_branch != 0 ? "yes" : "no");
+      return;
+    }
+
+  /* given the check above we could end up queueing a redraw on an
+   * unmapped actor with mapped clones, so we cannot assume that
+   * get_stage() will return a Stage
+   */
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL)
+    return;
+
+  /* ignore queueing a redraw on stages that are being destroyed */
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
+    return;
+
+  if (CLUTTER_REDRAW_CAUSES_ENABLED ())
+    _clutter_redraw_cause_record (self, FALSE);
+
+  /* actors that override the pick might change their silhouette
+   * without changing any of the state that the stage tracks
+   */
+  if (CLUTTER_ACTOR_IS_MAPPED (self) &&
+      !CLUTTER_ACTOR_IS_TOPLEVEL (self) &&
+      clutter_actor_has_custom_pick (self))
+    _clutter_stage_invalidate_pick (CLUTTER_STAGE (stage),
+                                    CLUTTER_ACTOR_AFFECTS_REACTIVE_PICK (self));
+
+  if (flags & CLUTTER_REDRAW_CLIPPED_TO_ALLOCATION)
+    {
+      ClutterActorBox allocation_clip;
+      ClutterVertex origin;
+
+      /* If the actor doesn't have a valid allocation then we will
+       * queue a full stage redraw. */
+      if (priv->needs_allocation)
+        {
+          /* NB: NULL denotes an undefined clip which will result in a
+           * full redraw... */
+          _clutter_actor_set_queue_redraw_clip (self, NULL);
+          _clutter_actor_signal_queue_redraw (self, self);
+          return;
+        }
+
+      _clutter_paint_volume_init_static (&allocation_pv, self);
+      pv = &allocation_pv;
+
+      _clutter_actor_get_allocation_clip (self, &allocation_clip);
+
+      origin.x = allocation_clip.x1;
+      origin.y = allocation_clip.y1;
+      origin.z = 0;
+      clutter_paint_volume_set_origin (pv, &origin);
+      clutter_paint_volume_set_width (pv,
+                                      allocation_clip.x2 - allocation_clip.x1);
+      clutter_paint_volume_set_height (pv,
+                                       allocation_clip.y2 -
+                                       allocation_clip.y1);
+      should_free_pv = TRUE;
+    }
+  else
+    {
+      pv = volume;
+      should_free_pv = FALSE;
+    }
+
+  self->priv->queue_redraw_entry =
+    _clutter_stage_queue_actor_redraw (CLUTTER_STAGE (stage),
+                                       priv->queue_redraw_entry,
+                                       self,
+                                       pv);
+
+  if (should_free_pv)
+    clutter_paint_volume_free (pv);
+
+  /* If this is the first redraw queued then we can directly use the
+     effect parameter */
+  if (!priv->is_dirty)
+    priv->effect_to_redraw = effect;
+  /* Otherwise we need to merge it with the existing effect parameter */
+  else if (effect != NULL)
+    {
+      /* If there's already an effect then we need to use whichever is
+         later in the chain of actors. Otherwise a full redraw has
+         already been queued on the actor so we need to ignore the
+         effect parameter */
+      if (priv->effect_to_redraw != NULL)
+        {
+          if (priv->effects == NULL)
+            g_warning ("Redraw queued with an effect that is "
+                       "not applied to the actor");
+          else
+            {
+              const GList *l;
+
+              for (l = _clutter_meta_group_peek_metas (priv->effects);
+                   l != NULL;
+                   l = l->next)
+                {
+                  if (l->data == priv->effect_to_redraw ||
+                      l->data == effect)
+                    priv->effect_to_redraw = l->data;
+                }
+            }
+        }
+    }
+  else
+    {
+      /* If no effect is specified then we need to redraw the whole
+         actor */
+      priv->effect_to_redraw = NULL;
+    }
+
+  priv->is_dirty = TRUE;
+
+  /* the contents of the actor are the same after a transformation change */
+  if (!(flags & CLUTTER_REDRAW_TRANSFORM_ONLY))
+    priv->is_damaged = TRUE;
+}
+
+/* queues a redraw of @self after a change of its transformation */
+static inline void
+clutter_actor_queue_transform_redraw (ClutterActor *self)
+{
+  _clutter_actor_queue_redraw_full (self,
+                                    CLUTTER_REDRAW_TRANSFORM_ONLY,
+                                    NULL, /* clip volume */
+                                    NULL /* effect */);
+}
+
+/*< private >
+ * _clutter_actor_is_damaged:
+ * @self: a #ClutterActor
+ *
+ * Checks whether the contents of @self, of any of its children or of
+ * its effects have changed since the last time @self was painted.
+ * Changes that only affect the transformation of @self do not damage it.
+ *
+ * Return value: %TRUE if the actor has been damaged
+ */
+gboolean
+_clutter_actor_is_damaged (ClutterActor *self)
+{
+  return self->priv->is_damaged;
+}
+
+/*< private >
+ * _clutter_actor_skip_children_pick_index:
+ * @self: a #ClutterActor
+ *
+ * Notifies the stage that the children of @self are not going to be
+ * painted in the current frame, for instance because @self has been
+ * culled or because an effect is painting its cached image; the
+ * entries of the children inside the pick index of the stage are
+ * not updated, so the pick index cannot be used until the next full
+ * paint of the stage.
+ */
+void
+_clutter_actor_skip_children_pick_index (ClutterActor *self)
+{
+  ClutterActor *stage;
+
+  if (self->priv->n_children == 0 ||
+      in_clone_paint () ||
+      _clutter_context_get_pick_mode () != CLUTTER_PICK_NONE)
+    return;
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage != NULL)
+    _clutter_stage_invalidate_pick_index (CLUTTER_STAGE (stage));
+}
+
+/*< private >
+ * _clutter_actor_peek_next_effects:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the effects that still have to be run by the paint
+ * sequence of @self; this function should only be called from the
+ * implementation of a #ClutterEffect, while @self is being painted.
+ *
+ * Return value: (transfer none) (element-type Clutter.Effect): the
+ *   list of effects following the current one, including the ones
+ *   that are disabled
+ */
+const GList *
+_clutter_actor_peek_next_effects (ClutterActor *self)
+{
+  return self->priv->next_effect_to_paint;
+}
+
+/*< private >
+ * _clutter_actor_get_flatten_effect:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the internal effect used to redirect @self offscreen,
+ * if @self is currently redirected; see the #ClutterActor:offscreen-redirect
+ * property.
+ *
+ * Return value: (transfer none): the effect, or %NULL
+ */
+ClutterEffect *
+_clutter_actor_get_flatten_effect (ClutterActor *self)
+{
+  return self->priv->flatten_effect;
+}
+
+/**
+ * clutter_actor_queue_redraw:
+ * @self: A #ClutterActor
+ *
+ * Queues up a redraw of an actor and any children. The redraw occurs
+ * once the main loop becomes idle (after the current batch of events
+ * has been processed, roughly).
+ *
+ * Applications rarely need to call this, as redraws are handled
+ * automatically by modification functions.
+ *
+ * This function will not do anything if @self is not visible, or
+ * if the actor is inside an invisible part of the scenegraph.
+ *
+ * Also be aware that painting is a NOP for actors with an opacity of
+ * 0
+ *
+ * When you are implementing a custom actor you must queue a redraw
+ * whenever some private state changes that will affect painting or
+ * picking of your actor.
+ */
+void
+clutter_actor_queue_redraw (ClutterActor *self)
+{
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  _clutter_actor_queue_redraw_full (self,
+                                    0, /* flags */
+                                    NULL, /* clip volume */
+                                    NULL /* effect */);
+}
+
+/*< private >
+ * _clutter_actor_queue_redraw_with_clip:
+ * @self: A #ClutterActor
+ * @flags: A mask of #ClutterRedrawFlags controlling the behaviour of
+ *   this queue redraw.
+ * @volume: A #ClutterPaintVolume describing the bounds of what needs to be
+ *   redrawn or %NULL if you are just using a @flag to state your
+ *   desired clipping.
+ *
+ * Queues up a clipped redraw of an actor and any children. The redraw
+ * occurs once the main loop becomes idle (after the current batch of
+ * events has been processed, roughly).
+ *
+ * If no flags are given the clip volume is defined by @volume
+ * specified in actor coordinates and tells Clutter that only content
+ * within this volume has been changed so Clutter can optionally
+ * optimize the redraw.
+ *
+ * If the %CLUTTER_REDRAW_CLIPPED_TO_ALLOCATION @flag is used, @volume
+ * should be %NULL and this tells Clutter to use the actor's current
+ * allocation as a clip box. This flag can only be used for 2D actors,
+ * because any actor with depth may be projected outside its
+ * allocation.
+ *
+ * Applications rarely need to call this, as redraws are handled
+ * automatically by modification functions.
+ *
+ * This function will not do anything if @self is not visible, or if
+ * the actor is inside an invisible part of the scenegraph.
+ *
+ * Also be aware that painting is a NOP for actors with an opacity of
+ * 0
+ *
+ * When you are implementing a custom actor you must queue a redraw
+ * whenever some private state changes that will affect painting or
+ * picking of your actor.
+ */
+void
+_clutter_actor_queue_redraw_with_clip (ClutterActor       *self,
+                                       ClutterRedrawFlags  flags,
+                                       ClutterPaintVolume *volume)
+{
+  _clutter_actor_queue_redraw_full (self,
+                                    flags, /* flags */
+                                    volume, /* clip volume */
+                                    NULL /* effect */);
+}
+
+void
+_clutter_actor_queue_only_relayout (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return;
+
+  if (priv->needs_width_request &&
+      priv->needs_height_request &&
+      priv->needs_allocation)
+    return; /* save some cpu cycles */
+
+#if CLUTTER_ENABLE_DEBUG
+  if (!CLUTTER_ACTOR_IS_TOPLEVEL (self) && CLUTTER_ACTOR_IN_RELAYOUT (self))
+    {
+      g_warning ("The actor '%s' is currently inside an allocation "
+                 "cycle; calling clutter_actor_queue_relayout() is "
+                 "not recommended",
+                 _clutter_actor_get_debug_name (self));
+    }
+#endif /* CLUTTER_ENABLE_DEBUG */
+
+  _clutter_actor_queue_relayout_on_clones (self);
+
+  g_signal_emit (self, actor_signals[QUEUE_RELAYOUT], 0);
+}
+
+/**
+ * clutter_actor_queue_redraw_with_clip:
+ * @self: a #ClutterActor
+ * @clip: (allow-none): a rectangular clip region, or %NULL
+ *
+ * Queues a redraw on @self limited to a specific, actor-relative
+ * rectangular area.
+ *
+ * If @clip is %NULL this function is equivalent to
+ * clutter_actor_queue_redraw().
+ *
+ *
+ */
+void
+clutter_actor_queue_redraw_with_clip (ClutterActor                *self,
+                                      const cairo_rectangle_int_t *clip)
+{
+  ClutterPaintVolume volume;
+  ClutterVertex origin;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  if (clip == NULL)
+    {
+      clutter_actor_queue_redraw (self);
+      return;
+    }
+
+  _clutter_paint_volume_init_static (&volume, self);
+
+  origin.x = clip->x;
+  origin.y = clip->y;
+  origin.z = 0.0f;
+
+  clutter_paint_volume_set_origin (&volume, &origin);
+  clutter_paint_volume_set_width (&volume, clip->width);
+  clutter_paint_volume_set_height (&volume, clip->height);
+
+  _clutter_actor_queue_redraw_full (self, 0, &volume, NULL);
+
+  clutter_paint_volume_free (&volume);
+}
+
+/**
+ * clutter_actor_queue_relayout:
+ * @self: A #ClutterActor
+ *
+ * Indicates that the actor's size request or other layout-affecting
+ * properties may have changed. This function is used inside #ClutterActor
+ * subclass implementations, not by applications directly.
+ *
+ * Queueing a new layout automatically queues a redraw as well.
+ *
+ *
+ */
+void
+clutter_actor_queue_relayout (ClutterActor *self)
+{
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  if (CLUTTER_REDRAW_CAUSES_ENABLED ())
+    _clutter_redraw_cause_record (self, TRUE);
+
+  _clutter_actor_queue_only_relayout (self);
+  clutter_actor_queue_redraw (self);
+}
+
+/* checks whether the cached size requests of @self would still be the
+ * same if they were computed again. an empty cache means that we do not
+ * know which requests the parent of @self made, and a full cache means
+ * that some of them might have been evicted
+ */
+static gboolean
+clutter_actor_cached_requests_unchanged (ClutterActor *self,
+                                         SizeRequest  *requests,
+                                         gboolean      is_width)
+{
+  guint i, n_cached = 0;
+
+  for (i = 0; i < N_CACHED_SIZE_REQUESTS; i++)
+    {
+      const SizeRequest *sr = &requests[i];
+      gfloat min_size, natural_size;
+
+      if (sr->age == 0)
+        continue;
+
+      if (is_width)
+        clutter_actor_compute_preferred_width (self, sr->for_size,
+                                               &min_size,
+                                               &natural_size);
+      else
+        clutter_actor_compute_preferred_height (self, sr->for_size,
+                                                &min_size,
+                                                &natural_size);
+
+      if (min_size != sr->min_size || natural_size != sr->natural_size)
+        return FALSE;
+
+      n_cached += 1;
+    }
+
+  return n_cached > 0 && n_cached < N_CACHED_SIZE_REQUESTS;
+}
+
+/*< private >
+ * _clutter_actor_queue_size_relayout:
+ * @self: a #ClutterActor
+ *
+ * Queues a relayout of @self for a change that can only affect its
+ * size requests and its own allocation, like a change in the text of
+ * a #ClutterText.
+ *
+ * If the #ClutterStage of @self uses incremental relayouts, the size
+ * requests of @self will be checked before the next allocation cycle;
+ * if they did not change, only @self will be allocated again, instead
+ * of all of its ancestors. Otherwise, this function is equivalent to
+ * clutter_actor_queue_relayout().
+ */
+void
+_clutter_actor_queue_size_relayout (ClutterActor *self)
+{
+  ClutterActor *stage;
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL ||
+      CLUTTER_ACTOR_IS_TOPLEVEL (self) ||
+      self->priv->needs_allocation ||
+      !clutter_stage_get_incremental_relayout (CLUTTER_STAGE (stage)))
+    {
+      clutter_actor_queue_relayout (self);
+      return;
+    }
+
+  _clutter_stage_queue_size_relayout (CLUTTER_STAGE (stage), self);
+  clutter_actor_queue_redraw (self);
+}
+
+/*< private >
+ * _clutter_actor_check_size_relayout:
+ * @self: a #ClutterActor
+ *
+ * Checks whether the size requests of @self, queued through
+ * _clutter_actor_queue_size_relayout(), changed; if they did, a
+ * relayout of @self and its ancestors is queued.
+ *
+ * Return value: %TRUE if @self should be allocated again in place
+ *   using _clutter_actor_reallocate()
+ */
+gboolean
+_clutter_actor_check_size_relayout (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return FALSE;
+
+  /* a full relayout has been queued in the meantime */
+  if (priv->needs_allocation)
+    return FALSE;
+
+  if ((!(priv->min_width_set && priv->natural_width_set) &&
+       (priv->needs_width_request ||
+        priv->size_requests == NULL ||
+        !clutter_actor_cached_requests_unchanged (self,
+                                                  priv->size_requests->width_requests,
+                                                  TRUE))) ||
+      (!(priv->min_height_set && priv->natural_height_set) &&
+       (priv->needs_height_request ||
+        priv->size_requests == NULL ||
+        !clutter_actor_cached_requests_unchanged (self,
+                                                  priv->size_requests->height_requests,
+                                                  FALSE))))
+    {
+      CLUTTER_NOTE (LAYOUT, "Size requests of '%s' changed, queueing "
+                    "a relayout",
+                    _clutter_actor_get_debug_name (self));
+
+      _clutter_actor_queue_only_relayout (self);
+      return FALSE;
+    }
+
+  priv->needs_allocation = TRUE;
+
+  return TRUE;
+}
+
+/*< private >
+ * _clutter_actor_reallocate:
+ * @self: a #ClutterActor
+ *
+ * Allocates @self again using its current allocation, if it still
+ * needs an allocation.
+ */
+void
+_clutter_actor_reallocate (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self) || !priv->needs_allocation)
+    return;
+
+  if (_clutter_actor_get_stage_internal (self) == NULL)
+    return;
+
+  CLUTTER_NOTE (LAYOUT, "Reallocating '%s' in place",
+                _clutter_actor_get_debug_name (self));
+
+  clutter_actor_allocate_internal (self, &priv->allocation,
+                                   priv->allocation_flags &
+                                   ~CLUTTER_ABSOLUTE_ORIGIN_CHANGED);
+}
+
+/**
+ * clutter_actor_get_preferred_size:
+ * @self: a #ClutterActor
+ * @min_width_p: (out) (allow-none): return location for the minimum
+ *   width, or %NULL
+ * @min_height_p: (out) (allow-none): return location for the minimum
+ *   height, or %NULL
+ * @natural_width_p: (out) (allow-none): return location for the natural
+ *   width, or %NULL
+ * @natural_height_p: (out) (allow-none): return location for the natural
+ *   height, or %NULL
+ *
+ * Computes the preferred minimum and natural size of an actor, taking into
+ * account the actor's geometry management (either height-for-width
+ * or width-for-height).
+ *
+ * The width and height used to compute the preferred height and preferred
+ * width are the actor's natural ones.
+ *
+ * If you need to control the height for the preferred width, or the width for
+ * the preferred height, you should use clutter_actor_get_preferred_width()
+ * and clutter_actor_get_preferred_height(), and check the actor's preferred
+ * geometry management using the #ClutterActor:request-mode property.
+ *
+ *
+ */
+void
+clutter_actor_get_preferred_size (ClutterActor *self,
+                                  gfloat       *min_width_p,
+                                  gfloat       *min_height_p,
+                                  gfloat       *natural_width_p,
+                                  gfloat       *natural_height_p)
+{
+  ClutterActorPrivate *priv;
+  gfloat min_width, min_height;
+  gfloat natural_width, natural_height;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  priv = self->priv;
+
+  min_width = min_height = 0;
+  natural_width = natural_height = 0;
+
+  if (priv->request_mode == CLUTTER_REQUEST_HEIGHT_FOR_WIDTH)
+    {
+      CLUTTER_NOTE (LAYOUT, "Preferred size (height-for-width)");
+      clutter_actor_get_preferred_width (self, -1,
+                                         &min_width,
+                                         &natural_width);
+      clutter_actor_get_preferred_height (self, natural_width,
+                                          &min_height,
+                                          &natural_height);
+    }
+  else
+    {
+      CLUTTER_NOTE (LAYOUT, "Preferred size (width-for-height)");
+      clutter_actor_get_preferred_height (self, -1,
+                                          &min_height,
+                                          &natural_height);
+      clutter_actor_get_preferred_width (self, natural_height,
+                                         &min_width,
+                                         &natural_width);
+    }
+
+  if (min_width_p)
+    *min_width_p = min_width;
+
+  if (min_height_p)
+    *min_height_p = min_height;
+
+  if (natural_width_p)
+    *natural_width_p = natural_width;
+
+  if (natural_height_p)
+    *natural_height_p = natural_height;
+}
+
+/*< private >
+ * effective_align:
+ * @align: a #ClutterActorAlign
+ * @direction: a #ClutterTextDirection
+ *
+ * Retrieves the correct alignment depending on the text direction
+ *
+ * Return value: the effective alignment
+ */
+static ClutterActorAlign
+effective_align (ClutterActorAlign    align,
+                 ClutterTextDirection direction)
+{
+  ClutterActorAlign res;
+
+  switch (align)
+    {
+    case CLUTTER_ACTOR_ALIGN_START:
+      res = (direction == CLUTTER_TEXT_DIRECTION_RTL)
+          ? CLUTTER_ACTOR_ALIGN_END
+          : CLUTTER_ACTOR_ALIGN_START;
+      break;
+
+    case CLUTTER_ACTOR_ALIGN_END:
+      res = (direction == CLUTTER_TEXT_DIRECTION_RTL)
+          ? CLUTTER_ACTOR_ALIGN_START
+          : CLUTTER_ACTOR_ALIGN_END;
+      break;
+
+    default:
+      res = align;
+      break;
+    }
+
+  return res;
+}
+
+/*< private >
+ * _clutter_actor_get_effective_x_align:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the effective horizontal alignment, taking into
+ * consideration the text direction of @self.
+ *
+ * Return value: the effective horizontal alignment
+ */
+ClutterActorAlign
+_clutter_actor_get_effective_x_align (ClutterActor *self)
+{
+  return effective_align (clutter_actor_get_x_align (self),
+                          clutter_actor_get_text_direction (self));
+}
+
+static inline void
+adjust_for_margin (float  margin_start,
+                   float  margin_end,
+                   float *minimum_size,
+                   float *natural_size,
+                   float *allocated_start,
+                   float *allocated_end)
+{
+  *minimum_size -= (margin_start + margin_end);
+  *natural_size -= (margin_start + margin_end);
+  *allocated_start += margin_start;
+  *allocated_end -= margin_end;
+}
+
+static inline void
+adjust_for_alignment (ClutterActorAlign  alignment,
+                      float              natural_size,
+                      float             *allocated_start,
+                      float             *allocated_end)
+{
+  float allocated_size = *allocated_end - *allocated_start;
+
+  switch (alignment)
+    {
+    case CLUTTER_ACTOR_ALIGN_FILL:
+      /* do nothing */
+      break;
 
-  /**
-   * ClutterActor::key-focus-out:
-   * @actor: the actor which now has key focus
-   *
-   * The ::key-focus-out signal is emitted when @actor loses key focus.
-   *
-   *
-   */
-  actor_signals[KEY_FOCUS_OUT] =
-    g_signal_new (I_("key-focus-out"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterActorClass, key_focus_out),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__VOID,
-		  G_TYPE_NONE, 0);
+    case CLUTTER_ACTOR_ALIGN_START:
+      /* keep start */
+      *allocated_end = *allocated_start + MIN (natural_size, allocated_size);
+      break;
 
-  /**
-   * ClutterActor::enter-event:
-   * @actor: the actor which the pointer has entered.
-   * @event: (type ClutterCrossingEvent): a #ClutterCrossingEvent
-   *
-   * The ::enter-event signal is emitted when the pointer enters the @actor
-   *
-   * Return value: %TRUE if the event has been handled by the actor,
-   *   or %FALSE to continue the emission.
-   *
-   *
-   */
-  actor_signals[ENTER_EVENT] =
-    g_signal_new (I_("enter-event"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterActorClass, enter_event),
-		  _clutter_boolean_handled_accumulator, NULL,
-		  _clutter_marshal_BOOLEAN__BOXED,
-		  G_TYPE_BOOLEAN, 1,
-		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+    case CLUTTER_ACTOR_ALIGN_END:
+      if (allocated_size > natural_size)
+        {
+          *allocated_start += (allocated_size - natural_size);
+          *allocated_end = *allocated_start + natural_size;
+        }
+      break;
 
-  /**
-   * ClutterActor::leave-event:
-   * @actor: the actor which the pointer has left
-   * @event: (type ClutterCrossingEvent): a #ClutterCrossingEvent
-   *
-   * The ::leave-event signal is emitted when the pointer leaves the @actor.
-   *
-   * Return value: %TRUE if the event has been handled by the actor,
-   *   or %FALSE to continue the emission.
-   *
-   *
-   */
-  actor_signals[LEAVE_EVENT] =
-    g_signal_new (I_("leave-event"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterActorClass, leave_event),
-		  _clutter_boolean_handled_accumulator, NULL,
-		  _clutter_marshal_BOOLEAN__BOXED,
-		  G_TYPE_BOOLEAN, 1,
-		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+    case CLUTTER_ACTOR_ALIGN_CENTER:
+      if (allocated_size > natural_size)
+        {
+          *allocated_start += floorf ((allocated_size - natural_size) / 2);
+          *allocated_end = *allocated_start + MIN (allocated_size, natural_size);
+        }
+      break;
+    }
+}
 
-  /**
-   * ClutterActor::captured-event:
-   * @actor: the actor which received the signal
-   * @event: a #ClutterEvent
-   *
-   * The ::captured-event signal is emitted when an event is captured
-   * by Clutter. This signal will be emitted starting from the top-level
-   * container (the #ClutterStage) to the actor which received the event
-   * going down the hierarchy. This signal can be used to intercept every
-   * event before the specialized events (like
-   * ClutterActor::button-press-event or ::key-released-event) are
-   * emitted.
-   *
-   * Return value: %TRUE if the event has been handled by the actor,
-   *   or %FALSE to continue the emission.
-   *
-   *
-   */
-  actor_signals[CAPTURED_EVENT] =
-    g_signal_new (I_("captured-event"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterActorClass, captured_event),
-		  _clutter_boolean_handled_accumulator, NULL,
-		  _clutter_marshal_BOOLEAN__BOXED,
-		  G_TYPE_BOOLEAN, 1,
-		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+/*< private >
+ * clutter_actor_adjust_width:
+ * @self: a #ClutterActor
+ * @minimum_width: (inout): the actor's preferred minimum width, which
+ *   will be adjusted depending on the margin
+ * @natural_width: (inout): the actor's preferred natural width, which
+ *   will be adjusted depending on the margin
+ * @adjusted_x1: (out): the adjusted x1 for the actor's bounding box
+ * @adjusted_x2: (out): the adjusted x2 for the actor's bounding box
+ *
+ * Adjusts the preferred and allocated position and size of an actor,
+ * depending on the margin and alignment properties.
+ */
+static void
+clutter_actor_adjust_width (ClutterActor *self,
+                            gfloat       *minimum_width,
+                            gfloat       *natural_width,
+                            gfloat       *adjusted_x1,
+                            gfloat       *adjusted_x2)
+{
+  ClutterTextDirection text_dir;
+  const ClutterLayoutInfo *info;
 
-  /**
-   * ClutterActor::realize:
-   * @actor: the #ClutterActor that received the signal
-   *
-   * The ::realize signal is emitted each time an actor is being
-   * realized.
-   *
-   *
-   */
-  actor_signals[REALIZE] =
-    g_signal_new (I_("realize"),
-                  G_TYPE_FROM_CLASS (object_class),
-                  G_SIGNAL_RUN_LAST,
-                  G_STRUCT_OFFSET (ClutterActorClass, realize),
-                  NULL, NULL,
-                  _clutter_marshal_VOID__VOID,
-                  G_TYPE_NONE, 0);
-  /**
-   * ClutterActor::unrealize:
-   * @actor: the #ClutterActor that received the signal
-   *
-   * The ::unrealize signal is emitted each time an actor is being
-   * unrealized.
-   *
-   *
-   */
-  actor_signals[UNREALIZE] =
-    g_signal_new (I_("unrealize"),
-                  G_TYPE_FROM_CLASS (object_class),
-                  G_SIGNAL_RUN_LAST,
-                  G_STRUCT_OFFSET (ClutterActorClass, unrealize),
-                  NULL, NULL,
-                  _clutter_marshal_VOID__VOID,
-                  G_TYPE_NONE, 0);
+  info = _clutter_actor_get_layout_info_or_defaults (self);
+  text_dir = clutter_actor_get_text_direction (self);
 
-  /**
-   * ClutterActor::allocation-changed:
-   * @actor: the #ClutterActor that emitted the signal
-   * @box: a #ClutterActorBox with the new allocation
-   * @flags: #ClutterAllocationFlags for the allocation
-   *
-   * The ::allocation-changed signal is emitted when the
-   * #ClutterActor:allocation property changes. Usually, application
-   * code should just use the notifications for the :allocation property
-   * but if you want to track the allocation flags as well, for instance
-   * to know whether the absolute origin of @actor changed, then you might
-   * want use this signal instead.
-   *
-   *
-   */
-  actor_signals[ALLOCATION_CHANGED] =
-    g_signal_new (I_("allocation-changed"),
-                  G_TYPE_FROM_CLASS (object_class),
-                  G_SIGNAL_RUN_LAST,
-                  0,
-                  NULL, NULL,
-                  _clutter_marshal_VOID__BOXED_FLAGS,
-                  G_TYPE_NONE, 2,
-                  CLUTTER_TYPE_ACTOR_BOX | G_SIGNAL_TYPE_STATIC_SCOPE,
-                  CLUTTER_TYPE_ALLOCATION_FLAGS);
+  CLUTTER_NOTE (LAYOUT, "Adjusting allocated X and width");
 
-  /**
-   * ClutterActor::transitions-completed:
-   * @actor: a #ClutterActor
-   *
-   * The ::transitions-completed signal is emitted once all transitions
-   * involving @actor are complete.
-   *
-   *
+  /* this will tweak natural_width to remove the margin, so that
+   * adjust_for_alignment() will use the correct size
    */
-  actor_signals[TRANSITIONS_COMPLETED] =
-    g_signal_new (I_("transitions-completed"),
-                  G_TYPE_FROM_CLASS (object_class),
-                  G_SIGNAL_RUN_LAST,
-                  0,
-                  NULL, NULL,
-                  _clutter_marshal_VOID__VOID,
-                  G_TYPE_NONE, 0);
+  adjust_for_margin (info->margin.left, info->margin.right,
+                     minimum_width, natural_width,
+                     adjusted_x1, adjusted_x2);
+
+  adjust_for_alignment (effective_align (info->x_align, text_dir),
+                        *natural_width,
+                        adjusted_x1, adjusted_x2);
+}
+
+/*< private >
+ * clutter_actor_adjust_height:
+ * @self: a #ClutterActor
+ * @minimum_height: (inout): the actor's preferred minimum height, which
+ *   will be adjusted depending on the margin
+ * @natural_height: (inout): the actor's preferred natural height, which
+ *   will be adjusted depending on the margin
+ * @adjusted_y1: (out): the adjusted y1 for the actor's bounding box
+ * @adjusted_y2: (out): the adjusted y2 for the actor's bounding box
+ *
+ * Adjusts the preferred and allocated position and size of an actor,
+ * depending on the margin and alignment properties.
+ */
+static void
+clutter_actor_adjust_height (ClutterActor *self,
+                             gfloat       *minimum_height,
+                             gfloat       *natural_height,
+                             gfloat       *adjusted_y1,
+                             gfloat       *adjusted_y2)
+{
+  const ClutterLayoutInfo *info;
 
-  /**
-   * ClutterActor::transition-stopped:
-   * @actor: a #ClutterActor
-   * @name: the name of the transition
-   * @is_finished: whether the transition was finished, or stopped
-   *
-   * The ::transition-stopped signal is emitted once a transition
-   * is stopped; a transition is stopped once it reached its total
-   * duration (including eventual repeats), it has been stopped
-   * using clutter_timeline_stop(), or it has been removed from the
-   * transitions applied on @actor, using clutter_actor_remove_transition().
-   *
-   *
+  info = _clutter_actor_get_layout_info_or_defaults (self);
+
+  CLUTTER_NOTE (LAYOUT, "Adjusting allocated Y and height");
+
+  /* this will tweak natural_height to remove the margin, so that
+   * adjust_for_alignment() will use the correct size
    */
-  actor_signals[TRANSITION_STOPPED] =
-    g_signal_new (I_("transition-stopped"),
-                  G_TYPE_FROM_CLASS (object_class),
-                  G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE |
-                  G_SIGNAL_NO_HOOKS | G_SIGNAL_DETAILED,
-                  0,
-                  NULL, NULL,
-                  _clutter_marshal_VOID__STRING_BOOLEAN,
-                  G_TYPE_NONE, 2,
-                  G_TYPE_STRING,
-                  G_TYPE_BOOLEAN);
+  adjust_for_margin (info->margin.top, info->margin.bottom,
+                     minimum_height, natural_height,
+                     adjusted_y1,
+                     adjusted_y2);
 
-  /**
-   * ClutterActor::touch-event:
-   * @actor: a #ClutterActor
-   *
-   * The ::touch-event signal is emitted each time a touch
-   * begin/end/update/cancel event.
-   *
-   *
+  /* we don't use effective_align() here, because text direction
+   * only affects the horizontal axis
    */
-  actor_signals[TOUCH_EVENT] =
-    g_signal_new (I_("touch-event"),
-		  G_TYPE_FROM_CLASS (object_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterActorClass, touch_event),
-		  _clutter_boolean_handled_accumulator, NULL,
-		  _clutter_marshal_BOOLEAN__BOXED,
-		  G_TYPE_BOOLEAN, 1,
-		  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+  adjust_for_alignment (info->y_align,
+                        *natural_height,
+                        adjusted_y1,
+                        adjusted_y2);
+
 }
 
-static void
-clutter_actor_init (ClutterActor *self)
+/* the size request cache is only needed by actors that get asked for
+ * their preferred size, so it is allocated the first time it is used */
+static SizeRequestCache *
+clutter_actor_get_size_requests (ClutterActor *self)
 {
-  ClutterActorPrivate *priv;
+  ClutterActorPrivate *priv = self->priv;
 
-  self->priv = priv = CLUTTER_ACTOR_GET_PRIVATE (self);
+  if (priv->size_requests == NULL)
+    {
+      priv->size_requests = g_slice_new0 (SizeRequestCache);
+      priv->size_requests->cached_width_age = 1;
+      priv->size_requests->cached_height_age = 1;
 
-  priv->id = _clutter_context_acquire_id (self);
-  priv->pick_id = -1;
+      _clutter_memory_account (CLUTTER_MEMORY_ACTORS,
+                               sizeof (SizeRequestCache), 0);
+    }
 
-  priv->opacity = 255;
+  return priv->size_requests;
+}
 
-  CLUTTER_ACTOR_SET_FLAGS (self, CLUTTER_ACTOR_VISIBLE);
+/* looks for a cached size request for this for_size, and marks it as
+ * the most recently used. If not found, returns the least recently used
+ * entry so it can be overwritten */
+static gboolean
+_clutter_actor_get_cached_size_request (gfloat         for_size,
+                                        SizeRequest   *cached_size_requests,
+                                        guint         *cached_age,
+                                        SizeRequest  **result)
+{
+  guint i;
 
-  priv->needs_width_request = TRUE;
-  priv->needs_height_request = TRUE;
-  priv->needs_allocation = TRUE;
+  CLUTTER_STATIC_COUNTER (size_cache_hit_counter,
+                          "Size request cache hit counter",
+                          "Increments for each size request cache hit",
+                          0);
+  CLUTTER_STATIC_COUNTER (size_cache_miss_counter,
+                          "Size request cache miss counter",
+                          "Increments for each size request cache miss",
+                          0);
 
-  priv->cached_width_age = 1;
-  priv->cached_height_age = 1;
+  *result = &cached_size_requests[0];
 
-  priv->opacity_override = -1;
-  priv->enable_model_view_transform = TRUE;
+  for (i = 0; i < N_CACHED_SIZE_REQUESTS; i++)
+    {
+      SizeRequest *sr;
 
-  /* Initialize an empty paint volume to start with */
-  _clutter_paint_volume_init_static (&priv->last_paint_volume, NULL);
-  priv->last_paint_volume_valid = TRUE;
+      sr = &cached_size_requests[i];
 
-  priv->transform_valid = FALSE;
+      if (sr->age > 0 &&
+          sr->for_size == for_size)
+        {
+          CLUTTER_NOTE (LAYOUT, "Size cache hit for size: %.2f", for_size);
+          CLUTTER_COUNTER_INC (_clutter_uprof_context, size_cache_hit_counter);
 
-  /* the default is to stretch the content, to match the
-   * current behaviour of basically all actors. also, it's
-   * the easiest thing to compute.
-   */
-  priv->content_gravity = CLUTTER_CONTENT_GRAVITY_RESIZE_FILL;
-  priv->min_filter = CLUTTER_SCALING_FILTER_LINEAR;
-  priv->mag_filter = CLUTTER_SCALING_FILTER_LINEAR;
+          sr->age = *cached_age;
+          *cached_age += 1;
 
-  /* this flag will be set to TRUE if the actor gets a child
-   * or if the [xy]-expand flags are explicitly set; until
-   * then, the actor does not need to expand.
-   *
-   * this also allows us to avoid computing the expand flag
-   * when building up a scene.
+          *result = sr;
+          return TRUE;
+        }
+      else if (sr->age < (*result)->age)
+        {
+          *result = sr;
+        }
+    }
+
+  CLUTTER_NOTE (LAYOUT, "Size cache miss for size: %.2f", for_size);
+  CLUTTER_COUNTER_INC (_clutter_uprof_context, size_cache_miss_counter);
+
+  return FALSE;
+}
+
+/* computes the width request of @self, including the margins, without
+ * going through the cache
+ */
+static void
+clutter_actor_compute_preferred_width (ClutterActor *self,
+                                       gfloat        for_height,
+                                       gfloat       *min_width_p,
+                                       gfloat       *natural_width_p)
+{
+  const ClutterLayoutInfo *info;
+  gfloat minimum_width, natural_width;
+  ClutterActorClass *klass;
+
+  info = _clutter_actor_get_layout_info_or_defaults (self);
+
+  minimum_width = natural_width = 0;
+
+  /* adjust for the margin */
+  if (for_height >= 0)
+    {
+      for_height -= (info->margin.top + info->margin.bottom);
+      if (for_height < 0)
+        for_height = 0;
+    }
+
+  CLUTTER_NOTE (LAYOUT, "Width request for %.2f px", for_height);
+
+  if (CLUTTER_ACTOR_COST_ENABLED ())
+    _clutter_actor_cost_begin (self, CLUTTER_ACTOR_COST_SIZE_REQUEST);
+
+  klass = CLUTTER_ACTOR_GET_CLASS (self);
+  klass->get_preferred_width (self, for_height,
+                              &minimum_width,
+                              &natural_width);
+
+  if (CLUTTER_ACTOR_COST_ENABLED ())
+    _clutter_actor_cost_end ();
+
+  /* adjust for the margin */
+  minimum_width += (info->margin.left + info->margin.right);
+  natural_width += (info->margin.left + info->margin.right);
+
+  /* Due to accumulated float errors, it's better not to warn
+   * on this, but just fix it.
    */
-  priv->needs_compute_expand = FALSE;
+  if (natural_width < minimum_width)
+    natural_width = minimum_width;
 
-  clutter_actor_save_easing_state (self);
-  clutter_actor_set_easing_duration (self, 0);
+  *min_width_p = minimum_width;
+  *natural_width_p = natural_width;
 }
 
-/**
- * clutter_actor_new:
- *
- * Creates a new #ClutterActor.
- *
- * A newly created actor has a floating reference, which will be sunk
- * when it is added to another actor.
- *
- * Return value: the newly created #ClutterActor
- *
- *
+/* computes the height request of @self, including the margins, without
+ * going through the cache
  */
-ClutterActor *
-clutter_actor_new (void)
+static void
+clutter_actor_compute_preferred_height (ClutterActor *self,
+                                        gfloat        for_width,
+                                        gfloat       *min_height_p,
+                                        gfloat       *natural_height_p)
 {
-  return g_object_new (CLUTTER_TYPE_ACTOR, NULL);
+  const ClutterLayoutInfo *info;
+  gfloat minimum_height, natural_height;
+  ClutterActorClass *klass;
+
+  info = _clutter_actor_get_layout_info_or_defaults (self);
+
+  minimum_height = natural_height = 0;
+
+  CLUTTER_NOTE (LAYOUT, "Height request for %.2f px", for_width);
+
+  /* adjust for margin */
+  if (for_width >= 0)
+    {
+      for_width -= (info->margin.left + info->margin.right);
+      if (for_width < 0)
+        for_width = 0;
+    }
+
+  if (CLUTTER_ACTOR_COST_ENABLED ())
+    _clutter_actor_cost_begin (self, CLUTTER_ACTOR_COST_SIZE_REQUEST);
+
+  klass = CLUTTER_ACTOR_GET_CLASS (self);
+  klass->get_preferred_height (self, for_width,
+                               &minimum_height,
+                               &natural_height);
+
+  if (CLUTTER_ACTOR_COST_ENABLED ())
+    _clutter_actor_cost_end ();
+
+  /* adjust for margin */
+  minimum_height += (info->margin.top + info->margin.bottom);
+  natural_height += (info->margin.top + info->margin.bottom);
+
+  /* Due to accumulated float errors, it's better not to warn
+   * on this, but just fix it.
+   */
+  if (natural_height < minimum_height)
+    natural_height = minimum_height;
+
+  *min_height_p = minimum_height;
+  *natural_height_p = natural_height;
 }
 
 /**
- * clutter_actor_destroy:
- * @self: a #ClutterActor
+ * clutter_actor_get_preferred_width:
+ * @self: A #ClutterActor
+ * @for_height: available height when computing the preferred width,
+ *   or a negative value to indicate that no height is defined
+ * @min_width_p: (out) (allow-none): return location for minimum width,
+ *   or %NULL
+ * @natural_width_p: (out) (allow-none): return location for the natural
+ *   width, or %NULL
  *
- * Destroys an actor.  When an actor is destroyed, it will break any
- * references it holds to other objects.  If the actor is inside a
- * container, the actor will be removed.
+ * Computes the requested minimum and natural widths for an actor,
+ * optionally depending on the specified height, or if they are
+ * already computed, returns the cached values.
+ *
+ * An actor may not get its request - depending on the layout
+ * manager that's in effect.
  *
- * When you destroy a container, its children will be destroyed as well.
  *
- * Note: you cannot destroy the #ClutterStage returned by
- * clutter_stage_get_default().
  */
 void
-clutter_actor_destroy (ClutterActor *self)
+clutter_actor_get_preferred_width (ClutterActor *self,
+                                   gfloat        for_height,
+                                   gfloat       *min_width_p,
+                                   gfloat       *natural_width_p)
 {
+  float request_min_width, request_natural_width;
+  SizeRequest *cached_size_request;
+  SizeRequestCache *cache;
+  const ClutterLayoutInfo *info;
+  ClutterActorPrivate *priv;
+  gboolean found_in_cache;
+
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  g_object_ref (self);
+  priv = self->priv;
 
-  /* avoid recursion while destroying */
-  if (!CLUTTER_ACTOR_IN_DESTRUCTION (self))
+  info = _clutter_actor_get_layout_info_or_defaults (self);
+
+  /* we shortcircuit the case of a fixed size set using set_width() */
+  if (priv->min_width_set && priv->natural_width_set)
     {
-      CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IN_DESTRUCTION);
+      if (min_width_p != NULL)
+        *min_width_p = info->minimum.width + (info->margin.left + info->margin.right);
 
-      g_object_run_dispose (G_OBJECT (self));
+      if (natural_width_p != NULL)
+        *natural_width_p = info->natural.width + (info->margin.left + info->margin.right);
 
-      CLUTTER_UNSET_PRIVATE_FLAGS (self, CLUTTER_IN_DESTRUCTION);
+      return;
     }
-
-  g_object_unref (self);
-}
-
-void
-_clutter_actor_finish_queue_redraw (ClutterActor *self,
-                                    ClutterPaintVolume *clip)
-{
-  ClutterActorPrivate *priv = self->priv;
-  ClutterPaintVolume *pv;
-  gboolean clipped;
-
-  /* Remove queue entry early in the process, otherwise a new
-     queue_redraw() during signal handling could put back this
-     object in the stage redraw list (but the entry is freed as
-     soon as we return from this function, causing a segfault
-     later)
-  */
-  priv->queue_redraw_entry = NULL;
-
-  /* If we've been explicitly passed a clip volume then there's
-   * nothing more to calculate, but otherwise the only thing we know
-   * is that the change is constrained to the given actor.
-   *
-   * The idea is that if we know the paint volume for where the actor
-   * was last drawn (in eye coordinates) and we also have the paint
-   * volume for where it will be drawn next (in actor coordinates)
-   * then if we queue a redraw for both these volumes that will cover
-   * everything that needs to be redrawn to clear the old view and
-   * show the latest view of the actor.
+
+  /* the remaining cases are:
    *
-   * Don't clip this redraw if we don't know what position we had for
-   * the previous redraw since we don't know where to set the clip so
-   * it will clear the actor as it is currently.
+   *   - either min_width or natural_width have been set
+   *   - neither min_width or natural_width have been set
+   *
+   * in both cases, we go through the cache (and through the actor in case
+   * of cache misses) and determine the authoritative value depending on
+   * the *_set flags.
    */
-  if (clip)
+
+  cache = clutter_actor_get_size_requests (self);
+
+  if (!priv->needs_width_request)
     {
-      _clutter_actor_set_queue_redraw_clip (self, clip);
-      clipped = TRUE;
+      found_in_cache =
+        _clutter_actor_get_cached_size_request (for_height,
+                                                cache->width_requests,
+                                                &cache->cached_width_age,
+                                                &cached_size_request);
     }
-  else if (G_LIKELY (priv->last_paint_volume_valid))
+  else
     {
-      pv = _clutter_actor_get_paint_volume_mutable (self);
-      if (pv)
-        {
-          ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+      /* if the actor needs a width request we use the first slot */
+      found_in_cache = FALSE;
+      cached_size_request = &cache->width_requests[0];
+    }
 
-          /* make sure we redraw the actors old position... */
-          _clutter_actor_set_queue_redraw_clip (stage,
-                                                &priv->last_paint_volume);
-          _clutter_actor_signal_queue_redraw (stage, stage);
-          _clutter_actor_set_queue_redraw_clip (stage, NULL);
+  if (!found_in_cache)
+    {
+      gfloat minimum_width, natural_width;
 
-          /* XXX: Ideally the redraw signal would take a clip volume
-           * argument, but that would be an ABI break. Until we can
-           * break the ABI we pass the argument out-of-band
-           */
+      clutter_actor_compute_preferred_width (self, for_height,
+                                             &minimum_width,
+                                             &natural_width);
 
-          /* setup the clip for the actors new position... */
-          _clutter_actor_set_queue_redraw_clip (self, pv);
-          clipped = TRUE;
-        }
-      else
-        clipped = FALSE;
-    }
-  else
-    clipped = FALSE;
+      cached_size_request->min_size = minimum_width;
+      cached_size_request->natural_size = natural_width;
+      cached_size_request->for_size = for_height;
+      cached_size_request->age = cache->cached_width_age;
 
-  _clutter_actor_signal_queue_redraw (self, self);
+      cache->cached_width_age += 1;
+      priv->needs_width_request = FALSE;
+    }
 
-  /* Just in case anyone is manually firing redraw signals without
-   * using the public queue_redraw() API we are careful to ensure that
-   * our out-of-band clip member is cleared before returning...
-   *
-   * Note: A NULL clip denotes a full-stage, un-clipped redraw
-   */
-  if (G_LIKELY (clipped))
-    _clutter_actor_set_queue_redraw_clip (self, NULL);
-}
+  if (!priv->min_width_set)
+    request_min_width = cached_size_request->min_size;
+  else
+    request_min_width = info->margin.left
+                      + info->minimum.width
+                      + info->margin.right;
 
-static void
-_clutter_actor_get_allocation_clip (ClutterActor *self,
-                                    ClutterActorBox *clip)
-{
-  ClutterActorBox allocation;
+  if (!priv->natural_width_set)
+    request_natural_width = cached_size_request->natural_size;
+  else
+    request_natural_width = info->margin.left
+                          + info->natural.width
+                          + info->margin.right;
 
-  /* XXX: we don't care if we get an out of date allocation here
-   * because clutter_actor_queue_redraw_with_clip knows to ignore
-   * the clip if the actor's allocation is invalid.
-   *
-   * This is noted because clutter_actor_get_allocation_box does some
-   * unnecessary work to support buggy code with a comment suggesting
-   * that it could be changed later which would be good for this use
-   * case!
-   */
-  clutter_actor_get_allocation_box (self, &allocation);
+  if (min_width_p)
+    *min_width_p = request_min_width;
 
-  /* NB: clutter_actor_queue_redraw_with_clip expects a box in the
-   * actor's own coordinate space but the allocation is in parent
-   * coordinates */
-  clip->x1 = 0;
-  clip->y1 = 0;
-  clip->x2 = allocation.x2 - allocation.x1;
-  clip->y2 = allocation.y2 - allocation.y1;
+  if (natural_width_p)
+    *natural_width_p = request_natural_width;
 }
 
+/**
+ * clutter_actor_get_preferred_height:
+ * @self: A #ClutterActor
+ * @for_width: available width to assume in computing desired height,
+ *   or a negative value to indicate that no width is defined
+ * @min_height_p: (out) (allow-none): return location for minimum height,
+ *   or %NULL
+ * @natural_height_p: (out) (allow-none): return location for natural
+ *   height, or %NULL
+ *
+ * Computes the requested minimum and natural heights for an actor,
+ * or if they are already computed, returns the cached values.
+ *
+ * An actor may not get its request - depending on the layout
+ * manager that's in effect.
+ *
+ *
+ */
 void
-_clutter_actor_queue_redraw_full (ClutterActor       *self,
-                                  ClutterRedrawFlags  flags,
-                                  ClutterPaintVolume *volume,
-                                  ClutterEffect      *effect)
+clutter_actor_get_preferred_height (ClutterActor *self,
+                                    gfloat        for_width,
+                                    gfloat       *min_height_p,
+                                    gfloat       *natural_height_p)
 {
-  ClutterActorPrivate *priv = self->priv;
-  ClutterPaintVolume allocation_pv;
-  ClutterPaintVolume *pv;
-  gboolean should_free_pv;
-  ClutterActor *stage;
-
-  /* Here's an outline of the actor queue redraw mechanism:
-   *
-   * The process starts in one of the following two functions which
-   * are wrappers for this function:
-   *
-   *   clutter_actor_queue_redraw()
-   *   _clutter_actor_queue_redraw_with_clip()
-   *
-   * additionally, an effect can queue a redraw by wrapping this
-   * function in clutter_effect_queue_repaint().
-   *
-   * This functions queues an entry in a list associated with the
-   * stage which is a list of actors that queued a redraw while
-   * updating the timelines, performing layouting and processing other
-   * mainloop sources before the next paint starts.
-   *
-   * We aim to minimize the processing done at this point because
-   * there is a good chance other events will happen while updating
-   * the scenegraph that would invalidate any expensive work we might
-   * otherwise try to do here. For example we don't try and resolve
-   * the screen space bounding box of an actor at this stage so as to
-   * minimize how much of the screen redraw because it's possible
-   * something else will happen which will force a full redraw anyway.
-   *
-   * When all updates are complete and we come to paint the stage then
-   * we iterate this list and actually emit the "queue-redraw" signals
-   * for each of the listed actors which will bubble up to the stage
-   * for each actor and at that point we will transform the actors
-   * paint volume into screen coordinates to determine the clip region
-   * for what needs to be redrawn in the next paint.
-   *
-   * Besides minimizing redundant work another reason for this
-   * deferred design is that it's more likely we will be able to
-   * determine the paint volume of an actor once we've finished
-   * updating the scenegraph because its allocation should be up to
-   * date. NB: If we can't determine an actors paint volume then we
-   * can't automatically queue a clipped redraw which can make a big
-   * difference to performance.
-   *
-   * So the control flow goes like this:
-   * One of clutter_actor_queue_redraw(),
-   *        _clutter_actor_queue_redraw_with_clip(),
-   *     or clutter_effect_queue_repaint()
-   *
-   * then control moves to:
-   *   _clutter_stage_queue_actor_redraw()
-   *
-   * later during _clutter_stage_do_update(), once relayouting is done
-   * and the scenegraph has been updated we will call:
-   * _clutter_stage_finish_queue_redraws().
-   *
-   * _clutter_stage_finish_queue_redraws() will call
-   * _clutter_actor_finish_queue_redraw() for each listed actor.
-   *
-   * Note: actors *are* allowed to queue further redraws during this
-   * process (considering clone actors or texture_new_from_actor which
-   * respond to their source queueing a redraw by queuing a redraw
-   * themselves). We repeat the process until the list is empty.
-   *
-   * This will result in the "queue-redraw" signal being fired for
-   * each actor which will pass control to the default signal handler:
-   * clutter_actor_real_queue_redraw()
-   *
-   * This will bubble up to the stages handler:
-   * clutter_stage_real_queue_redraw()
-   *
-   * clutter_stage_real_queue_redraw() will transform the actors paint
-   * volume into screen space and add it as a clip region for the next
-   * paint.
-   */
-
-  /* ignore queueing a redraw for actors being destroyed */
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
-    return;
+  float request_min_height, request_natural_height;
+  SizeRequest *cached_size_request;
+  SizeRequestCache *cache;
+  const ClutterLayoutInfo *info;
+  ClutterActorPrivate *priv;
+  gboolean found_in_cache;
 
-  /* we can ignore unmapped actors, unless they have at least one
-   * mapped clone or they are inside a cloned branch of the scene
-   * graph, as unmapped actors will simply be left unpainted.
-   *
-   * this allows us to ignore redraws queued on leaf nodes when one
-   * of their parents has been hidden
-   */
-  if (!CLUTTER_ACTOR_IS_MAPPED (self) &&
-      self->priv->in_cloned_branch == 0 &&
-      !clutter_actor_has_mapped_clones (self))
-    {
-      CLUTTER_NOTE (PAINT,
-                    "Skipping queue_redraw('%s'): mapped=%s, "
-                    "mapped_clones=%s, "
-                    "in_cloned_branch=%s\n",
-                    _clutter_actor_get_debug_name (self),
-                    CLUTTER_ACTOR_IS_MAPPED (self) ? "yes" : "no",
-                    clutter_actor_has_mapped_clones (self) ? "yes" : "no",
-                    self->priv->in_cloned_branch != 0 ? "yes" : "no");
-      return;
-    }
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  /* given the check above we could end up queueing a redraw on an
-   * unmapped actor with mapped clones, so we cannot assume that
-   * get_stage() will return a Stage
-   */
-  stage = _clutter_actor_get_stage_internal (self);
-  if (stage == NULL)
-    return;
+  priv = self->priv;
 
-  /* ignore queueing a redraw on stages that are being destroyed */
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
-    return;
+  info = _clutter_actor_get_layout_info_or_defaults (self);
 
-  if (flags & CLUTTER_REDRAW_CLIPPED_TO_ALLOCATION)
+  /* we shortcircuit the case of a fixed size set using set_height() */
+  if (priv->min_height_set && priv->natural_height_set)
     {
-      ClutterActorBox allocation_clip;
-      ClutterVertex origin;
+      if (min_height_p != NULL)
+        *min_height_p = info->minimum.height + (info->margin.top + info->margin.bottom);
 
-      /* If the actor doesn't have a valid allocation then we will
-       * queue a full stage redraw. */
-      if (priv->needs_allocation)
-        {
-          /* NB: NULL denotes an undefined clip which will result in a
-           * full redraw... */
-          _clutter_actor_set_queue_redraw_clip (self, NULL);
-          _clutter_actor_signal_queue_redraw (self, self);
-          return;
-        }
+      if (natural_height_p != NULL)
+        *natural_height_p = info->natural.height + (info->margin.top + info->margin.bottom);
 
-      _clutter_paint_volume_init_static (&allocation_pv, self);
-      pv = &allocation_pv;
+      return;
+    }
 
-      _clutter_actor_get_allocation_clip (self, &allocation_clip);
+  /* the remaining cases are:
+   *
+   *   - either min_height or natural_height have been set
+   *   - neither min_height or natural_height have been set
+   *
+   * in both cases, we go through the cache (and through the actor in case
+   * of cache misses) and determine the authoritative value depending on
+   * the *_set flags.
+   */
 
-      origin.x = allocation_clip.x1;
-      origin.y = allocation_clip.y1;
-      origin.z = 0;
-      clutter_paint_volume_set_origin (pv, &origin);
-      clutter_paint_volume_set_width (pv,
-                                      allocation_clip.x2 - allocation_clip.x1);
-      clutter_paint_volume_set_height (pv,
-                                       allocation_clip.y2 -
-                                       allocation_clip.y1);
-      should_free_pv = TRUE;
+  cache = clutter_actor_get_size_requests (self);
+
+  if (!priv->needs_height_request)
+    {
+      found_in_cache =
+        _clutter_actor_get_cached_size_request (for_width,
+                                                cache->height_requests,
+                                                &cache->cached_height_age,
+                                                &cached_size_request);
     }
   else
     {
-      pv = volume;
-      should_free_pv = FALSE;
+      found_in_cache = FALSE;
+      cached_size_request = &cache->height_requests[0];
     }
 
-  self->priv->queue_redraw_entry =
-    _clutter_stage_queue_actor_redraw (CLUTTER_STAGE (stage),
-                                       priv->queue_redraw_entry,
-                                       self,
-                                       pv);
+  if (!found_in_cache)
+    {
+      gfloat minimum_height, natural_height;
 
-  if (should_free_pv)
-    clutter_paint_volume_free (pv);
+      clutter_actor_compute_preferred_height (self, for_width,
+                                              &minimum_height,
+                                              &natural_height);
 
-  /* If this is the first redraw queued then we can directly use the
-     effect parameter */
-  if (!priv->is_dirty)
-    priv->effect_to_redraw = effect;
-  /* Otherwise we need to merge it with the existing effect parameter */
-  else if (effect != NULL)
-    {
-      /* If there's already an effect then we need to use whichever is
-         later in the chain of actors. Otherwise a full redraw has
-         already been queued on the actor so we need to ignore the
-         effect parameter */
-      if (priv->effect_to_redraw != NULL)
-        {
-          if (priv->effects == NULL)
-            g_warning ("Redraw queued with an effect that is "
-                       "not applied to the actor");
-          else
-            {
-              const GList *l;
+      cached_size_request->min_size = minimum_height;
+      cached_size_request->natural_size = natural_height;
+      cached_size_request->for_size = for_width;
+      cached_size_request->age = cache->cached_height_age;
 
-              for (l = _clutter_meta_group_peek_metas (priv->effects);
-                   l != NULL;
-                   l = l->next)
-                {
-                  if (l->data == priv->effect_to_redraw ||
-                      l->data == effect)
-                    priv->effect_to_redraw = l->data;
-                }
-            }
-        }
+      cache->cached_height_age += 1;
+      priv->needs_height_request = FALSE;
     }
+
+  if (!priv->min_height_set)
+    request_min_height = cached_size_request->min_size;
   else
-    {
-      /* If no effect is specified then we need to redraw the whole
-         actor */
-      priv->effect_to_redraw = NULL;
-    }
+    request_min_height = info->margin.top
+                       + info->minimum.height
+                       + info->margin.bottom;
 
-  priv->is_dirty = TRUE;
+  if (!priv->natural_height_set)
+    request_natural_height = cached_size_request->natural_size;
+  else
+    request_natural_height = info->margin.top
+                           + info->natural.height
+                           + info->margin.bottom;
+
+  if (min_height_p)
+    *min_height_p = request_min_height;
+
+  if (natural_height_p)
+    *natural_height_p = request_natural_height;
 }
 
 /**
- * clutter_actor_queue_redraw:
+ * clutter_actor_get_allocation_box:
  * @self: A #ClutterActor
+ * @box: (out): the function fills this in with the actor's allocation
  *
- * Queues up a redraw of an actor and any children. The redraw occurs
- * once the main loop becomes idle (after the current batch of events
- * has been processed, roughly).
- *
- * Applications rarely need to call this, as redraws are handled
- * automatically by modification functions.
+ * Gets the layout box an actor has been assigned. The allocation can
+ * only be assumed valid inside a paint() method; anywhere else, it
+ * may be out-of-date.
  *
- * This function will not do anything if @self is not visible, or
- * if the actor is inside an invisible part of the scenegraph.
+ * <note>Do not call any of the clutter_actor_get_allocation_*() family
+ * of functions inside the implementation of the get_preferred_width()
+ * or get_preferred_height() virtual functions.</note>
  *
- * Also be aware that painting is a NOP for actors with an opacity of
- * 0
  *
- * When you are implementing a custom actor you must queue a redraw
- * whenever some private state changes that will affect painting or
- * picking of your actor.
  */
 void
-clutter_actor_queue_redraw (ClutterActor *self)
+clutter_actor_get_allocation_box (ClutterActor    *self,
+                                  ClutterActorBox *box)
 {
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  _clutter_actor_queue_redraw_full (self,
-                                    0, /* flags */
-                                    NULL, /* clip volume */
-                                    NULL /* effect */);
+  /* XXX - if needs_allocation=TRUE, we can either 1) g_return_if_fail,
+   * which limits calling get_allocation to inside paint() basically; or
+   * we can 2) force a layout, which could be expensive if someone calls
+   * get_allocation somewhere silly; or we can 3) just return the latest
+   * value, allowing it to be out-of-date, and assume people know what
+   * they are doing.
+   *
+   * The least-surprises approach that keeps existing code working is
+   * likely to be 2). People can end up doing some inefficient things,
+   * though, and in general code that requires 2) is probably broken.
+   */
+
+  /* this implements 2) */
+  if (G_UNLIKELY (self->priv->needs_allocation))
+    {
+      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+
+      /* do not queue a relayout on an unparented actor */
+      if (stage)
+        _clutter_stage_maybe_relayout (stage);
+    }
+
+  /* commenting out the code above and just keeping this assigment
+   * implements 3)
+   */
+  *box = self->priv->allocation;
+}
+
+static void
+clutter_actor_update_constraints (ClutterActor           *self,
+                                  ClutterActorBox        *allocation,
+                                  ClutterAllocationFlags  flags)
+{
+  ClutterActorPrivate *priv = self->priv;
+  const GList *constraints, *l;
+  ClutterActorBox box;
+  gboolean has_sources = FALSE;
+
+  if (priv->constraints == NULL)
+    return;
+
+  box = *allocation;
+
+  constraints = _clutter_meta_group_peek_metas (priv->constraints);
+  for (l = constraints; l != NULL; l = l->next)
+    {
+      ClutterConstraint *constraint = l->data;
+      ClutterActorMeta *meta = l->data;
+
+      if (clutter_actor_meta_get_enabled (meta))
+        {
+          _clutter_constraint_update_allocation (constraint,
+                                                 self,
+                                                 allocation);
+
+          if (_clutter_constraint_get_source (constraint) != NULL)
+            has_sources = TRUE;
+
+          CLUTTER_NOTE (LAYOUT,
+                        "Allocation of '%s' after constraint '%s': "
+                        "{ %.2f, %.2f, %.2f, %.2f }",
+                        _clutter_actor_get_debug_name (self),
+                        _clutter_actor_meta_get_debug_name (meta),
+                        allocation->x1,
+                        allocation->y1,
+                        allocation->x2,
+                        allocation->y2);
+        }
+    }
+
+  /* constraints that depend on other actors may have used a stale
+   * allocation, if their source has not been allocated yet; the stage
+   * applies them again once the relayout is done
+   */
+  if (has_sources)
+    {
+      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+
+      if (stage != NULL && CLUTTER_ACTOR_IN_RELAYOUT (stage))
+        _clutter_stage_add_constrained_actor (CLUTTER_STAGE (stage),
+                                              self,
+                                              &box,
+                                              flags);
+    }
 }
 
 /*< private >
- * _clutter_actor_queue_redraw_with_clip:
- * @self: A #ClutterActor
- * @flags: A mask of #ClutterRedrawFlags controlling the behaviour of
- *   this queue redraw.
- * @volume: A #ClutterPaintVolume describing the bounds of what needs to be
- *   redrawn or %NULL if you are just using a @flag to state your
- *   desired clipping.
- *
- * Queues up a clipped redraw of an actor and any children. The redraw
- * occurs once the main loop becomes idle (after the current batch of
- * events has been processed, roughly).
- *
- * If no flags are given the clip volume is defined by @volume
- * specified in actor coordinates and tells Clutter that only content
- * within this volume has been changed so Clutter can optionally
- * optimize the redraw.
- *
- * If the %CLUTTER_REDRAW_CLIPPED_TO_ALLOCATION @flag is used, @volume
- * should be %NULL and this tells Clutter to use the actor's current
- * allocation as a clip box. This flag can only be used for 2D actors,
- * because any actor with depth may be projected outside its
- * allocation.
- *
- * Applications rarely need to call this, as redraws are handled
- * automatically by modification functions.
- *
- * This function will not do anything if @self is not visible, or if
- * the actor is inside an invisible part of the scenegraph.
- *
- * Also be aware that painting is a NOP for actors with an opacity of
- * 0
+ * clutter_actor_adjust_allocation:
+ * @self: a #ClutterActor
+ * @allocation: (inout): the allocation to adjust
  *
- * When you are implementing a custom actor you must queue a redraw
- * whenever some private state changes that will affect painting or
- * picking of your actor.
+ * Adjusts the passed allocation box taking into account the actor's
+ * layout information, like alignment, expansion, and margin.
  */
-void
-_clutter_actor_queue_redraw_with_clip (ClutterActor       *self,
-                                       ClutterRedrawFlags  flags,
-                                       ClutterPaintVolume *volume)
+static void
+clutter_actor_adjust_allocation (ClutterActor    *self,
+                                 ClutterActorBox *allocation)
 {
-  _clutter_actor_queue_redraw_full (self,
-                                    flags, /* flags */
-                                    volume, /* clip volume */
-                                    NULL /* effect */);
-}
+  ClutterActorBox adj_allocation;
+  float alloc_width, alloc_height;
+  float min_width, min_height;
+  float nat_width, nat_height;
+  ClutterRequestMode req_mode;
 
-void
-_clutter_actor_queue_only_relayout (ClutterActor *self)
-{
-  ClutterActorPrivate *priv = self->priv;
+  adj_allocation = *allocation;
 
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
-    return;
+  clutter_actor_box_get_size (allocation, &alloc_width, &alloc_height);
 
-  if (priv->needs_width_request &&
-      priv->needs_height_request &&
-      priv->needs_allocation)
-    return; /* save some cpu cycles */
+  /* we want to hit the cache, so we use the public API */
+  req_mode = clutter_actor_get_request_mode (self);
 
-#if CLUTTER_ENABLE_DEBUG
-  if (!CLUTTER_ACTOR_IS_TOPLEVEL (self) && CLUTTER_ACTOR_IN_RELAYOUT (self))
+  if (req_mode == CLUTTER_REQUEST_HEIGHT_FOR_WIDTH)
     {
-      g_warning ("The actor '%s' is currently inside an allocation "
-                 "cycle; calling clutter_actor_queue_relayout() is "
-                 "not recommended",
-                 _clutter_actor_get_debug_name (self));
+      clutter_actor_get_preferred_width (self, -1,
+                                         &min_width,
+                                         &nat_width);
+      clutter_actor_get_preferred_height (self, alloc_width,
+                                          &min_height,
+                                          &nat_height);
+    }
+  else if (req_mode == CLUTTER_REQUEST_WIDTH_FOR_HEIGHT)
+    {
+      clutter_actor_get_preferred_height (self, -1,
+                                          &min_height,
+                                          &nat_height);
+      clutter_actor_get_preferred_width (self, alloc_height,
+                                         &min_width,
+                                         &nat_width);
     }
-#endif /* CLUTTER_ENABLE_DEBUG */
 
-  _clutter_actor_queue_relayout_on_clones (self);
+#ifdef CLUTTER_ENABLE_DEBUG
+  /* warn about underallocations */
+  if (_clutter_diagnostic_enabled () &&
+      (floorf (min_width - alloc_width) > 0 ||
+       floorf (min_height - alloc_height) > 0))
+    {
+      ClutterActor *parent = clutter_actor_get_parent (self);
 
-  g_signal_emit (self, actor_signals[QUEUE_RELAYOUT], 0);
-}
+      /* the only actors that are allowed to be underallocated are the Stage,
+       * as it doesn't have an implicit size, and Actors that specifically
+       * told us that they want to opt-out from layout control mechanisms
+       * through the NO_LAYOUT escape hatch.
+       */
+      if (parent != NULL &&
+          !(self->flags & CLUTTER_ACTOR_NO_LAYOUT) != 0)
+        {
+          g_warning (G_STRLOC ": The actor '%s' is getting an allocation "
+                     "of %.2f x %.2f from its parent actor '%s', but its "
+                     "requested minimum size is of %.2f x %.2f",
+                     _clutter_actor_get_debug_name (self),
+                     alloc_width, alloc_height,
+                     _clutter_actor_get_debug_name (parent),
+                     min_width, min_height);
+        }
+    }
+#endif
 
-/**
- * clutter_actor_queue_redraw_with_clip:
- * @self: a #ClutterActor
- * @clip: (allow-none): a rectangular clip region, or %NULL
- *
- * Queues a redraw on @self limited to a specific, actor-relative
- * rectangular area.
- *
- * If @clip is %NULL this function is equivalent to
- * clutter_actor_queue_redraw().
- *
- *
- */
-void
-clutter_actor_queue_redraw_with_clip (ClutterActor                *self,
-                                      const cairo_rectangle_int_t *clip)
-{
-  ClutterPaintVolume volume;
-  ClutterVertex origin;
+  clutter_actor_adjust_width (self,
+                              &min_width,
+                              &nat_width,
+                              &adj_allocation.x1,
+                              &adj_allocation.x2);
 
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  clutter_actor_adjust_height (self,
+                               &min_height,
+                               &nat_height,
+                               &adj_allocation.y1,
+                               &adj_allocation.y2);
 
-  if (clip == NULL)
+  /* we maintain the invariant that an allocation cannot be adjusted
+   * to be outside the parent-given box
+   */
+  if (adj_allocation.x1 < allocation->x1 ||
+      adj_allocation.y1 < allocation->y1 ||
+      adj_allocation.x2 > allocation->x2 ||
+      adj_allocation.y2 > allocation->y2)
     {
-      clutter_actor_queue_redraw (self);
+      g_warning (G_STRLOC ": The actor '%s' tried to adjust its allocation "
+                 "to { %.2f, %.2f, %.2f, %.2f }, which is outside of its "
+                 "original allocation of { %.2f, %.2f, %.2f, %.2f }",
+                 _clutter_actor_get_debug_name (self),
+                 adj_allocation.x1, adj_allocation.y1,
+                 adj_allocation.x2 - adj_allocation.x1,
+                 adj_allocation.y2 - adj_allocation.y1,
+                 allocation->x1, allocation->y1,
+                 allocation->x2 - allocation->x1,
+                 allocation->y2 - allocation->y1);
       return;
     }
 
-  _clutter_paint_volume_init_static (&volume, self);
+  *allocation = adj_allocation;
+}
 
-  origin.x = clip->x;
-  origin.y = clip->y;
-  origin.z = 0.0f;
+static void
+clutter_actor_allocate_internal (ClutterActor           *self,
+                                 const ClutterActorBox  *allocation,
+                                 ClutterAllocationFlags  flags)
+{
+  ClutterActorClass *klass;
 
-  clutter_paint_volume_set_origin (&volume, &origin);
-  clutter_paint_volume_set_width (&volume, clip->width);
-  clutter_paint_volume_set_height (&volume, clip->height);
+  CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IN_RELAYOUT);
 
-  _clutter_actor_queue_redraw_full (self, 0, &volume, NULL);
+  CLUTTER_NOTE (LAYOUT, "Calling %s::allocate()",
+                _clutter_actor_get_debug_name (self));
 
-  clutter_paint_volume_free (&volume);
+  if (CLUTTER_ACTOR_COST_ENABLED ())
+    _clutter_actor_cost_begin (self, CLUTTER_ACTOR_COST_ALLOCATE);
+
+  klass = CLUTTER_ACTOR_GET_CLASS (self);
+  klass->allocate (self, allocation, flags);
+
+  if (CLUTTER_ACTOR_COST_ENABLED ())
+    _clutter_actor_cost_end ();
+
+  CLUTTER_UNSET_PRIVATE_FLAGS (self, CLUTTER_IN_RELAYOUT);
+
+  /* Caller should call clutter_actor_queue_redraw() if needed
+   * for that particular case.
+   */
 }
 
 /**
- * clutter_actor_queue_relayout:
+ * clutter_actor_allocate:
  * @self: A #ClutterActor
+ * @box: new allocation of the actor, in parent-relative coordinates
+ * @flags: flags that control the allocation
  *
- * Indicates that the actor's size request or other layout-affecting
- * properties may have changed. This function is used inside #ClutterActor
- * subclass implementations, not by applications directly.
- *
- * Queueing a new layout automatically queues a redraw as well.
- *
+ * Assigns the size of a #ClutterActor from the given @box.
  *
- */
-void
-clutter_actor_queue_relayout (ClutterActor *self)
-{
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-
-  _clutter_actor_queue_only_relayout (self);
-  clutter_actor_queue_redraw (self);
-}
-
-/**
- * clutter_actor_get_preferred_size:
- * @self: a #ClutterActor
- * @min_width_p: (out) (allow-none): return location for the minimum
- *   width, or %NULL
- * @min_height_p: (out) (allow-none): return location for the minimum
- *   height, or %NULL
- * @natural_width_p: (out) (allow-none): return location for the natural
- *   width, or %NULL
- * @natural_height_p: (out) (allow-none): return location for the natural
- *   height, or %NULL
+ * This function should only be called on the children of an actor when
+ * overriding the #ClutterActorClass.allocate() virtual function.
  *
- * Computes the preferred minimum and natural size of an actor, taking into
- * account the actor's geometry management (either height-for-width
- * or width-for-height).
+ * This function will adjust the stored allocation to take into account
+ * the alignment flags set in the #ClutterActor:x-align and
+ * #ClutterActor:y-align properties, as well as the margin values set in
+ * the #ClutterActor:margin-top, #ClutterActor:margin-right,
+ * #ClutterActor:margin-bottom, and #ClutterActor:margin-left properties.
  *
- * The width and height used to compute the preferred height and preferred
- * width are the actor's natural ones.
+ * This function will respect the easing state of the #ClutterActor and
+ * interpolate between the current allocation and the new one if the
+ * easing state duration is a positive value.
  *
- * If you need to control the height for the preferred width, or the width for
- * the preferred height, you should use clutter_actor_get_preferred_width()
- * and clutter_actor_get_preferred_height(), and check the actor's preferred
- * geometry management using the #ClutterActor:request-mode property.
+ * Actors can know from their allocation box whether they have moved
+ * with respect to their parent actor. The @flags parameter describes
+ * additional information about the allocation, for instance whether
+ * the parent has moved with respect to the stage, for example because
+ * a grandparent's origin has moved.
  *
  *
  */
 void
-clutter_actor_get_preferred_size (ClutterActor *self,
-                                  gfloat       *min_width_p,
-                                  gfloat       *min_height_p,
-                                  gfloat       *natural_width_p,
-                                  gfloat       *natural_height_p)
+clutter_actor_allocate (ClutterActor           *self,
+                        const ClutterActorBox  *box,
+                        ClutterAllocationFlags  flags)
 {
+  ClutterActorBox old_allocation, real_allocation;
+  gboolean origin_changed, child_moved, size_changed;
+  gboolean stage_allocation_changed;
   ClutterActorPrivate *priv;
-  gfloat min_width, min_height;
-  gfloat natural_width, natural_height;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
-
-  priv = self->priv;
-
-  min_width = min_height = 0;
-  natural_width = natural_height = 0;
-
-  if (priv->request_mode == CLUTTER_REQUEST_HEIGHT_FOR_WIDTH)
-    {
-      CLUTTER_NOTE (LAYOUT, "Preferred size (height-for-width)");
-      clutter_actor_get_preferred_width (self, -1,
-                                         &min_width,
-                                         &natural_width);
-      clutter_actor_get_preferred_height (self, natural_width,
-                                          &min_height,
-                                          &natural_height);
-    }
-  else
+  if (G_UNLIKELY (_clutter_actor_get_stage_internal (self) == NULL))
     {
-      CLUTTER_NOTE (LAYOUT, "Preferred size (width-for-height)");
-      clutter_actor_get_preferred_height (self, -1,
-                                          &min_height,
-                                          &natural_height);
-      clutter_actor_get_preferred_width (self, natural_height,
-                                         &min_width,
-                                         &natural_width);
-    }
-
-  if (min_width_p)
-    *min_width_p = min_width;
+      g_warning ("Spurious clutter_actor_allocate called for actor %p/%s "
+                 "which isn't a descendent of the stage!\n",
+                 self, _clutter_actor_get_debug_name (self));
+      return;
+    }
 
-  if (min_height_p)
-    *min_height_p = min_height;
+  priv = self->priv;
 
-  if (natural_width_p)
-    *natural_width_p = natural_width;
+  old_allocation = priv->allocation;
+  real_allocation = *box;
 
-  if (natural_height_p)
-    *natural_height_p = natural_height;
-}
+  /* constraints are allowed to modify the allocation only here; we do
+   * this prior to all the other checks so that we can bail out if the
+   * allocation did not change
+   */
+  clutter_actor_update_constraints (self, &real_allocation, flags);
 
-/*< private >
- * effective_align:
- * @align: a #ClutterActorAlign
- * @direction: a #ClutterTextDirection
- *
- * Retrieves the correct alignment depending on the text direction
- *
- * Return value: the effective alignment
- */
-static ClutterActorAlign
-effective_align (ClutterActorAlign    align,
-                 ClutterTextDirection direction)
-{
-  ClutterActorAlign res;
+  /* adjust the allocation depending on the align/margin properties */
+  clutter_actor_adjust_allocation (self, &real_allocation);
 
-  switch (align)
+  if (real_allocation.x2 < real_allocation.x1 ||
+      real_allocation.y2 < real_allocation.y1)
     {
-    case CLUTTER_ACTOR_ALIGN_START:
-      res = (direction == CLUTTER_TEXT_DIRECTION_RTL)
-          ? CLUTTER_ACTOR_ALIGN_END
-          : CLUTTER_ACTOR_ALIGN_START;
-      break;
+      g_warning (G_STRLOC ": Actor '%s' tried to allocate a size of %.2f x %.2f",
+                 _clutter_actor_get_debug_name (self),
+                 real_allocation.x2 - real_allocation.x1,
+                 real_allocation.y2 - real_allocation.y1);
+    }
 
-    case CLUTTER_ACTOR_ALIGN_END:
-      res = (direction == CLUTTER_TEXT_DIRECTION_RTL)
-          ? CLUTTER_ACTOR_ALIGN_START
-          : CLUTTER_ACTOR_ALIGN_END;
-      break;
+  /* we allow 0-sized actors, but not negative-sized ones */
+  real_allocation.x2 = MAX (real_allocation.x2, real_allocation.x1);
+  real_allocation.y2 = MAX (real_allocation.y2, real_allocation.y1);
 
-    default:
-      res = align;
-      break;
-    }
+  origin_changed = (flags & CLUTTER_ABSOLUTE_ORIGIN_CHANGED);
 
-  return res;
-}
+  child_moved = (real_allocation.x1 != old_allocation.x1 ||
+                 real_allocation.y1 != old_allocation.y1);
 
-/*< private >
- * _clutter_actor_get_effective_x_align:
- * @self: a #ClutterActor
- *
- * Retrieves the effective horizontal alignment, taking into
- * consideration the text direction of @self.
- *
- * Return value: the effective horizontal alignment
- */
-ClutterActorAlign
-_clutter_actor_get_effective_x_align (ClutterActor *self)
-{
-  return effective_align (clutter_actor_get_x_align (self),
-                          clutter_actor_get_text_direction (self));
-}
+  size_changed = (real_allocation.x2 != old_allocation.x2 ||
+                  real_allocation.y2 != old_allocation.y2);
 
-static inline void
-adjust_for_margin (float  margin_start,
-                   float  margin_end,
-                   float *minimum_size,
-                   float *natural_size,
-                   float *allocated_start,
-                   float *allocated_end)
-{
-  *minimum_size -= (margin_start + margin_end);
-  *natural_size -= (margin_start + margin_end);
-  *allocated_start += margin_start;
-  *allocated_end -= margin_end;
-}
+  if (origin_changed || child_moved || size_changed)
+    stage_allocation_changed = TRUE;
+  else
+    stage_allocation_changed = FALSE;
 
-static inline void
-adjust_for_alignment (ClutterActorAlign  alignment,
-                      float              natural_size,
-                      float             *allocated_start,
-                      float             *allocated_end)
-{
-  float allocated_size = *allocated_end - *allocated_start;
+  /* If we get an allocation "out of the blue"
+   * (we did not queue relayout), then we want to
+   * ignore it. But if we have needs_allocation set,
+   * we want to guarantee that allocate() virtual
+   * method is always called, i.e. that queue_relayout()
+   * always results in an allocate() invocation on
+   * an actor.
+   *
+   * The optimization here is to avoid re-allocating
+   * actors that did not queue relayout and were
+   * not moved.
+   */
+  if (!priv->needs_allocation && !stage_allocation_changed)
+    {
+      CLUTTER_NOTE (LAYOUT, "No allocation needed");
+      return;
+    }
 
-  switch (alignment)
+  if (!stage_allocation_changed)
     {
-    case CLUTTER_ACTOR_ALIGN_FILL:
-      /* do nothing */
-      break;
+      /* If the actor didn't move but needs_allocation is set, we just
+       * need to allocate the children */
+      clutter_actor_allocate_internal (self, &real_allocation, flags);
+      return;
+    }
 
-    case CLUTTER_ACTOR_ALIGN_START:
-      /* keep start */
-      *allocated_end = *allocated_start + MIN (natural_size, allocated_size);
-      break;
+  /* When ABSOLUTE_ORIGIN_CHANGED is passed in to
+   * clutter_actor_allocate(), it indicates whether the parent has its
+   * absolute origin moved; when passed in to ClutterActor::allocate()
+   * virtual method though, it indicates whether the child has its
+   * absolute origin moved.  So we set it when child_moved is TRUE
+   */
+  if (child_moved)
+    flags |= CLUTTER_ABSOLUTE_ORIGIN_CHANGED;
 
-    case CLUTTER_ACTOR_ALIGN_END:
-      if (allocated_size > natural_size)
-        {
-          *allocated_start += (allocated_size - natural_size);
-          *allocated_end = *allocated_start + natural_size;
-        }
-      break;
+  /* store the flags here, so that they can be propagated by the
+   * transition code
+   */
+  self->priv->allocation_flags = flags;
 
-    case CLUTTER_ACTOR_ALIGN_CENTER:
-      if (allocated_size > natural_size)
-        {
-          *allocated_start += floorf ((allocated_size - natural_size) / 2);
-          *allocated_end = *allocated_start + MIN (allocated_size, natural_size);
-        }
-      break;
-    }
+  _clutter_actor_create_transition (self, obj_props[PROP_ALLOCATION],
+                                    &priv->allocation,
+                                    &real_allocation);
 }
 
-/*< private >
- * clutter_actor_adjust_width:
+/**
+ * clutter_actor_set_allocation:
  * @self: a #ClutterActor
- * @minimum_width: (inout): the actor's preferred minimum width, which
- *   will be adjusted depending on the margin
- * @natural_width: (inout): the actor's preferred natural width, which
- *   will be adjusted depending on the margin
- * @adjusted_x1: (out): the adjusted x1 for the actor's bounding box
- * @adjusted_x2: (out): the adjusted x2 for the actor's bounding box
+ * @box: a #ClutterActorBox
+ * @flags: allocation flags
  *
- * Adjusts the preferred and allocated position and size of an actor,
- * depending on the margin and alignment properties.
- */
-static void
-clutter_actor_adjust_width (ClutterActor *self,
-                            gfloat       *minimum_width,
-                            gfloat       *natural_width,
-                            gfloat       *adjusted_x1,
-                            gfloat       *adjusted_x2)
+ * Stores the allocation of @self as defined by @box.
+ *
+ * This function can only be called from within the implementation of
+ * the #ClutterActorClass.allocate() virtual function.
+ *
+ * The allocation should have been adjusted to take into account constraints,
+ * alignment, and margin properties. If you are implementing a #ClutterActor
+ * subclass that provides its own layout management policy for its children
+ * instead of using a #ClutterLayoutManager delegate, you should not call
+ * this function on the children of @self; instead, you should call
+ * clutter_actor_allocate(), which will adjust the allocation box for
+ * you.
+ *
+ * This function should only be used by subclasses of #ClutterActor
+ * that wish to store their allocation but cannot chain up to the
+ * parent's implementation; the default implementation of the
+ * #ClutterActorClass.allocate() virtual function will call this
+ * function.
+ *
+ * It is important to note that, while chaining up was the recommended
+ * behaviour for #ClutterActor subclasses prior to the introduction of
+ * this function, it is recommended to call clutter_actor_set_allocation()
+ * instead.
+ *
+ * If the #ClutterActor is using a #ClutterLayoutManager delegate object
+ * to handle the allocation of its children, this function will call
+ * the clutter_layout_manager_allocate() function only if the
+ * %CLUTTER_DELEGATE_LAYOUT flag is set on @flags, otherwise it is
+ * expected that the subclass will call clutter_layout_manager_allocate()
+ * by itself. For instance, the following code:
+ *
+ * |[
+ * static void
+ * my_actor_allocate (ClutterActor *actor,
+ *                    const ClutterActorBox *allocation,
+ *                    ClutterAllocationFlags flags)
+ * {
+ *   ClutterActorBox new_alloc;
+ *   ClutterAllocationFlags new_flags;
+ *
+ *   adjust_allocation (allocation, &amp;new_alloc);
+ *
+ *   new_flags = flags | CLUTTER_DELEGATE_LAYOUT;
+ *
+ *   /&ast; this will use the layout manager set on the actor &ast;/
+ *   clutter_actor_set_allocation (actor, &amp;new_alloc, new_flags);
+ * }
+ * ]|
+ *
+ * is equivalent to this:
+ *
+ * |[
+ * static void
+ * my_actor_allocate (ClutterActor *actor,
+ *                    const ClutterActorBox *allocation,
+ *                    ClutterAllocationFlags flags)
+ * {
+ *   ClutterLayoutManager *layout;
+ *   ClutterActorBox new_alloc;
+ *
+ *   adjust_allocation (allocation, &amp;new_alloc);
+ *
+ *   clutter_actor_set_allocation (actor, &amp;new_alloc, flags);
+ *
+ *   layout = clutter_actor_get_layout_manager (actor);
+ *   clutter_layout_manager_allocate (layout,
+ *                                    CLUTTER_CONTAINER (actor),
+ *                                    &amp;new_alloc,
+ *                                    flags);
+ * }
+ * ]|
+ *
+ *
+ */
+void
+clutter_actor_set_allocation (ClutterActor           *self,
+                              const ClutterActorBox  *box,
+                              ClutterAllocationFlags  flags)
 {
-  ClutterTextDirection text_dir;
-  const ClutterLayoutInfo *info;
+  ClutterActorPrivate *priv;
+  gboolean changed;
 
-  info = _clutter_actor_get_layout_info_or_defaults (self);
-  text_dir = clutter_actor_get_text_direction (self);
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (box != NULL);
 
-  CLUTTER_NOTE (LAYOUT, "Adjusting allocated X and width");
+  if (G_UNLIKELY (!CLUTTER_ACTOR_IN_RELAYOUT (self)))
+    {
+      g_critical (G_STRLOC ": The clutter_actor_set_allocation() function "
+                  "can only be called from within the implementation of "
+                  "the ClutterActor::allocate() virtual function.");
+      return;
+    }
 
-  /* this will tweak natural_width to remove the margin, so that
-   * adjust_for_alignment() will use the correct size
+  priv = self->priv;
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  changed = clutter_actor_set_allocation_internal (self, box, flags);
+
+  /* we allocate our children before we notify changes in our geometry,
+   * so that people connecting to properties will be able to get valid
+   * data out of the sub-tree of the scene graph that has this actor at
+   * the root.
    */
-  adjust_for_margin (info->margin.left, info->margin.right,
-                     minimum_width, natural_width,
-                     adjusted_x1, adjusted_x2);
+  clutter_actor_maybe_layout_children (self, box, flags);
 
-  adjust_for_alignment (effective_align (info->x_align, text_dir),
-                        *natural_width,
-                        adjusted_x1, adjusted_x2);
+  if (changed &&
+      g_signal_has_handler_pending (self, actor_signals[ALLOCATION_CHANGED],
+                                    0, FALSE))
+    {
+      ClutterActorBox signal_box = priv->allocation;
+      ClutterAllocationFlags signal_flags = priv->allocation_flags;
+
+      g_signal_emit (self, actor_signals[ALLOCATION_CHANGED], 0,
+                     &signal_box,
+                     signal_flags);
+    }
+
+  g_object_thaw_notify (G_OBJECT (self));
 }
 
 /*< private >
- * clutter_actor_adjust_height:
+ * _clutter_actor_restore_allocation:
  * @self: a #ClutterActor
- * @minimum_height: (inout): the actor's preferred minimum height, which
- *   will be adjusted depending on the margin
- * @natural_height: (inout): the actor's preferred natural height, which
- *   will be adjusted depending on the margin
- * @adjusted_y1: (out): the adjusted y1 for the actor's bounding box
- * @adjusted_y2: (out): the adjusted y2 for the actor's bounding box
+ * @box: the allocation of @self, as saved by a previous run
  *
- * Adjusts the preferred and allocated position and size of an actor,
- * depending on the margin and alignment properties.
+ * Stores @box as the allocation of @self without running its layout,
+ * so that @self can be painted before the first relayout. The stored
+ * allocation is considered valid until clutter_actor_queue_relayout()
+ * is called on @self, or until the parent of @self allocates it in a
+ * different box.
  */
-static void
-clutter_actor_adjust_height (ClutterActor *self,
-                             gfloat       *minimum_height,
-                             gfloat       *natural_height,
-                             gfloat       *adjusted_y1,
-                             gfloat       *adjusted_y2)
+void
+_clutter_actor_restore_allocation (ClutterActor          *self,
+                                   const ClutterActorBox *box)
 {
-  const ClutterLayoutInfo *info;
-
-  info = _clutter_actor_get_layout_info_or_defaults (self);
-
-  CLUTTER_NOTE (LAYOUT, "Adjusting allocated Y and height");
-
-  /* this will tweak natural_height to remove the margin, so that
-   * adjust_for_alignment() will use the correct size
-   */
-  adjust_for_margin (info->margin.top, info->margin.bottom,
-                     minimum_height, natural_height,
-                     adjusted_y1,
-                     adjusted_y2);
-
-  /* we don't use effective_align() here, because text direction
-   * only affects the horizontal axis
-   */
-  adjust_for_alignment (info->y_align,
-                        *natural_height,
-                        adjusted_y1,
-                        adjusted_y2);
-
+  clutter_actor_set_allocation_internal (self, box, CLUTTER_ALLOCATION_NONE);
 }
 
-/* looks for a cached size request for this for_size. If not
- * found, returns the oldest entry so it can be overwritten */
-static gboolean
-_clutter_actor_get_cached_size_request (gfloat         for_size,
-                                        SizeRequest   *cached_size_requests,
-                                        SizeRequest  **result)
+/**
+ * clutter_actor_set_position:
+ * @self: A #ClutterActor
+ * @x: New left position of actor in pixels.
+ * @y: New top position of actor in pixels.
+ *
+ * Sets the actor's fixed position in pixels relative to any parent
+ * actor.
+ *
+ * If a layout manager is in use, this position will override the
+ * layout manager and force a fixed position.
+ */
+void
+clutter_actor_set_position (ClutterActor *self,
+			    gfloat        x,
+			    gfloat        y)
 {
-  guint i;
+  ClutterPoint new_position;
+  ClutterPoint cur_position;
 
-  *result = &cached_size_requests[0];
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  for (i = 0; i < N_CACHED_SIZE_REQUESTS; i++)
-    {
-      SizeRequest *sr;
+  clutter_point_init (&new_position, x, y);
 
-      sr = &cached_size_requests[i];
+  cur_position.x = clutter_actor_get_x (self);
+  cur_position.y = clutter_actor_get_y (self);
 
-      if (sr->age > 0 &&
-          sr->for_size == for_size)
-        {
-          CLUTTER_NOTE (LAYOUT, "Size cache hit for size: %.2f", for_size);
-          *result = sr;
-          return TRUE;
-        }
-      else if (sr->age < (*result)->age)
-        {
-          *result = sr;
-        }
-    }
+  _clutter_actor_create_transition (self, obj_props[PROP_POSITION],
+                                    &cur_position,
+                                    &new_position);
+}
 
-  CLUTTER_NOTE (LAYOUT, "Size cache miss for size: %.2f", for_size);
+/**
+ * clutter_actor_get_fixed_position_set:
+ * @self: A #ClutterActor
+ *
+ * Checks whether an actor has a fixed position set (and will thus be
+ * unaffected by any layout manager).
+ *
+ * Return value: %TRUE if the fixed position is set on the actor
+ *
+ *
+ */
+gboolean
+clutter_actor_get_fixed_position_set (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
 
-  return FALSE;
+  return self->priv->position_set;
 }
 
 /**
- * clutter_actor_get_preferred_width:
+ * clutter_actor_set_fixed_position_set:
  * @self: A #ClutterActor
- * @for_height: available height when computing the preferred width,
- *   or a negative value to indicate that no height is defined
- * @min_width_p: (out) (allow-none): return location for minimum width,
- *   or %NULL
- * @natural_width_p: (out) (allow-none): return location for the natural
- *   width, or %NULL
- *
- * Computes the requested minimum and natural widths for an actor,
- * optionally depending on the specified height, or if they are
- * already computed, returns the cached values.
+ * @is_set: whether to use fixed position
  *
- * An actor may not get its request - depending on the layout
- * manager that's in effect.
+ * Sets whether an actor has a fixed position set (and will thus be
+ * unaffected by any layout manager).
  *
  *
  */
 void
-clutter_actor_get_preferred_width (ClutterActor *self,
-                                   gfloat        for_height,
-                                   gfloat       *min_width_p,
-                                   gfloat       *natural_width_p)
+clutter_actor_set_fixed_position_set (ClutterActor *self,
+                                      gboolean      is_set)
 {
-  float request_min_width, request_natural_width;
-  SizeRequest *cached_size_request;
-  const ClutterLayoutInfo *info;
-  ClutterActorPrivate *priv;
-  gboolean found_in_cache;
-
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  priv = self->priv;
-
-  info = _clutter_actor_get_layout_info_or_defaults (self);
-
-  /* we shortcircuit the case of a fixed size set using set_width() */
-  if (priv->min_width_set && priv->natural_width_set)
-    {
-      if (min_width_p != NULL)
-        *min_width_p = info->minimum.width + (info->margin.left + info->margin.right);
-
-      if (natural_width_p != NULL)
-        *natural_width_p = info->natural.width + (info->margin.left + info->margin.right);
-
-      return;
-    }
-
-  /* the remaining cases are:
-   *
-   *   - either min_width or natural_width have been set
-   *   - neither min_width or natural_width have been set
-   *
-   * in both cases, we go through the cache (and through the actor in case
-   * of cache misses) and determine the authoritative value depending on
-   * the *_set flags.
-   */
-
-  if (!priv->needs_width_request)
-    {
-      found_in_cache =
-        _clutter_actor_get_cached_size_request (for_height,
-                                                priv->width_requests,
-                                                &cached_size_request);
-    }
-  else
-    {
-      /* if the actor needs a width request we use the first slot */
-      found_in_cache = FALSE;
-      cached_size_request = &priv->width_requests[0];
-    }
+  if (self->priv->position_set == (is_set != FALSE))
+    return;
 
-  if (!found_in_cache)
+  if (!is_set)
     {
-      gfloat minimum_width, natural_width;
-      ClutterActorClass *klass;
-
-      minimum_width = natural_width = 0;
-
-      /* adjust for the margin */
-      if (for_height >= 0)
-        {
-          for_height -= (info->margin.top + info->margin.bottom);
-          if (for_height < 0)
-            for_height = 0;
-        }
-
-      CLUTTER_NOTE (LAYOUT, "Width request for %.2f px", for_height);
-
-      klass = CLUTTER_ACTOR_GET_CLASS (self);
-      klass->get_preferred_width (self, for_height,
-                                  &minimum_width,
-                                  &natural_width);
-
-      /* adjust for the margin */
-      minimum_width += (info->margin.left + info->margin.right);
-      natural_width += (info->margin.left + info->margin.right);
-
-      /* Due to accumulated float errors, it's better not to warn
-       * on this, but just fix it.
-       */
-      if (natural_width < minimum_width)
-	natural_width = minimum_width;
-
-      cached_size_request->min_size = minimum_width;
-      cached_size_request->natural_size = natural_width;
-      cached_size_request->for_size = for_height;
-      cached_size_request->age = priv->cached_width_age;
-
-      priv->cached_width_age += 1;
-      priv->needs_width_request = FALSE;
-    }
-
-  if (!priv->min_width_set)
-    request_min_width = cached_size_request->min_size;
-  else
-    request_min_width = info->margin.left
-                      + info->minimum.width
-                      + info->margin.right;
-
-  if (!priv->natural_width_set)
-    request_natural_width = cached_size_request->natural_size;
-  else
-    request_natural_width = info->margin.left
-                          + info->natural.width
-                          + info->margin.right;
+      ClutterLayoutInfo *info;
 
-  if (min_width_p)
-    *min_width_p = request_min_width;
+      /* Ensure we set back the default fixed position of 0,0 so that setting
+	 just one of x/y always atomically gets 0 for the other */
+      info = _clutter_actor_peek_layout_info (self);
+      if (info != NULL)
+	{
+	  info->fixed_pos.x = 0;
+	  info->fixed_pos.y = 0;
+	}
+    }
 
-  if (natural_width_p)
-    *natural_width_p = request_natural_width;
+  self->priv->position_set = is_set != FALSE;
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_FIXED_POSITION_SET]);
+
+  clutter_actor_queue_relayout (self);
 }
 
 /**
- * clutter_actor_get_preferred_height:
+ * clutter_actor_move_by:
  * @self: A #ClutterActor
- * @for_width: available width to assume in computing desired height,
- *   or a negative value to indicate that no width is defined
- * @min_height_p: (out) (allow-none): return location for minimum height,
- *   or %NULL
- * @natural_height_p: (out) (allow-none): return location for natural
- *   height, or %NULL
- *
- * Computes the requested minimum and natural heights for an actor,
- * or if they are already computed, returns the cached values.
+ * @dx: Distance to move Actor on X axis.
+ * @dy: Distance to move Actor on Y axis.
  *
- * An actor may not get its request - depending on the layout
- * manager that's in effect.
+ * Changes the fixed position of an actor by @dx on the horizontal
+ * axis, and by @dy on the vertical axis.
  *
  *
  */
 void
-clutter_actor_get_preferred_height (ClutterActor *self,
-                                    gfloat        for_width,
-                                    gfloat       *min_height_p,
-                                    gfloat       *natural_height_p)
+clutter_actor_move_by (ClutterActor *self,
+		       gfloat        dx,
+		       gfloat        dy)
 {
-  float request_min_height, request_natural_height;
-  SizeRequest *cached_size_request;
   const ClutterLayoutInfo *info;
-  ClutterActorPrivate *priv;
-  gboolean found_in_cache;
+  gfloat x, y;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  priv = self->priv;
-
   info = _clutter_actor_get_layout_info_or_defaults (self);
+  x = info->fixed_pos.x;
+  y = info->fixed_pos.y;
 
-  /* we shortcircuit the case of a fixed size set using set_height() */
-  if (priv->min_height_set && priv->natural_height_set)
-    {
-      if (min_height_p != NULL)
-        *min_height_p = info->minimum.height + (info->margin.top + info->margin.bottom);
+  clutter_actor_set_position (self, x + dx, y + dy);
+}
 
-      if (natural_height_p != NULL)
-        *natural_height_p = info->natural.height + (info->margin.top + info->margin.bottom);
+static void
+clutter_actor_set_min_width (ClutterActor *self,
+                             gfloat        min_width)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox old = { 0, };
+  ClutterLayoutInfo *info;
 
-      return;
-    }
+  /* if we are setting the size on a top-level actor and the
+   * backend only supports static top-levels (e.g. framebuffers)
+   * then we ignore the passed value and we override it with
+   * the stage implementation's preferred size.
+   */
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) &&
+      clutter_feature_available (CLUTTER_FEATURE_STAGE_STATIC))
+    return;
 
-  /* the remaining cases are:
-   *
-   *   - either min_height or natural_height have been set
-   *   - neither min_height or natural_height have been set
-   *
-   * in both cases, we go through the cache (and through the actor in case
-   * of cache misses) and determine the authoritative value depending on
-   * the *_set flags.
+  info = _clutter_actor_get_layout_info (self);
+
+  if (priv->min_width_set && min_width == info->minimum.width)
+    return;
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  clutter_actor_store_old_geometry (self, &old);
+
+  info->minimum.width = min_width;
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_MIN_WIDTH]);
+  clutter_actor_set_min_width_set (self, TRUE);
+
+  clutter_actor_notify_if_geometry_changed (self, &old);
+
+  g_object_thaw_notify (G_OBJECT (self));
+
+  clutter_actor_queue_relayout (self);
+}
+
+static void
+clutter_actor_set_min_height (ClutterActor *self,
+                              gfloat        min_height)
+
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox old = { 0, };
+  ClutterLayoutInfo *info;
+
+  /* if we are setting the size on a top-level actor and the
+   * backend only supports static top-levels (e.g. framebuffers)
+   * then we ignore the passed value and we override it with
+   * the stage implementation's preferred size.
    */
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) &&
+      clutter_feature_available (CLUTTER_FEATURE_STAGE_STATIC))
+    return;
 
-  if (!priv->needs_height_request)
-    {
-      found_in_cache =
-        _clutter_actor_get_cached_size_request (for_width,
-                                                priv->height_requests,
-                                                &cached_size_request);
-    }
-  else
-    {
-      found_in_cache = FALSE;
-      cached_size_request = &priv->height_requests[0];
-    }
+  info = _clutter_actor_get_layout_info (self);
 
-  if (!found_in_cache)
-    {
-      gfloat minimum_height, natural_height;
-      ClutterActorClass *klass;
+  if (priv->min_height_set && min_height == info->minimum.height)
+    return;
 
-      minimum_height = natural_height = 0;
+  g_object_freeze_notify (G_OBJECT (self));
 
-      CLUTTER_NOTE (LAYOUT, "Height request for %.2f px", for_width);
+  clutter_actor_store_old_geometry (self, &old);
 
-      /* adjust for margin */
-      if (for_width >= 0)
-        {
-          for_width -= (info->margin.left + info->margin.right);
-          if (for_width < 0)
-            for_width = 0;
-        }
+  info->minimum.height = min_height;
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_MIN_HEIGHT]);
+  clutter_actor_set_min_height_set (self, TRUE);
 
-      klass = CLUTTER_ACTOR_GET_CLASS (self);
-      klass->get_preferred_height (self, for_width,
-                                   &minimum_height,
-                                   &natural_height);
+  clutter_actor_notify_if_geometry_changed (self, &old);
 
-      /* adjust for margin */
-      minimum_height += (info->margin.top + info->margin.bottom);
-      natural_height += (info->margin.top + info->margin.bottom);
+  g_object_thaw_notify (G_OBJECT (self));
 
-      /* Due to accumulated float errors, it's better not to warn
-       * on this, but just fix it.
-       */
-      if (natural_height < minimum_height)
-	natural_height = minimum_height;
+  clutter_actor_queue_relayout (self);
+}
 
-      cached_size_request->min_size = minimum_height;
-      cached_size_request->natural_size = natural_height;
-      cached_size_request->for_size = for_width;
-      cached_size_request->age = priv->cached_height_age;
+static void
+clutter_actor_set_natural_width (ClutterActor *self,
+                                 gfloat        natural_width)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox old = { 0, };
+  ClutterLayoutInfo *info;
 
-      priv->cached_height_age += 1;
-      priv->needs_height_request = FALSE;
-    }
+  /* if we are setting the size on a top-level actor and the
+   * backend only supports static top-levels (e.g. framebuffers)
+   * then we ignore the passed value and we override it with
+   * the stage implementation's preferred size.
+   */
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) &&
+      clutter_feature_available (CLUTTER_FEATURE_STAGE_STATIC))
+    return;
 
-  if (!priv->min_height_set)
-    request_min_height = cached_size_request->min_size;
-  else
-    request_min_height = info->margin.top
-                       + info->minimum.height
-                       + info->margin.bottom;
+  info = _clutter_actor_get_layout_info (self);
 
-  if (!priv->natural_height_set)
-    request_natural_height = cached_size_request->natural_size;
-  else
-    request_natural_height = info->margin.top
-                           + info->natural.height
-                           + info->margin.bottom;
+  if (priv->natural_width_set && natural_width == info->natural.width)
+    return;
 
-  if (min_height_p)
-    *min_height_p = request_min_height;
+  g_object_freeze_notify (G_OBJECT (self));
 
-  if (natural_height_p)
-    *natural_height_p = request_natural_height;
+  clutter_actor_store_old_geometry (self, &old);
+
+  info->natural.width = natural_width;
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_NATURAL_WIDTH]);
+  clutter_actor_set_natural_width_set (self, TRUE);
+
+  clutter_actor_notify_if_geometry_changed (self, &old);
+
+  g_object_thaw_notify (G_OBJECT (self));
+
+  clutter_actor_queue_relayout (self);
 }
 
-/**
- * clutter_actor_get_allocation_box:
- * @self: A #ClutterActor
- * @box: (out): the function fills this in with the actor's allocation
- *
- * Gets the layout box an actor has been assigned. The allocation can
- * only be assumed valid inside a paint() method; anywhere else, it
- * may be out-of-date.
- *
- * <note>Do not call any of the clutter_actor_get_allocation_*() family
- * of functions inside the implementation of the get_preferred_width()
- * or get_preferred_height() virtual functions.</note>
- *
- *
- */
-void
-clutter_actor_get_allocation_box (ClutterActor    *self,
-                                  ClutterActorBox *box)
+static void
+clutter_actor_set_natural_height (ClutterActor *self,
+                                  gfloat        natural_height)
 {
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox old = { 0, };
+  ClutterLayoutInfo *info;
 
-  /* XXX - if needs_allocation=TRUE, we can either 1) g_return_if_fail,
-   * which limits calling get_allocation to inside paint() basically; or
-   * we can 2) force a layout, which could be expensive if someone calls
-   * get_allocation somewhere silly; or we can 3) just return the latest
-   * value, allowing it to be out-of-date, and assume people know what
-   * they are doing.
-   *
-   * The least-surprises approach that keeps existing code working is
-   * likely to be 2). People can end up doing some inefficient things,
-   * though, and in general code that requires 2) is probably broken.
+  /* if we are setting the size on a top-level actor and the
+   * backend only supports static top-levels (e.g. framebuffers)
+   * then we ignore the passed value and we override it with
+   * the stage implementation's preferred size.
    */
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) &&
+      clutter_feature_available (CLUTTER_FEATURE_STAGE_STATIC))
+    return;
 
-  /* this implements 2) */
-  if (G_UNLIKELY (self->priv->needs_allocation))
-    {
-      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+  info = _clutter_actor_get_layout_info (self);
+
+  if (priv->natural_height_set && natural_height == info->natural.height)
+    return;
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  clutter_actor_store_old_geometry (self, &old);
+
+  info->natural.height = natural_height;
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_NATURAL_HEIGHT]);
+  clutter_actor_set_natural_height_set (self, TRUE);
 
-      /* do not queue a relayout on an unparented actor */
-      if (stage)
-        _clutter_stage_maybe_relayout (stage);
-    }
+  clutter_actor_notify_if_geometry_changed (self, &old);
 
-  /* commenting out the code above and just keeping this assigment
-   * implements 3)
-   */
-  *box = self->priv->allocation;
+  g_object_thaw_notify (G_OBJECT (self));
+
+  clutter_actor_queue_relayout (self);
 }
 
 static void
-clutter_actor_update_constraints (ClutterActor    *self,
-                                  ClutterActorBox *allocation)
+clutter_actor_set_min_width_set (ClutterActor *self,
+                                 gboolean      use_min_width)
 {
   ClutterActorPrivate *priv = self->priv;
-  const GList *constraints, *l;
+  ClutterActorBox old = { 0, };
 
-  if (priv->constraints == NULL)
+  if (priv->min_width_set == (use_min_width != FALSE))
     return;
 
-  constraints = _clutter_meta_group_peek_metas (priv->constraints);
-  for (l = constraints; l != NULL; l = l->next)
-    {
-      ClutterConstraint *constraint = l->data;
-      ClutterActorMeta *meta = l->data;
+  clutter_actor_store_old_geometry (self, &old);
 
-      if (clutter_actor_meta_get_enabled (meta))
-        {
-          _clutter_constraint_update_allocation (constraint,
-                                                 self,
-                                                 allocation);
+  priv->min_width_set = use_min_width != FALSE;
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_MIN_WIDTH_SET]);
 
-          CLUTTER_NOTE (LAYOUT,
-                        "Allocation of '%s' after constraint '%s': "
-                        "{ %.2f, %.2f, %.2f, %.2f }",
-                        _clutter_actor_get_debug_name (self),
-                        _clutter_actor_meta_get_debug_name (meta),
-                        allocation->x1,
-                        allocation->y1,
-                        allocation->x2,
-                        allocation->y2);
-        }
-    }
+  clutter_actor_notify_if_geometry_changed (self, &old);
+
+  clutter_actor_queue_relayout (self);
 }
 
-/*< private >
- * clutter_actor_adjust_allocation:
- * @self: a #ClutterActor
- * @allocation: (inout): the allocation to adjust
- *
- * Adjusts the passed allocation box taking into account the actor's
- * layout information, like alignment, expansion, and margin.
- */
 static void
-clutter_actor_adjust_allocation (ClutterActor    *self,
-                                 ClutterActorBox *allocation)
+clutter_actor_set_min_height_set (ClutterActor *self,
+                                  gboolean      use_min_height)
 {
-  ClutterActorBox adj_allocation;
-  float alloc_width, alloc_height;
-  float min_width, min_height;
-  float nat_width, nat_height;
-  ClutterRequestMode req_mode;
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox old = { 0, };
 
-  adj_allocation = *allocation;
+  if (priv->min_height_set == (use_min_height != FALSE))
+    return;
 
-  clutter_actor_box_get_size (allocation, &alloc_width, &alloc_height);
+  clutter_actor_store_old_geometry (self, &old);
 
-  /* we want to hit the cache, so we use the public API */
-  req_mode = clutter_actor_get_request_mode (self);
+  priv->min_height_set = use_min_height != FALSE;
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_MIN_HEIGHT_SET]);
 
-  if (req_mode == CLUTTER_REQUEST_HEIGHT_FOR_WIDTH)
-    {
-      clutter_actor_get_preferred_width (self, -1,
-                                         &min_width,
-                                         &nat_width);
-      clutter_actor_get_preferred_height (self, alloc_width,
-                                          &min_height,
-                                          &nat_height);
-    }
-  else if (req_mode == CLUTTER_REQUEST_WIDTH_FOR_HEIGHT)
-    {
-      clutter_actor_get_preferred_height (self, -1,
-                                          &min_height,
-                                          &nat_height);
-      clutter_actor_get_preferred_width (self, alloc_height,
-                                         &min_width,
-                                         &nat_width);
-    }
+  clutter_actor_notify_if_geometry_changed (self, &old);
 
-#ifdef CLUTTER_ENABLE_DEBUG
-  /* warn about underallocations */
-  if (_clutter_diagnostic_enabled () &&
-      (floorf (min_width - alloc_width) > 0 ||
-       floorf (min_height - alloc_height) > 0))
-    {
-      ClutterActor *parent = clutter_actor_get_parent (self);
+  clutter_actor_queue_relayout (self);
+}
 
-      /* the only actors that are allowed to be underallocated are the Stage,
-       * as it doesn't have an implicit size, and Actors that specifically
-       * told us that they want to opt-out from layout control mechanisms
-       * through the NO_LAYOUT escape hatch.
-       */
-      if (parent != NULL &&
-          !(self->flags & CLUTTER_ACTOR_NO_LAYOUT) != 0)
-        {
-          g_warning (G_STRLOC ": The actor '%s' is getting an allocation "
-                     "of %.2f x %.2f from its parent actor '%s', but its "
-                     "requested minimum size is of %.2f x %.2f",
-                     _clutter_actor_get_debug_name (self),
-                     alloc_width, alloc_height,
-                     _clutter_actor_get_debug_name (parent),
-                     min_width, min_height);
-        }
-    }
-#endif
+static void
+clutter_actor_set_natural_width_set (ClutterActor *self,
+                                     gboolean      use_natural_width)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox old = { 0, };
 
-  clutter_actor_adjust_width (self,
-                              &min_width,
-                              &nat_width,
-                              &adj_allocation.x1,
-                              &adj_allocation.x2);
+  if (priv->natural_width_set == (use_natural_width != FALSE))
+    return;
 
-  clutter_actor_adjust_height (self,
-                               &min_height,
-                               &nat_height,
-                               &adj_allocation.y1,
-                               &adj_allocation.y2);
+  clutter_actor_store_old_geometry (self, &old);
 
-  /* we maintain the invariant that an allocation cannot be adjusted
-   * to be outside the parent-given box
-   */
-  if (adj_allocation.x1 < allocation->x1 ||
-      adj_allocation.y1 < allocation->y1 ||
-      adj_allocation.x2 > allocation->x2 ||
-      adj_allocation.y2 > allocation->y2)
-    {
-      g_warning (G_STRLOC ": The actor '%s' tried to adjust its allocation "
-                 "to { %.2f, %.2f, %.2f, %.2f }, which is outside of its "
-                 "original allocation of { %.2f, %.2f, %.2f, %.2f }",
-                 _clutter_actor_get_debug_name (self),
-                 adj_allocation.x1, adj_allocation.y1,
-                 adj_allocation.x2 - adj_allocation.x1,
-                 adj_allocation.y2 - adj_allocation.y1,
-                 allocation->x1, allocation->y1,
-                 allocation->x2 - allocation->x1,
-                 allocation->y2 - allocation->y1);
-      return;
-    }
+  priv->natural_width_set = use_natural_width != FALSE;
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_NATURAL_WIDTH_SET]);
 
-  *allocation = adj_allocation;
+  clutter_actor_notify_if_geometry_changed (self, &old);
+
+  clutter_actor_queue_relayout (self);
 }
 
 static void
-clutter_actor_allocate_internal (ClutterActor           *self,
-                                 const ClutterActorBox  *allocation,
-                                 ClutterAllocationFlags  flags)
+clutter_actor_set_natural_height_set (ClutterActor *self,
+                                      gboolean      use_natural_height)
 {
-  ClutterActorClass *klass;
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox old = { 0, };
 
-  CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IN_RELAYOUT);
+  if (priv->natural_height_set == (use_natural_height != FALSE))
+    return;
 
-  CLUTTER_NOTE (LAYOUT, "Calling %s::allocate()",
-                _clutter_actor_get_debug_name (self));
+  clutter_actor_store_old_geometry (self, &old);
 
-  klass = CLUTTER_ACTOR_GET_CLASS (self);
-  klass->allocate (self, allocation, flags);
+  priv->natural_height_set = use_natural_height != FALSE;
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_NATURAL_HEIGHT_SET]);
 
-  CLUTTER_UNSET_PRIVATE_FLAGS (self, CLUTTER_IN_RELAYOUT);
+  clutter_actor_notify_if_geometry_changed (self, &old);
 
-  /* Caller should call clutter_actor_queue_redraw() if needed
-   * for that particular case.
-   */
+  clutter_actor_queue_relayout (self);
 }
 
 /**
- * clutter_actor_allocate:
- * @self: A #ClutterActor
- * @box: new allocation of the actor, in parent-relative coordinates
- * @flags: flags that control the allocation
- *
- * Assigns the size of a #ClutterActor from the given @box.
- *
- * This function should only be called on the children of an actor when
- * overriding the #ClutterActorClass.allocate() virtual function.
- *
- * This function will adjust the stored allocation to take into account
- * the alignment flags set in the #ClutterActor:x-align and
- * #ClutterActor:y-align properties, as well as the margin values set in
- * the #ClutterActor:margin-top, #ClutterActor:margin-right,
- * #ClutterActor:margin-bottom, and #ClutterActor:margin-left properties.
+ * clutter_actor_set_request_mode:
+ * @self: a #ClutterActor
+ * @mode: the request mode
  *
- * This function will respect the easing state of the #ClutterActor and
- * interpolate between the current allocation and the new one if the
- * easing state duration is a positive value.
+ * Sets the geometry request mode of @self.
  *
- * Actors can know from their allocation box whether they have moved
- * with respect to their parent actor. The @flags parameter describes
- * additional information about the allocation, for instance whether
- * the parent has moved with respect to the stage, for example because
- * a grandparent's origin has moved.
+ * The @mode determines the order for invoking
+ * clutter_actor_get_preferred_width() and
+ * clutter_actor_get_preferred_height()
  *
  *
  */
 void
-clutter_actor_allocate (ClutterActor           *self,
-                        const ClutterActorBox  *box,
-                        ClutterAllocationFlags  flags)
+clutter_actor_set_request_mode (ClutterActor       *self,
+                                ClutterRequestMode  mode)
 {
-  ClutterActorBox old_allocation, real_allocation;
-  gboolean origin_changed, child_moved, size_changed;
-  gboolean stage_allocation_changed;
   ClutterActorPrivate *priv;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
-  if (G_UNLIKELY (_clutter_actor_get_stage_internal (self) == NULL))
-    {
-      g_warning ("Spurious clutter_actor_allocate called for actor %p/%s "
-                 "which isn't a descendent of the stage!\n",
-                 self, _clutter_actor_get_debug_name (self));
-      return;
-    }
 
   priv = self->priv;
 
-  old_allocation = priv->allocation;
-  real_allocation = *box;
+  if (priv->request_mode == mode)
+    return;
 
-  /* constraints are allowed to modify the allocation only here; we do
-   * this prior to all the other checks so that we can bail out if the
-   * allocation did not change
-   */
-  clutter_actor_update_constraints (self, &real_allocation);
+  priv->request_mode = mode;
 
-  /* adjust the allocation depending on the align/margin properties */
-  clutter_actor_adjust_allocation (self, &real_allocation);
+  priv->needs_width_request = TRUE;
+  priv->needs_height_request = TRUE;
 
-  if (real_allocation.x2 < real_allocation.x1 ||
-      real_allocation.y2 < real_allocation.y1)
-    {
-      g_warning (G_STRLOC ": Actor '%s' tried to allocate a size of %.2f x %.2f",
-                 _clutter_actor_get_debug_name (self),
-                 real_allocation.x2 - real_allocation.x1,
-                 real_allocation.y2 - real_allocation.y1);
-    }
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_REQUEST_MODE]);
 
-  /* we allow 0-sized actors, but not negative-sized ones */
-  real_allocation.x2 = MAX (real_allocation.x2, real_allocation.x1);
-  real_allocation.y2 = MAX (real_allocation.y2, real_allocation.y1);
+  clutter_actor_queue_relayout (self);
+}
 
-  origin_changed = (flags & CLUTTER_ABSOLUTE_ORIGIN_CHANGED);
+/**
+ * clutter_actor_get_request_mode:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the geometry request mode of @self
+ *
+ * Return value: the request mode for the actor
+ *
+ *
+ */
+ClutterRequestMode
+clutter_actor_get_request_mode (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self),
+                        CLUTTER_REQUEST_HEIGHT_FOR_WIDTH);
 
-  child_moved = (real_allocation.x1 != old_allocation.x1 ||
-                 real_allocation.y1 != old_allocation.y1);
+  return self->priv->request_mode;
+}
 
-  size_changed = (real_allocation.x2 != old_allocation.x2 ||
-                  real_allocation.y2 != old_allocation.y2);
+/* variant of set_width() without checks and without notification
+ * freeze+thaw, for internal usage only
+ */
+static inline void
+clutter_actor_set_width_internal (ClutterActor *self,
+                                  gfloat        width)
+{
+  if (width >= 0)
+    {
+      /* the Stage will use the :min-width to control the minimum
+       * width to be resized to, so we should not be setting it
+       * along with the :natural-width
+       */
+      if (!CLUTTER_ACTOR_IS_TOPLEVEL (self))
+        clutter_actor_set_min_width (self, width);
 
-  if (origin_changed || child_moved || size_changed)
-    stage_allocation_changed = TRUE;
+      clutter_actor_set_natural_width (self, width);
+    }
   else
-    stage_allocation_changed = FALSE;
-
-  /* If we get an allocation "out of the blue"
-   * (we did not queue relayout), then we want to
-   * ignore it. But if we have needs_allocation set,
-   * we want to guarantee that allocate() virtual
-   * method is always called, i.e. that queue_relayout()
-   * always results in an allocate() invocation on
-   * an actor.
-   *
-   * The optimization here is to avoid re-allocating
-   * actors that did not queue relayout and were
-   * not moved.
-   */
-  if (!priv->needs_allocation && !stage_allocation_changed)
     {
-      CLUTTER_NOTE (LAYOUT, "No allocation needed");
-      return;
+      /* we only unset the :natural-width for the Stage */
+      if (!CLUTTER_ACTOR_IS_TOPLEVEL (self))
+        clutter_actor_set_min_width_set (self, FALSE);
+
+      clutter_actor_set_natural_width_set (self, FALSE);
     }
+}
 
-  if (!stage_allocation_changed)
+/* variant of set_height() without checks and without notification
+ * freeze+thaw, for internal usage only
+ */
+static inline void
+clutter_actor_set_height_internal (ClutterActor *self,
+                                   gfloat        height)
+{
+  if (height >= 0)
     {
-      /* If the actor didn't move but needs_allocation is set, we just
-       * need to allocate the children */
-      clutter_actor_allocate_internal (self, &real_allocation, flags);
-      return;
-    }
+      /* see the comment above in set_width_internal() */
+      if (!CLUTTER_ACTOR_IS_TOPLEVEL (self))
+        clutter_actor_set_min_height (self, height);
 
-  /* When ABSOLUTE_ORIGIN_CHANGED is passed in to
-   * clutter_actor_allocate(), it indicates whether the parent has its
-   * absolute origin moved; when passed in to ClutterActor::allocate()
-   * virtual method though, it indicates whether the child has its
-   * absolute origin moved.  So we set it when child_moved is TRUE
-   */
-  if (child_moved)
-    flags |= CLUTTER_ABSOLUTE_ORIGIN_CHANGED;
+      clutter_actor_set_natural_height (self, height);
+    }
+  else
+    {
+      /* see the comment above in set_width_internal() */
+      if (!CLUTTER_ACTOR_IS_TOPLEVEL (self))
+        clutter_actor_set_min_height_set (self, FALSE);
 
-  /* store the flags here, so that they can be propagated by the
-   * transition code
-   */
-  self->priv->allocation_flags = flags;
+      clutter_actor_set_natural_height_set (self, FALSE);
+    }
+}
 
-  _clutter_actor_create_transition (self, obj_props[PROP_ALLOCATION],
-                                    &priv->allocation,
-                                    &real_allocation);
+static void
+clutter_actor_set_size_internal (ClutterActor      *self,
+                                 const ClutterSize *size)
+{
+  if (size != NULL)
+    {
+      clutter_actor_set_width_internal (self, size->width);
+      clutter_actor_set_height_internal (self, size->height);
+    }
+  else
+    {
+      clutter_actor_set_width_internal (self, -1);
+      clutter_actor_set_height_internal (self, -1);
+    }
 }
 
 /**
- * clutter_actor_set_allocation:
- * @self: a #ClutterActor
- * @box: a #ClutterActorBox
- * @flags: allocation flags
- *
- * Stores the allocation of @self as defined by @box.
- *
- * This function can only be called from within the implementation of
- * the #ClutterActorClass.allocate() virtual function.
- *
- * The allocation should have been adjusted to take into account constraints,
- * alignment, and margin properties. If you are implementing a #ClutterActor
- * subclass that provides its own layout management policy for its children
- * instead of using a #ClutterLayoutManager delegate, you should not call
- * this function on the children of @self; instead, you should call
- * clutter_actor_allocate(), which will adjust the allocation box for
- * you.
- *
- * This function should only be used by subclasses of #ClutterActor
- * that wish to store their allocation but cannot chain up to the
- * parent's implementation; the default implementation of the
- * #ClutterActorClass.allocate() virtual function will call this
- * function.
- *
- * It is important to note that, while chaining up was the recommended
- * behaviour for #ClutterActor subclasses prior to the introduction of
- * this function, it is recommended to call clutter_actor_set_allocation()
- * instead.
- *
- * If the #ClutterActor is using a #ClutterLayoutManager delegate object
- * to handle the allocation of its children, this function will call
- * the clutter_layout_manager_allocate() function only if the
- * %CLUTTER_DELEGATE_LAYOUT flag is set on @flags, otherwise it is
- * expected that the subclass will call clutter_layout_manager_allocate()
- * by itself. For instance, the following code:
- *
- * |[
- * static void
- * my_actor_allocate (ClutterActor *actor,
- *                    const ClutterActorBox *allocation,
- *                    ClutterAllocationFlags flags)
- * {
- *   ClutterActorBox new_alloc;
- *   ClutterAllocationFlags new_flags;
- *
- *   adjust_allocation (allocation, &amp;new_alloc);
- *
- *   new_flags = flags | CLUTTER_DELEGATE_LAYOUT;
- *
- *   /&ast; this will use the layout manager set on the actor &ast;/
- *   clutter_actor_set_allocation (actor, &amp;new_alloc, new_flags);
- * }
- * ]|
- *
- * is equivalent to this:
- *
- * |[
- * static void
- * my_actor_allocate (ClutterActor *actor,
- *                    const ClutterActorBox *allocation,
- *                    ClutterAllocationFlags flags)
- * {
- *   ClutterLayoutManager *layout;
- *   ClutterActorBox new_alloc;
- *
- *   adjust_allocation (allocation, &amp;new_alloc);
- *
- *   clutter_actor_set_allocation (actor, &amp;new_alloc, flags);
+ * clutter_actor_set_size:
+ * @self: A #ClutterActor
+ * @width: New width of actor in pixels, or -1
+ * @height: New height of actor in pixels, or -1
  *
- *   layout = clutter_actor_get_layout_manager (actor);
- *   clutter_layout_manager_allocate (layout,
- *                                    CLUTTER_CONTAINER (actor),
- *                                    &amp;new_alloc,
- *                                    flags);
- * }
- * ]|
+ * Sets the actor's size request in pixels. This overrides any
+ * "normal" size request the actor would have. For example
+ * a text actor might normally request the size of the text;
+ * this function would force a specific size instead.
  *
+ * If @width and/or @height are -1 the actor will use its
+ * "normal" size request instead of overriding it, i.e.
+ * you can "unset" the size with -1.
  *
+ * This function sets or unsets both the minimum and natural size.
  */
 void
-clutter_actor_set_allocation (ClutterActor           *self,
-                              const ClutterActorBox  *box,
-                              ClutterAllocationFlags  flags)
+clutter_actor_set_size (ClutterActor *self,
+			gfloat        width,
+			gfloat        height)
 {
-  ClutterActorPrivate *priv;
-  gboolean changed;
+  ClutterSize new_size;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
-  g_return_if_fail (box != NULL);
-
-  if (G_UNLIKELY (!CLUTTER_ACTOR_IN_RELAYOUT (self)))
-    {
-      g_critical (G_STRLOC ": The clutter_actor_set_allocation() function "
-                  "can only be called from within the implementation of "
-                  "the ClutterActor::allocate() virtual function.");
-      return;
-    }
-
-  priv = self->priv;
-
-  g_object_freeze_notify (G_OBJECT (self));
 
-  changed = clutter_actor_set_allocation_internal (self, box, flags);
+  clutter_size_init (&new_size, width, height);
 
-  /* we allocate our children before we notify changes in our geometry,
-   * so that people connecting to properties will be able to get valid
-   * data out of the sub-tree of the scene graph that has this actor at
-   * the root.
+  /* minor optimization: if we don't have a duration then we can
+   * skip the get_size() below, to avoid the chance of going through
+   * get_preferred_width() and get_preferred_height() just to jump to
+   * a new desired size
    */
-  clutter_actor_maybe_layout_children (self, box, flags);
-
-  if (changed)
+  if (clutter_actor_get_easing_duration (self) == 0)
     {
-      ClutterActorBox signal_box = priv->allocation;
-      ClutterAllocationFlags signal_flags = priv->allocation_flags;
+      g_object_freeze_notify (G_OBJECT (self));
+
+      clutter_actor_set_size_internal (self, &new_size);
+
+      g_object_thaw_notify (G_OBJECT (self));
 
-      g_signal_emit (self, actor_signals[ALLOCATION_CHANGED], 0,
-                     &signal_box,
-                     signal_flags);
+      return;
     }
+  else
+    {
+      ClutterSize cur_size;
 
-  g_object_thaw_notify (G_OBJECT (self));
+      clutter_size_init (&cur_size,
+                         clutter_actor_get_width (self),
+                         clutter_actor_get_height (self));
+
+      _clutter_actor_create_transition (self,
+                                        obj_props[PROP_SIZE],
+                                        &cur_size,
+                                        &new_size);
+    }
 }
 
 /**
- * clutter_actor_set_position:
+ * clutter_actor_get_size:
  * @self: A #ClutterActor
- * @x: New left position of actor in pixels.
- * @y: New top position of actor in pixels.
+ * @width: (out) (allow-none): return location for the width, or %NULL.
+ * @height: (out) (allow-none): return location for the height, or %NULL.
+ *
+ * This function tries to "do what you mean" and return
+ * the size an actor will have. If the actor has a valid
+ * allocation, the allocation will be returned; otherwise,
+ * the actors natural size request will be returned.
+ *
+ * If you care whether you get the request vs. the allocation, you
+ * should probably call a different function like
+ * clutter_actor_get_allocation_box() or
+ * clutter_actor_get_preferred_width().
  *
- * Sets the actor's fixed position in pixels relative to any parent
- * actor.
  *
- * If a layout manager is in use, this position will override the
- * layout manager and force a fixed position.
  */
 void
-clutter_actor_set_position (ClutterActor *self,
-			    gfloat        x,
-			    gfloat        y)
+clutter_actor_get_size (ClutterActor *self,
+			gfloat       *width,
+			gfloat       *height)
 {
-  ClutterPoint new_position;
-  ClutterPoint cur_position;
-
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  clutter_point_init (&new_position, x, y);
-
-  cur_position.x = clutter_actor_get_x (self);
-  cur_position.y = clutter_actor_get_y (self);
+  if (width)
+    *width = clutter_actor_get_width (self);
 
-  _clutter_actor_create_transition (self, obj_props[PROP_POSITION],
-                                    &cur_position,
-                                    &new_position);
+  if (height)
+    *height = clutter_actor_get_height (self);
 }
 
 /**
- * clutter_actor_get_fixed_position_set:
- * @self: A #ClutterActor
+ * clutter_actor_get_position:
+ * @self: a #ClutterActor
+ * @x: (out) (allow-none): return location for the X coordinate, or %NULL
+ * @y: (out) (allow-none): return location for the Y coordinate, or %NULL
  *
- * Checks whether an actor has a fixed position set (and will thus be
- * unaffected by any layout manager).
+ * This function tries to "do what you mean" and tell you where the
+ * actor is, prior to any transformations. Retrieves the fixed
+ * position of an actor in pixels, if one has been set; otherwise, if
+ * the allocation is valid, returns the actor's allocated position;
+ * otherwise, returns 0,0.
  *
- * Return value: %TRUE if the fixed position is set on the actor
+ * The returned position is in pixels.
  *
  *
  */
-gboolean
-clutter_actor_get_fixed_position_set (ClutterActor *self)
+void
+clutter_actor_get_position (ClutterActor *self,
+                            gfloat       *x,
+                            gfloat       *y)
 {
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  return self->priv->position_set;
+  if (x)
+    *x = clutter_actor_get_x (self);
+
+  if (y)
+    *y = clutter_actor_get_y (self);
 }
 
 /**
- * clutter_actor_set_fixed_position_set:
+ * clutter_actor_get_transformed_position:
  * @self: A #ClutterActor
- * @is_set: whether to use fixed position
+ * @x: (out) (allow-none): return location for the X coordinate, or %NULL
+ * @y: (out) (allow-none): return location for the Y coordinate, or %NULL
  *
- * Sets whether an actor has a fixed position set (and will thus be
- * unaffected by any layout manager).
+ * Gets the absolute position of an actor, in pixels relative to the stage.
  *
  *
  */
 void
-clutter_actor_set_fixed_position_set (ClutterActor *self,
-                                      gboolean      is_set)
+clutter_actor_get_transformed_position (ClutterActor *self,
+                                        gfloat       *x,
+                                        gfloat       *y)
 {
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-
-  if (self->priv->position_set == (is_set != FALSE))
-    return;
-
-  if (!is_set)
-    {
-      ClutterLayoutInfo *info;
+  ClutterVertex v1;
+  ClutterVertex v2;
 
-      /* Ensure we set back the default fixed position of 0,0 so that setting
-	 just one of x/y always atomically gets 0 for the other */
-      info = _clutter_actor_peek_layout_info (self);
-      if (info != NULL)
-	{
-	  info->fixed_pos.x = 0;
-	  info->fixed_pos.y = 0;
-	}
-    }
+  v1.x = v1.y = v1.z = 0;
+  clutter_actor_apply_transform_to_point (self, &v1, &v2);
 
-  self->priv->position_set = is_set != FALSE;
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_FIXED_POSITION_SET]);
+  if (x)
+    *x = v2.x;
 
-  clutter_actor_queue_relayout (self);
+  if (y)
+    *y = v2.y;
 }
 
 /**
- * clutter_actor_move_by:
+ * clutter_actor_get_transformed_size:
  * @self: A #ClutterActor
- * @dx: Distance to move Actor on X axis.
- * @dy: Distance to move Actor on Y axis.
+ * @width: (out) (allow-none): return location for the width, or %NULL
+ * @height: (out) (allow-none): return location for the height, or %NULL
  *
- * Changes the fixed position of an actor by @dx on the horizontal
- * axis, and by @dy on the vertical axis.
+ * Gets the absolute size of an actor in pixels, taking into account the
+ * scaling factors.
+ *
+ * If the actor has a valid allocation, the allocated size will be used.
+ * If the actor has not a valid allocation then the preferred size will
+ * be transformed and returned.
+ *
+ * If you want the transformed allocation, see
+ * clutter_actor_get_abs_allocation_vertices() instead.
+ *
+ * <note>When the actor (or one of its ancestors) is rotated around the
+ * X or Y axis, it no longer appears as on the stage as a rectangle, but
+ * as a generic quadrangle; in that case this function returns the size
+ * of the smallest rectangle that encapsulates the entire quad. Please
+ * note that in this case no assumptions can be made about the relative
+ * position of this envelope to the absolute position of the actor, as
+ * returned by clutter_actor_get_transformed_position(); if you need this
+ * information, you need to use clutter_actor_get_abs_allocation_vertices()
+ * to get the coords of the actual quadrangle.</note>
  *
  *
  */
 void
-clutter_actor_move_by (ClutterActor *self,
-		       gfloat        dx,
-		       gfloat        dy)
+clutter_actor_get_transformed_size (ClutterActor *self,
+                                    gfloat       *width,
+                                    gfloat       *height)
 {
-  const ClutterLayoutInfo *info;
-  gfloat x, y;
+  ClutterActorPrivate *priv;
+  ClutterVertex v[4];
+  gfloat x_min, x_max, y_min, y_max;
+  gint i;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  info = _clutter_actor_get_layout_info_or_defaults (self);
-  x = info->fixed_pos.x;
-  y = info->fixed_pos.y;
-
-  clutter_actor_set_position (self, x + dx, y + dy);
-}
-
-static void
-clutter_actor_set_min_width (ClutterActor *self,
-                             gfloat        min_width)
-{
-  ClutterActorPrivate *priv = self->priv;
-  ClutterActorBox old = { 0, };
-  ClutterLayoutInfo *info;
+  priv = self->priv;
 
-  /* if we are setting the size on a top-level actor and the
-   * backend only supports static top-levels (e.g. framebuffers)
-   * then we ignore the passed value and we override it with
-   * the stage implementation's preferred size.
+  /* if the actor hasn't been allocated yet, get the preferred
+   * size and transform that
    */
-  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) &&
-      clutter_feature_available (CLUTTER_FEATURE_STAGE_STATIC))
-    return;
-
-  info = _clutter_actor_get_layout_info (self);
-
-  if (priv->min_width_set && min_width == info->minimum.width)
-    return;
-
-  g_object_freeze_notify (G_OBJECT (self));
-
-  clutter_actor_store_old_geometry (self, &old);
-
-  info->minimum.width = min_width;
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_MIN_WIDTH]);
-  clutter_actor_set_min_width_set (self, TRUE);
-
-  clutter_actor_notify_if_geometry_changed (self, &old);
-
-  g_object_thaw_notify (G_OBJECT (self));
+  if (priv->needs_allocation)
+    {
+      gfloat natural_width, natural_height;
+      ClutterActorBox box;
 
-  clutter_actor_queue_relayout (self);
-}
+      /* Make a fake allocation to transform.
+       *
+       * NB: _clutter_actor_transform_and_project_box expects a box in
+       * the actor's coordinate space... */
 
-static void
-clutter_actor_set_min_height (ClutterActor *self,
-                              gfloat        min_height)
+      box.x1 = 0;
+      box.y1 = 0;
 
-{
-  ClutterActorPrivate *priv = self->priv;
-  ClutterActorBox old = { 0, };
-  ClutterLayoutInfo *info;
+      natural_width = natural_height = 0;
+      clutter_actor_get_preferred_size (self, NULL, NULL,
+                                        &natural_width,
+                                        &natural_height);
 
-  /* if we are setting the size on a top-level actor and the
-   * backend only supports static top-levels (e.g. framebuffers)
-   * then we ignore the passed value and we override it with
-   * the stage implementation's preferred size.
-   */
-  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) &&
-      clutter_feature_available (CLUTTER_FEATURE_STAGE_STATIC))
-    return;
+      box.x2 = natural_width;
+      box.y2 = natural_height;
 
-  info = _clutter_actor_get_layout_info (self);
+      _clutter_actor_transform_and_project_box (self, &box, v);
+    }
+  else
+    clutter_actor_get_abs_allocation_vertices (self, v);
 
-  if (priv->min_height_set && min_height == info->minimum.height)
-    return;
+  x_min = x_max = v[0].x;
+  y_min = y_max = v[0].y;
 
-  g_object_freeze_notify (G_OBJECT (self));
+  for (i = 1; i < G_N_ELEMENTS (v); ++i)
+    {
+      if (v[i].x < x_min)
+	x_min = v[i].x;
 
-  clutter_actor_store_old_geometry (self, &old);
+      if (v[i].x > x_max)
+	x_max = v[i].x;
 
-  info->minimum.height = min_height;
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_MIN_HEIGHT]);
-  clutter_actor_set_min_height_set (self, TRUE);
+      if (v[i].y < y_min)
+	y_min = v[i].y;
 
-  clutter_actor_notify_if_geometry_changed (self, &old);
+      if (v[i].y > y_max)
+	y_max = v[i].y;
+    }
 
-  g_object_thaw_notify (G_OBJECT (self));
+  if (width)
+    *width  = x_max - x_min;
 
-  clutter_actor_queue_relayout (self);
+  if (height)
+    *height = y_max - y_min;
 }
 
-static void
-clutter_actor_set_natural_width (ClutterActor *self,
-                                 gfloat        natural_width)
+/**
+ * clutter_actor_get_width:
+ * @self: A #ClutterActor
+ *
+ * Retrieves the width of a #ClutterActor.
+ *
+ * If the actor has a valid allocation, this function will return the
+ * width of the allocated area given to the actor.
+ *
+ * If the actor does not have a valid allocation, this function will
+ * return the actor's natural width, that is the preferred width of
+ * the actor.
+ *
+ * If you care whether you get the preferred width or the width that
+ * has been assigned to the actor, you should probably call a different
+ * function like clutter_actor_get_allocation_box() to retrieve the
+ * allocated size or clutter_actor_get_preferred_width() to retrieve the
+ * preferred width.
+ *
+ * If an actor has a fixed width, for instance a width that has been
+ * assigned using clutter_actor_set_width(), the width returned will
+ * be the same value.
+ *
+ * Return value: the width of the actor, in pixels
+ */
+gfloat
+clutter_actor_get_width (ClutterActor *self)
 {
-  ClutterActorPrivate *priv = self->priv;
-  ClutterActorBox old = { 0, };
-  ClutterLayoutInfo *info;
+  ClutterActorPrivate *priv;
 
-  /* if we are setting the size on a top-level actor and the
-   * backend only supports static top-levels (e.g. framebuffers)
-   * then we ignore the passed value and we override it with
-   * the stage implementation's preferred size.
-   */
-  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) &&
-      clutter_feature_available (CLUTTER_FEATURE_STAGE_STATIC))
-    return;
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
 
-  info = _clutter_actor_get_layout_info (self);
+  priv = self->priv;
 
-  if (priv->natural_width_set && natural_width == info->natural.width)
-    return;
+  if (priv->needs_allocation)
+    {
+      gfloat natural_width = 0;
 
-  g_object_freeze_notify (G_OBJECT (self));
+      if (self->priv->request_mode == CLUTTER_REQUEST_HEIGHT_FOR_WIDTH)
+        clutter_actor_get_preferred_width (self, -1, NULL, &natural_width);
+      else
+        {
+          gfloat natural_height = 0;
 
-  clutter_actor_store_old_geometry (self, &old);
+          clutter_actor_get_preferred_height (self, -1, NULL, &natural_height);
+          clutter_actor_get_preferred_width (self, natural_height,
+                                             NULL,
+                                             &natural_width);
+        }
 
-  info->natural.width = natural_width;
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_NATURAL_WIDTH]);
-  clutter_actor_set_natural_width_set (self, TRUE);
+      return natural_width;
+    }
+  else
+    return priv->allocation.x2 - priv->allocation.x1;
+}
 
-  clutter_actor_notify_if_geometry_changed (self, &old);
+/**
+ * clutter_actor_get_height:
+ * @self: A #ClutterActor
+ *
+ * Retrieves the height of a #ClutterActor.
+ *
+ * If the actor has a valid allocation, this function will return the
+ * height of the allocated area given to the actor.
+ *
+ * If the actor does not have a valid allocation, this function will
+ * return the actor's natural height, that is the preferred height of
+ * the actor.
+ *
+ * If you care whether you get the preferred height or the height that
+ * has been assigned to the actor, you should probably call a different
+ * function like clutter_actor_get_allocation_box() to retrieve the
+ * allocated size or clutter_actor_get_preferred_height() to retrieve the
+ * preferred height.
+ *
+ * If an actor has a fixed height, for instance a height that has been
+ * assigned using clutter_actor_set_height(), the height returned will
+ * be the same value.
+ *
+ * Return value: the height of the actor, in pixels
+ */
+gfloat
+clutter_actor_get_height (ClutterActor *self)
+{
+  ClutterActorPrivate *priv;
 
-  g_object_thaw_notify (G_OBJECT (self));
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
 
-  clutter_actor_queue_relayout (self);
-}
+  priv = self->priv;
 
-static void
-clutter_actor_set_natural_height (ClutterActor *self,
-                                  gfloat        natural_height)
-{
-  ClutterActorPrivate *priv = self->priv;
-  ClutterActorBox old = { 0, };
-  ClutterLayoutInfo *info;
+  if (priv->needs_allocation)
+    {
+      gfloat natural_height = 0;
 
-  /* if we are setting the size on a top-level actor and the
-   * backend only supports static top-levels (e.g. framebuffers)
-   * then we ignore the passed value and we override it with
-   * the stage implementation's preferred size.
-   */
-  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) &&
-      clutter_feature_available (CLUTTER_FEATURE_STAGE_STATIC))
-    return;
+      if (priv->request_mode == CLUTTER_REQUEST_HEIGHT_FOR_WIDTH)
+        {
+          gfloat natural_width = 0;
 
-  info = _clutter_actor_get_layout_info (self);
+          clutter_actor_get_preferred_width (self, -1, NULL, &natural_width);
+          clutter_actor_get_preferred_height (self, natural_width,
+                                              NULL, &natural_height);
+        }
+      else
+        clutter_actor_get_preferred_height (self, -1, NULL, &natural_height);
 
-  if (priv->natural_height_set && natural_height == info->natural.height)
-    return;
+      return natural_height;
+    }
+  else
+    return priv->allocation.y2 - priv->allocation.y1;
+}
 
-  g_object_freeze_notify (G_OBJECT (self));
+/**
+ * clutter_actor_set_width:
+ * @self: A #ClutterActor
+ * @width: Requested new width for the actor, in pixels, or -1
+ *
+ * Forces a width on an actor, causing the actor's preferred width
+ * and height (if any) to be ignored.
+ *
+ * If @width is -1 the actor will use its preferred width request
+ * instead of overriding it, i.e. you can "unset" the width with -1.
+ *
+ * This function sets both the minimum and natural size of the actor.
+ *
+ * since: 0.2
+ */
+void
+clutter_actor_set_width (ClutterActor *self,
+                         gfloat        width)
+{
+  float cur_size;
 
-  clutter_actor_store_old_geometry (self, &old);
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  info->natural.height = natural_height;
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_NATURAL_HEIGHT]);
-  clutter_actor_set_natural_height_set (self, TRUE);
+  /* minor optimization: if we don't have a duration
+   * then we can skip the get_width() below, to avoid
+   * the chance of going through get_preferred_width()
+   * just to jump to a new desired width.
+   */
+  if (clutter_actor_get_easing_duration (self) == 0)
+    {
+      g_object_freeze_notify (G_OBJECT (self));
 
-  clutter_actor_notify_if_geometry_changed (self, &old);
+      clutter_actor_set_width_internal (self, width);
 
-  g_object_thaw_notify (G_OBJECT (self));
+      g_object_thaw_notify (G_OBJECT (self));
 
-  clutter_actor_queue_relayout (self);
+      return;
+    }
+  else
+    cur_size = clutter_actor_get_width (self);
+
+  _clutter_actor_create_transition (self,
+                                    obj_props[PROP_WIDTH],
+                                    cur_size,
+                                    width);
 }
 
-static void
-clutter_actor_set_min_width_set (ClutterActor *self,
-                                 gboolean      use_min_width)
+/**
+ * clutter_actor_set_height:
+ * @self: A #ClutterActor
+ * @height: Requested new height for the actor, in pixels, or -1
+ *
+ * Forces a height on an actor, causing the actor's preferred width
+ * and height (if any) to be ignored.
+ *
+ * If @height is -1 the actor will use its preferred height instead of
+ * overriding it, i.e. you can "unset" the height with -1.
+ *
+ * This function sets both the minimum and natural size of the actor.
+ *
+ * since: 0.2
+ */
+void
+clutter_actor_set_height (ClutterActor *self,
+                          gfloat        height)
 {
-  ClutterActorPrivate *priv = self->priv;
-  ClutterActorBox old = { 0, };
+  float cur_size;
 
-  if (priv->min_width_set == (use_min_width != FALSE))
-    return;
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  clutter_actor_store_old_geometry (self, &old);
+  /* see the comment in clutter_actor_set_width() above */
+  if (clutter_actor_get_easing_duration (self) == 0)
+    {
+      g_object_freeze_notify (G_OBJECT (self));
 
-  priv->min_width_set = use_min_width != FALSE;
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_MIN_WIDTH_SET]);
+      clutter_actor_set_height_internal (self, height);
 
-  clutter_actor_notify_if_geometry_changed (self, &old);
+      g_object_thaw_notify (G_OBJECT (self));
 
-  clutter_actor_queue_relayout (self);
+      return;
+    }
+  else
+    cur_size = clutter_actor_get_height (self);
+
+  _clutter_actor_create_transition (self,
+                                    obj_props[PROP_HEIGHT],
+                                    cur_size,
+                                    height);
 }
 
-static void
-clutter_actor_set_min_height_set (ClutterActor *self,
-                                  gboolean      use_min_height)
+static inline void
+clutter_actor_set_x_internal (ClutterActor *self,
+                              float         x)
 {
   ClutterActorPrivate *priv = self->priv;
+  ClutterLayoutInfo *linfo;
   ClutterActorBox old = { 0, };
 
-  if (priv->min_height_set == (use_min_height != FALSE))
+  linfo = _clutter_actor_get_layout_info (self);
+
+  if (priv->position_set && linfo->fixed_pos.x == x)
     return;
 
   clutter_actor_store_old_geometry (self, &old);
 
-  priv->min_height_set = use_min_height != FALSE;
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_MIN_HEIGHT_SET]);
+  linfo->fixed_pos.x = x;
+  clutter_actor_set_fixed_position_set (self, TRUE);
 
   clutter_actor_notify_if_geometry_changed (self, &old);
 
-  clutter_actor_queue_relayout (self);
+  /* moving the actor does not change its contents */
+  _clutter_actor_queue_only_relayout (self);
+  clutter_actor_queue_transform_redraw (self);
 }
 
-static void
-clutter_actor_set_natural_width_set (ClutterActor *self,
-                                     gboolean      use_natural_width)
+static inline void
+clutter_actor_set_y_internal (ClutterActor *self,
+                              float         y)
 {
   ClutterActorPrivate *priv = self->priv;
+  ClutterLayoutInfo *linfo;
   ClutterActorBox old = { 0, };
 
-  if (priv->natural_width_set == (use_natural_width != FALSE))
+  linfo = _clutter_actor_get_layout_info (self);
+
+  if (priv->position_set && linfo->fixed_pos.y == y)
     return;
 
   clutter_actor_store_old_geometry (self, &old);
 
-  priv->natural_width_set = use_natural_width != FALSE;
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_NATURAL_WIDTH_SET]);
+  linfo->fixed_pos.y = y;
+  clutter_actor_set_fixed_position_set (self, TRUE);
 
   clutter_actor_notify_if_geometry_changed (self, &old);
 
-  clutter_actor_queue_relayout (self);
+  /* moving the actor does not change its contents */
+  _clutter_actor_queue_only_relayout (self);
+  clutter_actor_queue_transform_redraw (self);
 }
 
 static void
-clutter_actor_set_natural_height_set (ClutterActor *self,
-                                      gboolean      use_natural_height)
+clutter_actor_set_position_internal (ClutterActor       *self,
+                                     const ClutterPoint *position)
 {
   ClutterActorPrivate *priv = self->priv;
+  ClutterLayoutInfo *linfo;
   ClutterActorBox old = { 0, };
 
-  if (priv->natural_height_set == (use_natural_height != FALSE))
+  linfo = _clutter_actor_get_layout_info (self);
+
+  if (priv->position_set &&
+      clutter_point_equals (position, &linfo->fixed_pos))
     return;
 
   clutter_actor_store_old_geometry (self, &old);
 
-  priv->natural_height_set = use_natural_height != FALSE;
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_NATURAL_HEIGHT_SET]);
+  if (position != NULL)
+    {
+      linfo->fixed_pos = *position;
+      clutter_actor_set_fixed_position_set (self, TRUE);
+    }
+  else
+    clutter_actor_set_fixed_position_set (self, FALSE);
 
   clutter_actor_notify_if_geometry_changed (self, &old);
 
@@ -9366,3421 +13050,3762 @@ clutter_actor_set_natural_height_set (ClutterActor *self,
 }
 
 /**
- * clutter_actor_set_request_mode:
+ * clutter_actor_set_x:
  * @self: a #ClutterActor
- * @mode: the request mode
+ * @x: the actor's position on the X axis
  *
- * Sets the geometry request mode of @self.
+ * Sets the actor's X coordinate, relative to its parent, in pixels.
  *
- * The @mode determines the order for invoking
- * clutter_actor_get_preferred_width() and
- * clutter_actor_get_preferred_height()
+ * Overrides any layout manager and forces a fixed position for
+ * the actor.
+ *
+ * The #ClutterActor:x property is animatable.
  *
  *
  */
 void
-clutter_actor_set_request_mode (ClutterActor       *self,
-                                ClutterRequestMode  mode)
+clutter_actor_set_x (ClutterActor *self,
+                     gfloat        x)
 {
-  ClutterActorPrivate *priv;
+  float cur_position = clutter_actor_get_x (self);
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  priv = self->priv;
-
-  if (priv->request_mode == mode)
-    return;
-
-  priv->request_mode = mode;
-
-  priv->needs_width_request = TRUE;
-  priv->needs_height_request = TRUE;
-
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_REQUEST_MODE]);
-
-  clutter_actor_queue_relayout (self);
+  _clutter_actor_create_transition (self, obj_props[PROP_X],
+                                    cur_position,
+                                    x);
 }
 
 /**
- * clutter_actor_get_request_mode:
+ * clutter_actor_set_y:
  * @self: a #ClutterActor
+ * @y: the actor's position on the Y axis
  *
- * Retrieves the geometry request mode of @self
+ * Sets the actor's Y coordinate, relative to its parent, in pixels.#
  *
- * Return value: the request mode for the actor
+ * Overrides any layout manager and forces a fixed position for
+ * the actor.
+ *
+ * The #ClutterActor:y property is animatable.
  *
  *
  */
-ClutterRequestMode
-clutter_actor_get_request_mode (ClutterActor *self)
+void
+clutter_actor_set_y (ClutterActor *self,
+                     gfloat        y)
 {
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self),
-                        CLUTTER_REQUEST_HEIGHT_FOR_WIDTH);
+  float cur_position = clutter_actor_get_y (self);
 
-  return self->priv->request_mode;
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  _clutter_actor_create_transition (self, obj_props[PROP_Y],
+                                    cur_position,
+                                    y);
 }
 
-/* variant of set_width() without checks and without notification
- * freeze+thaw, for internal usage only
+/**
+ * clutter_actor_get_x:
+ * @self: A #ClutterActor
+ *
+ * Retrieves the X coordinate of a #ClutterActor.
+ *
+ * This function tries to "do what you mean", by returning the
+ * correct value depending on the actor's state.
+ *
+ * If the actor has a valid allocation, this function will return
+ * the X coordinate of the origin of the allocation box.
+ *
+ * If the actor has any fixed coordinate set using clutter_actor_set_x(),
+ * clutter_actor_set_position() or clutter_actor_set_geometry(), this
+ * function will return that coordinate.
+ *
+ * If both the allocation and a fixed position are missing, this function
+ * will return 0.
+ *
+ * Return value: the X coordinate, in pixels, ignoring any
+ *   transformation (i.e. scaling, rotation)
  */
-static inline void
-clutter_actor_set_width_internal (ClutterActor *self,
-                                  gfloat        width)
+gfloat
+clutter_actor_get_x (ClutterActor *self)
 {
-  if (width >= 0)
-    {
-      /* the Stage will use the :min-width to control the minimum
-       * width to be resized to, so we should not be setting it
-       * along with the :natural-width
-       */
-      if (!CLUTTER_ACTOR_IS_TOPLEVEL (self))
-        clutter_actor_set_min_width (self, width);
-
-      clutter_actor_set_natural_width (self, width);
-    }
-  else
-    {
-      /* we only unset the :natural-width for the Stage */
-      if (!CLUTTER_ACTOR_IS_TOPLEVEL (self))
-        clutter_actor_set_min_width_set (self, FALSE);
+  ClutterActorPrivate *priv;
 
-      clutter_actor_set_natural_width_set (self, FALSE);
-    }
-}
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
 
-/* variant of set_height() without checks and without notification
- * freeze+thaw, for internal usage only
- */
-static inline void
-clutter_actor_set_height_internal (ClutterActor *self,
-                                   gfloat        height)
-{
-  if (height >= 0)
-    {
-      /* see the comment above in set_width_internal() */
-      if (!CLUTTER_ACTOR_IS_TOPLEVEL (self))
-        clutter_actor_set_min_height (self, height);
+  priv = self->priv;
 
-      clutter_actor_set_natural_height (self, height);
-    }
-  else
+  if (priv->needs_allocation)
     {
-      /* see the comment above in set_width_internal() */
-      if (!CLUTTER_ACTOR_IS_TOPLEVEL (self))
-        clutter_actor_set_min_height_set (self, FALSE);
+      if (priv->position_set)
+        {
+          const ClutterLayoutInfo *info;
 
-      clutter_actor_set_natural_height_set (self, FALSE);
-    }
-}
+          info = _clutter_actor_get_layout_info_or_defaults (self);
 
-static void
-clutter_actor_set_size_internal (ClutterActor      *self,
-                                 const ClutterSize *size)
-{
-  if (size != NULL)
-    {
-      clutter_actor_set_width_internal (self, size->width);
-      clutter_actor_set_height_internal (self, size->height);
+          return info->fixed_pos.x;
+        }
+      else
+        return 0;
     }
   else
-    {
-      clutter_actor_set_width_internal (self, -1);
-      clutter_actor_set_height_internal (self, -1);
-    }
+    return priv->allocation.x1;
 }
 
 /**
- * clutter_actor_set_size:
+ * clutter_actor_get_y:
  * @self: A #ClutterActor
- * @width: New width of actor in pixels, or -1
- * @height: New height of actor in pixels, or -1
  *
- * Sets the actor's size request in pixels. This overrides any
- * "normal" size request the actor would have. For example
- * a text actor might normally request the size of the text;
- * this function would force a specific size instead.
+ * Retrieves the Y coordinate of a #ClutterActor.
  *
- * If @width and/or @height are -1 the actor will use its
- * "normal" size request instead of overriding it, i.e.
- * you can "unset" the size with -1.
+ * This function tries to "do what you mean", by returning the
+ * correct value depending on the actor's state.
  *
- * This function sets or unsets both the minimum and natural size.
+ * If the actor has a valid allocation, this function will return
+ * the Y coordinate of the origin of the allocation box.
+ *
+ * If the actor has any fixed coordinate set using clutter_actor_set_y(),
+ * clutter_actor_set_position() or clutter_actor_set_geometry(), this
+ * function will return that coordinate.
+ *
+ * If both the allocation and a fixed position are missing, this function
+ * will return 0.
+ *
+ * Return value: the Y coordinate, in pixels, ignoring any
+ *   transformation (i.e. scaling, rotation)
  */
-void
-clutter_actor_set_size (ClutterActor *self,
-			gfloat        width,
-			gfloat        height)
+gfloat
+clutter_actor_get_y (ClutterActor *self)
 {
-  ClutterSize new_size;
-
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-
-  clutter_size_init (&new_size, width, height);
-
-  /* minor optimization: if we don't have a duration then we can
-   * skip the get_size() below, to avoid the chance of going through
-   * get_preferred_width() and get_preferred_height() just to jump to
-   * a new desired size
-   */
-  if (clutter_actor_get_easing_duration (self) == 0)
-    {
-      g_object_freeze_notify (G_OBJECT (self));
+  ClutterActorPrivate *priv;
 
-      clutter_actor_set_size_internal (self, &new_size);
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
 
-      g_object_thaw_notify (G_OBJECT (self));
+  priv = self->priv;
 
-      return;
-    }
-  else
+  if (priv->needs_allocation)
     {
-      ClutterSize cur_size;
+      if (priv->position_set)
+        {
+          const ClutterLayoutInfo *info;
 
-      clutter_size_init (&cur_size,
-                         clutter_actor_get_width (self),
-                         clutter_actor_get_height (self));
+          info = _clutter_actor_get_layout_info_or_defaults (self);
 
-      _clutter_actor_create_transition (self,
-                                        obj_props[PROP_SIZE],
-                                        &cur_size,
-                                        &new_size);
+          return info->fixed_pos.y;
+        }
+      else
+        return 0;
     }
+  else
+    return priv->allocation.y1;
 }
 
 /**
- * clutter_actor_get_size:
+ * clutter_actor_set_scale:
  * @self: A #ClutterActor
- * @width: (out) (allow-none): return location for the width, or %NULL.
- * @height: (out) (allow-none): return location for the height, or %NULL.
+ * @scale_x: double factor to scale actor by horizontally.
+ * @scale_y: double factor to scale actor by vertically.
  *
- * This function tries to "do what you mean" and return
- * the size an actor will have. If the actor has a valid
- * allocation, the allocation will be returned; otherwise,
- * the actors natural size request will be returned.
+ * Scales an actor with the given factors.
  *
- * If you care whether you get the request vs. the allocation, you
- * should probably call a different function like
- * clutter_actor_get_allocation_box() or
- * clutter_actor_get_preferred_width().
+ * The scale transformation is relative the the #ClutterActor:pivot-point.
+ *
+ * The #ClutterActor:scale-x and #ClutterActor:scale-y properties are
+ * animatable.
  *
  *
  */
 void
-clutter_actor_get_size (ClutterActor *self,
-			gfloat       *width,
-			gfloat       *height)
+clutter_actor_set_scale (ClutterActor *self,
+                         gdouble       scale_x,
+                         gdouble       scale_y)
 {
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  if (width)
-    *width = clutter_actor_get_width (self);
+  g_object_freeze_notify (G_OBJECT (self));
 
-  if (height)
-    *height = clutter_actor_get_height (self);
+  clutter_actor_set_scale_factor (self, CLUTTER_X_AXIS, scale_x);
+  clutter_actor_set_scale_factor (self, CLUTTER_Y_AXIS, scale_y);
+
+  g_object_thaw_notify (G_OBJECT (self));
 }
 
 /**
- * clutter_actor_get_position:
+ * clutter_actor_set_scale_z:
  * @self: a #ClutterActor
- * @x: (out) (allow-none): return location for the X coordinate, or %NULL
- * @y: (out) (allow-none): return location for the Y coordinate, or %NULL
+ * @scale_z: the scaling factor along the Z axis
  *
- * This function tries to "do what you mean" and tell you where the
- * actor is, prior to any transformations. Retrieves the fixed
- * position of an actor in pixels, if one has been set; otherwise, if
- * the allocation is valid, returns the actor's allocated position;
- * otherwise, returns 0,0.
+ * Scales an actor on the Z axis by the given @scale_z factor.
  *
- * The returned position is in pixels.
+ * The scale transformation is relative the the #ClutterActor:pivot-point.
+ *
+ * The #ClutterActor:scale-z property is animatable.
  *
  *
  */
 void
-clutter_actor_get_position (ClutterActor *self,
-                            gfloat       *x,
-                            gfloat       *y)
+clutter_actor_set_scale_z (ClutterActor *self,
+                           gdouble       scale_z)
 {
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  if (x)
-    *x = clutter_actor_get_x (self);
-
-  if (y)
-    *y = clutter_actor_get_y (self);
+  clutter_actor_set_scale_factor (self, CLUTTER_Z_AXIS, scale_z);
 }
 
 /**
- * clutter_actor_get_transformed_position:
+ * clutter_actor_get_scale:
  * @self: A #ClutterActor
- * @x: (out) (allow-none): return location for the X coordinate, or %NULL
- * @y: (out) (allow-none): return location for the Y coordinate, or %NULL
+ * @scale_x: (out) (allow-none): Location to store horizonal
+ *   scale factor, or %NULL.
+ * @scale_y: (out) (allow-none): Location to store vertical
+ *   scale factor, or %NULL.
  *
- * Gets the absolute position of an actor, in pixels relative to the stage.
+ * Retrieves an actors scale factors.
  *
  *
  */
 void
-clutter_actor_get_transformed_position (ClutterActor *self,
-                                        gfloat       *x,
-                                        gfloat       *y)
+clutter_actor_get_scale (ClutterActor *self,
+			 gdouble      *scale_x,
+			 gdouble      *scale_y)
 {
-  ClutterVertex v1;
-  ClutterVertex v2;
+  const ClutterTransformInfo *info;
 
-  v1.x = v1.y = v1.z = 0;
-  clutter_actor_apply_transform_to_point (self, &v1, &v2);
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  if (x)
-    *x = v2.x;
+  info = _clutter_actor_get_transform_info_or_defaults (self);
 
-  if (y)
-    *y = v2.y;
+  if (scale_x)
+    *scale_x = info->scale_x;
+
+  if (scale_y)
+    *scale_y = info->scale_y;
 }
 
 /**
- * clutter_actor_get_transformed_size:
+ * clutter_actor_get_scale_z:
  * @self: A #ClutterActor
- * @width: (out) (allow-none): return location for the width, or %NULL
- * @height: (out) (allow-none): return location for the height, or %NULL
- *
- * Gets the absolute size of an actor in pixels, taking into account the
- * scaling factors.
- *
- * If the actor has a valid allocation, the allocated size will be used.
- * If the actor has not a valid allocation then the preferred size will
- * be transformed and returned.
  *
- * If you want the transformed allocation, see
- * clutter_actor_get_abs_allocation_vertices() instead.
+ * Retrieves the scaling factor along the Z axis, as set using
+ * clutter_actor_set_scale_z().
  *
- * <note>When the actor (or one of its ancestors) is rotated around the
- * X or Y axis, it no longer appears as on the stage as a rectangle, but
- * as a generic quadrangle; in that case this function returns the size
- * of the smallest rectangle that encapsulates the entire quad. Please
- * note that in this case no assumptions can be made about the relative
- * position of this envelope to the absolute position of the actor, as
- * returned by clutter_actor_get_transformed_position(); if you need this
- * information, you need to use clutter_actor_get_abs_allocation_vertices()
- * to get the coords of the actual quadrangle.</note>
+ * Return value: the scaling factor along the Z axis
  *
  *
  */
-void
-clutter_actor_get_transformed_size (ClutterActor *self,
-                                    gfloat       *width,
-                                    gfloat       *height)
+gdouble
+clutter_actor_get_scale_z (ClutterActor *self)
 {
-  ClutterActorPrivate *priv;
-  ClutterVertex v[4];
-  gfloat x_min, x_max, y_min, y_max;
-  gint i;
-
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-
-  priv = self->priv;
-
-  /* if the actor hasn't been allocated yet, get the preferred
-   * size and transform that
-   */
-  if (priv->needs_allocation)
-    {
-      gfloat natural_width, natural_height;
-      ClutterActorBox box;
-
-      /* Make a fake allocation to transform.
-       *
-       * NB: _clutter_actor_transform_and_project_box expects a box in
-       * the actor's coordinate space... */
-
-      box.x1 = 0;
-      box.y1 = 0;
-
-      natural_width = natural_height = 0;
-      clutter_actor_get_preferred_size (self, NULL, NULL,
-                                        &natural_width,
-                                        &natural_height);
-
-      box.x2 = natural_width;
-      box.y2 = natural_height;
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 1.0);
 
-      _clutter_actor_transform_and_project_box (self, &box, v);
-    }
-  else
-    clutter_actor_get_abs_allocation_vertices (self, v);
+  return _clutter_actor_get_transform_info_or_defaults (self)->scale_z;
+}
 
-  x_min = x_max = v[0].x;
-  y_min = y_max = v[0].y;
+static inline void
+clutter_actor_set_opacity_internal (ClutterActor *self,
+                                    guint8        opacity)
+{
+  ClutterActorPrivate *priv = self->priv;
 
-  for (i = 1; i < G_N_ELEMENTS (v); ++i)
+  if (priv->opacity != opacity)
     {
-      if (v[i].x < x_min)
-	x_min = v[i].x;
-
-      if (v[i].x > x_max)
-	x_max = v[i].x;
+      priv->opacity = opacity;
 
-      if (v[i].y < y_min)
-	y_min = v[i].y;
+      /* Queue a redraw from the flatten effect so that it can use
+         its cached image if available instead of having to redraw the
+         actual actor. If it doesn't end up using the FBO then the
+         effect is still able to continue the paint anyway. If there
+         is no flatten effect yet then this is equivalent to queueing
+         a full redraw */
+      _clutter_actor_queue_redraw_full (self,
+                                        0, /* flags */
+                                        NULL, /* clip */
+                                        priv->flatten_effect);
 
-      if (v[i].y > y_max)
-	y_max = v[i].y;
+      g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_OPACITY]);
     }
-
-  if (width)
-    *width  = x_max - x_min;
-
-  if (height)
-    *height = y_max - y_min;
 }
 
 /**
- * clutter_actor_get_width:
+ * clutter_actor_set_opacity:
  * @self: A #ClutterActor
+ * @opacity: New opacity value for the actor.
  *
- * Retrieves the width of a #ClutterActor.
- *
- * If the actor has a valid allocation, this function will return the
- * width of the allocated area given to the actor.
+ * Sets the actor's opacity, with zero being completely transparent and
+ * 255 (0xff) being fully opaque.
  *
- * If the actor does not have a valid allocation, this function will
- * return the actor's natural width, that is the preferred width of
- * the actor.
+ * The #ClutterActor:opacity property is animatable.
+ */
+void
+clutter_actor_set_opacity (ClutterActor *self,
+			   guint8        opacity)
+{
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  _clutter_actor_create_transition (self, obj_props[PROP_OPACITY],
+                                    self->priv->opacity,
+                                    opacity);
+}
+
+/*
+ * clutter_actor_get_paint_opacity_internal:
+ * @self: a #ClutterActor
  *
- * If you care whether you get the preferred width or the width that
- * has been assigned to the actor, you should probably call a different
- * function like clutter_actor_get_allocation_box() to retrieve the
- * allocated size or clutter_actor_get_preferred_width() to retrieve the
- * preferred width.
+ * Retrieves the absolute opacity of the actor, as it appears on the stage
  *
- * If an actor has a fixed width, for instance a width that has been
- * assigned using clutter_actor_set_width(), the width returned will
- * be the same value.
+ * This function does not do type checks
  *
- * Return value: the width of the actor, in pixels
+ * Return value: the absolute opacity of the actor
  */
-gfloat
-clutter_actor_get_width (ClutterActor *self)
+static guint8
+clutter_actor_get_paint_opacity_internal (ClutterActor *self)
 {
-  ClutterActorPrivate *priv;
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *parent;
 
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
+  /* override the top-level opacity to always be 255; even in
+   * case of ClutterStage:use-alpha being TRUE we want the rest
+   * of the scene to be painted
+   */
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self))
+    return 255;
 
-  priv = self->priv;
+  if (priv->opacity_override >= 0)
+    return priv->opacity_override;
 
-  if (priv->needs_allocation)
+  parent = priv->parent;
+
+  /* Factor in the actual actors opacity with parents */
+  if (parent != NULL)
     {
-      gfloat natural_width = 0;
+      guint8 opacity = clutter_actor_get_paint_opacity_internal (parent);
 
-      if (self->priv->request_mode == CLUTTER_REQUEST_HEIGHT_FOR_WIDTH)
-        clutter_actor_get_preferred_width (self, -1, NULL, &natural_width);
-      else
-        {
-          gfloat natural_height = 0;
+      if (opacity != 0xff)
+        return (opacity * priv->opacity) / 0xff;
+    }
 
-          clutter_actor_get_preferred_height (self, -1, NULL, &natural_height);
-          clutter_actor_get_preferred_width (self, natural_height,
-                                             NULL,
-                                             &natural_width);
-        }
+  return priv->opacity;
 
-      return natural_width;
-    }
-  else
-    return priv->allocation.x2 - priv->allocation.x1;
 }
 
 /**
- * clutter_actor_get_height:
+ * clutter_actor_get_paint_opacity:
  * @self: A #ClutterActor
  *
- * Retrieves the height of a #ClutterActor.
+ * Retrieves the absolute opacity of the actor, as it appears on the stage.
  *
- * If the actor has a valid allocation, this function will return the
- * height of the allocated area given to the actor.
+ * This function traverses the hierarchy chain and composites the opacity of
+ * the actor with that of its parents.
  *
- * If the actor does not have a valid allocation, this function will
- * return the actor's natural height, that is the preferred height of
- * the actor.
+ * This function is intended for subclasses to use in the paint virtual
+ * function, to paint themselves with the correct opacity.
  *
- * If you care whether you get the preferred height or the height that
- * has been assigned to the actor, you should probably call a different
- * function like clutter_actor_get_allocation_box() to retrieve the
- * allocated size or clutter_actor_get_preferred_height() to retrieve the
- * preferred height.
+ * Return value: The actor opacity value.
  *
- * If an actor has a fixed height, for instance a height that has been
- * assigned using clutter_actor_set_height(), the height returned will
- * be the same value.
  *
- * Return value: the height of the actor, in pixels
  */
-gfloat
-clutter_actor_get_height (ClutterActor *self)
+guint8
+clutter_actor_get_paint_opacity (ClutterActor *self)
 {
-  ClutterActorPrivate *priv;
-
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
 
-  priv = self->priv;
-
-  if (priv->needs_allocation)
-    {
-      gfloat natural_height = 0;
-
-      if (priv->request_mode == CLUTTER_REQUEST_HEIGHT_FOR_WIDTH)
-        {
-          gfloat natural_width = 0;
-
-          clutter_actor_get_preferred_width (self, -1, NULL, &natural_width);
-          clutter_actor_get_preferred_height (self, natural_width,
-                                              NULL, &natural_height);
-        }
-      else
-        clutter_actor_get_preferred_height (self, -1, NULL, &natural_height);
-
-      return natural_height;
-    }
-  else
-    return priv->allocation.y2 - priv->allocation.y1;
+  return clutter_actor_get_paint_opacity_internal (self);
 }
 
 /**
- * clutter_actor_set_width:
- * @self: A #ClutterActor
- * @width: Requested new width for the actor, in pixels, or -1
- *
- * Forces a width on an actor, causing the actor's preferred width
- * and height (if any) to be ignored.
+ * clutter_actor_get_opacity:
+ * @self: a #ClutterActor
  *
- * If @width is -1 the actor will use its preferred width request
- * instead of overriding it, i.e. you can "unset" the width with -1.
+ * Retrieves the opacity value of an actor, as set by
+ * clutter_actor_set_opacity().
  *
- * This function sets both the minimum and natural size of the actor.
+ * For retrieving the absolute opacity of the actor inside a paint
+ * virtual function, see clutter_actor_get_paint_opacity().
  *
- * since: 0.2
+ * Return value: the opacity of the actor
  */
-void
-clutter_actor_set_width (ClutterActor *self,
-                         gfloat        width)
+guint8
+clutter_actor_get_opacity (ClutterActor *self)
 {
-  float cur_size;
-
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-
-  /* minor optimization: if we don't have a duration
-   * then we can skip the get_width() below, to avoid
-   * the chance of going through get_preferred_width()
-   * just to jump to a new desired width.
-   */
-  if (clutter_actor_get_easing_duration (self) == 0)
-    {
-      g_object_freeze_notify (G_OBJECT (self));
-
-      clutter_actor_set_width_internal (self, width);
-
-      g_object_thaw_notify (G_OBJECT (self));
-
-      return;
-    }
-  else
-    cur_size = clutter_actor_get_width (self);
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
 
-  _clutter_actor_create_transition (self,
-                                    obj_props[PROP_WIDTH],
-                                    cur_size,
-                                    width);
+  return self->priv->opacity;
 }
 
 /**
- * clutter_actor_set_height:
+ * clutter_actor_set_offscreen_redirect:
  * @self: A #ClutterActor
- * @height: Requested new height for the actor, in pixels, or -1
+ * @redirect: New offscreen redirect flags for the actor.
  *
- * Forces a height on an actor, causing the actor's preferred width
- * and height (if any) to be ignored.
+ * Defines the circumstances where the actor should be redirected into
+ * an offscreen image. The offscreen image is used to flatten the
+ * actor into a single image while painting for two main reasons.
+ * Firstly, when the actor is painted a second time without any of its
+ * contents changing it can simply repaint the cached image without
+ * descending further down the actor hierarchy. Secondly, it will make
+ * the opacity look correct even if there are overlapping primitives
+ * in the actor.
  *
- * If @height is -1 the actor will use its preferred height instead of
- * overriding it, i.e. you can "unset" the height with -1.
+ * Caching the actor could in some cases be a performance win and in
+ * some cases be a performance lose so it is important to determine
+ * which value is right for an actor before modifying this value. For
+ * example, there is never any reason to flatten an actor that is just
+ * a single texture (such as a #ClutterTexture) because it is
+ * effectively already cached in an image so the offscreen would be
+ * redundant. Also if the actor contains primitives that are far apart
+ * with a large transparent area in the middle (such as a large
+ * CluterGroup with a small actor in the top left and a small actor in
+ * the bottom right) then the cached image will contain the entire
+ * image of the large area and the paint will waste time blending all
+ * of the transparent pixels in the middle.
+ *
+ * The default method of implementing opacity on a container simply
+ * forwards on the opacity to all of the children. If the children are
+ * overlapping then it will appear as if they are two separate glassy
+ * objects and there will be a break in the color where they
+ * overlap. By redirecting to an offscreen buffer it will be as if the
+ * two opaque objects are combined into one and then made transparent
+ * which is usually what is expected.
+ *
+ * The image below demonstrates the difference between redirecting and
+ * not. The image shows two Clutter groups, each containing a red and
+ * a green rectangle which overlap. The opacity on the group is set to
+ * 128 (which is 50%). When the offscreen redirect is not used, the
+ * red rectangle can be seen through the blue rectangle as if the two
+ * rectangles were separately transparent. When the redirect is used
+ * the group as a whole is transparent instead so the red rectangle is
+ * not visible where they overlap.
+ *
+ * <figure id="offscreen-redirect">
+ *   <title>Sample of using an offscreen redirect for transparency</title>
+ *   <graphic fileref="offscreen-redirect.png" format="PNG"/>
+ * </figure>
+ *
+ * The default value for this property is 0, so we effectively will
+ * never redirect an actor offscreen by default. This means that there
+ * are times that transparent actors may look glassy as described
+ * above. The reason this is the default is because there is a
+ * performance trade off between quality and performance here. In many
+ * cases the default form of glassy opacity looks good enough, but if
+ * it's not you will need to set the
+ * %CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_OPACITY flag to enable
+ * redirection for opacity.
+ *
+ * Custom actors that don't contain any overlapping primitives are
+ * recommended to override the has_overlaps() virtual to return %FALSE
+ * for maximum efficiency.
+ *
+ * Actors containing a large sub-tree that rarely changes can set the
+ * %CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_CACHING flag; Clutter will
+ * then redirect the actor only after it has been painted a number of
+ * times without changing, and will stop redirecting it as soon as it
+ * changes. The total size of the images cached this way is limited.
  *
- * This function sets both the minimum and natural size of the actor.
  *
- * since: 0.2
  */
 void
-clutter_actor_set_height (ClutterActor *self,
-                          gfloat        height)
+clutter_actor_set_offscreen_redirect (ClutterActor *self,
+                                      ClutterOffscreenRedirect redirect)
 {
-  float cur_size;
+  ClutterActorPrivate *priv;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  /* see the comment in clutter_actor_set_width() above */
-  if (clutter_actor_get_easing_duration (self) == 0)
-    {
-      g_object_freeze_notify (G_OBJECT (self));
+  priv = self->priv;
 
-      clutter_actor_set_height_internal (self, height);
+  if (priv->offscreen_redirect != redirect)
+    {
+      priv->offscreen_redirect = redirect;
 
-      g_object_thaw_notify (G_OBJECT (self));
+      /* Queue a redraw from the effect so that it can use its cached
+         image if available instead of having to redraw the actual
+         actor. If it doesn't end up using the FBO then the effect is
+         still able to continue the paint anyway. If there is no
+         effect then this is equivalent to queuing a full redraw */
+      _clutter_actor_queue_redraw_full (self,
+                                        0, /* flags */
+                                        NULL, /* clip */
+                                        priv->flatten_effect);
 
-      return;
+      g_object_notify_by_pspec (G_OBJECT (self),
+                                obj_props[PROP_OFFSCREEN_REDIRECT]);
     }
-  else
-    cur_size = clutter_actor_get_height (self);
-
-  _clutter_actor_create_transition (self,
-                                    obj_props[PROP_HEIGHT],
-                                    cur_size,
-                                    height);
 }
 
-static inline void
-clutter_actor_set_x_internal (ClutterActor *self,
-                              float         x)
+/**
+ * clutter_actor_get_offscreen_redirect:
+ * @self: a #ClutterActor
+ *
+ * Retrieves whether to redirect the actor to an offscreen buffer, as
+ * set by clutter_actor_set_offscreen_redirect().
+ *
+ * Return value: the value of the offscreen-redirect property of the actor
+ *
+ *
+ */
+ClutterOffscreenRedirect
+clutter_actor_get_offscreen_redirect (ClutterActor *self)
 {
-  ClutterActorPrivate *priv = self->priv;
-  ClutterLayoutInfo *linfo;
-  ClutterActorBox old = { 0, };
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
 
-  linfo = _clutter_actor_get_layout_info (self);
+  return self->priv->offscreen_redirect;
+}
 
-  if (priv->position_set && linfo->fixed_pos.x == x)
-    return;
+/**
+ * clutter_actor_set_name:
+ * @self: A #ClutterActor
+ * @name: Textual tag to apply to actor
+ *
+ * Sets the given name to @self. The name can be used to identify
+ * a #ClutterActor.
+ */
+void
+clutter_actor_set_name (ClutterActor *self,
+			const gchar  *name)
+{
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  clutter_actor_store_old_geometry (self, &old);
+  g_free (self->priv->name);
+  self->priv->name = g_strdup (name);
 
-  linfo->fixed_pos.x = x;
-  clutter_actor_set_fixed_position_set (self, TRUE);
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_NAME]);
+}
 
-  clutter_actor_notify_if_geometry_changed (self, &old);
+/**
+ * clutter_actor_get_name:
+ * @self: A #ClutterActor
+ *
+ * Retrieves the name of @self.
+ *
+ * Return value: the name of the actor, or %NULL. The returned string is
+ *   owned by the actor and should not be modified or freed.
+ */
+const gchar *
+clutter_actor_get_name (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
 
-  clutter_actor_queue_relayout (self);
+  return self->priv->name;
 }
 
 static inline void
-clutter_actor_set_y_internal (ClutterActor *self,
-                              float         y)
+clutter_actor_set_z_position_internal (ClutterActor *self,
+                                       float         z_position)
 {
-  ClutterActorPrivate *priv = self->priv;
-  ClutterLayoutInfo *linfo;
-  ClutterActorBox old = { 0, };
+  ClutterTransformInfo *info;
 
-  linfo = _clutter_actor_get_layout_info (self);
+  info = _clutter_actor_get_transform_info (self);
 
-  if (priv->position_set && linfo->fixed_pos.y == y)
-    return;
+  if (memcmp (&info->z_position, &z_position, sizeof (float)) != 0)
+    {
+      info->z_position = z_position;
 
-  clutter_actor_store_old_geometry (self, &old);
+      if (self->priv->parent != NULL &&
+          self->priv->parent->priv->children_max_z < z_position)
+        self->priv->parent->priv->children_max_z = z_position;
 
-  linfo->fixed_pos.y = y;
-  clutter_actor_set_fixed_position_set (self, TRUE);
+      clutter_actor_invalidate_transform (self);
+      clutter_actor_invalidate_pick (self);
 
-  clutter_actor_notify_if_geometry_changed (self, &old);
+      clutter_actor_queue_transform_redraw (self);
 
-  clutter_actor_queue_relayout (self);
+      g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_Z_POSITION]);
+    }
 }
 
-static void
-clutter_actor_set_position_internal (ClutterActor       *self,
-                                     const ClutterPoint *position)
+/**
+ * clutter_actor_set_z_position:
+ * @self: a #ClutterActor
+ * @z_position: the position on the Z axis
+ *
+ * Sets the actor's position on the Z axis.
+ *
+ * See #ClutterActor:z-position.
+ *
+ *
+ */
+void
+clutter_actor_set_z_position (ClutterActor *self,
+                              gfloat        z_position)
 {
-  ClutterActorPrivate *priv = self->priv;
-  ClutterLayoutInfo *linfo;
-  ClutterActorBox old = { 0, };
-
-  linfo = _clutter_actor_get_layout_info (self);
+  const ClutterTransformInfo *info;
 
-  if (priv->position_set &&
-      clutter_point_equals (position, &linfo->fixed_pos))
-    return;
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  clutter_actor_store_old_geometry (self, &old);
+  info = _clutter_actor_get_transform_info_or_defaults (self);
 
-  if (position != NULL)
-    {
-      linfo->fixed_pos = *position;
-      clutter_actor_set_fixed_position_set (self, TRUE);
-    }
-  else
-    clutter_actor_set_fixed_position_set (self, FALSE);
+  _clutter_actor_create_transition (self, obj_props[PROP_Z_POSITION],
+                                    info->z_position,
+                                    z_position);
+}
 
-  clutter_actor_notify_if_geometry_changed (self, &old);
+/**
+ * clutter_actor_get_z_position:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the actor's position on the Z axis.
+ *
+ * Return value: the position on the Z axis.
+ *
+ *
+ */
+gfloat
+clutter_actor_get_z_position (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0.f);
 
-  clutter_actor_queue_relayout (self);
+  return _clutter_actor_get_transform_info_or_defaults (self)->z_position;
 }
 
 /**
- * clutter_actor_set_x:
+ * clutter_actor_set_pivot_point:
  * @self: a #ClutterActor
- * @x: the actor's position on the X axis
- *
- * Sets the actor's X coordinate, relative to its parent, in pixels.
+ * @pivot_x: the normalized X coordinate of the pivot point
+ * @pivot_y: the normalized Y coordinate of the pivot point
  *
- * Overrides any layout manager and forces a fixed position for
- * the actor.
+ * Sets the position of the #ClutterActor:pivot-point around which the
+ * scaling and rotation transformations occur.
  *
- * The #ClutterActor:x property is animatable.
+ * The pivot point's coordinates are in normalized space, with the (0, 0)
+ * point being the top left corner of the actor, and the (1, 1) point being
+ * the bottom right corner.
  *
  *
  */
 void
-clutter_actor_set_x (ClutterActor *self,
-                     gfloat        x)
+clutter_actor_set_pivot_point (ClutterActor *self,
+                               gfloat        pivot_x,
+                               gfloat        pivot_y)
 {
-  float cur_position = clutter_actor_get_x (self);
+  ClutterPoint pivot = CLUTTER_POINT_INIT (pivot_x, pivot_y);
+  const ClutterTransformInfo *info;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  _clutter_actor_create_transition (self, obj_props[PROP_X],
-                                    cur_position,
-                                    x);
+  info = _clutter_actor_get_transform_info_or_defaults (self);
+  _clutter_actor_create_transition (self, obj_props[PROP_PIVOT_POINT],
+                                    &info->pivot,
+                                    &pivot);
 }
 
 /**
- * clutter_actor_set_y:
+ * clutter_actor_get_pivot_point:
  * @self: a #ClutterActor
- * @y: the actor's position on the Y axis
- *
- * Sets the actor's Y coordinate, relative to its parent, in pixels.#
- *
- * Overrides any layout manager and forces a fixed position for
- * the actor.
+ * @pivot_x: (out) (allow-none): return location for the normalized X
+ *   coordinate of the pivot point, or %NULL
+ * @pivot_y: (out) (allow-none): return location for the normalized Y
+ *   coordinate of the pivot point, or %NULL
  *
- * The #ClutterActor:y property is animatable.
+ * Retrieves the coordinates of the #ClutterActor:pivot-point.
  *
  *
  */
 void
-clutter_actor_set_y (ClutterActor *self,
-                     gfloat        y)
+clutter_actor_get_pivot_point (ClutterActor *self,
+                               gfloat       *pivot_x,
+                               gfloat       *pivot_y)
 {
-  float cur_position = clutter_actor_get_y (self);
+  const ClutterTransformInfo *info;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  _clutter_actor_create_transition (self, obj_props[PROP_Y],
-                                    cur_position,
-                                    y);
+  info = _clutter_actor_get_transform_info_or_defaults (self);
+
+  if (pivot_x != NULL)
+    *pivot_x = info->pivot.x;
+
+  if (pivot_y != NULL)
+    *pivot_y = info->pivot.y;
 }
 
 /**
- * clutter_actor_get_x:
- * @self: A #ClutterActor
- *
- * Retrieves the X coordinate of a #ClutterActor.
- *
- * This function tries to "do what you mean", by returning the
- * correct value depending on the actor's state.
+ * clutter_actor_set_pivot_point_z:
+ * @self: a #ClutterActor
+ * @pivot_z: the Z coordinate of the actor's pivot point
  *
- * If the actor has a valid allocation, this function will return
- * the X coordinate of the origin of the allocation box.
+ * Sets the component on the Z axis of the #ClutterActor:pivot-point around
+ * which the scaling and rotation transformations occur.
  *
- * If the actor has any fixed coordinate set using clutter_actor_set_x(),
- * clutter_actor_set_position() or clutter_actor_set_geometry(), this
- * function will return that coordinate.
+ * The @pivot_z value is expressed as a distance along the Z axis.
  *
- * If both the allocation and a fixed position are missing, this function
- * will return 0.
  *
- * Return value: the X coordinate, in pixels, ignoring any
- *   transformation (i.e. scaling, rotation)
  */
-gfloat
-clutter_actor_get_x (ClutterActor *self)
+void
+clutter_actor_set_pivot_point_z (ClutterActor *self,
+                                 gfloat        pivot_z)
 {
-  ClutterActorPrivate *priv;
-
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
-
-  priv = self->priv;
-
-  if (priv->needs_allocation)
-    {
-      if (priv->position_set)
-        {
-          const ClutterLayoutInfo *info;
+  const ClutterTransformInfo *info;
 
-          info = _clutter_actor_get_layout_info_or_defaults (self);
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-          return info->fixed_pos.x;
-        }
-      else
-        return 0;
-    }
-  else
-    return priv->allocation.x1;
+  info = _clutter_actor_get_transform_info_or_defaults (self);
+  _clutter_actor_create_transition (self, obj_props[PROP_PIVOT_POINT_Z],
+                                    info->pivot_z,
+                                    pivot_z);
 }
 
 /**
- * clutter_actor_get_y:
- * @self: A #ClutterActor
+ * clutter_actor_get_pivot_point_z:
+ * @self: a #ClutterActor
  *
- * Retrieves the Y coordinate of a #ClutterActor.
+ * Retrieves the Z component of the #ClutterActor:pivot-point.
  *
- * This function tries to "do what you mean", by returning the
- * correct value depending on the actor's state.
  *
- * If the actor has a valid allocation, this function will return
- * the Y coordinate of the origin of the allocation box.
+ */
+gfloat
+clutter_actor_get_pivot_point_z (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0.f);
+
+  return _clutter_actor_get_transform_info_or_defaults (self)->pivot_z;
+}
+
+/**
+ * clutter_actor_set_clip:
+ * @self: A #ClutterActor
+ * @xoff: X offset of the clip rectangle
+ * @yoff: Y offset of the clip rectangle
+ * @width: Width of the clip rectangle
+ * @height: Height of the clip rectangle
  *
- * If the actor has any fixed coordinate set using clutter_actor_set_y(),
- * clutter_actor_set_position() or clutter_actor_set_geometry(), this
- * function will return that coordinate.
+ * Sets clip area for @self. The clip area is always computed from the
+ * upper left corner of the actor.
  *
- * If both the allocation and a fixed position are missing, this function
- * will return 0.
  *
- * Return value: the Y coordinate, in pixels, ignoring any
- *   transformation (i.e. scaling, rotation)
  */
-gfloat
-clutter_actor_get_y (ClutterActor *self)
+void
+clutter_actor_set_clip (ClutterActor *self,
+                        gfloat        xoff,
+                        gfloat        yoff,
+                        gfloat        width,
+                        gfloat        height)
 {
   ClutterActorPrivate *priv;
+  GObject *obj;
 
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
   priv = self->priv;
 
-  if (priv->needs_allocation)
-    {
-      if (priv->position_set)
-        {
-          const ClutterLayoutInfo *info;
+  if (priv->has_clip &&
+      priv->clip.origin.x == xoff &&
+      priv->clip.origin.y == yoff &&
+      priv->clip.size.width == width &&
+      priv->clip.size.height == height)
+    return;
 
-          info = _clutter_actor_get_layout_info_or_defaults (self);
+  obj = G_OBJECT (self);
 
-          return info->fixed_pos.y;
-        }
-      else
-        return 0;
-    }
-  else
-    return priv->allocation.y1;
+  priv->clip.origin.x = xoff;
+  priv->clip.origin.y = yoff;
+  priv->clip.size.width = width;
+  priv->clip.size.height = height;
+
+  priv->has_clip = TRUE;
+
+  clutter_actor_invalidate_pick (self);
+  clutter_actor_queue_redraw (self);
+
+  g_object_notify_by_pspec (obj, obj_props[PROP_CLIP_RECT]);
+  g_object_notify_by_pspec (obj, obj_props[PROP_HAS_CLIP]);
 }
 
 /**
- * clutter_actor_set_scale:
+ * clutter_actor_remove_clip:
  * @self: A #ClutterActor
- * @scale_x: double factor to scale actor by horizontally.
- * @scale_y: double factor to scale actor by vertically.
- *
- * Scales an actor with the given factors.
- *
- * The scale transformation is relative the the #ClutterActor:pivot-point.
- *
- * The #ClutterActor:scale-x and #ClutterActor:scale-y properties are
- * animatable.
- *
  *
+ * Removes clip area from @self.
  */
 void
-clutter_actor_set_scale (ClutterActor *self,
-                         gdouble       scale_x,
-                         gdouble       scale_y)
+clutter_actor_remove_clip (ClutterActor *self)
 {
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  g_object_freeze_notify (G_OBJECT (self));
+  if (!self->priv->has_clip)
+    return;
 
-  clutter_actor_set_scale_factor (self, CLUTTER_X_AXIS, scale_x);
-  clutter_actor_set_scale_factor (self, CLUTTER_Y_AXIS, scale_y);
+  self->priv->has_clip = FALSE;
 
-  g_object_thaw_notify (G_OBJECT (self));
+  clutter_actor_invalidate_pick (self);
+  clutter_actor_queue_redraw (self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_HAS_CLIP]);
 }
 
 /**
- * clutter_actor_set_scale_z:
+ * clutter_actor_has_clip:
  * @self: a #ClutterActor
- * @scale_z: the scaling factor along the Z axis
  *
- * Scales an actor on the Z axis by the given @scale_z factor.
- *
- * The scale transformation is relative the the #ClutterActor:pivot-point.
+ * Determines whether the actor has a clip area set or not.
  *
- * The #ClutterActor:scale-z property is animatable.
+ * Return value: %TRUE if the actor has a clip area set.
  *
  *
  */
-void
-clutter_actor_set_scale_z (ClutterActor *self,
-                           gdouble       scale_z)
+gboolean
+clutter_actor_has_clip (ClutterActor *self)
 {
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
 
-  clutter_actor_set_scale_factor (self, CLUTTER_Z_AXIS, scale_z);
+  return self->priv->has_clip;
 }
 
 /**
- * clutter_actor_get_scale:
- * @self: A #ClutterActor
- * @scale_x: (out) (allow-none): Location to store horizonal
- *   scale factor, or %NULL.
- * @scale_y: (out) (allow-none): Location to store vertical
- *   scale factor, or %NULL.
+ * clutter_actor_get_clip:
+ * @self: a #ClutterActor
+ * @xoff: (out) (allow-none): return location for the X offset of
+ *   the clip rectangle, or %NULL
+ * @yoff: (out) (allow-none): return location for the Y offset of
+ *   the clip rectangle, or %NULL
+ * @width: (out) (allow-none): return location for the width of
+ *   the clip rectangle, or %NULL
+ * @height: (out) (allow-none): return location for the height of
+ *   the clip rectangle, or %NULL
  *
- * Retrieves an actors scale factors.
+ * Gets the clip area for @self, if any is set.
  *
  *
  */
 void
-clutter_actor_get_scale (ClutterActor *self,
-			 gdouble      *scale_x,
-			 gdouble      *scale_y)
+clutter_actor_get_clip (ClutterActor *self,
+                        gfloat       *xoff,
+                        gfloat       *yoff,
+                        gfloat       *width,
+                        gfloat       *height)
 {
-  const ClutterTransformInfo *info;
+  ClutterActorPrivate *priv;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  info = _clutter_actor_get_transform_info_or_defaults (self);
+  priv = self->priv;
 
-  if (scale_x)
-    *scale_x = info->scale_x;
+  if (!priv->has_clip)
+    return;
 
-  if (scale_y)
-    *scale_y = info->scale_y;
+  if (xoff != NULL)
+    *xoff = priv->clip.origin.x;
+
+  if (yoff != NULL)
+    *yoff = priv->clip.origin.y;
+
+  if (width != NULL)
+    *width = priv->clip.size.width;
+
+  if (height != NULL)
+    *height = priv->clip.size.height;
 }
 
 /**
- * clutter_actor_get_scale_z:
- * @self: A #ClutterActor
+ * clutter_actor_get_children:
+ * @self: a #ClutterActor
  *
- * Retrieves the scaling factor along the Z axis, as set using
- * clutter_actor_set_scale_z().
+ * Retrieves the list of children of @self.
  *
- * Return value: the scaling factor along the Z axis
+ * Return value: (transfer container) (element-type ClutterActor): A newly
+ *   allocated #GList of #ClutterActor<!-- -->s. Use g_list_free() when
+ *   done.
  *
  *
  */
-gdouble
-clutter_actor_get_scale_z (ClutterActor *self)
+GList *
+clutter_actor_get_children (ClutterActor *self)
 {
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 1.0);
+  ClutterActor *iter;
+  GList *res;
+
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
+
+  /* we walk the list backward so that we can use prepend(),
+   * which is O(1)
+   */
+  for (iter = self->priv->last_child, res = NULL;
+       iter != NULL;
+       iter = iter->priv->prev_sibling)
+    {
+      res = g_list_prepend (res, iter);
+    }
+
+  return res;
+}
+
+/*< private >
+ * insert_child_at_depth:
+ * @self: a #ClutterActor
+ * @child: a #ClutterActor
+ *
+ * Inserts @child inside the list of children held by @self, using
+ * the depth as the insertion criteria.
+ *
+ * This sadly makes the insertion not O(1), but we can keep the
+ * list sorted so that the painters algorithm we use for painting
+ * the children will work correctly. Children that are not below any
+ * of their siblings, which is the common case, are appended without
+ * walking the list.
+ */
+static void
+insert_child_at_depth (ClutterActor *self,
+                       ClutterActor *child,
+                       gpointer      dummy G_GNUC_UNUSED)
+{
+  ClutterActor *iter;
+  float child_depth, max_depth;
+
+  child->priv->parent = self;
+
+  child_depth =
+    _clutter_actor_get_transform_info_or_defaults (child)->z_position;
+
+  /* special-case the first child */
+  if (self->priv->n_children == 0)
+    {
+      self->priv->first_child = child;
+      self->priv->last_child = child;
+      self->priv->children_max_z = child_depth;
+
+      child->priv->next_sibling = NULL;
+      child->priv->prev_sibling = NULL;
+
+      return;
+    }
+
+  /* Find the right place to insert the child so that it will still be
+     sorted and the child will be after all of the actors at the same
+     dept */
+  if (child_depth >= self->priv->children_max_z)
+    {
+      iter = NULL;
+      max_depth = child_depth;
+    }
+  else
+    {
+      max_depth = child_depth;
+
+      for (iter = self->priv->first_child;
+           iter != NULL;
+           iter = iter->priv->next_sibling)
+        {
+          float iter_depth;
+
+          iter_depth =
+            _clutter_actor_get_transform_info_or_defaults (iter)->z_position;
+
+          if (iter_depth > child_depth)
+            break;
+
+          max_depth = MAX (max_depth, iter_depth);
+        }
+    }
+
+  /* if we walked the whole list then we know the exact bound */
+  if (iter == NULL)
+    self->priv->children_max_z = max_depth;
+
+  if (iter != NULL)
+    {
+      ClutterActor *tmp = iter->priv->prev_sibling;
+
+      if (tmp != NULL)
+        tmp->priv->next_sibling = child;
+
+      /* Insert the node before the found one */
+      child->priv->prev_sibling = iter->priv->prev_sibling;
+      child->priv->next_sibling = iter;
+      iter->priv->prev_sibling = child;
+    }
+  else
+    {
+      ClutterActor *tmp = self->priv->last_child;
 
-  return _clutter_actor_get_transform_info_or_defaults (self)->scale_z;
+      if (tmp != NULL)
+        tmp->priv->next_sibling = child;
+
+      /* insert the node at the end of the list */
+      child->priv->prev_sibling = self->priv->last_child;
+      child->priv->next_sibling = NULL;
+    }
+
+  if (child->priv->prev_sibling == NULL)
+    self->priv->first_child = child;
+
+  if (child->priv->next_sibling == NULL)
+    self->priv->last_child = child;
 }
 
-static inline void
-clutter_actor_set_opacity_internal (ClutterActor *self,
-                                    guint8        opacity)
+static void
+insert_child_at_index (ClutterActor *self,
+                       ClutterActor *child,
+                       gpointer      data_)
 {
-  ClutterActorPrivate *priv = self->priv;
+  gint index_ = GPOINTER_TO_INT (data_);
 
-  if (priv->opacity != opacity)
+  child->priv->parent = self;
+
+  if (index_ == 0)
     {
-      priv->opacity = opacity;
+      ClutterActor *tmp = self->priv->first_child;
 
-      /* Queue a redraw from the flatten effect so that it can use
-         its cached image if available instead of having to redraw the
-         actual actor. If it doesn't end up using the FBO then the
-         effect is still able to continue the paint anyway. If there
-         is no flatten effect yet then this is equivalent to queueing
-         a full redraw */
-      _clutter_actor_queue_redraw_full (self,
-                                        0, /* flags */
-                                        NULL, /* clip */
-                                        priv->flatten_effect);
+      if (tmp != NULL)
+        tmp->priv->prev_sibling = child;
 
-      g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_OPACITY]);
+      child->priv->prev_sibling = NULL;
+      child->priv->next_sibling = tmp;
     }
-}
+  else if (index_ < 0 || index_ >= self->priv->n_children)
+    {
+      ClutterActor *tmp = self->priv->last_child;
 
-/**
- * clutter_actor_set_opacity:
- * @self: A #ClutterActor
- * @opacity: New opacity value for the actor.
- *
- * Sets the actor's opacity, with zero being completely transparent and
- * 255 (0xff) being fully opaque.
- *
- * The #ClutterActor:opacity property is animatable.
- */
-void
-clutter_actor_set_opacity (ClutterActor *self,
-			   guint8        opacity)
-{
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+      if (tmp != NULL)
+        tmp->priv->next_sibling = child;
 
-  _clutter_actor_create_transition (self, obj_props[PROP_OPACITY],
-                                    self->priv->opacity,
-                                    opacity);
-}
+      child->priv->prev_sibling = tmp;
+      child->priv->next_sibling = NULL;
+    }
+  else
+    {
+      GPtrArray *children = clutter_actor_get_children_index (self);
+      ClutterActor *iter;
+      int i;
 
-/*
- * clutter_actor_get_paint_opacity_internal:
- * @self: a #ClutterActor
- *
- * Retrieves the absolute opacity of the actor, as it appears on the stage
- *
- * This function does not do type checks
- *
- * Return value: the absolute opacity of the actor
- */
-static guint8
-clutter_actor_get_paint_opacity_internal (ClutterActor *self)
-{
-  ClutterActorPrivate *priv = self->priv;
-  ClutterActor *parent;
+      if (children != NULL)
+        {
+          iter = g_ptr_array_index (children, index_);
+          i = index_;
+        }
+      else
+        {
+          iter = self->priv->first_child;
+          i = 0;
+        }
 
-  /* override the top-level opacity to always be 255; even in
-   * case of ClutterStage:use-alpha being TRUE we want the rest
-   * of the scene to be painted
-   */
-  if (CLUTTER_ACTOR_IS_TOPLEVEL (self))
-    return 255;
+      for (;
+           iter != NULL;
+           iter = iter->priv->next_sibling, i += 1)
+        {
+          if (index_ == i)
+            {
+              ClutterActor *tmp = iter->priv->prev_sibling;
 
-  if (priv->opacity_override >= 0)
-    return priv->opacity_override;
+              child->priv->prev_sibling = tmp;
+              child->priv->next_sibling = iter;
 
-  parent = priv->parent;
+              iter->priv->prev_sibling = child;
 
-  /* Factor in the actual actors opacity with parents */
-  if (parent != NULL)
-    {
-      guint8 opacity = clutter_actor_get_paint_opacity_internal (parent);
+              if (tmp != NULL)
+                tmp->priv->next_sibling = child;
 
-      if (opacity != 0xff)
-        return (opacity * priv->opacity) / 0xff;
+              break;
+            }
+        }
     }
 
-  return priv->opacity;
+  if (child->priv->prev_sibling == NULL)
+    self->priv->first_child = child;
 
+  if (child->priv->next_sibling == NULL)
+    self->priv->last_child = child;
 }
 
-/**
- * clutter_actor_get_paint_opacity:
- * @self: A #ClutterActor
- *
- * Retrieves the absolute opacity of the actor, as it appears on the stage.
- *
- * This function traverses the hierarchy chain and composites the opacity of
- * the actor with that of its parents.
- *
- * This function is intended for subclasses to use in the paint virtual
- * function, to paint themselves with the correct opacity.
- *
- * Return value: The actor opacity value.
- *
- *
- */
-guint8
-clutter_actor_get_paint_opacity (ClutterActor *self)
+static void
+insert_child_above (ClutterActor *self,
+                    ClutterActor *child,
+                    gpointer      data)
 {
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
+  ClutterActor *sibling = data;
 
-  return clutter_actor_get_paint_opacity_internal (self);
-}
+  child->priv->parent = self;
 
-/**
- * clutter_actor_get_opacity:
- * @self: a #ClutterActor
- *
- * Retrieves the opacity value of an actor, as set by
- * clutter_actor_set_opacity().
- *
- * For retrieving the absolute opacity of the actor inside a paint
- * virtual function, see clutter_actor_get_paint_opacity().
- *
- * Return value: the opacity of the actor
- */
-guint8
-clutter_actor_get_opacity (ClutterActor *self)
-{
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
+  if (sibling == NULL)
+    sibling = self->priv->last_child;
 
-  return self->priv->opacity;
-}
+  child->priv->prev_sibling = sibling;
 
-/**
- * clutter_actor_set_offscreen_redirect:
- * @self: A #ClutterActor
- * @redirect: New offscreen redirect flags for the actor.
- *
- * Defines the circumstances where the actor should be redirected into
- * an offscreen image. The offscreen image is used to flatten the
- * actor into a single image while painting for two main reasons.
- * Firstly, when the actor is painted a second time without any of its
- * contents changing it can simply repaint the cached image without
- * descending further down the actor hierarchy. Secondly, it will make
- * the opacity look correct even if there are overlapping primitives
- * in the actor.
- *
- * Caching the actor could in some cases be a performance win and in
- * some cases be a performance lose so it is important to determine
- * which value is right for an actor before modifying this value. For
- * example, there is never any reason to flatten an actor that is just
- * a single texture (such as a #ClutterTexture) because it is
- * effectively already cached in an image so the offscreen would be
- * redundant. Also if the actor contains primitives that are far apart
- * with a large transparent area in the middle (such as a large
- * CluterGroup with a small actor in the top left and a small actor in
- * the bottom right) then the cached image will contain the entire
- * image of the large area and the paint will waste time blending all
- * of the transparent pixels in the middle.
- *
- * The default method of implementing opacity on a container simply
- * forwards on the opacity to all of the children. If the children are
- * overlapping then it will appear as if they are two separate glassy
- * objects and there will be a break in the color where they
- * overlap. By redirecting to an offscreen buffer it will be as if the
- * two opaque objects are combined into one and then made transparent
- * which is usually what is expected.
- *
- * The image below demonstrates the difference between redirecting and
- * not. The image shows two Clutter groups, each containing a red and
- * a green rectangle which overlap. The opacity on the group is set to
- * 128 (which is 50%). When the offscreen redirect is not used, the
- * red rectangle can be seen through the blue rectangle as if the two
- * rectangles were separately transparent. When the redirect is used
- * the group as a whole is transparent instead so the red rectangle is
- * not visible where they overlap.
- *
- * <figure id="offscreen-redirect">
- *   <title>Sample of using an offscreen redirect for transparency</title>
- *   <graphic fileref="offscreen-redirect.png" format="PNG"/>
- * </figure>
- *
- * The default value for this property is 0, so we effectively will
- * never redirect an actor offscreen by default. This means that there
- * are times that transparent actors may look glassy as described
- * above. The reason this is the default is because there is a
- * performance trade off between quality and performance here. In many
- * cases the default form of glassy opacity looks good enough, but if
- * it's not you will need to set the
- * %CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_OPACITY flag to enable
- * redirection for opacity.
- *
- * Custom actors that don't contain any overlapping primitives are
- * recommended to override the has_overlaps() virtual to return %FALSE
- * for maximum efficiency.
- *
- *
- */
-void
-clutter_actor_set_offscreen_redirect (ClutterActor *self,
-                                      ClutterOffscreenRedirect redirect)
+  if (sibling != NULL)
+    {
+      ClutterActor *tmp = sibling->priv->next_sibling;
+
+      child->priv->next_sibling = tmp;
+
+      if (tmp != NULL)
+        tmp->priv->prev_sibling = child;
+
+      sibling->priv->next_sibling = child;
+    }
+  else
+    child->priv->next_sibling = NULL;
+
+  if (child->priv->prev_sibling == NULL)
+    self->priv->first_child = child;
+
+  if (child->priv->next_sibling == NULL)
+    self->priv->last_child = child;
+}
+
+static void
+insert_child_below (ClutterActor *self,
+                    ClutterActor *child,
+                    gpointer      data)
 {
-  ClutterActorPrivate *priv;
+  ClutterActor *sibling = data;
 
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  child->priv->parent = self;
 
-  priv = self->priv;
+  if (sibling == NULL)
+    sibling = self->priv->first_child;
 
-  if (priv->offscreen_redirect != redirect)
+  child->priv->next_sibling = sibling;
+
+  if (sibling != NULL)
     {
-      priv->offscreen_redirect = redirect;
+      ClutterActor *tmp = sibling->priv->prev_sibling;
 
-      /* Queue a redraw from the effect so that it can use its cached
-         image if available instead of having to redraw the actual
-         actor. If it doesn't end up using the FBO then the effect is
-         still able to continue the paint anyway. If there is no
-         effect then this is equivalent to queuing a full redraw */
-      _clutter_actor_queue_redraw_full (self,
-                                        0, /* flags */
-                                        NULL, /* clip */
-                                        priv->flatten_effect);
+      child->priv->prev_sibling = tmp;
 
-      g_object_notify_by_pspec (G_OBJECT (self),
-                                obj_props[PROP_OFFSCREEN_REDIRECT]);
+      if (tmp != NULL)
+        tmp->priv->next_sibling = child;
+
+      sibling->priv->prev_sibling = child;
     }
+  else
+    child->priv->prev_sibling = NULL;
+
+  if (child->priv->prev_sibling == NULL)
+    self->priv->first_child = child;
+
+  if (child->priv->next_sibling == NULL)
+    self->priv->last_child = child;
 }
 
-/**
- * clutter_actor_get_offscreen_redirect:
+typedef void (* ClutterActorAddChildFunc) (ClutterActor *parent,
+                                           ClutterActor *child,
+                                           gpointer      data);
+
+typedef enum {
+  ADD_CHILD_CREATE_META        = 1 << 0,
+  ADD_CHILD_EMIT_PARENT_SET    = 1 << 1,
+  ADD_CHILD_EMIT_ACTOR_ADDED   = 1 << 2,
+  ADD_CHILD_CHECK_STATE        = 1 << 3,
+  ADD_CHILD_NOTIFY_FIRST_LAST  = 1 << 4,
+  ADD_CHILD_QUEUE_REDRAW       = 1 << 5,
+
+  /* default flags for public API */
+  ADD_CHILD_DEFAULT_FLAGS    = ADD_CHILD_CREATE_META |
+                               ADD_CHILD_EMIT_PARENT_SET |
+                               ADD_CHILD_EMIT_ACTOR_ADDED |
+                               ADD_CHILD_CHECK_STATE |
+                               ADD_CHILD_NOTIFY_FIRST_LAST |
+                               ADD_CHILD_QUEUE_REDRAW,
+
+  /* flags for adding many children at once; the redraw and the
+   * notifications are handled by the caller
+   */
+  ADD_CHILD_BATCH_FLAGS      = ADD_CHILD_CREATE_META |
+                               ADD_CHILD_EMIT_PARENT_SET |
+                               ADD_CHILD_EMIT_ACTOR_ADDED |
+                               ADD_CHILD_CHECK_STATE
+} ClutterActorAddChildFlags;
+
+/*< private >
+ * clutter_actor_add_child_internal:
  * @self: a #ClutterActor
+ * @child: a #ClutterActor
+ * @flags: control flags for actions
+ * @add_func: delegate function
+ * @data: (closure): data to pass to @add_func
  *
- * Retrieves whether to redirect the actor to an offscreen buffer, as
- * set by clutter_actor_set_offscreen_redirect().
- *
- * Return value: the value of the offscreen-redirect property of the actor
+ * Adds @child to the list of children of @self.
  *
+ * The actual insertion inside the list is delegated to @add_func: this
+ * function will just set up the state, perform basic checks, and emit
+ * signals.
  *
+ * The @flags argument is used to perform additional operations.
  */
-ClutterOffscreenRedirect
-clutter_actor_get_offscreen_redirect (ClutterActor *self)
+static inline void
+clutter_actor_add_child_internal (ClutterActor              *self,
+                                  ClutterActor              *child,
+                                  ClutterActorAddChildFlags  flags,
+                                  ClutterActorAddChildFunc   add_func,
+                                  gpointer                   data)
 {
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
+  ClutterTextDirection text_dir;
+  gboolean create_meta;
+  gboolean emit_parent_set, emit_actor_added;
+  gboolean check_state;
+  gboolean notify_first_last;
+  gboolean queue_redraw;
+  gboolean show_on_set_parent;
+  ClutterActor *old_first_child, *old_last_child;
+  gfloat child_depth;
+  GObject *obj;
 
-  return self->priv->offscreen_redirect;
-}
+  if (child->priv->parent != NULL)
+    {
+      g_warning ("The actor '%s' already has a parent, '%s'. You must "
+                 "use clutter_actor_remove_child() first.",
+                 _clutter_actor_get_debug_name (child),
+                 _clutter_actor_get_debug_name (child->priv->parent));
+      return;
+    }
 
-/**
- * clutter_actor_set_name:
- * @self: A #ClutterActor
- * @name: Textual tag to apply to actor
- *
- * Sets the given name to @self. The name can be used to identify
- * a #ClutterActor.
- */
-void
-clutter_actor_set_name (ClutterActor *self,
-			const gchar  *name)
-{
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  /* the cached event chains are not valid any more */
+  hierarchy_generation += 1;
 
-  g_free (self->priv->name);
-  self->priv->name = g_strdup (name);
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (child))
+    {
+      g_warning ("The actor '%s' is a top-level actor, and cannot be "
+                 "a child of another actor.",
+                 _clutter_actor_get_debug_name (child));
+      return;
+    }
 
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_NAME]);
-}
+  /* the following check disallows calling methods that change the stacking
+   * order within the destruction sequence, by triggering a critical
+   * warning first, and leaving the actor in an undefined state, which
+   * then ends up being caught by an assertion.
+   *
+   * the reproducible sequence is:
+   *
+   *   - actor gets destroyed;
+   *   - another actor, linked to the first, will try to change the
+   *     stacking order of the first actor;
+   *   - changing the stacking order is a composite operation composed
+   *     by the following steps:
+   *     1. ref() the child;
+   *     2. remove_child_internal(), which removes the reference;
+   *     3. add_child_internal(), which adds a reference;
+   *   - the state of the actor is not changed between (2) and (3), as
+   *     it could be an expensive recomputation;
+   *   - if (3) bails out, then the actor is in an undefined state, but
+   *     still alive;
+   *   - the destruction sequence terminates, but the actor is unparented
+   *     while its state indicates being parented instead.
+   *   - assertion failure.
+   *
+   * the obvious fix would be to decompose each set_child_*_sibling()
+   * method into proper remove_child()/add_child(), with state validation;
+   * this may cause excessive work, though, and trigger a cascade of other
+   * bugs in code that assumes that a change in the stacking order is an
+   * atomic operation.
+   *
+   * another potential fix is to just remove this check here, and let
+   * code doing stacking order changes inside the destruction sequence
+   * of an actor continue doing the stacking changes as before; this
+   * option still performs more work than necessary.
+   *
+   * the third fix is to silently bail out early from every
+   * set_child_*_sibling() and set_child_at_index() method, and avoid
+   * doing stack changes altogether; Clutter implements this last option.
+   *
+   * see bug: https://bugzilla.gnome.org/show_bug.cgi?id=670647
+   */
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (child))
+    {
+      g_warning ("The actor '%s' is currently being destroyed, and "
+                 "cannot be added as a child of another actor.",
+                 _clutter_actor_get_debug_name (child));
+      return;
+    }
 
-/**
- * clutter_actor_get_name:
- * @self: A #ClutterActor
- *
- * Retrieves the name of @self.
- *
- * Return value: the name of the actor, or %NULL. The returned string is
- *   owned by the actor and should not be modified or freed.
- */
-const gchar *
-clutter_actor_get_name (ClutterActor *self)
-{
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
+  create_meta = (flags & ADD_CHILD_CREATE_META) != 0;
+  emit_parent_set = (flags & ADD_CHILD_EMIT_PARENT_SET) != 0;
+  emit_actor_added = (flags & ADD_CHILD_EMIT_ACTOR_ADDED) != 0;
+  check_state = (flags & ADD_CHILD_CHECK_STATE) != 0;
+  notify_first_last = (flags & ADD_CHILD_NOTIFY_FIRST_LAST) != 0;
+  queue_redraw = (flags & ADD_CHILD_QUEUE_REDRAW) != 0;
+  show_on_set_parent = CLUTTER_ACTOR_IS_VISIBLE (child);
 
-  return self->priv->name;
-}
+  old_first_child = self->priv->first_child;
+  old_last_child = self->priv->last_child;
 
-static inline void
-clutter_actor_set_z_position_internal (ClutterActor *self,
-                                       float         z_position)
-{
-  ClutterTransformInfo *info;
+  obj = G_OBJECT (self);
+  g_object_freeze_notify (obj);
 
-  info = _clutter_actor_get_transform_info (self);
+  if (create_meta)
+    clutter_container_create_child_meta (CLUTTER_CONTAINER (self), child);
 
-  if (memcmp (&info->z_position, &z_position, sizeof (float)) != 0)
+  g_object_ref_sink (child);
+  child->priv->parent = NULL;
+  child->priv->next_sibling = NULL;
+  child->priv->prev_sibling = NULL;
+
+  /* delegate the actual insertion */
+  add_func (self, child, data);
+
+  g_assert (child->priv->parent == self);
+
+  /* children inserted at a given position may be above their siblings */
+  child_depth =
+    _clutter_actor_get_transform_info_or_defaults (child)->z_position;
+  if (child_depth > self->priv->children_max_z)
+    self->priv->children_max_z = child_depth;
+
+  clutter_actor_invalidate_transform (child);
+
+  self->priv->n_children += 1;
+
+  self->priv->age += 1;
+
+  clutter_actor_children_index_insert (self, child,
+                                       add_func == insert_child_at_index
+                                         ? GPOINTER_TO_INT (data)
+                                         : -1);
+
+  clutter_actor_invalidate_pick (child);
+
+  /* if push_internal() has been called then we automatically set
+   * the flag on the actor
+   */
+  if (self->priv->internal_child)
+    CLUTTER_SET_PRIVATE_FLAGS (child, CLUTTER_INTERNAL_CHILD);
+
+  /* children may cause their parent to expand, if they are set
+   * to expand; if a child is not expanded then it cannot change
+   * its parent's state. any further change later on will queue
+   * an expand state check.
+   *
+   * this check, with the initial state of the needs_compute_expand
+   * flag set to FALSE, should avoid recomputing the expand flags
+   * state while building the actor tree.
+   */
+  if (CLUTTER_ACTOR_IS_VISIBLE (child) &&
+      (child->priv->needs_compute_expand ||
+       child->priv->needs_x_expand ||
+       child->priv->needs_y_expand))
     {
-      info->z_position = z_position;
+      clutter_actor_queue_compute_expand (self);
+    }
 
-      self->priv->transform_valid = FALSE;
+  /* clutter_actor_reparent() will emit ::parent-set for us */
+  if (emit_parent_set && !CLUTTER_ACTOR_IN_REPARENT (child))
+    g_signal_emit (child, actor_signals[PARENT_SET], 0, NULL);
 
-      clutter_actor_queue_redraw (self);
+  if (check_state)
+    {
+      /* If parent is mapped or realized, we need to also be mapped or
+       * realized once we're inside the parent.
+       */
+      clutter_actor_update_map_state (child, MAP_STATE_CHECK);
 
-      g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_Z_POSITION]);
+      /* propagate the parent's text direction to the child */
+      text_dir = clutter_actor_get_text_direction (self);
+      clutter_actor_set_text_direction (child, text_dir);
     }
-}
-
-/**
- * clutter_actor_set_z_position:
- * @self: a #ClutterActor
- * @z_position: the position on the Z axis
- *
- * Sets the actor's position on the Z axis.
- *
- * See #ClutterActor:z-position.
- *
- *
- */
-void
-clutter_actor_set_z_position (ClutterActor *self,
-                              gfloat        z_position)
-{
-  const ClutterTransformInfo *info;
 
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  /* this may end up queueing a redraw, in case the actor is
+   * not visible but the show-on-set-parent property is still
+   * set.
+   */
+  if (show_on_set_parent)
+    clutter_actor_show (child);
 
-  info = _clutter_actor_get_transform_info_or_defaults (self);
+  /* on the other hand, this will catch any other case where
+   * the actor is supposed to be visible when it's added
+   */
+  if (queue_redraw && CLUTTER_ACTOR_IS_MAPPED (child))
+    clutter_actor_queue_redraw (child);
 
-  _clutter_actor_create_transition (self, obj_props[PROP_Z_POSITION],
-                                    info->z_position,
-                                    z_position);
-}
+  /* maintain the invariant that if an actor needs layout,
+   * its parents do as well
+   */
+  if (child->priv->needs_width_request ||
+      child->priv->needs_height_request ||
+      child->priv->needs_allocation)
+    {
+      /* we work around the short-circuiting we do
+       * in clutter_actor_queue_relayout() since we
+       * want to force a relayout
+       */
+      child->priv->needs_width_request = TRUE;
+      child->priv->needs_height_request = TRUE;
+      child->priv->needs_allocation = TRUE;
 
-/**
- * clutter_actor_get_z_position:
- * @self: a #ClutterActor
- *
- * Retrieves the actor's position on the Z axis.
- *
- * Return value: the position on the Z axis.
- *
- *
- */
-gfloat
-clutter_actor_get_z_position (ClutterActor *self)
-{
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0.f);
+      /* we only queue a relayout here, because any possible
+       * redraw has already been queued either by show() or
+       * by our call to queue_redraw() above
+       */
+      _clutter_actor_queue_only_relayout (child->priv->parent);
+    }
 
-  return _clutter_actor_get_transform_info_or_defaults (self)->z_position;
-}
+  if (emit_actor_added)
+    g_signal_emit_by_name (self, "actor-added", child);
 
-/**
- * clutter_actor_set_pivot_point:
- * @self: a #ClutterActor
- * @pivot_x: the normalized X coordinate of the pivot point
- * @pivot_y: the normalized Y coordinate of the pivot point
- *
- * Sets the position of the #ClutterActor:pivot-point around which the
- * scaling and rotation transformations occur.
- *
- * The pivot point's coordinates are in normalized space, with the (0, 0)
- * point being the top left corner of the actor, and the (1, 1) point being
- * the bottom right corner.
- *
- *
- */
-void
-clutter_actor_set_pivot_point (ClutterActor *self,
-                               gfloat        pivot_x,
-                               gfloat        pivot_y)
-{
-  ClutterPoint pivot = CLUTTER_POINT_INIT (pivot_x, pivot_y);
-  const ClutterTransformInfo *info;
+  if (notify_first_last)
+    {
+      if (old_first_child != self->priv->first_child)
+        g_object_notify_by_pspec (obj, obj_props[PROP_FIRST_CHILD]);
 
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+      if (old_last_child != self->priv->last_child)
+        g_object_notify_by_pspec (obj, obj_props[PROP_LAST_CHILD]);
+    }
 
-  info = _clutter_actor_get_transform_info_or_defaults (self);
-  _clutter_actor_create_transition (self, obj_props[PROP_PIVOT_POINT],
-                                    &info->pivot,
-                                    &pivot);
+  g_object_thaw_notify (obj);
 }
 
 /**
- * clutter_actor_get_pivot_point:
+ * clutter_actor_add_child:
  * @self: a #ClutterActor
- * @pivot_x: (out) (allow-none): return location for the normalized X
- *   coordinate of the pivot point, or %NULL
- * @pivot_y: (out) (allow-none): return location for the normalized Y
- *   coordinate of the pivot point, or %NULL
- *
- * Retrieves the coordinates of the #ClutterActor:pivot-point.
+ * @child: a #ClutterActor
  *
+ * Adds @child to the children of @self.
  *
- */
-void
-clutter_actor_get_pivot_point (ClutterActor *self,
-                               gfloat       *pivot_x,
-                               gfloat       *pivot_y)
-{
-  const ClutterTransformInfo *info;
-
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-
-  info = _clutter_actor_get_transform_info_or_defaults (self);
-
-  if (pivot_x != NULL)
-    *pivot_x = info->pivot.x;
-
-  if (pivot_y != NULL)
-    *pivot_y = info->pivot.y;
-}
-
-/**
- * clutter_actor_set_pivot_point_z:
- * @self: a #ClutterActor
- * @pivot_z: the Z coordinate of the actor's pivot point
+ * This function will acquire a reference on @child that will only
+ * be released when calling clutter_actor_remove_child().
  *
- * Sets the component on the Z axis of the #ClutterActor:pivot-point around
- * which the scaling and rotation transformations occur.
+ * This function will take into consideration the #ClutterActor:depth
+ * of @child, and will keep the list of children sorted.
  *
- * The @pivot_z value is expressed as a distance along the Z axis.
+ * This function will emit the #ClutterContainer::actor-added signal
+ * on @self.
  *
  *
  */
 void
-clutter_actor_set_pivot_point_z (ClutterActor *self,
-                                 gfloat        pivot_z)
+clutter_actor_add_child (ClutterActor *self,
+                         ClutterActor *child)
 {
-  const ClutterTransformInfo *info;
-
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (CLUTTER_IS_ACTOR (child));
+  g_return_if_fail (self != child);
+  g_return_if_fail (child->priv->parent == NULL);
 
-  info = _clutter_actor_get_transform_info_or_defaults (self);
-  _clutter_actor_create_transition (self, obj_props[PROP_PIVOT_POINT_Z],
-                                    info->pivot_z,
-                                    pivot_z);
+  clutter_actor_add_child_internal (self, child,
+                                    ADD_CHILD_DEFAULT_FLAGS,
+                                    insert_child_at_depth,
+                                    NULL);
 }
 
 /**
- * clutter_actor_get_pivot_point_z:
+ * clutter_actor_add_children:
  * @self: a #ClutterActor
+ * @children: (array length=n_children): the children to add
+ * @n_children: the number of actors in @children
  *
- * Retrieves the Z component of the #ClutterActor:pivot-point.
- *
- *
- */
-gfloat
-clutter_actor_get_pivot_point_z (ClutterActor *self)
-{
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0.f);
-
-  return _clutter_actor_get_transform_info_or_defaults (self)->pivot_z;
-}
-
-/**
- * clutter_actor_set_clip:
- * @self: A #ClutterActor
- * @xoff: X offset of the clip rectangle
- * @yoff: Y offset of the clip rectangle
- * @width: Width of the clip rectangle
- * @height: Height of the clip rectangle
- *
- * Sets clip area for @self. The clip area is always computed from the
- * upper left corner of the actor.
+ * Adds each actor in @children to the children of @self, as if
+ * clutter_actor_add_child() had been called on each one of them.
  *
+ * The #ClutterActor:first-child and #ClutterActor:last-child properties
+ * are notified at most once, and a single redraw is queued on @self
+ * instead of one for each child, which makes this function cheaper
+ * than adding many children one at a time.
  *
+ * The #ClutterContainer::actor-added signal is still emitted for each
+ * child.
  */
 void
-clutter_actor_set_clip (ClutterActor *self,
-                        gfloat        xoff,
-                        gfloat        yoff,
-                        gfloat        width,
-                        gfloat        height)
+clutter_actor_add_children (ClutterActor  *self,
+                            ClutterActor **children,
+                            guint          n_children)
 {
-  ClutterActorPrivate *priv;
+  ClutterActor *old_first_child, *old_last_child;
+  gboolean queue_redraw = FALSE;
   GObject *obj;
+  guint i;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (children != NULL || n_children == 0);
 
-  priv = self->priv;
+  for (i = 0; i < n_children; i++)
+    {
+      g_return_if_fail (CLUTTER_IS_ACTOR (children[i]));
+      g_return_if_fail (children[i] != self);
+      g_return_if_fail (children[i]->priv->parent == NULL);
+    }
 
-  if (priv->has_clip &&
-      priv->clip.origin.x == xoff &&
-      priv->clip.origin.y == yoff &&
-      priv->clip.size.width == width &&
-      priv->clip.size.height == height)
+  if (n_children == 0)
     return;
 
-  obj = G_OBJECT (self);
-
-  priv->clip.origin.x = xoff;
-  priv->clip.origin.y = yoff;
-  priv->clip.size.width = width;
-  priv->clip.size.height = height;
-
-  priv->has_clip = TRUE;
-
-  clutter_actor_queue_redraw (self);
+  old_first_child = self->priv->first_child;
+  old_last_child = self->priv->last_child;
 
-  g_object_notify_by_pspec (obj, obj_props[PROP_CLIP_RECT]);
-  g_object_notify_by_pspec (obj, obj_props[PROP_HAS_CLIP]);
-}
+  obj = G_OBJECT (self);
+  g_object_freeze_notify (obj);
 
-/**
- * clutter_actor_remove_clip:
- * @self: A #ClutterActor
- *
- * Removes clip area from @self.
- */
-void
-clutter_actor_remove_clip (ClutterActor *self)
-{
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  for (i = 0; i < n_children; i++)
+    {
+      clutter_actor_add_child_internal (self, children[i],
+                                        ADD_CHILD_BATCH_FLAGS,
+                                        insert_child_at_depth,
+                                        NULL);
 
-  if (!self->priv->has_clip)
-    return;
+      if (CLUTTER_ACTOR_IS_MAPPED (children[i]))
+        queue_redraw = TRUE;
+    }
 
-  self->priv->has_clip = FALSE;
+  if (queue_redraw)
+    clutter_actor_queue_redraw (self);
 
-  clutter_actor_queue_redraw (self);
+  if (old_first_child != self->priv->first_child)
+    g_object_notify_by_pspec (obj, obj_props[PROP_FIRST_CHILD]);
 
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_HAS_CLIP]);
+  if (old_last_child != self->priv->last_child)
+    g_object_notify_by_pspec (obj, obj_props[PROP_LAST_CHILD]);
+
+  g_object_thaw_notify (obj);
 }
 
 /**
- * clutter_actor_has_clip:
+ * clutter_actor_insert_child_at_index:
  * @self: a #ClutterActor
+ * @child: a #ClutterActor
+ * @index_: the index
  *
- * Determines whether the actor has a clip area set or not.
+ * Inserts @child into the list of children of @self, using the
+ * given @index_. If @index_ is greater than the number of children
+ * in @self, or is less than 0, then the new child is added at the end.
  *
- * Return value: %TRUE if the actor has a clip area set.
+ * This function will acquire a reference on @child that will only
+ * be released when calling clutter_actor_remove_child().
+ *
+ * This function will not take into consideration the #ClutterActor:depth
+ * of @child.
+ *
+ * This function will emit the #ClutterContainer::actor-added signal
+ * on @self.
  *
  *
  */
-gboolean
-clutter_actor_has_clip (ClutterActor *self)
+void
+clutter_actor_insert_child_at_index (ClutterActor *self,
+                                     ClutterActor *child,
+                                     gint          index_)
 {
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (CLUTTER_IS_ACTOR (child));
+  g_return_if_fail (self != child);
+  g_return_if_fail (child->priv->parent == NULL);
 
-  return self->priv->has_clip;
+  clutter_actor_add_child_internal (self, child,
+                                    ADD_CHILD_DEFAULT_FLAGS,
+                                    insert_child_at_index,
+                                    GINT_TO_POINTER (index_));
 }
 
 /**
- * clutter_actor_get_clip:
+ * clutter_actor_insert_child_above:
  * @self: a #ClutterActor
- * @xoff: (out) (allow-none): return location for the X offset of
- *   the clip rectangle, or %NULL
- * @yoff: (out) (allow-none): return location for the Y offset of
- *   the clip rectangle, or %NULL
- * @width: (out) (allow-none): return location for the width of
- *   the clip rectangle, or %NULL
- * @height: (out) (allow-none): return location for the height of
- *   the clip rectangle, or %NULL
+ * @child: a #ClutterActor
+ * @sibling: (allow-none): a child of @self, or %NULL
  *
- * Gets the clip area for @self, if any is set.
+ * Inserts @child into the list of children of @self, above another
+ * child of @self or, if @sibling is %NULL, above all the children
+ * of @self.
+ *
+ * This function will acquire a reference on @child that will only
+ * be released when calling clutter_actor_remove_child().
+ *
+ * This function will not take into consideration the #ClutterActor:depth
+ * of @child.
+ *
+ * This function will emit the #ClutterContainer::actor-added signal
+ * on @self.
  *
  *
  */
 void
-clutter_actor_get_clip (ClutterActor *self,
-                        gfloat       *xoff,
-                        gfloat       *yoff,
-                        gfloat       *width,
-                        gfloat       *height)
+clutter_actor_insert_child_above (ClutterActor *self,
+                                  ClutterActor *child,
+                                  ClutterActor *sibling)
 {
-  ClutterActorPrivate *priv;
-
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (CLUTTER_IS_ACTOR (child));
+  g_return_if_fail (self != child);
+  g_return_if_fail (child != sibling);
+  g_return_if_fail (child->priv->parent == NULL);
+  g_return_if_fail (sibling == NULL ||
+                    (CLUTTER_IS_ACTOR (sibling) &&
+                     sibling->priv->parent == self));
 
-  priv = self->priv;
-
-  if (!priv->has_clip)
-    return;
-
-  if (xoff != NULL)
-    *xoff = priv->clip.origin.x;
-
-  if (yoff != NULL)
-    *yoff = priv->clip.origin.y;
-
-  if (width != NULL)
-    *width = priv->clip.size.width;
-
-  if (height != NULL)
-    *height = priv->clip.size.height;
+  clutter_actor_add_child_internal (self, child,
+                                    ADD_CHILD_DEFAULT_FLAGS,
+                                    insert_child_above,
+                                    sibling);
 }
 
 /**
- * clutter_actor_get_children:
+ * clutter_actor_insert_child_below:
  * @self: a #ClutterActor
+ * @child: a #ClutterActor
+ * @sibling: (allow-none): a child of @self, or %NULL
  *
- * Retrieves the list of children of @self.
+ * Inserts @child into the list of children of @self, below another
+ * child of @self or, if @sibling is %NULL, below all the children
+ * of @self.
  *
- * Return value: (transfer container) (element-type ClutterActor): A newly
- *   allocated #GList of #ClutterActor<!-- -->s. Use g_list_free() when
- *   done.
+ * This function will acquire a reference on @child that will only
+ * be released when calling clutter_actor_remove_child().
+ *
+ * This function will not take into consideration the #ClutterActor:depth
+ * of @child.
+ *
+ * This function will emit the #ClutterContainer::actor-added signal
+ * on @self.
  *
  *
  */
-GList *
-clutter_actor_get_children (ClutterActor *self)
+void
+clutter_actor_insert_child_below (ClutterActor *self,
+                                  ClutterActor *child,
+                                  ClutterActor *sibling)
 {
-  ClutterActor *iter;
-  GList *res;
-
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
-
-  /* we walk the list backward so that we can use prepend(),
-   * which is O(1)
-   */
-  for (iter = self->priv->last_child, res = NULL;
-       iter != NULL;
-       iter = iter->priv->prev_sibling)
-    {
-      res = g_list_prepend (res, iter);
-    }
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (CLUTTER_IS_ACTOR (child));
+  g_return_if_fail (self != child);
+  g_return_if_fail (child != sibling);
+  g_return_if_fail (child->priv->parent == NULL);
+  g_return_if_fail (sibling == NULL ||
+                    (CLUTTER_IS_ACTOR (sibling) &&
+                     sibling->priv->parent == self));
 
-  return res;
+  clutter_actor_add_child_internal (self, child,
+                                    ADD_CHILD_DEFAULT_FLAGS,
+                                    insert_child_below,
+                                    sibling);
 }
 
-/*< private >
- * insert_child_at_depth:
- * @self: a #ClutterActor
- * @child: a #ClutterActor
+/**
+ * clutter_actor_get_parent:
+ * @self: A #ClutterActor
  *
- * Inserts @child inside the list of children held by @self, using
- * the depth as the insertion criteria.
+ * Retrieves the parent of @self.
  *
- * This sadly makes the insertion not O(1), but we can keep the
- * list sorted so that the painters algorithm we use for painting
- * the children will work correctly.
+ * Return Value: (transfer none): The #ClutterActor parent, or %NULL
+ *  if no parent is set
  */
-static void
-insert_child_at_depth (ClutterActor *self,
-                       ClutterActor *child,
-                       gpointer      dummy G_GNUC_UNUSED)
+ClutterActor *
+clutter_actor_get_parent (ClutterActor *self)
 {
-  ClutterActor *iter;
-  float child_depth;
-
-  child->priv->parent = self;
-
-  child_depth =
-    _clutter_actor_get_transform_info_or_defaults (child)->z_position;
-
-  /* special-case the first child */
-  if (self->priv->n_children == 0)
-    {
-      self->priv->first_child = child;
-      self->priv->last_child = child;
-
-      child->priv->next_sibling = NULL;
-      child->priv->prev_sibling = NULL;
-
-      return;
-    }
-
-  /* Find the right place to insert the child so that it will still be
-     sorted and the child will be after all of the actors at the same
-     dept */
-  for (iter = self->priv->first_child;
-       iter != NULL;
-       iter = iter->priv->next_sibling)
-    {
-      float iter_depth;
-
-      iter_depth =
-        _clutter_actor_get_transform_info_or_defaults (iter)->z_position;
-
-      if (iter_depth > child_depth)
-        break;
-    }
-
-  if (iter != NULL)
-    {
-      ClutterActor *tmp = iter->priv->prev_sibling;
-
-      if (tmp != NULL)
-        tmp->priv->next_sibling = child;
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
 
-      /* Insert the node before the found one */
-      child->priv->prev_sibling = iter->priv->prev_sibling;
-      child->priv->next_sibling = iter;
-      iter->priv->prev_sibling = child;
-    }
-  else
-    {
-      ClutterActor *tmp = self->priv->last_child;
+  return self->priv->parent;
+}
 
-      if (tmp != NULL)
-        tmp->priv->next_sibling = child;
+/**
+ * clutter_actor_get_paint_visibility:
+ * @self: A #ClutterActor
+ *
+ * Retrieves the 'paint' visibility of an actor recursively checking for non
+ * visible parents.
+ *
+ * This is by definition the same as %CLUTTER_ACTOR_IS_MAPPED.
+ *
+ * Return Value: %TRUE if the actor is visibile and will be painted.
+ *
+ *
+ */
+gboolean
+clutter_actor_get_paint_visibility (ClutterActor *actor)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (actor), FALSE);
 
-      /* insert the node at the end of the list */
-      child->priv->prev_sibling = self->priv->last_child;
-      child->priv->next_sibling = NULL;
-    }
+  return CLUTTER_ACTOR_IS_MAPPED (actor);
+}
 
-  if (child->priv->prev_sibling == NULL)
-    self->priv->first_child = child;
+/**
+ * clutter_actor_remove_child:
+ * @self: a #ClutterActor
+ * @child: a #ClutterActor
+ *
+ * Removes @child from the children of @self.
+ *
+ * This function will release the reference added by
+ * clutter_actor_add_child(), so if you want to keep using @child
+ * you will have to acquire a referenced on it before calling this
+ * function.
+ *
+ * This function will emit the #ClutterContainer::actor-removed
+ * signal on @self.
+ *
+ *
+ */
+void
+clutter_actor_remove_child (ClutterActor *self,
+                            ClutterActor *child)
+{
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (CLUTTER_IS_ACTOR (child));
+  g_return_if_fail (self != child);
+  g_return_if_fail (child->priv->parent != NULL);
+  g_return_if_fail (child->priv->parent == self);
 
-  if (child->priv->next_sibling == NULL)
-    self->priv->last_child = child;
+  clutter_actor_remove_child_internal (self, child,
+                                       REMOVE_CHILD_DEFAULT_FLAGS);
 }
 
-static void
-insert_child_at_index (ClutterActor *self,
-                       ClutterActor *child,
-                       gpointer      data_)
+/**
+ * clutter_actor_remove_all_children:
+ * @self: a #ClutterActor
+ *
+ * Removes all children of @self.
+ *
+ * This function releases the reference added by inserting a child actor
+ * in the list of children of @self.
+ *
+ * If the reference count of a child drops to zero, the child will be
+ * destroyed. If you want to ensure the destruction of all the children
+ * of @self, use clutter_actor_destroy_all_children().
+ *
+ *
+ */
+void
+clutter_actor_remove_all_children (ClutterActor *self)
 {
-  gint index_ = GPOINTER_TO_INT (data_);
+  ClutterActorIter iter;
 
-  child->priv->parent = self;
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  if (index_ == 0)
-    {
-      ClutterActor *tmp = self->priv->first_child;
+  if (self->priv->n_children == 0)
+    return;
 
-      if (tmp != NULL)
-        tmp->priv->prev_sibling = child;
+  g_object_freeze_notify (G_OBJECT (self));
 
-      child->priv->prev_sibling = NULL;
-      child->priv->next_sibling = tmp;
-    }
-  else if (index_ < 0 || index_ >= self->priv->n_children)
-    {
-      ClutterActor *tmp = self->priv->last_child;
+  clutter_actor_iter_init (&iter, self);
+  while (clutter_actor_iter_next (&iter, NULL))
+    clutter_actor_iter_remove (&iter);
 
-      if (tmp != NULL)
-        tmp->priv->next_sibling = child;
+  g_object_thaw_notify (G_OBJECT (self));
 
-      child->priv->prev_sibling = tmp;
-      child->priv->next_sibling = NULL;
-    }
-  else
-    {
-      ClutterActor *iter;
-      int i;
+  /* sanity check */
+  g_assert (self->priv->first_child == NULL);
+  g_assert (self->priv->last_child == NULL);
+  g_assert (self->priv->n_children == 0);
+}
 
-      for (iter = self->priv->first_child, i = 0;
-           iter != NULL;
-           iter = iter->priv->next_sibling, i += 1)
-        {
-          if (index_ == i)
-            {
-              ClutterActor *tmp = iter->priv->prev_sibling;
+/**
+ * clutter_actor_destroy_all_children:
+ * @self: a #ClutterActor
+ *
+ * Destroys all children of @self.
+ *
+ * This function releases the reference added by inserting a child
+ * actor in the list of children of @self, and ensures that the
+ * #ClutterActor::destroy signal is emitted on each child of the
+ * actor.
+ *
+ * By default, #ClutterActor will emit the #ClutterActor::destroy signal
+ * when its reference count drops to 0; the default handler of the
+ * #ClutterActor::destroy signal will destroy all the children of an
+ * actor. This function ensures that all children are destroyed, instead
+ * of just removed from @self, unlike clutter_actor_remove_all_children()
+ * which will merely release the reference and remove each child.
+ *
+ * Unless you acquired an additional reference on each child of @self
+ * prior to calling clutter_actor_remove_all_children() and want to reuse
+ * the actors, you should use clutter_actor_destroy_all_children() in
+ * order to make sure that children are destroyed and signal handlers
+ * are disconnected even in cases where circular references prevent this
+ * from automatically happening through reference counting alone.
+ *
+ *
+ */
+void
+clutter_actor_destroy_all_children (ClutterActor *self)
+{
+  ClutterActorIter iter;
 
-              child->priv->prev_sibling = tmp;
-              child->priv->next_sibling = iter;
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-              iter->priv->prev_sibling = child;
+  if (self->priv->n_children == 0)
+    return;
 
-              if (tmp != NULL)
-                tmp->priv->next_sibling = child;
+  g_object_freeze_notify (G_OBJECT (self));
 
-              break;
-            }
-        }
-    }
+  clutter_actor_iter_init (&iter, self);
+  while (clutter_actor_iter_next (&iter, NULL))
+    clutter_actor_iter_destroy (&iter);
 
-  if (child->priv->prev_sibling == NULL)
-    self->priv->first_child = child;
+  g_object_thaw_notify (G_OBJECT (self));
 
-  if (child->priv->next_sibling == NULL)
-    self->priv->last_child = child;
+  /* sanity check */
+  g_assert (self->priv->first_child == NULL);
+  g_assert (self->priv->last_child == NULL);
+  g_assert (self->priv->n_children == 0);
 }
 
+/* updates @child to display the row pointed by @iter, or creates a new
+ * child at @index_ if @child is %NULL
+ */
 static void
-insert_child_above (ClutterActor *self,
-                    ClutterActor *child,
-                    gpointer      data)
+clutter_actor_update_model_child (ClutterActor     *self,
+                                  ClutterModelIter *iter,
+                                  ClutterActor     *child,
+                                  gint              index_)
 {
-  ClutterActor *sibling = data;
-
-  child->priv->parent = self;
-
-  if (sibling == NULL)
-    sibling = self->priv->last_child;
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *retval;
 
-  child->priv->prev_sibling = sibling;
+  retval = priv->model_binding->create_child_func (self, iter, child,
+                                                   priv->model_binding->create_child_data);
+  if (retval == child)
+    return;
 
-  if (sibling != NULL)
+  if (retval == NULL)
     {
-      ClutterActor *tmp = sibling->priv->next_sibling;
-
-      child->priv->next_sibling = tmp;
-
-      if (tmp != NULL)
-        tmp->priv->prev_sibling = child;
+      g_critical ("The function creating the children of the actor '%s' "
+                  "did not return an actor for the row %u of the model",
+                  _clutter_actor_get_debug_name (self),
+                  clutter_model_iter_get_row (iter));
+      return;
+    }
 
-      sibling->priv->next_sibling = child;
+  if (child != NULL)
+    {
+      clutter_actor_insert_child_above (self, retval, child);
+      clutter_actor_destroy (child);
     }
   else
-    child->priv->next_sibling = NULL;
-
-  if (child->priv->prev_sibling == NULL)
-    self->priv->first_child = child;
-
-  if (child->priv->next_sibling == NULL)
-    self->priv->last_child = child;
+    clutter_actor_insert_child_at_index (self, retval, index_);
 }
 
+/* maps the rows of the model to the children in order, reusing the
+ * existing children instead of creating new ones
+ */
 static void
-insert_child_below (ClutterActor *self,
-                    ClutterActor *child,
-                    gpointer      data)
+clutter_actor_sync_model_children (ClutterActor *self)
 {
-  ClutterActor *sibling = data;
-
-  child->priv->parent = self;
-
-  if (sibling == NULL)
-    sibling = self->priv->first_child;
+  ClutterActorPrivate *priv = self->priv;
+  ClutterModelIter *iter;
+  ClutterActor *child;
+  gint index_ = 0;
 
-  child->priv->next_sibling = sibling;
+  child = priv->first_child;
 
-  if (sibling != NULL)
+  iter = clutter_model_get_first_iter (priv->model_binding->model);
+  while (iter != NULL && !clutter_model_iter_is_last (iter))
     {
-      ClutterActor *tmp = sibling->priv->prev_sibling;
-
-      child->priv->prev_sibling = tmp;
+      ClutterActor *next = child != NULL ? child->priv->next_sibling : NULL;
 
-      if (tmp != NULL)
-        tmp->priv->next_sibling = child;
+      clutter_actor_update_model_child (self, iter, child, index_++);
 
-      sibling->priv->prev_sibling = child;
+      child = next;
+      iter = clutter_model_iter_next (iter);
     }
-  else
-    child->priv->prev_sibling = NULL;
 
-  if (child->priv->prev_sibling == NULL)
-    self->priv->first_child = child;
-
-  if (child->priv->next_sibling == NULL)
-    self->priv->last_child = child;
-}
-
-typedef void (* ClutterActorAddChildFunc) (ClutterActor *parent,
-                                           ClutterActor *child,
-                                           gpointer      data);
+  g_clear_object (&iter);
 
-typedef enum {
-  ADD_CHILD_CREATE_META        = 1 << 0,
-  ADD_CHILD_EMIT_PARENT_SET    = 1 << 1,
-  ADD_CHILD_EMIT_ACTOR_ADDED   = 1 << 2,
-  ADD_CHILD_CHECK_STATE        = 1 << 3,
-  ADD_CHILD_NOTIFY_FIRST_LAST  = 1 << 4,
+  /* the model has fewer rows than children */
+  while (child != NULL)
+    {
+      ClutterActor *next = child->priv->next_sibling;
 
-  /* default flags for public API */
-  ADD_CHILD_DEFAULT_FLAGS    = ADD_CHILD_CREATE_META |
-                               ADD_CHILD_EMIT_PARENT_SET |
-                               ADD_CHILD_EMIT_ACTOR_ADDED |
-                               ADD_CHILD_CHECK_STATE |
-                               ADD_CHILD_NOTIFY_FIRST_LAST
-} ClutterActorAddChildFlags;
+      clutter_actor_destroy (child);
+      child = next;
+    }
+}
 
-/*< private >
- * clutter_actor_add_child_internal:
- * @self: a #ClutterActor
- * @child: a #ClutterActor
- * @flags: control flags for actions
- * @add_func: delegate function
- * @data: (closure): data to pass to @add_func
- *
- * Adds @child to the list of children of @self.
- *
- * The actual insertion inside the list is delegated to @add_func: this
- * function will just set up the state, perform basic checks, and emit
- * signals.
- *
- * The @flags argument is used to perform additional operations.
+/* rows can only be mapped to a position in the list of children if
+ * the model is neither sorted nor filtered; otherwise adding or
+ * changing a row can move other rows around
  */
-static inline void
-clutter_actor_add_child_internal (ClutterActor              *self,
-                                  ClutterActor              *child,
-                                  ClutterActorAddChildFlags  flags,
-                                  ClutterActorAddChildFunc   add_func,
-                                  gpointer                   data)
+static inline gboolean
+clutter_actor_model_is_plain (ClutterModel *model)
 {
-  ClutterTextDirection text_dir;
-  gboolean create_meta;
-  gboolean emit_parent_set, emit_actor_added;
-  gboolean check_state;
-  gboolean notify_first_last;
-  gboolean show_on_set_parent;
-  ClutterActor *old_first_child, *old_last_child;
-  GObject *obj;
+  return clutter_model_get_sorting_column (model) < 0 &&
+         !clutter_model_get_filter_set (model);
+}
 
-  if (child->priv->parent != NULL)
+static void
+on_child_model_row_added (ClutterModel     *model,
+                          ClutterModelIter *iter,
+                          ClutterActor     *self)
+{
+  if (!clutter_actor_model_is_plain (model))
     {
-      g_warning ("The actor '%s' already has a parent, '%s'. You must "
-                 "use clutter_actor_remove_child() first.",
-                 _clutter_actor_get_debug_name (child),
-                 _clutter_actor_get_debug_name (child->priv->parent));
+      clutter_actor_sync_model_children (self);
       return;
     }
 
-  if (CLUTTER_ACTOR_IS_TOPLEVEL (child))
+  clutter_actor_update_model_child (self, iter, NULL,
+                                    clutter_model_iter_get_row (iter));
+}
+
+static void
+on_child_model_row_removed (ClutterModel     *model,
+                            ClutterModelIter *iter,
+                            ClutterActor     *self)
+{
+  ClutterActor *child;
+
+  /* the row is still inside the model at this point */
+  if (clutter_model_get_filter_set (model) &&
+      !clutter_model_filter_iter (model, iter))
+    return;
+
+  child = clutter_actor_get_child_at_index (self,
+                                            clutter_model_iter_get_row (iter));
+  if (child != NULL)
+    clutter_actor_destroy (child);
+}
+
+static void
+on_child_model_row_changed (ClutterModel     *model,
+                            ClutterModelIter *iter,
+                            ClutterActor     *self)
+{
+  ClutterActor *child;
+
+  if (!clutter_actor_model_is_plain (model))
     {
-      g_warning ("The actor '%s' is a top-level actor, and cannot be "
-                 "a child of another actor.",
-                 _clutter_actor_get_debug_name (child));
+      clutter_actor_sync_model_children (self);
       return;
     }
 
-  /* the following check disallows calling methods that change the stacking
-   * order within the destruction sequence, by triggering a critical
-   * warning first, and leaving the actor in an undefined state, which
-   * then ends up being caught by an assertion.
-   *
-   * the reproducible sequence is:
-   *
-   *   - actor gets destroyed;
-   *   - another actor, linked to the first, will try to change the
-   *     stacking order of the first actor;
-   *   - changing the stacking order is a composite operation composed
-   *     by the following steps:
-   *     1. ref() the child;
-   *     2. remove_child_internal(), which removes the reference;
-   *     3. add_child_internal(), which adds a reference;
-   *   - the state of the actor is not changed between (2) and (3), as
-   *     it could be an expensive recomputation;
-   *   - if (3) bails out, then the actor is in an undefined state, but
-   *     still alive;
-   *   - the destruction sequence terminates, but the actor is unparented
-   *     while its state indicates being parented instead.
-   *   - assertion failure.
-   *
-   * the obvious fix would be to decompose each set_child_*_sibling()
-   * method into proper remove_child()/add_child(), with state validation;
-   * this may cause excessive work, though, and trigger a cascade of other
-   * bugs in code that assumes that a change in the stacking order is an
-   * atomic operation.
-   *
-   * another potential fix is to just remove this check here, and let
-   * code doing stacking order changes inside the destruction sequence
-   * of an actor continue doing the stacking changes as before; this
-   * option still performs more work than necessary.
-   *
-   * the third fix is to silently bail out early from every
-   * set_child_*_sibling() and set_child_at_index() method, and avoid
-   * doing stack changes altogether; Clutter implements this last option.
-   *
-   * see bug: https://bugzilla.gnome.org/show_bug.cgi?id=670647
-   */
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (child))
+  child = clutter_actor_get_child_at_index (self,
+                                            clutter_model_iter_get_row (iter));
+  if (child != NULL)
+    clutter_actor_update_model_child (self, iter, child, -1);
+}
+
+static void
+on_child_model_rows_changed (ClutterModel *model,
+                             guint         position,
+                             guint         n_removed,
+                             guint         n_added,
+                             ClutterActor *self)
+{
+  ClutterModelIter *iter = NULL;
+  ClutterActor *child;
+  guint i, n_reused;
+
+  if (!clutter_actor_model_is_plain (model))
     {
-      g_warning ("The actor '%s' is currently being destroyed, and "
-                 "cannot be added as a child of another actor.",
-                 _clutter_actor_get_debug_name (child));
+      clutter_actor_sync_model_children (self);
       return;
     }
 
-  create_meta = (flags & ADD_CHILD_CREATE_META) != 0;
-  emit_parent_set = (flags & ADD_CHILD_EMIT_PARENT_SET) != 0;
-  emit_actor_added = (flags & ADD_CHILD_EMIT_ACTOR_ADDED) != 0;
-  check_state = (flags & ADD_CHILD_CHECK_STATE) != 0;
-  notify_first_last = (flags & ADD_CHILD_NOTIFY_FIRST_LAST) != 0;
-  show_on_set_parent = CLUTTER_ACTOR_IS_VISIBLE (child);
+  /* the children of the replaced rows display the added ones */
+  n_reused = MIN (n_removed, n_added);
+  child = clutter_actor_get_child_at_index (self, position);
 
-  old_first_child = self->priv->first_child;
-  old_last_child = self->priv->last_child;
+  if (n_added > 0)
+    iter = clutter_model_get_iter_at_row (model, position);
 
-  obj = G_OBJECT (self);
-  g_object_freeze_notify (obj);
+  for (i = 0; i < n_added && iter != NULL; i++)
+    {
+      ClutterActor *next = NULL;
 
-  if (create_meta)
-    clutter_container_create_child_meta (CLUTTER_CONTAINER (self), child);
+      if (i < n_reused && child != NULL)
+        {
+          next = child->priv->next_sibling;
+          clutter_actor_update_model_child (self, iter, child, -1);
+        }
+      else
+        clutter_actor_update_model_child (self, iter, NULL, position + i);
 
-  g_object_ref_sink (child);
-  child->priv->parent = NULL;
-  child->priv->next_sibling = NULL;
-  child->priv->prev_sibling = NULL;
+      child = next;
+      iter = clutter_model_iter_next (iter);
+    }
 
-  /* delegate the actual insertion */
-  add_func (self, child, data);
+  g_clear_object (&iter);
 
-  g_assert (child->priv->parent == self);
+  for (i = n_reused; i < n_removed; i++)
+    {
+      child = clutter_actor_get_child_at_index (self, position + n_added);
+      if (child == NULL)
+        break;
 
-  self->priv->n_children += 1;
+      clutter_actor_destroy (child);
+    }
+}
 
-  self->priv->age += 1;
+static void
+on_child_model_reordered (ClutterModel *model,
+                          ClutterActor *self)
+{
+  clutter_actor_sync_model_children (self);
+}
 
-  /* if push_internal() has been called then we automatically set
-   * the flag on the actor
-   */
-  if (self->priv->internal_child)
-    CLUTTER_SET_PRIVATE_FLAGS (child, CLUTTER_INTERNAL_CHILD);
+/**
+ * clutter_actor_bind_model:
+ * @self: a #ClutterActor
+ * @model: (allow-none): a #ClutterModel, or %NULL
+ * @create_child_func: the function used to create the children of @self
+ * @user_data: data passed to @create_child_func
+ * @notify: function called when unsetting the model
+ *
+ * Binds a #ClutterModel to @self, so that each row of @model is
+ * displayed by a child of @self, in the same order as the rows.
+ *
+ * The children are created using @create_child_func, and they are
+ * kept up to date whenever @model changes: when a row changes, or when
+ * @model is sorted or filtered, the existing children are passed to
+ * @create_child_func to be updated in place, instead of being destroyed
+ * and created again.
+ *
+ * Any child of @self will be destroyed when binding a model. The list of
+ * children of @self should not be changed while @model is bound, except
+ * by @create_child_func.
+ *
+ * Passing %NULL for @model removes the binding, but leaves the existing
+ * children in place.
+ */
+void
+clutter_actor_bind_model (ClutterActor                *self,
+                          ClutterModel                *model,
+                          ClutterActorCreateChildFunc  create_child_func,
+                          gpointer                     user_data,
+                          GDestroyNotify               notify)
+{
+  ClutterActorPrivate *priv;
 
-  /* children may cause their parent to expand, if they are set
-   * to expand; if a child is not expanded then it cannot change
-   * its parent's state. any further change later on will queue
-   * an expand state check.
-   *
-   * this check, with the initial state of the needs_compute_expand
-   * flag set to FALSE, should avoid recomputing the expand flags
-   * state while building the actor tree.
-   */
-  if (CLUTTER_ACTOR_IS_VISIBLE (child) &&
-      (child->priv->needs_compute_expand ||
-       child->priv->needs_x_expand ||
-       child->priv->needs_y_expand))
-    {
-      clutter_actor_queue_compute_expand (self);
-    }
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (model == NULL || CLUTTER_IS_MODEL (model));
+  g_return_if_fail (model == NULL || create_child_func != NULL);
 
-  /* clutter_actor_reparent() will emit ::parent-set for us */
-  if (emit_parent_set && !CLUTTER_ACTOR_IN_REPARENT (child))
-    g_signal_emit (child, actor_signals[PARENT_SET], 0, NULL);
+  priv = self->priv;
 
-  if (check_state)
+  if (priv->model_binding != NULL)
     {
-      /* If parent is mapped or realized, we need to also be mapped or
-       * realized once we're inside the parent.
-       */
-      clutter_actor_update_map_state (child, MAP_STATE_CHECK);
+      ModelBinding *binding = priv->model_binding;
 
-      /* propagate the parent's text direction to the child */
-      text_dir = clutter_actor_get_text_direction (self);
-      clutter_actor_set_text_direction (child, text_dir);
+      g_signal_handlers_disconnect_by_func (binding->model,
+                                            on_child_model_row_added,
+                                            self);
+      g_signal_handlers_disconnect_by_func (binding->model,
+                                            on_child_model_row_removed,
+                                            self);
+      g_signal_handlers_disconnect_by_func (binding->model,
+                                            on_child_model_row_changed,
+                                            self);
+      g_signal_handlers_disconnect_by_func (binding->model,
+                                            on_child_model_rows_changed,
+                                            self);
+      g_signal_handlers_disconnect_by_func (binding->model,
+                                            on_child_model_reordered,
+                                            self);
+      g_object_unref (binding->model);
+
+      if (binding->create_child_notify != NULL)
+        binding->create_child_notify (binding->create_child_data);
+
+      g_slice_free (ModelBinding, binding);
+      priv->model_binding = NULL;
+
+      _clutter_memory_account (CLUTTER_MEMORY_ACTORS,
+                               -(gssize) sizeof (ModelBinding),
+                               0);
     }
 
-  /* this may end up queueing a redraw, in case the actor is
-   * not visible but the show-on-set-parent property is still
-   * set.
-   */
-  if (show_on_set_parent)
-    clutter_actor_show (child);
+  if (model == NULL)
+    return;
 
-  /* on the other hand, this will catch any other case where
-   * the actor is supposed to be visible when it's added
-   */
-  if (CLUTTER_ACTOR_IS_MAPPED (child))
-    clutter_actor_queue_redraw (child);
+  priv->model_binding = g_slice_new (ModelBinding);
+  priv->model_binding->model = g_object_ref (model);
+  priv->model_binding->create_child_func = create_child_func;
+  priv->model_binding->create_child_data = user_data;
+  priv->model_binding->create_child_notify = notify;
+
+  _clutter_memory_account (CLUTTER_MEMORY_ACTORS, sizeof (ModelBinding), 0);
+
+  g_signal_connect (model, "row-added",
+                    G_CALLBACK (on_child_model_row_added),
+                    self);
+  g_signal_connect (model, "row-removed",
+                    G_CALLBACK (on_child_model_row_removed),
+                    self);
+  g_signal_connect (model, "row-changed",
+                    G_CALLBACK (on_child_model_row_changed),
+                    self);
+  g_signal_connect (model, "rows-changed",
+                    G_CALLBACK (on_child_model_rows_changed),
+                    self);
+  g_signal_connect (model, "sort-changed",
+                    G_CALLBACK (on_child_model_reordered),
+                    self);
+  g_signal_connect (model, "filter-changed",
+                    G_CALLBACK (on_child_model_reordered),
+                    self);
+
+  clutter_actor_destroy_all_children (self);
+  clutter_actor_sync_model_children (self);
+}
 
-  /* maintain the invariant that if an actor needs layout,
-   * its parents do as well
-   */
-  if (child->priv->needs_width_request ||
-      child->priv->needs_height_request ||
-      child->priv->needs_allocation)
-    {
-      /* we work around the short-circuiting we do
-       * in clutter_actor_queue_relayout() since we
-       * want to force a relayout
-       */
-      child->priv->needs_width_request = TRUE;
-      child->priv->needs_height_request = TRUE;
-      child->priv->needs_allocation = TRUE;
+typedef struct _InsertBetweenData {
+  ClutterActor *prev_sibling;
+  ClutterActor *next_sibling;
+} InsertBetweenData;
+
+static void
+insert_child_between (ClutterActor *self,
+                      ClutterActor *child,
+                      gpointer      data_)
+{
+  InsertBetweenData *data = data_;
+  ClutterActor *prev_sibling = data->prev_sibling;
+  ClutterActor *next_sibling = data->next_sibling;
+
+  child->priv->parent = self;
+  child->priv->prev_sibling = prev_sibling;
+  child->priv->next_sibling = next_sibling;
+
+  if (prev_sibling != NULL)
+    prev_sibling->priv->next_sibling = child;
+
+  if (next_sibling != NULL)
+    next_sibling->priv->prev_sibling = child;
+
+  if (child->priv->prev_sibling == NULL)
+    self->priv->first_child = child;
+
+  if (child->priv->next_sibling == NULL)
+    self->priv->last_child = child;
+}
+
+/**
+ * clutter_actor_replace_child:
+ * @self: a #ClutterActor
+ * @old_child: the child of @self to replace
+ * @new_child: the #ClutterActor to replace @old_child
+ *
+ * Replaces @old_child with @new_child in the list of children of @self.
+ *
+ *
+ */
+void
+clutter_actor_replace_child (ClutterActor *self,
+                             ClutterActor *old_child,
+                             ClutterActor *new_child)
+{
+  ClutterActor *prev_sibling, *next_sibling;
+  InsertBetweenData clos;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (CLUTTER_IS_ACTOR (old_child));
+  g_return_if_fail (old_child->priv->parent == self);
+  g_return_if_fail (CLUTTER_IS_ACTOR (new_child));
+  g_return_if_fail (old_child != new_child);
+  g_return_if_fail (new_child != self);
+  g_return_if_fail (new_child->priv->parent == NULL);
+
+  prev_sibling = old_child->priv->prev_sibling;
+  next_sibling = old_child->priv->next_sibling;
+  clutter_actor_remove_child_internal (self, old_child,
+                                       REMOVE_CHILD_DEFAULT_FLAGS);
+
+  clos.prev_sibling = prev_sibling;
+  clos.next_sibling = next_sibling;
+  clutter_actor_add_child_internal (self, new_child,
+                                    ADD_CHILD_DEFAULT_FLAGS,
+                                    insert_child_between,
+                                    &clos);
+}
+
+/**
+ * clutter_actor_replace_children:
+ * @self: a #ClutterActor
+ * @children: (array length=n_children): the new children of @self
+ * @n_children: the number of actors in @children
+ *
+ * Removes all the children of @self, and adds the actors in @children
+ * in their place, using clutter_actor_add_children().
+ *
+ * The actors in @children must not have a parent, unless it is @self.
+ */
+void
+clutter_actor_replace_children (ClutterActor  *self,
+                                ClutterActor **children,
+                                guint          n_children)
+{
+  guint i;
 
-      /* we only queue a relayout here, because any possible
-       * redraw has already been queued either by show() or
-       * by our call to queue_redraw() above
-       */
-      _clutter_actor_queue_only_relayout (child->priv->parent);
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (children != NULL || n_children == 0);
+
+  for (i = 0; i < n_children; i++)
+    {
+      g_return_if_fail (CLUTTER_IS_ACTOR (children[i]));
+      g_return_if_fail (children[i] != self);
+      g_return_if_fail (children[i]->priv->parent == NULL ||
+                        children[i]->priv->parent == self);
     }
 
-  if (emit_actor_added)
-    g_signal_emit_by_name (self, "actor-added", child);
+  g_object_freeze_notify (G_OBJECT (self));
 
-  if (notify_first_last)
-    {
-      if (old_first_child != self->priv->first_child)
-        g_object_notify_by_pspec (obj, obj_props[PROP_FIRST_CHILD]);
+  /* keep the children that are added back alive while they are
+   * not parented
+   */
+  for (i = 0; i < n_children; i++)
+    g_object_ref (children[i]);
 
-      if (old_last_child != self->priv->last_child)
-        g_object_notify_by_pspec (obj, obj_props[PROP_LAST_CHILD]);
-    }
+  clutter_actor_remove_all_children (self);
+  clutter_actor_add_children (self, children, n_children);
 
-  g_object_thaw_notify (obj);
+  for (i = 0; i < n_children; i++)
+    g_object_unref (children[i]);
+
+  g_object_thaw_notify (G_OBJECT (self));
 }
 
 /**
- * clutter_actor_add_child:
- * @self: a #ClutterActor
- * @child: a #ClutterActor
- *
- * Adds @child to the children of @self.
- *
- * This function will acquire a reference on @child that will only
- * be released when calling clutter_actor_remove_child().
+ * clutter_actor_contains:
+ * @self: A #ClutterActor
+ * @descendant: A #ClutterActor, possibly contained in @self
  *
- * This function will take into consideration the #ClutterActor:depth
- * of @child, and will keep the list of children sorted.
+ * Determines if @descendant is contained inside @self (either as an
+ * immediate child, or as a deeper descendant). If @self and
+ * @descendant point to the same actor then it will also return %TRUE.
  *
- * This function will emit the #ClutterContainer::actor-added signal
- * on @self.
+ * Return value: whether @descendent is contained within @self
  *
  *
  */
-void
-clutter_actor_add_child (ClutterActor *self,
-                         ClutterActor *child)
+gboolean
+clutter_actor_contains (ClutterActor *self,
+			ClutterActor *descendant)
 {
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-  g_return_if_fail (CLUTTER_IS_ACTOR (child));
-  g_return_if_fail (self != child);
-  g_return_if_fail (child->priv->parent == NULL);
+  ClutterActor *actor;
 
-  clutter_actor_add_child_internal (self, child,
-                                    ADD_CHILD_DEFAULT_FLAGS,
-                                    insert_child_at_depth,
-                                    NULL);
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (descendant), FALSE);
+
+  for (actor = descendant; actor; actor = actor->priv->parent)
+    if (actor == self)
+      return TRUE;
+
+  return FALSE;
 }
 
 /**
- * clutter_actor_insert_child_at_index:
+ * clutter_actor_set_child_above_sibling:
  * @self: a #ClutterActor
- * @child: a #ClutterActor
- * @index_: the index
- *
- * Inserts @child into the list of children of @self, using the
- * given @index_. If @index_ is greater than the number of children
- * in @self, or is less than 0, then the new child is added at the end.
+ * @child: a #ClutterActor child of @self
+ * @sibling: (allow-none): a #ClutterActor child of @self, or %NULL
  *
- * This function will acquire a reference on @child that will only
- * be released when calling clutter_actor_remove_child().
+ * Sets @child to be above @sibling in the list of children of @self.
  *
- * This function will not take into consideration the #ClutterActor:depth
- * of @child.
+ * If @sibling is %NULL, @child will be the new last child of @self.
  *
- * This function will emit the #ClutterContainer::actor-added signal
- * on @self.
+ * This function is logically equivalent to removing @child and using
+ * clutter_actor_insert_child_above(), but it will not emit signals
+ * or change state on @child.
  *
  *
  */
 void
-clutter_actor_insert_child_at_index (ClutterActor *self,
-                                     ClutterActor *child,
-                                     gint          index_)
+clutter_actor_set_child_above_sibling (ClutterActor *self,
+                                       ClutterActor *child,
+                                       ClutterActor *sibling)
 {
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
   g_return_if_fail (CLUTTER_IS_ACTOR (child));
-  g_return_if_fail (self != child);
-  g_return_if_fail (child->priv->parent == NULL);
+  g_return_if_fail (child->priv->parent == self);
+  g_return_if_fail (child != sibling);
+  g_return_if_fail (sibling == NULL || CLUTTER_IS_ACTOR (sibling));
+
+  if (sibling != NULL)
+    g_return_if_fail (sibling->priv->parent == self);
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self) ||
+      CLUTTER_ACTOR_IN_DESTRUCTION (child) ||
+      (sibling != NULL && CLUTTER_ACTOR_IN_DESTRUCTION (sibling)))
+    return;
 
+  /* we don't want to change the state of child, or emit signals, or
+   * regenerate ChildMeta instances here, but we still want to follow
+   * the correct sequence of steps encoded in remove_child() and
+   * add_child(), so that correctness is ensured, and we only go
+   * through one known code path.
+   */
+  g_object_ref (child);
+  clutter_actor_remove_child_internal (self, child, 0);
   clutter_actor_add_child_internal (self, child,
-                                    ADD_CHILD_DEFAULT_FLAGS,
-                                    insert_child_at_index,
-                                    GINT_TO_POINTER (index_));
+                                    ADD_CHILD_NOTIFY_FIRST_LAST |
+                                    ADD_CHILD_QUEUE_REDRAW,
+                                    insert_child_above,
+                                    sibling);
+
+  clutter_actor_queue_relayout (self);
 }
 
 /**
- * clutter_actor_insert_child_above:
+ * clutter_actor_set_child_below_sibling:
  * @self: a #ClutterActor
- * @child: a #ClutterActor
- * @sibling: (allow-none): a child of @self, or %NULL
- *
- * Inserts @child into the list of children of @self, above another
- * child of @self or, if @sibling is %NULL, above all the children
- * of @self.
+ * @child: a #ClutterActor child of @self
+ * @sibling: (allow-none): a #ClutterActor child of @self, or %NULL
  *
- * This function will acquire a reference on @child that will only
- * be released when calling clutter_actor_remove_child().
+ * Sets @child to be below @sibling in the list of children of @self.
  *
- * This function will not take into consideration the #ClutterActor:depth
- * of @child.
+ * If @sibling is %NULL, @child will be the new first child of @self.
  *
- * This function will emit the #ClutterContainer::actor-added signal
- * on @self.
+ * This function is logically equivalent to removing @self and using
+ * clutter_actor_insert_child_below(), but it will not emit signals
+ * or change state on @child.
  *
  *
  */
 void
-clutter_actor_insert_child_above (ClutterActor *self,
-                                  ClutterActor *child,
-                                  ClutterActor *sibling)
+clutter_actor_set_child_below_sibling (ClutterActor *self,
+                                       ClutterActor *child,
+                                       ClutterActor *sibling)
 {
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
   g_return_if_fail (CLUTTER_IS_ACTOR (child));
-  g_return_if_fail (self != child);
+  g_return_if_fail (child->priv->parent == self);
   g_return_if_fail (child != sibling);
-  g_return_if_fail (child->priv->parent == NULL);
-  g_return_if_fail (sibling == NULL ||
-                    (CLUTTER_IS_ACTOR (sibling) &&
-                     sibling->priv->parent == self));
+  g_return_if_fail (sibling == NULL || CLUTTER_IS_ACTOR (sibling));
+
+  if (sibling != NULL)
+    g_return_if_fail (sibling->priv->parent == self);
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self) ||
+      CLUTTER_ACTOR_IN_DESTRUCTION (child) ||
+      (sibling != NULL && CLUTTER_ACTOR_IN_DESTRUCTION (sibling)))
+    return;
 
+  /* see the comment in set_child_above_sibling() */
+  g_object_ref (child);
+  clutter_actor_remove_child_internal (self, child, 0);
   clutter_actor_add_child_internal (self, child,
-                                    ADD_CHILD_DEFAULT_FLAGS,
-                                    insert_child_above,
+                                    ADD_CHILD_NOTIFY_FIRST_LAST |
+                                    ADD_CHILD_QUEUE_REDRAW,
+                                    insert_child_below,
                                     sibling);
+
+  clutter_actor_queue_relayout (self);
 }
 
 /**
- * clutter_actor_insert_child_below:
+ * clutter_actor_set_child_at_index:
  * @self: a #ClutterActor
- * @child: a #ClutterActor
- * @sibling: (allow-none): a child of @self, or %NULL
- *
- * Inserts @child into the list of children of @self, below another
- * child of @self or, if @sibling is %NULL, below all the children
- * of @self.
- *
- * This function will acquire a reference on @child that will only
- * be released when calling clutter_actor_remove_child().
+ * @child: a #ClutterActor child of @self
+ * @index_: the new index for @child
  *
- * This function will not take into consideration the #ClutterActor:depth
- * of @child.
+ * Changes the index of @child in the list of children of @self.
  *
- * This function will emit the #ClutterContainer::actor-added signal
- * on @self.
+ * This function is logically equivalent to removing @child and
+ * calling clutter_actor_insert_child_at_index(), but it will not
+ * emit signals or change state on @child.
  *
  *
  */
 void
-clutter_actor_insert_child_below (ClutterActor *self,
+clutter_actor_set_child_at_index (ClutterActor *self,
                                   ClutterActor *child,
-                                  ClutterActor *sibling)
+                                  gint          index_)
 {
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
   g_return_if_fail (CLUTTER_IS_ACTOR (child));
-  g_return_if_fail (self != child);
-  g_return_if_fail (child != sibling);
-  g_return_if_fail (child->priv->parent == NULL);
-  g_return_if_fail (sibling == NULL ||
-                    (CLUTTER_IS_ACTOR (sibling) &&
-                     sibling->priv->parent == self));
+  g_return_if_fail (child->priv->parent == self);
+  g_return_if_fail (index_ <= self->priv->n_children);
 
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self) ||
+      CLUTTER_ACTOR_IN_DESTRUCTION (child))
+    return;
+
+  g_object_ref (child);
+  clutter_actor_remove_child_internal (self, child, 0);
   clutter_actor_add_child_internal (self, child,
-                                    ADD_CHILD_DEFAULT_FLAGS,
-                                    insert_child_below,
-                                    sibling);
+                                    ADD_CHILD_NOTIFY_FIRST_LAST |
+                                    ADD_CHILD_QUEUE_REDRAW,
+                                    insert_child_at_index,
+                                    GINT_TO_POINTER (index_));
+
+  clutter_actor_queue_relayout (self);
 }
 
+/*
+ * Event handling
+ */
+
 /**
- * clutter_actor_get_parent:
- * @self: A #ClutterActor
+ * clutter_actor_event:
+ * @actor: a #ClutterActor
+ * @event: a #ClutterEvent
+ * @capture: %TRUE if event in in capture phase, %FALSE otherwise.
  *
- * Retrieves the parent of @self.
+ * This function is used to emit an event on the main stage.
+ * You should rarely need to use this function, except for
+ * synthetising events.
  *
- * Return Value: (transfer none): The #ClutterActor parent, or %NULL
- *  if no parent is set
+ * Return value: the return value from the signal emission: %TRUE
+ *   if the actor handled the event, or %FALSE if the event was
+ *   not handled
+ *
+ *
+ */
+/* returns the type-specific signal emitted for @event, or -1; if
+ * @class_offset is not %NULL it is set to the offset of the class
+ * handler of the signal
+ */
+static gint
+get_event_signal (const ClutterEvent *event,
+                  gsize              *class_offset)
+{
+  gint signal_num;
+  gsize offset;
+
+  switch (event->type)
+    {
+    case CLUTTER_BUTTON_PRESS:
+      signal_num = BUTTON_PRESS_EVENT;
+      offset = G_STRUCT_OFFSET (ClutterActorClass, button_press_event);
+      break;
+    case CLUTTER_BUTTON_RELEASE:
+      signal_num = BUTTON_RELEASE_EVENT;
+      offset = G_STRUCT_OFFSET (ClutterActorClass, button_release_event);
+      break;
+    case CLUTTER_SCROLL:
+      signal_num = SCROLL_EVENT;
+      offset = G_STRUCT_OFFSET (ClutterActorClass, scroll_event);
+      break;
+    case CLUTTER_KEY_PRESS:
+      signal_num = KEY_PRESS_EVENT;
+      offset = G_STRUCT_OFFSET (ClutterActorClass, key_press_event);
+      break;
+    case CLUTTER_KEY_RELEASE:
+      signal_num = KEY_RELEASE_EVENT;
+      offset = G_STRUCT_OFFSET (ClutterActorClass, key_release_event);
+      break;
+    case CLUTTER_MOTION:
+      signal_num = MOTION_EVENT;
+      offset = G_STRUCT_OFFSET (ClutterActorClass, motion_event);
+      break;
+    case CLUTTER_ENTER:
+      signal_num = ENTER_EVENT;
+      offset = G_STRUCT_OFFSET (ClutterActorClass, enter_event);
+      break;
+    case CLUTTER_LEAVE:
+      signal_num = LEAVE_EVENT;
+      offset = G_STRUCT_OFFSET (ClutterActorClass, leave_event);
+      break;
+    case CLUTTER_TOUCH_BEGIN:
+    case CLUTTER_TOUCH_END:
+    case CLUTTER_TOUCH_UPDATE:
+    case CLUTTER_TOUCH_CANCEL:
+      signal_num = TOUCH_EVENT;
+      offset = G_STRUCT_OFFSET (ClutterActorClass, touch_event);
+      break;
+    case CLUTTER_NOTHING:
+    case CLUTTER_DELETE:
+    case CLUTTER_DESTROY_NOTIFY:
+    case CLUTTER_CLIENT_MESSAGE:
+    default:
+      signal_num = -1;
+      offset = 0;
+      break;
+    }
+
+  if (class_offset != NULL)
+    *class_offset = offset;
+
+  return signal_num;
+}
+
+/* checks whether emitting @event on @self in the given phase could
+ * run any code; actors without class or signal handlers for the event
+ * can be skipped by _clutter_actor_handle_event()
  */
-ClutterActor *
-clutter_actor_get_parent (ClutterActor *self)
+static gboolean
+clutter_actor_has_event_handlers (ClutterActor       *self,
+                                  const ClutterEvent *event,
+                                  gboolean            capture)
 {
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
+  ClutterActorClass *klass = CLUTTER_ACTOR_GET_CLASS (self);
+  gsize class_offset;
+  gint signal_num;
 
-  return self->priv->parent;
+  if (capture)
+    return klass->captured_event != NULL ||
+           g_signal_has_handler_pending (self,
+                                         actor_signals[CAPTURED_EVENT],
+                                         0, FALSE);
+
+  if (klass->event != NULL ||
+      g_signal_has_handler_pending (self, actor_signals[EVENT], 0, FALSE))
+    return TRUE;
+
+  signal_num = get_event_signal (event, &class_offset);
+  if (signal_num == -1)
+    return FALSE;
+
+  return G_STRUCT_MEMBER (gpointer, klass, class_offset) != NULL ||
+         g_signal_has_handler_pending (self, actor_signals[signal_num],
+                                       0, FALSE);
 }
 
-/**
- * clutter_actor_get_paint_visibility:
- * @self: A #ClutterActor
- *
- * Retrieves the 'paint' visibility of an actor recursively checking for non
- * visible parents.
- *
- * This is by definition the same as %CLUTTER_ACTOR_IS_MAPPED.
- *
- * Return Value: %TRUE if the actor is visibile and will be painted.
- *
- *
- */
 gboolean
-clutter_actor_get_paint_visibility (ClutterActor *actor)
+clutter_actor_event (ClutterActor       *actor,
+                     const ClutterEvent *event,
+		     gboolean            capture)
 {
+  gboolean retval = FALSE;
+  gint signal_num = -1;
+
   g_return_val_if_fail (CLUTTER_IS_ACTOR (actor), FALSE);
+  g_return_val_if_fail (event != NULL, FALSE);
 
-  return CLUTTER_ACTOR_IS_MAPPED (actor);
+  g_object_ref (actor);
+
+  if (capture)
+    {
+      g_signal_emit (actor, actor_signals[CAPTURED_EVENT], 0,
+		     event,
+                     &retval);
+      goto out;
+    }
+
+  g_signal_emit (actor, actor_signals[EVENT], 0, event, &retval);
+
+  if (!retval)
+    {
+      signal_num = get_event_signal (event, NULL);
+
+      if (signal_num != -1)
+	g_signal_emit (actor, actor_signals[signal_num], 0,
+		       event, &retval);
+    }
+
+out:
+  g_object_unref (actor);
+
+  return retval;
 }
 
 /**
- * clutter_actor_remove_child:
- * @self: a #ClutterActor
- * @child: a #ClutterActor
- *
- * Removes @child from the children of @self.
- *
- * This function will release the reference added by
- * clutter_actor_add_child(), so if you want to keep using @child
- * you will have to acquire a referenced on it before calling this
- * function.
+ * clutter_actor_set_reactive:
+ * @actor: a #ClutterActor
+ * @reactive: whether the actor should be reactive to events
  *
- * This function will emit the #ClutterContainer::actor-removed
- * signal on @self.
+ * Sets @actor as reactive. Reactive actors will receive events.
  *
  *
  */
 void
-clutter_actor_remove_child (ClutterActor *self,
-                            ClutterActor *child)
+clutter_actor_set_reactive (ClutterActor *actor,
+                            gboolean      reactive)
 {
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-  g_return_if_fail (CLUTTER_IS_ACTOR (child));
-  g_return_if_fail (self != child);
-  g_return_if_fail (child->priv->parent != NULL);
-  g_return_if_fail (child->priv->parent == self);
+  g_return_if_fail (CLUTTER_IS_ACTOR (actor));
 
-  clutter_actor_remove_child_internal (self, child,
-                                       REMOVE_CHILD_DEFAULT_FLAGS);
+  if (reactive == CLUTTER_ACTOR_IS_REACTIVE (actor))
+    return;
+
+  if (reactive)
+    CLUTTER_ACTOR_SET_FLAGS (actor, CLUTTER_ACTOR_REACTIVE);
+  else
+    CLUTTER_ACTOR_UNSET_FLAGS (actor, CLUTTER_ACTOR_REACTIVE);
+
+  /* the actor is inserted in the pick index when it is painted; the
+   * stage falls back to painting the scene for the reactive picks
+   * until the next full redraw
+   */
+  if (CLUTTER_ACTOR_IS_MAPPED (actor))
+    {
+      ClutterActor *stage = _clutter_actor_get_stage_internal (actor);
+
+      if (stage != NULL)
+        {
+          _clutter_stage_invalidate_pick_index (CLUTTER_STAGE (stage));
+          _clutter_stage_invalidate_pick (CLUTTER_STAGE (stage), TRUE);
+        }
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (actor), obj_props[PROP_REACTIVE]);
 }
 
 /**
- * clutter_actor_remove_all_children:
- * @self: a #ClutterActor
- *
- * Removes all children of @self.
+ * clutter_actor_get_reactive:
+ * @actor: a #ClutterActor
  *
- * This function releases the reference added by inserting a child actor
- * in the list of children of @self.
+ * Checks whether @actor is marked as reactive.
  *
- * If the reference count of a child drops to zero, the child will be
- * destroyed. If you want to ensure the destruction of all the children
- * of @self, use clutter_actor_destroy_all_children().
+ * Return value: %TRUE if the actor is reactive
  *
  *
  */
-void
-clutter_actor_remove_all_children (ClutterActor *self)
+gboolean
+clutter_actor_get_reactive (ClutterActor *actor)
 {
-  ClutterActorIter iter;
-
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (actor), FALSE);
 
-  if (self->priv->n_children == 0)
-    return;
+  return CLUTTER_ACTOR_IS_REACTIVE (actor) ? TRUE : FALSE;
+}
 
-  g_object_freeze_notify (G_OBJECT (self));
+static void
+clutter_actor_store_content_box (ClutterActor *self,
+                                 const ClutterActorBox *box)
+{
+  if (box != NULL)
+    {
+      self->priv->content_box = *box;
+      self->priv->content_box_valid = TRUE;
+    }
+  else
+    self->priv->content_box_valid = FALSE;
 
-  clutter_actor_iter_init (&iter, self);
-  while (clutter_actor_iter_next (&iter, NULL))
-    clutter_actor_iter_remove (&iter);
+  clutter_actor_queue_redraw (self);
 
-  g_object_thaw_notify (G_OBJECT (self));
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_CONTENT_BOX]);
+}
 
-  /* sanity check */
-  g_assert (self->priv->first_child == NULL);
-  g_assert (self->priv->last_child == NULL);
-  g_assert (self->priv->n_children == 0);
+static void
+clutter_container_iface_init (ClutterContainerIface *iface)
+{
+  /* we don't override anything, as ClutterContainer already has a default
+   * implementation that we can use, and which calls into our own API.
+   */
 }
 
-/**
- * clutter_actor_destroy_all_children:
- * @self: a #ClutterActor
- *
- * Destroys all children of @self.
- *
- * This function releases the reference added by inserting a child
- * actor in the list of children of @self, and ensures that the
- * #ClutterActor::destroy signal is emitted on each child of the
- * actor.
- *
- * By default, #ClutterActor will emit the #ClutterActor::destroy signal
- * when its reference count drops to 0; the default handler of the
- * #ClutterActor::destroy signal will destroy all the children of an
- * actor. This function ensures that all children are destroyed, instead
- * of just removed from @self, unlike clutter_actor_remove_all_children()
- * which will merely release the reference and remove each child.
- *
- * Unless you acquired an additional reference on each child of @self
- * prior to calling clutter_actor_remove_all_children() and want to reuse
- * the actors, you should use clutter_actor_destroy_all_children() in
- * order to make sure that children are destroyed and signal handlers
- * are disconnected even in cases where circular references prevent this
- * from automatically happening through reference counting alone.
- *
- *
- */
-void
-clutter_actor_destroy_all_children (ClutterActor *self)
+typedef enum
 {
-  ClutterActorIter iter;
+  PARSE_X,
+  PARSE_Y,
+  PARSE_WIDTH,
+  PARSE_HEIGHT,
+  PARSE_ANCHOR_X,
+  PARSE_ANCHOR_Y
+} ParseDimension;
 
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+static gfloat
+parse_units (ClutterActor   *self,
+             ParseDimension  dimension,
+             JsonNode       *node)
+{
+  GValue value = G_VALUE_INIT;
+  gfloat retval = 0;
 
-  if (self->priv->n_children == 0)
-    return;
+  if (JSON_NODE_TYPE (node) != JSON_NODE_VALUE)
+    return 0;
 
-  g_object_freeze_notify (G_OBJECT (self));
+  json_node_get_value (node, &value);
 
-  clutter_actor_iter_init (&iter, self);
-  while (clutter_actor_iter_next (&iter, NULL))
-    clutter_actor_iter_destroy (&iter);
+  if (G_VALUE_HOLDS (&value, G_TYPE_INT64))
+    {
+      retval = (gfloat) g_value_get_int64 (&value);
+    }
+  else if (G_VALUE_HOLDS (&value, G_TYPE_DOUBLE))
+    {
+      retval = g_value_get_double (&value);
+    }
+  else if (G_VALUE_HOLDS (&value, G_TYPE_STRING))
+    {
+      ClutterUnits units;
+      gboolean res;
+
+      res = clutter_units_from_string (&units, g_value_get_string (&value));
+      if (res)
+        retval = clutter_units_to_pixels (&units);
+      else
+        {
+          g_warning ("Invalid value '%s': integers, strings or floating point "
+                     "values can be used for the x, y, width and height "
+                     "properties. Valid modifiers for strings are 'px', 'mm', "
+                     "'pt' and 'em'.",
+                     g_value_get_string (&value));
+          retval = 0;
+        }
+    }
+  else
+    {
+      g_warning ("Invalid value of type '%s': integers, strings of floating "
+                 "point values can be used for the position and sizing "
+                 "properties.",
+                 g_type_name (G_VALUE_TYPE (&value)));
+    }
+
+  g_value_unset (&value);
+
+  return retval;
+}
 
-  g_object_thaw_notify (G_OBJECT (self));
+typedef struct {
+  ClutterRotateAxis axis;
 
-  /* sanity check */
-  g_assert (self->priv->first_child == NULL);
-  g_assert (self->priv->last_child == NULL);
-  g_assert (self->priv->n_children == 0);
-}
+  gdouble angle;
 
-typedef struct _InsertBetweenData {
-  ClutterActor *prev_sibling;
-  ClutterActor *next_sibling;
-} InsertBetweenData;
+  gfloat center_x;
+  gfloat center_y;
+  gfloat center_z;
+} RotationInfo;
 
-static void
-insert_child_between (ClutterActor *self,
-                      ClutterActor *child,
-                      gpointer      data_)
+static inline gboolean
+parse_rotation_array (ClutterActor *actor,
+                      JsonArray    *array,
+                      RotationInfo *info)
 {
-  InsertBetweenData *data = data_;
-  ClutterActor *prev_sibling = data->prev_sibling;
-  ClutterActor *next_sibling = data->next_sibling;
+  JsonNode *element;
 
-  child->priv->parent = self;
-  child->priv->prev_sibling = prev_sibling;
-  child->priv->next_sibling = next_sibling;
+  if (json_array_get_length (array) != 2)
+    return FALSE;
 
-  if (prev_sibling != NULL)
-    prev_sibling->priv->next_sibling = child;
+  /* angle */
+  element = json_array_get_element (array, 0);
+  if (JSON_NODE_TYPE (element) == JSON_NODE_VALUE)
+    info->angle = json_node_get_double (element);
+  else
+    return FALSE;
 
-  if (next_sibling != NULL)
-    next_sibling->priv->prev_sibling = child;
+  /* center */
+  element = json_array_get_element (array, 1);
+  if (JSON_NODE_TYPE (element) == JSON_NODE_ARRAY)
+    {
+      JsonArray *center = json_node_get_array (element);
 
-  if (child->priv->prev_sibling == NULL)
-    self->priv->first_child = child;
+      if (json_array_get_length (center) != 2)
+        return FALSE;
 
-  if (child->priv->next_sibling == NULL)
-    self->priv->last_child = child;
+      switch (info->axis)
+        {
+        case CLUTTER_X_AXIS:
+          info->center_y = parse_units (actor, PARSE_Y,
+                                        json_array_get_element (center, 0));
+          info->center_z = parse_units (actor, PARSE_Y,
+                                        json_array_get_element (center, 1));
+          return TRUE;
+
+        case CLUTTER_Y_AXIS:
+          info->center_x = parse_units (actor, PARSE_X,
+                                        json_array_get_element (center, 0));
+          info->center_z = parse_units (actor, PARSE_X,
+                                        json_array_get_element (center, 1));
+          return TRUE;
+
+        case CLUTTER_Z_AXIS:
+          info->center_x = parse_units (actor, PARSE_X,
+                                        json_array_get_element (center, 0));
+          info->center_y = parse_units (actor, PARSE_Y,
+                                        json_array_get_element (center, 1));
+          return TRUE;
+        }
+    }
+
+  return FALSE;
 }
 
-/**
- * clutter_actor_replace_child:
- * @self: a #ClutterActor
- * @old_child: the child of @self to replace
- * @new_child: the #ClutterActor to replace @old_child
- *
- * Replaces @old_child with @new_child in the list of children of @self.
- *
- *
- */
-void
-clutter_actor_replace_child (ClutterActor *self,
-                             ClutterActor *old_child,
-                             ClutterActor *new_child)
+static gboolean
+parse_rotation (ClutterActor *actor,
+                JsonNode     *node,
+                RotationInfo *info)
 {
-  ClutterActor *prev_sibling, *next_sibling;
-  InsertBetweenData clos;
+  JsonArray *array;
+  guint len, i;
+  gboolean retval = FALSE;
 
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-  g_return_if_fail (CLUTTER_IS_ACTOR (old_child));
-  g_return_if_fail (old_child->priv->parent == self);
-  g_return_if_fail (CLUTTER_IS_ACTOR (new_child));
-  g_return_if_fail (old_child != new_child);
-  g_return_if_fail (new_child != self);
-  g_return_if_fail (new_child->priv->parent == NULL);
+  if (JSON_NODE_TYPE (node) != JSON_NODE_ARRAY)
+    {
+      g_warning ("Invalid node of type '%s' found, expecting an array",
+                 json_node_type_name (node));
+      return FALSE;
+    }
 
-  prev_sibling = old_child->priv->prev_sibling;
-  next_sibling = old_child->priv->next_sibling;
-  clutter_actor_remove_child_internal (self, old_child,
-                                       REMOVE_CHILD_DEFAULT_FLAGS);
+  array = json_node_get_array (node);
+  len = json_array_get_length (array);
 
-  clos.prev_sibling = prev_sibling;
-  clos.next_sibling = next_sibling;
-  clutter_actor_add_child_internal (self, new_child,
-                                    ADD_CHILD_DEFAULT_FLAGS,
-                                    insert_child_between,
-                                    &clos);
-}
+  for (i = 0; i < len; i++)
+    {
+      JsonNode *element = json_array_get_element (array, i);
+      JsonObject *object;
+      JsonNode *member;
 
-/**
- * clutter_actor_contains:
- * @self: A #ClutterActor
- * @descendant: A #ClutterActor, possibly contained in @self
- *
- * Determines if @descendant is contained inside @self (either as an
- * immediate child, or as a deeper descendant). If @self and
- * @descendant point to the same actor then it will also return %TRUE.
- *
- * Return value: whether @descendent is contained within @self
- *
- *
- */
-gboolean
-clutter_actor_contains (ClutterActor *self,
-			ClutterActor *descendant)
-{
-  ClutterActor *actor;
+      if (JSON_NODE_TYPE (element) != JSON_NODE_OBJECT)
+        {
+          g_warning ("Invalid node of type '%s' found, expecting an object",
+                     json_node_type_name (element));
+          return FALSE;
+        }
 
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (descendant), FALSE);
+      object = json_node_get_object (element);
 
-  for (actor = descendant; actor; actor = actor->priv->parent)
-    if (actor == self)
-      return TRUE;
+      if (json_object_has_member (object, "x-axis"))
+        {
+          member = json_object_get_member (object, "x-axis");
 
-  return FALSE;
-}
+          info->axis = CLUTTER_X_AXIS;
 
-/**
- * clutter_actor_set_child_above_sibling:
- * @self: a #ClutterActor
- * @child: a #ClutterActor child of @self
- * @sibling: (allow-none): a #ClutterActor child of @self, or %NULL
- *
- * Sets @child to be above @sibling in the list of children of @self.
- *
- * If @sibling is %NULL, @child will be the new last child of @self.
- *
- * This function is logically equivalent to removing @child and using
- * clutter_actor_insert_child_above(), but it will not emit signals
- * or change state on @child.
- *
- *
- */
-void
-clutter_actor_set_child_above_sibling (ClutterActor *self,
-                                       ClutterActor *child,
-                                       ClutterActor *sibling)
-{
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-  g_return_if_fail (CLUTTER_IS_ACTOR (child));
-  g_return_if_fail (child->priv->parent == self);
-  g_return_if_fail (child != sibling);
-  g_return_if_fail (sibling == NULL || CLUTTER_IS_ACTOR (sibling));
+          if (JSON_NODE_TYPE (member) == JSON_NODE_VALUE)
+            {
+              info->angle = json_node_get_double (member);
+              retval = TRUE;
+            }
+          else if (JSON_NODE_TYPE (member) == JSON_NODE_ARRAY)
+            retval = parse_rotation_array (actor,
+                                           json_node_get_array (member),
+                                           info);
+          else
+            retval = FALSE;
+        }
+      else if (json_object_has_member (object, "y-axis"))
+        {
+          member = json_object_get_member (object, "y-axis");
 
-  if (sibling != NULL)
-    g_return_if_fail (sibling->priv->parent == self);
+          info->axis = CLUTTER_Y_AXIS;
 
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (self) ||
-      CLUTTER_ACTOR_IN_DESTRUCTION (child) ||
-      (sibling != NULL && CLUTTER_ACTOR_IN_DESTRUCTION (sibling)))
-    return;
+          if (JSON_NODE_TYPE (member) == JSON_NODE_VALUE)
+            {
+              info->angle = json_node_get_double (member);
+              retval = TRUE;
+            }
+          else if (JSON_NODE_TYPE (member) == JSON_NODE_ARRAY)
+            retval = parse_rotation_array (actor,
+                                           json_node_get_array (member),
+                                           info);
+          else
+            retval = FALSE;
+        }
+      else if (json_object_has_member (object, "z-axis"))
+        {
+          member = json_object_get_member (object, "z-axis");
 
-  /* we don't want to change the state of child, or emit signals, or
-   * regenerate ChildMeta instances here, but we still want to follow
-   * the correct sequence of steps encoded in remove_child() and
-   * add_child(), so that correctness is ensured, and we only go
-   * through one known code path.
-   */
-  g_object_ref (child);
-  clutter_actor_remove_child_internal (self, child, 0);
-  clutter_actor_add_child_internal (self, child,
-                                    ADD_CHILD_NOTIFY_FIRST_LAST,
-                                    insert_child_above,
-                                    sibling);
+          info->axis = CLUTTER_Z_AXIS;
+
+          if (JSON_NODE_TYPE (member) == JSON_NODE_VALUE)
+            {
+              info->angle = json_node_get_double (member);
+              retval = TRUE;
+            }
+          else if (JSON_NODE_TYPE (member) == JSON_NODE_ARRAY)
+            retval = parse_rotation_array (actor,
+                                           json_node_get_array (member),
+                                           info);
+          else
+            retval = FALSE;
+        }
+    }
 
-  clutter_actor_queue_relayout (self);
+  return retval;
 }
 
-/**
- * clutter_actor_set_child_below_sibling:
- * @self: a #ClutterActor
- * @child: a #ClutterActor child of @self
- * @sibling: (allow-none): a #ClutterActor child of @self, or %NULL
- *
- * Sets @child to be below @sibling in the list of children of @self.
- *
- * If @sibling is %NULL, @child will be the new first child of @self.
- *
- * This function is logically equivalent to removing @self and using
- * clutter_actor_insert_child_below(), but it will not emit signals
- * or change state on @child.
- *
- *
- */
-void
-clutter_actor_set_child_below_sibling (ClutterActor *self,
-                                       ClutterActor *child,
-                                       ClutterActor *sibling)
+static GSList *
+parse_actor_metas (ClutterScript *script,
+                   ClutterActor  *actor,
+                   JsonNode      *node)
 {
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-  g_return_if_fail (CLUTTER_IS_ACTOR (child));
-  g_return_if_fail (child->priv->parent == self);
-  g_return_if_fail (child != sibling);
-  g_return_if_fail (sibling == NULL || CLUTTER_IS_ACTOR (sibling));
+  GList *elements, *l;
+  GSList *retval = NULL;
 
-  if (sibling != NULL)
-    g_return_if_fail (sibling->priv->parent == self);
+  if (!JSON_NODE_HOLDS_ARRAY (node))
+    return NULL;
 
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (self) ||
-      CLUTTER_ACTOR_IN_DESTRUCTION (child) ||
-      (sibling != NULL && CLUTTER_ACTOR_IN_DESTRUCTION (sibling)))
-    return;
+  elements = json_array_get_elements (json_node_get_array (node));
 
-  /* see the comment in set_child_above_sibling() */
-  g_object_ref (child);
-  clutter_actor_remove_child_internal (self, child, 0);
-  clutter_actor_add_child_internal (self, child,
-                                    ADD_CHILD_NOTIFY_FIRST_LAST,
-                                    insert_child_below,
-                                    sibling);
+  for (l = elements; l != NULL; l = l->next)
+    {
+      JsonNode *element = l->data;
+      const gchar *id_ = _clutter_script_get_id_from_node (element);
+      GObject *meta;
 
-  clutter_actor_queue_relayout (self);
-}
+      if (id_ == NULL || *id_ == '\0')
+        continue;
 
-/**
- * clutter_actor_set_child_at_index:
- * @self: a #ClutterActor
- * @child: a #ClutterActor child of @self
- * @index_: the new index for @child
- *
- * Changes the index of @child in the list of children of @self.
- *
- * This function is logically equivalent to removing @child and
- * calling clutter_actor_insert_child_at_index(), but it will not
- * emit signals or change state on @child.
- *
- *
- */
-void
-clutter_actor_set_child_at_index (ClutterActor *self,
-                                  ClutterActor *child,
-                                  gint          index_)
-{
-  g_return_if_fail (CLUTTER_IS_ACTOR (self));
-  g_return_if_fail (CLUTTER_IS_ACTOR (child));
-  g_return_if_fail (child->priv->parent == self);
-  g_return_if_fail (index_ <= self->priv->n_children);
+      meta = clutter_script_get_object (script, id_);
+      if (meta == NULL)
+        continue;
 
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (self) ||
-      CLUTTER_ACTOR_IN_DESTRUCTION (child))
-    return;
+      retval = g_slist_prepend (retval, meta);
+    }
 
-  g_object_ref (child);
-  clutter_actor_remove_child_internal (self, child, 0);
-  clutter_actor_add_child_internal (self, child,
-                                    ADD_CHILD_NOTIFY_FIRST_LAST,
-                                    insert_child_at_index,
-                                    GINT_TO_POINTER (index_));
+  g_list_free (elements);
 
-  clutter_actor_queue_relayout (self);
+  return g_slist_reverse (retval);
 }
 
-/*
- * Event handling
- */
-
-/**
- * clutter_actor_event:
- * @actor: a #ClutterActor
- * @event: a #ClutterEvent
- * @capture: %TRUE if event in in capture phase, %FALSE otherwise.
- *
- * This function is used to emit an event on the main stage.
- * You should rarely need to use this function, except for
- * synthetising events.
- *
- * Return value: the return value from the signal emission: %TRUE
- *   if the actor handled the event, or %FALSE if the event was
- *   not handled
- *
- *
- */
-gboolean
-clutter_actor_event (ClutterActor       *actor,
-                     const ClutterEvent *event,
-		     gboolean            capture)
+static ClutterMargin *
+parse_margin (ClutterActor *self,
+              JsonNode     *node)
 {
-  gboolean retval = FALSE;
-  gint signal_num = -1;
-
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (actor), FALSE);
-  g_return_val_if_fail (event != NULL, FALSE);
-
-  g_object_ref (actor);
+  ClutterMargin *margin;
+  JsonArray *array;
 
-  if (capture)
+  if (!JSON_NODE_HOLDS_ARRAY (node))
     {
-      g_signal_emit (actor, actor_signals[CAPTURED_EVENT], 0,
-		     event,
-                     &retval);
-      goto out;
+      g_warning ("The margin property must be an array of 1 to 4 elements");
+      return NULL;
     }
 
-  g_signal_emit (actor, actor_signals[EVENT], 0, event, &retval);
-
-  if (!retval)
+  margin = clutter_margin_new ();
+  array = json_node_get_array (node);
+  switch (json_array_get_length (array))
     {
-      switch (event->type)
-	{
-	case CLUTTER_NOTHING:
-	  break;
-	case CLUTTER_BUTTON_PRESS:
-	  signal_num = BUTTON_PRESS_EVENT;
-	  break;
-	case CLUTTER_BUTTON_RELEASE:
-	  signal_num = BUTTON_RELEASE_EVENT;
-	  break;
-	case CLUTTER_SCROLL:
-	  signal_num = SCROLL_EVENT;
-	  break;
-	case CLUTTER_KEY_PRESS:
-	  signal_num = KEY_PRESS_EVENT;
-	  break;
-	case CLUTTER_KEY_RELEASE:
-	  signal_num = KEY_RELEASE_EVENT;
-	  break;
-	case CLUTTER_MOTION:
-	  signal_num = MOTION_EVENT;
-	  break;
-	case CLUTTER_ENTER:
-	  signal_num = ENTER_EVENT;
-	  break;
-	case CLUTTER_LEAVE:
-	  signal_num = LEAVE_EVENT;
-	  break;
-        case CLUTTER_TOUCH_BEGIN:
-        case CLUTTER_TOUCH_END:
-        case CLUTTER_TOUCH_UPDATE:
-        case CLUTTER_TOUCH_CANCEL:
-          signal_num = TOUCH_EVENT;
-          break;
-	case CLUTTER_DELETE:
-	case CLUTTER_DESTROY_NOTIFY:
-	case CLUTTER_CLIENT_MESSAGE:
-	default:
-	  signal_num = -1;
-	  break;
-	}
+    case 1:
+      margin->top = margin->right = margin->bottom = margin->left =
+        parse_units (self, 0, json_array_get_element (array, 0));
+      break;
 
-      if (signal_num != -1)
-	g_signal_emit (actor, actor_signals[signal_num], 0,
-		       event, &retval);
-    }
+    case 2:
+      margin->top = margin->bottom =
+        parse_units (self, 0, json_array_get_element (array, 0));
+      margin->right = margin->left =
+        parse_units (self, 0, json_array_get_element (array, 1));
+      break;
 
-out:
-  g_object_unref (actor);
+    case 3:
+      margin->top =
+        parse_units (self, 0, json_array_get_element (array, 0));
+      margin->right = margin->left =
+        parse_units (self, 0, json_array_get_element (array, 1));
+      margin->bottom =
+        parse_units (self, 0, json_array_get_element (array, 2));
+      break;
 
-  return retval;
+    case 4:
+      margin->top =
+        parse_units (self, 0, json_array_get_element (array, 0));
+      margin->right =
+        parse_units (self, 0, json_array_get_element (array, 1));
+      margin->bottom =
+        parse_units (self, 0, json_array_get_element (array, 2));
+      margin->left =
+        parse_units (self, 0, json_array_get_element (array, 3));
+      break;
+
+    default:
+      g_warning ("The margin property must be an array of 1 to 4 elements");
+      clutter_margin_free (margin);
+      return NULL;
+    }
+  return margin;
 }
 
-/**
- * clutter_actor_set_reactive:
- * @actor: a #ClutterActor
- * @reactive: whether the actor should be reactive to events
- *
- * Sets @actor as reactive. Reactive actors will receive events.
- *
- *
- */
-void
-clutter_actor_set_reactive (ClutterActor *actor,
-                            gboolean      reactive)
+static gboolean
+clutter_actor_parse_custom_node (ClutterScriptable *scriptable,
+                                 ClutterScript     *script,
+                                 GValue            *value,
+                                 const gchar       *name,
+                                 JsonNode          *node)
 {
-  g_return_if_fail (CLUTTER_IS_ACTOR (actor));
+  ClutterActor *actor = CLUTTER_ACTOR (scriptable);
+  gboolean retval = FALSE;
+
+  if ((name[0] == 'x' && name[1] == '\0') ||
+      (name[0] == 'y' && name[1] == '\0') ||
+      (strcmp (name, "width") == 0) ||
+      (strcmp (name, "height") == 0))
+    {
+      ParseDimension dimension;
+      gfloat units;
+
+      if (name[0] == 'x')
+        dimension = PARSE_X;
+      else if (name[0] == 'y')
+        dimension = PARSE_Y;
+      else if (name[0] == 'w')
+        dimension = PARSE_WIDTH;
+      else if (name[0] == 'h')
+        dimension = PARSE_HEIGHT;
+      else
+        return FALSE;
+
+      units = parse_units (actor, dimension, node);
+
+      /* convert back to pixels: all properties are pixel-based */
+      g_value_init (value, G_TYPE_FLOAT);
+      g_value_set_float (value, units);
+
+      retval = TRUE;
+    }
+  else if (strcmp (name, "rotation") == 0)
+    {
+      RotationInfo *info;
+
+      info = g_slice_new0 (RotationInfo);
+      retval = parse_rotation (actor, node, info);
+
+      if (retval)
+        {
+          g_value_init (value, G_TYPE_POINTER);
+          g_value_set_pointer (value, info);
+        }
+      else
+        g_slice_free (RotationInfo, info);
+    }
+  else if (strcmp (name, "actions") == 0 ||
+           strcmp (name, "constraints") == 0 ||
+           strcmp (name, "effects") == 0)
+    {
+      GSList *l;
 
-  if (reactive == CLUTTER_ACTOR_IS_REACTIVE (actor))
-    return;
+      l = parse_actor_metas (script, actor, node);
 
-  if (reactive)
-    CLUTTER_ACTOR_SET_FLAGS (actor, CLUTTER_ACTOR_REACTIVE);
-  else
-    CLUTTER_ACTOR_UNSET_FLAGS (actor, CLUTTER_ACTOR_REACTIVE);
+      g_value_init (value, G_TYPE_POINTER);
+      g_value_set_pointer (value, l);
 
-  g_object_notify_by_pspec (G_OBJECT (actor), obj_props[PROP_REACTIVE]);
-}
+      retval = TRUE;
+    }
+  else if (strcmp (name, "margin") == 0)
+    {
+      ClutterMargin *margin = parse_margin (actor, node);
 
-/**
- * clutter_actor_get_reactive:
- * @actor: a #ClutterActor
- *
- * Checks whether @actor is marked as reactive.
- *
- * Return value: %TRUE if the actor is reactive
- *
- *
- */
-gboolean
-clutter_actor_get_reactive (ClutterActor *actor)
-{
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (actor), FALSE);
+      if (margin)
+        {
+          g_value_init (value, CLUTTER_TYPE_MARGIN);
+          g_value_set_boxed (value, margin);
+          retval = TRUE;
+        }
+    }
 
-  return CLUTTER_ACTOR_IS_REACTIVE (actor) ? TRUE : FALSE;
+  return retval;
 }
 
 static void
-clutter_actor_store_content_box (ClutterActor *self,
-                                 const ClutterActorBox *box)
+clutter_actor_set_custom_property (ClutterScriptable *scriptable,
+                                   ClutterScript     *script,
+                                   const gchar       *name,
+                                   const GValue      *value)
 {
-  if (box != NULL)
+  ClutterActor *actor = CLUTTER_ACTOR (scriptable);
+
+#ifdef CLUTTER_ENABLE_DEBUG
+  if (G_UNLIKELY (CLUTTER_HAS_DEBUG (SCRIPT)))
     {
-      self->priv->content_box = *box;
-      self->priv->content_box_valid = TRUE;
-    }
-  else
-    self->priv->content_box_valid = FALSE;
+      gchar *tmp = g_strdup_value_contents (value);
 
-  clutter_actor_queue_redraw (self);
+      CLUTTER_NOTE (SCRIPT,
+                    "in ClutterActor::set_custom_property('%s') = %s",
+                    name,
+                    tmp);
 
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_CONTENT_BOX]);
-}
+      g_free (tmp);
+    }
+#endif /* CLUTTER_ENABLE_DEBUG */
 
-static void
-clutter_container_iface_init (ClutterContainerIface *iface)
-{
-  /* we don't override anything, as ClutterContainer already has a default
-   * implementation that we can use, and which calls into our own API.
-   */
-}
+  if (strcmp (name, "rotation") == 0)
+    {
+      RotationInfo *info;
 
-typedef enum
-{
-  PARSE_X,
-  PARSE_Y,
-  PARSE_WIDTH,
-  PARSE_HEIGHT,
-  PARSE_ANCHOR_X,
-  PARSE_ANCHOR_Y
-} ParseDimension;
+      if (!G_VALUE_HOLDS (value, G_TYPE_POINTER))
+        return;
 
-static gfloat
-parse_units (ClutterActor   *self,
-             ParseDimension  dimension,
-             JsonNode       *node)
-{
-  GValue value = G_VALUE_INIT;
-  gfloat retval = 0;
+      info = g_value_get_pointer (value);
 
-  if (JSON_NODE_TYPE (node) != JSON_NODE_VALUE)
-    return 0;
+      clutter_actor_set_rotation_angle (actor, info->axis, info->angle);
 
-  json_node_get_value (node, &value);
+      g_slice_free (RotationInfo, info);
 
-  if (G_VALUE_HOLDS (&value, G_TYPE_INT64))
-    {
-      retval = (gfloat) g_value_get_int64 (&value);
-    }
-  else if (G_VALUE_HOLDS (&value, G_TYPE_DOUBLE))
-    {
-      retval = g_value_get_double (&value);
+      return;
     }
-  else if (G_VALUE_HOLDS (&value, G_TYPE_STRING))
+
+  if (strcmp (name, "actions") == 0 ||
+      strcmp (name, "constraints") == 0 ||
+      strcmp (name, "effects") == 0)
     {
-      ClutterUnits units;
-      gboolean res;
+      GSList *metas, *l;
 
-      res = clutter_units_from_string (&units, g_value_get_string (&value));
-      if (res)
-        retval = clutter_units_to_pixels (&units);
-      else
+      if (!G_VALUE_HOLDS (value, G_TYPE_POINTER))
+        return;
+
+      metas = g_value_get_pointer (value);
+      for (l = metas; l != NULL; l = l->next)
         {
-          g_warning ("Invalid value '%s': integers, strings or floating point "
-                     "values can be used for the x, y, width and height "
-                     "properties. Valid modifiers for strings are 'px', 'mm', "
-                     "'pt' and 'em'.",
-                     g_value_get_string (&value));
-          retval = 0;
+          if (name[0] == 'a')
+            clutter_actor_add_action (actor, l->data);
+
+          if (name[0] == 'c')
+            clutter_actor_add_constraint (actor, l->data);
+
+          if (name[0] == 'e')
+            clutter_actor_add_effect (actor, l->data);
         }
+
+      g_slist_free (metas);
+
+      return;
     }
-  else
+  if (strcmp (name, "margin") == 0)
     {
-      g_warning ("Invalid value of type '%s': integers, strings of floating "
-                 "point values can be used for the position and sizing "
-                 "properties.",
-                 g_type_name (G_VALUE_TYPE (&value)));
+      clutter_actor_set_margin (actor, g_value_get_boxed (value));
+      return;
     }
 
-  g_value_unset (&value);
-
-  return retval;
+  g_object_set_property (G_OBJECT (scriptable), name, value);
 }
 
-typedef struct {
-  ClutterRotateAxis axis;
-
-  gdouble angle;
-
-  gfloat center_x;
-  gfloat center_y;
-  gfloat center_z;
-} RotationInfo;
+static void
+clutter_scriptable_iface_init (ClutterScriptableIface *iface)
+{
+  iface->parse_custom_node = clutter_actor_parse_custom_node;
+  iface->set_custom_property = clutter_actor_set_custom_property;
+}
 
-static inline gboolean
-parse_rotation_array (ClutterActor *actor,
-                      JsonArray    *array,
-                      RotationInfo *info)
+static ClutterActorMeta *
+get_meta_from_animation_property (ClutterActor  *actor,
+                                  const gchar   *name,
+                                  gchar        **name_p)
 {
-  JsonNode *element;
+  ClutterActorPrivate *priv = actor->priv;
+  ClutterActorMeta *meta = NULL;
+  gchar **tokens;
 
-  if (json_array_get_length (array) != 2)
-    return FALSE;
+  /* if this is not a special property, fall through */
+  if (name[0] != '@')
+    return NULL;
 
-  /* angle */
-  element = json_array_get_element (array, 0);
-  if (JSON_NODE_TYPE (element) == JSON_NODE_VALUE)
-    info->angle = json_node_get_double (element);
-  else
-    return FALSE;
+  /* detect the properties named using the following spec:
+   *
+   *   @<section>.<meta-name>.<property-name>
+   *
+   * where <section> can be one of the following:
+   *
+   *   - actions
+   *   - constraints
+   *   - effects
+   *
+   * and <meta-name> is the name set on a specific ActorMeta
+   */
 
-  /* center */
-  element = json_array_get_element (array, 1);
-  if (JSON_NODE_TYPE (element) == JSON_NODE_ARRAY)
+  tokens = g_strsplit (name + 1, ".", -1);
+  if (tokens == NULL || g_strv_length (tokens) != 3)
     {
-      JsonArray *center = json_node_get_array (element);
+      CLUTTER_NOTE (ANIMATION, "Invalid property name '%s'",
+                    name + 1);
+      g_strfreev (tokens);
+      return NULL;
+    }
 
-      if (json_array_get_length (center) != 2)
-        return FALSE;
+  if (strcmp (tokens[0], "actions") == 0)
+    meta = _clutter_meta_group_get_meta (priv->actions, tokens[1]);
 
-      switch (info->axis)
-        {
-        case CLUTTER_X_AXIS:
-          info->center_y = parse_units (actor, PARSE_Y,
-                                        json_array_get_element (center, 0));
-          info->center_z = parse_units (actor, PARSE_Y,
-                                        json_array_get_element (center, 1));
-          return TRUE;
+  if (strcmp (tokens[0], "constraints") == 0)
+    meta = _clutter_meta_group_get_meta (priv->constraints, tokens[1]);
 
-        case CLUTTER_Y_AXIS:
-          info->center_x = parse_units (actor, PARSE_X,
-                                        json_array_get_element (center, 0));
-          info->center_z = parse_units (actor, PARSE_X,
-                                        json_array_get_element (center, 1));
-          return TRUE;
+  if (strcmp (tokens[0], "effects") == 0)
+    meta = _clutter_meta_group_get_meta (priv->effects, tokens[1]);
 
-        case CLUTTER_Z_AXIS:
-          info->center_x = parse_units (actor, PARSE_X,
-                                        json_array_get_element (center, 0));
-          info->center_y = parse_units (actor, PARSE_Y,
-                                        json_array_get_element (center, 1));
-          return TRUE;
-        }
-    }
+  if (name_p != NULL)
+    *name_p = g_strdup (tokens[2]);
 
-  return FALSE;
+  CLUTTER_NOTE (ANIMATION,
+                "Looking for property '%s' of object '%s' in section '%s'",
+                tokens[2],
+                tokens[1],
+                tokens[0]);
+
+  g_strfreev (tokens);
+
+  return meta;
 }
 
-static gboolean
-parse_rotation (ClutterActor *actor,
-                JsonNode     *node,
-                RotationInfo *info)
+static GParamSpec *
+clutter_actor_find_property (ClutterAnimatable *animatable,
+                             const gchar       *property_name)
 {
-  JsonArray *array;
-  guint len, i;
-  gboolean retval = FALSE;
+  ClutterActorMeta *meta = NULL;
+  GObjectClass *klass = NULL;
+  GParamSpec *pspec = NULL;
+  gchar *p_name = NULL;
 
-  if (JSON_NODE_TYPE (node) != JSON_NODE_ARRAY)
+  meta = get_meta_from_animation_property (CLUTTER_ACTOR (animatable),
+                                           property_name,
+                                           &p_name);
+
+  if (meta != NULL)
     {
-      g_warning ("Invalid node of type '%s' found, expecting an array",
-                 json_node_type_name (node));
-      return FALSE;
+      klass = G_OBJECT_GET_CLASS (meta);
+
+      pspec = g_object_class_find_property (klass, p_name);
     }
+  else
+    {
+      klass = G_OBJECT_GET_CLASS (animatable);
 
-  array = json_node_get_array (node);
-  len = json_array_get_length (array);
+      pspec = g_object_class_find_property (klass, property_name);
+    }
 
-  for (i = 0; i < len; i++)
-    {
-      JsonNode *element = json_array_get_element (array, i);
-      JsonObject *object;
-      JsonNode *member;
+  g_free (p_name);
 
-      if (JSON_NODE_TYPE (element) != JSON_NODE_OBJECT)
-        {
-          g_warning ("Invalid node of type '%s' found, expecting an object",
-                     json_node_type_name (element));
-          return FALSE;
-        }
+  return pspec;
+}
 
-      object = json_node_get_object (element);
+static void
+clutter_actor_get_initial_state (ClutterAnimatable *animatable,
+                                 const gchar       *property_name,
+                                 GValue            *initial)
+{
+  ClutterActorMeta *meta = NULL;
+  gchar *p_name = NULL;
 
-      if (json_object_has_member (object, "x-axis"))
-        {
-          member = json_object_get_member (object, "x-axis");
+  meta = get_meta_from_animation_property (CLUTTER_ACTOR (animatable),
+                                           property_name,
+                                           &p_name);
 
-          info->axis = CLUTTER_X_AXIS;
+  if (meta != NULL)
+    g_object_get_property (G_OBJECT (meta), p_name, initial);
+  else
+    g_object_get_property (G_OBJECT (animatable), property_name, initial);
 
-          if (JSON_NODE_TYPE (member) == JSON_NODE_VALUE)
-            {
-              info->angle = json_node_get_double (member);
-              retval = TRUE;
-            }
-          else if (JSON_NODE_TYPE (member) == JSON_NODE_ARRAY)
-            retval = parse_rotation_array (actor,
-                                           json_node_get_array (member),
-                                           info);
-          else
-            retval = FALSE;
-        }
-      else if (json_object_has_member (object, "y-axis"))
-        {
-          member = json_object_get_member (object, "y-axis");
+  g_free (p_name);
+}
 
-          info->axis = CLUTTER_Y_AXIS;
+/*
+ * clutter_actor_set_animatable_property:
+ * @actor: a #ClutterActor
+ * @prop_id: the paramspec id
+ * @value: the value to set
+ * @pspec: the paramspec
+ *
+ * Sets values of animatable properties.
+ *
+ * This is a variant of clutter_actor_set_property() that gets called
+ * by the #ClutterAnimatable implementation of #ClutterActor for the
+ * properties with the %CLUTTER_PARAM_ANIMATABLE flag set on their
+ * #GParamSpec.
+ *
+ * Unlike the implementation of #GObjectClass.set_property(), this
+ * function will not update the interval if a transition involving an
+ * animatable property is in progress - this avoids cycles with the
+ * transition API calling the public API.
+ */
+static void
+clutter_actor_set_animatable_property (ClutterActor *actor,
+                                       guint         prop_id,
+                                       const GValue *value,
+                                       GParamSpec   *pspec)
+{
+  GObject *obj = G_OBJECT (actor);
 
-          if (JSON_NODE_TYPE (member) == JSON_NODE_VALUE)
-            {
-              info->angle = json_node_get_double (member);
-              retval = TRUE;
-            }
-          else if (JSON_NODE_TYPE (member) == JSON_NODE_ARRAY)
-            retval = parse_rotation_array (actor,
-                                           json_node_get_array (member),
-                                           info);
-          else
-            retval = FALSE;
-        }
-      else if (json_object_has_member (object, "z-axis"))
-        {
-          member = json_object_get_member (object, "z-axis");
+  g_object_freeze_notify (obj);
 
-          info->axis = CLUTTER_Z_AXIS;
+  switch (prop_id)
+    {
+    case PROP_X:
+      clutter_actor_set_x_internal (actor, g_value_get_float (value));
+      break;
 
-          if (JSON_NODE_TYPE (member) == JSON_NODE_VALUE)
-            {
-              info->angle = json_node_get_double (member);
-              retval = TRUE;
-            }
-          else if (JSON_NODE_TYPE (member) == JSON_NODE_ARRAY)
-            retval = parse_rotation_array (actor,
-                                           json_node_get_array (member),
-                                           info);
-          else
-            retval = FALSE;
-        }
-    }
+    case PROP_Y:
+      clutter_actor_set_y_internal (actor, g_value_get_float (value));
+      break;
 
-  return retval;
-}
+    case PROP_POSITION:
+      clutter_actor_set_position_internal (actor, g_value_get_boxed (value));
+      break;
 
-static GSList *
-parse_actor_metas (ClutterScript *script,
-                   ClutterActor  *actor,
-                   JsonNode      *node)
-{
-  GList *elements, *l;
-  GSList *retval = NULL;
+    case PROP_WIDTH:
+      clutter_actor_set_width_internal (actor, g_value_get_float (value));
+      break;
 
-  if (!JSON_NODE_HOLDS_ARRAY (node))
-    return NULL;
+    case PROP_HEIGHT:
+      clutter_actor_set_height_internal (actor, g_value_get_float (value));
+      break;
 
-  elements = json_array_get_elements (json_node_get_array (node));
+    case PROP_SIZE:
+      clutter_actor_set_size_internal (actor, g_value_get_boxed (value));
+      break;
 
-  for (l = elements; l != NULL; l = l->next)
-    {
-      JsonNode *element = l->data;
-      const gchar *id_ = _clutter_script_get_id_from_node (element);
-      GObject *meta;
+    case PROP_ALLOCATION:
+      clutter_actor_allocate_internal (actor,
+                                       g_value_get_boxed (value),
+                                       actor->priv->allocation_flags);
+      clutter_actor_queue_redraw (actor);
+      break;
 
-      if (id_ == NULL || *id_ == '\0')
-        continue;
+    case PROP_Z_POSITION:
+      clutter_actor_set_z_position_internal (actor, g_value_get_float (value));
+      break;
 
-      meta = clutter_script_get_object (script, id_);
-      if (meta == NULL)
-        continue;
+    case PROP_OPACITY:
+      clutter_actor_set_opacity_internal (actor, g_value_get_uint (value));
+      break;
 
-      retval = g_slist_prepend (retval, meta);
-    }
+    case PROP_BACKGROUND_COLOR:
+      clutter_actor_set_background_color_internal (actor, clutter_value_get_color (value));
+      break;
 
-  g_list_free (elements);
+    case PROP_PIVOT_POINT:
+      clutter_actor_set_pivot_point_internal (actor, g_value_get_boxed (value));
+      break;
 
-  return g_slist_reverse (retval);
-}
+    case PROP_PIVOT_POINT_Z:
+      clutter_actor_set_pivot_point_z_internal (actor, g_value_get_float (value));
+      break;
 
-static ClutterMargin *
-parse_margin (ClutterActor *self,
-              JsonNode     *node)
-{
-  ClutterMargin *margin;
-  JsonArray *array;
+    case PROP_TRANSLATION_X:
+    case PROP_TRANSLATION_Y:
+    case PROP_TRANSLATION_Z:
+      clutter_actor_set_translation_internal (actor,
+                                              g_value_get_float (value),
+                                              pspec);
+      break;
 
-  if (!JSON_NODE_HOLDS_ARRAY (node))
-    {
-      g_warning ("The margin property must be an array of 1 to 4 elements");
-      return NULL;
-    }
+    case PROP_SCALE_X:
+    case PROP_SCALE_Y:
+    case PROP_SCALE_Z:
+      clutter_actor_set_scale_factor_internal (actor,
+                                               g_value_get_double (value),
+                                               pspec);
+      break;
 
-  margin = clutter_margin_new ();
-  array = json_node_get_array (node);
-  switch (json_array_get_length (array))
-    {
-    case 1:
-      margin->top = margin->right = margin->bottom = margin->left =
-        parse_units (self, 0, json_array_get_element (array, 0));
+    case PROP_ROTATION_ANGLE_X:
+    case PROP_ROTATION_ANGLE_Y:
+    case PROP_ROTATION_ANGLE_Z:
+      clutter_actor_set_rotation_angle_internal (actor,
+                                                 g_value_get_double (value),
+                                                 pspec);
       break;
 
-    case 2:
-      margin->top = margin->bottom =
-        parse_units (self, 0, json_array_get_element (array, 0));
-      margin->right = margin->left =
-        parse_units (self, 0, json_array_get_element (array, 1));
+    case PROP_CONTENT_BOX:
+      clutter_actor_store_content_box (actor, g_value_get_boxed (value));
       break;
 
-    case 3:
-      margin->top =
-        parse_units (self, 0, json_array_get_element (array, 0));
-      margin->right = margin->left =
-        parse_units (self, 0, json_array_get_element (array, 1));
-      margin->bottom =
-        parse_units (self, 0, json_array_get_element (array, 2));
+    case PROP_MARGIN_TOP:
+    case PROP_MARGIN_BOTTOM:
+    case PROP_MARGIN_LEFT:
+    case PROP_MARGIN_RIGHT:
+      clutter_actor_set_margin_internal (actor, g_value_get_float (value),
+                                         pspec);
       break;
 
-    case 4:
-      margin->top =
-        parse_units (self, 0, json_array_get_element (array, 0));
-      margin->right =
-        parse_units (self, 0, json_array_get_element (array, 1));
-      margin->bottom =
-        parse_units (self, 0, json_array_get_element (array, 2));
-      margin->left =
-        parse_units (self, 0, json_array_get_element (array, 3));
+    case PROP_TRANSFORM:
+      clutter_actor_set_transform_internal (actor, g_value_get_boxed (value));
+      break;
+
+    case PROP_CHILD_TRANSFORM:
+      clutter_actor_set_child_transform_internal (actor, g_value_get_boxed (value));
       break;
 
     default:
-      g_warning ("The margin property must be an array of 1 to 4 elements");
-      clutter_margin_free (margin);
-      return NULL;
+      g_object_set_property (obj, pspec->name, value);
+      break;
     }
-  return margin;
+
+  g_object_thaw_notify (obj);
 }
 
-static gboolean
-clutter_actor_parse_custom_node (ClutterScriptable *scriptable,
-                                 ClutterScript     *script,
-                                 GValue            *value,
-                                 const gchar       *name,
-                                 JsonNode          *node)
+static void
+clutter_actor_set_final_state (ClutterAnimatable *animatable,
+                               const gchar       *property_name,
+                               const GValue      *final)
 {
-  ClutterActor *actor = CLUTTER_ACTOR (scriptable);
-  gboolean retval = FALSE;
-
-  if ((name[0] == 'x' && name[1] == '\0') ||
-      (name[0] == 'y' && name[1] == '\0') ||
-      (strcmp (name, "width") == 0) ||
-      (strcmp (name, "height") == 0))
-    {
-      ParseDimension dimension;
-      gfloat units;
-
-      if (name[0] == 'x')
-        dimension = PARSE_X;
-      else if (name[0] == 'y')
-        dimension = PARSE_Y;
-      else if (name[0] == 'w')
-        dimension = PARSE_WIDTH;
-      else if (name[0] == 'h')
-        dimension = PARSE_HEIGHT;
-      else
-        return FALSE;
-
-      units = parse_units (actor, dimension, node);
-
-      /* convert back to pixels: all properties are pixel-based */
-      g_value_init (value, G_TYPE_FLOAT);
-      g_value_set_float (value, units);
+  ClutterActor *actor = CLUTTER_ACTOR (animatable);
+  ClutterActorMeta *meta = NULL;
+  gchar *p_name = NULL;
 
-      retval = TRUE;
-    }
-  else if (strcmp (name, "rotation") == 0)
+  meta = get_meta_from_animation_property (actor,
+                                           property_name,
+                                           &p_name);
+  if (meta != NULL)
+    g_object_set_property (G_OBJECT (meta), p_name, final);
+  else
     {
-      RotationInfo *info;
+      GObjectClass *obj_class = G_OBJECT_GET_CLASS (animatable);
+      GParamSpec *pspec;
 
-      info = g_slice_new0 (RotationInfo);
-      retval = parse_rotation (actor, node, info);
+      pspec = g_object_class_find_property (obj_class, property_name);
 
-      if (retval)
+      if ((pspec->flags & CLUTTER_PARAM_ANIMATABLE) != 0)
         {
-          g_value_init (value, G_TYPE_POINTER);
-          g_value_set_pointer (value, info);
+          /* XXX - I'm going to the special hell for this */
+          clutter_actor_set_animatable_property (actor, pspec->param_id, final, pspec);
         }
       else
-        g_slice_free (RotationInfo, info);
-    }
-  else if (strcmp (name, "actions") == 0 ||
-           strcmp (name, "constraints") == 0 ||
-           strcmp (name, "effects") == 0)
-    {
-      GSList *l;
-
-      l = parse_actor_metas (script, actor, node);
-
-      g_value_init (value, G_TYPE_POINTER);
-      g_value_set_pointer (value, l);
-
-      retval = TRUE;
-    }
-  else if (strcmp (name, "margin") == 0)
-    {
-      ClutterMargin *margin = parse_margin (actor, node);
-
-      if (margin)
-        {
-          g_value_init (value, CLUTTER_TYPE_MARGIN);
-          g_value_set_boxed (value, margin);
-          retval = TRUE;
-        }
+        g_object_set_property (G_OBJECT (animatable), pspec->name, final);
     }
 
-  return retval;
+  g_free (p_name);
 }
 
-static void
-clutter_actor_set_custom_property (ClutterScriptable *scriptable,
-                                   ClutterScript     *script,
-                                   const gchar       *name,
-                                   const GValue      *value)
+/*< private >
+ * _clutter_actor_get_animatable_value_type:
+ * @self: a #ClutterActor
+ * @pspec: a #GParamSpec returned by clutter_animatable_find_property()
+ *
+ * Checks whether the animatable property described by @pspec can be
+ * set through one of the typed setters below, bypassing the lookup by
+ * name and the #GValue boxing of clutter_actor_set_final_state().
+ *
+ * Return value: the type of the value taken by the typed setter, or
+ *   %G_TYPE_INVALID if the property has to go through the
+ *   #ClutterAnimatable interface
+ */
+GType
+_clutter_actor_get_animatable_value_type (ClutterActor *self,
+                                          GParamSpec   *pspec)
 {
-  ClutterActor *actor = CLUTTER_ACTOR (scriptable);
-
-#ifdef CLUTTER_ENABLE_DEBUG
-  if (G_UNLIKELY (CLUTTER_HAS_DEBUG (SCRIPT)))
-    {
-      gchar *tmp = g_strdup_value_contents (value);
+  ClutterAnimatableIface *iface;
 
-      CLUTTER_NOTE (SCRIPT,
-                    "in ClutterActor::set_custom_property('%s') = %s",
-                    name,
-                    tmp);
+  if (pspec->owner_type != CLUTTER_TYPE_ACTOR ||
+      (pspec->flags & CLUTTER_PARAM_ANIMATABLE) == 0)
+    return G_TYPE_INVALID;
 
-      g_free (tmp);
-    }
-#endif /* CLUTTER_ENABLE_DEBUG */
+  /* sub-classes are allowed to override the interface */
+  iface = CLUTTER_ANIMATABLE_GET_IFACE (self);
+  if (iface->set_final_state != clutter_actor_set_final_state)
+    return G_TYPE_INVALID;
 
-  if (strcmp (name, "rotation") == 0)
+  switch (pspec->param_id)
     {
-      RotationInfo *info;
-
-      if (!G_VALUE_HOLDS (value, G_TYPE_POINTER))
-        return;
+    case PROP_X:
+    case PROP_Y:
+    case PROP_WIDTH:
+    case PROP_HEIGHT:
+    case PROP_Z_POSITION:
+    case PROP_PIVOT_POINT_Z:
+    case PROP_TRANSLATION_X:
+    case PROP_TRANSLATION_Y:
+    case PROP_TRANSLATION_Z:
+    case PROP_MARGIN_TOP:
+    case PROP_MARGIN_BOTTOM:
+    case PROP_MARGIN_LEFT:
+    case PROP_MARGIN_RIGHT:
+      return G_TYPE_FLOAT;
 
-      info = g_value_get_pointer (value);
+    case PROP_SCALE_X:
+    case PROP_SCALE_Y:
+    case PROP_SCALE_Z:
+    case PROP_ROTATION_ANGLE_X:
+    case PROP_ROTATION_ANGLE_Y:
+    case PROP_ROTATION_ANGLE_Z:
+      return G_TYPE_DOUBLE;
 
-      clutter_actor_set_rotation_angle (actor, info->axis, info->angle);
+    case PROP_BACKGROUND_COLOR:
+      return CLUTTER_TYPE_COLOR;
 
-      g_slice_free (RotationInfo, info);
+    case PROP_POSITION:
+    case PROP_PIVOT_POINT:
+      return CLUTTER_TYPE_POINT;
 
-      return;
+    default:
+      return G_TYPE_INVALID;
     }
+}
 
-  if (strcmp (name, "actions") == 0 ||
-      strcmp (name, "constraints") == 0 ||
-      strcmp (name, "effects") == 0)
-    {
-      GSList *metas, *l;
-
-      if (!G_VALUE_HOLDS (value, G_TYPE_POINTER))
-        return;
-
-      metas = g_value_get_pointer (value);
-      for (l = metas; l != NULL; l = l->next)
-        {
-          if (name[0] == 'a')
-            clutter_actor_add_action (actor, l->data);
-
-          if (name[0] == 'c')
-            clutter_actor_add_constraint (actor, l->data);
+/*< private >
+ * _clutter_actor_is_paint_time_property:
+ * @self: a #ClutterActor
+ * @pspec: a #GParamSpec returned by clutter_animatable_find_property()
+ *
+ * Checks whether the animatable property described by @pspec only
+ * affects the way the actor is painted, and can be evaluated by a
+ * transition right before painting; see
+ * _clutter_actor_schedule_paint_transition().
+ *
+ * Return value: %TRUE if the property can be evaluated on paint
+ */
+gboolean
+_clutter_actor_is_paint_time_property (ClutterActor *self,
+                                       GParamSpec   *pspec)
+{
+  ClutterAnimatableIface *iface;
 
-          if (name[0] == 'e')
-            clutter_actor_add_effect (actor, l->data);
-        }
+  if (pspec == NULL ||
+      pspec->owner_type != CLUTTER_TYPE_ACTOR ||
+      (pspec->flags & CLUTTER_PARAM_ANIMATABLE) == 0)
+    return FALSE;
 
-      g_slist_free (metas);
+  iface = CLUTTER_ANIMATABLE_GET_IFACE (self);
+  if (iface->set_final_state != clutter_actor_set_final_state ||
+      iface->interpolate_value != NULL)
+    return FALSE;
 
-      return;
-    }
-  if (strcmp (name, "margin") == 0)
+  switch (pspec->param_id)
     {
-      clutter_actor_set_margin (actor, g_value_get_boxed (value));
-      return;
-    }
-
-  g_object_set_property (G_OBJECT (scriptable), name, value);
-}
+    case PROP_TRANSLATION_X:
+    case PROP_TRANSLATION_Y:
+    case PROP_TRANSLATION_Z:
+    case PROP_SCALE_X:
+    case PROP_SCALE_Y:
+    case PROP_SCALE_Z:
+    case PROP_ROTATION_ANGLE_X:
+    case PROP_ROTATION_ANGLE_Y:
+    case PROP_ROTATION_ANGLE_Z:
+    case PROP_OPACITY:
+      return TRUE;
 
-static void
-clutter_scriptable_iface_init (ClutterScriptableIface *iface)
-{
-  iface->parse_custom_node = clutter_actor_parse_custom_node;
-  iface->set_custom_property = clutter_actor_set_custom_property;
+    default:
+      return FALSE;
+    }
 }
 
-static ClutterActorMeta *
-get_meta_from_animation_property (ClutterActor  *actor,
-                                  const gchar   *name,
-                                  gchar        **name_p)
+/*< private >
+ * _clutter_actor_schedule_paint_transition:
+ * @self: a #ClutterActor
+ * @transition: a #ClutterTransition
+ * @pspec: the property animated by @transition
+ *
+ * Queues a redraw of @self, and makes sure that the value of @pspec
+ * is computed by @transition before @self is painted, using
+ * _clutter_property_transition_update_paint_value().
+ *
+ * The actor does not hold a reference on @transition, which must be
+ * removed using _clutter_actor_unschedule_paint_transition().
+ */
+void
+_clutter_actor_schedule_paint_transition (ClutterActor      *self,
+                                          ClutterTransition *transition,
+                                          GParamSpec        *pspec)
 {
-  ClutterActorPrivate *priv = actor->priv;
-  ClutterActorMeta *meta = NULL;
-  gchar **tokens;
+  ClutterActorPrivate *priv = self->priv;
+  guint i;
 
-  /* if this is not a special property, fall through */
-  if (name[0] != '@')
-    return NULL;
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return;
 
-  /* detect the properties named using the following spec:
-   *
-   *   @<section>.<meta-name>.<property-name>
-   *
-   * where <section> can be one of the following:
-   *
-   *   - actions
-   *   - constraints
-   *   - effects
-   *
-   * and <meta-name> is the name set on a specific ActorMeta
-   */
+  if (priv->paint_transitions == NULL)
+    priv->paint_transitions = g_ptr_array_new ();
 
-  tokens = g_strsplit (name + 1, ".", -1);
-  if (tokens == NULL || g_strv_length (tokens) != 3)
+  for (i = 0; i < priv->paint_transitions->len; i++)
     {
-      CLUTTER_NOTE (ANIMATION, "Invalid property name '%s'",
-                    name + 1);
-      g_strfreev (tokens);
-      return NULL;
+      if (g_ptr_array_index (priv->paint_transitions, i) == transition)
+        break;
     }
 
-  if (strcmp (tokens[0], "actions") == 0)
-    meta = _clutter_meta_group_get_meta (priv->actions, tokens[1]);
-
-  if (strcmp (tokens[0], "constraints") == 0)
-    meta = _clutter_meta_group_get_meta (priv->constraints, tokens[1]);
-
-  if (strcmp (tokens[0], "effects") == 0)
-    meta = _clutter_meta_group_get_meta (priv->effects, tokens[1]);
+  if (i == priv->paint_transitions->len)
+    g_ptr_array_add (priv->paint_transitions, transition);
 
-  if (name_p != NULL)
-    *name_p = g_strdup (tokens[2]);
+  /* see clutter_actor_set_opacity_internal() */
+  if (pspec == obj_props[PROP_OPACITY])
+    _clutter_actor_queue_redraw_full (self, 0, NULL, priv->flatten_effect);
+  else
+    clutter_actor_queue_redraw (self);
+}
 
-  CLUTTER_NOTE (ANIMATION,
-                "Looking for property '%s' of object '%s' in section '%s'",
-                tokens[2],
-                tokens[1],
-                tokens[0]);
+/*< private >
+ * _clutter_actor_unschedule_paint_transition:
+ * @self: a #ClutterActor
+ * @transition: a #ClutterTransition
+ *
+ * Removes a transition added by _clutter_actor_schedule_paint_transition().
+ *
+ * Return value: %TRUE if @transition was scheduled on @self, and its
+ *   final value should be set on the actor
+ */
+gboolean
+_clutter_actor_unschedule_paint_transition (ClutterActor      *self,
+                                            ClutterTransition *transition)
+{
+  ClutterActorPrivate *priv = self->priv;
 
-  g_strfreev (tokens);
+  if (priv->paint_transitions == NULL)
+    return FALSE;
 
-  return meta;
+  return g_ptr_array_remove_fast (priv->paint_transitions, transition);
 }
 
-static GParamSpec *
-clutter_actor_find_property (ClutterAnimatable *animatable,
-                             const gchar       *property_name)
+/*< private >
+ * _clutter_actor_set_paint_time_value:
+ * @self: a #ClutterActor
+ * @pspec: a #GParamSpec accepted by _clutter_actor_is_paint_time_property()
+ * @value: the new value
+ *
+ * Stores the value of a property evaluated on paint; unlike the
+ * setters, this function does not queue a redraw and does not
+ * notify the change of the property.
+ */
+void
+_clutter_actor_set_paint_time_value (ClutterActor *self,
+                                     GParamSpec   *pspec,
+                                     gdouble       value)
 {
-  ClutterActorMeta *meta = NULL;
-  GObjectClass *klass = NULL;
-  GParamSpec *pspec = NULL;
-  gchar *p_name = NULL;
-
-  meta = get_meta_from_animation_property (CLUTTER_ACTOR (animatable),
-                                           property_name,
-                                           &p_name);
+  ClutterActorPrivate *priv = self->priv;
+  ClutterTransformInfo *info;
 
-  if (meta != NULL)
+  if (pspec->param_id == PROP_OPACITY)
     {
-      klass = G_OBJECT_GET_CLASS (meta);
-
-      pspec = g_object_class_find_property (klass, p_name);
+      priv->opacity = (guint8) CLAMP (value, 0.0, 255.0);
+      return;
     }
-  else
+
+  info = _clutter_actor_get_transform_info (self);
+
+  switch (pspec->param_id)
     {
-      klass = G_OBJECT_GET_CLASS (animatable);
+    case PROP_TRANSLATION_X:
+      info->translation.x = value;
+      break;
 
-      pspec = g_object_class_find_property (klass, property_name);
-    }
+    case PROP_TRANSLATION_Y:
+      info->translation.y = value;
+      break;
 
-  g_free (p_name);
+    case PROP_TRANSLATION_Z:
+      info->translation.z = value;
+      break;
 
-  return pspec;
-}
+    case PROP_SCALE_X:
+      info->scale_x = value;
+      break;
 
-static void
-clutter_actor_get_initial_state (ClutterAnimatable *animatable,
-                                 const gchar       *property_name,
-                                 GValue            *initial)
-{
-  ClutterActorMeta *meta = NULL;
-  gchar *p_name = NULL;
+    case PROP_SCALE_Y:
+      info->scale_y = value;
+      break;
 
-  meta = get_meta_from_animation_property (CLUTTER_ACTOR (animatable),
-                                           property_name,
-                                           &p_name);
+    case PROP_SCALE_Z:
+      info->scale_z = value;
+      break;
 
-  if (meta != NULL)
-    g_object_get_property (G_OBJECT (meta), p_name, initial);
-  else
-    g_object_get_property (G_OBJECT (animatable), property_name, initial);
+    case PROP_ROTATION_ANGLE_X:
+      info->rx_angle = value;
+      break;
 
-  g_free (p_name);
+    case PROP_ROTATION_ANGLE_Y:
+      info->ry_angle = value;
+      break;
+
+    case PROP_ROTATION_ANGLE_Z:
+      info->rz_angle = value;
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  clutter_actor_invalidate_transform (self);
+  clutter_actor_invalidate_pick (self);
 }
 
-/*
- * clutter_actor_set_animatable_property:
- * @actor: a #ClutterActor
- * @prop_id: the paramspec id
- * @value: the value to set
- * @pspec: the paramspec
- *
- * Sets values of animatable properties.
- *
- * This is a variant of clutter_actor_set_property() that gets called
- * by the #ClutterAnimatable implementation of #ClutterActor for the
- * properties with the %CLUTTER_PARAM_ANIMATABLE flag set on their
- * #GParamSpec.
+/*< private >
+ * _clutter_actor_set_animatable_float:
+ * @self: a #ClutterActor
+ * @pspec: a #GParamSpec
+ * @value: the new value
  *
- * Unlike the implementation of #GObjectClass.set_property(), this
- * function will not update the interval if a transition involving an
- * animatable property is in progress - this avoids cycles with the
- * transition API calling the public API.
+ * Sets the value of the animatable property described by @pspec; the
+ * type of the property must be %G_TYPE_FLOAT, as returned by
+ * _clutter_actor_get_animatable_value_type().
  */
-static void
-clutter_actor_set_animatable_property (ClutterActor *actor,
-                                       guint         prop_id,
-                                       const GValue *value,
-                                       GParamSpec   *pspec)
+void
+_clutter_actor_set_animatable_float (ClutterActor *self,
+                                     GParamSpec   *pspec,
+                                     gfloat        value)
 {
-  GObject *obj = G_OBJECT (actor);
+  GObject *obj = G_OBJECT (self);
 
   g_object_freeze_notify (obj);
 
-  switch (prop_id)
+  switch (pspec->param_id)
     {
     case PROP_X:
-      clutter_actor_set_x_internal (actor, g_value_get_float (value));
+      clutter_actor_set_x_internal (self, value);
       break;
 
     case PROP_Y:
-      clutter_actor_set_y_internal (actor, g_value_get_float (value));
-      break;
-
-    case PROP_POSITION:
-      clutter_actor_set_position_internal (actor, g_value_get_boxed (value));
+      clutter_actor_set_y_internal (self, value);
       break;
 
     case PROP_WIDTH:
-      clutter_actor_set_width_internal (actor, g_value_get_float (value));
+      clutter_actor_set_width_internal (self, value);
       break;
 
     case PROP_HEIGHT:
-      clutter_actor_set_height_internal (actor, g_value_get_float (value));
+      clutter_actor_set_height_internal (self, value);
       break;
 
-    case PROP_SIZE:
-      clutter_actor_set_size_internal (actor, g_value_get_boxed (value));
+    case PROP_Z_POSITION:
+      clutter_actor_set_z_position_internal (self, value);
       break;
 
-    case PROP_ALLOCATION:
-      clutter_actor_allocate_internal (actor,
-                                       g_value_get_boxed (value),
-                                       actor->priv->allocation_flags);
-      clutter_actor_queue_redraw (actor);
+    case PROP_PIVOT_POINT_Z:
+      clutter_actor_set_pivot_point_z_internal (self, value);
       break;
 
-    case PROP_Z_POSITION:
-      clutter_actor_set_z_position_internal (actor, g_value_get_float (value));
+    case PROP_TRANSLATION_X:
+    case PROP_TRANSLATION_Y:
+    case PROP_TRANSLATION_Z:
+      clutter_actor_set_translation_internal (self, value, pspec);
       break;
 
-    case PROP_OPACITY:
-      clutter_actor_set_opacity_internal (actor, g_value_get_uint (value));
+    case PROP_MARGIN_TOP:
+    case PROP_MARGIN_BOTTOM:
+    case PROP_MARGIN_LEFT:
+    case PROP_MARGIN_RIGHT:
+      clutter_actor_set_margin_internal (self, value, pspec);
       break;
 
-    case PROP_BACKGROUND_COLOR:
-      clutter_actor_set_background_color_internal (actor, clutter_value_get_color (value));
-      break;
+    default:
+      g_assert_not_reached ();
+    }
 
-    case PROP_PIVOT_POINT:
-      clutter_actor_set_pivot_point_internal (actor, g_value_get_boxed (value));
-      break;
+  g_object_thaw_notify (obj);
+}
 
-    case PROP_PIVOT_POINT_Z:
-      clutter_actor_set_pivot_point_z_internal (actor, g_value_get_float (value));
-      break;
+/*< private >
+ * _clutter_actor_set_animatable_double:
+ * @self: a #ClutterActor
+ * @pspec: a #GParamSpec
+ * @value: the new value
+ *
+ * Sets the value of the animatable property described by @pspec; the
+ * type of the property must be %G_TYPE_DOUBLE.
+ */
+void
+_clutter_actor_set_animatable_double (ClutterActor *self,
+                                      GParamSpec   *pspec,
+                                      gdouble       value)
+{
+  GObject *obj = G_OBJECT (self);
 
-    case PROP_TRANSLATION_X:
-    case PROP_TRANSLATION_Y:
-    case PROP_TRANSLATION_Z:
-      clutter_actor_set_translation_internal (actor,
-                                              g_value_get_float (value),
-                                              pspec);
-      break;
+  g_object_freeze_notify (obj);
 
+  switch (pspec->param_id)
+    {
     case PROP_SCALE_X:
     case PROP_SCALE_Y:
     case PROP_SCALE_Z:
-      clutter_actor_set_scale_factor_internal (actor,
-                                               g_value_get_double (value),
-                                               pspec);
+      clutter_actor_set_scale_factor_internal (self, value, pspec);
       break;
 
     case PROP_ROTATION_ANGLE_X:
     case PROP_ROTATION_ANGLE_Y:
     case PROP_ROTATION_ANGLE_Z:
-      clutter_actor_set_rotation_angle_internal (actor,
-                                                 g_value_get_double (value),
-                                                 pspec);
+      clutter_actor_set_rotation_angle_internal (self, value, pspec);
       break;
 
-    case PROP_CONTENT_BOX:
-      clutter_actor_store_content_box (actor, g_value_get_boxed (value));
-      break;
+    default:
+      g_assert_not_reached ();
+    }
 
-    case PROP_MARGIN_TOP:
-    case PROP_MARGIN_BOTTOM:
-    case PROP_MARGIN_LEFT:
-    case PROP_MARGIN_RIGHT:
-      clutter_actor_set_margin_internal (actor, g_value_get_float (value),
-                                         pspec);
-      break;
+  g_object_thaw_notify (obj);
+}
 
-    case PROP_TRANSFORM:
-      clutter_actor_set_transform_internal (actor, g_value_get_boxed (value));
-      break;
+/*< private >
+ * _clutter_actor_set_animatable_color:
+ * @self: a #ClutterActor
+ * @pspec: a #GParamSpec
+ * @value: the new value
+ *
+ * Sets the value of the animatable property described by @pspec; the
+ * type of the property must be %CLUTTER_TYPE_COLOR.
+ */
+void
+_clutter_actor_set_animatable_color (ClutterActor       *self,
+                                     GParamSpec         *pspec,
+                                     const ClutterColor *value)
+{
+  GObject *obj = G_OBJECT (self);
 
-    case PROP_CHILD_TRANSFORM:
-      clutter_actor_set_child_transform_internal (actor, g_value_get_boxed (value));
+  g_object_freeze_notify (obj);
+
+  switch (pspec->param_id)
+    {
+    case PROP_BACKGROUND_COLOR:
+      clutter_actor_set_background_color_internal (self, value);
       break;
 
     default:
-      g_object_set_property (obj, pspec->name, value);
-      break;
+      g_assert_not_reached ();
     }
 
   g_object_thaw_notify (obj);
 }
 
-static void
-clutter_actor_set_final_state (ClutterAnimatable *animatable,
-                               const gchar       *property_name,
-                               const GValue      *final)
+/*< private >
+ * _clutter_actor_set_animatable_point:
+ * @self: a #ClutterActor
+ * @pspec: a #GParamSpec
+ * @value: the new value
+ *
+ * Sets the value of the animatable property described by @pspec; the
+ * type of the property must be %CLUTTER_TYPE_POINT.
+ */
+void
+_clutter_actor_set_animatable_point (ClutterActor       *self,
+                                     GParamSpec         *pspec,
+                                     const ClutterPoint *value)
 {
-  ClutterActor *actor = CLUTTER_ACTOR (animatable);
-  ClutterActorMeta *meta = NULL;
-  gchar *p_name = NULL;
+  GObject *obj = G_OBJECT (self);
 
-  meta = get_meta_from_animation_property (actor,
-                                           property_name,
-                                           &p_name);
-  if (meta != NULL)
-    g_object_set_property (G_OBJECT (meta), p_name, final);
-  else
+  g_object_freeze_notify (obj);
+
+  switch (pspec->param_id)
     {
-      GObjectClass *obj_class = G_OBJECT_GET_CLASS (animatable);
-      GParamSpec *pspec;
+    case PROP_POSITION:
+      clutter_actor_set_position_internal (self, value);
+      break;
 
-      pspec = g_object_class_find_property (obj_class, property_name);
+    case PROP_PIVOT_POINT:
+      clutter_actor_set_pivot_point_internal (self, value);
+      break;
 
-      if ((pspec->flags & CLUTTER_PARAM_ANIMATABLE) != 0)
-        {
-          /* XXX - I'm going to the special hell for this */
-          clutter_actor_set_animatable_property (actor, pspec->param_id, final, pspec);
-        }
-      else
-        g_object_set_property (G_OBJECT (animatable), pspec->name, final);
+    default:
+      g_assert_not_reached ();
     }
 
-  g_free (p_name);
+  g_object_thaw_notify (obj);
 }
 
 static void
@@ -13708,9 +17733,10 @@ clutter_actor_set_transform_internal (ClutterActor        *self,
   info->transform = *transform;
   info->transform_set = !cogl_matrix_is_identity (&info->transform);
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
+  clutter_actor_invalidate_pick (self);
 
-  clutter_actor_queue_redraw (self);
+  clutter_actor_queue_transform_redraw (self);
 
   g_object_notify_by_pspec (obj, obj_props[PROP_TRANSFORM]);
 
@@ -13947,6 +17973,149 @@ _clutter_actor_set_queue_redraw_clip (ClutterActor       *self,
                      clip);
 }
 
+/* the time each slice of clutter_actor_prepare_layout() is allowed
+ * to run for, in microseconds
+ */
+#define PREPARE_LAYOUT_SLICE    2000
+
+typedef struct {
+  ClutterActor *root;
+  gfloat for_width;
+
+  /* the actors of the sub-tree, children first */
+  GPtrArray *actors;
+  guint next_actor;
+
+  ClutterCallback callback;
+  gpointer user_data;
+  GDestroyNotify notify;
+} PrepareLayoutClosure;
+
+static void
+prepare_layout_collect (ClutterActor *actor,
+                        GPtrArray    *actors)
+{
+  ClutterActor *iter;
+
+  for (iter = actor->priv->first_child;
+       iter != NULL;
+       iter = iter->priv->next_sibling)
+    prepare_layout_collect (iter, actors);
+
+  g_ptr_array_add (actors, g_object_ref (actor));
+}
+
+static gboolean
+prepare_layout_idle (gpointer data)
+{
+  PrepareLayoutClosure *closure = data;
+  gint64 start;
+
+  start = g_get_monotonic_time ();
+
+  if (closure->actors == NULL)
+    {
+      closure->actors = g_ptr_array_new_with_free_func (g_object_unref);
+      prepare_layout_collect (closure->root, closure->actors);
+    }
+
+  /* the natural size requests of the children are cached, and used
+   * by the layout managers of their parents
+   */
+  while (closure->next_actor < closure->actors->len)
+    {
+      ClutterActor *actor;
+
+      actor = g_ptr_array_index (closure->actors, closure->next_actor++);
+      if (!CLUTTER_ACTOR_IN_DESTRUCTION (actor))
+        clutter_actor_get_preferred_size (actor, NULL, NULL, NULL, NULL);
+
+      if (g_get_monotonic_time () - start >= PREPARE_LAYOUT_SLICE)
+        return TRUE;
+    }
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (closure->root))
+    return FALSE;
+
+  if (closure->for_width >= 0)
+    clutter_actor_get_preferred_height (closure->root, closure->for_width,
+                                        NULL,
+                                        NULL);
+
+  if (closure->callback != NULL)
+    closure->callback (closure->root, closure->user_data);
+
+  return FALSE;
+}
+
+static void
+prepare_layout_closure_free (gpointer data)
+{
+  PrepareLayoutClosure *closure = data;
+
+  if (closure->actors != NULL)
+    g_ptr_array_unref (closure->actors);
+
+  g_object_unref (closure->root);
+
+  if (closure->notify != NULL)
+    closure->notify (closure->user_data);
+
+  g_slice_free (PrepareLayoutClosure, closure);
+}
+
+/**
+ * clutter_actor_prepare_layout:
+ * @self: a #ClutterActor
+ * @for_width: the width that @self is going to be allocated, or a
+ *   negative value if it is not known
+ * @callback: (scope notified) (allow-none): the function to call once
+ *   the preparation is complete
+ * @user_data: data to pass to @callback
+ * @notify: (allow-none): function to call when @user_data is not
+ *   needed any more
+ *
+ * Computes the size requests of @self and all of its children while
+ * the main loop is idle, a few at a time, so that the allocation of a
+ * large sub-tree that is not yet part of the scene graph does not
+ * cause frames to be dropped.
+ *
+ * The computed size requests are cached by each actor; once @callback
+ * has been called, @self can be added to the scene graph and the
+ * following allocation cycle will mostly use the cached values.
+ *
+ * The preparation can be cancelled by passing the returned identifier
+ * to g_source_remove(); @notify is called in both cases.
+ *
+ * Return value: the identifier of the #GSource used to prepare @self
+ */
+guint
+clutter_actor_prepare_layout (ClutterActor    *self,
+                              gfloat           for_width,
+                              ClutterCallback  callback,
+                              gpointer         user_data,
+                              GDestroyNotify   notify)
+{
+  PrepareLayoutClosure *closure;
+
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
+
+  closure = g_slice_new0 (PrepareLayoutClosure);
+  closure->root = g_object_ref (self);
+  closure->for_width = for_width;
+  closure->callback = callback;
+  closure->user_data = user_data;
+  closure->notify = notify;
+
+  /* we use a lower priority than the redraws, so that the frames
+   * of the scene graph on the stage are not delayed
+   */
+  return clutter_threads_add_idle_full (G_PRIORITY_DEFAULT_IDLE,
+                                        prepare_layout_idle,
+                                        closure,
+                                        prepare_layout_closure_free);
+}
+
 /**
  * clutter_actor_has_allocation:
  * @self: a #ClutterActor
@@ -14421,6 +18590,7 @@ clutter_actor_set_clip_to_allocation (ClutterActor *self,
     {
       priv->clip_to_allocation = clip_set;
 
+      clutter_actor_invalidate_pick (self);
       clutter_actor_queue_redraw (self);
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_CLIP_TO_ALLOCATION]);
@@ -14752,9 +18922,19 @@ _clutter_actor_get_paint_volume_mutable (ClutterActor *self)
 
   priv = self->priv;
 
+  /* the volume is kept until something queues a redraw or a relayout
+   * on the actor or on one of its descendants; the volume up to the
+   * effect being painted is not cached
+   */
+  if (!priv->needs_paint_volume_update && priv->current_effect == NULL)
+    return priv->paint_volume_valid ? &priv->paint_volume : NULL;
+
   if (priv->paint_volume_valid)
     clutter_paint_volume_free (&priv->paint_volume);
 
+  priv->needs_paint_volume_update = priv->current_effect != NULL;
+  priv->last_paint_volume_cached = FALSE;
+
   if (_clutter_actor_get_paint_volume_real (self, &priv->paint_volume))
     {
       priv->paint_volume_valid = TRUE;
@@ -14788,6 +18968,11 @@ _clutter_actor_get_paint_volume_mutable (ClutterActor *self)
  * ensure their volume has a depth of 0. (This will be true so long as
  * you don't call clutter_paint_volume_set_depth().)</note>
  *
+ * The paint volume is cached until a redraw or a relayout is queued on
+ * the actor or on one of its descendants, so actors overriding
+ * <function>get_paint_volume()</function> should queue a redraw when
+ * the state it depends on changes.
+ *
  * Return value: (transfer none): a pointer to a #ClutterPaintVolume,
  *   or %NULL if no volume could be determined. The returned pointer
  *   is not guaranteed to be valid across multiple frames; if you want
@@ -15026,12 +19211,22 @@ ClutterActor *
 clutter_actor_get_child_at_index (ClutterActor *self,
                                   gint          index_)
 {
+  GPtrArray *children;
   ClutterActor *iter;
   int i;
 
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
   g_return_val_if_fail (index_ <= self->priv->n_children, NULL);
 
+  children = clutter_actor_get_children_index (self);
+  if (children != NULL)
+    {
+      if (index_ < 0 || (guint) index_ >= children->len)
+        return NULL;
+
+      return g_ptr_array_index (children, index_);
+    }
+
   for (iter = self->priv->first_child, i = 0;
        iter != NULL && i < index_;
        iter = iter->priv->next_sibling, i += 1)
@@ -15310,13 +19505,25 @@ static const ClutterLayoutInfo default_layout_info = {
   FALSE, FALSE,                 /* expand */
   CLUTTER_SIZE_INIT_ZERO,       /* minimum */
   CLUTTER_SIZE_INIT_ZERO,       /* natural */
+  NULL,                         /* layout-meta */
 };
 
 static void
 layout_info_free (gpointer data)
 {
   if (G_LIKELY (data != NULL))
-    g_slice_free (ClutterLayoutInfo, data);
+    {
+      ClutterLayoutInfo *info = data;
+
+      if (info->layout_meta != NULL)
+        g_object_unref (info->layout_meta);
+
+      g_slice_free (ClutterLayoutInfo, data);
+
+      _clutter_memory_account (CLUTTER_MEMORY_ACTORS,
+                               -(gssize) sizeof (ClutterLayoutInfo),
+                               0);
+    }
 }
 
 /*< private >
@@ -15363,6 +19570,10 @@ _clutter_actor_get_layout_info (ClutterActor *self)
 
       *retval = default_layout_info;
 
+      _clutter_memory_account (CLUTTER_MEMORY_ACTORS,
+                               sizeof (ClutterLayoutInfo),
+                               0);
+
       g_object_set_qdata_full (G_OBJECT (self), quark_actor_layout_info,
                                retval,
                                layout_info_free);
@@ -15927,6 +20138,21 @@ clutter_actor_get_last_child (ClutterActor *self)
   return self->priv->last_child;
 }
 
+/*< private >
+ * _clutter_actor_get_children_age:
+ * @self: a #ClutterActor
+ *
+ * Retrieves a counter that is incremented every time a child is added
+ * to, or removed from @self, including when the children are reordered.
+ *
+ * Return value: the age of the list of children of @self
+ */
+gint
+_clutter_actor_get_children_age (ClutterActor *self)
+{
+  return self->priv->age;
+}
+
 /* easy way to have properly named fields instead of the dummy ones
  * we use in the public structure
  */
@@ -16188,6 +20414,10 @@ clutter_animation_info_free (gpointer data)
         g_array_unref (info->states);
 
       g_slice_free (ClutterAnimationInfo, info);
+
+      _clutter_memory_account (CLUTTER_MEMORY_ACTORS,
+                               -(gssize) sizeof (ClutterAnimationInfo),
+                               0);
     }
 }
 
@@ -16217,6 +20447,10 @@ _clutter_actor_get_animation_info (ClutterActor *self)
 
       *res = default_animation_info;
 
+      _clutter_memory_account (CLUTTER_MEMORY_ACTORS,
+                               sizeof (ClutterAnimationInfo),
+                               0);
+
       g_object_set_qdata_full (obj, quark_actor_animation_info,
                                res,
                                clutter_animation_info_free);
@@ -16407,10 +20641,14 @@ _clutter_actor_create_transition (ClutterActor *actor,
   GValue final = G_VALUE_INIT;
   GType ptype;
   char *error;
+  const gchar *old_cause = _clutter_redraw_cause;
 
   g_assert (pspec != NULL);
   g_assert ((pspec->flags & CLUTTER_PARAM_ANIMATABLE) != 0);
 
+  /* the setters of the animatable properties end up here */
+  _clutter_redraw_cause = pspec->name;
+
   info = _clutter_actor_get_animation_info (actor);
 
   /* XXX - this will go away in 2.0
@@ -16570,6 +20808,8 @@ out:
 
   va_end (var_args);
 
+  _clutter_redraw_cause = old_cause;
+
   return res;
 }
 
@@ -16993,6 +21233,50 @@ clutter_actor_restore_easing_state (ClutterActor *self)
     }
 }
 
+/*< private >
+ * _clutter_actor_reset_for_reuse:
+ * @self: a #ClutterActor
+ *
+ * Removes all the transitions and easing states of @self, and resets
+ * its position, size request and transformations to their defaults,
+ * so that @self can be reused in place of a newly created actor.
+ */
+void
+_clutter_actor_reset_for_reuse (ClutterActor *self)
+{
+  ClutterAnimationInfo *info;
+
+  clutter_actor_remove_all_transitions (self);
+
+  info = g_object_get_qdata (G_OBJECT (self), quark_actor_animation_info);
+  if (info != NULL && info->states != NULL)
+    {
+      g_array_unref (info->states);
+      info->states = NULL;
+      info->cur_state = NULL;
+    }
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  /* without an easing state, all the setters below apply immediately */
+  clutter_actor_set_opacity (self, 255);
+  clutter_actor_set_scale (self, 1.0, 1.0);
+  clutter_actor_set_scale_z (self, 1.0);
+  clutter_actor_set_rotation_angle (self, CLUTTER_X_AXIS, 0.0);
+  clutter_actor_set_rotation_angle (self, CLUTTER_Y_AXIS, 0.0);
+  clutter_actor_set_rotation_angle (self, CLUTTER_Z_AXIS, 0.0);
+  clutter_actor_set_translation (self, 0.f, 0.f, 0.f);
+  clutter_actor_set_z_position (self, 0.f);
+  clutter_actor_set_pivot_point (self, 0.f, 0.f);
+  clutter_actor_set_transform (self, NULL);
+  clutter_actor_set_child_transform (self, NULL);
+
+  clutter_actor_set_fixed_position_set (self, FALSE);
+  clutter_actor_set_size (self, -1, -1);
+
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
 /**
  * clutter_actor_set_content:
  * @self: a #ClutterActor
@@ -17719,6 +22003,170 @@ clutter_actor_get_content_repeat (ClutterActor *self)
   return self->priv->content_repeat;
 }
 
+static LodInfo *
+clutter_actor_ensure_lod (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (priv->lod == NULL)
+    {
+      priv->lod = g_slice_new0 (LodInfo);
+      _clutter_memory_account (CLUTTER_MEMORY_ACTORS,
+                               sizeof (LodInfo),
+                               0);
+    }
+
+  return priv->lod;
+}
+
+/**
+ * clutter_actor_set_lod_threshold:
+ * @self: a #ClutterActor
+ * @threshold: the size on the stage, in pixels, or 0
+ *
+ * Sets the size below which @self is collapsed when painting.
+ *
+ * When both the width and the height of the paint box of a collapsed
+ * actor on the stage are smaller than @threshold, none of its effects,
+ * its #ClutterActor:content and its children are painted: the actor
+ * is painted using its background color and its
+ * #ClutterActor:lod-placeholder, if any, instead, and it is picked as
+ * a rectangle covering its allocation. This is useful for the actors
+ * holding many details that would be painted at a scale too small to
+ * distinguish them, like the parts of a zoomable map.
+ *
+ * The size is measured on the paint volume used to cull the actor, so
+ * it takes into account the transformations of the actor and of its
+ * parents. The actors painted by a #ClutterClone, or inside the
+ * offscreen buffer of an effect, are never collapsed.
+ *
+ * A @threshold of 0 disables collapsing.
+ */
+void
+clutter_actor_set_lod_threshold (ClutterActor *self,
+                                 gfloat        threshold)
+{
+  LodInfo *lod;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (threshold >= 0.f);
+
+  if (self->priv->lod == NULL && threshold == 0.f)
+    return;
+
+  lod = clutter_actor_ensure_lod (self);
+  if (lod->threshold == threshold)
+    return;
+
+  lod->threshold = threshold;
+
+  if (threshold == 0.f)
+    lod->collapsed = FALSE;
+
+  clutter_actor_queue_redraw (self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_LOD_THRESHOLD]);
+}
+
+/**
+ * clutter_actor_get_lod_threshold:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the value set using clutter_actor_set_lod_threshold().
+ *
+ * Return value: the size below which the actor is collapsed, in pixels
+ */
+gfloat
+clutter_actor_get_lod_threshold (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0.f);
+
+  if (self->priv->lod == NULL)
+    return 0.f;
+
+  return self->priv->lod->threshold;
+}
+
+/**
+ * clutter_actor_set_lod_placeholder:
+ * @self: a #ClutterActor
+ * @placeholder: (allow-none): a #ClutterContent, or %NULL
+ *
+ * Sets the content painted inside the content box of @self in place
+ * of the actor and its children, when the actor is collapsed; see
+ * clutter_actor_set_lod_threshold().
+ *
+ * The actor takes a reference on @placeholder.
+ */
+void
+clutter_actor_set_lod_placeholder (ClutterActor   *self,
+                                   ClutterContent *placeholder)
+{
+  LodInfo *lod;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (placeholder == NULL || CLUTTER_IS_CONTENT (placeholder));
+
+  if (self->priv->lod == NULL && placeholder == NULL)
+    return;
+
+  lod = clutter_actor_ensure_lod (self);
+  if (lod->placeholder == placeholder)
+    return;
+
+  if (lod->placeholder != NULL)
+    {
+      _clutter_content_detached (lod->placeholder, self);
+      g_object_unref (lod->placeholder);
+    }
+
+  lod->placeholder = placeholder;
+
+  if (lod->placeholder != NULL)
+    {
+      g_object_ref (lod->placeholder);
+      _clutter_content_attached (lod->placeholder, self);
+    }
+
+  if (lod->collapsed)
+    clutter_actor_queue_redraw (self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_LOD_PLACEHOLDER]);
+}
+
+/**
+ * clutter_actor_get_lod_placeholder:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the value set using clutter_actor_set_lod_placeholder().
+ *
+ * Return value: (transfer none): the placeholder of the actor, or %NULL
+ */
+ClutterContent *
+clutter_actor_get_lod_placeholder (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
+
+  if (self->priv->lod == NULL)
+    return NULL;
+
+  return self->priv->lod->placeholder;
+}
+
+static inline gboolean
+clutter_actor_should_emit_event (ClutterActor       *self,
+                                 const ClutterEvent *event,
+                                 gboolean            is_key_event,
+                                 gboolean            capture)
+{
+  if (!CLUTTER_ACTOR_IS_REACTIVE (self) && /* an actor must be reactive */
+      self->priv->parent != NULL &&        /* unless it's the stage */
+      !is_key_event)                       /* or this is a key event */
+    return FALSE;
+
+  return clutter_actor_has_event_handlers (self, event, capture);
+}
+
 void
 _clutter_actor_handle_event (ClutterActor       *self,
                              const ClutterEvent *event)
@@ -17735,40 +22183,71 @@ _clutter_actor_handle_event (ClutterActor       *self,
   is_key_event = event->type == CLUTTER_KEY_PRESS ||
                  event->type == CLUTTER_KEY_RELEASE;
 
-  event_tree = g_ptr_array_sized_new (64);
-  g_ptr_array_set_free_func (event_tree, (GDestroyNotify) g_object_unref);
+  /* the chain is shared, so a nested emission needs its own */
+  if (event_chain_in_use)
+    event_tree = g_ptr_array_sized_new (64);
+  else
+    {
+      if (event_chain == NULL)
+        event_chain = g_ptr_array_sized_new (64);
+
+      event_tree = event_chain;
+      event_chain_in_use = TRUE;
+    }
 
-  /* build the list of of emitters for the event */
-  iter = self;
-  while (iter != NULL)
+  /* build the list of ancestors of the source, unless we can
+   * reuse the one of the previous event
+   */
+  if (event_tree != event_chain ||
+      event_chain_source != self ||
+      event_chain_generation != hierarchy_generation)
     {
-      ClutterActor *parent = iter->priv->parent;
+      g_ptr_array_set_size (event_tree, 0);
 
-      if (CLUTTER_ACTOR_IS_REACTIVE (iter) || /* an actor must be reactive */
-          parent == NULL ||                       /* unless it's the stage */
-          is_key_event)                          /* or this is a key event */
+      for (iter = self; iter != NULL; iter = iter->priv->parent)
+        g_ptr_array_add (event_tree, iter);
+
+      if (event_tree == event_chain)
         {
-          /* keep a reference on the actor, so that it remains valid
-           * for the duration of the signal emission
-           */
-          g_ptr_array_add (event_tree, g_object_ref (iter));
+          event_chain_source = self;
+          event_chain_generation = hierarchy_generation;
         }
-
-      iter = parent;
     }
 
+  /* keep a reference on the actors, so that they remain valid for
+   * the duration of the signal emission
+   */
+  for (i = 0; i < event_tree->len; i++)
+    g_object_ref (g_ptr_array_index (event_tree, i));
+
   /* Capture: from top-level downwards */
   for (i = event_tree->len - 1; i >= 0; i--)
-    if (clutter_actor_event (g_ptr_array_index (event_tree, i), event, TRUE))
-      goto done;
+    {
+      iter = g_ptr_array_index (event_tree, i);
+
+      if (clutter_actor_should_emit_event (iter, event, is_key_event, TRUE) &&
+          clutter_actor_event (iter, event, TRUE))
+        goto done;
+    }
 
   /* Bubble: from source upwards */
   for (i = 0; i < event_tree->len; i++)
-    if (clutter_actor_event (g_ptr_array_index (event_tree, i), event, FALSE))
-      goto done;
+    {
+      iter = g_ptr_array_index (event_tree, i);
+
+      if (clutter_actor_should_emit_event (iter, event, is_key_event, FALSE) &&
+          clutter_actor_event (iter, event, FALSE))
+        goto done;
+    }
 
 done:
-  g_ptr_array_free (event_tree, TRUE);
+  for (i = 0; i < event_tree->len; i++)
+    g_object_unref (g_ptr_array_index (event_tree, i));
+
+  if (event_tree == event_chain)
+    event_chain_in_use = FALSE;
+  else
+    g_ptr_array_free (event_tree, TRUE);
 }
 
 static void
@@ -17789,7 +22268,9 @@ clutter_actor_set_child_transform_internal (ClutterActor        *self,
   /* we need to reset the transform_valid flag on each child */
   clutter_actor_iter_init (&iter, self);
   while (clutter_actor_iter_next (&iter, &child))
-    child->priv->transform_valid = FALSE;
+    clutter_actor_invalidate_transform (child);
+
+  clutter_actor_invalidate_pick (self);
 
   clutter_actor_queue_redraw (self);
 
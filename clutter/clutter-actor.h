@@ -92,6 +92,27 @@ typedef void (*ClutterCallback) (ClutterActor *actor,
  */
 #define CLUTTER_CALLBACK(f)        ((ClutterCallback) (f))
 
+/**
+ * ClutterActorCreateChildFunc:
+ * @self: the #ClutterActor bound to the model
+ * @iter: a #ClutterModelIter pointing to the row
+ * @child: (allow-none): the child currently displaying the row, or %NULL
+ * @user_data: data passed to clutter_actor_bind_model()
+ *
+ * Creates the child of @self displaying the row of the model pointed
+ * by @iter; see clutter_actor_bind_model().
+ *
+ * If @child is not %NULL, the function should update it to display the
+ * current contents of the row and return it, instead of creating a new
+ * actor; if a different actor is returned, @child will be destroyed.
+ *
+ * Return value: (transfer full): the child for the row
+ */
+typedef ClutterActor * (* ClutterActorCreateChildFunc) (ClutterActor     *self,
+                                                        ClutterModelIter *iter,
+                                                        ClutterActor     *child,
+                                                        gpointer          user_data);
+
 /**
  * ClutterActor:
  * @flags: #ClutterActorFlags
@@ -182,6 +203,9 @@ struct _ClutterActor
  * @paint_node: virtual function for creating paint nodes and attaching
  *   them to the render tree
  * @touch_event: signal class closure for #ClutterActor::touch-event
+ * @get_opaque_box: virtual function for retrieving the area of the actor,
+ *   in actor-relative coordinates, that is painted with fully opaque
+ *   pixels; used to avoid painting the actors hidden behind it
  *
  * Base class for actors.
  */
@@ -267,9 +291,12 @@ struct _ClutterActorClass
   gboolean (* touch_event)          (ClutterActor         *self,
                                      ClutterTouchEvent    *event);
 
+  gboolean (* get_opaque_box)       (ClutterActor         *self,
+                                     ClutterActorBox      *box);
+
   /*< private >*/
   /* padding for future expansion */
-  gpointer _padding_dummy[32];
+  gpointer _padding_dummy[31];
 };
 
 /**
@@ -338,6 +365,11 @@ void                            clutter_actor_get_preferred_size
                                                                                  gfloat                      *min_height_p,
                                                                                  gfloat                      *natural_width_p,
                                                                                  gfloat                      *natural_height_p);
+guint                           clutter_actor_prepare_layout                    (ClutterActor                *self,
+                                                                                 gfloat                       for_width,
+                                                                                 ClutterCallback              callback,
+                                                                                 gpointer                     user_data,
+                                                                                 GDestroyNotify               notify);
 void                            clutter_actor_allocate                          (ClutterActor                *self,
                                                                                  const ClutterActorBox       *box,
                                                                                  ClutterAllocationFlags       flags);
@@ -512,6 +544,13 @@ void                            clutter_actor_set_content_repeat
 
 ClutterContentRepeat            clutter_actor_get_content_repeat                (ClutterActor               *self);
 
+void                            clutter_actor_set_lod_threshold                 (ClutterActor               *self,
+                                                                                 gfloat                      threshold);
+gfloat                          clutter_actor_get_lod_threshold                 (ClutterActor               *self);
+void                            clutter_actor_set_lod_placeholder               (ClutterActor               *self,
+                                                                                 ClutterContent             *placeholder);
+ClutterContent *                clutter_actor_get_lod_placeholder               (ClutterActor               *self);
+
 void                            clutter_actor_get_content_box                   (ClutterActor               *self,
                                                                                  ClutterActorBox            *box);
 
@@ -550,6 +589,9 @@ ClutterTextDirection            clutter_actor_get_text_direction
 
 void                            clutter_actor_add_child                         (ClutterActor               *self,
                                                                                  ClutterActor               *child);
+void                            clutter_actor_add_children                      (ClutterActor               *self,
+                                                                                 ClutterActor              **children,
+                                                                                 guint                       n_children);
 
 void                            clutter_actor_insert_child_at_index             (ClutterActor               *self,
                                                                                  ClutterActor               *child,
@@ -566,6 +608,9 @@ void                            clutter_actor_insert_child_below
 void                            clutter_actor_replace_child                     (ClutterActor               *self,
                                                                                  ClutterActor               *old_child,
                                                                                  ClutterActor               *new_child);
+void                            clutter_actor_replace_children                  (ClutterActor               *self,
+                                                                                 ClutterActor              **children,
+                                                                                 guint                       n_children);
 
 void                            clutter_actor_remove_child                      (ClutterActor               *self,
                                                                                  ClutterActor               *child);
@@ -574,6 +619,12 @@ void                            clutter_actor_remove_all_children
 
 void                            clutter_actor_destroy_all_children              (ClutterActor               *self);
 
+void                            clutter_actor_bind_model                        (ClutterActor               *self,
+                                                                                 ClutterModel               *model,
+                                                                                 ClutterActorCreateChildFunc create_child_func,
+                                                                                 gpointer                    user_data,
+                                                                                 GDestroyNotify              notify);
+
 GList *                         clutter_actor_get_children                      (ClutterActor               *self);
 
 gint                            clutter_actor_get_n_children                    (ClutterActor               *self);
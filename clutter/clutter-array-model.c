@@ -0,0 +1,2019 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:clutter-array-model
+ * @short_description: Array model implementation
+ *
+ * #ClutterArrayModel is a #ClutterModel implementation provided by
+ * Clutter. #ClutterArrayModel stores the values of each column inside
+ * a single contiguous array, so it's optimized for large models that
+ * are mostly appended to and accessed by row index.
+ *
+ * Columns of type %G_TYPE_INT, %G_TYPE_FLOAT, %G_TYPE_STRING and
+ * %G_TYPE_OBJECT, or any of its sub-types, are stored in arrays of the
+ * corresponding C type instead of #GValue<!-- -->s; strings are interned
+ * using g_intern_string(), so they should be used for values that repeat
+ * across the rows, like names and categories. The values of these columns
+ * can be read without copying them into a #GValue using typed accessors
+ * like clutter_array_model_iter_get_int(), or for all the rows at once
+ * using accessors like clutter_array_model_get_int_column(), which are
+ * useful when sorting or filtering large models.
+ *
+ * Large models can also be sorted and filtered without blocking the
+ * main loop, using clutter_array_model_sort_async() and
+ * clutter_array_model_filter_async() with functions that can be called
+ * from other threads.
+ *
+ * When a filter is set on a #ClutterArrayModel, the model keeps the
+ * index of every row matching the filter, and updates it as rows get
+ * added, changed and removed; this allows retrieving a row, and
+ * iterating over the filtered model, without calling the filter
+ * function on the rows that do not match it.
+ *
+ * Unlike #ClutterListModel, inserting or removing a row in the middle
+ * of a #ClutterArrayModel will move all the following rows, and will
+ * invalidate every iterator pointing to them.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib-object.h>
+
+#include "clutter-array-model.h"
+#include "clutter-main.h"
+#include "clutter-model.h"
+#include "clutter-model-private.h"
+#include "clutter-private.h"
+#include "clutter-debug.h"
+
+#define CLUTTER_TYPE_ARRAY_MODEL_ITER                \
+        (clutter_array_model_iter_get_type())
+#define CLUTTER_ARRAY_MODEL_ITER(obj)                \
+        (G_TYPE_CHECK_INSTANCE_CAST((obj),           \
+         CLUTTER_TYPE_ARRAY_MODEL_ITER,              \
+         ClutterArrayModelIter))
+#define CLUTTER_IS_ARRAY_MODEL_ITER(obj)             \
+        (G_TYPE_CHECK_INSTANCE_TYPE((obj),           \
+         CLUTTER_TYPE_ARRAY_MODEL_ITER))
+
+typedef struct _ClutterArrayModelIter   ClutterArrayModelIter;
+typedef struct _ClutterModelIterClass   ClutterArrayModelIterClass;
+
+#define CLUTTER_ARRAY_MODEL_GET_PRIVATE(obj)    (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_ARRAY_MODEL, ClutterArrayModelPrivate))
+
+typedef enum {
+  COLUMN_INT,
+  COLUMN_FLOAT,
+  COLUMN_STRING,
+  COLUMN_OBJECT,
+  COLUMN_VALUE
+} ColumnKind;
+
+typedef struct {
+  ColumnKind kind;
+  GType gtype;
+
+  /* one cell per row; gint32 for COLUMN_INT, gfloat for COLUMN_FLOAT,
+   * interned strings for COLUMN_STRING, owned references for
+   * COLUMN_OBJECT and GValues for everything else
+   */
+  GArray *cells;
+} ArrayColumn;
+
+typedef struct _ArrayModelJob ArrayModelJob;
+
+struct _ClutterArrayModelPrivate
+{
+  /* the storage of each column, allocated on the first insertion */
+  ArrayColumn *columns;
+
+  guint n_rows;
+  guint n_columns;
+
+  /* the positions inside the storage of the rows matching the
+   * filter, in ascending order; the filtered row N is the storage
+   * row at filter_rows[N]
+   */
+  GArray *filter_rows;
+  guint filter_stamp;
+
+  ClutterModelIter *temp_iter;
+
+  /* changes every time the rows are modified, so that the results of
+   * the sorting and filtering jobs can be discarded if they are stale
+   */
+  guint generation;
+
+  ArrayModelJob *sort_job;
+  ArrayModelJob *filter_job;
+
+  guint filter_valid : 1;
+};
+
+struct _ClutterArrayModelIter
+{
+  ClutterModelIter parent_instance;
+
+  /* the position of the row inside the storage; a position equal to
+   * the number of rows is the end of the model
+   */
+  guint index;
+};
+
+GType clutter_array_model_iter_get_type (void);
+
+static void clutter_array_model_update_filter_row (ClutterArrayModel *model,
+                                                   ClutterModelIter  *iter);
+
+static void
+array_column_init (ArrayColumn *column,
+                   GType        gtype)
+{
+  guint element_size;
+
+  column->gtype = gtype;
+
+  if (gtype == G_TYPE_INT)
+    {
+      column->kind = COLUMN_INT;
+      element_size = sizeof (gint32);
+    }
+  else if (gtype == G_TYPE_FLOAT)
+    {
+      column->kind = COLUMN_FLOAT;
+      element_size = sizeof (gfloat);
+    }
+  else if (gtype == G_TYPE_STRING)
+    {
+      column->kind = COLUMN_STRING;
+      element_size = sizeof (const gchar *);
+    }
+  else if (g_type_is_a (gtype, G_TYPE_OBJECT))
+    {
+      column->kind = COLUMN_OBJECT;
+      element_size = sizeof (gpointer);
+    }
+  else
+    {
+      column->kind = COLUMN_VALUE;
+      element_size = sizeof (GValue);
+    }
+
+  column->cells = g_array_new (FALSE, TRUE, element_size);
+}
+
+/* releases the contents of a cell, without removing it */
+static void
+array_column_clear_cell (ArrayColumn *column,
+                         guint        index_)
+{
+  switch (column->kind)
+    {
+    case COLUMN_OBJECT:
+      {
+        gpointer *cell = &g_array_index (column->cells, gpointer, index_);
+
+        if (*cell != NULL)
+          {
+            g_object_unref (*cell);
+            *cell = NULL;
+          }
+      }
+      break;
+
+    case COLUMN_VALUE:
+      g_value_unset (&g_array_index (column->cells, GValue, index_));
+      break;
+
+    default:
+      break;
+    }
+}
+
+/* returns a GValue holding the contents of a cell; @scratch is used for
+ * the typed columns, and must be unset if it has been initialized
+ */
+static const GValue *
+array_column_peek_value (ArrayColumn *column,
+                         guint        index_,
+                         GValue      *scratch)
+{
+  GArray *cells = column->cells;
+
+  if (column->kind == COLUMN_VALUE)
+    return &g_array_index (cells, GValue, index_);
+
+  g_value_init (scratch, column->gtype);
+
+  switch (column->kind)
+    {
+    case COLUMN_INT:
+      g_value_set_int (scratch, g_array_index (cells, gint32, index_));
+      break;
+
+    case COLUMN_FLOAT:
+      g_value_set_float (scratch, g_array_index (cells, gfloat, index_));
+      break;
+
+    case COLUMN_STRING:
+      /* interned strings are never freed, so we don't need a copy */
+      g_value_set_static_string (scratch,
+                                 g_array_index (cells, const gchar *, index_));
+      break;
+
+    case COLUMN_OBJECT:
+      g_value_set_object (scratch, g_array_index (cells, gpointer, index_));
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  return scratch;
+}
+
+/* copies the contents of a cell into @key, which must be unset */
+static void
+array_column_get_key (ArrayColumn *column,
+                      guint        index_,
+                      GValue      *key)
+{
+  const GValue *value;
+
+  value = array_column_peek_value (column, index_, key);
+  if (value != key)
+    {
+      g_value_init (key, column->gtype);
+      g_value_copy (value, key);
+    }
+}
+
+/* stores @value, which must hold the type of the column, in a cell */
+static void
+array_column_set_value (ArrayColumn  *column,
+                        guint         index_,
+                        const GValue *value)
+{
+  GArray *cells = column->cells;
+
+  switch (column->kind)
+    {
+    case COLUMN_INT:
+      g_array_index (cells, gint32, index_) = g_value_get_int (value);
+      break;
+
+    case COLUMN_FLOAT:
+      g_array_index (cells, gfloat, index_) = g_value_get_float (value);
+      break;
+
+    case COLUMN_STRING:
+      g_array_index (cells, const gchar *, index_) =
+        g_intern_string (g_value_get_string (value));
+      break;
+
+    case COLUMN_OBJECT:
+      {
+        gpointer object = g_value_dup_object (value);
+
+        array_column_clear_cell (column, index_);
+        g_array_index (cells, gpointer, index_) = object;
+      }
+      break;
+
+    case COLUMN_VALUE:
+      g_value_copy (value, &g_array_index (cells, GValue, index_));
+      break;
+    }
+}
+
+static ArrayColumn *
+clutter_array_model_get_column (ClutterArrayModel *model,
+                                guint              column,
+                                ColumnKind         kind)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+
+  if (priv->columns == NULL || column >= priv->n_columns)
+    return NULL;
+
+  if (priv->columns[column].kind != kind)
+    {
+      g_warning ("%s: The column %u of the model is of type '%s'",
+                 G_STRLOC, column,
+                 g_type_name (priv->columns[column].gtype));
+      return NULL;
+    }
+
+  return &priv->columns[column];
+}
+
+/* returns the position of the first entry in the filtered rows index
+ * that is greater than or equal to @index_
+ */
+static guint
+clutter_array_model_filter_lower_bound (ClutterArrayModel *model,
+                                        guint              index_)
+{
+  GArray *filter_rows = model->priv->filter_rows;
+  guint low = 0, high = filter_rows->len;
+
+  while (low < high)
+    {
+      guint mid = low + (high - low) / 2;
+
+      if (g_array_index (filter_rows, guint, mid) < index_)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+  return low;
+}
+
+static gboolean
+clutter_array_model_filter_index (ClutterArrayModel *model,
+                                  guint              index_,
+                                  guint              row)
+{
+  ClutterModelIter *temp_iter = model->priv->temp_iter;
+
+  CLUTTER_ARRAY_MODEL_ITER (temp_iter)->index = index_;
+  _clutter_model_iter_set_row (temp_iter, row);
+
+  return clutter_model_filter_iter (CLUTTER_MODEL (model), temp_iter);
+}
+
+/* whether the filtered rows index is in sync with the filter set
+ * on the model
+ */
+static gboolean
+clutter_array_model_filter_is_valid (ClutterArrayModel *model)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+
+  if (!priv->filter_valid)
+    return FALSE;
+
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)) ||
+      priv->filter_stamp != _clutter_model_get_filter_stamp (CLUTTER_MODEL (model)))
+    {
+      priv->filter_valid = FALSE;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+clutter_array_model_ensure_filter (ClutterArrayModel *model)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+  guint i;
+
+  if (clutter_array_model_filter_is_valid (model))
+    return;
+
+  g_array_set_size (priv->filter_rows, 0);
+
+  /* we mark the index as valid before building it, in case the filter
+   * function queries the model; it will see the rows filtered so far
+   */
+  priv->filter_stamp = _clutter_model_get_filter_stamp (CLUTTER_MODEL (model));
+  priv->filter_valid = TRUE;
+
+  for (i = 0; i < priv->n_rows; i++)
+    {
+      if (clutter_array_model_filter_index (model, i, priv->filter_rows->len))
+        g_array_append_val (priv->filter_rows, i);
+    }
+
+  CLUTTER_NOTE (MISC, "Filtered %u rows out of %u",
+                priv->filter_rows->len,
+                priv->n_rows);
+}
+
+static guint
+clutter_array_model_get_n_visible (ClutterArrayModel *model)
+{
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    return model->priv->n_rows;
+
+  clutter_array_model_ensure_filter (model);
+
+  return model->priv->filter_rows->len;
+}
+
+/* maps a row of the filtered model to its position inside the storage */
+static guint
+clutter_array_model_row_to_index (ClutterArrayModel *model,
+                                  guint              row)
+{
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    return row;
+
+  clutter_array_model_ensure_filter (model);
+
+  return g_array_index (model->priv->filter_rows, guint, row);
+}
+
+/*
+ * ClutterArrayModelIter
+ */
+
+G_DEFINE_TYPE (ClutterArrayModelIter,
+               clutter_array_model_iter,
+               CLUTTER_TYPE_MODEL_ITER);
+
+static void
+clutter_array_model_iter_get_value (ClutterModelIter *iter,
+                                    guint             column,
+                                    GValue           *value)
+{
+  ClutterArrayModelIter *iter_array = CLUTTER_ARRAY_MODEL_ITER (iter);
+  ClutterModel *model = clutter_model_iter_get_model (iter);
+  ClutterArrayModelPrivate *priv = CLUTTER_ARRAY_MODEL (model)->priv;
+  const GValue *iter_value;
+  GValue scratch = G_VALUE_INIT;
+  GValue real_value = G_VALUE_INIT;
+  gboolean converted = FALSE;
+
+  g_assert (iter_array->index < priv->n_rows);
+
+  iter_value = array_column_peek_value (&priv->columns[column],
+                                        iter_array->index,
+                                        &scratch);
+
+  if (!g_type_is_a (G_VALUE_TYPE (value), G_VALUE_TYPE (iter_value)))
+    {
+      if (!g_value_type_compatible (G_VALUE_TYPE (value),
+                                    G_VALUE_TYPE (iter_value)) &&
+          !g_value_type_compatible (G_VALUE_TYPE (iter_value),
+                                    G_VALUE_TYPE (value)))
+        {
+          g_warning ("%s: Unable to convert from %s to %s",
+                     G_STRLOC,
+                     g_type_name (G_VALUE_TYPE (value)),
+                     g_type_name (G_VALUE_TYPE (iter_value)));
+          goto out;
+        }
+
+      g_value_init (&real_value, G_VALUE_TYPE (value));
+
+      if (!g_value_transform (iter_value, &real_value))
+        {
+          g_warning ("%s: Unable to make conversion from %s to %s",
+                     G_STRLOC,
+                     g_type_name (G_VALUE_TYPE (value)),
+                     g_type_name (G_VALUE_TYPE (iter_value)));
+          g_value_unset (&real_value);
+          goto out;
+        }
+
+      converted = TRUE;
+    }
+
+  if (converted)
+    {
+      g_value_copy (&real_value, value);
+      g_value_unset (&real_value);
+    }
+  else
+    g_value_copy (iter_value, value);
+
+out:
+  if (G_IS_VALUE (&scratch))
+    g_value_unset (&scratch);
+}
+
+static void
+clutter_array_model_iter_set_value (ClutterModelIter *iter,
+                                    guint             column,
+                                    const GValue     *value)
+{
+  ClutterArrayModelIter *iter_array = CLUTTER_ARRAY_MODEL_ITER (iter);
+  ClutterModel *model = clutter_model_iter_get_model (iter);
+  ClutterArrayModelPrivate *priv = CLUTTER_ARRAY_MODEL (model)->priv;
+  ArrayColumn *array_column;
+  GValue real_value = G_VALUE_INIT;
+  gboolean converted = FALSE;
+
+  g_assert (iter_array->index < priv->n_rows);
+
+  array_column = &priv->columns[column];
+
+  if (!g_type_is_a (G_VALUE_TYPE (value), array_column->gtype))
+    {
+      if (!g_value_type_compatible (G_VALUE_TYPE (value),
+                                    array_column->gtype) &&
+          !g_value_type_compatible (array_column->gtype,
+                                    G_VALUE_TYPE (value)))
+        {
+          g_warning ("%s: Unable to convert from %s to %s",
+                     G_STRLOC,
+                     g_type_name (G_VALUE_TYPE (value)),
+                     g_type_name (array_column->gtype));
+          return;
+        }
+
+      g_value_init (&real_value, array_column->gtype);
+
+      if (!g_value_transform (value, &real_value))
+        {
+          g_warning ("%s: Unable to make conversion from %s to %s",
+                     G_STRLOC,
+                     g_type_name (G_VALUE_TYPE (value)),
+                     g_type_name (array_column->gtype));
+          g_value_unset (&real_value);
+          return;
+        }
+
+      converted = TRUE;
+    }
+
+  if (converted)
+    {
+      array_column_set_value (array_column, iter_array->index, &real_value);
+      g_value_unset (&real_value);
+    }
+  else
+    array_column_set_value (array_column, iter_array->index, value);
+
+  priv->generation += 1;
+
+  clutter_array_model_update_filter_row (CLUTTER_ARRAY_MODEL (model), iter);
+}
+
+static gboolean
+clutter_array_model_iter_is_first (ClutterModelIter *iter)
+{
+  return clutter_model_iter_get_row (iter) == 0;
+}
+
+static gboolean
+clutter_array_model_iter_is_last (ClutterModelIter *iter)
+{
+  ClutterModel *model = clutter_model_iter_get_model (iter);
+  guint n_visible;
+
+  n_visible = clutter_array_model_get_n_visible (CLUTTER_ARRAY_MODEL (model));
+
+  return clutter_model_iter_get_row (iter) >= n_visible;
+}
+
+static ClutterModelIter *
+clutter_array_model_iter_next (ClutterModelIter *iter)
+{
+  ClutterArrayModelIter *iter_array = CLUTTER_ARRAY_MODEL_ITER (iter);
+  ClutterArrayModel *model;
+  guint row, n_visible;
+
+  model = CLUTTER_ARRAY_MODEL (clutter_model_iter_get_model (iter));
+  row = clutter_model_iter_get_row (iter) + 1;
+
+  n_visible = clutter_array_model_get_n_visible (model);
+  if (row < n_visible)
+    iter_array->index = clutter_array_model_row_to_index (model, row);
+  else
+    {
+      row = n_visible;
+      iter_array->index = model->priv->n_rows;
+    }
+
+  _clutter_model_iter_set_row (iter, row);
+
+  return iter;
+}
+
+static ClutterModelIter *
+clutter_array_model_iter_prev (ClutterModelIter *iter)
+{
+  ClutterArrayModelIter *iter_array = CLUTTER_ARRAY_MODEL_ITER (iter);
+  ClutterArrayModel *model;
+  guint row, n_visible;
+
+  model = CLUTTER_ARRAY_MODEL (clutter_model_iter_get_model (iter));
+  row = clutter_model_iter_get_row (iter);
+
+  n_visible = clutter_array_model_get_n_visible (model);
+  if (n_visible == 0)
+    return iter;
+
+  if (row > 0)
+    row -= 1;
+
+  row = MIN (row, n_visible - 1);
+
+  iter_array->index = clutter_array_model_row_to_index (model, row);
+  _clutter_model_iter_set_row (iter, row);
+
+  return iter;
+}
+
+static ClutterModelIter *
+clutter_array_model_iter_copy (ClutterModelIter *iter)
+{
+  ClutterArrayModelIter *iter_copy;
+
+  iter_copy = g_object_new (CLUTTER_TYPE_ARRAY_MODEL_ITER,
+                            "model", clutter_model_iter_get_model (iter),
+                            "row", clutter_model_iter_get_row (iter),
+                            NULL);
+
+  iter_copy->index = CLUTTER_ARRAY_MODEL_ITER (iter)->index;
+
+  return CLUTTER_MODEL_ITER (iter_copy);
+}
+
+static void
+clutter_array_model_iter_class_init (ClutterArrayModelIterClass *klass)
+{
+  ClutterModelIterClass *iter_class = CLUTTER_MODEL_ITER_CLASS (klass);
+
+  iter_class->get_value = clutter_array_model_iter_get_value;
+  iter_class->set_value = clutter_array_model_iter_set_value;
+  iter_class->is_first  = clutter_array_model_iter_is_first;
+  iter_class->is_last   = clutter_array_model_iter_is_last;
+  iter_class->next      = clutter_array_model_iter_next;
+  iter_class->prev      = clutter_array_model_iter_prev;
+  iter_class->copy      = clutter_array_model_iter_copy;
+}
+
+static void
+clutter_array_model_iter_init (ClutterArrayModelIter *iter)
+{
+  iter->index = 0;
+}
+
+/*
+ * ClutterArrayModel
+ */
+
+G_DEFINE_TYPE (ClutterArrayModel, clutter_array_model, CLUTTER_TYPE_MODEL);
+
+/* updates the filtered rows index after the values of the row pointed
+ * by @iter have changed
+ */
+static void
+clutter_array_model_update_filter_row (ClutterArrayModel *model,
+                                       ClutterModelIter  *iter)
+{
+  GArray *filter_rows = model->priv->filter_rows;
+  guint index_ = CLUTTER_ARRAY_MODEL_ITER (iter)->index;
+  gboolean is_visible, was_visible;
+  guint pos;
+
+  if (!clutter_array_model_filter_is_valid (model))
+    return;
+
+  pos = clutter_array_model_filter_lower_bound (model, index_);
+  was_visible = pos < filter_rows->len &&
+                g_array_index (filter_rows, guint, pos) == index_;
+
+  is_visible = clutter_array_model_filter_index (model, index_, pos);
+
+  if (is_visible && !was_visible)
+    g_array_insert_val (filter_rows, pos, index_);
+  else if (!is_visible && was_visible)
+    g_array_remove_index (filter_rows, pos);
+
+  _clutter_model_iter_set_row (iter, pos);
+}
+
+static ClutterModelIter *
+clutter_array_model_get_iter_at_row (ClutterModel *model,
+                                     guint         row)
+{
+  ClutterArrayModel *array_model = CLUTTER_ARRAY_MODEL (model);
+  ClutterArrayModelIter *retval;
+
+  if (row >= clutter_array_model_get_n_visible (array_model))
+    return NULL;
+
+  retval = g_object_new (CLUTTER_TYPE_ARRAY_MODEL_ITER,
+                         "model", model,
+                         "row", row,
+                         NULL);
+  retval->index = clutter_array_model_row_to_index (array_model, row);
+
+  return CLUTTER_MODEL_ITER (retval);
+}
+
+static ClutterModelIter *
+clutter_array_model_insert_row (ClutterModel *model,
+                                gint          index_)
+{
+  ClutterArrayModel *array_model = CLUTTER_ARRAY_MODEL (model);
+  ClutterArrayModelPrivate *priv = array_model->priv;
+  ClutterArrayModelIter *retval;
+  GValue empty = G_VALUE_INIT;
+  guint i, pos, row;
+
+  if (priv->columns == NULL)
+    {
+      priv->n_columns = clutter_model_get_n_columns (model);
+      priv->columns = g_new0 (ArrayColumn, priv->n_columns);
+
+      for (i = 0; i < priv->n_columns; i++)
+        array_column_init (&priv->columns[i],
+                           clutter_model_get_column_type (model, i));
+    }
+
+  if (index_ < 0 || (guint) index_ > priv->n_rows)
+    pos = priv->n_rows;
+  else
+    pos = index_;
+
+  /* a zeroed GValue is large enough to be used as the empty cell
+   * of every column
+   */
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      ArrayColumn *column = &priv->columns[i];
+
+      g_array_insert_vals (column->cells, pos, &empty, 1);
+
+      if (column->kind == COLUMN_VALUE)
+        g_value_init (&g_array_index (column->cells, GValue, pos),
+                      column->gtype);
+    }
+
+  priv->n_rows += 1;
+  priv->generation += 1;
+
+  row = pos;
+
+  /* the new row is added to the filtered rows index once its values
+   * have been set; we only need to shift the following rows
+   */
+  if (clutter_array_model_filter_is_valid (array_model))
+    {
+      row = clutter_array_model_filter_lower_bound (array_model, pos);
+
+      for (i = row; i < priv->filter_rows->len; i++)
+        g_array_index (priv->filter_rows, guint, i) += 1;
+    }
+
+  retval = g_object_new (CLUTTER_TYPE_ARRAY_MODEL_ITER,
+                         "model", model,
+                         "row", row,
+                         NULL);
+  retval->index = pos;
+
+  return CLUTTER_MODEL_ITER (retval);
+}
+
+static void
+clutter_array_model_remove_row (ClutterModel *model,
+                                guint         row)
+{
+  ClutterArrayModel *array_model = CLUTTER_ARRAY_MODEL (model);
+  ClutterModelIter *iter;
+
+  if (row >= clutter_array_model_get_n_visible (array_model))
+    return;
+
+  iter = g_object_new (CLUTTER_TYPE_ARRAY_MODEL_ITER,
+                       "model", model,
+                       "row", row,
+                       NULL);
+  CLUTTER_ARRAY_MODEL_ITER (iter)->index =
+    clutter_array_model_row_to_index (array_model, row);
+
+  /* the actual row is removed from the storage inside the
+   * ::row-removed signal class handler, so that every handler
+   * connected to ::row-removed will still get a valid iterator
+   */
+  g_signal_emit_by_name (model, "row-removed", iter);
+
+  g_object_unref (iter);
+}
+
+static void
+clutter_array_model_row_removed (ClutterModel     *model,
+                                 ClutterModelIter *iter)
+{
+  ClutterArrayModel *array_model = CLUTTER_ARRAY_MODEL (model);
+  ClutterArrayModelPrivate *priv = array_model->priv;
+  ClutterArrayModelIter *iter_array = CLUTTER_ARRAY_MODEL_ITER (iter);
+  guint i, pos;
+
+  g_assert (iter_array->index < priv->n_rows);
+
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      array_column_clear_cell (&priv->columns[i], iter_array->index);
+      g_array_remove_index (priv->columns[i].cells, iter_array->index);
+    }
+
+  priv->n_rows -= 1;
+  priv->generation += 1;
+
+  if (clutter_array_model_filter_is_valid (array_model))
+    {
+      GArray *filter_rows = priv->filter_rows;
+
+      pos = clutter_array_model_filter_lower_bound (array_model,
+                                                    iter_array->index);
+      if (pos < filter_rows->len &&
+          g_array_index (filter_rows, guint, pos) == iter_array->index)
+        g_array_remove_index (filter_rows, pos);
+
+      for (i = pos; i < filter_rows->len; i++)
+        g_array_index (filter_rows, guint, i) -= 1;
+    }
+
+  iter_array->index = priv->n_rows;
+}
+
+typedef struct
+{
+  ClutterModel *model;
+  GValue *keys;
+  ClutterModelSortFunc func;
+  gpointer data;
+} SortClosure;
+
+static gint
+sort_model_array (gconstpointer a,
+                  gconstpointer b,
+                  gpointer      data)
+{
+  guint row_a = *((const guint *) a);
+  guint row_b = *((const guint *) b);
+  SortClosure *clos = data;
+
+  return clos->func (clos->model,
+                     &clos->keys[row_a],
+                     &clos->keys[row_b],
+                     clos->data);
+}
+
+/* moves the rows of the model so that the row at order[N] becomes
+ * the row N
+ */
+static void
+clutter_array_model_apply_order (ClutterArrayModel *model,
+                                 const guint       *order)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+  guint i, j;
+
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      GArray *old_cells = priv->columns[i].cells;
+      guint element_size = g_array_get_element_size (old_cells);
+      GArray *new_cells;
+
+      new_cells = g_array_sized_new (FALSE, TRUE, element_size, priv->n_rows);
+      g_array_set_size (new_cells, priv->n_rows);
+
+      /* the cells are moved, so their contents are not released */
+      for (j = 0; j < priv->n_rows; j++)
+        memcpy (new_cells->data + j * element_size,
+                old_cells->data + order[j] * element_size,
+                element_size);
+
+      g_array_free (old_cells, TRUE);
+      priv->columns[i].cells = new_cells;
+    }
+
+  /* the filtered rows move with the rows, without calling the filter */
+  if (clutter_array_model_filter_is_valid (model))
+    {
+      GArray *filter_rows = priv->filter_rows;
+      guint8 *visible = g_new0 (guint8, priv->n_rows);
+
+      for (i = 0; i < filter_rows->len; i++)
+        visible[g_array_index (filter_rows, guint, i)] = TRUE;
+
+      g_array_set_size (filter_rows, 0);
+
+      for (i = 0; i < priv->n_rows; i++)
+        {
+          if (visible[order[i]])
+            g_array_append_val (filter_rows, i);
+        }
+
+      g_free (visible);
+    }
+
+  priv->generation += 1;
+}
+
+static void
+clutter_array_model_resort (ClutterModel         *model,
+                            ClutterModelSortFunc  func,
+                            gpointer              data)
+{
+  ClutterArrayModelPrivate *priv = CLUTTER_ARRAY_MODEL (model)->priv;
+  SortClosure sort_closure = { NULL, NULL, NULL, NULL };
+  ArrayColumn *sort_column;
+  guint *order;
+  guint i;
+
+  if (func == NULL || priv->n_rows < 2)
+    return;
+
+  sort_column = &priv->columns[clutter_model_get_sorting_column (model)];
+
+  /* we collect the values of the sorting column once, and sort the
+   * positions of the rows using them; then we move the cells of each
+   * column in the sorted order
+   */
+  sort_closure.model = model;
+  sort_closure.keys  = g_new0 (GValue, priv->n_rows);
+  sort_closure.func  = func;
+  sort_closure.data  = data;
+
+  order = g_new (guint, priv->n_rows);
+
+  for (i = 0; i < priv->n_rows; i++)
+    {
+      array_column_get_key (sort_column, i, &sort_closure.keys[i]);
+      order[i] = i;
+    }
+
+  g_qsort_with_data (order, priv->n_rows, sizeof (guint),
+                     sort_model_array,
+                     &sort_closure);
+
+  clutter_array_model_apply_order (CLUTTER_ARRAY_MODEL (model), order);
+
+  for (i = 0; i < priv->n_rows; i++)
+    g_value_unset (&sort_closure.keys[i]);
+
+  g_free (sort_closure.keys);
+  g_free (order);
+}
+
+static void
+clutter_array_model_resort_row (ClutterModel         *model,
+                                ClutterModelIter     *iter,
+                                ClutterModelSortFunc  func,
+                                gpointer              data)
+{
+  ClutterArrayModel *array_model = CLUTTER_ARRAY_MODEL (model);
+  ClutterArrayModelPrivate *priv = array_model->priv;
+  ClutterArrayModelIter *iter_array = CLUTTER_ARRAY_MODEL_ITER (iter);
+  ArrayColumn *sort_column;
+  GValue key = G_VALUE_INIT;
+  guint index_, low, high, i;
+
+  index_ = iter_array->index;
+  g_assert (index_ < priv->n_rows);
+
+  sort_column = &priv->columns[clutter_model_get_sorting_column (model)];
+  array_column_get_key (sort_column, index_, &key);
+
+  /* binary search for the position of the row among the other rows,
+   * which are still sorted; the row goes after the rows comparing
+   * equal to it
+   */
+  low = 0;
+  high = priv->n_rows - 1;
+  while (low < high)
+    {
+      guint mid = low + (high - low) / 2;
+      GValue scratch = G_VALUE_INIT;
+      const GValue *value;
+      gint res;
+
+      value = array_column_peek_value (sort_column,
+                                       mid < index_ ? mid : mid + 1,
+                                       &scratch);
+      res = func (model, &key, value, data);
+
+      if (G_IS_VALUE (&scratch))
+        g_value_unset (&scratch);
+
+      if (res >= 0)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+  g_value_unset (&key);
+
+  if (low == index_)
+    return;
+
+  priv->generation += 1;
+
+  /* move the cells of the row in every column; the cells are at most
+   * as large as a GValue
+   */
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      GArray *cells = priv->columns[i].cells;
+      guint element_size = g_array_get_element_size (cells);
+      GValue cell;
+
+      memcpy (&cell, cells->data + index_ * element_size, element_size);
+
+      if (low < index_)
+        memmove (cells->data + (low + 1) * element_size,
+                 cells->data + low * element_size,
+                 (index_ - low) * element_size);
+      else
+        memmove (cells->data + index_ * element_size,
+                 cells->data + (index_ + 1) * element_size,
+                 (low - index_) * element_size);
+
+      memcpy (cells->data + low * element_size, &cell, element_size);
+    }
+
+  if (clutter_array_model_filter_is_valid (array_model))
+    {
+      GArray *filter_rows = priv->filter_rows;
+      gboolean is_visible;
+      guint pos;
+
+      /* remove the row from its old position... */
+      pos = clutter_array_model_filter_lower_bound (array_model, index_);
+      is_visible = pos < filter_rows->len &&
+                   g_array_index (filter_rows, guint, pos) == index_;
+      if (is_visible)
+        g_array_remove_index (filter_rows, pos);
+
+      for (i = pos; i < filter_rows->len; i++)
+        g_array_index (filter_rows, guint, i) -= 1;
+
+      /* ... and add it to the new one */
+      pos = clutter_array_model_filter_lower_bound (array_model, low);
+
+      for (i = pos; i < filter_rows->len; i++)
+        g_array_index (filter_rows, guint, i) += 1;
+
+      if (is_visible)
+        g_array_insert_val (filter_rows, pos, low);
+
+      _clutter_model_iter_set_row (iter, pos);
+    }
+  else if (!clutter_model_get_filter_set (model))
+    _clutter_model_iter_set_row (iter, low);
+
+  iter_array->index = low;
+}
+
+static guint
+clutter_array_model_get_n_rows (ClutterModel *model)
+{
+  return clutter_array_model_get_n_visible (CLUTTER_ARRAY_MODEL (model));
+}
+
+static void
+clutter_array_model_clear (ClutterModel *model)
+{
+  ClutterArrayModelPrivate *priv = CLUTTER_ARRAY_MODEL (model)->priv;
+  guint i, j;
+
+  if (priv->columns == NULL)
+    return;
+
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      for (j = 0; j < priv->n_rows; j++)
+        array_column_clear_cell (&priv->columns[i], j);
+
+      g_array_set_size (priv->columns[i].cells, 0);
+    }
+
+  priv->n_rows = 0;
+  priv->generation += 1;
+
+  /* an empty set of filtered rows is still valid */
+  g_array_set_size (priv->filter_rows, 0);
+}
+
+static void
+clutter_array_model_finalize (GObject *gobject)
+{
+  ClutterArrayModelPrivate *priv = CLUTTER_ARRAY_MODEL (gobject)->priv;
+
+  if (priv->columns != NULL)
+    {
+      guint i, j;
+
+      for (i = 0; i < priv->n_columns; i++)
+        {
+          for (j = 0; j < priv->n_rows; j++)
+            array_column_clear_cell (&priv->columns[i], j);
+
+          g_array_free (priv->columns[i].cells, TRUE);
+        }
+
+      g_free (priv->columns);
+    }
+
+  g_array_free (priv->filter_rows, TRUE);
+
+  G_OBJECT_CLASS (clutter_array_model_parent_class)->finalize (gobject);
+}
+
+static void
+clutter_array_model_dispose (GObject *gobject)
+{
+  ClutterArrayModelPrivate *priv = CLUTTER_ARRAY_MODEL (gobject)->priv;
+
+  if (priv->temp_iter != NULL)
+    {
+      g_object_unref (priv->temp_iter);
+      priv->temp_iter = NULL;
+    }
+
+  G_OBJECT_CLASS (clutter_array_model_parent_class)->dispose (gobject);
+}
+
+static void
+clutter_array_model_class_init (ClutterArrayModelClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  ClutterModelClass *model_class = CLUTTER_MODEL_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (ClutterArrayModelPrivate));
+
+  gobject_class->finalize = clutter_array_model_finalize;
+  gobject_class->dispose = clutter_array_model_dispose;
+
+  model_class->get_iter_at_row = clutter_array_model_get_iter_at_row;
+  model_class->insert_row      = clutter_array_model_insert_row;
+  model_class->remove_row      = clutter_array_model_remove_row;
+  model_class->resort          = clutter_array_model_resort;
+  model_class->resort_row      = clutter_array_model_resort_row;
+  model_class->get_n_rows      = clutter_array_model_get_n_rows;
+  model_class->clear           = clutter_array_model_clear;
+
+  model_class->row_removed     = clutter_array_model_row_removed;
+}
+
+static void
+clutter_array_model_init (ClutterArrayModel *model)
+{
+  model->priv = CLUTTER_ARRAY_MODEL_GET_PRIVATE (model);
+
+  model->priv->filter_rows = g_array_new (FALSE, FALSE, sizeof (guint));
+  model->priv->temp_iter = g_object_new (CLUTTER_TYPE_ARRAY_MODEL_ITER,
+                                         "model", model,
+                                         NULL);
+}
+
+/**
+ * clutter_array_model_new:
+ * @n_columns: number of columns in the model
+ * @...: @n_columns number of #GType and string pairs
+ *
+ * Creates a new array model with @n_columns columns with the types
+ * and names passed in.
+ *
+ * See clutter_list_model_new() for the list of arguments.
+ *
+ * Return value: a new #ClutterArrayModel
+ */
+ClutterModel *
+clutter_array_model_new (guint n_columns,
+                         ...)
+{
+  ClutterModel *model;
+  va_list args;
+  gint i;
+
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  model = g_object_new (CLUTTER_TYPE_ARRAY_MODEL, NULL);
+  _clutter_model_set_n_columns (model, n_columns, TRUE, TRUE);
+
+  va_start (args, n_columns);
+
+  for (i = 0; i < n_columns; i++)
+    {
+      GType type = va_arg (args, GType);
+      const gchar *name = va_arg (args, gchar*);
+
+      if (!_clutter_model_check_type (type))
+        {
+          g_warning ("%s: Invalid type %s\n", G_STRLOC, g_type_name (type));
+          g_object_unref (model);
+          model = NULL;
+          goto out;
+        }
+
+      _clutter_model_set_column_type (model, i, type);
+      _clutter_model_set_column_name (model, i, name);
+    }
+
+ out:
+  va_end (args);
+  return model;
+}
+
+/**
+ * clutter_array_model_newv:
+ * @n_columns: number of columns in the model
+ * @types: (array length=n_columns): an array of #GType types for the columns, from first to last
+ * @names: (array length=n_columns): an array of names for the columns, from first to last
+ *
+ * Non-vararg version of clutter_array_model_new(). This function is
+ * useful for language bindings.
+ *
+ * Return value: (transfer full): a new #ClutterArrayModel
+ */
+ClutterModel *
+clutter_array_model_newv (guint                n_columns,
+                          GType               *types,
+                          const gchar * const  names[])
+{
+  ClutterModel *model;
+  gint i;
+
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  model = g_object_new (CLUTTER_TYPE_ARRAY_MODEL, NULL);
+  _clutter_model_set_n_columns (model, n_columns, TRUE, TRUE);
+
+  for (i = 0; i < n_columns; i++)
+    {
+      if (!_clutter_model_check_type (types[i]))
+        {
+          g_warning ("%s: Invalid type %s\n", G_STRLOC, g_type_name (types[i]));
+          g_object_unref (model);
+          return NULL;
+        }
+
+      _clutter_model_set_column_type (model, i, types[i]);
+      _clutter_model_set_column_name (model, i, names[i]);
+    }
+
+  return model;
+}
+
+static ArrayColumn *
+clutter_array_model_iter_get_column (ClutterModelIter *iter,
+                                     guint             column,
+                                     ColumnKind        kind,
+                                     guint            *index_)
+{
+  ClutterArrayModel *model;
+
+  model = CLUTTER_ARRAY_MODEL (clutter_model_iter_get_model (iter));
+
+  *index_ = CLUTTER_ARRAY_MODEL_ITER (iter)->index;
+  if (*index_ >= model->priv->n_rows)
+    {
+      g_warning ("%s: The iterator does not point to a valid row",
+                 G_STRLOC);
+      return NULL;
+    }
+
+  return clutter_array_model_get_column (model, column, kind);
+}
+
+/**
+ * clutter_array_model_iter_get_int:
+ * @iter: a #ClutterModelIter of a #ClutterArrayModel
+ * @column: a column of type %G_TYPE_INT
+ *
+ * Retrieves the value of @column for the row pointed by @iter,
+ * without copying it into a #GValue.
+ *
+ * Return value: the value of the cell
+ */
+gint
+clutter_array_model_iter_get_int (ClutterModelIter *iter,
+                                  guint             column)
+{
+  ArrayColumn *array_column;
+  guint index_;
+
+  g_return_val_if_fail (CLUTTER_IS_ARRAY_MODEL_ITER (iter), 0);
+
+  array_column = clutter_array_model_iter_get_column (iter, column,
+                                                      COLUMN_INT,
+                                                      &index_);
+  if (array_column == NULL)
+    return 0;
+
+  return g_array_index (array_column->cells, gint32, index_);
+}
+
+/**
+ * clutter_array_model_iter_get_float:
+ * @iter: a #ClutterModelIter of a #ClutterArrayModel
+ * @column: a column of type %G_TYPE_FLOAT
+ *
+ * Retrieves the value of @column for the row pointed by @iter,
+ * without copying it into a #GValue.
+ *
+ * Return value: the value of the cell
+ */
+gfloat
+clutter_array_model_iter_get_float (ClutterModelIter *iter,
+                                    guint             column)
+{
+  ArrayColumn *array_column;
+  guint index_;
+
+  g_return_val_if_fail (CLUTTER_IS_ARRAY_MODEL_ITER (iter), 0.f);
+
+  array_column = clutter_array_model_iter_get_column (iter, column,
+                                                      COLUMN_FLOAT,
+                                                      &index_);
+  if (array_column == NULL)
+    return 0.f;
+
+  return g_array_index (array_column->cells, gfloat, index_);
+}
+
+/**
+ * clutter_array_model_iter_get_string:
+ * @iter: a #ClutterModelIter of a #ClutterArrayModel
+ * @column: a column of type %G_TYPE_STRING
+ *
+ * Retrieves the value of @column for the row pointed by @iter,
+ * without copying it.
+ *
+ * Return value: (transfer none): the interned string stored in the
+ *   cell, or %NULL
+ */
+const gchar *
+clutter_array_model_iter_get_string (ClutterModelIter *iter,
+                                     guint             column)
+{
+  ArrayColumn *array_column;
+  guint index_;
+
+  g_return_val_if_fail (CLUTTER_IS_ARRAY_MODEL_ITER (iter), NULL);
+
+  array_column = clutter_array_model_iter_get_column (iter, column,
+                                                      COLUMN_STRING,
+                                                      &index_);
+  if (array_column == NULL)
+    return NULL;
+
+  return g_array_index (array_column->cells, const gchar *, index_);
+}
+
+/**
+ * clutter_array_model_iter_get_object:
+ * @iter: a #ClutterModelIter of a #ClutterArrayModel
+ * @column: a column holding a #GObject type
+ *
+ * Retrieves the value of @column for the row pointed by @iter,
+ * without acquiring a reference on it.
+ *
+ * Return value: (transfer none) (type GObject.Object): the object stored
+ *   in the cell, or %NULL
+ */
+gpointer
+clutter_array_model_iter_get_object (ClutterModelIter *iter,
+                                     guint             column)
+{
+  ArrayColumn *array_column;
+  guint index_;
+
+  g_return_val_if_fail (CLUTTER_IS_ARRAY_MODEL_ITER (iter), NULL);
+
+  array_column = clutter_array_model_iter_get_column (iter, column,
+                                                      COLUMN_OBJECT,
+                                                      &index_);
+  if (array_column == NULL)
+    return NULL;
+
+  return g_array_index (array_column->cells, gpointer, index_);
+}
+
+static gconstpointer
+clutter_array_model_peek_column (ClutterArrayModel *model,
+                                 guint              column,
+                                 ColumnKind         kind,
+                                 guint             *n_rows)
+{
+  ArrayColumn *array_column;
+
+  if (n_rows != NULL)
+    *n_rows = 0;
+
+  array_column = clutter_array_model_get_column (model, column, kind);
+  if (array_column == NULL || model->priv->n_rows == 0)
+    return NULL;
+
+  if (n_rows != NULL)
+    *n_rows = model->priv->n_rows;
+
+  return array_column->cells->data;
+}
+
+/**
+ * clutter_array_model_get_int_column:
+ * @model: a #ClutterArrayModel
+ * @column: a column of type %G_TYPE_INT
+ * @n_rows: (out) (allow-none): return location for the number of
+ *   rows, or %NULL
+ *
+ * Retrieves the values of @column for all the rows of @model.
+ *
+ * The returned array contains every row of @model in the order they
+ * are stored, regardless of the filter set using clutter_model_set_filter().
+ * The array is owned by @model, and it is only valid until the next
+ * time @model is modified.
+ *
+ * Return value: (transfer none) (array length=n_rows): the values of
+ *   the column, or %NULL if @model is empty
+ */
+const gint32 *
+clutter_array_model_get_int_column (ClutterArrayModel *model,
+                                    guint              column,
+                                    guint             *n_rows)
+{
+  g_return_val_if_fail (CLUTTER_IS_ARRAY_MODEL (model), NULL);
+
+  return clutter_array_model_peek_column (model, column, COLUMN_INT, n_rows);
+}
+
+/**
+ * clutter_array_model_get_float_column:
+ * @model: a #ClutterArrayModel
+ * @column: a column of type %G_TYPE_FLOAT
+ * @n_rows: (out) (allow-none): return location for the number of
+ *   rows, or %NULL
+ *
+ * Retrieves the values of @column for all the rows of @model.
+ *
+ * See clutter_array_model_get_int_column() for the contents of
+ * the returned array.
+ *
+ * Return value: (transfer none) (array length=n_rows): the values of
+ *   the column, or %NULL if @model is empty
+ */
+const gfloat *
+clutter_array_model_get_float_column (ClutterArrayModel *model,
+                                      guint              column,
+                                      guint             *n_rows)
+{
+  g_return_val_if_fail (CLUTTER_IS_ARRAY_MODEL (model), NULL);
+
+  return clutter_array_model_peek_column (model, column, COLUMN_FLOAT, n_rows);
+}
+
+/**
+ * clutter_array_model_get_string_column:
+ * @model: a #ClutterArrayModel
+ * @column: a column of type %G_TYPE_STRING
+ * @n_rows: (out) (allow-none): return location for the number of
+ *   rows, or %NULL
+ *
+ * Retrieves the values of @column for all the rows of @model.
+ *
+ * The strings are interned, so they can be compared using their
+ * address. See clutter_array_model_get_int_column() for the contents
+ * of the returned array.
+ *
+ * Return value: (transfer none) (array length=n_rows): the values of
+ *   the column, or %NULL if @model is empty
+ */
+const gchar * const *
+clutter_array_model_get_string_column (ClutterArrayModel *model,
+                                       guint              column,
+                                       guint             *n_rows)
+{
+  g_return_val_if_fail (CLUTTER_IS_ARRAY_MODEL (model), NULL);
+
+  return clutter_array_model_peek_column (model, column, COLUMN_STRING, n_rows);
+}
+
+/**
+ * clutter_array_model_get_object_column:
+ * @model: a #ClutterArrayModel
+ * @column: a column holding a #GObject type
+ * @n_rows: (out) (allow-none): return location for the number of
+ *   rows, or %NULL
+ *
+ * Retrieves the values of @column for all the rows of @model.
+ *
+ * See clutter_array_model_get_int_column() for the contents of
+ * the returned array.
+ *
+ * Return value: (transfer none) (array length=n_rows): the values of
+ *   the column, or %NULL if @model is empty
+ */
+gpointer const *
+clutter_array_model_get_object_column (ClutterArrayModel *model,
+                                       guint              column,
+                                       guint             *n_rows)
+{
+  g_return_val_if_fail (CLUTTER_IS_ARRAY_MODEL (model), NULL);
+
+  return clutter_array_model_peek_column (model, column, COLUMN_OBJECT, n_rows);
+}
+
+/*
+ * Sorting and filtering in worker threads
+ */
+
+/* models smaller than this are not split between threads */
+#define JOB_MIN_CHUNK_SIZE      4096
+#define JOB_MAX_CHUNKS          4
+
+typedef enum {
+  JOB_SORT,
+  JOB_FILTER
+} JobKind;
+
+struct _ArrayModelJob
+{
+  JobKind kind;
+
+  ClutterArrayModel *model;
+  guint generation;
+  guint filter_stamp;
+
+  guint column;
+
+  /* the snapshot of the column */
+  GValue *keys;
+  guint n_keys;
+
+  ClutterArrayModelCompareFunc compare_func;
+  ClutterArrayModelMatchFunc match_func;
+  gpointer user_data;
+  GDestroyNotify notify;
+
+  /* the results: the sorted positions of the rows, or whether each
+   * row matches the filter
+   */
+  guint *order;
+  guint8 *matches;
+
+  guint chunk_size;
+  volatile gint pending_chunks;
+
+  /* only accessed from the main thread */
+  gboolean cancelled;
+};
+
+typedef struct {
+  ArrayModelJob *job;
+  guint start;
+  guint end;
+} JobChunk;
+
+typedef struct {
+  guint column;
+  ClutterArrayModelCompareFunc compare_func;
+  ClutterArrayModelMatchFunc match_func;
+  gpointer user_data;
+  GDestroyNotify notify;
+} JobClosure;
+
+static GThreadPool *array_model_pool = NULL;
+
+static void clutter_array_model_start_job (ClutterArrayModel            *model,
+                                           JobKind                       kind,
+                                           guint                         column,
+                                           ClutterArrayModelCompareFunc  compare_func,
+                                           ClutterArrayModelMatchFunc    match_func,
+                                           gpointer                      user_data,
+                                           GDestroyNotify                notify);
+
+static void
+job_closure_free (gpointer data)
+{
+  JobClosure *closure = data;
+
+  if (closure->notify != NULL)
+    closure->notify (closure->user_data);
+
+  g_slice_free (JobClosure, closure);
+}
+
+/* used by the model once a sorting job has been applied, to keep the
+ * rows that change sorted
+ */
+static gint
+job_closure_sort (ClutterModel *model,
+                  const GValue *a,
+                  const GValue *b,
+                  gpointer      data)
+{
+  JobClosure *closure = data;
+
+  return closure->compare_func (a, b, closure->user_data);
+}
+
+/* used by the model once a filtering job has been applied, to update
+ * the rows that change
+ */
+static gboolean
+job_closure_filter (ClutterModel     *model,
+                    ClutterModelIter *iter,
+                    gpointer          data)
+{
+  ClutterArrayModelPrivate *priv = CLUTTER_ARRAY_MODEL (model)->priv;
+  JobClosure *closure = data;
+  GValue scratch = G_VALUE_INIT;
+  const GValue *value;
+  gboolean res;
+
+  value = array_column_peek_value (&priv->columns[closure->column],
+                                   CLUTTER_ARRAY_MODEL_ITER (iter)->index,
+                                   &scratch);
+  res = closure->match_func (value, closure->user_data);
+
+  if (G_IS_VALUE (&scratch))
+    g_value_unset (&scratch);
+
+  return res;
+}
+
+static void
+array_model_job_free (ArrayModelJob *job)
+{
+  guint i;
+
+  for (i = 0; i < job->n_keys; i++)
+    g_value_unset (&job->keys[i]);
+
+  if (job->notify != NULL)
+    job->notify (job->user_data);
+
+  g_object_unref (job->model);
+
+  g_free (job->keys);
+  g_free (job->order);
+  g_free (job->matches);
+
+  g_slice_free (ArrayModelJob, job);
+}
+
+static gint
+array_model_job_compare (gconstpointer a,
+                         gconstpointer b,
+                         gpointer      data)
+{
+  ArrayModelJob *job = data;
+
+  return job->compare_func (&job->keys[*((const guint *) a)],
+                            &job->keys[*((const guint *) b)],
+                            job->user_data);
+}
+
+/* merges the sorted chunks of the job; runs in a worker thread */
+static void
+array_model_job_merge (ArrayModelJob *job)
+{
+  guint *src = job->order;
+  guint *dest = g_new (guint, job->n_keys);
+  guint width;
+
+  for (width = job->chunk_size; width < job->n_keys; width *= 2)
+    {
+      guint *tmp;
+      guint lo;
+
+      for (lo = 0; lo < job->n_keys; lo += 2 * width)
+        {
+          guint mid = MIN (lo + width, job->n_keys);
+          guint hi = MIN (lo + 2 * width, job->n_keys);
+          guint i = lo, j = mid, k = lo;
+
+          /* taking from the left run on ties keeps the sort stable */
+          while (i < mid && j < hi)
+            {
+              if (array_model_job_compare (&src[j], &src[i], job) < 0)
+                dest[k++] = src[j++];
+              else
+                dest[k++] = src[i++];
+            }
+
+          while (i < mid)
+            dest[k++] = src[i++];
+
+          while (j < hi)
+            dest[k++] = src[j++];
+        }
+
+      tmp = src;
+      src = dest;
+      dest = tmp;
+    }
+
+  job->order = src;
+  g_free (dest);
+}
+
+/* runs in the main thread, once all the chunks of the job are done */
+static gboolean
+array_model_job_done (gpointer data)
+{
+  ArrayModelJob *job = data;
+  ClutterArrayModel *model = job->model;
+  ClutterArrayModelPrivate *priv = model->priv;
+  JobClosure *closure;
+  guint i;
+
+  if (job->kind == JOB_SORT)
+    {
+      g_assert (priv->sort_job == job);
+      priv->sort_job = NULL;
+    }
+  else
+    {
+      g_assert (priv->filter_job == job);
+      priv->filter_job = NULL;
+    }
+
+  if (job->cancelled)
+    goto out;
+
+  /* a filter set with clutter_model_set_filter() while the job was
+   * running replaces the one of the job
+   */
+  if (job->kind == JOB_FILTER &&
+      job->filter_stamp != _clutter_model_get_filter_stamp (CLUTTER_MODEL (model)))
+    goto out;
+
+  /* the model changed while the job was running, so we need to run
+   * it again using the current rows
+   */
+  if (job->generation != priv->generation)
+    {
+      clutter_array_model_start_job (model, job->kind, job->column,
+                                     job->compare_func,
+                                     job->match_func,
+                                     job->user_data,
+                                     job->notify);
+      job->notify = NULL;
+      goto out;
+    }
+
+  /* the model will call the function in the main thread for the rows
+   * that change from now on
+   */
+  closure = g_slice_new (JobClosure);
+  closure->column = job->column;
+  closure->compare_func = job->compare_func;
+  closure->match_func = job->match_func;
+  closure->user_data = job->user_data;
+  closure->notify = job->notify;
+  job->notify = NULL;
+
+  if (job->kind == JOB_SORT)
+    {
+      if (job->n_keys > 1)
+        clutter_array_model_apply_order (model, job->order);
+
+      _clutter_model_set_sort_func (CLUTTER_MODEL (model), job->column,
+                                    job_closure_sort,
+                                    closure,
+                                    job_closure_free);
+
+      g_signal_emit_by_name (model, "sort-changed");
+    }
+  else
+    {
+      _clutter_model_set_filter_func (CLUTTER_MODEL (model),
+                                      job_closure_filter,
+                                      closure,
+                                      job_closure_free);
+
+      g_array_set_size (priv->filter_rows, 0);
+      for (i = 0; i < job->n_keys; i++)
+        {
+          if (job->matches[i])
+            g_array_append_val (priv->filter_rows, i);
+        }
+
+      priv->filter_stamp = _clutter_model_get_filter_stamp (CLUTTER_MODEL (model));
+      priv->filter_valid = TRUE;
+
+      g_signal_emit_by_name (model, "filter-changed");
+      g_object_notify (G_OBJECT (model), "filter-set");
+    }
+
+out:
+  array_model_job_free (job);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* runs in a worker thread */
+static void
+array_model_job_chunk_run (gpointer data,
+                           gpointer user_data)
+{
+  JobChunk *chunk = data;
+  ArrayModelJob *job = chunk->job;
+  guint i;
+
+  if (job->kind == JOB_SORT)
+    g_qsort_with_data (job->order + chunk->start,
+                       chunk->end - chunk->start,
+                       sizeof (guint),
+                       array_model_job_compare,
+                       job);
+  else
+    {
+      for (i = chunk->start; i < chunk->end; i++)
+        job->matches[i] = job->match_func (&job->keys[i], job->user_data);
+    }
+
+  g_slice_free (JobChunk, chunk);
+
+  if (!g_atomic_int_dec_and_test (&job->pending_chunks))
+    return;
+
+  /* the last chunk to finish merges the results */
+  if (job->kind == JOB_SORT)
+    array_model_job_merge (job);
+
+  clutter_threads_add_idle_full (G_PRIORITY_DEFAULT,
+                                 array_model_job_done,
+                                 job,
+                                 NULL);
+}
+
+static void
+clutter_array_model_start_job (ClutterArrayModel            *model,
+                               JobKind                       kind,
+                               guint                         column,
+                               ClutterArrayModelCompareFunc  compare_func,
+                               ClutterArrayModelMatchFunc    match_func,
+                               gpointer                      user_data,
+                               GDestroyNotify                notify)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+  ArrayModelJob **current_job;
+  ArrayModelJob *job;
+  guint i, n_chunks;
+
+  current_job = kind == JOB_SORT ? &priv->sort_job : &priv->filter_job;
+
+  /* the results of the current job are discarded once it's done */
+  if (*current_job != NULL)
+    (*current_job)->cancelled = TRUE;
+
+  job = g_slice_new0 (ArrayModelJob);
+  job->kind = kind;
+  job->model = g_object_ref (model);
+  job->generation = priv->generation;
+  job->filter_stamp = _clutter_model_get_filter_stamp (CLUTTER_MODEL (model));
+  job->column = column;
+  job->compare_func = compare_func;
+  job->match_func = match_func;
+  job->user_data = user_data;
+  job->notify = notify;
+
+  /* the snapshot is taken in the main thread, so that the job does
+   * not access the model
+   */
+  job->n_keys = priv->n_rows;
+  job->keys = g_new0 (GValue, job->n_keys);
+  for (i = 0; i < job->n_keys; i++)
+    array_column_get_key (&priv->columns[column], i, &job->keys[i]);
+
+  if (kind == JOB_SORT)
+    {
+      job->order = g_new (guint, job->n_keys);
+      for (i = 0; i < job->n_keys; i++)
+        job->order[i] = i;
+    }
+  else
+    job->matches = g_new0 (guint8, job->n_keys);
+
+  *current_job = job;
+
+  if (job->n_keys == 0)
+    {
+      clutter_threads_add_idle_full (G_PRIORITY_DEFAULT,
+                                     array_model_job_done,
+                                     job,
+                                     NULL);
+      return;
+    }
+
+  job->chunk_size = (job->n_keys + JOB_MAX_CHUNKS - 1) / JOB_MAX_CHUNKS;
+  job->chunk_size = MAX (job->chunk_size, JOB_MIN_CHUNK_SIZE);
+
+  n_chunks = (job->n_keys + job->chunk_size - 1) / job->chunk_size;
+  job->pending_chunks = n_chunks;
+
+  if (G_UNLIKELY (array_model_pool == NULL))
+    array_model_pool = g_thread_pool_new (array_model_job_chunk_run,
+                                          NULL,
+                                          JOB_MAX_CHUNKS, FALSE,
+                                          NULL);
+
+  CLUTTER_NOTE (MISC, "Running a %s job on %u rows in %u chunks",
+                kind == JOB_SORT ? "sort" : "filter",
+                job->n_keys,
+                n_chunks);
+
+  for (i = 0; i < n_chunks; i++)
+    {
+      JobChunk *chunk = g_slice_new (JobChunk);
+
+      chunk->job = job;
+      chunk->start = i * job->chunk_size;
+      chunk->end = MIN (chunk->start + job->chunk_size, job->n_keys);
+
+      g_thread_pool_push (array_model_pool, chunk, NULL);
+    }
+}
+
+/**
+ * clutter_array_model_sort_async:
+ * @model: a #ClutterArrayModel
+ * @column: the column to sort on
+ * @func: (scope notified): a thread safe function used to compare
+ *   the values of @column
+ * @user_data: data to pass to @func
+ * @notify: destroy notifier of @user_data, or %NULL
+ *
+ * Sorts @model on @column using @func, without blocking the main loop.
+ *
+ * The values of @column are copied, and then sorted by a pool of
+ * worker threads. Once the sort is done, the rows of @model are moved
+ * to their sorted positions in the main thread, and the
+ * #ClutterModel::sort-changed signal is emitted; after that, @model
+ * behaves as if the sort was set using clutter_model_set_sort(), and
+ * @func will be called in the main thread to keep it sorted.
+ *
+ * Since @func is called from other threads, it must only access the
+ * values it receives and @user_data. If @model is changed while the
+ * sort runs, the sort will be run again.
+ */
+void
+clutter_array_model_sort_async (ClutterArrayModel            *model,
+                                guint                         column,
+                                ClutterArrayModelCompareFunc  func,
+                                gpointer                      user_data,
+                                GDestroyNotify                notify)
+{
+  g_return_if_fail (CLUTTER_IS_ARRAY_MODEL (model));
+  g_return_if_fail (column < clutter_model_get_n_columns (CLUTTER_MODEL (model)));
+  g_return_if_fail (func != NULL);
+
+  clutter_array_model_start_job (model, JOB_SORT, column,
+                                 func, NULL,
+                                 user_data, notify);
+}
+
+/**
+ * clutter_array_model_filter_async:
+ * @model: a #ClutterArrayModel
+ * @column: the column to filter on
+ * @func: (scope notified): a thread safe function deciding whether a
+ *   row should be displayed, using its value of @column
+ * @user_data: data to pass to @func
+ * @notify: destroy notifier of @user_data, or %NULL
+ *
+ * Filters @model on @column using @func, without blocking the main loop.
+ *
+ * The values of @column are copied, and then filtered by a pool of
+ * worker threads. Once the filter is done, the filtered rows are set
+ * in the main thread, and the #ClutterModel::filter-changed signal is
+ * emitted; after that, @model behaves as if the filter was set using
+ * clutter_model_set_filter(), and @func will be called in the main
+ * thread for the rows that change.
+ *
+ * Since @func is called from other threads, it must only access the
+ * value it receives and @user_data. If @model is changed while the
+ * filter runs, the filter will be run again.
+ */
+void
+clutter_array_model_filter_async (ClutterArrayModel          *model,
+                                  guint                       column,
+                                  ClutterArrayModelMatchFunc  func,
+                                  gpointer                    user_data,
+                                  GDestroyNotify              notify)
+{
+  g_return_if_fail (CLUTTER_IS_ARRAY_MODEL (model));
+  g_return_if_fail (column < clutter_model_get_n_columns (CLUTTER_MODEL (model)));
+  g_return_if_fail (func != NULL);
+
+  clutter_array_model_start_job (model, JOB_FILTER, column,
+                                 NULL, func,
+                                 user_data, notify);
+}
@@ -0,0 +1,140 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__CLUTTER_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <clutter/clutter.h> can be included directly."
+#endif
+
+#ifndef __CLUTTER_ARRAY_MODEL_H__
+#define __CLUTTER_ARRAY_MODEL_H__
+
+#include <clutter/clutter-model.h>
+
+G_BEGIN_DECLS
+
+#define CLUTTER_TYPE_ARRAY_MODEL                (clutter_array_model_get_type ())
+#define CLUTTER_ARRAY_MODEL(obj)                (G_TYPE_CHECK_INSTANCE_CAST ((obj), CLUTTER_TYPE_ARRAY_MODEL, ClutterArrayModel))
+#define CLUTTER_IS_ARRAY_MODEL(obj)             (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CLUTTER_TYPE_ARRAY_MODEL))
+#define CLUTTER_ARRAY_MODEL_CLASS(klass)        (G_TYPE_CHECK_CLASS_CAST ((klass), CLUTTER_TYPE_ARRAY_MODEL, ClutterArrayModelClass))
+#define CLUTTER_IS_ARRAY_MODEL_CLASS(klass)     (G_TYPE_CHECK_CLASS_TYPE ((klass), CLUTTER_TYPE_ARRAY_MODEL))
+#define CLUTTER_ARRAY_MODEL_GET_CLASS(obj)      (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_ARRAY_MODEL, ClutterArrayModelClass))
+
+typedef struct _ClutterArrayModel               ClutterArrayModel;
+typedef struct _ClutterArrayModelPrivate        ClutterArrayModelPrivate;
+typedef struct _ClutterArrayModelClass          ClutterArrayModelClass;
+
+/**
+ * ClutterArrayModelCompareFunc:
+ * @a: the value of the sorting column of a row
+ * @b: the value of the sorting column of another row
+ * @user_data: data passed to clutter_array_model_sort_async()
+ *
+ * Compares the values of two rows of a #ClutterArrayModel. This function
+ * can be called from threads other than the main one.
+ *
+ * Return value: a positive integer if @a is after @b, a negative integer if
+ *   @a is before @b, or 0 if the rows are the same
+ */
+typedef gint (* ClutterArrayModelCompareFunc) (const GValue *a,
+                                               const GValue *b,
+                                               gpointer      user_data);
+
+/**
+ * ClutterArrayModelMatchFunc:
+ * @value: the value of the filtering column of a row
+ * @user_data: data passed to clutter_array_model_filter_async()
+ *
+ * Filters a row of a #ClutterArrayModel using one of its values. This
+ * function can be called from threads other than the main one.
+ *
+ * Return value: %TRUE if the row should be displayed
+ */
+typedef gboolean (* ClutterArrayModelMatchFunc) (const GValue *value,
+                                                 gpointer      user_data);
+
+/**
+ * ClutterArrayModel:
+ *
+ * The #ClutterArrayModel struct contains only private data.
+ */
+struct _ClutterArrayModel
+{
+  /*< private >*/
+  ClutterModel parent_instance;
+
+  ClutterArrayModelPrivate *priv;
+};
+
+/**
+ * ClutterArrayModelClass:
+ *
+ * The #ClutterArrayModelClass struct contains only private data.
+ */
+struct _ClutterArrayModelClass
+{
+  /*< private >*/
+  ClutterModelClass parent_class;
+};
+
+GType         clutter_array_model_get_type (void) G_GNUC_CONST;
+
+ClutterModel *clutter_array_model_new      (guint                n_columns,
+                                            ...);
+ClutterModel *clutter_array_model_newv     (guint                n_columns,
+                                            GType               *types,
+                                            const gchar * const  names[]);
+
+gint                  clutter_array_model_iter_get_int          (ClutterModelIter  *iter,
+                                                                 guint              column);
+gfloat                clutter_array_model_iter_get_float        (ClutterModelIter  *iter,
+                                                                 guint              column);
+const gchar *         clutter_array_model_iter_get_string       (ClutterModelIter  *iter,
+                                                                 guint              column);
+gpointer              clutter_array_model_iter_get_object       (ClutterModelIter  *iter,
+                                                                 guint              column);
+
+const gint32 *        clutter_array_model_get_int_column        (ClutterArrayModel *model,
+                                                                 guint              column,
+                                                                 guint             *n_rows);
+const gfloat *        clutter_array_model_get_float_column      (ClutterArrayModel *model,
+                                                                 guint              column,
+                                                                 guint             *n_rows);
+const gchar * const * clutter_array_model_get_string_column     (ClutterArrayModel *model,
+                                                                 guint              column,
+                                                                 guint             *n_rows);
+gpointer const *      clutter_array_model_get_object_column     (ClutterArrayModel *model,
+                                                                 guint              column,
+                                                                 guint             *n_rows);
+
+void                  clutter_array_model_sort_async    (ClutterArrayModel            *model,
+                                                         guint                         column,
+                                                         ClutterArrayModelCompareFunc  func,
+                                                         gpointer                      user_data,
+                                                         GDestroyNotify                notify);
+void                  clutter_array_model_filter_async  (ClutterArrayModel            *model,
+                                                         guint                         column,
+                                                         ClutterArrayModelMatchFunc    func,
+                                                         gpointer                      user_data,
+                                                         GDestroyNotify                notify);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_ARRAY_MODEL_H__ */
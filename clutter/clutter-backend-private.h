@@ -92,6 +92,8 @@ struct _ClutterBackendClass
   gboolean              (* translate_event)    (ClutterBackend     *backend,
                                                 gpointer            native,
                                                 ClutterEvent       *event);
+  gulong                (* get_event_window)   (ClutterBackend     *backend,
+                                                gpointer            native);
 
   /* signals */
   void (* resolution_changed) (ClutterBackend *backend);
@@ -106,6 +108,7 @@ void                    _clutter_backend_ensure_context                 (Clutter
                                                                          ClutterStage           *stage);
 void                    _clutter_backend_ensure_context_internal        (ClutterBackend         *backend,
                                                                          ClutterStage           *stage);
+ClutterStage *          _clutter_backend_get_current_stage              (ClutterBackend         *backend);
 gboolean                _clutter_backend_create_context                 (ClutterBackend         *backend,
                                                                          GError                **error);
 
@@ -129,6 +132,12 @@ void                    _clutter_backend_add_event_translator           (Clutter
                                                                          ClutterEventTranslator *translator);
 void                    _clutter_backend_remove_event_translator        (ClutterBackend         *backend,
                                                                          ClutterEventTranslator *translator);
+void                    _clutter_backend_add_window_event_translator    (ClutterBackend         *backend,
+                                                                         gulong                  window,
+                                                                         ClutterEventTranslator *translator);
+void                    _clutter_backend_remove_window_event_translator (ClutterBackend         *backend,
+                                                                         gulong                  window,
+                                                                         ClutterEventTranslator *translator);
 
 ClutterFeatureFlags     _clutter_backend_get_features                   (ClutterBackend         *backend);
 
@@ -105,6 +105,11 @@ struct _ClutterBackendPrivate
   gint32 units_serial;
 
   GList *event_translators;
+
+  /* native window -> translator, for the translators that are only
+   * interested in the events of a window
+   */
+  GHashTable *window_translators;
 };
 
 enum
@@ -140,6 +145,12 @@ clutter_backend_dispose (GObject *gobject)
       priv->event_translators = NULL;
     }
 
+  if (priv->window_translators != NULL)
+    {
+      g_hash_table_destroy (priv->window_translators);
+      priv->window_translators = NULL;
+    }
+
   G_OBJECT_CLASS (clutter_backend_parent_class)->dispose (gobject);
 }
 
@@ -554,8 +565,39 @@ clutter_backend_real_translate_event (ClutterBackend *backend,
                                       ClutterEvent   *event)
 {
   ClutterBackendPrivate *priv = backend->priv;
+  ClutterBackendClass *klass = CLUTTER_BACKEND_GET_CLASS (backend);
   GList *l;
 
+  /* dispatch directly to the translator of the window of the event,
+   * if any, before trying the translators interested in every event
+   */
+  if (priv->window_translators != NULL && klass->get_event_window != NULL)
+    {
+      ClutterEventTranslator *translator;
+      gulong window;
+
+      window = klass->get_event_window (backend, native);
+      translator = window != 0
+                 ? g_hash_table_lookup (priv->window_translators,
+                                        GSIZE_TO_POINTER (window))
+                 : NULL;
+
+      if (translator != NULL)
+        {
+          ClutterTranslateReturn retval;
+
+          retval = _clutter_event_translator_translate_event (translator,
+                                                              native,
+                                                              event);
+
+          if (retval == CLUTTER_TRANSLATE_QUEUE)
+            return TRUE;
+
+          if (retval == CLUTTER_TRANSLATE_REMOVE)
+            return FALSE;
+        }
+    }
+
   for (l = priv->event_translators;
        l != NULL;
        l = l->next)
@@ -754,12 +796,13 @@ _clutter_backend_ensure_context_internal (ClutterBackend  *backend,
     klass->ensure_context (backend, stage);
 }
 
+/* the stage whose GL context is current */
+static ClutterStage *current_context_stage = NULL;
+
 void
 _clutter_backend_ensure_context (ClutterBackend *backend,
                                  ClutterStage   *stage)
 {
-  static ClutterStage *current_context_stage = NULL;
-
   g_assert (CLUTTER_IS_BACKEND (backend));
   g_assert (CLUTTER_IS_STAGE (stage));
 
@@ -825,6 +868,22 @@ _clutter_backend_ensure_context (ClutterBackend *backend,
 }
 
 
+/*< private >
+ * _clutter_backend_get_current_stage:
+ * @backend: a #ClutterBackend
+ *
+ * Retrieves the stage whose GL context was made current by the last
+ * call to _clutter_backend_ensure_context(). The returned pointer must
+ * only be compared, as the stage might have been destroyed since.
+ *
+ * Return value: (transfer none): the stage, or %NULL
+ */
+ClutterStage *
+_clutter_backend_get_current_stage (ClutterBackend *backend)
+{
+  return current_context_stage;
+}
+
 ClutterFeatureFlags
 _clutter_backend_get_features (ClutterBackend *backend)
 {
@@ -1097,6 +1156,64 @@ _clutter_backend_remove_event_translator (ClutterBackend         *backend,
     g_list_remove (priv->event_translators, translator);
 }
 
+/*< private >
+ * _clutter_backend_add_window_event_translator:
+ * @backend: a #ClutterBackend
+ * @window: the native window
+ * @translator: a #ClutterEventTranslator
+ *
+ * Adds @translator to the translators of @backend, for the native
+ * events of @window only; the backend class must implement the
+ * get_event_window() virtual function.
+ *
+ * Window translators are called before the ones added using
+ * _clutter_backend_add_event_translator(), and only for the events
+ * they are interested in.
+ */
+void
+_clutter_backend_add_window_event_translator (ClutterBackend         *backend,
+                                              gulong                  window,
+                                              ClutterEventTranslator *translator)
+{
+  ClutterBackendPrivate *priv = backend->priv;
+
+  g_return_if_fail (window != 0);
+  g_return_if_fail (CLUTTER_BACKEND_GET_CLASS (backend)->get_event_window != NULL);
+
+  if (priv->window_translators == NULL)
+    priv->window_translators = g_hash_table_new (NULL, NULL);
+
+  g_hash_table_replace (priv->window_translators,
+                        GSIZE_TO_POINTER (window),
+                        translator);
+}
+
+/*< private >
+ * _clutter_backend_remove_window_event_translator:
+ * @backend: a #ClutterBackend
+ * @window: the native window
+ * @translator: a #ClutterEventTranslator
+ *
+ * Removes @translator from the translators of the events of @window,
+ * if it was added using _clutter_backend_add_window_event_translator().
+ */
+void
+_clutter_backend_remove_window_event_translator (ClutterBackend         *backend,
+                                                 gulong                  window,
+                                                 ClutterEventTranslator *translator)
+{
+  ClutterBackendPrivate *priv = backend->priv;
+
+  if (priv->window_translators == NULL)
+    return;
+
+  if (g_hash_table_lookup (priv->window_translators,
+                           GSIZE_TO_POINTER (window)) != translator)
+    return;
+
+  g_hash_table_remove (priv->window_translators, GSIZE_TO_POINTER (window));
+}
+
 /**
  * clutter_backend_get_cogl_context:
  * @backend: a #ClutterBackend
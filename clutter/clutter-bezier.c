@@ -37,7 +37,8 @@
 /*
  * Constants for sampling of the bezier. Float point.
  */
-#define CBZ_T_SAMPLES 128.0
+#define CBZ_N_SAMPLES 128
+#define CBZ_T_SAMPLES ((gfloat) CBZ_N_SAMPLES)
 #define CBZ_T_STEP (1.0 / CBZ_T_SAMPLES)
 
 /*
@@ -58,6 +59,11 @@ struct _ClutterBezier
 
   /* length of the bezier */
   gfloat length;
+
+  /* the length of the bezier at each sample of t, used to map a
+   * relative length back to t
+   */
+  gfloat lengths[CBZ_N_SAMPLES + 1];
 };
 
 static gfloat
@@ -138,7 +144,8 @@ _clutter_bezier_clone_and_move (const ClutterBezier *b,
  * @knot: The point whith the calculated position
  *
  * Advances along the bezier @b to relative length @L and returns the coordinances
- * in @knot
+ * in @knot; the relative length is mapped to the parameter of the curve
+ * using the lengths sampled by _clutter_bezier_init().
  */
 void
 _clutter_bezier_advance (const ClutterBezier *b,
@@ -146,7 +153,34 @@ _clutter_bezier_advance (const ClutterBezier *b,
                          ClutterPoint        *knot)
 {
   gfloat t;
-  t = L;
+
+  if (b->length > 0.0)
+    {
+      gfloat target = CLAMP (L, 0.0, 1.0) * b->length;
+      gfloat segment;
+      gint lo = 1, hi = CBZ_N_SAMPLES;
+
+      /* the first sample at, or past, the target length */
+      while (lo < hi)
+        {
+          gint mid = lo + (hi - lo) / 2;
+
+          if (b->lengths[mid] < target)
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+
+      segment = b->lengths[lo] - b->lengths[lo - 1];
+
+      t = lo - 1;
+      if (segment > 0.0)
+        t += (target - b->lengths[lo - 1]) / segment;
+
+      t *= CBZ_T_STEP;
+    }
+  else
+    t = L;
 
   knot->x = _clutter_bezier_t2x (b, t);
   knot->y = _clutter_bezier_t2y (b, t);
@@ -207,12 +241,17 @@ _clutter_bezier_init (ClutterBezier *b,
 
   xp = b->ax;
   yp = b->ay;
-  for (t = CBZ_T_STEP, i = 1; i <= CBZ_T_SAMPLES; ++i, t += CBZ_T_STEP)
+  b->lengths[0] = 0.0;
+  for (i = 1; i <= CBZ_N_SAMPLES; ++i)
     {
-      gfloat x = _clutter_bezier_t2x (b, t);
-      gfloat y = _clutter_bezier_t2y (b, t);
+      gfloat x, y;
+
+      t = i * CBZ_T_STEP;
+      x = _clutter_bezier_t2x (b, t);
+      y = _clutter_bezier_t2y (b, t);
 
       b->length += sqrtf ((y - yp)*(y - yp) + (x - xp)*(x - xp));
+      b->lengths[i] = b->length;
 
       xp = x;
       yp = y;
@@ -116,6 +116,12 @@
                                   CLUTTER_HYPER_MASK   | \
                                   CLUTTER_META_MASK)   | CLUTTER_RELEASE_MASK)
 
+/* the key symbols below this value, which include the printable
+ * Latin-1 characters, are looked up in a table when they are bound
+ * without modifiers
+ */
+#define N_UNMODIFIED_KEYS       256
+
 typedef struct _ClutterBindingEntry     ClutterBindingEntry;
 
 static GSList *clutter_binding_pools = NULL;
@@ -129,6 +135,8 @@ struct _ClutterBindingPool
 
   GSList *entries;
   GHashTable *entries_hash;
+
+  ClutterBindingEntry *unmodified_entries[N_UNMODIFIED_KEYS];
 };
 
 struct _ClutterBindingPoolClass
@@ -143,6 +151,13 @@ struct _ClutterBindingEntry
   guint key_val;
   ClutterModifierType modifiers;
 
+  /* actions installed with a callback are invoked directly, while
+   * the ones installed with a closure go through its marshaller
+   */
+  ClutterBindingActionFunc callback;
+  gpointer data;
+  GDestroyNotify notify;
+
   GClosure *closure;
 
   guint is_blocked  : 1;
@@ -196,12 +211,59 @@ binding_entry_new (const gchar         *name,
   entry->key_val = key_val;
   entry->modifiers = modifiers;
   entry->name = (gchar *) g_intern_string (name);
+  entry->callback = NULL;
+  entry->data = NULL;
+  entry->notify = NULL;
   entry->closure = NULL;
   entry->is_blocked = FALSE;
 
   return entry;
 }
 
+static void
+binding_entry_clear_action (ClutterBindingEntry *entry)
+{
+  if (entry->notify != NULL)
+    entry->notify (entry->data);
+
+  entry->callback = NULL;
+  entry->data = NULL;
+  entry->notify = NULL;
+
+  if (entry->closure != NULL)
+    {
+      g_closure_unref (entry->closure);
+      entry->closure = NULL;
+    }
+}
+
+static void
+binding_entry_set_closure (ClutterBindingEntry *entry,
+                           GClosure            *closure)
+{
+  entry->closure = g_closure_ref (closure);
+  g_closure_sink (closure);
+
+  if (G_CLOSURE_NEEDS_MARSHAL (closure))
+    {
+      GClosureMarshal marshal;
+
+      marshal = _clutter_marshal_BOOLEAN__STRING_UINT_FLAGS;
+      g_closure_set_marshal (closure, marshal);
+    }
+}
+
+static void
+binding_pool_add_entry (ClutterBindingPool  *pool,
+                        ClutterBindingEntry *entry)
+{
+  pool->entries = g_slist_prepend (pool->entries, entry);
+  g_hash_table_insert (pool->entries_hash, entry, entry);
+
+  if (entry->modifiers == 0 && entry->key_val < N_UNMODIFIED_KEYS)
+    pool->unmodified_entries[entry->key_val] = entry;
+}
+
 static ClutterBindingEntry *
 binding_pool_lookup_entry (ClutterBindingPool  *pool,
                            guint                key_val,
@@ -222,7 +284,7 @@ binding_entry_free (gpointer data)
     {
       ClutterBindingEntry *entry = data;
 
-      g_closure_unref (entry->closure);
+      binding_entry_clear_action (entry);
 
       g_slice_free (ClutterBindingEntry, entry);
     }
@@ -482,7 +544,6 @@ clutter_binding_pool_install_action (ClutterBindingPool  *pool,
                                      GDestroyNotify       notify)
 {
   ClutterBindingEntry *entry;
-  GClosure *closure;
 
   g_return_if_fail (pool != NULL);
   g_return_if_fail (action_name != NULL);
@@ -502,20 +563,11 @@ clutter_binding_pool_install_action (ClutterBindingPool  *pool,
   else
     entry = binding_entry_new (action_name, key_val, modifiers);
 
-  closure = g_cclosure_new (callback, data, (GClosureNotify) notify);
-  entry->closure = g_closure_ref (closure);
-  g_closure_sink (closure);
-
-  if (G_CLOSURE_NEEDS_MARSHAL (closure))
-    {
-      GClosureMarshal marshal;
-
-      marshal = _clutter_marshal_BOOLEAN__STRING_UINT_FLAGS;
-      g_closure_set_marshal (closure, marshal);
-    }
+  entry->callback = (ClutterBindingActionFunc) callback;
+  entry->data = data;
+  entry->notify = notify;
 
-  pool->entries = g_slist_prepend (pool->entries, entry);
-  g_hash_table_insert (pool->entries_hash, entry, entry);
+  binding_pool_add_entry (pool, entry);
 }
 
 /**
@@ -569,19 +621,9 @@ clutter_binding_pool_install_closure (ClutterBindingPool  *pool,
   else
     entry = binding_entry_new (action_name, key_val, modifiers);
 
-  entry->closure = g_closure_ref (closure);
-  g_closure_sink (closure);
-
-  if (G_CLOSURE_NEEDS_MARSHAL (closure))
-    {
-      GClosureMarshal marshal;
+  binding_entry_set_closure (entry, closure);
 
-      marshal = _clutter_marshal_BOOLEAN__STRING_UINT_FLAGS;
-      g_closure_set_marshal (closure, marshal);
-    }
-
-  pool->entries = g_slist_prepend (pool->entries, entry);
-  g_hash_table_insert (pool->entries_hash, entry, entry);
+  binding_pool_add_entry (pool, entry);
 }
 
 /**
@@ -614,7 +656,6 @@ clutter_binding_pool_override_action (ClutterBindingPool  *pool,
                                       GDestroyNotify       notify)
 {
   ClutterBindingEntry *entry;
-  GClosure *closure;
 
   g_return_if_fail (pool != NULL);
   g_return_if_fail (key_val != 0);
@@ -630,23 +671,11 @@ clutter_binding_pool_override_action (ClutterBindingPool  *pool,
       return;
     }
 
-  if (entry->closure)
-    {
-      g_closure_unref (entry->closure);
-      entry->closure = NULL;
-    }
-
-  closure = g_cclosure_new (callback, data, (GClosureNotify) notify);
-  entry->closure = g_closure_ref (closure);
-  g_closure_sink (closure);
+  binding_entry_clear_action (entry);
 
-  if (G_CLOSURE_NEEDS_MARSHAL (closure))
-    {
-      GClosureMarshal marshal;
-
-      marshal = _clutter_marshal_BOOLEAN__STRING_UINT_FLAGS;
-      g_closure_set_marshal (closure, marshal);
-    }
+  entry->callback = (ClutterBindingActionFunc) callback;
+  entry->data = data;
+  entry->notify = notify;
 }
 
 /**
@@ -691,22 +720,9 @@ clutter_binding_pool_override_closure (ClutterBindingPool  *pool,
       return;
     }
 
-  if (entry->closure)
-    {
-      g_closure_unref (entry->closure);
-      entry->closure = NULL;
-    }
-
-  entry->closure = g_closure_ref (closure);
-  g_closure_sink (closure);
+  binding_entry_clear_action (entry);
 
-  if (G_CLOSURE_NEEDS_MARSHAL (closure))
-    {
-      GClosureMarshal marshal;
-
-      marshal = _clutter_marshal_BOOLEAN__STRING_UINT_FLAGS;
-      g_closure_set_marshal (closure, marshal);
-    }
+  binding_entry_set_closure (entry, closure);
 }
 
 /**
@@ -768,19 +784,23 @@ clutter_binding_pool_remove_action (ClutterBindingPool  *pool,
   remove_entry.key_val = key_val;
   remove_entry.modifiers = modifiers;
 
-  for (l = pool->entries; l != NULL; l = l->data)
+  if (modifiers == 0 && key_val < N_UNMODIFIED_KEYS)
+    pool->unmodified_entries[key_val] = NULL;
+
+  g_hash_table_remove (pool->entries_hash, &remove_entry);
+
+  for (l = pool->entries; l != NULL; l = l->next)
     {
       ClutterBindingEntry *e = l->data;
 
       if (e->key_val == remove_entry.key_val &&
           e->modifiers == remove_entry.modifiers)
         {
-          pool->entries = g_slist_remove_link (pool->entries, l);
+          pool->entries = g_slist_delete_link (pool->entries, l);
+          binding_entry_free (e);
           break;
         }
     }
-
-  g_hash_table_remove (pool->entries_hash, &remove_entry);
 }
 
 static gboolean
@@ -796,6 +816,14 @@ clutter_binding_entry_invoke (ClutterBindingEntry *entry,
   GValue result = G_VALUE_INIT;
   gboolean retval = TRUE;
 
+  /* no need to marshal the arguments for a C callback */
+  if (entry->callback != NULL)
+    return entry->callback (gobject,
+                            entry->name,
+                            entry->key_val,
+                            entry->modifiers,
+                            entry->data);
+
   g_value_init (&params[0], G_TYPE_OBJECT);
   g_value_set_object (&params[0], gobject);
 
@@ -870,7 +898,14 @@ clutter_binding_pool_activate (ClutterBindingPool  *pool,
 
   modifiers = (modifiers & BINDING_MOD_MASK);
 
-  entry = binding_pool_lookup_entry (pool, key_val, modifiers);
+  /* typing plain characters is the most common case, and it usually
+   * does not match any binding
+   */
+  if (modifiers == 0 && key_val < N_UNMODIFIED_KEYS)
+    entry = pool->unmodified_entries[key_val];
+  else
+    entry = binding_pool_lookup_entry (pool, key_val, modifiers);
+
   if (!entry)
     return FALSE;
 
@@ -43,6 +43,8 @@
 
 #define CLUTTER_ENABLE_EXPERIMENTAL_API
 
+#include <math.h>
+
 #include "clutter-blur-effect.h"
 
 #include "cogl/cogl.h"
@@ -74,6 +76,12 @@ static const gchar *box_blur_glsl_shader =
 "  cogl_texel /= 9.0;\n";
 #undef SAMPLE
 
+/* the largest supported radius, in pixels */
+#define MAX_BLUR_RADIUS         64.0
+
+/* radii up to this use the single pass box blur above */
+#define BOX_BLUR_RADIUS         1.0
+
 struct _ClutterBlurEffect
 {
   ClutterOffscreenEffect parent_instance;
@@ -87,6 +95,27 @@ struct _ClutterBlurEffect
   gint tex_height;
 
   CoglPipeline *pipeline;
+
+  gdouble radius;
+
+  /* the separable gaussian blur, used for radii larger than the box
+   * blur: the offscreen texture is scaled down into blur_fb[0], blurred
+   * horizontally into blur_fb[1] and vertically back into blur_fb[0],
+   * which is then scaled back up when painting
+   */
+  gint downscale;
+  gint blur_width;
+  gint blur_height;
+  CoglHandle blur_texture[2];
+  CoglHandle blur_fb[2];
+
+  /* the pass pipelines, regenerated when the radius changes */
+  CoglPipeline *downscale_pipeline;
+  CoglPipeline *blur_pipeline[2];
+  CoglPipeline *upscale_pipeline;
+
+  /* whether the offscreen texture was redrawn after the last blur */
+  guint blur_stale : 1;
 };
 
 struct _ClutterBlurEffectClass
@@ -96,10 +125,286 @@ struct _ClutterBlurEffectClass
   CoglPipeline *base_pipeline;
 };
 
+enum
+{
+  PROP_0,
+
+  PROP_RADIUS,
+
+  PROP_LAST
+};
+
+static GParamSpec *obj_props[PROP_LAST];
+
 G_DEFINE_TYPE (ClutterBlurEffect,
                clutter_blur_effect,
                CLUTTER_TYPE_OFFSCREEN_EFFECT);
 
+static inline gboolean
+clutter_blur_effect_use_box_blur (ClutterBlurEffect *self)
+{
+  return self->radius <= BOX_BLUR_RADIUS;
+}
+
+/* larger radii are blurred at a lower resolution; the result is
+ * scaled back up with linear filtering, which is not noticeable on a
+ * blurred image
+ */
+static gint
+clutter_blur_effect_get_downscale (ClutterBlurEffect *self)
+{
+  if (self->radius > 16.0)
+    return 4;
+
+  if (self->radius > 4.0)
+    return 2;
+
+  return 1;
+}
+
+static void
+clutter_blur_effect_free_targets (ClutterBlurEffect *self)
+{
+  int i;
+
+  for (i = 0; i < 2; i++)
+    {
+      if (self->blur_fb[i] != NULL)
+        {
+          cogl_handle_unref (self->blur_fb[i]);
+          self->blur_fb[i] = NULL;
+        }
+
+      if (self->blur_texture[i] != NULL)
+        {
+          cogl_handle_unref (self->blur_texture[i]);
+          self->blur_texture[i] = NULL;
+        }
+    }
+
+  self->blur_width = 0;
+  self->blur_height = 0;
+}
+
+static void
+clutter_blur_effect_free_pipelines (ClutterBlurEffect *self)
+{
+  int i;
+
+  if (self->downscale_pipeline != NULL)
+    {
+      cogl_object_unref (self->downscale_pipeline);
+      self->downscale_pipeline = NULL;
+    }
+
+  for (i = 0; i < 2; i++)
+    {
+      if (self->blur_pipeline[i] != NULL)
+        {
+          cogl_object_unref (self->blur_pipeline[i]);
+          self->blur_pipeline[i] = NULL;
+        }
+    }
+
+  if (self->upscale_pipeline != NULL)
+    {
+      cogl_object_unref (self->upscale_pipeline);
+      self->upscale_pipeline = NULL;
+    }
+}
+
+static CoglPipeline *
+create_pass_pipeline (CoglContext *ctx)
+{
+  CoglPipeline *pipeline = cogl_pipeline_new (ctx);
+
+  cogl_pipeline_set_layer_null_texture (pipeline, 0, COGL_TEXTURE_TYPE_2D);
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_LINEAR,
+                                   COGL_PIPELINE_FILTER_LINEAR);
+  cogl_pipeline_set_layer_wrap_mode (pipeline, 0,
+                                     COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+
+  return pipeline;
+}
+
+/* builds the texture lookup of a one dimensional gaussian kernel; the
+ * weights are baked into the shader, so that GLSL ES does not need to
+ * loop over uniform arrays
+ */
+static gchar *
+build_gaussian_shader (gdouble radius)
+{
+  GString *shader = g_string_new (NULL);
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+  gdouble sigma, sum, *weights;
+  gint n_taps, i;
+
+  n_taps = (gint) ceil (radius);
+  sigma = MAX (radius / 2.0, 0.5);
+
+  weights = g_new (gdouble, n_taps + 1);
+
+  sum = 0.0;
+  for (i = 0; i <= n_taps; i++)
+    {
+      weights[i] = exp (-(i * i) / (2.0 * sigma * sigma));
+      sum += i == 0 ? weights[i] : 2.0 * weights[i];
+    }
+
+  g_string_append_printf (shader,
+                          "  cogl_texel = texture2D (cogl_sampler, "
+                          "cogl_tex_coord.st) * %s;\n",
+                          g_ascii_formatd (buf, sizeof (buf), "%.6f",
+                                           weights[0] / sum));
+
+  for (i = 1; i <= n_taps; i++)
+    {
+      gchar offset[G_ASCII_DTOSTR_BUF_SIZE];
+
+      g_ascii_formatd (offset, sizeof (offset), "%.1f", (gdouble) i);
+      g_ascii_formatd (buf, sizeof (buf), "%.6f", weights[i] / sum);
+
+      g_string_append_printf (shader,
+                              "  cogl_texel += (texture2D (cogl_sampler, "
+                              "cogl_tex_coord.st + pixel_step * %s) + "
+                              "texture2D (cogl_sampler, "
+                              "cogl_tex_coord.st - pixel_step * %s)) * %s;\n",
+                              offset, offset, buf);
+    }
+
+  g_free (weights);
+
+  return g_string_free (shader, FALSE);
+}
+
+static void
+clutter_blur_effect_ensure_pipelines (ClutterBlurEffect *self)
+{
+  CoglContext *ctx;
+  CoglSnippet *snippet;
+  gchar *shader;
+  int i;
+
+  if (self->upscale_pipeline != NULL)
+    return;
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+  self->downscale_pipeline = create_pass_pipeline (ctx);
+  self->upscale_pipeline = create_pass_pipeline (ctx);
+
+  shader = build_gaussian_shader (self->radius / self->downscale);
+  snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
+                              box_blur_glsl_declarations,
+                              NULL);
+  cogl_snippet_set_replace (snippet, shader);
+  g_free (shader);
+
+  for (i = 0; i < 2; i++)
+    {
+      self->blur_pipeline[i] = create_pass_pipeline (ctx);
+
+      /* the passes sample at exact texel centers */
+      cogl_pipeline_set_layer_filters (self->blur_pipeline[i], 0,
+                                       COGL_PIPELINE_FILTER_NEAREST,
+                                       COGL_PIPELINE_FILTER_NEAREST);
+      cogl_pipeline_add_layer_snippet (self->blur_pipeline[i], 0, snippet);
+    }
+
+  cogl_object_unref (snippet);
+}
+
+static gboolean
+clutter_blur_effect_ensure_targets (ClutterBlurEffect *self,
+                                    CoglHandle         texture)
+{
+  gint width, height;
+  int i;
+
+  width = MAX (self->tex_width / self->downscale, 1);
+  height = MAX (self->tex_height / self->downscale, 1);
+
+  if (self->blur_width != width || self->blur_height != height)
+    {
+      clutter_blur_effect_free_targets (self);
+
+      for (i = 0; i < 2; i++)
+        {
+          self->blur_texture[i] =
+            cogl_texture_new_with_size (width, height,
+                                        COGL_TEXTURE_NO_SLICING,
+                                        COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+          if (self->blur_texture[i] == NULL)
+            break;
+
+          self->blur_fb[i] = cogl_offscreen_new_to_texture (self->blur_texture[i]);
+          if (self->blur_fb[i] == NULL)
+            break;
+
+          cogl_framebuffer_orthographic (self->blur_fb[i],
+                                         0, 0, width, height,
+                                         -1.f, 1.f);
+        }
+
+      if (i < 2)
+        {
+          g_warning ("%s: Unable to create the blur buffers", G_STRLOC);
+          clutter_blur_effect_free_targets (self);
+          return FALSE;
+        }
+
+      self->blur_width = width;
+      self->blur_height = height;
+    }
+
+  for (i = 0; i < 2; i++)
+    {
+      gfloat pixel_step[2];
+
+      pixel_step[0] = i == 0 ? 1.0f / width : 0.0f;
+      pixel_step[1] = i == 0 ? 0.0f : 1.0f / height;
+
+      cogl_pipeline_set_uniform_float (self->blur_pipeline[i],
+                                       cogl_pipeline_get_uniform_location (self->blur_pipeline[i],
+                                                                           "pixel_step"),
+                                       2, /* n_components */
+                                       1, /* count */
+                                       pixel_step);
+    }
+
+  cogl_pipeline_set_layer_texture (self->downscale_pipeline, 0, texture);
+  cogl_pipeline_set_layer_texture (self->blur_pipeline[0], 0, self->blur_texture[0]);
+  cogl_pipeline_set_layer_texture (self->blur_pipeline[1], 0, self->blur_texture[1]);
+  cogl_pipeline_set_layer_texture (self->upscale_pipeline, 0, self->blur_texture[0]);
+
+  return TRUE;
+}
+
+static void
+clutter_blur_effect_run_passes (ClutterBlurEffect *self)
+{
+  CoglHandle fb0 = self->blur_fb[0];
+  CoglHandle fb1 = self->blur_fb[1];
+
+  /* scale the offscreen texture down */
+  cogl_framebuffer_clear4f (fb0, COGL_BUFFER_BIT_COLOR, 0.f, 0.f, 0.f, 0.f);
+  cogl_framebuffer_draw_rectangle (fb0, self->downscale_pipeline,
+                                   0, 0, self->blur_width, self->blur_height);
+
+  /* horizontal pass */
+  cogl_framebuffer_clear4f (fb1, COGL_BUFFER_BIT_COLOR, 0.f, 0.f, 0.f, 0.f);
+  cogl_framebuffer_draw_rectangle (fb1, self->blur_pipeline[0],
+                                   0, 0, self->blur_width, self->blur_height);
+
+  /* vertical pass */
+  cogl_framebuffer_clear4f (fb0, COGL_BUFFER_BIT_COLOR, 0.f, 0.f, 0.f, 0.f);
+  cogl_framebuffer_draw_rectangle (fb0, self->blur_pipeline[1],
+                                   0, 0, self->blur_width, self->blur_height);
+
+  self->blur_stale = FALSE;
+}
+
 static gboolean
 clutter_blur_effect_pre_paint (ClutterEffect *effect)
 {
@@ -136,6 +441,16 @@ clutter_blur_effect_pre_paint (ClutterEffect *effect)
       self->tex_width = cogl_texture_get_width (texture);
       self->tex_height = cogl_texture_get_height (texture);
 
+      if (!clutter_blur_effect_use_box_blur (self))
+        {
+          clutter_blur_effect_ensure_pipelines (self);
+
+          /* the offscreen texture is about to be redrawn */
+          self->blur_stale = clutter_blur_effect_ensure_targets (self, texture);
+
+          return TRUE;
+        }
+
       if (self->pixel_step_uniform > -1)
         {
           gfloat pixel_step[2];
@@ -162,16 +477,33 @@ static void
 clutter_blur_effect_paint_target (ClutterOffscreenEffect *effect)
 {
   ClutterBlurEffect *self = CLUTTER_BLUR_EFFECT (effect);
+  CoglPipeline *pipeline;
   guint8 paint_opacity;
 
+  if (clutter_blur_effect_use_box_blur (self))
+    pipeline = self->pipeline;
+  else
+    {
+      if (self->blur_fb[0] == NULL)
+        return;
+
+      /* the blurred image is kept for as long as the offscreen
+       * texture is re-used, e.g. when the actor is only moved
+       */
+      if (self->blur_stale)
+        clutter_blur_effect_run_passes (self);
+
+      pipeline = self->upscale_pipeline;
+    }
+
   paint_opacity = clutter_actor_get_paint_opacity (self->actor);
 
-  cogl_pipeline_set_color4ub (self->pipeline,
+  cogl_pipeline_set_color4ub (pipeline,
                               paint_opacity,
                               paint_opacity,
                               paint_opacity,
                               paint_opacity);
-  cogl_push_source (self->pipeline);
+  cogl_push_source (pipeline);
 
   cogl_rectangle (0, 0, self->tex_width, self->tex_height);
 
@@ -182,17 +514,25 @@ static gboolean
 clutter_blur_effect_get_paint_volume (ClutterEffect      *effect,
                                       ClutterPaintVolume *volume)
 {
+  ClutterBlurEffect *self = CLUTTER_BLUR_EFFECT (effect);
   gfloat cur_width, cur_height;
   ClutterVertex origin;
+  gfloat padding;
+
+  /* the blur spreads the pixels by up to the radius on each side */
+  if (clutter_blur_effect_use_box_blur (self))
+    padding = BLUR_PADDING;
+  else
+    padding = ceil (self->radius) + self->downscale;
 
   clutter_paint_volume_get_origin (volume, &origin);
   cur_width = clutter_paint_volume_get_width (volume);
   cur_height = clutter_paint_volume_get_height (volume);
 
-  origin.x -= BLUR_PADDING;
-  origin.y -= BLUR_PADDING;
-  cur_width += 2 * BLUR_PADDING;
-  cur_height += 2 * BLUR_PADDING;
+  origin.x -= padding;
+  origin.y -= padding;
+  cur_width += 2 * padding;
+  cur_height += 2 * padding;
   clutter_paint_volume_set_origin (volume, &origin);
   clutter_paint_volume_set_width (volume, cur_width);
   clutter_paint_volume_set_height (volume, cur_height);
@@ -200,6 +540,46 @@ clutter_blur_effect_get_paint_volume (ClutterEffect      *effect,
   return TRUE;
 }
 
+static void
+clutter_blur_effect_set_property (GObject      *gobject,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  ClutterBlurEffect *effect = CLUTTER_BLUR_EFFECT (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_RADIUS:
+      clutter_blur_effect_set_radius (effect, g_value_get_double (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_blur_effect_get_property (GObject    *gobject,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  ClutterBlurEffect *effect = CLUTTER_BLUR_EFFECT (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_RADIUS:
+      g_value_set_double (value, effect->radius);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
 static void
 clutter_blur_effect_dispose (GObject *gobject)
 {
@@ -211,6 +591,9 @@ clutter_blur_effect_dispose (GObject *gobject)
       self->pipeline = NULL;
     }
 
+  clutter_blur_effect_free_pipelines (self);
+  clutter_blur_effect_free_targets (self);
+
   G_OBJECT_CLASS (clutter_blur_effect_parent_class)->dispose (gobject);
 }
 
@@ -221,6 +604,8 @@ clutter_blur_effect_class_init (ClutterBlurEffectClass *klass)
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   ClutterOffscreenEffectClass *offscreen_class;
 
+  gobject_class->set_property = clutter_blur_effect_set_property;
+  gobject_class->get_property = clutter_blur_effect_get_property;
   gobject_class->dispose = clutter_blur_effect_dispose;
 
   effect_class->pre_paint = clutter_blur_effect_pre_paint;
@@ -228,6 +613,25 @@ clutter_blur_effect_class_init (ClutterBlurEffectClass *klass)
 
   offscreen_class = CLUTTER_OFFSCREEN_EFFECT_CLASS (klass);
   offscreen_class->paint_target = clutter_blur_effect_paint_target;
+
+  /**
+   * ClutterBlurEffect:radius:
+   *
+   * The radius of the blur, in pixels.
+   *
+   * Radii up to 1.0 use a single 3x3 box blur; larger radii use a
+   * two pass gaussian blur, computed at a lower resolution for large
+   * radii.
+   */
+  obj_props[PROP_RADIUS] =
+    g_param_spec_double ("radius",
+                         P_("Radius"),
+                         P_("The radius of the blur, in pixels"),
+                         0.0, MAX_BLUR_RADIUS,
+                         BOX_BLUR_RADIUS,
+                         CLUTTER_PARAM_READWRITE);
+
+  g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
 }
 
 static void
@@ -259,6 +663,9 @@ clutter_blur_effect_init (ClutterBlurEffect *self)
 
   self->pixel_step_uniform =
     cogl_pipeline_get_uniform_location (self->pipeline, "pixel_step");
+
+  self->radius = BOX_BLUR_RADIUS;
+  self->downscale = 1;
 }
 
 /**
@@ -276,3 +683,60 @@ clutter_blur_effect_new (void)
 {
   return g_object_new (CLUTTER_TYPE_BLUR_EFFECT, NULL);
 }
+
+/**
+ * clutter_blur_effect_set_radius:
+ * @effect: a #ClutterBlurEffect
+ * @radius: the radius of the blur, in pixels
+ *
+ * Sets the radius of the blur applied by @effect.
+ *
+ * Radii larger than 1.0 are blurred using two separable gaussian
+ * passes; radii larger than 4.0 are blurred at half the resolution of
+ * the actor, and radii larger than 16.0 at a quarter of it, so large
+ * radii are cheaper than chaining multiple blur effects.
+ */
+void
+clutter_blur_effect_set_radius (ClutterBlurEffect *effect,
+                                gdouble            radius)
+{
+  ClutterActor *actor;
+
+  g_return_if_fail (CLUTTER_IS_BLUR_EFFECT (effect));
+  g_return_if_fail (radius >= 0.0 && radius <= MAX_BLUR_RADIUS);
+
+  if (fabs (effect->radius - radius) < 0.00001)
+    return;
+
+  effect->radius = radius;
+  effect->downscale = clutter_blur_effect_get_downscale (effect);
+
+  /* the kernel is part of the shader */
+  clutter_blur_effect_free_pipelines (effect);
+  clutter_blur_effect_free_targets (effect);
+
+  /* the paint volume, and thus the size of the offscreen buffer,
+   * depends on the radius
+   */
+  actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
+  if (actor != NULL)
+    clutter_actor_queue_redraw (actor);
+
+  g_object_notify_by_pspec (G_OBJECT (effect), obj_props[PROP_RADIUS]);
+}
+
+/**
+ * clutter_blur_effect_get_radius:
+ * @effect: a #ClutterBlurEffect
+ *
+ * Retrieves the radius set using clutter_blur_effect_set_radius().
+ *
+ * Return value: the radius of the blur, in pixels
+ */
+gdouble
+clutter_blur_effect_get_radius (ClutterBlurEffect *effect)
+{
+  g_return_val_if_fail (CLUTTER_IS_BLUR_EFFECT (effect), 0.0);
+
+  return effect->radius;
+}
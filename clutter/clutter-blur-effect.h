@@ -52,6 +52,10 @@ GType clutter_blur_effect_get_type (void) G_GNUC_CONST;
 
 ClutterEffect *clutter_blur_effect_new (void);
 
+void            clutter_blur_effect_set_radius  (ClutterBlurEffect *effect,
+                                                 gdouble            radius);
+gdouble         clutter_blur_effect_get_radius  (ClutterBlurEffect *effect);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_BLUR_EFFECT_H__ */
@@ -89,9 +89,18 @@ struct _ClutterBoxLayoutPrivate
 
   ClutterOrientation orientation;
 
+  /* the number of visible and expanding children, shared by the size
+   * requests and the allocation of a relayout; invalidated when a
+   * relayout is queued on the container
+   */
+  gint n_visible_children;
+  gint n_expand_children;
+  gulong queue_relayout_id;
+
   guint is_pack_start  : 1;
   guint use_animations : 1;
   guint is_homogeneous : 1;
+  guint children_counted : 1;
 };
 
 enum
@@ -129,6 +138,13 @@ static void count_expand_children         (ClutterLayoutManager *layout,
 					   gint                 *visible_children,
 					   gint                 *expand_children);
 
+static void
+on_container_queue_relayout (ClutterActor     *container,
+                             ClutterBoxLayout *self)
+{
+  self->priv->children_counted = FALSE;
+}
+
 static void
 clutter_box_layout_set_container (ClutterLayoutManager *layout,
                                   ClutterContainer     *container)
@@ -136,12 +152,24 @@ clutter_box_layout_set_container (ClutterLayoutManager *layout,
   ClutterBoxLayoutPrivate *priv = CLUTTER_BOX_LAYOUT (layout)->priv;
   ClutterLayoutManagerClass *parent_class;
 
+  if (priv->container != NULL && priv->queue_relayout_id != 0)
+    {
+      g_signal_handler_disconnect (priv->container, priv->queue_relayout_id);
+      priv->queue_relayout_id = 0;
+    }
+
   priv->container = container;
+  priv->children_counted = FALSE;
 
   if (priv->container != NULL)
     {
       ClutterRequestMode request_mode;
 
+      priv->queue_relayout_id =
+        g_signal_connect (priv->container, "queue-relayout",
+                          G_CALLBACK (on_container_queue_relayout),
+                          layout);
+
       /* we need to change the :request-mode of the container
        * to match the orientation
        */
@@ -309,19 +337,25 @@ get_preferred_size_for_opposite_orientation (ClutterBoxLayout   *self,
   sizes  = g_newa (RequestedSize, nvis_children);
   size   = for_size;
 
-  i = 0;
-  clutter_actor_iter_init (&iter, container);
-  while (clutter_actor_iter_next (&iter, &child))
+  /* homogeneous children all get the same size, regardless of their
+   * requests, so we don't need to ask for them
+   */
+  if (!priv->is_homogeneous)
     {
-      if (!CLUTTER_ACTOR_IS_VISIBLE (child))
-	continue;
+      i = 0;
+      clutter_actor_iter_init (&iter, container);
+      while (clutter_actor_iter_next (&iter, &child))
+        {
+          if (!CLUTTER_ACTOR_IS_VISIBLE (child))
+            continue;
 
-      get_child_size (child, priv->orientation, -1,
-		      &sizes[i].minimum_size,
-		      &sizes[i].natural_size);
+          get_child_size (child, priv->orientation, -1,
+                          &sizes[i].minimum_size,
+                          &sizes[i].natural_size);
 
-      size -= sizes[i].minimum_size;
-      i++;
+          size -= sizes[i].minimum_size;
+          i++;
+        }
     }
 
   if (priv->is_homogeneous)
@@ -486,6 +520,16 @@ count_expand_children (ClutterLayoutManager *layout,
   ClutterActor *actor, *child;
   ClutterActorIter iter;
 
+  /* showing, hiding, adding or removing a child, or changing its
+   * expand flags, all queue a relayout on the container
+   */
+  if (priv->children_counted && container == priv->container)
+    {
+      *visible_children = priv->n_visible_children;
+      *expand_children = priv->n_expand_children;
+      return;
+    }
+
   actor = CLUTTER_ACTOR (container);
 
   *visible_children = *expand_children = 0;
@@ -501,6 +545,13 @@ count_expand_children (ClutterLayoutManager *layout,
             *expand_children += 1;
         }
     }
+
+  if (container == priv->container)
+    {
+      priv->n_visible_children = *visible_children;
+      priv->n_expand_children = *expand_children;
+      priv->children_counted = TRUE;
+    }
 }
 
 /* Pulled from gtksizerequest.c from Gtk+ */
@@ -639,6 +690,9 @@ clutter_box_layout_allocate (ClutterLayoutManager   *layout,
                 nvis_children,
                 nexpand_children);
 
+  /* the counts are only reused within the same relayout */
+  priv->children_counted = FALSE;
+
   /* If there is no visible child, simply return. */
   if (nvis_children <= 0)
     return;
@@ -660,6 +714,19 @@ clutter_box_layout_allocate (ClutterLayoutManager   *layout,
       if (!CLUTTER_ACTOR_IS_VISIBLE (child))
         continue;
 
+      sizes[i].actor = child;
+
+      /* homogeneous children that expand fill their whole slot, so
+       * we only need the requests of the ones that are centered in it
+       */
+      if (priv->is_homogeneous &&
+          clutter_actor_needs_expand (child, priv->orientation))
+        {
+          sizes[i].minimum_size = sizes[i].natural_size = 0;
+          i += 1;
+          continue;
+        }
+
       if (priv->orientation == CLUTTER_ORIENTATION_VERTICAL)
         clutter_actor_get_preferred_height (child,
                                             box->x2 - box->x1,
@@ -704,8 +771,6 @@ clutter_box_layout_allocate (ClutterLayoutManager   *layout,
 
       size -= sizes[i].minimum_size;
 
-      sizes[i].actor = child;
-
       i += 1;
     }
 
@@ -1129,6 +1194,7 @@ clutter_box_layout_set_orientation (ClutterBoxLayout   *layout,
     return;
 
   priv->orientation = orientation;
+  priv->children_counted = FALSE;
 
   manager = CLUTTER_LAYOUT_MANAGER (layout);
 
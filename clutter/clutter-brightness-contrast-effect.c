@@ -52,6 +52,7 @@
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
 #include "clutter-offscreen-effect.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-private.h"
 
 struct _ClutterBrightnessContrastEffect
@@ -82,6 +83,7 @@ struct _ClutterBrightnessContrastEffectClass
   ClutterOffscreenEffectClass parent_class;
 
   CoglPipeline *base_pipeline;
+  CoglSnippet *snippet;
 };
 
 /* Brightness effects in GLSL.
@@ -364,7 +366,8 @@ get_brightness_values (gfloat  value,
 }
 
 static inline void
-update_uniforms (ClutterBrightnessContrastEffect *self)
+update_uniforms (ClutterBrightnessContrastEffect *self,
+                 CoglPipeline                    *pipeline)
 {
   if (self->brightness_multiplier_uniform > -1 &&
       self->brightness_offset_uniform > -1)
@@ -382,12 +385,12 @@ update_uniforms (ClutterBrightnessContrastEffect *self)
                              brightness_multiplier + 2,
                              brightness_offset + 2);
 
-      cogl_pipeline_set_uniform_float (self->pipeline,
+      cogl_pipeline_set_uniform_float (pipeline,
                                        self->brightness_multiplier_uniform,
                                        3, /* n_components */
                                        1, /* count */
                                        brightness_multiplier);
-      cogl_pipeline_set_uniform_float (self->pipeline,
+      cogl_pipeline_set_uniform_float (pipeline,
                                        self->brightness_offset_uniform,
                                        3, /* n_components */
                                        1, /* count */
@@ -402,7 +405,7 @@ update_uniforms (ClutterBrightnessContrastEffect *self)
         tan ((self->contrast_blue + 1) * G_PI_4)
       };
 
-      cogl_pipeline_set_uniform_float (self->pipeline,
+      cogl_pipeline_set_uniform_float (pipeline,
                                        self->contrast_uniform,
                                        3, /* n_components */
                                        1, /* count */
@@ -410,6 +413,13 @@ update_uniforms (ClutterBrightnessContrastEffect *self)
     }
 }
 
+static void
+clutter_brightness_contrast_effect_update_uniforms (ClutterOffscreenEffect *effect,
+                                                    CoglPipeline           *pipeline)
+{
+  update_uniforms (CLUTTER_BRIGHTNESS_CONTRAST_EFFECT (effect), pipeline);
+}
+
 static void
 clutter_brightness_contrast_effect_init (ClutterBrightnessContrastEffect *self)
 {
@@ -437,7 +447,9 @@ clutter_brightness_contrast_effect_init (ClutterBrightnessContrastEffect *self)
                                   brightness_contrast_decls,
                                   brightness_contrast_source);
       cogl_pipeline_add_snippet (klass->base_pipeline, snippet);
-      cogl_object_unref (snippet);
+
+      /* the snippet is also used when fusing the effect with others */
+      klass->snippet = snippet;
 
       cogl_pipeline_set_layer_null_texture (klass->base_pipeline,
                                             0, /* layer number */
@@ -446,6 +458,10 @@ clutter_brightness_contrast_effect_init (ClutterBrightnessContrastEffect *self)
 
   self->pipeline = cogl_pipeline_copy (klass->base_pipeline);
 
+  _clutter_offscreen_effect_set_fragment_snippet (CLUTTER_OFFSCREEN_EFFECT (self),
+                                                  klass->snippet,
+                                                  clutter_brightness_contrast_effect_update_uniforms);
+
   self->brightness_multiplier_uniform =
     cogl_pipeline_get_uniform_location (self->pipeline,
                                         "brightness_multiplier");
@@ -455,7 +471,7 @@ clutter_brightness_contrast_effect_init (ClutterBrightnessContrastEffect *self)
   self->contrast_uniform =
     cogl_pipeline_get_uniform_location (self->pipeline, "contrast");
 
-  update_uniforms (self);
+  update_uniforms (self, self->pipeline);
 }
 
 /**
@@ -506,7 +522,7 @@ clutter_brightness_contrast_effect_set_brightness_full (ClutterBrightnessContras
   effect->brightness_green = green;
   effect->brightness_blue = blue;
 
-  update_uniforms (effect);
+  update_uniforms (effect, effect->pipeline);
 
   clutter_effect_queue_repaint (CLUTTER_EFFECT (effect));
 
@@ -596,7 +612,7 @@ clutter_brightness_contrast_effect_set_contrast_full (ClutterBrightnessContrastE
   effect->contrast_green = green;
   effect->contrast_blue = blue;
 
-  update_uniforms (effect);
+  update_uniforms (effect, effect->pipeline);
 
   clutter_effect_queue_repaint (CLUTTER_EFFECT (effect));
 
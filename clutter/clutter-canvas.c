@@ -62,11 +62,19 @@
 #include "clutter-cairo.h"
 #include "clutter-color.h"
 #include "clutter-content-private.h"
+#include "clutter-main.h"
 #include "clutter-marshal.h"
+#include "clutter-memory.h"
 #include "clutter-paint-node.h"
 #include "clutter-paint-nodes.h"
 #include "clutter-private.h"
 
+/* the number of pixel buffers a canvas rotates between when it is fully
+ * redrawn, so that drawing does not have to wait until the GPU is done
+ * uploading the previous contents
+ */
+#define CANVAS_N_BUFFERS        3
+
 struct _ClutterCanvasPrivate
 {
   cairo_t *cr;
@@ -78,14 +86,49 @@ struct _ClutterCanvasPrivate
   gboolean dirty;
 
   CoglBitmap *buffer;
+
+  /* the pixel buffers used by the previous full redraws, of the current
+   * size; the least recently used one is at the head
+   */
+  GQueue spare_buffers;
+
+  /* the areas of the buffer that have been redrawn since the
+   * last upload, if the texture is not fully dirty
+   */
+  cairo_region_t *dirty_region;
+
+  /* set while clutter_canvas_invalidate_rect() is running */
+  const cairo_rectangle_int_t *invalidate_rect;
+
+  /* the image surface owning the memory of @buffer, if it
+   * was drawn by a worker thread
+   */
+  cairo_surface_t *buffer_surface;
+
+  /* the draw currently running in a worker thread, if any */
+  struct _CanvasDrawJob *draw_job;
+
+  guint threaded_draw : 1;
+  guint draw_pending : 1;
 };
 
+typedef struct _CanvasDrawJob
+{
+  ClutterCanvas *canvas;
+
+  int width;
+  int height;
+
+  cairo_surface_t *surface;
+} CanvasDrawJob;
+
 enum
 {
   PROP_0,
 
   PROP_WIDTH,
   PROP_HEIGHT,
+  PROP_THREADED_DRAW,
 
   LAST_PROP
 };
@@ -130,9 +173,9 @@ clutter_cairo_context_draw_marshaller (GClosure     *closure,
 }
 
 static void
-clutter_canvas_finalize (GObject *gobject)
+clutter_canvas_release_buffer (ClutterCanvas *self)
 {
-  ClutterCanvasPrivate *priv = CLUTTER_CANVAS (gobject)->priv;
+  ClutterCanvasPrivate *priv = self->priv;
 
   if (priv->buffer != NULL)
     {
@@ -140,7 +183,101 @@ clutter_canvas_finalize (GObject *gobject)
       priv->buffer = NULL;
     }
 
+  g_clear_pointer (&priv->buffer_surface, cairo_surface_destroy);
+}
+
+static void
+clutter_canvas_release_spare_buffers (ClutterCanvas *self)
+{
+  CoglBitmap *bitmap;
+
+  while ((bitmap = g_queue_pop_head (&self->priv->spare_buffers)) != NULL)
+    cogl_object_unref (bitmap);
+}
+
+static gboolean
+clutter_canvas_buffer_fits (ClutterCanvas *self,
+                            CoglBitmap    *bitmap)
+{
+  return cogl_bitmap_get_width (bitmap) == self->priv->width &&
+         cogl_bitmap_get_height (bitmap) == self->priv->height;
+}
+
+/* replaces the current buffer before a full redraw, re-using the least
+ * recently used spare buffer once the canvas has allocated all of its
+ * buffers; the upload of the contents of that buffer was queued the
+ * longest time ago, so it's the least likely to stall when mapped
+ */
+static void
+clutter_canvas_rotate_buffer (ClutterCanvas *self)
+{
+  ClutterCanvasPrivate *priv = self->priv;
+  CoglBitmap *bitmap;
+
+  /* the buffers wrapping the surfaces drawn by the worker threads,
+   * and the buffers of another size, cannot be re-used
+   */
+  if (priv->buffer != NULL &&
+      priv->buffer_surface == NULL &&
+      clutter_canvas_buffer_fits (self, priv->buffer))
+    {
+      g_queue_push_tail (&priv->spare_buffers, priv->buffer);
+      priv->buffer = NULL;
+    }
+  else
+    clutter_canvas_release_buffer (self);
+
+  while ((bitmap = g_queue_peek_head (&priv->spare_buffers)) != NULL &&
+         !clutter_canvas_buffer_fits (self, bitmap))
+    {
+      g_queue_pop_head (&priv->spare_buffers);
+      cogl_object_unref (bitmap);
+    }
+
+  /* a new buffer is allocated until we have enough of them */
+  if (g_queue_get_length (&priv->spare_buffers) >= CANVAS_N_BUFFERS)
+    priv->buffer = g_queue_pop_head (&priv->spare_buffers);
+}
+
+static void
+clutter_canvas_purge_caches (gpointer          instance,
+                             ClutterPurgeLevel level)
+{
+  ClutterCanvas *self = instance;
+  ClutterCanvasPrivate *priv = self->priv;
+
+  if (level < CLUTTER_PURGE_LEVEL_MODERATE)
+    return;
+
+  /* the spare buffers are only needed to avoid stalls */
+  clutter_canvas_release_spare_buffers (self);
+
+  /* once its contents have been uploaded, the buffer is only needed
+   * by the partial redraws, which become full redraws without it
+   */
+  if (priv->texture == NULL ||
+      priv->dirty ||
+      priv->dirty_region != NULL)
+    return;
+
+  clutter_canvas_release_buffer (self);
+}
+
+static void
+clutter_canvas_finalize (GObject *gobject)
+{
+  ClutterCanvasPrivate *priv = CLUTTER_CANVAS (gobject)->priv;
+
+  /* a draw job holds a reference on the canvas */
+  g_assert (priv->draw_job == NULL);
+
+  _clutter_memory_remove_purge_func (gobject);
+
+  clutter_canvas_release_buffer (CLUTTER_CANVAS (gobject));
+  clutter_canvas_release_spare_buffers (CLUTTER_CANVAS (gobject));
+
   g_clear_pointer (&priv->texture, cogl_object_unref);
+  g_clear_pointer (&priv->dirty_region, cairo_region_destroy);
 
   G_OBJECT_CLASS (clutter_canvas_parent_class)->finalize (gobject);
 }
@@ -171,6 +308,11 @@ clutter_canvas_set_property (GObject      *gobject,
         }
       break;
 
+    case PROP_THREADED_DRAW:
+      clutter_canvas_set_threaded_draw (CLUTTER_CANVAS (gobject),
+                                        g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -195,6 +337,10 @@ clutter_canvas_get_property (GObject    *gobject,
       g_value_set_int (value, priv->height);
       break;
 
+    case PROP_THREADED_DRAW:
+      g_value_set_boolean (value, priv->threaded_draw);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -240,6 +386,22 @@ clutter_canvas_class_init (ClutterCanvasClass *klass)
                       G_PARAM_READWRITE |
                       G_PARAM_STATIC_STRINGS);
 
+  /**
+   * ClutterCanvas:threaded-draw:
+   *
+   * Whether the #ClutterCanvas::draw signal should be emitted
+   * from a worker thread.
+   *
+   * See clutter_canvas_set_threaded_draw().
+   */
+  obj_props[PROP_THREADED_DRAW] =
+    g_param_spec_boolean ("threaded-draw",
+                          P_("Threaded Draw"),
+                          P_("Whether the canvas should be drawn in a worker thread"),
+                          FALSE,
+                          G_PARAM_READWRITE |
+                          G_PARAM_STATIC_STRINGS);
+
   /**
    * ClutterCanvas::draw:
    * @canvas: the #ClutterCanvas that emitted the signal
@@ -254,6 +416,9 @@ clutter_canvas_class_init (ClutterCanvasClass *klass)
    * handler invocation will be automatically protected by cairo_save()
    * and cairo_restore() pairs.
    *
+   * If #ClutterCanvas:threaded-draw is set, this signal is emitted
+   * from a worker thread.
+   *
    * Return value: %TRUE if the signal emission should stop, and
    *   %FALSE otherwise
    *
@@ -286,6 +451,12 @@ clutter_canvas_init (ClutterCanvas *self)
 
   self->priv->width = -1;
   self->priv->height = -1;
+
+  g_queue_init (&self->priv->spare_buffers);
+
+  _clutter_memory_add_purge_func (CLUTTER_MEMORY_CONTENT_TEXTURES,
+                                  self,
+                                  clutter_canvas_purge_caches);
 }
 
 static void
@@ -302,16 +473,61 @@ clutter_canvas_paint_content (ClutterContent   *content,
   ClutterScalingFilter min_f, mag_f;
   ClutterContentRepeat repeat;
 
+  /* the buffer might have been released by clutter_purge_caches()
+   * after uploading its contents
+   */
   if (priv->buffer == NULL)
-    return;
+    {
+      if (priv->texture == NULL)
+        return;
+    }
+  else if (priv->texture == NULL || priv->dirty)
+    {
+      int width = cogl_bitmap_get_width (priv->buffer);
+      int height = cogl_bitmap_get_height (priv->buffer);
+
+      /* the texture is re-used as long as the size does not change */
+      if (priv->texture != NULL &&
+          cogl_texture_get_width (priv->texture) == width &&
+          cogl_texture_get_height (priv->texture) == height)
+        {
+          cogl_texture_set_region_from_bitmap (priv->texture,
+                                               0, 0,
+                                               0, 0,
+                                               width, height,
+                                               priv->buffer);
+        }
+      else
+        {
+          g_clear_pointer (&priv->texture, cogl_object_unref);
 
-  if (priv->texture && priv->dirty)
-    g_clear_pointer (&priv->texture, cogl_object_unref);
+          priv->texture = cogl_texture_new_from_bitmap (priv->buffer,
+                                                        COGL_TEXTURE_NO_SLICING,
+                                                        CLUTTER_CAIRO_FORMAT_ARGB32);
+          _clutter_memory_track_texture (CLUTTER_MEMORY_CONTENT_TEXTURES,
+                                         priv->texture);
+        }
+    }
+  else if (priv->dirty_region != NULL)
+    {
+      int i, n_rects;
+
+      /* only upload the areas that have been redrawn */
+      n_rects = cairo_region_num_rectangles (priv->dirty_region);
+      for (i = 0; i < n_rects; i++)
+        {
+          cairo_rectangle_int_t rect;
+
+          cairo_region_get_rectangle (priv->dirty_region, i, &rect);
+          cogl_texture_set_region_from_bitmap (priv->texture,
+                                               rect.x, rect.y,
+                                               rect.x, rect.y,
+                                               rect.width, rect.height,
+                                               priv->buffer);
+        }
+    }
 
-  if (!priv->texture)
-    priv->texture = cogl_texture_new_from_bitmap (self->priv->buffer,
-                                                  COGL_TEXTURE_NO_SLICING,
-                                                  CLUTTER_CAIRO_FORMAT_ARGB32);
+  g_clear_pointer (&priv->dirty_region, cairo_region_destroy);
 
   if (priv->texture == NULL)
     return;
@@ -353,8 +569,12 @@ clutter_canvas_paint_content (ClutterContent   *content,
   priv->dirty = FALSE;
 }
 
+/* if @clip is not %NULL, the contents of the buffer are preserved
+ * outside of it, and only @clip will be uploaded on the next paint
+ */
 static void
-clutter_canvas_emit_draw (ClutterCanvas *self)
+clutter_canvas_emit_draw (ClutterCanvas               *self,
+                          const cairo_rectangle_int_t *clip)
 {
   ClutterCanvasPrivate *priv = self->priv;
   cairo_surface_t *surface;
@@ -366,7 +586,13 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
 
   g_assert (priv->width > 0 && priv->width > 0);
 
-  priv->dirty = TRUE;
+  if (clip == NULL || priv->buffer == NULL)
+    {
+      clip = NULL;
+      priv->dirty = TRUE;
+
+      clutter_canvas_rotate_buffer (self);
+    }
 
   if (priv->buffer == NULL)
     {
@@ -387,7 +613,7 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
 
   data = cogl_buffer_map (buffer,
                           COGL_BUFFER_ACCESS_READ_WRITE,
-                          COGL_BUFFER_MAP_HINT_DISCARD);
+                          clip == NULL ? COGL_BUFFER_MAP_HINT_DISCARD : 0);
 
   if (data != NULL)
     {
@@ -407,10 +633,35 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
                                             priv->height);
 
       mapped_buffer = FALSE;
+
+      /* we cannot read back the previous contents */
+      clip = NULL;
+      priv->dirty = TRUE;
     }
 
   self->priv->cr = cr = cairo_create (surface);
 
+  if (clip != NULL)
+    {
+      cairo_rectangle (cr, clip->x, clip->y, clip->width, clip->height);
+      cairo_clip (cr);
+
+      cairo_save (cr);
+      cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+      cairo_paint (cr);
+      cairo_restore (cr);
+
+      if (!priv->dirty)
+        {
+          if (priv->dirty_region == NULL)
+            priv->dirty_region = cairo_region_create_rectangle (clip);
+          else
+            cairo_region_union_rectangle (priv->dirty_region, clip);
+        }
+    }
+  else
+    g_clear_pointer (&priv->dirty_region, cairo_region_destroy);
+
   g_signal_emit (self, canvas_signals[DRAW], 0,
                  cr, priv->width, priv->height,
                  &res);
@@ -441,22 +692,157 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
   cairo_surface_destroy (surface);
 }
 
+static void clutter_canvas_start_draw_job (ClutterCanvas *self);
+
+/* runs in the main thread, once the worker thread is done */
+static void
+clutter_canvas_draw_job_done (gpointer data)
+{
+  CanvasDrawJob *job = data;
+  ClutterCanvas *self = job->canvas;
+  ClutterCanvasPrivate *priv = self->priv;
+
+  g_assert (priv->draw_job == job);
+  priv->draw_job = NULL;
+
+  /* discard the results of a draw for a different size, unless
+   * another draw is already being queued
+   */
+  if (job->width == priv->width && job->height == priv->height)
+    {
+      CoglContext *ctx;
+
+      clutter_canvas_release_buffer (self);
+      clutter_canvas_release_spare_buffers (self);
+
+      ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+      priv->buffer =
+        cogl_bitmap_new_for_data (ctx,
+                                  job->width,
+                                  job->height,
+                                  CLUTTER_CAIRO_FORMAT_ARGB32,
+                                  cairo_image_surface_get_stride (job->surface),
+                                  cairo_image_surface_get_data (job->surface));
+      priv->buffer_surface = job->surface;
+      job->surface = NULL;
+
+      priv->dirty = TRUE;
+      g_clear_pointer (&priv->dirty_region, cairo_region_destroy);
+
+      _clutter_content_queue_redraw (CLUTTER_CONTENT (self));
+    }
+  else
+    priv->draw_pending = TRUE;
+
+  /* coalesce all the invalidations received while drawing */
+  if (priv->draw_pending && priv->threaded_draw)
+    clutter_canvas_start_draw_job (self);
+
+  if (job->surface != NULL)
+    cairo_surface_destroy (job->surface);
+
+  g_object_unref (job->canvas);
+  g_slice_free (CanvasDrawJob, job);
+}
+
+/* runs in a worker thread */
+static void
+clutter_canvas_draw_job_run (gpointer data)
+{
+  CanvasDrawJob *job = data;
+  gboolean res;
+  cairo_t *cr;
+
+  cr = cairo_create (job->surface);
+
+  g_signal_emit (job->canvas, canvas_signals[DRAW], 0,
+                 cr, job->width, job->height,
+                 &res);
+
+#ifdef CLUTTER_ENABLE_DEBUG
+  if (_clutter_diagnostic_enabled () && cairo_status (cr))
+    {
+      g_warning ("Drawing failed for <ClutterCanvas>[%p]: %s",
+                 job->canvas,
+                 cairo_status_to_string (cairo_status (cr)));
+    }
+#endif
+
+  cairo_destroy (cr);
+
+  cairo_surface_flush (job->surface);
+}
+
+static void
+clutter_canvas_start_draw_job (ClutterCanvas *self)
+{
+  ClutterCanvasPrivate *priv = self->priv;
+  CanvasDrawJob *job;
+
+  priv->draw_pending = FALSE;
+
+  if (priv->width <= 0 || priv->height <= 0)
+    return;
+
+  job = g_slice_new0 (CanvasDrawJob);
+  job->canvas = g_object_ref (self);
+  job->width = priv->width;
+  job->height = priv->height;
+  job->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                             job->width,
+                                             job->height);
+
+  priv->draw_job = job;
+
+  /* the job holds a reference on the canvas, so it cannot be cancelled;
+   * the new contents are applied before the stages are updated
+   */
+  clutter_threads_add_worker_task (NULL,
+                                   CLUTTER_WORKER_PRIORITY_VISIBLE,
+                                   CLUTTER_REPAINT_FLAGS_PRE_PAINT,
+                                   clutter_canvas_draw_job_run,
+                                   clutter_canvas_draw_job_done,
+                                   job,
+                                   NULL);
+}
+
 static void
 clutter_canvas_invalidate (ClutterContent *content)
 {
   ClutterCanvas *self = CLUTTER_CANVAS (content);
   ClutterCanvasPrivate *priv = self->priv;
 
-  if (priv->buffer != NULL)
+  if (priv->threaded_draw)
     {
-      cogl_object_unref (priv->buffer);
-      priv->buffer = NULL;
+      /* the current contents are kept until the new ones are ready;
+       * if a draw is already running we redraw once it's done
+       */
+      if (priv->draw_job != NULL)
+        priv->draw_pending = TRUE;
+      else
+        clutter_canvas_start_draw_job (self);
+
+      return;
+    }
+
+  /* partial redraws reuse the current buffer */
+  if (priv->invalidate_rect != NULL &&
+      priv->buffer != NULL &&
+      priv->buffer_surface == NULL)
+    {
+      clutter_canvas_emit_draw (self, priv->invalidate_rect);
+      return;
     }
 
   if (priv->width <= 0 || priv->height <= 0)
-    return;
+    {
+      clutter_canvas_release_buffer (self);
+      clutter_canvas_release_spare_buffers (self);
+      return;
+    }
 
-  clutter_canvas_emit_draw (self);
+  /* the buffer is rotated by the full redraw */
+  clutter_canvas_emit_draw (self, NULL);
 }
 
 static gboolean
@@ -555,3 +941,104 @@ clutter_canvas_set_size (ClutterCanvas *canvas,
 
   g_object_thaw_notify (obj);
 }
+
+/**
+ * clutter_canvas_invalidate_rect:
+ * @canvas: a #ClutterCanvas
+ * @rect: the area of the @canvas to redraw, in pixels
+ *
+ * Invalidates the area of @canvas described by @rect.
+ *
+ * Unlike clutter_content_invalidate(), which redraws the whole @canvas,
+ * this function preserves the current contents outside of @rect: the
+ * Cairo context passed to the #ClutterCanvas::draw signal is clipped
+ * to @rect, the clipped area is cleared before the signal emission, and
+ * only the redrawn area is uploaded to the texture on the next paint.
+ *
+ * If the @canvas has not been drawn yet, the whole @canvas is redrawn.
+ */
+void
+clutter_canvas_invalidate_rect (ClutterCanvas               *canvas,
+                                const cairo_rectangle_int_t *rect)
+{
+  ClutterCanvasPrivate *priv;
+  cairo_rectangle_int_t clip;
+
+  g_return_if_fail (CLUTTER_IS_CANVAS (canvas));
+  g_return_if_fail (rect != NULL);
+
+  priv = canvas->priv;
+
+  if (priv->width <= 0 || priv->height <= 0)
+    return;
+
+  clip.x = CLAMP (rect->x, 0, priv->width);
+  clip.y = CLAMP (rect->y, 0, priv->height);
+  clip.width = CLAMP (rect->x + rect->width, 0, priv->width) - clip.x;
+  clip.height = CLAMP (rect->y + rect->height, 0, priv->height) - clip.y;
+
+  if (clip.width <= 0 || clip.height <= 0)
+    return;
+
+  priv->invalidate_rect = &clip;
+  clutter_content_invalidate (CLUTTER_CONTENT (canvas));
+  priv->invalidate_rect = NULL;
+}
+
+/**
+ * clutter_canvas_set_threaded_draw:
+ * @canvas: a #ClutterCanvas
+ * @threaded_draw: whether to draw in a worker thread
+ *
+ * Sets whether the #ClutterCanvas::draw signal of @canvas should be
+ * emitted from a worker thread, so that complex drawing operations do
+ * not block the main loop.
+ *
+ * When drawing in a worker thread, each invalidation draws on a new
+ * image surface; the current contents of @canvas are painted until the
+ * new ones are ready, at which point they are swapped, and the actors
+ * using @canvas are queued for a redraw. Invalidations received while
+ * a draw is in progress are coalesced into a single redraw.
+ *
+ * The handlers of the #ClutterCanvas::draw signal must not call any
+ * Clutter API, and must protect any state they share with the main
+ * thread.
+ *
+ * Partial redraws through clutter_canvas_invalidate_rect() are not
+ * supported when drawing in a worker thread, and will redraw the
+ * whole @canvas.
+ */
+void
+clutter_canvas_set_threaded_draw (ClutterCanvas *canvas,
+                                  gboolean       threaded_draw)
+{
+  ClutterCanvasPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_CANVAS (canvas));
+
+  priv = canvas->priv;
+
+  threaded_draw = !!threaded_draw;
+  if (priv->threaded_draw == threaded_draw)
+    return;
+
+  priv->threaded_draw = threaded_draw;
+
+  g_object_notify_by_pspec (G_OBJECT (canvas), obj_props[PROP_THREADED_DRAW]);
+}
+
+/**
+ * clutter_canvas_get_threaded_draw:
+ * @canvas: a #ClutterCanvas
+ *
+ * Retrieves the value set using clutter_canvas_set_threaded_draw().
+ *
+ * Return value: %TRUE if the @canvas is drawn in a worker thread
+ */
+gboolean
+clutter_canvas_get_threaded_draw (ClutterCanvas *canvas)
+{
+  g_return_val_if_fail (CLUTTER_IS_CANVAS (canvas), FALSE);
+
+  return canvas->priv->threaded_draw;
+}
@@ -94,6 +94,11 @@ ClutterContent *        clutter_canvas_new              (void);
 void                    clutter_canvas_set_size         (ClutterCanvas *canvas,
                                                          int            width,
                                                          int            height);
+void                    clutter_canvas_invalidate_rect  (ClutterCanvas               *canvas,
+                                                         const cairo_rectangle_int_t *rect);
+void                    clutter_canvas_set_threaded_draw (ClutterCanvas *canvas,
+                                                          gboolean       threaded_draw);
+gboolean                clutter_canvas_get_threaded_draw (ClutterCanvas *canvas);
 
 G_END_DECLS
 
@@ -30,6 +30,11 @@
  *
  * #ClutterClone can be used to efficiently clone any other actor.
  *
+ * If the source actor is redirected offscreen, for instance using the
+ * #ClutterActor:offscreen-redirect property, and the clone does not
+ * need to paint it at a higher resolution, the clone paints the cached
+ * image of the source instead of painting the source again.
+ *
  * <note><para>This is different from clutter_texture_new_from_actor()
  * which requires support for FBOs in the underlying GL
  * implementation.</para></note>
@@ -41,15 +46,20 @@
 #include "config.h"
 #endif
 
+#define CLUTTER_ENABLE_EXPERIMENTAL_API
+
 #include "clutter-actor-private.h"
 #include "clutter-clone.h"
 #include "clutter-debug.h"
 #include "clutter-main.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-paint-volume-private.h"
 #include "clutter-private.h"
 
 #include "cogl/cogl.h"
 
+#include <math.h>
+
 G_DEFINE_TYPE (ClutterClone, clutter_clone, CLUTTER_TYPE_ACTOR);
 
 enum
@@ -68,6 +78,9 @@ static GParamSpec *obj_props[PROP_LAST];
 struct _ClutterClonePrivate
 {
   ClutterActor *clone_source;
+
+  /* used to paint the cached image of the source */
+  CoglPipeline *pipeline;
 };
 
 static void clutter_clone_set_source_internal (ClutterClone *clone,
@@ -153,6 +166,86 @@ clutter_clone_apply_transform (ClutterActor *self, CoglMatrix *matrix)
   cogl_matrix_scale (matrix, x_scale, y_scale, x_scale);
 }
 
+/* paints the image of the source cached by its offscreen redirection,
+ * if it is valid and if it does not need to be scaled up
+ */
+static gboolean
+clutter_clone_paint_cached_source (ClutterClone *self)
+{
+  ClutterClonePrivate *priv = self->priv;
+  ClutterActor *source = priv->clone_source;
+  ClutterActor *stage;
+  ClutterEffect *effect;
+  CoglMatrix view, inverse, modelview, matrix;
+  ClutterActorBox box;
+  CoglHandle texture;
+  gfloat source_scale, x_scale, y_scale;
+  guint8 paint_opacity;
+
+  effect = _clutter_actor_get_flatten_effect (source);
+  if (effect == NULL)
+    return FALSE;
+
+  /* the image is outdated if the source changed since it was painted */
+  if (!CLUTTER_ACTOR_IS_MAPPED (source) || _clutter_actor_is_damaged (source))
+    return FALSE;
+
+  if (!_clutter_offscreen_effect_get_cached_image (CLUTTER_OFFSCREEN_EFFECT (effect),
+                                                   &texture,
+                                                   &box,
+                                                   &source_scale))
+    return FALSE;
+
+  stage = _clutter_actor_get_stage_internal (CLUTTER_ACTOR (self));
+  if (stage == NULL)
+    return FALSE;
+
+  cogl_matrix_init_identity (&view);
+  _clutter_actor_apply_modelview_transform (stage, &view);
+  if (!cogl_matrix_get_inverse (&view, &inverse))
+    return FALSE;
+
+  cogl_get_modelview_matrix (&modelview);
+  cogl_matrix_multiply (&matrix, &inverse, &modelview);
+
+  /* painting the image bigger than it was painted for the source would
+   * make it blurry, so we need to paint the source again
+   */
+  x_scale = sqrtf (matrix.xx * matrix.xx + matrix.yx * matrix.yx);
+  y_scale = sqrtf (matrix.xy * matrix.xy + matrix.yy * matrix.yy);
+  if (MAX (x_scale, y_scale) > source_scale * 1.01f)
+    return FALSE;
+
+  if (priv->pipeline == NULL)
+    {
+      CoglContext *ctx =
+        clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+      priv->pipeline = cogl_pipeline_new (ctx);
+    }
+
+  CLUTTER_NOTE (PAINT, "painting the cached image of the source of clone '%s'",
+                _clutter_actor_get_debug_name (CLUTTER_ACTOR (self)));
+
+  paint_opacity = clutter_actor_get_paint_opacity (CLUTTER_ACTOR (self));
+
+  cogl_pipeline_set_color4ub (priv->pipeline,
+                              paint_opacity,
+                              paint_opacity,
+                              paint_opacity,
+                              paint_opacity);
+  cogl_pipeline_set_layer_texture (priv->pipeline, 0, texture);
+
+  cogl_push_source (priv->pipeline);
+  cogl_rectangle_with_texture_coords (box.x1, box.y1,
+                                      box.x2, box.y2,
+                                      0.0, 0.0,
+                                      1.0, 1.0);
+  cogl_pop_source ();
+
+  return TRUE;
+}
+
 static void
 clutter_clone_paint (ClutterActor *actor)
 {
@@ -166,6 +259,9 @@ clutter_clone_paint (ClutterActor *actor)
   CLUTTER_NOTE (PAINT, "painting clone actor '%s'",
                 _clutter_actor_get_debug_name (actor));
 
+  if (clutter_clone_paint_cached_source (self))
+    return;
+
   /* The final bits of magic:
    * - We need to override the paint opacity of the actor with our own
    *   opacity.
@@ -308,8 +404,16 @@ clutter_clone_get_property (GObject    *gobject,
 static void
 clutter_clone_dispose (GObject *gobject)
 {
+  ClutterClonePrivate *priv = CLUTTER_CLONE (gobject)->priv;
+
   clutter_clone_set_source_internal (CLUTTER_CLONE (gobject), NULL);
 
+  if (priv->pipeline != NULL)
+    {
+      cogl_object_unref (priv->pipeline);
+      priv->pipeline = NULL;
+    }
+
   G_OBJECT_CLASS (clutter_clone_parent_class)->dispose (gobject);
 }
 
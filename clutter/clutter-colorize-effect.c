@@ -50,6 +50,7 @@
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
 #include "clutter-offscreen-effect.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-private.h"
 
 struct _ClutterColorizeEffect
@@ -72,6 +73,7 @@ struct _ClutterColorizeEffectClass
   ClutterOffscreenEffectClass parent_class;
 
   CoglPipeline *base_pipeline;
+  CoglSnippet *snippet;
 };
 
 /* the magic gray vec3 has been taken from the NTSC conversion weights
@@ -257,7 +259,8 @@ clutter_colorize_effect_class_init (ClutterColorizeEffectClass *klass)
 }
 
 static void
-update_tint_uniform (ClutterColorizeEffect *self)
+update_tint_uniform (ClutterColorizeEffect *self,
+                     CoglPipeline          *pipeline)
 {
   if (self->tint_uniform > -1)
     {
@@ -267,7 +270,7 @@ update_tint_uniform (ClutterColorizeEffect *self)
         self->tint.blue / 255.0
       };
 
-      cogl_pipeline_set_uniform_float (self->pipeline,
+      cogl_pipeline_set_uniform_float (pipeline,
                                        self->tint_uniform,
                                        3, /* n_components */
                                        1, /* count */
@@ -275,6 +278,13 @@ update_tint_uniform (ClutterColorizeEffect *self)
     }
 }
 
+static void
+clutter_colorize_effect_update_uniforms (ClutterOffscreenEffect *effect,
+                                         CoglPipeline           *pipeline)
+{
+  update_tint_uniform (CLUTTER_COLORIZE_EFFECT (effect), pipeline);
+}
+
 static void
 clutter_colorize_effect_init (ClutterColorizeEffect *self)
 {
@@ -292,7 +302,9 @@ clutter_colorize_effect_init (ClutterColorizeEffect *self)
                                   colorize_glsl_declarations,
                                   colorize_glsl_source);
       cogl_pipeline_add_snippet (klass->base_pipeline, snippet);
-      cogl_object_unref (snippet);
+
+      /* the snippet is also used when fusing the effect with others */
+      klass->snippet = snippet;
 
       cogl_pipeline_set_layer_null_texture (klass->base_pipeline,
                                             0, /* layer number */
@@ -301,12 +313,16 @@ clutter_colorize_effect_init (ClutterColorizeEffect *self)
 
   self->pipeline = cogl_pipeline_copy (klass->base_pipeline);
 
+  _clutter_offscreen_effect_set_fragment_snippet (CLUTTER_OFFSCREEN_EFFECT (self),
+                                                  klass->snippet,
+                                                  clutter_colorize_effect_update_uniforms);
+
   self->tint_uniform =
     cogl_pipeline_get_uniform_location (self->pipeline, "tint");
 
   self->tint = default_tint;
 
-  update_tint_uniform (self);
+  update_tint_uniform (self, self->pipeline);
 }
 
 /**
@@ -345,7 +361,7 @@ clutter_colorize_effect_set_tint (ClutterColorizeEffect *effect,
 
   effect->tint = *tint;
 
-  update_tint_uniform (effect);
+  update_tint_uniform (effect, effect->pipeline);
 
   clutter_effect_queue_repaint (CLUTTER_EFFECT (effect));
 
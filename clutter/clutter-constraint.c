@@ -145,7 +145,10 @@
 
 #include "clutter-actor.h"
 #include "clutter-actor-meta-private.h"
+#include "clutter-align-constraint.h"
+#include "clutter-bind-constraint.h"
 #include "clutter-private.h"
+#include "clutter-snap-constraint.h"
 
 G_DEFINE_ABSTRACT_TYPE (ClutterConstraint,
                         clutter_constraint,
@@ -203,3 +206,28 @@ _clutter_constraint_update_allocation (ClutterConstraint *constraint,
                                                                 actor,
                                                                 allocation);
 }
+
+/*< private >
+ * _clutter_constraint_get_source:
+ * @constraint: a #ClutterConstraint
+ *
+ * Retrieves the actor whose allocation is used by @constraint, for
+ * the constraints provided by Clutter.
+ *
+ * Return value: (transfer none): the source of @constraint, or %NULL
+ *   if it does not have one or if it is not known
+ */
+ClutterActor *
+_clutter_constraint_get_source (ClutterConstraint *constraint)
+{
+  if (CLUTTER_IS_BIND_CONSTRAINT (constraint))
+    return clutter_bind_constraint_get_source (CLUTTER_BIND_CONSTRAINT (constraint));
+
+  if (CLUTTER_IS_ALIGN_CONSTRAINT (constraint))
+    return clutter_align_constraint_get_source (CLUTTER_ALIGN_CONSTRAINT (constraint));
+
+  if (CLUTTER_IS_SNAP_CONSTRAINT (constraint))
+    return clutter_snap_constraint_get_source (CLUTTER_SNAP_CONSTRAINT (constraint));
+
+  return NULL;
+}
@@ -38,6 +38,14 @@ void            _clutter_content_paint_content          (ClutterContent   *conte
                                                          ClutterActor     *actor,
                                                          ClutterPaintNode *node);
 
+gboolean        _clutter_content_is_opaque              (ClutterContent   *content);
+
+void            _clutter_content_queue_redraw           (ClutterContent   *content);
+
+void            _clutter_content_set_view_dependent     (ClutterContent   *content,
+                                                         gboolean          view_dependent);
+gboolean        _clutter_content_is_view_dependent      (ClutterContent   *content);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_CONTENT_PRIVATE_H__ */
@@ -57,6 +57,7 @@ enum
 };
 
 static GQuark quark_content_actors = 0;
+static GQuark quark_content_view_dependent = 0;
 
 static guint content_signals[LAST_SIGNAL] = { 0, };
 
@@ -93,6 +94,12 @@ clutter_content_real_invalidate (ClutterContent *content)
 {
 }
 
+static gboolean
+clutter_content_real_is_opaque (ClutterContent *content)
+{
+  return FALSE;
+}
+
 static void
 clutter_content_real_paint_content (ClutterContent   *content,
                                     ClutterActor     *actor,
@@ -104,12 +111,15 @@ static void
 clutter_content_default_init (ClutterContentInterface *iface)
 {
   quark_content_actors = g_quark_from_static_string ("-clutter-content-actors");
+  quark_content_view_dependent =
+    g_quark_from_static_string ("-clutter-content-view-dependent");
 
   iface->get_preferred_size = clutter_content_real_get_preferred_size;
   iface->paint_content = clutter_content_real_paint_content;
   iface->attached = clutter_content_real_attached;
   iface->detached = clutter_content_real_detached;
   iface->invalidate = clutter_content_real_invalidate;
+  iface->is_opaque = clutter_content_real_is_opaque;
 
   /**
    * ClutterContent::attached:
@@ -167,14 +177,31 @@ clutter_content_default_init (ClutterContentInterface *iface)
 void
 clutter_content_invalidate (ClutterContent *content)
 {
-  GHashTable *actors;
-  GHashTableIter iter;
-  gpointer key_p, value_p;
-
   g_return_if_fail (CLUTTER_IS_CONTENT (content));
 
   CLUTTER_CONTENT_GET_IFACE (content)->invalidate (content);
 
+  _clutter_content_queue_redraw (content);
+}
+
+/*< private >
+ * _clutter_content_queue_redraw:
+ * @content: a #ClutterContent
+ *
+ * Queues a redraw of all the actors using @content, without
+ * invalidating it.
+ *
+ * This function should be used by contents that update their
+ * state outside of the #ClutterContentIface.invalidate() virtual
+ * function, for instance once an asynchronous operation is done.
+ */
+void
+_clutter_content_queue_redraw (ClutterContent *content)
+{
+  GHashTable *actors;
+  GHashTableIter iter;
+  gpointer key_p, value_p;
+
   actors = g_object_get_qdata (G_OBJECT (content), quark_content_actors);
   if (actors == NULL)
     return;
@@ -275,6 +302,61 @@ _clutter_content_paint_content (ClutterContent   *content,
   CLUTTER_CONTENT_GET_IFACE (content)->paint_content (content, actor, node);
 }
 
+/*< private >
+ * _clutter_content_is_opaque:
+ * @content: a #ClutterContent
+ *
+ * Checks whether @content paints only opaque pixels over the whole
+ * content box of the actors using it.
+ *
+ * This function will invoke the #ClutterContentIface.is_opaque()
+ * virtual function.
+ *
+ * Return value: %TRUE if the content is opaque
+ */
+gboolean
+_clutter_content_is_opaque (ClutterContent *content)
+{
+  return CLUTTER_CONTENT_GET_IFACE (content)->is_opaque (content);
+}
+
+/*< private >
+ * _clutter_content_set_view_dependent:
+ * @content: a #ClutterContent
+ * @view_dependent: whether the paint nodes depend on the view
+ *
+ * Marks @content as painting different paint nodes depending on the
+ * position of the actors using it on the stage, for instance because
+ * it only paints what is visible.
+ *
+ * The render tree of the actors using a view dependent content is
+ * built again on every paint, instead of being retained.
+ */
+void
+_clutter_content_set_view_dependent (ClutterContent *content,
+                                     gboolean        view_dependent)
+{
+  g_object_set_qdata (G_OBJECT (content),
+                      quark_content_view_dependent,
+                      GUINT_TO_POINTER (!!view_dependent));
+}
+
+/*< private >
+ * _clutter_content_is_view_dependent:
+ * @content: a #ClutterContent
+ *
+ * Checks whether @content has been marked using
+ * _clutter_content_set_view_dependent().
+ *
+ * Return value: %TRUE if the paint nodes of @content depend on the view
+ */
+gboolean
+_clutter_content_is_view_dependent (ClutterContent *content)
+{
+  return g_object_get_qdata (G_OBJECT (content),
+                             quark_content_view_dependent) != NULL;
+}
+
 /**
  * clutter_content_get_preferred_size:
  * @content: a #ClutterContent
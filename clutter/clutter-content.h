@@ -61,6 +61,9 @@ typedef struct _ClutterContentIface     ClutterContentIface;
  *   from a #ClutterActor.
  * @invalidate: virtual function; called each time a #ClutterContent state
  *   is changed.
+ * @is_opaque: virtual function; should be overridden by subclasses of
+ *   #ClutterContent that fully cover the content box of the actor with
+ *   opaque pixels
  *
  * The <structname>ClutterContentIface</structname> structure contains only
  * private data.
@@ -86,6 +89,8 @@ struct _ClutterContentIface
                                          ClutterActor     *actor);
 
   void          (* invalidate)          (ClutterContent   *content);
+
+  gboolean      (* is_opaque)           (ClutterContent   *content);
 };
 
 
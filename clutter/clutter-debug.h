@@ -23,7 +23,10 @@ typedef enum {
   CLUTTER_DEBUG_PICK                = 1 << 13,
   CLUTTER_DEBUG_EVENTLOOP           = 1 << 14,
   CLUTTER_DEBUG_CLIPPING            = 1 << 15,
-  CLUTTER_DEBUG_OOB_TRANSFORMS      = 1 << 16
+  CLUTTER_DEBUG_OOB_TRANSFORMS      = 1 << 16,
+  CLUTTER_DEBUG_MEMORY              = 1 << 17,
+  CLUTTER_DEBUG_HUD                 = 1 << 18,
+  CLUTTER_DEBUG_STARTUP             = 1 << 19
 } ClutterDebugFlag;
 
 typedef enum {
@@ -39,7 +42,11 @@ typedef enum {
   CLUTTER_DEBUG_DISABLE_CULLING         = 1 << 4,
   CLUTTER_DEBUG_DISABLE_OFFSCREEN_REDIRECT = 1 << 5,
   CLUTTER_DEBUG_CONTINUOUS_REDRAW       = 1 << 6,
-  CLUTTER_DEBUG_PAINT_DEFORM_TILES      = 1 << 7
+  CLUTTER_DEBUG_PAINT_DEFORM_TILES      = 1 << 7,
+  CLUTTER_DEBUG_INPUT_LATENCY           = 1 << 8,
+  CLUTTER_DEBUG_ACTOR_COST              = 1 << 9,
+  CLUTTER_DEBUG_REDRAW_CAUSES           = 1 << 10,
+  CLUTTER_DEBUG_REDRAW_BACKTRACES       = 1 << 11
 } ClutterDrawDebugFlag;
 
 #ifdef CLUTTER_ENABLE_DEBUG
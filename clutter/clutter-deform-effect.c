@@ -47,6 +47,18 @@
  *   Each passed vertex is an in-out parameter that initially contains the
  *   position of the vertex and should be modified according to a specific
  *   deformation algorithm.</para>
+ *   <para>Alternatively, sub-classes can override the
+ *   #ClutterDeformEffectClass.create_vertex_snippet() virtual function to
+ *   deform the vertices on the GPU. The returned snippet should use the
+ *   %COGL_SNIPPET_HOOK_VERTEX hook; the tiles are submitted once, with
+ *   <varname>cogl_position_in</varname> going from (0, 0) to (1, 1)
+ *   over the actor, and the snippet can use the
+ *   <varname>clutter_deform_size</varname> uniform, containing the size
+ *   of the actor, to compute <varname>cogl_position_out</varname>. Any
+ *   other uniform, like the parameters of the deformation, should be set
+ *   inside the #ClutterDeformEffectClass.update_vertex_uniforms() virtual
+ *   function. When using a vertex snippet, changing the parameters of
+ *   the effect does not require uploading the vertices again.</para>
  * </refsect2>
  *
  * #ClutterDeformEffect is available since Clutter 1.4
@@ -72,6 +84,11 @@ struct _ClutterDeformEffectPrivate
 {
   CoglPipeline *back_pipeline;
 
+  /* the GPU deformation, if the sub-class provides a vertex snippet */
+  CoglSnippet *vertex_snippet;
+  CoglSnippet *size_snippet;
+  CoglPipeline *front_pipeline;
+
   gint x_tiles;
   gint y_tiles;
 
@@ -130,6 +147,36 @@ clutter_deform_effect_deform_vertex (ClutterDeformEffect *effect,
                                                            vertex);
 }
 
+static void
+clutter_deform_effect_add_vertex_snippets (ClutterDeformEffect *self,
+                                           CoglPipeline        *pipeline)
+{
+  ClutterDeformEffectPrivate *priv = self->priv;
+
+  cogl_pipeline_add_snippet (pipeline, priv->size_snippet);
+  cogl_pipeline_add_snippet (pipeline, priv->vertex_snippet);
+}
+
+static void
+clutter_deform_effect_update_vertex_uniforms (ClutterDeformEffect *self,
+                                              CoglPipeline        *pipeline,
+                                              gfloat               width,
+                                              gfloat               height)
+{
+  ClutterDeformEffectClass *klass = CLUTTER_DEFORM_EFFECT_GET_CLASS (self);
+  float size[2] = { width, height };
+
+  cogl_pipeline_set_uniform_float (pipeline,
+                                   cogl_pipeline_get_uniform_location (pipeline,
+                                                                       "clutter_deform_size"),
+                                   2, /* n_components */
+                                   1, /* count */
+                                   size);
+
+  if (klass->update_vertex_uniforms != NULL)
+    klass->update_vertex_uniforms (self, pipeline, width, height);
+}
+
 static void
 vbo_invalidate (ClutterActor           *actor,
                 const ClutterActorBox  *allocation,
@@ -177,31 +224,32 @@ clutter_deform_effect_paint_target (ClutterOffscreenEffect *effect)
   CoglPipeline *pipeline;
   CoglDepthState depth_state;
   CoglFramebuffer *fb = cogl_get_draw_framebuffer ();
+  ClutterActor *actor;
+  ClutterRect rect;
+  gfloat width, height;
+  guint opacity;
+
+  actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
+  opacity = clutter_actor_get_paint_opacity (actor);
 
-  if (priv->is_dirty)
+  /* if we don't have a target size, fall back to the actor's
+   * allocation, though wrong it might be
+   */
+  if (clutter_offscreen_effect_get_target_rect (effect, &rect))
+    {
+      width = clutter_rect_get_width (&rect);
+      height = clutter_rect_get_height (&rect);
+    }
+  else
+    clutter_actor_get_size (actor, &width, &height);
+
+  /* the vertices deformed on the GPU never change */
+  if (priv->is_dirty && priv->vertex_snippet == NULL)
     {
-      ClutterRect rect;
       gboolean mapped_buffer;
       CoglVertexP3T2C4 *verts;
-      ClutterActor *actor;
-      gfloat width, height;
-      guint opacity;
       gint i, j;
 
-      actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
-      opacity = clutter_actor_get_paint_opacity (actor);
-
-      /* if we don't have a target size, fall back to the actor's
-       * allocation, though wrong it might be
-       */
-      if (clutter_offscreen_effect_get_target_rect (effect, &rect))
-        {
-          width = clutter_rect_get_width (&rect);
-          height = clutter_rect_get_height (&rect);
-        }
-      else
-        clutter_actor_get_size (actor, &width, &height);
-
       /* XXX ideally, the sub-classes should tell us what they
        * changed in the texture vertices; we then would be able to
        * avoid resubmitting the same data, if it did not change. for
@@ -275,12 +323,41 @@ clutter_deform_effect_paint_target (ClutterOffscreenEffect *effect)
                                 sizeof (*verts) * priv->n_vertices);
           g_free (verts);
         }
-
-      priv->is_dirty = FALSE;
     }
 
-  material = clutter_offscreen_effect_get_target (effect);
-  pipeline = COGL_PIPELINE (material);
+  priv->is_dirty = FALSE;
+
+  if (priv->vertex_snippet != NULL)
+    {
+      if (priv->front_pipeline == NULL)
+        {
+          CoglContext *ctx =
+            clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+          priv->front_pipeline = cogl_pipeline_new (ctx);
+          cogl_pipeline_set_layer_filters (priv->front_pipeline, 0,
+                                           COGL_PIPELINE_FILTER_NEAREST,
+                                           COGL_PIPELINE_FILTER_NEAREST);
+          clutter_deform_effect_add_vertex_snippets (self, priv->front_pipeline);
+        }
+
+      material = clutter_offscreen_effect_get_texture (effect);
+      if (material != NULL)
+        cogl_pipeline_set_layer_texture (priv->front_pipeline, 0, material);
+
+      /* there are no per-vertex colors */
+      cogl_pipeline_set_color4ub (priv->front_pipeline,
+                                  opacity, opacity, opacity, opacity);
+      clutter_deform_effect_update_vertex_uniforms (self, priv->front_pipeline,
+                                                    width, height);
+
+      pipeline = priv->front_pipeline;
+    }
+  else
+    {
+      material = clutter_offscreen_effect_get_target (effect);
+      pipeline = COGL_PIPELINE (material);
+    }
 
   /* enable depth testing */
   cogl_depth_state_init (&depth_state);
@@ -305,6 +382,16 @@ clutter_deform_effect_paint_target (ClutterOffscreenEffect *effect)
          instead we make a temporary copy */
       back_pipeline = cogl_pipeline_copy (priv->back_pipeline);
       cogl_pipeline_set_depth_state (back_pipeline, &depth_state, NULL);
+
+      if (priv->vertex_snippet != NULL)
+        {
+          clutter_deform_effect_add_vertex_snippets (self, back_pipeline);
+          cogl_pipeline_set_color4ub (back_pipeline,
+                                      opacity, opacity, opacity, opacity);
+          clutter_deform_effect_update_vertex_uniforms (self, back_pipeline,
+                                                        width, height);
+        }
+
       cogl_pipeline_set_cull_face_mode (pipeline,
                                         COGL_PIPELINE_CULL_FACE_MODE_FRONT);
 
@@ -319,6 +406,14 @@ clutter_deform_effect_paint_target (ClutterOffscreenEffect *effect)
         clutter_backend_get_cogl_context (clutter_get_default_backend ());
       CoglPipeline *lines_pipeline = cogl_pipeline_new (ctx);
       cogl_pipeline_set_color4f (lines_pipeline, 1.0, 0, 0, 1.0);
+
+      if (priv->vertex_snippet != NULL)
+        {
+          clutter_deform_effect_add_vertex_snippets (self, lines_pipeline);
+          clutter_deform_effect_update_vertex_uniforms (self, lines_pipeline,
+                                                        width, height);
+        }
+
       cogl_framebuffer_draw_primitive (fb, lines_pipeline,
                                        priv->lines_primitive);
       cogl_object_unref (lines_pipeline);
@@ -349,6 +444,78 @@ clutter_deform_effect_free_arrays (ClutterDeformEffect *self)
     }
 }
 
+/* the vertices deformed by a vertex snippet are a regular grid over the
+ * unit square, which is uploaded only once
+ */
+static void
+clutter_deform_effect_init_static_arrays (ClutterDeformEffect *self,
+                                          CoglIndices         *indices,
+                                          gint                 n_indices)
+{
+  ClutterDeformEffectPrivate *priv = self->priv;
+  CoglContext *ctx =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  CoglAttribute *attributes[2];
+  CoglVertexP3T2 *verts, *vertex;
+  gint i, j;
+
+  verts = vertex = g_new (CoglVertexP3T2, priv->n_vertices);
+
+  for (i = 0; i < priv->y_tiles + 1; i++)
+    {
+      for (j = 0; j < priv->x_tiles + 1; j++, vertex++)
+        {
+          vertex->s = vertex->x = (float) j / priv->x_tiles;
+          vertex->t = vertex->y = (float) i / priv->y_tiles;
+          vertex->z = 0.0f;
+        }
+    }
+
+  priv->buffer =
+    cogl_attribute_buffer_new (ctx,
+                               sizeof (CoglVertexP3T2) * priv->n_vertices,
+                               verts);
+  cogl_buffer_set_update_hint (COGL_BUFFER (priv->buffer),
+                               COGL_BUFFER_UPDATE_HINT_STATIC);
+
+  g_free (verts);
+
+  attributes[0] = cogl_attribute_new (priv->buffer,
+                                      "cogl_position_in",
+                                      sizeof (CoglVertexP3T2),
+                                      G_STRUCT_OFFSET (CoglVertexP3T2, x),
+                                      3, /* n_components */
+                                      COGL_ATTRIBUTE_TYPE_FLOAT);
+  attributes[1] = cogl_attribute_new (priv->buffer,
+                                      "cogl_tex_coord0_in",
+                                      sizeof (CoglVertexP3T2),
+                                      G_STRUCT_OFFSET (CoglVertexP3T2, s),
+                                      2, /* n_components */
+                                      COGL_ATTRIBUTE_TYPE_FLOAT);
+
+  priv->primitive =
+    cogl_primitive_new_with_attributes (COGL_VERTICES_MODE_TRIANGLE_STRIP,
+                                        priv->n_vertices,
+                                        attributes,
+                                        2 /* n_attributes */);
+  cogl_primitive_set_indices (priv->primitive, indices, n_indices);
+
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_PAINT_DEFORM_TILES))
+    {
+      priv->lines_primitive =
+        cogl_primitive_new_with_attributes (COGL_VERTICES_MODE_LINE_STRIP,
+                                            priv->n_vertices,
+                                            attributes,
+                                            1 /* n_attributes */);
+      cogl_primitive_set_indices (priv->lines_primitive, indices, n_indices);
+    }
+
+  cogl_object_unref (attributes[0]);
+  cogl_object_unref (attributes[1]);
+
+  priv->is_dirty = TRUE;
+}
+
 static void
 clutter_deform_effect_init_arrays (ClutterDeformEffect *self)
 {
@@ -430,6 +597,13 @@ clutter_deform_effect_init_arrays (ClutterDeformEffect *self)
 
   priv->n_vertices = (priv->x_tiles + 1) * (priv->y_tiles + 1);
 
+  if (priv->vertex_snippet != NULL)
+    {
+      clutter_deform_effect_init_static_arrays (self, indices, n_indices);
+      cogl_object_unref (indices);
+      return;
+    }
+
   priv->buffer =
     cogl_attribute_buffer_new (ctx,
                                sizeof (CoglVertexP3T2C4) *
@@ -509,9 +683,44 @@ clutter_deform_effect_finalize (GObject *gobject)
   clutter_deform_effect_free_arrays (self);
   clutter_deform_effect_free_back_pipeline (self);
 
+  if (self->priv->front_pipeline != NULL)
+    cogl_object_unref (self->priv->front_pipeline);
+
+  if (self->priv->vertex_snippet != NULL)
+    {
+      cogl_object_unref (self->priv->vertex_snippet);
+      cogl_object_unref (self->priv->size_snippet);
+    }
+
   G_OBJECT_CLASS (clutter_deform_effect_parent_class)->finalize (gobject);
 }
 
+static void
+clutter_deform_effect_constructed (GObject *gobject)
+{
+  ClutterDeformEffect *self = CLUTTER_DEFORM_EFFECT (gobject);
+  ClutterDeformEffectClass *klass = CLUTTER_DEFORM_EFFECT_GET_CLASS (self);
+  ClutterDeformEffectPrivate *priv = self->priv;
+
+  /* sub-classes providing a vertex snippet still need to implement
+   * deform_vertex() for the drivers without GLSL support
+   */
+  if (klass->create_vertex_snippet != NULL &&
+      clutter_feature_available (CLUTTER_FEATURE_SHADERS_GLSL))
+    priv->vertex_snippet = klass->create_vertex_snippet (self);
+
+  if (priv->vertex_snippet != NULL)
+    priv->size_snippet =
+      cogl_snippet_new (COGL_SNIPPET_HOOK_VERTEX,
+                        "uniform vec2 clutter_deform_size;\n",
+                        NULL);
+
+  clutter_deform_effect_init_arrays (self);
+
+  if (G_OBJECT_CLASS (clutter_deform_effect_parent_class)->constructed != NULL)
+    G_OBJECT_CLASS (clutter_deform_effect_parent_class)->constructed (gobject);
+}
+
 static void
 clutter_deform_effect_set_property (GObject      *gobject,
                                     guint         prop_id,
@@ -630,6 +839,7 @@ clutter_deform_effect_class_init (ClutterDeformEffectClass *klass)
                         COGL_TYPE_HANDLE,
                         CLUTTER_PARAM_READWRITE);
 
+  gobject_class->constructed = clutter_deform_effect_constructed;
   gobject_class->finalize = clutter_deform_effect_finalize;
   gobject_class->set_property = clutter_deform_effect_set_property;
   gobject_class->get_property = clutter_deform_effect_get_property;
@@ -650,8 +860,6 @@ clutter_deform_effect_init (ClutterDeformEffect *self)
 
   self->priv->x_tiles = self->priv->y_tiles = DEFAULT_N_TILES;
   self->priv->back_pipeline = NULL;
-
-  clutter_deform_effect_init_arrays (self);
 }
 
 /**
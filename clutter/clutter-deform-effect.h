@@ -65,6 +65,12 @@ struct _ClutterDeformEffect
  * ClutterDeformEffectClass:
  * @deform_vertex: virtual function; sub-classes should override this
  *   function to compute the deformation of each vertex
+ * @create_vertex_snippet: virtual function; sub-classes can override this
+ *   function to return a newly created #CoglSnippet computing the
+ *   deformation on the GPU, instead of using @deform_vertex
+ * @update_vertex_uniforms: virtual function; sub-classes using a vertex
+ *   snippet should override this function to set the uniforms used by
+ *   the snippet on the passed #CoglPipeline
  *
  * The <structname>ClutterDeformEffectClass</structname> structure contains
  * only private data
@@ -82,9 +88,13 @@ struct _ClutterDeformEffectClass
                           gfloat               height,
                           CoglTextureVertex   *vertex);
 
+  CoglHandle (* create_vertex_snippet)  (ClutterDeformEffect *effect);
+  void       (* update_vertex_uniforms) (ClutterDeformEffect *effect,
+                                         CoglHandle           pipeline,
+                                         gfloat               width,
+                                         gfloat               height);
+
   /*< private >*/
-  void (*_clutter_deform1) (void);
-  void (*_clutter_deform2) (void);
   void (*_clutter_deform3) (void);
   void (*_clutter_deform4) (void);
   void (*_clutter_deform5) (void);
@@ -54,6 +54,7 @@
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
 #include "clutter-offscreen-effect.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-private.h"
 
 struct _ClutterDesaturateEffect
@@ -76,6 +77,7 @@ struct _ClutterDesaturateEffectClass
   ClutterOffscreenEffectClass parent_class;
 
   CoglPipeline *base_pipeline;
+  CoglSnippet *snippet;
 };
 
 /* the magic gray vec3 has been taken from the NTSC conversion weights
@@ -237,10 +239,11 @@ clutter_desaturate_effect_get_property (GObject    *gobject,
 }
 
 static void
-update_factor_uniform (ClutterDesaturateEffect *self)
+update_factor_uniform (ClutterDesaturateEffect *self,
+                       CoglPipeline            *pipeline)
 {
   if (self->factor_uniform > -1)
-    cogl_pipeline_set_uniform_1f (self->pipeline,
+    cogl_pipeline_set_uniform_1f (pipeline,
                                   self->factor_uniform,
                                   self->factor);
 }
@@ -280,6 +283,13 @@ clutter_desaturate_effect_class_init (ClutterDesaturateEffectClass *klass)
   g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
 }
 
+static void
+clutter_desaturate_effect_update_uniforms (ClutterOffscreenEffect *effect,
+                                           CoglPipeline           *pipeline)
+{
+  update_factor_uniform (CLUTTER_DESATURATE_EFFECT (effect), pipeline);
+}
+
 static void
 clutter_desaturate_effect_init (ClutterDesaturateEffect *self)
 {
@@ -297,7 +307,9 @@ clutter_desaturate_effect_init (ClutterDesaturateEffect *self)
                                   desaturate_glsl_declarations,
                                   desaturate_glsl_source);
       cogl_pipeline_add_snippet (klass->base_pipeline, snippet);
-      cogl_object_unref (snippet);
+
+      /* the snippet is also used when fusing the effect with others */
+      klass->snippet = snippet;
 
       cogl_pipeline_set_layer_null_texture (klass->base_pipeline,
                                             0, /* layer number */
@@ -306,12 +318,16 @@ clutter_desaturate_effect_init (ClutterDesaturateEffect *self)
 
   self->pipeline = cogl_pipeline_copy (klass->base_pipeline);
 
+  _clutter_offscreen_effect_set_fragment_snippet (CLUTTER_OFFSCREEN_EFFECT (self),
+                                                  klass->snippet,
+                                                  clutter_desaturate_effect_update_uniforms);
+
   self->factor_uniform =
     cogl_pipeline_get_uniform_location (self->pipeline, "factor");
 
   self->factor = 1.0;
 
-  update_factor_uniform (self);
+  update_factor_uniform (self, self->pipeline);
 }
 
 /**
@@ -355,7 +371,7 @@ clutter_desaturate_effect_set_factor (ClutterDesaturateEffect *effect,
   if (fabsf (effect->factor - factor) >= 0.00001)
     {
       effect->factor = factor;
-      update_factor_uniform (effect);
+      update_factor_uniform (effect, effect->pipeline);
 
       clutter_effect_queue_repaint (CLUTTER_EFFECT (effect));
 
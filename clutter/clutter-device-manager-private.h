@@ -60,6 +60,23 @@ typedef struct _ClutterScrollInfo
   guint last_value_valid : 1;
 } ClutterScrollInfo;
 
+/* the last pick of a pointer or touch point: the pick will return
+ * the same actor while the point is inside the region, and the pick
+ * generation of the stage is the same
+ */
+typedef struct _ClutterPickRegion
+{
+  ClutterActor *actor;
+  ClutterActorBox box;
+  guint generation;
+} ClutterPickRegion;
+
+/* the number of touch sequences tracked in the slot array of a device;
+ * the sequences of the evdev backend are the MT slots plus one, so they
+ * map directly to a slot, and the others go into a hash table
+ */
+#define CLUTTER_INPUT_DEVICE_N_TOUCH_SLOTS      16
+
 typedef struct _ClutterTouchInfo
 {
   ClutterEventSequence *sequence;
@@ -67,6 +84,8 @@ typedef struct _ClutterTouchInfo
 
   gint current_x;
   gint current_y;
+
+  ClutterPickRegion pick_region;
 } ClutterTouchInfo;
 
 struct _ClutterInputDevice
@@ -93,6 +112,9 @@ struct _ClutterInputDevice
   ClutterActor *cursor_actor;
   GHashTable   *inv_touch_sequence_actors;
 
+  /* the region of the last pick of the pointer */
+  ClutterPickRegion pick_region;
+
   /* the actor that has a grab in place for the device */
   ClutterActor *pointer_grab_actor;
   ClutterActor *keyboard_grab_actor;
@@ -112,8 +134,14 @@ struct _ClutterInputDevice
   gint current_button_number;
   ClutterModifierType current_state;
 
-  /* the current touch points states */
+  /* the current touch points states: the slot array is allocated with
+   * the first touch point, and is indexed by the sequence minus one; a
+   * slot is free if its sequence is NULL. The other sequences are kept
+   * in the touch_sequences_info hash table, created on demand
+   */
+  ClutterTouchInfo *touch_slots;
   GHashTable *touch_sequences_info;
+  guint n_touch_sequences;
 
   /* the previous state, used for click count generation */
   gint previous_x;
@@ -182,6 +210,7 @@ void            _clutter_input_device_set_actor                 (ClutterInputDev
 ClutterActor *  _clutter_input_device_update                    (ClutterInputDevice   *device,
                                                                  ClutterEventSequence *sequence,
                                                                  gboolean              emit_crossing);
+ClutterActor *  _clutter_input_device_update_async              (ClutterInputDevice   *device);
 void            _clutter_input_device_set_n_keys                (ClutterInputDevice   *device,
                                                                  guint                 n_keys);
 guint           _clutter_input_device_add_axis                  (ClutterInputDevice   *device,
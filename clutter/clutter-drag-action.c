@@ -111,10 +111,18 @@ struct _ClutterDragActionPrivate
   gfloat transformed_press_x;
   gfloat transformed_press_y;
 
+  /* the actor moved through its translation, and the translation
+   * it had when the drag began
+   */
+  ClutterActor *translated_handle;
+  gfloat translation_x;
+  gfloat translation_y;
+
   guint emit_delayed_press    : 1;
   guint in_drag               : 1;
   guint motion_events_enabled : 1;
   guint drag_area_set         : 1;
+  guint use_translation       : 1;
 };
 
 enum
@@ -127,6 +135,7 @@ enum
   PROP_DRAG_AXIS,
   PROP_DRAG_AREA,
   PROP_DRAG_AREA_SET,
+  PROP_USE_TRANSLATION,
 
   PROP_LAST
 };
@@ -288,6 +297,38 @@ emit_drag_motion (ClutterDragAction *action,
     }
 }
 
+/* moves the actor dragged through its translation to its final
+ * position, and restores the translation it had when the drag began
+ */
+static void
+clutter_drag_action_commit_translation (ClutterDragAction *action)
+{
+  ClutterDragActionPrivate *priv = action->priv;
+  ClutterActor *handle = priv->translated_handle;
+  gfloat x, y, tx, ty, tz;
+
+  if (handle == NULL)
+    return;
+
+  priv->translated_handle = NULL;
+
+  clutter_actor_get_position (handle, &x, &y);
+  clutter_actor_get_translation (handle, &tx, &ty, &tz);
+
+  clutter_actor_save_easing_state (handle);
+  clutter_actor_set_easing_duration (handle, 0);
+
+  clutter_actor_set_translation (handle,
+                                 priv->translation_x,
+                                 priv->translation_y,
+                                 tz);
+  clutter_actor_set_position (handle,
+                              x + tx - priv->translation_x,
+                              y + ty - priv->translation_y);
+
+  clutter_actor_restore_easing_state (handle);
+}
+
 static void
 emit_drag_end (ClutterDragAction *action,
                ClutterActor      *actor,
@@ -314,6 +355,9 @@ emit_drag_end (ClutterDragAction *action,
 
   priv->in_drag = FALSE;
 
+  /* the position has to be final by the time ::drag-end is emitted */
+  clutter_drag_action_commit_translation (action);
+
   /* we might not have emitted ::drag-begin yet */
   if (!priv->emit_delayed_press)
     g_signal_emit (action, drag_signals[DRAG_END], 0,
@@ -505,6 +549,7 @@ clutter_drag_action_set_actor (ClutterActorMeta *meta,
     }
 
   clutter_drag_action_set_drag_handle (CLUTTER_DRAG_ACTION (meta), NULL);
+  clutter_drag_action_commit_translation (CLUTTER_DRAG_ACTION (meta));
 
   priv->in_drag = FALSE;
 
@@ -536,28 +581,63 @@ clutter_drag_action_real_drag_motion (ClutterDragAction *action,
                                       gfloat             delta_x,
                                       gfloat             delta_y)
 {
+  ClutterDragActionPrivate *priv = action->priv;
   ClutterActor *drag_handle;
-  gfloat x, y;
+  gfloat x, y, tx, ty, tz;
 
-  if (action->priv->drag_handle != NULL)
-    drag_handle = action->priv->drag_handle;
+  if (priv->drag_handle != NULL)
+    drag_handle = priv->drag_handle;
   else
     drag_handle = actor;
 
+  /* the handle may have changed since the last motion */
+  if (priv->translated_handle != drag_handle)
+    clutter_drag_action_commit_translation (action);
+
   clutter_actor_get_position (drag_handle, &x, &y);
 
+  if (priv->use_translation)
+    {
+      clutter_actor_get_translation (drag_handle, &tx, &ty, &tz);
+
+      if (priv->translated_handle == NULL)
+        {
+          priv->translated_handle = drag_handle;
+          priv->translation_x = tx;
+          priv->translation_y = ty;
+        }
+
+      /* the position the handle is painted at */
+      x += tx - priv->translation_x;
+      y += ty - priv->translation_y;
+    }
+
   x += delta_x;
   y += delta_y;
 
-  if (action->priv->drag_area_set)
+  if (priv->drag_area_set)
     {
-      ClutterRect *drag_area = &action->priv->drag_area;
+      ClutterRect *drag_area = &priv->drag_area;
 
       x = CLAMP (x, drag_area->origin.x, drag_area->origin.x + drag_area->size.width);
       y = CLAMP (y, drag_area->origin.y, drag_area->origin.y + drag_area->size.height);
     }
 
-  clutter_actor_set_position (drag_handle, x, y);
+  if (priv->use_translation)
+    {
+      gfloat pos_x, pos_y;
+
+      /* changing the translation does not queue a relayout, unlike
+       * changing the position; the latter is done once the drag ends
+       */
+      clutter_actor_get_position (drag_handle, &pos_x, &pos_y);
+      clutter_actor_set_translation (drag_handle,
+                                     priv->translation_x + x - pos_x,
+                                     priv->translation_y + y - pos_y,
+                                     tz);
+    }
+  else
+    clutter_actor_set_position (drag_handle, x, y);
 }
 
 static void
@@ -595,6 +675,10 @@ clutter_drag_action_set_property (GObject      *gobject,
       clutter_drag_action_set_drag_area (action, g_value_get_boxed (value));
       break;
 
+    case PROP_USE_TRANSLATION:
+      clutter_drag_action_set_use_translation (action, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -644,6 +728,10 @@ clutter_drag_action_get_property (GObject    *gobject,
       g_value_set_boolean (value, priv->drag_area_set);
       break;
 
+    case PROP_USE_TRANSLATION:
+      g_value_set_boolean (value, priv->use_translation);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -847,6 +935,24 @@ clutter_drag_action_class_init (ClutterDragActionClass *klass)
 			  FALSE,
 			  CLUTTER_PARAM_READABLE);
 
+  /**
+   * ClutterDragAction:use-translation:
+   *
+   * Whether the default handler of the #ClutterDragAction::drag-motion
+   * signal should move the dragged actor by changing its translation,
+   * instead of its position.
+   *
+   * Changing the translation of an actor does not queue a relayout of
+   * its parent; the position of the actor is updated, and its original
+   * translation restored, when the dragging ends.
+   */
+  drag_props[PROP_USE_TRANSLATION] =
+    g_param_spec_boolean ("use-translation",
+                          P_("Use Translation"),
+                          P_("Whether the dragged actor is moved using its translation"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
 
   gobject_class->set_property = clutter_drag_action_set_property;
   gobject_class->get_property = clutter_drag_action_get_property;
@@ -947,8 +1053,9 @@ clutter_drag_action_class_init (ClutterDragActionClass *klass)
    *
    * The default handler of the signal will call clutter_actor_move_by()
    * either on @actor or, if set, of #ClutterDragAction:drag-handle using
-   * the @delta_x and @delta_y components of the dragging motion. If you
-   * want to override the default behaviour, you can connect to the
+   * the @delta_x and @delta_y components of the dragging motion, or
+   * change its translation if #ClutterDragAction:use-translation is set.
+   * If you want to override the default behaviour, you can connect to the
    * #ClutterDragAction::drag-progress signal and return %FALSE from the
    * handler.
    *
@@ -1110,6 +1217,9 @@ on_drag_handle_destroy (ClutterActor      *handle,
   ClutterActor *actor;
 
   /* make sure we reset the state */
+  if (priv->translated_handle == handle)
+    priv->translated_handle = NULL;
+
   actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (action));
   if (priv->in_drag)
     emit_drag_end (action, actor, NULL);
@@ -1145,6 +1255,8 @@ clutter_drag_action_set_drag_handle (ClutterDragAction *action,
                                           G_CALLBACK (on_drag_handle_destroy),
                                           action);
 
+  clutter_drag_action_commit_translation (action);
+
   priv->drag_handle = handle;
 
   if (priv->drag_handle != NULL)
@@ -1337,3 +1449,55 @@ clutter_drag_action_set_drag_area (ClutterDragAction *action,
   g_object_notify_by_pspec (G_OBJECT (action), drag_props[PROP_DRAG_AREA_SET]);
   g_object_notify_by_pspec (G_OBJECT (action), drag_props[PROP_DRAG_AREA]);
 }
+
+/**
+ * clutter_drag_action_set_use_translation:
+ * @action: a #ClutterDragAction
+ * @use_translation: whether to move the dragged actor using its translation
+ *
+ * Sets whether the default handler of the #ClutterDragAction::drag-motion
+ * signal should move the dragged actor by changing its translation, and
+ * update its position only at the end of the dragging.
+ *
+ * This avoids queueing a relayout of the parent of the dragged actor on
+ * each motion event, which can be expensive when dragging actors inside
+ * complex layouts.
+ */
+void
+clutter_drag_action_set_use_translation (ClutterDragAction *action,
+                                         gboolean           use_translation)
+{
+  ClutterDragActionPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_DRAG_ACTION (action));
+
+  priv = action->priv;
+
+  use_translation = !!use_translation;
+
+  if (priv->use_translation == use_translation)
+    return;
+
+  priv->use_translation = use_translation;
+
+  if (!priv->use_translation)
+    clutter_drag_action_commit_translation (action);
+
+  g_object_notify_by_pspec (G_OBJECT (action), drag_props[PROP_USE_TRANSLATION]);
+}
+
+/**
+ * clutter_drag_action_get_use_translation:
+ * @action: a #ClutterDragAction
+ *
+ * Retrieves the value set by clutter_drag_action_set_use_translation().
+ *
+ * Return value: %TRUE if the dragged actor is moved using its translation
+ */
+gboolean
+clutter_drag_action_get_use_translation (ClutterDragAction *action)
+{
+  g_return_val_if_fail (CLUTTER_IS_DRAG_ACTION (action), FALSE);
+
+  return action->priv->use_translation;
+}
@@ -137,6 +137,10 @@ gboolean        clutter_drag_action_get_drag_area      (ClutterDragAction *actio
 void            clutter_drag_action_set_drag_area      (ClutterDragAction *action,
                                                         const ClutterRect *drag_area);
 
+void            clutter_drag_action_set_use_translation (ClutterDragAction *action,
+                                                         gboolean           use_translation);
+gboolean        clutter_drag_action_get_use_translation (ClutterDragAction *action);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_DRAG_ACTION_H__ */
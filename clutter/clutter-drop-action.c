@@ -162,15 +162,26 @@ on_stage_capture (ClutterStage *stage,
 
   clutter_event_get_coords (event, &event_x, &event_y);
 
-  /* get the actor under the cursor, excluding the dragged actor; we
-   * use reactivity because it won't cause any scene invalidation
+  /* get the actor under the cursor, excluding the dragged actor; the
+   * pick index of the stage resolves it using the geometry of the
+   * reactive actors, which is usually up to date as the dragged actor
+   * is moved after this handler has been called
    */
   was_reactive = clutter_actor_get_reactive (drag_actor);
-  clutter_actor_set_reactive (drag_actor, FALSE);
 
-  actor = clutter_stage_get_actor_at_pos (stage, CLUTTER_PICK_REACTIVE,
-                                          event_x,
-                                          event_y);
+  if (!_clutter_stage_get_reactive_actor_at_pos (stage, event_x, event_y,
+                                                 drag_actor,
+                                                 &actor))
+    {
+      /* we need to pick; we use reactivity because it won't cause any
+       * scene invalidation
+       */
+      clutter_actor_set_reactive (drag_actor, FALSE);
+
+      actor = clutter_stage_get_actor_at_pos (stage, CLUTTER_PICK_REACTIVE,
+                                              event_x,
+                                              event_y);
+    }
   if (actor == NULL || actor == CLUTTER_ACTOR (stage))
     {
       if (data->last_action != NULL)
@@ -525,6 +525,153 @@ static const struct {
   { CLUTTER_ANIMATION_LAST,      NULL, "sentinel" },
 };
 
+/*< private >
+ * Sampled easing functions
+ *
+ * The expensive easing functions, and the cubic bezier curves, can be
+ * sampled into a table of CLUTTER_EASING_TABLE_SIZE + 1 values, which
+ * is then linearly interpolated. With 512 intervals the absolute error
+ * is below 1e-5 for the sine modes and for the usual cubic bezier
+ * curves, below 5e-4 for the elastic modes and below 1e-3 for the
+ * exponential modes, which already have a discontinuity of that size
+ * at their ends. The largest error is below 2.5e-3 and is reached at
+ * the bounces of the bounce modes, where the derivative of the curve
+ * is not continuous; that is less than a pixel for an animation
+ * spanning 400 pixels.
+ */
+static gfloat *easing_tables[CLUTTER_ANIMATION_LAST] = { NULL, };
+
+static gfloat *
+easing_table_new (ClutterAnimationMode mode,
+                  const double         cubic_bezier[4])
+{
+  gfloat *table = g_new (gfloat, CLUTTER_EASING_TABLE_SIZE + 1);
+  int i;
+
+  for (i = 0; i <= CLUTTER_EASING_TABLE_SIZE; i++)
+    {
+      double t = (double) i / CLUTTER_EASING_TABLE_SIZE;
+
+      if (cubic_bezier != NULL)
+        table[i] = clutter_ease_cubic_bezier (t, 1.0,
+                                              cubic_bezier[0],
+                                              cubic_bezier[1],
+                                              cubic_bezier[2],
+                                              cubic_bezier[3]);
+      else
+        table[i] = clutter_easing_for_mode (mode, t, 1.0);
+    }
+
+  return table;
+}
+
+/*< private >
+ * _clutter_easing_get_table:
+ * @mode: an animation mode
+ *
+ * Retrieves the shared table of samples of @mode, if @mode is worth
+ * sampling: the cheap polynomial modes are not, and neither are the
+ * steps, which are not continuous.
+ *
+ * Return value: the table of samples, or %NULL
+ */
+const gfloat *
+_clutter_easing_get_table (ClutterAnimationMode mode)
+{
+  static const double ease[4] = { 0.25, 0.1, 0.25, 1.0 };
+  static const double ease_in[4] = { 0.42, 0.0, 1.0, 1.0 };
+  static const double ease_out[4] = { 0.0, 0.0, 0.58, 1.0 };
+  static const double ease_in_out[4] = { 0.42, 0.0, 0.58, 1.0 };
+  const double *cubic_bezier = NULL;
+
+  switch (mode)
+    {
+    case CLUTTER_EASE_IN_SINE:
+    case CLUTTER_EASE_OUT_SINE:
+    case CLUTTER_EASE_IN_OUT_SINE:
+    case CLUTTER_EASE_IN_EXPO:
+    case CLUTTER_EASE_OUT_EXPO:
+    case CLUTTER_EASE_IN_OUT_EXPO:
+    case CLUTTER_EASE_IN_ELASTIC:
+    case CLUTTER_EASE_OUT_ELASTIC:
+    case CLUTTER_EASE_IN_OUT_ELASTIC:
+    case CLUTTER_EASE_IN_BOUNCE:
+    case CLUTTER_EASE_OUT_BOUNCE:
+    case CLUTTER_EASE_IN_OUT_BOUNCE:
+      break;
+
+    case CLUTTER_EASE:
+      cubic_bezier = ease;
+      break;
+
+    case CLUTTER_EASE_IN:
+      cubic_bezier = ease_in;
+      break;
+
+    case CLUTTER_EASE_OUT:
+      cubic_bezier = ease_out;
+      break;
+
+    case CLUTTER_EASE_IN_OUT:
+      cubic_bezier = ease_in_out;
+      break;
+
+    default:
+      return NULL;
+    }
+
+  if (G_UNLIKELY (easing_tables[mode] == NULL))
+    easing_tables[mode] = easing_table_new (mode, cubic_bezier);
+
+  return easing_tables[mode];
+}
+
+/*< private >
+ * _clutter_easing_table_new_cubic_bezier:
+ * @x_1: the X coordinate of the first control point
+ * @y_1: the Y coordinate of the first control point
+ * @x_2: the X coordinate of the second control point
+ * @y_2: the Y coordinate of the second control point
+ *
+ * Samples the given cubic bezier curve.
+ *
+ * Return value: a newly allocated table; use g_free() to free it
+ */
+gfloat *
+_clutter_easing_table_new_cubic_bezier (double x_1,
+                                        double y_1,
+                                        double x_2,
+                                        double y_2)
+{
+  double cubic_bezier[4] = { x_1, y_1, x_2, y_2 };
+
+  return easing_table_new (CLUTTER_CUBIC_BEZIER, cubic_bezier);
+}
+
+/*< private >
+ * _clutter_easing_table_lookup:
+ * @table: a table of samples
+ * @t: elapsed time
+ * @d: total duration
+ *
+ * Linearly interpolates the samples in @table.
+ *
+ * Return value: the interpolated progress
+ */
+double
+_clutter_easing_table_lookup (const gfloat *table,
+                              double        t,
+                              double        d)
+{
+  double x = CLAMP (t / d, 0.0, 1.0) * CLUTTER_EASING_TABLE_SIZE;
+  int i = (int) x;
+
+  if (i >= CLUTTER_EASING_TABLE_SIZE)
+    return table[CLUTTER_EASING_TABLE_SIZE];
+
+  return table[i] + (table[i + 1] - table[i]) * (x - i);
+}
+
 ClutterEasingFunc
 clutter_get_easing_func_for_mode (ClutterAnimationMode mode)
 {
@@ -137,6 +137,20 @@ double  clutter_ease_cubic_bezier       (double t,
                                          double x_2,
                                          double y_2);
 
+#define CLUTTER_EASING_TABLE_SIZE       512
+
+G_GNUC_INTERNAL
+const gfloat *  _clutter_easing_get_table               (ClutterAnimationMode mode);
+G_GNUC_INTERNAL
+gfloat *        _clutter_easing_table_new_cubic_bezier  (double x_1,
+                                                         double y_1,
+                                                         double x_2,
+                                                         double y_2);
+G_GNUC_INTERNAL
+double          _clutter_easing_table_lookup            (const gfloat *table,
+                                                         double        t,
+                                                         double        d);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_EASING_H__ */
@@ -344,6 +344,10 @@ typedef enum { /*< prefix=CLUTTER_ACTOR >*/
  *   virtual returns %TRUE. This is the default.
  * @CLUTTER_OFFSCREEN_REDIRECT_ALWAYS: Always redirect the actor to an
  *   offscreen buffer even if it is fully opaque.
+ * @CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_CACHING: Redirect the actor
+ *   if it contains many children and it has not changed for a number of
+ *   frames, so that the cached image can be painted instead of the
+ *   children; the actor stops being redirected once it changes again.
  *
  * Possible flags to pass to clutter_actor_set_offscreen_redirect().
  *
@@ -351,7 +355,8 @@ typedef enum { /*< prefix=CLUTTER_ACTOR >*/
  */
 typedef enum { /*< prefix=CLUTTER_OFFSCREEN_REDIRECT >*/
   CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_OPACITY = 1<<0,
-  CLUTTER_OFFSCREEN_REDIRECT_ALWAYS = 1<<1
+  CLUTTER_OFFSCREEN_REDIRECT_ALWAYS = 1<<1,
+  CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_CACHING = 1<<2
 } ClutterOffscreenRedirect;
 
 /**
@@ -983,6 +988,9 @@ typedef enum {
  *   painting the stages
  * @CLUTTER_REPAINT_FLAGS_QUEUE_REDRAW_ON_ADD: Ensure that a new frame
  *   is queued after adding the repaint function
+ * @CLUTTER_REPAINT_FLAGS_IDLE: Run the repaint function after the stages
+ *   have been painted, only as long as the frame budget allows it; see
+ *   clutter_threads_get_remaining_frame_budget()
  *
  * Flags to pass to clutter_threads_add_repaint_func_full().
  *
@@ -991,7 +999,8 @@ typedef enum {
 typedef enum {
   CLUTTER_REPAINT_FLAGS_PRE_PAINT = 1 << 0,
   CLUTTER_REPAINT_FLAGS_POST_PAINT = 1 << 1,
-  CLUTTER_REPAINT_FLAGS_QUEUE_REDRAW_ON_ADD = 1 << 2
+  CLUTTER_REPAINT_FLAGS_QUEUE_REDRAW_ON_ADD = 1 << 2,
+  CLUTTER_REPAINT_FLAGS_IDLE = 1 << 3
 } ClutterRepaintFlags;
 
 /**
@@ -1139,6 +1148,27 @@ typedef enum {
   CLUTTER_STEP_MODE_END
 } ClutterStepMode;
 
+/**
+ * ClutterTransitionNotifyMode:
+ * @CLUTTER_TRANSITION_NOTIFY_EACH_FRAME: The property changes are
+ *   notified as soon as the value is set, on every frame
+ * @CLUTTER_TRANSITION_NOTIFY_END_OF_FRAME: The property changes are
+ *   notified once, after all the timelines have been advanced for
+ *   the current frame
+ * @CLUTTER_TRANSITION_NOTIFY_ON_COMPLETION: The property changes are
+ *   notified once, when the transition is stopped or detached
+ *
+ * Controls when a #ClutterTransition emits the #GObject::notify signal
+ * for the changes of the animatable instance.
+ *
+ * See clutter_transition_set_notify_mode().
+ */
+typedef enum {
+  CLUTTER_TRANSITION_NOTIFY_EACH_FRAME,
+  CLUTTER_TRANSITION_NOTIFY_END_OF_FRAME,
+  CLUTTER_TRANSITION_NOTIFY_ON_COMPLETION
+} ClutterTransitionNotifyMode;
+
 /**
  * ClutterZoomAxis:
  * @CLUTTER_ZOOM_X_AXIS: Scale only on the X axis
@@ -1156,6 +1186,63 @@ typedef enum { /*< prefix=CLUTTER_ZOOM >*/
   CLUTTER_ZOOM_BOTH
 } ClutterZoomAxis;
 
+/**
+ * ClutterMemoryCategory:
+ * @CLUTTER_MEMORY_ACTORS: the private data of the actors, and the
+ *   layout, transformation and animation data attached to them
+ * @CLUTTER_MEMORY_TEXT_LAYOUTS: the layouts cached by #ClutterText
+ * @CLUTTER_MEMORY_OFFSCREEN_TARGETS: the offscreen targets of the
+ *   #ClutterOffscreenEffect instances
+ * @CLUTTER_MEMORY_CONTENT_TEXTURES: the textures of the #ClutterImage
+ *   and #ClutterCanvas contents
+ * @CLUTTER_MEMORY_EVENTS: the events, and the event queues of the stages
+ *
+ * The subsystems whose memory usage is accounted; see
+ * clutter_get_memory_usage().
+ */
+typedef enum {
+  CLUTTER_MEMORY_ACTORS,
+  CLUTTER_MEMORY_TEXT_LAYOUTS,
+  CLUTTER_MEMORY_OFFSCREEN_TARGETS,
+  CLUTTER_MEMORY_CONTENT_TEXTURES,
+  CLUTTER_MEMORY_EVENTS
+} ClutterMemoryCategory;
+
+/**
+ * ClutterPurgeLevel:
+ * @CLUTTER_PURGE_LEVEL_LOW: release the caches that are not in use,
+ *   like the idle offscreen targets, the textures of the images that
+ *   are not shown anymore and the older text layouts
+ * @CLUTTER_PURGE_LEVEL_MODERATE: also release the caches of the actors
+ *   that are not mapped, and the buffers of the #ClutterCanvas contents
+ * @CLUTTER_PURGE_LEVEL_CRITICAL: also release the caches of the visible
+ *   actors, and the glyph cache; they are rebuilt by the next paint
+ *
+ * The amount of memory released by clutter_purge_caches(); each level
+ * includes the caches released by the levels before it.
+ */
+typedef enum {
+  CLUTTER_PURGE_LEVEL_LOW,
+  CLUTTER_PURGE_LEVEL_MODERATE,
+  CLUTTER_PURGE_LEVEL_CRITICAL
+} ClutterPurgeLevel;
+
+/**
+ * ClutterWorkerPriority:
+ * @CLUTTER_WORKER_PRIORITY_VISIBLE: the task produces content that is,
+ *   or is about to be, visible on screen
+ * @CLUTTER_WORKER_PRIORITY_PREFETCH: the task produces content that
+ *   may be needed later
+ *
+ * The priorities of the tasks added with clutter_threads_add_worker_task();
+ * pending tasks are run in priority order, and in adding order for tasks
+ * with the same priority.
+ */
+typedef enum {
+  CLUTTER_WORKER_PRIORITY_VISIBLE,
+  CLUTTER_WORKER_PRIORITY_PREFETCH
+} ClutterWorkerPriority;
+
 G_END_DECLS
 
 #endif /* __CLUTTER_ENUMS_H__ */
@@ -19,9 +19,21 @@ void            _clutter_event_set_platform_data        (ClutterEvent       *eve
                                                          gpointer            data);
 gpointer        _clutter_event_get_platform_data        (const ClutterEvent *event);
 
+void            _clutter_event_set_origin_time          (ClutterEvent       *event,
+                                                         gint64              origin_time);
+gint64          _clutter_event_get_origin_time          (const ClutterEvent *event);
+
+/* moves the samples of a compressed event into the history of the next one */
+void            _clutter_event_merge_history            (ClutterEvent       *event,
+                                                         ClutterEvent       *compressed);
+
 void            _clutter_event_push                     (const ClutterEvent *event,
                                                          gboolean            do_copy);
 
+/* queues an event on its stage, like clutter_do_event() */
+void            _clutter_do_event                       (ClutterEvent       *event,
+                                                         gboolean            do_copy);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_EVENT_PRIVATE_H__ */
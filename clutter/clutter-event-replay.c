@@ -0,0 +1,509 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Input recording and replay.
+ *
+ * Setting CLUTTER_RECORD_EVENTS to the name of a file writes the input
+ * events reaching the stages to it, one event per line:
+ *
+ *   TIME TYPE X Y STATE [ARGUMENTS]
+ *
+ * where TIME is the time of the event in microseconds since the first
+ * recorded event, TYPE is the nick of the #ClutterEventType, X and Y
+ * are the stage coordinates and STATE the #ClutterModifierType of the
+ * event. The button events are followed by the button and the click
+ * count; the key events by the key symbol, the hardware key code and
+ * the Unicode character; the scroll events by the direction and the
+ * deltas of a smooth scroll; and the touch events by the identifier
+ * of their sequence.
+ *
+ * Setting CLUTTER_REPLAY_EVENTS to the name of a recording sends its
+ * events to the first stage, and quits the main loop once they have all
+ * been delivered. The events are delivered with their original timing,
+ * unless CLUTTER_REPLAY_MODE is set to "fast": in that case the frames
+ * are run back to back, the master clock advances by one frame interval
+ * at each frame regardless of the time the frames take, and the events
+ * are delivered at the frame matching their time. The same recording
+ * then produces the same sequence of frames on every run, which makes
+ * it suitable for comparing the performance of two builds.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "clutter-event-replay.h"
+
+#include "clutter-debug.h"
+#include "clutter-device-manager.h"
+#include "clutter-enum-types.h"
+#include "clutter-event-private.h"
+#include "clutter-main.h"
+#include "clutter-private.h"
+#include "clutter-stage-manager.h"
+
+typedef struct _ReplayEvent
+{
+  gint64 time;
+  ClutterEvent *event;
+} ReplayEvent;
+
+gboolean _clutter_event_recording = FALSE;
+gboolean _clutter_event_replay_active = FALSE;
+
+static FILE *record_file = NULL;
+static gint64 record_start = -1;
+
+static GArray *replay_events = NULL;
+static guint replay_next = 0;
+static gboolean replay_fast = FALSE;
+static gint64 replay_start = -1;
+static ClutterStage *replay_stage = NULL;
+
+static void
+clutter_event_record_close (void)
+{
+  if (record_file != NULL)
+    {
+      fclose (record_file);
+      record_file = NULL;
+    }
+
+  _clutter_event_recording = FALSE;
+}
+
+/*< private >
+ * _clutter_event_record_init:
+ * @filename: the file to write the recording to
+ *
+ * Starts recording the input events queued on the stages; called
+ * when CLUTTER_RECORD_EVENTS is set. The input is not recorded while
+ * a recording is being replayed.
+ */
+void
+_clutter_event_record_init (const gchar *filename)
+{
+  if (_clutter_event_recording || _clutter_event_replay_active)
+    return;
+
+  record_file = fopen (filename, "w");
+  if (record_file == NULL)
+    {
+      g_warning ("Unable to record the events to '%s': %s",
+                 filename,
+                 g_strerror (errno));
+      return;
+    }
+
+  g_atexit (clutter_event_record_close);
+  _clutter_event_recording = TRUE;
+}
+
+static const gchar *
+event_type_get_nick (ClutterEventType event_type)
+{
+  GEnumClass *enum_class;
+  GEnumValue *value;
+
+  /* the class of the enumeration is never finalized once created */
+  enum_class = g_type_class_ref (CLUTTER_TYPE_EVENT_TYPE);
+  value = g_enum_get_value (enum_class, event_type);
+  g_type_class_unref (enum_class);
+
+  return value != NULL ? value->value_nick : NULL;
+}
+
+/*< private >
+ * _clutter_event_record:
+ * @event: a #ClutterEvent queued on a stage
+ *
+ * Writes @event to the recording, if it is an input event.
+ */
+void
+_clutter_event_record (const ClutterEvent *event)
+{
+  gchar x_buf[G_ASCII_DTOSTR_BUF_SIZE], y_buf[G_ASCII_DTOSTR_BUF_SIZE];
+  const gchar *nick;
+  gint64 origin_time;
+  gfloat x, y;
+
+  if (record_file == NULL)
+    return;
+
+  switch (event->type)
+    {
+    case CLUTTER_MOTION:
+    case CLUTTER_ENTER:
+    case CLUTTER_LEAVE:
+    case CLUTTER_BUTTON_PRESS:
+    case CLUTTER_BUTTON_RELEASE:
+    case CLUTTER_KEY_PRESS:
+    case CLUTTER_KEY_RELEASE:
+    case CLUTTER_SCROLL:
+    case CLUTTER_TOUCH_BEGIN:
+    case CLUTTER_TOUCH_UPDATE:
+    case CLUTTER_TOUCH_END:
+    case CLUTTER_TOUCH_CANCEL:
+      break;
+
+    default:
+      return;
+    }
+
+  nick = event_type_get_nick (event->type);
+  if (nick == NULL)
+    return;
+
+  origin_time = _clutter_event_get_origin_time (event);
+  if (record_start == -1)
+    record_start = origin_time;
+
+  clutter_event_get_coords (event, &x, &y);
+
+  fprintf (record_file, "%" G_GINT64_FORMAT " %s %s %s %u",
+           MAX (origin_time - record_start, 0),
+           nick,
+           g_ascii_formatd (x_buf, sizeof (x_buf), "%.2f", x),
+           g_ascii_formatd (y_buf, sizeof (y_buf), "%.2f", y),
+           (guint) clutter_event_get_state (event));
+
+  switch (event->type)
+    {
+    case CLUTTER_BUTTON_PRESS:
+    case CLUTTER_BUTTON_RELEASE:
+      fprintf (record_file, " %u %u",
+               event->button.button,
+               event->button.click_count);
+      break;
+
+    case CLUTTER_KEY_PRESS:
+    case CLUTTER_KEY_RELEASE:
+      fprintf (record_file, " %u %u %u",
+               event->key.keyval,
+               (guint) event->key.hardware_keycode,
+               (guint) event->key.unicode_value);
+      break;
+
+    case CLUTTER_SCROLL:
+      {
+        gdouble dx = 0, dy = 0;
+
+        if (event->scroll.direction == CLUTTER_SCROLL_SMOOTH)
+          clutter_event_get_scroll_delta (event, &dx, &dy);
+
+        fprintf (record_file, " %u %s %s",
+                 (guint) event->scroll.direction,
+                 g_ascii_formatd (x_buf, sizeof (x_buf), "%.4f", dx),
+                 g_ascii_formatd (y_buf, sizeof (y_buf), "%.4f", dy));
+      }
+      break;
+
+    case CLUTTER_TOUCH_BEGIN:
+    case CLUTTER_TOUCH_UPDATE:
+    case CLUTTER_TOUCH_END:
+    case CLUTTER_TOUCH_CANCEL:
+      fprintf (record_file, " %" G_GSIZE_FORMAT,
+               GPOINTER_TO_SIZE (event->touch.sequence));
+      break;
+
+    default:
+      break;
+    }
+
+  fputc ('\n', record_file);
+}
+
+static ClutterEvent *
+event_parse (gchar   **fields,
+             guint     n_fields,
+             gint64   *time_)
+{
+  GEnumClass *enum_class;
+  GEnumValue *value;
+  ClutterEvent *event;
+  ClutterEventType event_type;
+  guint n_args;
+
+  if (n_fields < 5)
+    return NULL;
+
+  enum_class = g_type_class_ref (CLUTTER_TYPE_EVENT_TYPE);
+  value = g_enum_get_value_by_nick (enum_class, fields[1]);
+  event_type = value != NULL ? value->value : CLUTTER_NOTHING;
+  g_type_class_unref (enum_class);
+
+  switch (event_type)
+    {
+    case CLUTTER_BUTTON_PRESS:
+    case CLUTTER_BUTTON_RELEASE:
+      n_args = 2;
+      break;
+
+    case CLUTTER_KEY_PRESS:
+    case CLUTTER_KEY_RELEASE:
+    case CLUTTER_SCROLL:
+      n_args = 3;
+      break;
+
+    case CLUTTER_TOUCH_BEGIN:
+    case CLUTTER_TOUCH_UPDATE:
+    case CLUTTER_TOUCH_END:
+    case CLUTTER_TOUCH_CANCEL:
+      n_args = 1;
+      break;
+
+    case CLUTTER_MOTION:
+    case CLUTTER_ENTER:
+    case CLUTTER_LEAVE:
+      n_args = 0;
+      break;
+
+    default:
+      return NULL;
+    }
+
+  if (n_fields < 5 + n_args)
+    return NULL;
+
+  event = clutter_event_new (event_type);
+
+  *time_ = g_ascii_strtoll (fields[0], NULL, 10);
+  clutter_event_set_coords (event,
+                            g_ascii_strtod (fields[2], NULL),
+                            g_ascii_strtod (fields[3], NULL));
+  clutter_event_set_state (event, g_ascii_strtoull (fields[4], NULL, 10));
+
+  switch (event_type)
+    {
+    case CLUTTER_BUTTON_PRESS:
+    case CLUTTER_BUTTON_RELEASE:
+      event->button.button = g_ascii_strtoull (fields[5], NULL, 10);
+      event->button.click_count = g_ascii_strtoull (fields[6], NULL, 10);
+      break;
+
+    case CLUTTER_KEY_PRESS:
+    case CLUTTER_KEY_RELEASE:
+      event->key.keyval = g_ascii_strtoull (fields[5], NULL, 10);
+      event->key.hardware_keycode = g_ascii_strtoull (fields[6], NULL, 10);
+      event->key.unicode_value = g_ascii_strtoull (fields[7], NULL, 10);
+      break;
+
+    case CLUTTER_SCROLL:
+      clutter_event_set_scroll_direction (event,
+                                          g_ascii_strtoull (fields[5], NULL, 10));
+      if (event->scroll.direction == CLUTTER_SCROLL_SMOOTH)
+        clutter_event_set_scroll_delta (event,
+                                        g_ascii_strtod (fields[6], NULL),
+                                        g_ascii_strtod (fields[7], NULL));
+      break;
+
+    case CLUTTER_TOUCH_BEGIN:
+    case CLUTTER_TOUCH_UPDATE:
+    case CLUTTER_TOUCH_END:
+    case CLUTTER_TOUCH_CANCEL:
+      event->touch.sequence =
+        GSIZE_TO_POINTER (g_ascii_strtoull (fields[5], NULL, 10));
+      break;
+
+    default:
+      break;
+    }
+
+  return event;
+}
+
+/*< private >
+ * _clutter_event_replay_init:
+ * @filename: the recording to replay
+ * @fast: whether the events should be delivered as fast as possible,
+ *   instead of using their original timing
+ *
+ * Loads a recording written by CLUTTER_RECORD_EVENTS; the events are
+ * sent to the first stage by _clutter_event_replay_frame(), starting
+ * from the first frame in which a stage exists.
+ */
+void
+_clutter_event_replay_init (const gchar *filename,
+                            gboolean     fast)
+{
+  GError *error = NULL;
+  gchar *contents;
+  gchar **lines;
+  guint i;
+
+  if (replay_events != NULL)
+    return;
+
+  if (!g_file_get_contents (filename, &contents, NULL, &error))
+    {
+      g_warning ("Unable to replay the events of '%s': %s",
+                 filename,
+                 error->message);
+      g_error_free (error);
+      return;
+    }
+
+  replay_events = g_array_new (FALSE, FALSE, sizeof (ReplayEvent));
+  replay_fast = fast;
+
+  lines = g_strsplit (contents, "\n", -1);
+  for (i = 0; lines[i] != NULL; i++)
+    {
+      ReplayEvent replay_event;
+      gchar **fields;
+
+      if (lines[i][0] == '\0' || lines[i][0] == '#')
+        continue;
+
+      fields = g_strsplit (lines[i], " ", -1);
+      replay_event.event = event_parse (fields,
+                                        g_strv_length (fields),
+                                        &replay_event.time);
+      g_strfreev (fields);
+
+      if (replay_event.event == NULL)
+        {
+          g_warning ("Invalid event at line %u of '%s'", i + 1, filename);
+          continue;
+        }
+
+      g_array_append_val (replay_events, replay_event);
+    }
+
+  g_strfreev (lines);
+  g_free (contents);
+
+  CLUTTER_NOTE (EVENT, "Replaying %u events from '%s'",
+                replay_events->len,
+                filename);
+
+  _clutter_event_replay_active = TRUE;
+}
+
+static void
+clutter_event_replay_finish (void)
+{
+  guint i;
+
+  for (i = 0; i < replay_events->len; i++)
+    clutter_event_free (g_array_index (replay_events, ReplayEvent, i).event);
+
+  g_array_set_size (replay_events, 0);
+  replay_stage = NULL;
+
+  _clutter_event_replay_active = FALSE;
+
+  if (clutter_main_level () > 0)
+    clutter_main_quit ();
+}
+
+/*< private >
+ * _clutter_event_replay_frame:
+ * @master_clock: the #ClutterMasterClock
+ *
+ * Sends the events of the recording that are due to the stage; called
+ * at the beginning of each frame, before the events are processed.
+ */
+void
+_clutter_event_replay_frame (ClutterMasterClock *master_clock)
+{
+  ClutterStageManager *stage_manager;
+  ClutterDeviceManager *device_manager;
+  ClutterInputDevice *pointer, *keyboard;
+  const GSList *stages;
+  gint64 elapsed;
+
+  stage_manager = clutter_stage_manager_get_default ();
+  stages = clutter_stage_manager_peek_stages (stage_manager);
+
+  if (replay_stage == NULL)
+    {
+      if (stages == NULL)
+        return;
+
+      replay_stage = stages->data;
+
+      /* the replay clock starts from the time of the current frame */
+      if (replay_fast)
+        {
+          gint64 interval = 1000000 / _clutter_context_get_frame_rate ();
+
+          _clutter_master_clock_set_replay_interval (master_clock, interval);
+          replay_start = _clutter_master_clock_get_replay_tick (master_clock);
+        }
+      else
+        replay_start = g_get_monotonic_time ();
+    }
+
+  /* the stage went away before the end of the recording */
+  if (g_slist_find ((GSList *) stages, replay_stage) == NULL)
+    {
+      clutter_event_replay_finish ();
+      return;
+    }
+
+  if (replay_fast)
+    elapsed = _clutter_master_clock_get_replay_tick (master_clock) - replay_start;
+  else
+    elapsed = g_get_monotonic_time () - replay_start;
+
+  device_manager = clutter_device_manager_get_default ();
+  pointer = clutter_device_manager_get_core_device (device_manager,
+                                                    CLUTTER_POINTER_DEVICE);
+  keyboard = clutter_device_manager_get_core_device (device_manager,
+                                                     CLUTTER_KEYBOARD_DEVICE);
+
+  while (replay_next < replay_events->len)
+    {
+      ReplayEvent *replay_event;
+      ClutterEvent *event;
+
+      replay_event = &g_array_index (replay_events, ReplayEvent, replay_next);
+      if (replay_event->time > elapsed)
+        break;
+
+      event = replay_event->event;
+      clutter_event_set_stage (event, replay_stage);
+      clutter_event_set_time (event, (guint32) (elapsed / 1000));
+
+      if (event->type == CLUTTER_KEY_PRESS ||
+          event->type == CLUTTER_KEY_RELEASE)
+        clutter_event_set_device (event, keyboard);
+      else
+        clutter_event_set_device (event, pointer);
+
+      clutter_event_put (event);
+
+      replay_next += 1;
+    }
+
+  /* keep the clock running until the last event has been delivered */
+  if (replay_next < replay_events->len)
+    _clutter_master_clock_ensure_next_iteration (master_clock);
+  else
+    clutter_event_replay_finish ();
+}
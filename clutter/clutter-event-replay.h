@@ -0,0 +1,45 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_EVENT_REPLAY_H__
+#define __CLUTTER_EVENT_REPLAY_H__
+
+#include "clutter-event.h"
+#include "clutter-master-clock.h"
+
+G_BEGIN_DECLS
+
+/* set when CLUTTER_RECORD_EVENTS names a file to record the input to */
+extern gboolean _clutter_event_recording;
+
+/* set when CLUTTER_REPLAY_EVENTS names a recording to replay */
+extern gboolean _clutter_event_replay_active;
+
+void    _clutter_event_record_init      (const gchar        *filename);
+void    _clutter_event_record           (const ClutterEvent *event);
+
+void    _clutter_event_replay_init      (const gchar        *filename,
+                                         gboolean            fast);
+void    _clutter_event_replay_frame     (ClutterMasterClock *master_clock);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_EVENT_REPLAY_H__ */
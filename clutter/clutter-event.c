@@ -31,9 +31,11 @@
 #include "clutter-debug.h"
 #include "clutter-event-private.h"
 #include "clutter-keysyms.h"
+#include "clutter-memory.h"
 #include "clutter-private.h"
 
 #include <math.h>
+#include <string.h>
 
 /**
  * SECTION:clutter-event
@@ -56,10 +58,27 @@ typedef struct _ClutterEventPrivate {
 
   gpointer platform_data;
 
+  /* the monotonic time at which the event was generated, in µs */
+  gint64 origin_time;
+
+  /* the ClutterEventSample of the compressed events, oldest first */
+  GArray *history;
+
+  /* the next free event of the pool */
+  struct _ClutterEventPrivate *next_free;
+
   guint is_pointer_emulated : 1;
+  guint is_allocated        : 1;
 } ClutterEventPrivate;
 
-static GHashTable *all_events = NULL;
+/* The events are allocated from blocks of memory that are never
+ * released; each block is twice the size of the previous one. The
+ * freed events are kept in a list, and re-used by clutter_event_new()
+ */
+#define EVENT_POOL_BLOCK_SIZE   64
+
+static GPtrArray *event_pool_blocks = NULL;
+static ClutterEventPrivate *event_pool_free = NULL;
 
 G_DEFINE_BOXED_TYPE (ClutterEvent, clutter_event,
                      clutter_event_copy,
@@ -68,10 +87,78 @@ G_DEFINE_BOXED_TYPE (ClutterEvent, clutter_event,
 static gboolean
 is_event_allocated (const ClutterEvent *event)
 {
-  if (all_events == NULL)
+  const ClutterEventPrivate *real_event = (const ClutterEventPrivate *) event;
+  guint i;
+
+  if (event_pool_blocks == NULL)
     return FALSE;
 
-  return g_hash_table_lookup (all_events, event) != NULL;
+  /* events that have not been created by clutter_event_new(), like the
+   * ones on the stack, do not have the private data, so we need to check
+   * that the event is inside the pool before looking at it
+   */
+  for (i = 0; i < event_pool_blocks->len; i++)
+    {
+      const ClutterEventPrivate *block;
+
+      block = g_ptr_array_index (event_pool_blocks, i);
+      if (real_event >= block &&
+          real_event < block + (EVENT_POOL_BLOCK_SIZE << i))
+        return real_event->is_allocated;
+    }
+
+  return FALSE;
+}
+
+static ClutterEventPrivate *
+event_pool_alloc (void)
+{
+  ClutterEventPrivate *real_event;
+
+  if (G_UNLIKELY (event_pool_free == NULL))
+    {
+      ClutterEventPrivate *block;
+      guint i, n_events;
+
+      if (event_pool_blocks == NULL)
+        event_pool_blocks = g_ptr_array_new ();
+
+      n_events = EVENT_POOL_BLOCK_SIZE << event_pool_blocks->len;
+      block = g_new (ClutterEventPrivate, n_events);
+
+      for (i = n_events; i > 0; i--)
+        {
+          block[i - 1].is_allocated = FALSE;
+          block[i - 1].next_free = event_pool_free;
+          event_pool_free = &block[i - 1];
+        }
+
+      g_ptr_array_add (event_pool_blocks, block);
+
+      _clutter_memory_account (CLUTTER_MEMORY_EVENTS,
+                               n_events * sizeof (ClutterEventPrivate),
+                               0);
+    }
+
+  real_event = event_pool_free;
+  event_pool_free = real_event->next_free;
+
+  memset (real_event, 0, sizeof (ClutterEventPrivate));
+  real_event->is_allocated = TRUE;
+
+  _clutter_memory_account (CLUTTER_MEMORY_EVENTS, 0, 1);
+
+  return real_event;
+}
+
+static void
+event_pool_release (ClutterEventPrivate *real_event)
+{
+  real_event->is_allocated = FALSE;
+  real_event->next_free = event_pool_free;
+  event_pool_free = real_event;
+
+  _clutter_memory_account (CLUTTER_MEMORY_EVENTS, 0, -1);
 }
 
 /*
@@ -112,6 +199,34 @@ _clutter_event_set_platform_data (ClutterEvent *event,
   ((ClutterEventPrivate *) event)->platform_data = data;
 }
 
+/*< private >
+ * _clutter_event_set_origin_time:
+ * @event: a #ClutterEvent
+ * @origin_time: the monotonic time, in microseconds
+ *
+ * Sets the time at which the input device generated @event, in the
+ * same time base as g_get_monotonic_time(). This is used to measure
+ * the latency between the input and the presentation of its effects.
+ */
+void
+_clutter_event_set_origin_time (ClutterEvent *event,
+                                gint64        origin_time)
+{
+  if (!is_event_allocated (event))
+    return;
+
+  ((ClutterEventPrivate *) event)->origin_time = origin_time;
+}
+
+gint64
+_clutter_event_get_origin_time (const ClutterEvent *event)
+{
+  if (!is_event_allocated (event))
+    return 0;
+
+  return ((ClutterEventPrivate *) event)->origin_time;
+}
+
 void
 _clutter_event_set_pointer_emulated (ClutterEvent *event,
                                      gboolean      is_emulated)
@@ -122,6 +237,100 @@ _clutter_event_set_pointer_emulated (ClutterEvent *event,
   ((ClutterEventPrivate *) event)->is_pointer_emulated = !!is_emulated;
 }
 
+static gdouble **
+event_get_axes_location (ClutterEvent *event)
+{
+  switch (event->type)
+    {
+    case CLUTTER_BUTTON_PRESS:
+    case CLUTTER_BUTTON_RELEASE:
+      return &event->button.axes;
+
+    case CLUTTER_MOTION:
+      return &event->motion.axes;
+
+    case CLUTTER_SCROLL:
+      return &event->scroll.axes;
+
+    case CLUTTER_TOUCH_BEGIN:
+    case CLUTTER_TOUCH_UPDATE:
+    case CLUTTER_TOUCH_END:
+    case CLUTTER_TOUCH_CANCEL:
+      return &event->touch.axes;
+
+    default:
+      return NULL;
+    }
+}
+
+static void
+event_history_free (GArray *history)
+{
+  guint i;
+
+  for (i = 0; i < history->len; i++)
+    g_free (g_array_index (history, ClutterEventSample, i).axes);
+
+  g_array_free (history, TRUE);
+}
+
+/*< private >
+ * _clutter_event_merge_history:
+ * @event: a #ClutterEvent
+ * @compressed: the event preceding @event, which is being dropped
+ *
+ * Transfers the history of @compressed, followed by a sample for
+ * @compressed itself, at the beginning of the history of @event.
+ *
+ * The axes of @compressed are stolen, and @compressed is left
+ * without a history.
+ */
+void
+_clutter_event_merge_history (ClutterEvent *event,
+                              ClutterEvent *compressed)
+{
+  ClutterEventPrivate *real_event = (ClutterEventPrivate *) event;
+  ClutterEventPrivate *real_compressed = (ClutterEventPrivate *) compressed;
+  ClutterEventSample sample;
+  gdouble **axes;
+  GArray *history;
+
+  if (!is_event_allocated (event) || !is_event_allocated (compressed))
+    return;
+
+  history = real_compressed->history;
+  real_compressed->history = NULL;
+
+  if (history == NULL)
+    history = g_array_new (FALSE, FALSE, sizeof (ClutterEventSample));
+
+  sample.time = clutter_event_get_time (compressed);
+  clutter_event_get_coords (compressed, &sample.x, &sample.y);
+
+  axes = event_get_axes_location (compressed);
+  if (axes != NULL)
+    {
+      sample.axes = *axes;
+      *axes = NULL;
+    }
+  else
+    sample.axes = NULL;
+
+  g_array_append_val (history, sample);
+
+  if (real_event->history != NULL)
+    {
+      g_array_append_vals (history,
+                           real_event->history->data,
+                           real_event->history->len);
+
+      /* the axes are now owned by the new array */
+      g_array_free (real_event->history, TRUE);
+    }
+
+  real_event->history = history;
+}
+
 /**
  * clutter_event_type:
  * @event: a #ClutterEvent
@@ -1100,16 +1309,11 @@ clutter_event_new (ClutterEventType type)
   ClutterEvent *new_event;
   ClutterEventPrivate *priv;
 
-  priv = g_slice_new0 (ClutterEventPrivate);
+  priv = event_pool_alloc ();
 
   new_event = (ClutterEvent *) priv;
   new_event->type = new_event->any.type = type;
 
-  if (G_UNLIKELY (all_events == NULL))
-    all_events = g_hash_table_new (NULL, NULL);
-
-  g_hash_table_replace (all_events, priv, GUINT_TO_POINTER (1));
-
   return new_event;
 }
 
@@ -1145,12 +1349,37 @@ clutter_event_copy (const ClutterEvent *event)
       new_real_event->delta_x = real_event->delta_x;
       new_real_event->delta_y = real_event->delta_y;
       new_real_event->is_pointer_emulated = real_event->is_pointer_emulated;
+      new_real_event->origin_time = real_event->origin_time;
     }
 
   device = clutter_event_get_device (event);
   if (device != NULL)
     n_axes = clutter_input_device_get_n_axes (device);
 
+  if (is_event_allocated (event) &&
+      ((ClutterEventPrivate *) event)->history != NULL)
+    {
+      GArray *history = ((ClutterEventPrivate *) event)->history;
+      guint i;
+
+      new_real_event->history =
+        g_array_sized_new (FALSE, FALSE,
+                           sizeof (ClutterEventSample),
+                           history->len);
+      g_array_append_vals (new_real_event->history,
+                           history->data,
+                           history->len);
+
+      for (i = 0; i < history->len; i++)
+        {
+          ClutterEventSample *sample;
+
+          sample = &g_array_index (new_real_event->history, ClutterEventSample, i);
+          if (sample->axes != NULL)
+            sample->axes = g_memdup (sample->axes, sizeof (gdouble) * n_axes);
+        }
+    }
+
   switch (event->type)
     {
     case CLUTTER_BUTTON_PRESS:
@@ -1204,8 +1433,13 @@ clutter_event_free (ClutterEvent *event)
 {
   if (G_LIKELY (event != NULL))
     {
+      g_return_if_fail (is_event_allocated (event));
+
       _clutter_backend_free_event_data (clutter_get_default_backend (), event);
 
+      if (((ClutterEventPrivate *) event)->history != NULL)
+        event_history_free (((ClutterEventPrivate *) event)->history);
+
       switch (event->type)
         {
         case CLUTTER_BUTTON_PRESS:
@@ -1232,8 +1466,7 @@ clutter_event_free (ClutterEvent *event)
           break;
         }
 
-      g_hash_table_remove (all_events, event);
-      g_slice_free (ClutterEventPrivate, (ClutterEventPrivate *) event);
+      event_pool_release ((ClutterEventPrivate *) event);
     }
 }
 
@@ -1533,6 +1766,50 @@ clutter_event_get_axes (const ClutterEvent *event,
   return retval;
 }
 
+/**
+ * clutter_event_get_history:
+ * @event: a #ClutterEvent
+ * @n_samples: (out): return location for the number of samples
+ *
+ * Retrieves the motion history of @event.
+ *
+ * When the motion events are compressed, see
+ * clutter_stage_set_throttle_motion_events(), the %CLUTTER_MOTION and
+ * %CLUTTER_TOUCH_UPDATE events that are dropped because a later event
+ * of the same device and type has been queued in the same frame are
+ * kept as samples of the event that is delivered instead. This allows
+ * applications to track every position of a device, while receiving
+ * a single event per frame.
+ *
+ * The samples are sorted from the oldest to the newest, and they do not
+ * include the coordinates of @event itself.
+ *
+ * Return value: (transfer none) (array length=n_samples): the samples,
+ *   or %NULL if @event has no history. The returned array is owned by
+ *   @event
+ */
+const ClutterEventSample *
+clutter_event_get_history (const ClutterEvent *event,
+                           guint              *n_samples)
+{
+  const ClutterEventPrivate *real_event = (const ClutterEventPrivate *) event;
+
+  g_return_val_if_fail (event != NULL, NULL);
+
+  if (!is_event_allocated (event) || real_event->history == NULL)
+    {
+      if (n_samples != NULL)
+        *n_samples = 0;
+
+      return NULL;
+    }
+
+  if (n_samples != NULL)
+    *n_samples = real_event->history->len;
+
+  return (const ClutterEventSample *) real_event->history->data;
+}
+
 /**
  * clutter_event_get_distance:
  * @source: a #ClutterEvent
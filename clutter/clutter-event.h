@@ -114,6 +114,7 @@ typedef struct _ClutterScrollEvent      ClutterScrollEvent;
 typedef struct _ClutterStageStateEvent  ClutterStageStateEvent;
 typedef struct _ClutterCrossingEvent    ClutterCrossingEvent;
 typedef struct _ClutterTouchEvent       ClutterTouchEvent;
+typedef struct _ClutterEventSample      ClutterEventSample;
 
 /**
  * ClutterAnyEvent:
@@ -383,6 +384,26 @@ struct _ClutterTouchEvent
   ClutterInputDevice *device;
 };
 
+/**
+ * ClutterEventSample:
+ * @time: the time of the sample
+ * @x: the X coordinate of the sample, relative to the stage
+ * @y: the Y coordinate of the sample, relative to the stage
+ * @axes: (array) (allow-none): the values of the axes of the sample, or
+ *   %NULL; the number of axes is the one returned by
+ *   clutter_input_device_get_n_axes() for the device of the event
+ *
+ * A motion or touch update sample that has been compressed into a
+ * later event. See clutter_event_get_history().
+ */
+struct _ClutterEventSample
+{
+  guint32 time;
+  gfloat x;
+  gfloat y;
+  gdouble *axes;
+};
+
 /**
  * ClutterEvent:
  *
@@ -461,6 +482,8 @@ double                  clutter_event_get_angle                 (const ClutterEv
 
 gdouble *               clutter_event_get_axes                  (const ClutterEvent     *event,
                                                                  guint                  *n_axes);
+const ClutterEventSample *clutter_event_get_history             (const ClutterEvent     *event,
+                                                                 guint                  *n_samples);
 
 
 gboolean                clutter_event_has_shift_modifier        (const ClutterEvent     *event);
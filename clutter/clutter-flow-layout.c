@@ -74,6 +74,7 @@
 #include <math.h>
 
 #include "clutter-actor.h"
+#include "clutter-actor-private.h"
 #include "clutter-animatable.h"
 #include "clutter-child-meta.h"
 #include "clutter-container.h"
@@ -85,6 +86,20 @@
 
 #define CLUTTER_FLOW_LAYOUT_GET_PRIVATE(obj)    (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_FLOW_LAYOUT, ClutterFlowLayoutPrivate))
 
+/* the value of dirty_line when none of the lines has been invalidated */
+#define LINES_VALID     G_MAXUINT
+
+typedef struct _FlowLine
+{
+  /* the first child in the line; for an empty line, the first child of
+   * the following one
+   */
+  ClutterActor *first_child;
+
+  gfloat min_size;
+  gfloat natural_size;
+} FlowLine;
+
 struct _ClutterFlowLayoutPrivate
 {
   ClutterContainer *container;
@@ -110,6 +125,17 @@ struct _ClutterFlowLayoutPrivate
 
   guint line_count;
 
+  /* the lines of the flow, cached between size requests, and the map
+   * from each visible child to the index of its line; only the lines
+   * from dirty_line onwards are computed again
+   */
+  GArray *lines;
+  GHashTable *child_lines;
+  guint dirty_line;
+  gfloat lines_for_size;
+  gint lines_n_per_line;
+  gint children_age;
+
   guint is_homogeneous : 1;
   guint snap_to_grid : 1;
 };
@@ -198,6 +224,310 @@ compute_lines (ClutterFlowLayout *self,
     return get_rows (self, avail_height);
 }
 
+static void
+clutter_flow_layout_invalidate_line (ClutterFlowLayout *self,
+                                     guint              line)
+{
+  ClutterFlowLayoutPrivate *priv = self->priv;
+
+  /* a child changing size might move back into the previous line */
+  if (line > 0)
+    line -= 1;
+
+  priv->dirty_line = MIN (priv->dirty_line, line);
+}
+
+static void
+clutter_flow_layout_invalidate_child (ClutterFlowLayout *self,
+                                      ClutterActor      *child)
+{
+  ClutterFlowLayoutPrivate *priv = self->priv;
+  ClutterActor *iter;
+  gpointer line;
+
+  /* children that are not in a line yet, like new or hidden ones, will
+   * go in the line of their closest previous sibling at the earliest
+   */
+  for (iter = child;
+       iter != NULL;
+       iter = clutter_actor_get_previous_sibling (iter))
+    {
+      if (g_hash_table_lookup_extended (priv->child_lines, iter, NULL, &line))
+        {
+          clutter_flow_layout_invalidate_line (self, GPOINTER_TO_UINT (line));
+          return;
+        }
+    }
+
+  clutter_flow_layout_invalidate_line (self, 0);
+}
+
+static void
+on_child_queue_relayout (ClutterActor      *child,
+                         ClutterFlowLayout *self)
+{
+  clutter_flow_layout_invalidate_child (self, child);
+}
+
+static void
+on_child_visible_changed (ClutterActor      *child,
+                          GParamSpec        *pspec,
+                          ClutterFlowLayout *self)
+{
+  clutter_flow_layout_invalidate_child (self, child);
+}
+
+static void
+clutter_flow_layout_connect_child (ClutterFlowLayout *self,
+                                   ClutterActor      *child)
+{
+  g_signal_connect (child, "queue-relayout",
+                    G_CALLBACK (on_child_queue_relayout),
+                    self);
+  g_signal_connect (child, "notify::visible",
+                    G_CALLBACK (on_child_visible_changed),
+                    self);
+}
+
+static void
+clutter_flow_layout_disconnect_child (ClutterFlowLayout *self,
+                                      ClutterActor      *child)
+{
+  g_signal_handlers_disconnect_by_func (child,
+                                        on_child_queue_relayout,
+                                        self);
+  g_signal_handlers_disconnect_by_func (child,
+                                        on_child_visible_changed,
+                                        self);
+}
+
+static void
+on_actor_added (ClutterContainer  *container,
+                ClutterActor      *child,
+                ClutterFlowLayout *self)
+{
+  ClutterFlowLayoutPrivate *priv = self->priv;
+
+  clutter_flow_layout_connect_child (self, child);
+  clutter_flow_layout_invalidate_child (self, child);
+
+  priv->children_age =
+    _clutter_actor_get_children_age (CLUTTER_ACTOR (container));
+}
+
+static void
+on_actor_removed (ClutterContainer  *container,
+                  ClutterActor      *child,
+                  ClutterFlowLayout *self)
+{
+  ClutterFlowLayoutPrivate *priv = self->priv;
+  gpointer value;
+
+  clutter_flow_layout_disconnect_child (self, child);
+
+  if (g_hash_table_lookup_extended (priv->child_lines, child, NULL, &value))
+    {
+      g_hash_table_remove (priv->child_lines, child);
+
+      clutter_flow_layout_invalidate_line (self, GPOINTER_TO_UINT (value));
+    }
+
+  priv->children_age =
+    _clutter_actor_get_children_age (CLUTTER_ACTOR (container));
+}
+
+/* computes the lines of the flow for the given available size along
+ * the orientation of the layout, starting from the first line that
+ * has been invalidated since the last call
+ */
+static void
+clutter_flow_layout_update_lines (ClutterFlowLayout *self,
+                                  ClutterActor      *container,
+                                  gfloat             for_size,
+                                  gint               n_per_line)
+{
+  ClutterFlowLayoutPrivate *priv = self->priv;
+  gboolean is_horizontal, check_break;
+  gint line_item_count;
+  ClutterActor *child;
+  gfloat item_pos;
+  gfloat spacing;
+  FlowLine line;
+  guint start;
+
+  /* children reordered without notification */
+  if (priv->children_age != _clutter_actor_get_children_age (container))
+    {
+      priv->children_age = _clutter_actor_get_children_age (container);
+      priv->dirty_line = 0;
+    }
+
+  if (priv->lines_for_size != for_size ||
+      priv->lines_n_per_line != n_per_line)
+    {
+      priv->lines_for_size = for_size;
+      priv->lines_n_per_line = n_per_line;
+      priv->dirty_line = 0;
+    }
+
+  if (priv->dirty_line == LINES_VALID)
+    return;
+
+  start = MIN (priv->dirty_line, priv->lines->len);
+
+  /* new children can only be appended to the last line */
+  if (start > 0 && start == priv->lines->len)
+    start -= 1;
+
+  if (start == 0)
+    child = clutter_actor_get_first_child (container);
+  else
+    child = g_array_index (priv->lines, FlowLine, start).first_child;
+
+  CLUTTER_NOTE (LAYOUT, "Flow: recomputing lines from %u of %u",
+                start,
+                priv->lines->len);
+
+  g_array_set_size (priv->lines, start);
+
+  is_horizontal = priv->orientation == CLUTTER_FLOW_HORIZONTAL;
+  spacing = is_horizontal ? priv->col_spacing : priv->row_spacing;
+
+  line.first_child = NULL;
+  line.min_size = line.natural_size = 0;
+
+  line_item_count = 0;
+  item_pos = 0;
+
+  /* the first child of a line other than the first one is there because
+   * it did not fit in the previous line, so it cannot break the line
+   */
+  check_break = start == 0;
+
+  for (; child != NULL; child = clutter_actor_get_next_sibling (child))
+    {
+      gfloat child_min, child_natural;
+      gfloat new_pos, item_size;
+
+      if (!CLUTTER_ACTOR_IS_VISIBLE (child))
+        {
+          g_hash_table_remove (priv->child_lines, child);
+          continue;
+        }
+
+      if (is_horizontal)
+        clutter_actor_get_preferred_width (child, -1,
+                                           &child_min,
+                                           &child_natural);
+      else
+        clutter_actor_get_preferred_height (child, -1,
+                                            &child_min,
+                                            &child_natural);
+
+      if (check_break &&
+          ((priv->snap_to_grid && line_item_count == n_per_line) ||
+           (!priv->snap_to_grid && item_pos + child_natural > for_size)))
+        {
+          /* an empty line starts at the child that did not fit */
+          if (line.first_child == NULL)
+            line.first_child = child;
+
+          g_array_append_val (priv->lines, line);
+
+          line.first_child = NULL;
+          line.min_size = line.natural_size = 0;
+
+          line_item_count = 0;
+          item_pos = 0;
+        }
+
+      if (line.first_child == NULL)
+        line.first_child = child;
+
+      check_break = TRUE;
+
+      if (priv->snap_to_grid)
+        {
+          new_pos = ((line_item_count + 1) * (for_size + spacing))
+                  / n_per_line;
+          item_size = new_pos - item_pos - spacing;
+        }
+      else
+        {
+          new_pos = item_pos + child_natural + spacing;
+          item_size = child_natural;
+        }
+
+      if (is_horizontal)
+        clutter_actor_get_preferred_height (child, item_size,
+                                            &child_min,
+                                            &child_natural);
+      else
+        clutter_actor_get_preferred_width (child, item_size,
+                                           &child_min,
+                                           &child_natural);
+
+      line.min_size = MAX (line.min_size, child_min);
+      line.natural_size = MAX (line.natural_size, child_natural);
+
+      item_pos = new_pos;
+      line_item_count += 1;
+
+      g_hash_table_insert (priv->child_lines, child,
+                           GUINT_TO_POINTER (priv->lines->len));
+    }
+
+  /* if we have a non-full line we need to add it */
+  if (line_item_count > 0)
+    g_array_append_val (priv->lines, line);
+
+  priv->dirty_line = LINES_VALID;
+}
+
+/* copies the sizes of the computed lines into the per-line arrays used
+ * by the allocation, and returns the number of lines
+ */
+static gint
+clutter_flow_layout_get_lines (ClutterFlowLayout *self,
+                               ClutterActor      *container,
+                               gfloat            *total_min_p,
+                               gfloat            *total_natural_p,
+                               gfloat            *max_min_p,
+                               gfloat            *max_natural_p)
+{
+  ClutterFlowLayoutPrivate *priv = self->priv;
+  gfloat total_min, total_natural;
+  gfloat max_min, max_natural;
+  guint i;
+
+  total_min = total_natural = 0;
+  max_min = max_natural = 0;
+
+  for (i = 0; i < priv->lines->len; i++)
+    {
+      const FlowLine *line = &g_array_index (priv->lines, FlowLine, i);
+
+      total_min += line->min_size;
+      total_natural += line->natural_size;
+
+      max_min = MAX (max_min, line->min_size);
+      max_natural = MAX (max_natural, line->natural_size);
+
+      g_array_append_val (priv->line_min, line->min_size);
+      g_array_append_val (priv->line_natural, line->natural_size);
+    }
+
+  *total_min_p = total_min;
+  *total_natural_p = total_natural;
+  *max_min_p = max_min;
+  *max_natural_p = max_natural;
+
+  if (priv->lines->len == 0 && clutter_actor_get_n_children (container) != 0)
+    return 1;
+
+  return priv->lines->len;
+}
+
 static void
 clutter_flow_layout_get_preferred_width (ClutterLayoutManager *manager,
                                          ClutterContainer     *container,
@@ -205,16 +535,16 @@ clutter_flow_layout_get_preferred_width (ClutterLayoutManager *manager,
                                          gfloat               *min_width_p,
                                          gfloat               *nat_width_p)
 {
-  ClutterFlowLayoutPrivate *priv = CLUTTER_FLOW_LAYOUT (manager)->priv;
-  gint n_rows, line_item_count, line_count;
+  ClutterFlowLayout *self = CLUTTER_FLOW_LAYOUT (manager);
+  ClutterFlowLayoutPrivate *priv = self->priv;
+  gint n_rows, line_count;
   gfloat total_min_width, total_natural_width;
   gfloat line_min_width, line_natural_width;
   gfloat max_min_width, max_natural_width;
   ClutterActor *actor, *child;
   ClutterActorIter iter;
-  gfloat item_y;
 
-  n_rows = get_rows (CLUTTER_FLOW_LAYOUT (manager), for_height);
+  n_rows = get_rows (self, for_height);
 
   total_min_width = 0;
   total_natural_width = 0;
@@ -222,11 +552,8 @@ clutter_flow_layout_get_preferred_width (ClutterLayoutManager *manager,
   line_min_width = 0;
   line_natural_width = 0;
 
-  line_item_count = 0;
   line_count = 0;
 
-  item_y = 0;
-
   actor = CLUTTER_ACTOR (container);
 
   /* clear the line width arrays */
@@ -243,71 +570,31 @@ clutter_flow_layout_get_preferred_width (ClutterLayoutManager *manager,
                                           sizeof (gfloat),
                                           16);
 
-  if (clutter_actor_get_n_children (actor) != 0)
-    line_count = 1;
-
   max_min_width = max_natural_width = 0;
 
-  clutter_actor_iter_init (&iter, actor);
-  while (clutter_actor_iter_next (&iter, &child))
+  if (priv->orientation == CLUTTER_FLOW_VERTICAL && for_height > 0)
     {
-      gfloat child_min, child_natural;
-      gfloat new_y, item_height;
+      clutter_flow_layout_update_lines (self, actor, for_height, n_rows);
 
-      if (!CLUTTER_ACTOR_IS_VISIBLE (child))
-        continue;
+      line_count = clutter_flow_layout_get_lines (self, actor,
+                                                  &total_min_width,
+                                                  &total_natural_width,
+                                                  &max_min_width,
+                                                  &max_natural_width);
+    }
+  else
+    {
+      if (clutter_actor_get_n_children (actor) != 0)
+        line_count = 1;
 
-      if (priv->orientation == CLUTTER_FLOW_VERTICAL && for_height > 0)
+      clutter_actor_iter_init (&iter, actor);
+      while (clutter_actor_iter_next (&iter, &child))
         {
-          clutter_actor_get_preferred_height (child, -1,
-                                              &child_min,
-                                              &child_natural);
-
-          if ((priv->snap_to_grid && line_item_count == n_rows) ||
-              (!priv->snap_to_grid && item_y + child_natural > for_height))
-            {
-              total_min_width += line_min_width;
-              total_natural_width += line_natural_width;
-
-              g_array_append_val (priv->line_min,
-                                  line_min_width);
-              g_array_append_val (priv->line_natural,
-                                  line_natural_width);
-
-              line_min_width = line_natural_width = 0;
-
-              line_item_count = 0;
-              line_count += 1;
-              item_y = 0;
-            }
-
-          if (priv->snap_to_grid)
-            {
-              new_y = ((line_item_count + 1) * (for_height + priv->row_spacing))
-                    / n_rows;
-              item_height = new_y - item_y - priv->row_spacing;
-            }
-          else
-            {
-              new_y = item_y + child_natural + priv->row_spacing;
-              item_height = child_natural;
-            }
-
-          clutter_actor_get_preferred_width (child, item_height,
-                                             &child_min,
-                                             &child_natural);
-
-          line_min_width = MAX (line_min_width, child_min);
-          line_natural_width = MAX (line_natural_width, child_natural);
+          gfloat child_min, child_natural;
 
-          item_y = new_y;
-          line_item_count += 1;
+          if (!CLUTTER_ACTOR_IS_VISIBLE (child))
+            continue;
 
-          max_min_width = MAX (max_min_width, line_min_width);
-          max_natural_width = MAX (max_natural_width, line_natural_width);
-        }
-      else
-        {
           clutter_actor_get_preferred_width (child, for_height,
                                              &child_min,
                                              &child_natural);
@@ -331,18 +618,6 @@ clutter_flow_layout_get_preferred_width (ClutterLayoutManager *manager,
 
   if (priv->orientation == CLUTTER_FLOW_VERTICAL && for_height > 0)
     {
-      /* if we have a non-full row we need to add it */
-      if (line_item_count > 0)
-        {
-          total_min_width += line_min_width;
-          total_natural_width += line_natural_width;
-
-          g_array_append_val (priv->line_min,
-                              line_min_width);
-          g_array_append_val (priv->line_natural,
-                              line_natural_width);
-        }
-
       priv->line_count = line_count;
 
       if (priv->line_count > 0)
@@ -396,16 +671,16 @@ clutter_flow_layout_get_preferred_height (ClutterLayoutManager *manager,
                                           gfloat               *min_height_p,
                                           gfloat               *nat_height_p)
 {
-  ClutterFlowLayoutPrivate *priv = CLUTTER_FLOW_LAYOUT (manager)->priv;
-  gint n_columns, line_item_count, line_count;
+  ClutterFlowLayout *self = CLUTTER_FLOW_LAYOUT (manager);
+  ClutterFlowLayoutPrivate *priv = self->priv;
+  gint n_columns, line_count;
   gfloat total_min_height, total_natural_height;
   gfloat line_min_height, line_natural_height;
   gfloat max_min_height, max_natural_height;
   ClutterActor *actor, *child;
   ClutterActorIter iter;
-  gfloat item_x;
 
-  n_columns = get_columns (CLUTTER_FLOW_LAYOUT (manager), for_width);
+  n_columns = get_columns (self, for_width);
 
   total_min_height = 0;
   total_natural_height = 0;
@@ -413,11 +688,8 @@ clutter_flow_layout_get_preferred_height (ClutterLayoutManager *manager,
   line_min_height = 0;
   line_natural_height = 0;
 
-  line_item_count = 0;
   line_count = 0;
 
-  item_x = 0;
-
   actor = CLUTTER_ACTOR (container);
 
   /* clear the line height arrays */
@@ -434,71 +706,31 @@ clutter_flow_layout_get_preferred_height (ClutterLayoutManager *manager,
                                           sizeof (gfloat),
                                           16);
 
-  if (clutter_actor_get_n_children (actor) != 0)
-    line_count = 1;
-
   max_min_height = max_natural_height = 0;
 
-  clutter_actor_iter_init (&iter, actor);
-  while (clutter_actor_iter_next (&iter, &child))
+  if (priv->orientation == CLUTTER_FLOW_HORIZONTAL && for_width > 0)
     {
-      gfloat child_min, child_natural;
-      gfloat new_x, item_width;
+      clutter_flow_layout_update_lines (self, actor, for_width, n_columns);
 
-      if (!CLUTTER_ACTOR_IS_VISIBLE (child))
-        continue;
+      line_count = clutter_flow_layout_get_lines (self, actor,
+                                                  &total_min_height,
+                                                  &total_natural_height,
+                                                  &max_min_height,
+                                                  &max_natural_height);
+    }
+  else
+    {
+      if (clutter_actor_get_n_children (actor) != 0)
+        line_count = 1;
 
-      if (priv->orientation == CLUTTER_FLOW_HORIZONTAL && for_width > 0)
+      clutter_actor_iter_init (&iter, actor);
+      while (clutter_actor_iter_next (&iter, &child))
         {
-          clutter_actor_get_preferred_width (child, -1,
-                                             &child_min,
-                                             &child_natural);
-
-          if ((priv->snap_to_grid && line_item_count == n_columns) ||
-              (!priv->snap_to_grid && item_x + child_natural > for_width))
-            {
-              total_min_height += line_min_height;
-              total_natural_height += line_natural_height;
-
-              g_array_append_val (priv->line_min,
-                                  line_min_height);
-              g_array_append_val (priv->line_natural,
-                                  line_natural_height);
+          gfloat child_min, child_natural;
 
-              line_min_height = line_natural_height = 0;
-
-              line_item_count = 0;
-              line_count += 1;
-              item_x = 0;
-            }
+          if (!CLUTTER_ACTOR_IS_VISIBLE (child))
+            continue;
 
-          if (priv->snap_to_grid)
-            {
-              new_x = ((line_item_count + 1) * (for_width + priv->col_spacing))
-                    / n_columns;
-              item_width = new_x - item_x - priv->col_spacing;
-            }
-          else
-            {
-              new_x = item_x + child_natural + priv->col_spacing;
-              item_width = child_natural;
-            }
-
-          clutter_actor_get_preferred_height (child, item_width,
-                                              &child_min,
-                                              &child_natural);
-
-          line_min_height = MAX (line_min_height, child_min);
-          line_natural_height = MAX (line_natural_height, child_natural);
-
-          item_x = new_x;
-          line_item_count += 1;
-
-          max_min_height = MAX (max_min_height, line_min_height);
-          max_natural_height = MAX (max_natural_height, line_natural_height);
-        }
-      else
-        {
           clutter_actor_get_preferred_height (child, for_width,
                                               &child_min,
                                               &child_natural);
@@ -523,18 +755,6 @@ clutter_flow_layout_get_preferred_height (ClutterLayoutManager *manager,
 
   if (priv->orientation == CLUTTER_FLOW_HORIZONTAL && for_width > 0)
     {
-      /* if we have a non-full row we need to add it */
-      if (line_item_count > 0)
-        {
-          total_min_height += line_min_height;
-          total_natural_height += line_natural_height;
-
-          g_array_append_val (priv->line_min,
-                              line_min_height);
-          g_array_append_val (priv->line_natural,
-                              line_natural_height);
-        }
-
       priv->line_count = line_count;
       if (priv->line_count > 0)
         {
@@ -761,8 +981,29 @@ static void
 clutter_flow_layout_set_container (ClutterLayoutManager *manager,
                                    ClutterContainer     *container)
 {
-  ClutterFlowLayoutPrivate *priv = CLUTTER_FLOW_LAYOUT (manager)->priv;
+  ClutterFlowLayout *self = CLUTTER_FLOW_LAYOUT (manager);
+  ClutterFlowLayoutPrivate *priv = self->priv;
   ClutterLayoutManagerClass *parent_class;
+  ClutterActor *child;
+
+  if (priv->container != NULL)
+    {
+      for (child = clutter_actor_get_first_child (CLUTTER_ACTOR (priv->container));
+           child != NULL;
+           child = clutter_actor_get_next_sibling (child))
+        clutter_flow_layout_disconnect_child (self, child);
+
+      g_signal_handlers_disconnect_by_func (priv->container,
+                                            on_actor_added,
+                                            self);
+      g_signal_handlers_disconnect_by_func (priv->container,
+                                            on_actor_removed,
+                                            self);
+    }
+
+  g_array_set_size (priv->lines, 0);
+  g_hash_table_remove_all (priv->child_lines);
+  priv->dirty_line = 0;
 
   priv->container = container;
 
@@ -770,6 +1011,21 @@ clutter_flow_layout_set_container (ClutterLayoutManager *manager,
     {
       ClutterRequestMode request_mode;
 
+      for (child = clutter_actor_get_first_child (CLUTTER_ACTOR (priv->container));
+           child != NULL;
+           child = clutter_actor_get_next_sibling (child))
+        clutter_flow_layout_connect_child (self, child);
+
+      g_signal_connect (priv->container, "actor-added",
+                        G_CALLBACK (on_actor_added),
+                        self);
+      g_signal_connect (priv->container, "actor-removed",
+                        G_CALLBACK (on_actor_removed),
+                        self);
+
+      priv->children_age =
+        _clutter_actor_get_children_age (CLUTTER_ACTOR (priv->container));
+
       /* we need to change the :request-mode of the container
        * to match the orientation
        */
@@ -784,6 +1040,15 @@ clutter_flow_layout_set_container (ClutterLayoutManager *manager,
   parent_class->set_container (manager, container);
 }
 
+static void
+clutter_flow_layout_layout_changed (ClutterLayoutManager *manager)
+{
+  ClutterFlowLayoutPrivate *priv = CLUTTER_FLOW_LAYOUT (manager)->priv;
+
+  /* any change in the layout properties affects all the lines */
+  priv->dirty_line = 0;
+}
+
 static void
 clutter_flow_layout_set_property (GObject      *gobject,
                                   guint         prop_id,
@@ -908,6 +1173,9 @@ clutter_flow_layout_finalize (GObject *gobject)
   if (priv->line_natural != NULL)
     g_array_free (priv->line_natural, TRUE);
 
+  g_array_unref (priv->lines);
+  g_hash_table_unref (priv->child_lines);
+
   G_OBJECT_CLASS (clutter_flow_layout_parent_class)->finalize (gobject);
 }
 
@@ -928,6 +1196,7 @@ clutter_flow_layout_class_init (ClutterFlowLayoutClass *klass)
     clutter_flow_layout_get_preferred_height;
   layout_class->allocate = clutter_flow_layout_allocate;
   layout_class->set_container = clutter_flow_layout_set_container;
+  layout_class->layout_changed = clutter_flow_layout_layout_changed;
 
   /**
    * ClutterFlowLayout:orientation:
@@ -1099,6 +1368,11 @@ clutter_flow_layout_init (ClutterFlowLayout *self)
   priv->line_min = NULL;
   priv->line_natural = NULL;
   priv->snap_to_grid = TRUE;
+
+  priv->lines = g_array_new (FALSE, FALSE, sizeof (FlowLine));
+  priv->child_lines = g_hash_table_new (NULL, NULL);
+  priv->dirty_line = 0;
+  priv->lines_for_size = -1;
 }
 
 /**
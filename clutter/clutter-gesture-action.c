@@ -97,8 +97,14 @@
 #define MAX_GESTURE_POINTS (10)
 #define FLOAT_EPSILON   (1e-15)
 
+/* a touch point, or a pointer with a pressed button; points are shared
+ * by all the gesture actions that received the press, and are kept up
+ * to date by the gesture arbiter of the stage
+ */
 typedef struct
 {
+  gint ref_count;
+
   ClutterInputDevice *device;
   ClutterEventSequence *sequence;
   ClutterEvent *last_event;
@@ -109,17 +115,34 @@ typedef struct
   gint64 last_delta_time;
   gfloat last_delta_x, last_delta_y;
   gfloat release_x, release_y;
+
+  /* the ClutterGestureActions tracking the point */
+  GPtrArray *actions;
 } GesturePoint;
 
+/* the gesture arbiter of a stage receives the events of the stage
+ * once, and routes the events of each point only to the actions that
+ * are tracking it
+ */
+typedef struct
+{
+  ClutterActor *stage;
+  gulong capture_id;
+
+  /* the active GesturePoints */
+  GPtrArray *points;
+} GestureArbiter;
+
 struct _ClutterGestureActionPrivate
 {
   ClutterActor *stage;
 
   gint requested_nb_points;
-  GArray *points;
+
+  /* the GesturePoints tracked by the action, in order of arrival */
+  GPtrArray *points;
 
   guint actor_capture_id;
-  gulong stage_capture_id;
 
   ClutterGestureTriggerEdge edge;
 
@@ -148,77 +171,215 @@ enum
 static GParamSpec *gesture_props[PROP_LAST];
 static guint gesture_signals[LAST_SIGNAL] = { 0, };
 
+static GQuark quark_gesture_arbiter = 0;
+
 G_DEFINE_TYPE (ClutterGestureAction, clutter_gesture_action, CLUTTER_TYPE_ACTION);
 
+#define gesture_get_point(action,i) \
+  ((GesturePoint *) g_ptr_array_index ((action)->priv->points, (i)))
+
+static gboolean arbiter_captured_event_cb (ClutterActor   *stage,
+                                           ClutterEvent   *event,
+                                           GestureArbiter *arbiter);
+
+static void
+gesture_point_unref (GesturePoint *point)
+{
+  if (--point->ref_count > 0)
+    return;
+
+  clutter_event_free (point->last_event);
+  g_ptr_array_unref (point->actions);
+  g_slice_free (GesturePoint, point);
+}
+
+static void
+gesture_arbiter_free (GestureArbiter *arbiter)
+{
+  g_ptr_array_unref (arbiter->points);
+  g_slice_free (GestureArbiter, arbiter);
+}
+
+static GestureArbiter *
+gesture_arbiter_get (ClutterActor *stage)
+{
+  GestureArbiter *arbiter;
+
+  arbiter = g_object_get_qdata (G_OBJECT (stage), quark_gesture_arbiter);
+  if (arbiter != NULL)
+    return arbiter;
+
+  arbiter = g_slice_new0 (GestureArbiter);
+  arbiter->stage = stage;
+  arbiter->points =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) gesture_point_unref);
+
+  g_object_set_qdata_full (G_OBJECT (stage), quark_gesture_arbiter,
+                           arbiter,
+                           (GDestroyNotify) gesture_arbiter_free);
+
+  return arbiter;
+}
+
+static GesturePoint *
+gesture_arbiter_find_point (GestureArbiter       *arbiter,
+                            ClutterInputDevice   *device,
+                            ClutterEventSequence *sequence,
+                            gint                 *position)
+{
+  gint i;
+
+  for (i = 0; i < arbiter->points->len; i++)
+    {
+      GesturePoint *point = g_ptr_array_index (arbiter->points, i);
+
+      if (point->device == device && point->sequence == sequence)
+        {
+          if (position != NULL)
+            *position = i;
+
+          return point;
+        }
+    }
+
+  return NULL;
+}
+
+static ClutterEventSequence *
+gesture_get_event_sequence (ClutterEvent *event)
+{
+  ClutterEventType type = clutter_event_type (event);
+
+  if ((type != CLUTTER_BUTTON_PRESS) &&
+      (type != CLUTTER_BUTTON_RELEASE) &&
+      (type != CLUTTER_MOTION))
+    return clutter_event_get_event_sequence (event);
+
+  return NULL;
+}
+
 static GesturePoint *
 gesture_register_point (ClutterGestureAction *action, ClutterEvent *event)
 {
   ClutterGestureActionPrivate *priv = action->priv;
+  ClutterInputDevice *device = clutter_event_get_device (event);
+  ClutterEventSequence *sequence = gesture_get_event_sequence (event);
+  GestureArbiter *arbiter;
   GesturePoint *point = NULL;
 
   if (priv->points->len >= MAX_GESTURE_POINTS)
     return NULL;
 
-  g_array_set_size (priv->points, priv->points->len + 1);
-  point = &g_array_index (priv->points, GesturePoint, priv->points->len - 1);
+  arbiter = gesture_arbiter_get (priv->stage);
 
-  point->last_event = clutter_event_copy (event);
-  point->device = clutter_event_get_device (event);
+  /* the press is delivered to each action on the actors underneath
+   * the point, so the first one creates the point and the others
+   * share it
+   */
+  point = gesture_arbiter_find_point (arbiter, device, sequence, NULL);
+  if (point == NULL)
+    {
+      point = g_slice_new0 (GesturePoint);
+      point->ref_count = 1;
+      point->actions = g_ptr_array_new ();
+
+      point->last_event = clutter_event_copy (event);
+      point->device = device;
+      point->sequence = sequence;
 
-  clutter_event_get_coords (event, &point->press_x, &point->press_y);
-  point->last_motion_x = point->press_x;
-  point->last_motion_y = point->press_y;
-  point->last_motion_time = clutter_event_get_time (event);
+      clutter_event_get_coords (event, &point->press_x, &point->press_y);
+      point->last_motion_x = point->press_x;
+      point->last_motion_y = point->press_y;
+      point->last_motion_time = clutter_event_get_time (event);
 
-  point->last_delta_x = point->last_delta_y = 0;
-  point->last_delta_time = 0;
+      point->last_delta_x = point->last_delta_y = 0;
+      point->last_delta_time = 0;
 
-  if (clutter_event_type (event) != CLUTTER_BUTTON_PRESS)
-    point->sequence = clutter_event_get_event_sequence (event);
+      g_ptr_array_add (arbiter->points, point);
+    }
   else
-    point->sequence = NULL;
+    {
+      gint i;
+
+      for (i = 0; i < point->actions->len; i++)
+        if (g_ptr_array_index (point->actions, i) == action)
+          return point;
+    }
+
+  point->ref_count += 1;
+  g_ptr_array_add (priv->points, point);
+  g_ptr_array_add (point->actions, action);
+
+  if (arbiter->capture_id == 0)
+    arbiter->capture_id =
+      g_signal_connect_after (arbiter->stage, "captured-event",
+                              G_CALLBACK (arbiter_captured_event_cb),
+                              arbiter);
 
   return point;
 }
 
-static GesturePoint *
+static gboolean
 gesture_find_point (ClutterGestureAction *action,
-                    ClutterEvent *event,
-                    gint *position)
+                    GesturePoint         *point,
+                    gint                 *position)
 {
-  ClutterGestureActionPrivate *priv = action->priv;
-  GesturePoint *point = NULL;
-  ClutterEventType type = clutter_event_type (event);
-  ClutterInputDevice *device = clutter_event_get_device (event);
-  ClutterEventSequence *sequence = NULL;
   gint i;
 
-  if ((type != CLUTTER_BUTTON_PRESS) &&
-      (type != CLUTTER_BUTTON_RELEASE) &&
-      (type != CLUTTER_MOTION))
-    sequence = clutter_event_get_event_sequence (event);
-
-  for (i = 0; i < priv->points->len; i++)
+  for (i = 0; i < action->priv->points->len; i++)
     {
-      if ((g_array_index (priv->points, GesturePoint, i).device == device) &&
-          (g_array_index (priv->points, GesturePoint, i).sequence == sequence))
+      if (gesture_get_point (action, i) == point)
         {
-          if (position != NULL)
-            *position = i;
-          point = &g_array_index (priv->points, GesturePoint, i);
-          break;
+          *position = i;
+          return TRUE;
         }
     }
 
-  return point;
+  return FALSE;
+}
+
+static void
+gesture_arbiter_check_idle (GestureArbiter *arbiter)
+{
+  if (arbiter->points->len == 0 && arbiter->capture_id != 0)
+    {
+      g_signal_handler_disconnect (arbiter->stage, arbiter->capture_id);
+      arbiter->capture_id = 0;
+    }
 }
 
 static void
 gesture_unregister_point (ClutterGestureAction *action, gint position)
+{
+  ClutterGestureActionPrivate *priv = action->priv;
+  GesturePoint *point = gesture_get_point (action, position);
+
+  g_ptr_array_remove (point->actions, action);
+
+  /* stop tracking the points that no action is interested in */
+  if (point->actions->len == 0 && priv->stage != NULL)
+    {
+      GestureArbiter *arbiter;
+
+      arbiter = g_object_get_qdata (G_OBJECT (priv->stage),
+                                    quark_gesture_arbiter);
+      if (arbiter != NULL)
+        {
+          g_ptr_array_remove (arbiter->points, point);
+          gesture_arbiter_check_idle (arbiter);
+        }
+    }
+
+  g_ptr_array_remove_index (priv->points, position);
+}
+
+static void
+gesture_unregister_all_points (ClutterGestureAction *action)
 {
   ClutterGestureActionPrivate *priv = action->priv;
 
-  g_array_remove_index (priv->points, position);
+  while (priv->points->len > 0)
+    gesture_unregister_point (action, priv->points->len - 1);
 }
 
 static void
@@ -284,30 +445,17 @@ gesture_point_pass_threshold (GesturePoint *point, ClutterEvent *event)
   return FALSE;
 }
 
-static void
-gesture_point_unset (GesturePoint *point)
-{
-  clutter_event_free (point->last_event);
-}
-
 static void
 cancel_gesture (ClutterGestureAction *action)
 {
-  ClutterGestureActionPrivate *priv = action->priv;
   ClutterActor *actor;
 
-  priv->in_gesture = FALSE;
-
-  if (priv->stage_capture_id != 0)
-    {
-      g_signal_handler_disconnect (priv->stage, priv->stage_capture_id);
-      priv->stage_capture_id = 0;
-    }
+  action->priv->in_gesture = FALSE;
 
   actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (action));
   g_signal_emit (action, gesture_signals[GESTURE_CANCEL], 0, actor);
 
-  g_array_set_size (action->priv->points, 0);
+  gesture_unregister_all_points (action);
 }
 
 static gboolean
@@ -342,19 +490,21 @@ begin_gesture (ClutterGestureAction *action,
   return TRUE;
 }
 
-static gboolean
-stage_captured_event_cb (ClutterActor       *stage,
-                         ClutterEvent       *event,
-                         ClutterGestureAction *action)
+/* handles an event for one of the points of @action; the point has
+ * already been updated by the arbiter
+ */
+static void
+gesture_action_handle_event (ClutterGestureAction *action,
+                             GesturePoint         *point,
+                             ClutterEvent         *event)
 {
   ClutterGestureActionPrivate *priv = action->priv;
   ClutterActor *actor;
   gint position, drag_threshold;
   gboolean return_value;
-  GesturePoint *point;
 
-  if ((point = gesture_find_point (action, event, &position)) == NULL)
-    return CLUTTER_EVENT_PROPAGATE;
+  if (!gesture_find_point (action, point, &position))
+    return;
 
   actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (action));
 
@@ -371,7 +521,7 @@ stage_captured_event_cb (ClutterActor       *stage,
         if (!(mods & CLUTTER_BUTTON1_MASK))
           {
             cancel_gesture (action);
-            return CLUTTER_EVENT_PROPAGATE;
+            return;
           }
       }
       /* Follow same code path as a touch event update */
@@ -380,35 +530,24 @@ stage_captured_event_cb (ClutterActor       *stage,
       if (!priv->in_gesture)
         {
           if (priv->points->len < priv->requested_nb_points)
-            {
-              gesture_update_motion_point (point, event);
-              return CLUTTER_EVENT_PROPAGATE;
-            }
+            return;
 
           /* Wait until the drag threshold has been exceeded
            * before starting _TRIGGER_EDGE_AFTER gestures. */
           if (priv->edge == CLUTTER_GESTURE_TRIGGER_EDGE_AFTER &&
               gesture_point_pass_threshold (point, event))
-            {
-              gesture_update_motion_point (point, event);
-              return CLUTTER_EVENT_PROPAGATE;
-            }
+            return;
 
-          if (!begin_gesture(action, actor))
-            {
-              gesture_update_motion_point (point, event);
-              return CLUTTER_EVENT_PROPAGATE;
-            }
+          if (!begin_gesture (action, actor))
+            return;
         }
 
-      gesture_update_motion_point (point, event);
-
       g_signal_emit (action, gesture_signals[GESTURE_PROGRESS], 0, actor,
                      &return_value);
       if (!return_value)
         {
           cancel_gesture (action);
-          return CLUTTER_EVENT_PROPAGATE;
+          return;
         }
 
       /* Check if a _TRIGGER_EDGE_BEFORE gesture needs to be cancelled because
@@ -419,15 +558,13 @@ stage_captured_event_cb (ClutterActor       *stage,
            (fabsf (point->press_x - point->last_motion_x) > drag_threshold)))
         {
           cancel_gesture (action);
-          return CLUTTER_EVENT_PROPAGATE;
+          return;
         }
       break;
 
     case CLUTTER_BUTTON_RELEASE:
     case CLUTTER_TOUCH_END:
       {
-        gesture_update_release_point (point, event);
-
         if (priv->in_gesture &&
             ((priv->points->len - 1) < priv->requested_nb_points))
           {
@@ -435,34 +572,87 @@ stage_captured_event_cb (ClutterActor       *stage,
             g_signal_emit (action, gesture_signals[GESTURE_END], 0, actor);
           }
 
-        gesture_unregister_point (action, position);
+        /* the signal handlers might have cancelled the gesture */
+        if (gesture_find_point (action, point, &position))
+          gesture_unregister_point (action, position);
       }
       break;
 
     case CLUTTER_TOUCH_CANCEL:
       {
-        gesture_update_release_point (point, event);
-
         if (priv->in_gesture)
           {
             priv->in_gesture = FALSE;
             cancel_gesture (action);
           }
 
-        gesture_unregister_point (action, position);
+        if (gesture_find_point (action, point, &position))
+          gesture_unregister_point (action, position);
       }
       break;
 
     default:
       break;
     }
+}
+
+static gboolean
+arbiter_captured_event_cb (ClutterActor   *stage,
+                           ClutterEvent   *event,
+                           GestureArbiter *arbiter)
+{
+  GesturePoint *point;
+  GPtrArray *actions;
+  gint i, position;
+
+  point = gesture_arbiter_find_point (arbiter,
+                                      clutter_event_get_device (event),
+                                      gesture_get_event_sequence (event),
+                                      &position);
+  if (point == NULL)
+    return CLUTTER_EVENT_PROPAGATE;
 
-  if (priv->points->len == 0)
+  /* the point is shared, so we update it once for all the actions */
+  switch (clutter_event_type (event))
     {
-      g_signal_handler_disconnect (priv->stage, priv->stage_capture_id);
-      priv->stage_capture_id = 0;
+    case CLUTTER_MOTION:
+    case CLUTTER_TOUCH_UPDATE:
+      gesture_update_motion_point (point, event);
+      break;
+
+    case CLUTTER_BUTTON_RELEASE:
+    case CLUTTER_TOUCH_END:
+    case CLUTTER_TOUCH_CANCEL:
+      gesture_update_release_point (point, event);
+
+      /* the point ends here, whatever the actions do with it */
+      point->ref_count += 1;
+      g_ptr_array_remove_index (arbiter->points, position);
+      break;
+
+    default:
+      return CLUTTER_EVENT_PROPAGATE;
     }
 
+  /* the signal handlers can add or remove actions, or cancel the
+   * gestures, so we work on a copy of the list
+   */
+  actions = g_ptr_array_new_with_free_func (g_object_unref);
+  for (i = 0; i < point->actions->len; i++)
+    g_ptr_array_add (actions, g_object_ref (g_ptr_array_index (point->actions, i)));
+
+  for (i = 0; i < actions->len; i++)
+    gesture_action_handle_event (g_ptr_array_index (actions, i), point, event);
+
+  g_ptr_array_unref (actions);
+
+  if (clutter_event_type (event) == CLUTTER_BUTTON_RELEASE ||
+      clutter_event_type (event) == CLUTTER_TOUCH_END ||
+      clutter_event_type (event) == CLUTTER_TOUCH_CANCEL)
+    gesture_point_unref (point);
+
+  gesture_arbiter_check_idle (arbiter);
+
   return CLUTTER_EVENT_PROPAGATE;
 }
 
@@ -472,7 +662,6 @@ actor_captured_event_cb (ClutterActor *actor,
                          ClutterGestureAction *action)
 {
   ClutterGestureActionPrivate *priv = action->priv;
-  GesturePoint *point G_GNUC_UNUSED;
 
   if ((clutter_event_type (event) != CLUTTER_BUTTON_PRESS) &&
       (clutter_event_type (event) != CLUTTER_TOUCH_BEGIN))
@@ -481,16 +670,11 @@ actor_captured_event_cb (ClutterActor *actor,
   if (!clutter_actor_meta_get_enabled (CLUTTER_ACTOR_META (action)))
     return CLUTTER_EVENT_PROPAGATE;
 
-  point = gesture_register_point (action, event);
-
   if (priv->stage == NULL)
     priv->stage = clutter_actor_get_stage (actor);
 
-  if (priv->stage_capture_id == 0)
-    priv->stage_capture_id =
-      g_signal_connect_after (priv->stage, "captured-event",
-                              G_CALLBACK (stage_captured_event_cb),
-                              action);
+  if (gesture_register_point (action, event) == NULL)
+    return CLUTTER_EVENT_PROPAGATE;
 
   /* Start the gesture immediately if the gesture has no
    * _TRIGGER_EDGE_AFTER drag threshold. */
@@ -519,14 +703,9 @@ clutter_gesture_action_set_actor (ClutterActorMeta *meta,
       priv->actor_capture_id = 0;
     }
 
-  if (priv->stage_capture_id != 0)
-    {
-      if (priv->stage != NULL)
-        g_signal_handler_disconnect (priv->stage, priv->stage_capture_id);
-
-      priv->stage_capture_id = 0;
-      priv->stage = NULL;
-    }
+  gesture_unregister_all_points (CLUTTER_GESTURE_ACTION (meta));
+  priv->in_gesture = FALSE;
+  priv->stage = NULL;
 
   if (actor != NULL)
     {
@@ -607,9 +786,10 @@ clutter_gesture_action_get_property (GObject    *gobject,
 static void
 clutter_gesture_action_finalize (GObject *gobject)
 {
-  ClutterGestureActionPrivate *priv = CLUTTER_GESTURE_ACTION (gobject)->priv;
+  ClutterGestureAction *self = CLUTTER_GESTURE_ACTION (gobject);
 
-  g_array_unref (priv->points);
+  gesture_unregister_all_points (self);
+  g_ptr_array_unref (self->priv->points);
 
   G_OBJECT_CLASS (clutter_gesture_action_parent_class)->finalize (gobject);
 }
@@ -622,6 +802,8 @@ clutter_gesture_action_class_init (ClutterGestureActionClass *klass)
 
   g_type_class_add_private (klass, sizeof (ClutterGestureActionPrivate));
 
+  quark_gesture_arbiter = g_quark_from_static_string ("-clutter-gesture-arbiter");
+
   gobject_class->finalize = clutter_gesture_action_finalize;
   gobject_class->set_property = clutter_gesture_action_set_property;
   gobject_class->get_property = clutter_gesture_action_get_property;
@@ -749,8 +931,8 @@ clutter_gesture_action_init (ClutterGestureAction *self)
   self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, CLUTTER_TYPE_GESTURE_ACTION,
                                             ClutterGestureActionPrivate);
 
-  self->priv->points = g_array_sized_new (FALSE, TRUE, sizeof (GesturePoint), 3);
-  g_array_set_clear_func (self->priv->points, (GDestroyNotify) gesture_point_unset);
+  self->priv->points =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) gesture_point_unref);
 
   self->priv->requested_nb_points = 1;
   self->priv->edge = CLUTTER_GESTURE_TRIGGER_EDGE_AFTER;
@@ -796,14 +978,10 @@ clutter_gesture_action_get_press_coords (ClutterGestureAction *action,
   g_return_if_fail (action->priv->points->len > point);
 
   if (press_x)
-    *press_x = g_array_index (action->priv->points,
-                              GesturePoint,
-                              point).press_x;
+    *press_x = gesture_get_point (action, point)->press_x;
 
   if (press_y)
-    *press_y = g_array_index (action->priv->points,
-                              GesturePoint,
-                              point).press_y;
+    *press_y = gesture_get_point (action, point)->press_y;
 }
 
 /**
@@ -831,14 +1009,10 @@ clutter_gesture_action_get_motion_coords (ClutterGestureAction *action,
   g_return_if_fail (action->priv->points->len > point);
 
   if (motion_x)
-    *motion_x = g_array_index (action->priv->points,
-                               GesturePoint,
-                               point).last_motion_x;
+    *motion_x = gesture_get_point (action, point)->last_motion_x;
 
   if (motion_y)
-    *motion_y = g_array_index (action->priv->points,
-                               GesturePoint,
-                               point).last_motion_y;
+    *motion_y = gesture_get_point (action, point)->last_motion_y;
 }
 
 /**
@@ -867,12 +1041,8 @@ clutter_gesture_action_get_motion_delta (ClutterGestureAction *action,
   g_return_val_if_fail (CLUTTER_IS_GESTURE_ACTION (action), 0);
   g_return_val_if_fail (action->priv->points->len > point, 0);
 
-  d_x = g_array_index (action->priv->points,
-                       GesturePoint,
-                       point).last_delta_x;
-  d_y = g_array_index (action->priv->points,
-                       GesturePoint,
-                       point).last_delta_y;
+  d_x = gesture_get_point (action, point)->last_delta_x;
+  d_y = gesture_get_point (action, point)->last_delta_y;
 
   if (delta_x)
     *delta_x = d_x;
@@ -908,14 +1078,10 @@ clutter_gesture_action_get_release_coords (ClutterGestureAction *action,
   g_return_if_fail (action->priv->points->len > point);
 
   if (release_x)
-    *release_x = g_array_index (action->priv->points,
-                                GesturePoint,
-                                point).release_x;
+    *release_x = gesture_get_point (action, point)->release_x;
 
   if (release_y)
-    *release_y = g_array_index (action->priv->points,
-                                GesturePoint,
-                                point).release_y;
+    *release_y = gesture_get_point (action, point)->release_y;
 }
 
 /**
@@ -946,9 +1112,7 @@ clutter_gesture_action_get_velocity (ClutterGestureAction *action,
   distance = clutter_gesture_action_get_motion_delta (action, point,
                                                       &d_x, &d_y);
 
-  d_t = g_array_index (action->priv->points,
-                       GesturePoint,
-                       point).last_delta_time;
+  d_t = gesture_get_point (action, point)->last_delta_time;
 
   if (velocity_x)
     *velocity_x = d_t > FLOAT_EPSILON ? d_x / d_t : 0;
@@ -1020,7 +1184,7 @@ clutter_gesture_action_set_n_touch_points (ClutterGestureAction *action,
 
           for (i = 0; i < priv->points->len; i++)
             {
-              GesturePoint *point = &g_array_index (priv->points, GesturePoint, i);
+              GesturePoint *point = gesture_get_point (action, i);
 
               if ((ABS (point->press_y - point->last_motion_y) >= drag_threshold) ||
                   (ABS (point->press_x - point->last_motion_x) >= drag_threshold))
@@ -1068,7 +1232,7 @@ clutter_gesture_action_get_sequence (ClutterGestureAction *action,
   g_return_val_if_fail (CLUTTER_IS_GESTURE_ACTION (action), NULL);
   g_return_val_if_fail (action->priv->points->len > point, NULL);
 
-  return g_array_index (action->priv->points, GesturePoint, point).sequence;
+  return gesture_get_point (action, point)->sequence;
 }
 
 /**
@@ -1088,7 +1252,7 @@ clutter_gesture_action_get_device (ClutterGestureAction *action,
   g_return_val_if_fail (CLUTTER_IS_GESTURE_ACTION (action), NULL);
   g_return_val_if_fail (action->priv->points->len > point, NULL);
 
-  return g_array_index (action->priv->points, GesturePoint, point).device;
+  return gesture_get_point (action, point)->device;
 }
 
 /**
@@ -1110,7 +1274,7 @@ clutter_gesture_action_get_last_event (ClutterGestureAction *action,
   g_return_val_if_fail (CLUTTER_IS_GESTURE_ACTION (action), NULL);
   g_return_val_if_fail (action->priv->points->len > point, NULL);
 
-  gesture_point = &g_array_index (action->priv->points, GesturePoint, point);
+  gesture_point = gesture_get_point (action, point);
 
   return gesture_point->last_event;
 }
@@ -0,0 +1,318 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+
+/*
+ * GPU frame timing.
+ *
+ * A ClutterGpuTimer measures the time the GPU spends on the commands
+ * of a frame by writing a GPU timestamp before and after them, using
+ * GL_ARB_timer_query on desktop GL or GL_EXT_disjoint_timer_query on
+ * GLES. The queries are read asynchronously: the results of a frame
+ * are only collected a few frames later, once the GPU has executed it,
+ * so measuring never stalls the pipeline.
+ *
+ * Cogl does not wrap the queries, so the GL entry points are resolved
+ * through cogl_get_proc_address(); the timer relies on the GL context
+ * of the stage being current, which is the case while it is painted.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <cogl/cogl.h>
+
+#include "clutter-gpu-timer.h"
+
+#include "clutter-debug.h"
+#include "clutter-private.h"
+
+/* the number of frames whose queries can be in flight at once */
+#define N_PENDING_FRAMES        4
+
+#define GL_EXTENSIONS           0x1F03
+#define GL_QUERY_RESULT         0x8866
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#define GL_TIMESTAMP            0x8E28
+#define GL_GPU_DISJOINT_EXT     0x8FBB
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+#define CLUTTER_GL_APIENTRY __stdcall
+#else
+#define CLUTTER_GL_APIENTRY
+#endif
+
+typedef const guchar *(CLUTTER_GL_APIENTRY *GetStringFunc) (guint name);
+typedef void (CLUTTER_GL_APIENTRY *GetIntegervFunc) (guint name, gint *value);
+typedef void (CLUTTER_GL_APIENTRY *GenQueriesFunc) (gint n, guint *ids);
+typedef void (CLUTTER_GL_APIENTRY *DeleteQueriesFunc) (gint n, const guint *ids);
+typedef void (CLUTTER_GL_APIENTRY *QueryCounterFunc) (guint id, guint target);
+typedef void (CLUTTER_GL_APIENTRY *GetQueryObjectivFunc) (guint id, guint name, gint *value);
+typedef void (CLUTTER_GL_APIENTRY *GetQueryObjectui64vFunc) (guint id, guint name, guint64 *value);
+
+typedef struct _GpuTimerFrame
+{
+  guint queries[2];
+  gboolean pending;
+} GpuTimerFrame;
+
+struct _ClutterGpuTimer
+{
+  GetIntegervFunc get_integerv;
+  GenQueriesFunc gen_queries;
+  DeleteQueriesFunc delete_queries;
+  QueryCounterFunc query_counter;
+  GetQueryObjectivFunc get_query_objectiv;
+  GetQueryObjectui64vFunc get_query_objectui64v;
+
+  /* whether the results can be invalidated by a disjoint operation */
+  gboolean check_disjoint;
+
+  GpuTimerFrame frames[N_PENDING_FRAMES];
+  guint current;
+
+  /* the GPU time of the last frame collected, in microseconds */
+  gint64 last_time;
+};
+
+static gboolean
+has_extension (const gchar *extensions,
+               const gchar *name)
+{
+  gsize len = strlen (name);
+  const gchar *p = extensions;
+
+  while ((p = strstr (p, name)) != NULL)
+    {
+      if ((p == extensions || p[-1] == ' ') &&
+          (p[len] == ' ' || p[len] == '\0'))
+        return TRUE;
+
+      p += len;
+    }
+
+  return FALSE;
+}
+
+/*< private >
+ * _clutter_gpu_timer_new:
+ *
+ * Creates a new GPU timer, using the GL context that is current.
+ *
+ * Return value: the new timer, or %NULL if the driver does not support
+ *   timer queries
+ */
+ClutterGpuTimer *
+_clutter_gpu_timer_new (void)
+{
+  ClutterGpuTimer *timer;
+  GetStringFunc get_string;
+  const gchar *extensions;
+  const gchar *suffix;
+  gchar *name;
+  guint i;
+
+  get_string = (GetStringFunc) cogl_get_proc_address ("glGetString");
+  if (get_string == NULL)
+    return NULL;
+
+  extensions = (const gchar *) get_string (GL_EXTENSIONS);
+  if (extensions == NULL)
+    return NULL;
+
+  timer = g_slice_new0 (ClutterGpuTimer);
+
+  if (has_extension (extensions, "GL_ARB_timer_query"))
+    suffix = "";
+  else if (has_extension (extensions, "GL_EXT_disjoint_timer_query"))
+    {
+      suffix = "EXT";
+      timer->check_disjoint = TRUE;
+    }
+  else
+    {
+      CLUTTER_NOTE (PAINT, "Timer queries are not supported");
+      g_slice_free (ClutterGpuTimer, timer);
+      return NULL;
+    }
+
+#define RESOLVE(field,func)                                     G_STMT_START { \
+  name = g_strconcat (func, suffix, NULL);                                     \
+  timer->field = (gpointer) cogl_get_proc_address (name);                      \
+  g_free (name);                                                               \
+                                                                } G_STMT_END
+
+  timer->get_integerv = (GetIntegervFunc) cogl_get_proc_address ("glGetIntegerv");
+  RESOLVE (gen_queries, "glGenQueries");
+  RESOLVE (delete_queries, "glDeleteQueries");
+  RESOLVE (query_counter, "glQueryCounter");
+  RESOLVE (get_query_objectiv, "glGetQueryObjectiv");
+  RESOLVE (get_query_objectui64v, "glGetQueryObjectui64v");
+
+#undef RESOLVE
+
+  if (timer->gen_queries == NULL ||
+      timer->delete_queries == NULL ||
+      timer->query_counter == NULL ||
+      timer->get_query_objectiv == NULL ||
+      timer->get_query_objectui64v == NULL ||
+      (timer->check_disjoint && timer->get_integerv == NULL))
+    {
+      CLUTTER_NOTE (PAINT, "Unable to resolve the timer query functions");
+      g_slice_free (ClutterGpuTimer, timer);
+      return NULL;
+    }
+
+  for (i = 0; i < N_PENDING_FRAMES; i++)
+    timer->gen_queries (2, timer->frames[i].queries);
+
+  timer->last_time = -1;
+
+  return timer;
+}
+
+void
+_clutter_gpu_timer_free (ClutterGpuTimer *timer)
+{
+  guint i;
+
+  if (timer == NULL)
+    return;
+
+  for (i = 0; i < N_PENDING_FRAMES; i++)
+    timer->delete_queries (2, timer->frames[i].queries);
+
+  g_slice_free (ClutterGpuTimer, timer);
+}
+
+/*< private >
+ * _clutter_gpu_timer_begin:
+ * @timer: a #ClutterGpuTimer
+ *
+ * Marks the beginning of the commands of a frame.
+ *
+ * If all the slots are still waiting for the GPU, the frame is not
+ * measured.
+ */
+void
+_clutter_gpu_timer_begin (ClutterGpuTimer *timer)
+{
+  GpuTimerFrame *frame = &timer->frames[timer->current];
+
+  if (frame->pending)
+    return;
+
+  /* the commands batched by Cogl so far belong to the previous frame */
+  cogl_flush ();
+
+  timer->query_counter (frame->queries[0], GL_TIMESTAMP);
+}
+
+static void
+gpu_timer_collect (ClutterGpuTimer *timer)
+{
+  gboolean disjoint = FALSE;
+  guint i;
+
+  if (timer->check_disjoint)
+    {
+      gint value = 0;
+
+      /* reading the flag resets it */
+      timer->get_integerv (GL_GPU_DISJOINT_EXT, &value);
+      disjoint = value != 0;
+    }
+
+  /* oldest first, so that last_time is the most recent frame */
+  for (i = 0; i < N_PENDING_FRAMES; i++)
+    {
+      GpuTimerFrame *frame;
+      guint64 start, end;
+      gint available = 0;
+
+      frame = &timer->frames[(timer->current + i) % N_PENDING_FRAMES];
+      if (!frame->pending)
+        continue;
+
+      timer->get_query_objectiv (frame->queries[1],
+                                 GL_QUERY_RESULT_AVAILABLE,
+                                 &available);
+      if (!available && !disjoint)
+        continue;
+
+      frame->pending = FALSE;
+
+      /* a disjoint operation makes the pending results meaningless */
+      if (disjoint)
+        continue;
+
+      timer->get_query_objectui64v (frame->queries[0], GL_QUERY_RESULT, &start);
+      timer->get_query_objectui64v (frame->queries[1], GL_QUERY_RESULT, &end);
+
+      if (end >= start)
+        timer->last_time = (gint64) ((end - start) / 1000);
+    }
+}
+
+/*< private >
+ * _clutter_gpu_timer_end:
+ * @timer: a #ClutterGpuTimer
+ *
+ * Marks the end of the commands of a frame, and collects the results
+ * of the previous frames that the GPU has completed.
+ */
+void
+_clutter_gpu_timer_end (ClutterGpuTimer *timer)
+{
+  GpuTimerFrame *frame = &timer->frames[timer->current];
+
+  if (!frame->pending)
+    {
+      /* submit the commands of the frame before the timestamp */
+      cogl_flush ();
+
+      timer->query_counter (frame->queries[1], GL_TIMESTAMP);
+      frame->pending = TRUE;
+
+      timer->current = (timer->current + 1) % N_PENDING_FRAMES;
+    }
+
+  gpu_timer_collect (timer);
+}
+
+/*< private >
+ * _clutter_gpu_timer_get_time:
+ * @timer: a #ClutterGpuTimer
+ *
+ * Retrieves the GPU time of the most recent frame whose results have
+ * been collected, which is usually a couple of frames behind the
+ * current one.
+ *
+ * Return value: the time, in microseconds, or -1 if no frame has
+ *   been collected yet
+ */
+gint64
+_clutter_gpu_timer_get_time (ClutterGpuTimer *timer)
+{
+  return timer->last_time;
+}
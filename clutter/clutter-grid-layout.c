@@ -75,7 +75,10 @@ typedef struct _ClutterGridAttach       ClutterGridAttach;
 typedef struct _ClutterGridLine         ClutterGridLine;
 typedef struct _ClutterGridLines        ClutterGridLines;
 typedef struct _ClutterGridLineData     ClutterGridLineData;
+typedef struct _ClutterGridSolution     ClutterGridSolution;
 typedef struct _ClutterGridRequest      ClutterGridRequest;
+typedef struct _ClutterGridCell         ClutterGridCell;
+typedef struct _ClutterGridExtent       ClutterGridExtent;
 
 
 struct _ClutterGridAttach
@@ -96,6 +99,32 @@ struct _ClutterGridChild
 #define CHILD_TOP(child)     ((child)->attach[CLUTTER_ORIENTATION_VERTICAL].pos)
 #define CHILD_HEIGHT(child)  ((child)->attach[CLUTTER_ORIENTATION_VERTICAL].span)
 
+/* children spanning more cells than this are not stored in the cell
+ * index, and are checked one by one instead
+ */
+#define MAX_INDEXED_CELLS       256
+
+/* A ClutterGridCell struct maps a cell of the grid to the first child,
+ * in paint order, covering it; @ordinal is the position of the child
+ * in the list of children.
+ */
+struct _ClutterGridCell
+{
+  gint left, top;
+
+  ClutterActor *child;
+  gint ordinal;
+};
+
+/* A ClutterGridExtent struct holds the first and last line occupied,
+ * along one orientation, by the children touching a line of the
+ * opposite orientation.
+ */
+struct _ClutterGridExtent
+{
+  gint min, max;
+};
+
 /* A ClutterGridLineData struct contains row/column specific parts
  * of the grid.
  */
@@ -105,12 +134,50 @@ struct _ClutterGridLineData
   guint homogeneous : 1;
 };
 
+/* A ClutterGridSolution struct holds the lines computed by a request
+ * along one orientation, so that they can be reused by a later request
+ * for the same children.
+ */
+struct _ClutterGridSolution
+{
+  ClutterGridLine *lines;
+  gint min, max;
+
+  /* the allocated size along the opposite orientation, for contextual
+   * requests; -1 otherwise
+   */
+  gfloat for_size;
+
+  /* the generation of the layout the lines were computed for; 0 if
+   * the solution is not valid
+   */
+  guint generation;
+};
+
 struct _ClutterGridLayoutPrivate
 {
   ClutterContainer *container;
   ClutterOrientation orientation;
 
   ClutterGridLineData linedata[2];
+
+  /* indexed by orientation, and by whether the request is contextual */
+  ClutterGridSolution solutions[2][2];
+
+  /* incremented whenever the children, their attachments or their
+   * sizes change, or the layout properties do
+   */
+  guint generation;
+  gint children_age;
+
+  /* the index of the cells covered by the children, rebuilt lazily
+   * whenever the children or their attachments change; the children
+   * too big for the index are in spanning_children
+   */
+  GHashTable *cells;
+  GHashTable *extents[2];
+  GArray *spanning_children;
+  guint cells_valid : 1;
 };
 
 #define ROWS(priv)    (&(priv)->linedata[CLUTTER_ORIENTATION_HORIZONTAL])
@@ -179,10 +246,183 @@ G_DEFINE_TYPE (ClutterGridLayout, clutter_grid_layout,
 
 
 #define GET_GRID_CHILD(grid, child) \
-  (CLUTTER_GRID_CHILD(clutter_layout_manager_get_child_meta \
+  (CLUTTER_GRID_CHILD(_clutter_layout_manager_get_child_meta \
    (CLUTTER_LAYOUT_MANAGER((grid)),\
     CLUTTER_GRID_LAYOUT((grid))->priv->container,(child))))
 
+static void clutter_grid_layout_check_children_age (ClutterGridLayout *self);
+
+static guint
+grid_cell_hash (gconstpointer key)
+{
+  const ClutterGridCell *cell = key;
+
+  return ((guint) cell->left * 31) ^ (guint) cell->top;
+}
+
+static gboolean
+grid_cell_equal (gconstpointer a,
+                 gconstpointer b)
+{
+  const ClutterGridCell *cell_a = a;
+  const ClutterGridCell *cell_b = b;
+
+  return cell_a->left == cell_b->left && cell_a->top == cell_b->top;
+}
+
+static inline void
+clutter_grid_layout_invalidate_cells (ClutterGridLayout *self)
+{
+  self->priv->cells_valid = FALSE;
+}
+
+static inline gboolean
+grid_child_is_indexed (ClutterGridChild *grid_child)
+{
+  gint width = CHILD_WIDTH (grid_child);
+  gint height = CHILD_HEIGHT (grid_child);
+
+  return width > 0 && width <= MAX_INDEXED_CELLS &&
+         height > 0 && height <= MAX_INDEXED_CELLS &&
+         width * height <= MAX_INDEXED_CELLS;
+}
+
+static void
+clutter_grid_layout_index_child (ClutterGridLayout *self,
+                                 ClutterActor      *child,
+                                 ClutterGridChild  *grid_child,
+                                 gint               ordinal)
+{
+  ClutterGridLayoutPrivate *priv = self->priv;
+  gint orientation;
+  gint x, y;
+
+  for (y = CHILD_TOP (grid_child);
+       y < CHILD_TOP (grid_child) + CHILD_HEIGHT (grid_child);
+       y++)
+    {
+      for (x = CHILD_LEFT (grid_child);
+           x < CHILD_LEFT (grid_child) + CHILD_WIDTH (grid_child);
+           x++)
+        {
+          ClutterGridCell key = { x, y, NULL, 0 };
+          ClutterGridCell *cell;
+
+          /* the first child covering a cell wins */
+          if (g_hash_table_lookup (priv->cells, &key) != NULL)
+            continue;
+
+          cell = g_slice_new (ClutterGridCell);
+          *cell = key;
+          cell->child = child;
+          cell->ordinal = ordinal;
+
+          g_hash_table_insert (priv->cells, cell, cell);
+        }
+    }
+
+  /* the lines touched by a child include the one past its end, see
+   * find_attach_position()
+   */
+  for (orientation = 0; orientation < 2; orientation++)
+    {
+      ClutterGridAttach *attach = &grid_child->attach[orientation];
+      ClutterGridAttach *opposite = &grid_child->attach[1 - orientation];
+      gint line;
+
+      for (line = opposite->pos; line <= opposite->pos + opposite->span; line++)
+        {
+          ClutterGridExtent *extent;
+
+          extent = g_hash_table_lookup (priv->extents[orientation],
+                                        GINT_TO_POINTER (line));
+          if (extent == NULL)
+            {
+              extent = g_slice_new (ClutterGridExtent);
+              extent->min = attach->pos;
+              extent->max = attach->pos + attach->span;
+
+              g_hash_table_insert (priv->extents[orientation],
+                                   GINT_TO_POINTER (line),
+                                   extent);
+            }
+          else
+            {
+              extent->min = MIN (extent->min, attach->pos);
+              extent->max = MAX (extent->max, attach->pos + attach->span);
+            }
+        }
+    }
+}
+
+static void
+grid_cell_free (gpointer data)
+{
+  g_slice_free (ClutterGridCell, data);
+}
+
+static void
+grid_extent_free (gpointer data)
+{
+  g_slice_free (ClutterGridExtent, data);
+}
+
+static void
+clutter_grid_layout_ensure_cells (ClutterGridLayout *self)
+{
+  ClutterGridLayoutPrivate *priv = self->priv;
+  ClutterActor *child;
+  gint ordinal;
+
+  if (priv->cells_valid)
+    return;
+
+  if (priv->cells == NULL)
+    {
+      priv->cells = g_hash_table_new_full (grid_cell_hash, grid_cell_equal,
+                                           NULL,
+                                           grid_cell_free);
+      priv->extents[0] = g_hash_table_new_full (NULL, NULL,
+                                                NULL,
+                                                grid_extent_free);
+      priv->extents[1] = g_hash_table_new_full (NULL, NULL,
+                                                NULL,
+                                                grid_extent_free);
+      priv->spanning_children = g_array_new (FALSE, FALSE,
+                                             sizeof (ClutterGridCell));
+    }
+  else
+    {
+      g_hash_table_remove_all (priv->cells);
+      g_hash_table_remove_all (priv->extents[0]);
+      g_hash_table_remove_all (priv->extents[1]);
+      g_array_set_size (priv->spanning_children, 0);
+    }
+
+  for (child = clutter_actor_get_first_child (CLUTTER_ACTOR (priv->container)), ordinal = 0;
+       child != NULL;
+       child = clutter_actor_get_next_sibling (child), ordinal++)
+    {
+      ClutterGridChild *grid_child = GET_GRID_CHILD (self, child);
+
+      if (grid_child_is_indexed (grid_child))
+        clutter_grid_layout_index_child (self, child, grid_child, ordinal);
+      else
+        {
+          ClutterGridCell spanning;
+
+          spanning.left = CHILD_LEFT (grid_child);
+          spanning.top = CHILD_TOP (grid_child);
+          spanning.child = child;
+          spanning.ordinal = ordinal;
+
+          g_array_append_val (priv->spanning_children, spanning);
+        }
+    }
+
+  priv->cells_valid = TRUE;
+}
+
 static void
 grid_attach (ClutterGridLayout *self,
              ClutterActor      *actor,
@@ -199,6 +439,8 @@ grid_attach (ClutterGridLayout *self,
   CHILD_TOP (grid_child) = top;
   CHILD_WIDTH (grid_child) = width;
   CHILD_HEIGHT (grid_child) = height;
+
+  clutter_grid_layout_invalidate_cells (self);
 }
 
 /* Find the position 'touching' existing
@@ -223,6 +465,7 @@ find_attach_position (ClutterGridLayout  *self,
   ClutterActor *child;
   gint pos;
   gboolean hit;
+  guint i;
 
   if (max)
     pos = -G_MAXINT;
@@ -234,6 +477,60 @@ find_attach_position (ClutterGridLayout  *self,
   if (!priv->container)
     return -1;
 
+  /* use the extents of the lines for the children in the index, and
+   * only check the spanning ones
+   */
+  if (op_span >= 0 && op_span < MAX_INDEXED_CELLS)
+    {
+      gint line;
+
+      clutter_grid_layout_check_children_age (self);
+      clutter_grid_layout_ensure_cells (self);
+
+      for (line = op_pos; line <= op_pos + op_span; line++)
+        {
+          ClutterGridExtent *extent;
+
+          extent = g_hash_table_lookup (priv->extents[orientation],
+                                        GINT_TO_POINTER (line));
+          if (extent == NULL)
+            continue;
+
+          hit = TRUE;
+
+          if (max)
+            pos = MAX (pos, extent->max);
+          else
+            pos = MIN (pos, extent->min);
+        }
+
+      for (i = 0; i < priv->spanning_children->len; i++)
+        {
+          ClutterGridCell *spanning;
+
+          spanning = &g_array_index (priv->spanning_children, ClutterGridCell, i);
+          grid_child = GET_GRID_CHILD (self, spanning->child);
+
+          attach = &grid_child->attach[orientation];
+          opposite = &grid_child->attach[1 - orientation];
+
+          if (opposite->pos <= op_pos + op_span && op_pos <= opposite->pos + opposite->span)
+            {
+              hit = TRUE;
+
+              if (max)
+                pos = MAX (pos, attach->pos + attach->span);
+              else
+                pos = MIN (pos, attach->pos);
+            }
+        }
+
+      if (!hit)
+        pos = 0;
+
+      return pos;
+    }
+
   clutter_actor_iter_init (&iter, CLUTTER_ACTOR (priv->container));
   while (clutter_actor_iter_next (&iter, &child))
     {
@@ -889,6 +1186,83 @@ clutter_grid_request_run (ClutterGridRequest *request,
   clutter_grid_request_homogeneous (request, orientation);
 }
 
+/* Like clutter_grid_request_run(), but reuses the lines computed by a
+ * previous run, if the layout did not change in the meantime and, for
+ * contextual runs, the size along the opposite orientation is the same.
+ */
+static void
+clutter_grid_request_solve (ClutterGridRequest *request,
+                            ClutterOrientation  orientation,
+                            gboolean            contextual,
+                            gfloat              for_size)
+{
+  ClutterGridLayoutPrivate *priv = request->grid->priv;
+  ClutterGridSolution *solution;
+  ClutterGridLines *lines;
+  gint n_lines;
+
+  solution = &priv->solutions[orientation][contextual ? 1 : 0];
+  lines = &request->lines[orientation];
+  n_lines = lines->max - lines->min;
+
+  if (!contextual)
+    for_size = -1;
+
+  if (solution->generation == priv->generation &&
+      solution->for_size == for_size &&
+      solution->min == lines->min &&
+      solution->max == lines->max)
+    {
+      memcpy (lines->lines, solution->lines, n_lines * sizeof (ClutterGridLine));
+      return;
+    }
+
+  CLUTTER_NOTE (LAYOUT, "Solving %s grid lines (contextual: %s, for size: %.2f)",
+                orientation == CLUTTER_ORIENTATION_HORIZONTAL ? "horizontal"
+                                                              : "vertical",
+                contextual ? "yes" : "no",
+                for_size);
+
+  clutter_grid_request_run (request, orientation, contextual);
+
+  solution->lines = g_renew (ClutterGridLine, solution->lines, MAX (n_lines, 1));
+  memcpy (solution->lines, lines->lines, n_lines * sizeof (ClutterGridLine));
+  solution->min = lines->min;
+  solution->max = lines->max;
+  solution->for_size = for_size;
+  solution->generation = priv->generation;
+}
+
+static void
+clutter_grid_layout_invalidate (ClutterGridLayout *self)
+{
+  ClutterGridLayoutPrivate *priv = self->priv;
+
+  priv->generation += 1;
+
+  /* skip the value used for invalid solutions */
+  if (G_UNLIKELY (priv->generation == 0))
+    priv->generation = 1;
+}
+
+/* children can be moved without notification, for instance when
+ * changing their paint order
+ */
+static void
+clutter_grid_layout_check_children_age (ClutterGridLayout *self)
+{
+  ClutterGridLayoutPrivate *priv = self->priv;
+  gint age;
+
+  age = _clutter_actor_get_children_age (CLUTTER_ACTOR (priv->container));
+  if (age != priv->children_age)
+    {
+      priv->children_age = age;
+      clutter_grid_layout_invalidate (self);
+      clutter_grid_layout_invalidate_cells (self);
+    }
+}
+
 typedef struct _RequestedSize
 {
   gpointer data;
@@ -1260,12 +1634,101 @@ clutter_grid_child_init (ClutterGridChild *self)
   CHILD_HEIGHT (self) = 1;
 }
 
+static void
+on_child_changed (ClutterActor      *child,
+                  ClutterGridLayout *self)
+{
+  clutter_grid_layout_invalidate (self);
+}
+
+static void
+on_child_visible_changed (ClutterActor      *child,
+                          GParamSpec        *pspec,
+                          ClutterGridLayout *self)
+{
+  clutter_grid_layout_invalidate (self);
+}
+
+static void
+clutter_grid_layout_connect_child (ClutterGridLayout *self,
+                                   ClutterActor      *child)
+{
+  g_signal_connect (child, "queue-relayout",
+                    G_CALLBACK (on_child_changed),
+                    self);
+  g_signal_connect (child, "notify::visible",
+                    G_CALLBACK (on_child_visible_changed),
+                    self);
+}
+
+static void
+clutter_grid_layout_disconnect_child (ClutterGridLayout *self,
+                                      ClutterActor      *child)
+{
+  g_signal_handlers_disconnect_by_func (child, on_child_changed, self);
+  g_signal_handlers_disconnect_by_func (child, on_child_visible_changed, self);
+}
+
+static void
+on_actor_added (ClutterContainer  *container,
+                ClutterActor      *child,
+                ClutterGridLayout *self)
+{
+  clutter_grid_layout_connect_child (self, child);
+  clutter_grid_layout_invalidate (self);
+  clutter_grid_layout_invalidate_cells (self);
+
+  self->priv->children_age =
+    _clutter_actor_get_children_age (CLUTTER_ACTOR (container));
+}
+
+static void
+on_actor_removed (ClutterContainer  *container,
+                  ClutterActor      *child,
+                  ClutterGridLayout *self)
+{
+  clutter_grid_layout_disconnect_child (self, child);
+  clutter_grid_layout_invalidate (self);
+  clutter_grid_layout_invalidate_cells (self);
+
+  self->priv->children_age =
+    _clutter_actor_get_children_age (CLUTTER_ACTOR (container));
+}
+
+static void
+clutter_grid_layout_layout_changed (ClutterLayoutManager *manager)
+{
+  /* this is also how the attachments of the children notify changes */
+  clutter_grid_layout_invalidate (CLUTTER_GRID_LAYOUT (manager));
+  clutter_grid_layout_invalidate_cells (CLUTTER_GRID_LAYOUT (manager));
+}
+
 static void
 clutter_grid_layout_set_container (ClutterLayoutManager *self,
                                    ClutterContainer     *container)
 {
-  ClutterGridLayoutPrivate *priv = CLUTTER_GRID_LAYOUT (self)->priv;
+  ClutterGridLayout *grid = CLUTTER_GRID_LAYOUT (self);
+  ClutterGridLayoutPrivate *priv = grid->priv;
   ClutterLayoutManagerClass *parent_class;
+  ClutterActor *child;
+
+  if (priv->container != NULL)
+    {
+      for (child = clutter_actor_get_first_child (CLUTTER_ACTOR (priv->container));
+           child != NULL;
+           child = clutter_actor_get_next_sibling (child))
+        clutter_grid_layout_disconnect_child (grid, child);
+
+      g_signal_handlers_disconnect_by_func (priv->container,
+                                            on_actor_added,
+                                            grid);
+      g_signal_handlers_disconnect_by_func (priv->container,
+                                            on_actor_removed,
+                                            grid);
+    }
+
+  clutter_grid_layout_invalidate (grid);
+  clutter_grid_layout_invalidate_cells (grid);
 
   priv->container = container;
 
@@ -1273,6 +1736,21 @@ clutter_grid_layout_set_container (ClutterLayoutManager *self,
     {
       ClutterRequestMode request_mode;
 
+      for (child = clutter_actor_get_first_child (CLUTTER_ACTOR (priv->container));
+           child != NULL;
+           child = clutter_actor_get_next_sibling (child))
+        clutter_grid_layout_connect_child (grid, child);
+
+      g_signal_connect (priv->container, "actor-added",
+                        G_CALLBACK (on_actor_added),
+                        grid);
+      g_signal_connect (priv->container, "actor-removed",
+                        G_CALLBACK (on_actor_removed),
+                        grid);
+
+      priv->children_age =
+        _clutter_actor_get_children_age (CLUTTER_ACTOR (priv->container));
+
       /* we need to change the :request-mode of the container
        * to match the orientation
        */
@@ -1304,13 +1782,14 @@ clutter_grid_layout_get_preferred_width (ClutterLayoutManager *self,
     *nat_width_p = 0.0f;
 
   request.grid = CLUTTER_GRID_LAYOUT (self);
+  clutter_grid_layout_check_children_age (request.grid);
   clutter_grid_request_update_attach (&request);
   clutter_grid_request_count_lines (&request);
   lines = &request.lines[priv->orientation];
   lines->lines = g_newa (ClutterGridLine, lines->max - lines->min);
   memset (lines->lines, 0, (lines->max - lines->min) * sizeof (ClutterGridLine));
 
-  clutter_grid_request_run (&request, priv->orientation, FALSE);
+  clutter_grid_request_solve (&request, priv->orientation, FALSE, -1);
   clutter_grid_request_sum (&request, priv->orientation,
                             min_width_p, nat_width_p);
 }
@@ -1332,13 +1811,14 @@ clutter_grid_layout_get_preferred_height (ClutterLayoutManager *self,
     *nat_height_p = 0.0f;
 
   request.grid = CLUTTER_GRID_LAYOUT (self);
+  clutter_grid_layout_check_children_age (request.grid);
   clutter_grid_request_update_attach (&request);
   clutter_grid_request_count_lines (&request);
   lines = &request.lines[priv->orientation];
   lines->lines = g_newa (ClutterGridLine, lines->max - lines->min);
   memset (lines->lines, 0, (lines->max - lines->min) * sizeof (ClutterGridLine));
 
-  clutter_grid_request_run (&request, priv->orientation, FALSE);
+  clutter_grid_request_solve (&request, priv->orientation, FALSE, -1);
   clutter_grid_request_sum (&request, priv->orientation,
                             min_height_p, nat_height_p);
 }
@@ -1391,6 +1871,7 @@ clutter_grid_layout_allocate (ClutterLayoutManager   *layout,
 
   request.grid = self;
 
+  clutter_grid_layout_check_children_age (self);
   clutter_grid_request_update_attach (&request);
   clutter_grid_request_count_lines (&request);
   lines = &request.lines[0];
@@ -1400,9 +1881,10 @@ clutter_grid_layout_allocate (ClutterLayoutManager   *layout,
   lines->lines = g_newa (ClutterGridLine, lines->max - lines->min);
   memset (lines->lines, 0, (lines->max - lines->min) * sizeof (ClutterGridLine));
 
-  clutter_grid_request_run (&request, 1 - priv->orientation, FALSE);
+  clutter_grid_request_solve (&request, 1 - priv->orientation, FALSE, -1);
   clutter_grid_request_allocate (&request, 1 - priv->orientation, GET_SIZE (allocation, 1 - priv->orientation));
-  clutter_grid_request_run (&request, priv->orientation, TRUE);
+  clutter_grid_request_solve (&request, priv->orientation, TRUE,
+                              GET_SIZE (allocation, 1 - priv->orientation));
   clutter_grid_request_allocate (&request, priv->orientation, GET_SIZE (allocation, priv->orientation));
 
   clutter_grid_request_position (&request, 0);
@@ -1519,6 +2001,29 @@ clutter_grid_layout_get_property (GObject    *gobject,
     }
 }
 
+static void
+clutter_grid_layout_finalize (GObject *gobject)
+{
+  ClutterGridLayoutPrivate *priv = CLUTTER_GRID_LAYOUT (gobject)->priv;
+  gint i;
+
+  for (i = 0; i < 2; i++)
+    {
+      g_free (priv->solutions[i][0].lines);
+      g_free (priv->solutions[i][1].lines);
+    }
+
+  if (priv->cells != NULL)
+    {
+      g_hash_table_destroy (priv->cells);
+      g_hash_table_destroy (priv->extents[0]);
+      g_hash_table_destroy (priv->extents[1]);
+      g_array_free (priv->spanning_children, TRUE);
+    }
+
+  G_OBJECT_CLASS (clutter_grid_layout_parent_class)->finalize (gobject);
+}
+
 static void
 clutter_grid_layout_class_init (ClutterGridLayoutClass *klass)
 {
@@ -1531,8 +2036,10 @@ clutter_grid_layout_class_init (ClutterGridLayoutClass *klass)
 
   object_class->set_property = clutter_grid_layout_set_property;
   object_class->get_property = clutter_grid_layout_get_property;
+  object_class->finalize = clutter_grid_layout_finalize;
 
   layout_class->set_container = clutter_grid_layout_set_container;
+  layout_class->layout_changed = clutter_grid_layout_layout_changed;
   layout_class->get_preferred_width = clutter_grid_layout_get_preferred_width;
   layout_class->get_preferred_height = clutter_grid_layout_get_preferred_height;
   layout_class->allocate = clutter_grid_layout_allocate;
@@ -1627,6 +2134,8 @@ clutter_grid_layout_init (ClutterGridLayout *self)
 
   priv->linedata[0].homogeneous = FALSE;
   priv->linedata[1].homogeneous = FALSE;
+
+  priv->generation = 1;
 }
 
 /**
@@ -1776,8 +2285,9 @@ clutter_grid_layout_get_child_at (ClutterGridLayout *layout,
 {
   ClutterGridLayoutPrivate *priv;
   ClutterGridChild *grid_child;
-  ClutterActorIter iter;
-  ClutterActor *child;
+  ClutterGridCell key = { left, top, NULL, 0 };
+  ClutterGridCell *cell;
+  guint i;
 
   g_return_val_if_fail (CLUTTER_IS_GRID_LAYOUT (layout), NULL);
 
@@ -1786,19 +2296,30 @@ clutter_grid_layout_get_child_at (ClutterGridLayout *layout,
   if (!priv->container)
     return NULL;
 
-  clutter_actor_iter_init (&iter, CLUTTER_ACTOR (priv->container));
-  while (clutter_actor_iter_next (&iter, &child))
+  clutter_grid_layout_check_children_age (layout);
+  clutter_grid_layout_ensure_cells (layout);
+
+  cell = g_hash_table_lookup (priv->cells, &key);
+
+  /* a spanning child covering the cell wins if it comes first */
+  for (i = 0; i < priv->spanning_children->len; i++)
     {
-      grid_child = GET_GRID_CHILD (layout, child);
+      ClutterGridCell *spanning;
+
+      spanning = &g_array_index (priv->spanning_children, ClutterGridCell, i);
+      if (cell != NULL && spanning->ordinal > cell->ordinal)
+        break;
+
+      grid_child = GET_GRID_CHILD (layout, spanning->child);
 
       if (CHILD_LEFT (grid_child) <= left &&
           CHILD_LEFT (grid_child) + CHILD_WIDTH (grid_child) > left &&
           CHILD_TOP (grid_child) <= top &&
           CHILD_TOP (grid_child) + CHILD_HEIGHT (grid_child) > top)
-        return child;
+        return spanning->child;
     }
 
-  return NULL;
+  return cell != NULL ? cell->child : NULL;
 }
 
 /**
@@ -35,12 +35,88 @@
 #include "clutter-debug.h"
 #include "clutter-id-pool.h"
 
+#define BITS_PER_WORD   (sizeof (gulong) * 8)
+
 struct _ClutterIDPool
 {
-  GArray *array;     /* Array of pointers    */
-  GSList *free_ids;  /* A stack of freed ids */
+  GArray *array;        /* Array of pointers                    */
+  GArray *free_ids;     /* Bitmap of free ids, as gulong words  */
+
+  guint n_free_ids;     /* The number of bits set in free_ids   */
+  guint first_free;     /* The first word that may have a bit set */
+
+  guint initial_size;
+  guint max_len;        /* The peak length since the last shrink */
 };
 
+static inline void
+id_pool_set_free (ClutterIDPool *id_pool,
+                  guint32        id_,
+                  gboolean       is_free)
+{
+  gulong *words = (gulong *) (void *) id_pool->free_ids->data;
+  gulong mask = 1UL << (id_ % BITS_PER_WORD);
+
+  if (is_free)
+    words[id_ / BITS_PER_WORD] |= mask;
+  else
+    words[id_ / BITS_PER_WORD] &= ~mask;
+}
+
+/* Drops the free ids at the end of the pool, and releases the memory
+ * after a large number of ids has been removed
+ */
+static void
+id_pool_compact (ClutterIDPool *id_pool)
+{
+  gpointer *array = (void *) id_pool->array->data;
+  guint len = id_pool->array->len;
+
+  while (len > 0 && array[len - 1] == NULL)
+    {
+      len -= 1;
+
+      id_pool_set_free (id_pool, len, FALSE);
+      id_pool->n_free_ids -= 1;
+    }
+
+  if (len == id_pool->array->len)
+    return;
+
+  g_array_set_size (id_pool->array, len);
+  g_array_set_size (id_pool->free_ids,
+                    (len + BITS_PER_WORD - 1) / BITS_PER_WORD);
+
+  id_pool->first_free = MIN (id_pool->first_free, id_pool->free_ids->len);
+
+  /* a GArray never gives memory back, so we need to copy the
+   * contents into a smaller one
+   */
+  if (id_pool->max_len > id_pool->initial_size &&
+      len < id_pool->max_len / 4)
+    {
+      GArray *array_copy;
+      GArray *free_ids_copy;
+
+      array_copy = g_array_sized_new (FALSE, FALSE, sizeof (gpointer),
+                                      MAX (len, id_pool->initial_size));
+      g_array_append_vals (array_copy, id_pool->array->data, len);
+
+      free_ids_copy = g_array_sized_new (FALSE, TRUE, sizeof (gulong),
+                                         id_pool->free_ids->len);
+      g_array_append_vals (free_ids_copy,
+                           id_pool->free_ids->data,
+                           id_pool->free_ids->len);
+
+      g_array_free (id_pool->array, TRUE);
+      g_array_free (id_pool->free_ids, TRUE);
+
+      id_pool->array = array_copy;
+      id_pool->free_ids = free_ids_copy;
+      id_pool->max_len = len;
+    }
+}
+
 ClutterIDPool *
 _clutter_id_pool_new  (guint initial_size)
 {
@@ -50,7 +126,14 @@ _clutter_id_pool_new  (guint initial_size)
 
   self->array = g_array_sized_new (FALSE, FALSE, 
                                    sizeof (gpointer), initial_size);
-  self->free_ids = NULL;
+  self->free_ids = g_array_sized_new (FALSE, TRUE, sizeof (gulong),
+                                      (initial_size + BITS_PER_WORD - 1)
+                                      / BITS_PER_WORD);
+  self->n_free_ids = 0;
+  self->first_free = 0;
+  self->initial_size = initial_size;
+  self->max_len = 0;
+
   return self;
 }
 
@@ -60,7 +143,7 @@ _clutter_id_pool_free (ClutterIDPool *id_pool)
   g_return_if_fail (id_pool != NULL);
 
   g_array_free (id_pool->array, TRUE);
-  g_slist_free (id_pool->free_ids);
+  g_array_free (id_pool->free_ids, TRUE);
   g_slice_free (ClutterIDPool, id_pool);
 }
 
@@ -73,13 +156,26 @@ _clutter_id_pool_add (ClutterIDPool *id_pool,
 
   g_return_val_if_fail (id_pool != NULL, 0);
 
-  if (id_pool->free_ids) /* There are items on our freelist, reuse one */
+  if (id_pool->n_free_ids > 0) /* There are free ids, reuse the lowest */
     {
-      array = (void*) id_pool->array->data;
-      retval = GPOINTER_TO_UINT (id_pool->free_ids->data);
+      gulong *words = (gulong *) (void *) id_pool->free_ids->data;
+      guint i;
+
+      for (i = id_pool->first_free; i < id_pool->free_ids->len; i++)
+        {
+          if (words[i] != 0)
+            break;
+        }
 
-      id_pool->free_ids = g_slist_remove (id_pool->free_ids,
-                                          id_pool->free_ids->data);
+      g_assert (i < id_pool->free_ids->len);
+
+      retval = i * BITS_PER_WORD + g_bit_nth_lsf (words[i], -1);
+
+      id_pool_set_free (id_pool, retval, FALSE);
+      id_pool->n_free_ids -= 1;
+      id_pool->first_free = i;
+
+      array = (void*) id_pool->array->data;
       array[retval] = ptr;
       return retval;
     }
@@ -88,6 +184,11 @@ _clutter_id_pool_add (ClutterIDPool *id_pool,
   retval = id_pool->array->len;
   g_array_append_val (id_pool->array, ptr);
 
+  if (id_pool->array->len > id_pool->free_ids->len * BITS_PER_WORD)
+    g_array_set_size (id_pool->free_ids, id_pool->free_ids->len + 1);
+
+  id_pool->max_len = MAX (id_pool->max_len, id_pool->array->len);
+
   return retval;
 }
 
@@ -99,12 +200,23 @@ _clutter_id_pool_remove (ClutterIDPool *id_pool,
 
   g_return_if_fail (id_pool != NULL);
 
+  /* the id might have been released already */
+  if (id_ >= id_pool->array->len)
+    return;
+
   array = (void*) id_pool->array->data;
 
+  if (array[id_] == NULL)
+    return;
+
   array[id_] = NULL;
 
-  id_pool->free_ids = g_slist_prepend (id_pool->free_ids,
-                                       GUINT_TO_POINTER (id_));
+  id_pool_set_free (id_pool, id_, TRUE);
+  id_pool->n_free_ids += 1;
+  id_pool->first_free = MIN (id_pool->first_free, id_ / BITS_PER_WORD);
+
+  if (id_ == id_pool->array->len - 1)
+    id_pool_compact (id_pool);
 }
 
 gpointer
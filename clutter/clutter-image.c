@@ -45,21 +45,133 @@
 
 #define CLUTTER_ENABLE_EXPERIMENTAL_API
 
+#include <math.h>
+#include <string.h>
+
 #include "clutter-image.h"
+#include "clutter-image-private.h"
 
+#include "clutter-backend.h"
 #include "clutter-color.h"
 #include "clutter-content-private.h"
 #include "clutter-debug.h"
+#include "clutter-main.h"
+#include "clutter-memory.h"
 #include "clutter-paint-node.h"
 #include "clutter-paint-nodes.h"
 #include "clutter-private.h"
 
+typedef struct _ImageCacheEntry ImageCacheEntry;
+
 struct _ClutterImagePrivate
 {
   CoglTexture *texture;
+
+  /* the entry of the texture cache for @texture, if it is shared */
+  ImageCacheEntry *cache_entry;
+
+  /* the full resolution image data, kept when downscaling */
+  GBytes *source;
+  CoglPixelFormat source_format;
+  guint source_width;
+  guint source_height;
+  guint source_stride;
+
+  /* the level of detail of @texture, relative to @source */
+  guint level;
+
+  /* bumped every time the image data is replaced, so that a pending
+   * asynchronous upload does not overwrite newer contents
+   */
+  guint upload_serial;
+
+  guint use_atlas : 1;
+  guint downscale : 1;
+
+  /* whether the image was last painted using mipmaps */
+  guint uses_mipmaps : 1;
+};
+
+typedef struct _ImageUpload
+{
+  /* the result returned to the caller of the async function */
+  GSimpleAsyncResult *result;
+
+  guint serial;
+
+  /* raw data: copied by the worker thread into the staging area */
+  const guint8 *data;
+  CoglPixelFormat pixel_format;
+  guint width;
+  guint height;
+  guint row_stride;
+
+  CoglPixelBuffer *staging;
+  guint8 *staging_data;
+
+  /* file: decoded by the worker thread */
+  gchar *filename;
+
+  CoglBitmap *bitmap;
+
+  /* the entry of the texture cache for the file; the upload holds a
+   * use on it until it is done
+   */
+  ImageCacheEntry *cache_entry;
+  GCancellable *cancellable;
+} ImageUpload;
+
+/* An ImageCacheEntry holds a texture shared by the images loading the
+ * same file; the entries that are not used by any image are kept in
+ * a LRU queue, and evicted once the size of the textures inside the
+ * cache exceeds its budget.
+ */
+struct _ImageCacheEntry
+{
+  gchar *key;
+
+  /* NULL while the file is being decoded */
+  CoglTexture *texture;
+  gsize size;
+
+  /* the images and uploads using the entry */
+  guint n_users;
+  GList lru_link;
+
+  /* the other uploads waiting for the file to be decoded */
+  GSList *waiting;
 };
 
+/* key -> ImageCacheEntry */
+static GHashTable *image_cache = NULL;
+
+/* the unused entries, least recently used first */
+static GQueue image_cache_lru = G_QUEUE_INIT;
+
+static gsize image_cache_size = 0;
+static gsize image_cache_max_size = 32 * 1024 * 1024;
+
 static void clutter_content_iface_init (ClutterContentIface *iface);
+static void clutter_image_set_cache_entry (ClutterImage    *image,
+                                           ImageCacheEntry *entry);
+
+/* images up to this size are placed in the shared texture atlas */
+#define IMAGE_ATLAS_MAX_SIZE    128
+
+/* the smallest level of detail used when downscaling */
+#define IMAGE_MAX_LEVEL         8
+
+enum
+{
+  PROP_0,
+
+  PROP_USE_ATLAS,
+  PROP_DOWNSCALE,
+
+  PROP_LAST
+};
+
+static GParamSpec *obj_props[PROP_LAST] = { NULL, };
 
 G_DEFINE_TYPE_WITH_CODE (ClutterImage, clutter_image, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_CONTENT,
@@ -82,15 +194,103 @@ clutter_image_finalize (GObject *gobject)
       priv->texture = NULL;
     }
 
+  clutter_image_set_cache_entry (CLUTTER_IMAGE (gobject), NULL);
+
+  g_clear_pointer (&priv->source, g_bytes_unref);
+
   G_OBJECT_CLASS (clutter_image_parent_class)->finalize (gobject);
 }
 
+static void
+clutter_image_set_property (GObject      *gobject,
+                            guint         prop_id,
+                            const GValue *value,
+                            GParamSpec   *pspec)
+{
+  ClutterImage *image = CLUTTER_IMAGE (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_USE_ATLAS:
+      clutter_image_set_use_atlas (image, g_value_get_boolean (value));
+      break;
+
+    case PROP_DOWNSCALE:
+      clutter_image_set_downscale (image, g_value_get_boolean (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_image_get_property (GObject    *gobject,
+                            guint       prop_id,
+                            GValue     *value,
+                            GParamSpec *pspec)
+{
+  ClutterImagePrivate *priv = CLUTTER_IMAGE (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_USE_ATLAS:
+      g_value_set_boolean (value, priv->use_atlas);
+      break;
+
+    case PROP_DOWNSCALE:
+      g_value_set_boolean (value, priv->downscale);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
 static void
 clutter_image_class_init (ClutterImageClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
   g_type_class_add_private (klass, sizeof (ClutterImagePrivate));
 
-  G_OBJECT_CLASS (klass)->finalize = clutter_image_finalize;
+  gobject_class->set_property = clutter_image_set_property;
+  gobject_class->get_property = clutter_image_get_property;
+  gobject_class->finalize = clutter_image_finalize;
+
+  /**
+   * ClutterImage:use-atlas:
+   *
+   * Whether small images should be placed inside a texture shared
+   * with other images.
+   *
+   * See clutter_image_set_use_atlas().
+   */
+  obj_props[PROP_USE_ATLAS] =
+    g_param_spec_boolean ("use-atlas",
+                          P_("Use Atlas"),
+                          P_("Whether small images should share a texture"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterImage:downscale:
+   *
+   * Whether the image should only keep a downscaled copy of the image
+   * data in texture memory, depending on the size at which it is painted.
+   *
+   * See clutter_image_set_downscale().
+   */
+  obj_props[PROP_DOWNSCALE] =
+    g_param_spec_boolean ("downscale",
+                          P_("Downscale"),
+                          P_("Whether the image data should be downscaled to the painted size"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
+  g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
 }
 
 static void
@@ -100,309 +300,1515 @@ clutter_image_init (ClutterImage *self)
                                             ClutterImagePrivate);
 }
 
-static void
-clutter_image_paint_content (ClutterContent   *content,
-                             ClutterActor     *actor,
-                             ClutterPaintNode *root)
+/* the shared atlas only accepts textures with an RGB or a premultiplied
+ * RGBA internal format; Cogl would otherwise preserve the layout of the
+ * image data, e.g. the BGRA of Cairo surfaces on little endian systems,
+ * and give each image its own texture
+ */
+static CoglPixelFormat
+clutter_image_get_internal_format (ClutterImage    *image,
+                                   CoglPixelFormat  pixel_format,
+                                   guint            width,
+                                   guint            height)
 {
-  ClutterImagePrivate *priv = CLUTTER_IMAGE (content)->priv;
-  ClutterScalingFilter min_f, mag_f;
-  ClutterContentRepeat repeat;
-  ClutterPaintNode *node;
-  ClutterActorBox box;
-  ClutterColor color;
-  guint8 paint_opacity;
+  if (!image->priv->use_atlas)
+    return COGL_PIXEL_FORMAT_ANY;
 
-  if (priv->texture == NULL)
-    return;
+  if (width > IMAGE_ATLAS_MAX_SIZE || height > IMAGE_ATLAS_MAX_SIZE)
+    return COGL_PIXEL_FORMAT_ANY;
 
-  clutter_actor_get_content_box (actor, &box);
-  paint_opacity = clutter_actor_get_paint_opacity (actor);
-  clutter_actor_get_content_scaling_filters (actor, &min_f, &mag_f);
-  repeat = clutter_actor_get_content_repeat (actor);
+  if ((pixel_format & COGL_A_BIT) != 0)
+    return COGL_PIXEL_FORMAT_RGBA_8888_PRE;
 
-  color.red = paint_opacity;
-  color.green = paint_opacity;
-  color.blue = paint_opacity;
-  color.alpha = paint_opacity;
+  return COGL_PIXEL_FORMAT_RGB_888;
+}
 
-  node = clutter_texture_node_new (priv->texture, &color, min_f, mag_f);
-  clutter_paint_node_set_name (node, "Image");
+static void
+clutter_image_clear_source (ClutterImage *image)
+{
+  ClutterImagePrivate *priv = image->priv;
 
-  if (repeat == CLUTTER_REPEAT_NONE)
-    clutter_paint_node_add_rectangle (node, &box);
+  g_clear_pointer (&priv->source, g_bytes_unref);
+  priv->level = 0;
+}
+
+/* the logical size of the image, regardless of the level of detail */
+static void
+clutter_image_get_size (ClutterImage *image,
+                        guint        *width,
+                        guint        *height)
+{
+  ClutterImagePrivate *priv = image->priv;
+
+  if (priv->source != NULL)
+    {
+      *width = priv->source_width;
+      *height = priv->source_height;
+    }
   else
     {
-      float t_w = 1.f, t_h = 1.f;
-
-      if ((repeat & CLUTTER_REPEAT_X_AXIS) != FALSE)
-        t_w = (box.x2 - box.x1) / cogl_texture_get_width (priv->texture);
+      *width = cogl_texture_get_width (priv->texture);
+      *height = cogl_texture_get_height (priv->texture);
+    }
+}
 
-      if ((repeat & CLUTTER_REPEAT_Y_AXIS) != FALSE)
-        t_h = (box.y2 - box.y1) / cogl_texture_get_height (priv->texture);
+/* we only downscale formats with four 8-bit channels; averaging each
+ * channel independently works regardless of their order
+ */
+static gboolean
+clutter_image_can_downscale (CoglPixelFormat pixel_format)
+{
+  switch (pixel_format & ~COGL_PREMULT_BIT)
+    {
+    case COGL_PIXEL_FORMAT_RGBA_8888:
+    case COGL_PIXEL_FORMAT_BGRA_8888:
+    case COGL_PIXEL_FORMAT_ARGB_8888:
+    case COGL_PIXEL_FORMAT_ABGR_8888:
+      return TRUE;
 
-      clutter_paint_node_add_texture_rectangle (node, &box,
-                                                0.f, 0.f,
-                                                t_w, t_h);
+    default:
+      return FALSE;
     }
-
-  clutter_paint_node_add_child (root, node);
-  clutter_paint_node_unref (node);
 }
 
-static gboolean
-clutter_image_get_preferred_size (ClutterContent *content,
-                                  gfloat         *width,
-                                  gfloat         *height)
+/* box filter of the source data, 2^level pixels on each side */
+static guint8 *
+clutter_image_downscale (const guint8 *src,
+                         guint         src_width,
+                         guint         src_height,
+                         guint         src_stride,
+                         guint         level,
+                         guint        *width_p,
+                         guint        *height_p)
 {
-  ClutterImagePrivate *priv = CLUTTER_IMAGE (content)->priv;
+  guint factor = 1 << level;
+  guint width = MAX (src_width >> level, 1);
+  guint height = MAX (src_height >> level, 1);
+  guint8 *res, *dst;
+  guint x, y;
 
-  if (priv->texture == NULL)
-    return FALSE;
+  res = dst = g_malloc (width * height * 4);
 
-  if (width != NULL)
-    *width = cogl_texture_get_width (priv->texture);
+  for (y = 0; y < height; y++)
+    {
+      guint y0 = y * factor;
+      guint y1 = MIN (y0 + factor, src_height);
 
-  if (height != NULL)
-    *height = cogl_texture_get_height (priv->texture);
+      for (x = 0; x < width; x++)
+        {
+          guint x0 = x * factor;
+          guint x1 = MIN (x0 + factor, src_width);
+          guint sum[4] = { 0, };
+          guint n = (x1 - x0) * (y1 - y0);
+          guint sx, sy, i;
 
-  return TRUE;
+          for (sy = y0; sy < y1; sy++)
+            {
+              const guint8 *p = src + sy * src_stride + x0 * 4;
+
+              for (sx = x0; sx < x1; sx++, p += 4)
+                {
+                  sum[0] += p[0];
+                  sum[1] += p[1];
+                  sum[2] += p[2];
+                  sum[3] += p[3];
+                }
+            }
+
+          for (i = 0; i < 4; i++)
+            *dst++ = sum[i] / n;
+        }
+    }
+
+  *width_p = width;
+  *height_p = height;
+
+  return res;
 }
 
-static void
-clutter_content_iface_init (ClutterContentIface *iface)
+static CoglTexture *
+clutter_image_create_texture (ClutterImage    *image,
+                              const guint8    *data,
+                              CoglPixelFormat  pixel_format,
+                              guint            width,
+                              guint            height,
+                              guint            row_stride)
 {
-  iface->get_preferred_size = clutter_image_get_preferred_size;
-  iface->paint_content = clutter_image_paint_content;
+  return cogl_texture_new_from_data (width, height,
+                                     COGL_TEXTURE_NONE,
+                                     pixel_format,
+                                     clutter_image_get_internal_format (image,
+                                                                        pixel_format,
+                                                                        width,
+                                                                        height),
+                                     row_stride,
+                                     data);
 }
 
-/**
- * clutter_image_new:
- *
- * Creates a new #ClutterImage instance.
- *
- * Return value: (transfer full): the newly created #ClutterImage instance.
- *   Use g_object_unref() when done.
- *
- *
- */
-ClutterContent *
-clutter_image_new (void)
+/* uploads a level of detail of the source data */
+static CoglTexture *
+clutter_image_create_level (ClutterImage *image,
+                            guint         level)
 {
-  return g_object_new (CLUTTER_TYPE_IMAGE, NULL);
+  ClutterImagePrivate *priv = image->priv;
+  const guint8 *data = g_bytes_get_data (priv->source, NULL);
+  CoglTexture *texture;
+  guint8 *scaled;
+  guint width, height;
+
+  if (level == 0)
+    return clutter_image_create_texture (image, data,
+                                         priv->source_format,
+                                         priv->source_width,
+                                         priv->source_height,
+                                         priv->source_stride);
+
+  scaled = clutter_image_downscale (data,
+                                    priv->source_width,
+                                    priv->source_height,
+                                    priv->source_stride,
+                                    level,
+                                    &width, &height);
+
+  texture = clutter_image_create_texture (image, scaled,
+                                          priv->source_format,
+                                          width, height,
+                                          width * 4);
+
+  g_free (scaled);
+
+  return texture;
 }
 
-/**
- * clutter_image_set_data:
- * @image: a #ClutterImage
- * @data: (array): the image data, as an array of bytes
- * @pixel_format: the Cogl pixel format of the image data
- * @width: the width of the image data
- * @height: the height of the image data
- * @row_stride: the length of each row inside @data
- * @error: return location for a #GError, or %NULL
- *
- * Sets the image data to be displayed by @image.
- *
- * If the image data was successfully loaded, the @image will be invalidated.
- *
- * In case of error, the @error value will be set, and this function will
- * return %FALSE.
- *
- * The image data is copied in texture memory.
- *
- * Return value: %TRUE if the image data was successfully loaded,
- *   and %FALSE otherwise.
- *
- *
+/* Cogl generates the mipmaps of a texture lazily, the first time it
+ * is painted with a mipmap filter; for images that we know are painted
+ * that way, we generate them right after the upload instead, by drawing
+ * the texture into a tiny framebuffer
  */
-gboolean
-clutter_image_set_data (ClutterImage     *image,
-                        const guint8     *data,
-                        CoglPixelFormat   pixel_format,
-                        guint             width,
-                        guint             height,
-                        guint             row_stride,
-                        GError          **error)
+static void
+clutter_image_ensure_mipmaps (ClutterImage *image)
 {
-  ClutterImagePrivate *priv;
+  static CoglFramebuffer *mipmap_fb = NULL;
+  static CoglPipeline *mipmap_pipeline = NULL;
+  ClutterImagePrivate *priv = image->priv;
+  CoglPipeline *pipeline;
 
-  g_return_val_if_fail (CLUTTER_IS_IMAGE (image), FALSE);
-  g_return_val_if_fail (data != NULL, FALSE);
+  if (!priv->uses_mipmaps || priv->texture == NULL)
+    return;
 
-  priv = image->priv;
+  if (G_UNLIKELY (mipmap_fb == NULL))
+    {
+      CoglContext *ctx;
+      CoglTexture *target;
 
-  if (priv->texture != NULL)
-    cogl_object_unref (priv->texture);
+      ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+      target = cogl_texture_new_with_size (1, 1,
+                                           COGL_TEXTURE_NO_SLICING,
+                                           COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+      mipmap_fb = COGL_FRAMEBUFFER (cogl_offscreen_new_to_texture (target));
+      cogl_object_unref (target);
 
-  priv->texture = cogl_texture_new_from_data (width, height,
-                                              COGL_TEXTURE_NONE,
-                                              pixel_format,
-                                              COGL_PIXEL_FORMAT_ANY,
-                                              row_stride,
-                                              data);
-  if (priv->texture == NULL)
-    {
-      g_set_error_literal (error, CLUTTER_IMAGE_ERROR,
-                           CLUTTER_IMAGE_ERROR_INVALID_DATA,
-                           _("Unable to load image data"));
-      return FALSE;
+      mipmap_pipeline = cogl_pipeline_new (ctx);
+      cogl_pipeline_set_layer_filters (mipmap_pipeline, 0,
+                                       COGL_PIPELINE_FILTER_LINEAR_MIPMAP_LINEAR,
+                                       COGL_PIPELINE_FILTER_LINEAR);
     }
 
-  clutter_content_invalidate (CLUTTER_CONTENT (image));
+  pipeline = cogl_pipeline_copy (mipmap_pipeline);
+  cogl_pipeline_set_layer_texture (pipeline, 0, priv->texture);
+  cogl_framebuffer_draw_rectangle (mipmap_fb, pipeline, -1.f, -1.f, 1.f, 1.f);
+  cogl_object_unref (pipeline);
+}
 
-  return TRUE;
+static void
+image_cache_entry_free (ImageCacheEntry *entry)
+{
+  g_assert (entry->n_users == 0 && entry->waiting == NULL);
+
+  if (entry->texture != NULL)
+    {
+      image_cache_size -= entry->size;
+      cogl_object_unref (entry->texture);
+    }
+
+  g_free (entry->key);
+  g_slice_free (ImageCacheEntry, entry);
 }
 
-/**
- * clutter_image_set_bytes:
- * @image: a #ClutterImage
- * @data: the image data, as a #GBytes
- * @pixel_format: the Cogl pixel format of the image data
- * @width: the width of the image data
- * @height: the height of the image data
- * @row_stride: the length of each row inside @data
- * @error: return location for a #GError, or %NULL
- *
- * Sets the image data stored inside a #GBytes to be displayed by @image.
- *
- * If the image data was successfully loaded, the @image will be invalidated.
- *
- * In case of error, the @error value will be set, and this function will
- * return %FALSE.
- *
- * The image data contained inside the #GBytes is copied in texture memory,
- * and no additional reference is acquired on the @data.
- *
- * Return value: %TRUE if the image data was successfully loaded,
- *   and %FALSE otherwise.
- *
- *
+/* evicts the least recently used textures until the cache is within
+ * @max_size; the textures used by an image are never evicted
  */
-gboolean
-clutter_image_set_bytes (ClutterImage     *image,
-                         GBytes           *data,
-                         CoglPixelFormat   pixel_format,
-                         guint             width,
-                         guint             height,
-                         guint             row_stride,
-                         GError          **error)
+static void
+image_cache_trim (gsize max_size)
 {
-  ClutterImagePrivate *priv;
+  while (image_cache_size > max_size &&
+         image_cache_lru.head != NULL)
+    {
+      ImageCacheEntry *entry = image_cache_lru.head->data;
 
-  g_return_val_if_fail (CLUTTER_IS_IMAGE (image), FALSE);
-  g_return_val_if_fail (data != NULL, FALSE);
+      g_queue_unlink (&image_cache_lru, &entry->lru_link);
+      g_hash_table_remove (image_cache, entry->key);
 
-  priv = image->priv;
+      CLUTTER_NOTE (MISC, "Evicting '%s' from the image cache", entry->key);
 
-  if (priv->texture != NULL)
-    cogl_object_unref (priv->texture);
+      image_cache_entry_free (entry);
+    }
+}
+
+static void
+image_cache_purge (gpointer          instance,
+                   ClutterPurgeLevel level)
+{
+  image_cache_trim (0);
+}
+
+static ImageCacheEntry *
+image_cache_lookup (const gchar *key)
+{
+  if (image_cache == NULL)
+    return NULL;
+
+  return g_hash_table_lookup (image_cache, key);
+}
+
+/* adds an entry for @key, whose texture is still being loaded */
+static ImageCacheEntry *
+image_cache_insert (const gchar *key)
+{
+  ImageCacheEntry *entry;
+
+  if (image_cache == NULL)
+    {
+      image_cache = g_hash_table_new (g_str_hash, g_str_equal);
+
+      /* the textures not used by any image can be evicted at once */
+      _clutter_memory_add_purge_func (CLUTTER_MEMORY_CONTENT_TEXTURES,
+                                      &image_cache,
+                                      image_cache_purge);
+    }
+
+  entry = g_slice_new0 (ImageCacheEntry);
+  entry->key = g_strdup (key);
+  entry->lru_link.data = entry;
+
+  g_hash_table_insert (image_cache, entry->key, entry);
+
+  return entry;
+}
+
+static void
+image_cache_entry_use (ImageCacheEntry *entry)
+{
+  if (entry->n_users == 0 && entry->texture != NULL)
+    g_queue_unlink (&image_cache_lru, &entry->lru_link);
+
+  entry->n_users += 1;
+}
+
+static void
+image_cache_entry_release (ImageCacheEntry *entry)
+{
+  g_assert (entry->n_users > 0);
+
+  entry->n_users -= 1;
+  if (entry->n_users > 0)
+    return;
+
+  /* the file could not be loaded */
+  if (entry->texture == NULL)
+    {
+      g_hash_table_remove (image_cache, entry->key);
+      image_cache_entry_free (entry);
+      return;
+    }
+
+  g_queue_push_tail_link (&image_cache_lru, &entry->lru_link);
+  image_cache_trim (image_cache_max_size);
+}
+
+static void
+image_cache_entry_set_texture (ImageCacheEntry *entry,
+                               CoglTexture     *texture)
+{
+  entry->texture = cogl_object_ref (texture);
+  entry->size = (gsize) cogl_texture_get_width (texture)
+              * cogl_texture_get_height (texture)
+              * 4;
+
+  image_cache_size += entry->size;
+}
+
+static void
+clutter_image_set_cache_entry (ClutterImage    *image,
+                               ImageCacheEntry *entry)
+{
+  ClutterImagePrivate *priv = image->priv;
+
+  if (priv->cache_entry == entry)
+    return;
+
+  if (entry != NULL)
+    image_cache_entry_use (entry);
+
+  if (priv->cache_entry != NULL)
+    image_cache_entry_release (priv->cache_entry);
+
+  priv->cache_entry = entry;
+}
+
+/* replaces the texture of @image with the shared one inside @entry */
+static void
+clutter_image_set_cached_texture (ClutterImage    *image,
+                                  ImageCacheEntry *entry)
+{
+  ClutterImagePrivate *priv = image->priv;
+
+  cogl_object_ref (entry->texture);
+
+  if (priv->texture != NULL)
+    cogl_object_unref (priv->texture);
+
+  priv->texture = entry->texture;
+  clutter_image_set_cache_entry (image, entry);
+
+  clutter_image_clear_source (image);
+  clutter_image_ensure_mipmaps (image);
+
+  clutter_content_invalidate (CLUTTER_CONTENT (image));
+}
+
+/* gives @image its own copy of a shared texture, before changing it */
+static void
+clutter_image_unshare_texture (ClutterImage *image)
+{
+  ClutterImagePrivate *priv = image->priv;
+  CoglPixelFormat format = COGL_PIXEL_FORMAT_RGBA_8888_PRE;
+  CoglTexture *texture;
+  guint8 *data;
+  guint width, height;
+
+  if (priv->cache_entry == NULL)
+    return;
+
+  width = cogl_texture_get_width (priv->texture);
+  height = cogl_texture_get_height (priv->texture);
+
+  data = g_malloc (width * height * 4);
+  cogl_texture_get_data (priv->texture, format, width * 4, data);
+
+  texture = clutter_image_create_texture (image, data, format,
+                                          width, height,
+                                          width * 4);
+  g_free (data);
+
+  cogl_object_unref (priv->texture);
+  priv->texture = texture;
+  _clutter_memory_track_texture (CLUTTER_MEMORY_CONTENT_TEXTURES, texture);
+
+  clutter_image_set_cache_entry (image, NULL);
+}
+
+static gboolean
+clutter_image_upload_data (ClutterImage     *image,
+                           const guint8     *data,
+                           GBytes           *bytes,
+                           CoglPixelFormat   pixel_format,
+                           guint             width,
+                           guint             height,
+                           guint             row_stride,
+                           GError          **error)
+{
+  ClutterImagePrivate *priv = image->priv;
+  CoglTexture *texture;
+
+  priv->upload_serial += 1;
+
+  g_clear_pointer (&priv->source, g_bytes_unref);
+
+  if (priv->downscale && clutter_image_can_downscale (pixel_format))
+    {
+      if (bytes != NULL)
+        priv->source = g_bytes_ref (bytes);
+      else
+        priv->source = g_bytes_new (data, row_stride * height);
+
+      priv->source_format = pixel_format;
+      priv->source_width = width;
+      priv->source_height = height;
+      priv->source_stride = row_stride;
+
+      /* keep the level of detail of the previous contents */
+      priv->level = MIN (priv->level, g_bit_storage (MAX (width, height)) - 1);
+
+      texture = clutter_image_create_level (image, priv->level);
+    }
+  else
+    {
+      clutter_image_clear_source (image);
+
+      texture = clutter_image_create_texture (image,
+                                              bytes != NULL
+                                                ? g_bytes_get_data (bytes, NULL)
+                                                : data,
+                                              pixel_format,
+                                              width, height,
+                                              row_stride);
+    }
+
+  if (priv->texture != NULL)
+    cogl_object_unref (priv->texture);
+
+  priv->texture = texture;
+  _clutter_memory_track_texture (CLUTTER_MEMORY_CONTENT_TEXTURES, texture);
+  clutter_image_set_cache_entry (image, NULL);
+
+  if (priv->texture == NULL)
+    {
+      clutter_image_clear_source (image);
+      g_set_error_literal (error, CLUTTER_IMAGE_ERROR,
+                           CLUTTER_IMAGE_ERROR_INVALID_DATA,
+                           _("Unable to load image data"));
+      return FALSE;
+    }
+
+  clutter_image_ensure_mipmaps (image);
+
+  clutter_content_invalidate (CLUTTER_CONTENT (image));
+
+  return TRUE;
+}
+
+/* the level of detail that matches the size of the content box on
+ * the screen; we measure two edges of the transformed box, so that
+ * rotations do not affect the result
+ */
+static guint
+clutter_image_get_paint_level (ClutterImage          *image,
+                               ClutterActor          *actor,
+                               const ClutterActorBox *box)
+{
+  ClutterImagePrivate *priv = image->priv;
+  ClutterVertex v[3], p[3];
+  float screen_width, screen_height, scale;
+  guint level;
+
+  v[0].x = box->x1; v[0].y = box->y1; v[0].z = 0.f;
+  v[1].x = box->x2; v[1].y = box->y1; v[1].z = 0.f;
+  v[2].x = box->x1; v[2].y = box->y2; v[2].z = 0.f;
+
+  clutter_actor_apply_transform_to_point (actor, &v[0], &p[0]);
+  clutter_actor_apply_transform_to_point (actor, &v[1], &p[1]);
+  clutter_actor_apply_transform_to_point (actor, &v[2], &p[2]);
+
+  screen_width = sqrtf ((p[1].x - p[0].x) * (p[1].x - p[0].x) +
+                        (p[1].y - p[0].y) * (p[1].y - p[0].y));
+  screen_height = sqrtf ((p[2].x - p[0].x) * (p[2].x - p[0].x) +
+                         (p[2].y - p[0].y) * (p[2].y - p[0].y));
+
+  scale = MAX (screen_width / priv->source_width,
+               screen_height / priv->source_height);
+
+  if (scale >= 0.5f || scale <= 0.f)
+    return 0;
+
+  /* the largest level that is still at least as big as the screen */
+  level = (guint) floorf (log2f (1.f / scale));
+  level = MIN (level, IMAGE_MAX_LEVEL);
+  level = MIN (level, g_bit_storage (MAX (priv->source_width,
+                                          priv->source_height)) - 1);
+
+  return level;
+}
+
+static void
+clutter_image_paint_content (ClutterContent   *content,
+                             ClutterActor     *actor,
+                             ClutterPaintNode *root)
+{
+  ClutterImage *image = CLUTTER_IMAGE (content);
+  ClutterImagePrivate *priv = image->priv;
+  ClutterScalingFilter min_f, mag_f;
+  ClutterContentRepeat repeat;
+  ClutterPaintNode *node;
+  ClutterActorBox box;
+  ClutterColor color;
+  guint8 paint_opacity;
+  guint width, height;
+
+  if (priv->texture == NULL)
+    return;
+
+  clutter_actor_get_content_box (actor, &box);
+  paint_opacity = clutter_actor_get_paint_opacity (actor);
+  clutter_actor_get_content_scaling_filters (actor, &min_f, &mag_f);
+  repeat = clutter_actor_get_content_repeat (actor);
+
+  priv->uses_mipmaps = min_f == CLUTTER_SCALING_FILTER_TRILINEAR;
+
+  if (priv->source != NULL)
+    {
+      guint level = clutter_image_get_paint_level (image, actor, &box);
+
+      if (level != priv->level)
+        {
+          CoglTexture *texture = clutter_image_create_level (image, level);
+
+          CLUTTER_NOTE (PAINT, "Switching <ClutterImage>[%p] from level %u to %u",
+                        image, priv->level, level);
+
+          if (texture != NULL)
+            {
+              cogl_object_unref (priv->texture);
+              priv->texture = texture;
+              priv->level = level;
+
+              _clutter_memory_track_texture (CLUTTER_MEMORY_CONTENT_TEXTURES,
+                                             texture);
+
+              clutter_image_ensure_mipmaps (image);
+            }
+        }
+    }
+
+  clutter_image_get_size (image, &width, &height);
+
+  color.red = paint_opacity;
+  color.green = paint_opacity;
+  color.blue = paint_opacity;
+  color.alpha = paint_opacity;
+
+  node = clutter_texture_node_new (priv->texture, &color, min_f, mag_f);
+  clutter_paint_node_set_name (node, "Image");
+
+  if (repeat == CLUTTER_REPEAT_NONE)
+    clutter_paint_node_add_rectangle (node, &box);
+  else
+    {
+      float t_w = 1.f, t_h = 1.f;
+
+      if ((repeat & CLUTTER_REPEAT_X_AXIS) != FALSE)
+        t_w = (box.x2 - box.x1) / width;
+
+      if ((repeat & CLUTTER_REPEAT_Y_AXIS) != FALSE)
+        t_h = (box.y2 - box.y1) / height;
+
+      clutter_paint_node_add_texture_rectangle (node, &box,
+                                                0.f, 0.f,
+                                                t_w, t_h);
+    }
+
+  clutter_paint_node_add_child (root, node);
+  clutter_paint_node_unref (node);
+}
+
+static gboolean
+clutter_image_get_preferred_size (ClutterContent *content,
+                                  gfloat         *width,
+                                  gfloat         *height)
+{
+  ClutterImage *image = CLUTTER_IMAGE (content);
+  guint image_width, image_height;
+
+  if (image->priv->texture == NULL)
+    return FALSE;
+
+  clutter_image_get_size (image, &image_width, &image_height);
+
+  if (width != NULL)
+    *width = image_width;
+
+  if (height != NULL)
+    *height = image_height;
+
+  return TRUE;
+}
+
+static gboolean
+clutter_image_is_opaque (ClutterContent *content)
+{
+  ClutterImagePrivate *priv = CLUTTER_IMAGE (content)->priv;
 
-  priv->texture = cogl_texture_new_from_data (width, height,
-                                              COGL_TEXTURE_NONE,
-                                              pixel_format,
-                                              COGL_PIXEL_FORMAT_ANY,
-                                              row_stride,
-                                              g_bytes_get_data (data, NULL));
   if (priv->texture == NULL)
+    return FALSE;
+
+  return (cogl_texture_get_format (priv->texture) & COGL_A_BIT) == 0;
+}
+
+static void
+clutter_content_iface_init (ClutterContentIface *iface)
+{
+  iface->get_preferred_size = clutter_image_get_preferred_size;
+  iface->paint_content = clutter_image_paint_content;
+  iface->is_opaque = clutter_image_is_opaque;
+}
+
+/**
+ * clutter_image_new:
+ *
+ * Creates a new #ClutterImage instance.
+ *
+ * Return value: (transfer full): the newly created #ClutterImage instance.
+ *   Use g_object_unref() when done.
+ *
+ *
+ */
+ClutterContent *
+clutter_image_new (void)
+{
+  return g_object_new (CLUTTER_TYPE_IMAGE, NULL);
+}
+
+/**
+ * clutter_image_set_data:
+ * @image: a #ClutterImage
+ * @data: (array): the image data, as an array of bytes
+ * @pixel_format: the Cogl pixel format of the image data
+ * @width: the width of the image data
+ * @height: the height of the image data
+ * @row_stride: the length of each row inside @data
+ * @error: return location for a #GError, or %NULL
+ *
+ * Sets the image data to be displayed by @image.
+ *
+ * If the image data was successfully loaded, the @image will be invalidated.
+ *
+ * In case of error, the @error value will be set, and this function will
+ * return %FALSE.
+ *
+ * The image data is copied in texture memory.
+ *
+ * Return value: %TRUE if the image data was successfully loaded,
+ *   and %FALSE otherwise.
+ *
+ *
+ */
+gboolean
+clutter_image_set_data (ClutterImage     *image,
+                        const guint8     *data,
+                        CoglPixelFormat   pixel_format,
+                        guint             width,
+                        guint             height,
+                        guint             row_stride,
+                        GError          **error)
+{
+  g_return_val_if_fail (CLUTTER_IS_IMAGE (image), FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+
+  return clutter_image_upload_data (image, data, NULL,
+                                    pixel_format,
+                                    width, height,
+                                    row_stride,
+                                    error);
+}
+
+/**
+ * clutter_image_set_bytes:
+ * @image: a #ClutterImage
+ * @data: the image data, as a #GBytes
+ * @pixel_format: the Cogl pixel format of the image data
+ * @width: the width of the image data
+ * @height: the height of the image data
+ * @row_stride: the length of each row inside @data
+ * @error: return location for a #GError, or %NULL
+ *
+ * Sets the image data stored inside a #GBytes to be displayed by @image.
+ *
+ * If the image data was successfully loaded, the @image will be invalidated.
+ *
+ * In case of error, the @error value will be set, and this function will
+ * return %FALSE.
+ *
+ * The image data contained inside the #GBytes is copied in texture memory,
+ * and no additional reference is acquired on the @data.
+ *
+ * Return value: %TRUE if the image data was successfully loaded,
+ *   and %FALSE otherwise.
+ *
+ *
+ */
+gboolean
+clutter_image_set_bytes (ClutterImage     *image,
+                         GBytes           *data,
+                         CoglPixelFormat   pixel_format,
+                         guint             width,
+                         guint             height,
+                         guint             row_stride,
+                         GError          **error)
+{
+  g_return_val_if_fail (CLUTTER_IS_IMAGE (image), FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+
+  return clutter_image_upload_data (image, NULL, data,
+                                    pixel_format,
+                                    width, height,
+                                    row_stride,
+                                    error);
+}
+
+/**
+ * clutter_image_set_area:
+ * @image: a #ClutterImage
+ * @data: (array): the image data, as an array of bytes
+ * @pixel_format: the Cogl pixel format of the image data
+ * @rect: a rectangle indicating the area that should be set
+ * @row_stride: the length of each row inside @data
+ * @error: return location for a #GError, or %NULL
+ *
+ * Sets the image data to be display by @image, using @rect to indicate
+ * the position and size of the image data to be set.
+ *
+ * If the @image does not have any image data set when this function is
+ * called, a new texture will be created with the size of the width and
+ * height of the rectangle, i.e. calling this function on a newly created
+ * #ClutterImage will be the equivalent of calling clutter_image_set_data().
+ *
+ * If the image data was successfully loaded, the @image will be invalidated.
+ *
+ * In case of error, the @error value will be set, and this function will
+ * return %FALSE.
+ *
+ * The image data is copied in texture memory.
+ *
+ * Return value: %TRUE if the image data was successfully loaded,
+ *   and %FALSE otherwise.
+ *
+ *
+ */
+gboolean
+clutter_image_set_area (ClutterImage                 *image,
+                        const guint8                 *data,
+                        CoglPixelFormat               pixel_format,
+                        const cairo_rectangle_int_t  *area,
+                        guint                         row_stride,
+                        GError                      **error)
+{
+  ClutterImagePrivate *priv;
+
+  g_return_val_if_fail (CLUTTER_IS_IMAGE (image), FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+  g_return_val_if_fail (area != NULL, FALSE);
+
+  priv = image->priv;
+  priv->upload_serial += 1;
+
+  /* updating a region needs the full resolution texture */
+  if (priv->source != NULL)
+    {
+      if (priv->level != 0)
+        {
+          CoglTexture *texture = clutter_image_create_level (image, 0);
+
+          if (priv->texture != NULL)
+            cogl_object_unref (priv->texture);
+
+          priv->texture = texture;
+          _clutter_memory_track_texture (CLUTTER_MEMORY_CONTENT_TEXTURES,
+                                         texture);
+        }
+
+      clutter_image_clear_source (image);
+    }
+
+  /* the texture may be shared with other images loading the same file */
+  if (priv->texture != NULL)
+    clutter_image_unshare_texture (image);
+
+  if (priv->texture == NULL)
+    {
+      priv->texture = cogl_texture_new_from_data (area->width,
+                                                  area->height,
+                                                  COGL_TEXTURE_NONE,
+                                                  pixel_format,
+                                                  clutter_image_get_internal_format (image,
+                                                                                     pixel_format,
+                                                                                     area->width,
+                                                                                     area->height),
+                                                  row_stride,
+                                                  data);
+      _clutter_memory_track_texture (CLUTTER_MEMORY_CONTENT_TEXTURES,
+                                     priv->texture);
+    }
+  else
+    {
+      gboolean res;
+
+      res = cogl_texture_set_region (priv->texture,
+                                     0, 0,
+                                     area->x, area->y,
+                                     area->width, area->height,
+                                     area->width, area->height,
+                                     pixel_format,
+                                     row_stride,
+                                     data);
+
+      if (!res)
+        {
+          cogl_object_unref (priv->texture);
+          priv->texture = NULL;
+        }
+    }
+
+  if (priv->texture == NULL)
+    {
+      g_set_error_literal (error, CLUTTER_IMAGE_ERROR,
+                           CLUTTER_IMAGE_ERROR_INVALID_DATA,
+                           _("Unable to load image data"));
+      return FALSE;
+    }
+
+  clutter_content_invalidate (CLUTTER_CONTENT (image));
+
+  return TRUE;
+}
+
+static void
+image_upload_free (gpointer data)
+{
+  ImageUpload *upload = data;
+
+  if (upload->staging != NULL)
+    {
+      if (upload->staging_data != NULL)
+        cogl_buffer_unmap (COGL_BUFFER (upload->staging));
+
+      cogl_object_unref (upload->staging);
+    }
+  else
+    g_free (upload->staging_data);
+
+  if (upload->bitmap != NULL)
+    cogl_object_unref (upload->bitmap);
+
+  if (upload->result != NULL)
+    g_object_unref (upload->result);
+
+  if (upload->cancellable != NULL)
+    g_object_unref (upload->cancellable);
+
+  g_free (upload->filename);
+
+  g_slice_free (ImageUpload, upload);
+}
+
+static ImageUpload *
+image_upload_new (ClutterImage        *image,
+                  GAsyncReadyCallback  callback,
+                  gpointer             user_data,
+                  gpointer             source_tag)
+{
+  ImageUpload *upload;
+
+  upload = g_slice_new0 (ImageUpload);
+  upload->result = g_simple_async_result_new (G_OBJECT (image),
+                                              callback,
+                                              user_data,
+                                              source_tag);
+  upload->serial = ++image->priv->upload_serial;
+
+  return upload;
+}
+
+/* runs in a worker thread: this function must not call into GL */
+static void
+image_upload_thread (GSimpleAsyncResult *res,
+                     GObject            *gobject,
+                     GCancellable       *cancellable)
+{
+  ImageUpload *upload = g_simple_async_result_get_op_res_gpointer (res);
+  GError *error = NULL;
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, &error))
     {
-      g_set_error_literal (error, CLUTTER_IMAGE_ERROR,
+      g_simple_async_result_take_error (res, error);
+      return;
+    }
+
+  if (upload->filename != NULL)
+    {
+      upload->bitmap = cogl_bitmap_new_from_file (upload->filename, &error);
+      if (upload->bitmap == NULL)
+        g_simple_async_result_take_error (res, error);
+    }
+  else
+    memcpy (upload->staging_data, upload->data,
+            upload->row_stride * upload->height);
+}
+
+/* completes an upload of a file through the texture cache, once the
+ * file has been decoded, or has failed to
+ */
+static void
+image_upload_finish_cached (ImageUpload  *upload,
+                            const GError *load_error)
+{
+  ImageCacheEntry *entry = upload->cache_entry;
+  GObject *source;
+  ClutterImage *image;
+  GError *error = NULL;
+
+  source = g_async_result_get_source_object (G_ASYNC_RESULT (upload->result));
+  image = CLUTTER_IMAGE (source);
+
+  if (load_error != NULL)
+    error = g_error_copy (load_error);
+  else if (g_cancellable_set_error_if_cancelled (upload->cancellable, &error))
+    ;
+  else if (upload->serial != image->priv->upload_serial)
+    g_set_error_literal (&error, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                         _("The image data was replaced"));
+  else
+    clutter_image_set_cached_texture (image, entry);
+
+  if (error != NULL)
+    g_simple_async_result_take_error (upload->result, error);
+  else
+    g_simple_async_result_set_op_res_gboolean (upload->result, TRUE);
+
+  g_simple_async_result_complete (upload->result);
+
+  upload->cache_entry = NULL;
+  image_upload_free (upload);
+
+  image_cache_entry_release (entry);
+
+  g_object_unref (source);
+}
+
+/* runs in the main thread, once the worker thread is done */
+static void
+image_upload_done (GObject      *gobject,
+                   GAsyncResult *res,
+                   gpointer      user_data)
+{
+  ClutterImage *image = CLUTTER_IMAGE (gobject);
+  ClutterImagePrivate *priv = image->priv;
+  ImageUpload *upload = user_data;
+  CoglTexture *texture = NULL;
+  GError *error = NULL;
+
+  if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res),
+                                             &error))
+    goto out;
+
+  /* the image data was replaced while we were busy; the texture of
+   * a cached file can still be used by other images
+   */
+  if (upload->cache_entry == NULL && upload->serial != priv->upload_serial)
+    {
+      g_set_error_literal (&error, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                           _("The image data was replaced"));
+      goto out;
+    }
+
+  if (upload->bitmap == NULL)
+    {
+      if (upload->staging != NULL)
+        {
+          cogl_buffer_unmap (COGL_BUFFER (upload->staging));
+          upload->staging_data = NULL;
+
+          upload->bitmap =
+            cogl_bitmap_new_from_buffer (COGL_BUFFER (upload->staging),
+                                         upload->pixel_format,
+                                         upload->width,
+                                         upload->height,
+                                         upload->row_stride,
+                                         0);
+        }
+      else
+        {
+          upload->bitmap =
+            cogl_bitmap_new_for_data (clutter_backend_get_cogl_context (clutter_get_default_backend ()),
+                                      upload->width,
+                                      upload->height,
+                                      upload->pixel_format,
+                                      upload->row_stride,
+                                      upload->staging_data);
+        }
+    }
+
+  if (upload->bitmap != NULL)
+    texture = cogl_texture_new_from_bitmap (upload->bitmap,
+                                            COGL_TEXTURE_NONE,
+                                            clutter_image_get_internal_format (image,
+                                                                               cogl_bitmap_get_format (upload->bitmap),
+                                                                               cogl_bitmap_get_width (upload->bitmap),
+                                                                               cogl_bitmap_get_height (upload->bitmap)));
+
+  if (texture == NULL)
+    {
+      g_set_error_literal (&error, CLUTTER_IMAGE_ERROR,
                            CLUTTER_IMAGE_ERROR_INVALID_DATA,
                            _("Unable to load image data"));
-      return FALSE;
+      goto out;
+    }
+
+  _clutter_memory_track_texture (CLUTTER_MEMORY_CONTENT_TEXTURES, texture);
+
+  if (upload->cache_entry != NULL)
+    {
+      image_cache_entry_set_texture (upload->cache_entry, texture);
+      cogl_object_unref (texture);
+      goto out;
     }
 
+  if (priv->texture != NULL)
+    cogl_object_unref (priv->texture);
+
+  priv->texture = texture;
+  clutter_image_set_cache_entry (image, NULL);
+
+  clutter_image_clear_source (image);
+  clutter_image_ensure_mipmaps (image);
+
   clutter_content_invalidate (CLUTTER_CONTENT (image));
 
-  return TRUE;
+out:
+  if (upload->cache_entry != NULL)
+    {
+      ImageCacheEntry *entry = upload->cache_entry;
+      GSList *waiting, *l;
+
+      /* complete the loads of the same file in the order they were
+       * started
+       */
+      waiting = g_slist_reverse (entry->waiting);
+      waiting = g_slist_prepend (waiting, upload);
+      entry->waiting = NULL;
+
+      for (l = waiting; l != NULL; l = l->next)
+        image_upload_finish_cached (l->data, error);
+
+      g_slist_free (waiting);
+      g_clear_error (&error);
+
+      return;
+    }
+
+  if (error != NULL)
+    g_simple_async_result_take_error (upload->result, error);
+  else
+    g_simple_async_result_set_op_res_gboolean (upload->result, TRUE);
+
+  g_simple_async_result_complete (upload->result);
+
+  image_upload_free (upload);
+}
+
+static void
+image_upload_run (ClutterImage *image,
+                  ImageUpload  *upload,
+                  GCancellable *cancellable)
+{
+  GSimpleAsyncResult *res;
+
+  res = g_simple_async_result_new (G_OBJECT (image),
+                                   image_upload_done,
+                                   upload,
+                                   image_upload_run);
+  g_simple_async_result_set_op_res_gpointer (res, upload, NULL);
+  g_simple_async_result_run_in_thread (res,
+                                       image_upload_thread,
+                                       G_PRIORITY_DEFAULT,
+                                       cancellable);
+  g_object_unref (res);
 }
 
 /**
- * clutter_image_set_area:
+ * clutter_image_set_data_async:
  * @image: a #ClutterImage
  * @data: (array): the image data, as an array of bytes
  * @pixel_format: the Cogl pixel format of the image data
- * @rect: a rectangle indicating the area that should be set
+ * @width: the width of the image data
+ * @height: the height of the image data
  * @row_stride: the length of each row inside @data
- * @error: return location for a #GError, or %NULL
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: (scope async): the function to call when the image data
+ *   has been loaded
+ * @user_data: data to pass to @callback
  *
- * Sets the image data to be display by @image, using @rect to indicate
- * the position and size of the image data to be set.
+ * Asynchronously sets the image data displayed by @image.
  *
- * If the @image does not have any image data set when this function is
- * called, a new texture will be created with the size of the width and
- * height of the rectangle, i.e. calling this function on a newly created
- * #ClutterImage will be the equivalent of calling clutter_image_set_data().
+ * The image data is copied into a staging buffer from a worker thread;
+ * if the GPU supports mapped pixel buffers the copy goes straight into
+ * memory that the driver can upload without touching the CPU again.
+ * Only the creation of the texture from the staging buffer happens in
+ * the main thread.
  *
- * If the image data was successfully loaded, the @image will be invalidated.
+ * The @data must remain valid until @callback is called.
  *
- * In case of error, the @error value will be set, and this function will
- * return %FALSE.
+ * The current contents of @image are kept until the new image data is
+ * ready; at that point the texture is swapped and @image is invalidated.
+ * If the image data is replaced before the upload is done, the upload
+ * will fail with %G_IO_ERROR_CANCELLED.
  *
- * The image data is copied in texture memory.
+ * Call clutter_image_load_finish() from @callback to retrieve the
+ * result of the operation.
+ */
+void
+clutter_image_set_data_async (ClutterImage        *image,
+                              const guint8        *data,
+                              CoglPixelFormat      pixel_format,
+                              guint                width,
+                              guint                height,
+                              guint                row_stride,
+                              GCancellable        *cancellable,
+                              GAsyncReadyCallback  callback,
+                              gpointer             user_data)
+{
+  ImageUpload *upload;
+  CoglContext *ctx;
+
+  g_return_if_fail (CLUTTER_IS_IMAGE (image));
+  g_return_if_fail (data != NULL);
+  g_return_if_fail (width > 0 && height > 0);
+
+  upload = image_upload_new (image, callback, user_data,
+                             clutter_image_set_data_async);
+  upload->data = data;
+  upload->pixel_format = pixel_format;
+  upload->width = width;
+  upload->height = height;
+  upload->row_stride = row_stride;
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  upload->staging = cogl_pixel_buffer_new (ctx,
+                                           row_stride * height,
+                                           NULL);
+  if (upload->staging != NULL)
+    {
+      upload->staging_data = cogl_buffer_map (COGL_BUFFER (upload->staging),
+                                              COGL_BUFFER_ACCESS_WRITE,
+                                              COGL_BUFFER_MAP_HINT_DISCARD);
+      if (upload->staging_data == NULL)
+        {
+          cogl_object_unref (upload->staging);
+          upload->staging = NULL;
+        }
+    }
+
+  if (upload->staging_data == NULL)
+    upload->staging_data = g_malloc (row_stride * height);
+
+  image_upload_run (image, upload, cancellable);
+}
+
+/**
+ * clutter_image_load_from_file_async:
+ * @image: a #ClutterImage
+ * @file: a #GFile
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: (scope async): the function to call when the image data
+ *   has been loaded
+ * @user_data: data to pass to @callback
  *
- * Return value: %TRUE if the image data was successfully loaded,
- *   and %FALSE otherwise.
+ * Asynchronously loads the image data displayed by @image from @file.
+ *
+ * The image file is decoded in a worker thread, using the image
+ * loaders available to Cogl; only the upload of the decoded data
+ * into a texture happens in the main thread.
+ *
+ * The current contents of @image are kept until the new image data is
+ * ready; at that point the texture is swapped and @image is invalidated.
+ *
+ * The textures of the files loaded by this function are shared between
+ * all the #ClutterImage instances loading the same file, with the same
+ * #ClutterImage:use-atlas setting, and the file is decoded only once;
+ * if the texture of a previous load of the file is still cached, @image
+ * is updated immediately. See clutter_image_set_texture_cache_size().
+ * The cache does not check whether a file changed after being loaded.
  *
+ * Only local files are supported.
  *
+ * Call clutter_image_load_finish() from @callback to retrieve the
+ * result of the operation.
  */
-gboolean
-clutter_image_set_area (ClutterImage                 *image,
-                        const guint8                 *data,
-                        CoglPixelFormat               pixel_format,
-                        const cairo_rectangle_int_t  *area,
-                        guint                         row_stride,
-                        GError                      **error)
+void
+clutter_image_load_from_file_async (ClutterImage        *image,
+                                    GFile               *file,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data)
 {
-  ClutterImagePrivate *priv;
+  ImageCacheEntry *entry;
+  ImageUpload *upload;
+  gchar *key;
 
-  g_return_val_if_fail (CLUTTER_IS_IMAGE (image), FALSE);
-  g_return_val_if_fail (data != NULL, FALSE);
-  g_return_val_if_fail (area != NULL, FALSE);
+  g_return_if_fail (CLUTTER_IS_IMAGE (image));
+  g_return_if_fail (G_IS_FILE (file));
 
-  priv = image->priv;
+  upload = image_upload_new (image, callback, user_data,
+                             clutter_image_load_from_file_async);
+  upload->filename = g_file_get_path (file);
 
-  if (priv->texture == NULL)
+  if (upload->filename == NULL)
     {
-      priv->texture = cogl_texture_new_from_data (area->width,
-                                                  area->height,
-                                                  COGL_TEXTURE_NONE,
-                                                  pixel_format,
-                                                  COGL_PIXEL_FORMAT_ANY,
-                                                  row_stride,
-                                                  data);
+      gchar *uri = g_file_get_uri (file);
+
+      g_simple_async_result_set_error (upload->result,
+                                       G_IO_ERROR,
+                                       G_IO_ERROR_NOT_SUPPORTED,
+                                       _("Unable to load '%s': only local "
+                                         "files are supported"),
+                                       uri);
+      g_simple_async_result_complete_in_idle (upload->result);
+      image_upload_free (upload);
+      g_free (uri);
+      return;
     }
-  else
+
+  key = g_strconcat (image->priv->use_atlas ? "atlas:" : "file:",
+                     upload->filename,
+                     NULL);
+  entry = image_cache_lookup (key);
+
+  if (entry != NULL && entry->texture != NULL)
     {
-      gboolean res;
+      CLUTTER_NOTE (MISC, "Using the cached texture for '%s'",
+                    upload->filename);
 
-      res = cogl_texture_set_region (priv->texture,
-                                     0, 0,
-                                     area->x, area->y,
-                                     area->width, area->height,
-                                     area->width, area->height,
-                                     pixel_format,
-                                     row_stride,
-                                     data);
+      clutter_image_set_cached_texture (image, entry);
 
-      if (!res)
-        {
-          cogl_object_unref (priv->texture);
-          priv->texture = NULL;
-        }
+      g_simple_async_result_set_op_res_gboolean (upload->result, TRUE);
+      g_simple_async_result_complete_in_idle (upload->result);
+      image_upload_free (upload);
+      g_free (key);
+      return;
     }
 
-  if (priv->texture == NULL)
+  /* the file is decoded only once for all the loads, so they are
+   * cancelled individually, once the decoding is done
+   */
+  if (cancellable != NULL)
+    upload->cancellable = g_object_ref (cancellable);
+
+  if (entry != NULL)
     {
-      g_set_error_literal (error, CLUTTER_IMAGE_ERROR,
-                           CLUTTER_IMAGE_ERROR_INVALID_DATA,
-                           _("Unable to load image data"));
-      return FALSE;
+      image_cache_entry_use (entry);
+      upload->cache_entry = entry;
+      entry->waiting = g_slist_prepend (entry->waiting, upload);
+      g_free (key);
+      return;
     }
 
+  entry = image_cache_insert (key);
+  image_cache_entry_use (entry);
+  upload->cache_entry = entry;
+  g_free (key);
+
+  image_upload_run (image, upload, NULL);
+}
+
+/**
+ * clutter_image_load_finish:
+ * @image: a #ClutterImage
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Finishes an asynchronous load started with clutter_image_set_data_async()
+ * or clutter_image_load_from_file_async().
+ *
+ * Return value: %TRUE if the image data was successfully loaded,
+ *   and %FALSE otherwise.
+ */
+gboolean
+clutter_image_load_finish (ClutterImage  *image,
+                           GAsyncResult  *result,
+                           GError       **error)
+{
+  GSimpleAsyncResult *res;
+
+  g_return_val_if_fail (CLUTTER_IS_IMAGE (image), FALSE);
+  g_return_val_if_fail (g_simple_async_result_is_valid (result,
+                                                        G_OBJECT (image),
+                                                        NULL),
+                        FALSE);
+
+  res = G_SIMPLE_ASYNC_RESULT (result);
+
+  if (g_simple_async_result_propagate_error (res, error))
+    return FALSE;
+
+  return g_simple_async_result_get_op_res_gboolean (res);
+}
+
+/*< private >
+ * _clutter_image_set_texture:
+ * @image: a #ClutterImage
+ * @texture: a #CoglTexture
+ *
+ * Replaces the texture used by @image with @texture, and invalidates
+ * the @image. The @image will take a reference on @texture.
+ */
+void
+_clutter_image_set_texture (ClutterImage *image,
+                            CoglTexture  *texture)
+{
+  ClutterImagePrivate *priv = image->priv;
+
+  priv->upload_serial += 1;
+
+  cogl_object_ref (texture);
+
+  if (priv->texture != NULL)
+    cogl_object_unref (priv->texture);
+
+  priv->texture = texture;
+  clutter_image_set_cache_entry (image, NULL);
+
+  clutter_image_clear_source (image);
+
   clutter_content_invalidate (CLUTTER_CONTENT (image));
+}
 
-  return TRUE;
+/**
+ * clutter_image_set_use_atlas:
+ * @image: a #ClutterImage
+ * @use_atlas: whether small images should share a texture
+ *
+ * Sets whether the image data of @image should be placed inside a
+ * texture shared with other images, if it is small enough.
+ *
+ * Images inside the same shared texture can be painted in a single
+ * batch, which reduces the number of state changes when painting many
+ * small images, like an icon grid; the images are still painted using
+ * the same texture coordinates, as Cogl will transform them to the
+ * area of the shared texture used by @image.
+ *
+ * Images using mipmaps, e.g. through %CLUTTER_SCALING_FILTER_TRILINEAR,
+ * or repeated along an axis are moved to their own texture when painted.
+ *
+ * This only affects the image data set after calling this function.
+ */
+void
+clutter_image_set_use_atlas (ClutterImage *image,
+                             gboolean      use_atlas)
+{
+  ClutterImagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_IMAGE (image));
+
+  priv = image->priv;
+
+  use_atlas = !!use_atlas;
+  if (priv->use_atlas == use_atlas)
+    return;
+
+  priv->use_atlas = use_atlas;
+
+  g_object_notify_by_pspec (G_OBJECT (image), obj_props[PROP_USE_ATLAS]);
+}
+
+/**
+ * clutter_image_get_use_atlas:
+ * @image: a #ClutterImage
+ *
+ * Retrieves the value set using clutter_image_set_use_atlas().
+ *
+ * Return value: %TRUE if small images should share a texture
+ */
+gboolean
+clutter_image_get_use_atlas (ClutterImage *image)
+{
+  g_return_val_if_fail (CLUTTER_IS_IMAGE (image), FALSE);
+
+  return image->priv->use_atlas;
+}
+
+/**
+ * clutter_image_set_downscale:
+ * @image: a #ClutterImage
+ * @downscale: whether the image data should be downscaled
+ *
+ * Sets whether @image should only keep a copy of the image data matching
+ * the size at which it is painted in texture memory.
+ *
+ * If @downscale is %TRUE, the image data passed to clutter_image_set_data()
+ * and clutter_image_set_bytes() is kept in system memory, and each time the
+ * image is painted at less than half of its size a copy of the data, scaled
+ * down by a power of two, is uploaded instead of the full resolution data.
+ * This reduces the texture memory used by large images painted as small
+ * thumbnails, and avoids the aliasing caused by sampling them.
+ *
+ * The preferred size of @image is not affected by the level of detail.
+ *
+ * Only image data with four 8-bit channels can be downscaled; calling
+ * clutter_image_set_area() restores the full resolution image data.
+ *
+ * This only affects the image data set after calling this function.
+ */
+void
+clutter_image_set_downscale (ClutterImage *image,
+                             gboolean      downscale)
+{
+  ClutterImagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_IMAGE (image));
+
+  priv = image->priv;
+
+  downscale = !!downscale;
+  if (priv->downscale == downscale)
+    return;
+
+  priv->downscale = downscale;
+
+  /* the level of detail depends on the transformation of the actor */
+  _clutter_content_set_view_dependent (CLUTTER_CONTENT (image), downscale);
+
+  g_object_notify_by_pspec (G_OBJECT (image), obj_props[PROP_DOWNSCALE]);
+}
+
+/**
+ * clutter_image_get_downscale:
+ * @image: a #ClutterImage
+ *
+ * Retrieves the value set using clutter_image_set_downscale().
+ *
+ * Return value: %TRUE if the image data should be downscaled
+ */
+gboolean
+clutter_image_get_downscale (ClutterImage *image)
+{
+  g_return_val_if_fail (CLUTTER_IS_IMAGE (image), FALSE);
+
+  return image->priv->downscale;
+}
+
+/**
+ * clutter_image_set_texture_cache_size:
+ * @max_size: the size of the cache, in bytes
+ *
+ * Sets the size of the textures kept in the cache shared by the files
+ * loaded using clutter_image_load_from_file_async().
+ *
+ * The textures used by a #ClutterImage are never evicted; once no
+ * image uses them, textures are kept until the cache is full, and
+ * then evicted starting from the least recently used one. The default
+ * size is 32 megabytes.
+ *
+ * Setting @max_size to 0 frees the textures as soon as they are not
+ * used anymore; loads of the same file are still shared.
+ */
+void
+clutter_image_set_texture_cache_size (gsize max_size)
+{
+  image_cache_max_size = max_size;
+
+  image_cache_trim (image_cache_max_size);
+}
+
+/**
+ * clutter_image_get_texture_cache_size:
+ *
+ * Retrieves the value set using clutter_image_set_texture_cache_size().
+ *
+ * Return value: the size of the cache, in bytes
+ */
+gsize
+clutter_image_get_texture_cache_size (void)
+{
+  return image_cache_max_size;
 }
 
 /**
@@ -29,6 +29,7 @@
 #ifndef __CLUTTER_IMAGE_H__
 #define __CLUTTER_IMAGE_H__
 
+#include <gio/gio.h>
 #include <cogl/cogl.h>
 #include <clutter/clutter-types.h>
 
@@ -131,6 +132,34 @@ gboolean                clutter_image_set_bytes         (ClutterImage
                                                          guint                         row_stride,
                                                          GError                      **error);
 
+void                    clutter_image_set_data_async    (ClutterImage                 *image,
+                                                         const guint8                 *data,
+                                                         CoglPixelFormat               pixel_format,
+                                                         guint                         width,
+                                                         guint                         height,
+                                                         guint                         row_stride,
+                                                         GCancellable                 *cancellable,
+                                                         GAsyncReadyCallback           callback,
+                                                         gpointer                      user_data);
+void                    clutter_image_load_from_file_async (ClutterImage              *image,
+                                                         GFile                        *file,
+                                                         GCancellable                 *cancellable,
+                                                         GAsyncReadyCallback           callback,
+                                                         gpointer                      user_data);
+gboolean                clutter_image_load_finish       (ClutterImage                 *image,
+                                                         GAsyncResult                 *result,
+                                                         GError                      **error);
+
+void                    clutter_image_set_use_atlas     (ClutterImage                 *image,
+                                                         gboolean                      use_atlas);
+gboolean                clutter_image_get_use_atlas     (ClutterImage                 *image);
+void                    clutter_image_set_downscale     (ClutterImage                 *image,
+                                                         gboolean                      downscale);
+gboolean                clutter_image_get_downscale     (ClutterImage                 *image);
+
+void                    clutter_image_set_texture_cache_size (gsize                   max_size);
+gsize                   clutter_image_get_texture_cache_size (void);
+
 #if defined(COGL_ENABLE_EXPERIMENTAL_API) && defined(CLUTTER_ENABLE_EXPERIMENTAL_API)
 
 CoglTexture *           clutter_image_get_texture       (ClutterImage                 *image);
@@ -35,6 +35,8 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "clutter-input-device.h"
 
 #include "clutter-actor-private.h"
@@ -103,12 +105,17 @@ clutter_input_device_dispose (GObject *gobject)
       device->keys = NULL;
     }
 
+  g_free (device->touch_slots);
+  device->touch_slots = NULL;
+
   if (device->touch_sequences_info)
     {
       g_hash_table_unref (device->touch_sequences_info);
       device->touch_sequences_info = NULL;
     }
 
+  device->n_touch_sequences = 0;
+
   if (device->inv_touch_sequence_actors)
     {
       GHashTableIter iter;
@@ -388,31 +395,69 @@ clutter_input_device_init (ClutterInputDevice *self)
   self->current_button_number = self->previous_button_number = -1;
   self->current_state = self->previous_state = 0;
 
-  self->touch_sequences_info =
-    g_hash_table_new_full (NULL, NULL,
-                           NULL, _clutter_input_device_free_touch_info);
   self->inv_touch_sequence_actors = g_hash_table_new (NULL, NULL);
 }
 
+static ClutterTouchInfo *
+_clutter_input_device_lookup_touch_info (ClutterInputDevice   *device,
+                                         ClutterEventSequence *sequence)
+{
+  guint slot = GPOINTER_TO_UINT (sequence) - 1;
+
+  if (slot < CLUTTER_INPUT_DEVICE_N_TOUCH_SLOTS)
+    {
+      if (device->touch_slots == NULL ||
+          device->touch_slots[slot].sequence == NULL)
+        return NULL;
+
+      return &device->touch_slots[slot];
+    }
+
+  if (device->touch_sequences_info == NULL)
+    return NULL;
+
+  return g_hash_table_lookup (device->touch_sequences_info, sequence);
+}
+
 static ClutterTouchInfo *
 _clutter_input_device_ensure_touch_info (ClutterInputDevice *device,
                                          ClutterEventSequence *sequence,
                                          ClutterStage *stage)
 {
   ClutterTouchInfo *info;
+  guint slot;
 
-  info = g_hash_table_lookup (device->touch_sequences_info, sequence);
+  info = _clutter_input_device_lookup_touch_info (device, sequence);
+  if (info != NULL)
+    return info;
 
-  if (info == NULL)
+  slot = GPOINTER_TO_UINT (sequence) - 1;
+
+  if (slot < CLUTTER_INPUT_DEVICE_N_TOUCH_SLOTS)
     {
+      if (device->touch_slots == NULL)
+        device->touch_slots = g_new0 (ClutterTouchInfo,
+                                      CLUTTER_INPUT_DEVICE_N_TOUCH_SLOTS);
+
+      info = &device->touch_slots[slot];
+    }
+  else
+    {
+      if (device->touch_sequences_info == NULL)
+        device->touch_sequences_info =
+          g_hash_table_new_full (NULL, NULL,
+                                 NULL, _clutter_input_device_free_touch_info);
+
       info = g_slice_new0 (ClutterTouchInfo);
-      info->sequence = sequence;
       g_hash_table_insert (device->touch_sequences_info, sequence, info);
-
-      if (g_hash_table_size (device->touch_sequences_info) == 1)
-        _clutter_input_device_set_stage (device, stage);
     }
 
+  info->sequence = sequence;
+
+  device->n_touch_sequences += 1;
+  if (device->n_touch_sequences == 1)
+    _clutter_input_device_set_stage (device, stage);
+
   return info;
 }
 
@@ -536,7 +581,7 @@ _clutter_input_device_get_actor (ClutterInputDevice   *device,
   if (sequence == NULL)
     return device->cursor_actor;
 
-  info = g_hash_table_lookup (device->touch_sequences_info, sequence);
+  info = _clutter_input_device_lookup_touch_info (device, sequence);
 
   return info->actor;
 }
@@ -587,7 +632,7 @@ _clutter_input_device_unassociate_actor (ClutterInputDevice   *device,
       for (l = sequences; l != NULL; l = l->next)
         {
           ClutterTouchInfo *info =
-            g_hash_table_lookup (device->touch_sequences_info, l->data);
+            _clutter_input_device_lookup_touch_info (device, l->data);
 
           if (info)
             info->actor = NULL;
@@ -824,7 +869,7 @@ clutter_input_device_get_coords (ClutterInputDevice   *device,
   else
     {
       ClutterTouchInfo *info =
-        g_hash_table_lookup (device->touch_sequences_info, sequence);
+        _clutter_input_device_lookup_touch_info (device, sequence);
 
       if (info == NULL)
         return FALSE;
@@ -836,6 +881,70 @@ clutter_input_device_get_coords (ClutterInputDevice   *device,
   return TRUE;
 }
 
+static ClutterPickRegion *
+clutter_input_device_get_pick_region (ClutterInputDevice   *device,
+                                      ClutterEventSequence *sequence)
+{
+  ClutterTouchInfo *info;
+
+  if (sequence == NULL)
+    return &device->pick_region;
+
+  info = _clutter_input_device_lookup_touch_info (device, sequence);
+  if (info == NULL)
+    return NULL;
+
+  return &info->pick_region;
+}
+
+/* checks whether a pick at @point would still return the actor of
+ * the last pick, without performing it
+ */
+static gboolean
+clutter_input_device_pick_region_contains (ClutterInputDevice   *device,
+                                           ClutterEventSequence *sequence,
+                                           ClutterActor         *actor,
+                                           const ClutterPoint   *point)
+{
+  ClutterPickRegion *region;
+  gfloat x = point->x + 0.5f;
+  gfloat y = point->y + 0.5f;
+
+  region = clutter_input_device_get_pick_region (device, sequence);
+  if (region == NULL || region->actor == NULL || region->actor != actor)
+    return FALSE;
+
+  if (region->generation != _clutter_stage_get_pick_generation (device->stage))
+    return FALSE;
+
+  return region->box.x1 <= x && x < region->box.x2 &&
+         region->box.y1 <= y && y < region->box.y2;
+}
+
+static void
+clutter_input_device_set_pick_region (ClutterInputDevice   *device,
+                                      ClutterEventSequence *sequence,
+                                      ClutterActor         *actor,
+                                      const ClutterPoint   *point)
+{
+  ClutterPickRegion *region;
+
+  region = clutter_input_device_get_pick_region (device, sequence);
+  if (region == NULL)
+    return;
+
+  region->actor = NULL;
+
+  if (_clutter_actor_get_pick_region (actor,
+                                      point->x + 0.5f,
+                                      point->y + 0.5f,
+                                      &region->box))
+    {
+      region->actor = actor;
+      region->generation = _clutter_stage_get_pick_generation (device->stage);
+    }
+}
+
 /*
  * _clutter_input_device_update:
  * @device: a #ClutterInputDevice
@@ -875,6 +984,26 @@ _clutter_input_device_update (ClutterInputDevice   *device,
   clutter_input_device_get_coords (device, sequence, &point);
 
   old_cursor_actor = _clutter_input_device_get_actor (device, sequence);
+
+  /* moving inside the region of the last pick cannot change the
+   * actor underneath the pointer, so there is nothing to do
+   */
+  if (old_cursor_actor != NULL &&
+      clutter_input_device_pick_region_contains (device, sequence,
+                                                 old_cursor_actor,
+                                                 &point))
+    {
+      CLUTTER_NOTE (EVENT,
+                    "Actor under cursor (device %d, at %.2f, %.2f): "
+                    "%s (cached)",
+                    clutter_input_device_get_device_id (device),
+                    point.x,
+                    point.y,
+                    _clutter_actor_get_debug_name (old_cursor_actor));
+
+      return old_cursor_actor;
+    }
+
   new_cursor_actor =
     _clutter_stage_do_pick (stage, point.x, point.y, CLUTTER_PICK_REACTIVE);
 
@@ -895,12 +1024,96 @@ _clutter_input_device_update (ClutterInputDevice   *device,
 
   /* short-circuit here */
   if (new_cursor_actor == old_cursor_actor)
-    return old_cursor_actor;
+    {
+      clutter_input_device_set_pick_region (device, sequence,
+                                            new_cursor_actor,
+                                            &point);
+      return old_cursor_actor;
+    }
 
   _clutter_input_device_set_actor (device, sequence,
                                    new_cursor_actor,
                                    emit_crossing);
 
+  /* emitting the crossing events could have changed the scene */
+  if (_clutter_input_device_get_actor (device, sequence) == new_cursor_actor)
+    clutter_input_device_set_pick_region (device, sequence,
+                                          new_cursor_actor,
+                                          &point);
+
+  return new_cursor_actor;
+}
+
+/*< private >
+ * _clutter_input_device_update_async:
+ * @device: a #ClutterInputDevice
+ *
+ * Like _clutter_input_device_update(), but without waiting for the
+ * result of the pick. If the pick is still pending when this function
+ * returns, the device will be updated when the pick is resolved.
+ *
+ * Return value: (transfer none): the actor underneath the pointer, or
+ *   the last known actor if the pick is pending
+ */
+ClutterActor *
+_clutter_input_device_update_async (ClutterInputDevice *device)
+{
+  ClutterStage *stage;
+  ClutterActor *new_cursor_actor;
+  ClutterActor *old_cursor_actor;
+  ClutterPoint point;
+
+  if (device->device_type == CLUTTER_KEYBOARD_DEVICE)
+    return NULL;
+
+  stage = device->stage;
+  if (G_UNLIKELY (stage == NULL))
+    return NULL;
+
+  old_cursor_actor = _clutter_input_device_get_actor (device, NULL);
+
+  point.x = device->current_x;
+  point.y = device->current_y;
+
+  if (old_cursor_actor != NULL &&
+      clutter_input_device_pick_region_contains (device, NULL,
+                                                 old_cursor_actor,
+                                                 &point))
+    return old_cursor_actor;
+
+  new_cursor_actor = _clutter_stage_do_pick_async (stage, device,
+                                                   device->current_x,
+                                                   device->current_y,
+                                                   CLUTTER_PICK_REACTIVE);
+
+  if (new_cursor_actor == NULL)
+    {
+      CLUTTER_NOTE (EVENT,
+                    "Pick pending for device %d at %d, %d",
+                    clutter_input_device_get_device_id (device),
+                    device->current_x,
+                    device->current_y);
+
+      return old_cursor_actor != NULL
+           ? old_cursor_actor
+           : CLUTTER_ACTOR (stage);
+    }
+
+  if (new_cursor_actor == old_cursor_actor)
+    {
+      clutter_input_device_set_pick_region (device, NULL,
+                                            new_cursor_actor,
+                                            &point);
+      return old_cursor_actor;
+    }
+
+  _clutter_input_device_set_actor (device, NULL, new_cursor_actor, TRUE);
+
+  if (_clutter_input_device_get_actor (device, NULL) == new_cursor_actor)
+    clutter_input_device_set_pick_region (device, NULL,
+                                          new_cursor_actor,
+                                          &point);
+
   return new_cursor_actor;
 }
 
@@ -1505,9 +1718,12 @@ _clutter_input_device_remove_event_sequence (ClutterInputDevice *device,
                                              ClutterEvent       *event)
 {
   ClutterEventSequence *sequence = clutter_event_get_event_sequence (event);
-  ClutterTouchInfo *info =
-    g_hash_table_lookup (device->touch_sequences_info, sequence);
+  ClutterTouchInfo *info;
+
+  if (sequence == NULL)
+    return;
 
+  info = _clutter_input_device_lookup_touch_info (device, sequence);
   if (info == NULL)
     return;
 
@@ -1522,9 +1738,14 @@ _clutter_input_device_remove_event_sequence (ClutterInputDevice *device,
                             info->actor, sequences);
     }
 
-  g_hash_table_remove (device->touch_sequences_info, sequence);
+  if (info >= device->touch_slots &&
+      info < device->touch_slots + CLUTTER_INPUT_DEVICE_N_TOUCH_SLOTS)
+    memset (info, 0, sizeof (ClutterTouchInfo));
+  else
+    g_hash_table_remove (device->touch_sequences_info, sequence);
 
-  if (g_hash_table_size (device->touch_sequences_info) == 0)
+  device->n_touch_sequences -= 1;
+  if (device->n_touch_sequences == 0)
     _clutter_input_device_set_stage (device, NULL);
 }
 
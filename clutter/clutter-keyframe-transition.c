@@ -93,6 +93,9 @@ struct _ClutterKeyframeTransitionPrivate
 {
   GArray *frames;
 
+  /* the last segment we found; sequential playback will usually
+   * hit it, or one of its neighbours
+   */
   gint current_frame;
 };
 
@@ -121,7 +124,7 @@ sort_by_key (gconstpointer a,
   if (fabs (k_a->key - k_b->key) < 0.0001)
     return 0;
 
-  if (k_a->key > k_a->key)
+  if (k_a->key > k_b->key)
     return 1;
 
   return -1;
@@ -211,6 +214,66 @@ clutter_keyframe_transition_update_frames (ClutterKeyframeTransition *transition
     }
 }
 
+static inline gboolean
+key_frame_contains (const KeyFrame *frame,
+                    double          p)
+{
+  return p >= frame->start && p <= frame->end;
+}
+
+/* finds the index of the key frame whose segment contains @p,
+ * starting from the cached segment and falling back to a binary
+ * search on the end of each segment, which are sorted
+ */
+static gint
+clutter_keyframe_transition_find_frame (ClutterKeyframeTransition *transition,
+                                        ClutterTimelineDirection   direction,
+                                        double                     p)
+{
+  ClutterKeyframeTransitionPrivate *priv = transition->priv;
+  GArray *frames = priv->frames;
+  gint cur = priv->current_frame;
+  gint last = frames->len - 1;
+  gint lo, hi;
+
+  if (cur >= 0 && cur <= last)
+    {
+      const KeyFrame *frame = &g_array_index (frames, KeyFrame, cur);
+
+      if (key_frame_contains (frame, p))
+        return cur;
+
+      /* the neighbour in the direction of the timeline */
+      if (direction == CLUTTER_TIMELINE_FORWARD && cur < last)
+        {
+          frame = &g_array_index (frames, KeyFrame, cur + 1);
+          if (key_frame_contains (frame, p))
+            return cur + 1;
+        }
+      else if (direction == CLUTTER_TIMELINE_BACKWARD && cur > 0)
+        {
+          frame = &g_array_index (frames, KeyFrame, cur - 1);
+          if (key_frame_contains (frame, p))
+            return cur - 1;
+        }
+    }
+
+  /* the first segment ending at, or after, @p */
+  lo = 0;
+  hi = last;
+  while (lo < hi)
+    {
+      gint mid = lo + (hi - lo) / 2;
+
+      if (g_array_index (frames, KeyFrame, mid).end < p)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
 static void
 clutter_keyframe_transition_compute_value (ClutterTransition *transition,
                                            ClutterAnimatable *animatable,
@@ -239,39 +302,16 @@ clutter_keyframe_transition_compute_value (ClutterTransition *transition,
   /* we need a normalized linear value */
   t = clutter_timeline_get_elapsed_time (timeline);
   d = clutter_timeline_get_duration (timeline);
-  p = t / d;
+  p = d > 0 ? CLAMP (t / d, 0.0, 1.0) : 1.0;
 
-  if (priv->current_frame < 0)
-    {
-      if (direction == CLUTTER_TIMELINE_FORWARD)
-        priv->current_frame = 0;
-      else
-        priv->current_frame = priv->frames->len - 1;
-    }
+  /* the timeline can be moved to any point, e.g. when scrubbing, so
+   * we cannot assume that we only ever move to the next key frame
+   */
+  priv->current_frame =
+    clutter_keyframe_transition_find_frame (self, direction, p);
 
   cur_frame = &g_array_index (priv->frames, KeyFrame, priv->current_frame);
 
-  /* skip to the next key frame, depending on the direction of the timeline */
-  if (direction == CLUTTER_TIMELINE_FORWARD)
-    {
-      if (p > cur_frame->end)
-        {
-          priv->current_frame = MIN (priv->current_frame + 1,
-                                     priv->frames->len - 1);
-
-          cur_frame = &g_array_index (priv->frames, KeyFrame, priv->current_frame);
-       }
-    }
-  else
-    {
-      if (p < cur_frame->start)
-        {
-          priv->current_frame = MAX (priv->current_frame - 1, 0);
-
-          cur_frame = &g_array_index (priv->frames, KeyFrame, priv->current_frame);
-        }
-    }
-
   /* if we are at the boundaries of the transition, use the from and to
    * value from the transition
    */
@@ -296,7 +336,10 @@ clutter_keyframe_transition_compute_value (ClutterTransition *transition,
   real_interval = cur_frame->interval;
 
   /* normalize the progress */
-  real_progress = (p - cur_frame->start) / (cur_frame->end - cur_frame->start);
+  if (cur_frame->end > cur_frame->start)
+    real_progress = (p - cur_frame->start) / (cur_frame->end - cur_frame->start);
+  else
+    real_progress = 1.0;
 
 #ifdef CLUTTER_ENABLE_DEBUG
   if (CLUTTER_HAS_DEBUG (ANIMATION))
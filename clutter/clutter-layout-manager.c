@@ -160,6 +160,7 @@
 #include <glib-object.h>
 #include <gobject/gvaluecollector.h>
 
+#include "clutter-actor-private.h"
 #include "clutter-container.h"
 #include "clutter-debug.h"
 #include "clutter-layout-manager.h"
@@ -191,7 +192,6 @@ G_DEFINE_ABSTRACT_TYPE (ClutterLayoutManager,
                         clutter_layout_manager,
                         G_TYPE_INITIALLY_UNOWNED);
 
-static GQuark quark_layout_meta  = 0;
 
 static guint manager_signals[LAST_SIGNAL] = { 0, };
 
@@ -331,9 +331,6 @@ layout_manager_real_get_child_meta_type (ClutterLayoutManager *manager)
 static void
 clutter_layout_manager_class_init (ClutterLayoutManagerClass *klass)
 {
-  quark_layout_meta =
-    g_quark_from_static_string ("-clutter-layout-manager-child-meta");
-
   g_type_class_add_private (klass, sizeof (ClutterLayoutManagerPrivate));
 
   klass->get_preferred_width = layout_manager_real_get_preferred_width;
@@ -571,18 +568,24 @@ create_child_meta (ClutterLayoutManager *manager,
   return meta;
 }
 
+/* the layout meta is kept in the layout info of the actor, next to
+ * the other layout properties, so that the layout managers can reach
+ * it without a separate lookup
+ */
 static inline ClutterLayoutMeta *
 get_child_meta (ClutterLayoutManager *manager,
                 ClutterContainer     *container,
                 ClutterActor         *actor)
 {
+  ClutterLayoutInfo *info;
   ClutterLayoutMeta *layout = NULL;
 
-  layout = g_object_get_qdata (G_OBJECT (actor), quark_layout_meta);
-  if (layout != NULL)
+  info = _clutter_actor_peek_layout_info (actor);
+  if (info != NULL && info->layout_meta != NULL)
     {
-      ClutterChildMeta *child = CLUTTER_CHILD_META (layout);
+      ClutterChildMeta *child = CLUTTER_CHILD_META (info->layout_meta);
 
+      layout = info->layout_meta;
       if (layout->manager == manager &&
           child->container == container &&
           child->actor == actor)
@@ -598,9 +601,13 @@ get_child_meta (ClutterLayoutManager *manager,
   if (layout != NULL)
     {
       g_assert (CLUTTER_IS_LAYOUT_META (layout));
-      g_object_set_qdata_full (G_OBJECT (actor), quark_layout_meta,
-                               layout,
-                               (GDestroyNotify) g_object_unref);
+
+      info = _clutter_actor_get_layout_info (actor);
+      if (info->layout_meta != NULL)
+        g_object_unref (info->layout_meta);
+
+      info->layout_meta = layout;
+
       return layout;
     }
 
@@ -636,6 +643,26 @@ clutter_layout_manager_get_child_meta (ClutterLayoutManager *manager,
   return get_child_meta (manager, container, actor);
 }
 
+/*< private >
+ * _clutter_layout_manager_get_child_meta:
+ * @manager: a #ClutterLayoutManager
+ * @container: a #ClutterContainer using @manager
+ * @actor: a #ClutterActor child of @container
+ *
+ * Unchecked version of clutter_layout_manager_get_child_meta(), for
+ * the layout managers looking up the meta of each child on every
+ * layout pass.
+ *
+ * Return value: (transfer none): a #ClutterLayoutMeta, or %NULL
+ */
+ClutterLayoutMeta *
+_clutter_layout_manager_get_child_meta (ClutterLayoutManager *manager,
+                                        ClutterContainer     *container,
+                                        ClutterActor         *actor)
+{
+  return get_child_meta (manager, container, actor);
+}
+
 static inline gboolean
 layout_set_property_internal (ClutterLayoutManager *manager,
                               GObject              *gobject,
@@ -824,6 +851,40 @@ clutter_layout_manager_child_set_property (ClutterLayoutManager *manager,
   layout_set_property_internal (manager, G_OBJECT (meta), pspec, value);
 }
 
+/*< private >
+ * _clutter_layout_manager_child_set_pspec:
+ * @manager: a #ClutterLayoutManager
+ * @container: a #ClutterContainer using @manager
+ * @actor: a #ClutterActor child of @container
+ * @pspec: a child property of @manager, as returned by
+ *   clutter_layout_manager_find_child_property()
+ * @value: a #GValue with the value of the property to set
+ *
+ * Like clutter_layout_manager_child_set_property(), but for callers
+ * that already looked up the #GParamSpec of the property, like
+ * #ClutterScript.
+ */
+void
+_clutter_layout_manager_child_set_pspec (ClutterLayoutManager *manager,
+                                         ClutterContainer     *container,
+                                         ClutterActor         *actor,
+                                         GParamSpec           *pspec,
+                                         const GValue         *value)
+{
+  ClutterLayoutMeta *meta;
+
+  meta = get_child_meta (manager, container, actor);
+  if (meta == NULL)
+    {
+      g_warning ("Layout managers of type '%s' do not support "
+                 "layout metadata",
+                 g_type_name (G_OBJECT_TYPE (manager)));
+      return;
+    }
+
+  layout_set_property_internal (manager, G_OBJECT (meta), pspec, value);
+}
+
 /**
  * clutter_layout_manager_child_get:
  * @manager: a #ClutterLayoutManager
@@ -616,6 +616,32 @@ clutter_list_model_resort (ClutterModel         *model,
                    &sort_closure);
 }
 
+static void
+clutter_list_model_resort_row (ClutterModel         *model,
+                               ClutterModelIter     *iter,
+                               ClutterModelSortFunc  func,
+                               gpointer              data)
+{
+  ClutterListModelIter *iter_default = CLUTTER_LIST_MODEL_ITER (iter);
+  SortClosure sort_closure = { NULL, 0, NULL, NULL };
+
+  sort_closure.model  = model;
+  sort_closure.column = clutter_model_get_sorting_column (model);
+  sort_closure.func   = func;
+  sort_closure.data   = data;
+
+  /* moves the row using a binary search, instead of sorting the
+   * whole sequence
+   */
+  g_sequence_sort_changed (iter_default->seq_iter,
+                           sort_model_default,
+                           &sort_closure);
+
+  if (!clutter_model_get_filter_set (model))
+    _clutter_model_iter_set_row (iter,
+                                 g_sequence_iter_get_position (iter_default->seq_iter));
+}
+
 static guint
 clutter_list_model_get_n_rows (ClutterModel *model)
 {
@@ -651,6 +677,32 @@ clutter_list_model_row_removed (ClutterModel     *model,
   iter_default->seq_iter = NULL;
 }
 
+static void
+clutter_list_model_clear (ClutterModel *model)
+{
+  GSequence *sequence = CLUTTER_LIST_MODEL (model)->priv->sequence;
+  GSequenceIter *iter;
+  guint n_columns, i;
+
+  n_columns = clutter_model_get_n_columns (model);
+
+  iter = g_sequence_get_begin_iter (sequence);
+  while (!g_sequence_iter_is_end (iter))
+    {
+      GValue *values = g_sequence_get (iter);
+
+      for (i = 0; i < n_columns; i++)
+        g_value_unset (&values[i]);
+
+      g_free (values);
+
+      iter = g_sequence_iter_next (iter);
+    }
+
+  g_sequence_remove_range (g_sequence_get_begin_iter (sequence),
+                           g_sequence_get_end_iter (sequence));
+}
+
 static void
 clutter_list_model_finalize (GObject *gobject)
 {
@@ -707,7 +759,9 @@ clutter_list_model_class_init (ClutterListModelClass *klass)
   model_class->insert_row      = clutter_list_model_insert_row;
   model_class->remove_row      = clutter_list_model_remove_row;
   model_class->resort          = clutter_list_model_resort;
+  model_class->resort_row      = clutter_list_model_resort_row;
   model_class->get_n_rows      = clutter_list_model_get_n_rows;
+  model_class->clear           = clutter_list_model_clear;
 
   model_class->row_removed     = clutter_list_model_row_removed;
 }
@@ -97,20 +97,25 @@
 #include <glib/gi18n-lib.h>
 #include <locale.h>
 
+#include "clutter-actor-cost.h"
 #include "clutter-actor-private.h"
 #include "clutter-backend-private.h"
 #include "clutter-config.h"
 #include "clutter-debug.h"
 #include "clutter-device-manager-private.h"
 #include "clutter-event-private.h"
+#include "clutter-event-replay.h"
 #include "clutter-feature.h"
 #include "clutter-main.h"
 #include "clutter-master-clock.h"
+#include "clutter-memory.h"
 #include "clutter-private.h"
+#include "clutter-redraw-cause.h"
 #include "clutter-profile.h"
 #include "clutter-settings-private.h"
 #include "clutter-stage-manager.h"
 #include "clutter-stage-private.h"
+#include "clutter-trace.h"
 #include "clutter-version.h" 	/* For flavour define */
 
 #ifdef CLUTTER_WINDOWING_OSX
@@ -135,6 +140,10 @@
 #include <cogl/cogl.h>
 #include <cogl-pango/cogl-pango.h>
 
+#ifdef HAVE_PANGO_FT2
+#include <fontconfig/fontconfig.h>
+#endif /* HAVE_PANGO_FT2 */
+
 #include "cally.h" /* For accessibility support */
 
 /* main context */
@@ -157,6 +166,8 @@ static gboolean clutter_sync_to_vblank       = TRUE;
 
 static guint clutter_default_fps             = 60;
 
+static gchar **clutter_prewarm_font_names    = NULL;
+
 static ClutterTextDirection clutter_text_direction = CLUTTER_TEXT_DIRECTION_LTR;
 
 static guint clutter_main_loop_level         = 0;
@@ -191,6 +202,9 @@ static const GDebugKey clutter_debug_keys[] = {
   { "layout", CLUTTER_DEBUG_LAYOUT },
   { "clipping", CLUTTER_DEBUG_CLIPPING },
   { "oob-transforms", CLUTTER_DEBUG_OOB_TRANSFORMS },
+  { "memory", CLUTTER_DEBUG_MEMORY },
+  { "hud", CLUTTER_DEBUG_HUD },
+  { "startup", CLUTTER_DEBUG_STARTUP },
 };
 #endif /* CLUTTER_ENABLE_DEBUG */
 
@@ -208,6 +222,10 @@ static const GDebugKey clutter_paint_debug_keys[] = {
   { "disable-offscreen-redirect", CLUTTER_DEBUG_DISABLE_OFFSCREEN_REDIRECT },
   { "continuous-redraw", CLUTTER_DEBUG_CONTINUOUS_REDRAW },
   { "paint-deform-tiles", CLUTTER_DEBUG_PAINT_DEFORM_TILES },
+  { "input-latency", CLUTTER_DEBUG_INPUT_LATENCY },
+  { "actor-cost", CLUTTER_DEBUG_ACTOR_COST },
+  { "redraw-causes", CLUTTER_DEBUG_REDRAW_CAUSES },
+  { "redraw-backtraces", CLUTTER_DEBUG_REDRAW_BACKTRACES },
 };
 
 #ifdef CLUTTER_ENABLE_PROFILE
@@ -489,6 +507,8 @@ _clutter_context_get_frame_rate (void)
 gboolean
 clutter_get_accessibility_enabled (void)
 {
+  _clutter_accessibility_ensure_initialized ();
+
   return cally_get_cally_initialized ();
 }
 
@@ -880,6 +900,9 @@ clutter_main (void)
   g_main_loop_unref (loop);
 
   clutter_main_loop_level--;
+
+  if (clutter_main_loop_level == 0 && CLUTTER_ACTOR_COST_ENABLED ())
+    _clutter_actor_cost_dump ();
 }
 
 /**
@@ -1362,6 +1385,100 @@ clutter_init_error_quark (void)
   return g_quark_from_static_string ("clutter-init-error-quark");
 }
 
+/* the phases of the initialization are timed, and reported together
+ * once the first frame has been processed, since the debug flags are
+ * not known when the first phases run
+ */
+#define CLUTTER_STARTUP_MAX_PHASES      8
+
+typedef struct _ClutterStartupPhase
+{
+  const gchar *name;
+  gint64 duration;
+} ClutterStartupPhase;
+
+static ClutterStartupPhase clutter_startup_phases[CLUTTER_STARTUP_MAX_PHASES];
+static guint clutter_startup_n_phases = 0;
+
+static gint64 clutter_startup_time = 0;
+static gint64 clutter_startup_phase_time = 0;
+
+/* set if cally_accessibility_init() has been deferred */
+static gboolean clutter_accessibility_pending = FALSE;
+
+static void
+clutter_startup_phase_begin (const gchar *name)
+{
+  CLUTTER_TRACE_BEGIN (name);
+
+  clutter_startup_phase_time = g_get_monotonic_time ();
+  if (clutter_startup_time == 0)
+    clutter_startup_time = clutter_startup_phase_time;
+}
+
+static void
+clutter_startup_phase_end (const gchar *name)
+{
+  gint64 duration = g_get_monotonic_time () - clutter_startup_phase_time;
+
+  CLUTTER_TRACE_END ();
+
+  if (clutter_startup_n_phases < CLUTTER_STARTUP_MAX_PHASES)
+    {
+      ClutterStartupPhase *phase;
+
+      phase = &clutter_startup_phases[clutter_startup_n_phases++];
+      phase->name = name;
+      phase->duration = duration;
+    }
+}
+
+/*
+ * _clutter_accessibility_ensure_initialized:
+ *
+ * Initializes the accessibility support, if it has been deferred until
+ * after the first frame and it is needed before.
+ */
+void
+_clutter_accessibility_ensure_initialized (void)
+{
+  if (G_LIKELY (!clutter_accessibility_pending))
+    return;
+
+  clutter_accessibility_pending = FALSE;
+
+  clutter_startup_phase_begin ("accessibility");
+  cally_accessibility_init ();
+  clutter_startup_phase_end ("accessibility");
+}
+
+/* runs once, after the first frame has been processed */
+static gboolean
+clutter_startup_first_frame (gpointer data)
+{
+#ifdef CLUTTER_ENABLE_DEBUG
+  if (CLUTTER_HAS_DEBUG (STARTUP))
+    {
+      guint i;
+
+      g_print ("Clutter startup:\n");
+
+      for (i = 0; i < clutter_startup_n_phases; i++)
+        g_print ("  %-20s %10.3f ms\n",
+                 clutter_startup_phases[i].name,
+                 clutter_startup_phases[i].duration / 1000.0);
+
+      g_print ("  %-20s %10.3f ms\n",
+               "first frame",
+               (g_get_monotonic_time () - clutter_startup_time) / 1000.0);
+    }
+#endif /* CLUTTER_ENABLE_DEBUG */
+
+  _clutter_accessibility_ensure_initialized ();
+
+  return G_SOURCE_REMOVE;
+}
+
 static ClutterInitError
 clutter_init_real (GError **error)
 {
@@ -1399,8 +1516,10 @@ clutter_init_real (GError **error)
   /*
    * Call backend post parse hooks.
    */
+  clutter_startup_phase_begin ("backend");
   if (!_clutter_backend_post_parse (backend, error))
     return CLUTTER_INIT_ERROR_BACKEND;
+  clutter_startup_phase_end ("backend");
 
   /* If we are displaying the regions that would get redrawn with clipped
    * redraws enabled we actually have to disable the clipped redrawing
@@ -1419,8 +1538,10 @@ clutter_init_real (GError **error)
   /* this will take care of initializing Cogl's state and
    * query the GL machinery for features
    */
+  clutter_startup_phase_begin ("features");
   if (!_clutter_feature_init (error))
     return CLUTTER_INIT_ERROR_BACKEND;
+  clutter_startup_phase_end ("features");
 
 #ifdef CLUTTER_ENABLE_PROFILE
   /* We need to be absolutely sure that uprof has been initialized
@@ -1446,14 +1567,30 @@ clutter_init_real (GError **error)
   clutter_text_direction = clutter_get_text_direction ();
 
   /* Initiate event collection */
+  clutter_startup_phase_begin ("events");
   _clutter_backend_init_events (ctx->backend);
+  clutter_startup_phase_end ("events");
 
   clutter_is_initialized = TRUE;
   ctx->is_initialized = TRUE;
 
-  /* Initialize a11y */
-  if (clutter_enable_accessibility)
-    cally_accessibility_init ();
+  /* the accessibility support is initialized after the first frame,
+   * unless something needs it before
+   */
+  clutter_accessibility_pending = clutter_enable_accessibility;
+
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         clutter_startup_first_frame,
+                                         NULL, NULL);
+
+  if (clutter_prewarm_font_names != NULL)
+    {
+      clutter_prewarm_fonts ((const gchar * const *) clutter_prewarm_font_names,
+                             NULL);
+
+      g_strfreev (clutter_prewarm_font_names);
+      clutter_prewarm_font_names = NULL;
+    }
 
   return CLUTTER_INIT_SUCCESS;
 }
@@ -1474,6 +1611,9 @@ static GOptionEntry clutter_args[] = {
   { "clutter-use-fuzzy-picking", 0, 0, G_OPTION_ARG_NONE,
     &clutter_use_fuzzy_picking,
     N_("Use 'fuzzy' picking"), NULL },
+  { "clutter-prewarm-font", 0, 0, G_OPTION_ARG_STRING_ARRAY,
+    &clutter_prewarm_font_names,
+    N_("Load a font in advance; can be repeated"), "FONT" },
 #ifdef CLUTTER_ENABLE_DEBUG
   { "clutter-debug", 0, 0, G_OPTION_ARG_CALLBACK, clutter_arg_debug_cb,
     N_("Clutter debugging flags to set"), "FLAGS" },
@@ -1516,7 +1656,9 @@ pre_parse_hook (GOptionContext  *context,
    * determines the initial state of the settings, so that command line
    * arguments can override them.
    */
+  clutter_startup_phase_begin ("configuration");
   clutter_config_read ();
+  clutter_startup_phase_end ("configuration");
 
   clutter_context = _clutter_context_get_default ();
 
@@ -1535,6 +1677,9 @@ pre_parse_hook (GOptionContext  *context,
                               G_N_ELEMENTS (clutter_debug_keys));
       env_string = NULL;
     }
+
+  if (CLUTTER_HAS_DEBUG (MEMORY))
+    _clutter_memory_init ();
 #endif /* CLUTTER_ENABLE_DEBUG */
 
 #ifdef CLUTTER_ENABLE_PROFILE
@@ -1569,6 +1714,16 @@ pre_parse_hook (GOptionContext  *context,
       env_string = NULL;
     }
 
+  if (CLUTTER_ACTOR_COST_ENABLED ())
+    _clutter_actor_cost_init ();
+
+  /* backtraces are only useful together with the causes */
+  if (clutter_paint_debug_flags & CLUTTER_DEBUG_REDRAW_BACKTRACES)
+    clutter_paint_debug_flags |= CLUTTER_DEBUG_REDRAW_CAUSES;
+
+  if (CLUTTER_REDRAW_CAUSES_ENABLED ())
+    _clutter_redraw_cause_init ();
+
   env_string = g_getenv ("CLUTTER_SHOW_FPS");
   if (env_string)
     clutter_show_fps = TRUE;
@@ -1589,10 +1744,35 @@ pre_parse_hook (GOptionContext  *context,
   if (env_string)
     clutter_use_fuzzy_picking = TRUE;
 
+  /* font descriptions can contain commas, so use semicolons */
+  env_string = g_getenv ("CLUTTER_PREWARM_FONTS");
+  if (env_string != NULL && *env_string != '\0')
+    {
+      g_strfreev (clutter_prewarm_font_names);
+      clutter_prewarm_font_names = g_strsplit (env_string, ";", -1);
+      env_string = NULL;
+    }
+
   env_string = g_getenv ("CLUTTER_VBLANK");
   if (g_strcmp0 (env_string, "none") == 0)
     clutter_sync_to_vblank = FALSE;
 
+  env_string = g_getenv ("CLUTTER_TRACE");
+  if (env_string != NULL)
+    _clutter_trace_init (env_string);
+
+  env_string = g_getenv ("CLUTTER_REPLAY_EVENTS");
+  if (env_string != NULL)
+    {
+      const gchar *mode = g_getenv ("CLUTTER_REPLAY_MODE");
+
+      _clutter_event_replay_init (env_string, g_strcmp0 (mode, "fast") == 0);
+    }
+
+  env_string = g_getenv ("CLUTTER_RECORD_EVENTS");
+  if (env_string != NULL)
+    _clutter_event_record_init (env_string);
+
   return _clutter_backend_pre_parse (backend, error);
 }
 
@@ -2223,17 +2403,43 @@ is_off_stage (ClutterActor *stage,
  */
 void
 clutter_do_event (ClutterEvent *event)
+{
+  _clutter_do_event (event, TRUE);
+}
+
+/*< private >
+ * _clutter_do_event:
+ * @event: a #ClutterEvent
+ * @do_copy: whether @event should be copied
+ *
+ * Queues @event on its stage, like clutter_do_event(); if @do_copy is
+ * %FALSE, the stage takes ownership of @event, which must have been
+ * allocated with clutter_event_new() or clutter_event_copy(), instead
+ * of copying it.
+ */
+void
+_clutter_do_event (ClutterEvent *event,
+                   gboolean      do_copy)
 {
   /* we need the stage for the event */
   if (event->any.stage == NULL)
     {
       g_warning ("%s: Event does not have a stage: discarding.", G_STRFUNC);
+
+      if (!do_copy)
+        clutter_event_free (event);
+
       return;
     }
 
   /* stages in destruction do not process events */
   if (CLUTTER_ACTOR_IN_DESTRUCTION (event->any.stage))
-    return;
+    {
+      if (!do_copy)
+        clutter_event_free (event);
+
+      return;
+    }
 
   /* Instead of processing events when received, we queue them up to
    * handle per-frame before animations, layout, and drawing.
@@ -2242,7 +2448,7 @@ clutter_do_event (ClutterEvent *event)
    * because we've "looked ahead" and know all motion events that
    * will occur before drawing the frame.
    */
-  _clutter_stage_queue_event (event->any.stage, event);
+  _clutter_stage_queue_event (event->any.stage, event, do_copy);
 }
 
 static void
@@ -2425,7 +2631,14 @@ _clutter_process_event_details (ClutterActor        *stage,
                * get the actor underneath
                */
               if (device != NULL)
-                actor = _clutter_input_device_update (device, NULL, TRUE);
+                {
+                  /* hover picks do not need to be resolved right away */
+                  if (event->type == CLUTTER_MOTION &&
+                      clutter_stage_get_async_pick_enabled (CLUTTER_STAGE (stage)))
+                    actor = _clutter_input_device_update_async (device);
+                  else
+                    actor = _clutter_input_device_update (device, NULL, TRUE);
+                }
               else
                 {
                   CLUTTER_NOTE (EVENT, "No device found: picking");
@@ -2984,6 +3197,187 @@ clutter_get_font_map (void)
   return PANGO_FONT_MAP (clutter_context_get_pango_fontmap ());
 }
 
+/* the printable ASCII characters */
+#define DEFAULT_PREWARM_CHARACTERS \
+  " !\"#$%&'()*+,-./0123456789:;<=>?@" \
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`" \
+  "abcdefghijklmnopqrstuvwxyz{|}~"
+
+typedef struct _FontPrewarm
+{
+  gchar **font_names;
+  gchar *characters;
+} FontPrewarm;
+
+static void
+font_prewarm_free (gpointer data)
+{
+  FontPrewarm *prewarm = data;
+
+  g_strfreev (prewarm->font_names);
+  g_free (prewarm->characters);
+  g_slice_free (FontPrewarm, prewarm);
+}
+
+/* runs in the main thread: creates the font map and the Pango
+ * context, loads the fonts and uploads the glyphs of the characters
+ * into the glyph cache of CoglPango, which requires the Cogl context
+ */
+static gboolean
+font_prewarm_load_glyphs (gpointer data)
+{
+  FontPrewarm *prewarm = data;
+  PangoContext *context;
+  PangoLayout *layout;
+  gint i;
+
+  context = _clutter_context_create_pango_context ();
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, prewarm->characters, -1);
+
+  if (prewarm->font_names == NULL)
+    cogl_pango_ensure_glyph_cache_for_layout (layout);
+  else
+    {
+      for (i = 0; prewarm->font_names[i] != NULL; i++)
+        {
+          PangoFontDescription *desc;
+
+          CLUTTER_NOTE (MISC, "Prewarming font '%s'", prewarm->font_names[i]);
+
+          desc = pango_font_description_from_string (prewarm->font_names[i]);
+          pango_layout_set_font_description (layout, desc);
+          cogl_pango_ensure_glyph_cache_for_layout (layout);
+          pango_font_description_free (desc);
+        }
+    }
+
+  g_object_unref (layout);
+  g_object_unref (context);
+
+  return G_SOURCE_REMOVE;
+}
+
+#ifdef HAVE_PANGO_FT2
+/* runs in a separate thread: the bulk of the cost of loading a font
+ * for the first time is fontconfig reading its configuration and its
+ * caches, and sorting the fonts matching the description; fontconfig
+ * can do that outside of the main thread, unlike Pango
+ */
+static gpointer
+font_prewarm_thread (gpointer data)
+{
+  FontPrewarm *prewarm = data;
+  gint i;
+
+  FcInit ();
+
+  for (i = 0; prewarm->font_names != NULL && prewarm->font_names[i] != NULL; i++)
+    {
+      PangoFontDescription *desc;
+      const gchar *family;
+      FcPattern *pattern;
+      FcFontSet *fonts;
+      FcResult result;
+
+      desc = pango_font_description_from_string (prewarm->font_names[i]);
+      family = pango_font_description_get_family (desc);
+
+      pattern = FcPatternCreate ();
+
+      if (family != NULL)
+        {
+          gchar **families = g_strsplit (family, ",", -1);
+          gint j;
+
+          for (j = 0; families[j] != NULL; j++)
+            FcPatternAddString (pattern, FC_FAMILY,
+                                (const FcChar8 *) g_strstrip (families[j]));
+
+          g_strfreev (families);
+        }
+
+      FcConfigSubstitute (NULL, pattern, FcMatchPattern);
+      FcDefaultSubstitute (pattern);
+
+      fonts = FcFontSort (NULL, pattern, FcTrue, NULL, &result);
+      if (fonts != NULL)
+        FcFontSetDestroy (fonts);
+
+      FcPatternDestroy (pattern);
+      pango_font_description_free (desc);
+    }
+
+  clutter_threads_add_idle_full (G_PRIORITY_DEFAULT_IDLE,
+                                 font_prewarm_load_glyphs,
+                                 prewarm,
+                                 font_prewarm_free);
+
+  return NULL;
+}
+#endif /* HAVE_PANGO_FT2 */
+
+/**
+ * clutter_prewarm_fonts:
+ * @font_names: (array zero-terminated=1) (allow-none): a %NULL-terminated
+ *   array of font descriptions, in the format accepted by
+ *   pango_font_description_from_string(), or %NULL to use the
+ *   default font
+ * @characters: (allow-none): a UTF-8 string with the characters to
+ *   load, or %NULL for the printable ASCII characters
+ *
+ * Loads the fonts described by @font_names, and the glyphs of
+ * @characters in each of them, ahead of the first frame that uses
+ * them.
+ *
+ * This function returns immediately: when possible, the font
+ * configuration is loaded in a separate thread, while the application
+ * builds its scene; the fonts and the glyphs are then loaded from the
+ * main loop.
+ *
+ * The same can be achieved by passing the --clutter-prewarm-font
+ * command line option, or by setting the CLUTTER_PREWARM_FONTS
+ * environment variable to a semicolon-separated list of fonts.
+ *
+ * This function can only be called after clutter_init().
+ */
+void
+clutter_prewarm_fonts (const gchar * const *font_names,
+                       const gchar         *characters)
+{
+  FontPrewarm *prewarm;
+
+  g_return_if_fail (clutter_is_initialized);
+  g_return_if_fail (characters == NULL || g_utf8_validate (characters, -1, NULL));
+
+  prewarm = g_slice_new0 (FontPrewarm);
+  prewarm->font_names = g_strdupv ((gchar **) font_names);
+  prewarm->characters = g_strdup (characters != NULL
+                                  ? characters
+                                  : DEFAULT_PREWARM_CHARACTERS);
+
+#ifdef HAVE_PANGO_FT2
+  {
+    GThread *thread;
+
+    thread = g_thread_try_new ("Clutter font prewarm",
+                               font_prewarm_thread,
+                               prewarm,
+                               NULL);
+    if (thread != NULL)
+      {
+        g_thread_unref (thread);
+        return;
+      }
+  }
+#endif /* HAVE_PANGO_FT2 */
+
+  clutter_threads_add_idle_full (G_PRIORITY_DEFAULT_IDLE,
+                                 font_prewarm_load_glyphs,
+                                 prewarm,
+                                 font_prewarm_free);
+}
+
 typedef struct _ClutterRepaintFunction
 {
   guint id;
@@ -3113,6 +3507,13 @@ clutter_threads_add_repaint_func (GSourceFunc    func,
  * function will determine the section of the frame processing that will
  * result in @func being called.
  *
+ * Repaint functions using %CLUTTER_REPAINT_FLAGS_IDLE are meant for work
+ * that can be done whenever the frame budget allows, like warming caches
+ * for content that is not visible yet; they keep the master clock running
+ * until they are removed, and they should use
+ * clutter_threads_get_remaining_frame_budget() to stop before exceeding
+ * the frame budget.
+ *
  * Adding a repaint function does not automatically ensure that a new
  * frame will be queued.
  *
@@ -3166,6 +3567,351 @@ clutter_threads_add_repaint_func_full (ClutterRepaintFlags flags,
   return repaint_func->id;
 }
 
+typedef struct _ClutterThreadTask      ClutterThreadTask;
+
+struct _ClutterThreadTask
+{
+  ClutterThreadTask *next;
+
+  GSourceFunc func;
+  gpointer data;
+  GDestroyNotify notify;
+};
+
+/* the tasks posted using clutter_threads_post_task(), as two lock-free
+ * stacks, one for each phase of the frame in which they are run; the
+ * Clutter thread is the only consumer, and steals a whole stack at
+ * once, so there is no need to guard against ABA
+ */
+static ClutterThreadTask * volatile pre_paint_tasks = NULL;
+static ClutterThreadTask * volatile post_paint_tasks = NULL;
+
+/* pushes the chain going from @first to @last on top of @stack */
+static gboolean
+clutter_thread_tasks_push (ClutterThreadTask * volatile *stack,
+                           ClutterThreadTask            *first,
+                           ClutterThreadTask            *last)
+{
+  ClutterThreadTask *head;
+
+  do
+    {
+      head = g_atomic_pointer_get (stack);
+      last->next = head;
+    }
+  while (!g_atomic_pointer_compare_and_exchange (stack, head, first));
+
+  return head == NULL;
+}
+
+/* empties @stack, and returns its tasks in the order they were posted */
+static ClutterThreadTask *
+clutter_thread_tasks_steal (ClutterThreadTask * volatile *stack)
+{
+  ClutterThreadTask *head, *reversed;
+
+  do
+    head = g_atomic_pointer_get (stack);
+  while (head != NULL &&
+         !g_atomic_pointer_compare_and_exchange (stack, head, NULL));
+
+  reversed = NULL;
+  while (head != NULL)
+    {
+      ClutterThreadTask *next = head->next;
+
+      head->next = reversed;
+      reversed = head;
+      head = next;
+    }
+
+  return reversed;
+}
+
+/**
+ * clutter_threads_post_task:
+ * @flags: the section of the frame processing in which @func should
+ *   be called; only %CLUTTER_REPAINT_FLAGS_PRE_PAINT and
+ *   %CLUTTER_REPAINT_FLAGS_POST_PAINT are meaningful
+ * @func: the function to be called
+ * @data: data to be passed to the function, or %NULL
+ * @notify: function to be called once @func will not be called any
+ *   more, or %NULL
+ *
+ * Posts @func to be called on the next frame processed by Clutter,
+ * and wakes up the Clutter main loop if needed.
+ *
+ * This function can be called from any thread, and it does not
+ * acquire the Clutter lock, nor any other lock: it is meant to be
+ * used by worker threads that need to update the scene graph
+ * frequently, without contending with the Clutter thread.
+ *
+ * Like the functions added by clutter_threads_add_repaint_func_full(),
+ * @func is called from within the same thread that called clutter_main()
+ * and while the Clutter lock is being held, in posting order, before
+ * the repaint functions with the same @flags. Unlike them, posting a
+ * task does not create or store anything besides a small record, which
+ * is released after @func has been called; if @func returns %TRUE it
+ * is posted again for the next frame.
+ */
+void
+clutter_threads_post_task (ClutterRepaintFlags flags,
+                           GSourceFunc         func,
+                           gpointer            data,
+                           GDestroyNotify      notify)
+{
+  ClutterThreadTask *task;
+  gboolean was_empty;
+
+  g_return_if_fail (func != NULL);
+
+  task = g_slice_new (ClutterThreadTask);
+  task->func = func;
+  task->data = data;
+  task->notify = notify;
+
+  if ((flags & CLUTTER_REPAINT_FLAGS_POST_PAINT) != 0)
+    was_empty = clutter_thread_tasks_push (&post_paint_tasks, task, task);
+  else
+    was_empty = clutter_thread_tasks_push (&pre_paint_tasks, task, task);
+
+  /* the master clock checks for pending tasks when deciding whether
+   * to process a frame, so we only need to wake up the main loop if
+   * this is the first task posted since the last frame
+   */
+  if (was_empty)
+    g_main_context_wakeup (NULL);
+}
+
+/*
+ * _clutter_threads_has_pending_tasks:
+ *
+ * Checks whether there are tasks posted using clutter_threads_post_task()
+ * and waiting for the next frame.
+ */
+gboolean
+_clutter_threads_has_pending_tasks (void)
+{
+  return g_atomic_pointer_get (&pre_paint_tasks) != NULL ||
+         g_atomic_pointer_get (&post_paint_tasks) != NULL;
+}
+
+static void
+clutter_run_thread_tasks (ClutterThreadTask * volatile *stack)
+{
+  ClutterThreadTask *tasks, *first, *last;
+
+  tasks = clutter_thread_tasks_steal (stack);
+  if (tasks == NULL)
+    return;
+
+  first = last = NULL;
+
+  while (tasks != NULL)
+    {
+      ClutterThreadTask *task = tasks;
+
+      tasks = task->next;
+
+      if (task->func (task->data))
+        {
+          /* keep the posting order when re-posting */
+          task->next = NULL;
+
+          if (last != NULL)
+            last->next = task;
+          else
+            first = task;
+
+          last = task;
+        }
+      else
+        {
+          if (task->notify != NULL)
+            task->notify (task->data);
+
+          g_slice_free (ClutterThreadTask, task);
+        }
+    }
+
+  /* tasks that asked to be called again will run on the next frame;
+   * re-posting them keeps the master clock running
+   */
+  if (first != NULL)
+    {
+      ClutterThreadTask *head = NULL, *l;
+
+      /* the stack is in reverse posting order */
+      for (l = first; l != NULL; )
+        {
+          ClutterThreadTask *next = l->next;
+
+          l->next = head;
+          head = l;
+          l = next;
+        }
+
+      clutter_thread_tasks_push (stack, head, first);
+    }
+}
+
+typedef struct _ClutterWorkerTask
+{
+  /* only accessed from the Clutter thread */
+  GObject *owner;
+  guint sequence;
+
+  volatile gint cancelled;
+
+  ClutterWorkerPriority priority;
+  ClutterRepaintFlags flags;
+
+  ClutterWorkerFunc run;
+  ClutterWorkerFunc complete;
+  gpointer data;
+  GDestroyNotify notify;
+} ClutterWorkerTask;
+
+/* the shared pool of worker threads; it is bounded so that background
+ * work never competes with the Clutter thread for every core
+ */
+#define CLUTTER_WORKER_MAX_THREADS      4
+
+static GThreadPool *worker_pool = NULL;
+static guint worker_sequence = 0;
+
+static void
+clutter_worker_task_owner_gone (gpointer  data,
+                                GObject  *where_the_object_was)
+{
+  ClutterWorkerTask *task = data;
+
+  task->owner = NULL;
+  g_atomic_int_set (&task->cancelled, TRUE);
+}
+
+/* runs in the Clutter thread, in the frame phase requested for the task */
+static gboolean
+clutter_worker_task_complete (gpointer data)
+{
+  ClutterWorkerTask *task = data;
+
+  if (task->owner != NULL)
+    g_object_weak_unref (task->owner, clutter_worker_task_owner_gone, task);
+
+  if (!g_atomic_int_get (&task->cancelled) && task->complete != NULL)
+    task->complete (task->data);
+
+  if (task->notify != NULL)
+    task->notify (task->data);
+
+  g_slice_free (ClutterWorkerTask, task);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* runs in a worker thread */
+static void
+clutter_worker_task_run (gpointer data,
+                         gpointer user_data)
+{
+  ClutterWorkerTask *task = data;
+
+  if (!g_atomic_int_get (&task->cancelled))
+    task->run (task->data);
+
+  clutter_threads_post_task (task->flags,
+                             clutter_worker_task_complete,
+                             task,
+                             NULL);
+}
+
+static gint
+clutter_worker_task_compare (gconstpointer a,
+                             gconstpointer b,
+                             gpointer      user_data)
+{
+  const ClutterWorkerTask *task_a = a;
+  const ClutterWorkerTask *task_b = b;
+
+  if (task_a->priority != task_b->priority)
+    return task_a->priority < task_b->priority ? -1 : 1;
+
+  /* the difference handles the wrap around of the sequence */
+  return (gint) (task_a->sequence - task_b->sequence);
+}
+
+/**
+ * clutter_threads_add_worker_task:
+ * @owner: (type GObject.Object) (allow-none): the object owning the task,
+ *   or %NULL
+ * @priority: the priority of the task
+ * @flags: the section of the frame processing in which @complete should
+ *   be called; see clutter_threads_post_task()
+ * @run: the function to be called in a worker thread
+ * @complete: (allow-none): the function to be called in the Clutter
+ *   thread once @run is done, or %NULL
+ * @data: data to be passed to @run and @complete
+ * @notify: (allow-none): function to be called once the task is done,
+ *   or %NULL
+ *
+ * Adds a task to the pool of worker threads shared by Clutter and the
+ * applications using it.
+ *
+ * The @run function is called in one of the worker threads; once it
+ * returns, @complete is called from within the thread that called
+ * clutter_main() while the Clutter lock is being held, during the
+ * frame processing as specified by @flags.
+ *
+ * If @owner is not %NULL, the task is cancelled when @owner is disposed:
+ * @run is not called if it has not started yet, and @complete is not
+ * called. The @notify function is always called, from the Clutter
+ * thread, once the task is done.
+ *
+ * This function must be called from the Clutter thread.
+ */
+void
+clutter_threads_add_worker_task (gpointer              owner,
+                                 ClutterWorkerPriority priority,
+                                 ClutterRepaintFlags   flags,
+                                 ClutterWorkerFunc     run,
+                                 ClutterWorkerFunc     complete,
+                                 gpointer              data,
+                                 GDestroyNotify        notify)
+{
+  ClutterWorkerTask *task;
+
+  g_return_if_fail (owner == NULL || G_IS_OBJECT (owner));
+  g_return_if_fail (run != NULL);
+
+  if (G_UNLIKELY (worker_pool == NULL))
+    {
+      worker_pool = g_thread_pool_new (clutter_worker_task_run,
+                                       NULL,
+                                       CLUTTER_WORKER_MAX_THREADS, FALSE,
+                                       NULL);
+      g_thread_pool_set_sort_function (worker_pool,
+                                       clutter_worker_task_compare,
+                                       NULL);
+    }
+
+  task = g_slice_new (ClutterWorkerTask);
+  task->owner = owner;
+  task->sequence = worker_sequence++;
+  task->cancelled = FALSE;
+  task->priority = priority;
+  task->flags = flags;
+  task->run = run;
+  task->complete = complete;
+  task->data = data;
+  task->notify = notify;
+
+  if (owner != NULL)
+    g_object_weak_ref (owner, clutter_worker_task_owner_gone, task);
+
+  g_thread_pool_push (worker_pool, task, NULL);
+}
+
 /*
  * _clutter_run_repaint_functions:
  * @flags: only run the repaint functions matching the passed flags
@@ -3179,8 +3925,15 @@ void
 _clutter_run_repaint_functions (ClutterRepaintFlags flags)
 {
   ClutterMainContext *context = _clutter_context_get_default ();
+  ClutterMasterClock *master_clock = _clutter_master_clock_get_default ();
   ClutterRepaintFunction *repaint_func;
-  GList *invoke_list, *reinvoke_list, *l;
+  GList *invoke_list, *reinvoke_list, *skipped_list, *l;
+
+  if ((flags & CLUTTER_REPAINT_FLAGS_PRE_PAINT) != 0)
+    clutter_run_thread_tasks (&pre_paint_tasks);
+
+  if ((flags & CLUTTER_REPAINT_FLAGS_POST_PAINT) != 0)
+    clutter_run_thread_tasks (&post_paint_tasks);
 
   if (context->repaint_funcs == NULL)
     return;
@@ -3190,6 +3943,7 @@ _clutter_run_repaint_functions (ClutterRepaintFlags flags)
   context->repaint_funcs = NULL;
 
   reinvoke_list = NULL;
+  skipped_list = NULL;
 
   /* consume the whole list while we execute the functions */
   while (invoke_list != NULL)
@@ -3203,10 +3957,19 @@ _clutter_run_repaint_functions (ClutterRepaintFlags flags)
 
       g_list_free (l);
 
-      if ((repaint_func->flags & flags) != 0)
-        res = repaint_func->func (repaint_func->data);
-      else
-        res = TRUE;
+      /* the idle functions are skipped once the frame budget has been
+       * used; they are moved ahead of the ones that did run, so that
+       * they are the first to run on the next frame
+       */
+      if ((repaint_func->flags & flags) == 0 ||
+          ((repaint_func->flags & CLUTTER_REPAINT_FLAGS_IDLE) != 0 &&
+           _clutter_master_clock_get_remaining_budget (master_clock) == 0))
+        {
+          skipped_list = g_list_prepend (skipped_list, repaint_func);
+          continue;
+        }
+
+      res = repaint_func->func (repaint_func->data);
 
       if (res)
         reinvoke_list = g_list_prepend (reinvoke_list, repaint_func);
@@ -3219,13 +3982,79 @@ _clutter_run_repaint_functions (ClutterRepaintFlags flags)
         }
     }
 
+  reinvoke_list = g_list_concat (g_list_reverse (skipped_list),
+                                 g_list_reverse (reinvoke_list));
+
   if (context->repaint_funcs != NULL)
+    context->repaint_funcs = g_list_concat (context->repaint_funcs,
+                                            reinvoke_list);
+  else
+    context->repaint_funcs = reinvoke_list;
+}
+
+/*
+ * _clutter_has_repaint_functions:
+ * @flags: the repaint flags to look for
+ *
+ * Checks whether any of the repaint functions is run during the
+ * sections of the frame processing matching @flags.
+ *
+ * Must be called with the Clutter thread lock held.
+ */
+gboolean
+_clutter_has_repaint_functions (ClutterRepaintFlags flags)
+{
+  ClutterMainContext *context = _clutter_context_get_default ();
+  GList *l;
+
+  for (l = context->repaint_funcs; l != NULL; l = l->next)
     {
-      context->repaint_funcs = g_list_concat (context->repaint_funcs,
-                                              g_list_reverse (reinvoke_list));
+      ClutterRepaintFunction *repaint_func = l->data;
+
+      if ((repaint_func->flags & flags) != 0)
+        return TRUE;
     }
-  else
-    context->repaint_funcs = g_list_reverse (reinvoke_list);
+
+  return FALSE;
+}
+
+/**
+ * clutter_threads_get_remaining_frame_budget:
+ *
+ * Retrieves how much time is left to the frame being processed before
+ * it exceeds its budget, that is the refresh interval of the stages.
+ *
+ * This function is meant to be called by the repaint functions added
+ * with the %CLUTTER_REPAINT_FLAGS_IDLE flag, to split their work in
+ * slices that fit inside the frame; for instance:
+ *
+ * |[
+ * static gboolean
+ * prefetch_rows (gpointer data)
+ * {
+ *   MyView *view = data;
+ *
+ *   while (clutter_threads_get_remaining_frame_budget () > 1000)
+ *     {
+ *       if (!my_view_prefetch_next_row (view))
+ *         return G_SOURCE_REMOVE;
+ *     }
+ *
+ *   /&ast; continue on the next frame &ast;/
+ *   return G_SOURCE_CONTINUE;
+ * }
+ * ]|
+ *
+ * Return value: the remaining time, in microseconds, or 0 if the budget
+ *   has been exhausted, or if this function is not called while a frame
+ *   is being processed
+ */
+gint64
+clutter_threads_get_remaining_frame_budget (void)
+{
+  ClutterMasterClock *master_clock = _clutter_master_clock_get_default ();
+
+  return _clutter_master_clock_get_remaining_budget (master_clock);
 }
 
 /**
@@ -76,6 +76,14 @@ GQuark clutter_init_error_quark (void);
  */
 #define CLUTTER_PRIORITY_REDRAW         (G_PRIORITY_HIGH_IDLE + 50)
 
+/**
+ * ClutterWorkerFunc:
+ * @data: the data passed to clutter_threads_add_worker_task()
+ *
+ * The functions run by a task added with clutter_threads_add_worker_task().
+ */
+typedef void (* ClutterWorkerFunc) (gpointer data);
+
 /* Initialisation */
 void                    clutter_base_init                       (void);
 ClutterInitError        clutter_init                            (int          *argc,
@@ -129,6 +137,18 @@ guint                   clutter_threads_add_repaint_func_full   (ClutterRepaintF
                                                                  gpointer       data,
                                                                  GDestroyNotify notify);
 void                    clutter_threads_remove_repaint_func     (guint          handle_id);
+gint64                  clutter_threads_get_remaining_frame_budget (void);
+void                    clutter_threads_post_task               (ClutterRepaintFlags flags,
+                                                                 GSourceFunc    func,
+                                                                 gpointer       data,
+                                                                 GDestroyNotify notify);
+void                    clutter_threads_add_worker_task         (gpointer              owner,
+                                                                 ClutterWorkerPriority priority,
+                                                                 ClutterRepaintFlags   flags,
+                                                                 ClutterWorkerFunc     run,
+                                                                 ClutterWorkerFunc     complete,
+                                                                 gpointer              data,
+                                                                 GDestroyNotify        notify);
 
 void                    clutter_grab_pointer                    (ClutterActor  *actor);
 void                    clutter_ungrab_pointer                  (void);
@@ -138,9 +158,15 @@ void                    clutter_ungrab_keyboard                 (void);
 ClutterActor *          clutter_get_keyboard_grab               (void);
 
 PangoFontMap *          clutter_get_font_map                    (void);
+void                    clutter_prewarm_fonts                   (const gchar * const *font_names,
+                                                                 const gchar   *characters);
 
 ClutterTextDirection    clutter_get_default_text_direction      (void);
 
+gsize                   clutter_get_memory_usage                (ClutterMemoryCategory category,
+                                                                 guint                *n_objects);
+void                    clutter_purge_caches                    (ClutterPurgeLevel     level);
+
 G_END_DECLS
 
 #endif /* _CLUTTER_MAIN_H__ */
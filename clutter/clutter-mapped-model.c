@@ -0,0 +1,1032 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:clutter-mapped-model
+ * @short_description: Read-only model backed by a file
+ *
+ * #ClutterMappedModel is a read-only #ClutterModel implementation
+ * provided by Clutter, which maps a file containing the rows in memory
+ * instead of copying them; the rows are read from the file only when
+ * they are accessed, so it's meant for large, static data sets, like
+ * catalogues, that would otherwise have to be appended row by row to a
+ * #ClutterListModel or a #ClutterArrayModel.
+ *
+ * The file contains the values of each column in a contiguous array,
+ * with a table holding all the strings. All the fields are 32 bits
+ * wide, and stored in little-endian order:
+ *
+ * <itemizedlist>
+ *   <listitem><para>a header, with the "CMDL" magic, the version of
+ *   the format (currently 1), the number of columns, the number of
+ *   rows, and the offset and size in bytes of the string
+ *   table;</para></listitem>
+ *   <listitem><para>one descriptor for each column, with its type (0
+ *   for %G_TYPE_INT, 1 for %G_TYPE_FLOAT and 2 for %G_TYPE_STRING),
+ *   the offset of its name inside the string table, and the offset of
+ *   its values, which must be a multiple of 4;</para></listitem>
+ *   <listitem><para>the values of each column, one per row; the
+ *   values of string columns are offsets inside the string table, or
+ *   0xffffffff for %NULL;</para></listitem>
+ *   <listitem><para>the string table, containing the strings
+ *   terminated by a nul byte.</para></listitem>
+ * </itemizedlist>
+ *
+ * The values can be read without copying them into a #GValue using
+ * clutter_mapped_model_iter_get_int() and the other typed accessors;
+ * the strings returned by clutter_mapped_model_iter_get_string() are
+ * stored inside the mapping, and are valid for as long as the model
+ * is.
+ *
+ * Sorting and filtering a #ClutterMappedModel do not change the file:
+ * the model keeps the positions of the rows inside the file in the
+ * sorted order, and the positions of the rows matching the filter.
+ *
+ * Trying to add, change or remove the rows of a #ClutterMappedModel
+ * is a programming error.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib-object.h>
+
+#include "clutter-mapped-model.h"
+#include "clutter-main.h"
+#include "clutter-model.h"
+#include "clutter-model-private.h"
+#include "clutter-private.h"
+#include "clutter-debug.h"
+
+#define CLUTTER_TYPE_MAPPED_MODEL_ITER                \
+        (clutter_mapped_model_iter_get_type())
+#define CLUTTER_MAPPED_MODEL_ITER(obj)                \
+        (G_TYPE_CHECK_INSTANCE_CAST((obj),            \
+         CLUTTER_TYPE_MAPPED_MODEL_ITER,              \
+         ClutterMappedModelIter))
+#define CLUTTER_IS_MAPPED_MODEL_ITER(obj)             \
+        (G_TYPE_CHECK_INSTANCE_TYPE((obj),            \
+         CLUTTER_TYPE_MAPPED_MODEL_ITER))
+
+typedef struct _ClutterMappedModelIter  ClutterMappedModelIter;
+typedef struct _ClutterModelIterClass   ClutterMappedModelIterClass;
+
+#define CLUTTER_MAPPED_MODEL_GET_PRIVATE(obj)   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_MAPPED_MODEL, ClutterMappedModelPrivate))
+
+#define MAPPED_MODEL_VERSION    1
+#define MAPPED_MODEL_NULL       0xffffffff
+
+typedef enum {
+  COLUMN_INT    = 0,
+  COLUMN_FLOAT  = 1,
+  COLUMN_STRING = 2
+} ColumnKind;
+
+/* the layout of the file; all the fields are little-endian */
+typedef struct {
+  gchar magic[4];
+  guint32 version;
+  guint32 n_columns;
+  guint32 n_rows;
+  guint32 strings_offset;
+  guint32 strings_size;
+} MappedHeader;
+
+typedef struct {
+  guint32 kind;
+  guint32 name;
+  guint32 cells_offset;
+} MappedColumnHeader;
+
+typedef struct {
+  ColumnKind kind;
+
+  /* n_rows little-endian cells inside the mapping */
+  const guint32 *cells;
+} MappedColumn;
+
+struct _ClutterMappedModelPrivate
+{
+  GMappedFile *file;
+
+  MappedColumn *columns;
+  guint n_columns;
+  guint n_rows;
+
+  const gchar *strings;
+  guint32 strings_size;
+
+  /* the positions inside the file of the rows in the sorted order;
+   * the sorted row N is the row at order[N], and a NULL order is the
+   * order of the file
+   */
+  guint *order;
+
+  /* the positions inside the file of the rows matching the filter,
+   * in the sorted order
+   */
+  GArray *filter_rows;
+  guint filter_stamp;
+
+  ClutterModelIter *temp_iter;
+
+  guint filter_valid : 1;
+};
+
+struct _ClutterMappedModelIter
+{
+  ClutterModelIter parent_instance;
+
+  /* the position of the row inside the file; a position equal to
+   * the number of rows is the end of the model
+   */
+  guint index;
+};
+
+GType clutter_mapped_model_iter_get_type (void);
+
+static inline guint32
+mapped_column_get_cell (const MappedColumn *column,
+                        guint               index_)
+{
+  return GUINT32_FROM_LE (column->cells[index_]);
+}
+
+static inline gint
+mapped_column_get_int (const MappedColumn *column,
+                       guint               index_)
+{
+  return (gint32) mapped_column_get_cell (column, index_);
+}
+
+static inline gfloat
+mapped_column_get_float (const MappedColumn *column,
+                         guint               index_)
+{
+  guint32 bits = mapped_column_get_cell (column, index_);
+  gfloat retval;
+
+  memcpy (&retval, &bits, sizeof (gfloat));
+
+  return retval;
+}
+
+static const gchar *
+clutter_mapped_model_get_string (ClutterMappedModel *model,
+                                 guint32             offset)
+{
+  ClutterMappedModelPrivate *priv = model->priv;
+
+  if (offset == MAPPED_MODEL_NULL)
+    return NULL;
+
+  /* the string table is terminated by a nul byte, and every offset
+   * has been checked when loading the file, so it points to a valid
+   * C string
+   */
+  g_assert (offset < priv->strings_size);
+
+  return priv->strings + offset;
+}
+
+/* initializes @value with the contents of a cell; the strings are not
+ * copied, as they live as long as the model
+ */
+static void
+clutter_mapped_model_peek_value (ClutterMappedModel *model,
+                                 guint               column,
+                                 guint               index_,
+                                 GValue             *value)
+{
+  const MappedColumn *mapped_column = &model->priv->columns[column];
+
+  switch (mapped_column->kind)
+    {
+    case COLUMN_INT:
+      g_value_init (value, G_TYPE_INT);
+      g_value_set_int (value, mapped_column_get_int (mapped_column, index_));
+      break;
+
+    case COLUMN_FLOAT:
+      g_value_init (value, G_TYPE_FLOAT);
+      g_value_set_float (value,
+                         mapped_column_get_float (mapped_column, index_));
+      break;
+
+    case COLUMN_STRING:
+      {
+        guint32 offset = mapped_column_get_cell (mapped_column, index_);
+
+        g_value_init (value, G_TYPE_STRING);
+        g_value_set_static_string (value,
+                                   clutter_mapped_model_get_string (model,
+                                                                    offset));
+      }
+      break;
+    }
+}
+
+static inline guint
+clutter_mapped_model_sorted_to_index (ClutterMappedModel *model,
+                                      guint               sorted_row)
+{
+  if (model->priv->order == NULL)
+    return sorted_row;
+
+  return model->priv->order[sorted_row];
+}
+
+static gboolean
+clutter_mapped_model_filter_index (ClutterMappedModel *model,
+                                   guint               index_,
+                                   guint               row)
+{
+  ClutterModelIter *temp_iter = model->priv->temp_iter;
+
+  CLUTTER_MAPPED_MODEL_ITER (temp_iter)->index = index_;
+  _clutter_model_iter_set_row (temp_iter, row);
+
+  return clutter_model_filter_iter (CLUTTER_MODEL (model), temp_iter);
+}
+
+/* whether the filtered rows index is in sync with the filter set
+ * on the model
+ */
+static gboolean
+clutter_mapped_model_filter_is_valid (ClutterMappedModel *model)
+{
+  ClutterMappedModelPrivate *priv = model->priv;
+
+  if (!priv->filter_valid)
+    return FALSE;
+
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)) ||
+      priv->filter_stamp != _clutter_model_get_filter_stamp (CLUTTER_MODEL (model)))
+    {
+      priv->filter_valid = FALSE;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+clutter_mapped_model_ensure_filter (ClutterMappedModel *model)
+{
+  ClutterMappedModelPrivate *priv = model->priv;
+  guint i;
+
+  if (clutter_mapped_model_filter_is_valid (model))
+    return;
+
+  g_array_set_size (priv->filter_rows, 0);
+
+  /* we mark the index as valid before building it, in case the filter
+   * function queries the model; it will see the rows filtered so far
+   */
+  priv->filter_stamp = _clutter_model_get_filter_stamp (CLUTTER_MODEL (model));
+  priv->filter_valid = TRUE;
+
+  for (i = 0; i < priv->n_rows; i++)
+    {
+      guint index_ = clutter_mapped_model_sorted_to_index (model, i);
+
+      if (clutter_mapped_model_filter_index (model, index_,
+                                             priv->filter_rows->len))
+        g_array_append_val (priv->filter_rows, index_);
+    }
+
+  CLUTTER_NOTE (MISC, "Filtered %u rows out of %u",
+                priv->filter_rows->len,
+                priv->n_rows);
+}
+
+static guint
+clutter_mapped_model_get_n_visible (ClutterMappedModel *model)
+{
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    return model->priv->n_rows;
+
+  clutter_mapped_model_ensure_filter (model);
+
+  return model->priv->filter_rows->len;
+}
+
+/* maps a row of the sorted and filtered model to its position
+ * inside the file
+ */
+static guint
+clutter_mapped_model_row_to_index (ClutterMappedModel *model,
+                                   guint               row)
+{
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    return clutter_mapped_model_sorted_to_index (model, row);
+
+  clutter_mapped_model_ensure_filter (model);
+
+  return g_array_index (model->priv->filter_rows, guint, row);
+}
+
+static void
+clutter_mapped_model_warn_read_only (ClutterModel *model)
+{
+  g_warning ("%s: The model of type '%s' is read-only",
+             G_STRLOC,
+             G_OBJECT_TYPE_NAME (model));
+}
+
+/*
+ * ClutterMappedModelIter
+ */
+
+G_DEFINE_TYPE (ClutterMappedModelIter,
+               clutter_mapped_model_iter,
+               CLUTTER_TYPE_MODEL_ITER);
+
+static void
+clutter_mapped_model_iter_get_value (ClutterModelIter *iter,
+                                     guint             column,
+                                     GValue           *value)
+{
+  ClutterMappedModelIter *iter_mapped = CLUTTER_MAPPED_MODEL_ITER (iter);
+  ClutterModel *model = clutter_model_iter_get_model (iter);
+  GValue iter_value = G_VALUE_INIT;
+  GValue real_value = G_VALUE_INIT;
+
+  g_assert (iter_mapped->index < CLUTTER_MAPPED_MODEL (model)->priv->n_rows);
+
+  clutter_mapped_model_peek_value (CLUTTER_MAPPED_MODEL (model),
+                                   column,
+                                   iter_mapped->index,
+                                   &iter_value);
+
+  if (!g_type_is_a (G_VALUE_TYPE (value), G_VALUE_TYPE (&iter_value)))
+    {
+      if (!g_value_type_compatible (G_VALUE_TYPE (value),
+                                    G_VALUE_TYPE (&iter_value)) &&
+          !g_value_type_compatible (G_VALUE_TYPE (&iter_value),
+                                    G_VALUE_TYPE (value)))
+        {
+          g_warning ("%s: Unable to convert from %s to %s",
+                     G_STRLOC,
+                     g_type_name (G_VALUE_TYPE (value)),
+                     g_type_name (G_VALUE_TYPE (&iter_value)));
+          goto out;
+        }
+
+      g_value_init (&real_value, G_VALUE_TYPE (value));
+
+      if (!g_value_transform (&iter_value, &real_value))
+        {
+          g_warning ("%s: Unable to make conversion from %s to %s",
+                     G_STRLOC,
+                     g_type_name (G_VALUE_TYPE (value)),
+                     g_type_name (G_VALUE_TYPE (&iter_value)));
+          g_value_unset (&real_value);
+          goto out;
+        }
+
+      g_value_copy (&real_value, value);
+      g_value_unset (&real_value);
+    }
+  else
+    g_value_copy (&iter_value, value);
+
+out:
+  g_value_unset (&iter_value);
+}
+
+static void
+clutter_mapped_model_iter_set_value (ClutterModelIter *iter,
+                                     guint             column,
+                                     const GValue     *value)
+{
+  clutter_mapped_model_warn_read_only (clutter_model_iter_get_model (iter));
+}
+
+static gboolean
+clutter_mapped_model_iter_is_first (ClutterModelIter *iter)
+{
+  return clutter_model_iter_get_row (iter) == 0;
+}
+
+static gboolean
+clutter_mapped_model_iter_is_last (ClutterModelIter *iter)
+{
+  ClutterModel *model = clutter_model_iter_get_model (iter);
+  guint n_visible;
+
+  n_visible = clutter_mapped_model_get_n_visible (CLUTTER_MAPPED_MODEL (model));
+
+  return clutter_model_iter_get_row (iter) >= n_visible;
+}
+
+static ClutterModelIter *
+clutter_mapped_model_iter_next (ClutterModelIter *iter)
+{
+  ClutterMappedModelIter *iter_mapped = CLUTTER_MAPPED_MODEL_ITER (iter);
+  ClutterMappedModel *model;
+  guint row, n_visible;
+
+  model = CLUTTER_MAPPED_MODEL (clutter_model_iter_get_model (iter));
+  row = clutter_model_iter_get_row (iter) + 1;
+
+  n_visible = clutter_mapped_model_get_n_visible (model);
+  if (row < n_visible)
+    iter_mapped->index = clutter_mapped_model_row_to_index (model, row);
+  else
+    {
+      row = n_visible;
+      iter_mapped->index = model->priv->n_rows;
+    }
+
+  _clutter_model_iter_set_row (iter, row);
+
+  return iter;
+}
+
+static ClutterModelIter *
+clutter_mapped_model_iter_prev (ClutterModelIter *iter)
+{
+  ClutterMappedModelIter *iter_mapped = CLUTTER_MAPPED_MODEL_ITER (iter);
+  ClutterMappedModel *model;
+  guint row, n_visible;
+
+  model = CLUTTER_MAPPED_MODEL (clutter_model_iter_get_model (iter));
+  row = clutter_model_iter_get_row (iter);
+
+  n_visible = clutter_mapped_model_get_n_visible (model);
+  if (n_visible == 0)
+    return iter;
+
+  if (row > 0)
+    row -= 1;
+
+  row = MIN (row, n_visible - 1);
+
+  iter_mapped->index = clutter_mapped_model_row_to_index (model, row);
+  _clutter_model_iter_set_row (iter, row);
+
+  return iter;
+}
+
+static ClutterModelIter *
+clutter_mapped_model_iter_copy (ClutterModelIter *iter)
+{
+  ClutterMappedModelIter *iter_copy;
+
+  iter_copy = g_object_new (CLUTTER_TYPE_MAPPED_MODEL_ITER,
+                            "model", clutter_model_iter_get_model (iter),
+                            "row", clutter_model_iter_get_row (iter),
+                            NULL);
+
+  iter_copy->index = CLUTTER_MAPPED_MODEL_ITER (iter)->index;
+
+  return CLUTTER_MODEL_ITER (iter_copy);
+}
+
+static void
+clutter_mapped_model_iter_class_init (ClutterMappedModelIterClass *klass)
+{
+  ClutterModelIterClass *iter_class = CLUTTER_MODEL_ITER_CLASS (klass);
+
+  iter_class->get_value = clutter_mapped_model_iter_get_value;
+  iter_class->set_value = clutter_mapped_model_iter_set_value;
+  iter_class->is_first  = clutter_mapped_model_iter_is_first;
+  iter_class->is_last   = clutter_mapped_model_iter_is_last;
+  iter_class->next      = clutter_mapped_model_iter_next;
+  iter_class->prev      = clutter_mapped_model_iter_prev;
+  iter_class->copy      = clutter_mapped_model_iter_copy;
+}
+
+static void
+clutter_mapped_model_iter_init (ClutterMappedModelIter *iter)
+{
+  iter->index = 0;
+}
+
+/*
+ * ClutterMappedModel
+ */
+
+G_DEFINE_TYPE (ClutterMappedModel, clutter_mapped_model, CLUTTER_TYPE_MODEL);
+
+GQuark
+clutter_mapped_model_error_quark (void)
+{
+  return g_quark_from_static_string ("clutter-mapped-model-error-quark");
+}
+
+static ClutterModelIter *
+clutter_mapped_model_get_iter_at_row (ClutterModel *model,
+                                      guint         row)
+{
+  ClutterMappedModel *mapped_model = CLUTTER_MAPPED_MODEL (model);
+  ClutterMappedModelIter *retval;
+
+  if (row >= clutter_mapped_model_get_n_visible (mapped_model))
+    return NULL;
+
+  retval = g_object_new (CLUTTER_TYPE_MAPPED_MODEL_ITER,
+                         "model", model,
+                         "row", row,
+                         NULL);
+  retval->index = clutter_mapped_model_row_to_index (mapped_model, row);
+
+  return CLUTTER_MODEL_ITER (retval);
+}
+
+static ClutterModelIter *
+clutter_mapped_model_insert_row (ClutterModel *model,
+                                 gint          index_)
+{
+  clutter_mapped_model_warn_read_only (model);
+
+  return NULL;
+}
+
+static void
+clutter_mapped_model_remove_row (ClutterModel *model,
+                                 guint         row)
+{
+  clutter_mapped_model_warn_read_only (model);
+}
+
+static void
+clutter_mapped_model_clear (ClutterModel *model)
+{
+  clutter_mapped_model_warn_read_only (model);
+}
+
+typedef struct
+{
+  ClutterModel *model;
+  GValue *keys;
+  ClutterModelSortFunc func;
+  gpointer data;
+} SortClosure;
+
+static gint
+sort_model_mapped (gconstpointer a,
+                   gconstpointer b,
+                   gpointer      data)
+{
+  guint index_a = *((const guint *) a);
+  guint index_b = *((const guint *) b);
+  SortClosure *clos = data;
+
+  return clos->func (clos->model,
+                     &clos->keys[index_a],
+                     &clos->keys[index_b],
+                     clos->data);
+}
+
+static void
+clutter_mapped_model_resort (ClutterModel         *model,
+                             ClutterModelSortFunc  func,
+                             gpointer              data)
+{
+  ClutterMappedModel *mapped_model = CLUTTER_MAPPED_MODEL (model);
+  ClutterMappedModelPrivate *priv = mapped_model->priv;
+  SortClosure sort_closure = { NULL, NULL, NULL, NULL };
+  guint *order;
+  guint sort_column, i;
+
+  /* without a sorting function, the rows go back to the order of
+   * the file
+   */
+  if (func == NULL)
+    {
+      order = NULL;
+      goto out;
+    }
+
+  if (priv->n_rows < 2)
+    return;
+
+  sort_column = clutter_model_get_sorting_column (model);
+
+  /* the values of the sorting column are collected once, and the
+   * strings are not copied; the file itself is never modified, as
+   * we only sort the positions of the rows
+   */
+  sort_closure.model = model;
+  sort_closure.keys  = g_new0 (GValue, priv->n_rows);
+  sort_closure.func  = func;
+  sort_closure.data  = data;
+
+  order = g_new (guint, priv->n_rows);
+
+  for (i = 0; i < priv->n_rows; i++)
+    {
+      clutter_mapped_model_peek_value (mapped_model, sort_column, i,
+                                       &sort_closure.keys[i]);
+      order[i] = i;
+    }
+
+  g_qsort_with_data (order, priv->n_rows, sizeof (guint),
+                     sort_model_mapped,
+                     &sort_closure);
+
+  for (i = 0; i < priv->n_rows; i++)
+    g_value_unset (&sort_closure.keys[i]);
+
+  g_free (sort_closure.keys);
+
+out:
+  /* the filtered rows move with the rows, without calling the filter */
+  if (clutter_mapped_model_filter_is_valid (mapped_model))
+    {
+      GArray *filter_rows = priv->filter_rows;
+      guint8 *visible = g_new0 (guint8, priv->n_rows);
+
+      for (i = 0; i < filter_rows->len; i++)
+        visible[g_array_index (filter_rows, guint, i)] = TRUE;
+
+      g_array_set_size (filter_rows, 0);
+
+      for (i = 0; i < priv->n_rows; i++)
+        {
+          guint index_ = order != NULL ? order[i] : i;
+
+          if (visible[index_])
+            g_array_append_val (filter_rows, index_);
+        }
+
+      g_free (visible);
+    }
+
+  g_free (priv->order);
+  priv->order = order;
+}
+
+static guint
+clutter_mapped_model_get_n_rows (ClutterModel *model)
+{
+  return clutter_mapped_model_get_n_visible (CLUTTER_MAPPED_MODEL (model));
+}
+
+static void
+clutter_mapped_model_finalize (GObject *gobject)
+{
+  ClutterMappedModelPrivate *priv = CLUTTER_MAPPED_MODEL (gobject)->priv;
+
+  g_free (priv->columns);
+  g_free (priv->order);
+  g_array_free (priv->filter_rows, TRUE);
+
+  if (priv->file != NULL)
+    g_mapped_file_unref (priv->file);
+
+  G_OBJECT_CLASS (clutter_mapped_model_parent_class)->finalize (gobject);
+}
+
+static void
+clutter_mapped_model_dispose (GObject *gobject)
+{
+  ClutterMappedModelPrivate *priv = CLUTTER_MAPPED_MODEL (gobject)->priv;
+
+  if (priv->temp_iter != NULL)
+    {
+      g_object_unref (priv->temp_iter);
+      priv->temp_iter = NULL;
+    }
+
+  G_OBJECT_CLASS (clutter_mapped_model_parent_class)->dispose (gobject);
+}
+
+static void
+clutter_mapped_model_class_init (ClutterMappedModelClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  ClutterModelClass *model_class = CLUTTER_MODEL_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (ClutterMappedModelPrivate));
+
+  gobject_class->finalize = clutter_mapped_model_finalize;
+  gobject_class->dispose = clutter_mapped_model_dispose;
+
+  model_class->get_iter_at_row = clutter_mapped_model_get_iter_at_row;
+  model_class->insert_row      = clutter_mapped_model_insert_row;
+  model_class->remove_row      = clutter_mapped_model_remove_row;
+  model_class->resort          = clutter_mapped_model_resort;
+  model_class->get_n_rows      = clutter_mapped_model_get_n_rows;
+  model_class->clear           = clutter_mapped_model_clear;
+}
+
+static void
+clutter_mapped_model_init (ClutterMappedModel *model)
+{
+  model->priv = CLUTTER_MAPPED_MODEL_GET_PRIVATE (model);
+
+  model->priv->filter_rows = g_array_new (FALSE, FALSE, sizeof (guint));
+  model->priv->temp_iter = g_object_new (CLUTTER_TYPE_MAPPED_MODEL_ITER,
+                                         "model", model,
+                                         NULL);
+}
+
+static gboolean
+clutter_mapped_model_load (ClutterMappedModel  *model,
+                           const gchar         *filename,
+                           GError             **error)
+{
+  ClutterMappedModelPrivate *priv = model->priv;
+  const MappedHeader *header;
+  const MappedColumnHeader *column_headers;
+  const gchar *data;
+  gsize size;
+  guint32 strings_offset;
+  guint i;
+
+  priv->file = g_mapped_file_new (filename, FALSE, error);
+  if (priv->file == NULL)
+    return FALSE;
+
+  data = g_mapped_file_get_contents (priv->file);
+  size = g_mapped_file_get_length (priv->file);
+
+  /* the mapping is page aligned, so the fields can be read in place */
+  header = (const MappedHeader *) data;
+  if (size < sizeof (MappedHeader) ||
+      memcmp (header->magic, "CMDL", 4) != 0)
+    goto invalid;
+
+  if (GUINT32_FROM_LE (header->version) != MAPPED_MODEL_VERSION)
+    {
+      g_set_error (error, CLUTTER_MAPPED_MODEL_ERROR,
+                   CLUTTER_MAPPED_MODEL_ERROR_INVALID_DATA,
+                   "Unsupported version %u of the model in '%s'",
+                   GUINT32_FROM_LE (header->version),
+                   filename);
+      return FALSE;
+    }
+
+  priv->n_columns = GUINT32_FROM_LE (header->n_columns);
+  priv->n_rows = GUINT32_FROM_LE (header->n_rows);
+  strings_offset = GUINT32_FROM_LE (header->strings_offset);
+  priv->strings_size = GUINT32_FROM_LE (header->strings_size);
+
+  if (priv->n_columns == 0 ||
+      (guint64) priv->n_columns * sizeof (MappedColumnHeader) >
+        size - sizeof (MappedHeader))
+    goto invalid;
+
+  /* the string table must be terminated by a nul byte */
+  if (priv->strings_size == 0 ||
+      (guint64) strings_offset + priv->strings_size > size ||
+      data[strings_offset + priv->strings_size - 1] != '\0')
+    goto invalid;
+
+  priv->strings = data + strings_offset;
+
+  _clutter_model_set_n_columns (CLUTTER_MODEL (model), priv->n_columns,
+                                TRUE, TRUE);
+
+  priv->columns = g_new0 (MappedColumn, priv->n_columns);
+  column_headers = (const MappedColumnHeader *) (data + sizeof (MappedHeader));
+
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      guint32 kind = GUINT32_FROM_LE (column_headers[i].kind);
+      guint32 name = GUINT32_FROM_LE (column_headers[i].name);
+      guint32 cells_offset = GUINT32_FROM_LE (column_headers[i].cells_offset);
+      GType gtype;
+
+      switch (kind)
+        {
+        case COLUMN_INT:
+          gtype = G_TYPE_INT;
+          break;
+
+        case COLUMN_FLOAT:
+          gtype = G_TYPE_FLOAT;
+          break;
+
+        case COLUMN_STRING:
+          gtype = G_TYPE_STRING;
+          break;
+
+        default:
+          goto invalid;
+        }
+
+      if (name != MAPPED_MODEL_NULL && name >= priv->strings_size)
+        goto invalid;
+
+      if (cells_offset % sizeof (guint32) != 0 ||
+          (guint64) cells_offset + (guint64) priv->n_rows * sizeof (guint32) > size)
+        goto invalid;
+
+      priv->columns[i].kind = kind;
+      priv->columns[i].cells = (const guint32 *) (data + cells_offset);
+
+      /* check the strings once, instead of on each access */
+      if (kind == COLUMN_STRING)
+        {
+          guint row;
+
+          for (row = 0; row < priv->n_rows; row++)
+            {
+              guint32 offset = mapped_column_get_cell (&priv->columns[i], row);
+
+              if (offset != MAPPED_MODEL_NULL && offset >= priv->strings_size)
+                goto invalid;
+            }
+        }
+
+      _clutter_model_set_column_type (CLUTTER_MODEL (model), i, gtype);
+      _clutter_model_set_column_name (CLUTTER_MODEL (model), i,
+                                      clutter_mapped_model_get_string (model, name));
+    }
+
+  CLUTTER_NOTE (MISC, "Mapped a model of %u columns and %u rows from '%s'",
+                priv->n_columns,
+                priv->n_rows,
+                filename);
+
+  return TRUE;
+
+invalid:
+  g_set_error (error, CLUTTER_MAPPED_MODEL_ERROR,
+               CLUTTER_MAPPED_MODEL_ERROR_INVALID_DATA,
+               "The file '%s' does not contain a valid model",
+               filename);
+  return FALSE;
+}
+
+/**
+ * clutter_mapped_model_new:
+ * @filename: the path of a file containing the model
+ * @error: return location for a #GError, or %NULL
+ *
+ * Creates a new read-only model, mapping the rows stored inside
+ * @filename; see the description of #ClutterMappedModel for the
+ * format of the file.
+ *
+ * The file should not be modified while the model exists.
+ *
+ * Return value: (transfer full): a new #ClutterMappedModel, or %NULL
+ *   if the file could not be mapped, in which case @error is set
+ */
+ClutterModel *
+clutter_mapped_model_new (const gchar  *filename,
+                          GError      **error)
+{
+  ClutterMappedModel *model;
+
+  g_return_val_if_fail (filename != NULL, NULL);
+
+  model = g_object_new (CLUTTER_TYPE_MAPPED_MODEL, NULL);
+
+  if (!clutter_mapped_model_load (model, filename, error))
+    {
+      g_object_unref (model);
+      return NULL;
+    }
+
+  return CLUTTER_MODEL (model);
+}
+
+static const MappedColumn *
+clutter_mapped_model_iter_get_column (ClutterModelIter *iter,
+                                      guint             column,
+                                      ColumnKind        kind,
+                                      guint            *index_)
+{
+  ClutterMappedModelPrivate *priv;
+
+  priv = CLUTTER_MAPPED_MODEL (clutter_model_iter_get_model (iter))->priv;
+
+  *index_ = CLUTTER_MAPPED_MODEL_ITER (iter)->index;
+  if (*index_ >= priv->n_rows)
+    {
+      g_warning ("%s: The iterator does not point to a valid row",
+                 G_STRLOC);
+      return NULL;
+    }
+
+  if (column >= priv->n_columns)
+    return NULL;
+
+  if (priv->columns[column].kind != kind)
+    {
+      g_warning ("%s: The column %u of the model is of type '%s'",
+                 G_STRLOC, column,
+                 g_type_name (clutter_model_get_column_type (clutter_model_iter_get_model (iter),
+                                                             column)));
+      return NULL;
+    }
+
+  return &priv->columns[column];
+}
+
+/**
+ * clutter_mapped_model_iter_get_int:
+ * @iter: a #ClutterModelIter of a #ClutterMappedModel
+ * @column: a column of type %G_TYPE_INT
+ *
+ * Retrieves the value of @column for the row pointed by @iter,
+ * without copying it into a #GValue.
+ *
+ * Return value: the value of the cell
+ */
+gint
+clutter_mapped_model_iter_get_int (ClutterModelIter *iter,
+                                   guint             column)
+{
+  const MappedColumn *mapped_column;
+  guint index_;
+
+  g_return_val_if_fail (CLUTTER_IS_MAPPED_MODEL_ITER (iter), 0);
+
+  mapped_column = clutter_mapped_model_iter_get_column (iter, column,
+                                                        COLUMN_INT,
+                                                        &index_);
+  if (mapped_column == NULL)
+    return 0;
+
+  return mapped_column_get_int (mapped_column, index_);
+}
+
+/**
+ * clutter_mapped_model_iter_get_float:
+ * @iter: a #ClutterModelIter of a #ClutterMappedModel
+ * @column: a column of type %G_TYPE_FLOAT
+ *
+ * Retrieves the value of @column for the row pointed by @iter,
+ * without copying it into a #GValue.
+ *
+ * Return value: the value of the cell
+ */
+gfloat
+clutter_mapped_model_iter_get_float (ClutterModelIter *iter,
+                                     guint             column)
+{
+  const MappedColumn *mapped_column;
+  guint index_;
+
+  g_return_val_if_fail (CLUTTER_IS_MAPPED_MODEL_ITER (iter), 0.f);
+
+  mapped_column = clutter_mapped_model_iter_get_column (iter, column,
+                                                        COLUMN_FLOAT,
+                                                        &index_);
+  if (mapped_column == NULL)
+    return 0.f;
+
+  return mapped_column_get_float (mapped_column, index_);
+}
+
+/**
+ * clutter_mapped_model_iter_get_string:
+ * @iter: a #ClutterModelIter of a #ClutterMappedModel
+ * @column: a column of type %G_TYPE_STRING
+ *
+ * Retrieves the value of @column for the row pointed by @iter,
+ * without copying it.
+ *
+ * Return value: (transfer none): the string stored inside the file,
+ *   which is valid as long as the model, or %NULL
+ */
+const gchar *
+clutter_mapped_model_iter_get_string (ClutterModelIter *iter,
+                                      guint             column)
+{
+  const MappedColumn *mapped_column;
+  ClutterModel *model;
+  guint index_;
+
+  g_return_val_if_fail (CLUTTER_IS_MAPPED_MODEL_ITER (iter), NULL);
+
+  mapped_column = clutter_mapped_model_iter_get_column (iter, column,
+                                                        COLUMN_STRING,
+                                                        &index_);
+  if (mapped_column == NULL)
+    return NULL;
+
+  model = clutter_model_iter_get_model (iter);
+
+  return clutter_mapped_model_get_string (CLUTTER_MAPPED_MODEL (model),
+                                          mapped_column_get_cell (mapped_column,
+                                                                  index_));
+}
@@ -0,0 +1,102 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__CLUTTER_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <clutter/clutter.h> can be included directly."
+#endif
+
+#ifndef __CLUTTER_MAPPED_MODEL_H__
+#define __CLUTTER_MAPPED_MODEL_H__
+
+#include <clutter/clutter-model.h>
+
+G_BEGIN_DECLS
+
+#define CLUTTER_TYPE_MAPPED_MODEL               (clutter_mapped_model_get_type ())
+#define CLUTTER_MAPPED_MODEL(obj)               (G_TYPE_CHECK_INSTANCE_CAST ((obj), CLUTTER_TYPE_MAPPED_MODEL, ClutterMappedModel))
+#define CLUTTER_IS_MAPPED_MODEL(obj)            (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CLUTTER_TYPE_MAPPED_MODEL))
+#define CLUTTER_MAPPED_MODEL_CLASS(klass)       (G_TYPE_CHECK_CLASS_CAST ((klass), CLUTTER_TYPE_MAPPED_MODEL, ClutterMappedModelClass))
+#define CLUTTER_IS_MAPPED_MODEL_CLASS(klass)    (G_TYPE_CHECK_CLASS_TYPE ((klass), CLUTTER_TYPE_MAPPED_MODEL))
+#define CLUTTER_MAPPED_MODEL_GET_CLASS(obj)     (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_MAPPED_MODEL, ClutterMappedModelClass))
+
+/**
+ * CLUTTER_MAPPED_MODEL_ERROR:
+ *
+ * Error domain for the #ClutterMappedModelError enumeration.
+ */
+#define CLUTTER_MAPPED_MODEL_ERROR              (clutter_mapped_model_error_quark ())
+
+typedef struct _ClutterMappedModel              ClutterMappedModel;
+typedef struct _ClutterMappedModelPrivate       ClutterMappedModelPrivate;
+typedef struct _ClutterMappedModelClass         ClutterMappedModelClass;
+
+/**
+ * ClutterMappedModelError:
+ * @CLUTTER_MAPPED_MODEL_ERROR_INVALID_DATA: The file does not contain
+ *   a valid model
+ *
+ * Error enumeration for #ClutterMappedModel.
+ */
+typedef enum {
+  CLUTTER_MAPPED_MODEL_ERROR_INVALID_DATA
+} ClutterMappedModelError;
+
+/**
+ * ClutterMappedModel:
+ *
+ * The #ClutterMappedModel struct contains only private data.
+ */
+struct _ClutterMappedModel
+{
+  /*< private >*/
+  ClutterModel parent_instance;
+
+  ClutterMappedModelPrivate *priv;
+};
+
+/**
+ * ClutterMappedModelClass:
+ *
+ * The #ClutterMappedModelClass struct contains only private data.
+ */
+struct _ClutterMappedModelClass
+{
+  /*< private >*/
+  ClutterModelClass parent_class;
+};
+
+GQuark        clutter_mapped_model_error_quark (void);
+
+GType         clutter_mapped_model_get_type (void) G_GNUC_CONST;
+
+ClutterModel *clutter_mapped_model_new      (const gchar       *filename,
+                                             GError           **error);
+
+gint          clutter_mapped_model_iter_get_int         (ClutterModelIter *iter,
+                                                         guint             column);
+gfloat        clutter_mapped_model_iter_get_float       (ClutterModelIter *iter,
+                                                         guint             column);
+const gchar * clutter_mapped_model_iter_get_string      (ClutterModelIter *iter,
+                                                         guint             column);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_MAPPED_MODEL_H__ */
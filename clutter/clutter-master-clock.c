@@ -36,28 +36,36 @@
 #endif
 
 #include "clutter-master-clock.h"
+#include "clutter-backend-private.h"
 #include "clutter-debug.h"
 #include "clutter-private.h"
+#include "clutter-event-replay.h"
 #include "clutter-profile.h"
 #include "clutter-stage-manager-private.h"
 #include "clutter-stage-private.h"
+#include "clutter-trace.h"
+#include "clutter-transition.h"
 
 #define CLUTTER_MASTER_CLOCK_CLASS(klass)       (G_TYPE_CHECK_CLASS_CAST ((klass), CLUTTER_TYPE_MASTER_CLOCK, ClutterMasterClockClass))
 #define CLUTTER_IS_MASTER_CLOCK_CLASS(klass)    (G_TYPE_CHECK_CLASS_TYPE ((klass), CLUTTER_TYPE_MASTER_CLOCK))
 #define CLUTTER_MASTER_CLASS_GET_CLASS(obj)     (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_MASTER_CLOCK, ClutterMasterClockClass))
 
-#ifdef CLUTTER_ENABLE_DEBUG
-#define clutter_warn_if_over_budget(master_clock,start_time,section)    G_STMT_START  { \
-  gint64 __delta = g_get_monotonic_time () - start_time;                                \
-  gint64 __budget = master_clock->remaining_budget;                                     \
-  if (__budget > 0 && __delta >= __budget) {                                            \
-    _clutter_diagnostic_message ("%s took %" G_GINT64_FORMAT " microseconds "           \
-                                 "over a budget of %" G_GINT64_FORMAT " microseconds",  \
-                                 section, __delta, __budget);                           \
-  }                                                                     } G_STMT_END
-#else
-#define clutter_warn_if_over_budget(master_clock,start_time,section)
-#endif
+/* the phases of a frame, whose duration is measured to schedule
+ * the next frames
+ */
+typedef enum {
+  MASTER_CLOCK_PHASE_EVENTS,
+  MASTER_CLOCK_PHASE_TIMELINES,
+  MASTER_CLOCK_PHASE_UPDATE,
+
+  MASTER_CLOCK_N_PHASES
+} MasterClockPhase;
+
+static const char *phase_names[MASTER_CLOCK_N_PHASES] = {
+  "Event processing",
+  "Animations",
+  "Updating the stage",
+};
 
 typedef struct _ClutterClockSource              ClutterClockSource;
 typedef struct _ClutterMasterClockClass         ClutterMasterClockClass;
@@ -75,10 +83,42 @@ struct _ClutterMasterClock
   /* the previous state of the clock, in usecs, used to compute the delta */
   gint64 prev_tick;
 
-#ifdef CLUTTER_ENABLE_DEBUG
+  /* the time used to advance the timelines, in usecs: the predicted
+   * presentation time of the frame when the backend knows it, or the
+   * current state of the clock otherwise
+   */
+  gint64 frame_tick;
+
+  /* when replaying input as fast as possible, the virtual time of the
+   * frame, in usecs, and the amount it advances by at each dispatch;
+   * the replay interval is 0 otherwise
+   */
+  gint64 replay_tick;
+  gint64 replay_interval;
+
+  /* the timelines advanced by the current frame without emitting the
+   * ::new-frame signal, and the storage for their initial values, final
+   * values and progress, laid out as three contiguous arrays
+   */
+  GPtrArray *batch;
+  gdouble *batch_values;
+  guint batch_size;
+
+  /* the objects whose notifications are delayed until all the
+   * timelines have been advanced
+   */
+  GPtrArray *frozen;
+
+  /* the time available to a frame, in usecs; the duration of each
+   * phase of the last frame, and an estimate of the duration of each
+   * phase of the next frame, which follows the peaks immediately and
+   * decays slowly
+   */
   gint64 frame_budget;
-  gint64 remaining_budget;
-#endif
+  gint64 frame_start;
+  gint64 phase_start;
+  gint64 phase_duration[MASTER_CLOCK_N_PHASES];
+  gint64 phase_estimate[MASTER_CLOCK_N_PHASES];
 
   /* an idle source, used by the Master Clock to queue
    * a redraw on the stage and drive the animations
@@ -92,6 +132,12 @@ struct _ClutterMasterClock
    */
   guint idle : 1;
   guint ensure_next_iteration : 1;
+  guint in_advance : 1;
+
+  /* whether the timelines are advanced explicitly, using
+   * _clutter_master_clock_advance_to(), instead of by each frame
+   */
+  guint manual_advance : 1;
 };
 
 struct _ClutterMasterClockClass
@@ -142,7 +188,14 @@ master_clock_is_running (ClutterMasterClock *master_clock)
 
   stages = clutter_stage_manager_peek_stages (stage_manager);
 
-  if (master_clock->timelines)
+  if (master_clock->timelines && !master_clock->manual_advance)
+    return TRUE;
+
+  if (_clutter_threads_has_pending_tasks ())
+    return TRUE;
+
+  /* keep running until the idle work is done */
+  if (_clutter_has_repaint_functions (CLUTTER_REPAINT_FLAGS_IDLE))
     return TRUE;
 
   for (l = stages; l; l = l->next)
@@ -239,6 +292,140 @@ master_clock_list_ready_stages (ClutterMasterClock *master_clock)
   return g_slist_reverse (result);
 }
 
+/*
+ * master_clock_select_output_group:
+ * @master_clock: a #ClutterMasterClock
+ * @stages: (transfer full): the stages that are ready to be updated
+ *
+ * Stages on different outputs are presented at different vertical
+ * refreshes, so updating all of them with the same frame tick shows
+ * some of them ahead of their own presentation time. Each dispatch
+ * only updates the stages that are going to be presented within the
+ * same refresh as the earliest one; the other stages keep their update
+ * time, and are updated by the next dispatch, with a frame tick from
+ * their own presentation feedback.
+ *
+ * Return value: (transfer full): the stages to update in this dispatch
+ */
+static GSList *
+master_clock_select_output_group (ClutterMasterClock *master_clock,
+                                  GSList             *stages)
+{
+  gint64 earliest = -1;
+  gint64 tolerance = 0;
+  GSList *l, *result;
+
+  if (stages == NULL || stages->next == NULL)
+    return stages;
+
+  for (l = stages; l != NULL; l = l->next)
+    {
+      gint64 presentation_time = _clutter_stage_get_next_presentation_time (l->data);
+
+      if (presentation_time != -1 &&
+          (earliest == -1 || presentation_time < earliest))
+        {
+          earliest = presentation_time;
+          tolerance = _clutter_stage_get_refresh_interval (l->data) / 2;
+        }
+    }
+
+  if (earliest == -1)
+    return stages;
+
+  result = NULL;
+  for (l = stages; l != NULL; l = l->next)
+    {
+      gint64 presentation_time = _clutter_stage_get_next_presentation_time (l->data);
+
+      /* stages without presentation feedback follow the earliest output */
+      if (presentation_time == -1 || presentation_time - earliest <= tolerance)
+        result = g_slist_prepend (result, l->data);
+      else
+        {
+          CLUTTER_NOTE (SCHEDULER, "Deferring the update of stage %p "
+                        "to its own refresh", l->data);
+          g_object_unref (l->data);
+        }
+    }
+
+  g_slist_free (stages);
+
+  return g_slist_reverse (result);
+}
+
+/* whether any of the playing timelines needs to be updated on every
+ * frame, see ClutterTimeline:update-interval
+ */
+static gboolean
+master_clock_has_frame_rate_timelines (ClutterMasterClock *master_clock)
+{
+  GSList *l;
+
+  for (l = master_clock->timelines; l != NULL; l = l->next)
+    {
+      if (clutter_timeline_get_update_interval (l->data) == 0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*
+ * master_clock_get_coarse_delay:
+ * @master_clock: a #ClutterMasterClock
+ *
+ * Computes the delay before the next frame when all the playing
+ * timelines have a coarse update interval, and nothing else needs
+ * a new frame.
+ *
+ * Return value: the delay in milliseconds, or -1 if the frames should
+ *   be scheduled at the normal rate
+ */
+static gint
+master_clock_get_coarse_delay (ClutterMasterClock *master_clock)
+{
+  ClutterStageManager *stage_manager = clutter_stage_manager_get_default ();
+  const GSList *stages, *l;
+  gint64 now;
+  gint delay = -1;
+
+  if (master_clock->timelines == NULL ||
+      master_clock->replay_interval != 0 ||
+      master_clock_has_frame_rate_timelines (master_clock))
+    return -1;
+
+  if (master_clock->ensure_next_iteration)
+    {
+      master_clock->ensure_next_iteration = FALSE;
+      return -1;
+    }
+
+  stages = clutter_stage_manager_peek_stages (stage_manager);
+  for (l = stages; l != NULL; l = l->next)
+    {
+      if (_clutter_stage_has_queued_events (l->data) ||
+          _clutter_stage_needs_update (l->data))
+        return -1;
+    }
+
+  if (_clutter_threads_has_pending_tasks () ||
+      _clutter_has_repaint_functions (CLUTTER_REPAINT_FLAGS_IDLE))
+    return -1;
+
+  now = g_source_get_time (master_clock->source) / 1000;
+
+  for (l = master_clock->timelines; l != NULL; l = l->next)
+    {
+      gint timeline_delay = _clutter_timeline_get_update_delay (l->data, now);
+
+      if (delay == -1 || timeline_delay < delay)
+        delay = timeline_delay;
+    }
+
+  return delay;
+}
+
 static void
 master_clock_reschedule_stage_updates (ClutterMasterClock *master_clock,
                                        GSList             *stages)
@@ -250,14 +437,59 @@ master_clock_reschedule_stage_updates (ClutterMasterClock *master_clock,
       /* Clear the old update time */
       _clutter_stage_clear_update_time (l->data);
 
-      /* And if there is still work to be done, schedule a new one */
-      if (master_clock->timelines ||
+      /* And if there is still work to be done, schedule a new one; the
+       * timelines with a coarse update interval are scheduled by the
+       * master clock itself
+       */
+      if (master_clock_has_frame_rate_timelines (master_clock) ||
           _clutter_stage_has_queued_events (l->data) ||
           _clutter_stage_needs_update (l->data))
         _clutter_stage_schedule_update (l->data);
     }
 }
 
+/*
+ * master_clock_update_frame_tick:
+ * @master_clock: a #ClutterMasterClock
+ * @stages: the stages that are going to be updated
+ *
+ * Computes the time used to advance the timelines for the current
+ * frame. Using the time at which the frame is going to be presented,
+ * instead of the time at which we were dispatched, keeps the motion
+ * regular when the dispatch of the clock is delayed.
+ */
+static void
+master_clock_update_frame_tick (ClutterMasterClock *master_clock,
+                                GSList             *stages)
+{
+  gint64 frame_tick = -1;
+  GSList *l;
+
+  /* the replay clock does not depend on how long the frames take */
+  if (master_clock->replay_interval != 0)
+    {
+      master_clock->frame_tick = master_clock->replay_tick;
+      return;
+    }
+
+  for (l = stages; l != NULL; l = l->next)
+    {
+      gint64 presentation_time = _clutter_stage_get_next_presentation_time (l->data);
+
+      if (presentation_time != -1 &&
+          (frame_tick == -1 || presentation_time < frame_tick))
+        frame_tick = presentation_time;
+    }
+
+  if (frame_tick == -1)
+    frame_tick = master_clock->cur_tick;
+
+  /* switching between the predicted and the current time must not
+   * make the timelines go backwards
+   */
+  master_clock->frame_tick = MAX (frame_tick, master_clock->frame_tick);
+}
+
 /*
  * master_clock_next_frame_delay:
  * @master_clock: a #ClutterMasterClock
@@ -271,17 +503,31 @@ static gint
 master_clock_next_frame_delay (ClutterMasterClock *master_clock)
 {
   gint64 now, next;
-  gint swap_delay;
+  gint swap_delay, coarse_delay;
 
   if (!master_clock_is_running (master_clock))
     return -1;
 
+  /* slow animations only need a wakeup at their own rate */
+  coarse_delay = master_clock_get_coarse_delay (master_clock);
+  if (coarse_delay >= 0)
+    {
+      CLUTTER_NOTE (SCHEDULER, "Coarse timelines, waiting %d msecs",
+                    coarse_delay);
+
+      return coarse_delay;
+    }
+
   /* If all of the stages are busy waiting for a swap-buffers to complete
    * then we wait for one to be ready.. */
   swap_delay = master_clock_get_swap_wait_time (master_clock);
   if (swap_delay != 0)
     return swap_delay;
 
+  /* the replay clock runs the frames back to back */
+  if (master_clock->replay_interval != 0)
+    return 0;
+
   /* When we have sync-to-vblank, we count on swap-buffer requests (or
    * swap-buffer-complete events if supported in the backend) to throttle our
    * frame rate so no additional delay is needed to start the next frame.
@@ -344,15 +590,96 @@ master_clock_next_frame_delay (ClutterMasterClock *master_clock)
     }
 }
 
+static inline void
+master_clock_begin_phase (ClutterMasterClock *master_clock)
+{
+  master_clock->phase_start = g_get_monotonic_time ();
+}
+
+static inline void
+master_clock_end_phase (ClutterMasterClock *master_clock,
+                        MasterClockPhase    phase)
+{
+  gint64 duration = g_get_monotonic_time () - master_clock->phase_start;
+  gint64 estimate = master_clock->phase_estimate[phase];
+
+  master_clock->phase_duration[phase] = duration;
+
+  /* a frame that misses its deadline costs more than a frame that
+   * starts a bit too early, so we follow the peaks and decay slowly
+   */
+  if (duration >= estimate)
+    master_clock->phase_estimate[phase] = duration;
+  else
+    master_clock->phase_estimate[phase] = estimate - (estimate - duration) / 8;
+}
+
+/* the time available to a frame: the shortest refresh interval of the
+ * stages, or the interval of the default frame rate
+ */
+static gint64
+master_clock_get_frame_budget (ClutterMasterClock *master_clock)
+{
+  ClutterStageManager *stage_manager = clutter_stage_manager_get_default ();
+  const GSList *stages, *l;
+  gint64 budget = 0;
+
+  stages = clutter_stage_manager_peek_stages (stage_manager);
+
+  for (l = stages; l != NULL; l = l->next)
+    {
+      gint64 interval = _clutter_stage_get_refresh_interval (l->data);
+
+      if (interval > 0 && (budget == 0 || interval < budget))
+        budget = interval;
+    }
+
+  if (budget == 0)
+    budget = G_USEC_PER_SEC / _clutter_context_get_frame_rate ();
+
+  return budget;
+}
+
+/* reports the frames that took longer than the frame budget, with the
+ * duration of each phase
+ */
+static void
+master_clock_check_budget (ClutterMasterClock *master_clock)
+{
+  gint64 total = 0;
+  gint i;
+
+  for (i = 0; i < MASTER_CLOCK_N_PHASES; i++)
+    total += master_clock->phase_duration[i];
+
+  CLUTTER_NOTE (SCHEDULER,
+                "Frame took %" G_GINT64_FORMAT " microseconds "
+                "(budget: %" G_GINT64_FORMAT ", estimate: %" G_GINT64_FORMAT ")",
+                total,
+                master_clock->frame_budget,
+                _clutter_master_clock_get_frame_cost (master_clock));
+
+  if (total <= master_clock->frame_budget || !_clutter_diagnostic_enabled ())
+    return;
+
+  for (i = 0; i < MASTER_CLOCK_N_PHASES; i++)
+    {
+      _clutter_diagnostic_message ("%s took %" G_GINT64_FORMAT " microseconds "
+                                   "of a frame budget of %" G_GINT64_FORMAT " "
+                                   "microseconds, which was exceeded by %"
+                                   G_GINT64_FORMAT " microseconds",
+                                   phase_names[i],
+                                   master_clock->phase_duration[i],
+                                   master_clock->frame_budget,
+                                   total - master_clock->frame_budget);
+    }
+}
+
 static void
 master_clock_process_events (ClutterMasterClock *master_clock,
                              GSList             *stages)
 {
   GSList *l;
-#ifdef CLUTTER_ENABLE_DEBUG
-  gint64 start = g_get_monotonic_time ();
-#endif
-
   CLUTTER_STATIC_TIMER (master_event_process,
                         "Master Clock",
                         "Event Processing",
@@ -360,19 +687,99 @@ master_clock_process_events (ClutterMasterClock *master_clock,
                         0);
 
   CLUTTER_TIMER_START (_clutter_uprof_context, master_event_process);
+  CLUTTER_TRACE_BEGIN ("Event processing");
+
+  master_clock_begin_phase (master_clock);
 
   /* Process queued events */
   for (l = stages; l != NULL; l = l->next)
     _clutter_stage_process_queued_events (l->data);
 
+  master_clock_end_phase (master_clock, MASTER_CLOCK_PHASE_EVENTS);
+
+  CLUTTER_TRACE_END ();
   CLUTTER_TIMER_STOP (_clutter_uprof_context, master_event_process);
+}
+
+static void
+master_clock_thaw_notify (gpointer data)
+{
+  g_object_thaw_notify (data);
+  g_object_unref (data);
+}
 
-#ifdef CLUTTER_ENABLE_DEBUG
-  if (_clutter_diagnostic_enabled ())
-    clutter_warn_if_over_budget (master_clock, start, "Event processing");
+/*
+ * master_clock_flush_batch:
+ * @master_clock: a #ClutterMasterClock
+ *
+ * Computes and sets the values of the transitions advanced with
+ * _clutter_timeline_do_quiet_tick(); the interpolation is done in a
+ * single pass over the arrays of initial values, final values and
+ * progress, and the progress itself is only computed once for the
+ * transitions sharing it, like the ones started by the same easing
+ * state.
+ */
+static void
+master_clock_flush_batch (ClutterMasterClock *master_clock)
+{
+  GPtrArray *batch = master_clock->batch;
+  gdouble *initial, *final, *progress;
+  guint i, n_values;
 
-  master_clock->remaining_budget -= (g_get_monotonic_time () - start);
-#endif
+  if (batch->len == 0)
+    return;
+
+  if (master_clock->batch_size < batch->len)
+    {
+      g_free (master_clock->batch_values);
+
+      master_clock->batch_size = MAX (batch->len, master_clock->batch_size * 2);
+      master_clock->batch_values = g_new (gdouble, master_clock->batch_size * 3);
+    }
+
+  initial = master_clock->batch_values;
+  final = initial + master_clock->batch_size;
+  progress = final + master_clock->batch_size;
+
+  /* the timelines ticked after a batched one might have changed it */
+  for (i = 0, n_values = 0; i < batch->len; i++)
+    {
+      ClutterTimeline *timeline = g_ptr_array_index (batch, i);
+
+      if (!clutter_timeline_is_playing (timeline))
+        continue;
+
+      if (!_clutter_property_transition_get_direct_interval (timeline,
+                                                             &initial[n_values],
+                                                             &final[n_values]))
+        {
+          _clutter_timeline_emit_new_frame (timeline);
+          continue;
+        }
+
+      if (n_values > 0 &&
+          _clutter_timeline_shares_progress (g_ptr_array_index (batch, n_values - 1),
+                                             timeline))
+        progress[n_values] = progress[n_values - 1];
+      else
+        progress[n_values] = clutter_timeline_get_progress (timeline);
+
+      g_ptr_array_index (batch, n_values) = timeline;
+      n_values += 1;
+    }
+
+  for (i = 0; i < n_values; i++)
+    initial[i] += (final[i] - initial[i]) * progress[i];
+
+  for (i = 0; i < n_values; i++)
+    {
+      ClutterTimeline *timeline = g_ptr_array_index (batch, i);
+
+      _clutter_transition_freeze_notify (CLUTTER_TRANSITION (timeline));
+      _clutter_property_transition_set_direct_value (timeline, initial[i]);
+    }
+
+  g_ptr_array_set_size (batch, 0);
 }
 
 /*
@@ -387,10 +794,6 @@ static void
 master_clock_advance_timelines (ClutterMasterClock *master_clock)
 {
   GSList *timelines, *l;
-#ifdef CLUTTER_ENABLE_DEBUG
-  gint64 start = g_get_monotonic_time ();
-#endif
-
   CLUTTER_STATIC_TIMER (master_timeline_advance,
                         "Master Clock",
                         "Timelines Advancement",
@@ -421,49 +824,103 @@ master_clock_advance_timelines (ClutterMasterClock *master_clock)
   g_slist_foreach (timelines, (GFunc) g_object_ref, NULL);
 
   CLUTTER_TIMER_START (_clutter_uprof_context, master_timeline_advance);
+  CLUTTER_TRACE_BEGIN ("Timelines");
 
+  master_clock_begin_phase (master_clock);
+
+  master_clock->in_advance = TRUE;
+
+  /* the property transitions that only need their value computed are
+   * advanced without emitting ::new-frame, and their values are set
+   * all at once after every other timeline was advanced
+   */
   for (l = timelines; l != NULL; l = l->next)
-    _clutter_timeline_do_tick (l->data, master_clock->cur_tick / 1000);
+    {
+      ClutterTimeline *timeline = l->data;
+      gint64 tick_time = master_clock->frame_tick / 1000;
+      gdouble initial, final;
+
+      if (_clutter_property_transition_get_direct_interval (timeline,
+                                                            &initial,
+                                                            &final) &&
+          _clutter_timeline_do_quiet_tick (timeline, tick_time))
+        g_ptr_array_add (master_clock->batch, timeline);
+      else
+        _clutter_timeline_do_tick (timeline, tick_time);
+    }
+
+  master_clock_flush_batch (master_clock);
+
+  /* emits the notifications coalesced during this frame */
+  master_clock->in_advance = FALSE;
+  g_ptr_array_set_size (master_clock->frozen, 0);
 
+  CLUTTER_TRACE_END ();
   CLUTTER_TIMER_STOP (_clutter_uprof_context, master_timeline_advance);
 
   g_slist_foreach (timelines, (GFunc) g_object_unref, NULL);
   g_slist_free (timelines);
 
-#ifdef CLUTTER_ENABLE_DEBUG
-  if (_clutter_diagnostic_enabled ())
-    clutter_warn_if_over_budget (master_clock, start, "Animations");
-
-  master_clock->remaining_budget -= (g_get_monotonic_time () - start);
-#endif
+  master_clock_end_phase (master_clock, MASTER_CLOCK_PHASE_TIMELINES);
 }
 
 static gboolean
 master_clock_update_stages (ClutterMasterClock *master_clock,
                             GSList             *stages)
 {
+  ClutterBackend *backend = clutter_get_default_backend ();
+  ClutterStage *current_stage;
   gboolean stages_updated = FALSE;
+  GSList *repaint = NULL;
   GSList *l;
-#ifdef CLUTTER_ENABLE_DEBUG
-  gint64 start = g_get_monotonic_time ();
-#endif
+
+  master_clock_begin_phase (master_clock);
 
   _clutter_run_repaint_functions (CLUTTER_REPAINT_FLAGS_PRE_PAINT);
 
-  /* Update any stage that needs redraw/relayout after the clock
-   * is advanced.
+  /* Update the layout of every stage that needs a relayout after the
+   * clock is advanced, before painting any of them; the layout does
+   * not need a GL context, so all the painting happens in one batch
    */
   for (l = stages; l != NULL; l = l->next)
-    stages_updated |= _clutter_stage_do_update (l->data);
+    {
+      if (_clutter_stage_do_layout (l->data))
+        repaint = g_slist_prepend (repaint, l->data);
+    }
+
+  repaint = g_slist_reverse (repaint);
+
+  /* the stage painted last in the previous frame still holds the GL
+   * context, so we paint it first; this saves a context switch, and
+   * the viewport and projection setup that comes with it, per frame
+   */
+  current_stage = _clutter_backend_get_current_stage (backend);
+  l = g_slist_find (repaint, current_stage);
+  if (l != NULL && l != repaint)
+    {
+      repaint = g_slist_delete_link (repaint, l);
+      repaint = g_slist_prepend (repaint, current_stage);
+    }
+
+  for (l = repaint; l != NULL; l = l->next)
+    stages_updated |= _clutter_stage_do_repaint (l->data);
+
+  g_slist_free (repaint);
+
+  /* the offscreen targets are shared by all the stages, so they age
+   * once per frame, regardless of how many stages were painted
+   */
+  if (stages_updated)
+    _clutter_stage_expire_offscreen_pool ();
 
   _clutter_run_repaint_functions (CLUTTER_REPAINT_FLAGS_POST_PAINT);
 
-#ifdef CLUTTER_ENABLE_DEBUG
-  if (_clutter_diagnostic_enabled ())
-    clutter_warn_if_over_budget (master_clock, start, "Updating the stage");
+  master_clock_end_phase (master_clock, MASTER_CLOCK_PHASE_UPDATE);
 
-  master_clock->remaining_budget -= (g_get_monotonic_time () - start);
-#endif
+  /* the idle work uses what is left of the frame budget, and is not
+   * accounted as part of the frame
+   */
+  _clutter_run_repaint_functions (CLUTTER_REPAINT_FLAGS_IDLE);
 
   return stages_updated;
 }
@@ -554,6 +1011,7 @@ clutter_clock_dispatch (GSource     *source,
                         0);
 
   CLUTTER_TIMER_START (_clutter_uprof_context, master_dispatch_timer);
+  CLUTTER_TRACE_BEGIN ("Master clock dispatch");
 
   CLUTTER_NOTE (SCHEDULER, "Master clock [tick]");
 
@@ -562,18 +1020,25 @@ clutter_clock_dispatch (GSource     *source,
   /* Get the time to use for this frame */
   master_clock->cur_tick = g_source_get_time (source);
 
-#ifdef CLUTTER_ENABLE_DEBUG
-  master_clock->remaining_budget = master_clock->frame_budget;
-#endif
+  if (master_clock->replay_interval != 0)
+    master_clock->replay_tick += master_clock->replay_interval;
+
+  master_clock->frame_budget = master_clock_get_frame_budget (master_clock);
+  master_clock->frame_start = g_get_monotonic_time ();
 
   /* We need to protect ourselves against stages being destroyed during
    * event handling - master_clock_list_ready_stages() returns a
    * list of referenced that we'll unref afterwards.
    */
   stages = master_clock_list_ready_stages (master_clock);
+  stages = master_clock_select_output_group (master_clock, stages);
 
   master_clock->idle = FALSE;
 
+  /* the replayed events are queued before the events are processed */
+  if (G_UNLIKELY (_clutter_event_replay_active))
+    _clutter_event_replay_frame (master_clock);
+
   /* Each frame is split into three separate phases: */
 
   /* 1. process all the events; each stage goes through its events queue
@@ -583,11 +1048,32 @@ clutter_clock_dispatch (GSource     *source,
   master_clock_process_events (master_clock, stages);
 
   /* 2. advance the timelines */
-  master_clock_advance_timelines (master_clock);
+  if (!master_clock->manual_advance)
+    {
+      master_clock_update_frame_tick (master_clock, stages);
+      master_clock_advance_timelines (master_clock);
+    }
 
   /* 3. relayout and redraw the stages */
   stages_updated = master_clock_update_stages (master_clock, stages);
 
+  if (stages_updated)
+    {
+      GSList *l;
+
+      master_clock_check_budget (master_clock);
+
+      for (l = stages; l != NULL; l = l->next)
+        {
+          gint64 *phase_duration = master_clock->phase_duration;
+
+          _clutter_stage_emit_frame_stats (l->data,
+                                           master_clock->cur_tick,
+                                           phase_duration[MASTER_CLOCK_PHASE_EVENTS],
+                                           phase_duration[MASTER_CLOCK_PHASE_TIMELINES]);
+        }
+    }
+
   /* The master clock goes idle if no stages were updated and falls back
    * to polling for timeline progressions... */
   if (!stages_updated)
@@ -599,9 +1085,11 @@ clutter_clock_dispatch (GSource     *source,
   g_slist_free (stages);
 
   master_clock->prev_tick = master_clock->cur_tick;
+  master_clock->frame_start = 0;
 
   _clutter_threads_release_lock ();
 
+  CLUTTER_TRACE_END ();
   CLUTTER_TIMER_STOP (_clutter_uprof_context, master_dispatch_timer);
 
   return TRUE;
@@ -614,6 +1102,10 @@ clutter_master_clock_finalize (GObject *gobject)
 
   g_slist_free (master_clock->timelines);
 
+  g_ptr_array_unref (master_clock->batch);
+  g_ptr_array_unref (master_clock->frozen);
+  g_free (master_clock->batch_values);
+
   G_OBJECT_CLASS (clutter_master_clock_parent_class)->finalize (gobject);
 }
 
@@ -636,9 +1128,10 @@ clutter_master_clock_init (ClutterMasterClock *self)
   self->idle = FALSE;
   self->ensure_next_iteration = FALSE;
 
-#ifdef CLUTTER_ENABLE_DEBUG
+  self->batch = g_ptr_array_new ();
+  self->frozen = g_ptr_array_new_with_free_func (master_clock_thaw_notify);
+
   self->frame_budget = G_USEC_PER_SEC / 60;
-#endif
 
   g_source_set_priority (source, CLUTTER_PRIORITY_REDRAW);
   g_source_set_can_recurse (source, FALSE);
@@ -739,3 +1232,138 @@ _clutter_master_clock_ensure_next_iteration (ClutterMasterClock *master_clock)
 
   master_clock->ensure_next_iteration = TRUE;
 }
+
+/*
+ * _clutter_master_clock_freeze_notify_for_frame:
+ * @master_clock: a #ClutterMasterClock
+ * @gobject: a #GObject
+ *
+ * Freezes the notifications of @gobject until all the timelines have
+ * been advanced for the current frame. Outside of the advancement of
+ * the timelines, this function does nothing.
+ */
+void
+_clutter_master_clock_freeze_notify_for_frame (ClutterMasterClock *master_clock,
+                                               GObject            *gobject)
+{
+  g_return_if_fail (CLUTTER_IS_MASTER_CLOCK (master_clock));
+
+  if (!master_clock->in_advance)
+    return;
+
+  g_object_freeze_notify (gobject);
+  g_ptr_array_add (master_clock->frozen, g_object_ref (gobject));
+}
+
+/*
+ * _clutter_master_clock_get_frame_cost:
+ * @master_clock: a #ClutterMasterClock
+ *
+ * Estimates how long the next frame is going to take, from the
+ * duration of the phases of the previous frames.
+ *
+ * Return value: the estimated duration of a frame, in microseconds
+ */
+gint64
+_clutter_master_clock_get_frame_cost (ClutterMasterClock *master_clock)
+{
+  gint64 cost = 0;
+  gint i;
+
+  g_return_val_if_fail (CLUTTER_IS_MASTER_CLOCK (master_clock), 0);
+
+  for (i = 0; i < MASTER_CLOCK_N_PHASES; i++)
+    cost += master_clock->phase_estimate[i];
+
+  return cost;
+}
+
+/*
+ * _clutter_master_clock_get_remaining_budget:
+ * @master_clock: a #ClutterMasterClock
+ *
+ * Computes how much of the frame budget is left to the frame being
+ * processed.
+ *
+ * Return value: the remaining time, in microseconds, or 0 if the
+ *   budget has been exhausted or if no frame is being processed
+ */
+gint64
+_clutter_master_clock_get_remaining_budget (ClutterMasterClock *master_clock)
+{
+  gint64 elapsed;
+
+  g_return_val_if_fail (CLUTTER_IS_MASTER_CLOCK (master_clock), 0);
+
+  if (master_clock->frame_start == 0)
+    return 0;
+
+  elapsed = g_get_monotonic_time () - master_clock->frame_start;
+
+  return MAX (master_clock->frame_budget - elapsed, 0);
+}
+
+/*
+ * _clutter_master_clock_set_replay_interval:
+ * @master_clock: a #ClutterMasterClock
+ * @interval: the duration of a frame of the replay clock, in
+ *   microseconds, or 0 to use the real time
+ *
+ * Makes the master clock advance the timelines by @interval at each
+ * frame, regardless of the time the frames take, and run the frames
+ * without waiting; this makes the animations deterministic when the
+ * input of an application is replayed as fast as possible.
+ */
+void
+_clutter_master_clock_set_replay_interval (ClutterMasterClock *master_clock,
+                                           gint64              interval)
+{
+  g_return_if_fail (CLUTTER_IS_MASTER_CLOCK (master_clock));
+  g_return_if_fail (interval >= 0);
+
+  master_clock->replay_interval = interval;
+  master_clock->replay_tick = MAX (master_clock->frame_tick,
+                                   master_clock->cur_tick);
+}
+
+/*
+ * _clutter_master_clock_advance_to:
+ * @master_clock: a #ClutterMasterClock
+ * @frame_time: the time of the frame, in microseconds
+ *
+ * Advances all the timelines to @frame_time, and runs the stage
+ * updates queued from that point on without advancing the timelines
+ * any further; this is used to render the frames of offscreen stages
+ * at arbitrary times.
+ */
+void
+_clutter_master_clock_advance_to (ClutterMasterClock *master_clock,
+                                  gint64              frame_time)
+{
+  g_return_if_fail (CLUTTER_IS_MASTER_CLOCK (master_clock));
+
+  master_clock->manual_advance = TRUE;
+
+  /* a time before the previous frame makes the timelines drop the
+   * frame, see _clutter_timeline_do_tick()
+   */
+  master_clock->frame_tick = frame_time;
+  master_clock_advance_timelines (master_clock);
+}
+
+/*
+ * _clutter_master_clock_get_replay_tick:
+ * @master_clock: a #ClutterMasterClock
+ *
+ * Retrieves the time of the current frame of the replay clock set
+ * using _clutter_master_clock_set_replay_interval().
+ *
+ * Return value: the virtual time of the frame, in microseconds
+ */
+gint64
+_clutter_master_clock_get_replay_tick (ClutterMasterClock *master_clock)
+{
+  g_return_val_if_fail (CLUTTER_IS_MASTER_CLOCK (master_clock), 0);
+
+  return master_clock->replay_tick;
+}
@@ -43,12 +43,38 @@ void                    _clutter_master_clock_remove_timeline           (Clutter
                                                                          ClutterTimeline    *timeline);
 void                    _clutter_master_clock_start_running             (ClutterMasterClock *master_clock);
 void                    _clutter_master_clock_ensure_next_iteration     (ClutterMasterClock *master_clock);
+void                    _clutter_master_clock_freeze_notify_for_frame   (ClutterMasterClock *master_clock,
+                                                                         GObject            *gobject);
+gint64                  _clutter_master_clock_get_frame_cost            (ClutterMasterClock *master_clock);
+gint64                  _clutter_master_clock_get_remaining_budget      (ClutterMasterClock *master_clock);
+void                    _clutter_master_clock_set_replay_interval       (ClutterMasterClock *master_clock,
+                                                                         gint64              interval);
+gint64                  _clutter_master_clock_get_replay_tick           (ClutterMasterClock *master_clock);
+void                    _clutter_master_clock_advance_to                (ClutterMasterClock *master_clock,
+                                                                         gint64              frame_time);
 
 void                    _clutter_timeline_advance                       (ClutterTimeline    *timeline,
                                                                          gint64              tick_time);
 gint64                  _clutter_timeline_get_delta                     (ClutterTimeline    *timeline);
 void                    _clutter_timeline_do_tick                       (ClutterTimeline    *timeline,
                                                                          gint64              tick_time);
+gboolean                _clutter_timeline_do_quiet_tick                 (ClutterTimeline    *timeline,
+                                                                         gint64              tick_time);
+gboolean                _clutter_timeline_quiet_advance                 (ClutterTimeline    *timeline,
+                                                                         gint64              msecs);
+gint                    _clutter_timeline_get_update_delay              (ClutterTimeline    *timeline,
+                                                                         gint64              tick_time);
+gboolean                _clutter_timeline_shares_progress               (ClutterTimeline    *a,
+                                                                         ClutterTimeline    *b);
+void                    _clutter_timeline_emit_new_frame                (ClutterTimeline    *timeline);
+
+gboolean                _clutter_property_transition_get_direct_interval (ClutterTimeline   *timeline,
+                                                                          gdouble           *initial,
+                                                                          gdouble           *final);
+void                    _clutter_property_transition_set_direct_value    (ClutterTimeline   *timeline,
+                                                                          gdouble            value);
+
+void                    _clutter_transition_freeze_notify               (ClutterTransition  *transition);
 
 G_END_DECLS
 
@@ -0,0 +1,390 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+
+/*
+ * Memory accounting.
+ *
+ * Clutter keeps a count of the memory it allocates for the actors, the
+ * cached text layouts, the offscreen targets of the effects, the textures
+ * of the #ClutterImage and #ClutterCanvas contents and the events, which
+ * can be queried using clutter_get_memory_usage().
+ *
+ * The subsystems keeping caches that can be rebuilt register a purge
+ * function for each of their instances, which is called by
+ * clutter_purge_caches() when the application is asked to release
+ * memory.
+ *
+ * If Clutter has been compiled with debugging enabled, setting
+ * CLUTTER_DEBUG=memory prints a report of the memory still in use, and
+ * of the peak usage, when the application terminates.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "clutter-memory.h"
+
+#include "clutter-debug.h"
+#include "clutter-enum-types.h"
+#include "clutter-main.h"
+#include "clutter-private.h"
+
+#define N_CATEGORIES    (CLUTTER_MEMORY_EVENTS + 1)
+
+typedef struct _MemoryCounter
+{
+  volatile gssize bytes;
+  volatile gint n_objects;
+
+  /* updated without locking, so it is only an approximation */
+  gssize peak_bytes;
+} MemoryCounter;
+
+typedef struct _TrackedTexture
+{
+  ClutterMemoryCategory category;
+  gssize bytes;
+} TrackedTexture;
+
+typedef struct _PurgeFunc
+{
+  ClutterMemoryCategory category;
+  ClutterPurgeFunc func;
+} PurgeFunc;
+
+static MemoryCounter counters[N_CATEGORIES];
+
+/* instance -> PurgeFunc */
+static GHashTable *purge_funcs = NULL;
+
+static CoglUserDataKey tracked_texture_key;
+
+static void
+clutter_memory_print_report (void)
+{
+  GEnumClass *enum_class;
+  gint i;
+
+  enum_class = g_type_class_ref (CLUTTER_TYPE_MEMORY_CATEGORY);
+
+  g_print ("Clutter memory usage:\n");
+  g_print ("  %-20s %12s %12s %10s\n", "category", "bytes", "peak", "objects");
+
+  for (i = 0; i < N_CATEGORIES; i++)
+    {
+      GEnumValue *value = g_enum_get_value (enum_class, i);
+
+      g_print ("  %-20s %12" G_GSSIZE_FORMAT " %12" G_GSSIZE_FORMAT " %10d\n",
+               value != NULL ? value->value_nick : "unknown",
+               counters[i].bytes,
+               counters[i].peak_bytes,
+               counters[i].n_objects);
+    }
+
+  g_type_class_unref (enum_class);
+}
+
+/*< private >
+ * _clutter_memory_init:
+ *
+ * Installs the report printed at exit by CLUTTER_DEBUG=memory.
+ */
+void
+_clutter_memory_init (void)
+{
+  static gboolean initialized = FALSE;
+
+  if (initialized)
+    return;
+
+  g_atexit (clutter_memory_print_report);
+  initialized = TRUE;
+}
+
+/*< private >
+ * _clutter_memory_account:
+ * @category: the subsystem owning the memory
+ * @bytes: the number of bytes allocated, or negative if released
+ * @n_objects: the number of objects created, or negative if destroyed
+ *
+ * Updates the counters of @category. This function can be called
+ * from any thread.
+ */
+void
+_clutter_memory_account (ClutterMemoryCategory category,
+                         gssize                bytes,
+                         gint                  n_objects)
+{
+  MemoryCounter *counter;
+  gssize total;
+
+  g_return_if_fail (category < N_CATEGORIES);
+
+  counter = &counters[category];
+
+  total = (gssize) g_atomic_pointer_add (&counter->bytes, bytes) + bytes;
+  if (n_objects != 0)
+    g_atomic_int_add (&counter->n_objects, n_objects);
+
+  if (total > counter->peak_bytes)
+    counter->peak_bytes = total;
+}
+
+static void
+tracked_texture_free (gpointer data)
+{
+  TrackedTexture *tracked = data;
+
+  _clutter_memory_account (tracked->category, -tracked->bytes, -1);
+
+  g_slice_free (TrackedTexture, tracked);
+}
+
+/*< private >
+ * _clutter_memory_track_texture:
+ * @category: the subsystem owning the texture
+ * @texture: a #CoglTexture
+ *
+ * Accounts the storage of @texture to @category until the texture
+ * is destroyed; the storage is estimated from the size of the texture,
+ * assuming 32 bits per pixel. Textures already tracked are ignored.
+ */
+void
+_clutter_memory_track_texture (ClutterMemoryCategory category,
+                               CoglHandle            texture)
+{
+  TrackedTexture *tracked;
+
+  if (texture == NULL)
+    return;
+
+  if (cogl_object_get_user_data (COGL_OBJECT (texture),
+                                 &tracked_texture_key) != NULL)
+    return;
+
+  tracked = g_slice_new (TrackedTexture);
+  tracked->category = category;
+  tracked->bytes = (gssize) cogl_texture_get_width (texture)
+                 * (gssize) cogl_texture_get_height (texture)
+                 * 4;
+
+  cogl_object_set_user_data (COGL_OBJECT (texture),
+                             &tracked_texture_key,
+                             tracked,
+                             tracked_texture_free);
+
+  _clutter_memory_account (category, tracked->bytes, 1);
+}
+
+/**
+ * clutter_get_memory_usage:
+ * @category: a #ClutterMemoryCategory
+ * @n_objects: (out) (allow-none): return location for the number of
+ *   objects accounted to @category, or %NULL
+ *
+ * Retrieves the memory currently used by a subsystem of Clutter.
+ *
+ * If Clutter has been compiled with debugging enabled, setting the
+ * CLUTTER_DEBUG environment variable to "memory" prints the usage of
+ * every subsystem when the application terminates.
+ *
+ * The figures only include the memory allocated by Clutter itself:
+ * the storage of the textures is an estimate, and the memory used
+ * internally by Pango and by the GPU drivers is not included.
+ *
+ * Return value: the number of bytes accounted to @category
+ */
+gsize
+clutter_get_memory_usage (ClutterMemoryCategory  category,
+                          guint                 *n_objects)
+{
+  g_return_val_if_fail (category < N_CATEGORIES, 0);
+
+  if (n_objects != NULL)
+    *n_objects = MAX (g_atomic_int_get (&counters[category].n_objects), 0);
+
+  return MAX ((gssize) g_atomic_pointer_get (&counters[category].bytes), 0);
+}
+
+static void
+purge_func_free (gpointer data)
+{
+  g_slice_free (PurgeFunc, data);
+}
+
+/*< private >
+ * _clutter_memory_add_purge_func:
+ * @category: the subsystem owning the caches of @instance
+ * @instance: the object keeping the caches
+ * @func: the function releasing the caches of @instance
+ *
+ * Registers @func, so that clutter_purge_caches() can release the
+ * caches of @instance; every instance has at most one purge function.
+ * The function must be removed using _clutter_memory_remove_purge_func()
+ * before @instance is destroyed.
+ */
+void
+_clutter_memory_add_purge_func (ClutterMemoryCategory category,
+                                gpointer              instance,
+                                ClutterPurgeFunc      func)
+{
+  PurgeFunc *purge;
+
+  g_return_if_fail (category < N_CATEGORIES);
+  g_return_if_fail (instance != NULL);
+  g_return_if_fail (func != NULL);
+
+  if (purge_funcs == NULL)
+    purge_funcs = g_hash_table_new_full (NULL, NULL, NULL, purge_func_free);
+
+  purge = g_slice_new (PurgeFunc);
+  purge->category = category;
+  purge->func = func;
+
+  g_hash_table_replace (purge_funcs, instance, purge);
+}
+
+/*< private >
+ * _clutter_memory_remove_purge_func:
+ * @instance: the object passed to _clutter_memory_add_purge_func()
+ *
+ * Removes the purge function of @instance, if any.
+ */
+void
+_clutter_memory_remove_purge_func (gpointer instance)
+{
+  if (purge_funcs == NULL)
+    return;
+
+  g_hash_table_remove (purge_funcs, instance);
+}
+
+static gint
+compare_category_usage (gconstpointer a,
+                        gconstpointer b,
+                        gpointer      user_data)
+{
+  gsize usage_a = clutter_get_memory_usage (*(const gint *) a, NULL);
+  gsize usage_b = clutter_get_memory_usage (*(const gint *) b, NULL);
+
+  if (usage_a > usage_b)
+    return -1;
+
+  if (usage_a < usage_b)
+    return 1;
+
+  return 0;
+}
+
+/**
+ * clutter_purge_caches:
+ * @level: a #ClutterPurgeLevel
+ *
+ * Releases the memory held by the caches of Clutter that can be
+ * rebuilt when needed, like the text layouts, the offscreen targets
+ * of the effects, the textures of the images that are not shown, the
+ * buffers of the #ClutterCanvas contents and the glyph cache.
+ *
+ * This function is meant to be called when the system is running low
+ * on memory. The contents shown on screen are preserved, though the
+ * frames painted after purging the caches of the visible actors, using
+ * %CLUTTER_PURGE_LEVEL_CRITICAL, take longer to render.
+ *
+ * The subsystems using the most memory, as reported by
+ * clutter_get_memory_usage(), are purged first.
+ *
+ * This function must not be called while painting.
+ */
+void
+clutter_purge_caches (ClutterPurgeLevel level)
+{
+  gint order[N_CATEGORIES];
+  GPtrArray *instances;
+  gint i;
+
+  g_return_if_fail (level <= CLUTTER_PURGE_LEVEL_CRITICAL);
+
+  for (i = 0; i < N_CATEGORIES; i++)
+    order[i] = i;
+
+  g_qsort_with_data (order, N_CATEGORIES, sizeof (gint),
+                     compare_category_usage,
+                     NULL);
+
+  instances = g_ptr_array_new ();
+
+  for (i = 0; i < N_CATEGORIES; i++)
+    {
+      GHashTableIter iter;
+      gpointer key, value;
+      gsize before;
+      guint j;
+
+      if (purge_funcs == NULL)
+        break;
+
+      /* the purge functions might end up removing other instances,
+       * so we collect them before calling any of them
+       */
+      g_ptr_array_set_size (instances, 0);
+
+      g_hash_table_iter_init (&iter, purge_funcs);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+          PurgeFunc *purge = value;
+
+          if (purge->category == order[i])
+            g_ptr_array_add (instances, key);
+        }
+
+      before = clutter_get_memory_usage (order[i], NULL);
+
+      for (j = 0; j < instances->len; j++)
+        {
+          gpointer instance = g_ptr_array_index (instances, j);
+          PurgeFunc *purge = g_hash_table_lookup (purge_funcs, instance);
+
+          if (purge != NULL)
+            purge->func (instance, level);
+        }
+
+      CLUTTER_NOTE (MISC, "Purged %u caches of category %d: "
+                    "%" G_GSIZE_FORMAT " bytes released",
+                    instances->len,
+                    order[i],
+                    before - MIN (before,
+                                  clutter_get_memory_usage (order[i], NULL)));
+    }
+
+  g_ptr_array_free (instances, TRUE);
+
+  /* the text layouts have all been released by now, so the glyphs
+   * are uploaded again as the layouts are recreated
+   */
+  if (level >= CLUTTER_PURGE_LEVEL_CRITICAL)
+    {
+      ClutterMainContext *context = _clutter_context_get_default ();
+
+      if (context->font_map != NULL)
+        cogl_pango_font_map_clear_glyph_cache (context->font_map);
+    }
+}
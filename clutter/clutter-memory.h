@@ -0,0 +1,54 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_MEMORY_H__
+#define __CLUTTER_MEMORY_H__
+
+#include <cogl/cogl.h>
+#include <clutter/clutter-types.h>
+
+G_BEGIN_DECLS
+
+void    _clutter_memory_init            (void);
+void    _clutter_memory_account         (ClutterMemoryCategory  category,
+                                         gssize                 bytes,
+                                         gint                   n_objects);
+void    _clutter_memory_track_texture   (ClutterMemoryCategory  category,
+                                         CoglHandle             texture);
+
+/*< private >
+ * ClutterPurgeFunc:
+ * @instance: the instance passed to _clutter_memory_add_purge_func()
+ * @level: the #ClutterPurgeLevel requested
+ *
+ * Releases the caches of @instance allowed by @level.
+ */
+typedef void (* ClutterPurgeFunc) (gpointer          instance,
+                                   ClutterPurgeLevel level);
+
+void    _clutter_memory_add_purge_func          (ClutterMemoryCategory  category,
+                                                 gpointer               instance,
+                                                 ClutterPurgeFunc       func);
+void    _clutter_memory_remove_purge_func       (gpointer               instance);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_MEMORY_H__ */
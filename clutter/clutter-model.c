@@ -192,6 +192,8 @@ enum
 
   SORT_CHANGED,
   FILTER_CHANGED,
+
+  ROWS_CHANGED,
   
   LAST_SIGNAL
 };
@@ -219,6 +221,7 @@ struct _ClutterModelPrivate
   ClutterModelFilterFunc  filter_func;
   gpointer                filter_data;
   GDestroyNotify          filter_notify;
+  guint                   filter_stamp;
 
   gint                    sort_column;
   ClutterModelSortFunc    sort_func;
@@ -290,6 +293,23 @@ clutter_model_real_get_n_rows (ClutterModel *model)
   return row_count;
 }
 
+static void
+clutter_model_real_clear (ClutterModel *model)
+{
+  ClutterModelClass *klass = CLUTTER_MODEL_GET_CLASS (model);
+  guint n_rows;
+
+  if (klass->remove_row == NULL)
+    return;
+
+  /* implementations should override this, as the rows are removed
+   * one by one, and the rows hidden by the filter are kept
+   */
+  n_rows = clutter_model_get_n_rows (model);
+  while (n_rows-- > 0)
+    klass->remove_row (model, n_rows);
+}
+
 static void 
 clutter_model_finalize (GObject *object)
 {
@@ -353,6 +373,7 @@ clutter_model_class_init (ClutterModelClass *klass)
   klass->get_column_type  = clutter_model_real_get_column_type;
   klass->get_n_columns    = clutter_model_real_get_n_columns;
   klass->get_n_rows       = clutter_model_real_get_n_rows;
+  klass->clear            = clutter_model_real_clear;
 
   /**
    * ClutterModel:filter-set:
@@ -463,6 +484,33 @@ clutter_model_class_init (ClutterModelClass *klass)
                   NULL, NULL,
                   _clutter_marshal_VOID__VOID,
                   G_TYPE_NONE, 0);
+  /**
+   * ClutterModel::rows-changed:
+   * @model: the #ClutterModel on which the signal is emitted
+   * @position: the first row that changed
+   * @n_removed: the number of rows removed starting from @position
+   * @n_added: the number of rows added starting from @position
+   *
+   * The ::rows-changed signal is emitted when a range of rows has been
+   * replaced at once, using clutter_model_append_rows() or
+   * clutter_model_replace_all().
+   *
+   * The #ClutterModel::row-added and #ClutterModel::row-removed signals
+   * are not emitted for the rows in the range, so handlers should update
+   * every row from @position to @position + @n_added using the current
+   * contents of the model.
+   */
+  model_signals[ROWS_CHANGED] =
+    g_signal_new ("rows-changed",
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  G_STRUCT_OFFSET (ClutterModelClass, rows_changed),
+                  NULL, NULL,
+                  _clutter_marshal_VOID__UINT_UINT_UINT,
+                  G_TYPE_NONE, 3,
+                  G_TYPE_UINT,
+                  G_TYPE_UINT,
+                  G_TYPE_UINT);
 }
 
 static void
@@ -785,6 +833,25 @@ clutter_model_resort (ClutterModel *model)
     klass->resort (model, priv->sort_func, priv->sort_data);
 }
 
+/* keeps the model sorted after the value of the sorting column
+ * of the row pointed by @iter changed
+ */
+static void
+clutter_model_resort_row (ClutterModel     *model,
+                          ClutterModelIter *iter)
+{
+  ClutterModelPrivate *priv = model->priv;
+  ClutterModelClass *klass = CLUTTER_MODEL_GET_CLASS (model);
+
+  if (klass->resort_row == NULL || priv->sort_func == NULL)
+    {
+      clutter_model_resort (model);
+      return;
+    }
+
+  klass->resort_row (model, iter, priv->sort_func, priv->sort_data);
+}
+
 /**
  * clutter_model_filter_row:
  * @model: a #ClutterModel
@@ -1066,10 +1133,13 @@ clutter_model_appendv (ClutterModel *model,
       clutter_model_iter_set_value (iter, columns[i], &values[i]);
     }
 
-  g_signal_emit (model, model_signals[ROW_ADDED], 0, iter);
-
+  /* the row is in its final position when ::row-added is emitted,
+   * like in clutter_model_append()
+   */
   if (resort)
-    clutter_model_resort (model);
+    clutter_model_resort_row (model, iter);
+
+  g_signal_emit (model, model_signals[ROW_ADDED], 0, iter);
 
   g_object_unref (iter);
 }
@@ -1160,10 +1230,10 @@ clutter_model_prependv (ClutterModel *model,
       clutter_model_iter_set_value (iter, columns[i], &values[i]);
     }
 
-  g_signal_emit (model, model_signals[ROW_ADDED], 0, iter);
-
   if (resort)
-    clutter_model_resort (model);
+    clutter_model_resort_row (model, iter);
+
+  g_signal_emit (model, model_signals[ROW_ADDED], 0, iter);
 
   g_object_unref (iter);
 }
@@ -1298,10 +1368,10 @@ clutter_model_insertv (ClutterModel *model,
       clutter_model_iter_set_value (iter, columns[i], &values[i]);
     }
 
-  g_signal_emit (model, model_signals[ROW_ADDED], 0, iter);
-
   if (resort)
-    clutter_model_resort (model);
+    clutter_model_resort_row (model, iter);
+
+  g_signal_emit (model, model_signals[ROW_ADDED], 0, iter);
 
   g_object_unref (iter);
 }
@@ -1346,12 +1416,12 @@ clutter_model_insert_value (ClutterModel *model,
 
   clutter_model_iter_set_value (iter, column, value);
 
+  if (priv->sort_column == column)
+    clutter_model_resort_row (model, iter);
+
   if (added)
     g_signal_emit (model, model_signals[ROW_ADDED], 0, iter);
 
-  if (priv->sort_column == column)
-    clutter_model_resort (model);
-
   g_object_unref (iter);
 }
 
@@ -1377,6 +1447,146 @@ clutter_model_remove (ClutterModel *model,
     klass->remove_row (model, row);
 }
 
+/* appends @n_rows rows without emitting signals; returns whether the
+ * model should be sorted again
+ */
+static gboolean
+clutter_model_insert_rows_internal (ClutterModel *model,
+                                    guint         n_rows,
+                                    guint         n_columns,
+                                    guint        *columns,
+                                    GValue       *values)
+{
+  ClutterModelClass *klass = CLUTTER_MODEL_GET_CLASS (model);
+  ClutterModelPrivate *priv = model->priv;
+  gboolean resort = FALSE;
+  guint i, j;
+
+  if (n_rows == 0)
+    return FALSE;
+
+  for (i = 0; i < n_columns; i++)
+    {
+      if (priv->sort_column == columns[i])
+        resort = TRUE;
+    }
+
+  for (i = 0; i < n_rows; i++)
+    {
+      GValue *row_values = values + (i * n_columns);
+      ClutterModelIter *iter;
+
+      iter = klass->insert_row (model, -1);
+      g_assert (CLUTTER_IS_MODEL_ITER (iter));
+
+      for (j = 0; j < n_columns; j++)
+        CLUTTER_MODEL_ITER_GET_CLASS (iter)->set_value (iter,
+                                                        columns[j],
+                                                        &row_values[j]);
+
+      g_object_unref (iter);
+    }
+
+  return resort;
+}
+
+/**
+ * clutter_model_append_rows:
+ * @model: a #ClutterModel
+ * @n_rows: the number of rows to append
+ * @n_columns: the number of columns to set for each row
+ * @columns: (array length=n_columns): a vector with the columns to set
+ * @values: (array): a vector with @n_rows times @n_columns values, with
+ *   the values of each row following the values of the previous one
+ *
+ * Appends @n_rows rows to @model, setting the values for the given
+ * @columns upon creation.
+ *
+ * Unlike calling clutter_model_appendv() for each row, this function
+ * sorts @model at most once, and emits a single #ClutterModel::rows-changed
+ * signal instead of emitting #ClutterModel::row-added for each row.
+ */
+void
+clutter_model_append_rows (ClutterModel *model,
+                           guint         n_rows,
+                           guint         n_columns,
+                           guint        *columns,
+                           GValue       *values)
+{
+  guint old_n_rows, new_n_rows;
+
+  g_return_if_fail (CLUTTER_IS_MODEL (model));
+  g_return_if_fail (n_columns <= clutter_model_get_n_columns (model));
+  g_return_if_fail (n_rows == 0 || columns != NULL);
+  g_return_if_fail (n_rows == 0 || values != NULL);
+
+  if (n_rows == 0)
+    return;
+
+  old_n_rows = clutter_model_get_n_rows (model);
+
+  if (clutter_model_insert_rows_internal (model, n_rows,
+                                          n_columns, columns,
+                                          values))
+    {
+      clutter_model_resort (model);
+
+      new_n_rows = clutter_model_get_n_rows (model);
+      g_signal_emit (model, model_signals[ROWS_CHANGED], 0,
+                     0, old_n_rows, new_n_rows);
+    }
+  else
+    {
+      new_n_rows = clutter_model_get_n_rows (model);
+      g_signal_emit (model, model_signals[ROWS_CHANGED], 0,
+                     old_n_rows, 0, new_n_rows - old_n_rows);
+    }
+}
+
+/**
+ * clutter_model_replace_all:
+ * @model: a #ClutterModel
+ * @n_rows: the number of rows of the new contents
+ * @n_columns: the number of columns to set for each row
+ * @columns: (array length=n_columns): a vector with the columns to set
+ * @values: (array): a vector with @n_rows times @n_columns values, with
+ *   the values of each row following the values of the previous one
+ *
+ * Removes all the rows of @model, and replaces them with @n_rows rows
+ * holding the passed @values.
+ *
+ * This function sorts @model at most once, and emits a single
+ * #ClutterModel::rows-changed signal instead of emitting the
+ * #ClutterModel::row-removed and #ClutterModel::row-added signals
+ * for each row.
+ */
+void
+clutter_model_replace_all (ClutterModel *model,
+                           guint         n_rows,
+                           guint         n_columns,
+                           guint        *columns,
+                           GValue       *values)
+{
+  guint old_n_rows;
+
+  g_return_if_fail (CLUTTER_IS_MODEL (model));
+  g_return_if_fail (n_columns <= clutter_model_get_n_columns (model));
+  g_return_if_fail (n_rows == 0 || columns != NULL);
+  g_return_if_fail (n_rows == 0 || values != NULL);
+
+  old_n_rows = clutter_model_get_n_rows (model);
+
+  CLUTTER_MODEL_GET_CLASS (model)->clear (model);
+
+  if (clutter_model_insert_rows_internal (model, n_rows,
+                                          n_columns, columns,
+                                          values))
+    clutter_model_resort (model);
+
+  g_signal_emit (model, model_signals[ROWS_CHANGED], 0,
+                 0, old_n_rows, clutter_model_get_n_rows (model));
+}
+
 /**
  * clutter_model_get_column_name:
  * @model: #ClutterModel
@@ -1708,6 +1918,7 @@ clutter_model_set_filter (ClutterModel           *model,
   priv->filter_func = func;
   priv->filter_data = user_data;
   priv->filter_notify = notify;
+  priv->filter_stamp += 1;
 
   g_signal_emit (model, model_signals[FILTER_CHANGED], 0);
   g_object_notify (G_OBJECT (model), "filter-set");
@@ -1732,6 +1943,80 @@ clutter_model_get_filter_set (ClutterModel *model)
   return model->priv->filter_func != NULL;
 }
 
+/*< private >
+ * _clutter_model_get_filter_stamp:
+ * @model: a #ClutterModel
+ *
+ * Retrieves a counter that changes every time the filter of @model
+ * is set, so that implementations caching the result of the filter
+ * can know when to discard it.
+ *
+ * Return value: the filter counter
+ */
+guint
+_clutter_model_get_filter_stamp (ClutterModel *model)
+{
+  return model->priv->filter_stamp;
+}
+
+/*< private >
+ * _clutter_model_set_filter_func:
+ * @model: a #ClutterModel
+ * @func: a #ClutterModelFilterFunc
+ * @user_data: data to pass to @func
+ * @notify: destroy notifier of @user_data
+ *
+ * Sets the filter of @model, like clutter_model_set_filter(), without
+ * emitting the #ClutterModel::filter-changed signal; used by the
+ * implementations that already filtered their rows.
+ */
+void
+_clutter_model_set_filter_func (ClutterModel           *model,
+                                ClutterModelFilterFunc  func,
+                                gpointer                user_data,
+                                GDestroyNotify          notify)
+{
+  ClutterModelPrivate *priv = model->priv;
+
+  if (priv->filter_notify)
+    priv->filter_notify (priv->filter_data);
+
+  priv->filter_func = func;
+  priv->filter_data = user_data;
+  priv->filter_notify = notify;
+  priv->filter_stamp += 1;
+}
+
+/*< private >
+ * _clutter_model_set_sort_func:
+ * @model: a #ClutterModel
+ * @column: the column to sort on
+ * @func: a #ClutterModelSortFunc
+ * @user_data: data to pass to @func
+ * @notify: destroy notifier of @user_data
+ *
+ * Sets the sorting function of @model, like clutter_model_set_sort(),
+ * without sorting the model nor emitting the #ClutterModel::sort-changed
+ * signal; used by the implementations that already sorted their rows.
+ */
+void
+_clutter_model_set_sort_func (ClutterModel         *model,
+                              gint                  column,
+                              ClutterModelSortFunc  func,
+                              gpointer              user_data,
+                              GDestroyNotify        notify)
+{
+  ClutterModelPrivate *priv = model->priv;
+
+  if (priv->sort_notify)
+    priv->sort_notify (priv->sort_data);
+
+  priv->sort_column = column;
+  priv->sort_func = func;
+  priv->sort_data = user_data;
+  priv->sort_notify = notify;
+}
+
 /*
  * ClutterModelIter Object 
  */
@@ -2041,7 +2326,7 @@ clutter_model_iter_set_internal_valist (ClutterModelIter *iter,
     }
 
   if (sort)
-    clutter_model_resort (model);
+    clutter_model_resort_row (model, iter);
 }
 
 static void inline
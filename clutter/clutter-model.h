@@ -30,7 +30,7 @@
 #ifndef __CLUTTER_MODEL_H__
 #define __CLUTTER_MODEL_H__
 
-#include <glib-object.h>
+#include <clutter/clutter-types.h>
 
 G_BEGIN_DECLS
 
@@ -41,10 +41,8 @@ G_BEGIN_DECLS
 #define CLUTTER_IS_MODEL_CLASS(klass)   (G_TYPE_CHECK_CLASS_TYPE ((klass), CLUTTER_TYPE_MODEL))
 #define CLUTTER_MODEL_GET_CLASS(obj)    (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_MODEL, ClutterModelClass))
 
-typedef struct _ClutterModel            ClutterModel;
 typedef struct _ClutterModelClass       ClutterModelClass;
 typedef struct _ClutterModelPrivate     ClutterModelPrivate;
-typedef struct _ClutterModelIter        ClutterModelIter;
 typedef struct _ClutterModelIterClass   ClutterModelIterClass;
 typedef struct _ClutterModelIterPrivate ClutterModelIterPrivate;
 
@@ -138,6 +136,13 @@ struct _ClutterModel
  *   and returning an iterator pointing to it; if the index is a negative
  *   integer, the row should be appended to the model
  * @remove_row: virtual function for removing a row at the given index
+ * @clear: virtual function for removing all the rows without emitting
+ *   the #ClutterModel::row-removed signal
+ * @rows_changed: signal class handler for ClutterModel::rows-changed
+ * @resort_row: virtual function for moving the row pointed by an
+ *   iterator to its position in the sorted model, after the value of
+ *   the sorting column changed; if the virtual function is not
+ *   implemented, the whole model will be sorted with @resort
  *
  * Class for #ClutterModel instances.
  *
@@ -176,11 +181,23 @@ struct _ClutterModelClass
   void              (* sort_changed)    (ClutterModel     *model);
   void              (* filter_changed)  (ClutterModel     *model);
 
+  /* vtable */
+  void              (* clear)           (ClutterModel     *model);
+
+  /* signals */
+  void              (* rows_changed)    (ClutterModel     *model,
+                                         guint             position,
+                                         guint             n_removed,
+                                         guint             n_added);
+
+  /* vtable */
+  void              (* resort_row)      (ClutterModel         *model,
+                                         ClutterModelIter     *iter,
+                                         ClutterModelSortFunc  func,
+                                         gpointer              data);
+
   /*< private >*/
   /* padding for future expansion */
-  void (*_clutter_model_1) (void);
-  void (*_clutter_model_2) (void);
-  void (*_clutter_model_3) (void);
   void (*_clutter_model_4) (void);
   void (*_clutter_model_5) (void);
   void (*_clutter_model_6) (void);
@@ -223,6 +240,16 @@ void                  clutter_model_insert_value       (ClutterModel     *model,
                                                         const GValue     *value);
 void                  clutter_model_remove             (ClutterModel     *model,
                                                         guint             row);
+void                  clutter_model_append_rows        (ClutterModel     *model,
+                                                        guint             n_rows,
+                                                        guint             n_columns,
+                                                        guint            *columns,
+                                                        GValue           *values);
+void                  clutter_model_replace_all        (ClutterModel     *model,
+                                                        guint             n_rows,
+                                                        guint             n_columns,
+                                                        guint            *columns,
+                                                        GValue           *values);
 
 guint                 clutter_model_get_n_rows         (ClutterModel     *model);
 guint                 clutter_model_get_n_columns      (ClutterModel     *model);
@@ -5,6 +5,26 @@
 
 G_BEGIN_DECLS
 
+/*< private >
+ * ClutterOffscreenEffectUniformsFunc:
+ * @effect: a #ClutterOffscreenEffect
+ * @pipeline: the pipeline used to paint the offscreen target
+ *
+ * Sets the uniforms used by the fragment snippet of @effect
+ * on @pipeline.
+ */
+typedef void (* ClutterOffscreenEffectUniformsFunc) (ClutterOffscreenEffect *effect,
+                                                     CoglPipeline           *pipeline);
+
+void     _clutter_offscreen_effect_set_fragment_snippet (ClutterOffscreenEffect             *effect,
+                                                         CoglSnippet                        *snippet,
+                                                         ClutterOffscreenEffectUniformsFunc  update_uniforms);
+
+gboolean _clutter_offscreen_effect_get_cached_image     (ClutterOffscreenEffect             *effect,
+                                                         CoglHandle                         *texture,
+                                                         ClutterActorBox                    *box,
+                                                         gfloat                             *scale);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_OFFSCREEN_EFFECT_PRIVATE_H__ */
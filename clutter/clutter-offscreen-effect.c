@@ -58,6 +58,13 @@
  *   case.</para>
  * </refsect2>
  *
+ * The effects provided by Clutter that only change the color of each
+ * pixel, like #ClutterColorizeEffect, #ClutterDesaturateEffect and
+ * #ClutterBrightnessContrastEffect, share a single offscreen buffer when
+ * they are applied consecutively to the same actor; their fragment
+ * shaders are combined and applied in a single pass, in the same order
+ * the effects would have been applied.
+ *
  * #ClutterOffscreenEffect is available since Clutter 1.4
  */
 
@@ -67,12 +74,17 @@
 
 #define CLUTTER_ENABLE_EXPERIMENTAL_API
 
+#include <math.h>
+#include <string.h>
+
 #include "clutter-offscreen-effect.h"
+#include "clutter-offscreen-effect-private.h"
 
 #include "cogl/cogl.h"
 
 #include "clutter-actor-private.h"
 #include "clutter-debug.h"
+#include "clutter-memory.h"
 #include "clutter-private.h"
 #include "clutter-stage-private.h"
 
@@ -85,6 +97,11 @@ struct _ClutterOffscreenEffectPrivate
   ClutterActor *actor;
   ClutterActor *stage;
 
+  /* the stage owning the pool of the offscreen target, if the target
+   * was not created by a create_texture() implementation
+   */
+  ClutterActor *pool_stage;
+
   gfloat x_offset;
   gfloat y_offset;
 
@@ -106,12 +123,248 @@ struct _ClutterOffscreenEffectPrivate
      and it won't cause a redraw to be queued on the parent's
      children. */
   CoglMatrix last_matrix_drawn;
+
+  /* the fragment snippet set by the sub-class, if the effect only
+   * changes the color of each pixel of the target; effects with a
+   * fragment snippet can be combined in a single offscreen pass
+   */
+  CoglSnippet *fragment_snippet;
+  ClutterOffscreenEffectUniformsFunc update_uniforms;
+
+  /* the effects following this one on the actor whose fragment
+   * snippets are applied when painting our target, and the pipeline
+   * combining all the fragment snippets
+   */
+  GPtrArray *fused_effects;
+  CoglPipeline *fused_pipeline;
+
+  /* the effect painting the target for us during the current paint */
+  ClutterOffscreenEffect *fused_into;
 };
 
 G_DEFINE_ABSTRACT_TYPE (ClutterOffscreenEffect,
                         clutter_offscreen_effect,
                         CLUTTER_TYPE_EFFECT);
 
+static CoglHandle
+clutter_offscreen_effect_real_create_texture (ClutterOffscreenEffect *effect,
+                                              gfloat                  width,
+                                              gfloat                  height);
+
+/* the pixel format of the targets created by the default create_texture() */
+#define OFFSCREEN_TARGET_FORMAT         COGL_PIXEL_FORMAT_RGBA_8888_PRE
+
+static void
+clutter_offscreen_effect_release_target (ClutterOffscreenEffect *self)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+
+  if (priv->pool_stage != NULL)
+    {
+      /* give the target back to the stage, so that other effects can
+       * use it instead of creating a new one of the same size
+       */
+      _clutter_stage_release_offscreen (CLUTTER_STAGE (priv->pool_stage),
+                                        OFFSCREEN_TARGET_FORMAT,
+                                        priv->texture,
+                                        priv->offscreen);
+      priv->texture = NULL;
+      priv->offscreen = NULL;
+
+      g_object_remove_weak_pointer (G_OBJECT (priv->pool_stage),
+                                    (gpointer *) &priv->pool_stage);
+      priv->pool_stage = NULL;
+    }
+
+  if (priv->offscreen != NULL)
+    {
+      cogl_handle_unref (priv->offscreen);
+      priv->offscreen = NULL;
+    }
+
+  if (priv->texture != NULL)
+    {
+      cogl_handle_unref (priv->texture);
+      priv->texture = NULL;
+    }
+
+  priv->fbo_width = 0;
+  priv->fbo_height = 0;
+}
+
+static void
+clutter_offscreen_effect_purge_caches (gpointer          instance,
+                                       ClutterPurgeLevel level)
+{
+  ClutterOffscreenEffect *self = instance;
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+
+  if (priv->offscreen == NULL || level < CLUTTER_PURGE_LEVEL_MODERATE)
+    return;
+
+  /* the target of a visible actor is painted again on the next frame */
+  if (level < CLUTTER_PURGE_LEVEL_CRITICAL &&
+      priv->actor != NULL &&
+      CLUTTER_ACTOR_IS_MAPPED (priv->actor))
+    return;
+
+  clutter_offscreen_effect_release_target (self);
+}
+
+static void
+clutter_offscreen_effect_clear_fusion (ClutterOffscreenEffect *self)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+
+  if (priv->fused_effects != NULL)
+    {
+      g_ptr_array_unref (priv->fused_effects);
+      priv->fused_effects = NULL;
+    }
+
+  if (priv->fused_pipeline != NULL)
+    {
+      cogl_object_unref (priv->fused_pipeline);
+      priv->fused_pipeline = NULL;
+    }
+}
+
+static gboolean
+clutter_offscreen_effect_can_fuse (ClutterOffscreenEffect *self,
+                                   ClutterOffscreenEffect *effect,
+                                   guint                   n_fused)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+  guint i;
+
+  if (effect->priv->fragment_snippet == NULL)
+    return FALSE;
+
+  /* the declarations of the snippets of two effects of the same type
+   * would clash
+   */
+  if (G_OBJECT_TYPE (effect) == G_OBJECT_TYPE (self))
+    return FALSE;
+
+  for (i = 0; i < n_fused; i++)
+    {
+      if (G_OBJECT_TYPE (effect) ==
+          G_OBJECT_TYPE (g_ptr_array_index (priv->fused_effects, i)))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* collects the enabled effects following @self that can be painted
+ * by combining their fragment snippet with ours, and makes them skip
+ * their own offscreen pass for the current paint
+ */
+static void
+clutter_offscreen_effect_update_fusion (ClutterOffscreenEffect *self)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+  gboolean changed = FALSE;
+  const GList *l;
+  guint n_fused = 0;
+  guint i;
+
+  if (priv->fragment_snippet == NULL)
+    return;
+
+  if (priv->fused_effects == NULL)
+    priv->fused_effects = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (l = _clutter_actor_peek_next_effects (priv->actor);
+       l != NULL;
+       l = l->next)
+    {
+      ClutterOffscreenEffect *effect;
+
+      if (!clutter_actor_meta_get_enabled (l->data))
+        continue;
+
+      if (!CLUTTER_IS_OFFSCREEN_EFFECT (l->data))
+        break;
+
+      effect = l->data;
+      if (!clutter_offscreen_effect_can_fuse (self, effect, n_fused))
+        break;
+
+      if (n_fused < priv->fused_effects->len &&
+          g_ptr_array_index (priv->fused_effects, n_fused) == effect)
+        {
+          n_fused += 1;
+          continue;
+        }
+
+      g_ptr_array_remove_range (priv->fused_effects,
+                                n_fused,
+                                priv->fused_effects->len - n_fused);
+      g_ptr_array_add (priv->fused_effects, g_object_ref (effect));
+      n_fused += 1;
+
+      changed = TRUE;
+    }
+
+  if (n_fused < priv->fused_effects->len)
+    {
+      g_ptr_array_remove_range (priv->fused_effects,
+                                n_fused,
+                                priv->fused_effects->len - n_fused);
+      changed = TRUE;
+    }
+
+  if (n_fused == 0)
+    {
+      clutter_offscreen_effect_clear_fusion (self);
+      return;
+    }
+
+  if (changed || priv->fused_pipeline == NULL)
+    {
+      CoglContext *ctx =
+        clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+      if (priv->fused_pipeline != NULL)
+        cogl_object_unref (priv->fused_pipeline);
+
+      priv->fused_pipeline = cogl_pipeline_new (ctx);
+      cogl_pipeline_set_layer_null_texture (priv->fused_pipeline,
+                                            0, /* layer_index */
+                                            COGL_TEXTURE_TYPE_2D);
+      cogl_pipeline_set_layer_filters (priv->fused_pipeline,
+                                       0, /* layer_index */
+                                       COGL_PIPELINE_FILTER_NEAREST,
+                                       COGL_PIPELINE_FILTER_NEAREST);
+
+      /* the last effect is the first one to be applied */
+      for (i = n_fused; i > 0; i--)
+        {
+          ClutterOffscreenEffect *effect =
+            g_ptr_array_index (priv->fused_effects, i - 1);
+
+          cogl_pipeline_add_snippet (priv->fused_pipeline,
+                                     effect->priv->fragment_snippet);
+        }
+
+      cogl_pipeline_add_snippet (priv->fused_pipeline,
+                                 priv->fragment_snippet);
+    }
+
+  for (i = 0; i < n_fused; i++)
+    {
+      ClutterOffscreenEffect *effect =
+        g_ptr_array_index (priv->fused_effects, i);
+
+      /* the fused effects do not need their own target any more */
+      clutter_offscreen_effect_release_target (effect);
+      clutter_offscreen_effect_clear_fusion (effect);
+
+      effect->priv->fused_into = self;
+    }
+}
+
 static void
 clutter_offscreen_effect_set_actor (ClutterActorMeta *meta,
                                     ClutterActor     *actor)
@@ -124,11 +377,8 @@ clutter_offscreen_effect_set_actor (ClutterActorMeta *meta,
   meta_class->set_actor (meta, actor);
 
   /* clear out the previous state */
-  if (priv->offscreen != NULL)
-    {
-      cogl_handle_unref (priv->offscreen);
-      priv->offscreen = NULL;
-    }
+  clutter_offscreen_effect_release_target (self);
+  clutter_offscreen_effect_clear_fusion (self);
 
   /* we keep a back pointer here, to avoid going through the ActorMeta */
   priv->actor = clutter_actor_meta_get_actor (meta);
@@ -193,38 +443,59 @@ update_fbo (ClutterEffect *effect, int fbo_width, int fbo_height)
                                        COGL_PIPELINE_FILTER_NEAREST);
     }
 
-  if (priv->texture != NULL)
+  clutter_offscreen_effect_release_target (self);
+
+  if (CLUTTER_OFFSCREEN_EFFECT_GET_CLASS (self)->create_texture ==
+      clutter_offscreen_effect_real_create_texture)
     {
-      cogl_handle_unref (priv->texture);
-      priv->texture = NULL;
+      /* the default targets are shared between all the effects on
+       * the stage; this avoids creating and destroying framebuffers
+       * when effects are toggled or their actors are resized
+       */
+      if (!_clutter_stage_acquire_offscreen (CLUTTER_STAGE (priv->stage),
+                                             MAX (fbo_width, 1),
+                                             MAX (fbo_height, 1),
+                                             OFFSCREEN_TARGET_FORMAT,
+                                             &priv->texture,
+                                             &priv->offscreen))
+        {
+          g_warning ("%s: Unable to create an Offscreen buffer", G_STRLOC);
+          return FALSE;
+        }
+
+      priv->pool_stage = priv->stage;
+      g_object_add_weak_pointer (G_OBJECT (priv->pool_stage),
+                                 (gpointer *) &priv->pool_stage);
     }
+  else
+    {
+      priv->texture =
+        clutter_offscreen_effect_create_texture (self, fbo_width, fbo_height);
+      if (priv->texture == NULL)
+        return FALSE;
 
-  priv->texture =
-    clutter_offscreen_effect_create_texture (self, fbo_width, fbo_height);
-  if (priv->texture == NULL)
-    return FALSE;
+      _clutter_memory_track_texture (CLUTTER_MEMORY_OFFSCREEN_TARGETS,
+                                     priv->texture);
 
-  cogl_pipeline_set_layer_texture (priv->target, 0, priv->texture);
+      priv->offscreen = cogl_offscreen_new_to_texture (priv->texture);
+      if (priv->offscreen == NULL)
+        {
+          g_warning ("%s: Unable to create an Offscreen buffer", G_STRLOC);
 
-  priv->fbo_width = fbo_width;
-  priv->fbo_height = fbo_height;
+          cogl_handle_unref (priv->target);
+          priv->target = NULL;
 
-  if (priv->offscreen != NULL)
-    cogl_handle_unref (priv->offscreen);
-
-  priv->offscreen = cogl_offscreen_new_to_texture (priv->texture);
-  if (priv->offscreen == NULL)
-    {
-      g_warning ("%s: Unable to create an Offscreen buffer", G_STRLOC);
+          cogl_handle_unref (priv->texture);
+          priv->texture = NULL;
 
-      cogl_handle_unref (priv->target);
-      priv->target = NULL;
+          return FALSE;
+        }
+    }
 
-      priv->fbo_width = 0;
-      priv->fbo_height = 0;
+  cogl_pipeline_set_layer_texture (priv->target, 0, priv->texture);
 
-      return FALSE;
-    }
+  priv->fbo_width = fbo_width;
+  priv->fbo_height = fbo_height;
 
   return TRUE;
 }
@@ -348,6 +619,8 @@ clutter_offscreen_effect_pre_paint (ClutterEffect *effect)
     _clutter_actor_get_opacity_override (priv->actor);
   _clutter_actor_set_opacity_override (priv->actor, 0xff);
 
+  clutter_offscreen_effect_update_fusion (self);
+
   return TRUE;
 }
 
@@ -378,6 +651,41 @@ clutter_offscreen_effect_real_paint_target (ClutterOffscreenEffect *effect)
                                       1.0, 1.0);
 }
 
+static void
+clutter_offscreen_effect_paint_fused (ClutterOffscreenEffect *effect)
+{
+  ClutterOffscreenEffectPrivate *priv = effect->priv;
+  guint8 paint_opacity;
+  guint i;
+
+  paint_opacity = clutter_actor_get_paint_opacity (priv->actor);
+
+  cogl_pipeline_set_color4ub (priv->fused_pipeline,
+                              paint_opacity,
+                              paint_opacity,
+                              paint_opacity,
+                              paint_opacity);
+  cogl_pipeline_set_layer_texture (priv->fused_pipeline, 0, priv->texture);
+
+  for (i = 0; i < priv->fused_effects->len; i++)
+    {
+      ClutterOffscreenEffect *fused =
+        g_ptr_array_index (priv->fused_effects, i);
+
+      fused->priv->update_uniforms (fused, priv->fused_pipeline);
+    }
+
+  priv->update_uniforms (effect, priv->fused_pipeline);
+
+  cogl_push_source (priv->fused_pipeline);
+
+  cogl_rectangle (0, 0,
+                  cogl_texture_get_width (priv->texture),
+                  cogl_texture_get_height (priv->texture));
+
+  cogl_pop_source ();
+}
+
 static void
 clutter_offscreen_effect_paint_texture (ClutterOffscreenEffect *effect)
 {
@@ -396,9 +704,13 @@ clutter_offscreen_effect_paint_texture (ClutterOffscreenEffect *effect)
   cogl_set_modelview_matrix (&modelview);
 
   /* paint the target material; this is virtualized for
-   * sub-classes that require special hand-holding
+   * sub-classes that require special hand-holding, unless we
+   * are also painting the effects fused with this one
    */
-  clutter_offscreen_effect_paint_target (effect);
+  if (priv->fused_pipeline != NULL)
+    clutter_offscreen_effect_paint_fused (effect);
+  else
+    clutter_offscreen_effect_paint_target (effect);
 
   cogl_pop_matrix ();
 }
@@ -417,12 +729,90 @@ clutter_offscreen_effect_post_paint (ClutterEffect *effect)
   /* Restore the previous opacity override */
   _clutter_actor_set_opacity_override (priv->actor, priv->old_opacity_override);
 
+  if (priv->fused_effects != NULL)
+    {
+      guint i;
+
+      for (i = 0; i < priv->fused_effects->len; i++)
+        {
+          ClutterOffscreenEffect *fused =
+            g_ptr_array_index (priv->fused_effects, i);
+
+          fused->priv->fused_into = NULL;
+        }
+    }
+
   cogl_pop_matrix ();
   cogl_pop_framebuffer ();
 
   clutter_offscreen_effect_paint_texture (self);
 }
 
+static inline gboolean
+matrix_value_equal (float a,
+                    float b)
+{
+  return fabsf (a - b) < 1e-4f;
+}
+
+/* checks whether the actor painted with @matrix would look the same as
+ * the contents of the offscreen buffer, moved by a translation on the
+ * plane of the stage; this happens when the actor, or any of its
+ * parents, is moved without being transformed in any other way
+ */
+static gboolean
+clutter_offscreen_effect_get_translation (ClutterOffscreenEffect *self,
+                                          const CoglMatrix       *matrix,
+                                          gfloat                 *dx,
+                                          gfloat                 *dy)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+  CoglMatrix view, inverse, old_matrix, new_matrix;
+
+  if (cogl_matrix_equal (matrix, &priv->last_matrix_drawn))
+    {
+      *dx = *dy = 0.f;
+      return TRUE;
+    }
+
+  /* compare the transformations relative to the stage */
+  cogl_matrix_init_identity (&view);
+  _clutter_actor_apply_modelview_transform (priv->stage, &view);
+  if (!cogl_matrix_get_inverse (&view, &inverse))
+    return FALSE;
+
+  cogl_matrix_multiply (&old_matrix, &inverse, &priv->last_matrix_drawn);
+  cogl_matrix_multiply (&new_matrix, &inverse, matrix);
+
+  /* the actor must lie on the plane of the stage, otherwise the
+   * perspective would make a translation look different
+   */
+  if (!matrix_value_equal (new_matrix.zx, 0.f) ||
+      !matrix_value_equal (new_matrix.zy, 0.f) ||
+      !matrix_value_equal (new_matrix.zw, 0.f) ||
+      !matrix_value_equal (new_matrix.wx, 0.f) ||
+      !matrix_value_equal (new_matrix.wy, 0.f) ||
+      !matrix_value_equal (new_matrix.ww, 1.f))
+    return FALSE;
+
+  if (!matrix_value_equal (new_matrix.xx, old_matrix.xx) ||
+      !matrix_value_equal (new_matrix.xy, old_matrix.xy) ||
+      !matrix_value_equal (new_matrix.yx, old_matrix.yx) ||
+      !matrix_value_equal (new_matrix.yy, old_matrix.yy) ||
+      !matrix_value_equal (old_matrix.zx, 0.f) ||
+      !matrix_value_equal (old_matrix.zy, 0.f) ||
+      !matrix_value_equal (old_matrix.zw, 0.f) ||
+      !matrix_value_equal (old_matrix.wx, 0.f) ||
+      !matrix_value_equal (old_matrix.wy, 0.f) ||
+      !matrix_value_equal (old_matrix.ww, 1.f))
+    return FALSE;
+
+  *dx = new_matrix.xw - old_matrix.xw;
+  *dy = new_matrix.yw - old_matrix.yw;
+
+  return TRUE;
+}
+
 static void
 clutter_offscreen_effect_paint (ClutterEffect           *effect,
                                 ClutterEffectPaintFlags  flags)
@@ -430,15 +820,27 @@ clutter_offscreen_effect_paint (ClutterEffect           *effect,
   ClutterOffscreenEffect *self = CLUTTER_OFFSCREEN_EFFECT (effect);
   ClutterOffscreenEffectPrivate *priv = self->priv;
   CoglMatrix matrix;
+  gfloat dx, dy;
+
+  /* the effect painting the target before us is also going to apply
+   * our fragment snippet, so we just need to paint the actor
+   */
+  if (priv->fused_into != NULL)
+    {
+      clutter_actor_continue_paint (priv->actor);
+      return;
+    }
 
   cogl_get_modelview_matrix (&matrix);
 
-  /* If we've already got a cached image for the same matrix and the
-     actor hasn't been redrawn then we can just use the cached image
-     in the fbo */
+  /* If we've already got a cached image and the contents of the actor
+     haven't changed then we can just use the cached image in the fbo;
+     redraws queued only because the actor moved do not invalidate the
+     cached image, as long as the actor was only translated */
   if (priv->offscreen == NULL ||
-      (flags & CLUTTER_EFFECT_PAINT_ACTOR_DIRTY) ||
-      !cogl_matrix_equal (&matrix, &priv->last_matrix_drawn))
+      ((flags & CLUTTER_EFFECT_PAINT_ACTOR_DIRTY) &&
+       _clutter_actor_is_damaged (priv->actor)) ||
+      !clutter_offscreen_effect_get_translation (self, &matrix, &dx, &dy))
     {
       /* Chain up to the parent paint method which will call the pre and
          post paint functions to update the image */
@@ -446,7 +848,21 @@ clutter_offscreen_effect_paint (ClutterEffect           *effect,
         paint (effect, flags);
     }
   else
-    clutter_offscreen_effect_paint_texture (self);
+    {
+      CLUTTER_NOTE (PAINT, "Re-using the offscreen image of '%s'",
+                    _clutter_actor_get_debug_name (priv->actor));
+
+      priv->x_offset += dx;
+      priv->y_offset += dy;
+      priv->last_matrix_drawn = matrix;
+
+      /* the children are not traversed, so they cannot update their
+       * position inside the pick index of the stage
+       */
+      _clutter_actor_skip_children_pick_index (priv->actor);
+
+      clutter_offscreen_effect_paint_texture (self);
+    }
 }
 
 static void
@@ -455,18 +871,35 @@ clutter_offscreen_effect_finalize (GObject *gobject)
   ClutterOffscreenEffect *self = CLUTTER_OFFSCREEN_EFFECT (gobject);
   ClutterOffscreenEffectPrivate *priv = self->priv;
 
-  if (priv->offscreen)
-    cogl_handle_unref (priv->offscreen);
+  _clutter_memory_remove_purge_func (self);
+
+  clutter_offscreen_effect_release_target (self);
+  clutter_offscreen_effect_clear_fusion (self);
+
+  if (priv->fragment_snippet != NULL)
+    cogl_object_unref (priv->fragment_snippet);
 
   if (priv->target)
     cogl_handle_unref (priv->target);
 
-  if (priv->texture)
-    cogl_handle_unref (priv->texture);
-
   G_OBJECT_CLASS (clutter_offscreen_effect_parent_class)->finalize (gobject);
 }
 
+static void
+clutter_offscreen_effect_notify (GObject    *gobject,
+                                 GParamSpec *pspec)
+{
+  ClutterOffscreenEffect *self = CLUTTER_OFFSCREEN_EFFECT (gobject);
+
+  /* a disabled effect does not need its target any more */
+  if (strcmp (pspec->name, "enabled") == 0 &&
+      !clutter_actor_meta_get_enabled (CLUTTER_ACTOR_META (self)))
+    clutter_offscreen_effect_release_target (self);
+
+  if (G_OBJECT_CLASS (clutter_offscreen_effect_parent_class)->notify != NULL)
+    G_OBJECT_CLASS (clutter_offscreen_effect_parent_class)->notify (gobject, pspec);
+}
+
 static void
 clutter_offscreen_effect_class_init (ClutterOffscreenEffectClass *klass)
 {
@@ -485,6 +918,7 @@ clutter_offscreen_effect_class_init (ClutterOffscreenEffectClass *klass)
   effect_class->post_paint = clutter_offscreen_effect_post_paint;
   effect_class->paint = clutter_offscreen_effect_paint;
 
+  gobject_class->notify = clutter_offscreen_effect_notify;
   gobject_class->finalize = clutter_offscreen_effect_finalize;
 }
 
@@ -494,6 +928,10 @@ clutter_offscreen_effect_init (ClutterOffscreenEffect *self)
   self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                                             CLUTTER_TYPE_OFFSCREEN_EFFECT,
                                             ClutterOffscreenEffectPrivate);
+
+  _clutter_memory_add_purge_func (CLUTTER_MEMORY_OFFSCREEN_TARGETS,
+                                  self,
+                                  clutter_offscreen_effect_purge_caches);
 }
 
 /**
@@ -669,3 +1107,120 @@ clutter_offscreen_effect_get_target_rect (ClutterOffscreenEffect *effect,
 
   return TRUE;
 }
+
+/*< private >
+ * _clutter_offscreen_effect_set_fragment_snippet:
+ * @effect: a #ClutterOffscreenEffect
+ * @snippet: a fragment #CoglSnippet
+ * @update_uniforms: the function used to set the uniforms of @snippet
+ *
+ * Declares that the paint_target() implementation of @effect only
+ * paints the target with a pipeline using @snippet, so that @effect
+ * can be combined with the effects preceding and following it on the
+ * same actor, and painted without using its own offscreen buffer.
+ *
+ * The declarations of @snippet must not clash with the ones of the
+ * other effects using this function.
+ */
+void
+_clutter_offscreen_effect_set_fragment_snippet (ClutterOffscreenEffect             *effect,
+                                                CoglSnippet                        *snippet,
+                                                ClutterOffscreenEffectUniformsFunc  update_uniforms)
+{
+  ClutterOffscreenEffectPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_OFFSCREEN_EFFECT (effect));
+  g_return_if_fail (snippet == NULL || update_uniforms != NULL);
+
+  priv = effect->priv;
+
+  if (snippet != NULL)
+    cogl_object_ref (snippet);
+
+  if (priv->fragment_snippet != NULL)
+    cogl_object_unref (priv->fragment_snippet);
+
+  priv->fragment_snippet = snippet;
+  priv->update_uniforms = update_uniforms;
+
+  clutter_offscreen_effect_clear_fusion (effect);
+}
+
+/*< private >
+ * _clutter_offscreen_effect_get_cached_image:
+ * @effect: a #ClutterOffscreenEffect
+ * @texture: (out): return location for the texture of the cached image
+ * @box: (out): return location for the area covered by the image, in
+ *   the coordinate space of the actor
+ * @scale: (out): return location for the number of texels of the image
+ *   for each unit of the coordinate space of the actor
+ *
+ * Retrieves the image of the actor painted by @effect the last time the
+ * offscreen buffer was updated, so that it can be painted in place of
+ * the actor.
+ *
+ * The image can only be retrieved if @effect paints the offscreen buffer
+ * unmodified, and if the actor was only scaled and translated on the
+ * plane of the stage when it was painted.
+ *
+ * Return value: %TRUE if the image is available
+ */
+gboolean
+_clutter_offscreen_effect_get_cached_image (ClutterOffscreenEffect *effect,
+                                            CoglHandle             *texture,
+                                            ClutterActorBox        *box,
+                                            gfloat                 *scale)
+{
+  ClutterOffscreenEffectPrivate *priv;
+  CoglMatrix view, inverse, matrix;
+  gfloat width, height;
+
+  g_return_val_if_fail (CLUTTER_IS_OFFSCREEN_EFFECT (effect), FALSE);
+
+  priv = effect->priv;
+
+  if (priv->offscreen == NULL ||
+      priv->texture == NULL ||
+      priv->stage == NULL ||
+      priv->fused_pipeline != NULL)
+    return FALSE;
+
+  if (CLUTTER_OFFSCREEN_EFFECT_GET_CLASS (effect)->paint_target !=
+      clutter_offscreen_effect_real_paint_target)
+    return FALSE;
+
+  cogl_matrix_init_identity (&view);
+  _clutter_actor_apply_modelview_transform (priv->stage, &view);
+  if (!cogl_matrix_get_inverse (&view, &inverse))
+    return FALSE;
+
+  cogl_matrix_multiply (&matrix, &inverse, &priv->last_matrix_drawn);
+
+  if (!matrix_value_equal (matrix.xy, 0.f) ||
+      !matrix_value_equal (matrix.yx, 0.f) ||
+      !matrix_value_equal (matrix.zx, 0.f) ||
+      !matrix_value_equal (matrix.zy, 0.f) ||
+      !matrix_value_equal (matrix.zw, 0.f) ||
+      !matrix_value_equal (matrix.wx, 0.f) ||
+      !matrix_value_equal (matrix.wy, 0.f) ||
+      !matrix_value_equal (matrix.ww, 1.f) ||
+      matrix_value_equal (matrix.xx, 0.f) ||
+      matrix_value_equal (matrix.yy, 0.f))
+    return FALSE;
+
+  width = cogl_texture_get_width (priv->texture);
+  height = cogl_texture_get_height (priv->texture);
+
+  /* transform the area of the offscreen buffer on the stage back to
+   * the coordinate space of the actor
+   */
+  box->x1 = (priv->x_offset - matrix.xw) / matrix.xx;
+  box->y1 = (priv->y_offset - matrix.yw) / matrix.yy;
+  box->x2 = (priv->x_offset + width - matrix.xw) / matrix.xx;
+  box->y2 = (priv->y_offset + height - matrix.yw) / matrix.yy;
+
+  *texture = priv->texture;
+  *scale = MIN (fabsf (matrix.xx), fabsf (matrix.yy));
+
+  return TRUE;
+}
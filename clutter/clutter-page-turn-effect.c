@@ -147,6 +147,77 @@ clutter_page_turn_effect_deform_vertex (ClutterDeformEffect *effect,
     }
 }
 
+/* the same deformation as clutter_page_turn_effect_deform_vertex(),
+ * computed on the GPU
+ */
+static const gchar *page_turn_glsl_declarations =
+"uniform float period;\n"
+"uniform float angle;\n"
+"uniform float radius;\n";
+
+static const gchar *page_turn_glsl_shader =
+"  vec4 position = vec4 (cogl_position_in.xy * clutter_deform_size, 0.0, 1.0);\n"
+"\n"
+"  if (period > 0.0)\n"
+"    {\n"
+"      vec2 center = (1.0 - period) * clutter_deform_size;\n"
+"      vec2 delta = position.xy - center;\n"
+"      float rx = delta.x * cos (-angle) - delta.y * sin (-angle) - radius;\n"
+"      float ry = delta.x * sin (-angle) + delta.y * cos (-angle);\n"
+"      float turn_angle = 0.0;\n"
+"\n"
+"      if (rx > radius * -2.0)\n"
+"        {\n"
+"          float shade;\n"
+"\n"
+"          turn_angle = (rx / radius * 1.5707963) - 1.5707963;\n"
+"          shade = ((sin (turn_angle) * 96.0) + 159.0) / 255.0;\n"
+"          cogl_color_out = vec4 (shade, shade, shade, 1.0) * cogl_color_out.a;\n"
+"        }\n"
+"\n"
+"      if (rx > 0.0)\n"
+"        {\n"
+"          float small_radius = radius\n"
+"                             - min (radius, (turn_angle * 10.0) / 3.1415926);\n"
+"\n"
+"          rx = (small_radius * cos (turn_angle)) + radius;\n"
+"\n"
+"          position.x = (rx * cos (angle)) - (ry * sin (angle)) + center.x;\n"
+"          position.y = (rx * sin (angle)) + (ry * cos (angle)) + center.y;\n"
+"          position.z = (small_radius * sin (turn_angle)) + radius;\n"
+"        }\n"
+"    }\n"
+"\n"
+"  cogl_position_out = cogl_modelview_projection_matrix * position;\n";
+
+static CoglHandle
+clutter_page_turn_effect_create_vertex_snippet (ClutterDeformEffect *effect)
+{
+  return cogl_snippet_new (COGL_SNIPPET_HOOK_VERTEX,
+                           page_turn_glsl_declarations,
+                           page_turn_glsl_shader);
+}
+
+static void
+clutter_page_turn_effect_update_vertex_uniforms (ClutterDeformEffect *effect,
+                                                 CoglHandle           handle,
+                                                 gfloat               width,
+                                                 gfloat               height)
+{
+  ClutterPageTurnEffect *self = CLUTTER_PAGE_TURN_EFFECT (effect);
+  CoglPipeline *pipeline = COGL_PIPELINE (handle);
+
+  cogl_pipeline_set_uniform_1f (pipeline,
+                                cogl_pipeline_get_uniform_location (pipeline, "period"),
+                                self->period);
+  cogl_pipeline_set_uniform_1f (pipeline,
+                                cogl_pipeline_get_uniform_location (pipeline, "angle"),
+                                self->angle / (180.0f / G_PI));
+  cogl_pipeline_set_uniform_1f (pipeline,
+                                cogl_pipeline_get_uniform_location (pipeline, "radius"),
+                                self->radius);
+}
+
 static void
 clutter_page_turn_effect_set_property (GObject      *gobject,
                                        guint         prop_id,
@@ -263,6 +334,8 @@ clutter_page_turn_effect_class_init (ClutterPageTurnEffectClass *klass)
   g_object_class_install_property (gobject_class, PROP_RADIUS, pspec);
 
   deform_class->deform_vertex = clutter_page_turn_effect_deform_vertex;
+  deform_class->create_vertex_snippet = clutter_page_turn_effect_create_vertex_snippet;
+  deform_class->update_vertex_uniforms = clutter_page_turn_effect_update_vertex_uniforms;
 }
 
 static void
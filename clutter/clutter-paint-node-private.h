@@ -97,6 +97,8 @@ GType _clutter_transform_node_get_type (void) G_GNUC_CONST;
 GType _clutter_dummy_node_get_type (void) G_GNUC_CONST;
 
 void                    _clutter_paint_operation_paint_rectangle        (const ClutterPaintOperation *op);
+guint                   _clutter_paint_operation_paint_rectangles       (const ClutterPaintOperation *ops,
+                                                                         guint                        n_ops);
 void                    _clutter_paint_operation_clip_rectangle         (const ClutterPaintOperation *op);
 void                    _clutter_paint_operation_paint_path             (const ClutterPaintOperation *op);
 void                    _clutter_paint_operation_clip_path              (const ClutterPaintOperation *op);
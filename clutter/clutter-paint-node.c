@@ -70,6 +70,8 @@
 
 #define CLUTTER_ENABLE_EXPERIMENTAL_API
 
+#include <string.h>
+
 #include <pango/pango.h>
 #include <cogl/cogl.h>
 #include <json-glib/json-glib.h>
@@ -174,6 +176,38 @@ clutter_paint_node_class_base_finalize (ClutterPaintNodeClass *klass)
 {
 }
 
+/* the operation arrays of the finalized nodes are recycled by the
+ * nodes created afterwards, since most nodes only ever live for the
+ * duration of a paint; large arrays are not worth keeping around
+ */
+#define OPERATIONS_POOL_SIZE            64
+#define OPERATIONS_POOL_MAX_LENGTH      64
+
+static GArray *operations_pool[OPERATIONS_POOL_SIZE];
+static guint n_pooled_operations = 0;
+
+static inline GArray *
+clutter_paint_operations_acquire (void)
+{
+  if (n_pooled_operations > 0)
+    return operations_pool[--n_pooled_operations];
+
+  return g_array_new (FALSE, FALSE, sizeof (ClutterPaintOperation));
+}
+
+static inline void
+clutter_paint_operations_release (GArray *operations)
+{
+  if (n_pooled_operations < OPERATIONS_POOL_SIZE &&
+      operations->len <= OPERATIONS_POOL_MAX_LENGTH)
+    {
+      g_array_set_size (operations, 0);
+      operations_pool[n_pooled_operations++] = operations;
+    }
+  else
+    g_array_unref (operations);
+}
+
 static void
 clutter_paint_node_real_finalize (ClutterPaintNode *node)
 {
@@ -193,7 +227,7 @@ clutter_paint_node_real_finalize (ClutterPaintNode *node)
           clutter_paint_operation_clear (op);
         }
 
-      g_array_unref (node->operations);
+      clutter_paint_operations_release (node->operations);
     }
 
   iter = node->first_child;
@@ -822,14 +856,54 @@ clutter_paint_op_init_primitive (ClutterPaintOperation *op,
   op->op.primitive = cogl_object_ref (primitive);
 }
 
+/* the number of rectangles submitted to Cogl with a single call */
+#define PAINT_OP_RECT_BATCH     64
+
+/*< private >
+ * _clutter_paint_operation_paint_rectangles:
+ * @ops: an array of #ClutterPaintOperation, starting with a
+ *   %PAINT_OP_TEX_RECT operation
+ * @n_ops: the number of operations in @ops
+ *
+ * Paints the run of consecutive %PAINT_OP_TEX_RECT operations at the
+ * beginning of @ops using the current source, submitting them to Cogl
+ * in batches instead of one rectangle at a time.
+ *
+ * Return value: the number of operations that have been painted
+ */
+guint
+_clutter_paint_operation_paint_rectangles (const ClutterPaintOperation *ops,
+                                           guint                        n_ops)
+{
+  float verts[PAINT_OP_RECT_BATCH * 8];
+  guint n_rects = 0;
+  guint i;
+
+  for (i = 0; i < n_ops && ops[i].opcode == PAINT_OP_TEX_RECT; i++)
+    {
+      memcpy (verts + n_rects * 8, ops[i].op.texrect, sizeof (float) * 8);
+      n_rects += 1;
+
+      if (n_rects == PAINT_OP_RECT_BATCH)
+        {
+          cogl_rectangles_with_texture_coords (verts, n_rects);
+          n_rects = 0;
+        }
+    }
+
+  if (n_rects != 0)
+    cogl_rectangles_with_texture_coords (verts, n_rects);
+
+  return i;
+}
+
 static inline void
 clutter_paint_node_maybe_init_operations (ClutterPaintNode *node)
 {
   if (node->operations != NULL)
     return;
 
-  node->operations =
-    g_array_new (FALSE, FALSE, sizeof (ClutterPaintOperation));
+  node->operations = clutter_paint_operations_acquire ();
 }
 
 /**
@@ -52,6 +52,28 @@
 static CoglPipeline *default_color_pipeline   = NULL;
 static CoglPipeline *default_texture_pipeline = NULL;
 
+/* The pipelines of the color and texture nodes are shared between all
+ * the nodes painting the same texture with the same state; a pipeline
+ * stays in the cache only as long as it is used by a node
+ */
+typedef struct _PipelineKey
+{
+  CoglTexture *texture;
+  CoglPipelineFilter min_filter;
+  CoglPipelineFilter mag_filter;
+  guint32 color;
+} PipelineKey;
+
+typedef struct _PipelineCacheEntry
+{
+  PipelineKey key;
+
+  CoglPipeline *pipeline;
+} PipelineCacheEntry;
+
+static GHashTable *pipeline_cache = NULL;
+static CoglUserDataKey pipeline_cache_entry_key;
+
 /*< private >
  * _clutter_paint_node_init_types:
  *
@@ -84,6 +106,113 @@ _clutter_paint_node_init_types (void)
                                      COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
 }
 
+static guint
+pipeline_key_hash (gconstpointer data)
+{
+  const PipelineKey *key = data;
+
+  return g_direct_hash (key->texture)
+       ^ (key->min_filter << 16)
+       ^ (key->mag_filter << 24)
+       ^ key->color;
+}
+
+static gboolean
+pipeline_key_equal (gconstpointer a,
+                    gconstpointer b)
+{
+  const PipelineKey *key_a = a;
+  const PipelineKey *key_b = b;
+
+  return key_a->texture == key_b->texture &&
+         key_a->min_filter == key_b->min_filter &&
+         key_a->mag_filter == key_b->mag_filter &&
+         key_a->color == key_b->color;
+}
+
+static void
+pipeline_cache_entry_free (gpointer data)
+{
+  PipelineCacheEntry *entry = data;
+
+  /* the pipeline is being destroyed */
+  g_hash_table_remove (pipeline_cache, &entry->key);
+
+  g_slice_free (PipelineCacheEntry, entry);
+}
+
+/*< private >
+ * get_pipeline:
+ * @texture: (allow-none): the texture to paint, or %NULL for a
+ *   solid color
+ * @color: the color of the pipeline
+ * @min_filter: the minification filter of @texture
+ * @mag_filter: the magnification filter of @texture
+ *
+ * Retrieves a pipeline with the given state from the cache, creating
+ * it if no node currently uses it.
+ *
+ * The returned pipeline must not be modified.
+ *
+ * Return value: (transfer full): a pipeline
+ */
+static CoglPipeline *
+get_pipeline (CoglTexture        *texture,
+              const ClutterColor *color,
+              CoglPipelineFilter  min_filter,
+              CoglPipelineFilter  mag_filter)
+{
+  PipelineCacheEntry *entry;
+  PipelineKey key;
+  CoglColor cogl_color;
+
+  key.texture = texture;
+  key.min_filter = texture != NULL ? min_filter : 0;
+  key.mag_filter = texture != NULL ? mag_filter : 0;
+  key.color = clutter_color_to_pixel (color);
+
+  if (G_UNLIKELY (pipeline_cache == NULL))
+    pipeline_cache = g_hash_table_new (pipeline_key_hash, pipeline_key_equal);
+
+  entry = g_hash_table_lookup (pipeline_cache, &key);
+  if (entry != NULL)
+    return cogl_object_ref (entry->pipeline);
+
+  entry = g_slice_new (PipelineCacheEntry);
+  entry->key = key;
+
+  if (texture != NULL)
+    {
+      entry->pipeline = cogl_pipeline_copy (default_texture_pipeline);
+      cogl_pipeline_set_layer_texture (entry->pipeline, 0, texture);
+      cogl_pipeline_set_layer_filters (entry->pipeline, 0,
+                                       min_filter,
+                                       mag_filter);
+    }
+  else
+    entry->pipeline = cogl_pipeline_copy (default_color_pipeline);
+
+  cogl_color_init_from_4ub (&cogl_color,
+                            color->red,
+                            color->green,
+                            color->blue,
+                            color->alpha);
+  cogl_color_premultiply (&cogl_color);
+  cogl_pipeline_set_color (entry->pipeline, &cogl_color);
+
+  /* the cache does not own a reference on the pipeline; the entry is
+   * removed when the last node using the pipeline is destroyed
+   */
+  cogl_object_set_user_data (COGL_OBJECT (entry->pipeline),
+                             &pipeline_cache_entry_key,
+                             entry,
+                             pipeline_cache_entry_free);
+
+  g_hash_table_insert (pipeline_cache, &entry->key, entry);
+
+  return entry->pipeline;
+}
+
 /*
  * Root node, private
  *
@@ -404,14 +533,10 @@ clutter_pipeline_node_draw (ClutterPaintNode *node)
           break;
 
         case PAINT_OP_TEX_RECT:
-          cogl_rectangle_with_texture_coords (op->op.texrect[0],
-                                              op->op.texrect[1],
-                                              op->op.texrect[2],
-                                              op->op.texrect[3],
-                                              op->op.texrect[4],
-                                              op->op.texrect[5],
-                                              op->op.texrect[6],
-                                              op->op.texrect[7]);
+          /* consecutive rectangles share the same source, so we can
+           * submit them all at once
+           */
+          i += _clutter_paint_operation_paint_rectangles (op, node->operations->len - i) - 1;
           break;
 
         case PAINT_OP_PATH:
@@ -557,10 +682,6 @@ clutter_color_node_class_init (ClutterColorNodeClass *klass)
 static void
 clutter_color_node_init (ClutterColorNode *cnode)
 {
-  ClutterPipelineNode *pnode = CLUTTER_PIPELINE_NODE (cnode);
-
-  g_assert (default_color_pipeline != NULL);
-  pnode->pipeline = cogl_pipeline_copy (default_color_pipeline);
 }
 
 /**
@@ -578,23 +699,16 @@ clutter_color_node_init (ClutterColorNode *cnode)
 ClutterPaintNode *
 clutter_color_node_new (const ClutterColor *color)
 {
+  static const ClutterColor default_color = { 0xff, 0xff, 0xff, 0xff };
   ClutterPipelineNode *cnode;
 
-  cnode = _clutter_paint_node_create (CLUTTER_TYPE_COLOR_NODE);
-
-  if (color != NULL)
-    {
-      CoglColor cogl_color;
-
-      cogl_color_init_from_4ub (&cogl_color,
-                                color->red,
-                                color->green,
-                                color->blue,
-                                color->alpha);
-      cogl_color_premultiply (&cogl_color);
+  g_assert (default_color_pipeline != NULL);
 
-      cogl_pipeline_set_color (cnode->pipeline, &cogl_color);
-    }
+  cnode = _clutter_paint_node_create (CLUTTER_TYPE_COLOR_NODE);
+  cnode->pipeline = get_pipeline (NULL,
+                                  color != NULL ? color : &default_color,
+                                  COGL_PIPELINE_FILTER_LINEAR,
+                                  COGL_PIPELINE_FILTER_LINEAR);
 
   return (ClutterPaintNode *) cnode;
 }
@@ -631,10 +745,6 @@ clutter_texture_node_class_init (ClutterTextureNodeClass *klass)
 static void
 clutter_texture_node_init (ClutterTextureNode *self)
 {
-  ClutterPipelineNode *pnode = CLUTTER_PIPELINE_NODE (self);
-
-  g_assert (default_texture_pipeline != NULL);
-  pnode->pipeline = cogl_pipeline_copy (default_texture_pipeline);
 }
 
 static CoglPipelineFilter
@@ -679,26 +789,17 @@ clutter_texture_node_new (CoglTexture          *texture,
                           ClutterScalingFilter  mag_filter)
 {
   ClutterPipelineNode *tnode;
-  CoglColor cogl_color;
   CoglPipelineFilter min_f, mag_f;
 
   g_return_val_if_fail (cogl_is_texture (texture), NULL);
 
-  tnode = _clutter_paint_node_create (CLUTTER_TYPE_TEXTURE_NODE);
+  g_assert (default_texture_pipeline != NULL);
 
-  cogl_pipeline_set_layer_texture (tnode->pipeline, 0, texture);
+  tnode = _clutter_paint_node_create (CLUTTER_TYPE_TEXTURE_NODE);
 
   min_f = clutter_scaling_filter_to_cogl_pipeline_filter (min_filter);
   mag_f = clutter_scaling_filter_to_cogl_pipeline_filter (mag_filter);
-  cogl_pipeline_set_layer_filters (tnode->pipeline, 0, min_f, mag_f);
-
-  cogl_color_init_from_4ub (&cogl_color,
-                            color->red,
-                            color->green,
-                            color->blue,
-                            color->alpha);
-  cogl_color_premultiply (&cogl_color);
-  cogl_pipeline_set_color (tnode->pipeline, &cogl_color);
+  tnode->pipeline = get_pipeline (texture, color, min_f, mag_f);
 
   return (ClutterPaintNode *) tnode;
 }
@@ -1141,14 +1242,7 @@ clutter_layer_node_post_draw (ClutterPaintNode *node)
         case PAINT_OP_TEX_RECT:
           /* now we need to paint the texture */
           cogl_push_source (lnode->state);
-          cogl_rectangle_with_texture_coords (op->op.texrect[0],
-                                              op->op.texrect[1],
-                                              op->op.texrect[2],
-                                              op->op.texrect[3],
-                                              op->op.texrect[4],
-                                              op->op.texrect[5],
-                                              op->op.texrect[6],
-                                              op->op.texrect[7]);
+          i += _clutter_paint_operation_paint_rectangles (op, node->operations->len - i) - 1;
           cogl_pop_source ();
           break;
 
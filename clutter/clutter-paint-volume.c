@@ -848,7 +848,10 @@ void
 _clutter_paint_volume_transform (ClutterPaintVolume *pv,
                                  const CoglMatrix *matrix)
 {
+  ClutterVertex4 transformed[8];
+  ClutterTransformKind kind;
   int transform_count;
+  int i;
 
   if (pv->is_empty)
     {
@@ -873,13 +876,46 @@ _clutter_paint_volume_transform (ClutterPaintVolume *pv,
   else
     transform_count = 8;
 
-  cogl_matrix_transform_points (matrix,
-                                3,
-                                sizeof (ClutterVertex),
-                                pv->vertices,
-                                sizeof (ClutterVertex),
-                                pv->vertices,
-                                transform_count);
+  kind = _clutter_util_matrix_classify (matrix);
+  if (kind == CLUTTER_TRANSFORM_IDENTITY)
+    return;
+
+  /* the transformations keeping the XY plane parallel to itself only
+   * need an affine map of X and Y, and a scale of Z
+   */
+  if (kind != CLUTTER_TRANSFORM_GENERAL)
+    {
+      for (i = 0; i < transform_count; i++)
+        {
+          ClutterVertex *vertex = &pv->vertices[i];
+          float x = vertex->x;
+          float y = vertex->y;
+
+          vertex->x = matrix->xx * x + matrix->xy * y + matrix->xw;
+          vertex->y = matrix->yx * x + matrix->yy * y + matrix->yw;
+          vertex->z = matrix->zz * vertex->z + matrix->zw;
+        }
+
+      /* translations and positive scales keep the volume aligned */
+      if (kind == CLUTTER_TRANSFORM_2D_AFFINE ||
+          (kind == CLUTTER_TRANSFORM_SCALE &&
+           (matrix->xx < 0.f || matrix->yy < 0.f || matrix->zz < 0.f)))
+        pv->is_axis_aligned = FALSE;
+
+      return;
+    }
+
+  _clutter_util_transform_vertices (matrix,
+                                    pv->vertices,
+                                    transformed,
+                                    transform_count);
+
+  for (i = 0; i < transform_count; i++)
+    {
+      pv->vertices[i].x = transformed[i].x;
+      pv->vertices[i].y = transformed[i].y;
+      pv->vertices[i].z = transformed[i].z;
+    }
 
   pv->is_axis_aligned = FALSE;
 }
@@ -1073,9 +1109,7 @@ _clutter_paint_volume_cull (ClutterPaintVolume *pv,
 {
   int vertex_count;
   ClutterVertex *vertices = pv->vertices;
-  gboolean partial = FALSE;
-  int i;
-  int j;
+  guint all_out, any_out;
 
   if (pv->is_empty)
     return CLUTTER_CULL_RESULT_OUT;
@@ -1092,36 +1126,16 @@ _clutter_paint_volume_cull (ClutterPaintVolume *pv,
   else
     vertex_count = 8;
 
-  for (i = 0; i < 4; i++)
-    {
-      int out = 0;
-      for (j = 0; j < vertex_count; j++)
-        {
-          ClutterVertex p;
-          float distance;
-
-          /* XXX: for perspective projections this can be optimized
-           * out because all the planes should pass through the origin
-           * so (0,0,0) is a valid v0. */
-          p.x = vertices[j].x - planes[i].v0[0];
-          p.y = vertices[j].y - planes[i].v0[1];
-          p.z = vertices[j].z - planes[i].v0[2];
-
-          distance = (planes[i].n[0] * p.x +
-                      planes[i].n[1] * p.y +
-                      planes[i].n[2] * p.z);
-
-          if (distance < 0)
-            out++;
-        }
-
-      if (out == vertex_count)
-        return CLUTTER_CULL_RESULT_OUT;
-      else if (out != 0)
-        partial = TRUE;
-    }
+  /* all the vertices are tested against the four planes in one batch */
+  _clutter_util_cull_vertices (planes, vertices, vertex_count,
+                               &all_out, &any_out);
 
-  if (partial)
+  /* the volume is outside if all its vertices are on the outside of
+   * the same plane
+   */
+  if (all_out != 0)
+    return CLUTTER_CULL_RESULT_OUT;
+  else if (any_out != 0)
     return CLUTTER_CULL_RESULT_PARTIAL;
   else
     return CLUTTER_CULL_RESULT_IN;
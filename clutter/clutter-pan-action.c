@@ -49,6 +49,11 @@
  *
  * will automatically result in the actor children to be moved
  * when dragging.
+ *
+ * If the actor is a #ClutterScrollActor, the default handler of the
+ * #ClutterPanAction::pan signal scrolls it instead, so that a
+ * #ClutterPanAction with #ClutterPanAction:interpolate set to %TRUE
+ * provides kinetic scrolling for the scroll actor.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -61,6 +66,8 @@
 #include "clutter-enum-types.h"
 #include "clutter-marshal.h"
 #include "clutter-private.h"
+#include "clutter-scroll-actor-private.h"
+
 #include <math.h>
 
 #define FLOAT_EPSILON   (1e-15)
@@ -70,6 +77,22 @@ static const gfloat reference_fps = 60.0f; // the fps assumed for the decelerati
 static const gfloat default_deceleration_rate = 0.95f;
 static const gfloat default_acceleration_factor = 1.0f;
 
+/* the number of motion samples kept to estimate the velocity of the
+ * pan at the time of the release
+ */
+#define N_VELOCITY_SAMPLES      16
+
+/* only the samples within this many milliseconds from the release
+ * are used to estimate the velocity
+ */
+#define VELOCITY_WINDOW         100
+
+typedef struct
+{
+  guint32 time;
+  gfloat x, y;
+} VelocitySample;
+
 typedef enum
 {
   PAN_STATE_INACTIVE,
@@ -97,6 +120,15 @@ struct _ClutterPanActionPrivate
   gfloat interpolated_y;
   gfloat release_x;
   gfloat release_y;
+  gfloat tau;
+  gfloat target_fraction;
+
+  /* the latest motion samples of the first point, oldest first once
+   * the ring has wrapped around
+   */
+  VelocitySample samples[N_VELOCITY_SAMPLES];
+  guint n_samples;
+  guint next_sample;
 
   guint should_interpolate : 1;
 };
@@ -172,7 +204,17 @@ on_deceleration_new_frame (ClutterTimeline     *timeline,
   gdouble progress;
   gfloat interpolated_x, interpolated_y;
 
-  progress = clutter_timeline_get_progress (timeline);
+  /* the timeline is advanced using the time at which the frame is
+   * going to be presented, so we evaluate the exponential decay of
+   * the velocity at that time, instead of approximating it with an
+   * easing mode
+   *
+   * x(t) = v(0) * tau * [1 - exp(-t/tau)], normalized so that the
+   * target is reached at the end of the timeline
+   */
+  progress = (1.0 - exp (- (gdouble) elapsed_time / priv->tau))
+           / priv->target_fraction;
+  progress = CLAMP (progress, 0.0, 1.0);
 
   interpolated_x = priv->target_x * progress;
   interpolated_y = priv->target_y * progress;
@@ -185,6 +227,99 @@ on_deceleration_new_frame (ClutterTimeline     *timeline,
   emit_pan (self, actor, TRUE);
 }
 
+static void
+add_velocity_sample (ClutterPanActionPrivate *priv,
+                     guint32                  time_,
+                     gfloat                   x,
+                     gfloat                   y)
+{
+  VelocitySample *sample = &priv->samples[priv->next_sample];
+
+  sample->time = time_;
+  sample->x = x;
+  sample->y = y;
+
+  priv->next_sample = (priv->next_sample + 1) % N_VELOCITY_SAMPLES;
+  priv->n_samples = MIN (priv->n_samples + 1, N_VELOCITY_SAMPLES);
+}
+
+static void
+add_velocity_samples_from_event (ClutterPanActionPrivate *priv,
+                                 const ClutterEvent      *event)
+{
+  const ClutterEventSample *history;
+  guint i, n_history;
+  gfloat x, y;
+
+  if (event == NULL)
+    return;
+
+  /* the motion events compressed into @event are older than it,
+   * and carry samples that the gesture action never saw
+   */
+  history = clutter_event_get_history (event, &n_history);
+  for (i = 0; i < n_history; i++)
+    add_velocity_sample (priv, history[i].time, history[i].x, history[i].y);
+
+  clutter_event_get_coords (event, &x, &y);
+  add_velocity_sample (priv, clutter_event_get_time (event), x, y);
+}
+
+/* estimates the velocity, in px/ms, with a least squares fit of the
+ * samples within VELOCITY_WINDOW from the latest one; a single delta
+ * between two events is too noisy, especially with batched input
+ */
+static gboolean
+estimate_velocity (ClutterPanActionPrivate *priv,
+                   gfloat                  *velocity_x,
+                   gfloat                  *velocity_y)
+{
+  const VelocitySample *last;
+  gdouble sum_t = 0, sum_x = 0, sum_y = 0;
+  gdouble sum_tt = 0, sum_tx = 0, sum_ty = 0;
+  gdouble denominator;
+  guint i, n = 0;
+
+  if (priv->n_samples < 2)
+    return FALSE;
+
+  last = &priv->samples[(priv->next_sample + N_VELOCITY_SAMPLES - 1) % N_VELOCITY_SAMPLES];
+
+  for (i = 0; i < priv->n_samples; i++)
+    {
+      const VelocitySample *sample;
+      gdouble t;
+
+      sample = &priv->samples[(priv->next_sample + N_VELOCITY_SAMPLES - 1 - i) % N_VELOCITY_SAMPLES];
+
+      /* the samples are most recent first */
+      if (last->time - sample->time > VELOCITY_WINDOW)
+        break;
+
+      t = - (gdouble) (last->time - sample->time);
+
+      sum_t += t;
+      sum_x += sample->x;
+      sum_y += sample->y;
+      sum_tt += t * t;
+      sum_tx += t * sample->x;
+      sum_ty += t * sample->y;
+      n += 1;
+    }
+
+  if (n < 2)
+    return FALSE;
+
+  denominator = n * sum_tt - sum_t * sum_t;
+  if (denominator < FLOAT_EPSILON)
+    return FALSE;
+
+  *velocity_x = (n * sum_tx - sum_t * sum_x) / denominator;
+  *velocity_y = (n * sum_ty - sum_t * sum_y) / denominator;
+
+  return TRUE;
+}
+
 static gboolean
 gesture_prepare (ClutterGestureAction  *gesture,
                  ClutterActor          *actor)
@@ -209,6 +344,8 @@ gesture_begin (ClutterGestureAction  *gesture,
   priv->interpolated_x = priv->interpolated_y = 0.0f;
   priv->dx = priv->dy = 0.0f;
 
+  priv->n_samples = priv->next_sample = 0;
+
   return TRUE;
 }
 
@@ -218,6 +355,9 @@ gesture_progress (ClutterGestureAction *gesture,
 {
   ClutterPanAction *self = CLUTTER_PAN_ACTION (gesture);
 
+  add_velocity_samples_from_event (self->priv,
+                                   clutter_gesture_action_get_last_event (gesture, 0));
+
   emit_pan (self, actor, FALSE);
 
   return TRUE;
@@ -255,13 +395,22 @@ gesture_end (ClutterGestureAction *gesture,
   priv->state = PAN_STATE_INTERPOLATING;
 
   clutter_gesture_action_get_motion_delta (gesture, 0, &delta_x, &delta_y);
-  velocity = clutter_gesture_action_get_velocity (gesture, 0, &velocity_x, &velocity_y);
+
+  /* the release event is the continuation of the last motion */
+  add_velocity_samples_from_event (priv,
+                                   clutter_gesture_action_get_last_event (gesture, 0));
+
+  if (estimate_velocity (priv, &velocity_x, &velocity_y))
+    velocity = sqrtf (velocity_x * velocity_x + velocity_y * velocity_y);
+  else
+    velocity = clutter_gesture_action_get_velocity (gesture, 0, &velocity_x, &velocity_y);
 
   /* Exponential timing constant v(t) = v(0) * exp(-t/tau)
    * tau = 1000ms / (frame_per_second * - ln(decay_per_frame))
    * with frame_per_second = 60 and decay_per_frame = 0.95, tau ~= 325ms
    * see http://ariya.ofilabs.com/2011/10/flick-list-with-its-momentum-scrolling-and-deceleration.html */
   tau = 1000.0f / (reference_fps * - logf (priv->deceleration_rate));
+  priv->tau = tau;
 
   /* See where the decreasing velocity reaches $min_velocity px/ms
    * v(t) = v(0) * exp(-t/tau) = min_velocity
@@ -275,8 +424,8 @@ gesture_end (ClutterGestureAction *gesture,
   if (ABS (velocity) * priv->acceleration_factor > min_velocity && duration > FLOAT_EPSILON)
     {
       priv->interpolated_x = priv->interpolated_y = 0.0f;
+      priv->target_fraction = 1 - exp ((float)-duration / tau);
       priv->deceleration_timeline = clutter_timeline_new (duration);
-      clutter_timeline_set_progress_mode (priv->deceleration_timeline, CLUTTER_EASE_OUT_EXPO);
 
       g_signal_connect (priv->deceleration_timeline, "new_frame",
                         G_CALLBACK (on_deceleration_new_frame), self);
@@ -315,6 +464,16 @@ clutter_pan_action_real_pan (ClutterPanAction *self,
       break;
     }
 
+  /* moving the origin of a scroll actor only changes its child
+   * transform, so the contents do not need a relayout; the scroll
+   * origin moves in the opposite direction of the pointer
+   */
+  if (CLUTTER_IS_SCROLL_ACTOR (actor))
+    {
+      _clutter_scroll_actor_scroll_by (CLUTTER_SCROLL_ACTOR (actor), -dx, -dy);
+      return TRUE;
+    }
+
   clutter_actor_get_child_transform (actor, &transform);
   cogl_matrix_translate (&transform, dx, dy, 0.0f);
   clutter_actor_set_child_transform (actor, &transform);
@@ -127,6 +127,13 @@ struct _ClutterPathPrivate
   gboolean nodes_dirty;
 
   guint total_length;
+
+  /* the nodes, and the length of the path at the end of each node,
+   * rebuilt with the node data
+   */
+  ClutterPathNodeFull **node_array;
+  guint *node_ends;
+  guint n_node_array;
 };
 
 /* Character tests that don't pay attention to the locale */
@@ -257,6 +264,9 @@ clutter_path_finalize (GObject *object)
 
   clutter_path_clear (self);
 
+  g_free (self->priv->node_array);
+  g_free (self->priv->node_ends);
+
   G_OBJECT_CLASS (clutter_path_parent_class)->finalize (object);
 }
 
@@ -1294,10 +1304,16 @@ clutter_path_ensure_node_data (ClutterPath *path)
       ClutterPoint last_position = { 0, 0 };
       ClutterPoint loop_start = { 0, 0 };
       ClutterPoint points[3];
+      guint i;
 
       priv->total_length = 0;
 
-      for (l = priv->nodes; l; l = l->next)
+      priv->n_node_array = g_slist_length (priv->nodes);
+      priv->node_array = g_renew (ClutterPathNodeFull *, priv->node_array,
+                                  priv->n_node_array);
+      priv->node_ends = g_renew (guint, priv->node_ends, priv->n_node_array);
+
+      for (l = priv->nodes, i = 0; l; l = l->next, i++)
         {
           ClutterPathNodeFull *node = l->data;
           gboolean relative = (node->k.type & CLUTTER_PATH_RELATIVE) != 0;
@@ -1383,12 +1399,97 @@ clutter_path_ensure_node_data (ClutterPath *path)
             }
 
           priv->total_length += node->length;
+
+          priv->node_array[i] = node;
+          priv->node_ends[i] = priv->total_length;
         }
 
       priv->nodes_dirty = FALSE;
     }
 }
 
+/* finds the index of the node that covers @point_distance: the first
+ * node ending past it, or the last node of the path. The search starts
+ * from @hint, which is usually the node of a nearby position
+ */
+static guint
+clutter_path_find_node (ClutterPath *path,
+                        guint        point_distance,
+                        guint        hint)
+{
+  ClutterPathPrivate *priv = path->priv;
+  guint *ends = priv->node_ends;
+  guint last = priv->n_node_array - 1;
+  guint lo, hi;
+
+  if (hint <= last &&
+      point_distance < ends[hint] &&
+      (hint == 0 || point_distance >= ends[hint - 1]))
+    return hint;
+
+  lo = 0;
+  hi = last;
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (point_distance >= ends[mid])
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+static void
+clutter_path_node_get_position (ClutterPath  *path,
+                                guint         node_num,
+                                guint         point_distance,
+                                ClutterPoint *position)
+{
+  ClutterPathPrivate *priv = path->priv;
+  ClutterPathNodeFull *node = priv->node_array[node_num];
+
+  /* Convert the point distance to a distance along the node */
+  point_distance -= MIN (point_distance, priv->node_ends[node_num] - node->length);
+  if (point_distance > node->length)
+    point_distance = node->length;
+
+  switch (node->k.type & ~CLUTTER_PATH_RELATIVE)
+    {
+    case CLUTTER_PATH_MOVE_TO:
+      *position = node->k.points[1];
+      break;
+
+    case CLUTTER_PATH_LINE_TO:
+    case CLUTTER_PATH_CLOSE:
+      if (node->length == 0)
+        *position = node->k.points[1];
+      else
+        {
+          position->x = (node->k.points[1].x
+                         + ((node->k.points[2].x - node->k.points[1].x)
+                            * (gint) point_distance / (gint) node->length));
+          position->y = (node->k.points[1].y
+                         + ((node->k.points[2].y - node->k.points[1].y)
+                            * (gint) point_distance / (gint) node->length));
+        }
+      break;
+
+    case CLUTTER_PATH_CURVE_TO:
+      if (node->length == 0)
+        *position = node->k.points[2];
+      else
+        {
+          _clutter_bezier_advance (node->bezier,
+                                   (gfloat) point_distance / (gfloat) node->length,
+                                   position);
+        }
+      break;
+    }
+}
+
 /**
  * clutter_path_get_position:
  * @path: a #ClutterPath
@@ -1409,9 +1510,7 @@ clutter_path_get_position (ClutterPath  *path,
                            ClutterPoint *position)
 {
   ClutterPathPrivate *priv;
-  GSList *l;
-  guint point_distance, length = 0, node_num = 0;
-  ClutterPathNodeFull *node;
+  guint point_distance, node_num;
 
   g_return_val_if_fail (CLUTTER_IS_PATH (path), 0);
   g_return_val_if_fail (progress >= 0.0 && progress <= 1.0, 0);
@@ -1431,57 +1530,62 @@ clutter_path_get_position (ClutterPath  *path,
   /* Convert the progress to a length along the path */
   point_distance = progress * priv->total_length;
 
-  /* Find the node that covers this point */
-  for (l = priv->nodes;
-       l->next && point_distance >= (((ClutterPathNodeFull *) l->data)->length
-                                     + length);
-       l = l->next)
-    {
-      length += ((ClutterPathNodeFull *) l->data)->length;
-      node_num++;
-    }
+  node_num = clutter_path_find_node (path, point_distance, 0);
+  clutter_path_node_get_position (path, node_num, point_distance, position);
 
-  node = l->data;
+  return node_num;
+}
 
-  /* Convert the point distance to a distance along the node */
-  point_distance -= length;
-  if (point_distance > node->length)
-    point_distance = node->length;
+/**
+ * clutter_path_get_positions:
+ * @path: a #ClutterPath
+ * @n_positions: the number of positions to compute
+ * @progress: (array length=n_positions): the positions along the path,
+ *   as fractions of its length between 0.0 and 1.0
+ * @positions: (array length=n_positions) (out caller-allocates): return
+ *   location for the interpolated positions
+ *
+ * Computes the positions along @path for each value in @progress, like
+ * clutter_path_get_position() does for a single position.
+ *
+ * This function is meant to place many actors following the same
+ * path; computing their positions at once is faster, especially when
+ * the values in @progress are sorted.
+ */
+void
+clutter_path_get_positions (ClutterPath        *path,
+                            guint               n_positions,
+                            const gdouble      *progress,
+                            ClutterPoint       *positions)
+{
+  ClutterPathPrivate *priv;
+  guint i, node_num = 0;
 
-  switch (node->k.type & ~CLUTTER_PATH_RELATIVE)
-    {
-    case CLUTTER_PATH_MOVE_TO:
-      *position = node->k.points[1];
-      break;
+  g_return_if_fail (CLUTTER_IS_PATH (path));
+  g_return_if_fail (n_positions == 0 || progress != NULL);
+  g_return_if_fail (n_positions == 0 || positions != NULL);
 
-    case CLUTTER_PATH_LINE_TO:
-    case CLUTTER_PATH_CLOSE:
-      if (node->length == 0)
-        *position = node->k.points[1];
-      else
-        {
-          position->x = (node->k.points[1].x
-                         + ((node->k.points[2].x - node->k.points[1].x)
-                            * (gint) point_distance / (gint) node->length));
-          position->y = (node->k.points[1].y
-                         + ((node->k.points[2].y - node->k.points[1].y)
-                            * (gint) point_distance / (gint) node->length));
-        }
-      break;
+  priv = path->priv;
 
-    case CLUTTER_PATH_CURVE_TO:
-      if (node->length == 0)
-        *position = node->k.points[2];
-      else
-        {
-          _clutter_bezier_advance (node->bezier,
-                                   (gfloat) point_distance / (gfloat) node->length,
-                                   position);
-        }
-      break;
+  clutter_path_ensure_node_data (path);
+
+  if (priv->nodes == NULL)
+    {
+      memset (positions, 0, sizeof (ClutterPoint) * n_positions);
+      return;
     }
 
-  return node_num;
+  for (i = 0; i < n_positions; i++)
+    {
+      guint point_distance;
+
+      point_distance = CLAMP (progress[i], 0.0, 1.0) * priv->total_length;
+
+      /* start from the node of the previous position */
+      node_num = clutter_path_find_node (path, point_distance, node_num);
+      clutter_path_node_get_position (path, node_num, point_distance,
+                                      &positions[i]);
+    }
 }
 
 /**
@@ -149,6 +149,10 @@ void         clutter_path_to_cairo_path        (ClutterPath           *path,
 guint        clutter_path_get_position         (ClutterPath           *path,
                                                 gdouble                progress,
                                                 ClutterPoint          *position);
+void         clutter_path_get_positions        (ClutterPath           *path,
+                                                guint                  n_positions,
+                                                const gdouble         *progress,
+                                                ClutterPoint          *positions);
 guint        clutter_path_get_length           (ClutterPath           *path);
 
 G_END_DECLS
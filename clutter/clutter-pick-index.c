@@ -0,0 +1,665 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * ClutterPickIndex: a bounding volume hierarchy of stage-space boxes.
+ *
+ * The index is a dynamic binary tree of axis aligned boxes; leaves hold
+ * the user data and a box that has been enlarged by a small margin, so
+ * that small movements do not require restructuring the tree; inner
+ * nodes hold the union of the boxes of their children. Insertions pick
+ * the sibling that minimizes the increase in perimeter of the tree, and
+ * the tree is kept balanced using rotations, so that point queries only
+ * visit O(log n) nodes.
+ *
+ * Nodes are stored in a single array, and leaf handles are indices
+ * inside that array, so they are stable for the whole lifetime of the
+ * leaf.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "clutter-pick-index.h"
+
+#include "clutter-debug.h"
+#include "clutter-private.h"
+
+#define NULL_NODE       (-1)
+
+/* the margin, in pixels, used to enlarge the box of a leaf */
+#define BOX_MARGIN      (4.f)
+
+typedef struct _PickIndexNode   PickIndexNode;
+
+struct _PickIndexNode
+{
+  ClutterActorBox box;
+
+  gpointer data;
+
+  /* the parent of the node, or the next free node */
+  gint parent;
+
+  gint child1;
+  gint child2;
+
+  /* 0 for leaves, -1 for free nodes */
+  gint height;
+};
+
+struct _ClutterPickIndex
+{
+  GArray *nodes;
+
+  gint root;
+  gint free_list;
+
+  guint n_leaves;
+};
+
+#define NODE(index_,i)  (&g_array_index ((index_)->nodes, PickIndexNode, (i)))
+#define IS_LEAF(n)      ((n)->child1 == NULL_NODE)
+
+static inline gfloat
+box_perimeter (const ClutterActorBox *box)
+{
+  return 2.f * ((box->x2 - box->x1) + (box->y2 - box->y1));
+}
+
+static inline void
+box_union (const ClutterActorBox *a,
+           const ClutterActorBox *b,
+           ClutterActorBox       *res)
+{
+  res->x1 = MIN (a->x1, b->x1);
+  res->y1 = MIN (a->y1, b->y1);
+  res->x2 = MAX (a->x2, b->x2);
+  res->y2 = MAX (a->y2, b->y2);
+}
+
+static inline gboolean
+box_contains_box (const ClutterActorBox *outer,
+                  const ClutterActorBox *inner)
+{
+  return outer->x1 <= inner->x1 &&
+         outer->y1 <= inner->y1 &&
+         outer->x2 >= inner->x2 &&
+         outer->y2 >= inner->y2;
+}
+
+static inline gboolean
+box_contains_point (const ClutterActorBox *box,
+                    gfloat                 x,
+                    gfloat                 y)
+{
+  return x >= box->x1 && x <= box->x2 &&
+         y >= box->y1 && y <= box->y2;
+}
+
+static gint
+pick_index_allocate_node (ClutterPickIndex *index_)
+{
+  PickIndexNode *node;
+  gint i;
+
+  if (index_->free_list == NULL_NODE)
+    {
+      PickIndexNode empty = { { 0, }, NULL, NULL_NODE, NULL_NODE, NULL_NODE, -1 };
+
+      g_array_append_val (index_->nodes, empty);
+      i = index_->nodes->len - 1;
+    }
+  else
+    {
+      i = index_->free_list;
+      index_->free_list = NODE (index_, i)->parent;
+    }
+
+  node = NODE (index_, i);
+  node->data = NULL;
+  node->parent = NULL_NODE;
+  node->child1 = NULL_NODE;
+  node->child2 = NULL_NODE;
+  node->height = 0;
+
+  return i;
+}
+
+static void
+pick_index_free_node (ClutterPickIndex *index_,
+                      gint              i)
+{
+  PickIndexNode *node = NODE (index_, i);
+
+  node->data = NULL;
+  node->height = -1;
+  node->parent = index_->free_list;
+  index_->free_list = i;
+}
+
+/* performs a left or right rotation if the node at @a is imbalanced,
+ * and returns the new root of the sub-tree
+ */
+static gint
+pick_index_balance (ClutterPickIndex *index_,
+                    gint              ia)
+{
+  PickIndexNode *a, *b, *c;
+  gint ib, ic, balance;
+
+  a = NODE (index_, ia);
+  if (IS_LEAF (a) || a->height < 2)
+    return ia;
+
+  ib = a->child1;
+  ic = a->child2;
+  b = NODE (index_, ib);
+  c = NODE (index_, ic);
+
+  balance = c->height - b->height;
+
+  /* rotate c up */
+  if (balance > 1)
+    {
+      gint i_f = c->child1;
+      gint i_g = c->child2;
+      PickIndexNode *f = NODE (index_, i_f);
+      PickIndexNode *g = NODE (index_, i_g);
+
+      c->child1 = ia;
+      c->parent = a->parent;
+      a->parent = ic;
+
+      if (c->parent != NULL_NODE)
+        {
+          PickIndexNode *p = NODE (index_, c->parent);
+
+          if (p->child1 == ia)
+            p->child1 = ic;
+          else
+            p->child2 = ic;
+        }
+      else
+        index_->root = ic;
+
+      if (f->height > g->height)
+        {
+          c->child2 = i_f;
+          a->child2 = i_g;
+          g->parent = ia;
+          box_union (&b->box, &g->box, &a->box);
+          box_union (&a->box, &f->box, &c->box);
+          a->height = 1 + MAX (b->height, g->height);
+          c->height = 1 + MAX (a->height, f->height);
+        }
+      else
+        {
+          c->child2 = i_g;
+          a->child2 = i_f;
+          f->parent = ia;
+          box_union (&b->box, &f->box, &a->box);
+          box_union (&a->box, &g->box, &c->box);
+          a->height = 1 + MAX (b->height, f->height);
+          c->height = 1 + MAX (a->height, g->height);
+        }
+
+      return ic;
+    }
+
+  /* rotate b up */
+  if (balance < -1)
+    {
+      gint i_d = b->child1;
+      gint i_e = b->child2;
+      PickIndexNode *d = NODE (index_, i_d);
+      PickIndexNode *e = NODE (index_, i_e);
+
+      b->child1 = ia;
+      b->parent = a->parent;
+      a->parent = ib;
+
+      if (b->parent != NULL_NODE)
+        {
+          PickIndexNode *p = NODE (index_, b->parent);
+
+          if (p->child1 == ia)
+            p->child1 = ib;
+          else
+            p->child2 = ib;
+        }
+      else
+        index_->root = ib;
+
+      if (d->height > e->height)
+        {
+          b->child2 = i_d;
+          a->child1 = i_e;
+          e->parent = ia;
+          box_union (&c->box, &e->box, &a->box);
+          box_union (&a->box, &d->box, &b->box);
+          a->height = 1 + MAX (c->height, e->height);
+          b->height = 1 + MAX (a->height, d->height);
+        }
+      else
+        {
+          b->child2 = i_e;
+          a->child1 = i_d;
+          d->parent = ia;
+          box_union (&c->box, &d->box, &a->box);
+          box_union (&a->box, &e->box, &b->box);
+          a->height = 1 + MAX (c->height, d->height);
+          b->height = 1 + MAX (a->height, e->height);
+        }
+
+      return ib;
+    }
+
+  return ia;
+}
+
+/* walks back from @i to the root, refitting boxes and heights */
+static void
+pick_index_refit (ClutterPickIndex *index_,
+                  gint              i)
+{
+  while (i != NULL_NODE)
+    {
+      PickIndexNode *node, *child1, *child2;
+
+      i = pick_index_balance (index_, i);
+
+      node = NODE (index_, i);
+      child1 = NODE (index_, node->child1);
+      child2 = NODE (index_, node->child2);
+
+      node->height = 1 + MAX (child1->height, child2->height);
+      box_union (&child1->box, &child2->box, &node->box);
+
+      i = node->parent;
+    }
+}
+
+static void
+pick_index_insert_leaf (ClutterPickIndex *index_,
+                        gint              leaf)
+{
+  ClutterActorBox leaf_box;
+  gint sibling, old_parent, new_parent;
+
+  if (index_->root == NULL_NODE)
+    {
+      index_->root = leaf;
+      NODE (index_, leaf)->parent = NULL_NODE;
+      return;
+    }
+
+  leaf_box = NODE (index_, leaf)->box;
+
+  /* find the best sibling for the new leaf, by descending the tree
+   * and choosing the cheapest branch each time
+   */
+  sibling = index_->root;
+  while (!IS_LEAF (NODE (index_, sibling)))
+    {
+      PickIndexNode *node = NODE (index_, sibling);
+      ClutterActorBox combined;
+      gfloat area, combined_area, cost, inheritance_cost;
+      gfloat cost1 = 0.f, cost2 = 0.f;
+      gint children[2], j;
+
+      area = box_perimeter (&node->box);
+
+      box_union (&node->box, &leaf_box, &combined);
+      combined_area = box_perimeter (&combined);
+
+      /* cost of creating a new parent for this node and the leaf */
+      cost = 2.f * combined_area;
+
+      /* minimum cost of pushing the leaf further down the tree */
+      inheritance_cost = 2.f * (combined_area - area);
+
+      children[0] = node->child1;
+      children[1] = node->child2;
+
+      for (j = 0; j < 2; j++)
+        {
+          PickIndexNode *child = NODE (index_, children[j]);
+          ClutterActorBox child_box;
+          gfloat child_cost;
+
+          box_union (&leaf_box, &child->box, &child_box);
+
+          if (IS_LEAF (child))
+            child_cost = box_perimeter (&child_box) + inheritance_cost;
+          else
+            child_cost = box_perimeter (&child_box)
+                       - box_perimeter (&child->box)
+                       + inheritance_cost;
+
+          if (j == 0)
+            cost1 = child_cost;
+          else
+            cost2 = child_cost;
+        }
+
+      if (cost < cost1 && cost < cost2)
+        break;
+
+      sibling = cost1 < cost2 ? children[0] : children[1];
+    }
+
+  /* create a new parent for the leaf and its sibling */
+  old_parent = NODE (index_, sibling)->parent;
+  new_parent = pick_index_allocate_node (index_);
+
+  {
+    PickIndexNode *parent = NODE (index_, new_parent);
+    PickIndexNode *sibling_node = NODE (index_, sibling);
+
+    parent->parent = old_parent;
+    parent->data = NULL;
+    box_union (&leaf_box, &sibling_node->box, &parent->box);
+    parent->height = sibling_node->height + 1;
+    parent->child1 = sibling;
+    parent->child2 = leaf;
+
+    sibling_node->parent = new_parent;
+    NODE (index_, leaf)->parent = new_parent;
+  }
+
+  if (old_parent != NULL_NODE)
+    {
+      PickIndexNode *node = NODE (index_, old_parent);
+
+      if (node->child1 == sibling)
+        node->child1 = new_parent;
+      else
+        node->child2 = new_parent;
+    }
+  else
+    index_->root = new_parent;
+
+  pick_index_refit (index_, NODE (index_, leaf)->parent);
+}
+
+static void
+pick_index_remove_leaf (ClutterPickIndex *index_,
+                        gint              leaf)
+{
+  gint parent, grand_parent, sibling;
+  PickIndexNode *parent_node;
+
+  if (leaf == index_->root)
+    {
+      index_->root = NULL_NODE;
+      return;
+    }
+
+  parent = NODE (index_, leaf)->parent;
+  parent_node = NODE (index_, parent);
+  grand_parent = parent_node->parent;
+  sibling = parent_node->child1 == leaf
+          ? parent_node->child2
+          : parent_node->child1;
+
+  if (grand_parent != NULL_NODE)
+    {
+      PickIndexNode *node = NODE (index_, grand_parent);
+
+      /* replace the parent with the sibling */
+      if (node->child1 == parent)
+        node->child1 = sibling;
+      else
+        node->child2 = sibling;
+
+      NODE (index_, sibling)->parent = grand_parent;
+      pick_index_free_node (index_, parent);
+
+      pick_index_refit (index_, grand_parent);
+    }
+  else
+    {
+      index_->root = sibling;
+      NODE (index_, sibling)->parent = NULL_NODE;
+      pick_index_free_node (index_, parent);
+    }
+}
+
+static inline void
+fatten_box (const ClutterActorBox *box,
+            ClutterActorBox       *res)
+{
+  res->x1 = box->x1 - BOX_MARGIN;
+  res->y1 = box->y1 - BOX_MARGIN;
+  res->x2 = box->x2 + BOX_MARGIN;
+  res->y2 = box->y2 + BOX_MARGIN;
+}
+
+ClutterPickIndex *
+_clutter_pick_index_new (void)
+{
+  ClutterPickIndex *index_;
+
+  index_ = g_slice_new (ClutterPickIndex);
+  index_->nodes = g_array_sized_new (FALSE, FALSE, sizeof (PickIndexNode), 64);
+  index_->root = NULL_NODE;
+  index_->free_list = NULL_NODE;
+  index_->n_leaves = 0;
+
+  return index_;
+}
+
+void
+_clutter_pick_index_free (ClutterPickIndex *index_)
+{
+  g_return_if_fail (index_ != NULL);
+
+  g_array_free (index_->nodes, TRUE);
+  g_slice_free (ClutterPickIndex, index_);
+}
+
+/*< private >
+ * _clutter_pick_index_insert:
+ * @index_: a #ClutterPickIndex
+ * @box: the box of the new leaf, in stage coordinates
+ * @data: the data associated to the leaf
+ *
+ * Inserts a new leaf inside the index.
+ *
+ * Return value: a handle for the leaf, to be used with
+ *   _clutter_pick_index_update() and _clutter_pick_index_remove()
+ */
+gint
+_clutter_pick_index_insert (ClutterPickIndex      *index_,
+                            const ClutterActorBox *box,
+                            gpointer               data)
+{
+  PickIndexNode *node;
+  gint leaf;
+
+  g_return_val_if_fail (index_ != NULL, NULL_NODE);
+  g_return_val_if_fail (box != NULL, NULL_NODE);
+
+  leaf = pick_index_allocate_node (index_);
+
+  node = NODE (index_, leaf);
+  fatten_box (box, &node->box);
+  node->data = data;
+  node->height = 0;
+
+  pick_index_insert_leaf (index_, leaf);
+
+  index_->n_leaves += 1;
+
+  return leaf;
+}
+
+/*< private >
+ * _clutter_pick_index_update:
+ * @index_: a #ClutterPickIndex
+ * @handle: the handle returned by _clutter_pick_index_insert()
+ * @box: the new box of the leaf, in stage coordinates
+ *
+ * Updates the box of a leaf. If the new box is still contained by
+ * the enlarged box of the leaf this function is cheap, otherwise the
+ * leaf will be moved inside the tree. The handle of the leaf is left
+ * unchanged.
+ */
+void
+_clutter_pick_index_update (ClutterPickIndex      *index_,
+                            gint                   handle,
+                            const ClutterActorBox *box)
+{
+  PickIndexNode *node;
+
+  g_return_if_fail (index_ != NULL);
+  g_return_if_fail (handle >= 0 && (guint) handle < index_->nodes->len);
+
+  node = NODE (index_, handle);
+
+  g_assert (IS_LEAF (node) && node->height == 0);
+
+  if (box_contains_box (&node->box, box))
+    {
+      ClutterActorBox fat_box;
+
+      /* we shrink the leaf only if the enlarged box is obviously
+       * too big, to avoid accumulating false positives
+       */
+      fatten_box (box, &fat_box);
+      fat_box.x1 -= BOX_MARGIN;
+      fat_box.y1 -= BOX_MARGIN;
+      fat_box.x2 += BOX_MARGIN;
+      fat_box.y2 += BOX_MARGIN;
+
+      if (box_contains_box (&fat_box, &node->box))
+        return;
+    }
+
+  pick_index_remove_leaf (index_, handle);
+
+  node = NODE (index_, handle);
+  fatten_box (box, &node->box);
+
+  pick_index_insert_leaf (index_, handle);
+}
+
+/*< private >
+ * _clutter_pick_index_remove:
+ * @index_: a #ClutterPickIndex
+ * @handle: the handle returned by _clutter_pick_index_insert()
+ *
+ * Removes a leaf from the index.
+ */
+void
+_clutter_pick_index_remove (ClutterPickIndex *index_,
+                            gint              handle)
+{
+  g_return_if_fail (index_ != NULL);
+  g_return_if_fail (handle >= 0 && (guint) handle < index_->nodes->len);
+
+  pick_index_remove_leaf (index_, handle);
+  pick_index_free_node (index_, handle);
+
+  index_->n_leaves -= 1;
+}
+
+/*< private >
+ * _clutter_pick_index_query_point:
+ * @index_: a #ClutterPickIndex
+ * @x: the X coordinate of the point, in stage coordinates
+ * @y: the Y coordinate of the point, in stage coordinates
+ * @results: a #GPtrArray
+ *
+ * Appends to @results the data of each leaf whose box contains the
+ * given point. Since the boxes of the leaves are enlarged, the
+ * results are a conservative approximation.
+ */
+void
+_clutter_pick_index_query_point (ClutterPickIndex *index_,
+                                 gfloat            x,
+                                 gfloat            y,
+                                 GPtrArray        *results)
+{
+  gint stack_static[64];
+  gint *stack = stack_static;
+  gint stack_size = G_N_ELEMENTS (stack_static);
+  gint n_stack = 0;
+
+  g_return_if_fail (index_ != NULL);
+  g_return_if_fail (results != NULL);
+
+  if (index_->root == NULL_NODE)
+    return;
+
+  stack[n_stack++] = index_->root;
+
+  while (n_stack > 0)
+    {
+      PickIndexNode *node = NODE (index_, stack[--n_stack]);
+
+      if (!box_contains_point (&node->box, x, y))
+        continue;
+
+      if (IS_LEAF (node))
+        {
+          g_ptr_array_add (results, node->data);
+          continue;
+        }
+
+      if (n_stack + 2 > stack_size)
+        {
+          gint *new_stack = g_new (gint, stack_size * 2);
+
+          memcpy (new_stack, stack, sizeof (gint) * n_stack);
+
+          if (stack != stack_static)
+            g_free (stack);
+
+          stack = new_stack;
+          stack_size *= 2;
+        }
+
+      stack[n_stack++] = node->child1;
+      stack[n_stack++] = node->child2;
+    }
+
+  if (stack != stack_static)
+    g_free (stack);
+}
+
+/*< private >
+ * _clutter_pick_index_get_size:
+ * @index_: a #ClutterPickIndex
+ *
+ * Retrieves the number of leaves inside the index.
+ *
+ * Return value: the number of leaves
+ */
+guint
+_clutter_pick_index_get_size (ClutterPickIndex *index_)
+{
+  g_return_val_if_fail (index_ != NULL, 0);
+
+  return index_->n_leaves;
+}
@@ -0,0 +1,54 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * ClutterPickIndex: a bounding volume hierarchy of stage-space boxes.
+ */
+
+#ifndef __CLUTTER_PICK_INDEX_H__
+#define __CLUTTER_PICK_INDEX_H__
+
+#include <clutter/clutter-types.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ClutterPickIndex        ClutterPickIndex;
+
+ClutterPickIndex *      _clutter_pick_index_new         (void);
+void                    _clutter_pick_index_free        (ClutterPickIndex      *index_);
+
+gint                    _clutter_pick_index_insert      (ClutterPickIndex      *index_,
+                                                         const ClutterActorBox *box,
+                                                         gpointer               data);
+void                    _clutter_pick_index_update      (ClutterPickIndex      *index_,
+                                                         gint                   handle,
+                                                         const ClutterActorBox *box);
+void                    _clutter_pick_index_remove      (ClutterPickIndex      *index_,
+                                                         gint                   handle);
+
+void                    _clutter_pick_index_query_point (ClutterPickIndex      *index_,
+                                                         gfloat                 x,
+                                                         gfloat                 y,
+                                                         GPtrArray             *results);
+
+guint                   _clutter_pick_index_get_size    (ClutterPickIndex      *index_);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_PICK_INDEX_H__ */
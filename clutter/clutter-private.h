@@ -249,12 +249,48 @@ gboolean _clutter_boolean_continue_accumulator (GSignalInvocationHint *ihint,
                                                 gpointer               dummy);
 
 void _clutter_run_repaint_functions (ClutterRepaintFlags flags);
+gboolean _clutter_has_repaint_functions (ClutterRepaintFlags flags);
+void _clutter_accessibility_ensure_initialized (void);
+gboolean _clutter_threads_has_pending_tasks (void);
 
 void _clutter_constraint_update_allocation (ClutterConstraint *constraint,
                                             ClutterActor      *actor,
                                             ClutterActorBox   *allocation);
+ClutterActor *_clutter_constraint_get_source (ClutterConstraint *constraint);
 
 GType _clutter_layout_manager_get_child_meta_type (ClutterLayoutManager *manager);
+ClutterLayoutMeta *_clutter_layout_manager_get_child_meta (ClutterLayoutManager *manager,
+                                                           ClutterContainer     *container,
+                                                           ClutterActor         *actor);
+void _clutter_layout_manager_child_set_pspec (ClutterLayoutManager *manager,
+                                              ClutterContainer     *container,
+                                              ClutterActor         *actor,
+                                              GParamSpec           *pspec,
+                                              const GValue         *value);
+
+/*< private >
+ * ClutterTransformKind:
+ * @CLUTTER_TRANSFORM_IDENTITY: the identity
+ * @CLUTTER_TRANSFORM_TRANSLATE: a translation
+ * @CLUTTER_TRANSFORM_SCALE: a scale along the axes, and a translation
+ * @CLUTTER_TRANSFORM_2D_AFFINE: an affine transformation of the X and Y
+ *   coordinates, like a rotation around the Z axis, with a scale and a
+ *   translation of the Z coordinate
+ * @CLUTTER_TRANSFORM_GENERAL: any other transformation, like a rotation
+ *   around the X or Y axis, or a perspective
+ *
+ * The kinds of transformations classified by
+ * _clutter_util_matrix_classify(), from the simplest.
+ */
+typedef enum {
+  CLUTTER_TRANSFORM_IDENTITY,
+  CLUTTER_TRANSFORM_TRANSLATE,
+  CLUTTER_TRANSFORM_SCALE,
+  CLUTTER_TRANSFORM_2D_AFFINE,
+  CLUTTER_TRANSFORM_GENERAL
+} ClutterTransformKind;
+
+ClutterTransformKind _clutter_util_matrix_classify (const CoglMatrix *matrix);
 
 void  _clutter_util_fully_transform_vertices (const CoglMatrix    *modelview,
                                               const CoglMatrix    *projection,
@@ -319,7 +355,56 @@ typedef enum _ClutterCullResult
   CLUTTER_CULL_RESULT_PARTIAL
 } ClutterCullResult;
 
+void    _clutter_util_transform_vertices        (const CoglMatrix    *matrix,
+                                                 const ClutterVertex *vertices_in,
+                                                 ClutterVertex4      *vertices_out,
+                                                 int                  n_vertices);
+void    _clutter_util_cull_vertices             (const ClutterPlane  *planes,
+                                                 const ClutterVertex *vertices,
+                                                 int                  n_vertices,
+                                                 guint               *all_out,
+                                                 guint               *any_out);
+
+/*< private >
+ * CLUTTER_MAX_OCCLUDERS:
+ *
+ * The maximum number of opaque areas tracked while painting a stage.
+ */
+#define CLUTTER_MAX_OCCLUDERS   8
+
+/*< private >
+ * ClutterOccluder:
+ * @box: the opaque area, in window coordinates
+ * @paint_index: the position of the opaque actor in the paint order
+ *
+ * An area of the stage covered by opaque pixels.
+ */
+typedef struct _ClutterOccluder
+{
+  ClutterActorBox box;
+
+  guint paint_index;
+} ClutterOccluder;
+
+/*< private >
+ * ClutterOcclusion:
+ * @serial: the serial of the paint using the occluders
+ * @n_occluders: the number of valid occluders
+ * @occluders: the largest opaque areas of the stage
+ *
+ * The opaque areas of the stage, computed before each paint by
+ * _clutter_actor_compute_occlusion().
+ */
+typedef struct _ClutterOcclusion
+{
+  guint serial;
+
+  guint n_occluders;
+  ClutterOccluder occluders[CLUTTER_MAX_OCCLUDERS];
+} ClutterOcclusion;
+
 gboolean        _clutter_has_progress_function  (GType gtype);
+gboolean        _clutter_has_overridden_progress_function (GType gtype);
 gboolean        _clutter_run_progress_function  (GType gtype,
                                                  const GValue *initial,
                                                  const GValue *final,
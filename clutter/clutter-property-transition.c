@@ -36,9 +36,12 @@
 
 #include "clutter-property-transition.h"
 
+#include "clutter-actor-private.h"
 #include "clutter-animatable.h"
+#include "clutter-color.h"
 #include "clutter-debug.h"
 #include "clutter-interval.h"
+#include "clutter-master-clock.h"
 #include "clutter-private.h"
 #include "clutter-transition.h"
 
@@ -47,6 +50,18 @@ struct _ClutterPropertyTransitionPrivate
   char *property_name;
 
   GParamSpec *pspec;
+
+  /* the type of the direct setter of the property, resolved when the
+   * transition is attached, or G_TYPE_INVALID if the value has to go
+   * through a GValue and the ClutterAnimatable interface
+   */
+  GType direct_type;
+
+  /* whether the values are computed when the actor is about to be
+   * painted, and whether the property can be animated that way
+   */
+  guint evaluate_on_paint : 1;
+  guint paint_time        : 1;
 };
 
 enum
@@ -54,6 +69,7 @@ enum
   PROP_0,
 
   PROP_PROPERTY_NAME,
+  PROP_EVALUATE_ON_PAINT,
 
   PROP_LAST
 };
@@ -94,6 +110,330 @@ clutter_property_transition_ensure_interval (ClutterPropertyTransition *transiti
     }
 }
 
+static void
+clutter_property_transition_resolve_direct_type (ClutterPropertyTransition *transition,
+                                                 ClutterAnimatable         *animatable)
+{
+  ClutterPropertyTransitionPrivate *priv = transition->priv;
+  GType value_type;
+
+  priv->direct_type = G_TYPE_INVALID;
+  priv->paint_time = FALSE;
+
+  /* the properties of the actor metas are set through the actor */
+  if (priv->pspec == NULL ||
+      !CLUTTER_IS_ACTOR (animatable) ||
+      priv->property_name[0] == '@')
+    return;
+
+  /* a custom interpolation replaces the interval */
+  if (CLUTTER_ANIMATABLE_GET_IFACE (animatable)->interpolate_value != NULL)
+    return;
+
+  value_type =
+    _clutter_actor_get_animatable_value_type (CLUTTER_ACTOR (animatable),
+                                              priv->pspec);
+
+  /* the direct path interpolates like the default progress functions */
+  if (value_type == G_TYPE_FLOAT || value_type == G_TYPE_DOUBLE)
+    {
+      if (_clutter_has_progress_function (value_type))
+        return;
+    }
+  else if (value_type != G_TYPE_INVALID)
+    {
+      if (_clutter_has_overridden_progress_function (value_type))
+        return;
+    }
+
+  priv->direct_type = value_type;
+
+  /* sub-classes can override the computation of the frames */
+  priv->paint_time =
+    G_OBJECT_TYPE (transition) == CLUTTER_TYPE_PROPERTY_TRANSITION &&
+    _clutter_actor_is_paint_time_property (CLUTTER_ACTOR (animatable),
+                                           priv->pspec) &&
+    !_clutter_has_progress_function (G_PARAM_SPEC_VALUE_TYPE (priv->pspec));
+}
+
+/* interpolates the scalar properties that can be evaluated on paint */
+static gboolean
+clutter_property_transition_interpolate_scalar (ClutterInterval *interval,
+                                                gdouble          progress,
+                                                gdouble         *value)
+{
+  const GValue *initial, *final;
+  gdouble ia, ib;
+
+  if (G_OBJECT_TYPE (interval) != CLUTTER_TYPE_INTERVAL ||
+      !clutter_interval_is_valid (interval))
+    return FALSE;
+
+  initial = clutter_interval_peek_initial_value (interval);
+  final = clutter_interval_peek_final_value (interval);
+
+  switch (clutter_interval_get_value_type (interval))
+    {
+    case G_TYPE_FLOAT:
+      ia = g_value_get_float (initial);
+      ib = g_value_get_float (final);
+      break;
+
+    case G_TYPE_DOUBLE:
+      ia = g_value_get_double (initial);
+      ib = g_value_get_double (final);
+      break;
+
+    case G_TYPE_UINT:
+      ia = g_value_get_uint (initial);
+      ib = g_value_get_uint (final);
+      break;
+
+    default:
+      return FALSE;
+    }
+
+  *value = (progress * (ib - ia)) + ia;
+
+  return TRUE;
+}
+
+/*
+ * _clutter_property_transition_update_paint_value:
+ * @transition: a #ClutterTransition
+ * @actor: the #ClutterActor being animated by @transition
+ *
+ * Computes the value of the property animated by @transition, which
+ * was scheduled on @actor with _clutter_actor_schedule_paint_transition(),
+ * from the current progress of the timeline, and stores it inside the
+ * actor without notifying the change.
+ */
+void
+_clutter_property_transition_update_paint_value (ClutterTransition *transition,
+                                                 ClutterActor      *actor)
+{
+  ClutterPropertyTransitionPrivate *priv;
+  ClutterInterval *interval;
+  gdouble progress, value;
+
+  priv = CLUTTER_PROPERTY_TRANSITION (transition)->priv;
+  if (priv->pspec == NULL)
+    return;
+
+  interval = clutter_transition_get_interval (transition);
+  if (interval == NULL)
+    return;
+
+  progress = clutter_timeline_get_progress (CLUTTER_TIMELINE (transition));
+
+  if (clutter_property_transition_interpolate_scalar (interval, progress, &value))
+    _clutter_actor_set_paint_time_value (actor, priv->pspec, value);
+}
+
+/* commits the last value evaluated on paint to the actor, notifying
+ * the property; the value is recomputed because the actor may not
+ * have been painted since the last frame
+ */
+static void
+clutter_property_transition_commit_paint_value (ClutterPropertyTransition *transition,
+                                                ClutterAnimatable         *animatable)
+{
+  ClutterPropertyTransitionPrivate *priv = transition->priv;
+  ClutterInterval *interval;
+  gdouble progress, value;
+
+  if (animatable == NULL || priv->pspec == NULL || !priv->paint_time)
+    return;
+
+  if (!_clutter_actor_unschedule_paint_transition (CLUTTER_ACTOR (animatable),
+                                                   CLUTTER_TRANSITION (transition)))
+    return;
+
+  interval = clutter_transition_get_interval (CLUTTER_TRANSITION (transition));
+  if (interval == NULL)
+    return;
+
+  progress = clutter_timeline_get_progress (CLUTTER_TIMELINE (transition));
+
+  if (!clutter_property_transition_interpolate_scalar (interval, progress, &value))
+    return;
+
+  /* the value may already be stored inside the actor, so the setters
+   * would skip the notification
+   */
+  _clutter_actor_set_paint_time_value (CLUTTER_ACTOR (animatable),
+                                       priv->pspec,
+                                       value);
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (animatable));
+  g_object_notify_by_pspec (G_OBJECT (animatable), priv->pspec);
+}
+
+/* interpolates the interval and sets the value without going through
+ * a GValue; returns FALSE if the interval cannot be used directly
+ */
+static gboolean
+clutter_property_transition_compute_direct (ClutterPropertyTransition *transition,
+                                            ClutterActor              *actor,
+                                            ClutterInterval           *interval,
+                                            gdouble                    progress)
+{
+  ClutterPropertyTransitionPrivate *priv = transition->priv;
+  const GValue *initial, *final;
+
+  /* sub-classes of ClutterInterval can override the computation */
+  if (G_OBJECT_TYPE (interval) != CLUTTER_TYPE_INTERVAL ||
+      clutter_interval_get_value_type (interval) != priv->direct_type)
+    return FALSE;
+
+  initial = clutter_interval_peek_initial_value (interval);
+  final = clutter_interval_peek_final_value (interval);
+
+  if (priv->direct_type == G_TYPE_FLOAT)
+    {
+      gdouble ia = g_value_get_float (initial);
+      gdouble ib = g_value_get_float (final);
+
+      _clutter_actor_set_animatable_float (actor, priv->pspec,
+                                           (progress * (ib - ia)) + ia);
+    }
+  else if (priv->direct_type == G_TYPE_DOUBLE)
+    {
+      gdouble ia = g_value_get_double (initial);
+      gdouble ib = g_value_get_double (final);
+
+      _clutter_actor_set_animatable_double (actor, priv->pspec,
+                                            (progress * (ib - ia)) + ia);
+    }
+  else if (priv->direct_type == CLUTTER_TYPE_COLOR)
+    {
+      const ClutterColor *a = clutter_value_get_color (initial);
+      const ClutterColor *b = clutter_value_get_color (final);
+      ClutterColor res;
+
+      if (a == NULL || b == NULL)
+        return FALSE;
+
+      clutter_color_interpolate (a, b, progress, &res);
+      _clutter_actor_set_animatable_color (actor, priv->pspec, &res);
+    }
+  else if (priv->direct_type == CLUTTER_TYPE_POINT)
+    {
+      const ClutterPoint *a = g_value_get_boxed (initial);
+      const ClutterPoint *b = g_value_get_boxed (final);
+      ClutterPoint res;
+
+      if (a == NULL || b == NULL)
+        return FALSE;
+
+      res.x = a->x + (b->x - a->x) * progress;
+      res.y = a->y + (b->y - a->y) * progress;
+      _clutter_actor_set_animatable_point (actor, priv->pspec, &res);
+    }
+  else
+    return FALSE;
+
+  return TRUE;
+}
+
+/*
+ * _clutter_property_transition_get_direct_interval:
+ * @timeline: a #ClutterTimeline
+ * @initial: (out): return location for the initial value
+ * @final: (out): return location for the final value
+ *
+ * Checks whether @timeline is a #ClutterPropertyTransition whose
+ * frames only interpolate a float or double property of an actor:
+ * the master clock can then compute the values of many of them in
+ * one pass, and set them with _clutter_property_transition_set_direct_value().
+ *
+ * Return value: %TRUE if the bounds of the interval were retrieved
+ */
+gboolean
+_clutter_property_transition_get_direct_interval (ClutterTimeline *timeline,
+                                                  gdouble         *initial,
+                                                  gdouble         *final)
+{
+  ClutterPropertyTransitionPrivate *priv;
+  ClutterTransition *transition;
+  ClutterInterval *interval;
+  const GValue *value_p;
+
+  /* sub-classes can override the computation of the frames */
+  if (G_OBJECT_TYPE (timeline) != CLUTTER_TYPE_PROPERTY_TRANSITION)
+    return FALSE;
+
+  priv = CLUTTER_PROPERTY_TRANSITION (timeline)->priv;
+
+  if (priv->pspec == NULL ||
+      (priv->direct_type != G_TYPE_FLOAT &&
+       priv->direct_type != G_TYPE_DOUBLE))
+    return FALSE;
+
+  /* the values are evaluated when painting */
+  if (priv->evaluate_on_paint && priv->paint_time)
+    return FALSE;
+
+  transition = CLUTTER_TRANSITION (timeline);
+  if (clutter_transition_get_animatable (transition) == NULL)
+    return FALSE;
+
+  interval = clutter_transition_get_interval (transition);
+  if (interval == NULL ||
+      G_OBJECT_TYPE (interval) != CLUTTER_TYPE_INTERVAL ||
+      clutter_interval_get_value_type (interval) != priv->direct_type ||
+      !clutter_interval_is_valid (interval))
+    return FALSE;
+
+  if (priv->direct_type == G_TYPE_FLOAT)
+    {
+      value_p = clutter_interval_peek_initial_value (interval);
+      *initial = g_value_get_float (value_p);
+      value_p = clutter_interval_peek_final_value (interval);
+      *final = g_value_get_float (value_p);
+    }
+  else
+    {
+      value_p = clutter_interval_peek_initial_value (interval);
+      *initial = g_value_get_double (value_p);
+      value_p = clutter_interval_peek_final_value (interval);
+      *final = g_value_get_double (value_p);
+    }
+
+  return TRUE;
+}
+
+/*
+ * _clutter_property_transition_set_direct_value:
+ * @timeline: a #ClutterTimeline
+ * @value: the interpolated value
+ *
+ * Sets @value on the property animated by @timeline, which must have
+ * been checked with _clutter_property_transition_get_direct_interval().
+ */
+void
+_clutter_property_transition_set_direct_value (ClutterTimeline *timeline,
+                                               gdouble          value)
+{
+  ClutterPropertyTransitionPrivate *priv;
+  ClutterAnimatable *animatable;
+
+  priv = CLUTTER_PROPERTY_TRANSITION (timeline)->priv;
+
+  /* setting the previous values of a batch can detach the transition */
+  animatable = clutter_transition_get_animatable (CLUTTER_TRANSITION (timeline));
+  if (animatable == NULL || priv->pspec == NULL)
+    return;
+
+  if (priv->direct_type == G_TYPE_FLOAT)
+    _clutter_actor_set_animatable_float (CLUTTER_ACTOR (animatable),
+                                         priv->pspec,
+                                         value);
+  else if (priv->direct_type == G_TYPE_DOUBLE)
+    _clutter_actor_set_animatable_double (CLUTTER_ACTOR (animatable),
+                                          priv->pspec,
+                                          value);
+}
+
 static void
 clutter_property_transition_attached (ClutterTransition *transition,
                                       ClutterAnimatable *animatable)
@@ -108,6 +448,8 @@ clutter_property_transition_attached (ClutterTransition *transition,
   priv->pspec =
     clutter_animatable_find_property (animatable, priv->property_name);
 
+  clutter_property_transition_resolve_direct_type (self, animatable);
+
   if (priv->pspec == NULL)
     return;
 
@@ -125,7 +467,27 @@ clutter_property_transition_detached (ClutterTransition *transition,
   ClutterPropertyTransition *self = CLUTTER_PROPERTY_TRANSITION (transition);
   ClutterPropertyTransitionPrivate *priv = self->priv;
 
-  priv->pspec = NULL; 
+  clutter_property_transition_commit_paint_value (self, animatable);
+
+  priv->pspec = NULL;
+  priv->direct_type = G_TYPE_INVALID;
+  priv->paint_time = FALSE;
+}
+
+static void
+clutter_property_transition_stopped (ClutterTimeline *timeline,
+                                     gboolean         is_finished)
+{
+  ClutterPropertyTransition *self = CLUTTER_PROPERTY_TRANSITION (timeline);
+  ClutterTimelineClass *parent_class;
+
+  clutter_property_transition_commit_paint_value (self,
+                                                  clutter_transition_get_animatable (CLUTTER_TRANSITION (timeline)));
+
+  parent_class =
+    CLUTTER_TIMELINE_CLASS (clutter_property_transition_parent_class);
+  if (parent_class->stopped != NULL)
+    parent_class->stopped (timeline, is_finished);
 }
 
 static void
@@ -146,6 +508,22 @@ clutter_property_transition_compute_value (ClutterTransition *transition,
 
   clutter_property_transition_ensure_interval (self, animatable, interval);
 
+  /* the value is computed by the actor before it is painted */
+  if (priv->evaluate_on_paint && priv->paint_time)
+    {
+      _clutter_actor_schedule_paint_transition (CLUTTER_ACTOR (animatable),
+                                                transition,
+                                                priv->pspec);
+      return;
+    }
+
+  if (priv->direct_type != G_TYPE_INVALID &&
+      clutter_property_transition_compute_direct (self,
+                                                  CLUTTER_ACTOR (animatable),
+                                                  interval,
+                                                  progress))
+    return;
+
   p_type = G_PARAM_SPEC_VALUE_TYPE (priv->pspec);
   i_type = clutter_interval_get_value_type (interval);
 
@@ -207,6 +585,11 @@ clutter_property_transition_set_property (GObject      *gobject,
                                                      g_value_get_string (value));
       break;
 
+    case PROP_EVALUATE_ON_PAINT:
+      clutter_property_transition_set_evaluate_on_paint (self,
+                                                         g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -226,6 +609,10 @@ clutter_property_transition_get_property (GObject    *gobject,
       g_value_set_string (value, priv->property_name);
       break;
 
+    case PROP_EVALUATE_ON_PAINT:
+      g_value_set_boolean (value, priv->evaluate_on_paint);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -247,6 +634,7 @@ static void
 clutter_property_transition_class_init (ClutterPropertyTransitionClass *klass)
 {
   ClutterTransitionClass *transition_class = CLUTTER_TRANSITION_CLASS (klass);
+  ClutterTimelineClass *timeline_class = CLUTTER_TIMELINE_CLASS (klass);
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 
   g_type_class_add_private (klass, sizeof (ClutterPropertyTransitionPrivate));
@@ -255,6 +643,8 @@ clutter_property_transition_class_init (ClutterPropertyTransitionClass *klass)
   transition_class->detached = clutter_property_transition_detached;
   transition_class->compute_value = clutter_property_transition_compute_value;
 
+  timeline_class->stopped = clutter_property_transition_stopped;
+
   gobject_class->set_property = clutter_property_transition_set_property;
   gobject_class->get_property = clutter_property_transition_get_property;
   gobject_class->finalize = clutter_property_transition_finalize;
@@ -273,6 +663,21 @@ clutter_property_transition_class_init (ClutterPropertyTransitionClass *klass)
                          NULL,
                          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * ClutterPropertyTransition:evaluate-on-paint:
+   *
+   * Whether the value of the property should be computed right before
+   * the actor is painted, instead of being set on each frame.
+   *
+   * See clutter_property_transition_set_evaluate_on_paint().
+   */
+  obj_props[PROP_EVALUATE_ON_PAINT] =
+    g_param_spec_boolean ("evaluate-on-paint",
+                          P_("Evaluate On Paint"),
+                          P_("Whether the value should be computed before painting"),
+                          FALSE,
+                          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
 }
 
@@ -326,6 +731,9 @@ clutter_property_transition_set_property_name (ClutterPropertyTransition *transi
   if (g_strcmp0 (priv->property_name, property_name) == 0)
     return;
 
+  clutter_property_transition_commit_paint_value (transition,
+                                                  clutter_transition_get_animatable (CLUTTER_TRANSITION (transition)));
+
   g_free (priv->property_name);
   priv->property_name = g_strdup (property_name);
   priv->pspec = NULL;
@@ -338,6 +746,8 @@ clutter_property_transition_set_property_name (ClutterPropertyTransition *transi
                                                       priv->property_name);
     }
 
+  clutter_property_transition_resolve_direct_type (transition, animatable);
+
   g_object_notify_by_pspec (G_OBJECT (transition),
                             obj_props[PROP_PROPERTY_NAME]);
 }
@@ -362,3 +772,68 @@ clutter_property_transition_get_property_name (ClutterPropertyTransition *transi
 
   return transition->priv->property_name;
 }
+
+/**
+ * clutter_property_transition_set_evaluate_on_paint:
+ * @transition: a #ClutterPropertyTransition
+ * @evaluate_on_paint: whether the value should be computed on paint
+ *
+ * Sets whether the value of the property animated by @transition
+ * should be computed right before the actor is painted, using the
+ * progress of the current frame, instead of being set on the actor
+ * each time the timeline advances.
+ *
+ * The values computed this way do not cause a notification of the
+ * property, nor a relayout: they are only used to paint and pick the
+ * actor. The last value is set on the actor when @transition is
+ * stopped, or when it is detached from the actor; until then, reading
+ * the property returns the value of the last painted frame.
+ *
+ * This only applies to the #ClutterActor:translation-x,
+ * #ClutterActor:translation-y, #ClutterActor:translation-z,
+ * #ClutterActor:scale-x, #ClutterActor:scale-y, #ClutterActor:scale-z,
+ * #ClutterActor:rotation-angle-x, #ClutterActor:rotation-angle-y,
+ * #ClutterActor:rotation-angle-z and #ClutterActor:opacity properties,
+ * when they are not overridden by a sub-class of #ClutterActor; the
+ * other properties are set on each frame as usual.
+ */
+void
+clutter_property_transition_set_evaluate_on_paint (ClutterPropertyTransition *transition,
+                                                   gboolean                   evaluate_on_paint)
+{
+  ClutterPropertyTransitionPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_PROPERTY_TRANSITION (transition));
+
+  priv = transition->priv;
+
+  evaluate_on_paint = !!evaluate_on_paint;
+
+  if (priv->evaluate_on_paint == evaluate_on_paint)
+    return;
+
+  if (!evaluate_on_paint)
+    clutter_property_transition_commit_paint_value (transition,
+                                                    clutter_transition_get_animatable (CLUTTER_TRANSITION (transition)));
+
+  priv->evaluate_on_paint = evaluate_on_paint;
+
+  g_object_notify_by_pspec (G_OBJECT (transition),
+                            obj_props[PROP_EVALUATE_ON_PAINT]);
+}
+
+/**
+ * clutter_property_transition_get_evaluate_on_paint:
+ * @transition: a #ClutterPropertyTransition
+ *
+ * Retrieves the value set by clutter_property_transition_set_evaluate_on_paint().
+ *
+ * Return value: %TRUE if the values are computed on paint
+ */
+gboolean
+clutter_property_transition_get_evaluate_on_paint (ClutterPropertyTransition *transition)
+{
+  g_return_val_if_fail (CLUTTER_IS_PROPERTY_TRANSITION (transition), FALSE);
+
+  return transition->priv->evaluate_on_paint;
+}
@@ -86,6 +86,10 @@ void                    clutter_property_transition_set_property_name   (Clutter
 
 const char *            clutter_property_transition_get_property_name   (ClutterPropertyTransition *transition);
 
+void                    clutter_property_transition_set_evaluate_on_paint (ClutterPropertyTransition *transition,
+                                                                           gboolean                   evaluate_on_paint);
+gboolean                clutter_property_transition_get_evaluate_on_paint (ClutterPropertyTransition *transition);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_PROPERTY_TRANSITION_H__ */
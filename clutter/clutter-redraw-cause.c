@@ -0,0 +1,192 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Redraw cause attribution.
+ *
+ * With CLUTTER_PAINT=redraw-causes, every redraw and relayout queued
+ * on an actor is recorded together with the type and name of the actor
+ * and the property whose change queued it, if any; adding redraw-backtraces
+ * to CLUTTER_PAINT also records the callers, on platforms that support
+ * it. Once per second, the most frequent causes are printed, so that the
+ * animations and the actors keeping the stage busy can be found.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_EXECINFO_H
+#include <execinfo.h>
+#include <stdlib.h>
+#endif
+
+#include "clutter-redraw-cause.h"
+
+#include "clutter-actor.h"
+#include "clutter-debug.h"
+#include "clutter-private.h"
+
+/* the number of causes in each report */
+#define REDRAW_CAUSES_REPORT_SIZE       10
+
+/* the number of callers recorded with redraw-backtraces */
+#define REDRAW_BACKTRACE_DEPTH          6
+
+typedef struct _CauseRow
+{
+  const gchar *cause;
+  guint count;
+} CauseRow;
+
+const gchar *_clutter_redraw_cause = NULL;
+
+/* cause -> number of times it happened in the current second */
+static GHashTable *redraw_causes = NULL;
+
+static gint
+sort_by_count (gconstpointer a,
+               gconstpointer b)
+{
+  const CauseRow *row_a = a;
+  const CauseRow *row_b = b;
+
+  return (gint) row_b->count - (gint) row_a->count;
+}
+
+static gboolean
+clutter_redraw_cause_report (gpointer data G_GNUC_UNUSED)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+  GArray *rows;
+  guint i;
+
+  if (g_hash_table_size (redraw_causes) == 0)
+    return G_SOURCE_CONTINUE;
+
+  rows = g_array_sized_new (FALSE, FALSE, sizeof (CauseRow),
+                            g_hash_table_size (redraw_causes));
+
+  g_hash_table_iter_init (&iter, redraw_causes);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      CauseRow row;
+
+      row.cause = key;
+      row.count = GPOINTER_TO_UINT (value);
+
+      g_array_append_val (rows, row);
+    }
+
+  g_array_sort (rows, sort_by_count);
+
+  g_print ("Top redraw causes in the last second:\n");
+
+  for (i = 0; i < rows->len && i < REDRAW_CAUSES_REPORT_SIZE; i++)
+    {
+      const CauseRow *row = &g_array_index (rows, CauseRow, i);
+
+      g_print ("  %6u/s  %s\n", row->count, row->cause);
+    }
+
+  g_array_unref (rows);
+
+  g_hash_table_remove_all (redraw_causes);
+
+  return G_SOURCE_CONTINUE;
+}
+
+/*< private >
+ * _clutter_redraw_cause_init:
+ *
+ * Sets up the recording of the redraw causes, and the periodic report.
+ */
+void
+_clutter_redraw_cause_init (void)
+{
+  if (redraw_causes != NULL)
+    return;
+
+  redraw_causes = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         g_free,
+                                         NULL);
+
+  g_timeout_add_seconds (1, clutter_redraw_cause_report, NULL);
+}
+
+/*< private >
+ * _clutter_redraw_cause_record:
+ * @actor: the #ClutterActor queueing the redraw
+ * @relayout: %TRUE if @actor is queueing a relayout
+ *
+ * Records a redraw or a relayout queued by @actor, attributing it
+ * to the property currently being changed.
+ */
+void
+_clutter_redraw_cause_record (ClutterActor *actor,
+                              gboolean      relayout)
+{
+  const gchar *name;
+  GString *cause;
+  guint count;
+
+  if (G_UNLIKELY (redraw_causes == NULL))
+    _clutter_redraw_cause_init ();
+
+  cause = g_string_new (relayout ? "relayout " : "redraw ");
+
+  g_string_append (cause, G_OBJECT_TYPE_NAME (actor));
+
+  name = clutter_actor_get_name (actor);
+  if (name != NULL)
+    g_string_append_printf (cause, " '%s'", name);
+
+  if (_clutter_redraw_cause != NULL)
+    g_string_append_printf (cause, ", changing '%s'", _clutter_redraw_cause);
+
+#ifdef HAVE_EXECINFO_H
+  if (clutter_paint_debug_flags & CLUTTER_DEBUG_REDRAW_BACKTRACES)
+    {
+      gpointer frames[REDRAW_BACKTRACE_DEPTH + 2];
+      gchar **symbols;
+      gint i, n_frames;
+
+      n_frames = backtrace (frames, G_N_ELEMENTS (frames));
+      symbols = backtrace_symbols (frames, n_frames);
+
+      /* skip this function and the function queueing the redraw */
+      if (symbols != NULL)
+        {
+          for (i = 2; i < n_frames; i++)
+            g_string_append_printf (cause, "\n             %s", symbols[i]);
+
+          free (symbols);
+        }
+    }
+#endif /* HAVE_EXECINFO_H */
+
+  count = GPOINTER_TO_UINT (g_hash_table_lookup (redraw_causes, cause->str));
+
+  /* the table keeps its own copy of the key if the cause is known */
+  g_hash_table_insert (redraw_causes,
+                       g_string_free (cause, FALSE),
+                       GUINT_TO_POINTER (count + 1));
+}
@@ -0,0 +1,44 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_REDRAW_CAUSE_H__
+#define __CLUTTER_REDRAW_CAUSE_H__
+
+#include <clutter/clutter-types.h>
+
+G_BEGIN_DECLS
+
+/* the instrumentation is enabled by CLUTTER_PAINT=redraw-causes */
+#define CLUTTER_REDRAW_CAUSES_ENABLED() \
+  G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_REDRAW_CAUSES)
+
+/* the property being changed, or %NULL; the redraws and relayouts
+ * queued while it is set are attributed to it
+ */
+extern const gchar *_clutter_redraw_cause;
+
+void    _clutter_redraw_cause_init      (void);
+void    _clutter_redraw_cause_record    (ClutterActor *actor,
+                                         gboolean      relayout);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_REDRAW_CAUSE_H__ */
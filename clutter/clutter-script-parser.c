@@ -35,6 +35,46 @@
 #include <gmodule.h>
 
 #include "clutter-actor.h"
+#include "clutter-align-constraint.h"
+#include "clutter-array-model.h"
+#include "clutter-bin-layout.h"
+#include "clutter-bind-constraint.h"
+#include "clutter-blur-effect.h"
+#include "clutter-box-layout.h"
+#include "clutter-brightness-contrast-effect.h"
+#include "clutter-canvas.h"
+#include "clutter-click-action.h"
+#include "clutter-clone.h"
+#include "clutter-colorize-effect.h"
+#include "clutter-desaturate-effect.h"
+#include "clutter-drag-action.h"
+#include "clutter-drop-action.h"
+#include "clutter-fixed-layout.h"
+#include "clutter-flow-layout.h"
+#include "clutter-gesture-action.h"
+#include "clutter-grid-layout.h"
+#include "clutter-image.h"
+#include "clutter-interval.h"
+#include "clutter-keyframe-transition.h"
+#include "clutter-list-model.h"
+#include "clutter-page-turn-effect.h"
+#include "clutter-pan-action.h"
+#include "clutter-path-constraint.h"
+#include "clutter-path.h"
+#include "clutter-property-transition.h"
+#include "clutter-rotate-action.h"
+#include "clutter-scroll-actor.h"
+#include "clutter-shader-effect.h"
+#include "clutter-snap-constraint.h"
+#include "clutter-stage.h"
+#include "clutter-swipe-action.h"
+#include "clutter-table-layout.h"
+#include "clutter-tap-action.h"
+#include "clutter-text.h"
+#include "clutter-tiled-canvas.h"
+#include "clutter-timeline.h"
+#include "clutter-transition-group.h"
+#include "clutter-zoom-action.h"
 #include "clutter-container.h"
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
@@ -66,18 +106,179 @@ clutter_script_parser_init (ClutterScriptParser *parser)
 {
 }
 
+/* The types that can be used inside UI definitions, resolved without
+ * looking up their type function in the symbol table of the process
+ */
+static const struct {
+  const gchar *type_name;
+  GTypeGetFunc get_type;
+} clutter_script_types[] = {
+  { "ClutterActor",                    clutter_actor_get_type },
+  { "ClutterAlignConstraint",          clutter_align_constraint_get_type },
+  { "ClutterArrayModel",               clutter_array_model_get_type },
+  { "ClutterBinLayout",                clutter_bin_layout_get_type },
+  { "ClutterBindConstraint",           clutter_bind_constraint_get_type },
+  { "ClutterBlurEffect",               clutter_blur_effect_get_type },
+  { "ClutterBoxLayout",                clutter_box_layout_get_type },
+  { "ClutterBrightnessContrastEffect", clutter_brightness_contrast_effect_get_type },
+  { "ClutterCanvas",                   clutter_canvas_get_type },
+  { "ClutterClickAction",              clutter_click_action_get_type },
+  { "ClutterClone",                    clutter_clone_get_type },
+  { "ClutterColorizeEffect",           clutter_colorize_effect_get_type },
+  { "ClutterDesaturateEffect",         clutter_desaturate_effect_get_type },
+  { "ClutterDragAction",               clutter_drag_action_get_type },
+  { "ClutterDropAction",               clutter_drop_action_get_type },
+  { "ClutterFixedLayout",              clutter_fixed_layout_get_type },
+  { "ClutterFlowLayout",               clutter_flow_layout_get_type },
+  { "ClutterGestureAction",            clutter_gesture_action_get_type },
+  { "ClutterGridLayout",               clutter_grid_layout_get_type },
+  { "ClutterImage",                    clutter_image_get_type },
+  { "ClutterInterval",                 clutter_interval_get_type },
+  { "ClutterKeyframeTransition",       clutter_keyframe_transition_get_type },
+  { "ClutterListModel",                clutter_list_model_get_type },
+  { "ClutterPageTurnEffect",           clutter_page_turn_effect_get_type },
+  { "ClutterPanAction",                clutter_pan_action_get_type },
+  { "ClutterPath",                     clutter_path_get_type },
+  { "ClutterPathConstraint",           clutter_path_constraint_get_type },
+  { "ClutterPropertyTransition",       clutter_property_transition_get_type },
+  { "ClutterRotateAction",             clutter_rotate_action_get_type },
+  { "ClutterScrollActor",              clutter_scroll_actor_get_type },
+  { "ClutterShaderEffect",             clutter_shader_effect_get_type },
+  { "ClutterSnapConstraint",           clutter_snap_constraint_get_type },
+  { "ClutterStage",                    clutter_stage_get_type },
+  { "ClutterSwipeAction",              clutter_swipe_action_get_type },
+  { "ClutterTableLayout",              clutter_table_layout_get_type },
+  { "ClutterTapAction",                clutter_tap_action_get_type },
+  { "ClutterText",                     clutter_text_get_type },
+  { "ClutterTiledCanvas",              clutter_tiled_canvas_get_type },
+  { "ClutterTimeline",                 clutter_timeline_get_type },
+  { "ClutterTransitionGroup",          clutter_transition_group_get_type },
+  { "ClutterZoomAction",               clutter_zoom_action_get_type },
+};
+
+typedef struct {
+  GTypeGetFunc get_type;
+  GType gtype;
+} ScriptTypeEntry;
+
+/* the process-wide cache of the resolved types, by type name or by
+ * type function name
+ */
+static GHashTable *script_types = NULL;
+G_LOCK_DEFINE_STATIC (script_types);
+
+static void
+script_type_entry_free (gpointer data)
+{
+  g_slice_free (ScriptTypeEntry, data);
+}
+
+static void
+script_types_add (gchar        *key,
+                  GTypeGetFunc  get_type,
+                  GType         gtype)
+{
+  ScriptTypeEntry *entry = g_slice_new (ScriptTypeEntry);
+
+  entry->get_type = get_type;
+  entry->gtype = gtype;
+
+  g_hash_table_replace (script_types, key, entry);
+}
+
+static void
+script_types_ensure (void)
+{
+  guint i;
+
+  if (G_LIKELY (script_types != NULL))
+    return;
+
+  script_types = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                        g_free,
+                                        script_type_entry_free);
+
+  for (i = 0; i < G_N_ELEMENTS (clutter_script_types); i++)
+    script_types_add (g_strdup (clutter_script_types[i].type_name),
+                      clutter_script_types[i].get_type,
+                      G_TYPE_INVALID);
+}
+
+static GType
+script_types_lookup (const gchar *key)
+{
+  ScriptTypeEntry *entry;
+  GType gtype = G_TYPE_INVALID;
+
+  G_LOCK (script_types);
+
+  script_types_ensure ();
+
+  entry = g_hash_table_lookup (script_types, key);
+  if (entry != NULL)
+    {
+      /* the type functions are only called when needed */
+      if (entry->gtype == G_TYPE_INVALID)
+        entry->gtype = entry->get_type ();
+
+      gtype = entry->gtype;
+    }
+
+  G_UNLOCK (script_types);
+
+  return gtype;
+}
+
+static void
+script_types_insert (const gchar *key,
+                     GType        gtype)
+{
+  G_LOCK (script_types);
+
+  script_types_ensure ();
+  script_types_add (g_strdup (key), NULL, gtype);
+
+  G_UNLOCK (script_types);
+}
+
+/*< private >
+ * _clutter_script_register_type_func:
+ * @type_name: the name of a type
+ * @get_type: the function returning the #GType for @type_name
+ *
+ * Adds @type_name to the cache of the types used by #ClutterScript.
+ */
+void
+_clutter_script_register_type_func (const gchar  *type_name,
+                                    GTypeGetFunc  get_type)
+{
+  G_LOCK (script_types);
+
+  script_types_ensure ();
+  script_types_add (g_strdup (type_name), get_type, G_TYPE_INVALID);
+
+  G_UNLOCK (script_types);
+}
+
 GType
 _clutter_script_get_type_from_symbol (const gchar *symbol)
 {
   static GModule *module = NULL;
   GTypeGetFunc func;
-  GType gtype = G_TYPE_INVALID;
+  GType gtype;
+
+  gtype = script_types_lookup (symbol);
+  if (gtype != G_TYPE_INVALID)
+    return gtype;
 
   if (!module)
     module = g_module_open (NULL, 0);
   
   if (g_module_symbol (module, symbol, (gpointer)&func))
-    gtype = func ();
+    {
+      gtype = func ();
+      script_types_insert (symbol, gtype);
+    }
   
   return gtype;
 }
@@ -86,14 +287,20 @@ GType
 _clutter_script_get_type_from_class (const gchar *name)
 {
   static GModule *module = NULL;
-  GString *symbol_name = g_string_sized_new (64);
+  GString *symbol_name;
   GType gtype = G_TYPE_INVALID;
   GTypeGetFunc func;
   gchar *symbol;
   gint i;
 
+  gtype = script_types_lookup (name);
+  if (gtype != G_TYPE_INVALID)
+    return gtype;
+
   if (G_UNLIKELY (!module))
     module = g_module_open (NULL, 0);
+
+  symbol_name = g_string_sized_new (64);
   
   for (i = 0; name[i] != '\0'; i++)
     {
@@ -139,6 +346,9 @@ _clutter_script_get_type_from_class (const gchar *name)
     {
       CLUTTER_NOTE (SCRIPT, "Type function: %s", symbol);
       gtype = func ();
+
+      if (gtype != G_TYPE_INVALID)
+        script_types_insert (name, gtype);
     }
   
   g_free (symbol);
@@ -894,13 +1104,79 @@ clutter_script_parser_object_end (JsonParser *json_parser,
                 g_list_length (oinfo->signals));
 
   _clutter_script_add_object_info (script, oinfo);
-  _clutter_script_construct_object (script, oinfo);
+
+  /* objects constructed on demand are only built when retrieved, but
+   * merged definitions still need to update the existing objects
+   */
+  if (oinfo->object != NULL || !clutter_script_get_construct_on_demand (script))
+    _clutter_script_construct_object (script, oinfo);
 }
 
 static void
 clutter_script_parser_parse_end (JsonParser *parser)
 {
-  clutter_script_ensure_objects (CLUTTER_SCRIPT_PARSER (parser)->script);
+  ClutterScript *script = CLUTTER_SCRIPT_PARSER (parser)->script;
+
+  if (!clutter_script_get_construct_on_demand (script))
+    clutter_script_ensure_objects (script);
+}
+
+/* JsonParser emits ::object-end once all the members of an object have
+ * been parsed, so inner objects are visited before their parent
+ */
+static void
+clutter_script_parser_walk_node (ClutterScriptParser *parser,
+                                 JsonNode            *node)
+{
+  switch (JSON_NODE_TYPE (node))
+    {
+    case JSON_NODE_OBJECT:
+      {
+        JsonObject *object = json_node_get_object (node);
+        GList *values, *l;
+
+        values = json_object_get_values (object);
+        for (l = values; l != NULL; l = l->next)
+          clutter_script_parser_walk_node (parser, l->data);
+
+        g_list_free (values);
+
+        clutter_script_parser_object_end (JSON_PARSER (parser), object);
+      }
+      break;
+
+    case JSON_NODE_ARRAY:
+      {
+        JsonArray *array = json_node_get_array (node);
+        guint i, n_elements;
+
+        n_elements = json_array_get_length (array);
+        for (i = 0; i < n_elements; i++)
+          clutter_script_parser_walk_node (parser,
+                                           json_array_get_element (array, i));
+      }
+      break;
+
+    default:
+      break;
+    }
+}
+
+/*< private >
+ * _clutter_script_parser_load_from_node:
+ * @parser: a #ClutterScriptParser
+ * @root: the root of an already parsed JSON tree
+ *
+ * Loads the definitions inside @root, in the same order used when
+ * parsing a JSON buffer; this is used for the compiled definitions,
+ * which do not need to go through the JSON tokenizer.
+ */
+void
+_clutter_script_parser_load_from_node (ClutterScriptParser *parser,
+                                       JsonNode            *root)
+{
+  clutter_script_parser_walk_node (parser, root);
+  clutter_script_parser_parse_end (JSON_PARSER (parser));
 }
 
 gboolean
@@ -1546,9 +1822,15 @@ apply_layout_properties (ClutterScript    *script,
                     g_type_name (oinfo->gtype),
                     oinfo->id);
 
-      clutter_layout_manager_child_set_property (manager, container, actor,
-                                                 name,
+      /* the property was already looked up while parsing it */
+      if (pinfo->pspec != NULL)
+        _clutter_layout_manager_child_set_pspec (manager, container, actor,
+                                                 pinfo->pspec,
                                                  &value);
+      else
+        clutter_layout_manager_child_set_property (manager, container, actor,
+                                                   name,
+                                                   &value);
 
       g_value_unset (&value);
 
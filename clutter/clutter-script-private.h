@@ -98,6 +98,9 @@ void property_info_free (gpointer data);
 
 GType _clutter_script_parser_get_type (void) G_GNUC_CONST;
 
+void _clutter_script_parser_load_from_node (ClutterScriptParser *parser,
+                                            JsonNode            *root);
+
 gboolean _clutter_script_parse_node        (ClutterScript *script,
                                             GValue        *value,
                                             const gchar   *name,
@@ -106,6 +109,8 @@ gboolean _clutter_script_parse_node        (ClutterScript *script,
 
 GType    _clutter_script_get_type_from_symbol (const gchar *symbol);
 GType    _clutter_script_get_type_from_class  (const gchar *name);
+void     _clutter_script_register_type_func   (const gchar  *type_name,
+                                               GTypeGetFunc  get_type);
 
 gulong   _clutter_script_resolve_animation_mode (JsonNode *node);
 
@@ -129,9 +129,11 @@
 
 #include <glib.h>
 #include <glib-object.h>
+#include <gio/gio.h>
 #include <gmodule.h>
 
-#include "clutter-actor.h"
+#include "clutter-actor-private.h"
+#include "clutter-main.h"
 #include "clutter-stage.h"
 
 #include "clutter-script.h"
@@ -149,6 +151,7 @@ enum
   PROP_FILENAME_SET,
   PROP_FILENAME,
   PROP_TRANSLATION_DOMAIN,
+  PROP_CONSTRUCT_ON_DEMAND,
 
   PROP_LAST
 };
@@ -164,6 +167,11 @@ struct _ClutterScriptPrivate
   guint last_merge_id;
   guint last_unknown;
 
+  /* the merge id of the stream being parsed, if any; see
+   * clutter_script_load_from_stream()
+   */
+  guint loading_merge_id;
+
   ClutterScriptParser *parser;
 
   gchar **search_paths;
@@ -171,9 +179,25 @@ struct _ClutterScriptPrivate
   gchar *translation_domain;
 
   gchar *filename;
+
+  /* the signal connections to apply to the objects constructed
+   * on demand, after clutter_script_connect_signals() was called
+   */
+  GList *deferred_connects;
+
+  /* the parsed templates, by name */
+  GHashTable *templates;
+
   guint is_filename : 1;
+  guint construct_on_demand : 1;
 };
 
+typedef struct {
+  ClutterScriptConnectFunc func;
+  gpointer user_data;
+  GDestroyNotify notify;
+} DeferredConnect;
+
 G_DEFINE_TYPE (ClutterScript, clutter_script, G_TYPE_OBJECT);
 
 static GType
@@ -276,6 +300,22 @@ clutter_script_finalize (GObject *gobject)
   g_free (priv->filename);
   g_free (priv->translation_domain);
 
+  if (priv->templates != NULL)
+    g_hash_table_destroy (priv->templates);
+
+  while (priv->deferred_connects != NULL)
+    {
+      DeferredConnect *deferred = priv->deferred_connects->data;
+
+      if (deferred->notify != NULL)
+        deferred->notify (deferred->user_data);
+
+      g_slice_free (DeferredConnect, deferred);
+
+      priv->deferred_connects =
+        g_list_delete_link (priv->deferred_connects, priv->deferred_connects);
+    }
+
   G_OBJECT_CLASS (clutter_script_parent_class)->finalize (gobject);
 }
 
@@ -293,6 +333,10 @@ clutter_script_set_property (GObject      *gobject,
       clutter_script_set_translation_domain (script, g_value_get_string (value));
       break;
 
+    case PROP_CONSTRUCT_ON_DEMAND:
+      clutter_script_set_construct_on_demand (script, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -321,6 +365,10 @@ clutter_script_get_property (GObject    *gobject,
       g_value_set_string (value, script->priv->translation_domain);
       break;
 
+    case PROP_CONSTRUCT_ON_DEMAND:
+      g_value_set_boolean (value, script->priv->construct_on_demand);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -385,6 +433,33 @@ clutter_script_class_init (ClutterScriptClass *klass)
                          NULL,
                          CLUTTER_PARAM_READWRITE);
 
+  /**
+   * ClutterScript:construct-on-demand:
+   *
+   * Whether the objects defined inside the UI definitions should only
+   * be constructed when needed.
+   *
+   * When this property is set, loading UI definitions does not build
+   * any object; an object, and the actors in its children sub-tree, are
+   * constructed the first time the object is retrieved through
+   * clutter_script_get_object() or clutter_script_get_objects(), or
+   * when an object being constructed references it. This allows loading
+   * the definitions of a whole application without paying the price of
+   * the parts that are never shown.
+   *
+   * The signal handlers connected with clutter_script_connect_signals()
+   * or clutter_script_connect_signals_full() are connected to the
+   * objects when they are constructed, so the user data passed to
+   * clutter_script_connect_signals_full() must stay valid for the
+   * lifetime of the #ClutterScript.
+   */
+  obj_props[PROP_CONSTRUCT_ON_DEMAND] =
+    g_param_spec_boolean ("construct-on-demand",
+                          P_("Construct On Demand"),
+                          P_("Whether the objects should only be constructed when needed"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
   gobject_class->set_property = clutter_script_set_property;
   gobject_class->get_property = clutter_script_get_property;
   gobject_class->finalize = clutter_script_finalize;
@@ -421,26 +496,914 @@ clutter_script_init (ClutterScript *script)
  * definitions must be encoded using the JavaScript Object Notation (JSON)
  * language.
  *
- * Return value: the newly created #ClutterScript instance. Use
- *   g_object_unref() when done.
+ * Return value: the newly created #ClutterScript instance. Use
+ *   g_object_unref() when done.
+ *
+ *
+ */
+ClutterScript *
+clutter_script_new (void)
+{
+  return g_object_new (CLUTTER_TYPE_SCRIPT, NULL);
+}
+
+/**
+ * clutter_script_load_from_file:
+ * @script: a #ClutterScript
+ * @filename: the full path to the definition file
+ * @error: return location for a #GError, or %NULL
+ *
+ * Loads the definitions from @filename into @script and merges with
+ * the currently loaded ones, if any.
+ *
+ * Return value: on error, zero is returned and @error is set
+ *   accordingly. On success, the merge id for the UI definitions is
+ *   returned. You can use the merge id with clutter_script_unmerge_objects().
+ *
+ *
+ */
+guint
+clutter_script_load_from_file (ClutterScript  *script,
+                               const gchar    *filename,
+                               GError        **error)
+{
+  ClutterScriptPrivate *priv;
+  GError *internal_error;
+
+  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), 0);
+  g_return_val_if_fail (filename != NULL, 0);
+
+  priv = script->priv;
+
+  g_free (priv->filename);
+  priv->filename = g_strdup (filename);
+  priv->is_filename = TRUE;
+  priv->last_merge_id += 1;
+
+  internal_error = NULL;
+  json_parser_load_from_file (JSON_PARSER (priv->parser),
+                              filename,
+                              &internal_error);
+  if (internal_error)
+    {
+      g_propagate_error (error, internal_error);
+      priv->last_merge_id -= 1;
+      return 0;
+    }
+
+  return priv->last_merge_id;
+}
+
+/**
+ * clutter_script_load_from_data:
+ * @script: a #ClutterScript
+ * @data: a buffer containing the definitions
+ * @length: the length of the buffer, or -1 if @data is a NUL-terminated
+ *   buffer
+ * @error: return location for a #GError, or %NULL
+ *
+ * Loads the definitions from @data into @script and merges with
+ * the currently loaded ones, if any.
+ *
+ * Return value: on error, zero is returned and @error is set
+ *   accordingly. On success, the merge id for the UI definitions is
+ *   returned. You can use the merge id with clutter_script_unmerge_objects().
+ *
+ *
+ */
+guint
+clutter_script_load_from_data (ClutterScript  *script,
+                               const gchar    *data,
+                               gssize          length,
+                               GError        **error)
+{
+  ClutterScriptPrivate *priv;
+  GError *internal_error;
+
+  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), 0);
+  g_return_val_if_fail (data != NULL, 0);
+
+  if (length < 0)
+    length = strlen (data);
+
+  priv = script->priv;
+
+  g_free (priv->filename);
+  priv->filename = NULL;
+  priv->is_filename = FALSE;
+  priv->last_merge_id += 1;
+
+  internal_error = NULL;
+  json_parser_load_from_data (JSON_PARSER (priv->parser),
+                              data, length,
+                              &internal_error);
+  if (internal_error)
+    {
+      g_propagate_error (error, internal_error);
+      priv->last_merge_id -= 1;
+      return 0;
+    }
+
+  return priv->last_merge_id;
+}
+
+/* the size of the chunks read from the streams */
+#define STREAM_CHUNK_SIZE       4096
+
+/*
+ * ScriptStream:
+ *
+ * The state of a load from a #GInputStream. The definitions are split
+ * into their top-level objects, which are parsed, and whose objects
+ * are constructed, as soon as they have been read completely; only
+ * the text of the object being read is kept around.
+ */
+typedef struct {
+  ClutterScript *script;
+  GInputStream *stream;
+  GCancellable *cancellable;
+  GSimpleAsyncResult *result;
+
+  guint merge_id;
+
+  /* the text of the top-level object being read */
+  GString *element;
+  gint depth;
+
+  guint started          : 1;
+  guint finished         : 1;
+  guint in_array         : 1;
+  guint in_string        : 1;
+  guint in_escape        : 1;
+  guint after_slash      : 1;
+  guint after_star       : 1;
+  guint in_line_comment  : 1;
+  guint in_block_comment : 1;
+
+  gchar buffer[STREAM_CHUNK_SIZE];
+} ScriptStream;
+
+static ScriptStream *
+script_stream_new (ClutterScript *script,
+                   GInputStream  *stream,
+                   GCancellable  *cancellable)
+{
+  ClutterScriptPrivate *priv = script->priv;
+  ScriptStream *s;
+
+  s = g_slice_new0 (ScriptStream);
+  s->script = g_object_ref (script);
+  s->stream = g_object_ref (stream);
+  s->cancellable = cancellable != NULL ? g_object_ref (cancellable) : NULL;
+  s->element = g_string_new (NULL);
+
+  g_free (priv->filename);
+  priv->filename = NULL;
+  priv->is_filename = FALSE;
+  priv->last_merge_id += 1;
+
+  s->merge_id = priv->last_merge_id;
+
+  return s;
+}
+
+static void
+script_stream_free (ScriptStream *s)
+{
+  g_string_free (s->element, TRUE);
+
+  if (s->result != NULL)
+    g_object_unref (s->result);
+
+  if (s->cancellable != NULL)
+    g_object_unref (s->cancellable);
+
+  g_object_unref (s->stream);
+  g_object_unref (s->script);
+
+  g_slice_free (ScriptStream, s);
+}
+
+static gboolean
+script_stream_load_element (ScriptStream  *s,
+                            GError       **error)
+{
+  ClutterScriptPrivate *priv = s->script->priv;
+  gboolean res;
+
+  CLUTTER_NOTE (SCRIPT, "Loading a definition of %" G_GSIZE_FORMAT " bytes "
+                "(merge id: %u)",
+                s->element->len,
+                s->merge_id);
+
+  /* other definitions might have been loaded since the stream started */
+  priv->loading_merge_id = s->merge_id;
+  res = json_parser_load_from_data (JSON_PARSER (priv->parser),
+                                    s->element->str,
+                                    s->element->len,
+                                    error);
+  priv->loading_merge_id = 0;
+
+  g_string_truncate (s->element, 0);
+
+  return res;
+}
+
+/* splits @data, continuing from the state of @s, into the top-level
+ * objects of the definitions; the definitions are either a single
+ * object, or an array of objects
+ */
+static gboolean
+script_stream_feed (ScriptStream  *s,
+                    const gchar   *data,
+                    gsize          length,
+                    GError       **error)
+{
+  gsize i;
+
+  for (i = 0; i < length; i++)
+    {
+      gchar c = data[i];
+
+      if (s->in_line_comment)
+        {
+          if (c == '\n')
+            s->in_line_comment = FALSE;
+
+          continue;
+        }
+
+      if (s->in_block_comment)
+        {
+          if (s->after_star && c == '/')
+            s->in_block_comment = FALSE;
+
+          s->after_star = c == '*';
+          continue;
+        }
+
+      if (s->in_string)
+        {
+          g_string_append_c (s->element, c);
+
+          if (s->in_escape)
+            s->in_escape = FALSE;
+          else if (c == '\\')
+            s->in_escape = TRUE;
+          else if (c == '"')
+            s->in_string = FALSE;
+
+          continue;
+        }
+
+      /* the comments are dropped from the text of the element */
+      if (s->after_slash)
+        {
+          s->after_slash = FALSE;
+
+          if (c == '*')
+            {
+              s->in_block_comment = TRUE;
+              s->after_star = FALSE;
+              continue;
+            }
+
+          if (c == '/')
+            {
+              s->in_line_comment = TRUE;
+              continue;
+            }
+
+          goto unexpected;
+        }
+
+      if (c == '/')
+        {
+          s->after_slash = TRUE;
+          continue;
+        }
+
+      if (s->depth > 0)
+        {
+          g_string_append_c (s->element, c);
+
+          if (c == '"')
+            s->in_string = TRUE;
+          else if (c == '{' || c == '[')
+            s->depth += 1;
+          else if (c == '}' || c == ']')
+            {
+              s->depth -= 1;
+
+              if (s->depth == 0)
+                {
+                  if (!script_stream_load_element (s, error))
+                    return FALSE;
+
+                  if (!s->in_array)
+                    s->finished = TRUE;
+                }
+            }
+
+          continue;
+        }
+
+      /* between the top-level objects */
+      if (g_ascii_isspace (c))
+        continue;
+
+      if (s->finished)
+        goto unexpected;
+
+      if (!s->started)
+        {
+          s->started = TRUE;
+
+          if (c == '[')
+            {
+              s->in_array = TRUE;
+              continue;
+            }
+        }
+      else if (c == ',')
+        continue;
+      else if (c == ']')
+        {
+          s->finished = TRUE;
+          continue;
+        }
+
+      if (c != '{')
+        goto unexpected;
+
+      g_string_append_c (s->element, c);
+      s->depth = 1;
+    }
+
+  return TRUE;
+
+unexpected:
+  g_set_error (error, CLUTTER_SCRIPT_ERROR,
+               CLUTTER_SCRIPT_ERROR_INVALID_VALUE,
+               "Unexpected character '%c' in the UI definitions",
+               data[i]);
+  return FALSE;
+}
+
+static gboolean
+script_stream_close (ScriptStream  *s,
+                     GError       **error)
+{
+  if (!s->started)
+    {
+      g_set_error_literal (error, CLUTTER_SCRIPT_ERROR,
+                           CLUTTER_SCRIPT_ERROR_INVALID_VALUE,
+                           "No UI definitions found");
+      return FALSE;
+    }
+
+  if (!s->finished)
+    {
+      g_set_error_literal (error, CLUTTER_SCRIPT_ERROR,
+                           CLUTTER_SCRIPT_ERROR_INVALID_VALUE,
+                           "Unexpected end of the UI definitions");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * clutter_script_load_from_stream:
+ * @script: a #ClutterScript
+ * @stream: a #GInputStream with the definitions
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: return location for a #GError, or %NULL
+ *
+ * Loads the definitions read from @stream into @script and merges
+ * with the currently loaded ones, if any.
+ *
+ * Unlike clutter_script_load_from_data(), the definitions do not need
+ * to be held in memory together: each top-level object is parsed as
+ * soon as it has been read. If an error occurs, the objects loaded
+ * before it are kept.
+ *
+ * Return value: on error, zero is returned and @error is set
+ *   accordingly. On success, the merge id for the UI definitions is
+ *   returned. You can use the merge id with clutter_script_unmerge_objects().
+ */
+guint
+clutter_script_load_from_stream (ClutterScript  *script,
+                                 GInputStream   *stream,
+                                 GCancellable   *cancellable,
+                                 GError        **error)
+{
+  ScriptStream *s;
+  guint retval = 0;
+
+  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), 0);
+  g_return_val_if_fail (G_IS_INPUT_STREAM (stream), 0);
+
+  s = script_stream_new (script, stream, cancellable);
+
+  while (TRUE)
+    {
+      gssize n_read;
+
+      n_read = g_input_stream_read (stream, s->buffer, STREAM_CHUNK_SIZE,
+                                    cancellable,
+                                    error);
+      if (n_read < 0)
+        goto out;
+
+      if (n_read == 0)
+        break;
+
+      if (!script_stream_feed (s, s->buffer, n_read, error))
+        goto out;
+    }
+
+  if (script_stream_close (s, error))
+    retval = s->merge_id;
+
+out:
+  script_stream_free (s);
+
+  return retval;
+}
+
+static void
+script_stream_complete (ScriptStream *s,
+                        GError       *error)
+{
+  if (error != NULL)
+    g_simple_async_result_take_error (s->result, error);
+  else
+    g_simple_async_result_set_op_res_gssize (s->result, s->merge_id);
+
+  g_simple_async_result_complete (s->result);
+
+  script_stream_free (s);
+}
+
+static void
+script_stream_read_cb (GObject      *source,
+                       GAsyncResult *result,
+                       gpointer      data)
+{
+  ScriptStream *s = data;
+  GError *error = NULL;
+  gssize n_read;
+
+  n_read = g_input_stream_read_finish (s->stream, result, &error);
+  if (n_read < 0)
+    {
+      script_stream_complete (s, error);
+      return;
+    }
+
+  if (n_read == 0)
+    {
+      script_stream_close (s, &error);
+      script_stream_complete (s, error);
+      return;
+    }
+
+  if (!script_stream_feed (s, s->buffer, n_read, &error))
+    {
+      script_stream_complete (s, error);
+      return;
+    }
+
+  g_input_stream_read_async (s->stream, s->buffer, STREAM_CHUNK_SIZE,
+                             G_PRIORITY_DEFAULT,
+                             s->cancellable,
+                             script_stream_read_cb,
+                             s);
+}
+
+/**
+ * clutter_script_load_from_stream_async:
+ * @script: a #ClutterScript
+ * @stream: a #GInputStream with the definitions
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: (scope async): a function to call when the definitions
+ *   have been loaded
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronously loads the definitions read from @stream into @script,
+ * and merges with the currently loaded ones, if any.
+ *
+ * Each top-level object is parsed as soon as it has been read, so
+ * clutter_script_get_object() can retrieve the objects that have
+ * already been loaded while the rest of the definitions are still
+ * being read, for instance from the network.
+ *
+ * Use clutter_script_load_from_stream_finish() inside @callback to
+ * retrieve the result of the operation.
+ */
+void
+clutter_script_load_from_stream_async (ClutterScript       *script,
+                                       GInputStream        *stream,
+                                       GCancellable        *cancellable,
+                                       GAsyncReadyCallback  callback,
+                                       gpointer             user_data)
+{
+  ScriptStream *s;
+
+  g_return_if_fail (CLUTTER_IS_SCRIPT (script));
+  g_return_if_fail (G_IS_INPUT_STREAM (stream));
+
+  s = script_stream_new (script, stream, cancellable);
+  s->result = g_simple_async_result_new (G_OBJECT (script),
+                                         callback,
+                                         user_data,
+                                         clutter_script_load_from_stream_async);
+
+  g_input_stream_read_async (stream, s->buffer, STREAM_CHUNK_SIZE,
+                             G_PRIORITY_DEFAULT,
+                             cancellable,
+                             script_stream_read_cb,
+                             s);
+}
+
+/**
+ * clutter_script_load_from_stream_finish:
+ * @script: a #ClutterScript
+ * @result: the #GAsyncResult passed to the callback of
+ *   clutter_script_load_from_stream_async()
+ * @error: return location for a #GError, or %NULL
+ *
+ * Terminates an operation started by clutter_script_load_from_stream_async().
+ *
+ * If an error occurred, the objects loaded before it are kept.
+ *
+ * Return value: on error, zero is returned and @error is set
+ *   accordingly. On success, the merge id for the UI definitions is
+ *   returned. You can use the merge id with clutter_script_unmerge_objects().
+ */
+guint
+clutter_script_load_from_stream_finish (ClutterScript  *script,
+                                        GAsyncResult   *result,
+                                        GError        **error)
+{
+  GSimpleAsyncResult *res;
+
+  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), 0);
+  g_return_val_if_fail (g_simple_async_result_is_valid (result,
+                                                        G_OBJECT (script),
+                                                        clutter_script_load_from_stream_async),
+                        0);
+
+  res = G_SIMPLE_ASYNC_RESULT (result);
+
+  if (g_simple_async_result_propagate_error (res, error))
+    return 0;
+
+  return g_simple_async_result_get_op_res_gssize (res);
+}
+
+/* The compiled definitions are the JSON tree serialized as a GVariant,
+ * after a header that also keeps the variant data aligned
+ */
+#define COMPILED_HEADER         "ClScript"
+#define COMPILED_HEADER_SIZE    8
+
+static gboolean
+is_compiled_data (const gchar *data,
+                  gsize        length)
+{
+  return length >= COMPILED_HEADER_SIZE &&
+         memcmp (data, COMPILED_HEADER, COMPILED_HEADER_SIZE) == 0;
+}
+
+/**
+ * clutter_script_compile_data:
+ * @data: a buffer containing the JSON definitions
+ * @length: the length of the buffer, or -1 if @data is a NUL-terminated
+ *   buffer
+ * @compiled_length: (out): return location for the length of the
+ *   compiled definitions
+ * @error: return location for a #GError, or %NULL
+ *
+ * Compiles the UI definitions inside @data into a binary format that
+ * can be loaded with clutter_script_load_from_compiled_data() without
+ * parsing JSON.
+ *
+ * This function is meant to be called when building an application,
+ * for instance from a small tool generating the files that will be
+ * shipped inside a #GResource.
+ *
+ * Return value: (array length=compiled_length) (transfer full): the
+ *   compiled definitions, or %NULL on error. Use g_free() to free the
+ *   returned buffer
+ */
+gchar *
+clutter_script_compile_data (const gchar  *data,
+                             gssize        length,
+                             gsize        *compiled_length,
+                             GError      **error)
+{
+  JsonParser *parser;
+  JsonNode *root;
+  GVariant *variant;
+  gchar *retval;
+  gsize size;
+
+  g_return_val_if_fail (data != NULL, NULL);
+  g_return_val_if_fail (compiled_length != NULL, NULL);
+
+  if (length < 0)
+    length = strlen (data);
+
+  parser = json_parser_new ();
+  if (!json_parser_load_from_data (parser, data, length, error))
+    {
+      g_object_unref (parser);
+      return NULL;
+    }
+
+  root = json_parser_get_root (parser);
+  if (root == NULL)
+    {
+      g_set_error_literal (error, CLUTTER_SCRIPT_ERROR,
+                           CLUTTER_SCRIPT_ERROR_INVALID_VALUE,
+                           "No UI definitions found");
+      g_object_unref (parser);
+      return NULL;
+    }
+
+  variant = g_variant_new_variant (json_gvariant_serialize (root));
+  g_variant_ref_sink (variant);
+
+  size = g_variant_get_size (variant);
+  retval = g_malloc (COMPILED_HEADER_SIZE + size);
+  memcpy (retval, COMPILED_HEADER, COMPILED_HEADER_SIZE);
+  g_variant_store (variant, retval + COMPILED_HEADER_SIZE);
+
+  *compiled_length = COMPILED_HEADER_SIZE + size;
+
+  g_variant_unref (variant);
+  g_object_unref (parser);
+
+  return retval;
+}
+
+/**
+ * clutter_script_load_from_compiled_data:
+ * @script: a #ClutterScript
+ * @data: (array length=length): a buffer containing the compiled
+ *   definitions
+ * @length: the length of the buffer
+ * @error: return location for a #GError, or %NULL
+ *
+ * Loads the definitions compiled with clutter_script_compile_data()
+ * into @script and merges with the currently loaded ones, if any.
+ *
+ * The buffer is only read while loading, so it can be a mapped file,
+ * or the data of a #GResource; for the best performance, @data should
+ * be aligned to 8 bytes.
+ *
+ * Return value: on error, zero is returned and @error is set
+ *   accordingly. On success, the merge id for the UI definitions is
+ *   returned. You can use the merge id with clutter_script_unmerge_objects().
+ */
+guint
+clutter_script_load_from_compiled_data (ClutterScript  *script,
+                                        const gchar    *data,
+                                        gsize           length,
+                                        GError        **error)
+{
+  ClutterScriptPrivate *priv;
+  GVariant *variant, *child;
+  JsonNode *root;
+
+  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), 0);
+  g_return_val_if_fail (data != NULL, 0);
+
+  if (!is_compiled_data (data, length))
+    {
+      g_set_error_literal (error, CLUTTER_SCRIPT_ERROR,
+                           CLUTTER_SCRIPT_ERROR_INVALID_VALUE,
+                           "The data does not contain compiled UI definitions");
+      return 0;
+    }
+
+  variant = g_variant_new_from_data (G_VARIANT_TYPE_VARIANT,
+                                     data + COMPILED_HEADER_SIZE,
+                                     length - COMPILED_HEADER_SIZE,
+                                     FALSE,
+                                     NULL, NULL);
+  g_variant_ref_sink (variant);
+
+  child = g_variant_get_variant (variant);
+  root = json_gvariant_deserialize (child, NULL, error);
+
+  g_variant_unref (child);
+  g_variant_unref (variant);
+
+  if (root == NULL)
+    return 0;
+
+  priv = script->priv;
+
+  g_free (priv->filename);
+  priv->filename = NULL;
+  priv->is_filename = FALSE;
+  priv->last_merge_id += 1;
+
+  _clutter_script_parser_load_from_node (CLUTTER_SCRIPT_PARSER (priv->parser),
+                                         root);
+
+  json_node_free (root);
+
+  return priv->last_merge_id;
+}
+
+#define ALLOCATIONS_HEADER      "ClAllocs"
+#define ALLOCATIONS_HEADER_SIZE 8
+
+/**
+ * clutter_script_save_allocations:
+ * @script: a #ClutterScript
+ * @length: (out): return location for the length of the snapshot
+ *
+ * Saves the allocations of the actors defined by @script, so that they
+ * can be restored with clutter_script_restore_allocations() the next
+ * time the same UI definitions are loaded.
+ *
+ * Only the actors that have been constructed and allocated are saved;
+ * this function is meant to be called after the first frame of the
+ * user interface has been presented, and the snapshot stored in a
+ * cache file.
+ *
+ * Return value: (array length=length) (transfer full): the snapshot
+ *   of the allocations. Use g_free() to free the returned buffer
+ */
+gchar *
+clutter_script_save_allocations (ClutterScript *script,
+                                 gsize         *length)
+{
+  GVariantBuilder builder;
+  GVariant *variant;
+  GHashTableIter iter;
+  gpointer value;
+  gchar *retval;
+  gsize size;
+
+  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), NULL);
+  g_return_val_if_fail (length != NULL, NULL);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s(dddd)}"));
+
+  if (script->priv->objects != NULL)
+    {
+      g_hash_table_iter_init (&iter, script->priv->objects);
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        {
+          ObjectInfo *oinfo = value;
+          ClutterActorBox box;
+
+          if (!oinfo->is_actor || oinfo->object == NULL)
+            continue;
+
+          if (!clutter_actor_has_allocation (CLUTTER_ACTOR (oinfo->object)))
+            continue;
+
+          clutter_actor_get_allocation_box (CLUTTER_ACTOR (oinfo->object),
+                                            &box);
+
+          g_variant_builder_add (&builder, "{s(dddd)}",
+                                 oinfo->id,
+                                 (gdouble) box.x1, (gdouble) box.y1,
+                                 (gdouble) box.x2, (gdouble) box.y2);
+        }
+    }
+
+  variant = g_variant_builder_end (&builder);
+  g_variant_ref_sink (variant);
+
+  size = g_variant_get_size (variant);
+  retval = g_malloc (ALLOCATIONS_HEADER_SIZE + size);
+  memcpy (retval, ALLOCATIONS_HEADER, ALLOCATIONS_HEADER_SIZE);
+  g_variant_store (variant, retval + ALLOCATIONS_HEADER_SIZE);
+
+  *length = ALLOCATIONS_HEADER_SIZE + size;
+
+  g_variant_unref (variant);
+
+  return retval;
+}
+
+/* runs after the first frame painted using the restored allocations */
+static gboolean
+clutter_script_validate_allocations (gpointer data)
+{
+  GPtrArray *actors = data;
+  guint i;
+
+  for (i = 0; i < actors->len; i++)
+    clutter_actor_queue_relayout (g_ptr_array_index (actors, i));
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * clutter_script_restore_allocations:
+ * @script: a #ClutterScript
+ * @data: (array length=length): a snapshot created by
+ *   clutter_script_save_allocations()
+ * @length: the length of the snapshot
+ * @error: return location for a #GError, or %NULL
+ *
+ * Restores the allocations saved with clutter_script_save_allocations()
+ * on the actors defined by @script that have already been constructed.
  *
+ * The restored allocations are used to paint the next frame without
+ * running the layout of the actors; a relayout of each of the restored
+ * actors is queued after that frame, so that the allocations are
+ * validated against the current state of the user interface.
  *
+ * Identifiers in @data that do not match an actor constructed by
+ * @script are ignored; it is up to the application to discard the
+ * snapshots of different UI definitions, or of a different stage size.
+ *
+ * Return value: %TRUE if the snapshot was valid, and %FALSE otherwise
  */
-ClutterScript *
-clutter_script_new (void)
+gboolean
+clutter_script_restore_allocations (ClutterScript  *script,
+                                    const gchar    *data,
+                                    gsize           length,
+                                    GError        **error)
 {
-  return g_object_new (CLUTTER_TYPE_SCRIPT, NULL);
+  GVariant *variant;
+  GVariantIter iter;
+  GPtrArray *actors;
+  const gchar *id;
+  gdouble x1, y1, x2, y2;
+
+  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+
+  if (length < ALLOCATIONS_HEADER_SIZE ||
+      memcmp (data, ALLOCATIONS_HEADER, ALLOCATIONS_HEADER_SIZE) != 0)
+    {
+      g_set_error_literal (error, CLUTTER_SCRIPT_ERROR,
+                           CLUTTER_SCRIPT_ERROR_INVALID_VALUE,
+                           "The data does not contain saved allocations");
+      return FALSE;
+    }
+
+  variant = g_variant_new_from_data (G_VARIANT_TYPE ("a{s(dddd)}"),
+                                     data + ALLOCATIONS_HEADER_SIZE,
+                                     length - ALLOCATIONS_HEADER_SIZE,
+                                     FALSE,
+                                     NULL, NULL);
+  g_variant_ref_sink (variant);
+
+  actors = g_ptr_array_new_with_free_func (g_object_unref);
+
+  g_variant_iter_init (&iter, variant);
+  while (g_variant_iter_next (&iter, "{&s(dddd)}", &id, &x1, &y1, &x2, &y2))
+    {
+      ObjectInfo *oinfo;
+      ClutterActorBox box;
+
+      oinfo = _clutter_script_get_object_info (script, id);
+      if (oinfo == NULL || !oinfo->is_actor || oinfo->object == NULL)
+        continue;
+
+      clutter_actor_box_init (&box, x1, y1, x2, y2);
+      _clutter_actor_restore_allocation (CLUTTER_ACTOR (oinfo->object), &box);
+
+      g_ptr_array_add (actors, g_object_ref (oinfo->object));
+    }
+
+  g_variant_unref (variant);
+
+  if (actors->len > 0)
+    clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                           clutter_script_validate_allocations,
+                                           actors,
+                                           (GDestroyNotify) g_ptr_array_unref);
+  else
+    g_ptr_array_unref (actors);
+
+  return TRUE;
 }
 
 /**
- * clutter_script_load_from_file:
+ * clutter_script_load_from_resource:
  * @script: a #ClutterScript
- * @filename: the full path to the definition file
+ * @resource_path: the resource path of the file to parse
  * @error: return location for a #GError, or %NULL
  *
- * Loads the definitions from @filename into @script and merges with
+ * Loads the definitions from a resource file into @script and merges with
  * the currently loaded ones, if any.
  *
+ * The resource can contain either JSON definitions, or definitions
+ * compiled with clutter_script_compile_data().
+ *
  * Return value: on error, zero is returned and @error is set
  *   accordingly. On success, the merge id for the UI definitions is
  *   returned. You can use the merge id with clutter_script_unmerge_objects().
@@ -448,127 +1411,226 @@ clutter_script_new (void)
  *
  */
 guint
-clutter_script_load_from_file (ClutterScript  *script,
-                               const gchar    *filename,
-                               GError        **error)
+clutter_script_load_from_resource (ClutterScript  *script,
+                                   const gchar    *resource_path,
+                                   GError        **error)
 {
-  ClutterScriptPrivate *priv;
-  GError *internal_error;
+  GBytes *data;
+  guint res;
 
   g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), 0);
-  g_return_val_if_fail (filename != NULL, 0);
 
-  priv = script->priv;
+  data = g_resources_lookup_data (resource_path, 0, error);
+  if (data == NULL)
+    return 0;
 
-  g_free (priv->filename);
-  priv->filename = g_strdup (filename);
-  priv->is_filename = TRUE;
-  priv->last_merge_id += 1;
+  if (is_compiled_data (g_bytes_get_data (data, NULL), g_bytes_get_size (data)))
+    res = clutter_script_load_from_compiled_data (script,
+                                                  g_bytes_get_data (data, NULL),
+                                                  g_bytes_get_size (data),
+                                                  error);
+  else
+    res = clutter_script_load_from_data (script,
+                                         g_bytes_get_data (data, NULL),
+                                         g_bytes_get_size (data),
+                                         error);
 
-  internal_error = NULL;
-  json_parser_load_from_file (JSON_PARSER (priv->parser),
-                              filename,
-                              &internal_error);
-  if (internal_error)
+  g_bytes_unref (data);
+
+  return res;
+}
+
+static void connect_object_signals                  (ClutterScript            *script,
+                                                     ObjectInfo               *oinfo,
+                                                     ClutterScriptConnectFunc  func,
+                                                     gpointer                  user_data);
+static void clutter_script_connect_signals_internal (ClutterScript            *script,
+                                                     ClutterScriptConnectFunc  func,
+                                                     gpointer                  user_data,
+                                                     GDestroyNotify            notify);
+
+/* Constructs the object of @oinfo and applies its properties; objects
+ * constructed on demand also get their signals connected, and the
+ * properties of the actors in their sub-tree applied
+ */
+static void
+clutter_script_ensure_object (ClutterScript *script,
+                              ObjectInfo    *oinfo)
+{
+  ClutterScriptPrivate *priv = script->priv;
+  ClutterActor *child;
+  GList *l;
+
+  _clutter_script_construct_object (script, oinfo);
+  if (oinfo->object == NULL)
+    return;
+
+  _clutter_script_apply_properties (script, oinfo);
+
+  if (!priv->construct_on_demand)
+    return;
+
+  for (l = priv->deferred_connects; l != NULL && oinfo->signals != NULL; l = l->next)
     {
-      g_propagate_error (error, internal_error);
-      priv->last_merge_id -= 1;
-      return 0;
+      DeferredConnect *deferred = l->data;
+
+      connect_object_signals (script, oinfo, deferred->func, deferred->user_data);
     }
 
-  return priv->last_merge_id;
+  if (!CLUTTER_IS_ACTOR (oinfo->object))
+    return;
+
+  /* the children are constructed when they are added to the actor,
+   * but nothing else is done until they are ensured as well
+   */
+  for (child = clutter_actor_get_first_child (CLUTTER_ACTOR (oinfo->object));
+       child != NULL;
+       child = clutter_actor_get_next_sibling (child))
+    {
+      ObjectInfo *child_info;
+      const gchar *id_;
+
+      id_ = clutter_get_script_id (G_OBJECT (child));
+      if (id_ == NULL || *id_ == '\0')
+        continue;
+
+      child_info = _clutter_script_get_object_info (script, id_);
+      if (child_info == NULL || child_info->object != G_OBJECT (child))
+        continue;
+
+      if (child_info->has_unresolved ||
+          (child_info->signals != NULL && priv->deferred_connects != NULL))
+        clutter_script_ensure_object (script, child_info);
+    }
 }
 
 /**
- * clutter_script_load_from_data:
+ * clutter_script_add_template_from_data:
  * @script: a #ClutterScript
- * @data: a buffer containing the definitions
+ * @name: the name of the template
+ * @data: a buffer containing the definitions of the template
  * @length: the length of the buffer, or -1 if @data is a NUL-terminated
  *   buffer
  * @error: return location for a #GError, or %NULL
  *
- * Loads the definitions from @data into @script and merges with
- * the currently loaded ones, if any.
- *
- * Return value: on error, zero is returned and @error is set
- *   accordingly. On success, the merge id for the UI definitions is
- *   returned. You can use the merge id with clutter_script_unmerge_objects().
+ * Parses the UI definitions inside @data, and stores them inside
+ * @script as a template called @name, replacing any template with the
+ * same name.
  *
+ * No object is constructed by this function; the template can be
+ * instantiated any number of times with clutter_script_instantiate_template(),
+ * without parsing @data again.
  *
+ * Return value: %TRUE if the template was successfully parsed
  */
-guint
-clutter_script_load_from_data (ClutterScript  *script,
-                               const gchar    *data,
-                               gssize          length,
-                               GError        **error)
+gboolean
+clutter_script_add_template_from_data (ClutterScript  *script,
+                                       const gchar    *name,
+                                       const gchar    *data,
+                                       gssize          length,
+                                       GError        **error)
 {
   ClutterScriptPrivate *priv;
-  GError *internal_error;
+  JsonParser *parser;
+  JsonNode *root;
 
-  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), 0);
-  g_return_val_if_fail (data != NULL, 0);
+  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), FALSE);
+  g_return_val_if_fail (name != NULL, FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
 
   if (length < 0)
     length = strlen (data);
 
-  priv = script->priv;
-
-  g_free (priv->filename);
-  priv->filename = NULL;
-  priv->is_filename = FALSE;
-  priv->last_merge_id += 1;
+  parser = json_parser_new ();
+  if (!json_parser_load_from_data (parser, data, length, error))
+    {
+      g_object_unref (parser);
+      return FALSE;
+    }
 
-  internal_error = NULL;
-  json_parser_load_from_data (JSON_PARSER (priv->parser),
-                              data, length,
-                              &internal_error);
-  if (internal_error)
+  root = json_parser_get_root (parser);
+  if (root == NULL)
     {
-      g_propagate_error (error, internal_error);
-      priv->last_merge_id -= 1;
-      return 0;
+      g_set_error (error, CLUTTER_SCRIPT_ERROR,
+                   CLUTTER_SCRIPT_ERROR_INVALID_VALUE,
+                   "The template '%s' does not contain any definition",
+                   name);
+      g_object_unref (parser);
+      return FALSE;
     }
 
-  return priv->last_merge_id;
+  priv = script->priv;
+
+  if (priv->templates == NULL)
+    priv->templates = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                             g_free,
+                                             (GDestroyNotify) json_node_free);
+
+  g_hash_table_replace (priv->templates, g_strdup (name), json_node_copy (root));
+
+  g_object_unref (parser);
+
+  return TRUE;
 }
 
 /**
- * clutter_script_load_from_resource:
+ * clutter_script_instantiate_template:
  * @script: a #ClutterScript
- * @resource_path: the resource path of the file to parse
- * @error: return location for a #GError, or %NULL
+ * @name: the name of a template added with
+ *   clutter_script_add_template_from_data()
  *
- * Loads the definitions from a resource file into @script and merges with
- * the currently loaded ones, if any.
+ * Constructs the objects defined by the template @name.
  *
- * Return value: on error, zero is returned and @error is set
- *   accordingly. On success, the merge id for the UI definitions is
- *   returned. You can use the merge id with clutter_script_unmerge_objects().
+ * Every instance of a template is stored inside its own #ClutterScript,
+ * so the objects of each instance can be retrieved using the ids they
+ * have inside the template, and the signals of each instance can be
+ * connected using clutter_script_connect_signals(). The returned
+ * #ClutterScript inherits the search paths and the translation domain
+ * of @script.
  *
+ * Just like for any other #ClutterScript, the objects are owned by the
+ * returned instance; the actors added to a parent outside of the
+ * instance will survive the instance.
  *
+ * Return value: (transfer full): a new #ClutterScript with the objects
+ *   of the template, or %NULL if no template called @name was found.
+ *   Use g_object_unref() when done
  */
-guint
-clutter_script_load_from_resource (ClutterScript  *script,
-                                   const gchar    *resource_path,
-                                   GError        **error)
+ClutterScript *
+clutter_script_instantiate_template (ClutterScript *script,
+                                     const gchar   *name)
 {
-  GBytes *data;
-  guint res;
+  ClutterScriptPrivate *priv;
+  ClutterScript *instance;
+  JsonNode *root;
 
-  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), 0);
+  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), NULL);
+  g_return_val_if_fail (name != NULL, NULL);
 
-  data = g_resources_lookup_data (resource_path, 0, error);
-  if (data == NULL)
-    return 0;
+  priv = script->priv;
 
-  res = clutter_script_load_from_data (script,
-                                       g_bytes_get_data (data, NULL),
-                                       g_bytes_get_size (data),
-                                       error);
+  root = priv->templates != NULL ? g_hash_table_lookup (priv->templates, name)
+                                 : NULL;
+  if (root == NULL)
+    {
+      g_warning ("No template named '%s' was found", name);
+      return NULL;
+    }
 
-  g_bytes_unref (data);
+  /* subclasses may resolve the types differently */
+  instance = g_object_new (G_OBJECT_TYPE (script),
+                           "translation-domain", priv->translation_domain,
+                           NULL);
 
-  return res;
+  instance->priv->search_paths = g_strdupv (priv->search_paths);
+  instance->priv->last_merge_id += 1;
+
+  /* the parser modifies the object definitions while loading them */
+  root = json_node_copy (root);
+  _clutter_script_parser_load_from_node (instance->priv->parser, root);
+  json_node_free (root);
+
+  return instance;
 }
 
 /**
@@ -597,8 +1659,7 @@ clutter_script_get_object (ClutterScript *script,
   if (!oinfo)
     return NULL;
 
-  _clutter_script_construct_object (script, oinfo);
-  _clutter_script_apply_properties (script, oinfo);
+  clutter_script_ensure_object (script, oinfo);
 
   return oinfo->object;
 }
@@ -746,20 +1807,13 @@ construct_each_objects (gpointer key,
   ClutterScript *script = user_data;
   ObjectInfo *oinfo = value;
 
-  /* we have unfinished business */
-  if (oinfo->has_unresolved)
-    {
-      /* this should not happen, but resilence is
-       * a good thing in a parser
-       */
-      if (oinfo->object == NULL)
-        _clutter_script_construct_object (script, oinfo);
-
-      /* this will take care of setting up properties,
-       * adding children and applying behaviours
-       */
-      _clutter_script_apply_properties (script, oinfo);
-    }
+  /* we have unfinished business; this will take care of constructing
+   * the object, setting up properties, adding children and applying
+   * behaviours
+   */
+  if (oinfo->has_unresolved ||
+      (oinfo->signals != NULL && script->priv->deferred_connects != NULL))
+    clutter_script_ensure_object (script, oinfo);
 }
 
 /**
@@ -806,6 +1860,31 @@ clutter_script_get_type_from_name (ClutterScript *script,
   return CLUTTER_SCRIPT_GET_CLASS (script)->get_type_from_name (script, type_name);
 }
 
+/**
+ * clutter_script_register_type: (skip)
+ * @type_name: the name of a type
+ * @get_type_func: the function returning the #GType for @type_name
+ *
+ * Registers @type_name with the types that #ClutterScript can resolve
+ * without looking up the type function inside the symbol table of the
+ * process.
+ *
+ * Applications defining their own types, and using them inside UI
+ * definitions, should call this function before loading the definitions.
+ *
+ * The @get_type_func will only be called the first time @type_name is
+ * used by a #ClutterScript instance.
+ */
+void
+clutter_script_register_type (const gchar *type_name,
+                              GType      (* get_type_func) (void))
+{
+  g_return_if_fail (type_name != NULL);
+  g_return_if_fail (get_type_func != NULL);
+
+  _clutter_script_register_type_func (type_name, get_type_func);
+}
+
 /**
  * clutter_get_script_id:
  * @gobject: a #GObject
@@ -834,6 +1913,15 @@ typedef struct {
   gpointer data;
 } ConnectData;
 
+static void
+connect_data_free (gpointer data)
+{
+  ConnectData *cd = data;
+
+  g_module_close (cd->module);
+  g_free (cd);
+}
+
 /* default signal connection code */
 static void
 clutter_script_default_connect (ClutterScript *script,
@@ -920,13 +2008,10 @@ clutter_script_connect_signals (ClutterScript *script,
   cd->module = g_module_open (NULL, 0);
   cd->data = user_data;
 
-  clutter_script_connect_signals_full (script,
-                                       clutter_script_default_connect,
-                                       cd);
-
-  g_module_close (cd->module);
-
-  g_free (cd);
+  clutter_script_connect_signals_internal (script,
+                                           clutter_script_default_connect,
+                                           cd,
+                                           connect_data_free);
 }
 
 typedef struct {
@@ -936,18 +2021,14 @@ typedef struct {
 } SignalConnectData;
 
 static void
-connect_each_object (gpointer key,
-                     gpointer value,
-                     gpointer data)
+connect_object_signals (ClutterScript            *script,
+                        ObjectInfo               *oinfo,
+                        ClutterScriptConnectFunc  func,
+                        gpointer                  user_data)
 {
-  SignalConnectData *connect_data = data;
-  ClutterScript *script = connect_data->script;
-  ObjectInfo *oinfo = value;
   GObject *object = oinfo->object;
   GList *unresolved, *l;
 
-  _clutter_script_construct_object (script, oinfo);
-
   unresolved = NULL;
   for (l = oinfo->signals; l != NULL; l = l->next)
     {
@@ -964,12 +2045,12 @@ connect_each_object (gpointer key,
             unresolved = g_list_prepend (unresolved, sinfo);
           else
             {
-              connect_data->func (script, object,
-                                  sinfo->name,
-                                  sinfo->handler,
-                                  connect_object,
-                                  sinfo->flags,
-                                  connect_data->user_data);
+              func (script, object,
+                    sinfo->name,
+                    sinfo->handler,
+                    connect_object,
+                    sinfo->flags,
+                    user_data);
             }
         }
 
@@ -984,6 +2065,60 @@ connect_each_object (gpointer key,
   oinfo->signals = unresolved;
 }
 
+static void
+connect_each_object (gpointer key,
+                     gpointer value,
+                     gpointer data)
+{
+  SignalConnectData *connect_data = data;
+  ClutterScript *script = connect_data->script;
+  ObjectInfo *oinfo = value;
+
+  /* the objects that have not been constructed yet will have their
+   * signals connected when they are
+   */
+  if (oinfo->object == NULL && script->priv->construct_on_demand)
+    return;
+
+  _clutter_script_construct_object (script, oinfo);
+  if (oinfo->object == NULL)
+    return;
+
+  connect_object_signals (script, oinfo,
+                          connect_data->func,
+                          connect_data->user_data);
+}
+
+static void
+clutter_script_connect_signals_internal (ClutterScript            *script,
+                                         ClutterScriptConnectFunc  func,
+                                         gpointer                  user_data,
+                                         GDestroyNotify            notify)
+{
+  ClutterScriptPrivate *priv = script->priv;
+  SignalConnectData data;
+
+  data.script = script;
+  data.func = func;
+  data.user_data = user_data;
+
+  g_hash_table_foreach (priv->objects, connect_each_object, &data);
+
+  if (priv->construct_on_demand)
+    {
+      DeferredConnect *deferred = g_slice_new (DeferredConnect);
+
+      deferred->func = func;
+      deferred->user_data = user_data;
+      deferred->notify = notify;
+
+      priv->deferred_connects = g_list_append (priv->deferred_connects,
+                                               deferred);
+    }
+  else if (notify != NULL)
+    notify (user_data);
+}
+
 /**
  * clutter_script_connect_signals_full:
  * @script: a #ClutterScript
@@ -1008,16 +2143,10 @@ clutter_script_connect_signals_full (ClutterScript            *script,
                                      ClutterScriptConnectFunc  func,
                                      gpointer                  user_data)
 {
-  SignalConnectData data;
-
   g_return_if_fail (CLUTTER_IS_SCRIPT (script));
   g_return_if_fail (func != NULL);
 
-  data.script = script;
-  data.func = func;
-  data.user_data = user_data;
-
-  g_hash_table_foreach (script->priv->objects, connect_each_object, &data);
+  clutter_script_connect_signals_internal (script, func, user_data, NULL);
 }
 
 GQuark
@@ -1239,6 +2368,54 @@ clutter_script_get_translation_domain (ClutterScript *script)
   return script->priv->translation_domain;
 }
 
+/**
+ * clutter_script_set_construct_on_demand:
+ * @script: a #ClutterScript
+ * @construct_on_demand: whether the objects should only be constructed
+ *   when needed
+ *
+ * Sets whether the objects defined in the UI definitions loaded by
+ * @script should only be constructed when needed.
+ *
+ * This function should be called before loading any UI definition.
+ * See #ClutterScript:construct-on-demand for more information.
+ */
+void
+clutter_script_set_construct_on_demand (ClutterScript *script,
+                                        gboolean       construct_on_demand)
+{
+  ClutterScriptPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_SCRIPT (script));
+
+  priv = script->priv;
+
+  construct_on_demand = !!construct_on_demand;
+
+  if (priv->construct_on_demand == construct_on_demand)
+    return;
+
+  priv->construct_on_demand = construct_on_demand;
+
+  g_object_notify_by_pspec (G_OBJECT (script), obj_props[PROP_CONSTRUCT_ON_DEMAND]);
+}
+
+/**
+ * clutter_script_get_construct_on_demand:
+ * @script: a #ClutterScript
+ *
+ * Retrieves whether @script only constructs objects when needed.
+ *
+ * Return value: %TRUE if the objects are constructed on demand
+ */
+gboolean
+clutter_script_get_construct_on_demand (ClutterScript *script)
+{
+  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), FALSE);
+
+  return script->priv->construct_on_demand;
+}
+
 /*
  * _clutter_script_generate_fake_id:
  * @script: a #ClutterScript
@@ -1372,6 +2549,9 @@ _clutter_script_get_object_info (ClutterScript *script,
 guint
 _clutter_script_get_last_merge_id (ClutterScript *script)
 {
+  if (script->priv->loading_merge_id != 0)
+    return script->priv->loading_merge_id;
+
   return script->priv->last_merge_id;
 }
 
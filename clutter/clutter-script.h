@@ -28,6 +28,7 @@
 #ifndef __CLUTTER_SCRIPT_H__
 #define __CLUTTER_SCRIPT_H__
 
+#include <gio/gio.h>
 #include <clutter/clutter-types.h>
 
 G_BEGIN_DECLS
@@ -154,9 +155,44 @@ guint           clutter_script_load_from_data           (ClutterScript
                                                          gssize                     length,
                                                          GError                   **error);
 
+guint           clutter_script_load_from_stream         (ClutterScript             *script,
+                                                         GInputStream              *stream,
+                                                         GCancellable              *cancellable,
+                                                         GError                   **error);
+void            clutter_script_load_from_stream_async   (ClutterScript             *script,
+                                                         GInputStream              *stream,
+                                                         GCancellable              *cancellable,
+                                                         GAsyncReadyCallback        callback,
+                                                         gpointer                   user_data);
+guint           clutter_script_load_from_stream_finish  (ClutterScript             *script,
+                                                         GAsyncResult              *result,
+                                                         GError                   **error);
+
 guint           clutter_script_load_from_resource       (ClutterScript             *script,
                                                          const gchar               *resource_path,
                                                          GError                   **error);
+guint           clutter_script_load_from_compiled_data  (ClutterScript             *script,
+                                                         const gchar               *data,
+                                                         gsize                      length,
+                                                         GError                   **error);
+gchar *         clutter_script_save_allocations         (ClutterScript             *script,
+                                                         gsize                     *length);
+gboolean        clutter_script_restore_allocations      (ClutterScript             *script,
+                                                         const gchar               *data,
+                                                         gsize                      length,
+                                                         GError                   **error);
+gchar *         clutter_script_compile_data             (const gchar               *data,
+                                                         gssize                     length,
+                                                         gsize                     *compiled_length,
+                                                         GError                   **error);
+
+gboolean        clutter_script_add_template_from_data   (ClutterScript             *script,
+                                                         const gchar               *name,
+                                                         const gchar               *data,
+                                                         gssize                     length,
+                                                         GError                   **error);
+ClutterScript * clutter_script_instantiate_template     (ClutterScript             *script,
+                                                         const gchar               *name);
 
 GObject *       clutter_script_get_object               (ClutterScript             *script,
                                                          const gchar               *name);
@@ -181,6 +217,8 @@ gchar *         clutter_script_lookup_filename          (ClutterScript
                                                          const gchar               *filename) G_GNUC_MALLOC;
 GType           clutter_script_get_type_from_name       (ClutterScript             *script,
                                                          const gchar               *type_name);
+void            clutter_script_register_type            (const gchar               *type_name,
+                                                         GType                    (* get_type_func) (void));
 
 
 void            clutter_script_set_translation_domain   (ClutterScript             *script,
@@ -188,6 +226,10 @@ void            clutter_script_set_translation_domain   (ClutterScript
 
 const gchar *   clutter_script_get_translation_domain   (ClutterScript             *script);
 
+void            clutter_script_set_construct_on_demand  (ClutterScript             *script,
+                                                         gboolean                   construct_on_demand);
+gboolean        clutter_script_get_construct_on_demand  (ClutterScript             *script);
+
 const gchar *   clutter_get_script_id                   (GObject                   *gobject);
 
 G_END_DECLS
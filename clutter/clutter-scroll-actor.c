@@ -36,6 +36,24 @@
  * #ClutterScrollActor does not provide pointer or keyboard event handling,
  * nor does it provide visible scroll handles.
  *
+ * #ClutterScrollActor can also display a vertical list of items whose
+ * contents are provided by a #ClutterModel, using
+ * clutter_scroll_actor_set_model(); in that mode, the scroll actor will
+ * only create the actors for the rows that intersect the visible area,
+ * plus a prefetch margin, and will recycle the actors scrolled out of
+ * view. The height of the rows that have never been shown is estimated
+ * from the height of the rows that have been.
+ *
+ * A #ClutterScrollActor displaying static but complex contents can
+ * cache them, using clutter_scroll_actor_set_use_tile_cache(); the
+ * children are rendered into a grid of textures covering the visible
+ * area and its surroundings, so that scrolling only needs to paint
+ * the textures, and to render the tiles that become visible. A redraw
+ * queued by a descendant of the scroll actor only renders again the
+ * tiles covered by its clip, while a relayout renders all of them;
+ * the children are always painted in two dimensions, without the
+ * perspective of the stage.
+ *
  * <informalexample>
  *  <programlisting>
  * <xi:include xmlns:xi="http://www.w3.org/2001/XInclude" parse="text" href="../../../../examples/scroll-actor.c">
@@ -47,87 +65,1243 @@
  * #ClutterScrollActor is available since Clutter 1.12.
  */
 
-#ifdef HAVE_CONFIG_H
-#include "config.h"
-#endif
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <string.h>
+
+#include "clutter-scroll-actor-private.h"
+
+#include "clutter-actor-private.h"
+#include "clutter-animatable.h"
+#include "clutter-debug.h"
+#include "clutter-enum-types.h"
+#include "clutter-main.h"
+#include "clutter-memory.h"
+#include "clutter-model.h"
+#include "clutter-paint-volume-private.h"
+#include "clutter-private.h"
+#include "clutter-property-transition.h"
+#include "clutter-stage-private.h"
+#include "clutter-transition.h"
+
+struct _ClutterScrollActorPrivate
+{
+  ClutterPoint scroll_to;
+
+  ClutterScrollMode scroll_mode;
+
+  ClutterTransition *transition;
+
+  /* virtualized mode */
+  ClutterModel *model;
+  ClutterScrollActorCreateItemFunc create_item;
+  gpointer create_item_data;
+  GDestroyNotify create_item_notify;
+
+  /* the height of each row, measured or estimated, and the Fenwick
+   * tree of their prefix sums, so that mapping an offset to a row and
+   * a row to an offset are both O(log n)
+   */
+  GArray *row_heights;
+  gdouble *row_tree;
+  guint row_tree_mask;
+
+  gdouble measured_height;
+  guint n_measured;
+
+  /* the realized items, covering the rows starting from first_item;
+   * NULL slots are rows that need to be created again
+   */
+  GPtrArray *items;
+  guint first_item;
+
+  /* hidden children available for reuse */
+  GPtrArray *recycled;
+
+  gfloat viewport_width;
+  gfloat viewport_height;
+
+  guint update_id;
+
+  /* tile cache mode; the tiles are indexed by their position in the
+   * grid, packed by tile_key(); tile_generation is bumped each time
+   * all the tiles are invalidated
+   */
+  gboolean use_tile_cache;
+  GHashTable *tiles;
+  CoglPipeline *tile_pipeline;
+  guint tile_generation;
+};
+
+typedef struct _ScrollTile
+{
+  gint64 key;
+
+  gint column;
+  gint row;
+
+  CoglHandle texture;
+  CoglHandle offscreen;
+
+  gboolean valid;
+} ScrollTile;
+
+/* the content box covered by the last redraw queued by a descendant,
+ * stored on the descendant, so that the next redraw also damages the
+ * area where it was painted before
+ */
+typedef struct _TileDamage
+{
+  ClutterScrollActor *scroll;
+  guint generation;
+  ClutterActorBox box;
+} TileDamage;
+
+/* the rows within this fraction of the viewport height on either side
+ * of the visible area are realized ahead of time
+ */
+#define PREFETCH_FACTOR         1.0f
+
+/* the estimated height of a row before any has been measured */
+#define DEFAULT_ROW_HEIGHT      32.0f
+
+/* the maximum number of hidden items kept around for reuse */
+#define MAX_RECYCLED_ITEMS      32
+
+/* the number of times the realized window is recomputed after the
+ * new rows have been measured
+ */
+#define MAX_UPDATE_PASSES       3
+
+/* the size of the side of a cached tile, in pixels */
+#define TILE_SIZE               256
+
+/* the number of tiles rendered ahead of time on each side of the
+ * visible ones
+ */
+#define TILE_PREFETCH           1
+
+/* the maximum number of tiles outside of the visible area rendered
+ * in a single frame
+ */
+#define MAX_PREFETCH_TILES      2
+
+/* the depth range of the projection used to render the tiles */
+#define TILE_Z_RANGE            (10.f * TILE_SIZE)
+
+enum
+{
+  PROP_0,
+
+  PROP_SCROLL_MODE,
+  PROP_USE_TILE_CACHE,
+
+  PROP_LAST
+};
+
+enum
+{
+  ANIM_PROP_0,
+
+  ANIM_PROP_SCROLL_TO,
+
+  ANIM_PROP_LAST
+};
+
+static GParamSpec *obj_props[PROP_LAST] = { NULL, };
+static GParamSpec *animatable_props[ANIM_PROP_LAST] = { NULL, };
+
+static ClutterAnimatableIface *parent_animatable_iface = NULL;
+
+static GQuark quark_tile_damage = 0;
+
+static void     clutter_animatable_iface_init   (ClutterAnimatableIface *iface);
+
+static void     clutter_scroll_actor_update_items (ClutterScrollActor *self);
+
+G_DEFINE_TYPE_WITH_CODE (ClutterScrollActor, clutter_scroll_actor, CLUTTER_TYPE_ACTOR,
+                         G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_ANIMATABLE,
+                                                clutter_animatable_iface_init))
+
+static void
+clutter_scroll_actor_set_scroll_to_internal (ClutterScrollActor *self,
+                                             const ClutterPoint *point)
+{
+  ClutterScrollActorPrivate *priv = self->priv;
+  ClutterActor *actor = CLUTTER_ACTOR (self);
+  ClutterMatrix m = CLUTTER_MATRIX_INIT_IDENTITY;
+  float dx, dy;
+
+  if (clutter_point_equals (&priv->scroll_to, point))
+    return;
+
+  if (point == NULL)
+    clutter_point_init (&priv->scroll_to, 0.f, 0.f);
+  else
+    priv->scroll_to = *point;
+
+  if (priv->scroll_mode & CLUTTER_SCROLL_HORIZONTALLY)
+    dx = -priv->scroll_to.x;
+  else
+    dx = 0.f;
+
+  if (priv->scroll_mode & CLUTTER_SCROLL_VERTICALLY)
+    dy = -priv->scroll_to.y;
+  else
+    dy = 0.f;
+
+  cogl_matrix_translate (&m, dx, dy, 0.f);
+  clutter_actor_set_child_transform (actor, &m);
+
+  if (priv->model != NULL)
+    clutter_scroll_actor_update_items (self);
+}
+
+static void
+row_tree_rebuild (ClutterScrollActorPrivate *priv)
+{
+  guint n_rows = priv->row_heights->len;
+  guint i;
+
+  g_free (priv->row_tree);
+  priv->row_tree = g_new0 (gdouble, n_rows + 1);
+
+  for (i = 1; i <= n_rows; i++)
+    {
+      guint parent = i + (i & -i);
+
+      priv->row_tree[i] += g_array_index (priv->row_heights, gfloat, i - 1);
+
+      if (parent <= n_rows)
+        priv->row_tree[parent] += priv->row_tree[i];
+    }
+
+  priv->row_tree_mask = 1;
+  while ((priv->row_tree_mask << 1) <= n_rows)
+    priv->row_tree_mask <<= 1;
+}
+
+static void
+row_tree_set_height (ClutterScrollActorPrivate *priv,
+                     guint                      row,
+                     gfloat                     height)
+{
+  guint n_rows = priv->row_heights->len;
+  gfloat *old_height;
+  gdouble delta;
+  guint i;
+
+  old_height = &g_array_index (priv->row_heights, gfloat, row);
+  delta = height - *old_height;
+  *old_height = height;
+
+  for (i = row + 1; i <= n_rows; i += (i & -i))
+    priv->row_tree[i] += delta;
+}
+
+/* the sum of the heights of the rows before @row */
+static gdouble
+row_tree_get_offset (ClutterScrollActorPrivate *priv,
+                     guint                      row)
+{
+  gdouble retval = 0.0;
+  guint i;
+
+  for (i = row; i > 0; i -= (i & -i))
+    retval += priv->row_tree[i];
+
+  return retval;
+}
+
+/* the row containing @offset, or the number of rows if @offset is past
+ * the last one
+ */
+static guint
+row_tree_find (ClutterScrollActorPrivate *priv,
+               gdouble                    offset)
+{
+  guint n_rows = priv->row_heights->len;
+  guint pos = 0, mask;
+
+  if (n_rows == 0)
+    return 0;
+
+  for (mask = priv->row_tree_mask; mask != 0; mask >>= 1)
+    {
+      if (pos + mask <= n_rows && priv->row_tree[pos + mask] <= offset)
+        {
+          pos += mask;
+          offset -= priv->row_tree[pos];
+        }
+    }
+
+  return pos;
+}
+
+static gfloat
+clutter_scroll_actor_get_row_estimate (ClutterScrollActorPrivate *priv)
+{
+  if (priv->n_measured == 0)
+    return DEFAULT_ROW_HEIGHT;
+
+  return priv->measured_height / priv->n_measured;
+}
+
+static void
+clutter_scroll_actor_recycle_item (ClutterScrollActor *self,
+                                   ClutterActor       *item)
+{
+  ClutterScrollActorPrivate *priv = self->priv;
+
+  if (priv->recycled->len < MAX_RECYCLED_ITEMS)
+    {
+      _clutter_actor_reset_for_reuse (item);
+      clutter_actor_hide (item);
+      g_ptr_array_add (priv->recycled, item);
+    }
+  else
+    clutter_actor_destroy (item);
+}
+
+static ClutterActor *
+clutter_scroll_actor_create_item (ClutterScrollActor *self,
+                                  guint               row)
+{
+  ClutterScrollActorPrivate *priv = self->priv;
+  ClutterActor *recycled = NULL;
+  ClutterModelIter *iter;
+  ClutterActor *item;
+
+  iter = clutter_model_get_iter_at_row (priv->model, row);
+  if (iter == NULL)
+    return NULL;
+
+  if (priv->recycled->len > 0)
+    recycled = g_ptr_array_remove_index_fast (priv->recycled,
+                                              priv->recycled->len - 1);
+
+  item = priv->create_item (self, iter, recycled, priv->create_item_data);
+  g_object_unref (iter);
+
+  if (recycled != NULL && item != recycled)
+    clutter_actor_destroy (recycled);
+
+  if (item == NULL)
+    return NULL;
+
+  if (clutter_actor_get_parent (item) == NULL)
+    clutter_actor_add_child (CLUTTER_ACTOR (self), item);
+
+  clutter_actor_show (item);
+
+  return item;
+}
+
+/* measures the realized items, and returns TRUE if any of the row
+ * heights changed
+ */
+static gboolean
+clutter_scroll_actor_measure_items (ClutterScrollActor *self)
+{
+  ClutterScrollActorPrivate *priv = self->priv;
+  gboolean retval = FALSE;
+  guint i;
+
+  for (i = 0; i < priv->items->len; i++)
+    {
+      ClutterActor *item = g_ptr_array_index (priv->items, i);
+      guint row = priv->first_item + i;
+      gfloat height;
+
+      if (item == NULL)
+        continue;
+
+      clutter_actor_get_preferred_height (item, priv->viewport_width,
+                                          NULL,
+                                          &height);
+
+      if (height == g_array_index (priv->row_heights, gfloat, row))
+        continue;
+
+      /* the first measurement replaces the default estimate */
+      if (priv->n_measured == 0 && priv->row_heights->len > 1)
+        {
+          guint j;
+
+          for (j = 0; j < priv->row_heights->len; j++)
+            g_array_index (priv->row_heights, gfloat, j) = height;
+
+          row_tree_rebuild (priv);
+        }
+      else
+        row_tree_set_height (priv, row, height);
+
+      priv->measured_height += height;
+      priv->n_measured += 1;
+
+      retval = TRUE;
+    }
+
+  return retval;
+}
+
+static void
+clutter_scroll_actor_update_items (ClutterScrollActor *self)
+{
+  ClutterScrollActorPrivate *priv = self->priv;
+  gdouble top, bottom, margin;
+  guint n_passes = 0;
+  guint first, last;
+  guint i;
+
+  if (priv->model == NULL ||
+      priv->viewport_width <= 0.f ||
+      priv->viewport_height <= 0.f)
+    return;
+
+  margin = priv->viewport_height * PREFETCH_FACTOR;
+
+  do
+    {
+      GPtrArray *items;
+      guint row;
+
+      top = MAX (priv->scroll_to.y - margin, 0.0);
+      bottom = priv->scroll_to.y + priv->viewport_height + margin;
+
+      first = row_tree_find (priv, top);
+      last = MIN (row_tree_find (priv, bottom) + 1, priv->row_heights->len);
+      if (first > last)
+        first = last;
+
+      if (first == priv->first_item && last - first == priv->items->len)
+        {
+          gboolean complete = TRUE;
+
+          for (i = 0; i < priv->items->len; i++)
+            {
+              if (g_ptr_array_index (priv->items, i) == NULL)
+                {
+                  complete = FALSE;
+                  break;
+                }
+            }
+
+          if (complete)
+            break;
+        }
+
+      /* recycle the items that fell out of the realized window */
+      for (i = 0; i < priv->items->len; i++)
+        {
+          ClutterActor *item = g_ptr_array_index (priv->items, i);
+
+          row = priv->first_item + i;
+          if (item != NULL && (row < first || row >= last))
+            {
+              g_ptr_array_index (priv->items, i) = NULL;
+              clutter_scroll_actor_recycle_item (self, item);
+            }
+        }
+
+      items = g_ptr_array_sized_new (last - first);
+
+      for (row = first; row < last; row++)
+        {
+          ClutterActor *item = NULL;
+
+          if (row >= priv->first_item &&
+              row < priv->first_item + priv->items->len)
+            item = g_ptr_array_index (priv->items, row - priv->first_item);
+
+          if (item == NULL)
+            item = clutter_scroll_actor_create_item (self, row);
+
+          g_ptr_array_add (items, item);
+        }
+
+      g_ptr_array_unref (priv->items);
+      priv->items = items;
+      priv->first_item = first;
+    }
+  while (clutter_scroll_actor_measure_items (self) &&
+         ++n_passes < MAX_UPDATE_PASSES);
+
+  for (i = 0; i < priv->items->len; i++)
+    {
+      ClutterActor *item = g_ptr_array_index (priv->items, i);
+      gdouble offset;
+
+      if (item == NULL)
+        continue;
+
+      offset = row_tree_get_offset (priv, priv->first_item + i);
+
+      clutter_actor_set_position (item, 0.f, offset);
+      clutter_actor_set_width (item, priv->viewport_width);
+    }
+}
+
+static gboolean
+clutter_scroll_actor_update_idle (gpointer data)
+{
+  ClutterScrollActor *self = data;
+
+  self->priv->update_id = 0;
+
+  clutter_scroll_actor_update_items (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+clutter_scroll_actor_queue_update (ClutterScrollActor *self)
+{
+  ClutterScrollActorPrivate *priv = self->priv;
+
+  if (priv->update_id != 0)
+    return;
+
+  /* run before the master clock, so that the new items are laid out
+   * and painted in the same frame
+   */
+  priv->update_id =
+    clutter_threads_add_idle_full (G_PRIORITY_HIGH_IDLE + 10,
+                                   clutter_scroll_actor_update_idle,
+                                   self,
+                                   NULL);
+}
+
+static void
+clutter_scroll_actor_clear_items (ClutterScrollActor *self)
+{
+  ClutterScrollActorPrivate *priv = self->priv;
+  guint i;
+
+  for (i = 0; i < priv->items->len; i++)
+    {
+      ClutterActor *item = g_ptr_array_index (priv->items, i);
+
+      g_ptr_array_index (priv->items, i) = NULL;
+
+      if (item != NULL)
+        clutter_scroll_actor_recycle_item (self, item);
+    }
+
+  g_ptr_array_set_size (priv->items, 0);
+  priv->first_item = 0;
+}
+
+static void
+clutter_scroll_actor_reset_rows (ClutterScrollActor *self)
+{
+  ClutterScrollActorPrivate *priv = self->priv;
+  guint n_rows, i;
+  gfloat estimate;
+
+  clutter_scroll_actor_clear_items (self);
+
+  n_rows = priv->model != NULL ? clutter_model_get_n_rows (priv->model) : 0;
+  estimate = clutter_scroll_actor_get_row_estimate (priv);
+
+  g_array_set_size (priv->row_heights, n_rows);
+  for (i = 0; i < n_rows; i++)
+    g_array_index (priv->row_heights, gfloat, i) = estimate;
+
+  row_tree_rebuild (priv);
+
+  clutter_scroll_actor_queue_update (self);
+}
+
+static void
+on_model_row_added (ClutterModel       *model,
+                    ClutterModelIter   *iter,
+                    ClutterScrollActor *self)
+{
+  ClutterScrollActorPrivate *priv = self->priv;
+  gfloat estimate;
+  guint row;
+
+  /* the row indices of a filtered model are not stable */
+  if (clutter_model_get_filter_set (model))
+    {
+      clutter_scroll_actor_reset_rows (self);
+      return;
+    }
+
+  row = clutter_model_iter_get_row (iter);
+  if (row > priv->row_heights->len)
+    row = priv->row_heights->len;
+
+  estimate = clutter_scroll_actor_get_row_estimate (priv);
+  g_array_insert_val (priv->row_heights, row, estimate);
+  row_tree_rebuild (priv);
+
+  if (row <= priv->first_item && priv->items->len > 0)
+    priv->first_item += 1;
+  else if (row < priv->first_item + priv->items->len)
+    {
+      guint slot = row - priv->first_item;
+
+      g_ptr_array_add (priv->items, NULL);
+      memmove (priv->items->pdata + slot + 1,
+               priv->items->pdata + slot,
+               (priv->items->len - slot - 1) * sizeof (gpointer));
+      priv->items->pdata[slot] = NULL;
+    }
+
+  clutter_scroll_actor_queue_update (self);
+}
+
+static void
+on_model_row_removed (ClutterModel       *model,
+                      ClutterModelIter   *iter,
+                      ClutterScrollActor *self)
+{
+  ClutterScrollActorPrivate *priv = self->priv;
+  guint row;
+
+  if (clutter_model_get_filter_set (model))
+    {
+      clutter_scroll_actor_reset_rows (self);
+      return;
+    }
+
+  row = clutter_model_iter_get_row (iter);
+  if (row >= priv->row_heights->len)
+    return;
+
+  if (row < priv->first_item)
+    priv->first_item -= 1;
+  else if (row < priv->first_item + priv->items->len)
+    {
+      ClutterActor *item;
+
+      item = g_ptr_array_remove_index (priv->items, row - priv->first_item);
+      if (item != NULL)
+        clutter_scroll_actor_recycle_item (self, item);
+    }
+
+  g_array_remove_index (priv->row_heights, row);
+  row_tree_rebuild (priv);
+
+  /* the row is still in the model while ::row-removed is emitted */
+  clutter_scroll_actor_queue_update (self);
+}
+
+static void
+on_model_row_changed (ClutterModel       *model,
+                      ClutterModelIter   *iter,
+                      ClutterScrollActor *self)
+{
+  ClutterScrollActorPrivate *priv = self->priv;
+  ClutterActor *item;
+  guint row;
+
+  row = clutter_model_iter_get_row (iter);
+  if (row < priv->first_item || row >= priv->first_item + priv->items->len)
+    return;
+
+  item = g_ptr_array_index (priv->items, row - priv->first_item);
+  if (item == NULL)
+    return;
+
+  g_ptr_array_index (priv->items, row - priv->first_item) = NULL;
+  clutter_scroll_actor_recycle_item (self, item);
+
+  clutter_scroll_actor_queue_update (self);
+}
+
+static void
+on_model_reset (ClutterModel       *model,
+                ClutterScrollActor *self)
+{
+  clutter_scroll_actor_reset_rows (self);
+}
+
+static void
+on_actor_removed (ClutterActor *container,
+                  ClutterActor *child)
+{
+  ClutterScrollActorPrivate *priv = CLUTTER_SCROLL_ACTOR (container)->priv;
+  guint i;
+
+  /* the items might be destroyed by the application */
+  if (priv->items != NULL)
+    {
+      for (i = 0; i < priv->items->len; i++)
+        {
+          if (g_ptr_array_index (priv->items, i) == child)
+            g_ptr_array_index (priv->items, i) = NULL;
+        }
+    }
+
+  if (priv->recycled != NULL)
+    g_ptr_array_remove_fast (priv->recycled, child);
+}
+
+static void
+clutter_scroll_actor_disconnect_model (ClutterScrollActor *self)
+{
+  ClutterScrollActorPrivate *priv = self->priv;
+
+  if (priv->model == NULL)
+    return;
+
+  g_signal_handlers_disconnect_by_func (priv->model, on_model_row_added, self);
+  g_signal_handlers_disconnect_by_func (priv->model, on_model_row_removed, self);
+  g_signal_handlers_disconnect_by_func (priv->model, on_model_row_changed, self);
+  g_signal_handlers_disconnect_by_func (priv->model, on_model_reset, self);
+
+  g_clear_object (&priv->model);
+
+  if (priv->create_item_notify != NULL)
+    priv->create_item_notify (priv->create_item_data);
+
+  priv->create_item = NULL;
+  priv->create_item_data = NULL;
+  priv->create_item_notify = NULL;
+}
+
+static inline gint64
+tile_key (gint column,
+          gint row)
+{
+  return ((gint64) column << 32) | (guint32) row;
+}
+
+static void
+scroll_tile_free (gpointer data)
+{
+  ScrollTile *tile = data;
+
+  if (tile->offscreen != NULL)
+    cogl_handle_unref (tile->offscreen);
+
+  if (tile->texture != NULL)
+    cogl_handle_unref (tile->texture);
+
+  g_slice_free (ScrollTile, tile);
+}
+
+static void
+tile_damage_free (gpointer data)
+{
+  g_slice_free (TileDamage, data);
+}
+
+/* the offset of the visible area inside the contents, taken from the
+ * child transform set by clutter_scroll_actor_set_scroll_to_internal()
+ */
+static void
+clutter_scroll_actor_get_offset (ClutterScrollActor *self,
+                                 gfloat             *x_offset,
+                                 gfloat             *y_offset)
+{
+  ClutterMatrix m;
+
+  clutter_actor_get_child_transform (CLUTTER_ACTOR (self), &m);
+
+  *x_offset = -m.xw;
+  *y_offset = -m.yw;
+}
+
+static void
+clutter_scroll_actor_release_tiles (ClutterScrollActor *self)
+{
+  ClutterScrollActorPrivate *priv = self->priv;
+
+  if (priv->tiles != NULL)
+    {
+      g_hash_table_unref (priv->tiles);
+      priv->tiles = NULL;
+    }
+
+  priv->tile_generation += 1;
+}
+
+/*
+ * clutter_scroll_actor_invalidate_tiles:
+ * @self: a #ClutterScrollActor
+ * @box: (allow-none): the damaged area, in the coordinates of the
+ *   contents, or %NULL for all of them
+ *
+ * Marks the tiles intersecting @box as needing to be rendered again.
+ */
+static void
+clutter_scroll_actor_invalidate_tiles (ClutterScrollActor    *self,
+                                       const ClutterActorBox *box)
+{
+  ClutterScrollActorPrivate *priv = self->priv;
+  gint first_column, last_column, first_row, last_row;
+  gint column, row;
+
+  if (priv->tiles == NULL)
+    return;
+
+  if (box == NULL)
+    {
+      GHashTableIter iter;
+      gpointer value;
 
-#include "clutter-scroll-actor.h"
+      g_hash_table_iter_init (&iter, priv->tiles);
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        ((ScrollTile *) value)->valid = FALSE;
 
-#include "clutter-actor-private.h"
-#include "clutter-animatable.h"
-#include "clutter-debug.h"
-#include "clutter-enum-types.h"
-#include "clutter-private.h"
-#include "clutter-property-transition.h"
-#include "clutter-transition.h"
+      priv->tile_generation += 1;
+      return;
+    }
 
-struct _ClutterScrollActorPrivate
+  first_column = floorf (box->x1 / TILE_SIZE);
+  last_column = ceilf (box->x2 / TILE_SIZE) - 1;
+  first_row = floorf (box->y1 / TILE_SIZE);
+  last_row = ceilf (box->y2 / TILE_SIZE) - 1;
+
+  for (row = first_row; row <= last_row; row++)
+    for (column = first_column; column <= last_column; column++)
+      {
+        gint64 key = tile_key (column, row);
+        ScrollTile *tile;
+
+        tile = g_hash_table_lookup (priv->tiles, &key);
+        if (tile != NULL)
+          tile->valid = FALSE;
+      }
+}
+
+/* maps the clip of a redraw queued by a descendant to the coordinates
+ * of the contents
+ */
+static gboolean
+clutter_scroll_actor_get_damage_box (ClutterScrollActor       *self,
+                                     const ClutterPaintVolume *clip,
+                                     ClutterActorBox          *box)
 {
-  ClutterPoint scroll_to;
+  ClutterActor *actor = CLUTTER_ACTOR (self);
+  ClutterPaintVolume pv;
+  gfloat x_offset, y_offset;
 
-  ClutterScrollMode scroll_mode;
+  /* the volumes in eye coordinates cannot be mapped back */
+  if (clip->actor == NULL || !clutter_actor_contains (actor, clip->actor))
+    return FALSE;
 
-  ClutterTransition *transition;
-};
+  _clutter_paint_volume_copy_static (clip, &pv);
+  _clutter_paint_volume_transform_relative (&pv, actor);
+  _clutter_paint_volume_get_bounding_box (&pv, box);
+  clutter_paint_volume_free (&pv);
 
-enum
+  clutter_scroll_actor_get_offset (self, &x_offset, &y_offset);
+
+  box->x1 += x_offset;
+  box->y1 += y_offset;
+  box->x2 += x_offset;
+  box->y2 += y_offset;
+
+  return TRUE;
+}
+
+static void
+clutter_scroll_actor_damage_tiles (ClutterScrollActor *self,
+                                   ClutterActor       *origin)
 {
-  PROP_0,
+  ClutterScrollActorPrivate *priv = self->priv;
+  ClutterPaintVolume *clip;
+  TileDamage *damage;
+  ClutterActorBox box;
 
-  PROP_SCROLL_MODE,
+  clip = _clutter_actor_get_queue_redraw_clip (origin);
+  if (clip == NULL || !clutter_scroll_actor_get_damage_box (self, clip, &box))
+    {
+      clutter_scroll_actor_invalidate_tiles (self, NULL);
+      return;
+    }
 
-  PROP_LAST
-};
+  clutter_scroll_actor_invalidate_tiles (self, &box);
 
-enum
+  /* without an explicit clip, the redraw is clipped to the current
+   * paint volume of the origin; the origin might have moved without
+   * a relayout, after a change in its transformation properties, so
+   * the area damaged by its previous redraw needs to be rendered
+   * again as well. if we do not know where the origin was, we have
+   * to render everything
+   */
+  if (clip != clutter_actor_get_paint_volume (origin))
+    return;
+
+  damage = g_object_get_qdata (G_OBJECT (origin), quark_tile_damage);
+  if (damage == NULL)
+    {
+      damage = g_slice_new0 (TileDamage);
+      g_object_set_qdata_full (G_OBJECT (origin), quark_tile_damage,
+                               damage,
+                               tile_damage_free);
+
+      clutter_scroll_actor_invalidate_tiles (self, NULL);
+    }
+  else if (damage->scroll != self ||
+           damage->generation != priv->tile_generation)
+    clutter_scroll_actor_invalidate_tiles (self, NULL);
+  else
+    clutter_scroll_actor_invalidate_tiles (self, &damage->box);
+
+  damage->scroll = self;
+  damage->generation = priv->tile_generation;
+  damage->box = box;
+}
+
+static gboolean
+clutter_scroll_actor_render_tile (ClutterScrollActor *self,
+                                  ScrollTile         *tile)
 {
-  ANIM_PROP_0,
+  ClutterActor *actor = CLUTTER_ACTOR (self);
+  CoglFramebuffer *fb;
+  CoglMatrix modelview;
+  ClutterActor *child;
+  gfloat x_offset, y_offset;
+  gint old_opacity_override;
 
-  ANIM_PROP_SCROLL_TO,
+  if (tile->texture == NULL)
+    {
+      CoglError *error = NULL;
 
-  ANIM_PROP_LAST
-};
+      tile->texture = cogl_texture_new_with_size (TILE_SIZE, TILE_SIZE,
+                                                  COGL_TEXTURE_NO_SLICING,
+                                                  COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+      if (!cogl_texture_allocate (tile->texture, &error))
+        {
+          CLUTTER_NOTE (PAINT, "Unable to allocate a tile of the scroll "
+                        "actor '%s': %s",
+                        _clutter_actor_get_debug_name (actor),
+                        error->message);
+          cogl_error_free (error);
+          cogl_handle_unref (tile->texture);
+          tile->texture = NULL;
+          return FALSE;
+        }
 
-static GParamSpec *obj_props[PROP_LAST] = { NULL, };
-static GParamSpec *animatable_props[ANIM_PROP_LAST] = { NULL, };
+      _clutter_memory_track_texture (CLUTTER_MEMORY_OFFSCREEN_TARGETS,
+                                     tile->texture);
 
-static ClutterAnimatableIface *parent_animatable_iface = NULL;
+      tile->offscreen = cogl_offscreen_new_to_texture (tile->texture);
+      if (tile->offscreen == NULL)
+        {
+          cogl_handle_unref (tile->texture);
+          tile->texture = NULL;
+          return FALSE;
+        }
+    }
 
-static void     clutter_animatable_iface_init   (ClutterAnimatableIface *iface);
+  fb = COGL_FRAMEBUFFER (tile->offscreen);
 
-G_DEFINE_TYPE_WITH_CODE (ClutterScrollActor, clutter_scroll_actor, CLUTTER_TYPE_ACTOR,
-                         G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_ANIMATABLE,
-                                                clutter_animatable_iface_init))
+  cogl_push_framebuffer (fb);
 
-static void
-clutter_scroll_actor_set_scroll_to_internal (ClutterScrollActor *self,
-                                             const ClutterPoint *point)
+  cogl_framebuffer_orthographic (fb, 0.f, 0.f, TILE_SIZE, TILE_SIZE,
+                                 -TILE_Z_RANGE, TILE_Z_RANGE);
+
+  /* the children are painted with the scrolling applied by the child
+   * transform; we undo it, and move the origin of the tile inside the
+   * contents to the origin of the texture
+   */
+  clutter_scroll_actor_get_offset (self, &x_offset, &y_offset);
+
+  cogl_matrix_init_identity (&modelview);
+  cogl_matrix_translate (&modelview,
+                         x_offset - tile->column * TILE_SIZE,
+                         y_offset - tile->row * TILE_SIZE,
+                         0.f);
+  cogl_framebuffer_set_modelview_matrix (fb, &modelview);
+
+  cogl_framebuffer_clear4f (fb,
+                            COGL_BUFFER_BIT_COLOR | COGL_BUFFER_BIT_DEPTH,
+                            0.f, 0.f, 0.f, 0.f);
+
+  /* the tiles are painted with the opacity of the scroll actor, so
+   * the children must be rendered fully opaque; we also paint them
+   * like the sources of a clone, so that they do not update their
+   * position on the stage, as they are not painted there
+   */
+  old_opacity_override = _clutter_actor_get_opacity_override (actor);
+  _clutter_actor_set_opacity_override (actor, 0xff);
+  _clutter_actor_push_clone_paint ();
+
+  for (child = clutter_actor_get_first_child (actor);
+       child != NULL;
+       child = clutter_actor_get_next_sibling (child))
+    clutter_actor_paint (child);
+
+  _clutter_actor_pop_clone_paint ();
+  _clutter_actor_set_opacity_override (actor, old_opacity_override);
+
+  cogl_pop_framebuffer ();
+
+  tile->valid = TRUE;
+
+  return TRUE;
+}
+
+/* paints the visible tiles, rendering the ones that are not valid;
+ * returns FALSE if the contents should be painted directly instead
+ */
+static gboolean
+clutter_scroll_actor_paint_tiles (ClutterScrollActor *self)
 {
   ClutterScrollActorPrivate *priv = self->priv;
   ClutterActor *actor = CLUTTER_ACTOR (self);
-  ClutterMatrix m = CLUTTER_MATRIX_INIT_IDENTITY;
-  float dx, dy;
+  gint first_column, last_column, first_row, last_row;
+  gint column, row, n_prefetched;
+  gfloat x_offset, y_offset, width, height;
+  GHashTableIter iter;
+  CoglFramebuffer *fb;
+  ClutterActor *stage;
+  gpointer value;
+  guint8 opacity;
+
+  stage = _clutter_actor_get_stage_internal (actor);
+  if (stage == NULL || clutter_actor_get_n_children (actor) == 0)
+    return FALSE;
+
+  clutter_actor_get_size (actor, &width, &height);
+  if (width < 1.f || height < 1.f)
+    return FALSE;
+
+  clutter_scroll_actor_get_offset (self, &x_offset, &y_offset);
+
+  first_column = floorf (x_offset / TILE_SIZE);
+  last_column = ceilf ((x_offset + width) / TILE_SIZE) - 1;
+  first_row = floorf (y_offset / TILE_SIZE);
+  last_row = ceilf ((y_offset + height) / TILE_SIZE) - 1;
+
+  if (priv->tiles == NULL)
+    priv->tiles = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                         NULL,
+                                         scroll_tile_free);
+
+  if (priv->tile_pipeline == NULL)
+    {
+      CoglContext *ctx =
+        clutter_backend_get_cogl_context (clutter_get_default_backend ());
 
-  if (clutter_point_equals (&priv->scroll_to, point))
+      priv->tile_pipeline = cogl_pipeline_new (ctx);
+    }
+
+  /* render the missing tiles: the visible ones first, and then a few
+   * of the ones around them
+   */
+  n_prefetched = 0;
+  for (row = first_row - TILE_PREFETCH; row <= last_row + TILE_PREFETCH; row++)
+    for (column = first_column - TILE_PREFETCH; column <= last_column + TILE_PREFETCH; column++)
+      {
+        gboolean is_visible = row >= first_row && row <= last_row &&
+                              column >= first_column && column <= last_column;
+        gint64 key = tile_key (column, row);
+        ScrollTile *tile;
+
+        tile = g_hash_table_lookup (priv->tiles, &key);
+        if (tile != NULL && tile->valid)
+          continue;
+
+        if (!is_visible)
+          {
+            if (n_prefetched == MAX_PREFETCH_TILES)
+              continue;
+
+            n_prefetched += 1;
+          }
+
+        if (tile == NULL)
+          {
+            tile = g_slice_new0 (ScrollTile);
+            tile->key = key;
+            tile->column = column;
+            tile->row = row;
+            g_hash_table_insert (priv->tiles, &tile->key, tile);
+          }
+
+        if (!clutter_scroll_actor_render_tile (self, tile) && is_visible)
+          return FALSE;
+      }
+
+  fb = cogl_get_draw_framebuffer ();
+  opacity = clutter_actor_get_paint_opacity (actor);
+
+  cogl_pipeline_set_color4ub (priv->tile_pipeline,
+                              opacity,
+                              opacity,
+                              opacity,
+                              opacity);
+
+  for (row = first_row; row <= last_row; row++)
+    for (column = first_column; column <= last_column; column++)
+      {
+        gint64 key = tile_key (column, row);
+        ScrollTile *tile;
+        gfloat x, y;
+
+        tile = g_hash_table_lookup (priv->tiles, &key);
+
+        x = column * TILE_SIZE - x_offset;
+        y = row * TILE_SIZE - y_offset;
+
+        cogl_pipeline_set_layer_texture (priv->tile_pipeline, 0, tile->texture);
+        cogl_framebuffer_draw_textured_rectangle (fb, priv->tile_pipeline,
+                                                  x, y,
+                                                  x + TILE_SIZE,
+                                                  y + TILE_SIZE,
+                                                  0.f, 0.f,
+                                                  1.f, 1.f);
+      }
+
+  /* drop the tiles that scrolled away */
+  g_hash_table_iter_init (&iter, priv->tiles);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      ScrollTile *tile = value;
+
+      if (tile->row < first_row - TILE_PREFETCH ||
+          tile->row > last_row + TILE_PREFETCH ||
+          tile->column < first_column - TILE_PREFETCH ||
+          tile->column > last_column + TILE_PREFETCH)
+        g_hash_table_iter_remove (&iter);
+    }
+
+  /* the children have not updated their position in the pick index,
+   * since they were not painted on the stage
+   */
+  _clutter_stage_invalidate_pick_index (CLUTTER_STAGE (stage));
+
+  return TRUE;
+}
+
+static void
+clutter_scroll_actor_purge_tiles (gpointer          instance,
+                                  ClutterPurgeLevel level)
+{
+  ClutterScrollActor *self = instance;
+
+  if (self->priv->tiles == NULL)
     return;
 
-  if (point == NULL)
-    clutter_point_init (&priv->scroll_to, 0.f, 0.f);
-  else
-    priv->scroll_to = *point;
+  /* the tiles around the visible area are released by the next
+   * paint, and the visible ones are rendered again by it
+   */
+  if (level == CLUTTER_PURGE_LEVEL_CRITICAL ||
+      (level == CLUTTER_PURGE_LEVEL_MODERATE &&
+       !CLUTTER_ACTOR_IS_MAPPED (self)))
+    clutter_scroll_actor_release_tiles (self);
+}
 
-  if (priv->scroll_mode & CLUTTER_SCROLL_HORIZONTALLY)
-    dx = -priv->scroll_to.x;
-  else
-    dx = 0.f;
+static void
+clutter_scroll_actor_paint (ClutterActor *actor)
+{
+  ClutterScrollActor *self = CLUTTER_SCROLL_ACTOR (actor);
 
-  if (priv->scroll_mode & CLUTTER_SCROLL_VERTICALLY)
-    dy = -priv->scroll_to.y;
-  else
-    dy = 0.f;
+  if (self->priv->use_tile_cache && clutter_scroll_actor_paint_tiles (self))
+    return;
 
-  cogl_matrix_translate (&m, dx, dy, 0.f);
-  clutter_actor_set_child_transform (actor, &m);
+  CLUTTER_ACTOR_CLASS (clutter_scroll_actor_parent_class)->paint (actor);
+}
+
+static void
+clutter_scroll_actor_queue_redraw (ClutterActor *actor,
+                                   ClutterActor *origin)
+{
+  ClutterScrollActor *self = CLUTTER_SCROLL_ACTOR (actor);
+
+  /* the redraws queued by the scroll actor itself, like the ones
+   * caused by scrolling, do not change the contents
+   */
+  if (self->priv->tiles != NULL && origin != actor)
+    clutter_scroll_actor_damage_tiles (self, origin);
+
+  CLUTTER_ACTOR_CLASS (clutter_scroll_actor_parent_class)->queue_redraw (actor,
+                                                                         origin);
+}
+
+static void
+clutter_scroll_actor_queue_relayout (ClutterActor *actor)
+{
+  /* the children could be moving anywhere */
+  clutter_scroll_actor_invalidate_tiles (CLUTTER_SCROLL_ACTOR (actor), NULL);
+
+  CLUTTER_ACTOR_CLASS (clutter_scroll_actor_parent_class)->queue_relayout (actor);
+}
+
+static void
+clutter_scroll_actor_allocate (ClutterActor           *actor,
+                               const ClutterActorBox  *box,
+                               ClutterAllocationFlags  flags)
+{
+  ClutterScrollActorPrivate *priv = CLUTTER_SCROLL_ACTOR (actor)->priv;
+  gfloat width, height;
+
+  CLUTTER_ACTOR_CLASS (clutter_scroll_actor_parent_class)->allocate (actor,
+                                                                     box,
+                                                                     flags);
+
+  clutter_actor_box_get_size (box, &width, &height);
+
+  if (width == priv->viewport_width && height == priv->viewport_height)
+    return;
+
+  priv->viewport_width = width;
+  priv->viewport_height = height;
+
+  /* we cannot add or resize children while allocating */
+  if (priv->model != NULL)
+    clutter_scroll_actor_queue_update (CLUTTER_SCROLL_ACTOR (actor));
+}
+
+static void
+clutter_scroll_actor_dispose (GObject *gobject)
+{
+  ClutterScrollActorPrivate *priv = CLUTTER_SCROLL_ACTOR (gobject)->priv;
+
+  if (priv->update_id != 0)
+    {
+      g_source_remove (priv->update_id);
+      priv->update_id = 0;
+    }
+
+  clutter_scroll_actor_disconnect_model (CLUTTER_SCROLL_ACTOR (gobject));
+
+  _clutter_memory_remove_purge_func (gobject);
+
+  clutter_scroll_actor_release_tiles (CLUTTER_SCROLL_ACTOR (gobject));
+
+  if (priv->tile_pipeline != NULL)
+    {
+      cogl_object_unref (priv->tile_pipeline);
+      priv->tile_pipeline = NULL;
+    }
+
+  /* the items are children, and will be destroyed with us */
+  if (priv->items != NULL)
+    {
+      g_ptr_array_unref (priv->items);
+      priv->items = NULL;
+    }
+
+  if (priv->recycled != NULL)
+    {
+      g_ptr_array_unref (priv->recycled);
+      priv->recycled = NULL;
+    }
+
+  G_OBJECT_CLASS (clutter_scroll_actor_parent_class)->dispose (gobject);
+}
+
+static void
+clutter_scroll_actor_finalize (GObject *gobject)
+{
+  ClutterScrollActorPrivate *priv = CLUTTER_SCROLL_ACTOR (gobject)->priv;
+
+  g_array_unref (priv->row_heights);
+  g_free (priv->row_tree);
+
+  G_OBJECT_CLASS (clutter_scroll_actor_parent_class)->finalize (gobject);
 }
 
 static void
@@ -144,6 +1318,10 @@ clutter_scroll_actor_set_property (GObject      *gobject,
       clutter_scroll_actor_set_scroll_mode (actor, g_value_get_flags (value));
       break;
 
+    case PROP_USE_TILE_CACHE:
+      clutter_scroll_actor_set_use_tile_cache (actor, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -163,6 +1341,10 @@ clutter_scroll_actor_get_property (GObject    *gobject,
       g_value_set_flags (value, actor->priv->scroll_mode);
       break;
 
+    case PROP_USE_TILE_CACHE:
+      g_value_set_boolean (value, actor->priv->use_tile_cache);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -172,11 +1354,22 @@ static void
 clutter_scroll_actor_class_init (ClutterScrollActorClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
 
   g_type_class_add_private (klass, sizeof (ClutterScrollActorPrivate));
 
   gobject_class->set_property = clutter_scroll_actor_set_property;
   gobject_class->get_property = clutter_scroll_actor_get_property;
+  gobject_class->dispose = clutter_scroll_actor_dispose;
+  gobject_class->finalize = clutter_scroll_actor_finalize;
+
+  actor_class->allocate = clutter_scroll_actor_allocate;
+  actor_class->paint = clutter_scroll_actor_paint;
+  actor_class->queue_redraw = clutter_scroll_actor_queue_redraw;
+  actor_class->queue_relayout = clutter_scroll_actor_queue_relayout;
+
+  quark_tile_damage =
+    g_quark_from_static_string ("-clutter-scroll-actor-tile-damage");
 
   /**
    * ClutterScrollActor:scroll-mode:
@@ -194,6 +1387,21 @@ clutter_scroll_actor_class_init (ClutterScrollActorClass *klass)
                         G_PARAM_READWRITE |
                         G_PARAM_STATIC_STRINGS);
 
+  /**
+   * ClutterScrollActor:use-tile-cache:
+   *
+   * Whether the contents of the scroll actor are cached into tiles.
+   *
+   * See clutter_scroll_actor_set_use_tile_cache().
+   */
+  obj_props[PROP_USE_TILE_CACHE] =
+    g_param_spec_boolean ("use-tile-cache",
+                          P_("Use Tile Cache"),
+                          P_("Whether the contents are cached into tiles"),
+                          FALSE,
+                          G_PARAM_READWRITE |
+                          G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
 }
 
@@ -205,7 +1413,17 @@ clutter_scroll_actor_init (ClutterScrollActor *self)
 
   self->priv->scroll_mode = CLUTTER_SCROLL_BOTH;
 
+  self->priv->row_heights = g_array_new (FALSE, FALSE, sizeof (gfloat));
+  self->priv->items = g_ptr_array_new ();
+  self->priv->recycled = g_ptr_array_new ();
+
   clutter_actor_set_clip_to_allocation (CLUTTER_ACTOR (self), TRUE);
+
+  _clutter_memory_add_purge_func (CLUTTER_MEMORY_OFFSCREEN_TARGETS,
+                                  self,
+                                  clutter_scroll_actor_purge_tiles);
+
+  g_signal_connect (self, "actor-removed", G_CALLBACK (on_actor_removed), NULL);
 }
 
 static GParamSpec *
@@ -311,6 +1529,62 @@ clutter_scroll_actor_set_scroll_mode (ClutterScrollActor *actor,
   g_object_notify_by_pspec (G_OBJECT (actor), obj_props[PROP_SCROLL_MODE]);
 }
 
+/**
+ * clutter_scroll_actor_set_use_tile_cache:
+ * @actor: a #ClutterScrollActor
+ * @use_tile_cache: whether to cache the contents into tiles
+ *
+ * Sets whether @actor should render its children into a grid of
+ * cached textures, and paint the textures instead of the children.
+ *
+ * Scrolling static contents through the tile cache only costs the
+ * painting of a few textures; the tiles are rendered again when a
+ * descendant of @actor queues a redraw intersecting them, and all of
+ * them are rendered again after a relayout. The contents are always
+ * rendered in two dimensions, so the tile cache should not be used
+ * if the children are transformed in three dimensions.
+ */
+void
+clutter_scroll_actor_set_use_tile_cache (ClutterScrollActor *actor,
+                                         gboolean            use_tile_cache)
+{
+  ClutterScrollActorPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_SCROLL_ACTOR (actor));
+
+  priv = actor->priv;
+
+  use_tile_cache = !!use_tile_cache;
+
+  if (priv->use_tile_cache == use_tile_cache)
+    return;
+
+  priv->use_tile_cache = use_tile_cache;
+
+  if (!use_tile_cache)
+    clutter_scroll_actor_release_tiles (actor);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (actor));
+
+  g_object_notify_by_pspec (G_OBJECT (actor), obj_props[PROP_USE_TILE_CACHE]);
+}
+
+/**
+ * clutter_scroll_actor_get_use_tile_cache:
+ * @actor: a #ClutterScrollActor
+ *
+ * Retrieves the value set by clutter_scroll_actor_set_use_tile_cache().
+ *
+ * Return value: %TRUE if the contents of @actor are cached into tiles
+ */
+gboolean
+clutter_scroll_actor_get_use_tile_cache (ClutterScrollActor *actor)
+{
+  g_return_val_if_fail (CLUTTER_IS_SCROLL_ACTOR (actor), FALSE);
+
+  return actor->priv->use_tile_cache;
+}
+
 /**
  * clutter_scroll_actor_get_scroll_mode:
  * @actor: a #ClutterScrollActor
@@ -417,6 +1691,40 @@ clutter_scroll_actor_scroll_to_point (ClutterScrollActor *actor,
   clutter_timeline_start (CLUTTER_TIMELINE (priv->transition));
 }
 
+/*< private >
+ * _clutter_scroll_actor_scroll_by:
+ * @actor: a #ClutterScrollActor
+ * @dx: the horizontal offset, in pixels
+ * @dy: the vertical offset, in pixels
+ *
+ * Moves the scrolling origin of @actor by the given offsets, ignoring
+ * the easing state; this is used by #ClutterPanAction, which drives
+ * its own kinetic motion and calls this function once per frame.
+ *
+ * Only the child transform of @actor changes, so scrolling does not
+ * queue a relayout.
+ */
+void
+_clutter_scroll_actor_scroll_by (ClutterScrollActor *actor,
+                                 gfloat              dx,
+                                 gfloat              dy)
+{
+  ClutterScrollActorPrivate *priv = actor->priv;
+  ClutterPoint point;
+
+  if (priv->transition != NULL)
+    {
+      clutter_actor_remove_transition (CLUTTER_ACTOR (actor), "scroll-to");
+      priv->transition = NULL;
+    }
+
+  clutter_point_init (&point,
+                      priv->scroll_to.x + dx,
+                      priv->scroll_to.y + dy);
+
+  clutter_scroll_actor_set_scroll_to_internal (actor, &point);
+}
+
 /**
  * clutter_scroll_actor_scroll_to_rect:
  * @actor: a #ClutterScrollActor
@@ -442,3 +1750,101 @@ clutter_scroll_actor_scroll_to_rect (ClutterScrollActor *actor,
 
   clutter_scroll_actor_scroll_to_point (actor, &n_rect.origin);
 }
+
+/**
+ * clutter_scroll_actor_set_model:
+ * @actor: a #ClutterScrollActor
+ * @model: (allow-none): a #ClutterModel, or %NULL
+ * @create_item: (allow-none): a function that creates the actor for a row
+ *   of @model
+ * @user_data: data passed to @create_item
+ * @notify: (allow-none): function called when @user_data is not needed
+ *   any more
+ *
+ * Makes @actor display the rows of @model as a vertical list of items.
+ *
+ * Only the items intersecting the visible area of @actor, plus a
+ * prefetch margin above and below it, are created using @create_item;
+ * the items scrolled out of view are hidden and passed back to
+ * @create_item to be reused for other rows.
+ *
+ * The position of the rows that have not been created yet is based on
+ * the average height of the created ones, so scrolling to any point is
+ * cheap regardless of the number of rows in @model.
+ *
+ * The items are children of @actor, and should not be added or removed
+ * by the application. Passing a %NULL @model destroys all the items.
+ */
+void
+clutter_scroll_actor_set_model (ClutterScrollActor               *actor,
+                                ClutterModel                     *model,
+                                ClutterScrollActorCreateItemFunc  create_item,
+                                gpointer                          user_data,
+                                GDestroyNotify                    notify)
+{
+  ClutterScrollActorPrivate *priv;
+  guint i;
+
+  g_return_if_fail (CLUTTER_IS_SCROLL_ACTOR (actor));
+  g_return_if_fail (model == NULL || CLUTTER_IS_MODEL (model));
+  g_return_if_fail (model == NULL || create_item != NULL);
+
+  priv = actor->priv;
+
+  clutter_scroll_actor_disconnect_model (actor);
+
+  clutter_scroll_actor_clear_items (actor);
+
+  /* the recycled items belong to the old factory */
+  for (i = priv->recycled->len; i > 0; i--)
+    clutter_actor_destroy (g_ptr_array_index (priv->recycled, i - 1));
+
+  g_ptr_array_set_size (priv->recycled, 0);
+
+  priv->measured_height = 0.0;
+  priv->n_measured = 0;
+
+  if (model != NULL)
+    {
+      priv->model = g_object_ref (model);
+      priv->create_item = create_item;
+      priv->create_item_data = user_data;
+      priv->create_item_notify = notify;
+
+      g_signal_connect (model, "row-added",
+                        G_CALLBACK (on_model_row_added),
+                        actor);
+      g_signal_connect (model, "row-removed",
+                        G_CALLBACK (on_model_row_removed),
+                        actor);
+      g_signal_connect (model, "row-changed",
+                        G_CALLBACK (on_model_row_changed),
+                        actor);
+      g_signal_connect (model, "sort-changed",
+                        G_CALLBACK (on_model_reset),
+                        actor);
+      g_signal_connect (model, "filter-changed",
+                        G_CALLBACK (on_model_reset),
+                        actor);
+    }
+  else if (notify != NULL)
+    notify (user_data);
+
+  clutter_scroll_actor_reset_rows (actor);
+}
+
+/**
+ * clutter_scroll_actor_get_model:
+ * @actor: a #ClutterScrollActor
+ *
+ * Retrieves the #ClutterModel set using clutter_scroll_actor_set_model().
+ *
+ * Return value: (transfer none): a #ClutterModel, or %NULL
+ */
+ClutterModel *
+clutter_scroll_actor_get_model (ClutterScrollActor *actor)
+{
+  g_return_val_if_fail (CLUTTER_IS_SCROLL_ACTOR (actor), NULL);
+
+  return actor->priv->model;
+}
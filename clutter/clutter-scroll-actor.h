@@ -28,6 +28,7 @@
 
 #include <clutter/clutter-types.h>
 #include <clutter/clutter-actor.h>
+#include <clutter/clutter-model.h>
 
 G_BEGIN_DECLS
 
@@ -57,6 +58,26 @@ struct _ClutterScrollActor
   ClutterScrollActorPrivate *priv;
 };
 
+/**
+ * ClutterScrollActorCreateItemFunc:
+ * @actor: the #ClutterScrollActor
+ * @iter: a #ClutterModelIter pointing to the row
+ * @recycled: (allow-none): an item that is not used any more, or %NULL
+ * @user_data: data passed to clutter_scroll_actor_set_model()
+ *
+ * Creates the item displaying the row of the model pointed by @iter.
+ *
+ * If @recycled is not %NULL, the function can update it to display the
+ * row and return it, instead of creating a new actor; if a different
+ * actor is returned, @recycled will be destroyed.
+ *
+ * Return value: (transfer full): the item for the row
+ */
+typedef ClutterActor * (* ClutterScrollActorCreateItemFunc) (ClutterScrollActor *actor,
+                                                             ClutterModelIter   *iter,
+                                                             ClutterActor       *recycled,
+                                                             gpointer            user_data);
+
 /**
  * ClutterScrollActorClass:
  *
@@ -85,6 +106,11 @@ void                    clutter_scroll_actor_set_scroll_mode    (ClutterScrollAc
 
 ClutterScrollMode       clutter_scroll_actor_get_scroll_mode    (ClutterScrollActor *actor);
 
+void                    clutter_scroll_actor_set_use_tile_cache (ClutterScrollActor *actor,
+                                                                 gboolean            use_tile_cache);
+
+gboolean                clutter_scroll_actor_get_use_tile_cache (ClutterScrollActor *actor);
+
 
 void                    clutter_scroll_actor_scroll_to_point    (ClutterScrollActor *actor,
                                                                  const ClutterPoint *point);
@@ -92,6 +118,15 @@ void                    clutter_scroll_actor_scroll_to_point    (ClutterScrollAc
 void                    clutter_scroll_actor_scroll_to_rect     (ClutterScrollActor *actor,
                                                                  const ClutterRect  *rect);
 
+
+void                    clutter_scroll_actor_set_model          (ClutterScrollActor               *actor,
+                                                                 ClutterModel                     *model,
+                                                                 ClutterScrollActorCreateItemFunc  create_item,
+                                                                 gpointer                          user_data,
+                                                                 GDestroyNotify                    notify);
+
+ClutterModel *          clutter_scroll_actor_get_model          (ClutterScrollActor *actor);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_SCROLL_ACTOR_H__ */
@@ -113,6 +113,8 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 /* XXX: This file depends on the cogl_program_ api with has been
  * removed for Cogl 2.0 so we undef COGL_ENABLE_EXPERIMENTAL_2_0_API
  * for this file for now */
@@ -133,8 +135,29 @@ typedef struct _ShaderUniform
   GType type;
   GValue value;
   int location;
+
+  /* whether the value changed since it was last set on the program */
+  guint is_dirty : 1;
 } ShaderUniform;
 
+/* A program compiled from the source passed to set_shader_source();
+ * the programs are shared between all the instances using the same
+ * source, to avoid compiling and linking the same program multiple
+ * times
+ */
+typedef struct _ShaderProgram
+{
+  ClutterShaderType shader_type;
+  gchar *source;
+
+  CoglHandle shader;
+  CoglHandle program;
+
+  gpointer uniforms_owner;
+
+  int ref_count;
+} ShaderProgram;
+
 struct _ClutterShaderEffectPrivate
 {
   ClutterActor *actor;
@@ -144,7 +167,24 @@ struct _ClutterShaderEffectPrivate
   CoglHandle program;
   CoglHandle shader;
 
-  GHashTable *uniforms;
+  /* the uniforms, in the order they were added, and an index to
+   * find them by name
+   */
+  GPtrArray *uniforms;
+  GHashTable *uniforms_index;
+
+  /* whether at least one uniform is dirty */
+  guint uniforms_dirty : 1;
+
+  /* the instance whose uniforms were last set on the program, if
+   * the program is shared with other instances
+   */
+  gpointer *uniforms_owner;
+
+  /* the program compiled from the source passed to
+   * clutter_shader_effect_set_shader_source()
+   */
+  ShaderProgram *cached_program;
 };
 
 typedef struct _ClutterShaderEffectClassPrivate
@@ -155,6 +195,11 @@ typedef struct _ClutterShaderEffectClassPrivate
      of this class */
   CoglHandle program;
   CoglHandle shader;
+
+  /* The instance whose uniforms were last set on the shared program;
+     uniform values are stored inside the program, so another instance
+     needs to set all its uniforms again */
+  gpointer uniforms_owner;
 } ClutterShaderEffectClassPrivate;
 
 enum
@@ -168,18 +213,81 @@ enum
 
 static GParamSpec *obj_props[PROP_LAST];
 
+/* the programs compiled with set_shader_source() */
+static GHashTable *shader_programs = NULL;
+
 G_DEFINE_TYPE_WITH_CODE (ClutterShaderEffect,
                          clutter_shader_effect,
                          CLUTTER_TYPE_OFFSCREEN_EFFECT,
                          g_type_add_class_private (g_define_type_id,
                                                    sizeof (ClutterShaderEffectClassPrivate)))
 
+static guint
+shader_program_hash (gconstpointer key)
+{
+  const ShaderProgram *program = key;
+
+  return g_str_hash (program->source) ^ program->shader_type;
+}
+
+static gboolean
+shader_program_equal (gconstpointer a,
+                      gconstpointer b)
+{
+  const ShaderProgram *program_a = a;
+  const ShaderProgram *program_b = b;
+
+  return program_a->shader_type == program_b->shader_type &&
+         strcmp (program_a->source, program_b->source) == 0;
+}
+
+static ShaderProgram *
+shader_program_ref (ShaderProgram *program)
+{
+  program->ref_count += 1;
+
+  return program;
+}
+
+static void
+shader_program_unref (ShaderProgram *program)
+{
+  program->ref_count -= 1;
+
+  if (program->ref_count == 0)
+    {
+      g_hash_table_remove (shader_programs, program);
+
+      if (program->program != COGL_INVALID_HANDLE)
+        cogl_handle_unref (program->program);
+
+      cogl_handle_unref (program->shader);
+
+      g_free (program->source);
+      g_slice_free (ShaderProgram, program);
+    }
+}
+
 static inline void
 clutter_shader_effect_clear (ClutterShaderEffect *self,
                              gboolean             reset_uniforms)
 {
   ClutterShaderEffectPrivate *priv = self->priv;
 
+  if (priv->uniforms_owner != NULL)
+    {
+      if (*priv->uniforms_owner == self)
+        *priv->uniforms_owner = NULL;
+
+      priv->uniforms_owner = NULL;
+    }
+
+  if (priv->cached_program != NULL)
+    {
+      shader_program_unref (priv->cached_program);
+      priv->cached_program = NULL;
+    }
+
   if (priv->shader != COGL_INVALID_HANDLE)
     {
       cogl_handle_unref (priv->shader);
@@ -196,9 +304,27 @@ clutter_shader_effect_clear (ClutterShaderEffect *self,
 
   if (reset_uniforms && priv->uniforms != NULL)
     {
-      g_hash_table_destroy (priv->uniforms);
+      g_hash_table_destroy (priv->uniforms_index);
+      priv->uniforms_index = NULL;
+
+      g_ptr_array_unref (priv->uniforms);
       priv->uniforms = NULL;
     }
+  else if (priv->uniforms != NULL)
+    {
+      guint i;
+
+      /* the locations and values belonged to the old program */
+      for (i = 0; i < priv->uniforms->len; i++)
+        {
+          ShaderUniform *uniform = g_ptr_array_index (priv->uniforms, i);
+
+          uniform->location = -1;
+          uniform->is_dirty = TRUE;
+        }
+
+      priv->uniforms_dirty = TRUE;
+    }
 
   priv->actor = NULL;
 }
@@ -207,9 +333,9 @@ static void
 clutter_shader_effect_update_uniforms (ClutterShaderEffect *effect)
 {
   ClutterShaderEffectPrivate *priv = effect->priv;
-  GHashTableIter iter;
-  gpointer key, value;
+  gboolean upload_all = FALSE;
   gsize size;
+  guint i;
 
   if (priv->program == COGL_INVALID_HANDLE)
     return;
@@ -217,11 +343,26 @@ clutter_shader_effect_update_uniforms (ClutterShaderEffect *effect)
   if (priv->uniforms == NULL)
     return;
 
-  key = value = NULL;
-  g_hash_table_iter_init (&iter, priv->uniforms);
-  while (g_hash_table_iter_next (&iter, &key, &value))
+  /* a shared program holds the values set by the last instance
+   * painted with it
+   */
+  if (priv->uniforms_owner != NULL && *priv->uniforms_owner != effect)
     {
-      ShaderUniform *uniform = value;
+      *priv->uniforms_owner = effect;
+      upload_all = TRUE;
+    }
+
+  if (!upload_all && !priv->uniforms_dirty)
+    return;
+
+  for (i = 0; i < priv->uniforms->len; i++)
+    {
+      ShaderUniform *uniform = g_ptr_array_index (priv->uniforms, i);
+
+      if (!upload_all && !uniform->is_dirty)
+        continue;
+
+      uniform->is_dirty = FALSE;
 
       if (uniform->location == -1)
         uniform->location = cogl_program_get_uniform_location (priv->program,
@@ -285,6 +426,8 @@ clutter_shader_effect_update_uniforms (ClutterShaderEffect *effect)
                    g_type_name (G_VALUE_TYPE (&uniform->value)),
                    uniform->name);
     }
+
+  priv->uniforms_dirty = FALSE;
 }
 
 static void
@@ -392,7 +535,10 @@ clutter_shader_effect_try_static_source (ClutterShaderEffect *self)
       priv->shader = cogl_handle_ref (class_priv->shader);
 
       if (class_priv->program != COGL_INVALID_HANDLE)
-        priv->program = cogl_handle_ref (class_priv->program);
+        {
+          priv->program = cogl_handle_ref (class_priv->program);
+          priv->uniforms_owner = &class_priv->uniforms_owner;
+        }
     }
 }
 
@@ -596,6 +742,7 @@ shader_uniform_new (const gchar  *name,
   retval->name = g_strdup (name);
   retval->type = G_VALUE_TYPE (value);
   retval->location = -1;
+  retval->is_dirty = TRUE;
 
   g_value_init (&retval->value, retval->type);
   g_value_copy (value, &retval->value);
@@ -611,6 +758,8 @@ shader_uniform_update (ShaderUniform *uniform,
 
   g_value_init (&uniform->value, G_VALUE_TYPE (value));
   g_value_copy (value, &uniform->value);
+
+  uniform->is_dirty = TRUE;
 }
 
 static inline void
@@ -623,20 +772,22 @@ clutter_shader_effect_add_uniform (ClutterShaderEffect *effect,
 
   if (priv->uniforms == NULL)
     {
-      priv->uniforms = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                              NULL,
-                                              shader_uniform_free);
+      priv->uniforms = g_ptr_array_new_with_free_func (shader_uniform_free);
+      priv->uniforms_index = g_hash_table_new (g_str_hash, g_str_equal);
     }
 
-  uniform = g_hash_table_lookup (priv->uniforms, name);
+  uniform = g_hash_table_lookup (priv->uniforms_index, name);
   if (uniform == NULL)
     {
       uniform = shader_uniform_new (name, value);
-      g_hash_table_insert (priv->uniforms, uniform->name, uniform);
+      g_ptr_array_add (priv->uniforms, uniform);
+      g_hash_table_insert (priv->uniforms_index, uniform->name, uniform);
     }
   else
     shader_uniform_update (uniform, value);
 
+  priv->uniforms_dirty = TRUE;
+
   if (priv->actor != NULL && !CLUTTER_ACTOR_IN_PAINT (priv->actor))
     clutter_effect_queue_repaint (CLUTTER_EFFECT (effect));
 }
@@ -882,6 +1033,9 @@ clutter_shader_effect_set_uniform (ClutterShaderEffect *effect,
  * This function can only be called once; subsequent calls will
  * yield no result.
  *
+ * The shader is compiled only once for all the #ClutterShaderEffect
+ * instances using the same @source and #ClutterShaderType.
+ *
  * Return value: %TRUE if the source was set
  *
  *
@@ -891,6 +1045,7 @@ clutter_shader_effect_set_shader_source (ClutterShaderEffect *effect,
                                          const gchar         *source)
 {
   ClutterShaderEffectPrivate *priv;
+  ShaderProgram key, *program;
 
   g_return_val_if_fail (CLUTTER_IS_SHADER_EFFECT (effect), FALSE);
   g_return_val_if_fail (source != NULL && *source != '\0', FALSE);
@@ -900,29 +1055,64 @@ clutter_shader_effect_set_shader_source (ClutterShaderEffect *effect,
   if (priv->shader != COGL_INVALID_HANDLE)
     return TRUE;
 
-  priv->shader = clutter_shader_effect_create_shader (effect);
-
-  cogl_shader_source (priv->shader, source);
+  if (G_UNLIKELY (shader_programs == NULL))
+    shader_programs = g_hash_table_new (shader_program_hash,
+                                        shader_program_equal);
 
-  CLUTTER_NOTE (SHADER, "Compiling shader effect");
+  key.shader_type = priv->shader_type;
+  key.source = (gchar *) source;
 
-  cogl_shader_compile (priv->shader);
-
-  if (cogl_shader_is_compiled (priv->shader))
+  program = g_hash_table_lookup (shader_programs, &key);
+  if (program != NULL)
     {
-      priv->program = cogl_create_program ();
-
-      cogl_program_attach_shader (priv->program, priv->shader);
+      CLUTTER_NOTE (SHADER, "Re-using the compiled shader effect");
 
-      cogl_program_link (priv->program);
+      shader_program_ref (program);
     }
   else
     {
-      gchar *log_buf = cogl_shader_get_info_log (priv->shader);
+      /* failed compilations are stored as well, so that we don't
+       * try again for every instance
+       */
+      program = g_slice_new0 (ShaderProgram);
+      program->shader_type = priv->shader_type;
+      program->source = g_strdup (source);
+      program->ref_count = 1;
+
+      program->shader = clutter_shader_effect_create_shader (effect);
+
+      cogl_shader_source (program->shader, source);
+
+      CLUTTER_NOTE (SHADER, "Compiling shader effect");
+
+      cogl_shader_compile (program->shader);
+
+      if (cogl_shader_is_compiled (program->shader))
+        {
+          program->program = cogl_create_program ();
+
+          cogl_program_attach_shader (program->program, program->shader);
+
+          cogl_program_link (program->program);
+        }
+      else
+        {
+          gchar *log_buf = cogl_shader_get_info_log (program->shader);
 
-      g_warning (G_STRLOC ": Unable to compile the GLSL shader: %s", log_buf);
-      g_free (log_buf);
+          g_warning (G_STRLOC ": Unable to compile the GLSL shader: %s", log_buf);
+          g_free (log_buf);
+        }
+
+      g_hash_table_insert (shader_programs, program, program);
     }
 
+  priv->cached_program = program;
+  priv->uniforms_owner = &program->uniforms_owner;
+
+  priv->shader = cogl_handle_ref (program->shader);
+
+  if (program->program != COGL_INVALID_HANDLE)
+    priv->program = cogl_handle_ref (program->program);
+
   return TRUE;
 }
@@ -0,0 +1,366 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+
+/*
+ * Performance HUD.
+ *
+ * The HUD is painted on top of a stage, after the actors, and shows
+ * a graph of the CPU time of the last frames together with the frame
+ * rate, the GPU time, the picks, the share of the stage redrawn, the
+ * number of actors, the texture memory and the dropped frames.
+ *
+ * It is meant to be left on while testing, so it has to be cheap: the
+ * graph and its background are a single primitive, and the text is
+ * only laid out again twice a second.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "clutter-stage-hud.h"
+
+#include "clutter-actor-private.h"
+#include "clutter-main.h"
+#include "clutter-private.h"
+
+/* the number of frames in the graph */
+#define HUD_N_FRAMES            120
+
+/* the geometry of the HUD, in stage coordinates */
+#define HUD_X                   8
+#define HUD_Y                   8
+#define HUD_BAR_WIDTH           2
+#define HUD_GRAPH_HEIGHT        60
+#define HUD_PADDING             4
+
+/* the interval between the updates of the text, in microseconds */
+#define HUD_TEXT_INTERVAL       500000
+
+/* background, budget line, and one bar per frame; six vertices each */
+#define HUD_N_VERTICES          ((HUD_N_FRAMES + 2) * 6)
+
+struct _ClutterStageHud
+{
+  /* CPU time of the last frames, oldest first from the head */
+  gint64 frame_times[HUD_N_FRAMES];
+  guint head;
+
+  /* accumulated since the last update of the text */
+  gint64 last_update;
+  guint n_frames;
+  gint64 total_time;
+  gint64 gpu_time;
+  guint n_picks;
+  guint n_dropped;
+  gdouble redraw_area;
+
+  /* the stage area painted in the current frame */
+  gdouble frame_area;
+
+  PangoLayout *layout;
+  gint text_height;
+
+  CoglVertexP2C4 vertices[HUD_N_VERTICES];
+  CoglPipeline *pipeline;
+};
+
+static gint64
+get_frame_budget (void)
+{
+  guint frame_rate = _clutter_context_get_frame_rate ();
+
+  return 1000000 / MAX (frame_rate, 1);
+}
+
+ClutterStageHud *
+_clutter_stage_hud_new (void)
+{
+  ClutterStageHud *hud = g_slice_new0 (ClutterStageHud);
+  PangoFontDescription *desc;
+
+  hud->layout = pango_layout_new (_clutter_context_get_pango_context ());
+
+  desc = pango_font_description_from_string ("Monospace 8");
+  pango_layout_set_font_description (hud->layout, desc);
+  pango_font_description_free (desc);
+
+  pango_layout_set_text (hud->layout, "", -1);
+
+  return hud;
+}
+
+void
+_clutter_stage_hud_free (ClutterStageHud *hud)
+{
+  if (hud == NULL)
+    return;
+
+  g_object_unref (hud->layout);
+
+  if (hud->pipeline != NULL)
+    cogl_object_unref (hud->pipeline);
+
+  g_slice_free (ClutterStageHud, hud);
+}
+
+static void
+clutter_stage_hud_update_text (ClutterStageHud *hud,
+                               gint64           interval)
+{
+  gsize texture_bytes;
+  guint n_actors = 0;
+  gdouble seconds;
+  gchar *text;
+  gint height;
+
+  seconds = interval / 1000000.0;
+
+  texture_bytes = clutter_get_memory_usage (CLUTTER_MEMORY_CONTENT_TEXTURES, NULL)
+                + clutter_get_memory_usage (CLUTTER_MEMORY_OFFSCREEN_TARGETS, NULL);
+
+  clutter_get_memory_usage (CLUTTER_MEMORY_ACTORS, &n_actors);
+
+  text = g_strdup_printf ("%5.1f fps  cpu %5.2f ms  gpu %5.2f ms\n"
+                          "picks %u/s  redrawn %3.0f%%\n"
+                          "actors %u  textures %.1f MB\n"
+                          "dropped %u",
+                          hud->n_frames / seconds,
+                          hud->n_frames > 0
+                            ? hud->total_time / 1000.0 / hud->n_frames
+                            : 0.0,
+                          hud->gpu_time / 1000.0,
+                          (guint) (hud->n_picks / seconds),
+                          hud->n_frames > 0
+                            ? hud->redraw_area * 100.0 / hud->n_frames
+                            : 0.0,
+                          n_actors,
+                          texture_bytes / (1024.0 * 1024.0),
+                          hud->n_dropped);
+
+  pango_layout_set_text (hud->layout, text, -1);
+  g_free (text);
+
+  pango_layout_get_pixel_size (hud->layout, NULL, &height);
+  hud->text_height = height;
+
+  hud->n_frames = 0;
+  hud->total_time = 0;
+  hud->n_picks = 0;
+  hud->redraw_area = 0.0;
+}
+
+/*< private >
+ * _clutter_stage_hud_add_frame:
+ * @hud: a #ClutterStageHud
+ * @stage: the #ClutterStage of @hud
+ * @stats: the statistics of the frame that was just painted
+ *
+ * Records a frame of @stage; the text is updated at most twice per
+ * second.
+ */
+void
+_clutter_stage_hud_add_frame (ClutterStageHud         *hud,
+                              ClutterStage            *stage,
+                              const ClutterFrameStats *stats)
+{
+  gfloat width, height;
+  gint64 cpu_time;
+
+  cpu_time = stats->events_time
+           + stats->timelines_time
+           + stats->relayout_time
+           + stats->paint_time;
+
+  hud->frame_times[hud->head] = cpu_time;
+  hud->head = (hud->head + 1) % HUD_N_FRAMES;
+
+  hud->n_frames += 1;
+  hud->total_time += cpu_time;
+  hud->n_picks += stats->n_picks;
+
+  if (stats->gpu_time >= 0)
+    hud->gpu_time = stats->gpu_time;
+
+  /* the frame could not be ready for the next refresh */
+  if (cpu_time > get_frame_budget ())
+    hud->n_dropped += 1;
+
+  clutter_actor_get_size (CLUTTER_ACTOR (stage), &width, &height);
+  if (width > 0 && height > 0)
+    hud->redraw_area += MIN (hud->frame_area / (width * height), 1.0);
+
+  hud->frame_area = 0.0;
+
+  if (hud->last_update == 0)
+    hud->last_update = stats->frame_time;
+  else if (stats->frame_time - hud->last_update >= HUD_TEXT_INTERVAL)
+    {
+      clutter_stage_hud_update_text (hud, stats->frame_time - hud->last_update);
+      hud->last_update = stats->frame_time;
+    }
+}
+
+static CoglVertexP2C4 *
+add_quad (CoglVertexP2C4 *v,
+          float           x1,
+          float           y1,
+          float           x2,
+          float           y2,
+          guint8          r,
+          guint8          g,
+          guint8          b,
+          guint8          a)
+{
+  const float xs[6] = { x1, x2, x2, x1, x2, x1 };
+  const float ys[6] = { y1, y1, y2, y1, y2, y2 };
+  guint i;
+
+  /* premultiplied, as expected by the default blending */
+  r = r * a / 255;
+  g = g * a / 255;
+  b = b * a / 255;
+
+  for (i = 0; i < 6; i++, v++)
+    {
+      v->x = xs[i];
+      v->y = ys[i];
+      v->r = r;
+      v->g = g;
+      v->b = b;
+      v->a = a;
+    }
+
+  return v;
+}
+
+/*< private >
+ * _clutter_stage_hud_paint:
+ * @hud: a #ClutterStageHud
+ * @stage: the #ClutterStage of @hud
+ * @clip: the area of @stage being painted, or %NULL
+ *
+ * Paints @hud on top of @stage, which has just been painted.
+ */
+void
+_clutter_stage_hud_paint (ClutterStageHud             *hud,
+                          ClutterStage                *stage,
+                          const cairo_rectangle_int_t *clip)
+{
+  CoglFramebuffer *fb = cogl_get_draw_framebuffer ();
+  CoglContext *ctx;
+  CoglPrimitive *prim;
+  CoglVertexP2C4 *v;
+  CoglMatrix modelview;
+  CoglColor text_color;
+  gint64 budget;
+  float width, bottom;
+  guint i;
+
+  if (clip != NULL)
+    hud->frame_area += (gdouble) clip->width * clip->height;
+  else
+    {
+      gfloat stage_width, stage_height;
+
+      clutter_actor_get_size (CLUTTER_ACTOR (stage), &stage_width, &stage_height);
+      hud->frame_area += stage_width * stage_height;
+    }
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+  if (hud->pipeline == NULL)
+    hud->pipeline = cogl_pipeline_new (ctx);
+
+  budget = get_frame_budget ();
+  width = HUD_N_FRAMES * HUD_BAR_WIDTH;
+  bottom = HUD_Y + HUD_GRAPH_HEIGHT;
+
+  v = add_quad (hud->vertices,
+                HUD_X - HUD_PADDING, HUD_Y - HUD_PADDING,
+                HUD_X + width + HUD_PADDING,
+                bottom + HUD_PADDING + hud->text_height + HUD_PADDING,
+                0, 0, 0, 0xc0);
+
+  /* the graph spans two frame budgets, so the line is in the middle */
+  v = add_quad (v,
+                HUD_X, bottom - HUD_GRAPH_HEIGHT / 2,
+                HUD_X + width, bottom - HUD_GRAPH_HEIGHT / 2 + 1,
+                0xff, 0xff, 0xff, 0x80);
+
+  for (i = 0; i < HUD_N_FRAMES; i++)
+    {
+      gint64 frame_time = hud->frame_times[(hud->head + i) % HUD_N_FRAMES];
+      float bar_height;
+
+      bar_height = MIN ((float) frame_time / (2 * budget), 1.0f)
+                 * HUD_GRAPH_HEIGHT;
+
+      if (frame_time > budget)
+        v = add_quad (v,
+                      HUD_X + i * HUD_BAR_WIDTH, bottom - bar_height,
+                      HUD_X + (i + 1) * HUD_BAR_WIDTH, bottom,
+                      0xff, 0x40, 0x40, 0xff);
+      else
+        v = add_quad (v,
+                      HUD_X + i * HUD_BAR_WIDTH, bottom - bar_height,
+                      HUD_X + (i + 1) * HUD_BAR_WIDTH, bottom,
+                      0x40, 0xff, 0x40, 0xff);
+    }
+
+  cogl_framebuffer_push_matrix (fb);
+
+  cogl_framebuffer_get_modelview_matrix (fb, &modelview);
+  _clutter_actor_apply_modelview_transform (CLUTTER_ACTOR (stage), &modelview);
+  cogl_framebuffer_set_modelview_matrix (fb, &modelview);
+
+  prim = cogl_primitive_new_p2c4 (ctx, COGL_VERTICES_MODE_TRIANGLES,
+                                  HUD_N_VERTICES,
+                                  hud->vertices);
+  cogl_framebuffer_draw_primitive (fb, hud->pipeline, prim);
+  cogl_object_unref (prim);
+
+  cogl_color_init_from_4ub (&text_color, 0xff, 0xff, 0xff, 0xff);
+  cogl_pango_render_layout (hud->layout,
+                            HUD_X, bottom + HUD_PADDING,
+                            &text_color,
+                            0);
+
+  cogl_framebuffer_pop_matrix (fb);
+}
+
+/*< private >
+ * _clutter_stage_hud_get_area:
+ * @hud: a #ClutterStageHud
+ * @area: (out): return location for the area covered by @hud
+ *
+ * Retrieves the area of the stage covered by @hud, in stage coordinates.
+ */
+void
+_clutter_stage_hud_get_area (ClutterStageHud       *hud,
+                             cairo_rectangle_int_t *area)
+{
+  area->x = 0;
+  area->y = 0;
+  area->width = HUD_X + HUD_N_FRAMES * HUD_BAR_WIDTH + HUD_PADDING + 1;
+  area->height = HUD_Y + HUD_GRAPH_HEIGHT + hud->text_height
+               + 2 * HUD_PADDING + 1;
+}
@@ -0,0 +1,45 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_STAGE_HUD_H__
+#define __CLUTTER_STAGE_HUD_H__
+
+#include <cairo.h>
+#include <clutter/clutter-stage.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ClutterStageHud ClutterStageHud;
+
+ClutterStageHud *       _clutter_stage_hud_new          (void);
+void                    _clutter_stage_hud_free         (ClutterStageHud             *hud);
+void                    _clutter_stage_hud_add_frame    (ClutterStageHud             *hud,
+                                                         ClutterStage                *stage,
+                                                         const ClutterFrameStats     *stats);
+void                    _clutter_stage_hud_paint        (ClutterStageHud             *hud,
+                                                         ClutterStage                *stage,
+                                                         const cairo_rectangle_int_t *clip);
+void                    _clutter_stage_hud_get_area     (ClutterStageHud             *hud,
+                                                         cairo_rectangle_int_t       *area);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_STAGE_HUD_H__ */
@@ -0,0 +1,72 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_STAGE_OFFSCREEN_PRIVATE_H__
+#define __CLUTTER_STAGE_OFFSCREEN_PRIVATE_H__
+
+#include <cogl/cogl.h>
+#include <clutter/clutter-stage.h>
+#include <clutter/clutter-stage-window.h>
+
+G_BEGIN_DECLS
+
+#define CLUTTER_TYPE_STAGE_OFFSCREEN            (_clutter_stage_offscreen_get_type ())
+#define CLUTTER_STAGE_OFFSCREEN(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), CLUTTER_TYPE_STAGE_OFFSCREEN, ClutterStageOffscreen))
+#define CLUTTER_IS_STAGE_OFFSCREEN(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CLUTTER_TYPE_STAGE_OFFSCREEN))
+
+typedef struct _ClutterStageOffscreen           ClutterStageOffscreen;
+typedef struct _ClutterStageOffscreenClass      ClutterStageOffscreenClass;
+
+struct _ClutterStageOffscreen
+{
+  GObject parent_instance;
+
+  /* the stage wrapper */
+  ClutterStage *wrapper;
+
+  /* back pointer to the backend */
+  ClutterBackend *backend;
+
+  gint width;
+  gint height;
+
+  /* the render target, and the texture holding the last frame; both
+   * are created when realizing the stage
+   */
+  CoglHandle texture;
+  CoglHandle offscreen;
+};
+
+struct _ClutterStageOffscreenClass
+{
+  GObjectClass parent_class;
+};
+
+GType                   _clutter_stage_offscreen_get_type       (void) G_GNUC_CONST;
+
+ClutterStageWindow *    _clutter_stage_offscreen_new            (ClutterStage       *wrapper,
+                                                                 gint                width,
+                                                                 gint                height);
+CoglHandle              _clutter_stage_offscreen_get_texture    (ClutterStageWindow *stage_window);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_STAGE_OFFSCREEN_PRIVATE_H__ */
@@ -0,0 +1,351 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ClutterStageOffscreen:
+ *
+ * A #ClutterStageWindow implementation that renders into an offscreen
+ * framebuffer, instead of a window provided by the windowing system;
+ * see clutter_stage_new_offscreen().
+ *
+ * The stage is never updated by the master clock: each frame is
+ * rendered explicitly, using clutter_stage_render_frame().
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "clutter-stage-offscreen-private.h"
+
+#include "clutter-actor.h"
+#include "clutter-backend.h"
+#include "clutter-debug.h"
+#include "clutter-private.h"
+#include "clutter-stage-private.h"
+
+static void clutter_stage_window_iface_init (ClutterStageWindowIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (ClutterStageOffscreen,
+                         _clutter_stage_offscreen,
+                         G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_STAGE_WINDOW,
+                                                clutter_stage_window_iface_init));
+
+enum {
+  PROP_0,
+  PROP_WRAPPER,
+  PROP_BACKEND,
+  PROP_LAST
+};
+
+static void
+clutter_stage_offscreen_unrealize (ClutterStageWindow *stage_window)
+{
+  ClutterStageOffscreen *stage_offscreen = CLUTTER_STAGE_OFFSCREEN (stage_window);
+
+  CLUTTER_NOTE (BACKEND, "Unrealizing offscreen stage [%p]", stage_offscreen);
+
+  if (stage_offscreen->offscreen != NULL)
+    {
+      cogl_handle_unref (stage_offscreen->offscreen);
+      stage_offscreen->offscreen = NULL;
+    }
+
+  if (stage_offscreen->texture != NULL)
+    {
+      cogl_handle_unref (stage_offscreen->texture);
+      stage_offscreen->texture = NULL;
+    }
+}
+
+static gboolean
+clutter_stage_offscreen_realize (ClutterStageWindow *stage_window)
+{
+  ClutterStageOffscreen *stage_offscreen = CLUTTER_STAGE_OFFSCREEN (stage_window);
+  CoglError *error = NULL;
+
+  CLUTTER_NOTE (BACKEND, "Realizing offscreen stage [%p] (%dx%d)",
+                stage_offscreen,
+                stage_offscreen->width,
+                stage_offscreen->height);
+
+  if (stage_offscreen->offscreen != NULL)
+    return TRUE;
+
+  stage_offscreen->texture =
+    cogl_texture_new_with_size (stage_offscreen->width,
+                                stage_offscreen->height,
+                                COGL_TEXTURE_NO_SLICING,
+                                COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+  if (!cogl_texture_allocate (stage_offscreen->texture, &error))
+    {
+      g_warning ("Failed to allocate the offscreen stage: %s",
+                 error->message);
+      cogl_error_free (error);
+      cogl_handle_unref (stage_offscreen->texture);
+      stage_offscreen->texture = NULL;
+      return FALSE;
+    }
+
+  stage_offscreen->offscreen =
+    cogl_offscreen_new_to_texture (stage_offscreen->texture);
+  if (stage_offscreen->offscreen == NULL)
+    {
+      g_warning ("Failed to create the framebuffer of the offscreen stage");
+      cogl_handle_unref (stage_offscreen->texture);
+      stage_offscreen->texture = NULL;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static ClutterActor *
+clutter_stage_offscreen_get_wrapper (ClutterStageWindow *stage_window)
+{
+  return CLUTTER_ACTOR (CLUTTER_STAGE_OFFSCREEN (stage_window)->wrapper);
+}
+
+static void
+clutter_stage_offscreen_show (ClutterStageWindow *stage_window,
+                              gboolean            do_raise)
+{
+  ClutterStageOffscreen *stage_offscreen = CLUTTER_STAGE_OFFSCREEN (stage_window);
+
+  clutter_actor_map (CLUTTER_ACTOR (stage_offscreen->wrapper));
+}
+
+static void
+clutter_stage_offscreen_hide (ClutterStageWindow *stage_window)
+{
+  ClutterStageOffscreen *stage_offscreen = CLUTTER_STAGE_OFFSCREEN (stage_window);
+
+  clutter_actor_unmap (CLUTTER_ACTOR (stage_offscreen->wrapper));
+}
+
+static void
+clutter_stage_offscreen_get_geometry (ClutterStageWindow    *stage_window,
+                                      cairo_rectangle_int_t *geometry)
+{
+  ClutterStageOffscreen *stage_offscreen = CLUTTER_STAGE_OFFSCREEN (stage_window);
+
+  if (geometry != NULL)
+    {
+      geometry->x = geometry->y = 0;
+      geometry->width = stage_offscreen->width;
+      geometry->height = stage_offscreen->height;
+    }
+}
+
+static void
+clutter_stage_offscreen_resize (ClutterStageWindow *stage_window,
+                                gint                width,
+                                gint                height)
+{
+  ClutterStageOffscreen *stage_offscreen = CLUTTER_STAGE_OFFSCREEN (stage_window);
+  gboolean is_realized;
+
+  width = MAX (width, 1);
+  height = MAX (height, 1);
+
+  if (stage_offscreen->width == width && stage_offscreen->height == height)
+    return;
+
+  CLUTTER_NOTE (BACKEND, "Resizing offscreen stage [%p] to %dx%d",
+                stage_offscreen, width, height);
+
+  stage_offscreen->width = width;
+  stage_offscreen->height = height;
+
+  /* the render target has a fixed size, so we need a new one */
+  is_realized = stage_offscreen->offscreen != NULL;
+  clutter_stage_offscreen_unrealize (stage_window);
+
+  if (is_realized)
+    clutter_stage_offscreen_realize (stage_window);
+}
+
+/* the frames are rendered explicitly, so the master clock should
+ * never consider the stage ready for an update
+ */
+static void
+clutter_stage_offscreen_schedule_update (ClutterStageWindow *stage_window,
+                                         int                 sync_delay)
+{
+}
+
+static gint64
+clutter_stage_offscreen_get_update_time (ClutterStageWindow *stage_window)
+{
+  return -1;
+}
+
+static void
+clutter_stage_offscreen_clear_update_time (ClutterStageWindow *stage_window)
+{
+}
+
+static void
+clutter_stage_offscreen_redraw (ClutterStageWindow *stage_window)
+{
+  ClutterStageOffscreen *stage_offscreen = CLUTTER_STAGE_OFFSCREEN (stage_window);
+
+  if (stage_offscreen->offscreen == NULL)
+    return;
+
+  _clutter_stage_do_paint (stage_offscreen->wrapper, NULL);
+
+  /* nothing is presented, so the whole frame can be captured */
+  _clutter_stage_queue_captures (stage_offscreen->wrapper, NULL, 0);
+
+  cogl_flush ();
+}
+
+static CoglFramebuffer *
+clutter_stage_offscreen_get_active_framebuffer (ClutterStageWindow *stage_window)
+{
+  ClutterStageOffscreen *stage_offscreen = CLUTTER_STAGE_OFFSCREEN (stage_window);
+
+  return COGL_FRAMEBUFFER (stage_offscreen->offscreen);
+}
+
+static gboolean
+clutter_stage_offscreen_can_clip_redraws (ClutterStageWindow *stage_window)
+{
+  return FALSE;
+}
+
+static void
+clutter_stage_window_iface_init (ClutterStageWindowIface *iface)
+{
+  iface->realize = clutter_stage_offscreen_realize;
+  iface->unrealize = clutter_stage_offscreen_unrealize;
+  iface->get_wrapper = clutter_stage_offscreen_get_wrapper;
+  iface->get_geometry = clutter_stage_offscreen_get_geometry;
+  iface->resize = clutter_stage_offscreen_resize;
+  iface->show = clutter_stage_offscreen_show;
+  iface->hide = clutter_stage_offscreen_hide;
+  iface->schedule_update = clutter_stage_offscreen_schedule_update;
+  iface->get_update_time = clutter_stage_offscreen_get_update_time;
+  iface->clear_update_time = clutter_stage_offscreen_clear_update_time;
+  iface->redraw = clutter_stage_offscreen_redraw;
+  iface->get_active_framebuffer = clutter_stage_offscreen_get_active_framebuffer;
+  iface->can_clip_redraws = clutter_stage_offscreen_can_clip_redraws;
+}
+
+static void
+clutter_stage_offscreen_set_property (GObject      *gobject,
+                                      guint         prop_id,
+                                      const GValue *value,
+                                      GParamSpec   *pspec)
+{
+  ClutterStageOffscreen *self = CLUTTER_STAGE_OFFSCREEN (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_WRAPPER:
+      self->wrapper = g_value_get_object (value);
+      break;
+
+    case PROP_BACKEND:
+      self->backend = g_value_get_object (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_stage_offscreen_dispose (GObject *gobject)
+{
+  clutter_stage_offscreen_unrealize (CLUTTER_STAGE_WINDOW (gobject));
+
+  G_OBJECT_CLASS (_clutter_stage_offscreen_parent_class)->dispose (gobject);
+}
+
+static void
+_clutter_stage_offscreen_class_init (ClutterStageOffscreenClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->set_property = clutter_stage_offscreen_set_property;
+  gobject_class->dispose = clutter_stage_offscreen_dispose;
+
+  g_object_class_override_property (gobject_class, PROP_WRAPPER, "wrapper");
+  g_object_class_override_property (gobject_class, PROP_BACKEND, "backend");
+}
+
+static void
+_clutter_stage_offscreen_init (ClutterStageOffscreen *self)
+{
+  self->width = 1;
+  self->height = 1;
+}
+
+/*< private >
+ * _clutter_stage_offscreen_new:
+ * @wrapper: the #ClutterStage using the stage window
+ * @width: the width of the framebuffer, in pixels
+ * @height: the height of the framebuffer, in pixels
+ *
+ * Creates a new stage window rendering into an offscreen framebuffer
+ * of the given size.
+ *
+ * Return value: (transfer full): the newly created stage window
+ */
+ClutterStageWindow *
+_clutter_stage_offscreen_new (ClutterStage *wrapper,
+                              gint          width,
+                              gint          height)
+{
+  ClutterStageOffscreen *retval;
+
+  retval = g_object_new (CLUTTER_TYPE_STAGE_OFFSCREEN,
+                         "wrapper", wrapper,
+                         "backend", clutter_get_default_backend (),
+                         NULL);
+
+  retval->width = MAX (width, 1);
+  retval->height = MAX (height, 1);
+
+  return CLUTTER_STAGE_WINDOW (retval);
+}
+
+/*< private >
+ * _clutter_stage_offscreen_get_texture:
+ * @stage_window: a #ClutterStageOffscreen
+ *
+ * Retrieves the texture holding the last frame rendered by the stage.
+ *
+ * Return value: (transfer none): a handle for a Cogl texture, or
+ *   %COGL_INVALID_HANDLE if the stage has not been realized
+ */
+CoglHandle
+_clutter_stage_offscreen_get_texture (ClutterStageWindow *stage_window)
+{
+  g_return_val_if_fail (CLUTTER_IS_STAGE_OFFSCREEN (stage_window),
+                        COGL_INVALID_HANDLE);
+
+  return CLUTTER_STAGE_OFFSCREEN (stage_window)->texture;
+}
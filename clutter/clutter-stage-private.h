@@ -31,8 +31,6 @@
 
 G_BEGIN_DECLS
 
-typedef struct _ClutterStageQueueRedrawEntry ClutterStageQueueRedrawEntry;
-
 /* stage */
 ClutterStageWindow *_clutter_stage_get_default_window    (void);
 
@@ -60,35 +58,89 @@ void                _clutter_stage_maybe_setup_viewport  (ClutterStage
 void                _clutter_stage_maybe_relayout        (ClutterActor          *stage);
 gboolean            _clutter_stage_needs_update          (ClutterStage          *stage);
 gboolean            _clutter_stage_do_update             (ClutterStage          *stage);
+gboolean            _clutter_stage_do_layout             (ClutterStage          *stage);
+gboolean            _clutter_stage_do_repaint            (ClutterStage          *stage);
 
 void     _clutter_stage_queue_event                       (ClutterStage *stage,
-					                   ClutterEvent *event);
+					                   ClutterEvent *event,
+					                   gboolean      copy_event);
+gboolean _clutter_stage_push_event                        (ClutterStage       *stage,
+                                                           const ClutterEvent *event,
+                                                           gint64              origin_time);
 gboolean _clutter_stage_has_queued_events                 (ClutterStage *stage);
 void     _clutter_stage_process_queued_events             (ClutterStage *stage);
 void     _clutter_stage_update_input_devices              (ClutterStage *stage);
 void     _clutter_stage_schedule_update                   (ClutterStage *stage);
 gint64    _clutter_stage_get_update_time                  (ClutterStage *stage);
 void     _clutter_stage_clear_update_time                 (ClutterStage *stage);
+gint64   _clutter_stage_get_next_presentation_time        (ClutterStage *stage);
+gint64   _clutter_stage_get_refresh_interval              (ClutterStage *stage);
+gint64   _clutter_stage_take_input_time                   (ClutterStage *stage);
+void     _clutter_stage_report_input_latency              (ClutterStage *stage,
+                                                           gint64        latency);
+gboolean _clutter_stage_get_collect_frame_stats           (ClutterStage *stage);
+void     _clutter_stage_report_swap_wait_time             (ClutterStage *stage,
+                                                           gint64        duration);
+void     _clutter_stage_begin_gpu_timer                   (ClutterStage *stage);
+void     _clutter_stage_end_gpu_timer                     (ClutterStage *stage);
+void     _clutter_stage_queue_captures                    (ClutterStage                *stage,
+                                                           const cairo_rectangle_int_t *damage,
+                                                           guint                        n_damage);
+void     _clutter_stage_emit_frame_stats                  (ClutterStage *stage,
+                                                           gint64        frame_time,
+                                                           gint64        events_time,
+                                                           gint64        timelines_time);
 gboolean _clutter_stage_has_full_redraw_queued            (ClutterStage *stage);
 
 ClutterActor *_clutter_stage_do_pick (ClutterStage    *stage,
                                       gint             x,
                                       gint             y,
                                       ClutterPickMode  mode);
+void          _clutter_stage_do_pick_positions (ClutterStage       *stage,
+                                                const ClutterPoint *positions,
+                                                guint               n_positions,
+                                                ClutterPickMode     mode,
+                                                ClutterActor      **actors);
+ClutterActor *_clutter_stage_do_pick_async     (ClutterStage       *stage,
+                                                ClutterInputDevice *device,
+                                                gint                x,
+                                                gint                y,
+                                                ClutterPickMode     mode);
 
 ClutterPaintVolume *_clutter_stage_paint_volume_stack_allocate (ClutterStage *stage);
 void                _clutter_stage_paint_volume_stack_free_all (ClutterStage *stage);
 
+void                _clutter_stage_queue_size_relayout (ClutterStage *stage,
+                                                        ClutterActor *actor);
+void                _clutter_stage_add_constrained_actor (ClutterStage           *stage,
+                                                          ClutterActor           *actor,
+                                                          const ClutterActorBox  *box,
+                                                          ClutterAllocationFlags  flags);
+
 const ClutterPlane *_clutter_stage_get_clip (ClutterStage *stage);
+const ClutterOcclusion *_clutter_stage_get_occlusion (ClutterStage *stage);
 
-ClutterStageQueueRedrawEntry *_clutter_stage_queue_actor_redraw            (ClutterStage                 *stage,
-                                                                            ClutterStageQueueRedrawEntry *entry,
-                                                                            ClutterActor                 *actor,
-                                                                            ClutterPaintVolume           *clip);
-void                          _clutter_stage_queue_redraw_entry_invalidate (ClutterStageQueueRedrawEntry *entry);
+gint            _clutter_stage_queue_actor_redraw               (ClutterStage       *stage,
+                                                                 gint                entry_index,
+                                                                 ClutterActor       *actor,
+                                                                 ClutterPaintVolume *clip);
+void            _clutter_stage_queue_redraw_entry_invalidate    (ClutterStage       *stage,
+                                                                 gint                entry_index);
 
 CoglFramebuffer *_clutter_stage_get_active_framebuffer (ClutterStage *stage);
 
+gboolean        _clutter_stage_acquire_offscreen        (ClutterStage    *stage,
+                                                         int              width,
+                                                         int              height,
+                                                         CoglPixelFormat  format,
+                                                         CoglHandle      *texture,
+                                                         CoglHandle      *offscreen);
+void            _clutter_stage_release_offscreen        (ClutterStage    *stage,
+                                                         CoglPixelFormat  format,
+                                                         CoglHandle       texture,
+                                                         CoglHandle       offscreen);
+void            _clutter_stage_expire_offscreen_pool    (void);
+
 gint32          _clutter_stage_acquire_pick_id          (ClutterStage *stage,
                                                          ClutterActor *actor);
 void            _clutter_stage_release_pick_id          (ClutterStage *stage,
@@ -96,6 +148,23 @@ void            _clutter_stage_release_pick_id          (ClutterStage *stage,
 ClutterActor *  _clutter_stage_get_actor_by_pick_id     (ClutterStage *stage,
                                                          gint32        pick_id);
 
+void            _clutter_stage_update_pick_index        (ClutterStage          *stage,
+                                                         ClutterActor          *actor,
+                                                         gint                  *handle_p,
+                                                         const ClutterActorBox *box);
+void            _clutter_stage_remove_from_pick_index   (ClutterStage          *stage,
+                                                         gint                  *handle_p);
+gboolean        _clutter_stage_get_reactive_actor_at_pos (ClutterStage         *stage,
+                                                          gfloat                x,
+                                                          gfloat                y,
+                                                          ClutterActor         *ignore,
+                                                          ClutterActor        **actor_p);
+void            _clutter_stage_invalidate_pick_index    (ClutterStage          *stage);
+guint           _clutter_stage_get_pick_generation      (ClutterStage          *stage);
+guint           _clutter_stage_get_view_generation      (ClutterStage          *stage);
+void            _clutter_stage_invalidate_pick          (ClutterStage          *stage,
+                                                         gboolean               reactive);
+
 void            _clutter_stage_add_pointer_drag_actor    (ClutterStage       *stage,
                                                           ClutterInputDevice *device,
                                                           ClutterActor       *actor);
@@ -174,6 +174,53 @@ _clutter_stage_window_clear_update_time (ClutterStageWindow *window)
   iface->clear_update_time (window);
 }
 
+/*
+ * _clutter_stage_window_get_next_presentation_time:
+ * @window: a #ClutterStageWindow
+ *
+ * Predicts when the frame drawn now is going to be presented, using
+ * the timings of the previous frames.
+ *
+ * Return value: the predicted presentation time, in microseconds on
+ *   the monotonic clock, or -1 if the backend cannot tell
+ */
+gint64
+_clutter_stage_window_get_next_presentation_time (ClutterStageWindow *window)
+{
+  ClutterStageWindowIface *iface;
+
+  g_return_val_if_fail (CLUTTER_IS_STAGE_WINDOW (window), -1);
+
+  iface = CLUTTER_STAGE_WINDOW_GET_IFACE (window);
+  if (iface->get_next_presentation_time == NULL)
+    return -1;
+
+  return iface->get_next_presentation_time (window);
+}
+
+/*
+ * _clutter_stage_window_get_refresh_interval:
+ * @window: a #ClutterStageWindow
+ *
+ * Retrieves the interval between two vertical refreshes of @window.
+ *
+ * Return value: the refresh interval, in microseconds, or 0 if the
+ *   backend cannot tell
+ */
+gint64
+_clutter_stage_window_get_refresh_interval (ClutterStageWindow *window)
+{
+  ClutterStageWindowIface *iface;
+
+  g_return_val_if_fail (CLUTTER_IS_STAGE_WINDOW (window), 0);
+
+  iface = CLUTTER_STAGE_WINDOW_GET_IFACE (window);
+  if (iface->get_refresh_interval == NULL)
+    return 0;
+
+  return iface->get_refresh_interval (window);
+}
+
 void
 _clutter_stage_window_add_redraw_clip (ClutterStageWindow    *window,
                                        cairo_rectangle_int_t *stage_clip)
@@ -27,6 +27,11 @@ typedef struct _ClutterStageWindowIface ClutterStageWindowIface;
  *
  * The interface implemented by backends for stage windows
  *
+ * All the painting of a stage window goes through the redraw() virtual
+ * function; there is no hook for assigning actors to hardware planes,
+ * since the Cogl winsys used by the backends does not expose the KMS
+ * planes, or a way to flip client buffers onto them.
+ *
  *
  */
 struct _ClutterStageWindowIface
@@ -62,6 +67,8 @@ struct _ClutterStageWindowIface
                                                  int                 sync_delay);
   gint64            (* get_update_time)         (ClutterStageWindow *stage_window);
   void              (* clear_update_time)       (ClutterStageWindow *stage_window);
+  gint64            (* get_next_presentation_time) (ClutterStageWindow *stage_window);
+  gint64            (* get_refresh_interval)    (ClutterStageWindow *stage_window);
 
   void              (* add_redraw_clip)         (ClutterStageWindow    *stage_window,
                                                  cairo_rectangle_int_t *stage_rectangle);
@@ -115,6 +122,8 @@ void              _clutter_stage_window_schedule_update         (ClutterStageWin
                                                                  int                 sync_delay);
 gint64            _clutter_stage_window_get_update_time         (ClutterStageWindow *window);
 void              _clutter_stage_window_clear_update_time       (ClutterStageWindow *window);
+gint64            _clutter_stage_window_get_next_presentation_time (ClutterStageWindow *window);
+gint64            _clutter_stage_window_get_refresh_interval    (ClutterStageWindow *window);
 
 void              _clutter_stage_window_add_redraw_clip         (ClutterStageWindow    *window,
                                                                  cairo_rectangle_int_t *stage_clip);
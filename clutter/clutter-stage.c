@@ -47,6 +47,7 @@
 #endif
 
 #include <math.h>
+#include <string.h>
 #include <cairo.h>
 
 #define CLUTTER_ENABLE_EXPERIMENTAL_API
@@ -62,15 +63,22 @@
 #include "clutter-device-manager-private.h"
 #include "clutter-enum-types.h"
 #include "clutter-event-private.h"
+#include "clutter-event-replay.h"
+#include "clutter-gpu-timer.h"
 #include "clutter-id-pool.h"
 #include "clutter-main.h"
 #include "clutter-marshal.h"
 #include "clutter-master-clock.h"
+#include "clutter-memory.h"
 #include "clutter-paint-volume-private.h"
+#include "clutter-pick-index.h"
 #include "clutter-private.h"
 #include "clutter-profile.h"
 #include "clutter-stage-manager-private.h"
+#include "clutter-stage-hud.h"
+#include "clutter-stage-offscreen-private.h"
 #include "clutter-stage-private.h"
+#include "clutter-trace.h"
 #include "clutter-version.h" 	/* For flavour */
 #include "clutter-private.h"
 
@@ -78,6 +86,16 @@
 
 G_DEFINE_TYPE (ClutterStage, clutter_stage, CLUTTER_TYPE_ACTOR)
 
+static void clutter_stage_prefetch_picks        (ClutterStage *stage,
+                                                 GList        *events);
+static void clutter_stage_clear_pick_prefetch   (ClutterStage *stage);
+static void clutter_stage_clear_async_picks     (ClutterStage *stage);
+static void clutter_stage_resolve_async_picks   (ClutterStage *stage);
+static void clutter_stage_clear_captures        (ClutterStage *stage);
+static void clutter_stage_resolve_captures      (ClutterStage *stage);
+static void clutter_stage_solve_constraints     (ClutterStage *stage);
+static void clutter_stage_clear_constrained_actors (ClutterStage *stage);
+
 #define CLUTTER_STAGE_GET_PRIVATE(obj) \
 (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_STAGE, ClutterStagePrivate))
 
@@ -100,12 +118,111 @@ typedef enum { /*< prefix=CLUTTER_STAGE >*/
 
 #define STAGE_NO_CLEAR_ON_PAINT(s)      ((((ClutterStage *) (s))->priv->stage_hints & CLUTTER_STAGE_NO_CLEAR_ON_PAINT) != 0)
 
-struct _ClutterStageQueueRedrawEntry
+/* the pick identifier used for the stage itself, which is painted
+ * as a white background when picking
+ */
+#define STAGE_PICK_ID   G_MAXUINT32
+
+#define POINT_IN_VIEWPORT(x,y,w,h)      ((x) >= 0 && (x) < (w) && (y) >= 0 && (y) < (h))
+
+typedef struct _AsyncPick
+{
+  ClutterInputDevice *device;
+  ClutterPickMode mode;
+
+  /* the bitmap wrapping the pixel buffer we read the pick into */
+  CoglBitmap *bitmap;
+} AsyncPick;
+
+typedef struct _StageCapture
+{
+  cairo_rectangle_int_t rect;
+
+  ClutterStageCaptureFunc func;
+  gpointer user_data;
+  GDestroyNotify notify;
+
+  /* the bitmap wrapping the pixel buffer we read the frame into, and
+   * the areas repainted by the frame; both are set by the stage window
+   * after painting the frame
+   */
+  CoglBitmap *bitmap;
+  GArray *damage;
+
+  /* whether the frame has been submitted since we queued the read */
+  guint submitted : 1;
+} StageCapture;
+
+/* idle offscreen targets are released after this many frames */
+#define OFFSCREEN_POOL_MAX_AGE  60
+
+typedef struct _OffscreenPoolKey
+{
+  int width;
+  int height;
+  CoglPixelFormat format;
+} OffscreenPoolKey;
+
+typedef struct _OffscreenTarget
+{
+  CoglHandle texture;
+  CoglHandle offscreen;
+
+  /* the frame in which the target was released */
+  guint64 release_frame;
+} OffscreenTarget;
+
+/* the offscreen targets are shared by all the stages, as they all use
+ * the same Cogl context; the pool exists as long as a stage does
+ */
+static GHashTable *offscreen_pool = NULL;
+static guint64 offscreen_pool_frame = 0;
+static guint offscreen_pool_n_stages = 0;
+
+/* the size of the ring of events pushed by the input threads; it must
+ * be a power of two
+ */
+#define EVENT_RING_SIZE         256
+#define EVENT_RING_MASK         (EVENT_RING_SIZE - 1)
+
+typedef struct _EventRingSlot
+{
+  /* the position of the slot, for the producers, or the position
+   * plus one, once the event has been written and can be drained
+   */
+  volatile gint sequence;
+
+  ClutterEvent event;
+  gint64 origin_time;
+} EventRingSlot;
+
+typedef struct _EventRing
+{
+  /* the next position claimed by a producer */
+  volatile gint head;
+
+  /* the next position drained; only accessed by the main thread */
+  gint tail;
+
+  volatile gint wakeup_pending;
+
+  EventRingSlot slots[EVENT_RING_SIZE];
+} EventRing;
+
+typedef struct _PickPrefetch
+{
+  gint x;
+  gint y;
+  ClutterPickMode mode;
+  guint32 pick_id;
+} PickPrefetch;
+
+typedef struct _QueueRedrawEntry
 {
   ClutterActor *actor;
   gboolean has_clip;
   ClutterPaintVolume clip;
-};
+} QueueRedrawEntry;
 
 struct _ClutterStagePrivate
 {
@@ -123,18 +240,58 @@ struct _ClutterStagePrivate
 
   GQueue *event_queue;
 
+  /* the events pushed from any thread through _clutter_stage_push_event() */
+  EventRing *event_ring;
+
+  /* the origin time of the oldest event processed since the last
+   * redraw, or 0; see _clutter_stage_take_input_time()
+   */
+  gint64 pending_input_time;
+
+  /* the input latency of the presented frames, in milliseconds; only
+   * used with CLUTTER_PAINT=input-latency
+   */
+  guint *input_latency_histogram;
+
   ClutterStageHint stage_hints;
 
   gint picks_per_frame;
 
+  ClutterFrameStats frame_stats;
+
   GArray *paint_volume_stack;
 
   ClutterPlane current_clip_planes[4];
 
-  GList *pending_queue_redraws;
+  /* the opaque areas of the stage for the current paint */
+  ClutterOcclusion occlusion;
+
+  /* the actors that queued a redraw since the last update, stored in
+   * place; each actor knows the index of its entry, so that further
+   * redraws combine their clip with it. The array is emptied, but not
+   * released, when the redraws are processed
+   */
+  GArray *pending_queue_redraws;
 
   ClutterPickMode pick_buffer_mode;
 
+  /* bumped each time the state relevant to picking changes; we keep
+   * two counters, since most of the changes do not affect the picks
+   * done in %CLUTTER_PICK_REACTIVE mode
+   */
+  guint pick_generation_all;
+  guint pick_generation_reactive;
+
+  /* bumped each time the view matrix changes */
+  guint view_generation;
+
+  /* the generation at the time of the last pick render, the last
+   * update of the pick index and the last prefetch
+   */
+  guint pick_buffer_generation;
+  guint pick_index_generation;
+  guint pick_prefetch_generation;
+
   CoglFramebuffer *active_framebuffer;
 
   gint sync_delay;
@@ -144,6 +301,39 @@ struct _ClutterStagePrivate
 
   ClutterIDPool *pick_id_pool;
 
+  /* bounding volume hierarchy of the reactive actors */
+  ClutterPickIndex *pick_index;
+  GPtrArray *pick_candidates;
+
+  /* picks resolved in advance for the queued events */
+  GArray *pick_prefetch;
+
+  /* pending asynchronous picks, and the unused pixel buffers */
+  GList *async_picks;
+  GSList *async_pick_bitmaps;
+
+  /* pending captures of the contents of the stage */
+  GList *captures;
+
+  /* actors whose size requests might have changed, queued through
+   * _clutter_actor_queue_size_relayout()
+   */
+  GPtrArray *pending_size_relayouts;
+
+  /* actors allocated during the current relayout whose constraints
+   * depend on other actors; see clutter_stage_solve_constraints()
+   */
+  GPtrArray *constrained_actors;
+  GHashTable *constrained_actors_map;
+
+  /* measures the GPU time of the frames while ::frame-stats has
+   * handlers; created on the first measured frame
+   */
+  ClutterGpuTimer *gpu_timer;
+
+  /* the performance HUD, if it is shown */
+  ClutterStageHud *hud;
+
 #ifdef CLUTTER_ENABLE_DEBUG
   gulong redraw_count;
 #endif /* CLUTTER_ENABLE_DEBUG */
@@ -152,6 +342,7 @@ struct _ClutterStagePrivate
 
   guint relayout_pending       : 1;
   guint redraw_pending         : 1;
+  guint redraw_damaged         : 1;
   guint is_fullscreen          : 1;
   guint is_cursor_visible      : 1;
   guint is_user_resizable      : 1;
@@ -163,7 +354,33 @@ struct _ClutterStagePrivate
   guint have_valid_pick_buffer : 1;
   guint accept_focus           : 1;
   guint motion_events_enabled  : 1;
+  guint adaptive_sync_delay    : 1;
   guint has_custom_perspective : 1;
+  guint use_orthographic       : 1;
+  guint geometry_pick_enabled  : 1;
+  guint pick_index_complete    : 1;
+  guint occlusion_computed     : 1;
+  guint async_pick_enabled     : 1;
+  guint incremental_relayout   : 1;
+  guint in_constraint_pass     : 1;
+
+  /* whether the stage renders into an offscreen framebuffer, and is
+   * updated using clutter_stage_render_frame()
+   */
+  guint is_offscreen           : 1;
+
+  /* whether the duration of the phases of the current frame is being
+   * measured, because ::frame-stats has handlers, and whether the
+   * stage was painted during the current frame
+   */
+  guint collect_frame_stats    : 1;
+  guint frame_stats_pending    : 1;
+  guint gpu_timer_checked      : 1;
+
+  /* idle offscreen targets, bucketed by size and pixel format;
+   * each bucket holds a GQueue of OffscreenTarget, the most recently
+   * released at the head
+   */
 };
 
 enum
@@ -180,6 +397,7 @@ enum
   PROP_USE_FOG,
   PROP_FOG,
   PROP_USE_ALPHA,
+  PROP_USE_ORTHOGRAPHIC,
   PROP_KEY_FOCUS,
   PROP_NO_CLEAR_HINT,
   PROP_ACCEPT_FOCUS
@@ -192,6 +410,8 @@ enum
   ACTIVATE,
   DEACTIVATE,
   DELETE_EVENT,
+  FRAME_STATS,
+  LAYOUT_CHANGED,
 
   LAST_SIGNAL
 };
@@ -201,7 +421,7 @@ static guint stage_signals[LAST_SIGNAL] = { 0, };
 static const ClutterColor default_stage_color = { 255, 255, 255, 255 };
 
 static void _clutter_stage_maybe_finish_queue_redraws (ClutterStage *stage);
-static void free_queue_redraw_entry (ClutterStageQueueRedrawEntry *entry);
+static void clear_queue_redraw_entry (QueueRedrawEntry *entry);
 
 static void
 clutter_stage_get_preferred_width (ClutterActor *self,
@@ -245,6 +465,19 @@ clutter_stage_get_preferred_height (ClutterActor *self,
     *natural_height_p = geom.height;
 }
 
+/* adds a redraw clip to the window of @stage, and records that the
+ * next redraw will change something on screen; a @clip of %NULL means
+ * a redraw of the whole stage
+ */
+static inline void
+clutter_stage_add_redraw_clip (ClutterStage          *stage,
+                               cairo_rectangle_int_t *clip)
+{
+  stage->priv->redraw_damaged = TRUE;
+
+  _clutter_stage_window_add_redraw_clip (stage->priv->impl, clip);
+}
+
 static inline void
 queue_full_redraw (ClutterStage *stage)
 {
@@ -263,7 +496,7 @@ queue_full_redraw (ClutterStage *stage)
   if (stage_window == NULL)
     return;
 
-  _clutter_stage_window_add_redraw_clip (stage_window, NULL);
+  clutter_stage_add_redraw_clip (stage, NULL);
 }
 
 static void
@@ -529,6 +762,243 @@ _clutter_stage_update_active_framebuffer (ClutterStage *stage)
  * allow us to avoid projecting actors into window coordinates to
  * be able to cull them.
  */
+static guint
+offscreen_pool_key_hash (gconstpointer data)
+{
+  const OffscreenPoolKey *key = data;
+
+  return (key->width * 31 + key->height) * 31 + key->format;
+}
+
+static gboolean
+offscreen_pool_key_equal (gconstpointer a,
+                          gconstpointer b)
+{
+  const OffscreenPoolKey *key_a = a;
+  const OffscreenPoolKey *key_b = b;
+
+  return key_a->width == key_b->width &&
+         key_a->height == key_b->height &&
+         key_a->format == key_b->format;
+}
+
+static void
+offscreen_target_free (gpointer data)
+{
+  OffscreenTarget *target = data;
+
+  cogl_handle_unref (target->offscreen);
+  cogl_handle_unref (target->texture);
+
+  g_slice_free (OffscreenTarget, target);
+}
+
+static void
+offscreen_pool_bucket_free (gpointer data)
+{
+  g_queue_free_full (data, offscreen_target_free);
+}
+
+static void
+offscreen_pool_key_free (gpointer data)
+{
+  g_slice_free (OffscreenPoolKey, data);
+}
+
+/*< private >
+ * _clutter_stage_acquire_offscreen:
+ * @stage: a #ClutterStage
+ * @width: the width of the target
+ * @height: the height of the target
+ * @format: the pixel format of the target
+ * @texture: (out): return location for the texture of the target
+ * @offscreen: (out): return location for the offscreen framebuffer
+ *   rendering to @texture
+ *
+ * Retrieves an offscreen target with the given size and format, re-using
+ * a target released with _clutter_stage_release_offscreen() by any stage,
+ * if any, or creating a new one. The caller owns a reference on both @texture and
+ * @offscreen until it releases the target.
+ *
+ * Return value: %TRUE if a target was available
+ */
+gboolean
+_clutter_stage_acquire_offscreen (ClutterStage    *stage,
+                                  int              width,
+                                  int              height,
+                                  CoglPixelFormat  format,
+                                  CoglHandle      *texture,
+                                  CoglHandle      *offscreen)
+{
+  OffscreenPoolKey key = { width, height, format };
+  CoglError *error = NULL;
+  GQueue *bucket;
+
+  bucket = g_hash_table_lookup (offscreen_pool, &key);
+  if (bucket != NULL && !g_queue_is_empty (bucket))
+    {
+      OffscreenTarget *target = g_queue_pop_head (bucket);
+
+      CLUTTER_NOTE (PAINT, "Re-using offscreen target of %dx%d from the pool",
+                    width, height);
+
+      *texture = target->texture;
+      *offscreen = target->offscreen;
+
+      g_slice_free (OffscreenTarget, target);
+
+      return TRUE;
+    }
+
+  *texture = cogl_texture_new_with_size (width, height,
+                                         COGL_TEXTURE_NO_SLICING,
+                                         format);
+  if (!cogl_texture_allocate (*texture, &error))
+    {
+#if CLUTTER_ENABLE_DEBUG
+      g_warning ("Unable to allocate texture for offscreen target: %s", error->message);
+#endif /* CLUTTER_ENABLE_DEBUG */
+      cogl_error_free (error);
+      cogl_handle_unref (*texture);
+      *texture = NULL;
+      *offscreen = NULL;
+      return FALSE;
+    }
+
+  *offscreen = cogl_offscreen_new_to_texture (*texture);
+  if (*offscreen == NULL)
+    {
+      cogl_handle_unref (*texture);
+      *texture = NULL;
+      return FALSE;
+    }
+
+  _clutter_memory_track_texture (CLUTTER_MEMORY_OFFSCREEN_TARGETS, *texture);
+
+  return TRUE;
+}
+
+/*< private >
+ * _clutter_stage_release_offscreen:
+ * @stage: a #ClutterStage
+ * @format: the pixel format used to acquire the target
+ * @texture: the texture of the target
+ * @offscreen: the offscreen framebuffer of the target
+ *
+ * Returns a target retrieved using _clutter_stage_acquire_offscreen()
+ * to the pool shared by all the stages, transferring the references on
+ * @texture and @offscreen. The target can be re-used by another actor,
+ * on any stage, painted in a following frame or later in the same frame,
+ * and it is released if it stays idle for too many frames.
+ */
+void
+_clutter_stage_release_offscreen (ClutterStage    *stage,
+                                  CoglPixelFormat  format,
+                                  CoglHandle       texture,
+                                  CoglHandle       offscreen)
+{
+  OffscreenPoolKey key;
+  OffscreenTarget *target;
+  GQueue *bucket;
+
+  key.width = cogl_texture_get_width (texture);
+  key.height = cogl_texture_get_height (texture);
+  key.format = format;
+
+  bucket = g_hash_table_lookup (offscreen_pool, &key);
+  if (bucket == NULL)
+    {
+      OffscreenPoolKey *bucket_key = g_slice_dup (OffscreenPoolKey, &key);
+
+      bucket = g_queue_new ();
+      g_hash_table_insert (offscreen_pool, bucket_key, bucket);
+    }
+
+  target = g_slice_new (OffscreenTarget);
+  target->texture = texture;
+  target->offscreen = offscreen;
+  target->release_frame = offscreen_pool_frame;
+
+  g_queue_push_head (bucket, target);
+}
+
+static gboolean
+offscreen_pool_expire_bucket (gpointer key,
+                              gpointer value,
+                              gpointer data)
+{
+  GQueue *bucket = value;
+  guint64 frame = *(guint64 *) data;
+  OffscreenTarget *target;
+
+  /* the least recently released targets are at the tail */
+  while ((target = g_queue_peek_tail (bucket)) != NULL &&
+         frame - target->release_frame > OFFSCREEN_POOL_MAX_AGE)
+    {
+      g_queue_pop_tail (bucket);
+      offscreen_target_free (target);
+    }
+
+  return g_queue_is_empty (bucket);
+}
+
+/*< private >
+ * _clutter_stage_expire_offscreen_pool:
+ *
+ * Releases the offscreen targets that have been idle for too many
+ * frames; this should be called once per frame, after all the stages
+ * have been updated, so that the age of the targets does not depend
+ * on the number of stages.
+ */
+void
+_clutter_stage_expire_offscreen_pool (void)
+{
+  if (offscreen_pool == NULL)
+    return;
+
+  offscreen_pool_frame += 1;
+
+  g_hash_table_foreach_remove (offscreen_pool,
+                               offscreen_pool_expire_bucket,
+                               &offscreen_pool_frame);
+}
+
+static void
+clutter_stage_purge_caches (gpointer          instance,
+                            ClutterPurgeLevel level)
+{
+  ClutterStagePrivate *priv = CLUTTER_STAGE (instance)->priv;
+
+  /* the targets in the pool and the pixel buffers of the asynchronous
+   * picks are not in use, so they can always be released
+   */
+  if (offscreen_pool != NULL)
+    g_hash_table_remove_all (offscreen_pool);
+
+  g_slist_free_full (priv->async_pick_bitmaps, cogl_object_unref);
+  priv->async_pick_bitmaps = NULL;
+}
+
+/* walks the scene to find the opaque actors; each computation uses a
+ * new serial, so that the paint order stored by the actors during a
+ * previous one does not match any more
+ */
+static void
+clutter_stage_compute_occlusion (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  priv->occlusion.serial += 1;
+
+  if (G_LIKELY (!(clutter_paint_debug_flags & CLUTTER_DEBUG_DISABLE_CULLING)))
+    _clutter_actor_compute_occlusion (CLUTTER_ACTOR (stage),
+                                      &priv->projection,
+                                      priv->viewport,
+                                      &priv->occlusion);
+  else
+    priv->occlusion.n_occluders = 0;
+}
+
 void
 _clutter_stage_do_paint (ClutterStage                *stage,
                          const cairo_rectangle_int_t *clip)
@@ -575,9 +1045,54 @@ _clutter_stage_do_paint (ClutterStage                *stage,
                                              &priv->inverse_projection,
                                              priv->current_clip_planes);
 
+  /* the occluders are computed once by clutter_stage_do_redraw() for
+   * all the redraw clips of a frame; other paints compute their own
+   */
+  if (_clutter_context_get_pick_mode () != CLUTTER_PICK_NONE)
+    {
+      priv->occlusion.serial += 1;
+      priv->occlusion.n_occluders = 0;
+    }
+  else if (!priv->occlusion_computed)
+    clutter_stage_compute_occlusion (stage);
+
   _clutter_stage_paint_volume_stack_free_all (stage);
   _clutter_stage_update_active_framebuffer (stage);
   clutter_actor_paint (CLUTTER_ACTOR (stage));
+
+  /* the silhouettes of the actors are drawn at once */
+  _clutter_actor_flush_pick_batch ();
+
+  if (_clutter_context_get_pick_mode () == CLUTTER_PICK_NONE)
+    {
+      if (priv->hud != NULL)
+        _clutter_stage_hud_paint (priv->hud, stage, clip);
+    }
+}
+
+/* Returns TRUE if an opaque actor, like a fullscreen video or client
+ * surface, covers the whole viewport; in that case clearing the color
+ * buffer would be an additional fullscreen fill that is overwritten
+ * by the same frame
+ */
+static gboolean
+clutter_stage_is_fully_occluded (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  guint i;
+
+  for (i = 0; i < priv->occlusion.n_occluders; i++)
+    {
+      const ClutterActorBox *box = &priv->occlusion.occluders[i].box;
+
+      if (box->x1 <= priv->viewport[0] &&
+          box->y1 <= priv->viewport[1] &&
+          box->x2 >= priv->viewport[0] + priv->viewport[2] &&
+          box->y2 >= priv->viewport[1] + priv->viewport[3])
+        return TRUE;
+    }
+
+  return FALSE;
 }
 
 static void
@@ -606,7 +1121,8 @@ clutter_stage_paint (ClutterActor *self)
              / 255;
 
   clear_flags = COGL_BUFFER_BIT_DEPTH;
-  if (!STAGE_NO_CLEAR_ON_PAINT (self))
+  if (!STAGE_NO_CLEAR_ON_PAINT (self) &&
+      !clutter_stage_is_fully_occluded (CLUTTER_STAGE (self)))
     clear_flags |= COGL_BUFFER_BIT_COLOR;
 
   CLUTTER_TIMER_START (_clutter_uprof_context, stage_clear_timer);
@@ -821,33 +1337,12 @@ clutter_stage_real_fullscreen (ClutterStage *stage)
                           CLUTTER_ALLOCATION_NONE);
 }
 
-void
-_clutter_stage_queue_event (ClutterStage *stage,
-			    ClutterEvent *event)
+static void
+clutter_stage_update_event_device (ClutterStage       *stage,
+                                   const ClutterEvent *event)
 {
-  ClutterStagePrivate *priv;
-  gboolean first_event;
   ClutterInputDevice *device;
 
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
-
-  priv = stage->priv;
-
-  first_event = priv->event_queue->length == 0;
-
-  g_queue_push_tail (priv->event_queue, clutter_event_copy (event));
-
-  if (first_event)
-    {
-      ClutterMasterClock *master_clock = _clutter_master_clock_get_default ();
-      _clutter_master_clock_start_running (master_clock);
-      _clutter_stage_schedule_update (stage);
-    }
-
-  /* if needed, update the state of the input device of the event.
-   * we do it here to avoid calling the same code from every backend
-   * event processing function
-   */
   device = clutter_event_get_device (event);
   if (device != NULL)
     {
@@ -864,40 +1359,513 @@ _clutter_stage_queue_event (ClutterStage *stage,
     }
 }
 
-gboolean
-_clutter_stage_has_queued_events (ClutterStage *stage)
+/* returns the next event of the ring, or %NULL if the producer of the
+ * event at the tail has not finished writing it yet; this must only
+ * be called by the main thread
+ */
+static ClutterEvent *
+clutter_stage_pop_ring_event (ClutterStage *stage)
 {
-  ClutterStagePrivate *priv;
+  EventRing *ring = stage->priv->event_ring;
+  EventRingSlot *slot;
+  ClutterEvent *event;
+  guint pos;
 
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  pos = (guint) ring->tail;
+  slot = &ring->slots[pos & EVENT_RING_MASK];
 
-  priv = stage->priv;
+  if (g_atomic_int_get (&slot->sequence) != (gint) (pos + 1))
+    return NULL;
+
+  /* the event owns the pointers of the record, like the axes */
+  event = clutter_event_new (slot->event.type);
+  *event = slot->event;
+  _clutter_event_set_origin_time (event, slot->origin_time);
+
+  /* hand the slot back to the producers, for the next lap */
+  g_atomic_int_set (&slot->sequence, (gint) (pos + EVENT_RING_SIZE));
+  ring->tail = (gint) (pos + 1);
+
+  return event;
+}
+
+static void
+clutter_stage_drain_event_ring (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterEvent *event;
+
+  while ((event = clutter_stage_pop_ring_event (stage)) != NULL)
+    {
+      if (G_UNLIKELY (_clutter_event_recording))
+        _clutter_event_record (event);
+
+      g_queue_push_tail (priv->event_queue, event);
+      clutter_stage_update_event_device (stage, event);
+    }
+}
+
+static gboolean
+clutter_stage_event_ring_wakeup (gpointer data)
+{
+  ClutterStage *stage = data;
+  ClutterMasterClock *master_clock;
+
+  /* clear the flag first, so that a new event pushed while we are
+   * running will schedule another wakeup
+   */
+  g_atomic_int_set (&stage->priv->event_ring->wakeup_pending, FALSE);
+
+  master_clock = _clutter_master_clock_get_default ();
+  _clutter_master_clock_start_running (master_clock);
+  _clutter_stage_schedule_update (stage);
 
-  return priv->event_queue->length > 0;
+  return FALSE;
 }
 
 void
-_clutter_stage_process_queued_events (ClutterStage *stage)
+_clutter_stage_queue_event (ClutterStage *stage,
+			    ClutterEvent *event,
+			    gboolean      copy_event)
 {
   ClutterStagePrivate *priv;
-  GList *events, *l;
+  gboolean first_event;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
   priv = stage->priv;
 
-  if (priv->event_queue->length == 0)
-    return;
+  /* the events pushed in the ring happened before this one */
+  clutter_stage_drain_event_ring (stage);
 
-  /* In case the stage gets destroyed during event processing */
-  g_object_ref (stage);
+  first_event = priv->event_queue->length == 0;
 
-  /* Steal events before starting processing to avoid reentrancy
-   * issues */
-  events = priv->event_queue->head;
-  priv->event_queue->head =  NULL;
-  priv->event_queue->tail = NULL;
-  priv->event_queue->length = 0;
+  /* if we don't copy the event, the queue takes ownership of it */
+  if (copy_event)
+    event = clutter_event_copy (event);
+
+  /* events without a time from the input device are measured from
+   * the moment they reach the stage
+   */
+  if (_clutter_event_get_origin_time (event) == 0)
+    _clutter_event_set_origin_time (event, g_get_monotonic_time ());
+
+  if (G_UNLIKELY (_clutter_event_recording))
+    _clutter_event_record (event);
+
+  g_queue_push_tail (priv->event_queue, event);
+
+  if (first_event)
+    {
+      ClutterMasterClock *master_clock = _clutter_master_clock_get_default ();
+      _clutter_master_clock_start_running (master_clock);
+      _clutter_stage_schedule_update (stage);
+    }
+
+  /* if needed, update the state of the input device of the event.
+   * we do it here to avoid calling the same code from every backend
+   * event processing function
+   */
+  clutter_stage_update_event_device (stage, event);
+}
+
+/*< private >
+ * _clutter_stage_push_event:
+ * @stage: a #ClutterStage
+ * @event: the event to queue
+ * @origin_time: the monotonic time at which the input device generated
+ *   the event, in microseconds, or 0 to use the current time
+ *
+ * Queues a copy of @event on @stage without taking the Clutter lock.
+ *
+ * Unlike _clutter_stage_queue_event(), this function can be called
+ * by any thread, and by more than one thread at the same time; the
+ * events are stored in a bounded lock-free ring, which is drained by
+ * the main thread when processing the queued events of the frame.
+ *
+ * Only the public fields of @event are copied; the stage takes
+ * ownership of the pointers in them, like the axes, if the function
+ * returns %TRUE. The state of the input device of the event is
+ * updated when the event is moved from the ring to the event queue.
+ *
+ * Return value: %TRUE if the event was queued, and %FALSE if the
+ *   ring is full; a caller running on the main thread can fall
+ *   back to _clutter_stage_queue_event() in that case, which keeps
+ *   the order of the events
+ */
+gboolean
+_clutter_stage_push_event (ClutterStage       *stage,
+                           const ClutterEvent *event,
+                           gint64              origin_time)
+{
+  EventRing *ring;
+  EventRingSlot *slot;
+  gint pos;
+
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  g_return_val_if_fail (event != NULL, FALSE);
+
+  ring = stage->priv->event_ring;
+
+  /* claim a slot: it is free for the position we read if its
+   * sequence is the same as the position; if it is behind, the
+   * main thread has not drained it in the previous lap yet
+   */
+  pos = g_atomic_int_get (&ring->head);
+  while (TRUE)
+    {
+      gint diff;
+
+      slot = &ring->slots[(guint) pos & EVENT_RING_MASK];
+      diff = (gint) ((guint) g_atomic_int_get (&slot->sequence) - (guint) pos);
+
+      if (diff == 0)
+        {
+          if (g_atomic_int_compare_and_exchange (&ring->head,
+                                                 pos,
+                                                 (gint) ((guint) pos + 1)))
+            break;
+        }
+      else if (diff < 0)
+        return FALSE;
+
+      /* another producer claimed the slot before us */
+      pos = g_atomic_int_get (&ring->head);
+    }
+
+  slot->event = *event;
+  slot->origin_time = origin_time != 0 ? origin_time : g_get_monotonic_time ();
+
+  /* publish the record to the main thread */
+  g_atomic_int_set (&slot->sequence, (gint) ((guint) pos + 1));
+
+  if (g_atomic_int_compare_and_exchange (&ring->wakeup_pending, FALSE, TRUE))
+    {
+      clutter_threads_add_idle_full (CLUTTER_PRIORITY_EVENTS,
+                                     clutter_stage_event_ring_wakeup,
+                                     g_object_ref (stage),
+                                     g_object_unref);
+    }
+
+  return TRUE;
+}
+
+/*< private >
+ * _clutter_stage_take_input_time:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves the origin time of the oldest event processed by @stage
+ * since the previous call, and resets it.
+ *
+ * The stage implementations call this function when presenting a new
+ * frame, and then report the time between the returned value and the
+ * presentation of the frame using _clutter_stage_report_input_latency().
+ *
+ * Return value: the monotonic time, in microseconds, or 0 if no event
+ *   has been processed
+ */
+gint64
+_clutter_stage_take_input_time (ClutterStage *stage)
+{
+  gint64 retval;
+
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), 0);
+
+  retval = stage->priv->pending_input_time;
+  stage->priv->pending_input_time = 0;
+
+  return retval;
+}
+
+/* the histogram has one bucket per millisecond, plus one for the
+ * frames above the last one
+ */
+#define INPUT_LATENCY_BUCKETS   100
+
+static void
+clutter_stage_dump_input_latency (ClutterStage *stage)
+{
+  guint *histogram = stage->priv->input_latency_histogram;
+  guint i, total = 0;
+
+  for (i = 0; i <= INPUT_LATENCY_BUCKETS; i++)
+    total += histogram[i];
+
+  if (total == 0)
+    return;
+
+  g_print ("Input latency for stage '%s'[%p] (%u frames):\n",
+           _clutter_actor_get_debug_name (CLUTTER_ACTOR (stage)),
+           stage,
+           total);
+
+  for (i = 0; i < INPUT_LATENCY_BUCKETS; i++)
+    {
+      if (histogram[i] != 0)
+        g_print ("  %3u ms: %u\n", i, histogram[i]);
+    }
+
+  if (histogram[INPUT_LATENCY_BUCKETS] != 0)
+    g_print (" >%3u ms: %u\n",
+             INPUT_LATENCY_BUCKETS - 1,
+             histogram[INPUT_LATENCY_BUCKETS]);
+}
+
+/*< private >
+ * _clutter_stage_report_input_latency:
+ * @stage: a #ClutterStage
+ * @latency: the time between the oldest input event of a frame and
+ *   the presentation of the frame, in microseconds
+ *
+ * Records the input latency of a frame presented by @stage.
+ */
+void
+_clutter_stage_report_input_latency (ClutterStage *stage,
+                                     gint64        latency)
+{
+  ClutterStagePrivate *priv;
+  gint64 refresh_interval;
+
+  CLUTTER_STATIC_COUNTER (input_frames_counter,
+                          "Input frames",
+                          "Increments for each frame presenting input events",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (input_late_counter,
+                          "Input frames over one refresh",
+                          "Increments for each frame presenting input events more than one refresh interval after they happened",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (input_very_late_counter,
+                          "Input frames over two refreshes",
+                          "Increments for each frame presenting input events more than two refresh intervals after they happened",
+                          0 /* no application private data */);
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+  if (latency < 0)
+    latency = 0;
+
+  CLUTTER_NOTE (EVENT, "Input latency: %" G_GINT64_FORMAT " us", latency);
+
+  refresh_interval = _clutter_stage_get_refresh_interval (stage);
+
+  CLUTTER_COUNTER_INC (_clutter_uprof_context, input_frames_counter);
+
+  if (refresh_interval > 0 && latency > refresh_interval)
+    {
+      CLUTTER_COUNTER_INC (_clutter_uprof_context, input_late_counter);
+
+      if (latency > 2 * refresh_interval)
+        CLUTTER_COUNTER_INC (_clutter_uprof_context, input_very_late_counter);
+    }
+
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_INPUT_LATENCY))
+    {
+      gint64 bucket = latency / 1000;
+
+      if (priv->input_latency_histogram == NULL)
+        priv->input_latency_histogram = g_new0 (guint, INPUT_LATENCY_BUCKETS + 1);
+
+      priv->input_latency_histogram[MIN (bucket, INPUT_LATENCY_BUCKETS)] += 1;
+    }
+}
+
+/*< private >
+ * _clutter_stage_get_collect_frame_stats:
+ * @stage: a #ClutterStage
+ *
+ * Checks whether the duration of the phases of the current frame
+ * is being measured.
+ *
+ * Return value: %TRUE if the frame statistics should be reported
+ */
+gboolean
+_clutter_stage_get_collect_frame_stats (ClutterStage *stage)
+{
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+
+  return stage->priv->collect_frame_stats;
+}
+
+/*< private >
+ * _clutter_stage_report_swap_wait_time:
+ * @stage: a #ClutterStage
+ * @duration: the time spent presenting the frame, in microseconds
+ *
+ * Used by the stage implementations to report the time spent
+ * swapping the buffers of the current frame.
+ */
+void
+_clutter_stage_report_swap_wait_time (ClutterStage *stage,
+                                      gint64        duration)
+{
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  if (stage->priv->collect_frame_stats)
+    stage->priv->frame_stats.swap_wait_time += duration;
+}
+
+/*< private >
+ * _clutter_stage_begin_gpu_timer:
+ * @stage: a #ClutterStage
+ *
+ * Used by the stage implementations to mark the beginning of the
+ * GPU commands of the current frame, if the frame is being measured.
+ * The GL context of @stage must be current.
+ */
+void
+_clutter_stage_begin_gpu_timer (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+  if (!priv->collect_frame_stats)
+    return;
+
+  if (!priv->gpu_timer_checked)
+    {
+      priv->gpu_timer = _clutter_gpu_timer_new ();
+      priv->gpu_timer_checked = TRUE;
+    }
+
+  if (priv->gpu_timer != NULL)
+    _clutter_gpu_timer_begin (priv->gpu_timer);
+}
+
+/*< private >
+ * _clutter_stage_end_gpu_timer:
+ * @stage: a #ClutterStage
+ *
+ * Used by the stage implementations to mark the end of the GPU
+ * commands of the current frame, before presenting it. The GPU time
+ * reported is the one of the most recent frame the GPU completed.
+ */
+void
+_clutter_stage_end_gpu_timer (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+  if (!priv->collect_frame_stats || priv->gpu_timer == NULL)
+    return;
+
+  _clutter_gpu_timer_end (priv->gpu_timer);
+
+  priv->frame_stats.gpu_time = _clutter_gpu_timer_get_time (priv->gpu_timer);
+}
+
+/*< private >
+ * _clutter_stage_emit_frame_stats:
+ * @stage: a #ClutterStage
+ * @frame_time: the time at which the frame started
+ * @events_time: the time spent processing the events
+ * @timelines_time: the time spent advancing the timelines
+ *
+ * Emits the #ClutterStage::frame-stats signal at the end of a frame,
+ * if @stage was painted during the frame.
+ */
+void
+_clutter_stage_emit_frame_stats (ClutterStage *stage,
+                                 gint64        frame_time,
+                                 gint64        events_time,
+                                 gint64        timelines_time)
+{
+  ClutterStagePrivate *priv;
+  ClutterFrameStats stats;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+  if (!priv->frame_stats_pending)
+    return;
+
+  priv->frame_stats_pending = FALSE;
+
+  stats = priv->frame_stats;
+  stats.frame_time = frame_time;
+  stats.events_time = events_time;
+  stats.timelines_time = timelines_time;
+
+  if (priv->hud != NULL)
+    {
+      cairo_rectangle_int_t area;
+
+      _clutter_stage_hud_add_frame (priv->hud, stage, &stats);
+
+      /* the HUD changes with every frame, so include it in the next one */
+      _clutter_stage_hud_get_area (priv->hud, &area);
+      if (priv->impl != NULL)
+        clutter_stage_add_redraw_clip (stage, &area);
+    }
+
+  g_signal_emit (stage, stage_signals[FRAME_STATS], 0, &stats);
+}
+
+gboolean
+_clutter_stage_has_queued_events (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv;
+  EventRingSlot *slot;
+
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+
+  priv = stage->priv;
+
+  if (priv->event_queue->length > 0)
+    return TRUE;
+
+  slot = &priv->event_ring->slots[(guint) priv->event_ring->tail & EVENT_RING_MASK];
+
+  return g_atomic_int_get (&slot->sequence) == (gint) ((guint) priv->event_ring->tail + 1);
+}
+
+void
+_clutter_stage_process_queued_events (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv;
+  GList *events, *l;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+  /* the asynchronous picks queued during the previous iteration of
+   * the master clock have been flushed, and should be ready by now, so we can update the devices before delivering
+   * the new events
+   */
+  if (priv->async_picks != NULL)
+    clutter_stage_resolve_async_picks (stage);
+
+  if (priv->captures != NULL)
+    clutter_stage_resolve_captures (stage);
+
+  clutter_stage_drain_event_ring (stage);
+
+  if (priv->event_queue->length == 0)
+    return;
+
+  /* In case the stage gets destroyed during event processing */
+  g_object_ref (stage);
+
+  /* Steal events before starting processing to avoid reentrancy
+   * issues */
+  events = priv->event_queue->head;
+  priv->event_queue->head =  NULL;
+  priv->event_queue->tail = NULL;
+  priv->event_queue->length = 0;
+
+  /* Pick all the pointer and touch positions at once, instead of
+   * rendering the scene in pick mode for each event
+   */
+  clutter_stage_prefetch_picks (stage, events);
 
   for (l = events; l != NULL; l = l->next)
     {
@@ -906,10 +1874,20 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
       ClutterInputDevice *device;
       ClutterInputDevice *next_device;
       gboolean check_device = FALSE;
+      gint64 origin_time;
 
       event = l->data;
       next_event = l->next ? l->next->data : NULL;
 
+      /* the compressed events count too, since their effects are
+       * only visible in the same frame as the following event
+       */
+      origin_time = _clutter_event_get_origin_time (event);
+      if (origin_time != 0 &&
+          (priv->pending_input_time == 0 ||
+           origin_time < priv->pending_input_time))
+        priv->pending_input_time = origin_time;
+
       device = clutter_event_get_device (event);
 
       if (next_event != NULL)
@@ -932,6 +1910,10 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
                             "Omitting motion event at %d, %d",
                             (int) event->motion.x,
                             (int) event->motion.y);
+
+              if (next_event->type == CLUTTER_MOTION)
+                _clutter_event_merge_history (next_event, event);
+
               goto next_event;
             }
           else if (event->type == CLUTTER_TOUCH_UPDATE &&
@@ -943,6 +1925,11 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
                             "Omitting touch update event at %d, %d",
                             (int) event->touch.x,
                             (int) event->touch.y);
+
+              if (next_event->type == CLUTTER_TOUCH_UPDATE &&
+                  next_event->touch.sequence == event->touch.sequence)
+                _clutter_event_merge_history (next_event, event);
+
               goto next_event;
             }
         }
@@ -955,6 +1942,8 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
 
   g_list_free (events);
 
+  clutter_stage_clear_pick_prefetch (stage);
+
   g_object_unref (stage);
 }
 
@@ -964,6 +1953,9 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
  *
  * Determines if _clutter_stage_do_update() needs to be called.
  *
+ * Offscreen stages are only updated by clutter_stage_render_frame(),
+ * so they never need an update from the master clock.
+ *
  * Return value: %TRUE if the stage need layout or painting
  */
 gboolean
@@ -975,6 +1967,9 @@ _clutter_stage_needs_update (ClutterStage *stage)
 
   priv = stage->priv;
 
+  if (priv->is_offscreen)
+    return FALSE;
+
   return priv->relayout_pending || priv->redraw_pending;
 }
 
@@ -997,13 +1992,41 @@ _clutter_stage_maybe_relayout (ClutterActor *actor)
   /* avoid reentrancy */
   if (!CLUTTER_ACTOR_IN_RELAYOUT (stage))
     {
-      priv->relayout_pending = FALSE;
+      GPtrArray *size_relayouts;
+      guint allocation_serial;
+      guint i;
 
       CLUTTER_TIMER_START (_clutter_uprof_context, relayout_timer);
+      CLUTTER_TRACE_BEGIN ("Relayout");
+
+      /* the actors whose size requests did not change can be allocated
+       * again in place, without a relayout of their ancestors; the
+       * others queue a relayout, so we need to check them before
+       * resetting the relayout_pending flag
+       */
+      size_relayouts = priv->pending_size_relayouts;
+      priv->pending_size_relayouts = NULL;
+
+      if (size_relayouts != NULL)
+        {
+          i = size_relayouts->len;
+          while (i-- > 0)
+            {
+              ClutterActor *child = g_ptr_array_index (size_relayouts, i);
+
+              if (!_clutter_actor_check_size_relayout (child))
+                g_ptr_array_remove_index_fast (size_relayouts, i);
+            }
+        }
+
+      priv->relayout_pending = FALSE;
+
       CLUTTER_NOTE (ACTOR, "Recomputing layout");
 
       CLUTTER_SET_PRIVATE_FLAGS (stage, CLUTTER_IN_RELAYOUT);
 
+      allocation_serial = _clutter_actor_get_allocation_serial ();
+
       natural_width = natural_height = 0;
       clutter_actor_get_preferred_size (CLUTTER_ACTOR (stage),
                                         NULL, NULL,
@@ -1021,19 +2044,47 @@ _clutter_stage_maybe_relayout (ClutterActor *actor)
       clutter_actor_allocate (CLUTTER_ACTOR (stage),
                               &box, CLUTTER_ALLOCATION_NONE);
 
+      if (size_relayouts != NULL)
+        {
+          for (i = 0; i < size_relayouts->len; i++)
+            _clutter_actor_reallocate (g_ptr_array_index (size_relayouts, i));
+
+          g_ptr_array_unref (size_relayouts);
+        }
+
+      clutter_stage_solve_constraints (stage);
+
       CLUTTER_UNSET_PRIVATE_FLAGS (stage, CLUTTER_IN_RELAYOUT);
+      CLUTTER_TRACE_END ();
       CLUTTER_TIMER_STOP (_clutter_uprof_context, relayout_timer);
+
+      if (allocation_serial != _clutter_actor_get_allocation_serial ())
+        g_signal_emit (stage, stage_signals[LAYOUT_CHANGED], 0);
     }
 }
 
-static gboolean
-_clutter_stage_get_pick_buffer_valid (ClutterStage *stage, ClutterPickMode mode)
+static inline guint
+clutter_stage_get_pick_generation (ClutterStage    *stage,
+                                   ClutterPickMode  mode)
 {
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  if (mode == CLUTTER_PICK_REACTIVE)
+    return stage->priv->pick_generation_reactive;
+
+  return stage->priv->pick_generation_all;
+}
+
+static gboolean
+_clutter_stage_get_pick_buffer_valid (ClutterStage *stage, ClutterPickMode mode)
+{
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
   if (stage->priv->pick_buffer_mode != mode)
     return FALSE;
 
+  if (stage->priv->pick_buffer_generation !=
+      clutter_stage_get_pick_generation (stage, mode))
+    return FALSE;
+
   return stage->priv->have_valid_pick_buffer;
 }
 
@@ -1046,6 +2097,19 @@ _clutter_stage_set_pick_buffer_valid (ClutterStage   *stage,
 
   stage->priv->have_valid_pick_buffer = !!valid;
   stage->priv->pick_buffer_mode = mode;
+  stage->priv->pick_buffer_generation =
+    clutter_stage_get_pick_generation (stage, mode);
+}
+
+static void
+mark_capture_submitted (gpointer data,
+                        gpointer user_data G_GNUC_UNUSED)
+{
+  StageCapture *capture = data;
+
+  /* captures queued while painting the frame are read by the next one */
+  if (capture->bitmap != NULL)
+    capture->submitted = TRUE;
 }
 
 static void
@@ -1075,6 +2139,7 @@ clutter_stage_do_redraw (ClutterStage *stage)
                 _clutter_actor_get_debug_name (actor),
                 stage);
 
+  /* the pick buffer is going to be overwritten */
   _clutter_stage_set_pick_buffer_valid (stage, FALSE, -1);
   priv->picks_per_frame = 0;
 
@@ -1090,9 +2155,33 @@ clutter_stage_do_redraw (ClutterStage *stage)
 
   CLUTTER_COUNTER_INC (_clutter_uprof_context, redraw_counter);
   CLUTTER_TIMER_START (_clutter_uprof_context, redraw_timer);
+  CLUTTER_TRACE_BEGIN ("Redraw");
+
+  /* every reactive actor painted in this frame will update its entry
+   * in the pick index, and the sub-trees that are skipped will
+   * invalidate it; a clipped redraw only reaches part of the scene,
+   * so only a full redraw can make the pick index complete again
+   */
+  if (!_clutter_stage_window_has_redraw_clips (priv->impl))
+    priv->pick_index_complete = TRUE;
+  priv->pick_index_generation = priv->pick_generation_reactive;
+
+  /* the occluders only depend on the scene, so they are shared by all
+   * the redraw clips painted by the stage window
+   */
+  clutter_stage_compute_occlusion (stage);
+  priv->occlusion_computed = TRUE;
 
   _clutter_stage_window_redraw (priv->impl);
 
+  priv->occlusion_computed = FALSE;
+
+  /* the pending captures have been flushed together with the frame,
+   * and can be read back by the next frame
+   */
+  g_list_foreach (priv->captures, mark_capture_submitted, NULL);
+
+  CLUTTER_TRACE_END ();
   CLUTTER_TIMER_STOP (_clutter_uprof_context, redraw_timer);
 
   if (_clutter_context_get_show_fps ())
@@ -1115,18 +2204,22 @@ clutter_stage_do_redraw (ClutterStage *stage)
                 stage);
 }
 
-/**
- * _clutter_stage_do_update:
+/*< private >
+ * _clutter_stage_do_layout:
  * @stage: A #ClutterStage
  *
- * Handles per-frame layout and repaint for the stage.
+ * Handles the per-frame layout of the stage; this is the first half of
+ * _clutter_stage_do_update(), and it does not need the GL context of
+ * the stage.
  *
- * Return value: %TRUE if the stage was updated
+ * Return value: %TRUE if the stage should be repainted using
+ *   _clutter_stage_do_repaint()
  */
 gboolean
-_clutter_stage_do_update (ClutterStage *stage)
+_clutter_stage_do_layout (ClutterStage *stage)
 {
   ClutterStagePrivate *priv = stage->priv;
+  gint64 frame_start = 0;
 
   /* if the stage is being destroyed, or if the destruction already
    * happened and we don't have an StageWindow any more, then we
@@ -1138,21 +2231,91 @@ _clutter_stage_do_update (ClutterStage *stage)
   if (!CLUTTER_ACTOR_IS_REALIZED (stage))
     return FALSE;
 
+  /* measuring the frame is cheap, but not free */
+  priv->collect_frame_stats =
+    priv->hud != NULL ||
+    g_signal_has_handler_pending (stage, stage_signals[FRAME_STATS], 0, FALSE);
+
+  if (priv->collect_frame_stats)
+    {
+      memset (&priv->frame_stats, 0, sizeof (ClutterFrameStats));
+      priv->frame_stats.gpu_time = -1;
+      frame_start = g_get_monotonic_time ();
+    }
+
   /* NB: We need to ensure we have an up to date layout *before* we
    * check or clear the pending redraws flag since a relayout may
    * queue a redraw.
    */
   _clutter_stage_maybe_relayout (CLUTTER_ACTOR (stage));
 
+  if (priv->collect_frame_stats)
+    priv->frame_stats.relayout_time = g_get_monotonic_time () - frame_start;
+
+  return priv->redraw_pending;
+}
+
+/*< private >
+ * _clutter_stage_do_repaint:
+ * @stage: A #ClutterStage
+ *
+ * Handles the per-frame repaint of the stage, after its layout has been
+ * updated by _clutter_stage_do_layout(); this is the second half of
+ * _clutter_stage_do_update().
+ *
+ * Return value: %TRUE if the stage was updated
+ */
+gboolean
+_clutter_stage_do_repaint (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  gint64 paint_start = 0;
+
+  /* other stages might have been painted since the layout */
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (stage) || priv->impl == NULL)
+    return FALSE;
+
+  if (!CLUTTER_ACTOR_IS_REALIZED (stage))
+    return FALSE;
+
   if (!priv->redraw_pending)
     return FALSE;
 
+  if (priv->collect_frame_stats)
+    {
+      paint_start = g_get_monotonic_time ();
+      priv->frame_stats.n_picks = priv->picks_per_frame;
+    }
+
   _clutter_stage_maybe_finish_queue_redraws (stage);
 
+  /* the queued redraws can all resolve to nothing, for instance if the
+   * actors that queued them are outside of the stage; an empty set of
+   * redraw clips would mean a full redraw to the stage window, so we
+   * skip the frame and the swap altogether
+   */
+  if (!priv->redraw_damaged)
+    {
+      CLUTTER_NOTE (PAINT, "Skipping a redraw with no visible changes");
+
+      priv->redraw_pending = FALSE;
+
+      return FALSE;
+    }
+
   clutter_stage_do_redraw (stage);
 
+  if (priv->collect_frame_stats)
+    {
+      priv->frame_stats.paint_time = g_get_monotonic_time ()
+                                   - paint_start
+                                   - priv->frame_stats.swap_wait_time;
+      priv->frame_stats_pending = TRUE;
+    }
+
   /* reset the guard, so that new redraws are possible */
   priv->redraw_pending = FALSE;
+  priv->redraw_damaged = FALSE;
 
 #ifdef CLUTTER_ENABLE_DEBUG
   if (priv->redraw_count > 0)
@@ -1167,6 +2330,23 @@ _clutter_stage_do_update (ClutterStage *stage)
   return TRUE;
 }
 
+/**
+ * _clutter_stage_do_update:
+ * @stage: A #ClutterStage
+ *
+ * Handles per-frame layout and repaint for the stage.
+ *
+ * Return value: %TRUE if the stage was updated
+ */
+gboolean
+_clutter_stage_do_update (ClutterStage *stage)
+{
+  if (!_clutter_stage_do_layout (stage))
+    return FALSE;
+
+  return _clutter_stage_do_repaint (stage);
+}
+
 static void
 clutter_stage_real_queue_relayout (ClutterActor *self)
 {
@@ -1208,7 +2388,7 @@ clutter_stage_real_queue_redraw (ClutterActor *actor,
 
   if (_clutter_stage_window_ignoring_redraw_clips (stage_window))
     {
-      _clutter_stage_window_add_redraw_clip (stage_window, NULL);
+      clutter_stage_add_redraw_clip (stage, NULL);
       return;
     }
 
@@ -1218,7 +2398,7 @@ clutter_stage_real_queue_redraw (ClutterActor *actor,
   redraw_clip = _clutter_actor_get_queue_redraw_clip (leaf);
   if (redraw_clip == NULL)
     {
-      _clutter_stage_window_add_redraw_clip (stage_window, NULL);
+      clutter_stage_add_redraw_clip (stage, NULL);
       return;
     }
 
@@ -1245,7 +2425,7 @@ clutter_stage_real_queue_redraw (ClutterActor *actor,
   stage_clip.width = intersection_box.x2 - stage_clip.x;
   stage_clip.height = intersection_box.y2 - stage_clip.y;
 
-  _clutter_stage_window_add_redraw_clip (stage_window, &stage_clip);
+  clutter_stage_add_redraw_clip (stage, &stage_clip);
 }
 
 gboolean
@@ -1331,1976 +2511,4068 @@ read_pixels_to_file (char *filename_stem,
   read_count++;
 }
 
-ClutterActor *
-_clutter_stage_do_pick (ClutterStage   *stage,
-                        gint            x,
-                        gint            y,
-                        ClutterPickMode mode)
+static gboolean
+_clutter_stage_pick_index_pick (ClutterStage  *stage,
+                                gint           x,
+                                gint           y,
+                                ClutterActor  *ignore,
+                                ClutterActor **actor_p)
 {
-  ClutterStagePrivate *priv;
-  ClutterMainContext *context;
-  guchar pixel[4] = { 0xff, 0xff, 0xff, 0xff };
-  CoglColor stage_pick_id;
-  gboolean dither_enabled_save;
-  CoglFramebuffer *fb;
-  ClutterActor *actor;
-  gboolean is_clipped;
-  gint read_x;
-  gint read_y;
-
-  CLUTTER_STATIC_COUNTER (do_pick_counter,
-                          "_clutter_stage_do_pick counter",
-                          "Increments for each full pick run",
-                          0 /* no application private data */);
-  CLUTTER_STATIC_TIMER (pick_timer,
-                        "Mainloop", /* parent */
-                        "Picking",
-                        "The time spent picking",
-                        0 /* no application private data */);
-  CLUTTER_STATIC_TIMER (pick_clear,
-                        "Picking", /* parent */
-                        "Stage clear (pick)",
-                        "The time spent clearing stage for picking",
-                        0 /* no application private data */);
-  CLUTTER_STATIC_TIMER (pick_paint,
-                        "Picking", /* parent */
-                        "Painting actors (pick mode)",
-                        "The time spent painting actors in pick mode",
-                        0 /* no application private data */);
-  CLUTTER_STATIC_TIMER (pick_read,
-                        "Picking", /* parent */
-                        "Read Pixels",
-                        "The time spent issuing a read pixels",
-                        0 /* no application private data */);
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterGeometryPick geometry_pick = { 0, };
+  ClutterActor *top_actor = NULL;
+  guint i;
 
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
+  /* the index is only updated when painting, so we cannot use it
+   * if the scene changed in a way that affects picking since the
+   * last paint
+   */
+  if (!priv->pick_index_complete ||
+      priv->pick_index_generation != priv->pick_generation_reactive)
+    return FALSE;
 
-  priv = stage->priv;
+  g_ptr_array_set_size (priv->pick_candidates, 0);
+  _clutter_pick_index_query_point (priv->pick_index,
+                                   x + 0.5f, y + 0.5f,
+                                   priv->pick_candidates);
 
-  if (G_UNLIKELY (clutter_pick_debug_flags & CLUTTER_DEBUG_NOP_PICKING))
-    return CLUTTER_ACTOR (stage);
+  CLUTTER_NOTE (PICK, "Pick index: %u candidates out of %u actors",
+                priv->pick_candidates->len,
+                _clutter_pick_index_get_size (priv->pick_index));
 
-#ifdef CLUTTER_ENABLE_PROFILE
-  if (clutter_profile_flags & CLUTTER_PROFILE_PICKING_ONLY)
-    _clutter_profile_resume ();
-#endif /* CLUTTER_ENABLE_PROFILE */
+  geometry_pick.projection = &priv->projection;
+  geometry_pick.viewport = priv->viewport;
+  geometry_pick.mode = CLUTTER_PICK_REACTIVE;
+  geometry_pick.x = x;
+  geometry_pick.y = y;
 
-  CLUTTER_COUNTER_INC (_clutter_uprof_context, do_pick_counter);
-  CLUTTER_TIMER_START (_clutter_uprof_context, pick_timer);
+  for (i = 0; i < priv->pick_candidates->len; i++)
+    {
+      ClutterActor *candidate = g_ptr_array_index (priv->pick_candidates, i);
 
-  context = _clutter_context_get_default ();
-  clutter_stage_ensure_current (stage);
+      if (candidate == ignore)
+        continue;
 
-  /* It's possible that we currently have a static scene and have renderered a
-   * full, unclipped pick buffer. If so we can simply continue to read from
-   * this cached buffer until the scene next changes. */
-  if (_clutter_stage_get_pick_buffer_valid (stage, mode))
-    {
-      CLUTTER_TIMER_START (_clutter_uprof_context, pick_read);
-      cogl_read_pixels (x, y, 1, 1,
-                        COGL_READ_PIXELS_COLOR_BUFFER,
-                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
-                        pixel);
-      CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_read);
+      switch (_clutter_actor_geometry_pick_test (candidate, &geometry_pick))
+        {
+        case CLUTTER_GEOMETRY_PICK_HIT:
+          if (top_actor == NULL ||
+              _clutter_actor_paints_before (top_actor, candidate))
+            top_actor = candidate;
+          break;
 
-      CLUTTER_NOTE (PICK, "Reusing pick buffer from previous render to fetch "
-                    "actor at %i,%i", x, y);
+        case CLUTTER_GEOMETRY_PICK_MISS:
+          break;
 
-      goto check_pixel;
+        case CLUTTER_GEOMETRY_PICK_UNKNOWN:
+          return FALSE;
+        }
     }
 
-  priv->picks_per_frame++;
+  *actor_p = top_actor != NULL ? top_actor : CLUTTER_ACTOR (stage);
 
-  _clutter_backend_ensure_context (context->backend, stage);
+  return TRUE;
+}
 
-  /* needed for when a context switch happens */
-  _clutter_stage_maybe_setup_viewport (stage);
+static gboolean
+clutter_stage_pick_without_render (ClutterStage     *stage,
+                                   gint              x,
+                                   gint              y,
+                                   ClutterPickMode   mode,
+                                   ClutterActor    **actor_p)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterGeometryPick geometry_pick = { 0, };
 
-  /* If we are seeing multiple picks per frame that means the scene is static
-   * so we promote to doing a non-scissored pick render so that all subsequent
-   * picks for the same static scene won't require additional renders */
-  if (priv->picks_per_frame < 2)
+  CLUTTER_STATIC_TIMER (pick_geometry,
+                        "Picking", /* parent */
+                        "Geometric pick",
+                        "The time spent testing actors against the pick point",
+                        0 /* no application private data */);
+
+  /* If the pick index is up to date we only need to check the few
+   * reactive actors whose bounding box contains the point
+   */
+  if (mode == CLUTTER_PICK_REACTIVE &&
+      _clutter_stage_pick_index_pick (stage, x, y, NULL, actor_p))
     {
-       gint dirty_x;
-       gint dirty_y;
+      CLUTTER_NOTE (PICK, "Using the pick index to fetch actor at %i,%i",
+                    x, y);
+      return TRUE;
+    }
 
-      _clutter_stage_window_get_dirty_pixel (priv->impl, &dirty_x, &dirty_y);
+  /* If the scene can be picked by testing the point against the
+   * transformed allocation of each actor we can avoid rendering the
+   * scene and, more importantly, stalling the pipeline by reading
+   * back from the color buffer
+   */
+  if (!priv->geometry_pick_enabled)
+    return FALSE;
 
-      if (G_LIKELY (!(clutter_pick_debug_flags & CLUTTER_DEBUG_DUMP_PICK_BUFFERS)))
-        cogl_clip_push_window_rectangle (dirty_x, dirty_y, 1, 1);
+  CLUTTER_TIMER_START (_clutter_uprof_context, pick_geometry);
 
-      cogl_set_viewport (priv->viewport[0] - x + dirty_x,
-                         priv->viewport[1] - y + dirty_y,
-                         priv->viewport[2],
-                         priv->viewport[3]);
+  geometry_pick.projection = &priv->projection;
+  geometry_pick.viewport = priv->viewport;
+  geometry_pick.mode = mode;
+  geometry_pick.x = x;
+  geometry_pick.y = y;
+  geometry_pick.hit = NULL;
 
-      read_x = dirty_x;
-      read_y = dirty_y;
-      is_clipped = TRUE;
-    }
-  else
+  if (_clutter_actor_geometry_pick (CLUTTER_ACTOR (stage), &geometry_pick))
     {
-      read_x = x;
-      read_y = y;
-      is_clipped = FALSE;
+      CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_geometry);
+
+      CLUTTER_NOTE (PICK, "Performing geometric pick at %i,%i", x, y);
+
+      *actor_p = geometry_pick.hit != NULL
+               ? geometry_pick.hit
+               : CLUTTER_ACTOR (stage);
+
+      return TRUE;
     }
 
-  CLUTTER_NOTE (PICK, "Performing %s pick at %i,%i",
-                is_clipped ? "clipped" : "full", x, y);
+  CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_geometry);
 
-  cogl_color_init_from_4ub (&stage_pick_id, 255, 255, 255, 255);
-  CLUTTER_TIMER_START (_clutter_uprof_context, pick_clear);
-  cogl_clear (&stage_pick_id,
-	      COGL_BUFFER_BIT_COLOR |
-	      COGL_BUFFER_BIT_DEPTH);
-  CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_clear);
+  CLUTTER_NOTE (PICK, "Geometric pick at %i,%i not possible, falling "
+                "back to a pick render", x, y);
 
-  /* Disable dithering (if any) when doing the painting in pick mode */
-  fb = cogl_get_draw_framebuffer ();
-  dither_enabled_save = cogl_framebuffer_get_dither_enabled (fb);
-  cogl_framebuffer_set_dither_enabled (fb, FALSE);
+  return FALSE;
+}
 
-  /* Render the entire scence in pick mode - just single colored silhouette's
-   * are drawn offscreen (as we never swap buffers)
-  */
-  CLUTTER_TIMER_START (_clutter_uprof_context, pick_paint);
-  context->pick_mode = mode;
-  _clutter_stage_do_paint (stage, NULL);
-  context->pick_mode = CLUTTER_PICK_NONE;
-  CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_paint);
+static ClutterActor *
+clutter_stage_pick_id_to_actor (ClutterStage *stage,
+                                guint32       pick_id)
+{
+  if (pick_id == STAGE_PICK_ID)
+    return CLUTTER_ACTOR (stage);
 
-  /* Read the color of the screen co-ords pixel. RGBA_8888_PRE is used
-     even though we don't care about the alpha component because under
-     GLES this is the only format that is guaranteed to work so Cogl
-     will end up having to do a conversion if any other format is
-     used. The format is requested as pre-multiplied because Cogl
-     assumes that all pixels in the framebuffer are premultiplied so
-     it avoids a conversion. */
-  CLUTTER_TIMER_START (_clutter_uprof_context, pick_read);
-  cogl_read_pixels (read_x, read_y, 1, 1,
-                    COGL_READ_PIXELS_COLOR_BUFFER,
-                    COGL_PIXEL_FORMAT_RGBA_8888_PRE,
-                    pixel);
-  CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_read);
+  return _clutter_get_actor_by_id (stage, pick_id);
+}
 
-  if (G_UNLIKELY (clutter_pick_debug_flags & CLUTTER_DEBUG_DUMP_PICK_BUFFERS))
+static gboolean
+clutter_stage_get_pick_prefetch (ClutterStage     *stage,
+                                 gint              x,
+                                 gint              y,
+                                 ClutterPickMode   mode,
+                                 ClutterActor    **actor_p)
+{
+  GArray *prefetch = stage->priv->pick_prefetch;
+  guint i;
+
+  if (stage->priv->pick_prefetch_generation !=
+      clutter_stage_get_pick_generation (stage, mode))
+    return FALSE;
+
+  for (i = 0; i < prefetch->len; i++)
     {
-      char *file_name =
-        g_strconcat ("pick-buffer-",
-                     _clutter_actor_get_debug_name (CLUTTER_ACTOR (stage)),
-                     NULL);
+      const PickPrefetch *p = &g_array_index (prefetch, PickPrefetch, i);
 
-      read_pixels_to_file (file_name, 0, 0,
-                           clutter_actor_get_width (CLUTTER_ACTOR (stage)),
-                           clutter_actor_get_height (CLUTTER_ACTOR (stage)));
+      if (p->x == x && p->y == y && p->mode == mode)
+        {
+          *actor_p = clutter_stage_pick_id_to_actor (stage, p->pick_id);
 
-      g_free (file_name);
+          return *actor_p != NULL;
+        }
     }
 
-  /* Restore whether GL_DITHER was enabled */
-  cogl_framebuffer_set_dither_enabled (fb, dither_enabled_save);
+  return FALSE;
+}
 
-  if (is_clipped)
-  {
-     if (G_LIKELY (!(clutter_pick_debug_flags & CLUTTER_DEBUG_DUMP_PICK_BUFFERS)))
-      cogl_clip_pop ();
+static void
+clutter_stage_clear_pick_prefetch (ClutterStage *stage)
+{
+  g_array_set_size (stage->priv->pick_prefetch, 0);
+}
 
-     _clutter_stage_dirty_viewport (stage);
-
-    _clutter_stage_set_pick_buffer_valid (stage, FALSE, -1);
-  }
-  else
-  {
-    /* Notify the backend that we have trashed the contents of
-     * the back buffer... */
-    _clutter_stage_window_dirty_back_buffer (priv->impl);
+/* If the points are spread over a large area we read them one by one
+ * instead of transferring the whole rectangle containing them; only the
+ * first read back will need to wait for the pick render to complete
+ */
+#define PICK_UNION_IS_SPARSE(w,h,n)     ((gint64) (w) * (h) > (gint64) (n) * 1024)
 
-    _clutter_stage_set_pick_buffer_valid (stage, TRUE, mode);
-  }
+static void
+read_pick_points (gint         x,
+                  gint         y,
+                  gint         width,
+                  gint         height,
+                  const gint  *points,
+                  guint        n_points,
+                  guchar      *pixels)
+{
+  guint i;
 
-check_pixel:
-  if (pixel[0] == 0xff && pixel[1] == 0xff && pixel[2] == 0xff)
-    {
-      actor = CLUTTER_ACTOR (stage);
-    }
-  else
+  if (!PICK_UNION_IS_SPARSE (width, height, n_points))
     {
-      guint32 id_ = _clutter_pixel_to_id (pixel);
-
-      actor = _clutter_get_actor_by_id (stage, id_);
+      cogl_read_pixels (x, y, width, height,
+                        COGL_READ_PIXELS_COLOR_BUFFER,
+                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                        pixels);
+      return;
     }
 
-  CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_timer);
+  for (i = 0; i < n_points; i++)
+    {
+      gint point_x = points[i * 2];
+      gint point_y = points[i * 2 + 1];
 
-#ifdef CLUTTER_ENABLE_PROFILE
-  if (clutter_profile_flags & CLUTTER_PROFILE_PICKING_ONLY)
-    _clutter_profile_suspend ();
-#endif
+      if (point_x < x || point_x >= x + width ||
+          point_y < y || point_y >= y + height)
+        continue;
 
-  return actor;
+      cogl_read_pixels (point_x, point_y, 1, 1,
+                        COGL_READ_PIXELS_COLOR_BUFFER,
+                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                        pixels + i * 4);
+    }
 }
 
-
-
-static gboolean
-clutter_stage_real_delete_event (ClutterStage *stage,
-                                 ClutterEvent *event)
+/* Renders the scene in pick mode once, clipped to the rectangle
+ * containing all the @n_points integer coordinates inside @points,
+ * and reads the results back; the pick identifiers are stored inside
+ * @pick_ids
+ */
+static void
+clutter_stage_pick_render_points (ClutterStage    *stage,
+                                  const gint      *points,
+                                  guint            n_points,
+                                  ClutterPickMode  mode,
+                                  guint32         *pick_ids)
 {
-  clutter_actor_destroy (CLUTTER_ACTOR (stage));
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterMainContext *context;
+  CoglColor stage_pick_id;
+  CoglFramebuffer *fb;
+  gboolean dither_enabled_save;
+  gint x_1, y_1, x_2, y_2;
+  gint stage_width, stage_height;
+  gint width, height;
+  guchar *pixels;
+  guint i;
 
-  return TRUE;
-}
+  CLUTTER_STATIC_TIMER (pick_batch,
+                        "Picking", /* parent */
+                        "Batched pick",
+                        "The time spent picking multiple points at once",
+                        0 /* no application private data */);
 
-static void
-clutter_stage_real_apply_transform (ClutterActor *stage,
-                                    CoglMatrix   *matrix)
-{
-  ClutterStagePrivate *priv = CLUTTER_STAGE (stage)->priv;
+  stage_width = priv->viewport[2];
+  stage_height = priv->viewport[3];
 
-  /* FIXME: we probably shouldn't be explicitly reseting the matrix
-   * here... */
-  cogl_matrix_init_identity (matrix);
-  cogl_matrix_multiply (matrix, matrix, &priv->view);
-}
+  x_1 = stage_width;
+  y_1 = stage_height;
+  x_2 = y_2 = 0;
 
-static void
-clutter_stage_constructed (GObject *gobject)
-{
-  ClutterStage *self = CLUTTER_STAGE (gobject);
-  ClutterStageManager *stage_manager;
+  for (i = 0; i < n_points; i++)
+    {
+      gint x = points[i * 2];
+      gint y = points[i * 2 + 1];
 
-  stage_manager = clutter_stage_manager_get_default ();
+      /* nothing is painted outside of the viewport */
+      if (!POINT_IN_VIEWPORT (x, y, stage_width, stage_height))
+        continue;
 
-  /* this will take care to sinking the floating reference */
-  _clutter_stage_manager_add_stage (stage_manager, self);
+      x_1 = MIN (x_1, x);
+      y_1 = MIN (y_1, y);
+      x_2 = MAX (x_2, x + 1);
+      y_2 = MAX (y_2, y + 1);
+    }
 
-  /* if this stage has been created on a backend that does not
-   * support multiple stages then it becomes the default stage
-   * as well; any other attempt at creating a ClutterStage will
-   * fail.
-   */
-  if (!clutter_feature_available (CLUTTER_FEATURE_STAGE_MULTIPLE))
+  if (x_2 <= x_1 || y_2 <= y_1)
     {
-      if (G_UNLIKELY (clutter_stage_manager_get_default_stage (stage_manager) != NULL))
-        {
-          g_error ("Unable to create another stage: the backend of "
-                   "type '%s' does not support multiple stages. Use "
-                   "clutter_stage_manager_get_default_stage() instead "
-                   "to access the stage singleton.",
-                   G_OBJECT_TYPE_NAME (clutter_get_default_backend ()));
-        }
+      for (i = 0; i < n_points; i++)
+        pick_ids[i] = STAGE_PICK_ID;
 
-      _clutter_stage_manager_set_default_stage (stage_manager, self);
+      return;
     }
 
-  G_OBJECT_CLASS (clutter_stage_parent_class)->constructed (gobject);
-}
+  width = x_2 - x_1;
+  height = y_2 - y_1;
 
-static void
-clutter_stage_set_property (GObject      *object,
-			    guint         prop_id,
-			    const GValue *value,
-			    GParamSpec   *pspec)
-{
-  ClutterStage *stage = CLUTTER_STAGE (object);
+  if (PICK_UNION_IS_SPARSE (width, height, n_points))
+    pixels = g_malloc (n_points * 4);
+  else
+    pixels = g_malloc (width * height * 4);
 
-  switch (prop_id)
-    {
-    case PROP_COLOR:
-      clutter_actor_set_background_color (CLUTTER_ACTOR (stage),
-                                          clutter_value_get_color (value));
-      break;
+  CLUTTER_TIMER_START (_clutter_uprof_context, pick_batch);
 
-    case PROP_OFFSCREEN:
-      if (g_value_get_boolean (value))
-        g_warning ("Offscreen stages are currently not supported\n");
-      break;
+  context = _clutter_context_get_default ();
+  clutter_stage_ensure_current (stage);
 
-    case PROP_CURSOR_VISIBLE:
-      if (g_value_get_boolean (value))
-        clutter_stage_show_cursor (stage);
-      else
-        clutter_stage_hide_cursor (stage);
-      break;
+  if (!_clutter_stage_get_pick_buffer_valid (stage, mode))
+    {
+      gboolean is_clipped;
 
-    case PROP_PERSPECTIVE:
-      clutter_stage_set_perspective (stage, g_value_get_boxed (value));
-      break;
+      priv->picks_per_frame++;
 
-    case PROP_TITLE:
-      clutter_stage_set_title (stage, g_value_get_string (value));
-      break;
+      _clutter_backend_ensure_context (context->backend, stage);
 
-    case PROP_USER_RESIZABLE:
-      clutter_stage_set_user_resizable (stage, g_value_get_boolean (value));
-      break;
+      /* needed for when a context switch happens */
+      _clutter_stage_maybe_setup_viewport (stage);
 
-    case PROP_USE_ALPHA:
-      clutter_stage_set_use_alpha (stage, g_value_get_boolean (value));
-      break;
+      is_clipped = x_1 > 0 || y_1 > 0 ||
+                   x_2 < stage_width || y_2 < stage_height;
 
-    case PROP_KEY_FOCUS:
-      clutter_stage_set_key_focus (stage, g_value_get_object (value));
-      break;
+      CLUTTER_NOTE (PICK, "Performing batched pick of %u points "
+                    "inside %d,%d %dx%d",
+                    n_points, x_1, y_1, width, height);
 
-    case PROP_NO_CLEAR_HINT:
-      clutter_stage_set_no_clear_hint (stage, g_value_get_boolean (value));
-      break;
+      if (is_clipped)
+        cogl_clip_push_window_rectangle (x_1, y_1, width, height);
 
-    case PROP_ACCEPT_FOCUS:
-      clutter_stage_set_accept_focus (stage, g_value_get_boolean (value));
-      break;
+      cogl_color_init_from_4ub (&stage_pick_id, 255, 255, 255, 255);
+      cogl_clear (&stage_pick_id,
+                  COGL_BUFFER_BIT_COLOR |
+                  COGL_BUFFER_BIT_DEPTH);
 
-    default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
-      break;
-  }
-}
+      fb = cogl_get_draw_framebuffer ();
+      dither_enabled_save = cogl_framebuffer_get_dither_enabled (fb);
+      cogl_framebuffer_set_dither_enabled (fb, FALSE);
 
-static void
-clutter_stage_get_property (GObject    *gobject,
-			    guint       prop_id,
-			    GValue     *value,
-			    GParamSpec *pspec)
-{
-  ClutterStagePrivate *priv = CLUTTER_STAGE (gobject)->priv;
+      context->pick_mode = mode;
+      _clutter_stage_do_paint (stage, NULL);
+      context->pick_mode = CLUTTER_PICK_NONE;
 
-  switch (prop_id)
-    {
-    case PROP_COLOR:
-      {
-        ClutterColor bg_color;
+      cogl_framebuffer_set_dither_enabled (fb, dither_enabled_save);
 
-        clutter_actor_get_background_color (CLUTTER_ACTOR (gobject),
-                                            &bg_color);
-        clutter_value_set_color (value, &bg_color);
-      }
-      break;
+      read_pick_points (x_1, y_1, width, height, points, n_points, pixels);
 
-    case PROP_OFFSCREEN:
-      g_value_set_boolean (value, FALSE);
-      break;
+      if (is_clipped)
+        cogl_clip_pop ();
 
-    case PROP_FULLSCREEN_SET:
-      g_value_set_boolean (value, priv->is_fullscreen);
-      break;
+      /* we painted over the visible contents of the back buffer */
+      _clutter_stage_window_dirty_back_buffer (priv->impl);
 
-    case PROP_CURSOR_VISIBLE:
-      g_value_set_boolean (value, priv->is_cursor_visible);
-      break;
+      _clutter_stage_set_pick_buffer_valid (stage, !is_clipped, mode);
+    }
+  else
+    {
+      CLUTTER_NOTE (PICK, "Reusing pick buffer from previous render to "
+                    "fetch %u points", n_points);
 
-    case PROP_PERSPECTIVE:
-      g_value_set_boxed (value, &priv->perspective);
-      break;
+      read_pick_points (x_1, y_1, width, height, points, n_points, pixels);
+    }
 
-    case PROP_TITLE:
-      g_value_set_string (value, priv->title);
-      break;
+  for (i = 0; i < n_points; i++)
+    {
+      gint x = points[i * 2];
+      gint y = points[i * 2 + 1];
+      const guchar *pixel;
 
-    case PROP_USER_RESIZABLE:
-      g_value_set_boolean (value, priv->is_user_resizable);
-      break;
+      if (!POINT_IN_VIEWPORT (x, y, stage_width, stage_height))
+        {
+          pick_ids[i] = STAGE_PICK_ID;
+          continue;
+        }
 
-    case PROP_USE_ALPHA:
-      g_value_set_boolean (value, priv->use_alpha);
-      break;
+      if (PICK_UNION_IS_SPARSE (width, height, n_points))
+        pixel = pixels + i * 4;
+      else
+        pixel = pixels + ((y - y_1) * width + (x - x_1)) * 4;
 
-    case PROP_KEY_FOCUS:
-      g_value_set_object (value, priv->key_focused_actor);
-      break;
+      if (pixel[0] == 0xff && pixel[1] == 0xff && pixel[2] == 0xff)
+        pick_ids[i] = STAGE_PICK_ID;
+      else
+        pick_ids[i] = _clutter_pixel_to_id ((guchar *) pixel);
+    }
 
-    case PROP_NO_CLEAR_HINT:
-      {
-        gboolean hint =
-          (priv->stage_hints & CLUTTER_STAGE_NO_CLEAR_ON_PAINT) != 0;
+  CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_batch);
 
-        g_value_set_boolean (value, hint);
-      }
-      break;
+  g_free (pixels);
+}
 
-    case PROP_ACCEPT_FOCUS:
-      g_value_set_boolean (value, priv->accept_focus);
-      break;
+/*< private >
+ * _clutter_stage_do_pick_positions:
+ * @stage: a #ClutterStage
+ * @positions: (array length=n_positions): the positions to pick
+ * @n_positions: the number of positions
+ * @mode: the pick mode
+ * @actors: (out caller-allocates) (array length=n_positions): return
+ *   location for the actors at each position
+ *
+ * Picks all the @positions at once; each position that cannot be
+ * resolved without rendering is resolved from the same pick render
+ * and the same read back.
+ */
+void
+_clutter_stage_do_pick_positions (ClutterStage       *stage,
+                                  const ClutterPoint *positions,
+                                  guint               n_positions,
+                                  ClutterPickMode     mode,
+                                  ClutterActor      **actors)
+{
+  gint *points;
+  guint32 *pick_ids;
+  guint *indices;
+  guint i, n_points;
 
-    default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
-      break;
+  if (n_positions == 0)
+    return;
+
+  if (n_positions == 1)
+    {
+      actors[0] = _clutter_stage_do_pick (stage,
+                                          positions[0].x,
+                                          positions[0].y,
+                                          mode);
+      return;
     }
-}
 
-static void
-clutter_stage_dispose (GObject *object)
-{
-  ClutterStage        *stage = CLUTTER_STAGE (object);
-  ClutterStagePrivate *priv = stage->priv;
-  ClutterStageManager *stage_manager;
+  if (G_UNLIKELY (clutter_pick_debug_flags & CLUTTER_DEBUG_NOP_PICKING))
+    {
+      for (i = 0; i < n_positions; i++)
+        actors[i] = CLUTTER_ACTOR (stage);
 
-  clutter_actor_hide (CLUTTER_ACTOR (object));
+      return;
+    }
 
-  _clutter_clear_events_queue_for_stage (stage);
+  /* the batch size is chosen by the caller, so it does not belong
+   * on the stack
+   */
+  points = g_new (gint, n_positions * 2);
+  indices = g_new (guint, n_positions);
+  n_points = 0;
 
-  if (priv->impl != NULL)
+  for (i = 0; i < n_positions; i++)
     {
-      CLUTTER_NOTE (BACKEND, "Disposing of the stage implementation");
+      gint x = positions[i].x;
+      gint y = positions[i].y;
 
-      if (CLUTTER_ACTOR_IS_REALIZED (object))
-        _clutter_stage_window_unrealize (priv->impl);
+      if (clutter_stage_pick_without_render (stage, x, y, mode, &actors[i]))
+        continue;
 
-      g_object_unref (priv->impl);
-      priv->impl = NULL;
+      actors[i] = NULL;
+      points[n_points * 2] = x;
+      points[n_points * 2 + 1] = y;
+      indices[n_points] = i;
+      n_points += 1;
     }
 
-  clutter_actor_remove_all_children (CLUTTER_ACTOR (object));
+  if (n_points == 0)
+    goto out;
 
-  g_list_free_full (priv->pending_queue_redraws,
-                    (GDestroyNotify) free_queue_redraw_entry);
-  priv->pending_queue_redraws = NULL;
+  pick_ids = g_new (guint32, n_points);
+  clutter_stage_pick_render_points (stage, points, n_points, mode, pick_ids);
 
-  /* this will release the reference on the stage */
-  stage_manager = clutter_stage_manager_get_default ();
-  _clutter_stage_manager_remove_stage (stage_manager, stage);
+  for (i = 0; i < n_points; i++)
+    actors[indices[i]] = clutter_stage_pick_id_to_actor (stage, pick_ids[i]);
 
-  G_OBJECT_CLASS (clutter_stage_parent_class)->dispose (object);
+  g_free (pick_ids);
+
+out:
+  g_free (indices);
+  g_free (points);
 }
 
+/* Picks the positions of all the motion and touch events inside
+ * @events with a single pick render, so that the picks done while
+ * processing each event do not need to render the scene again, as
+ * long as no redraw is queued in the meantime.
+ */
 static void
-clutter_stage_finalize (GObject *object)
+clutter_stage_prefetch_picks (ClutterStage *stage,
+                              GList        *events)
 {
-  ClutterStage *stage = CLUTTER_STAGE (object);
   ClutterStagePrivate *priv = stage->priv;
+  gint *points;
+  guint32 *pick_ids;
+  guint n_events, n_points, i;
+  GList *l;
 
-  g_queue_foreach (priv->event_queue, (GFunc) clutter_event_free, NULL);
-  g_queue_free (priv->event_queue);
+  clutter_stage_clear_pick_prefetch (stage);
 
-  g_free (priv->title);
+  if (G_UNLIKELY (clutter_pick_debug_flags & CLUTTER_DEBUG_NOP_PICKING))
+    return;
 
-  g_array_free (priv->paint_volume_stack, TRUE);
+  n_events = g_list_length (events);
+  if (n_events < 2)
+    return;
 
-  _clutter_id_pool_free (priv->pick_id_pool);
+  points = g_new (gint, n_events * 2);
+  n_points = 0;
 
-  if (priv->fps_timer != NULL)
-    g_timer_destroy (priv->fps_timer);
+  for (l = events; l != NULL; l = l->next)
+    {
+      ClutterEvent *event = l->data;
+      ClutterEvent *next_event = l->next != NULL ? l->next->data : NULL;
+      ClutterActor *actor;
+      gfloat event_x, event_y;
+      gint x, y;
 
-  G_OBJECT_CLASS (clutter_stage_parent_class)->finalize (object);
+      switch (event->type)
+        {
+        case CLUTTER_MOTION:
+        case CLUTTER_TOUCH_UPDATE:
+          /* skip the events that will be compressed; see the
+           * throttling in _clutter_stage_process_queued_events()
+           */
+          if (priv->throttle_motion_events &&
+              next_event != NULL &&
+              (next_event->type == event->type ||
+               next_event->type == CLUTTER_LEAVE) &&
+              clutter_event_get_device (next_event) == clutter_event_get_device (event))
+            continue;
+          break;
+
+        case CLUTTER_TOUCH_BEGIN:
+          break;
+
+        default:
+          continue;
+        }
+
+      clutter_event_get_coords (event, &event_x, &event_y);
+      x = event_x;
+      y = event_y;
+
+      /* points that we can pick without rendering do not need to
+       * be part of the batch
+       */
+      if (clutter_stage_pick_without_render (stage, x, y,
+                                             CLUTTER_PICK_REACTIVE,
+                                             &actor))
+        continue;
+
+      points[n_points * 2] = x;
+      points[n_points * 2 + 1] = y;
+      n_points += 1;
+    }
+
+  /* a single point will be picked by _clutter_stage_do_pick() anyway */
+  if (n_points < 2)
+    {
+      g_free (points);
+      return;
+    }
+
+  pick_ids = g_new (guint32, n_points);
+  clutter_stage_pick_render_points (stage, points, n_points,
+                                    CLUTTER_PICK_REACTIVE,
+                                    pick_ids);
+
+  priv->pick_prefetch_generation = priv->pick_generation_reactive;
+
+  for (i = 0; i < n_points; i++)
+    {
+      PickPrefetch p;
+
+      p.x = points[i * 2];
+      p.y = points[i * 2 + 1];
+      p.mode = CLUTTER_PICK_REACTIVE;
+      p.pick_id = pick_ids[i];
+
+      g_array_append_val (priv->pick_prefetch, p);
+    }
+
+  g_free (pick_ids);
+  g_free (points);
 }
 
-static void
-clutter_stage_class_init (ClutterStageClass *klass)
+ClutterActor *
+_clutter_stage_do_pick (ClutterStage   *stage,
+                        gint            x,
+                        gint            y,
+                        ClutterPickMode mode)
 {
-  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
-  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
-  GParamSpec *pspec;
+  ClutterStagePrivate *priv;
+  ClutterMainContext *context;
+  guchar pixel[4] = { 0xff, 0xff, 0xff, 0xff };
+  CoglColor stage_pick_id;
+  gboolean dither_enabled_save;
+  CoglFramebuffer *fb;
+  ClutterActor *actor;
+  gboolean is_clipped;
+  gint read_x;
+  gint read_y;
 
-  gobject_class->constructed = clutter_stage_constructed;
-  gobject_class->set_property = clutter_stage_set_property;
-  gobject_class->get_property = clutter_stage_get_property;
-  gobject_class->dispose = clutter_stage_dispose;
-  gobject_class->finalize = clutter_stage_finalize;
+  CLUTTER_STATIC_COUNTER (do_pick_counter,
+                          "_clutter_stage_do_pick counter",
+                          "Increments for each full pick run",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_TIMER (pick_timer,
+                        "Mainloop", /* parent */
+                        "Picking",
+                        "The time spent picking",
+                        0 /* no application private data */);
+  CLUTTER_STATIC_TIMER (pick_clear,
+                        "Picking", /* parent */
+                        "Stage clear (pick)",
+                        "The time spent clearing stage for picking",
+                        0 /* no application private data */);
+  CLUTTER_STATIC_TIMER (pick_paint,
+                        "Picking", /* parent */
+                        "Painting actors (pick mode)",
+                        "The time spent painting actors in pick mode",
+                        0 /* no application private data */);
+  CLUTTER_STATIC_TIMER (pick_read,
+                        "Picking", /* parent */
+                        "Read Pixels",
+                        "The time spent issuing a read pixels",
+                        0 /* no application private data */);
 
-  actor_class->allocate = clutter_stage_allocate;
-  actor_class->get_preferred_width = clutter_stage_get_preferred_width;
-  actor_class->get_preferred_height = clutter_stage_get_preferred_height;
-  actor_class->paint = clutter_stage_paint;
-  actor_class->pick = clutter_stage_pick;
-  actor_class->get_paint_volume = clutter_stage_get_paint_volume;
-  actor_class->realize = clutter_stage_realize;
-  actor_class->unrealize = clutter_stage_unrealize;
-  actor_class->show = clutter_stage_show;
-  actor_class->show_all = clutter_stage_show_all;
-  actor_class->hide = clutter_stage_hide;
-  actor_class->hide_all = clutter_stage_hide_all;
-  actor_class->queue_relayout = clutter_stage_real_queue_relayout;
-  actor_class->queue_redraw = clutter_stage_real_queue_redraw;
-  actor_class->apply_transform = clutter_stage_real_apply_transform;
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
 
-  /**
-   * ClutterStage:fullscreen:
-   *
-   * Whether the stage should be fullscreen or not.
-   *
-   * This property is set by calling clutter_stage_set_fullscreen()
-   * but since the actual implementation is delegated to the backend
-   * you should connect to the notify::fullscreen-set signal in order
-   * to get notification if the fullscreen state has been successfully
-   * achieved.
-   *
-   *
-   */
-  pspec = g_param_spec_boolean ("fullscreen-set",
-                                P_("Fullscreen Set"),
-                                P_("Whether the main stage is fullscreen"),
-                                FALSE,
-                                CLUTTER_PARAM_READABLE);
-  g_object_class_install_property (gobject_class,
-                                   PROP_FULLSCREEN_SET,
-                                   pspec);
-  /**
-   * ClutterStage:cursor-visible:
-   *
-   * Whether the mouse pointer should be visible
-   */
-  pspec = g_param_spec_boolean ("cursor-visible",
-                                P_("Cursor Visible"),
-                                P_("Whether the mouse pointer is visible on the main stage"),
-                                TRUE,
-                                CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class,
-                                   PROP_CURSOR_VISIBLE,
-                                   pspec);
-  /**
-   * ClutterStage:user-resizable:
-   *
-   * Whether the stage is resizable via user interaction.
-   *
-   *
-   */
-  pspec = g_param_spec_boolean ("user-resizable",
-                                P_("User Resizable"),
-                                P_("Whether the stage is able to be resized via user interaction"),
-                                FALSE,
-                                CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class,
-                                   PROP_USER_RESIZABLE,
-                                   pspec);
-  /**
-   * ClutterStage:perspective:
-   *
-   * The parameters used for the perspective projection from 3D
-   * coordinates to 2D
-   *
-   *
+  priv = stage->priv;
+
+  if (G_UNLIKELY (clutter_pick_debug_flags & CLUTTER_DEBUG_NOP_PICKING))
+    return CLUTTER_ACTOR (stage);
+
+#ifdef CLUTTER_ENABLE_PROFILE
+  if (clutter_profile_flags & CLUTTER_PROFILE_PICKING_ONLY)
+    _clutter_profile_resume ();
+#endif /* CLUTTER_ENABLE_PROFILE */
+
+  CLUTTER_COUNTER_INC (_clutter_uprof_context, do_pick_counter);
+  CLUTTER_TIMER_START (_clutter_uprof_context, pick_timer);
+  CLUTTER_TRACE_BEGIN ("Pick");
+
+  if (clutter_stage_pick_without_render (stage, x, y, mode, &actor))
+    goto out;
+
+  /* The actor may have been picked in advance, together with other
+   * points, when processing the queued events
    */
-  pspec = g_param_spec_boxed ("perspective",
-                              P_("Perspective"),
-                              P_("Perspective projection parameters"),
-                              CLUTTER_TYPE_PERSPECTIVE,
-                              CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class,
-                                   PROP_PERSPECTIVE,
-                                   pspec);
+  if (clutter_stage_get_pick_prefetch (stage, x, y, mode, &actor))
+    {
+      CLUTTER_NOTE (PICK, "Using the prefetched pick at %i,%i", x, y);
+      goto out;
+    }
+
+  context = _clutter_context_get_default ();
+  clutter_stage_ensure_current (stage);
+
+  /* It's possible that we currently have a static scene and have renderered a
+   * full, unclipped pick buffer. If so we can simply continue to read from
+   * this cached buffer until the scene next changes. */
+  if (_clutter_stage_get_pick_buffer_valid (stage, mode))
+    {
+      CLUTTER_TIMER_START (_clutter_uprof_context, pick_read);
+      cogl_read_pixels (x, y, 1, 1,
+                        COGL_READ_PIXELS_COLOR_BUFFER,
+                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                        pixel);
+      CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_read);
+
+      CLUTTER_NOTE (PICK, "Reusing pick buffer from previous render to fetch "
+                    "actor at %i,%i", x, y);
+
+      goto check_pixel;
+    }
+
+  priv->picks_per_frame++;
+
+  _clutter_backend_ensure_context (context->backend, stage);
+
+  /* needed for when a context switch happens */
+  _clutter_stage_maybe_setup_viewport (stage);
+
+  /* If we are seeing multiple picks per frame that means the scene is static
+   * so we promote to doing a non-scissored pick render so that all subsequent
+   * picks for the same static scene won't require additional renders */
+  if (priv->picks_per_frame < 2)
+    {
+       gint dirty_x;
+       gint dirty_y;
+
+      _clutter_stage_window_get_dirty_pixel (priv->impl, &dirty_x, &dirty_y);
+
+      if (G_LIKELY (!(clutter_pick_debug_flags & CLUTTER_DEBUG_DUMP_PICK_BUFFERS)))
+        cogl_clip_push_window_rectangle (dirty_x, dirty_y, 1, 1);
+
+      cogl_set_viewport (priv->viewport[0] - x + dirty_x,
+                         priv->viewport[1] - y + dirty_y,
+                         priv->viewport[2],
+                         priv->viewport[3]);
+
+      read_x = dirty_x;
+      read_y = dirty_y;
+      is_clipped = TRUE;
+    }
+  else
+    {
+      read_x = x;
+      read_y = y;
+      is_clipped = FALSE;
+    }
+
+  CLUTTER_NOTE (PICK, "Performing %s pick at %i,%i",
+                is_clipped ? "clipped" : "full", x, y);
+
+  cogl_color_init_from_4ub (&stage_pick_id, 255, 255, 255, 255);
+  CLUTTER_TIMER_START (_clutter_uprof_context, pick_clear);
+  cogl_clear (&stage_pick_id,
+	      COGL_BUFFER_BIT_COLOR |
+	      COGL_BUFFER_BIT_DEPTH);
+  CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_clear);
+
+  /* Disable dithering (if any) when doing the painting in pick mode */
+  fb = cogl_get_draw_framebuffer ();
+  dither_enabled_save = cogl_framebuffer_get_dither_enabled (fb);
+  cogl_framebuffer_set_dither_enabled (fb, FALSE);
+
+  /* Render the entire scence in pick mode - just single colored silhouette's
+   * are drawn offscreen (as we never swap buffers)
+  */
+  CLUTTER_TIMER_START (_clutter_uprof_context, pick_paint);
+  context->pick_mode = mode;
+  _clutter_stage_do_paint (stage, NULL);
+  context->pick_mode = CLUTTER_PICK_NONE;
+  CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_paint);
+
+  /* Read the color of the screen co-ords pixel. RGBA_8888_PRE is used
+     even though we don't care about the alpha component because under
+     GLES this is the only format that is guaranteed to work so Cogl
+     will end up having to do a conversion if any other format is
+     used. The format is requested as pre-multiplied because Cogl
+     assumes that all pixels in the framebuffer are premultiplied so
+     it avoids a conversion. */
+  CLUTTER_TIMER_START (_clutter_uprof_context, pick_read);
+  cogl_read_pixels (read_x, read_y, 1, 1,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                    pixel);
+  CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_read);
+
+  if (G_UNLIKELY (clutter_pick_debug_flags & CLUTTER_DEBUG_DUMP_PICK_BUFFERS))
+    {
+      char *file_name =
+        g_strconcat ("pick-buffer-",
+                     _clutter_actor_get_debug_name (CLUTTER_ACTOR (stage)),
+                     NULL);
+
+      read_pixels_to_file (file_name, 0, 0,
+                           clutter_actor_get_width (CLUTTER_ACTOR (stage)),
+                           clutter_actor_get_height (CLUTTER_ACTOR (stage)));
+
+      g_free (file_name);
+    }
+
+  /* Restore whether GL_DITHER was enabled */
+  cogl_framebuffer_set_dither_enabled (fb, dither_enabled_save);
+
+  if (is_clipped)
+  {
+     if (G_LIKELY (!(clutter_pick_debug_flags & CLUTTER_DEBUG_DUMP_PICK_BUFFERS)))
+      cogl_clip_pop ();
+
+     _clutter_stage_dirty_viewport (stage);
+
+    _clutter_stage_set_pick_buffer_valid (stage, FALSE, -1);
+  }
+  else
+  {
+    /* Notify the backend that we have trashed the contents of
+     * the back buffer... */
+    _clutter_stage_window_dirty_back_buffer (priv->impl);
+
+    _clutter_stage_set_pick_buffer_valid (stage, TRUE, mode);
+  }
+
+check_pixel:
+  if (pixel[0] == 0xff && pixel[1] == 0xff && pixel[2] == 0xff)
+    {
+      actor = CLUTTER_ACTOR (stage);
+    }
+  else
+    {
+      guint32 id_ = _clutter_pixel_to_id (pixel);
+
+      actor = _clutter_get_actor_by_id (stage, id_);
+    }
+
+out:
+  CLUTTER_TRACE_END ();
+  CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_timer);
+
+#ifdef CLUTTER_ENABLE_PROFILE
+  if (clutter_profile_flags & CLUTTER_PROFILE_PICKING_ONLY)
+    _clutter_profile_suspend ();
+#endif
+
+  return actor;
+}
+
+static void
+async_pick_free (ClutterStage *stage,
+                 AsyncPick    *pick)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  /* keep the pixel buffer around for the next pick */
+  priv->async_pick_bitmaps = g_slist_prepend (priv->async_pick_bitmaps,
+                                              pick->bitmap);
+
+  g_object_unref (pick->device);
+  g_slice_free (AsyncPick, pick);
+}
+
+static void
+clutter_stage_clear_async_picks (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  GList *l;
+
+  for (l = priv->async_picks; l != NULL; l = l->next)
+    async_pick_free (stage, l->data);
+
+  g_list_free (priv->async_picks);
+  priv->async_picks = NULL;
+
+  g_slist_free_full (priv->async_pick_bitmaps, cogl_object_unref);
+  priv->async_pick_bitmaps = NULL;
+}
+
+static CoglBitmap *
+clutter_stage_get_async_pick_bitmap (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  CoglPixelBuffer *buffer;
+  CoglBitmap *bitmap;
+  CoglContext *ctx;
+
+  if (priv->async_pick_bitmaps != NULL)
+    {
+      bitmap = priv->async_pick_bitmaps->data;
+      priv->async_pick_bitmaps =
+        g_slist_delete_link (priv->async_pick_bitmaps,
+                             priv->async_pick_bitmaps);
+
+      return bitmap;
+    }
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  buffer = cogl_pixel_buffer_new (ctx, 4, NULL);
+  if (buffer == NULL)
+    return NULL;
+
+  cogl_buffer_set_update_hint (COGL_BUFFER (buffer),
+                               COGL_BUFFER_UPDATE_HINT_STREAM);
+
+  bitmap = cogl_bitmap_new_from_buffer (COGL_BUFFER (buffer),
+                                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                        1, 1,
+                                        4,
+                                        0);
+  cogl_object_unref (buffer);
+
+  return bitmap;
+}
+
+/*< private >
+ * _clutter_stage_do_pick_async:
+ * @stage: a #ClutterStage
+ * @device: the #ClutterInputDevice that requested the pick
+ * @x: X coordinate of the pick
+ * @y: Y coordinate of the pick
+ * @mode: the pick mode
+ *
+ * Picks the actor at @x, @y without waiting for the GPU.
+ *
+ * If the actor can be found without rendering the scene it is returned
+ * immediately. Otherwise the pick is rendered and read back into a pixel
+ * buffer, which is mapped by the next iteration of the master clock,
+ * even if the stage does not need to be redrawn; at that point the
+ * actor underneath @device is updated, emitting the crossing events.
+ *
+ * Any pick previously queued for @device is discarded.
+ *
+ * Return value: the actor at @x, @y, or %NULL if the pick is pending
+ */
+ClutterActor *
+_clutter_stage_do_pick_async (ClutterStage       *stage,
+                              ClutterInputDevice *device,
+                              gint                x,
+                              gint                y,
+                              ClutterPickMode     mode)
+{
+  ClutterStagePrivate *priv;
+  ClutterMainContext *context;
+  ClutterMasterClock *master_clock;
+  CoglColor stage_pick_id;
+  gboolean dither_enabled_save;
+  CoglFramebuffer *fb;
+  ClutterActor *actor;
+  CoglBitmap *bitmap;
+  AsyncPick *pick;
+  gint dirty_x;
+  gint dirty_y;
+  GList *l;
+
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
+  g_return_val_if_fail (CLUTTER_IS_INPUT_DEVICE (device), NULL);
+
+  priv = stage->priv;
+
+  if (G_UNLIKELY (clutter_pick_debug_flags & CLUTTER_DEBUG_NOP_PICKING))
+    return CLUTTER_ACTOR (stage);
+
+  if (clutter_stage_pick_without_render (stage, x, y, mode, &actor) ||
+      clutter_stage_get_pick_prefetch (stage, x, y, mode, &actor))
+    return actor;
+
+  /* the result of an older pick for the same device is now useless */
+  for (l = priv->async_picks; l != NULL; l = l->next)
+    {
+      pick = l->data;
+
+      if (pick->device == device)
+        {
+          async_pick_free (stage, pick);
+          priv->async_picks = g_list_delete_link (priv->async_picks, l);
+          break;
+        }
+    }
+
+  bitmap = clutter_stage_get_async_pick_bitmap (stage);
+  if (bitmap == NULL)
+    return _clutter_stage_do_pick (stage, x, y, mode);
+
+  context = _clutter_context_get_default ();
+  clutter_stage_ensure_current (stage);
+  _clutter_backend_ensure_context (context->backend, stage);
+
+  /* needed for when a context switch happens */
+  _clutter_stage_maybe_setup_viewport (stage);
+
+  /* we use the same trick as the clipped pick in _clutter_stage_do_pick()
+   * and render the pick on a pixel that is going to be redrawn anyway
+   */
+  _clutter_stage_window_get_dirty_pixel (priv->impl, &dirty_x, &dirty_y);
+
+  cogl_clip_push_window_rectangle (dirty_x, dirty_y, 1, 1);
+  cogl_set_viewport (priv->viewport[0] - x + dirty_x,
+                     priv->viewport[1] - y + dirty_y,
+                     priv->viewport[2],
+                     priv->viewport[3]);
+
+  CLUTTER_NOTE (PICK, "Performing asynchronous pick at %i,%i", x, y);
+
+  cogl_color_init_from_4ub (&stage_pick_id, 255, 255, 255, 255);
+  cogl_clear (&stage_pick_id,
+              COGL_BUFFER_BIT_COLOR |
+              COGL_BUFFER_BIT_DEPTH);
+
+  fb = cogl_get_draw_framebuffer ();
+  dither_enabled_save = cogl_framebuffer_get_dither_enabled (fb);
+  cogl_framebuffer_set_dither_enabled (fb, FALSE);
+
+  context->pick_mode = mode;
+  _clutter_stage_do_paint (stage, NULL);
+  context->pick_mode = CLUTTER_PICK_NONE;
+
+  /* this only queues the transfer into the pixel buffer */
+  cogl_framebuffer_read_pixels_into_bitmap (fb, dirty_x, dirty_y,
+                                            COGL_READ_PIXELS_COLOR_BUFFER,
+                                            bitmap);
+
+  cogl_framebuffer_set_dither_enabled (fb, dither_enabled_save);
+
+  cogl_clip_pop ();
+
+  _clutter_stage_dirty_viewport (stage);
+  _clutter_stage_set_pick_buffer_valid (stage, FALSE, -1);
+
+  /* submit the transfer now, instead of waiting for the next frame:
+   * on a static scene there might not be one
+   */
+  cogl_flush ();
+
+  pick = g_slice_new0 (AsyncPick);
+  pick->device = g_object_ref (device);
+  pick->mode = mode;
+  pick->bitmap = bitmap;
+
+  priv->async_picks = g_list_append (priv->async_picks, pick);
+
+  /* the pick is resolved when the queued events are processed by
+   * the next iteration of the master clock
+   */
+  master_clock = _clutter_master_clock_get_default ();
+  _clutter_master_clock_ensure_next_iteration (master_clock);
+  _clutter_master_clock_start_running (master_clock);
+  _clutter_stage_schedule_update (stage);
+
+  return NULL;
+}
+
+static void
+clutter_stage_resolve_async_picks (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  GList *l, *next;
+
+  for (l = priv->async_picks; l != NULL; l = next)
+    {
+      AsyncPick *pick = l->data;
+      ClutterActor *actor;
+      CoglBuffer *buffer;
+      guchar *pixel;
+
+      next = l->next;
+
+      priv->async_picks = g_list_delete_link (priv->async_picks, l);
+
+      buffer = COGL_BUFFER (cogl_bitmap_get_buffer (pick->bitmap));
+      pixel = cogl_buffer_map (buffer, COGL_BUFFER_ACCESS_READ, 0);
+      if (pixel == NULL)
+        {
+          async_pick_free (stage, pick);
+          continue;
+        }
+
+      if (pixel[0] == 0xff && pixel[1] == 0xff && pixel[2] == 0xff)
+        actor = CLUTTER_ACTOR (stage);
+      else
+        actor = _clutter_get_actor_by_id (stage, _clutter_pixel_to_id (pixel));
+
+      cogl_buffer_unmap (buffer);
+
+      /* the actor might have been destroyed in the meantime */
+      if (actor != NULL &&
+          _clutter_input_device_get_stage (pick->device) == stage &&
+          clutter_input_device_get_pointer_actor (pick->device) != actor)
+        {
+          CLUTTER_NOTE (PICK, "Asynchronous pick resolved: %s",
+                        _clutter_actor_get_debug_name (actor));
+
+          _clutter_input_device_set_actor (pick->device, NULL, actor, TRUE);
+        }
+
+      async_pick_free (stage, pick);
+    }
+}
+
+
+
+static gboolean
+clutter_stage_real_delete_event (ClutterStage *stage,
+                                 ClutterEvent *event)
+{
+  clutter_actor_destroy (CLUTTER_ACTOR (stage));
+
+  return TRUE;
+}
+
+static void
+clutter_stage_real_apply_transform (ClutterActor *stage,
+                                    CoglMatrix   *matrix)
+{
+  ClutterStagePrivate *priv = CLUTTER_STAGE (stage)->priv;
+
+  /* FIXME: we probably shouldn't be explicitly reseting the matrix
+   * here... */
+  cogl_matrix_init_identity (matrix);
+  cogl_matrix_multiply (matrix, matrix, &priv->view);
+}
+
+static void
+clutter_stage_constructed (GObject *gobject)
+{
+  ClutterStage *self = CLUTTER_STAGE (gobject);
+  ClutterStageManager *stage_manager;
+
+  stage_manager = clutter_stage_manager_get_default ();
+
+  /* this will take care to sinking the floating reference */
+  _clutter_stage_manager_add_stage (stage_manager, self);
+
+  /* if this stage has been created on a backend that does not
+   * support multiple stages then it becomes the default stage
+   * as well; any other attempt at creating a ClutterStage will
+   * fail.
+   */
+  if (!clutter_feature_available (CLUTTER_FEATURE_STAGE_MULTIPLE))
+    {
+      if (G_UNLIKELY (clutter_stage_manager_get_default_stage (stage_manager) != NULL))
+        {
+          g_error ("Unable to create another stage: the backend of "
+                   "type '%s' does not support multiple stages. Use "
+                   "clutter_stage_manager_get_default_stage() instead "
+                   "to access the stage singleton.",
+                   G_OBJECT_TYPE_NAME (clutter_get_default_backend ()));
+        }
+
+      _clutter_stage_manager_set_default_stage (stage_manager, self);
+    }
+
+  G_OBJECT_CLASS (clutter_stage_parent_class)->constructed (gobject);
+}
+
+static void
+clutter_stage_set_property (GObject      *object,
+			    guint         prop_id,
+			    const GValue *value,
+			    GParamSpec   *pspec)
+{
+  ClutterStage *stage = CLUTTER_STAGE (object);
+
+  switch (prop_id)
+    {
+    case PROP_COLOR:
+      clutter_actor_set_background_color (CLUTTER_ACTOR (stage),
+                                          clutter_value_get_color (value));
+      break;
+
+    case PROP_OFFSCREEN:
+      if (g_value_get_boolean (value))
+        g_warning ("Offscreen stages are currently not supported\n");
+      break;
+
+    case PROP_CURSOR_VISIBLE:
+      if (g_value_get_boolean (value))
+        clutter_stage_show_cursor (stage);
+      else
+        clutter_stage_hide_cursor (stage);
+      break;
+
+    case PROP_PERSPECTIVE:
+      clutter_stage_set_perspective (stage, g_value_get_boxed (value));
+      break;
+
+    case PROP_TITLE:
+      clutter_stage_set_title (stage, g_value_get_string (value));
+      break;
+
+    case PROP_USER_RESIZABLE:
+      clutter_stage_set_user_resizable (stage, g_value_get_boolean (value));
+      break;
+
+    case PROP_USE_ALPHA:
+      clutter_stage_set_use_alpha (stage, g_value_get_boolean (value));
+      break;
+
+    case PROP_USE_ORTHOGRAPHIC:
+      clutter_stage_set_use_orthographic (stage, g_value_get_boolean (value));
+      break;
+
+    case PROP_KEY_FOCUS:
+      clutter_stage_set_key_focus (stage, g_value_get_object (value));
+      break;
+
+    case PROP_NO_CLEAR_HINT:
+      clutter_stage_set_no_clear_hint (stage, g_value_get_boolean (value));
+      break;
+
+    case PROP_ACCEPT_FOCUS:
+      clutter_stage_set_accept_focus (stage, g_value_get_boolean (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+clutter_stage_get_property (GObject    *gobject,
+			    guint       prop_id,
+			    GValue     *value,
+			    GParamSpec *pspec)
+{
+  ClutterStagePrivate *priv = CLUTTER_STAGE (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_COLOR:
+      {
+        ClutterColor bg_color;
+
+        clutter_actor_get_background_color (CLUTTER_ACTOR (gobject),
+                                            &bg_color);
+        clutter_value_set_color (value, &bg_color);
+      }
+      break;
+
+    case PROP_OFFSCREEN:
+      g_value_set_boolean (value, FALSE);
+      break;
+
+    case PROP_FULLSCREEN_SET:
+      g_value_set_boolean (value, priv->is_fullscreen);
+      break;
+
+    case PROP_CURSOR_VISIBLE:
+      g_value_set_boolean (value, priv->is_cursor_visible);
+      break;
+
+    case PROP_PERSPECTIVE:
+      g_value_set_boxed (value, &priv->perspective);
+      break;
+
+    case PROP_TITLE:
+      g_value_set_string (value, priv->title);
+      break;
+
+    case PROP_USER_RESIZABLE:
+      g_value_set_boolean (value, priv->is_user_resizable);
+      break;
+
+    case PROP_USE_ALPHA:
+      g_value_set_boolean (value, priv->use_alpha);
+      break;
+
+    case PROP_USE_ORTHOGRAPHIC:
+      g_value_set_boolean (value, priv->use_orthographic);
+      break;
+
+    case PROP_KEY_FOCUS:
+      g_value_set_object (value, priv->key_focused_actor);
+      break;
+
+    case PROP_NO_CLEAR_HINT:
+      {
+        gboolean hint =
+          (priv->stage_hints & CLUTTER_STAGE_NO_CLEAR_ON_PAINT) != 0;
+
+        g_value_set_boolean (value, hint);
+      }
+      break;
+
+    case PROP_ACCEPT_FOCUS:
+      g_value_set_boolean (value, priv->accept_focus);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_stage_dispose (GObject *object)
+{
+  ClutterStage        *stage = CLUTTER_STAGE (object);
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterStageManager *stage_manager;
+
+  clutter_actor_hide (CLUTTER_ACTOR (object));
+
+  _clutter_clear_events_queue_for_stage (stage);
+
+  if (priv->impl != NULL)
+    {
+      CLUTTER_NOTE (BACKEND, "Disposing of the stage implementation");
+
+      if (CLUTTER_ACTOR_IS_REALIZED (object))
+        _clutter_stage_window_unrealize (priv->impl);
+
+      g_object_unref (priv->impl);
+      priv->impl = NULL;
+    }
+
+  clutter_actor_remove_all_children (CLUTTER_ACTOR (object));
+
+  if (priv->pending_queue_redraws != NULL)
+    {
+      guint i;
+
+      for (i = 0; i < priv->pending_queue_redraws->len; i++)
+        clear_queue_redraw_entry (&g_array_index (priv->pending_queue_redraws,
+                                                  QueueRedrawEntry,
+                                                  i));
+
+      g_array_free (priv->pending_queue_redraws, TRUE);
+      priv->pending_queue_redraws = NULL;
+    }
+
+  clutter_stage_clear_async_picks (stage);
+  clutter_stage_clear_captures (stage);
+
+  if (priv->pending_size_relayouts != NULL)
+    {
+      g_ptr_array_unref (priv->pending_size_relayouts);
+      priv->pending_size_relayouts = NULL;
+    }
+
+  clutter_stage_clear_constrained_actors (stage);
+
+  _clutter_memory_remove_purge_func (stage);
+
+  /* this will release the reference on the stage */
+  stage_manager = clutter_stage_manager_get_default ();
+  _clutter_stage_manager_remove_stage (stage_manager, stage);
+
+  G_OBJECT_CLASS (clutter_stage_parent_class)->dispose (object);
+}
+
+static void
+clutter_stage_finalize (GObject *object)
+{
+  ClutterStage *stage = CLUTTER_STAGE (object);
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterEvent *event;
+
+  while ((event = clutter_stage_pop_ring_event (stage)) != NULL)
+    clutter_event_free (event);
+
+  g_free (priv->event_ring);
+
+  g_clear_pointer (&priv->gpu_timer, _clutter_gpu_timer_free);
+  g_clear_pointer (&priv->hud, _clutter_stage_hud_free);
+  _clutter_memory_account (CLUTTER_MEMORY_EVENTS,
+                           -(gssize) sizeof (EventRing),
+                           0);
+
+  g_queue_foreach (priv->event_queue, (GFunc) clutter_event_free, NULL);
+  g_queue_free (priv->event_queue);
+
+  if (priv->input_latency_histogram != NULL)
+    {
+      clutter_stage_dump_input_latency (stage);
+      g_free (priv->input_latency_histogram);
+    }
+
+  g_free (priv->title);
+
+  g_array_free (priv->paint_volume_stack, TRUE);
+
+  _clutter_id_pool_free (priv->pick_id_pool);
+
+  _clutter_pick_index_free (priv->pick_index);
+  g_ptr_array_free (priv->pick_candidates, TRUE);
+  g_array_free (priv->pick_prefetch, TRUE);
+
+  /* the targets released by the last stage are not needed any more */
+  offscreen_pool_n_stages -= 1;
+  if (offscreen_pool_n_stages == 0)
+    g_clear_pointer (&offscreen_pool, g_hash_table_destroy);
+
+  if (priv->fps_timer != NULL)
+    g_timer_destroy (priv->fps_timer);
+
+  G_OBJECT_CLASS (clutter_stage_parent_class)->finalize (object);
+}
+
+static void
+clutter_stage_class_init (ClutterStageClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+  GParamSpec *pspec;
+
+  gobject_class->constructed = clutter_stage_constructed;
+  gobject_class->set_property = clutter_stage_set_property;
+  gobject_class->get_property = clutter_stage_get_property;
+  gobject_class->dispose = clutter_stage_dispose;
+  gobject_class->finalize = clutter_stage_finalize;
+
+  actor_class->allocate = clutter_stage_allocate;
+  actor_class->get_preferred_width = clutter_stage_get_preferred_width;
+  actor_class->get_preferred_height = clutter_stage_get_preferred_height;
+  actor_class->paint = clutter_stage_paint;
+  actor_class->pick = clutter_stage_pick;
+  actor_class->get_paint_volume = clutter_stage_get_paint_volume;
+  actor_class->realize = clutter_stage_realize;
+  actor_class->unrealize = clutter_stage_unrealize;
+  actor_class->show = clutter_stage_show;
+  actor_class->show_all = clutter_stage_show_all;
+  actor_class->hide = clutter_stage_hide;
+  actor_class->hide_all = clutter_stage_hide_all;
+  actor_class->queue_relayout = clutter_stage_real_queue_relayout;
+  actor_class->queue_redraw = clutter_stage_real_queue_redraw;
+  actor_class->apply_transform = clutter_stage_real_apply_transform;
+
+  /**
+   * ClutterStage:fullscreen:
+   *
+   * Whether the stage should be fullscreen or not.
+   *
+   * This property is set by calling clutter_stage_set_fullscreen()
+   * but since the actual implementation is delegated to the backend
+   * you should connect to the notify::fullscreen-set signal in order
+   * to get notification if the fullscreen state has been successfully
+   * achieved.
+   *
+   *
+   */
+  pspec = g_param_spec_boolean ("fullscreen-set",
+                                P_("Fullscreen Set"),
+                                P_("Whether the main stage is fullscreen"),
+                                FALSE,
+                                CLUTTER_PARAM_READABLE);
+  g_object_class_install_property (gobject_class,
+                                   PROP_FULLSCREEN_SET,
+                                   pspec);
+  /**
+   * ClutterStage:cursor-visible:
+   *
+   * Whether the mouse pointer should be visible
+   */
+  pspec = g_param_spec_boolean ("cursor-visible",
+                                P_("Cursor Visible"),
+                                P_("Whether the mouse pointer is visible on the main stage"),
+                                TRUE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class,
+                                   PROP_CURSOR_VISIBLE,
+                                   pspec);
+  /**
+   * ClutterStage:user-resizable:
+   *
+   * Whether the stage is resizable via user interaction.
+   *
+   *
+   */
+  pspec = g_param_spec_boolean ("user-resizable",
+                                P_("User Resizable"),
+                                P_("Whether the stage is able to be resized via user interaction"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class,
+                                   PROP_USER_RESIZABLE,
+                                   pspec);
+  /**
+   * ClutterStage:perspective:
+   *
+   * The parameters used for the perspective projection from 3D
+   * coordinates to 2D
+   *
+   *
+   */
+  pspec = g_param_spec_boxed ("perspective",
+                              P_("Perspective"),
+                              P_("Perspective projection parameters"),
+                              CLUTTER_TYPE_PERSPECTIVE,
+                              CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class,
+                                   PROP_PERSPECTIVE,
+                                   pspec);
+
+  /**
+   * ClutterStage:title:
+   *
+   * The stage's title - usually displayed in stage windows title decorations.
+   *
+   *
+   */
+  pspec = g_param_spec_string ("title",
+                               P_("Title"),
+                               P_("Stage Title"),
+                               NULL,
+                               CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_TITLE, pspec);
+
+  /**
+   * ClutterStage:use-alpha:
+   *
+   * Whether the #ClutterStage should honour the alpha component of the
+   * #ClutterStage:color property when painting. If Clutter is run under
+   * a compositing manager this will result in the stage being blended
+   * with the underlying window(s)
+   *
+   *
+   */
+  pspec = g_param_spec_boolean ("use-alpha",
+                                P_("Use Alpha"),
+                                P_("Whether to honour the alpha component of the stage color"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_USE_ALPHA, pspec);
+
+  /**
+   * ClutterStage:use-orthographic:
+   *
+   * Whether the #ClutterStage should use an orthographic projection
+   * instead of the #ClutterStage:perspective one
+   *
+   * See clutter_stage_set_use_orthographic().
+   */
+  pspec = g_param_spec_boolean ("use-orthographic",
+                                P_("Use Orthographic"),
+                                P_("Whether to use an orthographic projection"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_USE_ORTHOGRAPHIC, pspec);
+
+  /**
+   * ClutterStage:key-focus:
+   *
+   * The #ClutterActor that will receive key events from the underlying
+   * windowing system.
+   *
+   * If %NULL, the #ClutterStage will receive the events.
+   *
+   *
+   */
+  pspec = g_param_spec_object ("key-focus",
+                               P_("Key Focus"),
+                               P_("The currently key focused actor"),
+                               CLUTTER_TYPE_ACTOR,
+                               CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_KEY_FOCUS, pspec);
+
+  /**
+   * ClutterStage:no-clear-hint:
+   *
+   * Whether or not the #ClutterStage should clear its contents
+   * before each paint cycle.
+   *
+   * See clutter_stage_set_no_clear_hint() for further information.
+   *
+   *
+   */
+  pspec = g_param_spec_boolean ("no-clear-hint",
+                                P_("No Clear Hint"),
+                                P_("Whether the stage should clear its contents"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_NO_CLEAR_HINT, pspec);
+
+  /**
+   * ClutterStage:accept-focus:
+   *
+   * Whether the #ClutterStage should accept key focus when shown.
+   *
+   *
+   */
+  pspec = g_param_spec_boolean ("accept-focus",
+                                P_("Accept Focus"),
+                                P_("Whether the stage should accept focus on show"),
+                                TRUE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_ACCEPT_FOCUS, pspec);
+
+  /**
+   * ClutterStage::fullscreen:
+   * @stage: the stage which was fullscreened
+   *
+   * The ::fullscreen signal is emitted when the stage is made fullscreen.
+   *
+   *
+   */
+  stage_signals[FULLSCREEN] =
+    g_signal_new (I_("fullscreen"),
+		  G_TYPE_FROM_CLASS (gobject_class),
+		  G_SIGNAL_RUN_FIRST,
+		  G_STRUCT_OFFSET (ClutterStageClass, fullscreen),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__VOID,
+		  G_TYPE_NONE, 0);
+  /**
+   * ClutterStage::unfullscreen:
+   * @stage: the stage which has left a fullscreen state.
+   *
+   * The ::unfullscreen signal is emitted when the stage leaves a fullscreen
+   * state.
+   *
+   *
+   */
+  stage_signals[UNFULLSCREEN] =
+    g_signal_new (I_("unfullscreen"),
+		  G_TYPE_FROM_CLASS (gobject_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterStageClass, unfullscreen),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__VOID,
+		  G_TYPE_NONE, 0);
+  /**
+   * ClutterStage::activate:
+   * @stage: the stage which was activated
+   *
+   * The ::activate signal is emitted when the stage receives key focus
+   * from the underlying window system.
+   *
+   *
+   */
+  stage_signals[ACTIVATE] =
+    g_signal_new (I_("activate"),
+		  G_TYPE_FROM_CLASS (gobject_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterStageClass, activate),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__VOID,
+		  G_TYPE_NONE, 0);
+  /**
+   * ClutterStage::deactivate:
+   * @stage: the stage which was deactivated
+   *
+   * The ::activate signal is emitted when the stage loses key focus
+   * from the underlying window system.
+   *
+   *
+   */
+  stage_signals[DEACTIVATE] =
+    g_signal_new (I_("deactivate"),
+		  G_TYPE_FROM_CLASS (gobject_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterStageClass, deactivate),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__VOID,
+		  G_TYPE_NONE, 0);
+
+  /**
+   * ClutterStage::delete-event:
+   * @stage: the stage that received the event
+   * @event: a #ClutterEvent of type %CLUTTER_DELETE
+   *
+   * The ::delete-event signal is emitted when the user closes a
+   * #ClutterStage window using the window controls.
+   *
+   * Clutter by default will call clutter_main_quit() if @stage is
+   * the default stage, and clutter_actor_destroy() for any other
+   * stage.
+   *
+   * It is possible to override the default behaviour by connecting
+   * a new handler and returning %TRUE there.
+   *
+   * <note>This signal is emitted only on Clutter backends that
+   * embed #ClutterStage in native windows. It is not emitted for
+   * backends that use a static frame buffer.</note>
+   *
+   *
+   */
+  stage_signals[DELETE_EVENT] =
+    g_signal_new (I_("delete-event"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  G_STRUCT_OFFSET (ClutterStageClass, delete_event),
+                  _clutter_boolean_handled_accumulator, NULL,
+                  _clutter_marshal_BOOLEAN__BOXED,
+                  G_TYPE_BOOLEAN, 1,
+                  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+  /**
+   * ClutterStage::frame-stats:
+   * @stage: the #ClutterStage that was painted
+   * @stats: a #ClutterFrameStats with the duration of each phase
+   *   of the frame
+   *
+   * The ::frame-stats signal is emitted at the end of each frame that
+   * painted @stage, with the time spent in each phase of the frame.
+   *
+   * The phases of a frame are only measured while the signal has at
+   * least a handler connected.
+   */
+  stage_signals[FRAME_STATS] =
+    g_signal_new (I_("frame-stats"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  _clutter_marshal_VOID__BOXED,
+                  G_TYPE_NONE, 1,
+                  CLUTTER_TYPE_FRAME_STATS | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+  /**
+   * ClutterStage::layout-changed:
+   * @stage: the #ClutterStage that was laid out
+   *
+   * The ::layout-changed signal is emitted after a relayout of @stage
+   * that changed the allocation of at least one actor.
+   *
+   * Code that only needs to know that something moved in the current
+   * frame should use this signal instead of tracking the
+   * #ClutterActor::allocation-changed signal or the notifications of
+   * the #ClutterActor:allocation property of each actor.
+   */
+  stage_signals[LAYOUT_CHANGED] =
+    g_signal_new (I_("layout-changed"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  _clutter_marshal_VOID__VOID,
+                  G_TYPE_NONE, 0);
+
+  klass->fullscreen = clutter_stage_real_fullscreen;
+  klass->activate = clutter_stage_real_activate;
+  klass->deactivate = clutter_stage_real_deactivate;
+  klass->delete_event = clutter_stage_real_delete_event;
+
+  g_type_class_add_private (gobject_class, sizeof (ClutterStagePrivate));
+}
+
+static void
+clutter_stage_notify_min_size (ClutterStage *self)
+{
+  self->priv->min_size_changed = TRUE;
+}
+
+static void
+clutter_stage_init (ClutterStage *self)
+{
+  cairo_rectangle_int_t geom = { 0, };
+  ClutterStagePrivate *priv;
+  ClutterStageWindow *impl;
+  ClutterBackend *backend;
+  GError *error;
+  gint i;
+
+  CLUTTER_ACTOR_UNSET_FLAGS (self, CLUTTER_ACTOR_VISIBLE);
+
+  /* a stage is a top-level object */
+  CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IS_TOPLEVEL);
+
+  self->priv = priv = CLUTTER_STAGE_GET_PRIVATE (self);
+
+  CLUTTER_NOTE (BACKEND, "Creating stage from the default backend");
+  backend = clutter_get_default_backend ();
+
+  error = NULL;
+  impl = _clutter_backend_create_stage (backend, self, &error);
+
+  if (G_LIKELY (impl != NULL))
+    {
+      _clutter_stage_set_window (self, impl);
+      _clutter_stage_window_get_geometry (priv->impl, &geom);
+    }
+  else
+    {
+      if (error != NULL)
+        {
+          g_critical ("Unable to create a new stage implementation: %s",
+                      error->message);
+          g_error_free (error);
+        }
+      else
+        g_critical ("Unable to create a new stage implementation.");
+    }
+
+  priv->event_queue = g_queue_new ();
+  priv->pending_queue_redraws = g_array_new (FALSE, FALSE,
+                                             sizeof (QueueRedrawEntry));
+
+  priv->event_ring = g_new0 (EventRing, 1);
+  _clutter_memory_account (CLUTTER_MEMORY_EVENTS,
+                           sizeof (EventRing),
+                           0);
+  for (i = 0; i < EVENT_RING_SIZE; i++)
+    priv->event_ring->slots[i].sequence = i;
+
+  priv->is_fullscreen = FALSE;
+  priv->is_user_resizable = FALSE;
+  priv->is_cursor_visible = TRUE;
+  priv->throttle_motion_events = TRUE;
+  priv->min_size_changed = FALSE;
+  priv->sync_delay = -1;
+
+  if (CLUTTER_HAS_DEBUG (HUD))
+    priv->hud = _clutter_stage_hud_new ();
+
+  /* XXX - we need to keep the invariant that calling
+   * clutter_set_motion_event_enabled() before the stage creation
+   * will cause motion event delivery to be disabled on any newly
+   * created stage. this can go away when we break API and remove
+   * deprecated functions.
+   */
+  priv->motion_events_enabled = _clutter_context_get_motion_events_enabled ();
+
+  clutter_actor_set_background_color (CLUTTER_ACTOR (self),
+                                      &default_stage_color);
+
+  priv->perspective.fovy   = 60.0; /* 60 Degrees */
+  priv->perspective.aspect = (float) geom.width / (float) geom.height;
+  priv->perspective.z_near = 0.1;
+  priv->perspective.z_far  = 100.0;
+
+  cogl_matrix_init_identity (&priv->projection);
+  cogl_matrix_perspective (&priv->projection,
+                           priv->perspective.fovy,
+                           priv->perspective.aspect,
+                           priv->perspective.z_near,
+                           priv->perspective.z_far);
+  cogl_matrix_get_inverse (&priv->projection,
+                           &priv->inverse_projection);
+  cogl_matrix_init_identity (&priv->view);
+  cogl_matrix_view_2d_in_perspective (&priv->view,
+                                      priv->perspective.fovy,
+                                      priv->perspective.aspect,
+                                      priv->perspective.z_near,
+                                      50, /* distance to 2d plane */
+                                      geom.width,
+                                      geom.height);
+
+
+  priv->relayout_pending = TRUE;
+
+  clutter_actor_set_reactive (CLUTTER_ACTOR (self), TRUE);
+  clutter_stage_set_title (self, g_get_prgname ());
+  clutter_stage_set_key_focus (self, NULL);
+
+  g_signal_connect (self, "notify::min-width",
+                    G_CALLBACK (clutter_stage_notify_min_size), NULL);
+  g_signal_connect (self, "notify::min-height",
+                    G_CALLBACK (clutter_stage_notify_min_size), NULL);
+
+  _clutter_stage_set_viewport (self, 0, 0, geom.width, geom.height);
+
+  _clutter_stage_set_pick_buffer_valid (self, FALSE, CLUTTER_PICK_ALL);
+  priv->picks_per_frame = 0;
+
+  priv->paint_volume_stack =
+    g_array_new (FALSE, FALSE, sizeof (ClutterPaintVolume));
+
+  priv->pick_id_pool = _clutter_id_pool_new (256);
+
+  priv->pick_index = _clutter_pick_index_new ();
+  priv->pick_candidates = g_ptr_array_new ();
+  priv->pick_prefetch = g_array_new (FALSE, FALSE, sizeof (PickPrefetch));
+
+  if (offscreen_pool == NULL)
+    offscreen_pool = g_hash_table_new_full (offscreen_pool_key_hash,
+                                            offscreen_pool_key_equal,
+                                            offscreen_pool_key_free,
+                                            offscreen_pool_bucket_free);
+  offscreen_pool_n_stages += 1;
+  priv->pick_index_complete = FALSE;
+
+  _clutter_memory_add_purge_func (CLUTTER_MEMORY_OFFSCREEN_TARGETS,
+                                  self,
+                                  clutter_stage_purge_caches);
+}
+
+static void
+clutter_stage_update_projection (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  cogl_matrix_init_identity (&priv->projection);
+
+  if (priv->use_orthographic)
+    {
+      /* map the stage coordinates straight to the viewport, with the
+       * same room in front of and behind the stage plane as the
+       * default perspective leaves behind it
+       */
+      float z_range = MAX (priv->viewport[2], priv->viewport[3]) * 10.0f;
+
+      cogl_matrix_orthographic (&priv->projection,
+                                0, 0,
+                                priv->viewport[2],
+                                priv->viewport[3],
+                                -z_range,
+                                z_range);
+    }
+  else
+    cogl_matrix_perspective (&priv->projection,
+                             priv->perspective.fovy,
+                             priv->perspective.aspect,
+                             priv->perspective.z_near,
+                             priv->perspective.z_far);
+
+  cogl_matrix_get_inverse (&priv->projection,
+                           &priv->inverse_projection);
+
+  priv->dirty_projection = TRUE;
+  _clutter_stage_invalidate_pick (stage, TRUE);
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+}
+
+static void
+clutter_stage_set_perspective_internal (ClutterStage       *stage,
+                                        ClutterPerspective *perspective)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (priv->perspective.fovy == perspective->fovy &&
+      priv->perspective.aspect == perspective->aspect &&
+      priv->perspective.z_near == perspective->z_near &&
+      priv->perspective.z_far == perspective->z_far)
+    return;
+
+  priv->perspective = *perspective;
+
+  /* the perspective is applied when leaving the orthographic mode */
+  if (priv->use_orthographic)
+    return;
+
+  clutter_stage_update_projection (stage);
+}
+
+/**
+ * clutter_stage_set_perspective:
+ * @stage: A #ClutterStage
+ * @perspective: A #ClutterPerspective
+ *
+ * Sets the stage perspective. Using this function is not recommended
+ * because it will disable Clutter's attempts to generate an
+ * appropriate perspective based on the size of the stage.
+ *
+ * The perspective is not used while the stage is using an
+ * orthographic projection; see clutter_stage_set_use_orthographic().
+ */
+void
+clutter_stage_set_perspective (ClutterStage       *stage,
+                               ClutterPerspective *perspective)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (perspective != NULL);
+  g_return_if_fail (perspective->z_far - perspective->z_near != 0);
+
+  priv = stage->priv;
+
+  /* If the application ever calls this function then we'll stop
+     automatically updating the perspective when the stage changes
+     size */
+  priv->has_custom_perspective = TRUE;
+
+  clutter_stage_set_perspective_internal (stage, perspective);
+}
+
+/**
+ * clutter_stage_get_perspective:
+ * @stage: A #ClutterStage
+ * @perspective: (out caller-allocates) (allow-none): return location for a
+ *   #ClutterPerspective
+ *
+ * Retrieves the stage perspective.
+ */
+void
+clutter_stage_get_perspective (ClutterStage       *stage,
+                               ClutterPerspective *perspective)
+{
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (perspective != NULL);
+
+  *perspective = stage->priv->perspective;
+}
+
+/*
+ * clutter_stage_get_projection_matrix:
+ * @stage: A #ClutterStage
+ * @projection: return location for a #CoglMatrix representing the
+ *              perspective projection applied to actors on the given
+ *              @stage.
+ *
+ * Retrieves the @stage's projection matrix. This is derived from the
+ * current perspective set using clutter_stage_set_perspective().
+ *
+ *
+ */
+void
+_clutter_stage_get_projection_matrix (ClutterStage *stage,
+                                      CoglMatrix *projection)
+{
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (projection != NULL);
+
+  *projection = stage->priv->projection;
+}
+
+/* This simply provides a simple mechanism for us to ensure that
+ * the projection matrix gets re-asserted before painting.
+ *
+ * This is used when switching between multiple stages */
+void
+_clutter_stage_dirty_projection (ClutterStage *stage)
+{
+  stage->priv->dirty_projection = TRUE;
+}
+
+/*
+ * clutter_stage_set_viewport:
+ * @stage: A #ClutterStage
+ * @x: The X postition to render the stage at, in window coordinates
+ * @y: The Y position to render the stage at, in window coordinates
+ * @width: The width to render the stage at, in window coordinates
+ * @height: The height to render the stage at, in window coordinates
+ *
+ * Sets the stage viewport. The viewport defines a final scale and
+ * translation of your rendered stage and actors. This lets you render
+ * your stage into a subregion of the stage window or you could use it to
+ * pan a subregion of the stage if your stage window is smaller then
+ * the stage. (XXX: currently this isn't possible)
+ *
+ * Unlike a scale and translation done using the modelview matrix this
+ * is done after everything has had perspective projection applied, so
+ * for example if you were to pan across a subregion of the stage using
+ * the viewport then you would not see a change in perspective for the
+ * actors on the stage.
+ *
+ * Normally the stage viewport will automatically track the size of the
+ * stage window with no offset so the stage will fill your window. This
+ * behaviour can be changed with the "viewport-mimics-window" property
+ * which will automatically be set to FALSE if you use this API. If
+ * you want to revert to the original behaviour then you should set
+ * this property back to %TRUE using
+ * clutter_stage_set_viewport_mimics_window().
+ * (XXX: If we were to make this API public then we might want to do
+ *  add that property.)
+ *
+ * Note: currently this interface only support integer precision
+ * offsets and sizes for viewports but the interface takes floats because
+ * OpenGL 4.0 has introduced floating point viewports which we might
+ * want to expose via this API eventually.
+ *
+ *
+ */
+void
+_clutter_stage_set_viewport (ClutterStage *stage,
+                             float         x,
+                             float         y,
+                             float         width,
+                             float         height)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+
+  if (x == priv->viewport[0] &&
+      y == priv->viewport[1] &&
+      width == priv->viewport[2] &&
+      height == priv->viewport[3])
+    return;
+
+  priv->viewport[0] = x;
+  priv->viewport[1] = y;
+  priv->viewport[2] = width;
+  priv->viewport[3] = height;
+
+  priv->dirty_viewport = TRUE;
+  _clutter_stage_invalidate_pick (stage, TRUE);
+
+  queue_full_redraw (stage);
+}
+
+/* This simply provides a simple mechanism for us to ensure that
+ * the viewport gets re-asserted before next painting.
+ *
+ * This is used when switching between multiple stages */
+void
+_clutter_stage_dirty_viewport (ClutterStage *stage)
+{
+  stage->priv->dirty_viewport = TRUE;
+}
+
+/*
+ * clutter_stage_get_viewport:
+ * @stage: A #ClutterStage
+ * @x: A location for the X position where the stage is rendered,
+ *     in window coordinates.
+ * @y: A location for the Y position where the stage is rendered,
+ *     in window coordinates.
+ * @width: A location for the width the stage is rendered at,
+ *         in window coordinates.
+ * @height: A location for the height the stage is rendered at,
+ *          in window coordinates.
+ *
+ * Returns the viewport offset and size set using
+ * clutter_stage_set_viewport() or if the "viewport-mimics-window" property
+ * is TRUE then @x and @y will be set to 0 and @width and @height will equal
+ * the width if the stage window.
+ *
+ *
+ */
+void
+_clutter_stage_get_viewport (ClutterStage *stage,
+                             float        *x,
+                             float        *y,
+                             float        *width,
+                             float        *height)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+  *x = priv->viewport[0];
+  *y = priv->viewport[1];
+  *width = priv->viewport[2];
+  *height = priv->viewport[3];
+}
+
+/**
+ * clutter_stage_set_fullscreen:
+ * @stage: a #ClutterStage
+ * @fullscreen: %TRUE to to set the stage fullscreen
+ *
+ * Asks to place the stage window in the fullscreen or unfullscreen
+ * states.
+ *
+ ( Note that you shouldn't assume the window is definitely full screen
+ * afterward, because other entities (e.g. the user or window manager)
+ * could unfullscreen it again, and not all window managers honor
+ * requests to fullscreen windows.
+ *
+ * If you want to receive notification of the fullscreen state you
+ * should either use the #ClutterStage::fullscreen and
+ * #ClutterStage::unfullscreen signals, or use the notify signal
+ * for the #ClutterStage:fullscreen-set property
+ *
+ *
+ */
+void
+clutter_stage_set_fullscreen (ClutterStage *stage,
+                              gboolean      fullscreen)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+  if (priv->is_fullscreen != fullscreen)
+    {
+      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
+      ClutterStageWindowIface *iface;
+
+      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
+
+      /* Only set if backend implements.
+       *
+       * Also see clutter_stage_event() for setting priv->is_fullscreen
+       * on state change event.
+       */
+      if (iface->set_fullscreen)
+	iface->set_fullscreen (impl, fullscreen);
+    }
+
+  /* If the backend did fullscreen the stage window then we need to resize
+   * the stage and update its viewport so we queue a relayout.  Note: if the
+   * fullscreen request is handled asynchronously we can't rely on this
+   * queue_relayout to update the viewport, but for example the X backend
+   * will recieve a ConfigureNotify after a successful resize which is how
+   * we ensure the viewport is updated on X.
+   */
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (stage));
+}
+
+/**
+ * clutter_stage_get_fullscreen:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves whether the stage is full screen or not
+ *
+ * Return value: %TRUE if the stage is full screen
+ *
+ *
+ */
+gboolean
+clutter_stage_get_fullscreen (ClutterStage *stage)
+{
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+
+  return stage->priv->is_fullscreen;
+}
+
+/**
+ * clutter_stage_set_user_resizable:
+ * @stage: a #ClutterStage
+ * @resizable: whether the stage should be user resizable.
+ *
+ * Sets if the stage is resizable by user interaction (e.g. via
+ * window manager controls)
+ *
+ *
+ */
+void
+clutter_stage_set_user_resizable (ClutterStage *stage,
+                                  gboolean      resizable)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+  if (clutter_feature_available (CLUTTER_FEATURE_STAGE_USER_RESIZE)
+      && priv->is_user_resizable != resizable)
+    {
+      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
+      ClutterStageWindowIface *iface;
+
+      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
+      if (iface->set_user_resizable)
+        {
+          priv->is_user_resizable = resizable;
+
+          iface->set_user_resizable (impl, resizable);
+
+          g_object_notify (G_OBJECT (stage), "user-resizable");
+        }
+    }
+}
+
+/**
+ * clutter_stage_get_user_resizable:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves the value set with clutter_stage_set_user_resizable().
+ *
+ * Return value: %TRUE if the stage is resizable by the user.
+ *
+ *
+ */
+gboolean
+clutter_stage_get_user_resizable (ClutterStage *stage)
+{
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+
+  return stage->priv->is_user_resizable;
+}
+
+/**
+ * clutter_stage_show_cursor:
+ * @stage: a #ClutterStage
+ *
+ * Shows the cursor on the stage window
+ */
+void
+clutter_stage_show_cursor (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+  if (!priv->is_cursor_visible)
+    {
+      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
+      ClutterStageWindowIface *iface;
+
+      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
+      if (iface->set_cursor_visible)
+        {
+          priv->is_cursor_visible = TRUE;
+
+          iface->set_cursor_visible (impl, TRUE);
+
+          g_object_notify (G_OBJECT (stage), "cursor-visible");
+        }
+    }
+}
+
+/**
+ * clutter_stage_hide_cursor:
+ * @stage: a #ClutterStage
+ *
+ * Makes the cursor invisible on the stage window
+ *
+ *
+ */
+void
+clutter_stage_hide_cursor (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+  if (priv->is_cursor_visible)
+    {
+      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
+      ClutterStageWindowIface *iface;
+
+      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
+      if (iface->set_cursor_visible)
+        {
+          priv->is_cursor_visible = FALSE;
+
+          iface->set_cursor_visible (impl, FALSE);
+
+          g_object_notify (G_OBJECT (stage), "cursor-visible");
+        }
+    }
+}
+
+/**
+ * clutter_stage_read_pixels:
+ * @stage: A #ClutterStage
+ * @x: x coordinate of the first pixel that is read from stage
+ * @y: y coordinate of the first pixel that is read from stage
+ * @width: Width dimention of pixels to be read, or -1 for the
+ *   entire stage width
+ * @height: Height dimention of pixels to be read, or -1 for the
+ *   entire stage height
+ *
+ * Makes a screenshot of the stage in RGBA 8bit data, returns a
+ * linear buffer with @width * 4 as rowstride.
+ *
+ * The alpha data contained in the returned buffer is driver-dependent,
+ * and not guaranteed to hold any sensible value.
+ *
+ * Return value: (transfer full) (array): a pointer to newly allocated memory with the buffer
+ *   or %NULL if the read failed. Use g_free() on the returned data
+ *   to release the resources it has allocated.
+ */
+guchar *
+clutter_stage_read_pixels (ClutterStage *stage,
+                           gint          x,
+                           gint          y,
+                           gint          width,
+                           gint          height)
+{
+  ClutterActorBox box;
+  guchar *pixels;
+
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
 
-  /**
-   * ClutterStage:title:
-   *
-   * The stage's title - usually displayed in stage windows title decorations.
-   *
-   *
-   */
-  pspec = g_param_spec_string ("title",
-                               P_("Title"),
-                               P_("Stage Title"),
-                               NULL,
-                               CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class, PROP_TITLE, pspec);
+  /* Force a redraw of the stage before reading back pixels */
+  clutter_stage_ensure_current (stage);
+  clutter_actor_paint (CLUTTER_ACTOR (stage));
 
-  /**
-   * ClutterStage:use-alpha:
-   *
-   * Whether the #ClutterStage should honour the alpha component of the
-   * #ClutterStage:color property when painting. If Clutter is run under
-   * a compositing manager this will result in the stage being blended
-   * with the underlying window(s)
-   *
-   *
-   */
-  pspec = g_param_spec_boolean ("use-alpha",
-                                P_("Use Alpha"),
-                                P_("Whether to honour the alpha component of the stage color"),
-                                FALSE,
-                                CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class, PROP_USE_ALPHA, pspec);
+  clutter_actor_get_allocation_box (CLUTTER_ACTOR (stage), &box);
 
-  /**
-   * ClutterStage:key-focus:
-   *
-   * The #ClutterActor that will receive key events from the underlying
-   * windowing system.
-   *
-   * If %NULL, the #ClutterStage will receive the events.
-   *
-   *
-   */
-  pspec = g_param_spec_object ("key-focus",
-                               P_("Key Focus"),
-                               P_("The currently key focused actor"),
-                               CLUTTER_TYPE_ACTOR,
-                               CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class, PROP_KEY_FOCUS, pspec);
+  if (width < 0)
+    width = ceilf (box.x2 - box.x1);
 
-  /**
-   * ClutterStage:no-clear-hint:
-   *
-   * Whether or not the #ClutterStage should clear its contents
-   * before each paint cycle.
-   *
-   * See clutter_stage_set_no_clear_hint() for further information.
-   *
-   *
-   */
-  pspec = g_param_spec_boolean ("no-clear-hint",
-                                P_("No Clear Hint"),
-                                P_("Whether the stage should clear its contents"),
-                                FALSE,
-                                CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class, PROP_NO_CLEAR_HINT, pspec);
+  if (height < 0)
+    height = ceilf (box.y2 - box.y1);
 
-  /**
-   * ClutterStage:accept-focus:
-   *
-   * Whether the #ClutterStage should accept key focus when shown.
-   *
-   *
-   */
-  pspec = g_param_spec_boolean ("accept-focus",
-                                P_("Accept Focus"),
-                                P_("Whether the stage should accept focus on show"),
-                                TRUE,
-                                CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class, PROP_ACCEPT_FOCUS, pspec);
+  pixels = g_malloc (height * width * 4);
 
-  /**
-   * ClutterStage::fullscreen:
-   * @stage: the stage which was fullscreened
-   *
-   * The ::fullscreen signal is emitted when the stage is made fullscreen.
-   *
-   *
-   */
-  stage_signals[FULLSCREEN] =
-    g_signal_new (I_("fullscreen"),
-		  G_TYPE_FROM_CLASS (gobject_class),
-		  G_SIGNAL_RUN_FIRST,
-		  G_STRUCT_OFFSET (ClutterStageClass, fullscreen),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__VOID,
-		  G_TYPE_NONE, 0);
-  /**
-   * ClutterStage::unfullscreen:
-   * @stage: the stage which has left a fullscreen state.
-   *
-   * The ::unfullscreen signal is emitted when the stage leaves a fullscreen
-   * state.
-   *
-   *
-   */
-  stage_signals[UNFULLSCREEN] =
-    g_signal_new (I_("unfullscreen"),
-		  G_TYPE_FROM_CLASS (gobject_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterStageClass, unfullscreen),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__VOID,
-		  G_TYPE_NONE, 0);
-  /**
-   * ClutterStage::activate:
-   * @stage: the stage which was activated
-   *
-   * The ::activate signal is emitted when the stage receives key focus
-   * from the underlying window system.
-   *
-   *
-   */
-  stage_signals[ACTIVATE] =
-    g_signal_new (I_("activate"),
-		  G_TYPE_FROM_CLASS (gobject_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterStageClass, activate),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__VOID,
-		  G_TYPE_NONE, 0);
-  /**
-   * ClutterStage::deactivate:
-   * @stage: the stage which was deactivated
-   *
-   * The ::activate signal is emitted when the stage loses key focus
-   * from the underlying window system.
-   *
-   *
-   */
-  stage_signals[DEACTIVATE] =
-    g_signal_new (I_("deactivate"),
-		  G_TYPE_FROM_CLASS (gobject_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterStageClass, deactivate),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__VOID,
-		  G_TYPE_NONE, 0);
+  cogl_read_pixels (x, y, width, height,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888,
+                    pixels);
 
-  /**
-   * ClutterStage::delete-event:
-   * @stage: the stage that received the event
-   * @event: a #ClutterEvent of type %CLUTTER_DELETE
-   *
-   * The ::delete-event signal is emitted when the user closes a
-   * #ClutterStage window using the window controls.
-   *
-   * Clutter by default will call clutter_main_quit() if @stage is
-   * the default stage, and clutter_actor_destroy() for any other
-   * stage.
-   *
-   * It is possible to override the default behaviour by connecting
-   * a new handler and returning %TRUE there.
-   *
-   * <note>This signal is emitted only on Clutter backends that
-   * embed #ClutterStage in native windows. It is not emitted for
-   * backends that use a static frame buffer.</note>
-   *
-   *
-   */
-  stage_signals[DELETE_EVENT] =
-    g_signal_new (I_("delete-event"),
-                  G_TYPE_FROM_CLASS (gobject_class),
-                  G_SIGNAL_RUN_LAST,
-                  G_STRUCT_OFFSET (ClutterStageClass, delete_event),
-                  _clutter_boolean_handled_accumulator, NULL,
-                  _clutter_marshal_BOOLEAN__BOXED,
-                  G_TYPE_BOOLEAN, 1,
-                  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+  return pixels;
+}
 
-  klass->fullscreen = clutter_stage_real_fullscreen;
-  klass->activate = clutter_stage_real_activate;
-  klass->deactivate = clutter_stage_real_deactivate;
-  klass->delete_event = clutter_stage_real_delete_event;
+static void
+stage_capture_free (StageCapture *capture)
+{
+  if (capture->notify != NULL)
+    capture->notify (capture->user_data);
 
-  g_type_class_add_private (gobject_class, sizeof (ClutterStagePrivate));
+  if (capture->bitmap != NULL)
+    cogl_object_unref (capture->bitmap);
+
+  if (capture->damage != NULL)
+    g_array_free (capture->damage, TRUE);
+
+  g_slice_free (StageCapture, capture);
 }
 
 static void
-clutter_stage_notify_min_size (ClutterStage *self)
+clutter_stage_clear_captures (ClutterStage *stage)
 {
-  self->priv->min_size_changed = TRUE;
+  ClutterStagePrivate *priv = stage->priv;
+
+  g_list_free_full (priv->captures, (GDestroyNotify) stage_capture_free);
+  priv->captures = NULL;
 }
 
 static void
-clutter_stage_init (ClutterStage *self)
+clutter_stage_resolve_captures (ClutterStage *stage)
 {
-  cairo_rectangle_int_t geom = { 0, };
-  ClutterStagePrivate *priv;
-  ClutterStageWindow *impl;
-  ClutterBackend *backend;
-  GError *error;
+  ClutterStagePrivate *priv = stage->priv;
+  GList *l, *next;
 
-  CLUTTER_ACTOR_UNSET_FLAGS (self, CLUTTER_ACTOR_VISIBLE);
+  for (l = priv->captures; l != NULL; l = next)
+    {
+      StageCapture *capture = l->data;
+      CoglBuffer *buffer;
+      guchar *pixels;
 
-  /* a stage is a top-level object */
-  CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IS_TOPLEVEL);
+      next = l->next;
+
+      /* the frame has not been flushed yet, so mapping the buffer
+       * would stall the pipeline
+       */
+      if (!capture->submitted)
+        continue;
+
+      priv->captures = g_list_delete_link (priv->captures, l);
+
+      buffer = COGL_BUFFER (cogl_bitmap_get_buffer (capture->bitmap));
+      pixels = cogl_buffer_map (buffer, COGL_BUFFER_ACCESS_READ, 0);
+
+      CLUTTER_NOTE (MISC, "Asynchronous capture %s: %dx%d at %d,%d",
+                    pixels != NULL ? "resolved" : "failed",
+                    capture->rect.width, capture->rect.height,
+                    capture->rect.x, capture->rect.y);
+
+      capture->func (stage,
+                     pixels,
+                     capture->rect.width,
+                     capture->rect.height,
+                     cogl_bitmap_get_rowstride (capture->bitmap),
+                     (const cairo_rectangle_int_t *) capture->damage->data,
+                     capture->damage->len,
+                     capture->user_data);
+
+      if (pixels != NULL)
+        cogl_buffer_unmap (buffer);
+
+      stage_capture_free (capture);
+    }
+}
+
+/**
+ * clutter_stage_capture_async:
+ * @stage: A #ClutterStage
+ * @x: x coordinate of the first pixel that is read from stage
+ * @y: y coordinate of the first pixel that is read from stage
+ * @width: Width dimention of pixels to be read, or -1 for the
+ *   entire stage width
+ * @height: Height dimention of pixels to be read, or -1 for the
+ *   entire stage height
+ * @func: the function called with the captured pixels
+ * @user_data: data to pass to @func
+ * @notify: (allow-none): function called when the capture is released
+ *
+ * Asynchronously captures the contents of the next frame of @stage,
+ * without waiting for the GPU like clutter_stage_read_pixels() does.
+ *
+ * The pixels are copied into a buffer right after the next frame has
+ * been painted, and before it is presented; @func is called when the
+ * copy has completed, usually one or two frames later, together with
+ * the areas of the capture that were repainted by the frame. Calling
+ * this function after each frame allows streaming the contents of the
+ * stage, and only encoding the areas that changed.
+ *
+ * This function does not queue a redraw of @stage; if nothing changes
+ * on the stage, the capture is delayed until the next redraw.
+ */
+void
+clutter_stage_capture_async (ClutterStage            *stage,
+                             gint                     x,
+                             gint                     y,
+                             gint                     width,
+                             gint                     height,
+                             ClutterStageCaptureFunc  func,
+                             gpointer                 user_data,
+                             GDestroyNotify           notify)
+{
+  ClutterActorBox box;
+  StageCapture *capture;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (func != NULL);
+
+  clutter_actor_get_allocation_box (CLUTTER_ACTOR (stage), &box);
+
+  if (width < 0)
+    width = ceilf (box.x2 - box.x1);
+
+  if (height < 0)
+    height = ceilf (box.y2 - box.y1);
+
+  capture = g_slice_new0 (StageCapture);
+  capture->rect.x = x;
+  capture->rect.y = y;
+  capture->rect.width = width;
+  capture->rect.height = height;
+  capture->func = func;
+  capture->user_data = user_data;
+  capture->notify = notify;
+
+  stage->priv->captures = g_list_append (stage->priv->captures, capture);
+}
+
+/*< private >
+ * _clutter_stage_queue_captures:
+ * @stage: a #ClutterStage
+ * @damage: (array length=n_damage): the areas repainted by the frame,
+ *   in window coordinates
+ * @n_damage: the number of rectangles in @damage, or 0 if the whole
+ *   stage has been repainted
+ *
+ * Queues the transfer of the pending captures of @stage into pixel
+ * buffers.
+ *
+ * The stage implementations call this function after painting a frame
+ * and before presenting it, while the back buffer is still valid.
+ */
+void
+_clutter_stage_queue_captures (ClutterStage                *stage,
+                               const cairo_rectangle_int_t *damage,
+                               guint                        n_damage)
+{
+  ClutterStagePrivate *priv;
+  CoglFramebuffer *fb;
+  CoglContext *ctx;
+  GList *l;
 
-  self->priv = priv = CLUTTER_STAGE_GET_PRIVATE (self);
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-  CLUTTER_NOTE (BACKEND, "Creating stage from the default backend");
-  backend = clutter_get_default_backend ();
+  priv = stage->priv;
 
-  error = NULL;
-  impl = _clutter_backend_create_stage (backend, self, &error);
+  if (priv->captures == NULL)
+    return;
 
-  if (G_LIKELY (impl != NULL))
-    {
-      _clutter_stage_set_window (self, impl);
-      _clutter_stage_window_get_geometry (priv->impl, &geom);
-    }
-  else
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  fb = _clutter_stage_get_active_framebuffer (stage);
+
+  for (l = priv->captures; l != NULL; l = l->next)
     {
-      if (error != NULL)
+      StageCapture *capture = l->data;
+      const cairo_rectangle_int_t *rect = &capture->rect;
+      CoglPixelBuffer *buffer;
+      guint i;
+
+      if (capture->bitmap != NULL)
+        continue;
+
+      buffer = cogl_pixel_buffer_new (ctx, rect->width * rect->height * 4,
+                                      NULL);
+      if (buffer == NULL)
+        continue;
+
+      cogl_buffer_set_update_hint (COGL_BUFFER (buffer),
+                                   COGL_BUFFER_UPDATE_HINT_STREAM);
+
+      capture->bitmap = cogl_bitmap_new_from_buffer (COGL_BUFFER (buffer),
+                                                     COGL_PIXEL_FORMAT_RGBA_8888,
+                                                     rect->width,
+                                                     rect->height,
+                                                     rect->width * 4,
+                                                     0);
+      cogl_object_unref (buffer);
+
+      /* this only queues the transfer into the pixel buffer */
+      cogl_framebuffer_read_pixels_into_bitmap (fb, rect->x, rect->y,
+                                                COGL_READ_PIXELS_COLOR_BUFFER,
+                                                capture->bitmap);
+
+      capture->damage = g_array_sized_new (FALSE, FALSE,
+                                           sizeof (cairo_rectangle_int_t),
+                                           MAX (n_damage, 1));
+
+      if (n_damage == 0)
         {
-          g_critical ("Unable to create a new stage implementation: %s",
-                      error->message);
-          g_error_free (error);
+          cairo_rectangle_int_t area = { 0, 0, rect->width, rect->height };
+
+          g_array_append_val (capture->damage, area);
+          continue;
         }
-      else
-        g_critical ("Unable to create a new stage implementation.");
-    }
 
-  priv->event_queue = g_queue_new ();
+      for (i = 0; i < n_damage; i++)
+        {
+          cairo_rectangle_int_t area;
+          gint x_2, y_2;
 
-  priv->is_fullscreen = FALSE;
-  priv->is_user_resizable = FALSE;
-  priv->is_cursor_visible = TRUE;
-  priv->throttle_motion_events = TRUE;
-  priv->min_size_changed = FALSE;
-  priv->sync_delay = -1;
+          area.x = MAX (damage[i].x, rect->x);
+          area.y = MAX (damage[i].y, rect->y);
+          x_2 = MIN (damage[i].x + damage[i].width, rect->x + rect->width);
+          y_2 = MIN (damage[i].y + damage[i].height, rect->y + rect->height);
 
-  /* XXX - we need to keep the invariant that calling
-   * clutter_set_motion_event_enabled() before the stage creation
-   * will cause motion event delivery to be disabled on any newly
-   * created stage. this can go away when we break API and remove
-   * deprecated functions.
-   */
-  priv->motion_events_enabled = _clutter_context_get_motion_events_enabled ();
+          if (x_2 <= area.x || y_2 <= area.y)
+            continue;
 
-  clutter_actor_set_background_color (CLUTTER_ACTOR (self),
-                                      &default_stage_color);
+          area.width = x_2 - area.x;
+          area.height = y_2 - area.y;
+          area.x -= rect->x;
+          area.y -= rect->y;
 
-  priv->perspective.fovy   = 60.0; /* 60 Degrees */
-  priv->perspective.aspect = (float) geom.width / (float) geom.height;
-  priv->perspective.z_near = 0.1;
-  priv->perspective.z_far  = 100.0;
+          g_array_append_val (capture->damage, area);
+        }
+    }
+}
 
-  cogl_matrix_init_identity (&priv->projection);
-  cogl_matrix_perspective (&priv->projection,
-                           priv->perspective.fovy,
-                           priv->perspective.aspect,
-                           priv->perspective.z_near,
-                           priv->perspective.z_far);
-  cogl_matrix_get_inverse (&priv->projection,
-                           &priv->inverse_projection);
-  cogl_matrix_init_identity (&priv->view);
-  cogl_matrix_view_2d_in_perspective (&priv->view,
-                                      priv->perspective.fovy,
-                                      priv->perspective.aspect,
-                                      priv->perspective.z_near,
-                                      50, /* distance to 2d plane */
-                                      geom.width,
-                                      geom.height);
+/**
+ * clutter_stage_get_actor_at_pos:
+ * @stage: a #ClutterStage
+ * @pick_mode: how the scene graph should be painted
+ * @x: X coordinate to check
+ * @y: Y coordinate to check
+ *
+ * Checks the scene at the coordinates @x and @y and returns a pointer
+ * to the #ClutterActor at those coordinates.
+ *
+ * By using @pick_mode it is possible to control which actors will be
+ * painted and thus available.
+ *
+ * Return value: (transfer none): the actor at the specified coordinates,
+ *   if any
+ */
+ClutterActor *
+clutter_stage_get_actor_at_pos (ClutterStage    *stage,
+                                ClutterPickMode  pick_mode,
+                                gint             x,
+                                gint             y)
+{
+  return _clutter_stage_do_pick (stage, x, y, pick_mode);
+}
 
+/**
+ * clutter_stage_get_actors_at_positions:
+ * @stage: a #ClutterStage
+ * @pick_mode: how the scene graph should be painted
+ * @positions: (array length=n_positions): the positions to check
+ * @n_positions: the number of positions inside @positions
+ * @actors: (out caller-allocates) (array length=n_positions) (transfer none):
+ *   return location for an array of @n_positions actors
+ *
+ * Checks the scene at each of the given @positions and stores a pointer
+ * to the #ClutterActor at those coordinates inside @actors.
+ *
+ * This function is equivalent to calling clutter_stage_get_actor_at_pos()
+ * for each position, but the scene is painted once for all the positions,
+ * and the result is read back in a single operation.
+ */
+void
+clutter_stage_get_actors_at_positions (ClutterStage       *stage,
+                                       ClutterPickMode     pick_mode,
+                                       const ClutterPoint *positions,
+                                       guint               n_positions,
+                                       ClutterActor      **actors)
+{
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (n_positions == 0 || positions != NULL);
+  g_return_if_fail (n_positions == 0 || actors != NULL);
 
-  priv->relayout_pending = TRUE;
+  _clutter_stage_do_pick_positions (stage, positions, n_positions,
+                                    pick_mode,
+                                    actors);
+}
 
-  clutter_actor_set_reactive (CLUTTER_ACTOR (self), TRUE);
-  clutter_stage_set_title (self, g_get_prgname ());
-  clutter_stage_set_key_focus (self, NULL);
+/**
+ * clutter_stage_event:
+ * @stage: a #ClutterStage
+ * @event: a #ClutterEvent
+ *
+ * This function is used to emit an event on the main stage.
+ *
+ * You should rarely need to use this function, except for
+ * synthetised events.
+ *
+ * Return value: the return value from the signal emission
+ *
+ *
+ */
+gboolean
+clutter_stage_event (ClutterStage *stage,
+                     ClutterEvent *event)
+{
+  ClutterStagePrivate *priv;
 
-  g_signal_connect (self, "notify::min-width",
-                    G_CALLBACK (clutter_stage_notify_min_size), NULL);
-  g_signal_connect (self, "notify::min-height",
-                    G_CALLBACK (clutter_stage_notify_min_size), NULL);
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  g_return_val_if_fail (event != NULL, FALSE);
 
-  _clutter_stage_set_viewport (self, 0, 0, geom.width, geom.height);
+  priv = stage->priv;
 
-  _clutter_stage_set_pick_buffer_valid (self, FALSE, CLUTTER_PICK_ALL);
-  priv->picks_per_frame = 0;
+  if (event->type == CLUTTER_DELETE)
+    {
+      gboolean retval = FALSE;
 
-  priv->paint_volume_stack =
-    g_array_new (FALSE, FALSE, sizeof (ClutterPaintVolume));
+      g_signal_emit_by_name (stage, "event", event, &retval);
 
-  priv->pick_id_pool = _clutter_id_pool_new (256);
-}
+      if (!retval)
+        g_signal_emit_by_name (stage, "delete-event", event, &retval);
 
-static void
-clutter_stage_set_perspective_internal (ClutterStage       *stage,
-                                        ClutterPerspective *perspective)
-{
-  ClutterStagePrivate *priv = stage->priv;
+      return retval;
+    }
 
-  if (priv->perspective.fovy == perspective->fovy &&
-      priv->perspective.aspect == perspective->aspect &&
-      priv->perspective.z_near == perspective->z_near &&
-      priv->perspective.z_far == perspective->z_far)
-    return;
+  if (event->type != CLUTTER_STAGE_STATE)
+    return FALSE;
 
-  priv->perspective = *perspective;
+  /* emit raw event */
+  if (clutter_actor_event (CLUTTER_ACTOR (stage), event, FALSE))
+    return TRUE;
 
-  cogl_matrix_init_identity (&priv->projection);
-  cogl_matrix_perspective (&priv->projection,
-                           priv->perspective.fovy,
-                           priv->perspective.aspect,
-                           priv->perspective.z_near,
-                           priv->perspective.z_far);
-  cogl_matrix_get_inverse (&priv->projection,
-                           &priv->inverse_projection);
+  if (event->stage_state.changed_mask & CLUTTER_STAGE_STATE_FULLSCREEN)
+    {
+      if (event->stage_state.new_state & CLUTTER_STAGE_STATE_FULLSCREEN)
+	{
+	  priv->is_fullscreen = TRUE;
+	  g_signal_emit (stage, stage_signals[FULLSCREEN], 0);
 
-  priv->dirty_projection = TRUE;
-  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+          g_object_notify (G_OBJECT (stage), "fullscreen-set");
+	}
+      else
+	{
+	  priv->is_fullscreen = FALSE;
+	  g_signal_emit (stage, stage_signals[UNFULLSCREEN], 0);
+
+          g_object_notify (G_OBJECT (stage), "fullscreen-set");
+	}
+    }
+
+  if (event->stage_state.changed_mask & CLUTTER_STAGE_STATE_ACTIVATED)
+    {
+      if (event->stage_state.new_state & CLUTTER_STAGE_STATE_ACTIVATED)
+	g_signal_emit (stage, stage_signals[ACTIVATE], 0);
+      else
+	g_signal_emit (stage, stage_signals[DEACTIVATE], 0);
+    }
+
+  return TRUE;
 }
 
 /**
- * clutter_stage_set_perspective:
+ * clutter_stage_set_title:
  * @stage: A #ClutterStage
- * @perspective: A #ClutterPerspective
+ * @title: A utf8 string for the stage windows title.
  *
- * Sets the stage perspective. Using this function is not recommended
- * because it will disable Clutter's attempts to generate an
- * appropriate perspective based on the size of the stage.
- */
+ * Sets the stage title.
+ *
+ *
+ **/
 void
-clutter_stage_set_perspective (ClutterStage       *stage,
-                               ClutterPerspective *perspective)
+clutter_stage_set_title (ClutterStage       *stage,
+			 const gchar        *title)
 {
   ClutterStagePrivate *priv;
+  ClutterStageWindow *impl;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail (perspective != NULL);
-  g_return_if_fail (perspective->z_far - perspective->z_near != 0);
 
   priv = stage->priv;
 
-  /* If the application ever calls this function then we'll stop
-     automatically updating the perspective when the stage changes
-     size */
-  priv->has_custom_perspective = TRUE;
+  g_free (priv->title);
+  priv->title = g_strdup (title);
 
-  clutter_stage_set_perspective_internal (stage, perspective);
+  impl = CLUTTER_STAGE_WINDOW (priv->impl);
+  if (CLUTTER_STAGE_WINDOW_GET_IFACE(impl)->set_title != NULL)
+    CLUTTER_STAGE_WINDOW_GET_IFACE (impl)->set_title (impl, priv->title);
+
+  g_object_notify (G_OBJECT (stage), "title");
 }
 
 /**
- * clutter_stage_get_perspective:
+ * clutter_stage_get_title:
  * @stage: A #ClutterStage
- * @perspective: (out caller-allocates) (allow-none): return location for a
- *   #ClutterPerspective
  *
- * Retrieves the stage perspective.
- */
-void
-clutter_stage_get_perspective (ClutterStage       *stage,
-                               ClutterPerspective *perspective)
+ * Gets the stage title.
+ *
+ * Return value: pointer to the title string for the stage. The
+ * returned string is owned by the actor and should not
+ * be modified or freed.
+ *
+ *
+ **/
+const gchar *
+clutter_stage_get_title (ClutterStage       *stage)
 {
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail (perspective != NULL);
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
 
-  *perspective = stage->priv->perspective;
+  return stage->priv->title;
+}
+
+static void
+on_key_focus_destroy (ClutterActor *actor,
+                      ClutterStage *stage)
+{
+  /* unset the key focus */
+  clutter_stage_set_key_focus (stage, NULL);
 }
 
-/*
- * clutter_stage_get_projection_matrix:
- * @stage: A #ClutterStage
- * @projection: return location for a #CoglMatrix representing the
- *              perspective projection applied to actors on the given
- *              @stage.
+/**
+ * clutter_stage_set_key_focus:
+ * @stage: the #ClutterStage
+ * @actor: (allow-none): the actor to set key focus to, or %NULL
  *
- * Retrieves the @stage's projection matrix. This is derived from the
- * current perspective set using clutter_stage_set_perspective().
+ * Sets the key focus on @actor. An actor with key focus will receive
+ * all the key events. If @actor is %NULL, the stage will receive
+ * focus.
  *
  *
  */
 void
-_clutter_stage_get_projection_matrix (ClutterStage *stage,
-                                      CoglMatrix *projection)
+clutter_stage_set_key_focus (ClutterStage *stage,
+			     ClutterActor *actor)
 {
+  ClutterStagePrivate *priv;
+
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail (projection != NULL);
+  g_return_if_fail (actor == NULL || CLUTTER_IS_ACTOR (actor));
 
-  *projection = stage->priv->projection;
-}
+  priv = stage->priv;
 
-/* This simply provides a simple mechanism for us to ensure that
- * the projection matrix gets re-asserted before painting.
- *
- * This is used when switching between multiple stages */
-void
-_clutter_stage_dirty_projection (ClutterStage *stage)
-{
-  stage->priv->dirty_projection = TRUE;
+  /* normalize the key focus. NULL == stage */
+  if (actor == CLUTTER_ACTOR (stage))
+    actor = NULL;
+
+  /* avoid emitting signals and notifications if we're setting the same
+   * actor as the key focus
+   */
+  if (priv->key_focused_actor == actor)
+    return;
+
+  if (priv->key_focused_actor != NULL)
+    {
+      ClutterActor *old_focused_actor;
+
+      old_focused_actor = priv->key_focused_actor;
+
+      /* set key_focused_actor to NULL before emitting the signal or someone
+       * might hide the previously focused actor in the signal handler and we'd
+       * get re-entrant call and get glib critical from g_object_weak_unref
+       */
+      g_signal_handlers_disconnect_by_func (priv->key_focused_actor,
+                                            G_CALLBACK (on_key_focus_destroy),
+                                            stage);
+      priv->key_focused_actor = NULL;
+
+      g_signal_emit_by_name (old_focused_actor, "key-focus-out");
+    }
+  else
+    g_signal_emit_by_name (stage, "key-focus-out");
+
+  /* Note, if someone changes key focus in focus-out signal handler we'd be
+   * overriding the latter call below moving the focus where it was originally
+   * intended. The order of events would be:
+   *   1st focus-out, 2nd focus-out (on stage), 2nd focus-in, 1st focus-in
+   */
+  if (actor != NULL)
+    {
+      priv->key_focused_actor = actor;
+
+      g_signal_connect (actor,
+                        "destroy", G_CALLBACK (on_key_focus_destroy),
+                        stage);
+      g_signal_emit_by_name (priv->key_focused_actor, "key-focus-in");
+    }
+  else
+    g_signal_emit_by_name (stage, "key-focus-in");
+
+  g_object_notify (G_OBJECT (stage), "key-focus");
 }
 
-/*
- * clutter_stage_set_viewport:
- * @stage: A #ClutterStage
- * @x: The X postition to render the stage at, in window coordinates
- * @y: The Y position to render the stage at, in window coordinates
- * @width: The width to render the stage at, in window coordinates
- * @height: The height to render the stage at, in window coordinates
- *
- * Sets the stage viewport. The viewport defines a final scale and
- * translation of your rendered stage and actors. This lets you render
- * your stage into a subregion of the stage window or you could use it to
- * pan a subregion of the stage if your stage window is smaller then
- * the stage. (XXX: currently this isn't possible)
- *
- * Unlike a scale and translation done using the modelview matrix this
- * is done after everything has had perspective projection applied, so
- * for example if you were to pan across a subregion of the stage using
- * the viewport then you would not see a change in perspective for the
- * actors on the stage.
+/**
+ * clutter_stage_get_key_focus:
+ * @stage: the #ClutterStage
  *
- * Normally the stage viewport will automatically track the size of the
- * stage window with no offset so the stage will fill your window. This
- * behaviour can be changed with the "viewport-mimics-window" property
- * which will automatically be set to FALSE if you use this API. If
- * you want to revert to the original behaviour then you should set
- * this property back to %TRUE using
- * clutter_stage_set_viewport_mimics_window().
- * (XXX: If we were to make this API public then we might want to do
- *  add that property.)
+ * Retrieves the actor that is currently under key focus.
  *
- * Note: currently this interface only support integer precision
- * offsets and sizes for viewports but the interface takes floats because
- * OpenGL 4.0 has introduced floating point viewports which we might
- * want to expose via this API eventually.
+ * Return value: (transfer none): the actor with key focus, or the stage
  *
  *
  */
-void
-_clutter_stage_set_viewport (ClutterStage *stage,
-                             float         x,
-                             float         y,
-                             float         width,
-                             float         height)
+ClutterActor *
+clutter_stage_get_key_focus (ClutterStage *stage)
 {
-  ClutterStagePrivate *priv;
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
 
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  if (stage->priv->key_focused_actor)
+    return stage->priv->key_focused_actor;
 
-  priv = stage->priv;
+  return CLUTTER_ACTOR (stage);
+}
 
+/*** Perspective boxed type ******/
 
-  if (x == priv->viewport[0] &&
-      y == priv->viewport[1] &&
-      width == priv->viewport[2] &&
-      height == priv->viewport[3])
-    return;
+static gpointer
+clutter_perspective_copy (gpointer data)
+{
+  if (G_LIKELY (data))
+    return g_slice_dup (ClutterPerspective, data);
 
-  priv->viewport[0] = x;
-  priv->viewport[1] = y;
-  priv->viewport[2] = width;
-  priv->viewport[3] = height;
+  return NULL;
+}
 
-  priv->dirty_viewport = TRUE;
+static void
+clutter_perspective_free (gpointer data)
+{
+  if (G_LIKELY (data))
+    g_slice_free (ClutterPerspective, data);
+}
 
-  queue_full_redraw (stage);
+G_DEFINE_BOXED_TYPE (ClutterPerspective, clutter_perspective,
+                     clutter_perspective_copy,
+                     clutter_perspective_free);
+
+/*** Frame statistics boxed type ******/
+
+static gpointer
+clutter_frame_stats_copy (gpointer data)
+{
+  if (G_LIKELY (data))
+    return g_slice_dup (ClutterFrameStats, data);
+
+  return NULL;
 }
 
-/* This simply provides a simple mechanism for us to ensure that
- * the viewport gets re-asserted before next painting.
- *
- * This is used when switching between multiple stages */
-void
-_clutter_stage_dirty_viewport (ClutterStage *stage)
+static void
+clutter_frame_stats_free (gpointer data)
 {
-  stage->priv->dirty_viewport = TRUE;
+  if (G_LIKELY (data))
+    g_slice_free (ClutterFrameStats, data);
 }
 
-/*
- * clutter_stage_get_viewport:
- * @stage: A #ClutterStage
- * @x: A location for the X position where the stage is rendered,
- *     in window coordinates.
- * @y: A location for the Y position where the stage is rendered,
- *     in window coordinates.
- * @width: A location for the width the stage is rendered at,
- *         in window coordinates.
- * @height: A location for the height the stage is rendered at,
- *          in window coordinates.
+G_DEFINE_BOXED_TYPE (ClutterFrameStats, clutter_frame_stats,
+                     clutter_frame_stats_copy,
+                     clutter_frame_stats_free);
+
+/**
+ * clutter_stage_new:
  *
- * Returns the viewport offset and size set using
- * clutter_stage_set_viewport() or if the "viewport-mimics-window" property
- * is TRUE then @x and @y will be set to 0 and @width and @height will equal
- * the width if the stage window.
+ * Creates a new, non-default stage. A non-default stage is a new
+ * top-level actor which can be used as another container. It works
+ * exactly like the default stage, but while clutter_stage_get_default()
+ * will always return the same instance, you will have to keep a pointer
+ * to any #ClutterStage returned by clutter_stage_new().
+ *
+ * The ability to support multiple stages depends on the current
+ * backend. Use clutter_feature_available() and
+ * %CLUTTER_FEATURE_STAGE_MULTIPLE to check at runtime whether a
+ * backend supports multiple stages.
+ *
+ * Return value: a new stage, or %NULL if the default backend does
+ *   not support multiple stages. Use clutter_actor_destroy() to
+ *   programmatically close the returned stage.
  *
  *
  */
-void
-_clutter_stage_get_viewport (ClutterStage *stage,
-                             float        *x,
-                             float        *y,
-                             float        *width,
-                             float        *height)
+ClutterActor *
+clutter_stage_new (void)
 {
-  ClutterStagePrivate *priv;
+  return g_object_new (CLUTTER_TYPE_STAGE, NULL);
+}
 
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+/**
+ * clutter_stage_new_offscreen:
+ * @width: the width of the stage, in pixels
+ * @height: the height of the stage, in pixels
+ *
+ * Creates a new stage that renders into an offscreen framebuffer of
+ * the given size, instead of a window of the windowing system; this
+ * is useful to render frames without showing them, for instance when
+ * generating thumbnails or exporting a video.
+ *
+ * Offscreen stages are not updated by the frame clock: each frame has
+ * to be rendered using clutter_stage_render_frame(), once the stage
+ * has been shown with clutter_actor_show(). The result is available
+ * through clutter_stage_get_offscreen_texture(), or read back using
+ * clutter_stage_read_pixels() and clutter_stage_capture_async().
+ *
+ * Return value: a new offscreen stage. Use clutter_actor_destroy() to
+ *   release the returned stage.
+ */
+ClutterActor *
+clutter_stage_new_offscreen (gint width,
+                             gint height)
+{
+  ClutterStage *stage;
 
-  priv = stage->priv;
+  g_return_val_if_fail (width > 0 && height > 0, NULL);
 
-  *x = priv->viewport[0];
-  *y = priv->viewport[1];
-  *width = priv->viewport[2];
-  *height = priv->viewport[3];
+  stage = g_object_new (CLUTTER_TYPE_STAGE, NULL);
+
+  /* the window created by the backend has not been realized yet */
+  _clutter_stage_set_window (stage,
+                             _clutter_stage_offscreen_new (stage,
+                                                           width,
+                                                           height));
+  stage->priv->is_offscreen = TRUE;
+
+  clutter_actor_set_size (CLUTTER_ACTOR (stage), width, height);
+
+  return CLUTTER_ACTOR (stage);
 }
 
 /**
- * clutter_stage_set_fullscreen:
- * @stage: a #ClutterStage
- * @fullscreen: %TRUE to to set the stage fullscreen
- *
- * Asks to place the stage window in the fullscreen or unfullscreen
- * states.
+ * clutter_stage_render_frame:
+ * @stage: an offscreen #ClutterStage
+ * @frame_time: the time of the frame, in microseconds
  *
- ( Note that you shouldn't assume the window is definitely full screen
- * afterward, because other entities (e.g. the user or window manager)
- * could unfullscreen it again, and not all window managers honor
- * requests to fullscreen windows.
+ * Renders a frame of a stage created using clutter_stage_new_offscreen().
  *
- * If you want to receive notification of the fullscreen state you
- * should either use the #ClutterStage::fullscreen and
- * #ClutterStage::unfullscreen signals, or use the notify signal
- * for the #ClutterStage:fullscreen-set property
+ * All the timelines are advanced to @frame_time before the stage is
+ * laid out and painted; the time can be unrelated to the system clock,
+ * so frames can be rendered as fast as possible, or at a fixed rate
+ * regardless of the time they take.
  *
+ * Once this function has been called, the timelines are only advanced
+ * by the rendered frames, also for the stages that are not offscreen.
  *
+ * Return value: %TRUE if the contents of the stage changed, and
+ *   %FALSE if the previous frame is still valid
  */
-void
-clutter_stage_set_fullscreen (ClutterStage *stage,
-                              gboolean      fullscreen)
+gboolean
+clutter_stage_render_frame (ClutterStage *stage,
+                            gint64        frame_time)
 {
-  ClutterStagePrivate *priv;
+  gboolean retval;
 
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  g_return_val_if_fail (stage->priv->is_offscreen, FALSE);
 
-  priv = stage->priv;
+  if (!CLUTTER_ACTOR_IS_REALIZED (stage))
+    return FALSE;
 
-  if (priv->is_fullscreen != fullscreen)
-    {
-      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
-      ClutterStageWindowIface *iface;
+  CLUTTER_NOTE (SCHEDULER, "Rendering offscreen stage '%s'[%p] at %"
+                G_GINT64_FORMAT,
+                _clutter_actor_get_debug_name (CLUTTER_ACTOR (stage)),
+                stage,
+                frame_time);
 
-      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
+  /* in case the stage gets destroyed while processing the frame */
+  g_object_ref (stage);
 
-      /* Only set if backend implements.
-       *
-       * Also see clutter_stage_event() for setting priv->is_fullscreen
-       * on state change event.
-       */
-      if (iface->set_fullscreen)
-	iface->set_fullscreen (impl, fullscreen);
-    }
+  _clutter_stage_process_queued_events (stage);
 
-  /* If the backend did fullscreen the stage window then we need to resize
-   * the stage and update its viewport so we queue a relayout.  Note: if the
-   * fullscreen request is handled asynchronously we can't rely on this
-   * queue_relayout to update the viewport, but for example the X backend
-   * will recieve a ConfigureNotify after a successful resize which is how
-   * we ensure the viewport is updated on X.
-   */
-  clutter_actor_queue_relayout (CLUTTER_ACTOR (stage));
+  _clutter_master_clock_advance_to (_clutter_master_clock_get_default (),
+                                    frame_time);
+
+  _clutter_run_repaint_functions (CLUTTER_REPAINT_FLAGS_PRE_PAINT);
+  retval = _clutter_stage_do_update (stage);
+  _clutter_run_repaint_functions (CLUTTER_REPAINT_FLAGS_POST_PAINT);
+
+  if (retval)
+    _clutter_stage_expire_offscreen_pool ();
+
+  g_object_unref (stage);
+
+  return retval;
 }
 
 /**
- * clutter_stage_get_fullscreen:
+ * clutter_stage_get_offscreen_texture:
  * @stage: a #ClutterStage
  *
- * Retrieves whether the stage is full screen or not
- *
- * Return value: %TRUE if the stage is full screen
+ * Retrieves the texture holding the last frame rendered by a stage
+ * created using clutter_stage_new_offscreen().
  *
+ * The texture is replaced when the stage is resized.
  *
+ * Return value: (transfer none): a handle for a Cogl texture, or
+ *   %COGL_INVALID_HANDLE if @stage is not an offscreen stage or if
+ *   it has not been shown yet
  */
-gboolean
-clutter_stage_get_fullscreen (ClutterStage *stage)
+CoglHandle
+clutter_stage_get_offscreen_texture (ClutterStage *stage)
 {
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), COGL_INVALID_HANDLE);
 
-  return stage->priv->is_fullscreen;
+  if (!stage->priv->is_offscreen)
+    return COGL_INVALID_HANDLE;
+
+  return _clutter_stage_offscreen_get_texture (stage->priv->impl);
 }
 
 /**
- * clutter_stage_set_user_resizable:
- * @stage: a #ClutterStage
- * @resizable: whether the stage should be user resizable.
+ * clutter_stage_ensure_current:
+ * @stage: the #ClutterStage
  *
- * Sets if the stage is resizable by user interaction (e.g. via
- * window manager controls)
+ * This function essentially makes sure the right GL context is
+ * current for the passed stage. It is not intended to
+ * be used by applications.
  *
  *
  */
 void
-clutter_stage_set_user_resizable (ClutterStage *stage,
-                                  gboolean      resizable)
+clutter_stage_ensure_current (ClutterStage *stage)
 {
-  ClutterStagePrivate *priv;
+  ClutterBackend *backend;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-  priv = stage->priv;
-
-  if (clutter_feature_available (CLUTTER_FEATURE_STAGE_USER_RESIZE)
-      && priv->is_user_resizable != resizable)
-    {
-      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
-      ClutterStageWindowIface *iface;
-
-      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
-      if (iface->set_user_resizable)
-        {
-          priv->is_user_resizable = resizable;
-
-          iface->set_user_resizable (impl, resizable);
-
-          g_object_notify (G_OBJECT (stage), "user-resizable");
-        }
-    }
+  backend = clutter_get_default_backend ();
+  _clutter_backend_ensure_context (backend, stage);
 }
 
 /**
- * clutter_stage_get_user_resizable:
+ * clutter_stage_ensure_viewport:
  * @stage: a #ClutterStage
  *
- * Retrieves the value set with clutter_stage_set_user_resizable().
+ * Ensures that the GL viewport is updated with the current
+ * stage window size.
  *
- * Return value: %TRUE if the stage is resizable by the user.
+ * This function will queue a redraw of @stage.
+ *
+ * This function should not be called by applications; it is used
+ * when embedding a #ClutterStage into a toolkit with another
+ * windowing system, like GTK+.
  *
  *
  */
-gboolean
-clutter_stage_get_user_resizable (ClutterStage *stage)
+void
+clutter_stage_ensure_viewport (ClutterStage *stage)
 {
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-  return stage->priv->is_user_resizable;
+  _clutter_stage_dirty_viewport (stage);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
 }
 
-/**
- * clutter_stage_show_cursor:
- * @stage: a #ClutterStage
+/* This calculates a distance into the view frustum to position the
+ * stage so there is a decent amount of space to position geometry
+ * between the stage and the near clipping plane.
  *
- * Shows the cursor on the stage window
+ * Some awkward issues with this problem are:
+ * - It's not possible to have a gap as large as the stage size with
+ *   a fov > 53° which is basically always the case since the default
+ *   fov is 60°.
+ *    - This can be deduced if you consider that this requires a
+ *      triangle as wide as it is deep to fit in the frustum in front
+ *      of the z_near plane. That triangle will always have an angle
+ *      of 53.13° at the point sitting on the z_near plane, but if the
+ *      frustum has a wider fov angle the left/right clipping planes
+ *      can never converge with the two corners of our triangle no
+ *      matter what size the triangle has.
+ * - With a fov > 53° there is a trade off between maximizing the gap
+ *   size relative to the stage size but not loosing depth precision.
+ * - Perhaps ideally we wouldn't just consider the fov on the y-axis
+ *   that is usually used to define a perspective, we would consider
+ *   the fov of the axis with the largest stage size so the gap would
+ *   accommodate that size best.
+ *
+ * After going around in circles a few times with how to handle these
+ * issues, we decided in the end to go for the simplest solution to
+ * start with instead of an elaborate function that handles arbitrary
+ * fov angles that we currently have no use-case for.
+ *
+ * The solution assumes a fovy of 60° and for that case gives a gap
+ * that's 85% of the stage height. We can consider more elaborate
+ * functions if necessary later.
+ *
+ * One guide we had to steer the gap size we support is the
+ * interactive test, test-texture-quality which expects to animate an
+ * actor to +400 on the z axis with a stage size of 640x480. A gap
+ * that's 85% of the stage height gives a gap of 408 in that case.
  */
-void
-clutter_stage_show_cursor (ClutterStage *stage)
+static float
+calculate_z_translation (float z_near)
 {
-  ClutterStagePrivate *priv;
+  /* This solution uses fairly basic trigonometry, but is seems worth
+   * clarifying the particular geometry we are looking at in-case
+   * anyone wants to develop this further later. Not sure how well an
+   * ascii diagram is going to work :-)
+   *
+   *    |--- stage_height ---|
+   *    |     stage line     |
+   *   ╲━━━━━━━━━━━━━━━━━━━━━╱------------
+   *    ╲.  (2)   │        .╱       |   |
+   *   C ╲ .      │      . ╱     gap|   |
+   * =0.5°╲  . a  │    .  ╱         |   |
+   *      b╲(1). D│  .   ╱          |   |
+   *        ╲   B.│.    ╱near plane |   |
+   *      A= ╲━━━━━━━━━╱-------------   |
+   *     120° ╲ c │   ╱  |            z_2d
+   *           ╲  │  ╱  z_near          |
+   *       left ╲ │ ╱    |              |
+   *       clip  60°fovy |              |
+   *       plane  ╳----------------------
+   *              |
+   *              |
+   *         origin line
+   *
+   * The area of interest is the triangle labeled (1) at the top left
+   * marked with the ... line (a) from where the origin line crosses
+   * the near plane to the top left where the stage line cross the
+   * left clip plane.
+   *
+   * The sides of the triangle are a, b and c and the corresponding
+   * angles opposite those sides are A, B and C.
+   *
+   * The angle of C is what trades off the gap size we have relative
+   * to the stage size vs the depth precision we have.
+   *
+   * As mentioned above we arove at the angle for C is by working
+   * backwards from how much space we want for test-texture-quality.
+   * With a stage_height of 480 we want a gap > 400, ideally we also
+   * wanted a somewhat round number as a percentage of the height for
+   * documentation purposes. ~87% or a gap of ~416 is the limit
+   * because that's where we approach a C angle of 0° and effectively
+   * loose all depth precision.
+   *
+   * So for our test app with a stage_height of 480 if we aim for a
+   * gap of 408 (85% of 480) we can get the angle D as
+   * atan (stage_height/2/408) = 30.5°.
+   *
+   * That gives us the angle for B as 90° - 30.5° = 59.5°
+   *
+   * We can already determine that A has an angle of (fovy/2 + 90°) =
+   * 120°
+   *
+   * Therefore C = 180 - A - B = 0.5°
+   *
+   * The length of c = z_near * tan (30°)
+   *
+   * Now we can use the rule a/SinA = c/SinC to calculate the
+   * length of a. After some rearranging that gives us:
+   *
+   *      a              c
+   *  ----------  =  ----------
+   *  sin (120°)     sin (0.5°)
+   *
+   *      c * sin (120°)
+   *  a = --------------
+   *        sin (0.5°)
+   *
+   * And with that we can determine z_2d = cos (D) * a =
+   * cos (30.5°) * a + z_near:
+   *
+   *         c * sin (120°) * cos (30.5°)
+   *  z_2d = --------------------------- + z_near
+   *                 sin (0.5°)
+   */
+#define _DEG_TO_RAD (G_PI / 180.0)
+  return z_near * tanf (30.0f * _DEG_TO_RAD) *
+         sinf (120.0f * _DEG_TO_RAD) * cosf (30.5f * _DEG_TO_RAD) /
+         sinf (0.5f * _DEG_TO_RAD) +
+         z_near;
+#undef _DEG_TO_RAD
+   /* We expect the compiler should boil this down to z_near * CONSTANT */
+}
 
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+/* updates the view matrix, and the projection depending on it, for
+ * the current viewport
+ */
+static void
+clutter_stage_update_view (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterPerspective perspective;
+  float z_2d;
+
+  /* the volumes in eye coordinates of the last paint depend on it */
+  priv->view_generation += 1;
+
+  /* the orthographic projection already maps the stage coordinates
+   * to the viewport, so the view does not need to move the stage
+   * plane away from the eye; this also keeps the modelview matrices
+   * of a flat scene free of any perspective term
+   */
+  if (priv->use_orthographic)
+    {
+      cogl_matrix_init_identity (&priv->view);
+      clutter_stage_update_projection (stage);
+      return;
+    }
+
+  perspective = priv->perspective;
+
+      /* Ideally we want to regenerate the perspective matrix whenever
+       * the size changes but if the user has provided a custom matrix
+       * then we don't want to override it */
+  if (!priv->has_custom_perspective)
+    {
+      perspective.aspect = priv->viewport[2] / priv->viewport[3];
+      z_2d = calculate_z_translation (perspective.z_near);
+
+#define _DEG_TO_RAD (G_PI / 180.0)
+      /* NB: z_2d is only enough room for 85% of the stage_height between
+       * the stage and the z_near plane. For behind the stage plane we
+       * want a more consistent gap of 10 times the stage_height before
+       * hitting the far plane so we calculate that relative to the final
+       * height of the stage plane at the z_2d_distance we got... */
+      perspective.z_far = z_2d +
+        tanf ((perspective.fovy / 2.0f) * _DEG_TO_RAD) * z_2d * 20.0f;
+#undef _DEG_TO_RAD
+
+      clutter_stage_set_perspective_internal (stage, &perspective);
+    }
+  else
+    z_2d = calculate_z_translation (perspective.z_near);
+
+  cogl_matrix_init_identity (&priv->view);
+  cogl_matrix_view_2d_in_perspective (&priv->view,
+                                      perspective.fovy,
+                                      perspective.aspect,
+                                      perspective.z_near,
+                                      z_2d,
+                                      priv->viewport[2],
+                                      priv->viewport[3]);
+}
+
+void
+_clutter_stage_maybe_setup_viewport (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
 
-  priv = stage->priv;
-  if (!priv->is_cursor_visible)
+  if (priv->dirty_viewport)
     {
-      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
-      ClutterStageWindowIface *iface;
+      CLUTTER_NOTE (PAINT,
+                    "Setting up the viewport { w:%f, h:%f }",
+                    priv->viewport[2], priv->viewport[3]);
 
-      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
-      if (iface->set_cursor_visible)
-        {
-          priv->is_cursor_visible = TRUE;
+      cogl_set_viewport (priv->viewport[0],
+                         priv->viewport[1],
+                         priv->viewport[2],
+                         priv->viewport[3]);
 
-          iface->set_cursor_visible (impl, TRUE);
+      clutter_stage_update_view (stage);
 
-          g_object_notify (G_OBJECT (stage), "cursor-visible");
-        }
+      priv->dirty_viewport = FALSE;
+    }
+
+  if (priv->dirty_projection)
+    {
+      cogl_set_projection_matrix (&priv->projection);
+
+      priv->dirty_projection = FALSE;
     }
 }
 
 /**
- * clutter_stage_hide_cursor:
+ * clutter_stage_ensure_redraw:
  * @stage: a #ClutterStage
  *
- * Makes the cursor invisible on the stage window
+ * Ensures that @stage is redrawn
+ *
+ * This function should not be called by applications: it is
+ * used when embedding a #ClutterStage into a toolkit with
+ * another windowing system, like GTK+.
  *
  *
  */
 void
-clutter_stage_hide_cursor (ClutterStage *stage)
+clutter_stage_ensure_redraw (ClutterStage *stage)
 {
+  ClutterMasterClock *master_clock;
   ClutterStagePrivate *priv;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
   priv = stage->priv;
-  if (priv->is_cursor_visible)
-    {
-      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
-      ClutterStageWindowIface *iface;
 
-      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
-      if (iface->set_cursor_visible)
-        {
-          priv->is_cursor_visible = FALSE;
+  if (!priv->relayout_pending && !priv->redraw_pending)
+    _clutter_stage_schedule_update (stage);
 
-          iface->set_cursor_visible (impl, FALSE);
+  priv->relayout_pending = TRUE;
+  priv->redraw_pending = TRUE;
+  priv->redraw_damaged = TRUE;
 
-          g_object_notify (G_OBJECT (stage), "cursor-visible");
-        }
-    }
+  master_clock = _clutter_master_clock_get_default ();
+  _clutter_master_clock_start_running (master_clock);
 }
 
-/**
- * clutter_stage_read_pixels:
- * @stage: A #ClutterStage
- * @x: x coordinate of the first pixel that is read from stage
- * @y: y coordinate of the first pixel that is read from stage
- * @width: Width dimention of pixels to be read, or -1 for the
- *   entire stage width
- * @height: Height dimention of pixels to be read, or -1 for the
- *   entire stage height
- *
- * Makes a screenshot of the stage in RGBA 8bit data, returns a
- * linear buffer with @width * 4 as rowstride.
- *
- * The alpha data contained in the returned buffer is driver-dependent,
- * and not guaranteed to hold any sensible value.
- *
- * Return value: (transfer full) (array): a pointer to newly allocated memory with the buffer
- *   or %NULL if the read failed. Use g_free() on the returned data
- *   to release the resources it has allocated.
- */
-guchar *
-clutter_stage_read_pixels (ClutterStage *stage,
-                           gint          x,
-                           gint          y,
-                           gint          width,
-                           gint          height)
+void
+_clutter_stage_set_window (ClutterStage       *stage,
+                           ClutterStageWindow *stage_window)
 {
-  ClutterActorBox box;
-  guchar *pixels;
-
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (CLUTTER_IS_STAGE_WINDOW (stage_window));
 
-  /* Force a redraw of the stage before reading back pixels */
-  clutter_stage_ensure_current (stage);
-  clutter_actor_paint (CLUTTER_ACTOR (stage));
+  if (stage->priv->impl != NULL)
+    g_object_unref (stage->priv->impl);
 
-  clutter_actor_get_allocation_box (CLUTTER_ACTOR (stage), &box);
+  stage->priv->impl = stage_window;
+}
 
-  if (width < 0)
-    width = ceilf (box.x2 - box.x1);
+ClutterStageWindow *
+_clutter_stage_get_window (ClutterStage *stage)
+{
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
 
-  if (height < 0)
-    height = ceilf (box.y2 - box.y1);
+  return CLUTTER_STAGE_WINDOW (stage->priv->impl);
+}
 
-  pixels = g_malloc (height * width * 4);
+ClutterStageWindow *
+_clutter_stage_get_default_window (void)
+{
+  ClutterStageManager *manager = clutter_stage_manager_get_default ();
+  ClutterStage *stage;
 
-  cogl_read_pixels (x, y, width, height,
-                    COGL_READ_PIXELS_COLOR_BUFFER,
-                    COGL_PIXEL_FORMAT_RGBA_8888,
-                    pixels);
+  stage = clutter_stage_manager_get_default_stage (manager);
+  if (stage == NULL)
+    return NULL;
 
-  return pixels;
+  return _clutter_stage_get_window (stage);
 }
 
 /**
- * clutter_stage_get_actor_at_pos:
+ * clutter_stage_set_throttle_motion_events:
  * @stage: a #ClutterStage
- * @pick_mode: how the scene graph should be painted
- * @x: X coordinate to check
- * @y: Y coordinate to check
+ * @throttle: %TRUE to throttle motion events
  *
- * Checks the scene at the coordinates @x and @y and returns a pointer
- * to the #ClutterActor at those coordinates.
+ * Sets whether motion events received between redraws should
+ * be throttled or not. If motion events are throttled, those
+ * events received by the windowing system between redraws will
+ * be compressed so that only the last event will be propagated
+ * to the @stage and its actors. The positions of the compressed
+ * events are still available through clutter_event_get_history().
+ *
+ * This function should only be used if you want to have all
+ * the motion events delivered to your application code.
  *
- * By using @pick_mode it is possible to control which actors will be
- * painted and thus available.
  *
- * Return value: (transfer none): the actor at the specified coordinates,
- *   if any
  */
-ClutterActor *
-clutter_stage_get_actor_at_pos (ClutterStage    *stage,
-                                ClutterPickMode  pick_mode,
-                                gint             x,
-                                gint             y)
+void
+clutter_stage_set_throttle_motion_events (ClutterStage *stage,
+                                          gboolean      throttle)
 {
-  return _clutter_stage_do_pick (stage, x, y, pick_mode);
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+  if (priv->throttle_motion_events != throttle)
+    priv->throttle_motion_events = throttle;
 }
 
 /**
- * clutter_stage_event:
+ * clutter_stage_get_throttle_motion_events:
  * @stage: a #ClutterStage
- * @event: a #ClutterEvent
- *
- * This function is used to emit an event on the main stage.
  *
- * You should rarely need to use this function, except for
- * synthetised events.
+ * Retrieves the value set with clutter_stage_set_throttle_motion_events()
  *
- * Return value: the return value from the signal emission
+ * Return value: %TRUE if the motion events are being throttled,
+ *   and %FALSE otherwise
  *
  *
  */
 gboolean
-clutter_stage_event (ClutterStage *stage,
-                     ClutterEvent *event)
+clutter_stage_get_throttle_motion_events (ClutterStage *stage)
 {
-  ClutterStagePrivate *priv;
-
   g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
-  g_return_val_if_fail (event != NULL, FALSE);
-
-  priv = stage->priv;
-
-  if (event->type == CLUTTER_DELETE)
-    {
-      gboolean retval = FALSE;
-
-      g_signal_emit_by_name (stage, "event", event, &retval);
 
-      if (!retval)
-        g_signal_emit_by_name (stage, "delete-event", event, &retval);
+  return stage->priv->throttle_motion_events;
+}
 
-      return retval;
-    }
+/**
+ * clutter_stage_set_use_alpha:
+ * @stage: a #ClutterStage
+ * @use_alpha: whether the stage should honour the opacity or the
+ *   alpha channel of the stage color
+ *
+ * Sets whether the @stage should honour the #ClutterActor:opacity and
+ * the alpha channel of the #ClutterStage:color
+ *
+ *
+ */
+void
+clutter_stage_set_use_alpha (ClutterStage *stage,
+                             gboolean      use_alpha)
+{
+  ClutterStagePrivate *priv;
 
-  if (event->type != CLUTTER_STAGE_STATE)
-    return FALSE;
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-  /* emit raw event */
-  if (clutter_actor_event (CLUTTER_ACTOR (stage), event, FALSE))
-    return TRUE;
+  priv = stage->priv;
 
-  if (event->stage_state.changed_mask & CLUTTER_STAGE_STATE_FULLSCREEN)
+  if (priv->use_alpha != use_alpha)
     {
-      if (event->stage_state.new_state & CLUTTER_STAGE_STATE_FULLSCREEN)
-	{
-	  priv->is_fullscreen = TRUE;
-	  g_signal_emit (stage, stage_signals[FULLSCREEN], 0);
+      priv->use_alpha = use_alpha;
 
-          g_object_notify (G_OBJECT (stage), "fullscreen-set");
-	}
-      else
-	{
-	  priv->is_fullscreen = FALSE;
-	  g_signal_emit (stage, stage_signals[UNFULLSCREEN], 0);
+      clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
 
-          g_object_notify (G_OBJECT (stage), "fullscreen-set");
-	}
+      g_object_notify (G_OBJECT (stage), "use-alpha");
     }
+}
 
-  if (event->stage_state.changed_mask & CLUTTER_STAGE_STATE_ACTIVATED)
-    {
-      if (event->stage_state.new_state & CLUTTER_STAGE_STATE_ACTIVATED)
-	g_signal_emit (stage, stage_signals[ACTIVATE], 0);
-      else
-	g_signal_emit (stage, stage_signals[DEACTIVATE], 0);
-    }
+/**
+ * clutter_stage_get_use_alpha:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves the value set using clutter_stage_set_use_alpha()
+ *
+ * Return value: %TRUE if the stage should honour the opacity and the
+ *   alpha channel of the stage color
+ *
+ *
+ */
+gboolean
+clutter_stage_get_use_alpha (ClutterStage *stage)
+{
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
-  return TRUE;
+  return stage->priv->use_alpha;
 }
 
 /**
- * clutter_stage_set_title:
- * @stage: A #ClutterStage
- * @title: A utf8 string for the stage windows title.
- *
- * Sets the stage title.
- *
- *
- **/
+ * clutter_stage_set_use_orthographic:
+ * @stage: a #ClutterStage
+ * @use_orthographic: whether the stage should use an orthographic
+ *   projection
+ *
+ * Sets whether the @stage should use an orthographic projection,
+ * mapping the stage coordinates directly to the window, instead of
+ * the perspective set using clutter_stage_set_perspective().
+ *
+ * Under an orthographic projection the depth of an actor does not
+ * change its size on screen, and the projected position of a vertex
+ * never needs a perspective divide: this allows Clutter to compute the
+ * culling, clipping, picking and damaged areas of actors using only
+ * 2D math, which is a good fit for user interfaces without any 3D
+ * transformation.
+ */
 void
-clutter_stage_set_title (ClutterStage       *stage,
-			 const gchar        *title)
+clutter_stage_set_use_orthographic (ClutterStage *stage,
+                                    gboolean      use_orthographic)
 {
   ClutterStagePrivate *priv;
-  ClutterStageWindow *impl;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
   priv = stage->priv;
 
-  g_free (priv->title);
-  priv->title = g_strdup (title);
+  use_orthographic = !!use_orthographic;
 
-  impl = CLUTTER_STAGE_WINDOW (priv->impl);
-  if (CLUTTER_STAGE_WINDOW_GET_IFACE(impl)->set_title != NULL)
-    CLUTTER_STAGE_WINDOW_GET_IFACE (impl)->set_title (impl, priv->title);
+  if (priv->use_orthographic == use_orthographic)
+    return;
 
-  g_object_notify (G_OBJECT (stage), "title");
+  priv->use_orthographic = use_orthographic;
+
+  /* the perspective might not change when the view is updated, so
+   * the projection has to be switched back explicitly
+   */
+  if (!use_orthographic)
+    clutter_stage_update_projection (stage);
+
+  clutter_stage_update_view (stage);
+
+  g_object_notify (G_OBJECT (stage), "use-orthographic");
 }
 
 /**
- * clutter_stage_get_title:
- * @stage: A #ClutterStage
- *
- * Gets the stage title.
- *
- * Return value: pointer to the title string for the stage. The
- * returned string is owned by the actor and should not
- * be modified or freed.
+ * clutter_stage_get_use_orthographic:
+ * @stage: a #ClutterStage
  *
+ * Retrieves the value set using clutter_stage_set_use_orthographic()
  *
- **/
-const gchar *
-clutter_stage_get_title (ClutterStage       *stage)
+ * Return value: %TRUE if the stage uses an orthographic projection
+ */
+gboolean
+clutter_stage_get_use_orthographic (ClutterStage *stage)
 {
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
-  return stage->priv->title;
+  return stage->priv->use_orthographic;
 }
 
-static void
-on_key_focus_destroy (ClutterActor *actor,
-                      ClutterStage *stage)
+/**
+ * clutter_stage_set_minimum_size:
+ * @stage: a #ClutterStage
+ * @width: width, in pixels
+ * @height: height, in pixels
+ *
+ * Sets the minimum size for a stage window, if the default backend
+ * uses #ClutterStage inside a window
+ *
+ * This is a convenience function, and it is equivalent to setting the
+ * #ClutterActor:min-width and #ClutterActor:min-height on @stage
+ *
+ * If the current size of @stage is smaller than the minimum size, the
+ * @stage will be resized to the new @width and @height
+ *
+ * This function has no effect if @stage is fullscreen
+ *
+ *
+ */
+void
+clutter_stage_set_minimum_size (ClutterStage *stage,
+                                guint         width,
+                                guint         height)
 {
-  /* unset the key focus */
-  clutter_stage_set_key_focus (stage, NULL);
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail ((width > 0) && (height > 0));
+
+  g_object_set (G_OBJECT (stage),
+                "min-width", (gfloat) width,
+                "min-height", (gfloat )height,
+                NULL);
 }
 
 /**
- * clutter_stage_set_key_focus:
- * @stage: the #ClutterStage
- * @actor: (allow-none): the actor to set key focus to, or %NULL
+ * clutter_stage_get_minimum_size:
+ * @stage: a #ClutterStage
+ * @width: (out): return location for the minimum width, in pixels,
+ *   or %NULL
+ * @height: (out): return location for the minimum height, in pixels,
+ *   or %NULL
  *
- * Sets the key focus on @actor. An actor with key focus will receive
- * all the key events. If @actor is %NULL, the stage will receive
- * focus.
+ * Retrieves the minimum size for a stage window as set using
+ * clutter_stage_set_minimum_size().
+ *
+ * The returned size may not correspond to the actual minimum size and
+ * it is specific to the #ClutterStage implementation inside the
+ * Clutter backend
  *
  *
  */
 void
-clutter_stage_set_key_focus (ClutterStage *stage,
-			     ClutterActor *actor)
+clutter_stage_get_minimum_size (ClutterStage *stage,
+                                guint        *width_p,
+                                guint        *height_p)
 {
-  ClutterStagePrivate *priv;
+  gfloat width, height;
+  gboolean width_set, height_set;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail (actor == NULL || CLUTTER_IS_ACTOR (actor));
-
-  priv = stage->priv;
 
-  /* normalize the key focus. NULL == stage */
-  if (actor == CLUTTER_ACTOR (stage))
-    actor = NULL;
+  g_object_get (G_OBJECT (stage),
+                "min-width", &width,
+                "min-width-set", &width_set,
+                "min-height", &height,
+                "min-height-set", &height_set,
+                NULL);
 
-  /* avoid emitting signals and notifications if we're setting the same
-   * actor as the key focus
+  /* if not width or height have been set, then the Stage
+   * minimum size is defined to be 1x1
    */
-  if (priv->key_focused_actor == actor)
-    return;
+  if (!width_set)
+    width = 1;
 
-  if (priv->key_focused_actor != NULL)
-    {
-      ClutterActor *old_focused_actor;
+  if (!height_set)
+    height = 1;
 
-      old_focused_actor = priv->key_focused_actor;
+  if (width_p)
+    *width_p = (guint) width;
 
-      /* set key_focused_actor to NULL before emitting the signal or someone
-       * might hide the previously focused actor in the signal handler and we'd
-       * get re-entrant call and get glib critical from g_object_weak_unref
-       */
-      g_signal_handlers_disconnect_by_func (priv->key_focused_actor,
-                                            G_CALLBACK (on_key_focus_destroy),
-                                            stage);
-      priv->key_focused_actor = NULL;
+  if (height_p)
+    *height_p = (guint) height;
+}
 
-      g_signal_emit_by_name (old_focused_actor, "key-focus-out");
-    }
-  else
-    g_signal_emit_by_name (stage, "key-focus-out");
+/* the margin left before the vblank deadline by the adaptive
+ * sync delay, in microseconds
+ */
+#define ADAPTIVE_SYNC_MARGIN    2000
 
-  /* Note, if someone changes key focus in focus-out signal handler we'd be
-   * overriding the latter call below moving the focus where it was originally
-   * intended. The order of events would be:
-   *   1st focus-out, 2nd focus-out (on stage), 2nd focus-in, 1st focus-in
-   */
-  if (actor != NULL)
-    {
-      priv->key_focused_actor = actor;
+static gint
+clutter_stage_get_effective_sync_delay (ClutterStage       *stage,
+                                        ClutterStageWindow *stage_window)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  gint64 interval, cost, delay;
 
-      g_signal_connect (actor,
-                        "destroy", G_CALLBACK (on_key_focus_destroy),
-                        stage);
-      g_signal_emit_by_name (priv->key_focused_actor, "key-focus-in");
-    }
-  else
-    g_signal_emit_by_name (stage, "key-focus-in");
+  if (!priv->adaptive_sync_delay)
+    return priv->sync_delay;
 
-  g_object_notify (G_OBJECT (stage), "key-focus");
+  interval = _clutter_stage_window_get_refresh_interval (stage_window);
+  if (interval <= 0)
+    return priv->sync_delay;
+
+  /* start the frame as late as possible, so that it still ends before
+   * the next vertical refresh
+   */
+  cost = _clutter_master_clock_get_frame_cost (_clutter_master_clock_get_default ());
+  delay = interval - cost - ADAPTIVE_SYNC_MARGIN;
+
+  return MAX (delay, 0) / 1000;
 }
 
-/**
- * clutter_stage_get_key_focus:
- * @stage: the #ClutterStage
- *
- * Retrieves the actor that is currently under key focus.
- *
- * Return value: (transfer none): the actor with key focus, or the stage
- *
- *
- */
-ClutterActor *
-clutter_stage_get_key_focus (ClutterStage *stage)
+void
+_clutter_stage_schedule_update (ClutterStage *stage)
 {
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
+  ClutterStageWindow *stage_window;
 
-  if (stage->priv->key_focused_actor)
-    return stage->priv->key_focused_actor;
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
+    return;
 
-  return CLUTTER_ACTOR (stage);
-}
+  stage_window = _clutter_stage_get_window (stage);
+  if (stage_window == NULL)
+    return;
 
-/*** Perspective boxed type ******/
+  return _clutter_stage_window_schedule_update (stage_window,
+                                                clutter_stage_get_effective_sync_delay (stage,
+                                                                                        stage_window));
+}
 
-static gpointer
-clutter_perspective_copy (gpointer data)
+/* Returns the earliest time the stage is ready to update */
+gint64
+_clutter_stage_get_update_time (ClutterStage *stage)
 {
-  if (G_LIKELY (data))
-    return g_slice_dup (ClutterPerspective, data);
+  ClutterStageWindow *stage_window;
 
-  return NULL;
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
+    return 0;
+
+  stage_window = _clutter_stage_get_window (stage);
+  if (stage_window == NULL)
+    return 0;
+
+  return _clutter_stage_window_get_update_time (stage_window);
 }
 
-static void
-clutter_perspective_free (gpointer data)
+void
+_clutter_stage_clear_update_time (ClutterStage *stage)
 {
-  if (G_LIKELY (data))
-    g_slice_free (ClutterPerspective, data);
-}
+  ClutterStageWindow *stage_window;
 
-G_DEFINE_BOXED_TYPE (ClutterPerspective, clutter_perspective,
-                     clutter_perspective_copy,
-                     clutter_perspective_free);
+  stage_window = _clutter_stage_get_window (stage);
+  if (stage_window)
+    _clutter_stage_window_clear_update_time (stage_window);
+}
 
-/**
- * clutter_stage_new:
- *
- * Creates a new, non-default stage. A non-default stage is a new
- * top-level actor which can be used as another container. It works
- * exactly like the default stage, but while clutter_stage_get_default()
- * will always return the same instance, you will have to keep a pointer
- * to any #ClutterStage returned by clutter_stage_new().
- *
- * The ability to support multiple stages depends on the current
- * backend. Use clutter_feature_available() and
- * %CLUTTER_FEATURE_STAGE_MULTIPLE to check at runtime whether a
- * backend supports multiple stages.
- *
- * Return value: a new stage, or %NULL if the default backend does
- *   not support multiple stages. Use clutter_actor_destroy() to
- *   programmatically close the returned stage.
- *
- *
- */
-ClutterActor *
-clutter_stage_new (void)
+/* Returns the predicted presentation time of the next frame, or -1 */
+gint64
+_clutter_stage_get_next_presentation_time (ClutterStage *stage)
 {
-  return g_object_new (CLUTTER_TYPE_STAGE, NULL);
+  ClutterStageWindow *stage_window;
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
+    return -1;
+
+  stage_window = _clutter_stage_get_window (stage);
+  if (stage_window == NULL)
+    return -1;
+
+  return _clutter_stage_window_get_next_presentation_time (stage_window);
 }
 
-/**
- * clutter_stage_ensure_current:
- * @stage: the #ClutterStage
- *
- * This function essentially makes sure the right GL context is
- * current for the passed stage. It is not intended to
- * be used by applications.
- *
- *
- */
-void
-clutter_stage_ensure_current (ClutterStage *stage)
+/* Returns the interval between two vertical refreshes, or 0 */
+gint64
+_clutter_stage_get_refresh_interval (ClutterStage *stage)
 {
-  ClutterBackend *backend;
+  ClutterStageWindow *stage_window;
 
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
+    return 0;
 
-  backend = clutter_get_default_backend ();
-  _clutter_backend_ensure_context (backend, stage);
+  stage_window = _clutter_stage_get_window (stage);
+  if (stage_window == NULL)
+    return 0;
+
+  return _clutter_stage_window_get_refresh_interval (stage_window);
 }
 
 /**
- * clutter_stage_ensure_viewport:
+ * clutter_stage_set_no_clear_hint:
  * @stage: a #ClutterStage
+ * @no_clear: %TRUE if the @stage should not clear itself on every
+ *   repaint cycle
  *
- * Ensures that the GL viewport is updated with the current
- * stage window size.
+ * Sets whether the @stage should clear itself at the beginning
+ * of each paint cycle or not.
  *
- * This function will queue a redraw of @stage.
+ * Clearing the #ClutterStage can be a costly operation, especially
+ * if the stage is always covered - for instance, in a full-screen
+ * video player or in a game with a background texture.
  *
- * This function should not be called by applications; it is used
- * when embedding a #ClutterStage into a toolkit with another
- * windowing system, like GTK+.
+ * <note><para>This setting is a hint; Clutter might discard this
+ * hint depending on its internal state.</para></note>
+ *
+ * <warning><para>If parts of the stage are visible and you disable
+ * clearing you might end up with visual artifacts while painting the
+ * contents of the stage.</para></warning>
  *
  *
  */
 void
-clutter_stage_ensure_viewport (ClutterStage *stage)
+clutter_stage_set_no_clear_hint (ClutterStage *stage,
+                                 gboolean      no_clear)
 {
+  ClutterStagePrivate *priv;
+  ClutterStageHint new_hints;
+
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-  _clutter_stage_dirty_viewport (stage);
+  priv = stage->priv;
+  new_hints = priv->stage_hints;
 
-  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+  if (no_clear)
+    new_hints |= CLUTTER_STAGE_NO_CLEAR_ON_PAINT;
+  else
+    new_hints &= ~CLUTTER_STAGE_NO_CLEAR_ON_PAINT;
+
+  if (priv->stage_hints == new_hints)
+    return;
+
+  priv->stage_hints = new_hints;
+
+  g_object_notify (G_OBJECT (stage), "no-clear-hint");
 }
 
-/* This calculates a distance into the view frustum to position the
- * stage so there is a decent amount of space to position geometry
- * between the stage and the near clipping plane.
+/**
+ * clutter_stage_get_no_clear_hint:
+ * @stage: a #ClutterStage
  *
- * Some awkward issues with this problem are:
- * - It's not possible to have a gap as large as the stage size with
- *   a fov > 53° which is basically always the case since the default
- *   fov is 60°.
- *    - This can be deduced if you consider that this requires a
- *      triangle as wide as it is deep to fit in the frustum in front
- *      of the z_near plane. That triangle will always have an angle
- *      of 53.13° at the point sitting on the z_near plane, but if the
- *      frustum has a wider fov angle the left/right clipping planes
- *      can never converge with the two corners of our triangle no
- *      matter what size the triangle has.
- * - With a fov > 53° there is a trade off between maximizing the gap
- *   size relative to the stage size but not loosing depth precision.
- * - Perhaps ideally we wouldn't just consider the fov on the y-axis
- *   that is usually used to define a perspective, we would consider
- *   the fov of the axis with the largest stage size so the gap would
- *   accommodate that size best.
+ * Retrieves the hint set with clutter_stage_set_no_clear_hint()
  *
- * After going around in circles a few times with how to handle these
- * issues, we decided in the end to go for the simplest solution to
- * start with instead of an elaborate function that handles arbitrary
- * fov angles that we currently have no use-case for.
+ * Return value: %TRUE if the stage should not clear itself on every paint
+ *   cycle, and %FALSE otherwise
  *
- * The solution assumes a fovy of 60° and for that case gives a gap
- * that's 85% of the stage height. We can consider more elaborate
- * functions if necessary later.
  *
- * One guide we had to steer the gap size we support is the
- * interactive test, test-texture-quality which expects to animate an
- * actor to +400 on the z axis with a stage size of 640x480. A gap
- * that's 85% of the stage height gives a gap of 408 in that case.
  */
-static float
-calculate_z_translation (float z_near)
+gboolean
+clutter_stage_get_no_clear_hint (ClutterStage *stage)
 {
-  /* This solution uses fairly basic trigonometry, but is seems worth
-   * clarifying the particular geometry we are looking at in-case
-   * anyone wants to develop this further later. Not sure how well an
-   * ascii diagram is going to work :-)
-   *
-   *    |--- stage_height ---|
-   *    |     stage line     |
-   *   ╲━━━━━━━━━━━━━━━━━━━━━╱------------
-   *    ╲.  (2)   │        .╱       |   |
-   *   C ╲ .      │      . ╱     gap|   |
-   * =0.5°╲  . a  │    .  ╱         |   |
-   *      b╲(1). D│  .   ╱          |   |
-   *        ╲   B.│.    ╱near plane |   |
-   *      A= ╲━━━━━━━━━╱-------------   |
-   *     120° ╲ c │   ╱  |            z_2d
-   *           ╲  │  ╱  z_near          |
-   *       left ╲ │ ╱    |              |
-   *       clip  60°fovy |              |
-   *       plane  ╳----------------------
-   *              |
-   *              |
-   *         origin line
-   *
-   * The area of interest is the triangle labeled (1) at the top left
-   * marked with the ... line (a) from where the origin line crosses
-   * the near plane to the top left where the stage line cross the
-   * left clip plane.
-   *
-   * The sides of the triangle are a, b and c and the corresponding
-   * angles opposite those sides are A, B and C.
-   *
-   * The angle of C is what trades off the gap size we have relative
-   * to the stage size vs the depth precision we have.
-   *
-   * As mentioned above we arove at the angle for C is by working
-   * backwards from how much space we want for test-texture-quality.
-   * With a stage_height of 480 we want a gap > 400, ideally we also
-   * wanted a somewhat round number as a percentage of the height for
-   * documentation purposes. ~87% or a gap of ~416 is the limit
-   * because that's where we approach a C angle of 0° and effectively
-   * loose all depth precision.
-   *
-   * So for our test app with a stage_height of 480 if we aim for a
-   * gap of 408 (85% of 480) we can get the angle D as
-   * atan (stage_height/2/408) = 30.5°.
-   *
-   * That gives us the angle for B as 90° - 30.5° = 59.5°
-   *
-   * We can already determine that A has an angle of (fovy/2 + 90°) =
-   * 120°
-   *
-   * Therefore C = 180 - A - B = 0.5°
-   *
-   * The length of c = z_near * tan (30°)
-   *
-   * Now we can use the rule a/SinA = c/SinC to calculate the
-   * length of a. After some rearranging that gives us:
-   *
-   *      a              c
-   *  ----------  =  ----------
-   *  sin (120°)     sin (0.5°)
-   *
-   *      c * sin (120°)
-   *  a = --------------
-   *        sin (0.5°)
-   *
-   * And with that we can determine z_2d = cos (D) * a =
-   * cos (30.5°) * a + z_near:
-   *
-   *         c * sin (120°) * cos (30.5°)
-   *  z_2d = --------------------------- + z_near
-   *                 sin (0.5°)
-   */
-#define _DEG_TO_RAD (G_PI / 180.0)
-  return z_near * tanf (30.0f * _DEG_TO_RAD) *
-         sinf (120.0f * _DEG_TO_RAD) * cosf (30.5f * _DEG_TO_RAD) /
-         sinf (0.5f * _DEG_TO_RAD) +
-         z_near;
-#undef _DEG_TO_RAD
-   /* We expect the compiler should boil this down to z_near * CONSTANT */
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+
+  return (stage->priv->stage_hints & CLUTTER_STAGE_NO_CLEAR_ON_PAINT) != 0;
+}
+
+ClutterPaintVolume *
+_clutter_stage_paint_volume_stack_allocate (ClutterStage *stage)
+{
+  GArray *paint_volume_stack = stage->priv->paint_volume_stack;
+
+  g_array_set_size (paint_volume_stack,
+                    paint_volume_stack->len+1);
+
+  return &g_array_index (paint_volume_stack,
+                         ClutterPaintVolume,
+                         paint_volume_stack->len - 1);
 }
 
 void
-_clutter_stage_maybe_setup_viewport (ClutterStage *stage)
+_clutter_stage_paint_volume_stack_free_all (ClutterStage *stage)
+{
+  GArray *paint_volume_stack = stage->priv->paint_volume_stack;
+  int i;
+
+  for (i = 0; i < paint_volume_stack->len; i++)
+    {
+      ClutterPaintVolume *pv =
+        &g_array_index (paint_volume_stack, ClutterPaintVolume, i);
+      clutter_paint_volume_free (pv);
+    }
+
+  g_array_set_size (paint_volume_stack, 0);
+}
+
+/* The is an out-of-band paramater available while painting that
+ * can be used to cull actors. */
+const ClutterPlane *
+_clutter_stage_get_clip (ClutterStage *stage)
+{
+  return stage->priv->current_clip_planes;
+}
+
+/* The opaque areas computed before painting the stage, used to skip
+ * the actors hidden behind them. */
+const ClutterOcclusion *
+_clutter_stage_get_occlusion (ClutterStage *stage)
+{
+  return &stage->priv->occlusion;
+}
+
+/* When an actor queues a redraw we add it to a list on the stage that
+ * gets processed once all updates to the stage have been finished.
+ *
+ * This deferred approach to processing queue_redraw requests means
+ * that we can avoid redundant transformations of clip volumes if
+ * something later triggers a full stage redraw anyway. It also means
+ * we can be more sure that all the referenced actors will have valid
+ * allocations improving the chance that we can determine the actors
+ * paint volume so we can clip the redraw request even if the user
+ * didn't explicitly do so.
+ */
+gint
+_clutter_stage_queue_actor_redraw (ClutterStage *stage,
+                                   gint entry_index,
+                                   ClutterActor *actor,
+                                   ClutterPaintVolume *clip)
 {
   ClutterStagePrivate *priv = stage->priv;
+  QueueRedrawEntry *entry;
+
+  CLUTTER_NOTE (CLIPPING, "stage_queue_actor_redraw (actor=%s, clip=%p): ",
+                _clutter_actor_get_debug_name (actor), clip);
+
+  if (!priv->redraw_pending)
+    {
+      ClutterMasterClock *master_clock;
+
+      CLUTTER_NOTE (PAINT, "First redraw request");
+
+      _clutter_stage_schedule_update (stage);
+      priv->redraw_pending = TRUE;
 
-  if (priv->dirty_viewport)
+      master_clock = _clutter_master_clock_get_default ();
+      _clutter_master_clock_start_running (master_clock);
+    }
+#ifdef CLUTTER_ENABLE_DEBUG
+  else
     {
-      ClutterPerspective perspective;
-      float z_2d;
-
-      CLUTTER_NOTE (PAINT,
-                    "Setting up the viewport { w:%f, h:%f }",
-                    priv->viewport[2], priv->viewport[3]);
+      CLUTTER_NOTE (PAINT, "Redraw request number %lu",
+                    priv->redraw_count + 1);
 
-      cogl_set_viewport (priv->viewport[0],
-                         priv->viewport[1],
-                         priv->viewport[2],
-                         priv->viewport[3]);
+      priv->redraw_count += 1;
+    }
+#endif /* CLUTTER_ENABLE_DEBUG */
 
-      perspective = priv->perspective;
+  /* We do not need to invalidate the cached pick buffer here: the
+   * actors will bump the pick generation of the stage when a state
+   * that affects picking changes, see _clutter_stage_invalidate_pick()
+   */
 
-      /* Ideally we want to regenerate the perspective matrix whenever
-       * the size changes but if the user has provided a custom matrix
-       * then we don't want to override it */
-      if (!priv->has_custom_perspective)
-        {
-          perspective.aspect = priv->viewport[2] / priv->viewport[3];
-          z_2d = calculate_z_translation (perspective.z_near);
+  /* the pending redraws are gone if the stage has been disposed */
+  if (G_UNLIKELY (priv->pending_queue_redraws == NULL))
+    return -1;
 
-#define _DEG_TO_RAD (G_PI / 180.0)
-          /* NB: z_2d is only enough room for 85% of the stage_height between
-           * the stage and the z_near plane. For behind the stage plane we
-           * want a more consistent gap of 10 times the stage_height before
-           * hitting the far plane so we calculate that relative to the final
-           * height of the stage plane at the z_2d_distance we got... */
-          perspective.z_far = z_2d +
-            tanf ((perspective.fovy / 2.0f) * _DEG_TO_RAD) * z_2d * 20.0f;
-#undef _DEG_TO_RAD
+  if (entry_index >= 0 &&
+      (guint) entry_index < priv->pending_queue_redraws->len &&
+      g_array_index (priv->pending_queue_redraws,
+                     QueueRedrawEntry,
+                     entry_index).actor == actor)
+    {
+      entry = &g_array_index (priv->pending_queue_redraws,
+                              QueueRedrawEntry,
+                              entry_index);
 
-          clutter_stage_set_perspective_internal (stage, &perspective);
+      /* Ignore all requests to queue a redraw for an actor if a full
+       * (non-clipped) redraw of the actor has already been queued. */
+      if (!entry->has_clip)
+        {
+          CLUTTER_NOTE (CLIPPING, "Bail from stage_queue_actor_redraw (%s): "
+                        "Unclipped redraw of actor already queued",
+                        _clutter_actor_get_debug_name (actor));
+          return entry_index;
         }
-      else
-        z_2d = calculate_z_translation (perspective.z_near);
 
-      cogl_matrix_init_identity (&priv->view);
-      cogl_matrix_view_2d_in_perspective (&priv->view,
-                                          perspective.fovy,
-                                          perspective.aspect,
-                                          perspective.z_near,
-                                          z_2d,
-                                          priv->viewport[2],
-                                          priv->viewport[3]);
+      /* If queuing a clipped redraw and a clipped redraw has
+       * previously been queued for this actor then combine the latest
+       * clip together with the existing clip */
+      if (clip)
+        clutter_paint_volume_union (&entry->clip, clip);
+      else
+        {
+          clutter_paint_volume_free (&entry->clip);
+          entry->has_clip = FALSE;
+        }
 
-      priv->dirty_viewport = FALSE;
+      return entry_index;
     }
 
-  if (priv->dirty_projection)
-    {
-      cogl_set_projection_matrix (&priv->projection);
+  /* the array keeps its storage between frames, so appending only
+   * allocates while the number of queued actors is growing
+   */
+  entry_index = priv->pending_queue_redraws->len;
+  g_array_set_size (priv->pending_queue_redraws, entry_index + 1);
 
-      priv->dirty_projection = FALSE;
+  entry = &g_array_index (priv->pending_queue_redraws,
+                          QueueRedrawEntry,
+                          entry_index);
+  entry->actor = g_object_ref (actor);
+
+  if (clip)
+    {
+      entry->has_clip = TRUE;
+      _clutter_paint_volume_init_static (&entry->clip, actor);
+      _clutter_paint_volume_set_from_volume (&entry->clip, clip);
     }
+  else
+    entry->has_clip = FALSE;
+
+  return entry_index;
 }
 
-/**
- * clutter_stage_ensure_redraw:
- * @stage: a #ClutterStage
- *
- * Ensures that @stage is redrawn
- *
- * This function should not be called by applications: it is
- * used when embedding a #ClutterStage into a toolkit with
- * another windowing system, like GTK+.
- *
- *
- */
-void
-clutter_stage_ensure_redraw (ClutterStage *stage)
+static void
+clear_queue_redraw_entry (QueueRedrawEntry *entry)
 {
-  ClutterMasterClock *master_clock;
-  ClutterStagePrivate *priv;
-
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
-
-  priv = stage->priv;
-
-  if (!priv->relayout_pending && !priv->redraw_pending)
-    _clutter_stage_schedule_update (stage);
-
-  priv->relayout_pending = TRUE;
-  priv->redraw_pending = TRUE;
+  if (entry->actor)
+    {
+      g_object_unref (entry->actor);
+      entry->actor = NULL;
+    }
 
-  master_clock = _clutter_master_clock_get_default ();
-  _clutter_master_clock_start_running (master_clock);
+  if (entry->has_clip)
+    {
+      clutter_paint_volume_free (&entry->clip);
+      entry->has_clip = FALSE;
+    }
 }
 
 void
-_clutter_stage_set_window (ClutterStage       *stage,
-                           ClutterStageWindow *stage_window)
+_clutter_stage_queue_redraw_entry_invalidate (ClutterStage *stage,
+                                              gint          entry_index)
 {
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail (CLUTTER_IS_STAGE_WINDOW (stage_window));
+  ClutterStagePrivate *priv = stage->priv;
 
-  if (stage->priv->impl != NULL)
-    g_object_unref (stage->priv->impl);
+  if (entry_index < 0 ||
+      priv->pending_queue_redraws == NULL ||
+      (guint) entry_index >= priv->pending_queue_redraws->len)
+    return;
 
-  stage->priv->impl = stage_window;
+  clear_queue_redraw_entry (&g_array_index (priv->pending_queue_redraws,
+                                            QueueRedrawEntry,
+                                            entry_index));
 }
 
-ClutterStageWindow *
-_clutter_stage_get_window (ClutterStage *stage)
+static void
+_clutter_stage_maybe_finish_queue_redraws (ClutterStage *stage)
 {
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
+  ClutterStagePrivate *priv = stage->priv;
+  guint i;
 
-  return CLUTTER_STAGE_WINDOW (stage->priv->impl);
-}
+  if (priv->pending_queue_redraws == NULL)
+    return;
 
-ClutterStageWindow *
-_clutter_stage_get_default_window (void)
-{
-  ClutterStageManager *manager = clutter_stage_manager_get_default ();
-  ClutterStage *stage;
+  /* Note: actors are allowed to queue redraws in response to the
+   * queue-redraw signal, for example Clone actors or
+   * texture_new_from_actor actors will have to queue a redraw if
+   * their source queues a redraw; the new entries are appended to the
+   * array, so we process them in the same loop.
+   */
+  for (i = 0; i < priv->pending_queue_redraws->len; i++)
+    {
+      QueueRedrawEntry entry;
 
-  stage = clutter_stage_manager_get_default_stage (manager);
-  if (stage == NULL)
-    return NULL;
+      /* we move the entry out of the array, since the array can be
+       * reallocated while the redraw is processed
+       */
+      entry = g_array_index (priv->pending_queue_redraws, QueueRedrawEntry, i);
+      g_array_index (priv->pending_queue_redraws, QueueRedrawEntry, i).actor = NULL;
+      g_array_index (priv->pending_queue_redraws, QueueRedrawEntry, i).has_clip = FALSE;
 
-  return _clutter_stage_get_window (stage);
+      /* NB: Entries may be invalidated if the actor gets destroyed */
+      if (G_LIKELY (entry.actor != NULL))
+        _clutter_actor_finish_queue_redraw (entry.actor,
+                                            entry.has_clip ? &entry.clip : NULL);
+
+      clear_queue_redraw_entry (&entry);
+    }
+
+  g_array_set_size (priv->pending_queue_redraws, 0);
 }
 
 /**
- * clutter_stage_set_throttle_motion_events:
+ * clutter_stage_set_accept_focus:
  * @stage: a #ClutterStage
- * @throttle: %TRUE to throttle motion events
+ * @accept_focus: %TRUE to accept focus on show
  *
- * Sets whether motion events received between redraws should
- * be throttled or not. If motion events are throttled, those
- * events received by the windowing system between redraws will
- * be compressed so that only the last event will be propagated
- * to the @stage and its actors.
+ * Sets whether the @stage should accept the key focus when shown.
  *
- * This function should only be used if you want to have all
- * the motion events delivered to your application code.
+ * This function should be called before showing @stage using
+ * clutter_actor_show().
  *
  *
  */
 void
-clutter_stage_set_throttle_motion_events (ClutterStage *stage,
-                                          gboolean      throttle)
+clutter_stage_set_accept_focus (ClutterStage *stage,
+                                gboolean      accept_focus)
 {
   ClutterStagePrivate *priv;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
+  accept_focus = !!accept_focus;
+
   priv = stage->priv;
 
-  if (priv->throttle_motion_events != throttle)
-    priv->throttle_motion_events = throttle;
+  if (priv->accept_focus != accept_focus)
+    {
+      _clutter_stage_window_set_accept_focus (priv->impl, accept_focus);
+      g_object_notify (G_OBJECT (stage), "accept-focus");
+    }
 }
 
 /**
- * clutter_stage_get_throttle_motion_events:
+ * clutter_stage_get_accept_focus:
  * @stage: a #ClutterStage
  *
- * Retrieves the value set with clutter_stage_set_throttle_motion_events()
+ * Retrieves the value set with clutter_stage_set_accept_focus().
  *
- * Return value: %TRUE if the motion events are being throttled,
- *   and %FALSE otherwise
+ * Return value: %TRUE if the #ClutterStage should accept focus, and %FALSE
+ *   otherwise
  *
  *
  */
 gboolean
-clutter_stage_get_throttle_motion_events (ClutterStage *stage)
+clutter_stage_get_accept_focus (ClutterStage *stage)
 {
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), TRUE);
 
-  return stage->priv->throttle_motion_events;
+  return stage->priv->accept_focus;
 }
 
 /**
- * clutter_stage_set_use_alpha:
+ * clutter_stage_set_motion_events_enabled:
  * @stage: a #ClutterStage
- * @use_alpha: whether the stage should honour the opacity or the
- *   alpha channel of the stage color
+ * @enabled: %TRUE to enable the motion events delivery, and %FALSE
+ *   otherwise
  *
- * Sets whether the @stage should honour the #ClutterActor:opacity and
- * the alpha channel of the #ClutterStage:color
+ * Sets whether per-actor motion events (and relative crossing
+ * events) should be disabled or not.
+ *
+ * The default is %TRUE.
+ *
+ * If @enable is %FALSE the following events will not be delivered
+ * to the actors children of @stage.
+ *
+ * <itemizedlist>
+ *   <listitem><para>#ClutterActor::motion-event</para></listitem>
+ *   <listitem><para>#ClutterActor::enter-event</para></listitem>
+ *   <listitem><para>#ClutterActor::leave-event</para></listitem>
+ * </itemizedlist>
+ *
+ * The events will still be delivered to the #ClutterStage.
+ *
+ * The main side effect of this function is that disabling the motion
+ * events will disable picking to detect the #ClutterActor underneath
+ * the pointer for each motion event. This is useful, for instance,
+ * when dragging a #ClutterActor across the @stage: the actor underneath
+ * the pointer is not going to change, so it's meaningless to perform
+ * a pick.
  *
  *
  */
 void
-clutter_stage_set_use_alpha (ClutterStage *stage,
-                             gboolean      use_alpha)
+clutter_stage_set_motion_events_enabled (ClutterStage *stage,
+                                         gboolean      enabled)
 {
   ClutterStagePrivate *priv;
 
@@ -3308,543 +6580,492 @@ clutter_stage_set_use_alpha (ClutterStage *stage,
 
   priv = stage->priv;
 
-  if (priv->use_alpha != use_alpha)
-    {
-      priv->use_alpha = use_alpha;
-
-      clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
-
-      g_object_notify (G_OBJECT (stage), "use-alpha");
-    }
-}
-
-/**
- * clutter_stage_get_use_alpha:
- * @stage: a #ClutterStage
- *
- * Retrieves the value set using clutter_stage_set_use_alpha()
- *
- * Return value: %TRUE if the stage should honour the opacity and the
- *   alpha channel of the stage color
- *
- *
- */
-gboolean
-clutter_stage_get_use_alpha (ClutterStage *stage)
-{
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  enabled = !!enabled;
 
-  return stage->priv->use_alpha;
+  if (priv->motion_events_enabled != enabled)
+    priv->motion_events_enabled = enabled;
 }
 
 /**
- * clutter_stage_set_minimum_size:
+ * clutter_stage_get_motion_events_enabled:
  * @stage: a #ClutterStage
- * @width: width, in pixels
- * @height: height, in pixels
- *
- * Sets the minimum size for a stage window, if the default backend
- * uses #ClutterStage inside a window
- *
- * This is a convenience function, and it is equivalent to setting the
- * #ClutterActor:min-width and #ClutterActor:min-height on @stage
  *
- * If the current size of @stage is smaller than the minimum size, the
- * @stage will be resized to the new @width and @height
+ * Retrieves the value set using clutter_stage_set_motion_events_enabled().
  *
- * This function has no effect if @stage is fullscreen
+ * Return value: %TRUE if the per-actor motion event delivery is enabled
+ *   and %FALSE otherwise
  *
  *
- */
-void
-clutter_stage_set_minimum_size (ClutterStage *stage,
-                                guint         width,
-                                guint         height)
+ */
+gboolean
+clutter_stage_get_motion_events_enabled (ClutterStage *stage)
 {
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail ((width > 0) && (height > 0));
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
-  g_object_set (G_OBJECT (stage),
-                "min-width", (gfloat) width,
-                "min-height", (gfloat )height,
-                NULL);
+  return stage->priv->motion_events_enabled;
 }
 
 /**
- * clutter_stage_get_minimum_size:
+ * clutter_stage_set_show_hud:
  * @stage: a #ClutterStage
- * @width: (out): return location for the minimum width, in pixels,
- *   or %NULL
- * @height: (out): return location for the minimum height, in pixels,
- *   or %NULL
+ * @show: whether to show the performance HUD
  *
- * Retrieves the minimum size for a stage window as set using
- * clutter_stage_set_minimum_size().
- *
- * The returned size may not correspond to the actual minimum size and
- * it is specific to the #ClutterStage implementation inside the
- * Clutter backend
+ * Sets whether @stage should paint a performance HUD on top of its
+ * contents.
  *
+ * The HUD shows a graph of the CPU time of the last frames, the frame
+ * rate, the GPU time, the number of picks, the share of the stage that
+ * is redrawn each frame, the number of actors, the memory used by the
+ * textures and the number of frames that exceeded the frame budget.
  *
+ * The HUD can also be shown on every stage by setting the CLUTTER_DEBUG
+ * environment variable to "hud", if Clutter has been compiled with
+ * debugging enabled.
  */
 void
-clutter_stage_get_minimum_size (ClutterStage *stage,
-                                guint        *width_p,
-                                guint        *height_p)
+clutter_stage_set_show_hud (ClutterStage *stage,
+                            gboolean      show)
 {
-  gfloat width, height;
-  gboolean width_set, height_set;
+  ClutterStagePrivate *priv;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-  g_object_get (G_OBJECT (stage),
-                "min-width", &width,
-                "min-width-set", &width_set,
-                "min-height", &height,
-                "min-height-set", &height_set,
-                NULL);
-
-  /* if not width or height have been set, then the Stage
-   * minimum size is defined to be 1x1
-   */
-  if (!width_set)
-    width = 1;
+  priv = stage->priv;
 
-  if (!height_set)
-    height = 1;
+  if (show == (priv->hud != NULL))
+    return;
 
-  if (width_p)
-    *width_p = (guint) width;
+  if (show)
+    priv->hud = _clutter_stage_hud_new ();
+  else
+    g_clear_pointer (&priv->hud, _clutter_stage_hud_free);
 
-  if (height_p)
-    *height_p = (guint) height;
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
 }
 
-void
-_clutter_stage_schedule_update (ClutterStage *stage)
+/**
+ * clutter_stage_get_show_hud:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves whether @stage paints the performance HUD.
+ *
+ * Return value: %TRUE if the HUD is shown
+ */
+gboolean
+clutter_stage_get_show_hud (ClutterStage *stage)
 {
-  ClutterStageWindow *stage_window;
-
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
-    return;
-
-  stage_window = _clutter_stage_get_window (stage);
-  if (stage_window == NULL)
-    return;
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
-  return _clutter_stage_window_schedule_update (stage_window,
-                                                stage->priv->sync_delay);
+  return stage->priv->hud != NULL;
 }
 
-/* Returns the earliest time the stage is ready to update */
-gint64
-_clutter_stage_get_update_time (ClutterStage *stage)
+/**
+ * clutter_stage_set_geometry_pick_enabled:
+ * @stage: a #ClutterStage
+ * @enabled: whether to enable geometric picking
+ *
+ * Sets whether @stage should find the actor underneath a point by
+ * testing the point against the transformed allocation of each actor,
+ * instead of rendering the scene in pick mode and reading back the
+ * color of the pixel.
+ *
+ * Geometric picking does not require access to the GPU, and avoids
+ * stalling the rendering pipeline while waiting for the read back
+ * to complete. It is only reliable for actors whose silhouette is
+ * their allocation, so if the point lies over an actor that overrides
+ * the #ClutterActorClass.pick() virtual function, or that has an effect
+ * overriding the #ClutterEffectClass.pick() virtual function, @stage
+ * will fall back to a pick render.
+ *
+ * The default is %FALSE.
+ */
+void
+clutter_stage_set_geometry_pick_enabled (ClutterStage *stage,
+                                         gboolean      enabled)
 {
-  ClutterStageWindow *stage_window;
+  ClutterStagePrivate *priv;
 
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
-    return 0;
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-  stage_window = _clutter_stage_get_window (stage);
-  if (stage_window == NULL)
-    return 0;
+  priv = stage->priv;
 
-  return _clutter_stage_window_get_update_time (stage_window);
-}
+  enabled = !!enabled;
 
-void
-_clutter_stage_clear_update_time (ClutterStage *stage)
-{
-  ClutterStageWindow *stage_window;
+  if (priv->geometry_pick_enabled != enabled)
+    {
+      priv->geometry_pick_enabled = enabled;
 
-  stage_window = _clutter_stage_get_window (stage);
-  if (stage_window)
-    _clutter_stage_window_clear_update_time (stage_window);
+      /* a cached pick buffer is still valid, but there's no point
+       * in keeping it around if we're not going to read it
+       */
+      _clutter_stage_set_pick_buffer_valid (stage, FALSE, -1);
+    }
 }
 
 /**
- * clutter_stage_set_no_clear_hint:
+ * clutter_stage_get_geometry_pick_enabled:
  * @stage: a #ClutterStage
- * @no_clear: %TRUE if the @stage should not clear itself on every
- *   repaint cycle
  *
- * Sets whether the @stage should clear itself at the beginning
- * of each paint cycle or not.
+ * Retrieves the value set using clutter_stage_set_geometry_pick_enabled().
  *
- * Clearing the #ClutterStage can be a costly operation, especially
- * if the stage is always covered - for instance, in a full-screen
- * video player or in a game with a background texture.
+ * Return value: %TRUE if geometric picking is enabled
+ */
+gboolean
+clutter_stage_get_geometry_pick_enabled (ClutterStage *stage)
+{
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+
+  return stage->priv->geometry_pick_enabled;
+}
+
+/**
+ * clutter_stage_set_async_pick_enabled:
+ * @stage: a #ClutterStage
+ * @enabled: whether to enable asynchronous picking of motion events
  *
- * <note><para>This setting is a hint; Clutter might discard this
- * hint depending on its internal state.</para></note>
+ * Sets whether @stage should pick the actor underneath the pointer
+ * asynchronously when handling motion events.
  *
- * <warning><para>If parts of the stage are visible and you disable
- * clearing you might end up with visual artifacts while painting the
- * contents of the stage.</para></warning>
+ * Reading back the result of a pick render forces the CPU to wait for
+ * the GPU to complete it. If asynchronous picking is enabled the result
+ * of the picks done for motion events is read back one frame later,
+ * when it is already available; the motion events are delivered to the
+ * actor that was underneath the pointer until then, and the crossing
+ * events are emitted once the pick has been resolved.
  *
+ * Button, scroll and touch events are always picked synchronously.
  *
+ * The default is %FALSE.
  */
 void
-clutter_stage_set_no_clear_hint (ClutterStage *stage,
-                                 gboolean      no_clear)
+clutter_stage_set_async_pick_enabled (ClutterStage *stage,
+                                      gboolean      enabled)
 {
   ClutterStagePrivate *priv;
-  ClutterStageHint new_hints;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
   priv = stage->priv;
-  new_hints = priv->stage_hints;
-
-  if (no_clear)
-    new_hints |= CLUTTER_STAGE_NO_CLEAR_ON_PAINT;
-  else
-    new_hints &= ~CLUTTER_STAGE_NO_CLEAR_ON_PAINT;
 
-  if (priv->stage_hints == new_hints)
-    return;
+  enabled = !!enabled;
 
-  priv->stage_hints = new_hints;
+  if (priv->async_pick_enabled != enabled)
+    {
+      priv->async_pick_enabled = enabled;
 
-  g_object_notify (G_OBJECT (stage), "no-clear-hint");
+      /* the devices will be updated by the next synchronous pick */
+      if (!enabled)
+        clutter_stage_clear_async_picks (stage);
+    }
 }
 
 /**
- * clutter_stage_get_no_clear_hint:
+ * clutter_stage_get_async_pick_enabled:
  * @stage: a #ClutterStage
  *
- * Retrieves the hint set with clutter_stage_set_no_clear_hint()
- *
- * Return value: %TRUE if the stage should not clear itself on every paint
- *   cycle, and %FALSE otherwise
- *
+ * Retrieves the value set using clutter_stage_set_async_pick_enabled().
  *
+ * Return value: %TRUE if asynchronous picking is enabled
  */
 gboolean
-clutter_stage_get_no_clear_hint (ClutterStage *stage)
+clutter_stage_get_async_pick_enabled (ClutterStage *stage)
 {
   g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
-  return (stage->priv->stage_hints & CLUTTER_STAGE_NO_CLEAR_ON_PAINT) != 0;
-}
-
-ClutterPaintVolume *
-_clutter_stage_paint_volume_stack_allocate (ClutterStage *stage)
-{
-  GArray *paint_volume_stack = stage->priv->paint_volume_stack;
-
-  g_array_set_size (paint_volume_stack,
-                    paint_volume_stack->len+1);
-
-  return &g_array_index (paint_volume_stack,
-                         ClutterPaintVolume,
-                         paint_volume_stack->len - 1);
+  return stage->priv->async_pick_enabled;
 }
 
+/**
+ * clutter_stage_set_incremental_relayout:
+ * @stage: a #ClutterStage
+ * @enabled: whether to enable incremental relayouts
+ *
+ * Sets whether @stage should avoid allocating again the ancestors of
+ * an actor that queued a relayout, if the size requests of the actor
+ * did not change.
+ *
+ * Only the changes that cannot affect the layout of the parent of an
+ * actor, except through its size requests, are handled incrementally;
+ * for instance, a change of the text of a #ClutterText. Before the next
+ * allocation cycle, @stage will compute the size requests cached by
+ * the actor again, and if none of them changed the actor will be the
+ * only one to be allocated again.
+ *
+ * The default is %FALSE.
+ */
 void
-_clutter_stage_paint_volume_stack_free_all (ClutterStage *stage)
+clutter_stage_set_incremental_relayout (ClutterStage *stage,
+                                        gboolean      enabled)
 {
-  GArray *paint_volume_stack = stage->priv->paint_volume_stack;
-  int i;
-
-  for (i = 0; i < paint_volume_stack->len; i++)
-    {
-      ClutterPaintVolume *pv =
-        &g_array_index (paint_volume_stack, ClutterPaintVolume, i);
-      clutter_paint_volume_free (pv);
-    }
-
-  g_array_set_size (paint_volume_stack, 0);
-}
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-/* The is an out-of-band paramater available while painting that
- * can be used to cull actors. */
-const ClutterPlane *
-_clutter_stage_get_clip (ClutterStage *stage)
-{
-  return stage->priv->current_clip_planes;
+  stage->priv->incremental_relayout = !!enabled;
 }
 
-/* When an actor queues a redraw we add it to a list on the stage that
- * gets processed once all updates to the stage have been finished.
+/**
+ * clutter_stage_get_incremental_relayout:
+ * @stage: a #ClutterStage
  *
- * This deferred approach to processing queue_redraw requests means
- * that we can avoid redundant transformations of clip volumes if
- * something later triggers a full stage redraw anyway. It also means
- * we can be more sure that all the referenced actors will have valid
- * allocations improving the chance that we can determine the actors
- * paint volume so we can clip the redraw request even if the user
- * didn't explicitly do so.
+ * Retrieves the value set using clutter_stage_set_incremental_relayout().
+ *
+ * Return value: %TRUE if incremental relayouts are enabled
  */
-ClutterStageQueueRedrawEntry *
-_clutter_stage_queue_actor_redraw (ClutterStage *stage,
-                                   ClutterStageQueueRedrawEntry *entry,
-                                   ClutterActor *actor,
-                                   ClutterPaintVolume *clip)
+gboolean
+clutter_stage_get_incremental_relayout (ClutterStage *stage)
 {
-  ClutterStagePrivate *priv = stage->priv;
-
-  CLUTTER_NOTE (CLIPPING, "stage_queue_actor_redraw (actor=%s, clip=%p): ",
-                _clutter_actor_get_debug_name (actor), clip);
-
-  if (!priv->redraw_pending)
-    {
-      ClutterMasterClock *master_clock;
-
-      CLUTTER_NOTE (PAINT, "First redraw request");
-
-      _clutter_stage_schedule_update (stage);
-      priv->redraw_pending = TRUE;
-
-      master_clock = _clutter_master_clock_get_default ();
-      _clutter_master_clock_start_running (master_clock);
-    }
-#ifdef CLUTTER_ENABLE_DEBUG
-  else
-    {
-      CLUTTER_NOTE (PAINT, "Redraw request number %lu",
-                    priv->redraw_count + 1);
-
-      priv->redraw_count += 1;
-    }
-#endif /* CLUTTER_ENABLE_DEBUG */
-
-  /* We have an optimization in _clutter_stage_do_pick to detect when
-   * the scene is static so we can cache a full, un-clipped pick
-   * buffer to avoid continuous pick renders.
-   *
-   * Currently the assumption is that actors queue a redraw when some
-   * state changes that affects painting *or* picking so we can use
-   * this point to invalidate any currently cached pick buffer.
-   */
-  _clutter_stage_set_pick_buffer_valid (stage, FALSE, -1);
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
-  if (entry)
-    {
-      /* Ignore all requests to queue a redraw for an actor if a full
-       * (non-clipped) redraw of the actor has already been queued. */
-      if (!entry->has_clip)
-        {
-          CLUTTER_NOTE (CLIPPING, "Bail from stage_queue_actor_redraw (%s): "
-                        "Unclipped redraw of actor already queued",
-                        _clutter_actor_get_debug_name (actor));
-          return entry;
-        }
+  return stage->priv->incremental_relayout;
+}
 
-      /* If queuing a clipped redraw and a clipped redraw has
-       * previously been queued for this actor then combine the latest
-       * clip together with the existing clip */
-      if (clip)
-        clutter_paint_volume_union (&entry->clip, clip);
-      else
-        {
-          clutter_paint_volume_free (&entry->clip);
-          entry->has_clip = FALSE;
-        }
-      return entry;
-    }
-  else
-    {
-      entry = g_slice_new (ClutterStageQueueRedrawEntry);
-      entry->actor = g_object_ref (actor);
+/* an actor allocated during a relayout, with the allocation it received
+ * before its constraints were applied
+ */
+typedef struct _ConstrainedActor
+{
+  ClutterActor *actor;
 
-      if (clip)
-        {
-          entry->has_clip = TRUE;
-          _clutter_paint_volume_init_static (&entry->clip, actor);
-          _clutter_paint_volume_set_from_volume (&entry->clip, clip);
-        }
-      else
-        entry->has_clip = FALSE;
+  ClutterActorBox box;
+  ClutterAllocationFlags flags;
 
-      stage->priv->pending_queue_redraws =
-        g_list_prepend (stage->priv->pending_queue_redraws, entry);
+  /* the allocation serial after the constraints were last applied */
+  guint solved_serial;
 
-      return entry;
-    }
+  /* used when sorting; see constrained_actor_sort_visit() */
+  guint visit_state;
+} ConstrainedActor;
+
+/* the number of times the constraints are applied in a relayout; more
+ * than one is only needed if the constraints are circular, or depend on
+ * actors allocated by the actors they constrain
+ */
+#define MAX_CONSTRAINT_SWEEPS   4
+
+static void
+constrained_actor_free (gpointer data)
+{
+  ConstrainedActor *entry = data;
+
+  g_object_unref (entry->actor);
+  g_slice_free (ConstrainedActor, entry);
 }
 
 static void
-free_queue_redraw_entry (ClutterStageQueueRedrawEntry *entry)
+clutter_stage_clear_constrained_actors (ClutterStage *stage)
 {
-  if (entry->actor)
-    g_object_unref (entry->actor);
-  if (entry->has_clip)
-    clutter_paint_volume_free (&entry->clip);
-  g_slice_free (ClutterStageQueueRedrawEntry, entry);
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (priv->constrained_actors == NULL)
+    return;
+
+  g_hash_table_unref (priv->constrained_actors_map);
+  priv->constrained_actors_map = NULL;
+
+  g_ptr_array_unref (priv->constrained_actors);
+  priv->constrained_actors = NULL;
 }
 
+/*< private >
+ * _clutter_stage_add_constrained_actor:
+ * @stage: a #ClutterStage
+ * @actor: a #ClutterActor being allocated
+ * @box: the allocation of @actor before its constraints are applied
+ * @flags: the allocation flags
+ *
+ * Records @actor, whose constraints depend on other actors, so that its
+ * constraints are applied again at the end of the current relayout of
+ * @stage if their sources moved after @actor was allocated.
+ */
 void
-_clutter_stage_queue_redraw_entry_invalidate (ClutterStageQueueRedrawEntry *entry)
+_clutter_stage_add_constrained_actor (ClutterStage           *stage,
+                                      ClutterActor           *actor,
+                                      const ClutterActorBox  *box,
+                                      ClutterAllocationFlags  flags)
 {
-  if (entry == NULL)
+  ClutterStagePrivate *priv = stage->priv;
+  ConstrainedActor *entry;
+
+  /* the sweeps keep the entries up to date themselves */
+  if (priv->in_constraint_pass)
     return;
 
-  if (entry->actor != NULL)
+  if (priv->constrained_actors == NULL)
     {
-      g_object_unref (entry->actor);
-      entry->actor = NULL;
+      priv->constrained_actors =
+        g_ptr_array_new_with_free_func (constrained_actor_free);
+      priv->constrained_actors_map = g_hash_table_new (NULL, NULL);
     }
 
-  if (entry->has_clip)
+  entry = g_hash_table_lookup (priv->constrained_actors_map, actor);
+  if (entry == NULL)
     {
-      clutter_paint_volume_free (&entry->clip);
-      entry->has_clip = FALSE;
+      entry = g_slice_new0 (ConstrainedActor);
+      entry->actor = g_object_ref (actor);
+
+      g_ptr_array_add (priv->constrained_actors, entry);
+      g_hash_table_insert (priv->constrained_actors_map, actor, entry);
     }
+
+  entry->box = *box;
+  entry->flags = flags;
+
+  /* the constraints are applied before the allocation is stored */
+  entry->solved_serial = _clutter_actor_get_allocation_serial () + 1;
 }
 
+/* adds @entry to @order after the entries of the sources of its
+ * constraints; circular dependencies are broken at the first entry
+ * that is visited twice
+ */
 static void
-_clutter_stage_maybe_finish_queue_redraws (ClutterStage *stage)
+constrained_actor_sort_visit (GHashTable       *map,
+                              ConstrainedActor *entry,
+                              GPtrArray        *order,
+                              GPtrArray        *sources)
 {
-  /* Note: we have to repeat until the pending_queue_redraws list is
-   * empty because actors are allowed to queue redraws in response to
-   * the queue-redraw signal. For example Clone actors or
-   * texture_new_from_actor actors will have to queue a redraw if
-   * their source queues a redraw.
-   */
-  while (stage->priv->pending_queue_redraws)
-    {
-      GList *l;
-      /* XXX: we need to allow stage->priv->pending_queue_redraws to
-       * be updated while we process the current entries in the list
-       * so we steal the list pointer and then reset it to an empty
-       * list before processing... */
-      GList *stolen_list = stage->priv->pending_queue_redraws;
-      stage->priv->pending_queue_redraws = NULL;
-
-      for (l = stolen_list; l; l = l->next)
-        {
-          ClutterStageQueueRedrawEntry *entry = l->data;
-          ClutterPaintVolume *clip;
+  guint first, i;
+
+  if (entry->visit_state != 0)
+    return;
 
-          /* NB: Entries may be invalidated if the actor gets destroyed */
-          if (G_LIKELY (entry->actor != NULL))
-	    {
-	      clip = entry->has_clip ? &entry->clip : NULL;
+  entry->visit_state = 1;
 
-	      _clutter_actor_finish_queue_redraw (entry->actor, clip);
-	    }
+  first = sources->len;
+  _clutter_actor_get_constraint_sources (entry->actor, sources);
 
-          free_queue_redraw_entry (entry);
-        }
-      g_list_free (stolen_list);
+  for (i = first; i < sources->len; i++)
+    {
+      ConstrainedActor *dep = g_hash_table_lookup (map, sources->pdata[i]);
+
+      if (dep != NULL)
+        constrained_actor_sort_visit (map, dep, order, sources);
     }
+
+  g_ptr_array_set_size (sources, first);
+
+  entry->visit_state = 2;
+  g_ptr_array_add (order, entry);
 }
 
-/**
- * clutter_stage_set_accept_focus:
- * @stage: a #ClutterStage
- * @accept_focus: %TRUE to accept focus on show
- *
- * Sets whether the @stage should accept the key focus when shown.
- *
- * This function should be called before showing @stage using
- * clutter_actor_show().
- *
- *
+/* whether the allocation of a source of the constraints of @entry has
+ * changed since they were last applied
  */
-void
-clutter_stage_set_accept_focus (ClutterStage *stage,
-                                gboolean      accept_focus)
+static gboolean
+constrained_actor_is_stale (ConstrainedActor *entry,
+                            GPtrArray        *sources)
 {
-  ClutterStagePrivate *priv;
-
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  gboolean retval = FALSE;
+  guint i;
 
-  accept_focus = !!accept_focus;
-
-  priv = stage->priv;
+  _clutter_actor_get_constraint_sources (entry->actor, sources);
 
-  if (priv->accept_focus != accept_focus)
+  for (i = 0; i < sources->len; i++)
     {
-      _clutter_stage_window_set_accept_focus (priv->impl, accept_focus);
-      g_object_notify (G_OBJECT (stage), "accept-focus");
+      ClutterActor *source = sources->pdata[i];
+
+      if (_clutter_actor_get_last_allocation_serial (source) >= entry->solved_serial)
+        {
+          retval = TRUE;
+          break;
+        }
     }
-}
 
-/**
- * clutter_stage_get_accept_focus:
- * @stage: a #ClutterStage
- *
- * Retrieves the value set with clutter_stage_set_accept_focus().
- *
- * Return value: %TRUE if the #ClutterStage should accept focus, and %FALSE
- *   otherwise
- *
- *
- */
-gboolean
-clutter_stage_get_accept_focus (ClutterStage *stage)
-{
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), TRUE);
+  g_ptr_array_set_size (sources, 0);
 
-  return stage->priv->accept_focus;
+  return retval;
 }
 
-/**
- * clutter_stage_set_motion_events_enabled:
- * @stage: a #ClutterStage
- * @enabled: %TRUE to enable the motion events delivery, and %FALSE
- *   otherwise
- *
- * Sets whether per-actor motion events (and relative crossing
- * events) should be disabled or not.
- *
- * The default is %TRUE.
- *
- * If @enable is %FALSE the following events will not be delivered
- * to the actors children of @stage.
- *
- * <itemizedlist>
- *   <listitem><para>#ClutterActor::motion-event</para></listitem>
- *   <listitem><para>#ClutterActor::enter-event</para></listitem>
- *   <listitem><para>#ClutterActor::leave-event</para></listitem>
- * </itemizedlist>
- *
- * The events will still be delivered to the #ClutterStage.
- *
- * The main side effect of this function is that disabling the motion
- * events will disable picking to detect the #ClutterActor underneath
- * the pointer for each motion event. This is useful, for instance,
- * when dragging a #ClutterActor across the @stage: the actor underneath
- * the pointer is not going to change, so it's meaningless to perform
- * a pick.
- *
- *
+/* applies again the constraints of the actors allocated during the
+ * relayout whose sources moved after them, ordering the actors so
+ * that sources are solved before the actors that depend on them; the
+ * actors whose sources did not move keep their allocation
  */
-void
-clutter_stage_set_motion_events_enabled (ClutterStage *stage,
-                                         gboolean      enabled)
+static void
+clutter_stage_solve_constraints (ClutterStage *stage)
 {
-  ClutterStagePrivate *priv;
+  ClutterStagePrivate *priv = stage->priv;
+  GPtrArray *order, *sources;
+  guint sweep, i;
 
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  if (priv->constrained_actors == NULL)
+    return;
 
-  priv = stage->priv;
+  order = g_ptr_array_sized_new (priv->constrained_actors->len);
+  sources = g_ptr_array_new ();
 
-  enabled = !!enabled;
+  for (i = 0; i < priv->constrained_actors->len; i++)
+    constrained_actor_sort_visit (priv->constrained_actors_map,
+                                  g_ptr_array_index (priv->constrained_actors, i),
+                                  order,
+                                  sources);
 
-  if (priv->motion_events_enabled != enabled)
-    priv->motion_events_enabled = enabled;
+  priv->in_constraint_pass = TRUE;
+
+  for (sweep = 0; sweep < MAX_CONSTRAINT_SWEEPS; sweep++)
+    {
+      gboolean changed = FALSE;
+
+      for (i = 0; i < order->len; i++)
+        {
+          ConstrainedActor *entry = g_ptr_array_index (order, i);
+          guint serial;
+
+          if (CLUTTER_ACTOR_IN_DESTRUCTION (entry->actor) ||
+              _clutter_actor_get_stage_internal (entry->actor) != CLUTTER_ACTOR (stage))
+            continue;
+
+          if (!constrained_actor_is_stale (entry, sources))
+            continue;
+
+          CLUTTER_NOTE (LAYOUT, "Applying the constraints of '%s' again",
+                        _clutter_actor_get_debug_name (entry->actor));
+
+          serial = _clutter_actor_get_allocation_serial ();
+
+          clutter_actor_allocate (entry->actor, &entry->box, entry->flags);
+
+          if (_clutter_actor_get_allocation_serial () != serial)
+            changed = TRUE;
+
+          entry->solved_serial = _clutter_actor_get_allocation_serial () + 1;
+        }
+
+      if (!changed)
+        break;
+    }
+
+  priv->in_constraint_pass = FALSE;
+
+  g_ptr_array_unref (sources);
+  g_ptr_array_unref (order);
+
+  clutter_stage_clear_constrained_actors (stage);
 }
 
-/**
- * clutter_stage_get_motion_events_enabled:
+/*< private >
+ * _clutter_stage_queue_size_relayout:
  * @stage: a #ClutterStage
+ * @actor: a #ClutterActor
  *
- * Retrieves the value set using clutter_stage_set_motion_events_enabled().
- *
- * Return value: %TRUE if the per-actor motion event delivery is enabled
- *   and %FALSE otherwise
- *
- *
+ * Queues @actor for the check performed by the next allocation cycle
+ * of @stage; see _clutter_actor_queue_size_relayout().
  */
-gboolean
-clutter_stage_get_motion_events_enabled (ClutterStage *stage)
+void
+_clutter_stage_queue_size_relayout (ClutterStage *stage,
+                                    ClutterActor *actor)
 {
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  ClutterStagePrivate *priv = stage->priv;
 
-  return stage->priv->motion_events_enabled;
+  if (priv->pending_size_relayouts == NULL)
+    priv->pending_size_relayouts = g_ptr_array_new_with_free_func (g_object_unref);
+
+  g_ptr_array_add (priv->pending_size_relayouts, g_object_ref (actor));
+
+  if (!priv->relayout_pending)
+    {
+      _clutter_stage_schedule_update (stage);
+      priv->relayout_pending = TRUE;
+    }
 }
 
 /* NB: The presumption shouldn't be that a stage can't be comprised
@@ -3892,6 +7113,145 @@ _clutter_stage_get_actor_by_pick_id (ClutterStage *stage,
   return _clutter_id_pool_lookup (priv->pick_id_pool, pick_id);
 }
 
+/*< private >
+ * _clutter_stage_update_pick_index:
+ * @stage: a #ClutterStage
+ * @actor: a reactive #ClutterActor
+ * @handle_p: the location of the handle of @actor inside the index
+ * @box: the bounding box of @actor, in stage coordinates
+ *
+ * Inserts @actor inside the pick index of @stage, or updates its
+ * bounding box if it's already there.
+ */
+void
+_clutter_stage_update_pick_index (ClutterStage          *stage,
+                                  ClutterActor          *actor,
+                                  gint                  *handle_p,
+                                  const ClutterActorBox *box)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (*handle_p < 0)
+    *handle_p = _clutter_pick_index_insert (priv->pick_index, box, actor);
+  else
+    _clutter_pick_index_update (priv->pick_index, *handle_p, box);
+}
+
+/*< private >
+ * _clutter_stage_get_reactive_actor_at_pos:
+ * @stage: a #ClutterStage
+ * @x: the X coordinate, in stage coordinates
+ * @y: the Y coordinate, in stage coordinates
+ * @ignore: (allow-none): a reactive actor to ignore, or %NULL
+ * @actor_p: (out): return location for the reactive actor at @x, @y
+ *
+ * Retrieves the reactive actor at the given coordinates using only
+ * the pick index of @stage, ignoring @ignore as if it was not
+ * reactive; the scene is never rendered.
+ *
+ * Return value: %TRUE if the pick index could be used, and @actor_p
+ *   has been set
+ */
+gboolean
+_clutter_stage_get_reactive_actor_at_pos (ClutterStage  *stage,
+                                          gfloat         x,
+                                          gfloat         y,
+                                          ClutterActor  *ignore,
+                                          ClutterActor **actor_p)
+{
+  return _clutter_stage_pick_index_pick (stage, x, y, ignore, actor_p);
+}
+
+/*< private >
+ * _clutter_stage_remove_from_pick_index:
+ * @stage: a #ClutterStage
+ * @handle_p: the location of the handle of an actor inside the index
+ *
+ * Removes an actor from the pick index of @stage, and resets the
+ * handle at @handle_p.
+ */
+void
+_clutter_stage_remove_from_pick_index (ClutterStage *stage,
+                                       gint         *handle_p)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (*handle_p < 0)
+    return;
+
+  _clutter_pick_index_remove (priv->pick_index, *handle_p);
+  *handle_p = -1;
+}
+
+/*< private >
+ * _clutter_stage_invalidate_pick_index:
+ * @stage: a #ClutterStage
+ *
+ * Marks the pick index of @stage as incomplete, until the next
+ * full redraw of the stage; until then, reactive picks are
+ * performed by painting the scene.
+ */
+void
+_clutter_stage_invalidate_pick_index (ClutterStage *stage)
+{
+  stage->priv->pick_index_complete = FALSE;
+}
+
+/*< private >
+ * _clutter_stage_get_pick_generation:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves the generation of the state affecting the reactive picks
+ * of @stage; see _clutter_stage_invalidate_pick().
+ *
+ * Return value: the pick generation
+ */
+guint
+_clutter_stage_get_pick_generation (ClutterStage *stage)
+{
+  return stage->priv->pick_generation_reactive;
+}
+
+/*< private >
+ * _clutter_stage_get_view_generation:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves the generation of the view matrix of @stage, which is
+ * bumped each time the matrix changes.
+ *
+ * Return value: the view generation
+ */
+guint
+_clutter_stage_get_view_generation (ClutterStage *stage)
+{
+  return stage->priv->view_generation;
+}
+
+/*< private >
+ * _clutter_stage_invalidate_pick:
+ * @stage: a #ClutterStage
+ * @reactive: whether the change affects the picks of reactive actors
+ *
+ * Bumps the pick generation of @stage, after a state affecting the
+ * result of a pick has changed: the reactive flag, the allocation, the
+ * transformation, the clip, the mapped state or the paint order of an
+ * actor.
+ *
+ * Cached pick results are kept across redraws that do not change the
+ * pick generation.
+ */
+void
+_clutter_stage_invalidate_pick (ClutterStage *stage,
+                                gboolean      reactive)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  priv->pick_generation_all += 1;
+
+  if (reactive)
+    priv->pick_generation_reactive += 1;
+}
+
 void
 _clutter_stage_add_pointer_drag_actor (ClutterStage       *stage,
                                        ClutterInputDevice *device,
@@ -4136,3 +7496,30 @@ clutter_stage_skip_sync_delay (ClutterStage *stage)
   if (stage_window)
     _clutter_stage_window_schedule_update (stage_window, -1);
 }
+
+/**
+ * clutter_stage_set_adaptive_sync_delay:
+ * @stage: a #ClutterStage
+ * @adaptive: whether the sync delay should be computed by Clutter
+ *
+ * Sets whether the delay between the frame presentation and the
+ * painting of the next frame should be computed from the time that
+ * the previous frames took to process events, advance the animations,
+ * relayout and paint.
+ *
+ * When enabled, the next frame starts as late as possible while
+ * still finishing before the next vertical refresh; this reduces the
+ * latency between the input events and their effect on screen. The
+ * value set with clutter_stage_set_sync_delay() is used when the
+ * backend cannot tell the refresh interval.
+ *
+ * Stability: unstable
+ */
+void
+clutter_stage_set_adaptive_sync_delay (ClutterStage *stage,
+                                       gboolean      adaptive)
+{
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  stage->priv->adaptive_sync_delay = !!adaptive;
+}
@@ -115,10 +115,76 @@ struct _ClutterPerspective
   gfloat z_far;
 };
 
+/**
+ * ClutterFrameStats:
+ * @frame_time: the time at which the frame started, in microseconds,
+ *   using the same clock as g_get_monotonic_time()
+ * @events_time: the time spent processing the queued events
+ * @timelines_time: the time spent advancing the timelines
+ * @relayout_time: the time spent allocating the stage
+ * @paint_time: the time spent painting the stage
+ * @swap_wait_time: the time spent presenting the frame on the screen,
+ *   including any wait for the vertical refresh
+ * @gpu_time: the time the GPU spent executing the commands of a frame,
+ *   or -1 if the driver cannot measure it; the GPU timings are read
+ *   without stalling the pipeline, so this is the time of the most
+ *   recent frame the GPU completed, usually a couple of frames behind
+ * @n_picks: the number of picks performed since the previous frame
+ *
+ * The duration of each phase of a frame of a #ClutterStage, in
+ * microseconds; see the #ClutterStage::frame-stats signal.
+ *
+ * The event processing and the timelines are shared by all the
+ * stages updated by the same frame.
+ */
+struct _ClutterFrameStats
+{
+  gint64 frame_time;
+  gint64 events_time;
+  gint64 timelines_time;
+  gint64 relayout_time;
+  gint64 paint_time;
+  gint64 swap_wait_time;
+  gint64 gpu_time;
+  guint n_picks;
+};
+
+/**
+ * ClutterStageCaptureFunc:
+ * @stage: the #ClutterStage that was captured
+ * @data: (array) (allow-none): the captured pixels, in RGBA 8bit format,
+ *   or %NULL if the capture failed
+ * @width: the width of the captured area
+ * @height: the height of the captured area
+ * @stride: the length of each row of @data, in bytes
+ * @damage: (array length=n_damage): the areas of the capture that were
+ *   repainted by the captured frame, relative to the origin of the capture
+ * @n_damage: the number of rectangles in @damage
+ * @user_data: the data passed to clutter_stage_capture_async()
+ *
+ * The function called with the contents of a frame captured by
+ * clutter_stage_capture_async(). Both @data and @damage are owned by
+ * Clutter and are only valid until the function returns.
+ */
+typedef void (* ClutterStageCaptureFunc) (ClutterStage                *stage,
+                                          const guchar                *data,
+                                          gint                         width,
+                                          gint                         height,
+                                          gint                         stride,
+                                          const cairo_rectangle_int_t *damage,
+                                          guint                        n_damage,
+                                          gpointer                     user_data);
+
 GType clutter_perspective_get_type (void) G_GNUC_CONST;
+GType clutter_frame_stats_get_type (void) G_GNUC_CONST;
 GType clutter_stage_get_type (void) G_GNUC_CONST;
 
 ClutterActor *  clutter_stage_new                               (void);
+ClutterActor *  clutter_stage_new_offscreen                     (gint                   width,
+                                                                 gint                   height);
+gboolean        clutter_stage_render_frame                      (ClutterStage          *stage,
+                                                                 gint64                 frame_time);
+CoglHandle      clutter_stage_get_offscreen_texture             (ClutterStage          *stage);
 
 void            clutter_stage_set_perspective                   (ClutterStage          *stage,
 			                                         ClutterPerspective    *perspective);
@@ -148,6 +214,9 @@ gboolean        clutter_stage_get_no_clear_hint                 (ClutterStage
 void            clutter_stage_set_use_alpha                     (ClutterStage          *stage,
                                                                  gboolean               use_alpha);
 gboolean        clutter_stage_get_use_alpha                     (ClutterStage          *stage);
+void            clutter_stage_set_use_orthographic              (ClutterStage          *stage,
+                                                                 gboolean               use_orthographic);
+gboolean        clutter_stage_get_use_orthographic              (ClutterStage          *stage);
 
 void            clutter_stage_set_key_focus                     (ClutterStage          *stage,
                                                                  ClutterActor          *actor);
@@ -158,6 +227,18 @@ gboolean        clutter_stage_get_throttle_motion_events        (ClutterStage
 void            clutter_stage_set_motion_events_enabled         (ClutterStage          *stage,
                                                                  gboolean               enabled);
 gboolean        clutter_stage_get_motion_events_enabled         (ClutterStage          *stage);
+void            clutter_stage_set_show_hud                      (ClutterStage          *stage,
+                                                                 gboolean               show);
+gboolean        clutter_stage_get_show_hud                      (ClutterStage          *stage);
+void            clutter_stage_set_geometry_pick_enabled         (ClutterStage          *stage,
+                                                                 gboolean               enabled);
+gboolean        clutter_stage_get_geometry_pick_enabled         (ClutterStage          *stage);
+void            clutter_stage_set_async_pick_enabled            (ClutterStage          *stage,
+                                                                 gboolean               enabled);
+gboolean        clutter_stage_get_async_pick_enabled            (ClutterStage          *stage);
+void            clutter_stage_set_incremental_relayout          (ClutterStage          *stage,
+                                                                 gboolean               enabled);
+gboolean        clutter_stage_get_incremental_relayout          (ClutterStage          *stage);
 void            clutter_stage_set_accept_focus                  (ClutterStage          *stage,
                                                                  gboolean               accept_focus);
 gboolean        clutter_stage_get_accept_focus                  (ClutterStage          *stage);
@@ -168,11 +249,24 @@ ClutterActor *  clutter_stage_get_actor_at_pos                  (ClutterStage
                                                                  ClutterPickMode        pick_mode,
                                                                  gint                   x,
                                                                  gint                   y);
+void            clutter_stage_get_actors_at_positions           (ClutterStage          *stage,
+                                                                 ClutterPickMode        pick_mode,
+                                                                 const ClutterPoint    *positions,
+                                                                 guint                  n_positions,
+                                                                 ClutterActor         **actors);
 guchar *        clutter_stage_read_pixels                       (ClutterStage          *stage,
                                                                  gint                   x,
                                                                  gint                   y,
                                                                  gint                   width,
                                                                  gint                   height);
+void            clutter_stage_capture_async                     (ClutterStage           *stage,
+                                                                 gint                    x,
+                                                                 gint                    y,
+                                                                 gint                    width,
+                                                                 gint                    height,
+                                                                 ClutterStageCaptureFunc func,
+                                                                 gpointer                user_data,
+                                                                 GDestroyNotify          notify);
 
 void            clutter_stage_get_redraw_clip_bounds            (ClutterStage          *stage,
                                                                  cairo_rectangle_int_t *clip);
@@ -187,6 +281,8 @@ void            clutter_stage_set_sync_delay                    (ClutterStage
                                                                  gint                   sync_delay);
 CLUTTER_AVAILABLE_IN_1_14
 void            clutter_stage_skip_sync_delay                   (ClutterStage          *stage);
+void            clutter_stage_set_adaptive_sync_delay           (ClutterStage          *stage,
+                                                                 gboolean               adaptive);
 #endif
 
 G_END_DECLS
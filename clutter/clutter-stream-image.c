@@ -0,0 +1,707 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:clutter-stream-image
+ * @Title: ClutterStreamImage
+ * @Short_Description: Content for streams of frames, like videos
+ * @See_Also: #ClutterImage, #ClutterContent
+ *
+ * The #ClutterStreamImage class is a #ClutterContent implementation
+ * that displays a stream of frames, like the ones decoded by a video
+ * player or received from a camera.
+ *
+ * Replacing the data of a #ClutterImage for each frame can stall the
+ * application, as the GPU might still be reading the texture of the
+ * previous frame while the new one is being uploaded. A #ClutterStreamImage
+ * keeps a small ring of textures instead, and uploads each frame into the
+ * texture least recently shown, through a pixel buffer if the driver
+ * supports them.
+ *
+ * The frames are pushed using clutter_stream_image_push_frame(), which
+ * can be called from any thread and never blocks; the most recent frame
+ * is uploaded right before the stages are painted, and the frames that
+ * were replaced by a newer one in the meantime are dropped.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <cogl/cogl.h>
+
+#include "clutter-stream-image.h"
+
+#include "clutter-backend.h"
+#include "clutter-color.h"
+#include "clutter-content-private.h"
+#include "clutter-debug.h"
+#include "clutter-main.h"
+#include "clutter-memory.h"
+#include "clutter-paint-node.h"
+#include "clutter-paint-nodes.h"
+#include "clutter-private.h"
+
+#define DEFAULT_N_BUFFERS       3
+#define MAX_N_BUFFERS           8
+
+typedef struct _StreamFrame
+{
+  GBytes *data;
+  CoglPixelFormat pixel_format;
+  guint width;
+  guint height;
+  guint row_stride;
+} StreamFrame;
+
+typedef struct _StreamSlot
+{
+  CoglTexture *texture;
+
+  /* the pixel buffer used to upload the frames into @texture */
+  CoglPixelBuffer *staging;
+  gsize staging_size;
+} StreamSlot;
+
+struct _ClutterStreamImagePrivate
+{
+  /* protects @pending, @upload_posted and @n_dropped, which are
+   * accessed by the threads pushing the frames
+   */
+  GMutex lock;
+
+  /* the most recent frame pushed, waiting to be uploaded */
+  StreamFrame pending;
+  guint upload_posted : 1;
+  guint n_dropped;
+
+  /* the ring of textures; the rest is only accessed by the
+   * Clutter thread
+   */
+  StreamSlot *slots;
+  guint n_slots;
+
+  /* the slot holding the frame being shown, or -1 */
+  gint current;
+
+  CoglPixelFormat pixel_format;
+  guint width;
+  guint height;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_N_BUFFERS,
+
+  LAST_PROP
+};
+
+static GParamSpec *obj_props[LAST_PROP] = { NULL, };
+
+static void clutter_content_iface_init (ClutterContentIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (ClutterStreamImage, clutter_stream_image, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_CONTENT,
+                                                clutter_content_iface_init))
+
+static void
+stream_slot_clear (StreamSlot *slot)
+{
+  g_clear_pointer (&slot->texture, cogl_object_unref);
+
+  if (slot->staging != NULL)
+    {
+      _clutter_memory_account (CLUTTER_MEMORY_CONTENT_TEXTURES,
+                               -(gssize) slot->staging_size,
+                               -1);
+
+      cogl_object_unref (slot->staging);
+      slot->staging = NULL;
+      slot->staging_size = 0;
+    }
+}
+
+static gboolean
+stream_slot_upload (StreamSlot        *slot,
+                    const StreamFrame *frame)
+{
+  CoglContext *ctx;
+  CoglBitmap *bitmap;
+  gsize size;
+  gpointer dest;
+  gboolean res;
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+  if (slot->texture == NULL)
+    {
+      slot->texture = cogl_texture_new_with_size (frame->width,
+                                                  frame->height,
+                                                  COGL_TEXTURE_NO_ATLAS,
+                                                  frame->pixel_format);
+      if (slot->texture == NULL)
+        return FALSE;
+
+      _clutter_memory_track_texture (CLUTTER_MEMORY_CONTENT_TEXTURES,
+                                     slot->texture);
+    }
+
+  size = (gsize) frame->row_stride * frame->height;
+
+  if (slot->staging != NULL && slot->staging_size != size)
+    {
+      _clutter_memory_account (CLUTTER_MEMORY_CONTENT_TEXTURES,
+                               -(gssize) slot->staging_size,
+                               -1);
+
+      cogl_object_unref (slot->staging);
+      slot->staging = NULL;
+      slot->staging_size = 0;
+    }
+
+  if (slot->staging == NULL)
+    {
+      slot->staging = cogl_pixel_buffer_new (ctx, size, NULL);
+      if (slot->staging != NULL)
+        {
+          slot->staging_size = size;
+          _clutter_memory_account (CLUTTER_MEMORY_CONTENT_TEXTURES,
+                                   (gssize) size,
+                                   1);
+        }
+    }
+
+  dest = NULL;
+
+  /* the previous contents of the staging buffer are discarded, so
+   * mapping it does not wait for the GPU to finish reading them
+   */
+  if (slot->staging != NULL)
+    dest = cogl_buffer_map (COGL_BUFFER (slot->staging),
+                            COGL_BUFFER_ACCESS_WRITE,
+                            COGL_BUFFER_MAP_HINT_DISCARD);
+
+  if (dest != NULL)
+    {
+      memcpy (dest, g_bytes_get_data (frame->data, NULL), size);
+      cogl_buffer_unmap (COGL_BUFFER (slot->staging));
+
+      bitmap = cogl_bitmap_new_from_buffer (COGL_BUFFER (slot->staging),
+                                            frame->pixel_format,
+                                            frame->width,
+                                            frame->height,
+                                            frame->row_stride,
+                                            0);
+    }
+  else
+    {
+      bitmap = cogl_bitmap_new_for_data (ctx,
+                                         frame->width,
+                                         frame->height,
+                                         frame->pixel_format,
+                                         frame->row_stride,
+                                         (guint8 *) g_bytes_get_data (frame->data,
+                                                                      NULL));
+    }
+
+  res = cogl_texture_set_region_from_bitmap (slot->texture,
+                                             0, 0,
+                                             0, 0,
+                                             frame->width,
+                                             frame->height,
+                                             bitmap);
+  cogl_object_unref (bitmap);
+
+  return res;
+}
+
+static void
+clutter_stream_image_clear_slots (ClutterStreamImage *image)
+{
+  ClutterStreamImagePrivate *priv = image->priv;
+  guint i;
+
+  for (i = 0; i < priv->n_slots; i++)
+    stream_slot_clear (&priv->slots[i]);
+
+  priv->current = -1;
+}
+
+static void
+clutter_stream_image_upload (ClutterStreamImage *image,
+                             const StreamFrame  *frame)
+{
+  ClutterStreamImagePrivate *priv = image->priv;
+  guint next;
+
+  /* the textures have a fixed size and format */
+  if (frame->width != priv->width ||
+      frame->height != priv->height ||
+      frame->pixel_format != priv->pixel_format)
+    {
+      clutter_stream_image_clear_slots (image);
+
+      priv->width = frame->width;
+      priv->height = frame->height;
+      priv->pixel_format = frame->pixel_format;
+    }
+
+  /* the slot after the current one is the one least recently shown,
+   * so the GPU is the least likely to be still using it
+   */
+  next = (priv->current + 1) % priv->n_slots;
+
+  if (!stream_slot_upload (&priv->slots[next], frame))
+    {
+      g_warning ("Unable to upload a frame of %ux%u pixels into "
+                 "the texture of the stream image",
+                 frame->width,
+                 frame->height);
+      stream_slot_clear (&priv->slots[next]);
+      return;
+    }
+
+  priv->current = next;
+
+  _clutter_content_queue_redraw (CLUTTER_CONTENT (image));
+}
+
+/* called before the stages are painted, at most once per frame */
+static gboolean
+clutter_stream_image_upload_pending (gpointer data)
+{
+  ClutterStreamImage *image = data;
+  ClutterStreamImagePrivate *priv = image->priv;
+  StreamFrame frame;
+
+  g_mutex_lock (&priv->lock);
+
+  frame = priv->pending;
+  priv->pending.data = NULL;
+  priv->upload_posted = FALSE;
+
+  g_mutex_unlock (&priv->lock);
+
+  if (frame.data != NULL)
+    {
+      clutter_stream_image_upload (image, &frame);
+      g_bytes_unref (frame.data);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+clutter_stream_image_purge_caches (gpointer          instance,
+                                   ClutterPurgeLevel level)
+{
+  ClutterStreamImage *image = instance;
+  ClutterStreamImagePrivate *priv = image->priv;
+  guint i;
+
+  if (level < CLUTTER_PURGE_LEVEL_MODERATE)
+    return;
+
+  /* only the texture being shown is needed; the others are created
+   * again when the next frames arrive
+   */
+  for (i = 0; i < priv->n_slots; i++)
+    {
+      if ((gint) i != priv->current)
+        stream_slot_clear (&priv->slots[i]);
+    }
+}
+
+static void
+clutter_stream_image_paint_content (ClutterContent   *content,
+                                    ClutterActor     *actor,
+                                    ClutterPaintNode *root)
+{
+  ClutterStreamImagePrivate *priv = CLUTTER_STREAM_IMAGE (content)->priv;
+  ClutterScalingFilter min_f, mag_f;
+  ClutterContentRepeat repeat;
+  ClutterPaintNode *node;
+  ClutterActorBox box;
+  ClutterColor color;
+  guint8 paint_opacity;
+
+  if (priv->current < 0)
+    return;
+
+  clutter_actor_get_content_box (actor, &box);
+  paint_opacity = clutter_actor_get_paint_opacity (actor);
+  clutter_actor_get_content_scaling_filters (actor, &min_f, &mag_f);
+  repeat = clutter_actor_get_content_repeat (actor);
+
+  color.red = paint_opacity;
+  color.green = paint_opacity;
+  color.blue = paint_opacity;
+  color.alpha = paint_opacity;
+
+  node = clutter_texture_node_new (priv->slots[priv->current].texture,
+                                   &color,
+                                   min_f,
+                                   mag_f);
+  clutter_paint_node_set_name (node, "StreamImage");
+
+  if (repeat == CLUTTER_REPEAT_NONE)
+    clutter_paint_node_add_rectangle (node, &box);
+  else
+    {
+      float t_w = 1.f, t_h = 1.f;
+
+      if ((repeat & CLUTTER_REPEAT_X_AXIS) != FALSE)
+        t_w = (box.x2 - box.x1) / priv->width;
+
+      if ((repeat & CLUTTER_REPEAT_Y_AXIS) != FALSE)
+        t_h = (box.y2 - box.y1) / priv->height;
+
+      clutter_paint_node_add_texture_rectangle (node, &box,
+                                                0.f, 0.f,
+                                                t_w, t_h);
+    }
+
+  clutter_paint_node_add_child (root, node);
+  clutter_paint_node_unref (node);
+}
+
+static gboolean
+clutter_stream_image_get_preferred_size (ClutterContent *content,
+                                         gfloat         *width,
+                                         gfloat         *height)
+{
+  ClutterStreamImagePrivate *priv = CLUTTER_STREAM_IMAGE (content)->priv;
+
+  if (priv->current < 0)
+    return FALSE;
+
+  if (width != NULL)
+    *width = priv->width;
+
+  if (height != NULL)
+    *height = priv->height;
+
+  return TRUE;
+}
+
+static gboolean
+clutter_stream_image_is_opaque (ClutterContent *content)
+{
+  ClutterStreamImagePrivate *priv = CLUTTER_STREAM_IMAGE (content)->priv;
+
+  if (priv->current < 0)
+    return FALSE;
+
+  return (priv->pixel_format & COGL_A_BIT) == 0;
+}
+
+static void
+clutter_content_iface_init (ClutterContentIface *iface)
+{
+  iface->paint_content = clutter_stream_image_paint_content;
+  iface->get_preferred_size = clutter_stream_image_get_preferred_size;
+  iface->is_opaque = clutter_stream_image_is_opaque;
+}
+
+static void
+clutter_stream_image_finalize (GObject *gobject)
+{
+  ClutterStreamImage *self = CLUTTER_STREAM_IMAGE (gobject);
+  ClutterStreamImagePrivate *priv = self->priv;
+
+  _clutter_memory_remove_purge_func (self);
+
+  /* a posted upload holds a reference on the image */
+  g_assert (!priv->upload_posted);
+
+  clutter_stream_image_clear_slots (self);
+  g_free (priv->slots);
+
+  g_mutex_clear (&priv->lock);
+
+  G_OBJECT_CLASS (clutter_stream_image_parent_class)->finalize (gobject);
+}
+
+static void
+clutter_stream_image_set_property (GObject      *gobject,
+                                   guint         prop_id,
+                                   const GValue *value,
+                                   GParamSpec   *pspec)
+{
+  ClutterStreamImage *self = CLUTTER_STREAM_IMAGE (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_N_BUFFERS:
+      clutter_stream_image_set_n_buffers (self, g_value_get_uint (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_stream_image_get_property (GObject    *gobject,
+                                   guint       prop_id,
+                                   GValue     *value,
+                                   GParamSpec *pspec)
+{
+  ClutterStreamImagePrivate *priv = CLUTTER_STREAM_IMAGE (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_N_BUFFERS:
+      g_value_set_uint (value, priv->n_slots);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_stream_image_class_init (ClutterStreamImageClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (ClutterStreamImagePrivate));
+
+  /**
+   * ClutterStreamImage:n-buffers:
+   *
+   * The number of textures used by the image to hold the frames.
+   *
+   * A new frame is uploaded into the texture that has been shown the
+   * least recently; using more textures reduces the chances of having
+   * to wait for the GPU to stop using it, at the cost of more memory.
+   */
+  obj_props[PROP_N_BUFFERS] =
+    g_param_spec_uint ("n-buffers",
+                       P_("Buffers"),
+                       P_("The number of textures holding the frames"),
+                       2, MAX_N_BUFFERS,
+                       DEFAULT_N_BUFFERS,
+                       CLUTTER_PARAM_READWRITE);
+
+  gobject_class->set_property = clutter_stream_image_set_property;
+  gobject_class->get_property = clutter_stream_image_get_property;
+  gobject_class->finalize = clutter_stream_image_finalize;
+
+  g_object_class_install_properties (gobject_class, LAST_PROP, obj_props);
+}
+
+static void
+clutter_stream_image_init (ClutterStreamImage *self)
+{
+  ClutterStreamImagePrivate *priv;
+
+  self->priv = priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
+                                                   CLUTTER_TYPE_STREAM_IMAGE,
+                                                   ClutterStreamImagePrivate);
+
+  g_mutex_init (&priv->lock);
+
+  priv->n_slots = DEFAULT_N_BUFFERS;
+  priv->slots = g_new0 (StreamSlot, priv->n_slots);
+  priv->current = -1;
+
+  _clutter_memory_add_purge_func (CLUTTER_MEMORY_CONTENT_TEXTURES,
+                                  self,
+                                  clutter_stream_image_purge_caches);
+}
+
+/**
+ * clutter_stream_image_new:
+ *
+ * Creates a new #ClutterStreamImage instance.
+ *
+ * Return value: (transfer full): the newly created #ClutterStreamImage.
+ *   Use g_object_unref() when done.
+ */
+ClutterContent *
+clutter_stream_image_new (void)
+{
+  return g_object_new (CLUTTER_TYPE_STREAM_IMAGE, NULL);
+}
+
+/**
+ * clutter_stream_image_push_frame:
+ * @image: a #ClutterStreamImage
+ * @data: the image data of the frame
+ * @pixel_format: the Cogl pixel format of the image data
+ * @width: the width of the frame
+ * @height: the height of the frame
+ * @row_stride: the length of each row inside @data
+ *
+ * Queues a new frame to be shown by @image.
+ *
+ * The frame is uploaded before the next frame of the stages is painted,
+ * and @data is kept until then. If another frame is pushed in the
+ * meantime, @data is released without being uploaded; the number of
+ * frames dropped this way is returned by
+ * clutter_stream_image_get_dropped_frames().
+ *
+ * This function can be called from any thread, and it does not wait
+ * for the upload of the frame.
+ */
+void
+clutter_stream_image_push_frame (ClutterStreamImage *image,
+                                 GBytes             *data,
+                                 CoglPixelFormat     pixel_format,
+                                 guint               width,
+                                 guint               height,
+                                 guint               row_stride)
+{
+  ClutterStreamImagePrivate *priv;
+  GBytes *dropped;
+  gboolean post;
+
+  g_return_if_fail (CLUTTER_IS_STREAM_IMAGE (image));
+  g_return_if_fail (data != NULL);
+  g_return_if_fail (width > 0 && height > 0);
+  g_return_if_fail (g_bytes_get_size (data) >= (gsize) row_stride * height);
+
+  priv = image->priv;
+
+  g_mutex_lock (&priv->lock);
+
+  dropped = priv->pending.data;
+  if (dropped != NULL)
+    priv->n_dropped += 1;
+
+  priv->pending.data = g_bytes_ref (data);
+  priv->pending.pixel_format = pixel_format;
+  priv->pending.width = width;
+  priv->pending.height = height;
+  priv->pending.row_stride = row_stride;
+
+  post = !priv->upload_posted;
+  priv->upload_posted = TRUE;
+
+  g_mutex_unlock (&priv->lock);
+
+  if (dropped != NULL)
+    g_bytes_unref (dropped);
+
+  /* the upload is done on the Clutter thread, right before painting,
+   * so that only the most recent frame is ever uploaded
+   */
+  if (post)
+    clutter_threads_post_task (CLUTTER_REPAINT_FLAGS_PRE_PAINT,
+                               clutter_stream_image_upload_pending,
+                               g_object_ref (image),
+                               g_object_unref);
+}
+
+/**
+ * clutter_stream_image_set_n_buffers:
+ * @image: a #ClutterStreamImage
+ * @n_buffers: the number of textures, between 2 and 8
+ *
+ * Sets the number of textures used by @image to hold the frames.
+ *
+ * This function must be called from the Clutter thread.
+ */
+void
+clutter_stream_image_set_n_buffers (ClutterStreamImage *image,
+                                    guint               n_buffers)
+{
+  ClutterStreamImagePrivate *priv;
+  StreamSlot *slots;
+
+  g_return_if_fail (CLUTTER_IS_STREAM_IMAGE (image));
+  g_return_if_fail (n_buffers >= 2 && n_buffers <= MAX_N_BUFFERS);
+
+  priv = image->priv;
+
+  if (priv->n_slots == n_buffers)
+    return;
+
+  slots = g_new0 (StreamSlot, n_buffers);
+
+  /* keep showing the current frame */
+  if (priv->current >= 0)
+    {
+      slots[0] = priv->slots[priv->current];
+      priv->slots[priv->current].texture = NULL;
+      priv->slots[priv->current].staging = NULL;
+      priv->slots[priv->current].staging_size = 0;
+    }
+
+  clutter_stream_image_clear_slots (image);
+  g_free (priv->slots);
+
+  if (slots[0].texture != NULL)
+    priv->current = 0;
+
+  priv->slots = slots;
+  priv->n_slots = n_buffers;
+
+  g_object_notify_by_pspec (G_OBJECT (image), obj_props[PROP_N_BUFFERS]);
+}
+
+/**
+ * clutter_stream_image_get_n_buffers:
+ * @image: a #ClutterStreamImage
+ *
+ * Retrieves the value set using clutter_stream_image_set_n_buffers().
+ *
+ * Return value: the number of textures holding the frames
+ */
+guint
+clutter_stream_image_get_n_buffers (ClutterStreamImage *image)
+{
+  g_return_val_if_fail (CLUTTER_IS_STREAM_IMAGE (image), DEFAULT_N_BUFFERS);
+
+  return image->priv->n_slots;
+}
+
+/**
+ * clutter_stream_image_get_dropped_frames:
+ * @image: a #ClutterStreamImage
+ *
+ * Retrieves the number of frames pushed to @image that were replaced
+ * by a newer frame before they could be uploaded.
+ *
+ * This function can be called from any thread.
+ *
+ * Return value: the number of frames dropped
+ */
+guint
+clutter_stream_image_get_dropped_frames (ClutterStreamImage *image)
+{
+  guint retval;
+
+  g_return_val_if_fail (CLUTTER_IS_STREAM_IMAGE (image), 0);
+
+  g_mutex_lock (&image->priv->lock);
+  retval = image->priv->n_dropped;
+  g_mutex_unlock (&image->priv->lock);
+
+  return retval;
+}
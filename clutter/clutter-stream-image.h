@@ -0,0 +1,91 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__CLUTTER_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <clutter/clutter.h> can be included directly."
+#endif
+
+#ifndef __CLUTTER_STREAM_IMAGE_H__
+#define __CLUTTER_STREAM_IMAGE_H__
+
+#include <cogl/cogl.h>
+#include <clutter/clutter-types.h>
+
+G_BEGIN_DECLS
+
+#define CLUTTER_TYPE_STREAM_IMAGE               (clutter_stream_image_get_type ())
+#define CLUTTER_STREAM_IMAGE(obj)               (G_TYPE_CHECK_INSTANCE_CAST ((obj), CLUTTER_TYPE_STREAM_IMAGE, ClutterStreamImage))
+#define CLUTTER_IS_STREAM_IMAGE(obj)            (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CLUTTER_TYPE_STREAM_IMAGE))
+#define CLUTTER_STREAM_IMAGE_CLASS(klass)       (G_TYPE_CHECK_CLASS_CAST ((klass), CLUTTER_TYPE_STREAM_IMAGE, ClutterStreamImageClass))
+#define CLUTTER_IS_STREAM_IMAGE_CLASS(klass)    (G_TYPE_CHECK_CLASS_TYPE ((klass), CLUTTER_TYPE_STREAM_IMAGE))
+#define CLUTTER_STREAM_IMAGE_GET_CLASS(obj)     (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_STREAM_IMAGE, ClutterStreamImageClass))
+
+typedef struct _ClutterStreamImage              ClutterStreamImage;
+typedef struct _ClutterStreamImagePrivate       ClutterStreamImagePrivate;
+typedef struct _ClutterStreamImageClass         ClutterStreamImageClass;
+
+/**
+ * ClutterStreamImage:
+ *
+ * The <structname>ClutterStreamImage</structname> structure contains
+ * private data and should only be accessed using the provided
+ * API.
+ */
+struct _ClutterStreamImage
+{
+  /*< private >*/
+  GObject parent_instance;
+
+  ClutterStreamImagePrivate *priv;
+};
+
+/**
+ * ClutterStreamImageClass:
+ *
+ * The <structname>ClutterStreamImageClass</structname> structure contains
+ * private data.
+ */
+struct _ClutterStreamImageClass
+{
+  /*< private >*/
+  GObjectClass parent_class;
+
+  gpointer _padding[16];
+};
+
+GType clutter_stream_image_get_type (void) G_GNUC_CONST;
+
+ClutterContent *        clutter_stream_image_new                (void);
+
+void                    clutter_stream_image_push_frame         (ClutterStreamImage *image,
+                                                                 GBytes             *data,
+                                                                 CoglPixelFormat     pixel_format,
+                                                                 guint               width,
+                                                                 guint               height,
+                                                                 guint               row_stride);
+void                    clutter_stream_image_set_n_buffers      (ClutterStreamImage *image,
+                                                                 guint               n_buffers);
+guint                   clutter_stream_image_get_n_buffers      (ClutterStreamImage *image);
+guint                   clutter_stream_image_get_dropped_frames (ClutterStreamImage *image);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_STREAM_IMAGE_H__ */
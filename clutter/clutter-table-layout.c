@@ -84,6 +84,7 @@
 
 #include "clutter-table-layout.h"
 
+#include "clutter-actor-private.h"
 #include "clutter-container.h"
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
@@ -109,6 +110,11 @@ typedef struct _DimensionData {
   guint visible : 1;
 } DimensionData;
 
+typedef struct _TableCell {
+  ClutterActor *actor;
+  ClutterTableChild *meta;
+} TableCell;
+
 struct _ClutterTableLayoutPrivate
 {
   ClutterContainer *container;
@@ -125,6 +131,19 @@ struct _ClutterTableLayoutPrivate
 
   GArray *columns;
   GArray *rows;
+
+  /* the children and their metas, in paint order, so that the solver
+   * does not need to look up the metas on every pass; rebuilt only when
+   * the children or their child properties change
+   */
+  GArray *cells;
+  gint children_age;
+
+  /* the number of children spanning more than one column or row */
+  gint n_col_spanning;
+  gint n_row_spanning;
+
+  guint cells_valid : 1;
 };
 
 struct _ClutterTableChild
@@ -380,6 +399,18 @@ clutter_table_layout_set_container (ClutterLayoutManager *layout,
   ClutterTableLayoutPrivate *priv = CLUTTER_TABLE_LAYOUT (layout)->priv;
 
   priv->container = container;
+  priv->cells_valid = FALSE;
+}
+
+static void
+clutter_table_layout_layout_changed (ClutterLayoutManager *layout)
+{
+  ClutterTableLayoutPrivate *priv = CLUTTER_TABLE_LAYOUT (layout)->priv;
+
+  /* the child properties might have changed, so the cells have
+   * to be collected again
+   */
+  priv->cells_valid = FALSE;
 }
 
 
@@ -392,31 +423,108 @@ update_row_col (ClutterTableLayout *layout,
   ClutterActor *actor, *child;
   gint n_cols, n_rows;
 
-  n_cols = n_rows = 0;
-
   if (container == NULL)
-    goto out;
+    {
+      g_array_set_size (priv->cells, 0);
+      priv->cells_valid = FALSE;
+      priv->n_col_spanning = priv->n_row_spanning = 0;
+      priv->n_cols = priv->n_rows = 0;
+      return;
+    }
 
   actor = CLUTTER_ACTOR (container);
+
+  /* adding, removing or reordering children changes the age */
+  if (priv->cells_valid &&
+      priv->children_age == _clutter_actor_get_children_age (actor))
+    return;
+
+  n_cols = n_rows = 0;
+
+  g_array_set_size (priv->cells, 0);
+  priv->n_col_spanning = priv->n_row_spanning = 0;
+
   for (child = clutter_actor_get_first_child (actor);
        child != NULL;
        child = clutter_actor_get_next_sibling (child))
     {
       ClutterTableChild *meta;
+      TableCell cell;
 
       meta =
-        CLUTTER_TABLE_CHILD (clutter_layout_manager_get_child_meta (manager,
-                                                                    container,
-                                                                    child));
+        CLUTTER_TABLE_CHILD (_clutter_layout_manager_get_child_meta (manager,
+                                                                     container,
+                                                                     child));
 
       n_cols = MAX (n_cols, meta->col + meta->col_span);
       n_rows = MAX (n_rows, meta->row + meta->row_span);
+
+      if (meta->col_span > 1)
+        priv->n_col_spanning += 1;
+
+      if (meta->row_span > 1)
+        priv->n_row_spanning += 1;
+
+      cell.actor = child;
+      cell.meta = meta;
+      g_array_append_val (priv->cells, cell);
     }
 
-out:
   priv->n_cols = n_cols;
   priv->n_rows = n_rows;
 
+  priv->children_age = _clutter_actor_get_children_age (actor);
+  priv->cells_valid = TRUE;
+}
+
+/* Shrinks the dimensions between @start and @end, starting from their
+ * preferred size, until their total @size is not bigger than @target.
+ *
+ * This is the same as decrementing by one pixel, in turns, each of the
+ * dimensions that is still bigger than its minimum size, but it skips
+ * ahead over all the turns in which the same dimensions are shrinking.
+ */
+static void
+shrink_dimensions (DimensionData *dims,
+                   gint           start,
+                   gint           end,
+                   gfloat         size,
+                   gfloat         target)
+{
+  gint turns = 0;
+  gint i;
+
+  while (size > target)
+    {
+      gint n_shrinking = 0, next_stop = G_MAXINT, step;
+
+      for (i = start; i <= end; i++)
+        {
+          gint max_turns = ceilf (dims[i].pref_size - dims[i].min_size);
+
+          if (max_turns > turns)
+            {
+              n_shrinking += 1;
+              next_stop = MIN (next_stop, max_turns);
+            }
+        }
+
+      if (n_shrinking == 0)
+        break;
+
+      step = ceilf ((size - target) / n_shrinking);
+      step = MIN (step, next_stop - turns);
+
+      size -= (gfloat) step * n_shrinking;
+      turns += step;
+    }
+
+  for (i = start; i <= end; i++)
+    {
+      gint max_turns = ceilf (dims[i].pref_size - dims[i].min_size);
+
+      dims[i].final_size = dims[i].pref_size - CLAMP (max_turns, 0, turns);
+    }
 }
 
 static void
@@ -425,8 +533,7 @@ calculate_col_widths (ClutterTableLayout *self,
                       gint                for_width)
 {
   ClutterTableLayoutPrivate *priv = self->priv;
-  ClutterLayoutManager *manager = CLUTTER_LAYOUT_MANAGER (self);
-  ClutterActor *actor, *child;
+  guint c;
   gint i;
   DimensionData *columns;
   ClutterOrientation orientation = CLUTTER_ORIENTATION_HORIZONTAL;
@@ -444,25 +551,17 @@ calculate_col_widths (ClutterTableLayout *self,
       columns[i].visible = FALSE;
     }
 
-  actor = CLUTTER_ACTOR (container);
-
   /* STAGE ONE: calculate column widths for non-spanned children */
-  for (child = clutter_actor_get_first_child (actor);
-       child != NULL;
-       child = clutter_actor_get_next_sibling (child))
+  for (c = 0; c < priv->cells->len; c++)
     {
-      ClutterTableChild *meta;
+      ClutterActor *child = g_array_index (priv->cells, TableCell, c).actor;
+      ClutterTableChild *meta = g_array_index (priv->cells, TableCell, c).meta;
       DimensionData *col;
       gfloat c_min, c_pref;
 
       if (!CLUTTER_ACTOR_IS_VISIBLE (child))
         continue;
 
-      meta =
-        CLUTTER_TABLE_CHILD (clutter_layout_manager_get_child_meta (manager,
-                                                                    container,
-                                                                    child));
-
       if (meta->col_span > 1)
         continue;
 
@@ -483,12 +582,15 @@ calculate_col_widths (ClutterTableLayout *self,
         col->expand = clutter_actor_needs_expand (child, orientation);
     }
 
+  /* tables without spanning children only need one pass */
+  if (priv->n_col_spanning == 0)
+    goto final_sizes;
+
   /* STAGE TWO: take spanning children into account */
-  for (child = clutter_actor_get_first_child (actor);
-       child != NULL;
-       child = clutter_actor_get_next_sibling (child))
+  for (c = 0; c < priv->cells->len; c++)
     {
-      ClutterTableChild *meta;
+      ClutterActor *child = g_array_index (priv->cells, TableCell, c).actor;
+      ClutterTableChild *meta = g_array_index (priv->cells, TableCell, c).meta;
       gfloat c_min, c_pref;
       gfloat min_width, pref_width;
       gint start_col, end_col;
@@ -497,11 +599,6 @@ calculate_col_widths (ClutterTableLayout *self,
       if (!CLUTTER_ACTOR_IS_VISIBLE (child))
         continue;
 
-      meta =
-        CLUTTER_TABLE_CHILD (clutter_layout_manager_get_child_meta (manager,
-                                                                    container,
-                                                                    child));
-
       if (meta->col_span < 2)
         continue;
 
@@ -544,20 +641,7 @@ calculate_col_widths (ClutterTableLayout *self,
           /* we can start from preferred width and decrease */
           if (pref_width > c_min)
             {
-              for (i = start_col; i <= end_col; i++)
-                columns[i].final_size = columns[i].pref_size;
-
-              while (pref_width > c_min)
-                {
-                  for (i = start_col; i <= end_col; i++)
-                    {
-                      if (columns[i].final_size > columns[i].min_size)
-                        {
-                          columns[i].final_size--;
-                          pref_width--;
-                        }
-                    }
-                }
+              shrink_dimensions (columns, start_col, end_col, pref_width, c_min);
 
               for (i = start_col; i <= end_col; i++)
                 columns[i].min_size = columns[i].final_size;
@@ -586,6 +670,7 @@ calculate_col_widths (ClutterTableLayout *self,
         }
     }
 
+final_sizes:
   /* calculate final widths */
   if (for_width >= 0)
     {
@@ -628,27 +713,12 @@ calculate_col_widths (ClutterTableLayout *self,
       /* for_width is between min_width and pref_width */
       if (for_width < pref_width && for_width > min_width)
         {
-          gfloat width;
-
-          /* shrink columns until they reach min_width */
-
-          /* start with all columns at preferred size */
-          for (i = 0; i < self->priv->n_cols; i++)
-            columns[i].final_size = columns[i].pref_size;
-
-          width = pref_width;
-
-          while (width > for_width)
-            {
-              for (i = 0; i < self->priv->n_cols; i++)
-                {
-                  if (columns[i].final_size > columns[i].min_size)
-                    {
-                      columns[i].final_size--;
-                      width--;
-                    }
-                }
-            }
+          /* shrink columns until they reach min_width, starting with
+           * all columns at preferred size
+           */
+          shrink_dimensions (columns, 0, priv->n_cols - 1,
+                             pref_width,
+                             for_width);
 
           return;
         }
@@ -694,8 +764,7 @@ calculate_row_heights (ClutterTableLayout *self,
                        gint                for_height)
 {
   ClutterTableLayoutPrivate *priv = self->priv;
-  ClutterLayoutManager *manager = CLUTTER_LAYOUT_MANAGER (self);
-  ClutterActor *actor, *child;
+  guint c;
   gint i;
   DimensionData *rows, *columns;
   ClutterOrientation orientation = CLUTTER_ORIENTATION_VERTICAL;
@@ -715,25 +784,17 @@ calculate_row_heights (ClutterTableLayout *self,
       rows[i].visible = FALSE;
     }
 
-  actor = CLUTTER_ACTOR (container);
-
   /* STAGE ONE: calculate row heights for non-spanned children */
-  for (child = clutter_actor_get_first_child (actor);
-       child != NULL;
-       child = clutter_actor_get_next_sibling (child))
+  for (c = 0; c < priv->cells->len; c++)
     {
-      ClutterTableChild *meta;
+      ClutterActor *child = g_array_index (priv->cells, TableCell, c).actor;
+      ClutterTableChild *meta = g_array_index (priv->cells, TableCell, c).meta;
       DimensionData *row;
       gfloat c_min, c_pref;
 
       if (!CLUTTER_ACTOR_IS_VISIBLE (child))
         continue;
 
-      meta =
-        CLUTTER_TABLE_CHILD (clutter_layout_manager_get_child_meta (manager,
-                                                                    container,
-                                                                    child));
-
       if (meta->row_span > 1)
         continue;
 
@@ -755,12 +816,15 @@ calculate_row_heights (ClutterTableLayout *self,
         row->expand = clutter_actor_needs_expand (child, orientation);
     }
 
+  /* tables without spanning children only need one pass */
+  if (priv->n_row_spanning == 0)
+    goto final_sizes;
+
   /* STAGE TWO: take spanning children into account */
-  for (child = clutter_actor_get_first_child (actor);
-       child != NULL;
-       child = clutter_actor_get_next_sibling (child))
+  for (c = 0; c < priv->cells->len; c++)
     {
-      ClutterTableChild *meta;
+      ClutterActor *child = g_array_index (priv->cells, TableCell, c).actor;
+      ClutterTableChild *meta = g_array_index (priv->cells, TableCell, c).meta;
       gfloat c_min, c_pref;
       gfloat min_height, pref_height;
       gint start_row, end_row;
@@ -769,11 +833,6 @@ calculate_row_heights (ClutterTableLayout *self,
       if (!CLUTTER_ACTOR_IS_VISIBLE (child))
         continue;
 
-      meta =
-        CLUTTER_TABLE_CHILD (clutter_layout_manager_get_child_meta (manager,
-                                                                    container,
-                                                                    child));
-
       if (meta->row_span < 2)
         continue;
 
@@ -830,20 +889,7 @@ calculate_row_heights (ClutterTableLayout *self,
           /* we can start from preferred height and decrease */
           if (pref_height > c_min)
             {
-              for (i = start_row; i <= end_row; i++)
-                rows[i].final_size = rows[i].pref_size;
-
-              while (pref_height > c_min)
-                {
-                  for (i = start_row; i <= end_row; i++)
-                    {
-                      if (rows[i].final_size > rows[i].min_size)
-                        {
-                          rows[i].final_size--;
-                          pref_height--;
-                        }
-                    }
-                }
+              shrink_dimensions (rows, start_row, end_row, pref_height, c_min);
 
               for (i = start_row; i <= end_row; i++)
                 rows[i].min_size = rows[i].final_size;
@@ -870,6 +916,7 @@ calculate_row_heights (ClutterTableLayout *self,
         }
     }
 
+final_sizes:
   /* calculate final heights */
   if (for_height >= 0)
     {
@@ -912,27 +959,12 @@ calculate_row_heights (ClutterTableLayout *self,
       /* for_height is between min_height and pref_height */
       if (for_height < pref_height && for_height > min_height)
         {
-          gfloat height;
-
-          /* shrink rows until they reach min_height */
-
-          /* start with all rows at preferred size */
-          for (i = 0; i < self->priv->n_rows; i++)
-            rows[i].final_size = rows[i].pref_size;
-
-          height = pref_height;
-
-          while (height > for_height)
-            {
-              for (i = 0; i < priv->n_rows; i++)
-                {
-                  if (rows[i].final_size > rows[i].min_size)
-                    {
-                      rows[i].final_size--;
-                      height--;
-                    }
-                }
-            }
+          /* shrink rows until they reach min_height, starting with
+           * all rows at preferred size
+           */
+          shrink_dimensions (rows, 0, priv->n_rows - 1,
+                             pref_height,
+                             for_height);
 
           return;
         }
@@ -1108,9 +1140,9 @@ clutter_table_layout_allocate (ClutterLayoutManager   *layout,
         continue;
 
       meta =
-        CLUTTER_TABLE_CHILD (clutter_layout_manager_get_child_meta (layout,
-                                                                    container,
-                                                                    child));
+        CLUTTER_TABLE_CHILD (_clutter_layout_manager_get_child_meta (layout,
+                                                                     container,
+                                                                     child));
 
       /* get child properties */
       col = meta->col;
@@ -1242,6 +1274,7 @@ clutter_table_layout_finalize (GObject *gobject)
 
   g_array_free (priv->columns, TRUE);
   g_array_free (priv->rows, TRUE);
+  g_array_free (priv->cells, TRUE);
 
   G_OBJECT_CLASS (clutter_table_layout_parent_class)->finalize (gobject);
 }
@@ -1265,6 +1298,7 @@ clutter_table_layout_class_init (ClutterTableLayoutClass *klass)
     clutter_table_layout_get_preferred_height;
   layout_class->allocate = clutter_table_layout_allocate;
   layout_class->set_container = clutter_table_layout_set_container;
+  layout_class->layout_changed = clutter_table_layout_layout_changed;
   layout_class->get_child_meta_type =
     clutter_table_layout_get_child_meta_type;
 
@@ -1311,6 +1345,7 @@ clutter_table_layout_init (ClutterTableLayout *layout)
 
   priv->columns = g_array_new (FALSE, TRUE, sizeof (DimensionData));
   priv->rows = g_array_new (FALSE, TRUE, sizeof (DimensionData));
+  priv->cells = g_array_new (FALSE, FALSE, sizeof (TableCell));
 }
 
 /**
@@ -77,6 +77,21 @@ struct _ClutterTextBufferPrivate
   gsize  normal_text_size;
   gsize  normal_text_bytes;
   guint  normal_text_chars;
+
+  /* The free space of normal_text is kept as a gap at the position of
+   * the last edit, so that consecutive edits at the same position do
+   * not need to move the rest of the text; the gap is moved to the end
+   * of the text when the contents are retrieved
+   */
+  gsize  normal_text_gap;
+  gsize  normal_text_gap_len;
+  guint  normal_text_gap_chars;
+
+  /* The byte offset of the last character position that was looked
+   * up, used to avoid walking the whole text to find a position
+   */
+  guint  normal_text_cached_chars;
+  gsize  normal_text_cached_bytes;
 };
 
 G_DEFINE_TYPE (ClutterTextBuffer, clutter_text_buffer, G_TYPE_OBJECT);
@@ -99,15 +114,112 @@ trash_area (gchar *area,
     *varea++ = 0;
 }
 
+/* Returns the address of the logical byte offset @b, skipping the gap */
+#define NORMAL_TEXT_AT(pv,b) \
+  ((pv)->normal_text + (b) + ((b) < (pv)->normal_text_gap ? 0 : (pv)->normal_text_gap_len))
+
+/* Moves the gap to the logical byte offset @at, matching the character
+ * offset @at_chars; the bytes left inside the gap are trashed, as they
+ * might contain sensitive information.
+ */
+static void
+normal_text_move_gap (ClutterTextBufferPrivate *pv,
+                      gsize                     at,
+                      guint                     at_chars)
+{
+  gchar *text = pv->normal_text;
+  gsize gap = pv->normal_text_gap;
+  gsize gap_len = pv->normal_text_gap_len;
+
+  if (at < gap)
+    {
+      g_memmove (text + at + gap_len, text + at, gap - at);
+      trash_area (text + at, MIN (gap_len, gap - at));
+    }
+  else if (at > gap)
+    {
+      gsize stale = MAX (gap + gap_len, at);
+
+      g_memmove (text + gap, text + gap + gap_len, at - gap);
+      trash_area (text + stale, at + gap_len - stale);
+    }
+
+  pv->normal_text_gap = at;
+  pv->normal_text_gap_chars = at_chars;
+}
+
+/* Converts the character offset @position into a logical byte offset,
+ * walking from the closest known offset: the start or the end of the
+ * text, the gap, or the last offset that was looked up.
+ */
+static gsize
+normal_text_offset_to_bytes (ClutterTextBufferPrivate *pv,
+                             guint                     position)
+{
+  guint anchor_chars, distance;
+  gsize anchor_bytes;
+
+  if (position >= pv->normal_text_chars)
+    return pv->normal_text_bytes;
+
+  anchor_chars = 0;
+  anchor_bytes = 0;
+  distance = position;
+
+#define CHECK_ANCHOR(c,b) G_STMT_START {                        \
+  guint d = (c) > position ? (c) - position : position - (c);   \
+  if (d < distance)                                             \
+    {                                                           \
+      anchor_chars = (c);                                       \
+      anchor_bytes = (b);                                       \
+      distance = d;                                             \
+    }                                                           \
+} G_STMT_END
+
+  CHECK_ANCHOR (pv->normal_text_chars, pv->normal_text_bytes);
+  CHECK_ANCHOR (pv->normal_text_gap_chars, pv->normal_text_gap);
+  CHECK_ANCHOR (pv->normal_text_cached_chars, pv->normal_text_cached_bytes);
+
+#undef CHECK_ANCHOR
+
+  while (anchor_chars < position)
+    {
+      anchor_bytes += g_utf8_skip[*(const guchar *) NORMAL_TEXT_AT (pv, anchor_bytes)];
+      anchor_chars += 1;
+    }
+
+  while (anchor_chars > position)
+    {
+      /* skip back over the continuation bytes */
+      do
+        anchor_bytes -= 1;
+      while ((*(const guchar *) NORMAL_TEXT_AT (pv, anchor_bytes) & 0xc0) == 0x80);
+
+      anchor_chars -= 1;
+    }
+
+  pv->normal_text_cached_chars = position;
+  pv->normal_text_cached_bytes = anchor_bytes;
+
+  return anchor_bytes;
+}
+
 static const gchar*
 clutter_text_buffer_normal_get_text (ClutterTextBuffer *buffer,
                                   gsize          *n_bytes)
 {
+  ClutterTextBufferPrivate *pv = buffer->priv;
+
   if (n_bytes)
-    *n_bytes = buffer->priv->normal_text_bytes;
-  if (!buffer->priv->normal_text)
+    *n_bytes = pv->normal_text_bytes;
+  if (!pv->normal_text)
       return "";
-  return buffer->priv->normal_text;
+
+  /* the gap is always followed by enough room for the terminator */
+  normal_text_move_gap (pv, pv->normal_text_bytes, pv->normal_text_chars);
+  pv->normal_text[pv->normal_text_bytes] = '\0';
+
+  return pv->normal_text;
 }
 
 static guint
@@ -125,6 +237,7 @@ clutter_text_buffer_normal_insert_text (ClutterTextBuffer *buffer,
   ClutterTextBufferPrivate *pv = buffer->priv;
   gsize prev_size;
   gsize n_bytes;
+  gsize gap_len;
   gsize at;
 
   n_bytes = g_utf8_offset_to_pointer (chars, n_chars) - chars;
@@ -159,23 +272,39 @@ clutter_text_buffer_normal_insert_text (ClutterTextBuffer *buffer,
             }
         }
 
-      /* Could be a password, so can't leave stuff in memory. */
+      /* Could be a password, so can't leave stuff in memory. The
+       * text after the gap is moved to the end of the new buffer,
+       * so that the gap takes all the new room.
+       */
       et_new = g_malloc (pv->normal_text_size);
-      memcpy (et_new, pv->normal_text, MIN (prev_size, pv->normal_text_size));
+      gap_len = pv->normal_text_size - pv->normal_text_bytes - 1;
+      if (pv->normal_text != NULL)
+        {
+          memcpy (et_new, pv->normal_text, pv->normal_text_gap);
+          memcpy (et_new + pv->normal_text_gap + gap_len,
+                  pv->normal_text + pv->normal_text_gap + pv->normal_text_gap_len,
+                  pv->normal_text_bytes - pv->normal_text_gap);
+        }
       trash_area (pv->normal_text, prev_size);
       g_free (pv->normal_text);
       pv->normal_text = et_new;
+      pv->normal_text_gap_len = gap_len;
     }
 
-  /* Actual text insertion */
-  at = g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
-  g_memmove (pv->normal_text + at + n_bytes, pv->normal_text + at, pv->normal_text_bytes - at);
+  /* Actual text insertion, at the gap */
+  at = normal_text_offset_to_bytes (pv, position);
+  normal_text_move_gap (pv, at, position);
   memcpy (pv->normal_text + at, chars, n_bytes);
 
   /* Book keeping */
+  pv->normal_text_gap += n_bytes;
+  pv->normal_text_gap_len -= n_bytes;
+  pv->normal_text_gap_chars += n_chars;
   pv->normal_text_bytes += n_bytes;
   pv->normal_text_chars += n_chars;
-  pv->normal_text[pv->normal_text_bytes] = '\0';
+
+  pv->normal_text_cached_chars = pv->normal_text_gap_chars;
+  pv->normal_text_cached_bytes = pv->normal_text_gap;
 
   clutter_text_buffer_emit_inserted_text (buffer, position, chars, n_chars);
   return n_chars;
@@ -196,19 +325,24 @@ clutter_text_buffer_normal_delete_text (ClutterTextBuffer *buffer,
 
   if (n_chars > 0)
     {
-      start = g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
-      end = g_utf8_offset_to_pointer (pv->normal_text, position + n_chars) - pv->normal_text;
+      start = normal_text_offset_to_bytes (pv, position);
+      end = normal_text_offset_to_bytes (pv, position + n_chars);
 
-      g_memmove (pv->normal_text + start, pv->normal_text + end, pv->normal_text_bytes + 1 - end);
-      pv->normal_text_chars -= n_chars;
-      pv->normal_text_bytes -= (end - start);
+      /* The deleted text becomes part of the gap */
+      normal_text_move_gap (pv, start, position);
 
       /*
-       * Could be a password, make sure we don't leave anything sensitive after
-       * the terminating zero.  Note, that the terminating zero already trashed
-       * one byte.
+       * Could be a password, make sure we don't leave anything sensitive
+       * inside the gap.
        */
-      trash_area (pv->normal_text + pv->normal_text_bytes + 1, end - start - 1);
+      trash_area (pv->normal_text + start + pv->normal_text_gap_len, end - start);
+
+      pv->normal_text_gap_len += (end - start);
+      pv->normal_text_chars -= n_chars;
+      pv->normal_text_bytes -= (end - start);
+
+      pv->normal_text_cached_chars = position;
+      pv->normal_text_cached_bytes = start;
 
       clutter_text_buffer_emit_deleted_text (buffer, position, n_chars);
     }
@@ -254,6 +388,11 @@ clutter_text_buffer_init (ClutterTextBuffer *buffer)
   pv->normal_text_chars = 0;
   pv->normal_text_bytes = 0;
   pv->normal_text_size = 0;
+  pv->normal_text_gap = 0;
+  pv->normal_text_gap_len = 0;
+  pv->normal_text_gap_chars = 0;
+  pv->normal_text_cached_chars = 0;
+  pv->normal_text_cached_bytes = 0;
 }
 
 static void
@@ -269,6 +408,8 @@ clutter_text_buffer_finalize (GObject *obj)
       pv->normal_text = NULL;
       pv->normal_text_bytes = pv->normal_text_size = 0;
       pv->normal_text_chars = 0;
+      pv->normal_text_gap = pv->normal_text_gap_len = 0;
+      pv->normal_text_gap_chars = 0;
     }
 
   G_OBJECT_CLASS (clutter_text_buffer_parent_class)->finalize (obj);
@@ -56,9 +56,13 @@
 #include "clutter-keysyms.h"
 #include "clutter-main.h"
 #include "clutter-marshal.h"
+#include "clutter-memory.h"
+#include "clutter-paint-node.h"
+#include "clutter-paint-nodes.h"
 #include "clutter-private.h"    /* includes <cogl-pango/cogl-pango.h> */
 #include "clutter-profile.h"
 #include "clutter-property-transition.h"
+#include "clutter-stage-private.h"
 #include "clutter-text-buffer.h"
 #include "clutter-units.h"
 #include "clutter-paint-volume-private.h"
@@ -70,6 +74,16 @@
 /* vertical padding for the cursor */
 #define CURSOR_Y_PADDING        2
 
+/* layouts with fewer lines are always painted as a whole, since
+ * CoglPango caches the geometry of the entire layout
+ */
+#define MIN_CULLED_LINES        32
+
+/* the time spent creating deferred layouts in each main loop
+ * iteration, in microseconds
+ */
+#define DEFERRED_LAYOUT_BUDGET  4000
+
 /* We need at least three cached layouts to run the allocation without
  * regenerating a new layout. First the layout will be generated at
  * full width to get the preferred width, then it will be generated at
@@ -79,12 +93,22 @@
  *
  * since we might get multiple queries from layout managers doing a
  * double-pass allocations, like tabular ones, we should use 6 slots
+ * by default; the size can be changed through the :layout-cache-size
+ * property
  */
 #define N_CACHED_LAYOUTS        6
 
+/* The number of shared layouts that are kept around after the last
+ * ClutterText using them released them
+ */
+#define N_UNUSED_SHARED_LAYOUTS 64
+
 #define CLUTTER_TEXT_GET_PRIVATE(obj)   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_TEXT, ClutterTextPrivate))
 
 typedef struct _LayoutCache     LayoutCache;
+typedef struct _SharedLayout    SharedLayout;
+typedef struct _TextParagraph   TextParagraph;
+typedef struct _TextLineExtents TextLineExtents;
 
 static const ClutterColor default_cursor_color    = {   0,   0,   0, 255 };
 static const ClutterColor default_selection_color = {   0,   0,   0, 255 };
@@ -107,18 +131,111 @@ G_DEFINE_TYPE_WITH_CODE (ClutterText,
 
 struct _LayoutCache
 {
+  /* The size and ellipsization the layout was created for, in Pango
+   * units; this is the key of the entry inside the cache
+   */
+  gint width;
+  gint height;
+  PangoEllipsizeMode ellipsize;
+
   /* Cached layout. Pango internally caches the computed extents
    * when they are requested so there is no need to cache that as
    * well
    */
   PangoLayout *layout;
 
-  /* A number representing the age of this cache (so that when a
-   * new layout is needed the last used cache is replaced)
+  /* If set, the layout is owned by the shared layouts cache */
+  SharedLayout *shared;
+
+  /* The link inside the list of cached layouts, which is kept
+   * sorted by last use, so that when a new layout is needed the
+   * least recently used cache is replaced
    */
-  guint age;
+  GList link;
+
+  /* The bytes accounted to CLUTTER_MEMORY_TEXT_LAYOUTS */
+  gsize accounted_size;
+};
+
+/* A layout shared among all the ClutterText actors that display the
+ * same text with the same font, attributes and layout parameters.
+ *
+ * Shared layouts are immutable; they are created by the first actor
+ * that needs them and released when the last actor stops using them.
+ */
+struct _SharedLayout
+{
+  PangoContext *context;
+  gchar *text;
+  PangoFontDescription *font_desc;
+  PangoAttrList *attrs;
+
+  gint width;
+  gint height;
+
+  guint ellipsize        : 3;
+  guint alignment        : 2;
+  guint wrap_mode        : 3;
+  guint justify          : 1;
+  guint single_line_mode : 1;
+
+  guint hash;
+
+  PangoLayout *layout;
+
+  /* the number of LayoutCache entries using the layout */
+  guint ref_count;
+
+  /* whether the layout is still inside the shared_layouts table */
+  guint is_cached : 1;
+
+  /* the link inside the unused_shared_layouts queue, once the
+   * reference count drops to zero
+   */
+  GList unused_link;
+};
+
+/* The size of a paragraph of an editable ClutterText, measured on its own */
+struct _TextParagraph
+{
+  gchar *text;
+  gint length;
+
+  /* the extents of the paragraph without a width, in Pango units */
+  gint natural_width;
+  gint natural_height;
+
+  /* the height of the paragraph for the last width it was wrapped at */
+  gint wrap_width;
+  gint wrap_height;
+
+  guint is_measured : 1;
+};
+
+/* The position of a line inside a PangoLayout, in Pango units */
+struct _TextLineExtents
+{
+  PangoLayoutLine *line;
+
+  gint x;
+  gint y1;
+  gint y2;
+  gint baseline;
 };
 
+/* SharedLayout → SharedLayout */
+static GHashTable *shared_layouts = NULL;
+static GQueue unused_shared_layouts = G_QUEUE_INIT;
+
+/* A single handler of the ClutterBackend::settings-changed signal is
+ * shared by all the ClutterText actors: every change bumps the
+ * generation, and only the mapped actors are updated right away; the
+ * others are updated the next time they are mapped or measured
+ */
+static gulong text_settings_changed_id = 0;
+static guint text_settings_generation = 0;
+static GHashTable *mapped_texts = NULL;
+
 struct _ClutterTextPrivate
 {
   PangoFontDescription *font_desc;
@@ -132,14 +249,30 @@ struct _ClutterTextPrivate
 
   ClutterColor text_color;
 
-  LayoutCache cached_layouts[N_CACHED_LAYOUTS];
-  guint cache_age;
+  /* LayoutCache → LayoutCache; the entries are owned by the
+   * cached_layouts_lru queue, most recently used first
+   */
+  GHashTable *cached_layouts;
+  GQueue cached_layouts_lru;
+  guint layout_cache_size;
+
+  /* The paragraphs of multi-paragraph editable text, measured on their
+   * own so that editing a paragraph does not require shaping the whole
+   * text just to compute the preferred size; the font description and
+   * wrap mode are the ones used for the measurements
+   */
+  GArray *paragraphs;
+  PangoFontDescription *paragraphs_font_desc;
+  PangoWrapMode paragraphs_wrap_mode;
 
   /* These are the attributes set by the attributes property */
   PangoAttrList *attrs;
   /* These are the attributes derived from the text when the
      use-markup property is set */
   PangoAttrList *markup_attrs;
+  /* The markup string that markup_attrs was parsed from; it is reset
+     whenever the contents of the buffer change behind its back */
+  gchar *markup_source;
   /* This is the combination of the above two lists. It is set to NULL
      whenever either of them changes and then regenerated by merging
      the two lists whenever a layout is needed */
@@ -188,11 +321,20 @@ struct _ClutterTextPrivate
 
   gunichar password_char;
 
+  /* The contents of the buffer with every character replaced by
+     password_char, updated incrementally by the buffer signal
+     handlers; the hint string is only used while the last character
+     is shown in clear */
+  GString *password_text;
+  GString *password_hint_text;
+
   guint password_hint_id;
   guint password_hint_timeout;
 
-  /* Signal handler for when the backend changes its font settings */
-  guint settings_changed_id;
+  /* The value of text_settings_generation when the settings were
+   * last applied to the actor
+   */
+  guint settings_generation;
 
   /* Signal handler for when the :text-direction changes */
   guint direction_changed_id;
@@ -221,6 +363,10 @@ struct _ClutterTextPrivate
   guint paint_volume_valid      : 1;
   guint show_password_hint      : 1;
   guint password_hint_visible   : 1;
+  guint reuse_layouts           : 1;
+  guint deferred_layout         : 1;
+  guint layout_pending          : 1;
+  guint painted_by_node         : 1;
 };
 
 enum
@@ -255,6 +401,9 @@ enum
   PROP_SINGLE_LINE_MODE,
   PROP_SELECTED_TEXT_COLOR,
   PROP_SELECTED_TEXT_COLOR_SET,
+  PROP_LAYOUT_CACHE_SIZE,
+  PROP_REUSE_LAYOUTS,
+  PROP_DEFERRED_LAYOUT,
 
   PROP_LAST
 };
@@ -274,10 +423,20 @@ enum
 
 static guint text_signals[LAST_SIGNAL] = { 0, };
 
+/* the key bindings of ClutterText; see clutter_text_key_press() */
+static ClutterBindingPool *text_binding_pool = NULL;
+
 static void clutter_text_settings_changed_cb (ClutterText *text);
+static void clutter_text_clear_paragraphs (ClutterText *text);
+static void clutter_text_queue_deferred_layout (ClutterText *text);
 static void buffer_connect_signals (ClutterText *self);
 static void buffer_disconnect_signals (ClutterText *self);
 static ClutterTextBuffer *get_buffer (ClutterText *self);
+static PangoLayout *clutter_text_get_paint_layout (ClutterText           *text,
+                                                   const ClutterActorBox *alloc);
+static gint clutter_text_compute_scroll_offset (ClutterText           *text,
+                                                PangoLayout           *layout,
+                                                const ClutterActorBox *alloc);
 
 static inline void
 clutter_text_dirty_paint_volume (ClutterText *text)
@@ -343,12 +502,58 @@ clutter_text_clear_selection (ClutterText *self)
     }
 }
 
-static gchar *
+static void
+clutter_text_fill_password_text (ClutterText *self,
+                                 gsize        pos,
+                                 guint        n_chars)
+{
+  ClutterTextPrivate *priv = self->priv;
+  gchar buf[7];
+  gint char_len;
+  gchar *dest;
+  guint i;
+
+  char_len = g_unichar_to_utf8 (priv->password_char, buf);
+
+  /* make room for the new characters, and then copy the UTF-8
+   * encoding of the invisible character in place
+   */
+  g_string_set_size (priv->password_text,
+                     priv->password_text->len + n_chars * char_len);
+
+  dest = priv->password_text->str + pos;
+  memmove (dest + n_chars * char_len, dest,
+           priv->password_text->len - pos - n_chars * char_len);
+
+  for (i = 0; i < n_chars; i++, dest += char_len)
+    memcpy (dest, buf, char_len);
+}
+
+static void
+clutter_text_clear_password_text (ClutterText *self)
+{
+  ClutterTextPrivate *priv = self->priv;
+
+  if (priv->password_text != NULL)
+    {
+      g_string_free (priv->password_text, TRUE);
+      priv->password_text = NULL;
+    }
+}
+
+/* Returns the string that should be given to the layout: either the
+ * contents of the buffer or, in password mode, the masked string. The
+ * returned string is owned by the actor or the buffer, and it is only
+ * valid until the next change of the contents
+ */
+static const gchar *
 clutter_text_get_display_text (ClutterText *self)
 {
   ClutterTextPrivate *priv = self->priv;
   ClutterTextBuffer *buffer;
   const gchar *text;
+  guint n_chars;
+  gint char_len;
 
   buffer = get_buffer (self);
   text = clutter_text_buffer_get_text (buffer);
@@ -357,47 +562,48 @@ clutter_text_get_display_text (ClutterText *self)
    * with an empty text and a password char set
    */
   if (text[0] == '\0')
-    return g_strdup ("");
+    return "";
 
   if (G_LIKELY (priv->password_char == 0))
-    return g_strdup (text);
-  else
-    {
-      GString *str;
-      gunichar invisible_char;
-      gchar buf[7];
-      gint char_len, i;
-      guint n_chars;
+    return text;
 
-      n_chars = clutter_text_buffer_get_length (buffer);
-      str = g_string_sized_new (clutter_text_buffer_get_bytes (buffer));
-      invisible_char = priv->password_char;
+  n_chars = clutter_text_buffer_get_length (buffer);
+  char_len = g_unichar_to_utf8 (priv->password_char, NULL);
 
-      /* we need to convert the string built of invisible
-       * characters into UTF-8 for it to be fed to the Pango
-       * layout
-       */
-      memset (buf, 0, sizeof (buf));
-      char_len = g_unichar_to_utf8 (invisible_char, buf);
+  /* the masked string is normally kept in sync by the handlers of
+   * the buffer signals; if it went out of sync, e.g. because of a
+   * handler running before ours, then we simply build it again
+   */
+  if (priv->password_text != NULL &&
+      priv->password_text->len != (gsize) n_chars * char_len)
+    clutter_text_clear_password_text (self);
 
-      if (priv->show_password_hint && priv->password_hint_visible)
-        {
-          char *last_char;
+  if (priv->password_text == NULL)
+    {
+      priv->password_text = g_string_sized_new (n_chars * char_len);
+      clutter_text_fill_password_text (self, 0, n_chars);
+    }
 
-          for (i = 0; i < n_chars - 1; i++)
-            g_string_append_len (str, buf, char_len);
+  if (priv->show_password_hint && priv->password_hint_visible)
+    {
+      gsize n_bytes = clutter_text_buffer_get_bytes (buffer);
+      const gchar *last_char;
 
-          last_char = g_utf8_offset_to_pointer (text, n_chars - 1);
-          g_string_append (str, last_char);
-        }
-      else
-        {
-          for (i = 0; i < n_chars; i++)
-            g_string_append_len (str, buf, char_len);
-        }
+      last_char = g_utf8_find_prev_char (text, text + n_bytes);
 
-      return g_string_free (str, FALSE);
+      if (priv->password_hint_text == NULL)
+        priv->password_hint_text = g_string_sized_new (priv->password_text->len);
+
+      g_string_truncate (priv->password_hint_text, 0);
+      g_string_append_len (priv->password_hint_text,
+                           priv->password_text->str,
+                           (n_chars - 1) * char_len);
+      g_string_append (priv->password_hint_text, last_char);
+
+      return priv->password_hint_text->str;
     }
+
+  return priv->password_text->str;
 }
 
 static inline void
@@ -463,7 +669,7 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
 {
   ClutterTextPrivate *priv = text->priv;
   PangoLayout *layout;
-  gchar *contents;
+  const gchar *contents;
   gsize contents_len;
 
   CLUTTER_STATIC_TIMER (text_layout_timer,
@@ -526,27 +732,356 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
   pango_layout_set_width (layout, width);
   pango_layout_set_height (layout, height);
 
-  g_free (contents);
-
   CLUTTER_TIMER_STOP (_clutter_uprof_context, text_layout_timer);
 
   return layout;
 }
 
+static guint
+shared_layout_hash (gconstpointer key)
+{
+  const SharedLayout *shared = key;
+
+  return shared->hash;
+}
+
+static gint
+attribute_compare (gconstpointer a,
+                   gconstpointer b)
+{
+  return pango_attribute_equal (a, b) ? 0 : 1;
+}
+
+static gboolean
+attr_list_equal (PangoAttrList *a,
+                 PangoAttrList *b)
+{
+  PangoAttrIterator *iter_a, *iter_b;
+  gboolean retval = TRUE;
+
+  if (a == b)
+    return TRUE;
+
+  if (a == NULL || b == NULL)
+    return FALSE;
+
+  iter_a = pango_attr_list_get_iterator (a);
+  iter_b = pango_attr_list_get_iterator (b);
+
+  while (retval)
+    {
+      GSList *attrs_a, *attrs_b, *l;
+      gint start_a, end_a, start_b, end_b;
+      gboolean next_a, next_b;
+
+      pango_attr_iterator_range (iter_a, &start_a, &end_a);
+      pango_attr_iterator_range (iter_b, &start_b, &end_b);
+
+      if (start_a != start_b || end_a != end_b)
+        {
+          retval = FALSE;
+          break;
+        }
+
+      attrs_a = pango_attr_iterator_get_attrs (iter_a);
+      attrs_b = pango_attr_iterator_get_attrs (iter_b);
+
+      if (g_slist_length (attrs_a) != g_slist_length (attrs_b))
+        retval = FALSE;
+
+      for (l = attrs_a; retval && l != NULL; l = l->next)
+        {
+          if (g_slist_find_custom (attrs_b, l->data, attribute_compare) == NULL)
+            retval = FALSE;
+        }
+
+      g_slist_free_full (attrs_a, (GDestroyNotify) pango_attribute_destroy);
+      g_slist_free_full (attrs_b, (GDestroyNotify) pango_attribute_destroy);
+
+      next_a = pango_attr_iterator_next (iter_a);
+      next_b = pango_attr_iterator_next (iter_b);
+
+      if (next_a != next_b)
+        retval = FALSE;
+
+      if (!next_a)
+        break;
+    }
+
+  pango_attr_iterator_destroy (iter_a);
+  pango_attr_iterator_destroy (iter_b);
+
+  return retval;
+}
+
+static gboolean
+shared_layout_equal (gconstpointer a,
+                     gconstpointer b)
+{
+  const SharedLayout *shared_a = a;
+  const SharedLayout *shared_b = b;
+
+  return shared_a->hash == shared_b->hash &&
+         shared_a->context == shared_b->context &&
+         shared_a->width == shared_b->width &&
+         shared_a->height == shared_b->height &&
+         shared_a->ellipsize == shared_b->ellipsize &&
+         shared_a->alignment == shared_b->alignment &&
+         shared_a->wrap_mode == shared_b->wrap_mode &&
+         shared_a->justify == shared_b->justify &&
+         shared_a->single_line_mode == shared_b->single_line_mode &&
+         strcmp (shared_a->text, shared_b->text) == 0 &&
+         pango_font_description_equal (shared_a->font_desc, shared_b->font_desc) &&
+         attr_list_equal (shared_a->attrs, shared_b->attrs);
+}
+
+static void
+shared_layout_free (SharedLayout *shared)
+{
+  g_object_unref (shared->layout);
+  g_object_unref (shared->context);
+  g_free (shared->text);
+  pango_font_description_free (shared->font_desc);
+
+  if (shared->attrs != NULL)
+    pango_attr_list_unref (shared->attrs);
+
+  g_slice_free (SharedLayout, shared);
+}
+
+static void
+shared_layouts_trim_unused (guint max_unused)
+{
+  while (unused_shared_layouts.length > max_unused)
+    {
+      SharedLayout *shared = unused_shared_layouts.tail->data;
+
+      g_queue_unlink (&unused_shared_layouts, &shared->unused_link);
+      g_hash_table_remove (shared_layouts, shared);
+      shared_layout_free (shared);
+    }
+}
+
+static void
+shared_layout_unref (SharedLayout *shared)
+{
+  if (--shared->ref_count > 0)
+    return;
+
+  if (!shared->is_cached)
+    {
+      shared_layout_free (shared);
+      return;
+    }
+
+  /* keep the most recently released layouts around, in case another
+   * actor needs them soon, like when recycling actors in a list
+   */
+  g_queue_push_head_link (&unused_shared_layouts, &shared->unused_link);
+  shared_layouts_trim_unused (N_UNUSED_SHARED_LAYOUTS);
+}
+
+static gboolean
+shared_layout_uncache (gpointer key,
+                       gpointer value,
+                       gpointer data)
+{
+  SharedLayout *shared = value;
+
+  if (shared->ref_count == 0)
+    {
+      g_queue_unlink (&unused_shared_layouts, &shared->unused_link);
+      shared_layout_free (shared);
+    }
+  else
+    shared->is_cached = FALSE;
+
+  return TRUE;
+}
+
+/*
+ * shared_layouts_invalidate:
+ *
+ * Drops all the layouts from the shared cache; the layouts that are
+ * still in use will be freed once the last actor releases them.
+ */
+static void
+shared_layouts_invalidate (void)
+{
+  if (shared_layouts == NULL)
+    return;
+
+  g_hash_table_foreach_steal (shared_layouts, shared_layout_uncache, NULL);
+}
+
+/*
+ * clutter_text_can_share_layouts:
+ * @text: a #ClutterText
+ *
+ * Checks whether the layouts of @text can be shared with other
+ * #ClutterText actors; editable actors keep their own layouts, as
+ * they change with every key press and include the pre-edit string.
+ *
+ * The selection and the cursor are painted on top of the layout, so
+ * they do not prevent sharing it.
+ */
+static inline gboolean
+clutter_text_can_share_layouts (ClutterText *text)
+{
+  return !text->priv->editable;
+}
+
+static SharedLayout *
+shared_layout_acquire (ClutterText        *text,
+                       gint                width,
+                       gint                height,
+                       PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = text->priv;
+  SharedLayout key, *shared;
+
+  if (G_UNLIKELY (shared_layouts == NULL))
+    shared_layouts = g_hash_table_new (shared_layout_hash, shared_layout_equal);
+
+  clutter_text_ensure_effective_attributes (text);
+
+  key.context = clutter_actor_get_pango_context (CLUTTER_ACTOR (text));
+  key.text = (gchar *) clutter_text_get_display_text (text);
+  key.font_desc = priv->font_desc;
+  key.attrs = priv->effective_attrs;
+  key.width = width;
+  key.height = height;
+  key.ellipsize = ellipsize;
+  key.alignment = priv->alignment;
+  key.wrap_mode = priv->wrap_mode;
+  key.justify = priv->justify;
+  key.single_line_mode = priv->single_line_mode;
+
+  /* the attributes are only compared for equality */
+  key.hash = g_str_hash (key.text)
+           ^ pango_font_description_hash (key.font_desc)
+           ^ ((guint) width * 31 + (guint) height * 7 + ellipsize);
+
+  shared = g_hash_table_lookup (shared_layouts, &key);
+  if (shared != NULL)
+    {
+      if (shared->ref_count++ == 0)
+        g_queue_unlink (&unused_shared_layouts, &shared->unused_link);
+
+      return shared;
+    }
+
+  shared = g_slice_new0 (SharedLayout);
+  *shared = key;
+  shared->text = g_strdup (key.text);
+  shared->context = g_object_ref (key.context);
+  shared->font_desc = pango_font_description_copy (key.font_desc);
+
+  /* the attribute list is copied, as it can be changed by the
+   * application after being set on the actor
+   */
+  if (key.attrs != NULL)
+    shared->attrs = pango_attr_list_copy (key.attrs);
+
+  shared->layout =
+    clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+
+  cogl_pango_ensure_glyph_cache_for_layout (shared->layout);
+
+  shared->ref_count = 1;
+  shared->is_cached = TRUE;
+  shared->unused_link.data = shared;
+
+  g_hash_table_insert (shared_layouts, shared, shared);
+
+  return shared;
+}
+
+static guint
+layout_cache_hash (gconstpointer key)
+{
+  const LayoutCache *cache = key;
+
+  return (guint) cache->width * 31 + (guint) cache->height * 7 + cache->ellipsize;
+}
+
+static gboolean
+layout_cache_equal (gconstpointer a,
+                    gconstpointer b)
+{
+  const LayoutCache *cache_a = a;
+  const LayoutCache *cache_b = b;
+
+  return cache_a->width == cache_b->width &&
+         cache_a->height == cache_b->height &&
+         cache_a->ellipsize == cache_b->ellipsize;
+}
+
+static void
+layout_cache_remove (ClutterText *text,
+                     LayoutCache *cache)
+{
+  ClutterTextPrivate *priv = text->priv;
+
+  g_hash_table_remove (priv->cached_layouts, cache);
+  g_queue_unlink (&priv->cached_layouts_lru, &cache->link);
+
+  if (cache->shared != NULL)
+    shared_layout_unref (cache->shared);
+  else
+    g_object_unref (cache->layout);
+
+  _clutter_memory_account (CLUTTER_MEMORY_TEXT_LAYOUTS,
+                           -(gssize) cache->accounted_size,
+                           -1);
+
+  g_slice_free (LayoutCache, cache);
+}
+
+static void
+layout_cache_trim (ClutterText *text,
+                   guint        max_size)
+{
+  ClutterTextPrivate *priv = text->priv;
+
+  while (priv->cached_layouts_lru.length > max_size)
+    layout_cache_remove (text, priv->cached_layouts_lru.tail->data);
+}
+
+static void
+clutter_text_purge_caches (gpointer          instance,
+                           ClutterPurgeLevel level)
+{
+  ClutterText *text = instance;
+
+  /* the most recently used layout is the one being painted, so it is
+   * only released if the actor will not be painted soon
+   */
+  if (level >= CLUTTER_PURGE_LEVEL_CRITICAL ||
+      (level >= CLUTTER_PURGE_LEVEL_MODERATE &&
+       !CLUTTER_ACTOR_IS_MAPPED (text)))
+    layout_cache_trim (text, 0);
+  else
+    layout_cache_trim (text, 1);
+}
+
 static void
 clutter_text_dirty_cache (ClutterText *text)
 {
   ClutterTextPrivate *priv = text->priv;
-  int i;
+
+  /* Keep using the current layouts until the new ones have been
+     created, if the layout is deferred */
+  if (priv->deferred_layout && !priv->editable &&
+      priv->cached_layouts_lru.length > 0)
+    {
+      clutter_text_queue_deferred_layout (text);
+      return;
+    }
 
   /* Delete the cached layouts so they will be recreated the next time
      they are needed */
-  for (i = 0; i < N_CACHED_LAYOUTS; i++)
-    if (priv->cached_layouts[i].layout)
-      {
-	g_object_unref (priv->cached_layouts[i].layout);
-	priv->cached_layouts[i].layout = NULL;
-      }
+  layout_cache_trim (text, 0);
 
   clutter_text_dirty_paint_volume (text);
 }
@@ -589,18 +1124,31 @@ clutter_text_set_font_description_internal (ClutterText          *self,
   clutter_text_dirty_cache (self);
 
   if (clutter_text_buffer_get_length (get_buffer (self)) != 0)
-    clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+    _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (self));
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_FONT_DESCRIPTION]);
 }
 
+/*
+ * clutter_text_ensure_settings:
+ * @text: a #ClutterText
+ *
+ * Applies the font and password hint settings to @text, if they
+ * changed since the last time they were applied, and queues a
+ * relayout.
+ */
 static void
-clutter_text_settings_changed_cb (ClutterText *text)
+clutter_text_ensure_settings (ClutterText *text)
 {
   ClutterTextPrivate *priv = text->priv;
   guint password_hint_time = 0;
   ClutterSettings *settings;
 
+  if (priv->settings_generation == text_settings_generation)
+    return;
+
+  priv->settings_generation = text_settings_generation;
+
   settings = clutter_settings_get_default ();
 
   g_object_get (settings, "password-hint-time", &password_hint_time, NULL);
@@ -626,8 +1174,29 @@ clutter_text_settings_changed_cb (ClutterText *text)
       g_free (font_name);
     }
 
+  clutter_text_clear_paragraphs (text);
+
   clutter_text_dirty_cache (text);
-  clutter_actor_queue_relayout (CLUTTER_ACTOR (text));
+  _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (text));
+}
+
+static void
+clutter_text_settings_changed_cb (ClutterBackend *backend)
+{
+  GHashTableIter iter;
+  gpointer key;
+
+  text_settings_generation += 1;
+
+  /* the font settings affect all the shared layouts */
+  shared_layouts_invalidate ();
+
+  if (mapped_texts == NULL)
+    return;
+
+  g_hash_table_iter_init (&iter, mapped_texts);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    clutter_text_ensure_settings (key);
 }
 
 static void
@@ -635,10 +1204,94 @@ clutter_text_direction_changed_cb (GObject    *gobject,
                                    GParamSpec *pspec)
 {
   clutter_text_dirty_cache (CLUTTER_TEXT (gobject));
+  clutter_text_clear_paragraphs (CLUTTER_TEXT (gobject));
 
   /* no need to queue a relayout: set_text_direction() will do that for us */
 }
 
+static PangoLayout *layout_cache_insert (ClutterText        *text,
+                                         gint                width,
+                                         gint                height,
+                                         PangoEllipsizeMode  ellipsize);
+
+static inline PangoLayout *
+layout_cache_use (ClutterText *text,
+                  LayoutCache *cache)
+{
+  ClutterTextPrivate *priv = text->priv;
+
+  /* move the entry to the front of the queue */
+  if (priv->cached_layouts_lru.head != &cache->link)
+    {
+      g_queue_unlink (&priv->cached_layouts_lru, &cache->link);
+      g_queue_push_head_link (&priv->cached_layouts_lru, &cache->link);
+    }
+
+  return cache->layout;
+}
+
+/*< private >
+ * layout_cache_can_reuse:
+ * @text: a #ClutterText
+ * @cache: a cached layout
+ * @width: the requested width, in Pango units
+ * @height: the requested height, in Pango units
+ *
+ * Checks whether the layout inside @cache breaks its lines exactly
+ * like a layout created for @width would.
+ *
+ * Pango breaks lines greedily, so if every line of the cached layout
+ * fits inside @width, and @width is not larger than the width of the
+ * cached layout, the lines will be the same; the same is true for any
+ * width larger than the cached layout if no line was wrapped.
+ *
+ * Since the width of a layout also defines its alignment, the layout
+ * can only be reused if all its lines are aligned to the left edge.
+ *
+ * Return value: %TRUE if the cached layout can be used instead
+ */
+static gboolean
+layout_cache_can_reuse (ClutterText *text,
+                        LayoutCache *cache,
+                        gint         width,
+                        gint         height)
+{
+  ClutterTextPrivate *priv = text->priv;
+  PangoRectangle logical_rect;
+  GSList *l;
+
+  /* ellipsization and height both depend on the exact size */
+  if (width < 0 || height >= 0 || cache->height >= 0)
+    return FALSE;
+
+  if (cache->ellipsize != PANGO_ELLIPSIZE_NONE)
+    return FALSE;
+
+  if (priv->alignment != PANGO_ALIGN_LEFT || priv->justify)
+    return FALSE;
+
+  if (cache->width >= 0 && cache->width < width &&
+      pango_layout_is_wrapped (cache->layout))
+    return FALSE;
+
+  pango_layout_get_extents (cache->layout, NULL, &logical_rect);
+  if (logical_rect.x + logical_rect.width > width)
+    return FALSE;
+
+  /* right-to-left paragraphs swap the alignment */
+  for (l = pango_layout_get_lines_readonly (cache->layout);
+       l != NULL;
+       l = l->next)
+    {
+      PangoLayoutLine *line = l->data;
+
+      if (line->resolved_dir != PANGO_DIRECTION_LTR)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 /*
  * clutter_text_create_layout:
  * @text: a #ClutterText
@@ -656,12 +1309,15 @@ clutter_text_create_layout (ClutterText *text,
                             gfloat       allocation_height)
 {
   ClutterTextPrivate *priv = text->priv;
-  LayoutCache *oldest_cache = priv->cached_layouts;
-  gboolean found_free_cache = FALSE;
+  LayoutCache *cache;
+  LayoutCache key;
   gint width = -1;
   gint height = -1;
   PangoEllipsizeMode ellipsize = PANGO_ELLIPSIZE_NONE;
-  int i;
+  GList *l;
+
+  /* unmapped actors are only updated when they are measured */
+  clutter_text_ensure_settings (text);
 
   CLUTTER_STATIC_COUNTER (text_cache_hit_counter,
                           "Text layout cache hit counter",
@@ -735,106 +1391,495 @@ clutter_text_create_layout (ClutterText *text,
       height = allocation_height * 1024 + 0.5f;
     }
 
-  /* Search for a cached layout with the same width and keep
-   * track of the oldest one
+  /* Look for a cached layout with the same size first */
+  key.width = width;
+  key.height = height;
+  key.ellipsize = ellipsize;
+
+  cache = g_hash_table_lookup (priv->cached_layouts, &key);
+  if (cache != NULL)
+    {
+      /* If this cached layout is using the same size then we can
+       * just return that directly
+       */
+      CLUTTER_NOTE (ACTOR,
+                    "ClutterText: %p: cache hit for size %.2fx%.2f",
+                    text,
+                    allocation_width,
+                    allocation_height);
+
+      CLUTTER_COUNTER_INC (_clutter_uprof_context, text_cache_hit_counter);
+
+      return layout_cache_use (text, cache);
+    }
+
+  for (l = priv->cached_layouts_lru.head; l != NULL; l = l->next)
+    {
+      cache = l->data;
+
+      if (cache->ellipsize != ellipsize)
+        continue;
+
+      /* When getting the preferred height for a specific width,
+       * we might be able to reuse the layout from getting the
+       * preferred width. If the width that the layout gives
+       * unconstrained is less than the width that we are using
+       * than the height will be unaffected by that width.
+       */
+      if (allocation_height < 0 && cache->width == -1)
+        {
+          PangoRectangle logical_rect;
+
+          pango_layout_get_extents (cache->layout, NULL, &logical_rect);
+
+          if (logical_rect.width <= width)
+            {
+              /* We've been asked for our height for the width we gave as a result
+               * of a _get_preferred_width call
+               */
+              CLUTTER_NOTE (ACTOR,
+                            "ClutterText: %p: cache hit for size %.2fx%.2f "
+                            "(unwrapped width narrower than given width)",
+                            text,
+                            allocation_width,
+                            allocation_height);
+
+              CLUTTER_COUNTER_INC (_clutter_uprof_context,
+                                   text_cache_hit_counter);
+
+              return layout_cache_use (text, cache);
+            }
+        }
+
+      if (priv->reuse_layouts &&
+          layout_cache_can_reuse (text, cache, width, height))
+        {
+          CLUTTER_NOTE (ACTOR,
+                        "ClutterText: %p: cache hit for size %.2fx%.2f "
+                        "(same lines at width %.2f)",
+                        text,
+                        allocation_width,
+                        allocation_height,
+                        cache->width / 1024.0f);
+
+          CLUTTER_COUNTER_INC (_clutter_uprof_context,
+                               text_cache_hit_counter);
+
+          return layout_cache_use (text, cache);
+        }
+    }
+
+  CLUTTER_NOTE (ACTOR, "ClutterText: %p: cache miss for size %.2fx%.2f",
+		text,
+                allocation_width,
+                allocation_height);
+
+  CLUTTER_COUNTER_INC (_clutter_uprof_context, text_cache_miss_counter);
+
+  /* If we make it here then we didn't have a cached version so we
+     need to recreate the layout */
+  return layout_cache_insert (text, width, height, ellipsize);
+}
+
+static PangoLayout *
+layout_cache_insert (ClutterText        *text,
+                     gint                width,
+                     gint                height,
+                     PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = text->priv;
+  LayoutCache *cache;
+
+  /* make room for the new layout in the cache */
+  layout_cache_trim (text, MAX (priv->layout_cache_size, 1) - 1);
+
+  cache = g_slice_new0 (LayoutCache);
+  cache->width = width;
+  cache->height = height;
+  cache->ellipsize = ellipsize;
+  cache->link.data = cache;
+
+  if (clutter_text_can_share_layouts (text))
+    {
+      cache->shared = shared_layout_acquire (text, width, height, ellipsize);
+      cache->layout = cache->shared->layout;
+    }
+  else
+    {
+      cache->layout =
+        clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+
+      cogl_pango_ensure_glyph_cache_for_layout (cache->layout);
+    }
+
+  g_hash_table_insert (priv->cached_layouts, cache, cache);
+  g_queue_push_head_link (&priv->cached_layouts_lru, &cache->link);
+
+  /* Pango does not expose the size of a layout, so only the entry and
+   * the text it holds are accounted
+   */
+  cache->accounted_size = sizeof (LayoutCache)
+                        + strlen (pango_layout_get_text (cache->layout));
+  _clutter_memory_account (CLUTTER_MEMORY_TEXT_LAYOUTS,
+                           cache->accounted_size,
+                           1);
+
+  return cache->layout;
+}
+
+/* ClutterText actors whose layouts have to be created again */
+static GQueue deferred_layouts = G_QUEUE_INIT;
+static guint deferred_layouts_id = 0;
+
+/*
+ * clutter_text_commit_deferred_layout:
+ * @text: a #ClutterText
+ *
+ * Replaces the layouts of @text with new ones, created for the same
+ * sizes, and queues a relayout to let the new contents take effect.
+ */
+static void
+clutter_text_commit_deferred_layout (ClutterText *text)
+{
+  ClutterTextPrivate *priv = text->priv;
+  LayoutCache *keys;
+  guint i, n_keys;
+  GList *l;
+
+  priv->layout_pending = FALSE;
+
+  /* the layouts are created again from the least recently used,
+   * so that the order of the cache is preserved
+   */
+  n_keys = priv->cached_layouts_lru.length;
+  keys = g_newa (LayoutCache, n_keys);
+  for (l = priv->cached_layouts_lru.tail, i = 0; l != NULL; l = l->prev, i++)
+    keys[i] = *((LayoutCache *) l->data);
+
+  layout_cache_trim (text, 0);
+  clutter_text_dirty_paint_volume (text);
+
+  for (i = 0; i < n_keys; i++)
+    layout_cache_insert (text, keys[i].width, keys[i].height, keys[i].ellipsize);
+
+  _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (text));
+}
+
+static gboolean
+clutter_text_deferred_layouts_idle (gpointer data G_GNUC_UNUSED)
+{
+  gint64 deadline;
+
+  deadline = g_get_monotonic_time () + DEFERRED_LAYOUT_BUDGET;
+
+  /* commit as many layouts as it's possible without stalling the
+   * frames; at least one layout is committed in each iteration
+   */
+  do
+    {
+      ClutterText *text = g_queue_pop_head (&deferred_layouts);
+
+      if (text->priv->layout_pending)
+        clutter_text_commit_deferred_layout (text);
+
+      g_object_unref (text);
+    }
+  while (!g_queue_is_empty (&deferred_layouts) &&
+         g_get_monotonic_time () < deadline);
+
+  if (!g_queue_is_empty (&deferred_layouts))
+    return G_SOURCE_CONTINUE;
+
+  deferred_layouts_id = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+clutter_text_queue_deferred_layout (ClutterText *text)
+{
+  ClutterTextPrivate *priv = text->priv;
+
+  if (priv->layout_pending)
+    return;
+
+  priv->layout_pending = TRUE;
+  g_queue_push_tail (&deferred_layouts, g_object_ref (text));
+
+  /* the layouts are created after the frames have been painted */
+  if (deferred_layouts_id == 0)
+    deferred_layouts_id =
+      clutter_threads_add_idle_full (CLUTTER_PRIORITY_REDRAW + 10,
+                                     clutter_text_deferred_layouts_idle,
+                                     NULL,
+                                     NULL);
+}
+
+static void
+clutter_text_clear_paragraphs (ClutterText *text)
+{
+  ClutterTextPrivate *priv = text->priv;
+  guint i;
+
+  if (priv->paragraphs == NULL)
+    return;
+
+  for (i = 0; i < priv->paragraphs->len; i++)
+    g_free (g_array_index (priv->paragraphs, TextParagraph, i).text);
+
+  g_array_free (priv->paragraphs, TRUE);
+  priv->paragraphs = NULL;
+
+  if (priv->paragraphs_font_desc != NULL)
+    {
+      pango_font_description_free (priv->paragraphs_font_desc);
+      priv->paragraphs_font_desc = NULL;
+    }
+}
+
+static inline gboolean
+text_paragraph_matches (const TextParagraph *paragraph,
+                        const gchar         *text,
+                        gint                 length)
+{
+  return paragraph->length == length &&
+         memcmp (paragraph->text, text, length) == 0;
+}
+
+/*
+ * clutter_text_update_paragraphs:
+ * @text: a #ClutterText
+ *
+ * Splits the contents of @text into paragraphs, keeping the sizes of
+ * the paragraphs that did not change since the last time.
+ *
+ * Only editable text with more than one paragraph, and without any
+ * attribute, ellipsization or pre-edit string, is split; in every other
+ * case the whole layout is used to compute the preferred size.
+ *
+ * Return value: %TRUE if the paragraphs can be used
+ */
+static gboolean
+clutter_text_update_paragraphs (ClutterText *text)
+{
+  ClutterTextPrivate *priv = text->priv;
+  GArray *old_paragraphs, *paragraphs;
+  const gchar *contents, *p;
+  guint n_old, n_prefix, n_suffix, i;
+
+  clutter_text_ensure_effective_attributes (text);
+
+  if (!priv->editable ||
+      priv->single_line_mode ||
+      priv->preedit_set ||
+      priv->password_char != 0 ||
+      priv->ellipsize != PANGO_ELLIPSIZE_NONE ||
+      priv->effective_attrs != NULL)
+    {
+      clutter_text_clear_paragraphs (text);
+      return FALSE;
+    }
+
+  if (priv->paragraphs != NULL &&
+      (priv->paragraphs_wrap_mode != priv->wrap_mode ||
+       !pango_font_description_equal (priv->paragraphs_font_desc,
+                                       priv->font_desc)))
+    clutter_text_clear_paragraphs (text);
+
+  contents = clutter_text_buffer_get_text (get_buffer (text));
+
+  old_paragraphs = priv->paragraphs;
+  n_old = old_paragraphs != NULL ? old_paragraphs->len : 0;
+
+  paragraphs = g_array_new (FALSE, TRUE, sizeof (TextParagraph));
+
+  p = contents;
+  while (TRUE)
+    {
+      TextParagraph paragraph = { NULL, };
+      gint delimiter, next;
+
+      pango_find_paragraph_boundary (p, -1, &delimiter, &next);
+
+      paragraph.text = (gchar *) p;
+      paragraph.length = delimiter;
+      g_array_append_val (paragraphs, paragraph);
+
+      if (p[next] == '\0' && next == delimiter)
+        break;
+
+      p += next;
+    }
+
+  if (paragraphs->len < 2)
+    {
+      g_array_free (paragraphs, TRUE);
+      clutter_text_clear_paragraphs (text);
+      return FALSE;
+    }
+
+  /* keep the measurements of the unchanged paragraphs at the start
+   * and at the end of the text; an edit will usually change a single
+   * paragraph
+   */
+  n_prefix = 0;
+  while (n_prefix < n_old && n_prefix < paragraphs->len)
+    {
+      TextParagraph *old = &g_array_index (old_paragraphs, TextParagraph, n_prefix);
+      TextParagraph *new = &g_array_index (paragraphs, TextParagraph, n_prefix);
+
+      if (!text_paragraph_matches (old, new->text, new->length))
+        break;
+
+      n_prefix += 1;
+    }
+
+  n_suffix = 0;
+  while (n_prefix + n_suffix < n_old &&
+         n_prefix + n_suffix < paragraphs->len)
+    {
+      TextParagraph *old =
+        &g_array_index (old_paragraphs, TextParagraph, n_old - n_suffix - 1);
+      TextParagraph *new =
+        &g_array_index (paragraphs, TextParagraph, paragraphs->len - n_suffix - 1);
+
+      if (!text_paragraph_matches (old, new->text, new->length))
+        break;
+
+      n_suffix += 1;
+    }
+
+  for (i = 0; i < paragraphs->len; i++)
+    {
+      TextParagraph *new = &g_array_index (paragraphs, TextParagraph, i);
+
+      if (i < n_prefix)
+        *new = g_array_index (old_paragraphs, TextParagraph, i);
+      else if (i >= paragraphs->len - n_suffix)
+        *new = g_array_index (old_paragraphs, TextParagraph,
+                              n_old - (paragraphs->len - i));
+      else
+        {
+          new->text = g_strndup (new->text, new->length);
+          new->wrap_width = -1;
+        }
+    }
+
+  /* the matched paragraphs have been moved into the new array */
+  for (i = n_prefix; i + n_suffix < n_old; i++)
+    g_free (g_array_index (old_paragraphs, TextParagraph, i).text);
+
+  if (old_paragraphs != NULL)
+    g_array_free (old_paragraphs, TRUE);
+
+  priv->paragraphs = paragraphs;
+
+  if (priv->paragraphs_font_desc == NULL)
+    priv->paragraphs_font_desc = pango_font_description_copy (priv->font_desc);
+
+  priv->paragraphs_wrap_mode = priv->wrap_mode;
+
+  return TRUE;
+}
+
+static gint
+clutter_text_measure_paragraph (ClutterText   *text,
+                                TextParagraph *paragraph,
+                                gint           width)
+{
+  ClutterTextPrivate *priv = text->priv;
+  PangoRectangle logical_rect = { 0, };
+  PangoLayout *layout;
+
+  layout = clutter_actor_create_pango_layout (CLUTTER_ACTOR (text), NULL);
+  pango_layout_set_font_description (layout, priv->font_desc);
+  pango_layout_set_text (layout, paragraph->text, paragraph->length);
+  pango_layout_set_alignment (layout, priv->alignment);
+  pango_layout_set_justify (layout, priv->justify);
+  pango_layout_set_wrap (layout, priv->wrap_mode);
+  pango_layout_set_width (layout, width);
+
+  pango_layout_get_extents (layout, NULL, &logical_rect);
+
+  if (width < 0)
+    {
+      paragraph->natural_width = logical_rect.x + logical_rect.width;
+      paragraph->natural_height = logical_rect.y + logical_rect.height;
+      paragraph->is_measured = TRUE;
+    }
+  else
+    {
+      paragraph->wrap_width = width;
+      paragraph->wrap_height = logical_rect.y + logical_rect.height;
+    }
+
+  g_object_unref (layout);
+
+  return logical_rect.y + logical_rect.height;
+}
+
+/*
+ * clutter_text_get_paragraphs_size:
+ * @text: a #ClutterText
+ * @for_width: the width to wrap the text at, or -1
+ * @width_p: (out) (allow-none): return location for the width of the
+ *   text without wrapping, in Pango units
+ * @height_p: (out) (allow-none): return location for the height of the
+ *   text, in Pango units
+ *
+ * Computes the size of a multi-paragraph text by composing the sizes of
+ * its paragraphs, measuring only the paragraphs that changed.
+ *
+ * Return value: %FALSE if the text cannot be measured by paragraphs,
+ *   and the whole layout should be used instead
+ */
+static gboolean
+clutter_text_get_paragraphs_size (ClutterText *text,
+                                  gfloat       for_width,
+                                  gint        *width_p,
+                                  gint        *height_p)
+{
+  ClutterTextPrivate *priv = text->priv;
+  gint width = -1, max_width, total_height;
+  guint i;
+
+  if (!clutter_text_update_paragraphs (text))
+    return FALSE;
+
+  /* this matches the width used by clutter_text_create_layout() for
+   * non-ellipsized text
    */
-  for (i = 0; i < N_CACHED_LAYOUTS; i++)
-    {
-      if (priv->cached_layouts[i].layout == NULL)
-	{
-	  /* Always prefer free cache spaces */
-	  found_free_cache = TRUE;
-	  oldest_cache = priv->cached_layouts + i;
-	}
-      else
-        {
-          PangoLayout *cached = priv->cached_layouts[i].layout;
-          gint cached_width = pango_layout_get_width (cached);
-	  gint cached_height = pango_layout_get_height (cached);
-	  gint cached_ellipsize = pango_layout_get_ellipsize (cached);
-
-	  if (cached_width == width &&
-	      cached_height == height &&
-	      cached_ellipsize == ellipsize)
-	    {
-              /* If this cached layout is using the same size then we can
-               * just return that directly
-               */
-              CLUTTER_NOTE (ACTOR,
-                            "ClutterText: %p: cache hit for size %.2fx%.2f",
-                            text,
-                            allocation_width,
-                            allocation_height);
+  if (for_width >= 0 && priv->wrap)
+    width = for_width * 1024 + 0.5f;
 
-              CLUTTER_COUNTER_INC (_clutter_uprof_context,
-                                   text_cache_hit_counter);
+  max_width = total_height = 0;
 
-              return priv->cached_layouts[i].layout;
-	    }
-
-	  /* When getting the preferred height for a specific width,
-	   * we might be able to reuse the layout from getting the
-	   * preferred width. If the width that the layout gives
-	   * unconstrained is less than the width that we are using
-	   * than the height will be unaffected by that width.
-	   */
-	  if (allocation_height < 0 &&
-              cached_width == -1 &&
-              cached_ellipsize == ellipsize)
-	    {
-	      PangoRectangle logical_rect;
-
-	      pango_layout_get_extents (priv->cached_layouts[i].layout,
-                                        NULL,
-                                        &logical_rect);
-
-	      if (logical_rect.width <= width)
-		{
-		  /* We've been asked for our height for the width we gave as a result
-		   * of a _get_preferred_width call
-		   */
-		  CLUTTER_NOTE (ACTOR,
-                                "ClutterText: %p: cache hit for size %.2fx%.2f "
-				"(unwrapped width narrower than given width)",
-				text,
-				allocation_width,
-				allocation_height);
-
-                  CLUTTER_COUNTER_INC (_clutter_uprof_context,
-                                       text_cache_hit_counter);
-
-		  return priv->cached_layouts[i].layout;
-		}
-	    }
-
-	  if (!found_free_cache &&
-	      (priv->cached_layouts[i].age < oldest_cache->age))
-	    {
-	      oldest_cache = priv->cached_layouts + i;
-	    }
-        }
-    }
+  for (i = 0; i < priv->paragraphs->len; i++)
+    {
+      TextParagraph *paragraph =
+        &g_array_index (priv->paragraphs, TextParagraph, i);
 
-  CLUTTER_NOTE (ACTOR, "ClutterText: %p: cache miss for size %.2fx%.2f",
-		text,
-                allocation_width,
-                allocation_height);
+      if (!paragraph->is_measured)
+        clutter_text_measure_paragraph (text, paragraph, -1);
 
-  CLUTTER_COUNTER_INC (_clutter_uprof_context, text_cache_miss_counter);
+      max_width = MAX (max_width, paragraph->natural_width);
 
-  /* If we make it here then we didn't have a cached version so we
-     need to recreate the layout */
-  if (oldest_cache->layout)
-    g_object_unref (oldest_cache->layout);
+      /* paragraphs narrower than the width are not wrapped */
+      if (width < 0 || paragraph->natural_width <= width)
+        total_height += paragraph->natural_height;
+      else if (paragraph->wrap_width == width)
+        total_height += paragraph->wrap_height;
+      else
+        total_height += clutter_text_measure_paragraph (text, paragraph, width);
+    }
 
-  oldest_cache->layout =
-    clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+  if (width_p)
+    *width_p = max_width;
 
-  cogl_pango_ensure_glyph_cache_for_layout (oldest_cache->layout);
+  if (height_p)
+    *height_p = total_height;
 
-  /* Mark the 'time' this cache was created and advance the time */
-  oldest_cache->age = priv->cache_age++;
-  return oldest_cache->layout;
+  return TRUE;
 }
 
 /**
@@ -934,7 +1979,7 @@ clutter_text_position_to_coords (ClutterText *self,
     }
   else
     {
-      gchar *text = clutter_text_get_display_text (self);
+      const gchar *text = clutter_text_get_display_text (self);
       GString *tmp = g_string_new (text);
       gint cursor_index;
 
@@ -948,7 +1993,6 @@ clutter_text_position_to_coords (ClutterText *self,
       else
         index_ = position * password_char_bytes;
 
-      g_free (text);
       g_string_free (tmp, TRUE);
     }
 
@@ -1104,6 +2148,13 @@ clutter_text_set_markup_internal (ClutterText *self,
 
   g_assert (str != NULL);
 
+  /* setting the same markup again does not need another parse, as
+   * long as the buffer still holds the text it was parsed into
+   */
+  if (priv->markup_attrs != NULL &&
+      g_strcmp0 (priv->markup_source, str) == 0)
+    return;
+
   error = NULL;
   res = pango_parse_markup (str, -1, 0,
                             &attrs,
@@ -1139,6 +2190,10 @@ clutter_text_set_markup_internal (ClutterText *self,
 
   priv->markup_attrs = attrs;
 
+  /* the buffer handlers reset this when the contents change */
+  g_free (priv->markup_source);
+  priv->markup_source = g_strdup (str);
+
   /* Clear the effective attributes so they will be regenerated when a
      layout is created */
   if (priv->effective_attrs != NULL)
@@ -1264,6 +2319,18 @@ clutter_text_set_property (GObject      *gobject,
       clutter_text_set_selected_text_color (self, clutter_value_get_color (value));
       break;
 
+    case PROP_LAYOUT_CACHE_SIZE:
+      clutter_text_set_layout_cache_size (self, g_value_get_uint (value));
+      break;
+
+    case PROP_REUSE_LAYOUTS:
+      clutter_text_set_reuse_layouts (self, g_value_get_boolean (value));
+      break;
+
+    case PROP_DEFERRED_LAYOUT:
+      clutter_text_set_deferred_layout (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -1392,19 +2459,60 @@ clutter_text_get_property (GObject    *gobject,
       g_value_set_boolean (value, priv->selected_text_color_set);
       break;
 
+    case PROP_LAYOUT_CACHE_SIZE:
+      g_value_set_uint (value, priv->layout_cache_size);
+      break;
+
+    case PROP_REUSE_LAYOUTS:
+      g_value_set_boolean (value, priv->reuse_layouts);
+      break;
+
+    case PROP_DEFERRED_LAYOUT:
+      g_value_set_boolean (value, priv->deferred_layout);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
 }
 
+static void
+clutter_text_map (ClutterActor *actor)
+{
+  ClutterText *self = CLUTTER_TEXT (actor);
+
+  CLUTTER_ACTOR_CLASS (clutter_text_parent_class)->map (actor);
+
+  if (mapped_texts == NULL)
+    mapped_texts = g_hash_table_new (NULL, NULL);
+
+  g_hash_table_insert (mapped_texts, self, self);
+
+  clutter_text_ensure_settings (self);
+}
+
+static void
+clutter_text_unmap (ClutterActor *actor)
+{
+  if (mapped_texts != NULL)
+    g_hash_table_remove (mapped_texts, actor);
+
+  CLUTTER_ACTOR_CLASS (clutter_text_parent_class)->unmap (actor);
+}
+
 static void
 clutter_text_dispose (GObject *gobject)
 {
   ClutterText *self = CLUTTER_TEXT (gobject);
   ClutterTextPrivate *priv = self->priv;
 
-  /* get rid of the entire cache */
+  /* get rid of the entire cache, including the layouts that are
+   * still used while the new ones are pending
+   */
+  priv->deferred_layout = FALSE;
+  priv->layout_pending = FALSE;
   clutter_text_dirty_cache (self);
+  clutter_text_clear_paragraphs (self);
 
   if (priv->direction_changed_id)
     {
@@ -1412,12 +2520,8 @@ clutter_text_dispose (GObject *gobject)
       priv->direction_changed_id = 0;
     }
 
-  if (priv->settings_changed_id)
-    {
-      g_signal_handler_disconnect (clutter_get_default_backend (),
-                                   priv->settings_changed_id);
-      priv->settings_changed_id = 0;
-    }
+  if (mapped_texts != NULL)
+    g_hash_table_remove (mapped_texts, self);
 
   if (priv->password_hint_id)
     {
@@ -1448,11 +2552,23 @@ clutter_text_finalize (GObject *gobject)
   if (priv->preedit_attrs)
     pango_attr_list_unref (priv->preedit_attrs);
 
+  g_free (priv->markup_source);
+
+  clutter_text_clear_password_text (self);
+  if (priv->password_hint_text != NULL)
+    g_string_free (priv->password_hint_text, TRUE);
+
   clutter_text_dirty_paint_volume (self);
 
   clutter_text_set_buffer (self, NULL);
   g_free (priv->font_name);
 
+  _clutter_memory_remove_purge_func (self);
+
+  /* the deferred layouts would keep the cache alive */
+  layout_cache_trim (self, 0);
+  g_hash_table_destroy (priv->cached_layouts);
+
   G_OBJECT_CLASS (clutter_text_parent_class)->finalize (gobject);
 }
 
@@ -1467,7 +2583,7 @@ clutter_text_foreach_selection_rectangle (ClutterText              *self,
 {
   ClutterTextPrivate *priv = self->priv;
   PangoLayout *layout = clutter_text_get_layout (self);
-  gchar *utf8 = clutter_text_get_display_text (self);
+  const gchar *utf8 = clutter_text_get_display_text (self);
   gint lines;
   gint start_index;
   gint end_index;
@@ -1543,8 +2659,6 @@ clutter_text_foreach_selection_rectangle (ClutterText              *self,
 
       g_free (ranges);
     }
-
-  g_free (utf8);
 }
 
 static void
@@ -2008,12 +3122,66 @@ static gboolean
 clutter_text_remove_password_hint (gpointer data)
 {
   ClutterText *self = data;
+  ClutterTextPrivate *priv = self->priv;
+  ClutterActor *actor = CLUTTER_ACTOR (self);
+  ClutterActorBox alloc = { 0, };
+  ClutterPaintVolume volume;
+  ClutterVertex origin;
+  PangoLayout *layout;
+  gfloat hint_x, line_height;
+  gboolean can_clip;
+  gint n_chars;
+
+  n_chars = clutter_text_buffer_get_length (get_buffer (self));
+
+  /* only the last character is shown as a hint, so unless the text
+   * has to be wrapped or scrolled again we can limit the redraw to
+   * the area starting from it
+   */
+  can_clip = priv->editable && priv->single_line_mode &&
+             !priv->preedit_set &&
+             n_chars > 0 &&
+             clutter_actor_has_allocation (actor) &&
+             clutter_text_position_to_coords (self, n_chars - 1,
+                                              &hint_x, NULL,
+                                              &line_height);
+
+  priv->password_hint_visible = FALSE;
+  priv->password_hint_id = 0;
+
+  clutter_text_dirty_cache (self);
+
+  if (!can_clip)
+    {
+      clutter_text_queue_redraw (actor);
+      return G_SOURCE_REMOVE;
+    }
+
+  clutter_actor_get_allocation_box (actor, &alloc);
+  layout = clutter_text_get_paint_layout (self, &alloc);
+
+  clutter_text_ensure_cursor_position (self);
+
+  if (clutter_text_compute_scroll_offset (self, layout, &alloc) != priv->text_x)
+    {
+      clutter_text_queue_redraw (actor);
+      return G_SOURCE_REMOVE;
+    }
 
-  self->priv->password_hint_visible = FALSE;
-  self->priv->password_hint_id = 0;
+  /* leave some room for the glyph overhang of the hint */
+  origin.x = MAX (hint_x - line_height / 2.0f, 0.f);
+  origin.y = 0.f;
+  origin.z = 0.f;
 
-  clutter_text_dirty_cache (data);
-  clutter_text_queue_redraw (data);
+  _clutter_paint_volume_init_static (&volume, actor);
+  clutter_paint_volume_set_origin (&volume, &origin);
+  clutter_paint_volume_set_width (&volume,
+                                  MAX (clutter_actor_box_get_width (&alloc) - origin.x, 0.f));
+  clutter_paint_volume_set_height (&volume,
+                                   clutter_actor_box_get_height (&alloc));
+
+  _clutter_actor_queue_redraw_with_clip (actor, 0, &volume);
+  clutter_paint_volume_free (&volume);
 
   return G_SOURCE_REMOVE;
 }
@@ -2030,11 +3198,13 @@ clutter_text_key_press (ClutterActor    *actor,
   if (!priv->editable)
     return CLUTTER_EVENT_PROPAGATE;
 
-  /* we need to use the ClutterText type name to find our own
-   * key bindings; subclasses will override or chain up this
-   * event handler, so they can do whatever they want there
+  /* we need to use the ClutterText key bindings, and not the ones
+   * of the actual class; subclasses will override or chain up this
+   * event handler, so they can do whatever they want there. the
+   * pool is stored when initializing the class, to avoid looking
+   * it up by name for every key press
    */
-  pool = clutter_binding_pool_find (g_type_name (CLUTTER_TYPE_TEXT));
+  pool = text_binding_pool;
   g_assert (pool != NULL);
 
   /* we allow passing synthetic events that only contain
@@ -2145,26 +3315,425 @@ clutter_text_compute_layout_offsets (ClutterText           *self,
     case CLUTTER_ACTOR_ALIGN_START:
       break;
 
-    case CLUTTER_ACTOR_ALIGN_END:
-      if (alloc_height > logical_rect.height)
-        y = alloc_height - logical_rect.height;
-      break;
+    case CLUTTER_ACTOR_ALIGN_END:
+      if (alloc_height > logical_rect.height)
+        y = alloc_height - logical_rect.height;
+      break;
+
+    case CLUTTER_ACTOR_ALIGN_CENTER:
+      if (alloc_height > logical_rect.height)
+        y = (alloc_height - logical_rect.height) / 2.f;
+      break;
+    }
+
+  if (text_x != NULL)
+    *text_x = floorf (x);
+
+  if (text_y != NULL)
+    *text_y = floorf (y);
+}
+
+#define TEXT_PADDING    2
+
+/*
+ * clutter_text_get_line_extents:
+ * @layout: a #PangoLayout
+ *
+ * Retrieves the position of each line of @layout; since the layouts
+ * are never changed after being created, the positions are computed
+ * only once and stored on the layout itself.
+ *
+ * Return value: (transfer none): an array of #TextLineExtents
+ */
+static GArray *
+clutter_text_get_line_extents (PangoLayout *layout)
+{
+  static GQuark quark_line_extents = 0;
+  PangoLayoutIter *iter;
+  GArray *extents;
+
+  if (G_UNLIKELY (quark_line_extents == 0))
+    quark_line_extents = g_quark_from_static_string ("clutter-text-line-extents");
+
+  extents = g_object_get_qdata (G_OBJECT (layout), quark_line_extents);
+  if (extents != NULL)
+    return extents;
+
+  extents = g_array_sized_new (FALSE, FALSE, sizeof (TextLineExtents),
+                               pango_layout_get_line_count (layout));
+
+  iter = pango_layout_get_iter (layout);
+  do
+    {
+      PangoRectangle logical_rect;
+      TextLineExtents line;
+
+      pango_layout_iter_get_line_extents (iter, NULL, &logical_rect);
+      pango_layout_iter_get_line_yrange (iter, &line.y1, &line.y2);
+
+      line.line = pango_layout_iter_get_line_readonly (iter);
+      line.x = logical_rect.x;
+      line.baseline = pango_layout_iter_get_baseline (iter);
+
+      g_array_append_val (extents, line);
+    }
+  while (pango_layout_iter_next_line (iter));
+
+  pango_layout_iter_free (iter);
+
+  g_object_set_qdata_full (G_OBJECT (layout), quark_line_extents,
+                           extents,
+                           (GDestroyNotify) g_array_unref);
+
+  return extents;
+}
+
+/* Maps @box from the coordinate space of an ancestor to the coordinate
+ * space of the actor, using the transformation @matrix from the actor
+ * to the ancestor; only 2D scales and translations can be mapped back
+ */
+static gboolean
+clutter_text_unproject_box (const CoglMatrix      *matrix,
+                            const ClutterActorBox *box,
+                            ClutterActorBox       *box_out)
+{
+  gfloat x1, y1, x2, y2;
+
+  if (matrix->xy != 0.f || matrix->yx != 0.f ||
+      matrix->zx != 0.f || matrix->zy != 0.f || matrix->zw != 0.f ||
+      matrix->wx != 0.f || matrix->wy != 0.f || matrix->ww != 1.f ||
+      matrix->xx == 0.f || matrix->yy == 0.f)
+    return FALSE;
+
+  x1 = (box->x1 - matrix->xw) / matrix->xx;
+  x2 = (box->x2 - matrix->xw) / matrix->xx;
+  y1 = (box->y1 - matrix->yw) / matrix->yy;
+  y2 = (box->y2 - matrix->yw) / matrix->yy;
+
+  box_out->x1 = MIN (x1, x2);
+  box_out->x2 = MAX (x1, x2);
+  box_out->y1 = MIN (y1, y2);
+  box_out->y2 = MAX (y1, y2);
+
+  return TRUE;
+}
+
+/*
+ * clutter_text_get_visible_box:
+ * @self: a #ClutterText
+ * @visible: (out): return location for the visible area of @self
+ *
+ * Computes the area of @self that is not clipped by the actor itself,
+ * its ancestors or the stage, in actor-relative coordinates.
+ *
+ * Clips that cannot be mapped back, like the ones of rotated ancestors,
+ * are ignored, so the visible area is never smaller than the painted one.
+ *
+ * Return value: %FALSE if the visible area is not known
+ */
+static gboolean
+clutter_text_get_visible_box (ClutterText     *self,
+                              ClutterActorBox *visible)
+{
+  ClutterActor *actor = CLUTTER_ACTOR (self);
+  ClutterActor *stage, *iter;
+  gboolean is_clipped = FALSE;
+
+  /* clones and offscreen effects paint the actor somewhere else */
+  if (clutter_actor_is_in_clone_paint (actor))
+    return FALSE;
+
+  stage = _clutter_actor_get_stage_internal (actor);
+  if (stage == NULL ||
+      cogl_get_draw_framebuffer () !=
+      _clutter_stage_get_active_framebuffer (CLUTTER_STAGE (stage)))
+    return FALSE;
+
+  visible->x1 = visible->y1 = -G_MAXFLOAT;
+  visible->x2 = visible->y2 = G_MAXFLOAT;
+
+  for (iter = actor; iter != NULL; iter = clutter_actor_get_parent (iter))
+    {
+      ClutterActorBox clip;
+      CoglMatrix matrix;
+
+      if (clutter_actor_has_clip (iter))
+        {
+          gfloat x, y, width, height;
+
+          clutter_actor_get_clip (iter, &x, &y, &width, &height);
+          clutter_actor_box_init (&clip, x, y, x + width, y + height);
+        }
+      else if (iter == stage || clutter_actor_get_clip_to_allocation (iter))
+        {
+          gfloat width, height;
+
+          clutter_actor_get_size (iter, &width, &height);
+          clutter_actor_box_init (&clip, 0, 0, width, height);
+        }
+      else
+        continue;
+
+      cogl_matrix_init_identity (&matrix);
+      if (iter != actor)
+        _clutter_actor_apply_relative_transformation_matrix (actor, iter, &matrix);
+
+      if (!clutter_text_unproject_box (&matrix, &clip, &clip))
+        continue;
+
+      visible->x1 = MAX (visible->x1, clip.x1);
+      visible->y1 = MAX (visible->y1, clip.y1);
+      visible->x2 = MIN (visible->x2, clip.x2);
+      visible->y2 = MIN (visible->y2, clip.y2);
+
+      is_clipped = TRUE;
+    }
+
+  return is_clipped;
+}
+
+/*
+ * clutter_text_render_layout:
+ * @self: a #ClutterText
+ * @layout: the #PangoLayout to render
+ * @x: the X offset of the layout, in pixels
+ * @y: the Y offset of the layout, in pixels
+ * @color: the color of the text
+ *
+ * Renders @layout, skipping the lines that are outside the visible
+ * area of @self, for instance because the actor is inside a scrolling
+ * container.
+ */
+static void
+clutter_text_render_layout (ClutterText     *self,
+                            PangoLayout     *layout,
+                            gint             x,
+                            gint             y,
+                            const CoglColor *color)
+{
+  ClutterActorBox visible;
+  GArray *extents;
+  gint visible_y1, visible_y2;
+  guint first, last, lo, hi;
+
+  if (pango_layout_get_line_count (layout) < MIN_CULLED_LINES ||
+      !clutter_text_get_visible_box (self, &visible))
+    {
+      cogl_pango_render_layout (layout, x, y, color, 0);
+      return;
+    }
+
+  extents = clutter_text_get_line_extents (layout);
+
+  /* the visible area relative to the layout, in Pango units */
+  visible_y1 = CLAMP (floorf (visible.y1 - y) * PANGO_SCALE,
+                      -G_MAXINT / 2, G_MAXINT / 2);
+  visible_y2 = CLAMP (ceilf (visible.y2 - y) * PANGO_SCALE,
+                      -G_MAXINT / 2, G_MAXINT / 2);
+
+  /* binary search the first line ending after the top of the area */
+  lo = 0;
+  hi = extents->len;
+  while (lo < hi)
+    {
+      guint mid = (lo + hi) / 2;
+
+      if (g_array_index (extents, TextLineExtents, mid).y2 <= visible_y1)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  first = lo;
+
+  /* ... and the first line starting after the bottom of the area */
+  hi = extents->len;
+  while (lo < hi)
+    {
+      guint mid = (lo + hi) / 2;
+
+      if (g_array_index (extents, TextLineExtents, mid).y1 < visible_y2)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  last = lo;
+
+  if (first == 0 && last == extents->len)
+    {
+      cogl_pango_render_layout (layout, x, y, color, 0);
+      return;
+    }
+
+  CLUTTER_NOTE (PAINT, "painting lines %u to %u of %u",
+                first, last,
+                extents->len);
+
+  for (; first < last; first++)
+    {
+      const TextLineExtents *line =
+        &g_array_index (extents, TextLineExtents, first);
+
+      cogl_pango_render_layout_line (line->line,
+                                     x * PANGO_SCALE + line->x,
+                                     y * PANGO_SCALE + line->baseline,
+                                     color);
+    }
+}
+
+/*
+ * clutter_text_get_paint_layout:
+ * @text: a #ClutterText
+ * @alloc: the allocation of @text
+ *
+ * Retrieves the layout used to paint @text inside @alloc.
+ */
+static PangoLayout *
+clutter_text_get_paint_layout (ClutterText           *text,
+                               const ClutterActorBox *alloc)
+{
+  ClutterTextPrivate *priv = text->priv;
+
+  if (priv->editable && priv->single_line_mode)
+    return clutter_text_create_layout (text, -1, -1);
+
+  /* the only time when we create the PangoLayout using the full
+   * width and height of the allocation is when we can both wrap
+   * and ellipsize
+   */
+  if (priv->wrap && priv->ellipsize)
+    {
+      return clutter_text_create_layout (text,
+                                         alloc->x2 - alloc->x1,
+                                         alloc->y2 - alloc->y1);
+    }
+
+  /* if we're not wrapping we cannot set the height of the
+   * layout, otherwise Pango will happily wrap the text to
+   * fit in the rectangle - thus making the :wrap property
+   * useless
+   *
+   * see bug:
+   *
+   *   http://bugzilla.clutter-project.org/show_bug.cgi?id=2339
+   *
+   * in order to fix this, we create a layout that would fit
+   * in the assigned width, then we clip the actor if the
+   * logical rectangle overflows the allocation.
+   */
+  return clutter_text_create_layout (text, alloc->x2 - alloc->x1, -1);
+}
+
+static void
+clutter_text_paint_node (ClutterActor     *self,
+                         ClutterPaintNode *root)
+{
+  ClutterText *text = CLUTTER_TEXT (self);
+  ClutterTextPrivate *priv = text->priv;
+  ClutterPaintNode *node;
+  ClutterActorBox alloc = { 0, };
+  ClutterActorBox box;
+  ClutterColor color;
+  PangoLayout *layout;
+  gint text_x, text_y;
+
+  priv->painted_by_node = FALSE;
+
+  /* only static text can be retained in the render tree: painting
+   * the cursor and the selection, as well as culling the lines of
+   * long layouts, is done by clutter_text_paint()
+   */
+  if (priv->editable || priv->has_focus)
+    return;
+
+  if (clutter_text_buffer_get_length (get_buffer (text)) == 0)
+    return;
+
+  clutter_actor_get_allocation_box (self, &alloc);
+
+  layout = clutter_text_get_paint_layout (text, &alloc);
+  if (pango_layout_get_line_count (layout) >= MIN_CULLED_LINES)
+    return;
+
+  clutter_text_compute_layout_offsets (text, layout, &alloc, &text_x, &text_y);
+  priv->text_x = text_x;
+  priv->text_y = text_y;
+
+  color = priv->text_color;
+  color.alpha = clutter_actor_get_paint_opacity (self)
+              * priv->text_color.alpha
+              / 255;
+
+  /* the text node clips the layout to the rectangle if it overflows;
+   * the layout is only offset inside the allocation when it fits
+   */
+  clutter_actor_box_init (&box,
+                          text_x, text_y,
+                          alloc.x2 - alloc.x1,
+                          alloc.y2 - alloc.y1);
+
+  node = clutter_text_node_new (layout, &color);
+  clutter_paint_node_set_name (node, "text");
+  clutter_paint_node_add_rectangle (node, &box);
+  clutter_paint_node_add_child (root, node);
+  clutter_paint_node_unref (node);
+
+  priv->painted_by_node = TRUE;
+}
+
+/* computes the horizontal offset of the layout of a single line
+ * editable actor, which scrolls to keep the cursor visible; the
+ * position of the cursor must be up to date
+ */
+static gint
+clutter_text_compute_scroll_offset (ClutterText           *text,
+                                    PangoLayout           *layout,
+                                    const ClutterActorBox *alloc)
+{
+  ClutterTextPrivate *priv = text->priv;
+  PangoRectangle logical_rect = { 0, };
+  gint actor_width, text_width;
+  gint text_x = priv->text_x;
+
+  pango_layout_get_extents (layout, NULL, &logical_rect);
+
+  actor_width = (alloc->x2 - alloc->x1)
+              - 2 * TEXT_PADDING;
+  text_width  = logical_rect.width / PANGO_SCALE;
 
-    case CLUTTER_ACTOR_ALIGN_CENTER:
-      if (alloc_height > logical_rect.height)
-        y = (alloc_height - logical_rect.height) / 2.f;
-      break;
-    }
+  if (actor_width < text_width)
+    {
+      gint cursor_x = clutter_rect_get_x (&priv->cursor_rect);
 
-  if (text_x != NULL)
-    *text_x = floorf (x);
+      if (priv->position == -1)
+        {
+          text_x = actor_width - text_width;
+        }
+      else if (priv->position == 0)
+        {
+          text_x = TEXT_PADDING;
+        }
+      else
+        {
+          if (cursor_x < 0)
+            {
+              text_x = text_x - cursor_x - TEXT_PADDING;
+            }
+          else if (cursor_x > actor_width)
+            {
+              text_x = text_x + (actor_width - cursor_x) - TEXT_PADDING;
+            }
+        }
+    }
+  else
+    {
+      text_x = TEXT_PADDING;
+    }
 
-  if (text_y != NULL)
-    *text_y = floorf (y);
+  return text_x;
 }
 
-#define TEXT_PADDING    2
-
 static void
 clutter_text_paint (ClutterActor *self)
 {
@@ -2180,6 +3749,11 @@ clutter_text_paint (ClutterActor *self)
   gboolean bg_color_set = FALSE;
   guint n_chars;
 
+  /* the static text has already been added to the retained render
+     tree, together with the background color */
+  if (priv->painted_by_node)
+    return;
+
   /* Note that if anything in this paint method changes it needs to be
      reflected in the get_paint_volume implementation which is tightly
      tied to the workings of this function */
@@ -2211,88 +3785,19 @@ clutter_text_paint (ClutterActor *self)
   if (n_chars == 0 && (!priv->editable || !priv->cursor_visible))
     return;
 
-  if (priv->editable && priv->single_line_mode)
-    layout = clutter_text_create_layout (text, -1, -1);
-  else
-    {
-      /* the only time when we create the PangoLayout using the full
-       * width and height of the allocation is when we can both wrap
-       * and ellipsize
-       */
-      if (priv->wrap && priv->ellipsize)
-        {
-          layout = clutter_text_create_layout (text,
-                                               alloc.x2 - alloc.x1,
-                                               alloc.y2 - alloc.y1);
-        }
-      else
-        {
-          /* if we're not wrapping we cannot set the height of the
-           * layout, otherwise Pango will happily wrap the text to
-           * fit in the rectangle - thus making the :wrap property
-           * useless
-           *
-           * see bug:
-           *
-           *   http://bugzilla.clutter-project.org/show_bug.cgi?id=2339
-           *
-           * in order to fix this, we create a layout that would fit
-           * in the assigned width, then we clip the actor if the
-           * logical rectangle overflows the allocation.
-           */
-          layout = clutter_text_create_layout (text,
-                                               alloc.x2 - alloc.x1,
-                                               -1);
-        }
-    }
+  layout = clutter_text_get_paint_layout (text, &alloc);
 
   if (priv->editable && priv->cursor_visible)
     clutter_text_ensure_cursor_position (text);
 
   if (priv->editable && priv->single_line_mode)
     {
-      PangoRectangle logical_rect = { 0, };
-      gint actor_width, text_width;
-
-      pango_layout_get_extents (layout, NULL, &logical_rect);
-
       cogl_clip_push_rectangle (0, 0,
                                 (alloc.x2 - alloc.x1),
                                 (alloc.y2 - alloc.y1));
       clip_set = TRUE;
 
-      actor_width = (alloc.x2 - alloc.x1)
-                  - 2 * TEXT_PADDING;
-      text_width  = logical_rect.width / PANGO_SCALE;
-
-      if (actor_width < text_width)
-        {
-          gint cursor_x = clutter_rect_get_x (&priv->cursor_rect);
-
-          if (priv->position == -1)
-            {
-              text_x = actor_width - text_width;
-            }
-          else if (priv->position == 0)
-            {
-              text_x = TEXT_PADDING;
-            }
-          else
-            {
-              if (cursor_x < 0)
-                {
-                  text_x = text_x - cursor_x - TEXT_PADDING;
-                }
-              else if (cursor_x > actor_width)
-                {
-                  text_x = text_x + (actor_width - cursor_x) - TEXT_PADDING;
-                }
-            }
-        }
-      else
-        {
-          text_x = TEXT_PADDING;
-        }
+      text_x = clutter_text_compute_scroll_offset (text, layout, &alloc);
     }
   else if (!priv->editable && !(priv->wrap && priv->ellipsize))
     {
@@ -2336,7 +3841,7 @@ clutter_text_paint (ClutterActor *self)
                             priv->text_color.green,
                             priv->text_color.blue,
                             real_opacity);
-  cogl_pango_render_layout (layout, priv->text_x, priv->text_y, &color, 0);
+  clutter_text_render_layout (text, layout, priv->text_x, priv->text_y, &color);
 
   selection_paint (text);
 
@@ -2464,6 +3969,71 @@ clutter_text_get_paint_volume (ClutterActor       *self,
   return TRUE;
 }
 
+/* retrieves the area covered by the cursor, or by the selection; the
+ * volume is empty if they are not painted
+ */
+static void
+clutter_text_get_cursor_redraw_volume (ClutterText        *self,
+                                       ClutterPaintVolume *volume)
+{
+  ClutterTextPrivate *priv = self->priv;
+
+  _clutter_paint_volume_init_static (volume, CLUTTER_ACTOR (self));
+
+  if (priv->editable && priv->cursor_visible && priv->has_focus &&
+      clutter_actor_has_allocation (CLUTTER_ACTOR (self)))
+    clutter_text_get_paint_volume_for_cursor (self, volume);
+}
+
+/* queues a redraw of the area covered by the cursor, or by the
+ * selection, before a change, in @old_volume, and after it, instead
+ * of the whole actor; this is not possible if the change scrolls the
+ * contents of a single line actor
+ */
+static void
+clutter_text_queue_redraw_cursor (ClutterText        *self,
+                                  ClutterPaintVolume *old_volume)
+{
+  ClutterTextPrivate *priv = self->priv;
+  ClutterActor *actor = CLUTTER_ACTOR (self);
+  ClutterPaintVolume volume;
+
+  if (!clutter_actor_has_allocation (actor))
+    {
+      clutter_text_queue_redraw (actor);
+      return;
+    }
+
+  if (priv->editable && priv->single_line_mode)
+    {
+      ClutterActorBox alloc = { 0, };
+      PangoLayout *layout;
+
+      clutter_actor_get_allocation_box (actor, &alloc);
+      layout = clutter_text_get_paint_layout (self, &alloc);
+
+      clutter_text_ensure_cursor_position (self);
+
+      if (clutter_text_compute_scroll_offset (self, layout, &alloc) != priv->text_x)
+        {
+          clutter_text_queue_redraw (actor);
+          return;
+        }
+    }
+
+  /* the cursor is part of the paint volume */
+  clutter_text_dirty_paint_volume (self);
+
+  clutter_text_get_cursor_redraw_volume (self, &volume);
+  clutter_paint_volume_union (&volume, old_volume);
+
+  /* nothing visible changed */
+  if (!volume.is_empty)
+    _clutter_actor_queue_redraw_with_clip (actor, 0, &volume);
+
+  clutter_paint_volume_free (&volume);
+}
+
 static void
 clutter_text_get_preferred_width (ClutterActor *self,
                                   gfloat        for_height,
@@ -2477,15 +4047,18 @@ clutter_text_get_preferred_width (ClutterActor *self,
   gint logical_width;
   gfloat layout_width;
 
-  layout = clutter_text_create_layout (text, -1, -1);
+  if (!clutter_text_get_paragraphs_size (text, -1, &logical_width, NULL))
+    {
+      layout = clutter_text_create_layout (text, -1, -1);
 
-  pango_layout_get_extents (layout, NULL, &logical_rect);
+      pango_layout_get_extents (layout, NULL, &logical_rect);
 
-  /* the X coordinate of the logical rectangle might be non-zero
-   * according to the Pango documentation; hence, we need to offset
-   * the width accordingly
-   */
-  logical_width = logical_rect.x + logical_rect.width;
+      /* the X coordinate of the logical rectangle might be non-zero
+       * according to the Pango documentation; hence, we need to offset
+       * the width accordingly
+       */
+      logical_width = logical_rect.x + logical_rect.width;
+    }
 
   layout_width = logical_width > 0
     ? ceilf (logical_width / 1024.0f)
@@ -2534,6 +4107,25 @@ clutter_text_get_preferred_height (ClutterActor *self,
       if (priv->single_line_mode)
         for_width = -1;
 
+      /* multi-paragraph text is measured one paragraph at a time; the
+       * paragraphs are never ellipsized, so the minimum height is the
+       * same as the natural height
+       */
+      if (clutter_text_get_paragraphs_size (CLUTTER_TEXT (self), for_width,
+                                            NULL,
+                                            &logical_height))
+        {
+          layout_height = ceilf (logical_height / 1024.0f);
+
+          if (min_height_p)
+            *min_height_p = layout_height;
+
+          if (natural_height_p)
+            *natural_height_p = layout_height;
+
+          return;
+        }
+
       layout = clutter_text_create_layout (CLUTTER_TEXT (self),
                                            for_width, -1);
 
@@ -2613,20 +4205,28 @@ static void
 clutter_text_key_focus_in (ClutterActor *actor)
 {
   ClutterTextPrivate *priv = CLUTTER_TEXT (actor)->priv;
+  ClutterPaintVolume old_volume;
+
+  clutter_text_get_cursor_redraw_volume (CLUTTER_TEXT (actor), &old_volume);
 
   priv->has_focus = TRUE;
 
-  clutter_text_queue_redraw (actor);
+  clutter_text_queue_redraw_cursor (CLUTTER_TEXT (actor), &old_volume);
+  clutter_paint_volume_free (&old_volume);
 }
 
 static void
 clutter_text_key_focus_out (ClutterActor *actor)
 {
   ClutterTextPrivate *priv = CLUTTER_TEXT (actor)->priv;
+  ClutterPaintVolume old_volume;
+
+  clutter_text_get_cursor_redraw_volume (CLUTTER_TEXT (actor), &old_volume);
 
   priv->has_focus = FALSE;
 
-  clutter_text_queue_redraw (actor);
+  clutter_text_queue_redraw_cursor (CLUTTER_TEXT (actor), &old_volume);
+  clutter_paint_volume_free (&old_volume);
 }
 
 static gboolean
@@ -3315,7 +4915,10 @@ clutter_text_class_init (ClutterTextClass *klass)
   gobject_class->dispose = clutter_text_dispose;
   gobject_class->finalize = clutter_text_finalize;
 
+  actor_class->map = clutter_text_map;
+  actor_class->unmap = clutter_text_unmap;
   actor_class->paint = clutter_text_paint;
+  actor_class->paint_node = clutter_text_paint_node;
   actor_class->get_paint_volume = clutter_text_get_paint_volume;
   actor_class->get_preferred_width = clutter_text_get_preferred_width;
   actor_class->get_preferred_height = clutter_text_get_preferred_height;
@@ -3740,6 +5343,65 @@ clutter_text_class_init (ClutterTextClass *klass)
   obj_props[PROP_SELECTED_TEXT_COLOR_SET] = pspec;
   g_object_class_install_property (gobject_class, PROP_SELECTED_TEXT_COLOR_SET, pspec);
 
+  /**
+   * ClutterText:layout-cache-size:
+   *
+   * The maximum number of #PangoLayout<!-- -->s, each created for a
+   * different size, that the #ClutterText keeps around.
+   *
+   * A larger cache avoids shaping the text again when the size of
+   * the actor changes often, at the expense of memory.
+   */
+  pspec = g_param_spec_uint ("layout-cache-size",
+                             P_("Layout Cache Size"),
+                             P_("The number of layouts kept in the cache"),
+                             1, G_MAXUINT,
+                             N_CACHED_LAYOUTS,
+                             CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_LAYOUT_CACHE_SIZE] = pspec;
+  g_object_class_install_property (gobject_class, PROP_LAYOUT_CACHE_SIZE, pspec);
+
+  /**
+   * ClutterText:reuse-layouts:
+   *
+   * Whether the #ClutterText should reuse a cached #PangoLayout
+   * created for a different width, if it breaks the text into
+   * the same lines; for instance, if the text fits on a single
+   * line at both widths.
+   *
+   * Only left-aligned, non-justified and non-ellipsized text
+   * can reuse layouts.
+   */
+  pspec = g_param_spec_boolean ("reuse-layouts",
+                                P_("Reuse Layouts"),
+                                P_("Whether layouts with the same lines should be reused"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_REUSE_LAYOUTS] = pspec;
+  g_object_class_install_property (gobject_class, PROP_REUSE_LAYOUTS, pspec);
+
+  /**
+   * ClutterText:deferred-layout:
+   *
+   * Whether the #ClutterText should keep painting its current contents
+   * when they change, and lay out the new contents later.
+   *
+   * Deferred layouts are created after the frames have been painted,
+   * within a time budget shared by all the #ClutterText actors, so
+   * that changing the contents of many actors at once does not stall
+   * the frame; once the new layout of an actor is ready, the actor is
+   * queued for relayout.
+   *
+   * Editable actors always lay out their contents immediately.
+   */
+  pspec = g_param_spec_boolean ("deferred-layout",
+                                P_("Deferred Layout"),
+                                P_("Whether changes of the contents should be laid out later"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_DEFERRED_LAYOUT] = pspec;
+  g_object_class_install_property (gobject_class, PROP_DEFERRED_LAYOUT, pspec);
+
   /**
    * ClutterText::text-changed:
    * @self: the #ClutterText that emitted the signal
@@ -3835,6 +5497,7 @@ clutter_text_class_init (ClutterTextClass *klass)
                   G_TYPE_NONE, 0);
 
   binding_pool = clutter_binding_pool_get_for_class (klass);
+  text_binding_pool = binding_pool;
 
   clutter_text_add_move_binding (binding_pool, "move-left",
                                  CLUTTER_KEY_Left, CLUTTER_CONTROL_MASK,
@@ -3931,7 +5594,7 @@ clutter_text_init (ClutterText *self)
   ClutterSettings *settings;
   ClutterTextPrivate *priv;
   gchar *font_name;
-  int i, password_hint_time;
+  int password_hint_time;
 
   self->priv = priv = CLUTTER_TEXT_GET_PRIVATE (self);
 
@@ -3943,8 +5606,15 @@ clutter_text_init (ClutterText *self)
   priv->use_markup    = FALSE;
   priv->justify       = FALSE;
 
-  for (i = 0; i < N_CACHED_LAYOUTS; i++)
-    priv->cached_layouts[i].layout = NULL;
+  priv->cached_layouts = g_hash_table_new (layout_cache_hash,
+                                           layout_cache_equal);
+  g_queue_init (&priv->cached_layouts_lru);
+  priv->layout_cache_size = N_CACHED_LAYOUTS;
+  priv->reuse_layouts = FALSE;
+
+  _clutter_memory_add_purge_func (CLUTTER_MEMORY_TEXT_LAYOUTS,
+                                  self,
+                                  clutter_text_purge_caches);
 
   /* default to "" so that clutter_text_get_text() will
    * return a valid string and we can safely call strlen()
@@ -3992,11 +5662,14 @@ clutter_text_init (ClutterText *self)
 
   priv->cursor_size = DEFAULT_CURSOR_SIZE;
 
-  priv->settings_changed_id =
-    g_signal_connect_swapped (clutter_get_default_backend (),
-                              "settings-changed",
-                              G_CALLBACK (clutter_text_settings_changed_cb),
-                              self);
+  priv->settings_generation = text_settings_generation;
+
+  if (text_settings_changed_id == 0)
+    text_settings_changed_id =
+      g_signal_connect (clutter_get_default_backend (),
+                        "settings-changed",
+                        G_CALLBACK (clutter_text_settings_changed_cb),
+                        NULL);
 
   priv->direction_changed_id =
     g_signal_connect (self, "notify::text-direction",
@@ -4106,6 +5779,20 @@ buffer_inserted_text (ClutterTextBuffer *buffer,
   gsize n_bytes;
 
   priv = self->priv;
+
+  g_free (priv->markup_source);
+  priv->markup_source = NULL;
+
+  if (priv->password_text != NULL)
+    {
+      gint char_len = g_unichar_to_utf8 (priv->password_char, NULL);
+
+      if ((gsize) position * char_len <= priv->password_text->len)
+        clutter_text_fill_password_text (self, position * char_len, n_chars);
+      else
+        clutter_text_clear_password_text (self);
+    }
+
   if (priv->position >= 0 || priv->selection_bound >= 0)
     {
       new_position = priv->position;
@@ -4138,6 +5825,22 @@ buffer_deleted_text (ClutterTextBuffer *buffer,
   gint new_selection_bound;
 
   priv = self->priv;
+
+  g_free (priv->markup_source);
+  priv->markup_source = NULL;
+
+  if (priv->password_text != NULL)
+    {
+      gint char_len = g_unichar_to_utf8 (priv->password_char, NULL);
+      gsize pos = (gsize) position * char_len;
+      gsize len = (gsize) n_chars * char_len;
+
+      if (pos + len <= priv->password_text->len)
+        g_string_erase (priv->password_text, pos, len);
+      else
+        clutter_text_clear_password_text (self);
+    }
+
   if (priv->position >= 0 || priv->selection_bound >= 0)
     {
       new_position = priv->position;
@@ -4164,7 +5867,7 @@ buffer_notify_text (ClutterTextBuffer *buffer,
 
   clutter_text_dirty_cache (self);
 
-  clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+  _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (self));
 
   g_signal_emit (self, text_signals[TEXT_CHANGED], 0);
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_TEXT]);
@@ -4271,6 +5974,10 @@ clutter_text_set_buffer (ClutterText       *self,
 
   priv->buffer = buffer;
 
+  clutter_text_clear_password_text (self);
+  g_free (priv->markup_source);
+  priv->markup_source = NULL;
+
   if (priv->buffer)
      buffer_connect_signals (self);
 
@@ -4505,7 +6212,7 @@ clutter_text_set_cursor_visible (ClutterText *self,
       priv->cursor_visible = cursor_visible;
 
       clutter_text_dirty_cache (self);
-      clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+      _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_CURSOR_VISIBLE]);
     }
@@ -4681,13 +6388,17 @@ clutter_text_set_selection_bound (ClutterText *self,
   if (priv->selection_bound != selection_bound)
     {
       gint len = clutter_text_buffer_get_length (get_buffer (self));;
+      ClutterPaintVolume old_volume;
+
+      clutter_text_get_cursor_redraw_volume (self, &old_volume);
 
       if (selection_bound < 0 || selection_bound >= len)
         priv->selection_bound = -1;
       else
         priv->selection_bound = selection_bound;
 
-      clutter_text_queue_redraw (CLUTTER_ACTOR (self));
+      clutter_text_queue_redraw_cursor (self, &old_volume);
+      clutter_paint_volume_free (&old_volume);
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SELECTION_BOUND]);
     }
@@ -4999,6 +6710,9 @@ clutter_text_set_use_markup_internal (ClutterText *self,
           priv->markup_attrs = NULL;
         }
 
+      g_free (priv->markup_source);
+      priv->markup_source = NULL;
+
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_USE_MARKUP]);
     }
 }
@@ -5172,7 +6886,7 @@ clutter_text_set_ellipsize (ClutterText        *self,
 
       clutter_text_dirty_cache (self);
 
-      clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+      _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ELLIPSIZE]);
     }
@@ -5242,7 +6956,7 @@ clutter_text_set_line_wrap (ClutterText *self,
 
       clutter_text_dirty_cache (self);
 
-      clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+      _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_LINE_WRAP]);
     }
@@ -5275,7 +6989,7 @@ clutter_text_set_line_wrap_mode (ClutterText   *self,
 
       clutter_text_dirty_cache (self);
 
-      clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+      _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_LINE_WRAP_MODE]);
     }
@@ -5350,7 +7064,7 @@ clutter_text_set_attributes (ClutterText   *self,
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ATTRIBUTES]);
 
-  clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+  _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (self));
 }
 
 /**
@@ -5403,7 +7117,7 @@ clutter_text_set_line_alignment (ClutterText    *self,
 
       clutter_text_dirty_cache (self);
 
-      clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+      _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_LINE_ALIGNMENT]);
     }
@@ -5460,7 +7174,7 @@ clutter_text_set_use_markup (ClutterText *self,
 
   clutter_text_dirty_cache (self);
 
-  clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+  _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (self));
 }
 
 /**
@@ -5509,7 +7223,7 @@ clutter_text_set_justify (ClutterText *self,
 
       clutter_text_dirty_cache (self);
 
-      clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+      _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_JUSTIFY]);
     }
@@ -5568,6 +7282,7 @@ clutter_text_set_cursor_position (ClutterText *self,
                                   gint         position)
 {
   ClutterTextPrivate *priv;
+  ClutterPaintVolume old_volume;
   gint len;
 
   g_return_if_fail (CLUTTER_IS_TEXT (self));
@@ -5577,6 +7292,8 @@ clutter_text_set_cursor_position (ClutterText *self,
   if (priv->position == position)
     return;
 
+  clutter_text_get_cursor_redraw_volume (self, &old_volume);
+
   len = clutter_text_buffer_get_length (get_buffer (self));
 
   if (position < 0 || position >= len)
@@ -5588,7 +7305,8 @@ clutter_text_set_cursor_position (ClutterText *self,
      time the cursor is moved up or down */
   priv->x_pos = -1;
 
-  clutter_text_queue_redraw (CLUTTER_ACTOR (self));
+  clutter_text_queue_redraw_cursor (self, &old_volume);
+  clutter_paint_volume_free (&old_volume);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_CURSOR_POSITION]);
 }
@@ -5673,8 +7391,9 @@ clutter_text_set_password_char (ClutterText *self,
     {
       priv->password_char = wc;
 
+      clutter_text_clear_password_text (self);
       clutter_text_dirty_cache (self);
-      clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+      _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PASSWORD_CHAR]);
     }
@@ -5935,7 +7654,7 @@ clutter_text_set_single_line_mode (ClutterText *self,
         }
 
       clutter_text_dirty_cache (self);
-      clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+      _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SINGLE_LINE_MODE]);
 
@@ -6025,7 +7744,7 @@ clutter_text_set_preedit_string (ClutterText   *self,
     }
 
   clutter_text_dirty_cache (self);
-  clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+  _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (self));
 }
 
 
@@ -6077,3 +7796,164 @@ clutter_text_get_cursor_rect (ClutterText *self,
 
   *rect = self->priv->cursor_rect;
 }
+
+/**
+ * clutter_text_set_layout_cache_size:
+ * @self: a #ClutterText
+ * @n_layouts: the maximum number of cached layouts
+ *
+ * Sets the maximum number of #PangoLayout<!-- -->s, each created
+ * for a different size, that @self keeps in its cache.
+ *
+ * Actors whose size changes frequently, for instance because it
+ * is being animated, can use a larger cache to avoid shaping the
+ * text again.
+ */
+void
+clutter_text_set_layout_cache_size (ClutterText *self,
+                                    guint        n_layouts)
+{
+  ClutterTextPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_TEXT (self));
+  g_return_if_fail (n_layouts > 0);
+
+  priv = self->priv;
+
+  if (priv->layout_cache_size == n_layouts)
+    return;
+
+  priv->layout_cache_size = n_layouts;
+  layout_cache_trim (self, n_layouts);
+
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_LAYOUT_CACHE_SIZE]);
+}
+
+/**
+ * clutter_text_get_layout_cache_size:
+ * @self: a #ClutterText
+ *
+ * Retrieves the value set using clutter_text_set_layout_cache_size().
+ *
+ * Return value: the maximum number of cached layouts
+ */
+guint
+clutter_text_get_layout_cache_size (ClutterText *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_TEXT (self), N_CACHED_LAYOUTS);
+
+  return self->priv->layout_cache_size;
+}
+
+/**
+ * clutter_text_set_reuse_layouts:
+ * @self: a #ClutterText
+ * @reuse_layouts: whether layouts should be reused
+ *
+ * Sets whether @self should use a cached #PangoLayout created
+ * for a different width, as long as the text would be broken
+ * into the same lines at the requested width.
+ *
+ * This avoids shaping the text again when the width of the
+ * actor changes without affecting its lines, for instance
+ * when the text fits on a single line.
+ */
+void
+clutter_text_set_reuse_layouts (ClutterText *self,
+                                gboolean     reuse_layouts)
+{
+  ClutterTextPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_TEXT (self));
+
+  priv = self->priv;
+
+  reuse_layouts = !!reuse_layouts;
+
+  if (priv->reuse_layouts == reuse_layouts)
+    return;
+
+  priv->reuse_layouts = reuse_layouts;
+
+  /* the lines do not change; the layouts created until now have
+   * been laid out at the exact same width, so there is no need to
+   * drop the cache
+   */
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_REUSE_LAYOUTS]);
+}
+
+/**
+ * clutter_text_get_reuse_layouts:
+ * @self: a #ClutterText
+ *
+ * Retrieves the value set using clutter_text_set_reuse_layouts().
+ *
+ * Return value: %TRUE if layouts with the same lines are reused
+ */
+gboolean
+clutter_text_get_reuse_layouts (ClutterText *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_TEXT (self), FALSE);
+
+  return self->priv->reuse_layouts;
+}
+
+/**
+ * clutter_text_set_deferred_layout:
+ * @self: a #ClutterText
+ * @deferred: whether the layout should be deferred
+ *
+ * Sets whether @self should keep painting its current contents when
+ * they change, and create the layout of the new contents later, after
+ * the frames have been painted.
+ *
+ * This is useful when changing the contents of many #ClutterText actors
+ * at once, for instance when switching the language of the user
+ * interface, as the cost of shaping the text will be spread over
+ * multiple frames.
+ *
+ * See also: #ClutterText:deferred-layout
+ */
+void
+clutter_text_set_deferred_layout (ClutterText *self,
+                                  gboolean     deferred)
+{
+  ClutterTextPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_TEXT (self));
+
+  priv = self->priv;
+
+  deferred = !!deferred;
+
+  if (priv->deferred_layout == deferred)
+    return;
+
+  priv->deferred_layout = deferred;
+
+  /* pending layouts have to be created right away */
+  if (!priv->deferred_layout && priv->layout_pending)
+    {
+      priv->layout_pending = FALSE;
+      clutter_text_dirty_cache (self);
+      _clutter_actor_queue_size_relayout (CLUTTER_ACTOR (self));
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_DEFERRED_LAYOUT]);
+}
+
+/**
+ * clutter_text_get_deferred_layout:
+ * @self: a #ClutterText
+ *
+ * Retrieves the value set using clutter_text_set_deferred_layout().
+ *
+ * Return value: %TRUE if the layout of new contents is deferred
+ */
+gboolean
+clutter_text_get_deferred_layout (ClutterText *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_TEXT (self), FALSE);
+
+  return self->priv->deferred_layout;
+}
@@ -232,6 +232,16 @@ void                  clutter_text_get_layout_offsets   (ClutterText           *
                                                          gint                  *x,
                                                          gint                  *y);
 
+void                  clutter_text_set_layout_cache_size (ClutterText         *self,
+                                                          guint                n_layouts);
+guint                 clutter_text_get_layout_cache_size (ClutterText         *self);
+void                  clutter_text_set_reuse_layouts    (ClutterText          *self,
+                                                         gboolean              reuse_layouts);
+gboolean              clutter_text_get_reuse_layouts    (ClutterText          *self);
+void                  clutter_text_set_deferred_layout  (ClutterText          *self,
+                                                         gboolean              deferred);
+gboolean              clutter_text_get_deferred_layout  (ClutterText          *self);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_TEXT_H__ */
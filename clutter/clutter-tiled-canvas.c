@@ -0,0 +1,976 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2012  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:clutter-tiled-canvas
+ * @Title: ClutterTiledCanvas
+ * @Short_Description: Content for 2D painting on large surfaces
+ * @See_Also: #ClutterCanvas, #ClutterContent
+ *
+ * The #ClutterTiledCanvas class is a #ClutterContent implementation that
+ * allows drawing using the Cairo API on surfaces that are too large to
+ * be kept in memory, or in a single texture, like maps.
+ *
+ * Unlike #ClutterCanvas, a #ClutterTiledCanvas splits its surface into
+ * square tiles, which are drawn lazily, only when they are visible on
+ * the stage. The drawn tiles are kept in a cache until the memory they
+ * use exceeds the #ClutterTiledCanvas:memory-budget; at that point, the
+ * tiles that have not been painted for the longest time are evicted.
+ *
+ * The #ClutterTiledCanvas::draw signal is emitted once for each tile
+ * that needs to be drawn; the Cairo context is translated so that the
+ * handlers can draw using the coordinate space of the whole canvas, and
+ * it is clipped to the area of the tile.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cogl/cogl.h>
+#include <cairo-gobject.h>
+
+#include "clutter-tiled-canvas.h"
+
+#include "clutter-actor-private.h"
+#include "clutter-backend.h"
+#include "clutter-cairo.h"
+#include "clutter-color.h"
+#include "clutter-content-private.h"
+#include "clutter-debug.h"
+#include "clutter-marshal.h"
+#include "clutter-paint-node.h"
+#include "clutter-paint-nodes.h"
+#include "clutter-paint-volume-private.h"
+#include "clutter-private.h"
+#include "clutter-stage-private.h"
+
+#define DEFAULT_TILE_SIZE       256
+#define DEFAULT_MEMORY_BUDGET   (64 * 1024 * 1024)
+
+typedef struct _Tile
+{
+  int column;
+  int row;
+
+  CoglTexture *texture;
+
+  /* the link inside the LRU queue */
+  GList link;
+
+  /* the frame in which the tile was last painted */
+  guint last_paint;
+} Tile;
+
+struct _ClutterTiledCanvasPrivate
+{
+  int width;
+  int height;
+  int tile_size;
+
+  guint memory_budget;
+  guint memory_used;
+
+  /* column + row * n_columns -> Tile */
+  GHashTable *tiles;
+
+  /* the most recently painted tiles are at the head */
+  GQueue lru;
+
+  guint paint_serial;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_WIDTH,
+  PROP_HEIGHT,
+  PROP_TILE_SIZE,
+  PROP_MEMORY_BUDGET,
+
+  LAST_PROP
+};
+
+static GParamSpec *obj_props[LAST_PROP] = { NULL, };
+
+enum
+{
+  DRAW,
+
+  LAST_SIGNAL
+};
+
+static guint canvas_signals[LAST_SIGNAL] = { 0, };
+
+static void clutter_content_iface_init (ClutterContentIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (ClutterTiledCanvas, clutter_tiled_canvas, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_CONTENT,
+                                                clutter_content_iface_init))
+
+static void
+clutter_tiled_canvas_draw_marshaller (GClosure     *closure,
+                                      GValue       *return_value,
+                                      guint         n_param_values,
+                                      const GValue *param_values,
+                                      gpointer      invocation_hint,
+                                      gpointer      marshal_data)
+{
+  cairo_t *cr = g_value_get_boxed (&param_values[1]);
+
+  cairo_save (cr);
+
+  _clutter_marshal_BOOLEAN__BOXED_BOXED (closure,
+                                         return_value,
+                                         n_param_values,
+                                         param_values,
+                                         invocation_hint,
+                                         marshal_data);
+
+  cairo_restore (cr);
+}
+
+static void
+tile_free (gpointer data)
+{
+  Tile *tile = data;
+
+  if (tile->texture != NULL)
+    cogl_object_unref (tile->texture);
+
+  g_slice_free (Tile, tile);
+}
+
+static inline int
+clutter_tiled_canvas_get_n_columns (ClutterTiledCanvas *self)
+{
+  ClutterTiledCanvasPrivate *priv = self->priv;
+
+  return (priv->width + priv->tile_size - 1) / priv->tile_size;
+}
+
+static inline int
+clutter_tiled_canvas_get_n_rows (ClutterTiledCanvas *self)
+{
+  ClutterTiledCanvasPrivate *priv = self->priv;
+
+  return (priv->height + priv->tile_size - 1) / priv->tile_size;
+}
+
+static inline guint
+tile_get_size (ClutterTiledCanvas *self)
+{
+  return self->priv->tile_size * self->priv->tile_size * 4;
+}
+
+static void
+clutter_tiled_canvas_remove_tile (ClutterTiledCanvas *self,
+                                  Tile               *tile)
+{
+  ClutterTiledCanvasPrivate *priv = self->priv;
+  guint key;
+
+  g_queue_unlink (&priv->lru, &tile->link);
+  priv->memory_used -= tile_get_size (self);
+
+  key = tile->column + tile->row * clutter_tiled_canvas_get_n_columns (self);
+  g_hash_table_remove (priv->tiles, GUINT_TO_POINTER (key));
+}
+
+static void
+clutter_tiled_canvas_clear_tiles (ClutterTiledCanvas *self)
+{
+  ClutterTiledCanvasPrivate *priv = self->priv;
+
+  g_queue_init (&priv->lru);
+  g_hash_table_remove_all (priv->tiles);
+  priv->memory_used = 0;
+}
+
+/* evicts the least recently painted tiles until we are within the
+ * memory budget; the tiles painted in the current frame are never
+ * evicted, even if that means going over the budget
+ */
+static void
+clutter_tiled_canvas_enforce_budget (ClutterTiledCanvas *self)
+{
+  ClutterTiledCanvasPrivate *priv = self->priv;
+
+  while (priv->memory_used > priv->memory_budget &&
+         priv->lru.tail != NULL)
+    {
+      Tile *tile = priv->lru.tail->data;
+
+      if (tile->last_paint == priv->paint_serial)
+        break;
+
+      CLUTTER_NOTE (PAINT, "Evicting tile %d,%d of <ClutterTiledCanvas>[%p]",
+                    tile->column, tile->row,
+                    self);
+
+      clutter_tiled_canvas_remove_tile (self, tile);
+    }
+}
+
+static void
+clutter_tiled_canvas_get_tile_rect (ClutterTiledCanvas    *self,
+                                    int                    column,
+                                    int                    row,
+                                    cairo_rectangle_int_t *rect)
+{
+  ClutterTiledCanvasPrivate *priv = self->priv;
+
+  rect->x = column * priv->tile_size;
+  rect->y = row * priv->tile_size;
+  rect->width = MIN (priv->tile_size, priv->width - rect->x);
+  rect->height = MIN (priv->tile_size, priv->height - rect->y);
+}
+
+static CoglTexture *
+clutter_tiled_canvas_draw_tile (ClutterTiledCanvas          *self,
+                                const cairo_rectangle_int_t *rect)
+{
+  cairo_surface_t *surface;
+  CoglTexture *texture;
+  gboolean res;
+  cairo_t *cr;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                        rect->width,
+                                        rect->height);
+
+  cr = cairo_create (surface);
+
+  /* draw handlers use the coordinate space of the whole canvas */
+  cairo_translate (cr, -rect->x, -rect->y);
+  cairo_rectangle (cr, rect->x, rect->y, rect->width, rect->height);
+  cairo_clip (cr);
+
+  g_signal_emit (self, canvas_signals[DRAW], 0, cr, rect, &res);
+
+#ifdef CLUTTER_ENABLE_DEBUG
+  if (_clutter_diagnostic_enabled () && cairo_status (cr))
+    {
+      g_warning ("Drawing failed for <ClutterTiledCanvas>[%p]: %s",
+                 self,
+                 cairo_status_to_string (cairo_status (cr)));
+    }
+#endif
+
+  cairo_destroy (cr);
+
+  cairo_surface_flush (surface);
+
+  texture = cogl_texture_new_from_data (rect->width, rect->height,
+                                        COGL_TEXTURE_NO_SLICING,
+                                        CLUTTER_CAIRO_FORMAT_ARGB32,
+                                        COGL_PIXEL_FORMAT_ANY,
+                                        cairo_image_surface_get_stride (surface),
+                                        cairo_image_surface_get_data (surface));
+
+  cairo_surface_destroy (surface);
+
+  return texture;
+}
+
+static Tile *
+clutter_tiled_canvas_ensure_tile (ClutterTiledCanvas *self,
+                                  int                 column,
+                                  int                 row)
+{
+  ClutterTiledCanvasPrivate *priv = self->priv;
+  guint key;
+  Tile *tile;
+
+  key = column + row * clutter_tiled_canvas_get_n_columns (self);
+
+  tile = g_hash_table_lookup (priv->tiles, GUINT_TO_POINTER (key));
+  if (tile != NULL)
+    {
+      /* move to the head of the LRU */
+      g_queue_unlink (&priv->lru, &tile->link);
+    }
+  else
+    {
+      cairo_rectangle_int_t rect;
+
+      clutter_tiled_canvas_get_tile_rect (self, column, row, &rect);
+
+      tile = g_slice_new0 (Tile);
+      tile->column = column;
+      tile->row = row;
+      tile->link.data = tile;
+      tile->texture = clutter_tiled_canvas_draw_tile (self, &rect);
+
+      g_hash_table_insert (priv->tiles, GUINT_TO_POINTER (key), tile);
+      priv->memory_used += tile_get_size (self);
+    }
+
+  g_queue_push_head_link (&priv->lru, &tile->link);
+  tile->last_paint = priv->paint_serial;
+
+  return tile;
+}
+
+typedef struct
+{
+  ClutterTiledCanvas *canvas;
+  ClutterActor *actor;
+  ClutterPaintNode *root;
+
+  ClutterColor color;
+  ClutterScalingFilter min_filter;
+  ClutterScalingFilter mag_filter;
+
+  /* the content box, and the scale from canvas to actor coordinates */
+  ClutterActorBox box;
+  float scale_x;
+  float scale_y;
+
+  /* NULL if we cannot cull */
+  const ClutterPlane *planes;
+  CoglMatrix modelview;
+} TilePaintData;
+
+static ClutterCullResult
+tile_paint_data_cull (TilePaintData *data,
+                      int            column,
+                      int            row,
+                      int            n_columns,
+                      int            n_rows)
+{
+  ClutterTiledCanvasPrivate *priv = data->canvas->priv;
+  ClutterPaintVolume pv;
+  ClutterCullResult res;
+  ClutterVertex origin;
+  float x2, y2;
+
+  if (data->planes == NULL)
+    return CLUTTER_CULL_RESULT_IN;
+
+  origin.x = data->box.x1 + column * priv->tile_size * data->scale_x;
+  origin.y = data->box.y1 + row * priv->tile_size * data->scale_y;
+  origin.z = 0.f;
+
+  x2 = MIN ((column + n_columns) * priv->tile_size, priv->width);
+  y2 = MIN ((row + n_rows) * priv->tile_size, priv->height);
+
+  _clutter_paint_volume_init_static (&pv, data->actor);
+  clutter_paint_volume_set_origin (&pv, &origin);
+  clutter_paint_volume_set_width (&pv,
+                                  data->box.x1 + x2 * data->scale_x - origin.x);
+  clutter_paint_volume_set_height (&pv,
+                                   data->box.y1 + y2 * data->scale_y - origin.y);
+
+  _clutter_paint_volume_transform (&pv, &data->modelview);
+
+  res = _clutter_paint_volume_cull (&pv, data->planes);
+
+  clutter_paint_volume_free (&pv);
+
+  return res;
+}
+
+/* recursively subdivides the range of tiles, so that we only test
+ * the tiles on the edges of the visible area
+ */
+static void
+tile_paint_data_paint_range (TilePaintData *data,
+                             int            column,
+                             int            row,
+                             int            n_columns,
+                             int            n_rows,
+                             gboolean       culled)
+{
+  int i, j;
+
+  if (!culled)
+    {
+      ClutterCullResult res;
+
+      res = tile_paint_data_cull (data, column, row, n_columns, n_rows);
+      if (res == CLUTTER_CULL_RESULT_OUT)
+        return;
+
+      if (res == CLUTTER_CULL_RESULT_PARTIAL &&
+          (n_columns > 1 || n_rows > 1))
+        {
+          int half_columns = MAX (n_columns / 2, 1);
+          int half_rows = MAX (n_rows / 2, 1);
+
+          tile_paint_data_paint_range (data,
+                                       column, row,
+                                       half_columns, half_rows,
+                                       FALSE);
+
+          if (n_columns > half_columns)
+            tile_paint_data_paint_range (data,
+                                         column + half_columns, row,
+                                         n_columns - half_columns, half_rows,
+                                         FALSE);
+
+          if (n_rows > half_rows)
+            tile_paint_data_paint_range (data,
+                                         column, row + half_rows,
+                                         half_columns, n_rows - half_rows,
+                                         FALSE);
+
+          if (n_columns > half_columns && n_rows > half_rows)
+            tile_paint_data_paint_range (data,
+                                         column + half_columns,
+                                         row + half_rows,
+                                         n_columns - half_columns,
+                                         n_rows - half_rows,
+                                         FALSE);
+
+          return;
+        }
+    }
+
+  for (j = row; j < row + n_rows; j++)
+    {
+      for (i = column; i < column + n_columns; i++)
+        {
+          cairo_rectangle_int_t rect;
+          ClutterActorBox tile_box;
+          ClutterPaintNode *node;
+          Tile *tile;
+
+          tile = clutter_tiled_canvas_ensure_tile (data->canvas, i, j);
+          if (tile->texture == NULL)
+            continue;
+
+          clutter_tiled_canvas_get_tile_rect (data->canvas, i, j, &rect);
+
+          tile_box.x1 = data->box.x1 + rect.x * data->scale_x;
+          tile_box.y1 = data->box.y1 + rect.y * data->scale_y;
+          tile_box.x2 = data->box.x1 + (rect.x + rect.width) * data->scale_x;
+          tile_box.y2 = data->box.y1 + (rect.y + rect.height) * data->scale_y;
+
+          node = clutter_texture_node_new (tile->texture,
+                                           &data->color,
+                                           data->min_filter,
+                                           data->mag_filter);
+          clutter_paint_node_set_name (node, "TiledCanvas");
+          clutter_paint_node_add_rectangle (node, &tile_box);
+          clutter_paint_node_add_child (data->root, node);
+          clutter_paint_node_unref (node);
+        }
+    }
+}
+
+static void
+clutter_tiled_canvas_paint_content (ClutterContent   *content,
+                                    ClutterActor     *actor,
+                                    ClutterPaintNode *root)
+{
+  ClutterTiledCanvas *self = CLUTTER_TILED_CANVAS (content);
+  ClutterTiledCanvasPrivate *priv = self->priv;
+  TilePaintData data;
+  ClutterActor *stage;
+  guint8 paint_opacity;
+
+  if (priv->width <= 0 || priv->height <= 0)
+    return;
+
+  data.canvas = self;
+  data.actor = actor;
+  data.root = root;
+
+  clutter_actor_get_content_box (actor, &data.box);
+  if (clutter_actor_box_get_width (&data.box) <= 0.f ||
+      clutter_actor_box_get_height (&data.box) <= 0.f)
+    return;
+
+  data.scale_x = clutter_actor_box_get_width (&data.box) / priv->width;
+  data.scale_y = clutter_actor_box_get_height (&data.box) / priv->height;
+
+  paint_opacity = clutter_actor_get_paint_opacity (actor);
+  data.color.red = paint_opacity;
+  data.color.green = paint_opacity;
+  data.color.blue = paint_opacity;
+  data.color.alpha = paint_opacity;
+
+  clutter_actor_get_content_scaling_filters (actor,
+                                             &data.min_filter,
+                                             &data.mag_filter);
+
+  /* we can only cull against the stage clip when painting on the
+   * stage; offscreen redirections paint all the tiles
+   */
+  data.planes = NULL;
+  stage = _clutter_actor_get_stage_internal (actor);
+  if (stage != NULL &&
+      cogl_get_draw_framebuffer () ==
+      _clutter_stage_get_active_framebuffer (CLUTTER_STAGE (stage)))
+    {
+      data.planes = _clutter_stage_get_clip (CLUTTER_STAGE (stage));
+      cogl_get_modelview_matrix (&data.modelview);
+    }
+
+  priv->paint_serial += 1;
+
+  tile_paint_data_paint_range (&data,
+                               0, 0,
+                               clutter_tiled_canvas_get_n_columns (self),
+                               clutter_tiled_canvas_get_n_rows (self),
+                               FALSE);
+
+  clutter_tiled_canvas_enforce_budget (self);
+}
+
+static void
+clutter_tiled_canvas_invalidate (ClutterContent *content)
+{
+  clutter_tiled_canvas_clear_tiles (CLUTTER_TILED_CANVAS (content));
+}
+
+static gboolean
+clutter_tiled_canvas_get_preferred_size (ClutterContent *content,
+                                         gfloat         *width,
+                                         gfloat         *height)
+{
+  ClutterTiledCanvasPrivate *priv = CLUTTER_TILED_CANVAS (content)->priv;
+
+  if (priv->width < 0 || priv->height < 0)
+    return FALSE;
+
+  if (width != NULL)
+    *width = priv->width;
+
+  if (height != NULL)
+    *height = priv->height;
+
+  return TRUE;
+}
+
+static void
+clutter_content_iface_init (ClutterContentIface *iface)
+{
+  iface->invalidate = clutter_tiled_canvas_invalidate;
+  iface->paint_content = clutter_tiled_canvas_paint_content;
+  iface->get_preferred_size = clutter_tiled_canvas_get_preferred_size;
+}
+
+static void
+clutter_tiled_canvas_finalize (GObject *gobject)
+{
+  ClutterTiledCanvasPrivate *priv = CLUTTER_TILED_CANVAS (gobject)->priv;
+
+  g_hash_table_unref (priv->tiles);
+
+  G_OBJECT_CLASS (clutter_tiled_canvas_parent_class)->finalize (gobject);
+}
+
+static void
+clutter_tiled_canvas_set_property (GObject      *gobject,
+                                   guint         prop_id,
+                                   const GValue *value,
+                                   GParamSpec   *pspec)
+{
+  ClutterTiledCanvas *self = CLUTTER_TILED_CANVAS (gobject);
+  ClutterTiledCanvasPrivate *priv = self->priv;
+
+  switch (prop_id)
+    {
+    case PROP_WIDTH:
+      if (priv->width != g_value_get_int (value))
+        {
+          priv->width = g_value_get_int (value);
+          clutter_content_invalidate (CLUTTER_CONTENT (gobject));
+        }
+      break;
+
+    case PROP_HEIGHT:
+      if (priv->height != g_value_get_int (value))
+        {
+          priv->height = g_value_get_int (value);
+          clutter_content_invalidate (CLUTTER_CONTENT (gobject));
+        }
+      break;
+
+    case PROP_TILE_SIZE:
+      clutter_tiled_canvas_set_tile_size (self, g_value_get_int (value));
+      break;
+
+    case PROP_MEMORY_BUDGET:
+      clutter_tiled_canvas_set_memory_budget (self, g_value_get_uint (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_tiled_canvas_get_property (GObject    *gobject,
+                                   guint       prop_id,
+                                   GValue     *value,
+                                   GParamSpec *pspec)
+{
+  ClutterTiledCanvasPrivate *priv = CLUTTER_TILED_CANVAS (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_WIDTH:
+      g_value_set_int (value, priv->width);
+      break;
+
+    case PROP_HEIGHT:
+      g_value_set_int (value, priv->height);
+      break;
+
+    case PROP_TILE_SIZE:
+      g_value_set_int (value, priv->tile_size);
+      break;
+
+    case PROP_MEMORY_BUDGET:
+      g_value_set_uint (value, priv->memory_budget);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_tiled_canvas_class_init (ClutterTiledCanvasClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (ClutterTiledCanvasPrivate));
+
+  /**
+   * ClutterTiledCanvas:width:
+   *
+   * The width of the canvas.
+   */
+  obj_props[PROP_WIDTH] =
+    g_param_spec_int ("width",
+                      P_("Width"),
+                      P_("The width of the canvas"),
+                      -1, G_MAXINT,
+                      -1,
+                      G_PARAM_READWRITE |
+                      G_PARAM_STATIC_STRINGS);
+
+  /**
+   * ClutterTiledCanvas:height:
+   *
+   * The height of the canvas.
+   */
+  obj_props[PROP_HEIGHT] =
+    g_param_spec_int ("height",
+                      P_("Height"),
+                      P_("The height of the canvas"),
+                      -1, G_MAXINT,
+                      -1,
+                      G_PARAM_READWRITE |
+                      G_PARAM_STATIC_STRINGS);
+
+  /**
+   * ClutterTiledCanvas:tile-size:
+   *
+   * The size of the side of each tile, in pixels.
+   */
+  obj_props[PROP_TILE_SIZE] =
+    g_param_spec_int ("tile-size",
+                      P_("Tile Size"),
+                      P_("The size of each tile of the canvas"),
+                      16, 4096,
+                      DEFAULT_TILE_SIZE,
+                      G_PARAM_READWRITE |
+                      G_PARAM_STATIC_STRINGS);
+
+  /**
+   * ClutterTiledCanvas:memory-budget:
+   *
+   * The amount of texture memory, in bytes, that the tiles of
+   * the canvas can use before being evicted.
+   */
+  obj_props[PROP_MEMORY_BUDGET] =
+    g_param_spec_uint ("memory-budget",
+                       P_("Memory Budget"),
+                       P_("The amount of memory used to cache the tiles"),
+                       0, G_MAXUINT,
+                       DEFAULT_MEMORY_BUDGET,
+                       G_PARAM_READWRITE |
+                       G_PARAM_STATIC_STRINGS);
+
+  /**
+   * ClutterTiledCanvas::draw:
+   * @canvas: the #ClutterTiledCanvas that emitted the signal
+   * @cr: the Cairo context used to draw
+   * @tile: the area of the @canvas being drawn
+   *
+   * The #ClutterTiledCanvas::draw signal is emitted each time a tile
+   * of the canvas needs to be drawn.
+   *
+   * The @cr context uses the coordinate space of the whole @canvas,
+   * and it is clipped to @tile.
+   *
+   * It is safe to connect multiple handlers to this signal: each
+   * handler invocation will be automatically protected by cairo_save()
+   * and cairo_restore() pairs.
+   *
+   * Return value: %TRUE if the signal emission should stop, and
+   *   %FALSE otherwise
+   */
+  canvas_signals[DRAW] =
+    g_signal_new (I_("draw"),
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE,
+                  G_STRUCT_OFFSET (ClutterTiledCanvasClass, draw),
+                  _clutter_boolean_handled_accumulator, NULL,
+                  clutter_tiled_canvas_draw_marshaller,
+                  G_TYPE_BOOLEAN, 2,
+                  CAIRO_GOBJECT_TYPE_CONTEXT,
+                  CAIRO_GOBJECT_TYPE_RECTANGLE_INT | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+  gobject_class->set_property = clutter_tiled_canvas_set_property;
+  gobject_class->get_property = clutter_tiled_canvas_get_property;
+  gobject_class->finalize = clutter_tiled_canvas_finalize;
+
+  g_object_class_install_properties (gobject_class, LAST_PROP, obj_props);
+}
+
+static void
+clutter_tiled_canvas_init (ClutterTiledCanvas *self)
+{
+  ClutterTiledCanvasPrivate *priv;
+
+  self->priv = priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
+                                                   CLUTTER_TYPE_TILED_CANVAS,
+                                                   ClutterTiledCanvasPrivate);
+
+  priv->width = -1;
+  priv->height = -1;
+  priv->tile_size = DEFAULT_TILE_SIZE;
+  priv->memory_budget = DEFAULT_MEMORY_BUDGET;
+
+  priv->tiles = g_hash_table_new_full (NULL, NULL, NULL, tile_free);
+  g_queue_init (&priv->lru);
+
+  /* the visible tiles depend on the position of the actors on the
+   * stage, and not only on the state of the content
+   */
+  _clutter_content_set_view_dependent (CLUTTER_CONTENT (self), TRUE);
+}
+
+/**
+ * clutter_tiled_canvas_new:
+ *
+ * Creates a new instance of #ClutterTiledCanvas.
+ *
+ * You should call clutter_tiled_canvas_set_size() to set the size
+ * of the canvas.
+ *
+ * Return value: (transfer full): The newly allocated instance of
+ *   #ClutterTiledCanvas. Use g_object_unref() when done.
+ */
+ClutterContent *
+clutter_tiled_canvas_new (void)
+{
+  return g_object_new (CLUTTER_TYPE_TILED_CANVAS, NULL);
+}
+
+/**
+ * clutter_tiled_canvas_set_size:
+ * @canvas: a #ClutterTiledCanvas
+ * @width: the width of the canvas, in pixels
+ * @height: the height of the canvas, in pixels
+ *
+ * Sets the size of the @canvas.
+ *
+ * This function will cause the @canvas to be invalidated.
+ */
+void
+clutter_tiled_canvas_set_size (ClutterTiledCanvas *canvas,
+                               int                 width,
+                               int                 height)
+{
+  GObject *obj;
+  gboolean changed = FALSE;
+
+  g_return_if_fail (CLUTTER_IS_TILED_CANVAS (canvas));
+  g_return_if_fail (width >= -1 && height >= -1);
+
+  obj = G_OBJECT (canvas);
+
+  g_object_freeze_notify (obj);
+
+  if (canvas->priv->width != width)
+    {
+      canvas->priv->width = width;
+      changed = TRUE;
+
+      g_object_notify_by_pspec (obj, obj_props[PROP_WIDTH]);
+    }
+
+  if (canvas->priv->height != height)
+    {
+      canvas->priv->height = height;
+      changed = TRUE;
+
+      g_object_notify_by_pspec (obj, obj_props[PROP_HEIGHT]);
+    }
+
+  if (changed)
+    clutter_content_invalidate (CLUTTER_CONTENT (canvas));
+
+  g_object_thaw_notify (obj);
+}
+
+/**
+ * clutter_tiled_canvas_set_tile_size:
+ * @canvas: a #ClutterTiledCanvas
+ * @tile_size: the size of the side of each tile, in pixels
+ *
+ * Sets the size of the tiles of @canvas.
+ *
+ * Smaller tiles bound the cost of drawing the areas of the @canvas
+ * that become visible, at the price of more draw calls.
+ *
+ * This function will cause the @canvas to be invalidated.
+ */
+void
+clutter_tiled_canvas_set_tile_size (ClutterTiledCanvas *canvas,
+                                    int                 tile_size)
+{
+  g_return_if_fail (CLUTTER_IS_TILED_CANVAS (canvas));
+  g_return_if_fail (tile_size >= 16 && tile_size <= 4096);
+
+  if (canvas->priv->tile_size == tile_size)
+    return;
+
+  /* the tiles are keyed by their position */
+  clutter_tiled_canvas_clear_tiles (canvas);
+
+  canvas->priv->tile_size = tile_size;
+
+  clutter_content_invalidate (CLUTTER_CONTENT (canvas));
+
+  g_object_notify_by_pspec (G_OBJECT (canvas), obj_props[PROP_TILE_SIZE]);
+}
+
+/**
+ * clutter_tiled_canvas_get_tile_size:
+ * @canvas: a #ClutterTiledCanvas
+ *
+ * Retrieves the size set using clutter_tiled_canvas_set_tile_size().
+ *
+ * Return value: the size of the tiles, in pixels
+ */
+int
+clutter_tiled_canvas_get_tile_size (ClutterTiledCanvas *canvas)
+{
+  g_return_val_if_fail (CLUTTER_IS_TILED_CANVAS (canvas), DEFAULT_TILE_SIZE);
+
+  return canvas->priv->tile_size;
+}
+
+/**
+ * clutter_tiled_canvas_set_memory_budget:
+ * @canvas: a #ClutterTiledCanvas
+ * @budget: the amount of memory, in bytes
+ *
+ * Sets the amount of texture memory that the tiles of @canvas can
+ * use. Once the budget is exceeded, the tiles that have not been
+ * painted for the longest time are evicted from the cache.
+ *
+ * The tiles visible in a frame are never evicted, so the budget can
+ * be exceeded if the visible area requires it.
+ */
+void
+clutter_tiled_canvas_set_memory_budget (ClutterTiledCanvas *canvas,
+                                        guint               budget)
+{
+  g_return_if_fail (CLUTTER_IS_TILED_CANVAS (canvas));
+
+  if (canvas->priv->memory_budget == budget)
+    return;
+
+  canvas->priv->memory_budget = budget;
+
+  clutter_tiled_canvas_enforce_budget (canvas);
+
+  g_object_notify_by_pspec (G_OBJECT (canvas), obj_props[PROP_MEMORY_BUDGET]);
+}
+
+/**
+ * clutter_tiled_canvas_get_memory_budget:
+ * @canvas: a #ClutterTiledCanvas
+ *
+ * Retrieves the amount set using clutter_tiled_canvas_set_memory_budget().
+ *
+ * Return value: the memory budget, in bytes
+ */
+guint
+clutter_tiled_canvas_get_memory_budget (ClutterTiledCanvas *canvas)
+{
+  g_return_val_if_fail (CLUTTER_IS_TILED_CANVAS (canvas), 0);
+
+  return canvas->priv->memory_budget;
+}
+
+/**
+ * clutter_tiled_canvas_invalidate_rect:
+ * @canvas: a #ClutterTiledCanvas
+ * @rect: the area of the @canvas to redraw, in pixels
+ *
+ * Invalidates the tiles of @canvas that intersect @rect; the tiles
+ * will be drawn again the next time they are visible.
+ */
+void
+clutter_tiled_canvas_invalidate_rect (ClutterTiledCanvas          *canvas,
+                                      const cairo_rectangle_int_t *rect)
+{
+  ClutterTiledCanvasPrivate *priv;
+  GList *l, *next;
+
+  g_return_if_fail (CLUTTER_IS_TILED_CANVAS (canvas));
+  g_return_if_fail (rect != NULL);
+
+  priv = canvas->priv;
+
+  for (l = priv->lru.head; l != NULL; l = next)
+    {
+      Tile *tile = l->data;
+      cairo_rectangle_int_t tile_rect;
+
+      next = l->next;
+
+      clutter_tiled_canvas_get_tile_rect (canvas,
+                                          tile->column, tile->row,
+                                          &tile_rect);
+
+      if (tile_rect.x < rect->x + rect->width &&
+          rect->x < tile_rect.x + tile_rect.width &&
+          tile_rect.y < rect->y + rect->height &&
+          rect->y < tile_rect.y + tile_rect.height)
+        clutter_tiled_canvas_remove_tile (canvas, tile);
+    }
+
+  _clutter_content_queue_redraw (CLUTTER_CONTENT (canvas));
+}
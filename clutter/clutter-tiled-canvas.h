@@ -0,0 +1,98 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2012  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__CLUTTER_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <clutter/clutter.h> can be included directly."
+#endif
+
+#ifndef __CLUTTER_TILED_CANVAS_H__
+#define __CLUTTER_TILED_CANVAS_H__
+
+#include <clutter/clutter-types.h>
+
+G_BEGIN_DECLS
+
+#define CLUTTER_TYPE_TILED_CANVAS               (clutter_tiled_canvas_get_type ())
+#define CLUTTER_TILED_CANVAS(obj)               (G_TYPE_CHECK_INSTANCE_CAST ((obj), CLUTTER_TYPE_TILED_CANVAS, ClutterTiledCanvas))
+#define CLUTTER_IS_TILED_CANVAS(obj)            (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CLUTTER_TYPE_TILED_CANVAS))
+#define CLUTTER_TILED_CANVAS_CLASS(klass)       (G_TYPE_CHECK_CLASS_CAST ((klass), CLUTTER_TYPE_TILED_CANVAS, ClutterTiledCanvasClass))
+#define CLUTTER_IS_TILED_CANVAS_CLASS(klass)    (G_TYPE_CHECK_CLASS_TYPE ((klass), CLUTTER_TYPE_TILED_CANVAS))
+#define CLUTTER_TILED_CANVAS_GET_CLASS(obj)     (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_TILED_CANVAS, ClutterTiledCanvasClass))
+
+typedef struct _ClutterTiledCanvas              ClutterTiledCanvas;
+typedef struct _ClutterTiledCanvasPrivate       ClutterTiledCanvasPrivate;
+typedef struct _ClutterTiledCanvasClass         ClutterTiledCanvasClass;
+
+/**
+ * ClutterTiledCanvas:
+ *
+ * The <structname>ClutterTiledCanvas</structname> structure contains
+ * private data and should only be accessed using the provided
+ * API.
+ */
+struct _ClutterTiledCanvas
+{
+  /*< private >*/
+  GObject parent_instance;
+
+  ClutterTiledCanvasPrivate *priv;
+};
+
+/**
+ * ClutterTiledCanvasClass:
+ * @draw: class handler for the #ClutterTiledCanvas::draw signal
+ *
+ * The <structname>ClutterTiledCanvasClass</structname> structure contains
+ * private data.
+ */
+struct _ClutterTiledCanvasClass
+{
+  /*< private >*/
+  GObjectClass parent_class;
+
+  /*< public >*/
+  gboolean (* draw) (ClutterTiledCanvas          *canvas,
+                     cairo_t                     *cr,
+                     const cairo_rectangle_int_t *tile);
+
+  /*< private >*/
+  gpointer _padding[16];
+};
+
+GType clutter_tiled_canvas_get_type (void) G_GNUC_CONST;
+
+ClutterContent *        clutter_tiled_canvas_new                (void);
+
+void                    clutter_tiled_canvas_set_size           (ClutterTiledCanvas          *canvas,
+                                                                 int                          width,
+                                                                 int                          height);
+void                    clutter_tiled_canvas_set_tile_size      (ClutterTiledCanvas          *canvas,
+                                                                 int                          tile_size);
+int                     clutter_tiled_canvas_get_tile_size      (ClutterTiledCanvas          *canvas);
+void                    clutter_tiled_canvas_set_memory_budget  (ClutterTiledCanvas          *canvas,
+                                                                 guint                        budget);
+guint                   clutter_tiled_canvas_get_memory_budget  (ClutterTiledCanvas          *canvas);
+void                    clutter_tiled_canvas_invalidate_rect    (ClutterTiledCanvas          *canvas,
+                                                                 const cairo_rectangle_int_t *rect);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_TILED_CANVAS_H__ */
@@ -134,6 +134,11 @@ struct _ClutterTimelinePrivate
 
   GHashTable *markers_by_name;
 
+  /* the same markers, sorted by their time; relative markers move
+   * when the duration changes, so the array is sorted again lazily
+   */
+  GPtrArray *markers_by_time;
+
   /* Time we last advanced the elapsed time and showed a frame */
   gint64 last_frame_time;
 
@@ -156,6 +161,12 @@ struct _ClutterTimelinePrivate
   ClutterPoint cb_1;
   ClutterPoint cb_2;
 
+  /* the samples of the cubic-bezier() curve, with :sampled-progress */
+  gfloat *cb_table;
+
+  /* the coarsest interval between updates, in milliseconds, or 0 */
+  guint update_interval;
+
   guint is_playing         : 1;
 
   /* If we've just started playing and haven't yet gotten
@@ -163,6 +174,8 @@ struct _ClutterTimelinePrivate
    */
   guint waiting_first_tick : 1;
   guint auto_reverse       : 1;
+  guint sampled_progress   : 1;
+  guint markers_dirty      : 1;
 };
 
 typedef struct {
@@ -174,6 +187,11 @@ typedef struct {
     gdouble progress;
   } data;
 
+  /* the time of the marker for the current duration of the timeline,
+   * updated when markers_by_time is sorted
+   */
+  gint msecs;
+
   guint is_relative : 1;
 } TimelineMarker;
 
@@ -187,6 +205,8 @@ enum
   PROP_AUTO_REVERSE,
   PROP_REPEAT_COUNT,
   PROP_PROGRESS_MODE,
+  PROP_SAMPLED_PROGRESS,
+  PROP_UPDATE_INTERVAL,
 
   PROP_LAST
 };
@@ -207,6 +227,11 @@ enum
 
 static guint timeline_signals[LAST_SIGNAL] = { 0, };
 
+static gdouble clutter_timeline_progress_func (ClutterTimeline *timeline,
+                                               gdouble          elapsed,
+                                               gdouble          duration,
+                                               gpointer         user_data);
+
 static TimelineMarker *
 timeline_marker_new_time (const gchar *name,
                           guint        msecs)
@@ -289,6 +314,12 @@ clutter_timeline_add_marker_internal (ClutterTimeline *timeline,
     }
 
   g_hash_table_insert (priv->markers_by_name, marker->name, marker);
+
+  if (G_UNLIKELY (priv->markers_by_time == NULL))
+    priv->markers_by_time = g_ptr_array_new ();
+
+  g_ptr_array_add (priv->markers_by_time, marker);
+  priv->markers_dirty = TRUE;
 }
 
 /* Scriptable */
@@ -451,6 +482,14 @@ clutter_timeline_set_property (GObject      *object,
       clutter_timeline_set_progress_mode (timeline, g_value_get_enum (value));
       break;
 
+    case PROP_SAMPLED_PROGRESS:
+      clutter_timeline_set_sampled_progress (timeline, g_value_get_boolean (value));
+      break;
+
+    case PROP_UPDATE_INTERVAL:
+      clutter_timeline_set_update_interval (timeline, g_value_get_uint (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -492,6 +531,14 @@ clutter_timeline_get_property (GObject    *object,
       g_value_set_enum (value, priv->progress_mode);
       break;
 
+    case PROP_SAMPLED_PROGRESS:
+      g_value_set_boolean (value, priv->sampled_progress);
+      break;
+
+    case PROP_UPDATE_INTERVAL:
+      g_value_set_uint (value, priv->update_interval);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -505,9 +552,14 @@ clutter_timeline_finalize (GObject *object)
   ClutterTimelinePrivate *priv = self->priv;
   ClutterMasterClock *master_clock;
 
+  if (priv->markers_by_time)
+    g_ptr_array_free (priv->markers_by_time, TRUE);
+
   if (priv->markers_by_name)
     g_hash_table_destroy (priv->markers_by_name);
 
+  g_free (priv->cb_table);
+
   if (priv->is_playing)
     {
       master_clock = _clutter_master_clock_get_default ();
@@ -647,6 +699,38 @@ clutter_timeline_class_init (ClutterTimelineClass *klass)
                        CLUTTER_LINEAR,
                        CLUTTER_PARAM_READWRITE);
 
+  /**
+   * ClutterTimeline:sampled-progress:
+   *
+   * Whether the progress should be computed from a table of samples
+   * of the easing function, instead of evaluating the function on
+   * every frame.
+   *
+   * See clutter_timeline_set_sampled_progress().
+   */
+  obj_props[PROP_SAMPLED_PROGRESS] =
+    g_param_spec_boolean ("sampled-progress",
+                          P_("Sampled Progress"),
+                          P_("Whether the progress should be computed from samples of the easing function"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
+  /**
+   * ClutterTimeline:update-interval:
+   *
+   * The interval at which the timeline needs to be updated, in
+   * milliseconds, or 0 to update it on every frame.
+   *
+   * See clutter_timeline_set_update_interval().
+   */
+  obj_props[PROP_UPDATE_INTERVAL] =
+    g_param_spec_uint ("update-interval",
+                       P_("Update Interval"),
+                       P_("The interval between the updates of the timeline, or 0"),
+                       0, G_MAXUINT,
+                       0,
+                       CLUTTER_PARAM_READWRITE);
+
   object_class->dispose = clutter_timeline_dispose;
   object_class->finalize = clutter_timeline_finalize;
   object_class->set_property = clutter_timeline_set_property;
@@ -816,98 +900,162 @@ clutter_timeline_init (ClutterTimeline *self)
   clutter_point_init (&priv->cb_2, 1, 1);
 }
 
-struct CheckIfMarkerHitClosure
+static gint
+timeline_marker_compare (gconstpointer a,
+                         gconstpointer b)
 {
-  ClutterTimeline *timeline;
-  ClutterTimelineDirection direction;
-  gint new_time;
-  gint duration;
-  gint delta;
-};
+  const TimelineMarker *marker_a = *((const TimelineMarker **) a);
+  const TimelineMarker *marker_b = *((const TimelineMarker **) b);
 
-static gboolean
-have_passed_time (const struct CheckIfMarkerHitClosure *data,
-                  gint msecs)
+  if (marker_a->msecs != marker_b->msecs)
+    return marker_a->msecs < marker_b->msecs ? -1 : 1;
+
+  /* keep the order of the markers at the same time stable */
+  return strcmp (marker_a->name, marker_b->name);
+}
+
+static void
+clutter_timeline_ensure_markers_sorted (ClutterTimeline *timeline)
 {
-  /* Ignore markers that are outside the duration of the timeline */
-  if (msecs < 0 || msecs > data->duration)
-    return FALSE;
+  ClutterTimelinePrivate *priv = timeline->priv;
+  guint i;
 
-  if (data->direction == CLUTTER_TIMELINE_FORWARD)
-    {
-      /* We need to special case when a marker is added at the
-         beginning of the timeline */
-      if (msecs == 0 &&
-          data->delta > 0 &&
-          data->new_time - data->delta <= 0)
-        return TRUE;
-
-      /* Otherwise it's just a simple test if the time is in range of
-         the previous time and the new time */
-      return (msecs > data->new_time - data->delta &&
-              msecs <= data->new_time);
-    }
-  else
+  if (!priv->markers_dirty)
+    return;
+
+  for (i = 0; i < priv->markers_by_time->len; i++)
     {
-      /* We need to special case when a marker is added at the
-         end of the timeline */
-      if (msecs == data->duration &&
-          data->delta > 0 &&
-          data->new_time + data->delta >= data->duration)
-        return TRUE;
-
-      /* Otherwise it's just a simple test if the time is in range of
-         the previous time and the new time */
-      return (msecs >= data->new_time &&
-              msecs < data->new_time + data->delta);
+      TimelineMarker *marker = g_ptr_array_index (priv->markers_by_time, i);
+
+      if (marker->is_relative)
+        marker->msecs = (gdouble) priv->duration * marker->data.progress;
+      else
+        marker->msecs = marker->data.msecs;
     }
+
+  g_ptr_array_sort (priv->markers_by_time, timeline_marker_compare);
+
+  priv->markers_dirty = FALSE;
 }
 
-static void
-check_if_marker_hit (const gchar *name,
-                     TimelineMarker *marker,
-                     struct CheckIfMarkerHitClosure *data)
+/* returns the index of the first marker at or after @msecs */
+static guint
+clutter_timeline_find_marker (ClutterTimeline *timeline,
+                              gint             msecs)
 {
-  gint msecs;
-
-  if (marker->is_relative)
-    msecs = (gdouble) data->duration * marker->data.progress;
-  else
-    msecs = marker->data.msecs;
+  GPtrArray *markers = timeline->priv->markers_by_time;
+  guint lo = 0, hi = markers->len;
 
-  if (have_passed_time (data, msecs))
+  while (lo < hi)
     {
-      CLUTTER_NOTE (SCHEDULER, "Marker '%s' reached", name);
+      guint mid = lo + (hi - lo) / 2;
+      TimelineMarker *marker = g_ptr_array_index (markers, mid);
 
-      g_signal_emit (data->timeline, timeline_signals[MARKER_REACHED],
-                     marker->quark,
-                     name,
-                     msecs);
+      if (marker->msecs < msecs)
+        lo = mid + 1;
+      else
+        hi = mid;
     }
+
+  return lo;
 }
 
+typedef struct {
+  GQuark quark;
+  gint msecs;
+} MarkerHit;
+
 static void
 check_markers (ClutterTimeline *timeline,
                gint delta)
 {
   ClutterTimelinePrivate *priv = timeline->priv;
-  struct CheckIfMarkerHitClosure data;
+  ClutterTimelineDirection direction;
+  gint new_time, duration, first_msecs, last_msecs;
+  guint first, last, i, n_hits;
+  MarkerHit *hits;
 
   /* shortcircuit here if we don't have any marker installed */
-  if (priv->markers_by_name == NULL)
+  if (priv->markers_by_time == NULL || priv->markers_by_time->len == 0)
+    return;
+
+  clutter_timeline_ensure_markers_sorted (timeline);
+
+  direction = priv->direction;
+  new_time = priv->elapsed_time;
+  duration = priv->duration;
+
+  /* the markers hit are the ones inside the interval elapsed since
+   * the previous frame, so we only need to visit that interval
+   */
+  if (direction == CLUTTER_TIMELINE_FORWARD)
+    {
+      /* the range of the previous time and the new time */
+      first_msecs = new_time - delta + 1;
+      last_msecs = new_time;
+
+      /* We need to special case when a marker is added at the
+         beginning of the timeline */
+      if (delta > 0 && new_time - delta <= 0)
+        first_msecs = MIN (first_msecs, 0);
+    }
+  else
+    {
+      first_msecs = new_time;
+      last_msecs = new_time + delta - 1;
+
+      /* We need to special case when a marker is added at the
+         end of the timeline */
+      if (delta > 0 && new_time + delta >= duration)
+        last_msecs = MAX (last_msecs, duration);
+    }
+
+  /* Ignore markers that are outside the duration of the timeline */
+  first_msecs = MAX (first_msecs, 0);
+  last_msecs = MIN (last_msecs, duration);
+
+  if (first_msecs > last_msecs)
+    return;
+
+  first = clutter_timeline_find_marker (timeline, first_msecs);
+  last = clutter_timeline_find_marker (timeline, last_msecs + 1);
+  if (first == last)
     return;
 
-  /* store the details of the timeline so that changing them in a
-     marker signal handler won't affect which markers are hit */
-  data.timeline = timeline;
-  data.direction = priv->direction;
-  data.new_time = priv->elapsed_time;
-  data.duration = priv->duration;
-  data.delta = delta;
+  /* store the markers hit, so that changing the markers or the details
+     of the timeline in a marker signal handler won't affect which
+     markers are hit; the names of the markers are interned in their
+     quarks, so they outlive the markers themselves */
+  n_hits = last - first;
+  hits = g_new (MarkerHit, n_hits);
+
+  for (i = 0; i < n_hits; i++)
+    {
+      TimelineMarker *marker;
+
+      /* going backward, the later markers are hit first */
+      if (direction == CLUTTER_TIMELINE_FORWARD)
+        marker = g_ptr_array_index (priv->markers_by_time, first + i);
+      else
+        marker = g_ptr_array_index (priv->markers_by_time, last - 1 - i);
+
+      hits[i].quark = marker->quark;
+      hits[i].msecs = marker->msecs;
+    }
+
+  for (i = 0; i < n_hits; i++)
+    {
+      const gchar *name = g_quark_to_string (hits[i].quark);
+
+      CLUTTER_NOTE (SCHEDULER, "Marker '%s' reached", name);
+
+      g_signal_emit (timeline, timeline_signals[MARKER_REACHED],
+                     hits[i].quark,
+                     name,
+                     hits[i].msecs);
+    }
 
-  g_hash_table_foreach (priv->markers_by_name,
-                        (GHFunc) check_if_marker_hit,
-                        &data);
+  g_free (hits);
 }
 
 static void
@@ -1446,6 +1594,9 @@ clutter_timeline_set_duration (ClutterTimeline *timeline,
     {
       priv->duration = msecs;
 
+      /* the relative markers have moved */
+      priv->markers_dirty = TRUE;
+
       g_object_notify_by_pspec (G_OBJECT (timeline), obj_props[PROP_DURATION]);
     }
 }
@@ -1639,6 +1790,147 @@ _clutter_timeline_do_tick (ClutterTimeline *timeline,
     }
 }
 
+/*
+ * _clutter_timeline_do_quiet_tick:
+ * @timeline: a #ClutterTimeline
+ * @tick_time: time of advance
+ *
+ * Advances @timeline like _clutter_timeline_do_tick(), but only if the
+ * frame would not emit anything besides the class handler of the
+ * #ClutterTimeline::new-frame signal: no handler connected to the
+ * signal, no marker, and no completion.
+ *
+ * The elapsed time is updated without emitting the signal: the caller
+ * is responsible for doing the work of the class handler.
+ *
+ * Return value: %TRUE if @timeline was advanced, and %FALSE if the
+ *   frame has to go through _clutter_timeline_do_tick()
+ */
+gboolean
+_clutter_timeline_do_quiet_tick (ClutterTimeline *timeline,
+                                 gint64           tick_time)
+{
+  ClutterTimelinePrivate *priv = timeline->priv;
+  gint64 msecs;
+
+  if (!priv->is_playing || priv->waiting_first_tick)
+    return FALSE;
+
+  /* clock roll backs and empty frames are left to do_tick() */
+  msecs = tick_time - priv->last_frame_time;
+
+  if (!_clutter_timeline_quiet_advance (timeline, msecs))
+    return FALSE;
+
+  priv->last_frame_time += msecs;
+
+  return TRUE;
+}
+
+/*
+ * _clutter_timeline_quiet_advance:
+ * @timeline: a #ClutterTimeline
+ * @msecs: the amount of milliseconds to advance
+ *
+ * Advances @timeline like _clutter_timeline_advance(), under the same
+ * conditions as _clutter_timeline_do_quiet_tick(); this is used for
+ * timelines driven by another timeline, instead of the master clock.
+ *
+ * Return value: %TRUE if @timeline was advanced, and %FALSE if the
+ *   frame has to go through _clutter_timeline_advance()
+ */
+gboolean
+_clutter_timeline_quiet_advance (ClutterTimeline *timeline,
+                                 gint64           msecs)
+{
+  ClutterTimelinePrivate *priv = timeline->priv;
+  gint64 elapsed_time;
+
+  if (msecs <= 0)
+    return FALSE;
+
+  if (priv->markers_by_name != NULL &&
+      g_hash_table_size (priv->markers_by_name) != 0)
+    return FALSE;
+
+  if (priv->direction == CLUTTER_TIMELINE_FORWARD)
+    {
+      elapsed_time = priv->elapsed_time + msecs;
+      if (elapsed_time >= priv->duration)
+        return FALSE;
+    }
+  else
+    {
+      elapsed_time = priv->elapsed_time - msecs;
+      if (elapsed_time <= 0)
+        return FALSE;
+    }
+
+  if (g_signal_has_handler_pending (timeline, timeline_signals[NEW_FRAME], 0, TRUE))
+    return FALSE;
+
+  priv->msecs_delta = msecs;
+  priv->elapsed_time = elapsed_time;
+
+  return TRUE;
+}
+
+/*
+ * _clutter_timeline_emit_new_frame:
+ * @timeline: a #ClutterTimeline
+ *
+ * Emits the #ClutterTimeline::new-frame signal for a frame advanced
+ * with _clutter_timeline_do_quiet_tick() when the caller cannot do
+ * the work of the class handler after all.
+ */
+void
+_clutter_timeline_emit_new_frame (ClutterTimeline *timeline)
+{
+  emit_frame_signal (timeline);
+}
+
+/*
+ * _clutter_timeline_shares_progress:
+ * @a: a #ClutterTimeline
+ * @b: a #ClutterTimeline
+ *
+ * Checks whether clutter_timeline_get_progress() returns the same
+ * value for @a and @b, without computing it; timelines started
+ * together, with the same duration and progress mode, share the
+ * progress as long as they are not using a custom function.
+ */
+gboolean
+_clutter_timeline_shares_progress (ClutterTimeline *a,
+                                   ClutterTimeline *b)
+{
+  ClutterTimelinePrivate *priv_a = a->priv;
+  ClutterTimelinePrivate *priv_b = b->priv;
+
+  if (priv_a->elapsed_time != priv_b->elapsed_time ||
+      priv_a->duration != priv_b->duration ||
+      priv_a->progress_func != priv_b->progress_func ||
+      priv_a->sampled_progress != priv_b->sampled_progress)
+    return FALSE;
+
+  if (priv_a->progress_func == NULL)
+    return TRUE;
+
+  /* custom functions can depend on the timeline */
+  if (priv_a->progress_func != clutter_timeline_progress_func ||
+      priv_a->progress_mode != priv_b->progress_mode)
+    return FALSE;
+
+  if (priv_a->progress_mode == CLUTTER_STEPS)
+    return priv_a->n_steps == priv_b->n_steps &&
+           priv_a->step_mode == priv_b->step_mode;
+
+  if (priv_a->progress_mode == CLUTTER_CUBIC_BEZIER)
+    return clutter_point_equals (&priv_a->cb_1, &priv_b->cb_1) &&
+           clutter_point_equals (&priv_a->cb_2, &priv_b->cb_2);
+
+  return TRUE;
+}
+
 /**
  * clutter_timeline_add_marker:
  * @timeline: a #ClutterTimeline
@@ -1707,32 +1999,6 @@ clutter_timeline_add_marker_at_time (ClutterTimeline *timeline,
   clutter_timeline_add_marker_internal (timeline, marker);
 }
 
-struct CollectMarkersClosure
-{
-  guint duration;
-  guint msecs;
-  GArray *markers;
-};
-
-static void
-collect_markers (const gchar *key,
-                 TimelineMarker *marker,
-                 struct CollectMarkersClosure *data)
-{
-  guint msecs;
-
-  if (marker->is_relative)
-    msecs = marker->data.progress * data->duration;
-  else
-    msecs = marker->data.msecs;
-
-  if (msecs == data->msecs)
-    {
-      gchar *name_copy = g_strdup (key);
-      g_array_append_val (data->markers, name_copy);
-    }
-}
-
 /**
  * clutter_timeline_list_markers:
  * @timeline: a #ClutterTimeline
@@ -1784,18 +2050,26 @@ clutter_timeline_list_markers (ClutterTimeline *timeline,
     }
   else
     {
-      struct CollectMarkersClosure data;
+      GPtrArray *names = g_ptr_array_new ();
+      guint j;
 
-      data.duration = priv->duration;
-      data.msecs = msecs;
-      data.markers = g_array_new (TRUE, FALSE, sizeof (gchar *));
+      clutter_timeline_ensure_markers_sorted (timeline);
 
-      g_hash_table_foreach (priv->markers_by_name,
-                            (GHFunc) collect_markers,
-                            &data);
+      for (j = clutter_timeline_find_marker (timeline, msecs);
+           j < priv->markers_by_time->len;
+           j++)
+        {
+          TimelineMarker *marker = g_ptr_array_index (priv->markers_by_time, j);
 
-      i = data.markers->len;
-      retval = (gchar **) (void *) g_array_free (data.markers, FALSE);
+          if (marker->msecs != msecs)
+            break;
+
+          g_ptr_array_add (names, g_strdup (marker->name));
+        }
+
+      i = names->len;
+      g_ptr_array_add (names, NULL);
+      retval = (gchar **) g_ptr_array_free (names, FALSE);
     }
 
   if (n_markers)
@@ -1886,6 +2160,9 @@ clutter_timeline_remove_marker (ClutterTimeline *timeline,
       return;
     }
 
+  /* removing a marker keeps the others sorted */
+  g_ptr_array_remove (priv->markers_by_time, marker);
+
   /* this will take care of freeing the marker as well */
   g_hash_table_remove (priv->markers_by_name, marker_name);
 }
@@ -2107,6 +2384,19 @@ clutter_timeline_progress_func (ClutterTimeline *timeline,
 {
   ClutterTimelinePrivate *priv = timeline->priv;
 
+  if (priv->sampled_progress)
+    {
+      const gfloat *table;
+
+      if (priv->progress_mode == CLUTTER_CUBIC_BEZIER)
+        table = priv->cb_table;
+      else
+        table = _clutter_easing_get_table (priv->progress_mode);
+
+      if (table != NULL)
+        return _clutter_easing_table_lookup (table, elapsed, duration);
+    }
+
   /* parametrized easing functions need to be handled separately */
   switch (priv->progress_mode)
     {
@@ -2338,6 +2628,21 @@ clutter_timeline_get_step_progress (ClutterTimeline *timeline,
   return TRUE;
 }
 
+static void
+clutter_timeline_update_cubic_bezier_table (ClutterTimeline *timeline)
+{
+  ClutterTimelinePrivate *priv = timeline->priv;
+
+  g_free (priv->cb_table);
+  priv->cb_table = NULL;
+
+  if (priv->sampled_progress)
+    priv->cb_table = _clutter_easing_table_new_cubic_bezier (priv->cb_1.x,
+                                                             priv->cb_1.y,
+                                                             priv->cb_2.x,
+                                                             priv->cb_2.y);
+}
+
 /**
  * clutter_timeline_set_cubic_bezier_progress:
  * @timeline: a #ClutterTimeline
@@ -2373,6 +2678,8 @@ clutter_timeline_set_cubic_bezier_progress (ClutterTimeline    *timeline,
   priv->cb_1.x = CLAMP (priv->cb_1.x, 0.f, 1.f);
   priv->cb_2.x = CLAMP (priv->cb_2.x, 0.f, 1.f);
 
+  clutter_timeline_update_cubic_bezier_table (timeline);
+
   clutter_timeline_set_progress_mode (timeline, CLUTTER_CUBIC_BEZIER);
 }
 
@@ -2413,3 +2720,138 @@ clutter_timeline_get_cubic_bezier_progress (ClutterTimeline *timeline,
 
   return TRUE;
 }
+
+/**
+ * clutter_timeline_set_sampled_progress:
+ * @timeline: a #ClutterTimeline
+ * @sampled: whether the progress should be sampled
+ *
+ * Sets whether @timeline should compute its progress by interpolating
+ * a table of samples of its easing function, instead of evaluating
+ * the function on every frame.
+ *
+ * This is only done for the progress modes that are expensive to
+ * compute: the sine, exponential, elastic and bounce modes, and the
+ * cubic bezier modes. The tables of the predefined modes are shared by
+ * every timeline, while the table of the curve set with
+ * clutter_timeline_set_cubic_bezier_progress() is built when the curve
+ * is set.
+ *
+ * Each table holds 513 samples, and the absolute error on the progress
+ * is below 2.5e-3, which is reached at the bounces of the bounce modes;
+ * it is below 1e-5 for the sine modes and for the usual cubic bezier
+ * curves. This is mostly useful when many timelines use the same
+ * progress mode at the same time.
+ */
+void
+clutter_timeline_set_sampled_progress (ClutterTimeline *timeline,
+                                       gboolean         sampled)
+{
+  ClutterTimelinePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_TIMELINE (timeline));
+
+  priv = timeline->priv;
+
+  sampled = !!sampled;
+
+  if (priv->sampled_progress == sampled)
+    return;
+
+  priv->sampled_progress = sampled;
+
+  clutter_timeline_update_cubic_bezier_table (timeline);
+
+  g_object_notify_by_pspec (G_OBJECT (timeline), obj_props[PROP_SAMPLED_PROGRESS]);
+}
+
+/**
+ * clutter_timeline_get_sampled_progress:
+ * @timeline: a #ClutterTimeline
+ *
+ * Retrieves the value set by clutter_timeline_set_sampled_progress().
+ *
+ * Return value: %TRUE if the progress of @timeline is sampled
+ */
+gboolean
+clutter_timeline_get_sampled_progress (ClutterTimeline *timeline)
+{
+  g_return_val_if_fail (CLUTTER_IS_TIMELINE (timeline), FALSE);
+
+  return timeline->priv->sampled_progress;
+}
+
+/**
+ * clutter_timeline_set_update_interval:
+ * @timeline: a #ClutterTimeline
+ * @msecs: the interval between two updates, in milliseconds, or 0
+ *
+ * Declares that @timeline only needs to be updated every @msecs
+ * milliseconds, instead of on every frame; this is meant for slow
+ * animations, like blinking a cursor, or updating a clock.
+ *
+ * When all the playing timelines have an update interval, and nothing
+ * else needs a new frame, the master clock only wakes up at the
+ * lowest rate satisfying all of them instead of running at the full
+ * frame rate. A timeline can still be updated more often, if something
+ * else causes a new frame.
+ */
+void
+clutter_timeline_set_update_interval (ClutterTimeline *timeline,
+                                      guint            msecs)
+{
+  g_return_if_fail (CLUTTER_IS_TIMELINE (timeline));
+
+  if (timeline->priv->update_interval == msecs)
+    return;
+
+  timeline->priv->update_interval = msecs;
+
+  g_object_notify_by_pspec (G_OBJECT (timeline), obj_props[PROP_UPDATE_INTERVAL]);
+}
+
+/**
+ * clutter_timeline_get_update_interval:
+ * @timeline: a #ClutterTimeline
+ *
+ * Retrieves the value set by clutter_timeline_set_update_interval().
+ *
+ * Return value: the interval between two updates, in milliseconds,
+ *   or 0 if @timeline is updated on every frame
+ */
+guint
+clutter_timeline_get_update_interval (ClutterTimeline *timeline)
+{
+  g_return_val_if_fail (CLUTTER_IS_TIMELINE (timeline), 0);
+
+  return timeline->priv->update_interval;
+}
+
+/*< private >
+ * _clutter_timeline_get_update_delay:
+ * @timeline: a #ClutterTimeline
+ * @tick_time: the current time, in milliseconds
+ *
+ * Computes how long the master clock can wait before updating
+ * @timeline, according to its #ClutterTimeline:update-interval.
+ *
+ * Return value: the delay, in milliseconds, or -1 if @timeline needs
+ *   to be updated on every frame
+ */
+gint
+_clutter_timeline_get_update_delay (ClutterTimeline *timeline,
+                                    gint64           tick_time)
+{
+  ClutterTimelinePrivate *priv = timeline->priv;
+  gint64 next;
+
+  if (priv->update_interval == 0)
+    return -1;
+
+  if (priv->waiting_first_tick)
+    return 0;
+
+  next = priv->last_frame_time + priv->update_interval;
+
+  return (gint) CLAMP (next - tick_time, 0, priv->update_interval);
+}
@@ -191,6 +191,13 @@ gboolean                        clutter_timeline_get_cubic_bezier_progress
                                                                                  ClutterPoint             *c_1,
                                                                                  ClutterPoint             *c_2);
 
+void                            clutter_timeline_set_sampled_progress           (ClutterTimeline          *timeline,
+                                                                                 gboolean                  sampled);
+gboolean                        clutter_timeline_get_sampled_progress           (ClutterTimeline          *timeline);
+void                            clutter_timeline_set_update_interval            (ClutterTimeline          *timeline,
+                                                                                 guint                     msecs);
+guint                           clutter_timeline_get_update_interval            (ClutterTimeline          *timeline);
+
 
 gint64                          clutter_timeline_get_duration_hint              (ClutterTimeline          *timeline);
 
@@ -0,0 +1,151 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Trace spans for system-wide profilers.
+ *
+ * When CLUTTER_TRACE is set to "ftrace" or "perfetto", the phases of
+ * each frame are written to the ftrace marker file as begin and end
+ * markers, using the format of the systrace/atrace markers; perfetto,
+ * trace-cmd and the other ftrace consumers can then show the work done
+ * by Clutter together with the scheduling of the kernel and the work
+ * of the GPU driver.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <string.h>
+
+#ifdef G_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "clutter-trace.h"
+
+#include "clutter-debug.h"
+#include "clutter-private.h"
+
+gint _clutter_trace_fd = -1;
+
+#ifdef G_OS_UNIX
+static const gchar *trace_marker_paths[] = {
+  "/sys/kernel/tracing/trace_marker",
+  "/sys/kernel/debug/tracing/trace_marker",
+};
+
+static gint trace_pid = 0;
+
+static void
+clutter_trace_write (const gchar *buffer,
+                     gint         len)
+{
+  /* the markers are best-effort: a full buffer simply drops them */
+  if (write (_clutter_trace_fd, buffer, MIN (len, 255)) < 0)
+    return;
+}
+#endif /* G_OS_UNIX */
+
+/*< private >
+ * _clutter_trace_init:
+ * @tracer: the value of the CLUTTER_TRACE environment variable
+ *
+ * Opens the tracer selected by @tracer.
+ */
+void
+_clutter_trace_init (const gchar *tracer)
+{
+#ifdef G_OS_UNIX
+  guint i;
+
+  if (tracer == NULL || *tracer == '\0')
+    return;
+
+  if (g_ascii_strcasecmp (tracer, "ftrace") != 0 &&
+      g_ascii_strcasecmp (tracer, "perfetto") != 0)
+    {
+      g_warning ("Unknown tracer '%s' in CLUTTER_TRACE; the supported "
+                 "tracers are 'ftrace' and 'perfetto'",
+                 tracer);
+      return;
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (trace_marker_paths); i++)
+    {
+      _clutter_trace_fd = open (trace_marker_paths[i], O_WRONLY | O_CLOEXEC);
+      if (_clutter_trace_fd >= 0)
+        break;
+    }
+
+  if (_clutter_trace_fd < 0)
+    {
+      g_warning ("Unable to open the ftrace marker file for tracing: %s",
+                 g_strerror (errno));
+      return;
+    }
+
+  trace_pid = getpid ();
+
+  CLUTTER_NOTE (MISC, "Tracing enabled using '%s'", trace_marker_paths[i]);
+#else
+  if (tracer != NULL && *tracer != '\0')
+    g_warning ("Tracing is not supported on this platform");
+#endif /* G_OS_UNIX */
+}
+
+/*< private >
+ * _clutter_trace_begin:
+ * @name: the name of the span
+ *
+ * Opens a span; use the CLUTTER_TRACE_BEGIN() macro instead of
+ * calling this function directly.
+ */
+void
+_clutter_trace_begin (const gchar *name)
+{
+#ifdef G_OS_UNIX
+  gchar buffer[256];
+  gint len;
+
+  len = g_snprintf (buffer, sizeof (buffer), "B|%d|%s", trace_pid, name);
+  clutter_trace_write (buffer, len);
+#endif
+}
+
+/*< private >
+ * _clutter_trace_end:
+ *
+ * Closes the last span opened by the current thread; use the
+ * CLUTTER_TRACE_END() macro instead of calling this function
+ * directly.
+ */
+void
+_clutter_trace_end (void)
+{
+#ifdef G_OS_UNIX
+  gchar buffer[32];
+  gint len;
+
+  len = g_snprintf (buffer, sizeof (buffer), "E|%d", trace_pid);
+  clutter_trace_write (buffer, len);
+#endif
+}
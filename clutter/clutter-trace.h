@@ -0,0 +1,49 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_TRACE_H__
+#define __CLUTTER_TRACE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* the file descriptor of the tracer selected by CLUTTER_TRACE, or -1 */
+extern gint _clutter_trace_fd;
+
+void    _clutter_trace_init     (const gchar *tracer);
+void    _clutter_trace_begin    (const gchar *name);
+void    _clutter_trace_end      (void);
+
+/* the spans can be nested, and are closed in reverse order */
+#define CLUTTER_TRACE_BEGIN(name)       G_STMT_START {  \
+  if (G_UNLIKELY (_clutter_trace_fd >= 0))              \
+    _clutter_trace_begin (name);                        \
+} G_STMT_END
+
+#define CLUTTER_TRACE_END()             G_STMT_START {  \
+  if (G_UNLIKELY (_clutter_trace_fd >= 0))              \
+    _clutter_trace_end ();                              \
+} G_STMT_END
+
+G_END_DECLS
+
+#endif /* __CLUTTER_TRACE_H__ */
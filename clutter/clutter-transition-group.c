@@ -58,8 +58,12 @@ clutter_transition_group_new_frame (ClutterTimeline *timeline,
                                     gint             elapsed)
 {
   ClutterTransitionGroupPrivate *priv;
+  ClutterTimelineDirection direction;
+  ClutterTimeline *last_direct;
+  gdouble last_progress;
   GHashTableIter iter;
   gpointer element;
+  guint duration;
   gint64 msecs;
 
   priv = CLUTTER_TRANSITION_GROUP (timeline)->priv;
@@ -67,16 +71,44 @@ clutter_transition_group_new_frame (ClutterTimeline *timeline,
   /* get the time elapsed since the last ::new-frame... */
   msecs = clutter_timeline_get_delta (timeline);
 
+  direction = clutter_timeline_get_direction (timeline);
+  duration = clutter_timeline_get_duration (timeline);
+
+  last_direct = NULL;
+  last_progress = 0.0;
+
   g_hash_table_iter_init (&iter, priv->transitions);
   while (g_hash_table_iter_next (&iter, &element, NULL))
     {
       ClutterTimeline *t = element;
+      gdouble initial, final, progress;
 
       /* ... and advance every timeline */
-      clutter_timeline_set_direction (t, clutter_timeline_get_direction (timeline));
-      clutter_timeline_set_duration (t, clutter_timeline_get_duration (timeline));
-
-      _clutter_timeline_advance (t, msecs);
+      clutter_timeline_set_direction (t, direction);
+      clutter_timeline_set_duration (t, duration);
+
+      /* the property transitions that only need their value computed
+       * are advanced without emitting ::new-frame; their progress is
+       * computed once for all the ones sharing it, which is the common
+       * case for a group
+       */
+      if (!_clutter_property_transition_get_direct_interval (t, &initial, &final) ||
+          !_clutter_timeline_quiet_advance (t, msecs))
+        {
+          _clutter_timeline_advance (t, msecs);
+          continue;
+        }
+
+      if (last_direct != NULL && _clutter_timeline_shares_progress (last_direct, t))
+        progress = last_progress;
+      else
+        progress = clutter_timeline_get_progress (t);
+
+      last_direct = t;
+      last_progress = progress;
+
+      _clutter_transition_freeze_notify (CLUTTER_TRANSITION (t));
+      _clutter_property_transition_set_direct_value (t, initial + (final - initial) * progress);
     }
 }
 
@@ -38,7 +38,9 @@
 
 #include "clutter-animatable.h"
 #include "clutter-debug.h"
+#include "clutter-enum-types.h"
 #include "clutter-interval.h"
+#include "clutter-master-clock.h"
 #include "clutter-private.h"
 #include "clutter-timeline.h"
 
@@ -49,7 +51,11 @@ struct _ClutterTransitionPrivate
   ClutterInterval *interval;
   ClutterAnimatable *animatable;
 
+  ClutterTransitionNotifyMode notify_mode;
+
   guint remove_on_complete : 1;
+  /* whether we hold a notify freeze on the animatable */
+  guint notify_frozen      : 1;
 };
 
 enum
@@ -59,6 +65,7 @@ enum
   PROP_INTERVAL,
   PROP_ANIMATABLE,
   PROP_REMOVE_ON_COMPLETE,
+  PROP_NOTIFY_MODE,
 
   PROP_LAST
 };
@@ -103,6 +110,59 @@ clutter_transition_real_detached (ClutterTransition *transition,
 {
 }
 
+/* releases the freeze taken with CLUTTER_TRANSITION_NOTIFY_ON_COMPLETION,
+ * emitting the notifications queued since the transition started
+ */
+static void
+clutter_transition_thaw_notify (ClutterTransition *transition)
+{
+  ClutterTransitionPrivate *priv = transition->priv;
+
+  if (!priv->notify_frozen)
+    return;
+
+  priv->notify_frozen = FALSE;
+
+  if (priv->animatable != NULL)
+    g_object_thaw_notify (G_OBJECT (priv->animatable));
+}
+
+/*
+ * _clutter_transition_freeze_notify:
+ * @transition: a #ClutterTransition
+ *
+ * Delays the notifications of the animatable instance of @transition,
+ * according to the #ClutterTransition:notify-mode property; this
+ * function is called before a new value is computed.
+ */
+void
+_clutter_transition_freeze_notify (ClutterTransition *transition)
+{
+  ClutterTransitionPrivate *priv = transition->priv;
+
+  if (priv->animatable == NULL)
+    return;
+
+  switch (priv->notify_mode)
+    {
+    case CLUTTER_TRANSITION_NOTIFY_EACH_FRAME:
+      break;
+
+    case CLUTTER_TRANSITION_NOTIFY_END_OF_FRAME:
+      _clutter_master_clock_freeze_notify_for_frame (_clutter_master_clock_get_default (),
+                                                     G_OBJECT (priv->animatable));
+      break;
+
+    case CLUTTER_TRANSITION_NOTIFY_ON_COMPLETION:
+      if (!priv->notify_frozen)
+        {
+          g_object_freeze_notify (G_OBJECT (priv->animatable));
+          priv->notify_frozen = TRUE;
+        }
+      break;
+    }
+}
+
 static void
 clutter_transition_new_frame (ClutterTimeline *timeline,
                               gint             elapsed G_GNUC_UNUSED)
@@ -117,6 +177,8 @@ clutter_transition_new_frame (ClutterTimeline *timeline,
 
   progress = clutter_timeline_get_progress (timeline);
 
+  _clutter_transition_freeze_notify (transition);
+
   CLUTTER_TRANSITION_GET_CLASS (timeline)->compute_value (transition,
                                                           priv->animatable,
                                                           priv->interval,
@@ -129,6 +191,8 @@ clutter_transition_stopped (ClutterTimeline *timeline,
 {
   ClutterTransitionPrivate *priv = CLUTTER_TRANSITION (timeline)->priv;
 
+  clutter_transition_thaw_notify (CLUTTER_TRANSITION (timeline));
+
   if (is_finished &&
       priv->animatable != NULL &&
       priv->remove_on_complete)
@@ -162,6 +226,10 @@ clutter_transition_set_property (GObject      *gobject,
       clutter_transition_set_remove_on_complete (transition, g_value_get_boolean (value));
       break;
 
+    case PROP_NOTIFY_MODE:
+      clutter_transition_set_notify_mode (transition, g_value_get_enum (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -190,6 +258,10 @@ clutter_transition_get_property (GObject    *gobject,
       g_value_set_boolean (value, priv->remove_on_complete);
       break;
 
+    case PROP_NOTIFY_MODE:
+      g_value_set_enum (value, priv->notify_mode);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -205,6 +277,8 @@ clutter_transition_dispose (GObject *gobject)
     clutter_transition_detach (CLUTTER_TRANSITION (gobject),
                                priv->animatable);
 
+  clutter_transition_thaw_notify (CLUTTER_TRANSITION (gobject));
+
   g_clear_object (&priv->interval);
   g_clear_object (&priv->animatable);
 
@@ -285,6 +359,22 @@ clutter_transition_class_init (ClutterTransitionClass *klass)
                           FALSE,
                           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * ClutterTransition:notify-mode:
+   *
+   * When the changes of the #ClutterTransition:animatable instance
+   * should be notified.
+   *
+   * See clutter_transition_set_notify_mode().
+   */
+  obj_props[PROP_NOTIFY_MODE] =
+    g_param_spec_enum ("notify-mode",
+                       P_("Notify Mode"),
+                       P_("When the changes of the animatable should be notified"),
+                       CLUTTER_TYPE_TRANSITION_NOTIFY_MODE,
+                       CLUTTER_TRANSITION_NOTIFY_EACH_FRAME,
+                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
 }
 
@@ -382,6 +472,8 @@ clutter_transition_set_animatable (ClutterTransition *transition,
   if (priv->animatable != NULL)
     clutter_transition_detach (transition, priv->animatable);
 
+  clutter_transition_thaw_notify (transition);
+
   g_clear_object (&priv->animatable);
 
   if (animatable != NULL)
@@ -458,6 +550,63 @@ clutter_transition_get_remove_on_complete (ClutterTransition *transition)
   return transition->priv->remove_on_complete;
 }
 
+/**
+ * clutter_transition_set_notify_mode:
+ * @transition: a #ClutterTransition
+ * @mode: a #ClutterTransitionNotifyMode
+ *
+ * Sets when the changes applied by @transition should be notified
+ * by its #ClutterTransition:animatable instance.
+ *
+ * By default, every value set on each frame emits the #GObject::notify
+ * signal. With %CLUTTER_TRANSITION_NOTIFY_END_OF_FRAME, the
+ * notifications are coalesced until all the timelines have advanced
+ * for the current frame; with %CLUTTER_TRANSITION_NOTIFY_ON_COMPLETION,
+ * they are coalesced until @transition is stopped or detached.
+ *
+ * The notifications are delayed using g_object_freeze_notify() on the
+ * animatable instance, so the changes of other properties of the same
+ * instance are delayed as well.
+ */
+void
+clutter_transition_set_notify_mode (ClutterTransition           *transition,
+                                    ClutterTransitionNotifyMode  mode)
+{
+  ClutterTransitionPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_TRANSITION (transition));
+
+  priv = transition->priv;
+
+  if (priv->notify_mode == mode)
+    return;
+
+  priv->notify_mode = mode;
+
+  if (mode != CLUTTER_TRANSITION_NOTIFY_ON_COMPLETION)
+    clutter_transition_thaw_notify (transition);
+
+  g_object_notify_by_pspec (G_OBJECT (transition),
+                            obj_props[PROP_NOTIFY_MODE]);
+}
+
+/**
+ * clutter_transition_get_notify_mode:
+ * @transition: a #ClutterTransition
+ *
+ * Retrieves the value of the #ClutterTransition:notify-mode property.
+ *
+ * Return value: the notification mode of @transition
+ */
+ClutterTransitionNotifyMode
+clutter_transition_get_notify_mode (ClutterTransition *transition)
+{
+  g_return_val_if_fail (CLUTTER_IS_TRANSITION (transition),
+                        CLUTTER_TRANSITION_NOTIFY_EACH_FRAME);
+
+  return transition->priv->notify_mode;
+}
+
 typedef void (* IntervalSetFunc) (ClutterInterval *interval,
                                   const GValue    *value);
 
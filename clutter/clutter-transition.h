@@ -127,6 +127,10 @@ void                    clutter_transition_set_remove_on_complete       (Clutter
 
 gboolean                clutter_transition_get_remove_on_complete       (ClutterTransition *transition);
 
+void                    clutter_transition_set_notify_mode              (ClutterTransition           *transition,
+                                                                         ClutterTransitionNotifyMode  mode);
+ClutterTransitionNotifyMode clutter_transition_get_notify_mode          (ClutterTransition           *transition);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_TRANSITION_H__ */
@@ -29,6 +29,14 @@
 
 #include <math.h>
 
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#define CLUTTER_UTIL_USE_SSE2   1
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+#include <arm_neon.h>
+#define CLUTTER_UTIL_USE_NEON   1
+#endif
+
 #include <glib/gi18n-lib.h>
 
 #include "clutter-debug.h"
@@ -57,6 +65,310 @@ _clutter_gettext (const gchar *str)
 #define MTX_GL_SCALE_Y(y,w,v1,v2) ((v1) - (((((y) / (w)) + 1.0f) / 2.0f) * (v1)) + (v2))
 #define MTX_GL_SCALE_Z(z,w,v1,v2) (MTX_GL_SCALE_X ((z), (w), (v1), (v2)))
 
+/*< private >
+ * _clutter_util_transform_vertices:
+ * @matrix: a #CoglMatrix
+ * @vertices_in: the vertices to transform
+ * @vertices_out: return location for the transformed homogeneous
+ *   vertices; it must not overlap @vertices_in
+ * @n_vertices: the number of vertices
+ *
+ * Transforms a batch of vertices by @matrix, without dividing by W.
+ * The columns of a #CoglMatrix are contiguous, so each vertex is
+ * transformed as a sum of four scaled columns in SIMD registers when
+ * the target supports SSE2 or NEON.
+ */
+void
+_clutter_util_transform_vertices (const CoglMatrix    *matrix,
+                                  const ClutterVertex *vertices_in,
+                                  ClutterVertex4      *vertices_out,
+                                  int                  n_vertices)
+{
+  int i;
+
+#if defined (CLUTTER_UTIL_USE_SSE2)
+  __m128 c0 = _mm_loadu_ps (&matrix->xx);
+  __m128 c1 = _mm_loadu_ps (&matrix->xy);
+  __m128 c2 = _mm_loadu_ps (&matrix->xz);
+  __m128 c3 = _mm_loadu_ps (&matrix->xw);
+
+  for (i = 0; i < n_vertices; i++)
+    {
+      __m128 r;
+
+      r = _mm_add_ps (_mm_mul_ps (c0, _mm_set1_ps (vertices_in[i].x)),
+                      _mm_mul_ps (c1, _mm_set1_ps (vertices_in[i].y)));
+      r = _mm_add_ps (r, _mm_mul_ps (c2, _mm_set1_ps (vertices_in[i].z)));
+      r = _mm_add_ps (r, c3);
+
+      _mm_storeu_ps (&vertices_out[i].x, r);
+    }
+#elif defined (CLUTTER_UTIL_USE_NEON)
+  float32x4_t c0 = vld1q_f32 (&matrix->xx);
+  float32x4_t c1 = vld1q_f32 (&matrix->xy);
+  float32x4_t c2 = vld1q_f32 (&matrix->xz);
+  float32x4_t c3 = vld1q_f32 (&matrix->xw);
+
+  for (i = 0; i < n_vertices; i++)
+    {
+      float32x4_t r;
+
+      r = vmlaq_n_f32 (c3, c0, vertices_in[i].x);
+      r = vmlaq_n_f32 (r, c1, vertices_in[i].y);
+      r = vmlaq_n_f32 (r, c2, vertices_in[i].z);
+
+      vst1q_f32 (&vertices_out[i].x, r);
+    }
+#else
+  for (i = 0; i < n_vertices; i++)
+    {
+      float x = vertices_in[i].x;
+      float y = vertices_in[i].y;
+      float z = vertices_in[i].z;
+
+      vertices_out[i].x = matrix->xx * x + matrix->xy * y + matrix->xz * z + matrix->xw;
+      vertices_out[i].y = matrix->yx * x + matrix->yy * y + matrix->yz * z + matrix->yw;
+      vertices_out[i].z = matrix->zx * x + matrix->zy * y + matrix->zz * z + matrix->zw;
+      vertices_out[i].w = matrix->wx * x + matrix->wy * y + matrix->wz * z + matrix->ww;
+    }
+#endif
+}
+
+/*< private >
+ * _clutter_util_cull_vertices:
+ * @planes: the four clipping planes
+ * @vertices: the vertices to test
+ * @n_vertices: the number of vertices
+ * @all_out: (out): return location for a mask of the planes that
+ *   every vertex is outside of
+ * @any_out: (out): return location for a mask of the planes that at
+ *   least one vertex is outside of
+ *
+ * Computes the signed distance of the batch of @vertices from the
+ * four @planes; each vertex is tested against all the planes at once,
+ * in SIMD registers when the target supports SSE2 or NEON. Bit N of
+ * the masks corresponds to @planes[N].
+ */
+void
+_clutter_util_cull_vertices (const ClutterPlane  *planes,
+                             const ClutterVertex *vertices,
+                             int                  n_vertices,
+                             guint               *all_out,
+                             guint               *any_out)
+{
+  float nx[4], ny[4], nz[4], offset[4];
+  guint all_mask = 0xf, any_mask = 0;
+  int i;
+
+  /* the signed distance of v from a plane is n·v - n·v0 */
+  for (i = 0; i < 4; i++)
+    {
+      nx[i] = planes[i].n[0];
+      ny[i] = planes[i].n[1];
+      nz[i] = planes[i].n[2];
+      offset[i] = -(planes[i].n[0] * planes[i].v0[0] +
+                    planes[i].n[1] * planes[i].v0[1] +
+                    planes[i].n[2] * planes[i].v0[2]);
+    }
+
+#if defined (CLUTTER_UTIL_USE_SSE2)
+  {
+    __m128 vnx = _mm_loadu_ps (nx);
+    __m128 vny = _mm_loadu_ps (ny);
+    __m128 vnz = _mm_loadu_ps (nz);
+    __m128 voffset = _mm_loadu_ps (offset);
+    __m128 zero = _mm_setzero_ps ();
+
+    for (i = 0; i < n_vertices; i++)
+      {
+        __m128 d;
+        guint mask;
+
+        d = _mm_add_ps (_mm_mul_ps (vnx, _mm_set1_ps (vertices[i].x)),
+                        _mm_mul_ps (vny, _mm_set1_ps (vertices[i].y)));
+        d = _mm_add_ps (d, _mm_mul_ps (vnz, _mm_set1_ps (vertices[i].z)));
+        d = _mm_add_ps (d, voffset);
+
+        mask = _mm_movemask_ps (_mm_cmplt_ps (d, zero));
+        all_mask &= mask;
+        any_mask |= mask;
+      }
+  }
+#elif defined (CLUTTER_UTIL_USE_NEON)
+  {
+    float32x4_t vnx = vld1q_f32 (nx);
+    float32x4_t vny = vld1q_f32 (ny);
+    float32x4_t vnz = vld1q_f32 (nz);
+    float32x4_t voffset = vld1q_f32 (offset);
+    float32x4_t zero = vdupq_n_f32 (0.f);
+
+    for (i = 0; i < n_vertices; i++)
+      {
+        float32x4_t d;
+        uint32x4_t lt;
+        guint mask;
+
+        d = vmlaq_n_f32 (voffset, vnx, vertices[i].x);
+        d = vmlaq_n_f32 (d, vny, vertices[i].y);
+        d = vmlaq_n_f32 (d, vnz, vertices[i].z);
+
+        lt = vcltq_f32 (d, zero);
+        mask = (vgetq_lane_u32 (lt, 0) & 1)
+             | (vgetq_lane_u32 (lt, 1) & 2)
+             | (vgetq_lane_u32 (lt, 2) & 4)
+             | (vgetq_lane_u32 (lt, 3) & 8);
+        all_mask &= mask;
+        any_mask |= mask;
+      }
+  }
+#else
+  for (i = 0; i < n_vertices; i++)
+    {
+      guint mask = 0;
+      int j;
+
+      for (j = 0; j < 4; j++)
+        {
+          float d = nx[j] * vertices[i].x
+                  + ny[j] * vertices[i].y
+                  + nz[j] * vertices[i].z
+                  + offset[j];
+
+          if (d < 0)
+            mask |= 1 << j;
+        }
+
+      all_mask &= mask;
+      any_mask |= mask;
+    }
+#endif
+
+  if (n_vertices == 0)
+    all_mask = 0;
+
+  *all_out = all_mask;
+  *any_out = any_mask;
+}
+
+/*< private >
+ * _clutter_util_matrix_classify:
+ * @matrix: a #CoglMatrix
+ *
+ * Classifies the transformation of @matrix, so that the callers can
+ * use cheaper code paths for the transformations that keep the XY
+ * plane parallel to itself, which are the vast majority of them.
+ *
+ * Return value: the simplest kind of transformation matching @matrix
+ */
+ClutterTransformKind
+_clutter_util_matrix_classify (const CoglMatrix *matrix)
+{
+  /* a projective transformation */
+  if (matrix->wx != 0.f || matrix->wy != 0.f || matrix->wz != 0.f ||
+      matrix->ww != 1.f)
+    return CLUTTER_TRANSFORM_GENERAL;
+
+  /* a rotation around the X or Y axis, or a skew involving Z */
+  if (matrix->xz != 0.f || matrix->yz != 0.f ||
+      matrix->zx != 0.f || matrix->zy != 0.f)
+    return CLUTTER_TRANSFORM_GENERAL;
+
+  if (matrix->xy != 0.f || matrix->yx != 0.f)
+    return CLUTTER_TRANSFORM_2D_AFFINE;
+
+  if (matrix->xx != 1.f || matrix->yy != 1.f || matrix->zz != 1.f)
+    return CLUTTER_TRANSFORM_SCALE;
+
+  if (matrix->xw != 0.f || matrix->yw != 0.f || matrix->zw != 0.f)
+    return CLUTTER_TRANSFORM_TRANSLATE;
+
+  return CLUTTER_TRANSFORM_IDENTITY;
+}
+
+/* Projects vertices lying on a plane parallel to the XY plane through
+ * a @modelview that keeps the plane parallel to itself, using a
+ * @projection that does not depend on the X and Y eye coordinates to
+ * compute W, like the perspective and orthographic projections do: W
+ * is then the same for every vertex, and the whole transformation is
+ * an affine map of X and Y.
+ *
+ * A parallel projection, like the orthographic one, does not depend on
+ * the Z eye coordinate either: W is then the same for every vertex
+ * transformed by an affine @modelview, whatever its kind and the
+ * depth of the vertices.
+ */
+static gboolean
+_clutter_util_fully_transform_vertices_2d (const CoglMatrix *modelview,
+                                           const CoglMatrix *projection,
+                                           const float *viewport,
+                                           const ClutterVertex *vertices_in,
+                                           ClutterVertex *vertices_out,
+                                           int n_vertices)
+{
+  CoglMatrix modelview_projection;
+  float z, w, ax, bx, cx, dx, ay, by, cy, dy;
+  gboolean is_parallel;
+  int i;
+
+  if (projection->wx != 0.f || projection->wy != 0.f)
+    return FALSE;
+
+  is_parallel = projection->wz == 0.f;
+
+  if (!is_parallel)
+    {
+      if (_clutter_util_matrix_classify (modelview) == CLUTTER_TRANSFORM_GENERAL)
+        return FALSE;
+
+      z = vertices_in[0].z;
+      for (i = 1; i < n_vertices; i++)
+        {
+          if (vertices_in[i].z != z)
+            return FALSE;
+        }
+    }
+  else
+    z = 0.f;
+
+  cogl_matrix_multiply (&modelview_projection, projection, modelview);
+
+  /* a projective modelview would still make W vary between vertices */
+  if (is_parallel &&
+      (modelview_projection.wx != 0.f ||
+       modelview_projection.wy != 0.f ||
+       modelview_projection.wz != 0.f))
+    return FALSE;
+
+  w = modelview_projection.wz * z + modelview_projection.ww;
+  if (w == 0.f)
+    return FALSE;
+
+  ax = modelview_projection.xx / w;
+  bx = modelview_projection.xy / w;
+  cx = modelview_projection.xw / w;
+  dx = modelview_projection.xz / w;
+  ay = modelview_projection.yx / w;
+  by = modelview_projection.yy / w;
+  cy = modelview_projection.yw / w;
+  dy = modelview_projection.yz / w;
+
+  for (i = 0; i < n_vertices; i++)
+    {
+      float x = vertices_in[i].x;
+      float y = vertices_in[i].y;
+      float vz = vertices_in[i].z;
+
+      vertices_out[i].x = MTX_GL_SCALE_X (ax * x + bx * y + dx * vz + cx,
+                                          1.0f,
+                                          viewport[2], viewport[0]);
+      vertices_out[i].y = MTX_GL_SCALE_Y (ay * x + by * y + dy * vz + cy,
+                                          1.0f,
+                                          viewport[3], viewport[1]);
+    }
+
+  return TRUE;
+}
+
 void
 _clutter_util_fully_transform_vertices (const CoglMatrix *modelview,
                                         const CoglMatrix *projection,
@@ -69,6 +381,13 @@ _clutter_util_fully_transform_vertices (const CoglMatrix *modelview,
   ClutterVertex4 *vertices_tmp;
   int i;
 
+  if (n_vertices > 0 &&
+      _clutter_util_fully_transform_vertices_2d (modelview, projection,
+                                                 viewport,
+                                                 vertices_in, vertices_out,
+                                                 n_vertices))
+    return;
+
   vertices_tmp = g_alloca (sizeof (ClutterVertex4) * n_vertices);
 
   if (n_vertices >= 4)
@@ -77,13 +396,10 @@ _clutter_util_fully_transform_vertices (const CoglMatrix *modelview,
       cogl_matrix_multiply (&modelview_projection,
                             projection,
                             modelview);
-      cogl_matrix_project_points (&modelview_projection,
-                                  3,
-                                  sizeof (ClutterVertex),
-                                  vertices_in,
-                                  sizeof (ClutterVertex4),
-                                  vertices_tmp,
-                                  n_vertices);
+      _clutter_util_transform_vertices (&modelview_projection,
+                                        vertices_in,
+                                        vertices_tmp,
+                                        n_vertices);
     }
   else
     {
@@ -491,6 +807,9 @@ typedef struct
 {
   GType value_type;
   ClutterProgressFunc func;
+
+  /* whether func replaced the function registered with the type */
+  gboolean overridden;
 } ProgressData;
 
 G_LOCK_DEFINE_STATIC (progress_funcs);
@@ -507,6 +826,23 @@ _clutter_has_progress_function (GType gtype)
   return g_hash_table_lookup (progress_funcs, type_name) != NULL;
 }
 
+/* the progress functions of the Clutter types are registered when the
+ * types are; this checks whether the application replaced them, for
+ * the code that interpolates the Clutter types directly
+ */
+gboolean
+_clutter_has_overridden_progress_function (GType gtype)
+{
+  ProgressData *pdata;
+
+  if (progress_funcs == NULL)
+    return FALSE;
+
+  pdata = g_hash_table_lookup (progress_funcs, g_type_name (gtype));
+
+  return pdata != NULL && pdata->overridden;
+}
+
 gboolean
 _clutter_run_progress_function (GType gtype,
                                 const GValue *initial,
@@ -618,13 +954,17 @@ clutter_interval_register_progress_func (GType               value_type,
           g_slice_free (ProgressData, progress_func);
         }
       else
-        progress_func->func = func;
+        {
+          progress_func->func = func;
+          progress_func->overridden = TRUE;
+        }
     }
   else
     {
       progress_func = g_slice_new (ProgressData);
       progress_func->value_type = value_type;
       progress_func->func = func;
+      progress_func->overridden = FALSE;
 
       g_hash_table_replace (progress_funcs,
                             (gpointer) type_name,
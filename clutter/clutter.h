@@ -34,8 +34,10 @@
 #include "clutter-action.h"
 #include "clutter-actor.h"
 #include "clutter-actor-meta.h"
+#include "clutter-actor-pool.h"
 #include "clutter-align-constraint.h"
 #include "clutter-animatable.h"
+#include "clutter-array-model.h"
 #include "clutter-backend.h"
 #include "clutter-bind-constraint.h"
 #include "clutter-binding-pool.h"
@@ -77,6 +79,7 @@
 #include "clutter-list-model.h"
 #include "clutter-macros.h"
 #include "clutter-main.h"
+#include "clutter-mapped-model.h"
 #include "clutter-model.h"
 #include "clutter-offscreen-effect.h"
 #include "clutter-page-turn-effect.h"
@@ -97,9 +100,11 @@
 #include "clutter-snap-constraint.h"
 #include "clutter-stage.h"
 #include "clutter-stage-manager.h"
+#include "clutter-stream-image.h"
 #include "clutter-table-layout.h"
 #include "clutter-tap-action.h"
 #include "clutter-text.h"
+#include "clutter-tiled-canvas.h"
 #include "clutter-timeline.h"
 #include "clutter-transition-group.h"
 #include "clutter-transition.h"
@@ -32,6 +32,8 @@
 
 #define CLUTTER_ENABLE_EXPERIMENTAL_API
 
+#include <string.h>
+
 #include "clutter-config.h"
 
 #include "clutter-stage-cogl.h"
@@ -46,6 +48,7 @@
 #include "clutter-private.h"
 #include "clutter-profile.h"
 #include "clutter-stage-private.h"
+#include "clutter-trace.h"
 
 static void clutter_stage_window_iface_init (ClutterStageWindowIface *iface);
 
@@ -80,6 +83,35 @@ clutter_stage_cogl_unrealize (ClutterStageWindow *stage_window)
     }
 }
 
+static void
+clutter_stage_cogl_report_input_latency (ClutterStageCogl *stage_cogl,
+                                         CoglFrameInfo    *info)
+{
+  gint64 frame_counter = cogl_frame_info_get_frame_counter (info);
+  gint64 presentation_time;
+  guint index_;
+
+  index_ = frame_counter % CLUTTER_STAGE_COGL_PENDING_FRAMES;
+
+  if (stage_cogl->frame_counters[index_] != frame_counter ||
+      stage_cogl->frame_input_times[index_] == 0)
+    return;
+
+  /* without a presentation time, the completion of the frame is
+   * the closest approximation we have
+   */
+  if (cogl_frame_info_get_presentation_time (info) != 0)
+    presentation_time = stage_cogl->last_presentation_time;
+  else
+    presentation_time = g_get_monotonic_time ();
+
+  _clutter_stage_report_input_latency (stage_cogl->wrapper,
+                                       presentation_time -
+                                       stage_cogl->frame_input_times[index_]);
+
+  stage_cogl->frame_input_times[index_] = 0;
+}
+
 static void
 frame_cb (CoglOnscreen  *onscreen,
           CoglFrameEvent event,
@@ -117,6 +149,8 @@ frame_cb (CoglOnscreen  *onscreen,
         }
 
       stage_cogl->refresh_rate = cogl_frame_info_get_refresh_rate (info);
+
+      clutter_stage_cogl_report_input_latency (stage_cogl, info);
     }
 }
 
@@ -167,13 +201,29 @@ clutter_stage_cogl_realize (ClutterStageWindow *stage_window)
   return TRUE;
 }
 
+static gint64
+clutter_stage_cogl_get_refresh_interval (ClutterStageCogl *stage_cogl)
+{
+  float refresh_rate;
+  gint64 refresh_interval;
+
+  refresh_rate = stage_cogl->refresh_rate;
+  if (refresh_rate == 0.0)
+    refresh_rate = 60.0;
+
+  refresh_interval = (gint64) (0.5 + 1000000 / refresh_rate);
+  if (refresh_interval == 0)
+    refresh_interval = 16667; /* 1/60th second */
+
+  return refresh_interval;
+}
+
 static void
 clutter_stage_cogl_schedule_update (ClutterStageWindow *stage_window,
                                     gint                sync_delay)
 {
   ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
   gint64 now;
-  float refresh_rate;
   gint64 refresh_interval;
 
   if (stage_cogl->update_time != -1)
@@ -199,13 +249,7 @@ clutter_stage_cogl_schedule_update (ClutterStageWindow *stage_window,
       return;
     }
 
-  refresh_rate = stage_cogl->refresh_rate;
-  if (refresh_rate == 0.0)
-    refresh_rate = 60.0;
-
-  refresh_interval = (gint64) (0.5 + 1000000 / refresh_rate);
-  if (refresh_interval == 0)
-    refresh_interval = 16667; /* 1/60th second */
+  refresh_interval = clutter_stage_cogl_get_refresh_interval (stage_cogl);
 
   stage_cogl->update_time = stage_cogl->last_presentation_time + 1000 * sync_delay;
 
@@ -232,6 +276,46 @@ clutter_stage_cogl_clear_update_time (ClutterStageWindow *stage_window)
   stage_cogl->update_time = -1;
 }
 
+static gint64
+clutter_stage_cogl_real_get_refresh_interval (ClutterStageWindow *stage_window)
+{
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+
+  /* we don't know the refresh rate until a frame has been presented */
+  if (stage_cogl->last_presentation_time == 0)
+    return 0;
+
+  return clutter_stage_cogl_get_refresh_interval (stage_cogl);
+}
+
+static gint64
+clutter_stage_cogl_get_next_presentation_time (ClutterStageWindow *stage_window)
+{
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+  gint64 now, refresh_interval, next;
+
+  now = g_get_monotonic_time ();
+
+  /* see clutter_stage_cogl_schedule_update() */
+  if (stage_cogl->last_presentation_time == 0 ||
+      stage_cogl->last_presentation_time < now - 150000)
+    return -1;
+
+  refresh_interval = clutter_stage_cogl_get_refresh_interval (stage_cogl);
+
+  /* the first vertical refresh after now; a frame drawn while another
+   * swap is pending will be presented one refresh later
+   */
+  next = stage_cogl->last_presentation_time + refresh_interval;
+  while (next <= now)
+    next += refresh_interval;
+
+  if (stage_cogl->pending_swaps > 0)
+    next += refresh_interval;
+
+  return next;
+}
+
 static ClutterActor *
 clutter_stage_cogl_get_wrapper (ClutterStageWindow *stage_window)
 {
@@ -322,6 +406,105 @@ clutter_stage_cogl_ignoring_redraw_clips (ClutterStageWindow *stage_window)
     return FALSE;
 }
 
+static inline gint64
+rectangle_area (const cairo_rectangle_int_t *rect)
+{
+  return (gint64) rect->width * rect->height;
+}
+
+static inline gboolean
+rectangles_intersect (const cairo_rectangle_int_t *a,
+                      const cairo_rectangle_int_t *b)
+{
+  return a->x < b->x + b->width && b->x < a->x + a->width &&
+         a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+/* we merge two redraw clips if the area of their union is not much
+ * bigger than the area we would repaint if we kept them separated
+ */
+static inline gboolean
+should_merge_redraw_clips (const cairo_rectangle_int_t *a,
+                           const cairo_rectangle_int_t *b,
+                           cairo_rectangle_int_t       *merged)
+{
+  _clutter_util_rectangle_union (a, b, merged);
+
+  if (rectangles_intersect (a, b))
+    return TRUE;
+
+  return rectangle_area (merged) * 4 <=
+         (rectangle_area (a) + rectangle_area (b)) * 5;
+}
+
+static void
+clutter_stage_cogl_add_redraw_rectangle (ClutterStageCogl            *stage_cogl,
+                                         const cairo_rectangle_int_t *clip)
+{
+  cairo_rectangle_int_t rect = *clip;
+  cairo_rectangle_int_t merged;
+  gboolean changed;
+  guint i;
+
+  /* merging two rectangles might make the result overlap one of the
+   * other rectangles, so we keep going until nothing changes
+   */
+  do
+    {
+      changed = FALSE;
+
+      for (i = 0; i < stage_cogl->n_redraw_clips; i++)
+        {
+          cairo_rectangle_int_t *other = &stage_cogl->redraw_clips[i];
+
+          if (should_merge_redraw_clips (&rect, other, &merged))
+            {
+              rect = merged;
+
+              stage_cogl->n_redraw_clips -= 1;
+              *other = stage_cogl->redraw_clips[stage_cogl->n_redraw_clips];
+
+              changed = TRUE;
+              break;
+            }
+        }
+    }
+  while (changed);
+
+  /* if we ran out of space we merge with the rectangle that grows
+   * the least; this might make some rectangles overlap, which only
+   * costs us some redundant painting
+   */
+  if (stage_cogl->n_redraw_clips == CLUTTER_STAGE_COGL_MAX_REDRAW_CLIPS)
+    {
+      gint64 best_growth = G_MAXINT64;
+      guint best = 0;
+
+      for (i = 0; i < stage_cogl->n_redraw_clips; i++)
+        {
+          cairo_rectangle_int_t *other = &stage_cogl->redraw_clips[i];
+          gint64 growth;
+
+          _clutter_util_rectangle_union (&rect, other, &merged);
+          growth = rectangle_area (&merged) - rectangle_area (other);
+
+          if (growth < best_growth)
+            {
+              best_growth = growth;
+              best = i;
+            }
+        }
+
+      _clutter_util_rectangle_union (&rect,
+                                     &stage_cogl->redraw_clips[best],
+                                     &stage_cogl->redraw_clips[best]);
+      return;
+    }
+
+  stage_cogl->redraw_clips[stage_cogl->n_redraw_clips] = rect;
+  stage_cogl->n_redraw_clips += 1;
+}
+
 /* A redraw clip represents (in stage coordinates) the bounding box of
  * something that needs to be redraw. Typically they are added to the
  * StageWindow as a result of clutter_actor_queue_clipped_redraw() by
@@ -331,9 +514,11 @@ clutter_stage_cogl_ignoring_redraw_clips (ClutterStageWindow *stage_window)
  * A NULL stage_clip means the whole stage needs to be redrawn.
  *
  * What we do with this information:
- * - we keep track of the bounding box for all redraw clips
- * - when we come to redraw; we scissor the redraw to that box and use
- *   glBlitFramebuffer to present the redraw to the front
+ * - we keep track of a small set of disjoint rectangles, merging
+ *   the ones that are close to each other, as well as the bounding
+ *   box of all the redraw clips
+ * - when we come to redraw; we scissor the redraw to each rectangle
+ *   and use glBlitFramebuffer to present the rectangles to the front
  *   buffer.
  */
 static void
@@ -352,6 +537,7 @@ clutter_stage_cogl_add_redraw_clip (ClutterStageWindow    *stage_window,
   if (stage_clip == NULL)
     {
       stage_cogl->bounding_redraw_clip.width = 0;
+      stage_cogl->n_redraw_clips = 0;
       stage_cogl->initialized_redraw_clip = TRUE;
       return;
     }
@@ -363,6 +549,7 @@ clutter_stage_cogl_add_redraw_clip (ClutterStageWindow    *stage_window,
   if (!stage_cogl->initialized_redraw_clip)
     {
       stage_cogl->bounding_redraw_clip = *stage_clip;
+      stage_cogl->n_redraw_clips = 0;
     }
   else if (stage_cogl->bounding_redraw_clip.width > 0)
     {
@@ -371,6 +558,8 @@ clutter_stage_cogl_add_redraw_clip (ClutterStageWindow    *stage_window,
                                      &stage_cogl->bounding_redraw_clip);
     }
 
+  clutter_stage_cogl_add_redraw_rectangle (stage_cogl, stage_clip);
+
   stage_cogl->initialized_redraw_clip = TRUE;
 }
 
@@ -382,7 +571,7 @@ clutter_stage_cogl_get_redraw_clip_bounds (ClutterStageWindow    *stage_window,
 
   if (stage_cogl->using_clipped_redraw)
     {
-      *stage_clip = stage_cogl->bounding_redraw_clip;
+      *stage_clip = *stage_cogl->current_redraw_clip;
 
       return TRUE;
     }
@@ -390,6 +579,102 @@ clutter_stage_cogl_get_redraw_clip_bounds (ClutterStageWindow    *stage_window,
   return FALSE;
 }
 
+/* painting each rectangle separately means traversing the scene graph
+ * once for each of them, so we only do it if the rectangles cover
+ * a much smaller area than their bounding box does
+ */
+static gboolean
+clutter_stage_cogl_should_paint_redraw_clips (ClutterStageCogl *stage_cogl)
+{
+  gint64 area = 0;
+  guint i;
+
+  if (stage_cogl->n_redraw_clips < 2)
+    return FALSE;
+
+  for (i = 0; i < stage_cogl->n_redraw_clips; i++)
+    area += rectangle_area (&stage_cogl->redraw_clips[i]);
+
+  return area * 4 < rectangle_area (&stage_cogl->bounding_redraw_clip) * 3;
+}
+
+static void
+clutter_stage_cogl_reset_damage_history (ClutterStageCogl *stage_cogl)
+{
+  stage_cogl->n_damage_history = 0;
+}
+
+/* Stores @damage as the damage of the current frame; a %NULL @damage
+ * means that the whole stage has been repainted
+ */
+static void
+clutter_stage_cogl_push_damage (ClutterStageCogl             *stage_cogl,
+                                const ClutterStageCoglDamage *damage)
+{
+  ClutterStageCoglDamage *entry;
+
+  stage_cogl->damage_index = (stage_cogl->damage_index + 1)
+                           % CLUTTER_STAGE_COGL_DAMAGE_HISTORY;
+
+  entry = &stage_cogl->damage_history[stage_cogl->damage_index];
+
+  if (damage != NULL)
+    *entry = *damage;
+  else
+    entry->n_rects = 0;
+
+  if (stage_cogl->n_damage_history < CLUTTER_STAGE_COGL_DAMAGE_HISTORY)
+    stage_cogl->n_damage_history += 1;
+}
+
+/* A back buffer with an age of N contains the contents of the frame
+ * we painted N frames ago, so we need to repair the areas damaged by
+ * the previous N - 1 frames, on top of the current damage.
+ *
+ * Returns %FALSE if the history is not long enough, or if one of the
+ * previous frames repainted the whole stage.
+ */
+static gboolean
+clutter_stage_cogl_add_buffer_age_damage (ClutterStageCogl *stage_cogl,
+                                          int               age)
+{
+  int i;
+
+  if (age <= 0 || age - 1 > (int) stage_cogl->n_damage_history)
+    return FALSE;
+
+  for (i = 0; i < age - 1; i++)
+    {
+      guint index_ = (stage_cogl->damage_index
+                      + CLUTTER_STAGE_COGL_DAMAGE_HISTORY - i)
+                   % CLUTTER_STAGE_COGL_DAMAGE_HISTORY;
+
+      if (stage_cogl->damage_history[index_].n_rects == 0)
+        return FALSE;
+    }
+
+  for (i = 0; i < age - 1; i++)
+    {
+      guint index_ = (stage_cogl->damage_index
+                      + CLUTTER_STAGE_COGL_DAMAGE_HISTORY - i)
+                   % CLUTTER_STAGE_COGL_DAMAGE_HISTORY;
+      const ClutterStageCoglDamage *damage =
+        &stage_cogl->damage_history[index_];
+      guint j;
+
+      for (j = 0; j < damage->n_rects; j++)
+        {
+          _clutter_util_rectangle_union (&stage_cogl->bounding_redraw_clip,
+                                         &damage->rects[j],
+                                         &stage_cogl->bounding_redraw_clip);
+          clutter_stage_cogl_add_redraw_rectangle (stage_cogl,
+                                                   &damage->rects[j]);
+        }
+    }
+
+  return TRUE;
+}
+
 /* XXX: This is basically identical to clutter_stage_glx_redraw */
 static void
 clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
@@ -397,11 +682,13 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
   ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
   gboolean may_use_clipped_redraw;
   gboolean use_clipped_redraw;
+  gboolean use_redraw_clips;
   gboolean can_blit_sub_buffer;
   gboolean has_buffer_age;
   ClutterActor *wrapper;
   cairo_rectangle_int_t *clip_region;
   gboolean force_swap;
+  gint64 swap_start = 0;
 
   CLUTTER_STATIC_TIMER (painting_timer,
                         "Redrawing", /* parent */
@@ -426,6 +713,8 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
 
   CLUTTER_TIMER_START (_clutter_uprof_context, painting_timer);
 
+  _clutter_stage_begin_gpu_timer (stage_cogl->wrapper);
+
   can_blit_sub_buffer =
     cogl_clutter_winsys_has_feature (COGL_WINSYS_FEATURE_SWAP_REGION);
 
@@ -433,7 +722,7 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
 
   may_use_clipped_redraw = FALSE;
   if (_clutter_stage_window_can_clip_redraws (stage_window) &&
-      can_blit_sub_buffer &&
+      (can_blit_sub_buffer || has_buffer_age) &&
       /* NB: a zero width redraw clip == full stage redraw */
       stage_cogl->bounding_redraw_clip.width != 0 &&
       /* some drivers struggle to get going and produce some junk
@@ -453,65 +742,96 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
 
   force_swap = FALSE;
 
-  if (use_clipped_redraw)
+  if (use_clipped_redraw && has_buffer_age)
     {
-      if (has_buffer_age)
-      {
-        int age = cogl_onscreen_get_buffer_age (stage_cogl->onscreen);
-        cairo_rectangle_int_t *current_damage;
-
-        current_damage = g_new0 (cairo_rectangle_int_t, 1);
-        current_damage->x = clip_region->x;
-        current_damage->y = clip_region->y;
-        current_damage->width = clip_region->width;
-        current_damage->height = clip_region->height;
-
-        stage_cogl->damage_history = g_slist_prepend (stage_cogl->damage_history, current_damage);
-
-        if (age != 0 && !stage_cogl->dirty_backbuffer && g_slist_length (stage_cogl->damage_history) >= age)
-          {
-            int i = 0;
-            GSList *tmp = NULL;
-            for (tmp = stage_cogl->damage_history; tmp; tmp = tmp->next)
-              {
-                _clutter_util_rectangle_union (clip_region, tmp->data, clip_region);
-                i++;
-                if (i == age)
-                  {
-                    g_slist_free_full (tmp->next, g_free);
-                    tmp->next = NULL;
-                  }
-              }
-
-            force_swap = TRUE;
-
-            CLUTTER_NOTE (CLIPPING, "Reusing back buffer - repairing region: x=%d, y=%d, width=%d, height=%d\n",
-                    clip_region->x,
-                    clip_region->y,
-                    clip_region->width,
-                    clip_region->height);
+      int age = cogl_onscreen_get_buffer_age (stage_cogl->onscreen);
+      ClutterStageCoglDamage damage;
+
+      /* we need to remember what the current frame damaged before
+       * adding the damage of the previous frames to the redraw clips
+       */
+      damage.n_rects = stage_cogl->n_redraw_clips;
+      memcpy (damage.rects, stage_cogl->redraw_clips,
+              sizeof (cairo_rectangle_int_t) * damage.n_rects);
+
+      if (!stage_cogl->dirty_backbuffer &&
+          clutter_stage_cogl_add_buffer_age_damage (stage_cogl, age))
+        {
+          force_swap = TRUE;
+
+          CLUTTER_NOTE (CLIPPING, "Reusing back buffer (age: %d) - repairing "
+                        "%u rectangles inside: x=%d, y=%d, width=%d, height=%d\n",
+                        age,
+                        stage_cogl->n_redraw_clips,
+                        clip_region->x,
+                        clip_region->y,
+                        clip_region->width,
+                        clip_region->height);
+        }
+      else
+        {
+          CLUTTER_NOTE (CLIPPING, "Invalid back buffer (age: %d): "
+                        "performing a full redraw\n", age);
 
-          }
-        else if (age == 0 || stage_cogl->dirty_backbuffer)
-          {
-            CLUTTER_NOTE (CLIPPING, "Invalid back buffer: Resetting damage history list.\n");
-            g_slist_free_full (stage_cogl->damage_history, g_free);
-            stage_cogl->damage_history = NULL;
-          }
+          use_clipped_redraw = FALSE;
+        }
 
-      }
+      clutter_stage_cogl_push_damage (stage_cogl,
+                                      use_clipped_redraw ? &damage : NULL);
+    }
+  else if (use_clipped_redraw)
+    {
+      /* swapping regions copies the back buffer, so the history of
+       * the back buffer contents is unknown
+       */
+      clutter_stage_cogl_reset_damage_history (stage_cogl);
     }
   else
     {
-      CLUTTER_NOTE (CLIPPING, "Unclipped redraw: Resetting damage history list.\n");
-      g_slist_free_full (stage_cogl->damage_history, g_free);
-      stage_cogl->damage_history = NULL;
+      CLUTTER_NOTE (CLIPPING, "Unclipped redraw: the whole stage is damaged\n");
+
+      if (has_buffer_age)
+        clutter_stage_cogl_push_damage (stage_cogl, NULL);
+      else
+        clutter_stage_cogl_reset_damage_history (stage_cogl);
     }
 
-  if (has_buffer_age && !force_swap)
-    use_clipped_redraw = FALSE;
+  use_redraw_clips = use_clipped_redraw &&
+                     clutter_stage_cogl_should_paint_redraw_clips (stage_cogl);
+
+  if (use_redraw_clips)
+    {
+      guint i;
+
+      stage_cogl->using_clipped_redraw = TRUE;
+
+      for (i = 0; i < stage_cogl->n_redraw_clips; i++)
+        {
+          const cairo_rectangle_int_t *clip = &stage_cogl->redraw_clips[i];
+
+          CLUTTER_NOTE (CLIPPING,
+                        "Stage clip %u pushed: x=%d, y=%d, width=%d, height=%d\n",
+                        i,
+                        clip->x,
+                        clip->y,
+                        clip->width,
+                        clip->height);
+
+          stage_cogl->current_redraw_clip = clip;
+
+          cogl_clip_push_window_rectangle (clip->x,
+                                           clip->y,
+                                           clip->width,
+                                           clip->height);
+          _clutter_stage_do_paint (CLUTTER_STAGE (wrapper),
+                                   clip);
+          cogl_clip_pop ();
+        }
 
-  if (use_clipped_redraw)
+      stage_cogl->current_redraw_clip = NULL;
+      stage_cogl->using_clipped_redraw = FALSE;
+    }
+  else if (use_clipped_redraw)
     {
       CLUTTER_NOTE (CLIPPING,
                     "Stage clip pushed: x=%d, y=%d, width=%d, height=%d\n",
@@ -521,6 +841,7 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
                     clip_region->height);
 
       stage_cogl->using_clipped_redraw = TRUE;
+      stage_cogl->current_redraw_clip = clip_region;
 
       cogl_clip_push_window_rectangle (clip_region->x,
                                        clip_region->y,
@@ -530,6 +851,7 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
                                clip_region);
       cogl_clip_pop ();
 
+      stage_cogl->current_redraw_clip = NULL;
       stage_cogl->using_clipped_redraw = FALSE;
     }
   else
@@ -594,8 +916,66 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
 
   CLUTTER_TIMER_STOP (_clutter_uprof_context, painting_timer);
 
+  /* the back buffer is still valid until we swap it */
+  if (use_redraw_clips)
+    _clutter_stage_queue_captures (stage_cogl->wrapper,
+                                   stage_cogl->redraw_clips,
+                                   stage_cogl->n_redraw_clips);
+  else if (use_clipped_redraw)
+    _clutter_stage_queue_captures (stage_cogl->wrapper, clip_region, 1);
+  else
+    _clutter_stage_queue_captures (stage_cogl->wrapper, NULL, 0);
+
+  /* remember the input presented by this frame, so that we can
+   * report its latency once the frame is complete
+   */
+  {
+    gint64 frame_counter = cogl_onscreen_get_frame_counter (stage_cogl->onscreen);
+    guint index_ = frame_counter % CLUTTER_STAGE_COGL_PENDING_FRAMES;
+
+    stage_cogl->frame_counters[index_] = frame_counter;
+    stage_cogl->frame_input_times[index_] =
+      _clutter_stage_take_input_time (stage_cogl->wrapper);
+  }
+
+  _clutter_stage_end_gpu_timer (stage_cogl->wrapper);
+
+  if (_clutter_stage_get_collect_frame_stats (stage_cogl->wrapper))
+    swap_start = g_get_monotonic_time ();
+
+  CLUTTER_TRACE_BEGIN ("Swap buffers");
+
   /* push on the screen */
-  if (use_clipped_redraw && !force_swap)
+  if (use_redraw_clips && !force_swap)
+    {
+      int copy_area[CLUTTER_STAGE_COGL_MAX_REDRAW_CLIPS * 4];
+      guint i;
+
+      for (i = 0; i < stage_cogl->n_redraw_clips; i++)
+        {
+          const cairo_rectangle_int_t *clip = &stage_cogl->redraw_clips[i];
+
+          copy_area[i * 4 + 0] = clip->x;
+          copy_area[i * 4 + 1] = clip->y;
+          copy_area[i * 4 + 2] = clip->width;
+          copy_area[i * 4 + 3] = clip->height;
+        }
+
+      CLUTTER_NOTE (BACKEND,
+                    "cogl_onscreen_swap_region (onscreen: %p, "
+                                                "n_rectangles: %u)",
+                    stage_cogl->onscreen,
+                    stage_cogl->n_redraw_clips);
+
+      CLUTTER_TIMER_START (_clutter_uprof_context, blit_sub_buffer_timer);
+
+      cogl_onscreen_swap_region (stage_cogl->onscreen,
+                                 copy_area,
+                                 stage_cogl->n_redraw_clips);
+
+      CLUTTER_TIMER_STOP (_clutter_uprof_context, blit_sub_buffer_timer);
+    }
+  else if (use_clipped_redraw && !force_swap)
     {
       cairo_rectangle_int_t *clip = clip_region;
       int copy_area[4];
@@ -635,7 +1015,12 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
 
       /* If we have swap buffer events then cogl_onscreen_swap_buffers
        * will return immediately and we need to track that there is a
-       * swap in progress... */
+       * swap in progress...
+       *
+       * NB: the swap cannot be moved to a rendering thread, since the
+       * Cogl context is not thread safe and it is shared by everything
+       * that paints or uploads textures; the swap events are what keeps
+       * the main thread from blocking on the vertical refresh. */
       if (clutter_feature_available (CLUTTER_FEATURE_SWAP_EVENTS))
         stage_cogl->pending_swaps++;
 
@@ -644,8 +1029,15 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
       CLUTTER_TIMER_STOP (_clutter_uprof_context, swapbuffers_timer);
     }
 
+  CLUTTER_TRACE_END ();
+
+  if (swap_start != 0)
+    _clutter_stage_report_swap_wait_time (stage_cogl->wrapper,
+                                          g_get_monotonic_time () - swap_start);
+
   /* reset the redraw clipping for the next paint... */
   stage_cogl->initialized_redraw_clip = FALSE;
+  stage_cogl->n_redraw_clips = 0;
 
   /* We have repaired the backbuffer */
   stage_cogl->dirty_backbuffer = FALSE;
@@ -673,20 +1065,22 @@ static void
 clutter_stage_cogl_get_dirty_pixel (ClutterStageWindow *stage_window,
                                     int *x, int *y)
 {
-    ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
-    gboolean has_buffer_age = cogl_clutter_winsys_has_feature (COGL_WINSYS_FEATURE_BUFFER_AGE);
-    if ((stage_cogl->damage_history == NULL && has_buffer_age) || !has_buffer_age)
-      {
-        *x = 0;
-        *y = 0;
-      }
-    else
-     {
-        cairo_rectangle_int_t *rect;
-        rect = (cairo_rectangle_int_t *) (stage_cogl->damage_history->data);
-        *x = rect->x;
-        *y = rect->y;
-     }
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+  const ClutterStageCoglDamage *damage;
+
+  *x = 0;
+  *y = 0;
+
+  if (stage_cogl->n_damage_history == 0)
+    return;
+
+  /* the last damaged area will be repaired by the next redraw */
+  damage = &stage_cogl->damage_history[stage_cogl->damage_index];
+  if (damage->n_rects > 0)
+    {
+      *x = damage->rects[0].x;
+      *y = damage->rects[0].y;
+    }
 }
 
 static void
@@ -702,6 +1096,8 @@ clutter_stage_window_iface_init (ClutterStageWindowIface *iface)
   iface->schedule_update = clutter_stage_cogl_schedule_update;
   iface->get_update_time = clutter_stage_cogl_get_update_time;
   iface->clear_update_time = clutter_stage_cogl_clear_update_time;
+  iface->get_next_presentation_time = clutter_stage_cogl_get_next_presentation_time;
+  iface->get_refresh_interval = clutter_stage_cogl_real_get_refresh_interval;
   iface->add_redraw_clip = clutter_stage_cogl_add_redraw_clip;
   iface->has_redraw_clips = clutter_stage_cogl_has_redraw_clips;
   iface->ignoring_redraw_clips = clutter_stage_cogl_ignoring_redraw_clips;
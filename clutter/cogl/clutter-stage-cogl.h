@@ -20,9 +20,31 @@ G_BEGIN_DECLS
 #define CLUTTER_IS_STAGE_COGL_CLASS(klass)       (G_TYPE_CHECK_CLASS_TYPE ((klass), CLUTTER_TYPE_STAGE_COGL))
 #define CLUTTER_STAGE_COGL_GET_CLASS(obj)        (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_STAGE_COGL, ClutterStageCoglClass))
 
+/* the maximum number of disjoint redraw clips we keep for each frame */
+#define CLUTTER_STAGE_COGL_MAX_REDRAW_CLIPS     8
+
+/* the number of frames whose damage we remember; back buffers
+ * older than this are repainted in full
+ */
+#define CLUTTER_STAGE_COGL_DAMAGE_HISTORY       4
+
+/* the number of swapped frames whose input time we remember, while
+ * waiting for their presentation
+ */
+#define CLUTTER_STAGE_COGL_PENDING_FRAMES        4
+
+typedef struct _ClutterStageCoglDamage   ClutterStageCoglDamage;
 typedef struct _ClutterStageCogl         ClutterStageCogl;
 typedef struct _ClutterStageCoglClass    ClutterStageCoglClass;
 
+struct _ClutterStageCoglDamage
+{
+  cairo_rectangle_int_t rects[CLUTTER_STAGE_COGL_MAX_REDRAW_CLIPS];
+
+  /* zero means that the whole stage was damaged */
+  guint n_rects;
+};
+
 struct _ClutterStageCogl
 {
   GObject parent_instance;
@@ -49,16 +71,35 @@ struct _ClutterStageCogl
 
   cairo_rectangle_int_t bounding_redraw_clip;
 
+  /* the disjoint areas to redraw; bounding_redraw_clip is the union
+   * of these rectangles
+   */
+  cairo_rectangle_int_t redraw_clips[CLUTTER_STAGE_COGL_MAX_REDRAW_CLIPS];
+  guint n_redraw_clips;
+
+  /* the redraw clip being painted, while using_clipped_redraw is set */
+  const cairo_rectangle_int_t *current_redraw_clip;
+
   guint initialized_redraw_clip : 1;
 
   /* TRUE if the current paint cycle has a clipped redraw. In that
-     case bounding_redraw_clip specifies the the bounds. */
+     case current_redraw_clip specifies the the bounds. */
   guint using_clipped_redraw : 1;
 
   guint dirty_backbuffer     : 1;
 
-  /* Stores a list of previous damaged areas */
-  GSList *damage_history;
+  /* a ring of the areas damaged by the previous frames, used to
+   * repair back buffers with an age greater than one
+   */
+  ClutterStageCoglDamage damage_history[CLUTTER_STAGE_COGL_DAMAGE_HISTORY];
+  guint damage_index;
+  guint n_damage_history;
+
+  /* the origin time of the oldest input event of each frame in
+   * flight, indexed by the frame counter
+   */
+  gint64 frame_input_times[CLUTTER_STAGE_COGL_PENDING_FRAMES];
+  gint64 frame_counters[CLUTTER_STAGE_COGL_PENDING_FRAMES];
 };
 
 struct _ClutterStageCoglClass
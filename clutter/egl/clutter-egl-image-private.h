@@ -0,0 +1,43 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2012  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_EGL_IMAGE_PRIVATE_H__
+#define __CLUTTER_EGL_IMAGE_PRIVATE_H__
+
+#include "clutter-egl.h"
+
+G_BEGIN_DECLS
+
+gboolean        _clutter_egl_get_dma_buf_format         (guint32            drm_format,
+                                                         CoglPixelFormat   *pixel_format);
+
+CoglTexture *   _clutter_egl_texture_new_from_dma_buf   (gint               fd,
+                                                         guint              width,
+                                                         guint              height,
+                                                         guint              row_stride,
+                                                         guint              offset,
+                                                         guint32            drm_format,
+                                                         CoglPixelFormat    pixel_format,
+                                                         GError           **error);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_EGL_IMAGE_PRIVATE_H__ */
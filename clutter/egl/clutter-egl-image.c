@@ -0,0 +1,425 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2012  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "clutter-egl-image-private.h"
+
+#include "clutter-backend.h"
+#include "clutter-debug.h"
+#include "clutter-image-private.h"
+#include "clutter-main.h"
+#include "clutter-private.h"
+
+#ifndef EGL_EXT_image_dma_buf_import
+#define EGL_LINUX_DMA_BUF_EXT           0x3270
+#define EGL_LINUX_DRM_FOURCC_EXT        0x3271
+#define EGL_DMA_BUF_PLANE0_FD_EXT       0x3272
+#define EGL_DMA_BUF_PLANE0_OFFSET_EXT   0x3273
+#define EGL_DMA_BUF_PLANE0_PITCH_EXT    0x3274
+#endif
+
+#define FOURCC(a,b,c,d) \
+  ((guint32) (a) | ((guint32) (b) << 8) | ((guint32) (c) << 16) | ((guint32) (d) << 24))
+
+/* we only handle the single plane RGB formats that Cogl can sample
+ * from; YUV frames need a shader-based conversion, and should be
+ * imported as separate planes. The formats without alpha use an
+ * RGB internal format, so that the padding byte is ignored
+ */
+static const struct {
+  guint32 drm_format;
+  CoglPixelFormat pixel_format;
+} dma_buf_formats[] = {
+  { FOURCC ('A', 'R', '2', '4'), COGL_PIXEL_FORMAT_BGRA_8888_PRE },
+  { FOURCC ('X', 'R', '2', '4'), COGL_PIXEL_FORMAT_RGB_888 },
+  { FOURCC ('A', 'B', '2', '4'), COGL_PIXEL_FORMAT_RGBA_8888_PRE },
+  { FOURCC ('X', 'B', '2', '4'), COGL_PIXEL_FORMAT_RGB_888 },
+  { FOURCC ('R', 'G', '1', '6'), COGL_PIXEL_FORMAT_RGB_565 },
+};
+
+static EGLDisplay
+clutter_egl_get_display_for_import (GError **error)
+{
+  EGLDisplay edpy = EGL_NO_DISPLAY;
+
+#ifdef COGL_HAS_EGL_SUPPORT
+  if (_clutter_context_is_initialized ())
+    {
+      ClutterBackend *backend = clutter_get_default_backend ();
+      CoglContext *context = clutter_backend_get_cogl_context (backend);
+      CoglRenderer *renderer;
+
+      /* the EGL display is also available to the X11 and Wayland
+       * backends, as long as Cogl is using an EGL winsys
+       */
+      renderer = cogl_display_get_renderer (cogl_context_get_display (context));
+      switch (cogl_renderer_get_winsys_id (renderer))
+        {
+        case COGL_WINSYS_ID_EGL_XLIB:
+        case COGL_WINSYS_ID_EGL_NULL:
+        case COGL_WINSYS_ID_EGL_GDL:
+        case COGL_WINSYS_ID_EGL_WAYLAND:
+        case COGL_WINSYS_ID_EGL_KMS:
+        case COGL_WINSYS_ID_EGL_ANDROID:
+          edpy = cogl_egl_context_get_egl_display (context);
+          break;
+
+        default:
+          break;
+        }
+    }
+#endif
+
+  if (edpy == EGL_NO_DISPLAY)
+    g_set_error_literal (error, CLUTTER_IMAGE_ERROR,
+                         CLUTTER_IMAGE_ERROR_INVALID_DATA,
+                         _("The Clutter backend is not using EGL"));
+
+  return edpy;
+}
+
+static gboolean
+clutter_egl_has_extension (EGLDisplay   edpy,
+                           const gchar *name)
+{
+  const gchar *extensions, *end;
+  gsize len;
+
+  extensions = eglQueryString (edpy, EGL_EXTENSIONS);
+  if (extensions == NULL)
+    return FALSE;
+
+  len = strlen (name);
+
+  while (*extensions != '\0')
+    {
+      end = strchr (extensions, ' ');
+      if (end == NULL)
+        end = extensions + strlen (extensions);
+
+      if ((gsize) (end - extensions) == len &&
+          strncmp (extensions, name, len) == 0)
+        return TRUE;
+
+      extensions = *end == ' ' ? end + 1 : end;
+    }
+
+  return FALSE;
+}
+
+static CoglTexture *
+clutter_egl_texture_new_from_image (EGLImageKHR       egl_image,
+                                    guint             width,
+                                    guint             height,
+                                    CoglPixelFormat   pixel_format,
+                                    GError          **error)
+{
+  CoglTexture *texture = NULL;
+
+  if (clutter_egl_get_display_for_import (error) == EGL_NO_DISPLAY)
+    return NULL;
+
+#if defined(COGL_HAS_EGL_SUPPORT) && COGL_VERSION_CHECK (1, 18, 0)
+  {
+    ClutterBackend *backend = clutter_get_default_backend ();
+    CoglContext *context = clutter_backend_get_cogl_context (backend);
+
+    texture = (CoglTexture *)
+      cogl_egl_texture_2d_new_from_image (context,
+                                          width, height,
+                                          pixel_format,
+                                          egl_image,
+                                          error);
+    if (texture == NULL)
+      return NULL;
+  }
+#endif
+
+  if (texture == NULL)
+    g_set_error_literal (error, CLUTTER_IMAGE_ERROR,
+                         CLUTTER_IMAGE_ERROR_INVALID_DATA,
+                         _("Importing EGL images is not supported"));
+
+  return texture;
+}
+
+/**
+ * clutter_egl_image_set_egl_image:
+ * @image: a #ClutterImage
+ * @egl_image: an <structname>EGLImageKHR</structname>
+ * @width: the width of @egl_image
+ * @height: the height of @egl_image
+ * @pixel_format: the format of the data inside @egl_image
+ * @error: return location for a #GError, or %NULL
+ *
+ * Sets the contents of @image to be the contents of @egl_image,
+ * without copying them.
+ *
+ * The @egl_image can be destroyed once this function returns; the
+ * storage is kept alive by the texture used by @image. Any change to
+ * the storage will be visible on the next paint, but the @image must
+ * be invalidated with clutter_content_invalidate() to schedule it.
+ *
+ * If the image data was successfully set, the @image will be
+ * invalidated.
+ *
+ * Return value: %TRUE if the image data was successfully set,
+ *   and %FALSE otherwise.
+ *
+ * Stability: unstable
+ */
+gboolean
+clutter_egl_image_set_egl_image (ClutterImage     *image,
+                                 EGLImageKHR       egl_image,
+                                 guint             width,
+                                 guint             height,
+                                 CoglPixelFormat   pixel_format,
+                                 GError          **error)
+{
+  CoglTexture *texture;
+
+  g_return_val_if_fail (CLUTTER_IS_IMAGE (image), FALSE);
+  g_return_val_if_fail (egl_image != EGL_NO_IMAGE_KHR, FALSE);
+
+  texture = clutter_egl_texture_new_from_image (egl_image,
+                                                width, height,
+                                                pixel_format,
+                                                error);
+  if (texture == NULL)
+    return FALSE;
+
+  _clutter_image_set_texture (image, texture);
+  cogl_object_unref (texture);
+
+  return TRUE;
+}
+
+/**
+ * clutter_egl_image_set_dma_buf:
+ * @image: a #ClutterImage
+ * @fd: the file descriptor of a dma-buf
+ * @width: the width of the buffer
+ * @height: the height of the buffer
+ * @row_stride: the length of each row inside the buffer
+ * @offset: the offset of the first pixel inside the buffer
+ * @drm_format: the DRM fourcc code of the format of the buffer
+ * @error: return location for a #GError, or %NULL
+ *
+ * Sets the contents of @image to be the contents of the dma-buf
+ * @fd, without copying them.
+ *
+ * This function requires the <literal>EGL_EXT_image_dma_buf_import</literal>
+ * extension, and only supports single plane RGB formats, like
+ * <literal>DRM_FORMAT_ARGB8888</literal> and <literal>DRM_FORMAT_XRGB8888</literal>.
+ *
+ * The @image does not take ownership of @fd, which can be closed once
+ * this function returns.
+ *
+ * If the image data was successfully set, the @image will be
+ * invalidated.
+ *
+ * Return value: %TRUE if the image data was successfully set,
+ *   and %FALSE otherwise.
+ *
+ * Stability: unstable
+ */
+gboolean
+clutter_egl_image_set_dma_buf (ClutterImage  *image,
+                               gint           fd,
+                               guint          width,
+                               guint          height,
+                               guint          row_stride,
+                               guint          offset,
+                               guint32        drm_format,
+                               GError       **error)
+{
+  CoglPixelFormat pixel_format;
+  CoglTexture *texture;
+
+  g_return_val_if_fail (CLUTTER_IS_IMAGE (image), FALSE);
+  g_return_val_if_fail (fd >= 0, FALSE);
+  g_return_val_if_fail (width > 0 && height > 0, FALSE);
+
+  if (!_clutter_egl_get_dma_buf_format (drm_format, &pixel_format))
+    {
+      g_set_error (error, CLUTTER_IMAGE_ERROR,
+                   CLUTTER_IMAGE_ERROR_INVALID_DATA,
+                   _("Unsupported dma-buf format '%c%c%c%c'"),
+                   drm_format & 0xff,
+                   (drm_format >> 8) & 0xff,
+                   (drm_format >> 16) & 0xff,
+                   (drm_format >> 24) & 0xff);
+      return FALSE;
+    }
+
+  texture = _clutter_egl_texture_new_from_dma_buf (fd, width, height,
+                                                   row_stride, offset,
+                                                   drm_format,
+                                                   pixel_format,
+                                                   error);
+  if (texture == NULL)
+    return FALSE;
+
+  _clutter_image_set_texture (image, texture);
+  cogl_object_unref (texture);
+
+  return TRUE;
+}
+
+/*< private >
+ * _clutter_egl_get_dma_buf_format:
+ * @drm_format: a DRM fourcc code
+ * @pixel_format: (out): return location for the Cogl pixel format
+ *
+ * Checks whether dma-buf with the single plane RGB format @drm_format
+ * can be imported.
+ *
+ * Return value: %TRUE if the format is supported
+ */
+gboolean
+_clutter_egl_get_dma_buf_format (guint32          drm_format,
+                                 CoglPixelFormat *pixel_format)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (dma_buf_formats); i++)
+    {
+      if (dma_buf_formats[i].drm_format == drm_format)
+        {
+          *pixel_format = dma_buf_formats[i].pixel_format;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+/*< private >
+ * _clutter_egl_texture_new_from_dma_buf:
+ * @fd: the file descriptor of a dma-buf
+ * @width: the width of the buffer
+ * @height: the height of the buffer
+ * @row_stride: the length of each row inside the buffer
+ * @offset: the offset of the first pixel inside the buffer
+ * @drm_format: the DRM fourcc code of the format of the buffer
+ * @pixel_format: the Cogl pixel format of the texture
+ * @error: return location for a #GError, or %NULL
+ *
+ * Imports a single plane of a dma-buf into a texture, without copying
+ * it; the planes of YUV buffers can be imported one at a time by using
+ * formats like <literal>DRM_FORMAT_R8</literal> and
+ * <literal>DRM_FORMAT_GR88</literal>.
+ *
+ * Return value: (transfer full): a new texture, or %NULL
+ */
+CoglTexture *
+_clutter_egl_texture_new_from_dma_buf (gint              fd,
+                                       guint             width,
+                                       guint             height,
+                                       guint             row_stride,
+                                       guint             offset,
+                                       guint32           drm_format,
+                                       CoglPixelFormat   pixel_format,
+                                       GError          **error)
+{
+  static PFNEGLCREATEIMAGEKHRPROC create_image = NULL;
+  static PFNEGLDESTROYIMAGEKHRPROC destroy_image = NULL;
+  CoglTexture *texture;
+  EGLDisplay edpy;
+  EGLImageKHR egl_image;
+  EGLint attribs[13];
+  guint i;
+
+  edpy = clutter_egl_get_display_for_import (error);
+  if (edpy == EGL_NO_DISPLAY)
+    return NULL;
+
+  if (create_image == NULL)
+    {
+      if (!clutter_egl_has_extension (edpy, "EGL_EXT_image_dma_buf_import"))
+        {
+          g_set_error_literal (error, CLUTTER_IMAGE_ERROR,
+                               CLUTTER_IMAGE_ERROR_INVALID_DATA,
+                               _("Importing dma-buf is not supported"));
+          return NULL;
+        }
+
+      create_image = (PFNEGLCREATEIMAGEKHRPROC)
+        eglGetProcAddress ("eglCreateImageKHR");
+      destroy_image = (PFNEGLDESTROYIMAGEKHRPROC)
+        eglGetProcAddress ("eglDestroyImageKHR");
+
+      if (create_image == NULL || destroy_image == NULL)
+        {
+          create_image = NULL;
+          g_set_error_literal (error, CLUTTER_IMAGE_ERROR,
+                               CLUTTER_IMAGE_ERROR_INVALID_DATA,
+                               _("Importing dma-buf is not supported"));
+          return NULL;
+        }
+    }
+
+  i = 0;
+  attribs[i++] = EGL_WIDTH;
+  attribs[i++] = width;
+  attribs[i++] = EGL_HEIGHT;
+  attribs[i++] = height;
+  attribs[i++] = EGL_LINUX_DRM_FOURCC_EXT;
+  attribs[i++] = drm_format;
+  attribs[i++] = EGL_DMA_BUF_PLANE0_FD_EXT;
+  attribs[i++] = fd;
+  attribs[i++] = EGL_DMA_BUF_PLANE0_OFFSET_EXT;
+  attribs[i++] = offset;
+  attribs[i++] = EGL_DMA_BUF_PLANE0_PITCH_EXT;
+  attribs[i++] = row_stride;
+  attribs[i++] = EGL_NONE;
+
+  egl_image = create_image (edpy, EGL_NO_CONTEXT,
+                            EGL_LINUX_DMA_BUF_EXT,
+                            NULL,
+                            attribs);
+  if (egl_image == EGL_NO_IMAGE_KHR)
+    {
+      g_set_error (error, CLUTTER_IMAGE_ERROR,
+                   CLUTTER_IMAGE_ERROR_INVALID_DATA,
+                   _("Unable to import the dma-buf (EGL error 0x%x)"),
+                   eglGetError ());
+      return NULL;
+    }
+
+  CLUTTER_NOTE (BACKEND, "Imported dma-buf %d (%ux%u, stride: %u)",
+                fd, width, height, row_stride);
+
+  texture = clutter_egl_texture_new_from_image (egl_image,
+                                                width, height,
+                                                pixel_format,
+                                                error);
+
+  /* the texture keeps a reference on the storage */
+  destroy_image (edpy, egl_image);
+
+  return texture;
+}
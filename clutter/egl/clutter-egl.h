@@ -47,6 +47,8 @@
 
 #include "clutter-egl-headers.h"
 
+#include <clutter/clutter.h>
+
 G_BEGIN_DECLS
 
 /**
@@ -87,6 +89,21 @@ EGLDisplay      clutter_egl_display             (void);
  */
 EGLDisplay      clutter_egl_get_egl_display     (void);
 
+gboolean        clutter_egl_image_set_egl_image (ClutterImage     *image,
+                                                 EGLImageKHR       egl_image,
+                                                 guint             width,
+                                                 guint             height,
+                                                 CoglPixelFormat   pixel_format,
+                                                 GError          **error);
+gboolean        clutter_egl_image_set_dma_buf   (ClutterImage     *image,
+                                                 gint              fd,
+                                                 guint             width,
+                                                 guint             height,
+                                                 guint             row_stride,
+                                                 guint             offset,
+                                                 guint32           drm_format,
+                                                 GError          **error);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_EGL_H__ */
@@ -26,11 +26,13 @@
 #endif
 
 #include <linux/input.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <glib.h>
@@ -45,6 +47,7 @@
 #include "clutter-main.h"
 #include "clutter-private.h"
 #include "clutter-stage-manager.h"
+#include "clutter-stage-private.h"
 #include "clutter-xkb-utils.h"
 #include "clutter-backend-private.h"
 #include "clutter-evdev.h"
@@ -60,10 +63,25 @@ G_DEFINE_TYPE (ClutterDeviceManagerEvdev,
                clutter_device_manager_evdev,
                CLUTTER_TYPE_DEVICE_MANAGER);
 
+typedef struct _DeviceProbe     DeviceProbe;
+
 struct _ClutterDeviceManagerEvdevPrivate
 {
   GUdevClient *udev_client;
 
+  /* opening a device node and querying its capabilities can block for
+   * a long time, e.g. with a slow USB hub, so the devices are probed
+   * by a worker thread; the pool has a single thread, which keeps the
+   * probes in the order of the udev events
+   */
+  GThreadPool *probe_pool;
+  GList *pending_probes;    /* the probes not handed back yet */
+  DeviceProbe *current_probe;
+
+  /* the keymap shared by all the keyboards */
+  struct xkb_keymap *keymap;
+  GMutex keymap_lock;
+
   ClutterStage *stage;
   gboolean released;
 
@@ -103,6 +121,24 @@ static const char *option_xkb_options = "";
 
 typedef struct _ClutterEventSource  ClutterEventSource;
 
+/* the number of events read at once from a device, and the maximum
+ * number of reads for each dispatch
+ */
+#define EVENT_BATCH_SIZE                64
+#define MAX_BATCHES_PER_DISPATCH        16
+
+/* the number of multi-touch slots we track for each device */
+#define N_TOUCH_SLOTS                   16
+
+typedef struct _TouchSlot
+{
+  gint tracking_id;                   /* -1 if the slot is not in use */
+  gint x, y;                          /* the position, in device units */
+
+  guint dirty  : 1;                   /* changed in the current frame */
+  guint active : 1;                   /* a touch begin has been emitted */
+} TouchSlot;
+
 struct _ClutterEventSource
 {
   GSource source;
@@ -110,8 +146,48 @@ struct _ClutterEventSource
   ClutterInputDeviceEvdev *device;    /* back pointer to the evdev device */
   GPollFD event_poll_fd;              /* file descriptor of the /dev node */
   struct xkb_state *xkb;              /* XKB state object */
-  gint x, y;                          /* last x, y position for pointers */
+  gfloat x, y;                        /* last x, y position for pointers */
   guint32 modifier_state;             /* key modifiers */
+
+  /* the state accumulated since the last SYN_REPORT */
+  gint dx, dy;                        /* relative motion */
+  gint abs_x_value, abs_y_value;      /* absolute position */
+  gboolean abs_dirty;
+  gboolean syn_dropped;
+
+  /* the ranges of the absolute axes */
+  struct input_absinfo abs_x, abs_y;
+  struct input_absinfo abs_mt_x, abs_mt_y;
+
+  gint current_slot;
+  TouchSlot slots[N_TOUCH_SLOTS];
+
+  /* whether the kernel uses the monotonic clock for the timestamps,
+   * and the timestamp of the event being processed, in microseconds
+   */
+  gboolean monotonic_time;
+  gint64 origin_time;
+};
+
+/*
+ * The result of probing a device in the probing thread
+ */
+struct _DeviceProbe
+{
+  ClutterDeviceManagerEvdev *manager;
+  GUdevDevice *udev_device;
+
+  /* the new device, or NULL if it should be ignored */
+  ClutterInputDeviceEvdev *device;
+
+  /* the opened device node, and its capabilities */
+  gint fd;
+  gboolean monotonic_time;
+  struct input_absinfo abs_x, abs_y;
+  struct input_absinfo abs_mt_x, abs_mt_y;
+
+  /* set if the device is removed while being probed */
+  gboolean cancelled;
 };
 
 static gboolean
@@ -146,13 +222,35 @@ clutter_event_check (GSource *source)
   return retval;
 }
 
+/* maps the value of an absolute axis to the [0, size) range */
+static gfloat
+scale_abs_value (const struct input_absinfo *info,
+                 gint                        value,
+                 gfloat                      size)
+{
+  if (info->maximum <= info->minimum)
+    return value;
+
+  return (gfloat) (value - info->minimum) * size
+       / (gfloat) (info->maximum - info->minimum + 1);
+}
+
 static void
-queue_event (ClutterEvent *event)
+queue_event (ClutterEventSource *source,
+             ClutterStage       *stage,
+             const ClutterEvent *event)
 {
-  if (event == NULL)
-    return;
+  /* the stage ring does not use the Clutter lock; if it is full we
+   * fall back to the stage queue, which drains the ring first and
+   * keeps the events in order
+   */
+  if (!_clutter_stage_push_event (stage, event, source->origin_time))
+    {
+      ClutterEvent *copy = clutter_event_copy (event);
 
-  _clutter_event_push (event, FALSE);
+      _clutter_event_set_origin_time (copy, source->origin_time);
+      _clutter_stage_queue_event (stage, copy, FALSE);
+    }
 }
 
 static void
@@ -182,19 +280,23 @@ notify_key (ClutterEventSource *source,
     xkb_state_update_key (source->xkb, key, state ? XKB_KEY_DOWN : XKB_KEY_UP);
   }
 
-  queue_event (event);
+  if (event != NULL)
+    {
+      queue_event (source, stage, event);
+      clutter_event_free (event);
+    }
 }
 
 
 static void
 notify_motion (ClutterEventSource *source,
                guint32             time_,
-               gint                x,
-               gint                y)
+               gfloat              x,
+               gfloat              y)
 {
   ClutterInputDevice *input_device = (ClutterInputDevice *) source->device;
   gfloat stage_width, stage_height, new_x, new_y;
-  ClutterEvent *event;
+  ClutterEvent event = { 0, };
   ClutterStage *stage;
 
   /* We can drop the event on the floor if no stage has been
@@ -206,8 +308,6 @@ notify_motion (ClutterEventSource *source,
   stage_width = clutter_actor_get_width (CLUTTER_ACTOR (stage));
   stage_height = clutter_actor_get_height (CLUTTER_ACTOR (stage));
 
-  event = clutter_event_new (CLUTTER_MOTION);
-
   if (x < 0)
     new_x = 0.f;
   else if (x >= stage_width)
@@ -225,14 +325,15 @@ notify_motion (ClutterEventSource *source,
   source->x = new_x;
   source->y = new_y;
 
-  event->motion.time = time_;
-  event->motion.stage = stage;
-  event->motion.device = input_device;
-  event->motion.modifier_state = source->modifier_state;
-  event->motion.x = new_x;
-  event->motion.y = new_y;
+  event.type = CLUTTER_MOTION;
+  event.motion.time = time_;
+  event.motion.stage = stage;
+  event.motion.device = input_device;
+  event.motion.modifier_state = source->modifier_state;
+  event.motion.x = new_x;
+  event.motion.y = new_y;
 
-  queue_event (event);
+  queue_event (source, stage, &event);
 }
 
 static void
@@ -242,7 +343,7 @@ notify_button (ClutterEventSource *source,
                guint32             state)
 {
   ClutterInputDevice *input_device = (ClutterInputDevice *) source->device;
-  ClutterEvent *event;
+  ClutterEvent event = { 0, };
   ClutterStage *stage;
   gint button_nr;
   static gint maskmap[8] =
@@ -286,9 +387,9 @@ notify_button (ClutterEventSource *source,
     }
 
   if (state)
-    event = clutter_event_new (CLUTTER_BUTTON_PRESS);
+    event.type = CLUTTER_BUTTON_PRESS;
   else
-    event = clutter_event_new (CLUTTER_BUTTON_RELEASE);
+    event.type = CLUTTER_BUTTON_RELEASE;
 
   /* Update the modifiers */
   if (state)
@@ -296,15 +397,276 @@ notify_button (ClutterEventSource *source,
   else
     source->modifier_state &= ~maskmap[button - BTN_LEFT];
 
-  event->button.time = time_;
-  event->button.stage = CLUTTER_STAGE (stage);
-  event->button.device = (ClutterInputDevice *) source->device;
-  event->button.modifier_state = source->modifier_state;
-  event->button.button = button_nr;
-  event->button.x = source->x;
-  event->button.y = source->y;
+  event.button.time = time_;
+  event.button.stage = CLUTTER_STAGE (stage);
+  event.button.device = (ClutterInputDevice *) source->device;
+  event.button.modifier_state = source->modifier_state;
+  event.button.button = button_nr;
+  event.button.x = source->x;
+  event.button.y = source->y;
+
+  queue_event (source, stage, &event);
+}
+
+static void
+notify_touch (ClutterEventSource *source,
+              guint32             time_,
+              gint                slot_nr)
+{
+  ClutterInputDevice *input_device = (ClutterInputDevice *) source->device;
+  TouchSlot *slot = &source->slots[slot_nr];
+  ClutterEvent event = { 0, };
+  ClutterStage *stage;
+
+  stage = _clutter_input_device_get_stage (input_device);
+  if (!stage)
+    return;
+
+  if (slot->tracking_id < 0)
+    event.type = CLUTTER_TOUCH_END;
+  else if (!slot->active)
+    event.type = CLUTTER_TOUCH_BEGIN;
+  else
+    event.type = CLUTTER_TOUCH_UPDATE;
+
+  slot->active = slot->tracking_id >= 0;
+
+  event.touch.time = time_;
+  event.touch.stage = stage;
+  event.touch.device = input_device;
+  event.touch.modifier_state = source->modifier_state;
+  event.touch.sequence = GINT_TO_POINTER (slot_nr + 1);
+  event.touch.x = scale_abs_value (&source->abs_mt_x, slot->x,
+                                   clutter_actor_get_width (CLUTTER_ACTOR (stage)));
+  event.touch.y = scale_abs_value (&source->abs_mt_y, slot->y,
+                                   clutter_actor_get_height (CLUTTER_ACTOR (stage)));
+
+  queue_event (source, stage, &event);
+}
+
+/* emits the events for the state accumulated since the last
+ * SYN_REPORT, so that each frame of the device results in at most
+ * one motion event, and one touch event per slot
+ */
+static void
+flush_frame (ClutterEventSource *source,
+             guint32             time_)
+{
+  ClutterInputDevice *input_device = (ClutterInputDevice *) source->device;
+  ClutterStage *stage;
+  gint i;
+
+  if (source->dx != 0 || source->dy != 0)
+    {
+      notify_motion (source, time_,
+                     source->x + source->dx,
+                     source->y + source->dy);
+      source->dx = source->dy = 0;
+    }
+
+  if (source->abs_dirty)
+    {
+      stage = _clutter_input_device_get_stage (input_device);
+      if (stage != NULL)
+        {
+          gfloat stage_width, stage_height;
+
+          stage_width = clutter_actor_get_width (CLUTTER_ACTOR (stage));
+          stage_height = clutter_actor_get_height (CLUTTER_ACTOR (stage));
 
-  queue_event (event);
+          notify_motion (source, time_,
+                         scale_abs_value (&source->abs_x, source->abs_x_value,
+                                          stage_width),
+                         scale_abs_value (&source->abs_y, source->abs_y_value,
+                                          stage_height));
+        }
+
+      source->abs_dirty = FALSE;
+    }
+
+  for (i = 0; i < N_TOUCH_SLOTS; i++)
+    {
+      if (!source->slots[i].dirty)
+        continue;
+
+      source->slots[i].dirty = FALSE;
+
+      /* a touch can begin and end within the same frame */
+      if (source->slots[i].tracking_id < 0 && !source->slots[i].active)
+        continue;
+
+      notify_touch (source, time_, i);
+    }
+}
+
+static void
+process_abs_event (ClutterEventSource       *source,
+                   const struct input_event *e)
+{
+  TouchSlot *slot = NULL;
+
+  if (source->current_slot >= 0 && source->current_slot < N_TOUCH_SLOTS)
+    slot = &source->slots[source->current_slot];
+
+  switch (e->code)
+    {
+    case ABS_X:
+      source->abs_x_value = e->value;
+      source->abs_dirty = TRUE;
+      break;
+
+    case ABS_Y:
+      source->abs_y_value = e->value;
+      source->abs_dirty = TRUE;
+      break;
+
+    case ABS_MT_SLOT:
+      source->current_slot = e->value;
+      break;
+
+    case ABS_MT_TRACKING_ID:
+      if (slot != NULL)
+        {
+          slot->tracking_id = e->value;
+          slot->dirty = TRUE;
+        }
+      break;
+
+    case ABS_MT_POSITION_X:
+      if (slot != NULL)
+        {
+          slot->x = e->value;
+          slot->dirty = TRUE;
+        }
+      break;
+
+    case ABS_MT_POSITION_Y:
+      if (slot != NULL)
+        {
+          slot->y = e->value;
+          slot->dirty = TRUE;
+        }
+      break;
+
+    default:
+      break;
+    }
+}
+
+static void
+process_event (ClutterEventSource       *source,
+               const struct input_event *e)
+{
+  uint32_t _time;
+
+  _time = e->time.tv_sec * 1000 + e->time.tv_usec / 1000;
+
+  /* the stage measures the input latency from this time; if the
+   * kernel cannot give us monotonic timestamps, it will use the time
+   * at which the event is queued
+   */
+  if (source->monotonic_time)
+    source->origin_time = (gint64) e->time.tv_sec * G_USEC_PER_SEC + e->time.tv_usec;
+  else
+    source->origin_time = 0;
+
+  /* after a SYN_DROPPED the state of the device is unknown until the
+   * next SYN_REPORT, so we discard everything in between
+   */
+  if (source->syn_dropped)
+    {
+      if (e->type == EV_SYN && e->code == SYN_REPORT)
+        source->syn_dropped = FALSE;
+
+      return;
+    }
+
+  switch (e->type)
+    {
+    case EV_KEY:
+
+      /* don't repeat mouse buttons */
+      if (e->code >= BTN_MOUSE && e->code < KEY_OK)
+        if (e->value == 2)
+          return;
+
+      switch (e->code)
+        {
+        case BTN_TOUCH:
+        case BTN_TOOL_PEN:
+        case BTN_TOOL_RUBBER:
+        case BTN_TOOL_BRUSH:
+        case BTN_TOOL_PENCIL:
+        case BTN_TOOL_AIRBRUSH:
+        case BTN_TOOL_FINGER:
+        case BTN_TOOL_MOUSE:
+        case BTN_TOOL_LENS:
+          break;
+
+        case BTN_LEFT:
+        case BTN_RIGHT:
+        case BTN_MIDDLE:
+        case BTN_SIDE:
+        case BTN_EXTRA:
+        case BTN_FORWARD:
+        case BTN_BACK:
+        case BTN_TASK:
+          /* the position of the button event is the one at the
+           * end of the previous frame, so we emit the motion first
+           */
+          flush_frame (source, _time);
+          notify_button (source, _time, e->code, e->value);
+          break;
+
+        default:
+          notify_key (source, _time, e->code, e->value);
+          break;
+        }
+      break;
+
+    case EV_SYN:
+      switch (e->code)
+        {
+        case SYN_REPORT:
+          flush_frame (source, _time);
+          break;
+
+        case SYN_DROPPED:
+          source->dx = source->dy = 0;
+          source->abs_dirty = FALSE;
+          source->syn_dropped = TRUE;
+          break;
+
+        default:
+          break;
+        }
+      break;
+
+    case EV_MSC:
+      /* Nothing to do here? */
+      break;
+
+    case EV_REL:
+      /* accumulate the EV_REL events of the frame in dx/dy */
+      switch (e->code)
+        {
+        case REL_X:
+          source->dx += e->value;
+          break;
+        case REL_Y:
+          source->dy += e->value;
+          break;
+        }
+      break;
+
+    case EV_ABS:
+      process_abs_event (source, e);
+      break;
+
+    default:
+      g_warning ("Unhandled event of type %d", e->type);
+      break;
+    }
 }
 
 static gboolean
@@ -314,130 +676,62 @@ clutter_event_dispatch (GSource     *g_source,
 {
   ClutterEventSource *source = (ClutterEventSource *) g_source;
   ClutterInputDevice *input_device = (ClutterInputDevice *) source->device;
-  struct input_event ev[8];
+  struct input_event ev[EVENT_BATCH_SIZE];
   ClutterEvent *event;
-  gint len, i, dx = 0, dy = 0;
-  uint32_t _time;
   ClutterStage *stage;
+  gint len, i, n_batches;
 
   _clutter_threads_acquire_lock ();
 
   stage = _clutter_input_device_get_stage (input_device);
 
-  /* Don't queue more events if we haven't finished handling the previous batch
+  /* drain the device in large batches; the events go into the stage
+   * ring, so we don't need to wait for the previous ones to be
+   * handled. We cap the number of batches, to avoid starving the
+   * main loop with a device that floods us
    */
-  if (!clutter_events_pending ())
+  for (n_batches = 0; n_batches < MAX_BATCHES_PER_DISPATCH; n_batches++)
     {
-       len = read (source->event_poll_fd.fd, &ev, sizeof (ev));
-       if (len < 0 || len % sizeof (ev[0]) != 0)
-       {
-         if (errno != EAGAIN)
-           {
-             ClutterDeviceManager *manager;
-             ClutterInputDevice *device;
-             const gchar *device_path;
-
-             device = CLUTTER_INPUT_DEVICE (source->device);
-
-             if (CLUTTER_HAS_DEBUG (EVENT))
-               {
-                 device_path =
-                   _clutter_input_device_evdev_get_device_path (source->device);
-
-                 CLUTTER_NOTE (EVENT, "Could not read device (%s), removing.",
-                               device_path);
-               }
-
-             /* remove the faulty device */
-             manager = clutter_device_manager_get_default ();
-             _clutter_device_manager_remove_device (manager, device);
-
-           }
-         goto out;
-       }
-
-       /* Drop events if we don't have any stage to forward them to */
-       if (!stage)
-         goto out;
-
-       for (i = 0; i < len / sizeof (ev[0]); i++)
-         {
-           struct input_event *e = &ev[i];
-
-           _time = e->time.tv_sec * 1000 + e->time.tv_usec / 1000;
-           event = NULL;
-
-           switch (e->type)
-             {
-             case EV_KEY:
-
-               /* don't repeat mouse buttons */
-               if (e->code >= BTN_MOUSE && e->code < KEY_OK)
-                 if (e->value == 2)
-                   continue;
-
-               switch (e->code)
-                 {
-                 case BTN_TOUCH:
-                 case BTN_TOOL_PEN:
-                 case BTN_TOOL_RUBBER:
-                 case BTN_TOOL_BRUSH:
-                 case BTN_TOOL_PENCIL:
-                 case BTN_TOOL_AIRBRUSH:
-                 case BTN_TOOL_FINGER:
-                 case BTN_TOOL_MOUSE:
-                 case BTN_TOOL_LENS:
-                   break;
-
-                 case BTN_LEFT:
-                 case BTN_RIGHT:
-                 case BTN_MIDDLE:
-                 case BTN_SIDE:
-                 case BTN_EXTRA:
-                 case BTN_FORWARD:
-                 case BTN_BACK:
-                 case BTN_TASK:
-                   notify_button(source, _time, e->code, e->value);
-                   break;
-
-                 default:
-                   notify_key (source, _time, e->code, e->value);
-                 break;
-                 }
-               break;
-
-             case EV_SYN:
-               /* Nothing to do here? */
-               break;
-
-             case EV_MSC:
-               /* Nothing to do here? */
-               break;
-
-             case EV_REL:
-               /* compress the EV_REL events in dx/dy */
-               switch (e->code)
-                 {
-                 case REL_X:
-                   dx += e->value;
-                   break;
-                 case REL_Y:
-                   dy += e->value;
-                   break;
-                 }
-               break;
-
-             case EV_ABS:
-             default:
-               g_warning ("Unhandled event of type %d", e->type);
-               break;
-             }
-
-           queue_event (event);
-         }
-
-       if (dx != 0 || dy != 0)
-         notify_motion (source, _time, source->x + dx, source->y + dy);
+      len = read (source->event_poll_fd.fd, &ev, sizeof (ev));
+      if (len < 0 || len % sizeof (ev[0]) != 0)
+        {
+          if (len < 0 && errno != EAGAIN)
+            {
+              ClutterDeviceManager *manager;
+              ClutterInputDevice *device;
+              const gchar *device_path;
+
+              device = CLUTTER_INPUT_DEVICE (source->device);
+
+              if (CLUTTER_HAS_DEBUG (EVENT))
+                {
+                  device_path =
+                    _clutter_input_device_evdev_get_device_path (source->device);
+
+                  CLUTTER_NOTE (EVENT, "Could not read device (%s), removing.",
+                                device_path);
+                }
+
+              /* remove the faulty device */
+              manager = clutter_device_manager_get_default ();
+              _clutter_device_manager_remove_device (manager, device);
+
+              goto out;
+            }
+
+          break;
+        }
+
+      /* Drop events if we don't have any stage to forward them to */
+      if (stage != NULL)
+        {
+          for (i = 0; i < len / sizeof (ev[0]); i++)
+            process_event (source, &ev[i]);
+        }
+
+      /* a short read means that the device has been drained */
+      if (len < sizeof (ev))
+        break;
     }
 
   /* Pop an event off the queue if any */
@@ -446,8 +740,7 @@ clutter_event_dispatch (GSource     *g_source,
   if (event)
     {
       /* forward the event into clutter for emission etc. */
-      clutter_do_event (event);
-      clutter_event_free (event);
+      _clutter_do_event (event, FALSE);
     }
 
 out:
@@ -462,47 +755,123 @@ static GSourceFuncs event_funcs = {
   NULL
 };
 
-static GSource *
-clutter_event_source_new (ClutterInputDeviceEvdev *input_device)
+/* compiles the shared keymap the first time it's needed; this can be
+ * called both by the probing thread and by the main thread
+ */
+static struct xkb_keymap *
+clutter_device_manager_evdev_get_keymap (ClutterDeviceManagerEvdev *manager_evdev)
+{
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+  struct xkb_keymap *keymap;
+
+  g_mutex_lock (&priv->keymap_lock);
+
+  if (priv->keymap == NULL)
+    {
+      priv->keymap = _clutter_xkb_keymap_new (NULL,
+                                              option_xkb_layout,
+                                              option_xkb_variant,
+                                              option_xkb_options);
+      if (G_UNLIKELY (priv->keymap == NULL))
+        g_warning ("Could not compile keymap %s:%s:%s", option_xkb_layout,
+                   option_xkb_variant, option_xkb_options);
+    }
+
+  keymap = priv->keymap;
+
+  g_mutex_unlock (&priv->keymap_lock);
+
+  return keymap;
+}
+
+/* opens the device node of @device, and queries its capabilities */
+static gboolean
+device_probe_open (ClutterDeviceManagerEvdev *manager_evdev,
+                   ClutterInputDeviceEvdev   *device,
+                   DeviceProbe               *probe)
 {
-  GSource *source = g_source_new (&event_funcs, sizeof (ClutterEventSource));
-  ClutterEventSource *event_source = (ClutterEventSource *) source;
   ClutterInputDeviceType type;
   const gchar *node_path;
   gint fd;
 
-  /* grab the udev input device node and open it */
-  node_path = _clutter_input_device_evdev_get_device_path (input_device);
-
-  CLUTTER_NOTE (EVENT, "Creating GSource for device %s", node_path);
+  node_path = _clutter_input_device_evdev_get_device_path (device);
 
   fd = open (node_path, O_RDONLY | O_NONBLOCK);
   if (fd < 0)
     {
       g_warning ("Could not open device %s: %s", node_path, strerror (errno));
-      return NULL;
+      return FALSE;
     }
 
-  /* setup the source */
-  event_source->device = input_device;
-  event_source->event_poll_fd.fd = fd;
-  event_source->event_poll_fd.events = G_IO_IN;
+  type = clutter_input_device_get_device_type (CLUTTER_INPUT_DEVICE (device));
+
+  /* compile the keymap now, instead of on the main thread */
+  if (type == CLUTTER_KEYBOARD_DEVICE &&
+      clutter_device_manager_evdev_get_keymap (manager_evdev) == NULL)
+    {
+      close (fd);
+      return FALSE;
+    }
+
+  probe->fd = fd;
+
+#ifdef EVIOCSCLOCKID
+  {
+    int clk = CLOCK_MONOTONIC;
+
+    /* use the same time base as g_get_monotonic_time() */
+    probe->monotonic_time = ioctl (fd, EVIOCSCLOCKID, &clk) == 0;
+  }
+#endif
+
+  /* the ranges of the absolute axes, if any, used to map the
+   * positions of tablets and touch screens to the stage
+   */
+  if (ioctl (fd, EVIOCGABS (ABS_X), &probe->abs_x) < 0)
+    memset (&probe->abs_x, 0, sizeof (struct input_absinfo));
+  if (ioctl (fd, EVIOCGABS (ABS_Y), &probe->abs_y) < 0)
+    memset (&probe->abs_y, 0, sizeof (struct input_absinfo));
+  if (ioctl (fd, EVIOCGABS (ABS_MT_POSITION_X), &probe->abs_mt_x) < 0)
+    memset (&probe->abs_mt_x, 0, sizeof (struct input_absinfo));
+  if (ioctl (fd, EVIOCGABS (ABS_MT_POSITION_Y), &probe->abs_mt_y) < 0)
+    memset (&probe->abs_mt_y, 0, sizeof (struct input_absinfo));
+
+  return TRUE;
+}
+
+/* creates the source reading the device opened by @probe; the source
+ * takes ownership of the file descriptor
+ */
+static GSource *
+clutter_event_source_new (ClutterDeviceManagerEvdev *manager_evdev,
+                          ClutterInputDeviceEvdev   *input_device,
+                          DeviceProbe               *probe)
+{
+  GSource *source;
+  ClutterEventSource *event_source;
+  ClutterInputDeviceType type;
+  gint i;
+
+  CLUTTER_NOTE (EVENT, "Creating GSource for device %s",
+                _clutter_input_device_evdev_get_device_path (input_device));
 
   type =
     clutter_input_device_get_device_type (CLUTTER_INPUT_DEVICE (input_device));
 
+  source = g_source_new (&event_funcs, sizeof (ClutterEventSource));
+  event_source = (ClutterEventSource *) source;
+
   if (type == CLUTTER_KEYBOARD_DEVICE)
     {
-      /* create the xkb description */
-      event_source->xkb = _clutter_xkb_state_new (NULL,
-                                                  option_xkb_layout,
-                                                  option_xkb_variant,
-                                                  option_xkb_options);
+      struct xkb_keymap *keymap;
+
+      /* every keyboard has its own state, using the shared keymap */
+      keymap = clutter_device_manager_evdev_get_keymap (manager_evdev);
+      if (keymap != NULL)
+        event_source->xkb = xkb_state_new (keymap);
+
       if (G_UNLIKELY (event_source->xkb == NULL))
         {
-          g_warning ("Could not compile keymap %s:%s:%s", option_xkb_layout,
-                     option_xkb_variant, option_xkb_options);
-          close (fd);
           g_source_unref (source);
           return NULL;
         }
@@ -513,6 +882,21 @@ clutter_event_source_new (ClutterInputDeviceEvdev *input_device)
       event_source->y = 0;
     }
 
+  /* setup the source */
+  event_source->device = input_device;
+  event_source->event_poll_fd.fd = probe->fd;
+  event_source->event_poll_fd.events = G_IO_IN;
+  probe->fd = -1;
+
+  event_source->monotonic_time = probe->monotonic_time;
+  event_source->abs_x = probe->abs_x;
+  event_source->abs_y = probe->abs_y;
+  event_source->abs_mt_x = probe->abs_mt_x;
+  event_source->abs_mt_y = probe->abs_mt_y;
+
+  for (i = 0; i < N_TOUCH_SLOTS; i++)
+    event_source->slots[i].tracking_id = -1;
+
   /* and finally configure and attach the GSource */
   g_source_set_priority (source, CLUTTER_PRIORITY_EVENTS);
   g_source_add_poll (source, &event_source->event_poll_fd);
@@ -536,6 +920,9 @@ clutter_event_source_free (ClutterEventSource *source)
    * about it */
   close (source->event_poll_fd.fd);
 
+  if (source->xkb != NULL)
+    xkb_state_unref (source->xkb);
+
   g_source_destroy (g_source);
   g_source_unref (g_source);
 }
@@ -571,13 +958,13 @@ is_evdev (const gchar *sysfs_path)
   return match;
 }
 
-static void
-evdev_add_device (ClutterDeviceManagerEvdev *manager_evdev,
-                  GUdevDevice               *udev_device)
+/* creates the device for @udev_device, or returns NULL if it should
+ * be ignored; this is called by the probing thread
+ */
+static ClutterInputDeviceEvdev *
+evdev_create_device (GUdevDevice *udev_device)
 {
-  ClutterDeviceManager *manager = (ClutterDeviceManager *) manager_evdev;
   ClutterInputDeviceType type = CLUTTER_EXTENSION_DEVICE;
-  ClutterInputDevice *device;
   const gchar *device_file, *sysfs_path, *device_name;
 
   device_file = g_udev_device_get_device_file (udev_device);
@@ -585,16 +972,16 @@ evdev_add_device (ClutterDeviceManagerEvdev *manager_evdev,
   device_name = g_udev_device_get_name (udev_device);
 
   if (device_file == NULL || sysfs_path == NULL)
-    return;
+    return NULL;
 
   if (g_udev_device_get_property (udev_device, "ID_INPUT") == NULL)
-    return;
+    return NULL;
 
   /* Make sure to only add evdev devices, ie the device with a sysfs path that
    * finishes by input%d/event%d (We don't rely on the node name as this
    * policy is enforced by udev rules Vs API/ABI guarantees of sysfs) */
   if (!is_evdev (sysfs_path))
-    return;
+    return NULL;
 
   /* Clutter assumes that device types are exclusive in the
    * ClutterInputDevice API */
@@ -611,21 +998,100 @@ evdev_add_device (ClutterDeviceManagerEvdev *manager_evdev,
   else if (g_udev_device_has_property (udev_device, "ID_INPUT_TOUCHSCREEN"))
     type = CLUTTER_TOUCHSCREEN_DEVICE;
 
-  device = g_object_new (CLUTTER_TYPE_INPUT_DEVICE_EVDEV,
-                         "id", 0,
-                         "name", device_name,
-                         "device-type", type,
-                         "sysfs-path", sysfs_path,
-                         "device-path", device_file,
-                         "enabled", TRUE,
-                         NULL);
+  return g_object_new (CLUTTER_TYPE_INPUT_DEVICE_EVDEV,
+                       "id", 0,
+                       "name", device_name,
+                       "device-type", type,
+                       "sysfs-path", sysfs_path,
+                       "device-path", device_file,
+                       "enabled", TRUE,
+                       NULL);
+}
+
+static void
+device_probe_free (DeviceProbe *probe)
+{
+  if (probe->fd >= 0)
+    close (probe->fd);
+
+  if (probe->device != NULL)
+    g_object_unref (probe->device);
 
-  _clutter_input_device_set_stage (device, manager_evdev->priv->stage);
+  g_object_unref (probe->udev_device);
+  g_object_unref (probe->manager);
 
-  _clutter_device_manager_add_device (manager, device);
+  g_slice_free (DeviceProbe, probe);
+}
+
+/* hands the probed device back to the main thread */
+static gboolean
+device_probe_done (gpointer data)
+{
+  DeviceProbe *probe = data;
+  ClutterDeviceManagerEvdev *manager_evdev = probe->manager;
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+  ClutterInputDevice *device = (ClutterInputDevice *) probe->device;
+
+  priv->pending_probes = g_list_remove (priv->pending_probes, probe);
+
+  if (device != NULL && !probe->cancelled && !priv->released)
+    {
+      _clutter_input_device_set_stage (device, priv->stage);
+
+      /* the device list takes ownership of the device */
+      probe->device = NULL;
 
-  CLUTTER_NOTE (EVENT, "Added device %s, type %d, sysfs %s",
-                device_file, type, sysfs_path);
+      priv->current_probe = probe;
+      _clutter_device_manager_add_device (CLUTTER_DEVICE_MANAGER (manager_evdev),
+                                          device);
+      priv->current_probe = NULL;
+
+      CLUTTER_NOTE (EVENT, "Added device %s, type %d, sysfs %s",
+                    _clutter_input_device_evdev_get_device_path (CLUTTER_INPUT_DEVICE_EVDEV (device)),
+                    clutter_input_device_get_device_type (device),
+                    g_udev_device_get_sysfs_path (probe->udev_device));
+    }
+
+  device_probe_free (probe);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+device_probe_thread_func (gpointer data,
+                          gpointer user_data)
+{
+  DeviceProbe *probe = data;
+
+  probe->device = evdev_create_device (probe->udev_device);
+  if (probe->device != NULL &&
+      !device_probe_open (probe->manager, probe->device, probe))
+    {
+      g_object_unref (probe->device);
+      probe->device = NULL;
+    }
+
+  clutter_threads_add_idle_full (CLUTTER_PRIORITY_EVENTS,
+                                 device_probe_done,
+                                 probe,
+                                 NULL);
+}
+
+static void
+evdev_add_device (ClutterDeviceManagerEvdev *manager_evdev,
+                  GUdevDevice               *udev_device)
+{
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+  DeviceProbe *probe;
+
+  probe = g_slice_new0 (DeviceProbe);
+  probe->manager = g_object_ref (manager_evdev);
+  probe->udev_device = g_object_ref (udev_device);
+  probe->fd = -1;
+
+  priv->pending_probes = g_list_prepend (priv->pending_probes, probe);
+
+  g_thread_pool_push (priv->probe_pool, probe, NULL);
 }
 
 static ClutterInputDeviceEvdev *
@@ -662,8 +1128,22 @@ evdev_remove_device (ClutterDeviceManagerEvdev *manager_evdev,
                      GUdevDevice               *device)
 {
   ClutterDeviceManager *manager = CLUTTER_DEVICE_MANAGER (manager_evdev);
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
   ClutterInputDeviceEvdev *device_evdev;
   ClutterInputDevice *input_device;
+  const gchar *sysfs_path;
+  GList *l;
+
+  /* the device might not have been handed back by the probing thread */
+  sysfs_path = g_udev_device_get_sysfs_path (device);
+  for (l = priv->pending_probes; l != NULL; l = l->next)
+    {
+      DeviceProbe *probe = l->data;
+
+      if (g_strcmp0 (sysfs_path,
+                     g_udev_device_get_sysfs_path (probe->udev_device)) == 0)
+        probe->cancelled = TRUE;
+    }
 
   device_evdev = find_device_by_udev_device (manager_evdev, device);
   if (device_evdev == NULL)
@@ -704,6 +1184,7 @@ clutter_device_manager_evdev_add_device (ClutterDeviceManager *manager,
   ClutterInputDeviceType device_type;
   ClutterInputDeviceEvdev *device_evdev;
   gboolean is_pointer, is_keyboard;
+  DeviceProbe *probe, sync_probe;
   GSource *source;
 
   manager_evdev = CLUTTER_DEVICE_MANAGER_EVDEV (manager);
@@ -723,10 +1204,26 @@ clutter_device_manager_evdev_add_device (ClutterDeviceManager *manager,
   if (is_keyboard && priv->core_keyboard == NULL)
     priv->core_keyboard = device;
 
+  /* the devices not coming from the probing thread are opened here */
+  probe = priv->current_probe;
+  if (probe == NULL)
+    {
+      memset (&sync_probe, 0, sizeof (DeviceProbe));
+      sync_probe.fd = -1;
+
+      if (!device_probe_open (manager_evdev, device_evdev, &sync_probe))
+        return;
+
+      probe = &sync_probe;
+    }
+
   /* Install the GSource for this device */
-  source = clutter_event_source_new (device_evdev);
+  source = clutter_event_source_new (manager_evdev, device_evdev, probe);
   if (G_LIKELY (source))
     priv->event_sources = g_slist_prepend (priv->event_sources, source);
+
+  if (probe == &sync_probe && sync_probe.fd >= 0)
+    close (sync_probe.fd);
 }
 
 static void
@@ -841,6 +1338,14 @@ clutter_device_manager_evdev_constructed (GObject *gobject)
 
   priv->udev_client = g_udev_client_new (subsystems);
 
+  /* the existing devices are probed asynchronously as well, and they
+   * are added as soon as they are ready
+   */
+  priv->probe_pool = g_thread_pool_new (device_probe_thread_func,
+                                        NULL,
+                                        1, FALSE,
+                                        NULL);
+
   clutter_device_manager_evdev_probe_devices (manager_evdev);
 
   /* subcribe for events on input devices */
@@ -892,6 +1397,11 @@ clutter_device_manager_evdev_finalize (GObject *object)
 
   g_object_unref (priv->udev_client);
 
+  /* every probe holds a reference on the manager, so there is nothing
+   * left in the pool at this point
+   */
+  g_thread_pool_free (priv->probe_pool, FALSE, TRUE);
+
   for (l = priv->devices; l; l = g_slist_next (l))
     {
       ClutterInputDevice *device = l->data;
@@ -908,6 +1418,11 @@ clutter_device_manager_evdev_finalize (GObject *object)
     }
   g_slist_free (priv->event_sources);
 
+  if (priv->keymap != NULL)
+    xkb_map_unref (priv->keymap);
+
+  g_mutex_clear (&priv->keymap_lock);
+
   G_OBJECT_CLASS (clutter_device_manager_evdev_parent_class)->finalize (object);
 }
 
@@ -991,6 +1506,8 @@ clutter_device_manager_evdev_init (ClutterDeviceManagerEvdev *self)
 
   priv = self->priv = CLUTTER_DEVICE_MANAGER_EVDEV_GET_PRIVATE (self);
 
+  g_mutex_init (&priv->keymap_lock);
+
   priv->stage_manager = clutter_stage_manager_get_default ();
   g_object_ref (priv->stage_manager);
 
@@ -97,22 +97,23 @@ _clutter_key_event_new_from_evdev (ClutterInputDevice *device,
 }
 
 /*
- * _clutter_xkb_state_new:
+ * _clutter_xkb_keymap_new:
  *
- * Create a new xkbcommon keymap and state object.
+ * Compile a new xkbcommon keymap. Compiling a keymap is expensive, so
+ * the keymap should be shared by all the keyboards using the same
+ * layout; each keyboard only needs its own state object.
  *
  * FIXME: We need a way to override the layout here, a fixed or runtime
- * detected layout is provided by the backend calling _clutter_xkb_state_new();
+ * detected layout is provided by the backend calling _clutter_xkb_keymap_new();
  */
-struct xkb_state *
-_clutter_xkb_state_new (const gchar *model,
-                        const gchar *layout,
-                        const gchar *variant,
-                        const gchar *options)
+struct xkb_keymap *
+_clutter_xkb_keymap_new (const gchar *model,
+                         const gchar *layout,
+                         const gchar *variant,
+                         const gchar *options)
 {
   struct xkb_context *ctx;
   struct xkb_keymap *keymap;
-  struct xkb_state *state;
   struct xkb_rule_names names;
 
   ctx = xkb_context_new(0);
@@ -130,6 +131,25 @@ _clutter_xkb_state_new (const gchar *model,
 
   keymap = xkb_map_new_from_names(ctx, &names, 0);
   xkb_context_unref(ctx);
+
+  return keymap;
+}
+
+/*
+ * _clutter_xkb_state_new:
+ *
+ * Create a new xkbcommon keymap and state object.
+ */
+struct xkb_state *
+_clutter_xkb_state_new (const gchar *model,
+                        const gchar *layout,
+                        const gchar *variant,
+                        const gchar *options)
+{
+  struct xkb_keymap *keymap;
+  struct xkb_state *state;
+
+  keymap = _clutter_xkb_keymap_new (model, layout, variant, options);
   if (!keymap)
     return NULL;
 
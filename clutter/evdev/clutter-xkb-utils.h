@@ -37,6 +37,10 @@ ClutterEvent *    _clutter_key_event_new_from_evdev (ClutterInputDevice *device,
                                                      uint32_t            _time,
                                                      uint32_t            key,
                                                      uint32_t            state);
+struct xkb_keymap * _clutter_xkb_keymap_new        (const gchar *model,
+                                                     const gchar *layout,
+                                                     const gchar *variant,
+                                                     const gchar *options);
 struct xkb_state * _clutter_xkb_state_new           (const gchar *model,
                                                      const gchar *layout,
                                                      const gchar *variant,
@@ -48,6 +48,7 @@
 #include "clutter-event-private.h"
 #include "clutter-feature.h"
 #include "clutter-main.h"
+#include "clutter-master-clock.h"
 #include "clutter-paint-volume-private.h"
 #include "clutter-private.h"
 #include "clutter-stage-private.h"
@@ -149,11 +150,122 @@ clutter_stage_gdk_resize (ClutterStageWindow *stage_window,
   gdk_window_resize (stage_gdk->window, width, height);
 }
 
+/* The window is drawn by GDK as well, so the updates of the stage are
+ * driven by the update phase of the GdkFrameClock of the window, instead
+ * of being paced by the master clock on its own; this avoids painting
+ * twice in a frame, or missing the vertical refresh GDK is syncing to.
+ */
+static void
+clutter_stage_gdk_frame_clock_update (GdkFrameClock   *frame_clock,
+                                      ClutterStageGdk *stage_gdk)
+{
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_gdk);
+
+  /* the stage is ready to be updated by the next dispatch of the
+   * master clock, which we need to wake up
+   */
+  stage_cogl->update_time = gdk_frame_clock_get_frame_time (frame_clock);
+
+  _clutter_master_clock_start_running (_clutter_master_clock_get_default ());
+}
+
+static void
+clutter_stage_gdk_set_frame_clock (ClutterStageGdk *stage_gdk,
+                                   GdkFrameClock   *frame_clock)
+{
+  if (stage_gdk->frame_clock == frame_clock)
+    return;
+
+  if (stage_gdk->frame_clock != NULL)
+    {
+      g_signal_handler_disconnect (stage_gdk->frame_clock,
+                                   stage_gdk->update_id);
+      g_object_unref (stage_gdk->frame_clock);
+      stage_gdk->frame_clock = NULL;
+      stage_gdk->update_id = 0;
+    }
+
+  if (frame_clock != NULL)
+    {
+      stage_gdk->frame_clock = g_object_ref (frame_clock);
+      stage_gdk->update_id =
+        g_signal_connect (frame_clock, "update",
+                          G_CALLBACK (clutter_stage_gdk_frame_clock_update),
+                          stage_gdk);
+    }
+}
+
+static void
+clutter_stage_gdk_schedule_update (ClutterStageWindow *stage_window,
+                                   gint                sync_delay)
+{
+  ClutterStageGdk *stage_gdk = CLUTTER_STAGE_GDK (stage_window);
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+
+  if (stage_gdk->frame_clock == NULL)
+    {
+      clutter_stage_window_parent_iface->schedule_update (stage_window,
+                                                          sync_delay);
+      return;
+    }
+
+  /* the update time is set by the next update phase; until then the
+   * stage is not ready to be updated
+   */
+  if (stage_cogl->update_time != -1)
+    return;
+
+  gdk_frame_clock_request_phase (stage_gdk->frame_clock,
+                                 GDK_FRAME_CLOCK_PHASE_UPDATE);
+}
+
+static gint64
+clutter_stage_gdk_get_next_presentation_time (ClutterStageWindow *stage_window)
+{
+  ClutterStageGdk *stage_gdk = CLUTTER_STAGE_GDK (stage_window);
+  gint64 frame_time, refresh_interval, presentation_time;
+
+  if (stage_gdk->frame_clock == NULL)
+    return clutter_stage_window_parent_iface->get_next_presentation_time (stage_window);
+
+  /* the timelines are advanced using the times of the GDK frames, so
+   * that the animations of the stage match the rest of the window
+   */
+  frame_time = gdk_frame_clock_get_frame_time (stage_gdk->frame_clock);
+  gdk_frame_clock_get_refresh_info (stage_gdk->frame_clock, frame_time,
+                                    &refresh_interval,
+                                    &presentation_time);
+
+  if (presentation_time != 0)
+    return presentation_time;
+
+  return frame_time;
+}
+
+static gint64
+clutter_stage_gdk_get_refresh_interval (ClutterStageWindow *stage_window)
+{
+  ClutterStageGdk *stage_gdk = CLUTTER_STAGE_GDK (stage_window);
+  gint64 refresh_interval;
+
+  if (stage_gdk->frame_clock == NULL)
+    return clutter_stage_window_parent_iface->get_refresh_interval (stage_window);
+
+  gdk_frame_clock_get_refresh_info (stage_gdk->frame_clock,
+                                    gdk_frame_clock_get_frame_time (stage_gdk->frame_clock),
+                                    &refresh_interval,
+                                    NULL);
+
+  return refresh_interval;
+}
+
 static void
 clutter_stage_gdk_unrealize (ClutterStageWindow *stage_window)
 {
   ClutterStageGdk *stage_gdk = CLUTTER_STAGE_GDK (stage_window);
 
+  clutter_stage_gdk_set_frame_clock (stage_gdk, NULL);
+
   if (stage_gdk->window != NULL)
     {
       g_object_set_data (G_OBJECT (stage_gdk->window),
@@ -296,7 +408,13 @@ clutter_stage_gdk_realize (ClutterStageWindow *stage_window)
       return FALSE;
     }
 
-  return clutter_stage_window_parent_iface->realize (stage_window);
+  if (!clutter_stage_window_parent_iface->realize (stage_window))
+    return FALSE;
+
+  clutter_stage_gdk_set_frame_clock (stage_gdk,
+                                     gdk_window_get_frame_clock (stage_gdk->window));
+
+  return TRUE;
 }
 
 static void
@@ -423,6 +541,8 @@ clutter_stage_gdk_dispose (GObject *gobject)
 {
   ClutterStageGdk *stage_gdk = CLUTTER_STAGE_GDK (gobject);
 
+  clutter_stage_gdk_set_frame_clock (stage_gdk, NULL);
+
   if (stage_gdk->window != NULL)
     {
       g_object_set_data (G_OBJECT (stage_gdk->window),
@@ -474,6 +594,9 @@ clutter_stage_window_iface_init (ClutterStageWindowIface *iface)
   iface->realize = clutter_stage_gdk_realize;
   iface->unrealize = clutter_stage_gdk_unrealize;
   iface->can_clip_redraws = clutter_stage_gdk_can_clip_redraws;
+  iface->schedule_update = clutter_stage_gdk_schedule_update;
+  iface->get_next_presentation_time = clutter_stage_gdk_get_next_presentation_time;
+  iface->get_refresh_interval = clutter_stage_gdk_get_refresh_interval;
 }
 
 /**
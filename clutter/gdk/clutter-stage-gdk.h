@@ -48,6 +48,10 @@ struct _ClutterStageGdk
   GdkWindow *window;
   GdkCursor *blank_cursor;
 
+  /* the frame clock of the window, which drives the updates */
+  GdkFrameClock *frame_clock;
+  gulong update_id;
+
   gboolean foreign_window;
 };
 
@@ -50,6 +50,8 @@ G_DEFINE_TYPE_WITH_CODE (ClutterStageOSX,
 
 static ClutterActor *
 clutter_stage_osx_get_wrapper (ClutterStageWindow *stage_window);
+static void
+clutter_stage_osx_update_display_link (ClutterStageOSX *self);
 
 #define CLUTTER_OSX_FULLSCREEN_WINDOW_LEVEL (NSMainMenuWindowLevel + 1)
 
@@ -143,6 +145,7 @@ clutter_stage_osx_get_wrapper (ClutterStageWindow *stage_window);
 
 - (void)windowDidChangeScreen:(NSNotification *)notification
 {
+  clutter_stage_osx_update_display_link (self->stage_osx);
   clutter_stage_ensure_redraw (self->stage_osx->wrapper);
 }
 @end
@@ -202,6 +205,14 @@ clutter_stage_osx_get_wrapper (ClutterStageWindow *stage_window);
   cogl_flush ();
 
   [[self openGLContext] flushBuffer];
+
+  /* the display link reports when the frame reaches the screen */
+  if (stage_osx->display_link != NULL)
+    {
+      g_mutex_lock (&stage_osx->timing_lock);
+      stage_osx->pending_frames++;
+      g_mutex_unlock (&stage_osx->timing_lock);
+    }
 }
 
 /* In order to receive key events */
@@ -323,6 +334,106 @@ clutter_stage_osx_set_frame (ClutterStageOSX *self)
 }
 
 /*************************************************************************/
+/* Called by CoreVideo, in its own thread, ahead of every vertical
+ * refresh of the display showing the stage; @output_time is the time
+ * at which the frame being composited is going to be displayed. This
+ * takes the place of the frame callback of the Cogl windowing systems
+ * that support swap events.
+ */
+static CVReturn
+clutter_stage_osx_display_link_cb (CVDisplayLinkRef   display_link,
+                                   const CVTimeStamp *now_time,
+                                   const CVTimeStamp *output_time,
+                                   CVOptionFlags      flags_in,
+                                   CVOptionFlags     *flags_out,
+                                   void              *user_data)
+{
+  ClutterStageOSX *self = user_data;
+  gdouble refresh_period;
+
+  g_mutex_lock (&self->timing_lock);
+
+  refresh_period = CVDisplayLinkGetActualOutputVideoRefreshPeriod (display_link);
+  if (refresh_period == 0.0 && output_time->videoTimeScale != 0)
+    refresh_period = (gdouble) output_time->videoRefreshPeriod
+                   / output_time->videoTimeScale;
+
+  if (refresh_period > 0.0)
+    self->refresh_interval = (gint64) (0.5 + refresh_period * G_USEC_PER_SEC);
+
+  if (self->pending_frames > 0 &&
+      (output_time->flags & kCVTimeStampHostTimeValid) != 0)
+    {
+      gint64 delta = (gint64) (output_time->hostTime - CVGetCurrentHostTime ());
+
+      self->last_presentation_time =
+        g_get_monotonic_time () +
+        (gint64) (delta * (gdouble) G_USEC_PER_SEC / CVGetHostClockFrequency ());
+
+      self->pending_frames = 0;
+
+      /* the master clock is waiting for the frame to be presented */
+      g_main_context_wakeup (NULL);
+    }
+
+  g_mutex_unlock (&self->timing_lock);
+
+  return kCVReturnSuccess;
+}
+
+static void
+clutter_stage_osx_update_display_link (ClutterStageOSX *self)
+{
+  ClutterBackendOSX *backend_osx = CLUTTER_BACKEND_OSX (self->backend);
+
+  if (self->display_link == NULL)
+    return;
+
+  /* follow the display the window is on */
+  CVDisplayLinkSetCurrentCGDisplayFromOpenGLContext (self->display_link,
+                                                     [backend_osx->context CGLContextObj],
+                                                     [backend_osx->pixel_format CGLPixelFormatObj]);
+
+  g_mutex_lock (&self->timing_lock);
+  self->last_presentation_time = 0;
+  g_mutex_unlock (&self->timing_lock);
+}
+
+static void
+clutter_stage_osx_start_display_link (ClutterStageOSX *self)
+{
+  if (self->display_link != NULL || !_clutter_get_sync_to_vblank ())
+    return;
+
+  if (CVDisplayLinkCreateWithActiveCGDisplays (&self->display_link) != kCVReturnSuccess)
+    {
+      CLUTTER_NOTE (BACKEND, "Unable to create the display link; "
+                             "the presentation times are unknown");
+      self->display_link = NULL;
+      return;
+    }
+
+  CVDisplayLinkSetOutputCallback (self->display_link,
+                                  clutter_stage_osx_display_link_cb,
+                                  self);
+  clutter_stage_osx_update_display_link (self);
+  CVDisplayLinkStart (self->display_link);
+}
+
+static void
+clutter_stage_osx_stop_display_link (ClutterStageOSX *self)
+{
+  if (self->display_link == NULL)
+    return;
+
+  CVDisplayLinkStop (self->display_link);
+  CVDisplayLinkRelease (self->display_link);
+  self->display_link = NULL;
+
+  self->pending_frames = 0;
+  self->last_presentation_time = 0;
+}
+
 static gboolean
 clutter_stage_osx_realize (ClutterStageWindow *stage_window)
 {
@@ -365,6 +476,8 @@ clutter_stage_osx_realize (ClutterStageWindow *stage_window)
       [self->window center];
       self->haveRealized = true;
 
+      clutter_stage_osx_start_display_link (self);
+
       CLUTTER_NOTE (BACKEND, "Stage successfully realized");
     }
 
@@ -385,6 +498,8 @@ clutter_stage_osx_unrealize (ClutterStageWindow *stage_window)
   /* ensure we get realize+unrealize properly paired */
   g_return_if_fail (self->view != NULL && self->window != NULL);
 
+  clutter_stage_osx_stop_display_link (self);
+
   [self->view release];
   [self->window close];
 
@@ -633,6 +748,122 @@ clutter_stage_osx_redraw (ClutterStageWindow *stage_window)
   CLUTTER_OSX_POOL_RELEASE();
 }
 
+static gint64
+clutter_stage_osx_get_refresh_interval_locked (ClutterStageOSX *self)
+{
+  if (self->refresh_interval <= 0)
+    return 16667; /* 1/60th second */
+
+  return self->refresh_interval;
+}
+
+static void
+clutter_stage_osx_schedule_update (ClutterStageWindow *stage_window,
+                                   gint                sync_delay)
+{
+  ClutterStageOSX *self = CLUTTER_STAGE_OSX (stage_window);
+  gint64 now, refresh_interval, last_presentation_time;
+
+  if (self->update_time != -1)
+    return;
+
+  now = g_get_monotonic_time ();
+
+  if (sync_delay < 0)
+    {
+      self->update_time = now;
+      return;
+    }
+
+  g_mutex_lock (&self->timing_lock);
+  last_presentation_time = self->last_presentation_time;
+  refresh_interval = clutter_stage_osx_get_refresh_interval_locked (self);
+  g_mutex_unlock (&self->timing_lock);
+
+  /* see clutter_stage_cogl_schedule_update() */
+  if (last_presentation_time == 0 ||
+      last_presentation_time < now - 150000)
+    {
+      self->update_time = now;
+      return;
+    }
+
+  self->update_time = last_presentation_time + 1000 * sync_delay;
+
+  while (self->update_time < now)
+    self->update_time += refresh_interval;
+}
+
+static gint64
+clutter_stage_osx_get_update_time (ClutterStageWindow *stage_window)
+{
+  ClutterStageOSX *self = CLUTTER_STAGE_OSX (stage_window);
+  guint pending_frames;
+
+  g_mutex_lock (&self->timing_lock);
+  pending_frames = self->pending_frames;
+  g_mutex_unlock (&self->timing_lock);
+
+  if (pending_frames > 0)
+    return -1; /* in the future, indefinite */
+
+  return self->update_time;
+}
+
+static void
+clutter_stage_osx_clear_update_time (ClutterStageWindow *stage_window)
+{
+  ClutterStageOSX *self = CLUTTER_STAGE_OSX (stage_window);
+
+  self->update_time = -1;
+}
+
+static gint64
+clutter_stage_osx_get_refresh_interval (ClutterStageWindow *stage_window)
+{
+  ClutterStageOSX *self = CLUTTER_STAGE_OSX (stage_window);
+  gint64 refresh_interval = 0;
+
+  g_mutex_lock (&self->timing_lock);
+
+  /* we don't know the refresh rate until a frame has been presented */
+  if (self->last_presentation_time != 0)
+    refresh_interval = clutter_stage_osx_get_refresh_interval_locked (self);
+
+  g_mutex_unlock (&self->timing_lock);
+
+  return refresh_interval;
+}
+
+static gint64
+clutter_stage_osx_get_next_presentation_time (ClutterStageWindow *stage_window)
+{
+  ClutterStageOSX *self = CLUTTER_STAGE_OSX (stage_window);
+  gint64 now, refresh_interval, next;
+  guint pending_frames;
+
+  now = g_get_monotonic_time ();
+
+  g_mutex_lock (&self->timing_lock);
+  next = self->last_presentation_time;
+  refresh_interval = clutter_stage_osx_get_refresh_interval_locked (self);
+  pending_frames = self->pending_frames;
+  g_mutex_unlock (&self->timing_lock);
+
+  /* see clutter_stage_cogl_get_next_presentation_time() */
+  if (next == 0 || next < now - 150000)
+    return -1;
+
+  next += refresh_interval;
+  while (next <= now)
+    next += refresh_interval;
+
+  if (pending_frames > 0)
+    next += refresh_interval;
+
+  return next;
+}
+
 static void
 clutter_stage_window_iface_init (ClutterStageWindowIface *iface)
 {
@@ -649,6 +880,12 @@ clutter_stage_window_iface_init (ClutterStageWindowIface *iface)
   iface->set_user_resizable = clutter_stage_osx_set_user_resizable;
   iface->set_accept_focus   = clutter_stage_osx_set_accept_focus;
   iface->redraw             = clutter_stage_osx_redraw;
+
+  iface->schedule_update            = clutter_stage_osx_schedule_update;
+  iface->get_update_time            = clutter_stage_osx_get_update_time;
+  iface->clear_update_time          = clutter_stage_osx_clear_update_time;
+  iface->get_refresh_interval       = clutter_stage_osx_get_refresh_interval;
+  iface->get_next_presentation_time = clutter_stage_osx_get_next_presentation_time;
 }
 
 /*************************************************************************/
@@ -663,6 +900,10 @@ clutter_stage_osx_init (ClutterStageOSX *self)
   self->haveRealized = false;
   self->view = NULL;
   self->window = NULL;
+
+  g_mutex_init (&self->timing_lock);
+  self->display_link = NULL;
+  self->update_time = -1;
 }
 
 static void
@@ -692,12 +933,18 @@ clutter_stage_osx_set_property (GObject      *gobject,
 static void
 clutter_stage_osx_finalize (GObject *gobject)
 {
+  ClutterStageOSX *self = CLUTTER_STAGE_OSX (gobject);
+
+  g_mutex_clear (&self->timing_lock);
+
   G_OBJECT_CLASS (clutter_stage_osx_parent_class)->finalize (gobject);
 }
 
 static void
 clutter_stage_osx_dispose (GObject *gobject)
 {
+  clutter_stage_osx_stop_display_link (CLUTTER_STAGE_OSX (gobject));
+
   G_OBJECT_CLASS (clutter_stage_osx_parent_class)->dispose (gobject);
 }
 
@@ -28,6 +28,7 @@
 
 #import <Foundation/Foundation.h>
 #import <AppKit/AppKit.h>
+#import <CoreVideo/CoreVideo.h>
 
 G_BEGIN_DECLS
 
@@ -71,6 +72,16 @@ struct _ClutterStageOSX
 
   gfloat scroll_pos_x;
   gfloat scroll_pos_y;
+
+  /* frame timings; the presentation times are reported by the
+   * display link thread, so they are protected by timing_lock
+   */
+  CVDisplayLinkRef display_link;
+  GMutex timing_lock;
+  guint pending_frames;
+  gint64 update_time;
+  gint64 last_presentation_time;
+  gint64 refresh_interval;
 };
 
 struct _ClutterStageOSXClass
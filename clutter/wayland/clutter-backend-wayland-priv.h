@@ -27,6 +27,7 @@
 #ifndef __CLUTTER_BACKEND_WAYLAND_PRIV_H__
 #define __CLUTTER_BACKEND_WAYLAND_PRIV_H__
 
+#include <time.h>
 #include <glib-object.h>
 #include <clutter/clutter-event.h>
 #include <clutter/clutter-backend.h>
@@ -35,6 +36,10 @@
 #include "clutter-backend-private.h"
 #include "clutter-backend-wayland.h"
 
+#ifdef HAVE_WAYLAND_PRESENTATION
+#include "wayland/presentation-time-client-protocol.h"
+#endif
+
 G_BEGIN_DECLS
 
 struct _ClutterBackendWayland
@@ -53,6 +58,14 @@ struct _ClutterBackendWayland
   struct wl_output *wayland_output;
   struct wl_cursor_theme *cursor_theme;
 
+#ifdef HAVE_WAYLAND_PRESENTATION
+  /* the presentation-time global, if the compositor supports it, and
+   * the clock used by its timestamps
+   */
+  struct wp_presentation *wayland_presentation;
+  clockid_t presentation_clock;
+#endif
+
   gint cursor_x, cursor_y;
   gint output_width, output_height;
 
@@ -88,6 +88,14 @@ clutter_backend_wayland_dispose (GObject *gobject)
       backend_wayland->cursor_theme = NULL;
     }
 
+#ifdef HAVE_WAYLAND_PRESENTATION
+  if (backend_wayland->wayland_presentation)
+    {
+      wp_presentation_destroy (backend_wayland->wayland_presentation);
+      backend_wayland->wayland_presentation = NULL;
+    }
+#endif
+
   G_OBJECT_CLASS (clutter_backend_wayland_parent_class)->dispose (gobject);
 }
 
@@ -129,6 +137,22 @@ static const struct wl_output_listener wayland_output_listener = {
   output_handle_mode,
 };
 
+#ifdef HAVE_WAYLAND_PRESENTATION
+static void
+presentation_handle_clock_id (void                   *data,
+                              struct wp_presentation *presentation,
+                              uint32_t                clock_id)
+{
+  ClutterBackendWayland *backend_wayland = data;
+
+  backend_wayland->presentation_clock = clock_id;
+}
+
+static const struct wp_presentation_listener wayland_presentation_listener = {
+  presentation_handle_clock_id,
+};
+#endif
+
 
 static void
 registry_handle_global (void *data,
@@ -166,6 +190,16 @@ registry_handle_global (void *data,
                               &wayland_output_listener,
                               backend_wayland);
     }
+#ifdef HAVE_WAYLAND_PRESENTATION
+  else if (strcmp (interface, "wp_presentation") == 0)
+    {
+      backend_wayland->wayland_presentation =
+        wl_registry_bind (registry, id, &wp_presentation_interface, 1);
+      wp_presentation_add_listener (backend_wayland->wayland_presentation,
+                                    &wayland_presentation_listener,
+                                    backend_wayland);
+    }
+#endif
 }
 
 static const struct wl_registry_listener wayland_registry_listener = {
@@ -329,6 +363,9 @@ clutter_backend_wayland_load_cursor (ClutterBackendWayland *backend_wayland)
 static void
 clutter_backend_wayland_init (ClutterBackendWayland *backend_wayland)
 {
+#ifdef HAVE_WAYLAND_PRESENTATION
+  backend_wayland->presentation_clock = CLOCK_MONOTONIC;
+#endif
 }
 
 /**
@@ -29,6 +29,7 @@
 #endif
 
 #include <glib.h>
+#include <time.h>
 
 #include "clutter-wayland.h"
 #include "clutter-stage-wayland.h"
@@ -97,6 +98,108 @@ static const struct wl_shell_surface_listener shell_surface_listener = {
        handle_popup_done,
 };
 
+static void
+frame_callback_done (void               *data,
+                     struct wl_callback *callback,
+                     uint32_t            time)
+{
+  ClutterStageWayland *stage_wayland = data;
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_wayland);
+
+  wl_callback_destroy (callback);
+  stage_wayland->frame_callback = NULL;
+
+#ifdef HAVE_WAYLAND_PRESENTATION
+  /* the presentation feedback has the real presentation time */
+  if (CLUTTER_BACKEND_WAYLAND (stage_cogl->backend)->wayland_presentation != NULL)
+    return;
+#endif
+
+  /* the timestamp of the callback uses an unspecified base, so without
+   * the presentation feedback the time at which the compositor asks
+   * for a new frame is the best approximation of the refresh we have
+   */
+  stage_cogl->last_presentation_time = g_get_monotonic_time ();
+}
+
+static const struct wl_callback_listener frame_callback_listener = {
+  frame_callback_done,
+};
+
+#ifdef HAVE_WAYLAND_PRESENTATION
+static void
+presentation_feedback_destroy (ClutterStageWayland             *stage_wayland,
+                               struct wp_presentation_feedback *feedback)
+{
+  stage_wayland->presentation_feedbacks =
+    g_list_remove (stage_wayland->presentation_feedbacks, feedback);
+
+  wp_presentation_feedback_destroy (feedback);
+}
+
+static void
+presentation_feedback_sync_output (void                            *data,
+                                   struct wp_presentation_feedback *feedback,
+                                   struct wl_output                *output)
+{
+}
+
+static void
+presentation_feedback_presented (void                            *data,
+                                 struct wp_presentation_feedback *feedback,
+                                 uint32_t                         tv_sec_hi,
+                                 uint32_t                         tv_sec_lo,
+                                 uint32_t                         tv_nsec,
+                                 uint32_t                         refresh,
+                                 uint32_t                         seq_hi,
+                                 uint32_t                         seq_lo,
+                                 uint32_t                         flags)
+{
+  ClutterStageWayland *stage_wayland = data;
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_wayland);
+  ClutterBackendWayland *backend_wayland =
+    CLUTTER_BACKEND_WAYLAND (stage_cogl->backend);
+  gint64 presentation_time;
+
+  presentation_time = (((gint64) tv_sec_hi << 32) | tv_sec_lo) * G_USEC_PER_SEC
+                    + tv_nsec / 1000;
+
+  /* the master clock uses the monotonic clock; any other clock chosen
+   * by the compositor has to be moved to the same base
+   */
+  if (backend_wayland->presentation_clock != CLOCK_MONOTONIC)
+    {
+      struct timespec ts;
+
+      if (clock_gettime (backend_wayland->presentation_clock, &ts) == 0)
+        presentation_time += g_get_monotonic_time ()
+                           - ((gint64) ts.tv_sec * G_USEC_PER_SEC
+                              + ts.tv_nsec / 1000);
+    }
+
+  stage_cogl->last_presentation_time = presentation_time;
+
+  /* zero means that the output does not have a constant refresh rate */
+  if (refresh != 0)
+    stage_cogl->refresh_rate = 1000000000.0f / refresh;
+
+  presentation_feedback_destroy (stage_wayland, feedback);
+}
+
+static void
+presentation_feedback_discarded (void                            *data,
+                                 struct wp_presentation_feedback *feedback)
+{
+  presentation_feedback_destroy (data, feedback);
+}
+
+static const struct wp_presentation_feedback_listener presentation_feedback_listener = {
+  presentation_feedback_sync_output,
+  presentation_feedback_presented,
+  presentation_feedback_discarded,
+};
+#endif /* HAVE_WAYLAND_PRESENTATION */
+
 static void
 clutter_stage_wayland_set_fullscreen (ClutterStageWindow *stage_window,
                                       gboolean            fullscreen);
@@ -220,6 +323,87 @@ clutter_stage_wayland_resize (ClutterStageWindow *stage_window,
     }
 }
 
+static void
+clutter_stage_wayland_unrealize (ClutterStageWindow *stage_window)
+{
+  ClutterStageWayland *stage_wayland = CLUTTER_STAGE_WAYLAND (stage_window);
+
+  if (stage_wayland->frame_callback != NULL)
+    {
+      wl_callback_destroy (stage_wayland->frame_callback);
+      stage_wayland->frame_callback = NULL;
+    }
+
+#ifdef HAVE_WAYLAND_PRESENTATION
+  g_list_free_full (stage_wayland->presentation_feedbacks,
+                    (GDestroyNotify) wp_presentation_feedback_destroy);
+  stage_wayland->presentation_feedbacks = NULL;
+#endif
+
+  stage_wayland->wayland_surface = NULL;
+  stage_wayland->wayland_shell_surface = NULL;
+
+  clutter_stage_window_parent_iface->unrealize (stage_window);
+}
+
+static void
+clutter_stage_wayland_redraw (ClutterStageWindow *stage_window)
+{
+  ClutterStageWayland *stage_wayland = CLUTTER_STAGE_WAYLAND (stage_window);
+  struct wl_surface *wl_surface = stage_wayland->wayland_surface;
+
+  /* the requests apply to the commit done when swapping the buffers */
+  if (wl_surface != NULL)
+    {
+#ifdef HAVE_WAYLAND_PRESENTATION
+      ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+      ClutterBackendWayland *backend_wayland =
+        CLUTTER_BACKEND_WAYLAND (stage_cogl->backend);
+
+      if (backend_wayland->wayland_presentation != NULL)
+        {
+          struct wp_presentation_feedback *feedback;
+
+          feedback =
+            wp_presentation_feedback (backend_wayland->wayland_presentation,
+                                      wl_surface);
+          wp_presentation_feedback_add_listener (feedback,
+                                                 &presentation_feedback_listener,
+                                                 stage_wayland);
+
+          stage_wayland->presentation_feedbacks =
+            g_list_prepend (stage_wayland->presentation_feedbacks, feedback);
+        }
+#endif
+
+      if (stage_wayland->frame_callback == NULL)
+        {
+          stage_wayland->frame_callback = wl_surface_frame (wl_surface);
+          wl_callback_add_listener (stage_wayland->frame_callback,
+                                    &frame_callback_listener,
+                                    stage_wayland);
+        }
+    }
+
+  clutter_stage_window_parent_iface->redraw (stage_window);
+}
+
+static gint64
+clutter_stage_wayland_get_update_time (ClutterStageWindow *stage_window)
+{
+  ClutterStageWayland *stage_wayland = CLUTTER_STAGE_WAYLAND (stage_window);
+
+  /* the compositor would discard any frame committed before it asks
+   * for a new one, e.g. while the surface is not visible; the update
+   * time computed by the parent in its schedule_update() implementation
+   * comes from the presentation times reported by the compositor
+   */
+  if (stage_wayland->frame_callback != NULL)
+    return -1; /* in the future, indefinite */
+
+  return clutter_stage_window_parent_iface->get_update_time (stage_window);
+}
+
 static void
 clutter_stage_wayland_init (ClutterStageWayland *stage_wayland)
 {
@@ -231,7 +415,10 @@ clutter_stage_window_iface_init (ClutterStageWindowIface *iface)
   clutter_stage_window_parent_iface = g_type_interface_peek_parent (iface);
 
   iface->realize = clutter_stage_wayland_realize;
+  iface->unrealize = clutter_stage_wayland_unrealize;
   iface->show = clutter_stage_wayland_show;
+  iface->redraw = clutter_stage_wayland_redraw;
+  iface->get_update_time = clutter_stage_wayland_get_update_time;
   iface->set_fullscreen = clutter_stage_wayland_set_fullscreen;
   iface->resize = clutter_stage_wayland_resize;
 }
@@ -55,6 +55,16 @@ struct _ClutterStageWayland
   gboolean fullscreen;
   gboolean foreign_wl_surface;
   gboolean shown;
+
+  /* the frame callback requested with the last commit; no new frame
+   * is drawn until the compositor signals it
+   */
+  struct wl_callback *frame_callback;
+
+#ifdef HAVE_WAYLAND_PRESENTATION
+  /* the wp_presentation_feedback objects of the committed frames */
+  GList *presentation_feedbacks;
+#endif
 };
 
 struct _ClutterStageWaylandClass
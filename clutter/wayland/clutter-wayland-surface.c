@@ -47,9 +47,70 @@
 #include "clutter-private.h"
 #include "clutter-backend.h"
 
+#ifdef CLUTTER_WINDOWING_EGL
+#include "egl/clutter-egl-image-private.h"
+#endif
+
 #include <cogl/cogl.h>
 #include <cogl/cogl-wayland-server.h>
 
+#define FOURCC(a,b,c,d) \
+  ((guint32) (a) | ((guint32) (b) << 8) | ((guint32) (c) << 16) | ((guint32) (d) << 24))
+
+/* the YUV dma-buf formats are imported one plane at a time, and the
+ * planes are converted to RGB by a shader snippet when painting; the
+ * order maps the planes of the buffer to the Y, U and V layers
+ */
+typedef struct
+{
+  guint32 drm_format;
+  guint n_planes;
+  guint32 plane_formats[3];
+  guint plane_order[3];
+  guint plane_subsampling[3];
+} YuvFormat;
+
+static const YuvFormat yuv_formats[] = {
+  /* Y plane followed by an interleaved UV plane */
+  { FOURCC ('N', 'V', '1', '2'), 2,
+    { FOURCC ('R', '8', ' ', ' '), FOURCC ('G', 'R', '8', '8'), 0 },
+    { 0, 1, 0 },
+    { 1, 2, 0 } },
+  /* Y, U and V planes */
+  { FOURCC ('Y', 'U', '1', '2'), 3,
+    { FOURCC ('R', '8', ' ', ' '), FOURCC ('R', '8', ' ', ' '), FOURCC ('R', '8', ' ', ' ') },
+    { 0, 1, 2 },
+    { 1, 2, 2 } },
+  /* Y, V and U planes */
+  { FOURCC ('Y', 'V', '1', '2'), 3,
+    { FOURCC ('R', '8', ' ', ' '), FOURCC ('R', '8', ' ', ' '), FOURCC ('R', '8', ' ', ' ') },
+    { 0, 2, 1 },
+    { 1, 2, 2 } },
+};
+
+/* BT.601, limited range */
+#define YUV_TO_RGB_SOURCE \
+  "  y = 1.16438356 * (y - 0.0625);\n" \
+  "  u -= 0.5;\n" \
+  "  v -= 0.5;\n" \
+  "  cogl_color_out = vec4 (y + 1.59602678 * v,\n" \
+  "                         y - 0.39176229 * u - 0.81296764 * v,\n" \
+  "                         y + 2.01723214 * u,\n" \
+  "                         1.0) * cogl_color_in;\n"
+
+static const gchar nv12_fragment_source[] =
+  "  float y = texture2D (cogl_sampler0, cogl_tex_coord_in[0].st).r;\n"
+  "  vec2 uv = texture2D (cogl_sampler1, cogl_tex_coord_in[0].st).rg;\n"
+  "  float u = uv.x;\n"
+  "  float v = uv.y;\n"
+  YUV_TO_RGB_SOURCE;
+
+static const gchar yuv420_fragment_source[] =
+  "  float y = texture2D (cogl_sampler0, cogl_tex_coord_in[0].st).r;\n"
+  "  float u = texture2D (cogl_sampler1, cogl_tex_coord_in[0].st).r;\n"
+  "  float v = texture2D (cogl_sampler2, cogl_tex_coord_in[0].st).r;\n"
+  YUV_TO_RGB_SOURCE;
+
 enum
 {
   PROP_SURFACE = 1,
@@ -76,6 +137,24 @@ struct _ClutterWaylandSurfacePrivate
   CoglTexture2D *buffer;
   int width, height;
   CoglPipeline *pipeline;
+
+  /* for wl_shm buffers the contents are copied into two textures used
+   * in turns, so that the upload of a new buffer does not have to wait
+   * for the GPU to stop reading the texture of the previous one; the
+   * back texture lags behind by the damage collected since it was last
+   * used
+   */
+  CoglTexture2D *back_buffer;
+  cairo_region_t *back_damage;
+  guint32 shm_format;
+
+  /* for YUV dma-buf the buffer holds the Y plane, and the planes hold
+   * the chroma planes
+   */
+  CoglTexture *planes[2];
+  guint n_planes;
+
+  guint is_shm : 1;
 };
 
 G_DEFINE_TYPE (ClutterWaylandSurface,
@@ -181,6 +260,108 @@ free_surface_buffers (ClutterWaylandSurface *self)
       priv->buffer = NULL;
       free_pipeline (self);
     }
+
+  if (priv->back_buffer)
+    {
+      cogl_object_unref (priv->back_buffer);
+      priv->back_buffer = NULL;
+    }
+
+  if (priv->back_damage)
+    {
+      cairo_region_destroy (priv->back_damage);
+      priv->back_damage = NULL;
+    }
+
+  while (priv->n_planes > 0)
+    {
+      priv->n_planes -= 1;
+      cogl_object_unref (priv->planes[priv->n_planes]);
+      priv->planes[priv->n_planes] = NULL;
+    }
+
+  priv->is_shm = FALSE;
+}
+
+static CoglPixelFormat
+get_shm_buffer_format (struct wl_buffer *buffer)
+{
+  switch (wl_shm_buffer_get_format (buffer))
+    {
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+    case WL_SHM_FORMAT_ARGB8888:
+      return COGL_PIXEL_FORMAT_ARGB_8888_PRE;
+    case WL_SHM_FORMAT_XRGB8888:
+      return COGL_PIXEL_FORMAT_ARGB_8888;
+#elif G_BYTE_ORDER == G_LITTLE_ENDIAN
+    case WL_SHM_FORMAT_ARGB8888:
+      return COGL_PIXEL_FORMAT_BGRA_8888_PRE;
+    case WL_SHM_FORMAT_XRGB8888:
+      return COGL_PIXEL_FORMAT_BGRA_8888;
+#endif
+    default:
+      g_warn_if_reached ();
+      return COGL_PIXEL_FORMAT_ARGB_8888;
+    }
+}
+
+static void
+upload_shm_region (CoglTexture2D         *texture,
+                   struct wl_buffer      *buffer,
+                   cairo_rectangle_int_t *rect)
+{
+  cogl_texture_set_region (COGL_TEXTURE (texture),
+                           rect->x, rect->y,
+                           rect->x, rect->y,
+                           rect->width, rect->height,
+                           buffer->width, buffer->height,
+                           get_shm_buffer_format (buffer),
+                           wl_shm_buffer_get_stride (buffer),
+                           wl_shm_buffer_get_data (buffer));
+}
+
+/* swaps the textures of a surface showing wl_shm buffers, and brings
+ * the new front texture up to date with @buffer; returns %FALSE if
+ * @buffer cannot reuse the textures of the surface
+ */
+static gboolean
+swap_shm_buffers (ClutterWaylandSurface *self,
+                  struct wl_buffer      *buffer)
+{
+  ClutterWaylandSurfacePrivate *priv = self->priv;
+  CoglTexture2D *tmp;
+  int i, n_rects;
+
+  if (!priv->is_shm || priv->back_buffer == NULL)
+    return FALSE;
+
+  if (!wl_buffer_is_shm (buffer) ||
+      wl_shm_buffer_get_format (buffer) != priv->shm_format ||
+      buffer->width != priv->width ||
+      buffer->height != priv->height)
+    return FALSE;
+
+  tmp = priv->buffer;
+  priv->buffer = priv->back_buffer;
+  priv->back_buffer = tmp;
+
+  n_rects = cairo_region_num_rectangles (priv->back_damage);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (priv->back_damage, i, &rect);
+      upload_shm_region (priv->buffer, buffer, &rect);
+    }
+
+  cairo_region_destroy (priv->back_damage);
+  priv->back_damage = cairo_region_create ();
+
+  if (priv->pipeline != NULL)
+    cogl_pipeline_set_layer_texture (priv->pipeline, 0,
+                                     COGL_TEXTURE (priv->buffer));
+
+  return TRUE;
 }
 
 static void
@@ -345,6 +526,43 @@ clutter_wayland_surface_paint (ClutterActor *self)
                                   paint_opacity);
       cogl_pipeline_set_layer_texture (priv->pipeline, 0,
                                        COGL_TEXTURE (priv->buffer));
+
+      if (priv->n_planes > 0)
+        {
+          static CoglSnippet *nv12_snippet = NULL;
+          static CoglSnippet *yuv420_snippet = NULL;
+          CoglSnippet *snippet;
+          guint i;
+
+          for (i = 0; i < priv->n_planes; i++)
+            cogl_pipeline_set_layer_texture (priv->pipeline, i + 1,
+                                             priv->planes[i]);
+
+          if (priv->n_planes == 1)
+            {
+              if (G_UNLIKELY (nv12_snippet == NULL))
+                {
+                  nv12_snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT,
+                                                   NULL, NULL);
+                  cogl_snippet_set_replace (nv12_snippet, nv12_fragment_source);
+                }
+
+              snippet = nv12_snippet;
+            }
+          else
+            {
+              if (G_UNLIKELY (yuv420_snippet == NULL))
+                {
+                  yuv420_snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT,
+                                                     NULL, NULL);
+                  cogl_snippet_set_replace (yuv420_snippet, yuv420_fragment_source);
+                }
+
+              snippet = yuv420_snippet;
+            }
+
+          cogl_pipeline_add_snippet (priv->pipeline, snippet);
+        }
     }
 
   cogl_set_source (priv->pipeline);
@@ -398,6 +616,27 @@ clutter_wayland_surface_has_overlaps (ClutterActor *self)
   return FALSE;
 }
 
+static gboolean
+clutter_wayland_surface_get_opaque_box (ClutterActor    *self,
+                                        ClutterActorBox *box)
+{
+  ClutterWaylandSurfacePrivate *priv = CLUTTER_WAYLAND_SURFACE (self)->priv;
+
+  /* buffers without an alpha channel, like XRGB or YUV buffers, cover
+   * the whole allocation; this lets a fullscreen surface hide the rest
+   * of the stage
+   */
+  if (priv->buffer == NULL ||
+      (cogl_texture_get_format (COGL_TEXTURE (priv->buffer)) & COGL_A_BIT) != 0)
+    return CLUTTER_ACTOR_CLASS (clutter_wayland_surface_parent_class)->get_opaque_box (self, box);
+
+  box->x1 = 0.f;
+  box->y1 = 0.f;
+  clutter_actor_get_size (self, &box->x2, &box->y2);
+
+  return TRUE;
+}
+
 static void
 clutter_wayland_surface_class_init (ClutterWaylandSurfaceClass *klass)
 {
@@ -414,6 +653,7 @@ clutter_wayland_surface_class_init (ClutterWaylandSurfaceClass *klass)
   actor_class->get_preferred_height =
     clutter_wayland_surface_get_preferred_height;
   actor_class->has_overlaps = clutter_wayland_surface_has_overlaps;
+  actor_class->get_opaque_box = clutter_wayland_surface_get_opaque_box;
 
   object_class->dispose      = clutter_wayland_surface_dispose;
   object_class->set_property = clutter_wayland_surface_set_property;
@@ -538,6 +778,47 @@ clutter_wayland_surface_attach_buffer (ClutterWaylandSurface *self,
 
   priv = self->priv;
 
+  /* re-attaching a wl_shm buffer only uploads what changed since the
+   * back texture was used
+   */
+  if (swap_shm_buffers (self, buffer))
+    {
+      g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_COGL_TEXTURE]);
+      return TRUE;
+    }
+
+  if (priv->is_shm &&
+      priv->back_buffer == NULL &&
+      wl_buffer_is_shm (buffer) &&
+      wl_shm_buffer_get_format (buffer) == priv->shm_format &&
+      buffer->width == priv->width &&
+      buffer->height == priv->height)
+    {
+      /* the second texture is created on the second attach, with a
+       * full upload; from then on the two textures are used in turns
+       */
+      priv->back_buffer = priv->buffer;
+      priv->buffer =
+        cogl_wayland_texture_2d_new_from_buffer (context, buffer, error);
+
+      if (priv->buffer != NULL)
+        {
+          priv->back_damage = cairo_region_create ();
+
+          if (priv->pipeline != NULL)
+            cogl_pipeline_set_layer_texture (priv->pipeline, 0,
+                                             COGL_TEXTURE (priv->buffer));
+
+          g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_COGL_TEXTURE]);
+          return TRUE;
+        }
+
+      priv->buffer = priv->back_buffer;
+      priv->back_buffer = NULL;
+
+      return FALSE;
+    }
+
   free_surface_buffers (self);
 
   set_size (self, buffer->width, buffer->height);
@@ -545,6 +826,12 @@ clutter_wayland_surface_attach_buffer (ClutterWaylandSurface *self,
   priv->buffer =
     cogl_wayland_texture_2d_new_from_buffer (context, buffer, error);
 
+  if (priv->buffer != NULL && wl_buffer_is_shm (buffer))
+    {
+      priv->is_shm = TRUE;
+      priv->shm_format = wl_shm_buffer_get_format (buffer);
+    }
+
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_COGL_TEXTURE]);
 
   /* NB: We don't queue a redraw of the actor here because we don't
@@ -593,38 +880,22 @@ clutter_wayland_surface_damage_buffer (ClutterWaylandSurface *self,
 
   if (priv->buffer && wl_buffer_is_shm (buffer))
     {
-      CoglPixelFormat format;
+      cairo_rectangle_int_t rect;
 
-      switch (wl_shm_buffer_get_format (buffer))
+      /* the damage can extend outside of the buffer */
+      rect.x = CLAMP (x, 0, buffer->width);
+      rect.y = CLAMP (y, 0, buffer->height);
+      rect.width = CLAMP (x + width, 0, buffer->width) - rect.x;
+      rect.height = CLAMP (y + height, 0, buffer->height) - rect.y;
+
+      if (rect.width > 0 && rect.height > 0)
         {
-#if G_BYTE_ORDER == G_BIG_ENDIAN
-          case WL_SHM_FORMAT_ARGB8888:
-            format = COGL_PIXEL_FORMAT_ARGB_8888_PRE;
-            break;
-          case WL_SHM_FORMAT_XRGB8888:
-            format = COGL_PIXEL_FORMAT_ARGB_8888;
-            break;
-#elif G_BYTE_ORDER == G_LITTLE_ENDIAN
-          case WL_SHM_FORMAT_ARGB8888:
-            format = COGL_PIXEL_FORMAT_BGRA_8888_PRE;
-            break;
-          case WL_SHM_FORMAT_XRGB8888:
-            format = COGL_PIXEL_FORMAT_BGRA_8888;
-            break;
-#endif
-          default:
-            g_warn_if_reached ();
-            format = COGL_PIXEL_FORMAT_ARGB_8888;
-        }
+          upload_shm_region (priv->buffer, buffer, &rect);
 
-      cogl_texture_set_region (COGL_TEXTURE (priv->buffer),
-                               x, y,
-                               x, y,
-                               width, height,
-                               width, height,
-                               format,
-                               wl_shm_buffer_get_stride (buffer),
-                               wl_shm_buffer_get_data (buffer));
+          /* the back texture will need it when it is used again */
+          if (priv->back_damage != NULL)
+            cairo_region_union_rectangle (priv->back_damage, &rect);
+        }
     }
 
   g_signal_emit (self, signals[QUEUE_DAMAGE_REDRAW],
@@ -632,6 +903,147 @@ clutter_wayland_surface_damage_buffer (ClutterWaylandSurface *self,
                  x, y, width, height);
 }
 
+/**
+ * clutter_wayland_surface_attach_dma_buf:
+ * @self: A #ClutterWaylandSurface actor
+ * @width: the width of the buffer
+ * @height: the height of the buffer
+ * @drm_format: the DRM fourcc code of the format of the buffer
+ * @n_planes: the number of planes of the buffer
+ * @fds: (array length=n_planes): the file descriptors of the planes
+ * @strides: (array length=n_planes): the length of the rows of each plane
+ * @offsets: (array length=n_planes): the offset of the first pixel of
+ *   each plane
+ * @error: A #GError
+ *
+ * Associates a linux-dmabuf buffer with the #ClutterWaylandSurface
+ * actor @self, without copying its contents.
+ *
+ * This function requires the <literal>EGL_EXT_image_dma_buf_import</literal>
+ * extension. The single plane RGB formats supported by
+ * clutter_egl_image_set_dma_buf() are sampled directly; the
+ * <literal>NV12</literal>, <literal>YUV420</literal> and
+ * <literal>YVU420</literal> formats are imported one plane at a time,
+ * and converted to RGB when painting.
+ *
+ * The file descriptors are not owned by @self, and can be closed once
+ * this function returns. As with clutter_wayland_surface_attach_buffer(),
+ * the actor is only redrawn in response to damage.
+ *
+ * Return value: %TRUE if the buffer was successfully imported
+ *
+ * Stability: unstable
+ */
+gboolean
+clutter_wayland_surface_attach_dma_buf (ClutterWaylandSurface *self,
+                                        guint                  width,
+                                        guint                  height,
+                                        guint32                drm_format,
+                                        guint                  n_planes,
+                                        const gint            *fds,
+                                        const guint           *strides,
+                                        const guint           *offsets,
+                                        GError               **error)
+{
+#ifdef CLUTTER_WINDOWING_EGL
+  ClutterWaylandSurfacePrivate *priv;
+  CoglTexture *textures[3] = { NULL, };
+  CoglPixelFormat pixel_format;
+  const YuvFormat *yuv = NULL;
+  guint i, n_textures;
+
+  g_return_val_if_fail (CLUTTER_WAYLAND_IS_SURFACE (self), FALSE);
+  g_return_val_if_fail (width > 0 && height > 0, FALSE);
+  g_return_val_if_fail (n_planes > 0, FALSE);
+  g_return_val_if_fail (fds != NULL && strides != NULL && offsets != NULL, FALSE);
+
+  priv = self->priv;
+
+  if (_clutter_egl_get_dma_buf_format (drm_format, &pixel_format))
+    {
+      textures[0] =
+        _clutter_egl_texture_new_from_dma_buf (fds[0], width, height,
+                                               strides[0], offsets[0],
+                                               drm_format,
+                                               pixel_format,
+                                               error);
+      if (textures[0] == NULL)
+        return FALSE;
+
+      n_textures = 1;
+    }
+  else
+    {
+      for (i = 0; i < G_N_ELEMENTS (yuv_formats); i++)
+        {
+          if (yuv_formats[i].drm_format == drm_format)
+            {
+              yuv = &yuv_formats[i];
+              break;
+            }
+        }
+
+      if (yuv == NULL || n_planes < yuv->n_planes)
+        {
+          g_set_error (error, CLUTTER_IMAGE_ERROR,
+                       CLUTTER_IMAGE_ERROR_INVALID_DATA,
+                       "Unsupported dma-buf format '%c%c%c%c' with %u planes",
+                       drm_format & 0xff,
+                       (drm_format >> 8) & 0xff,
+                       (drm_format >> 16) & 0xff,
+                       (drm_format >> 24) & 0xff,
+                       n_planes);
+          return FALSE;
+        }
+
+      for (i = 0; i < yuv->n_planes; i++)
+        {
+          guint plane = yuv->plane_order[i];
+          guint subsampling = yuv->plane_subsampling[i];
+
+          /* the planes are only sampled, so the alpha is ignored */
+          textures[i] =
+            _clutter_egl_texture_new_from_dma_buf (fds[plane],
+                                                   (width + subsampling - 1) / subsampling,
+                                                   (height + subsampling - 1) / subsampling,
+                                                   strides[plane],
+                                                   offsets[plane],
+                                                   yuv->plane_formats[i],
+                                                   COGL_PIXEL_FORMAT_RGB_888,
+                                                   error);
+          if (textures[i] == NULL)
+            {
+              while (i-- > 0)
+                cogl_object_unref (textures[i]);
+
+              return FALSE;
+            }
+        }
+
+      n_textures = yuv->n_planes;
+    }
+
+  free_surface_buffers (self);
+
+  set_size (self, width, height);
+
+  priv->buffer = (CoglTexture2D *) textures[0];
+  for (i = 1; i < n_textures; i++)
+    priv->planes[priv->n_planes++] = textures[i];
+
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_COGL_TEXTURE]);
+
+  return TRUE;
+#else
+  g_return_val_if_fail (CLUTTER_WAYLAND_IS_SURFACE (self), FALSE);
+
+  g_set_error_literal (error, CLUTTER_IMAGE_ERROR,
+                       CLUTTER_IMAGE_ERROR_INVALID_DATA,
+                       "Importing dma-buf is not supported");
+  return FALSE;
+#endif
+}
+
 /**
  * clutter_wayland_surface_get_cogl_texture:
  * @self: a #ClutterWaylandSurface
@@ -97,6 +97,15 @@ struct wl_surface *clutter_wayland_surface_get_surface  (ClutterWaylandSurface *
 gboolean      clutter_wayland_surface_attach_buffer     (ClutterWaylandSurface *self,
                                                          struct wl_buffer *buffer,
                                                          GError **error);
+gboolean      clutter_wayland_surface_attach_dma_buf    (ClutterWaylandSurface *self,
+                                                         guint width,
+                                                         guint height,
+                                                         guint32 drm_format,
+                                                         guint n_planes,
+                                                         const gint *fds,
+                                                         const guint *strides,
+                                                         const guint *offsets,
+                                                         GError **error);
 void          clutter_wayland_surface_damage_buffer     (ClutterWaylandSurface *self,
                                                          struct wl_buffer *buffer,
                                                          gint32 x,
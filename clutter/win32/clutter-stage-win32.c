@@ -39,6 +39,19 @@
 #include "cogl/cogl.h"
 
 #include <windows.h>
+#include <dwmapi.h>
+
+/* the DWM is only available since Windows Vista, so its entry points
+ * are resolved at run time
+ */
+typedef HRESULT (WINAPI *DwmIsCompositionEnabledFunc) (BOOL *enabled);
+typedef HRESULT (WINAPI *DwmFlushFunc) (void);
+typedef HRESULT (WINAPI *DwmGetCompositionTimingInfoFunc) (HWND             hwnd,
+                                                           DWM_TIMING_INFO *info);
+
+static DwmIsCompositionEnabledFunc dwm_is_composition_enabled = NULL;
+static DwmFlushFunc dwm_flush = NULL;
+static DwmGetCompositionTimingInfoFunc dwm_get_composition_timing_info = NULL;
 
 static void clutter_stage_window_iface_init (ClutterStageWindowIface *iface);
 
@@ -525,6 +538,8 @@ clutter_stage_win32_realize (ClutterStageWindow *stage_window)
       goto fail;
     }
 
+  clutter_stage_win32_start_vblank_thread (stage_win32);
+
   CLUTTER_NOTE (BACKEND, "Successfully realized stage");
 
   return TRUE;
@@ -533,6 +548,164 @@ clutter_stage_win32_realize (ClutterStageWindow *stage_window)
   return FALSE;
 }
 
+static gboolean
+clutter_stage_win32_load_dwm (void)
+{
+  static gboolean dwm_loaded = FALSE;
+  BOOL enabled = FALSE;
+
+  if (!dwm_loaded)
+    {
+      HMODULE dwmapi = LoadLibraryW (L"dwmapi.dll");
+
+      if (dwmapi != NULL)
+        {
+          dwm_is_composition_enabled = (DwmIsCompositionEnabledFunc)
+            GetProcAddress (dwmapi, "DwmIsCompositionEnabled");
+          dwm_flush = (DwmFlushFunc)
+            GetProcAddress (dwmapi, "DwmFlush");
+          dwm_get_composition_timing_info = (DwmGetCompositionTimingInfoFunc)
+            GetProcAddress (dwmapi, "DwmGetCompositionTimingInfo");
+        }
+
+      dwm_loaded = TRUE;
+    }
+
+  if (dwm_is_composition_enabled == NULL ||
+      dwm_flush == NULL ||
+      dwm_get_composition_timing_info == NULL)
+    return FALSE;
+
+  /* without composition DwmFlush() returns immediately */
+  if (FAILED (dwm_is_composition_enabled (&enabled)))
+    return FALSE;
+
+  return enabled;
+}
+
+/* converts a value of the performance counter to the monotonic clock */
+static gint64
+qpc_to_monotonic_time (LONGLONG qpc,
+                       LONGLONG frequency)
+{
+  LARGE_INTEGER now_qpc;
+  gint64 now;
+
+  QueryPerformanceCounter (&now_qpc);
+  now = g_get_monotonic_time ();
+
+  return now + (qpc - now_qpc.QuadPart) * G_USEC_PER_SEC / frequency;
+}
+
+/* Waits for the composition pass that picks up the frame we have just
+ * swapped, and reports the time of the vertical refresh on which it
+ * is going to be presented; this is the equivalent of the frame
+ * callback of the Cogl windowing systems that support swap events.
+ */
+static gpointer
+clutter_stage_win32_vblank_thread (gpointer data)
+{
+  ClutterStageWin32 *stage_win32 = data;
+  LARGE_INTEGER frequency;
+
+  QueryPerformanceFrequency (&frequency);
+
+  g_mutex_lock (&stage_win32->vblank_lock);
+
+  while (!stage_win32->vblank_quit)
+    {
+      DWM_TIMING_INFO info;
+
+      if (stage_win32->pending_swaps == 0)
+        {
+          g_cond_wait (&stage_win32->vblank_cond, &stage_win32->vblank_lock);
+          continue;
+        }
+
+      g_mutex_unlock (&stage_win32->vblank_lock);
+
+      dwm_flush ();
+
+      memset (&info, 0, sizeof (info));
+      info.cbSize = sizeof (info);
+
+      /* the timing information is only available for the whole desktop
+       * since Windows 8.1, so we do not pass the stage window
+       */
+      if (FAILED (dwm_get_composition_timing_info (NULL, &info)))
+        info.qpcVBlank = 0;
+
+      g_mutex_lock (&stage_win32->vblank_lock);
+
+      if (info.qpcVBlank != 0 && frequency.QuadPart != 0)
+        {
+          stage_win32->last_presentation_time =
+            qpc_to_monotonic_time (info.qpcVBlank, frequency.QuadPart);
+
+          if (info.qpcRefreshPeriod != 0)
+            stage_win32->refresh_interval =
+              info.qpcRefreshPeriod * G_USEC_PER_SEC / frequency.QuadPart;
+        }
+
+      if (stage_win32->pending_swaps > 0)
+        stage_win32->pending_swaps--;
+
+      /* the master clock is waiting for the swap to complete */
+      g_main_context_wakeup (NULL);
+    }
+
+  g_mutex_unlock (&stage_win32->vblank_lock);
+
+  return NULL;
+}
+
+static void
+clutter_stage_win32_start_vblank_thread (ClutterStageWin32 *stage_win32)
+{
+  GError *error = NULL;
+
+  if (stage_win32->vblank_thread != NULL)
+    return;
+
+  if (!_clutter_get_sync_to_vblank () || !clutter_stage_win32_load_dwm ())
+    {
+      CLUTTER_NOTE (BACKEND, "Desktop composition not available; "
+                             "the presentation times are unknown");
+      return;
+    }
+
+  stage_win32->vblank_quit = FALSE;
+  stage_win32->vblank_thread =
+    g_thread_try_new ("Clutter vblank",
+                      clutter_stage_win32_vblank_thread,
+                      stage_win32,
+                      &error);
+
+  if (stage_win32->vblank_thread == NULL)
+    {
+      g_warning ("Unable to create the vblank thread: %s", error->message);
+      g_error_free (error);
+    }
+}
+
+static void
+clutter_stage_win32_stop_vblank_thread (ClutterStageWin32 *stage_win32)
+{
+  if (stage_win32->vblank_thread == NULL)
+    return;
+
+  g_mutex_lock (&stage_win32->vblank_lock);
+  stage_win32->vblank_quit = TRUE;
+  g_cond_signal (&stage_win32->vblank_cond);
+  g_mutex_unlock (&stage_win32->vblank_lock);
+
+  g_thread_join (stage_win32->vblank_thread);
+  stage_win32->vblank_thread = NULL;
+
+  stage_win32->pending_swaps = 0;
+  stage_win32->last_presentation_time = 0;
+}
+
 static void
 clutter_stage_win32_unprepare_window (ClutterStageWin32 *stage_win32)
 {
@@ -554,6 +727,7 @@ clutter_stage_win32_unrealize (ClutterStageWindow *stage_window)
 
   CLUTTER_NOTE (BACKEND, "Unrealizing stage");
 
+  clutter_stage_win32_stop_vblank_thread (stage_win32);
   clutter_stage_win32_unprepare_window (stage_win32);
 }
 
@@ -567,7 +741,133 @@ clutter_stage_win32_redraw (ClutterStageWindow *stage_window)
   cogl_flush ();
 
   if (stage_win32->onscreen)
-    cogl_onscreen_swap_buffers (COGL_FRAMEBUFFER (stage_win32->onscreen));
+    {
+      cogl_onscreen_swap_buffers (COGL_FRAMEBUFFER (stage_win32->onscreen));
+
+      if (stage_win32->vblank_thread != NULL)
+        {
+          g_mutex_lock (&stage_win32->vblank_lock);
+          stage_win32->pending_swaps++;
+          g_cond_signal (&stage_win32->vblank_cond);
+          g_mutex_unlock (&stage_win32->vblank_lock);
+        }
+    }
+}
+
+static gint64
+clutter_stage_win32_get_refresh_interval_locked (ClutterStageWin32 *stage_win32)
+{
+  if (stage_win32->refresh_interval <= 0)
+    return 16667; /* 1/60th second */
+
+  return stage_win32->refresh_interval;
+}
+
+static void
+clutter_stage_win32_schedule_update (ClutterStageWindow *stage_window,
+                                     gint                sync_delay)
+{
+  ClutterStageWin32 *stage_win32 = CLUTTER_STAGE_WIN32 (stage_window);
+  gint64 now, refresh_interval, last_presentation_time;
+
+  if (stage_win32->update_time != -1)
+    return;
+
+  now = g_get_monotonic_time ();
+
+  if (sync_delay < 0)
+    {
+      stage_win32->update_time = now;
+      return;
+    }
+
+  g_mutex_lock (&stage_win32->vblank_lock);
+  last_presentation_time = stage_win32->last_presentation_time;
+  refresh_interval = clutter_stage_win32_get_refresh_interval_locked (stage_win32);
+  g_mutex_unlock (&stage_win32->vblank_lock);
+
+  /* see clutter_stage_cogl_schedule_update() */
+  if (last_presentation_time == 0 ||
+      last_presentation_time < now - 150000)
+    {
+      stage_win32->update_time = now;
+      return;
+    }
+
+  stage_win32->update_time = last_presentation_time + 1000 * sync_delay;
+
+  while (stage_win32->update_time < now)
+    stage_win32->update_time += refresh_interval;
+}
+
+static gint64
+clutter_stage_win32_get_update_time (ClutterStageWindow *stage_window)
+{
+  ClutterStageWin32 *stage_win32 = CLUTTER_STAGE_WIN32 (stage_window);
+  guint pending_swaps;
+
+  g_mutex_lock (&stage_win32->vblank_lock);
+  pending_swaps = stage_win32->pending_swaps;
+  g_mutex_unlock (&stage_win32->vblank_lock);
+
+  if (pending_swaps > 0)
+    return -1; /* in the future, indefinite */
+
+  return stage_win32->update_time;
+}
+
+static void
+clutter_stage_win32_clear_update_time (ClutterStageWindow *stage_window)
+{
+  ClutterStageWin32 *stage_win32 = CLUTTER_STAGE_WIN32 (stage_window);
+
+  stage_win32->update_time = -1;
+}
+
+static gint64
+clutter_stage_win32_get_refresh_interval (ClutterStageWindow *stage_window)
+{
+  ClutterStageWin32 *stage_win32 = CLUTTER_STAGE_WIN32 (stage_window);
+  gint64 refresh_interval = 0;
+
+  g_mutex_lock (&stage_win32->vblank_lock);
+
+  /* we don't know the refresh rate until a frame has been presented */
+  if (stage_win32->last_presentation_time != 0)
+    refresh_interval = clutter_stage_win32_get_refresh_interval_locked (stage_win32);
+
+  g_mutex_unlock (&stage_win32->vblank_lock);
+
+  return refresh_interval;
+}
+
+static gint64
+clutter_stage_win32_get_next_presentation_time (ClutterStageWindow *stage_window)
+{
+  ClutterStageWin32 *stage_win32 = CLUTTER_STAGE_WIN32 (stage_window);
+  gint64 now, refresh_interval, next;
+  guint pending_swaps;
+
+  now = g_get_monotonic_time ();
+
+  g_mutex_lock (&stage_win32->vblank_lock);
+  next = stage_win32->last_presentation_time;
+  refresh_interval = clutter_stage_win32_get_refresh_interval_locked (stage_win32);
+  pending_swaps = stage_win32->pending_swaps;
+  g_mutex_unlock (&stage_win32->vblank_lock);
+
+  /* see clutter_stage_cogl_get_next_presentation_time() */
+  if (next == 0 || next < now - 150000)
+    return -1;
+
+  next += refresh_interval;
+  while (next <= now)
+    next += refresh_interval;
+
+  if (pending_swaps > 0)
+    next += refresh_interval;
+
+  return next;
 }
 
 static CoglFramebuffer *
@@ -609,6 +909,8 @@ clutter_stage_win32_dispose (GObject *gobject)
   /* Make sure that context and window are destroyed in case unrealize
    * hasn't been called yet.
    */
+  clutter_stage_win32_stop_vblank_thread (stage_win32);
+
   if (stage_win32->hwnd)
     clutter_stage_win32_unprepare_window (stage_win32);
 
@@ -621,6 +923,17 @@ clutter_stage_win32_dispose (GObject *gobject)
   G_OBJECT_CLASS (clutter_stage_win32_parent_class)->dispose (gobject);
 }
 
+static void
+clutter_stage_win32_finalize (GObject *gobject)
+{
+  ClutterStageWin32 *stage_win32 = CLUTTER_STAGE_WIN32 (gobject);
+
+  g_mutex_clear (&stage_win32->vblank_lock);
+  g_cond_clear (&stage_win32->vblank_cond);
+
+  G_OBJECT_CLASS (clutter_stage_win32_parent_class)->finalize (gobject);
+}
+
 static void
 clutter_stage_win32_class_init (ClutterStageWin32Class *klass)
 {
@@ -628,6 +941,7 @@ clutter_stage_win32_class_init (ClutterStageWin32Class *klass)
 
   gobject_class->set_property = clutter_stage_win32_set_property;
   gobject_class->dispose = clutter_stage_win32_dispose;
+  gobject_class->finalize = clutter_stage_win32_finalize;
 
   g_object_class_override_property (gobject_class, PROP_BACKEND, "backend");
   g_object_class_override_property (gobject_class, PROP_WRAPPER, "wrapper");
@@ -647,6 +961,11 @@ clutter_stage_win32_init (ClutterStageWin32 *stage)
   stage->is_foreign_win = FALSE;
   stage->is_cursor_visible = TRUE;
   stage->accept_focus = TRUE;
+
+  g_mutex_init (&stage->vblank_lock);
+  g_cond_init (&stage->vblank_cond);
+  stage->vblank_thread = NULL;
+  stage->update_time = -1;
 }
 
 static void
@@ -666,6 +985,11 @@ clutter_stage_window_iface_init (ClutterStageWindowIface *iface)
   iface->unrealize = clutter_stage_win32_unrealize;
   iface->redraw = clutter_stage_win32_redraw;
   iface->get_active_framebuffer = clutter_stage_win32_get_active_framebuffer;
+  iface->schedule_update = clutter_stage_win32_schedule_update;
+  iface->get_update_time = clutter_stage_win32_get_update_time;
+  iface->clear_update_time = clutter_stage_win32_clear_update_time;
+  iface->get_refresh_interval = clutter_stage_win32_get_refresh_interval;
+  iface->get_next_presentation_time = clutter_stage_win32_get_next_presentation_time;
 }
 
 /**
@@ -57,6 +57,18 @@ struct _ClutterStageWin32
 
   ClutterStage *wrapper;
 
+  /* frame timings; the presentation times are reported by the
+   * vblank thread, so they are protected by vblank_lock
+   */
+  GThread     *vblank_thread;
+  GMutex       vblank_lock;
+  GCond        vblank_cond;
+  gboolean     vblank_quit;
+  guint        pending_swaps;
+  gint64       update_time;
+  gint64       last_presentation_time;
+  gint64       refresh_interval;
+
   guint is_foreign_win    : 1;
   guint tracking_mouse    : 1;
   guint is_cursor_visible : 1;
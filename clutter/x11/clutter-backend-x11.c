@@ -687,6 +687,19 @@ clutter_backend_x11_translate_event (ClutterBackend *backend,
   return parent_class->translate_event (backend, native, event);
 }
 
+static gulong
+clutter_backend_x11_get_event_window (ClutterBackend *backend,
+                                      gpointer        native)
+{
+  XEvent *xevent = native;
+
+  /* the window of generic events is not meaningful */
+  if (xevent->type == GenericEvent)
+    return None;
+
+  return xevent->xany.window;
+}
+
 static CoglRenderer *
 clutter_backend_x11_get_renderer (ClutterBackend  *backend,
                                   GError         **error)
@@ -774,18 +787,16 @@ clutter_backend_x11_create_stage (ClutterBackend  *backend,
 				  ClutterStage    *wrapper,
 				  GError         **error)
 {
-  ClutterEventTranslator *translator;
   ClutterStageWindow *stage;
 
+  /* the X11 stage does event translation for its own window, and
+   * registers itself as a translator when realized
+   */
   stage = g_object_new (CLUTTER_TYPE_STAGE_X11,
 			"backend", backend,
 			"wrapper", wrapper,
 			NULL);
 
-  /* the X11 stage does event translation */
-  translator = CLUTTER_EVENT_TRANSLATOR (stage);
-  _clutter_backend_add_event_translator (backend, translator);
-
   CLUTTER_NOTE (MISC, "X11 stage created (display:%p, screen:%d, root:%u)",
                 CLUTTER_BACKEND_X11 (backend)->xdpy,
                 CLUTTER_BACKEND_X11 (backend)->xscreen_num,
@@ -813,6 +824,7 @@ clutter_backend_x11_class_init (ClutterBackendX11Class *klass)
   backend_class->copy_event_data = clutter_backend_x11_copy_event_data;
   backend_class->free_event_data = clutter_backend_x11_free_event_data;
   backend_class->translate_event = clutter_backend_x11_translate_event;
+  backend_class->get_event_window = clutter_backend_x11_get_event_window;
 
   backend_class->get_renderer = clutter_backend_x11_get_renderer;
   backend_class->get_display = clutter_backend_x11_get_display;
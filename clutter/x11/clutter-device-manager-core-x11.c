@@ -237,6 +237,7 @@ translate_key_event (ClutterBackendX11       *backend_x11,
     _clutter_keymap_x11_translate_key_state (backend_x11->keymap,
                                              event->key.hardware_keycode,
                                              &event->key.modifier_state,
+                                             NULL,
                                              NULL);
 
   event_x11->key_group =
@@ -305,6 +305,97 @@ create_device (ClutterDeviceManagerXI2 *manager_xi2,
   return retval;
 }
 
+static inline ClutterDeviceSlotXI2 *
+get_device_slot (ClutterDeviceManagerXI2 *manager_xi2,
+                 gint                     device_id)
+{
+  if (device_id < 0 || device_id >= manager_xi2->device_slots->len)
+    return NULL;
+
+  return &g_array_index (manager_xi2->device_slots,
+                         ClutterDeviceSlotXI2,
+                         device_id);
+}
+
+static inline ClutterInputDevice *
+get_device_by_id (ClutterDeviceManagerXI2 *manager_xi2,
+                  gint                     device_id)
+{
+  ClutterDeviceSlotXI2 *slot = get_device_slot (manager_xi2, device_id);
+
+  return slot != NULL ? slot->device : NULL;
+}
+
+/* precomputes the translation of the valuators of @device; this is
+ * done when the device is added, and when its classes change
+ */
+static void
+update_device_slot (ClutterDeviceManagerXI2 *manager_xi2,
+                    gint                     device_id,
+                    ClutterInputDevice      *device)
+{
+  ClutterDeviceSlotXI2 *slot;
+  guint i;
+
+  if (device_id < 0)
+    return;
+
+  if (device_id >= manager_xi2->device_slots->len)
+    {
+      if (device == NULL)
+        return;
+
+      g_array_set_size (manager_xi2->device_slots, device_id + 1);
+    }
+
+  slot = get_device_slot (manager_xi2, device_id);
+
+  g_free (slot->axes);
+  slot->device = device;
+  slot->axes = NULL;
+  slot->n_axes = 0;
+
+  if (device == NULL || device->axes == NULL || device->axes->len == 0)
+    return;
+
+  slot->n_axes = device->axes->len;
+  slot->axes = g_new0 (ClutterAxisEntryXI2, slot->n_axes);
+
+  for (i = 0; i < slot->n_axes; i++)
+    {
+      ClutterAxisInfo *info = &g_array_index (device->axes, ClutterAxisInfo, i);
+      ClutterAxisEntryXI2 *entry = &slot->axes[i];
+      gdouble width = info->max_value - info->min_value;
+
+      entry->axis = info->axis;
+
+      /* see _clutter_input_device_translate_axis() */
+      if (width != 0.0)
+        {
+          entry->scale = (info->max_axis - info->min_axis) / width;
+          entry->offset = (info->min_axis * info->max_value
+                        - info->max_axis * info->min_value) / width;
+        }
+      else
+        {
+          entry->scale = 0.0;
+          entry->offset = info->min_axis;
+        }
+    }
+
+  if (device->scroll_info != NULL)
+    {
+      for (i = 0; i < device->scroll_info->len; i++)
+        {
+          ClutterScrollInfo *info =
+            &g_array_index (device->scroll_info, ClutterScrollInfo, i);
+
+          if (info->axis_id < slot->n_axes)
+            slot->axes[info->axis_id].is_scroll = TRUE;
+        }
+    }
+}
+
 static ClutterInputDevice *
 add_device (ClutterDeviceManagerXI2 *manager_xi2,
             ClutterBackendX11       *backend_x11,
@@ -321,6 +412,7 @@ add_device (ClutterDeviceManagerXI2 *manager_xi2,
   g_hash_table_replace (manager_xi2->devices_by_id,
                         GINT_TO_POINTER (info->deviceid),
                         g_object_ref (device));
+  update_device_slot (manager_xi2, info->deviceid, device);
 
   if (info->use == XIMasterPointer ||
       info->use == XIMasterKeyboard)
@@ -348,8 +440,7 @@ add_device (ClutterDeviceManagerXI2 *manager_xi2,
         {
           ClutterInputDevice *master;
 
-          master = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                        GINT_TO_POINTER (info->attachment));
+          master = get_device_by_id (manager_xi2, info->attachment);
           _clutter_input_device_set_associated_device (device, master);
           _clutter_input_device_add_slave (master, device);
         }
@@ -370,8 +461,7 @@ remove_device (ClutterDeviceManagerXI2 *manager_xi2,
 {
   ClutterInputDevice *device;
 
-  device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                GINT_TO_POINTER (device_id));
+  device = get_device_by_id (manager_xi2, device_id);
 
   if (device != NULL)
     {
@@ -388,6 +478,7 @@ remove_device (ClutterDeviceManagerXI2 *manager_xi2,
 
       g_object_run_dispose (G_OBJECT (device));
 
+      update_device_slot (manager_xi2, device_id, NULL);
       g_hash_table_remove (manager_xi2->devices_by_id,
                            GINT_TO_POINTER (device_id));
     }
@@ -403,8 +494,7 @@ translate_hierarchy_event (ClutterBackendX11       *backend_x11,
   for (i = 0; i < ev->num_info; i++)
     {
       if (ev->info[i].flags & XIDeviceEnabled &&
-          !g_hash_table_lookup (manager_xi2->devices_by_id,
-                                GINT_TO_POINTER (ev->info[i].deviceid)))
+          !get_device_by_id (manager_xi2, ev->info[i].deviceid))
         {
           XIDeviceInfo *info;
           int n_devices;
@@ -435,8 +525,7 @@ translate_hierarchy_event (ClutterBackendX11       *backend_x11,
                           ? "attached"
                           : "detached");
 
-          slave = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                       GINT_TO_POINTER (ev->info[i].deviceid));
+          slave = get_device_by_id (manager_xi2, ev->info[i].deviceid);
           master = clutter_input_device_get_associated_device (slave);
 
           /* detach the slave in both cases */
@@ -454,8 +543,7 @@ translate_hierarchy_event (ClutterBackendX11       *backend_x11,
               info = XIQueryDevice (backend_x11->xdpy,
                                     ev->info[i].deviceid,
                                     &n_devices);
-              master = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                            GINT_TO_POINTER (info->attachment));
+              master = get_device_by_id (manager_xi2, info->attachment);
               _clutter_input_device_set_associated_device (slave, master);
               _clutter_input_device_add_slave (master, slave);
 
@@ -587,45 +675,58 @@ print_keysym (uint32_t symbol,
   return 1;
 }
 
+/* the valuator masks are walked a byte at a time, skipping the bytes
+ * with no bits set, and then a set bit at a time; the values array is
+ * packed, in the order of the set bits
+ */
 static gdouble *
-translate_axes (ClutterInputDevice *device,
-                gdouble             x,
-                gdouble             y,
-                ClutterStageX11    *stage_x11,
-                XIValuatorState    *valuators)
+translate_axes (ClutterDeviceSlotXI2 *slot,
+                gdouble               x,
+                gdouble               y,
+                ClutterStageX11      *stage_x11,
+                XIValuatorState      *valuators)
 {
-  guint n_axes = clutter_input_device_get_n_axes (device);
-  guint i;
   gdouble *retval;
-  double *values;
+  guint byte, n_val;
+
+  if (slot == NULL || slot->n_axes == 0)
+    return NULL;
 
-  retval = g_new0 (gdouble, n_axes);
-  values = valuators->values;
+  retval = g_new0 (gdouble, slot->n_axes);
 
-  for (i = 0; i < valuators->mask_len * 8; i++)
+  n_val = 0;
+  for (byte = 0; byte < valuators->mask_len; byte++)
     {
-      ClutterInputAxis axis;
-      gdouble val;
+      guint bits = valuators->mask[byte];
 
-      if (!XIMaskIsSet (valuators->mask, i))
-        continue;
+      while (bits != 0)
+        {
+          const ClutterAxisEntryXI2 *entry;
+          guint i = byte * 8 + g_bit_nth_lsf (bits, -1);
+          gdouble value = valuators->values[n_val++];
 
-      axis = clutter_input_device_get_axis (device, i);
-      val = *values++;
+          bits &= bits - 1;
 
-      switch (axis)
-        {
-        case CLUTTER_INPUT_AXIS_X:
-          retval[i] = x;
-          break;
+          /* valuators beyond the known axes have no meaning for us */
+          if (i >= slot->n_axes)
+            return retval;
 
-        case CLUTTER_INPUT_AXIS_Y:
-          retval[i] = y;
-          break;
+          entry = &slot->axes[i];
 
-        default:
-          _clutter_input_device_translate_axis (device, i, val, &retval[i]);
-          break;
+          switch (entry->axis)
+            {
+            case CLUTTER_INPUT_AXIS_X:
+              retval[i] = x;
+              break;
+
+            case CLUTTER_INPUT_AXIS_Y:
+              retval[i] = y;
+              break;
+
+            default:
+              retval[i] = value * entry->scale + entry->offset;
+              break;
+            }
         }
     }
 
@@ -633,45 +734,52 @@ translate_axes (ClutterInputDevice *device,
 }
 
 static gdouble
-scroll_valuators_changed (ClutterInputDevice *device,
-                          XIValuatorState    *valuators,
-                          gdouble            *dx_p,
-                          gdouble            *dy_p)
+scroll_valuators_changed (ClutterDeviceSlotXI2 *slot,
+                          XIValuatorState      *valuators,
+                          gdouble              *dx_p,
+                          gdouble              *dy_p)
 {
   gboolean retval = FALSE;
-  guint n_axes, n_val, i;
-  double *values;
-
-  n_axes = clutter_input_device_get_n_axes (device);
-  values = valuators->values;
+  guint byte, n_val;
 
   *dx_p = *dy_p = 0.0;
 
-  n_val = 0;
+  if (slot == NULL)
+    return FALSE;
 
-  for (i = 0; i < MIN (valuators->mask_len * 8, n_axes); i++)
+  n_val = 0;
+  for (byte = 0; byte < valuators->mask_len; byte++)
     {
-      ClutterScrollDirection direction;
-      gdouble delta;
-
-      if (!XIMaskIsSet (valuators->mask, i))
-        continue;
+      guint bits = valuators->mask[byte];
 
-      if (_clutter_input_device_get_scroll_delta (device, i,
-                                                  values[n_val],
-                                                  &direction,
-                                                  &delta))
+      while (bits != 0)
         {
-          retval = TRUE;
+          ClutterScrollDirection direction;
+          guint i = byte * 8 + g_bit_nth_lsf (bits, -1);
+          gdouble value = valuators->values[n_val++];
+          gdouble delta;
 
-          if (direction == CLUTTER_SCROLL_UP ||
-              direction == CLUTTER_SCROLL_DOWN)
-            *dy_p = delta;
-          else
-            *dx_p = delta;
-        }
+          bits &= bits - 1;
+
+          if (i >= slot->n_axes)
+            return retval;
+
+          if (!slot->axes[i].is_scroll)
+            continue;
 
-      n_val += 1;
+          if (_clutter_input_device_get_scroll_delta (slot->device, i, value,
+                                                      &direction,
+                                                      &delta))
+            {
+              retval = TRUE;
+
+              if (direction == CLUTTER_SCROLL_UP ||
+                  direction == CLUTTER_SCROLL_DOWN)
+                *dy_p = delta;
+              else
+                *dx_p = delta;
+            }
+        }
     }
 
   return retval;
@@ -734,10 +842,8 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
       {
         XIDeviceChangedEvent *xev = (XIDeviceChangedEvent *) xi_event;
 
-        device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                      GINT_TO_POINTER (xev->deviceid));
-        source_device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                             GINT_TO_POINTER (xev->sourceid));
+        device = get_device_by_id (manager_xi2, xev->deviceid);
+        source_device = get_device_by_id (manager_xi2, xev->sourceid);
         if (device)
           {
             _clutter_input_device_reset_axes (device);
@@ -745,6 +851,7 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
                                       device,
                                       xev->classes,
                                       xev->num_classes);
+            update_device_slot (manager_xi2, xev->deviceid, device);
           }
 
         if (source_device)
@@ -759,6 +866,7 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
         XIDeviceEvent *xev = (XIDeviceEvent *) xi_event;
         ClutterEventX11 *event_x11;
         char buffer[7] = { 0, };
+        gunichar unicode = 0;
         gunichar n;
 
         event->key.type = event->type = (xev->evtype == XI_KeyPress)
@@ -776,7 +884,8 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
           _clutter_keymap_x11_translate_key_state (backend_x11->keymap,
                                                    event->key.hardware_keycode,
                                                    &event->key.modifier_state,
-                                                   NULL);
+                                                   NULL,
+                                                   &unicode);
 
         /* KeyEvents have platform specific data associated to them */
         event_x11 = _clutter_event_x11_new ();
@@ -793,27 +902,28 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
         event_x11->caps_lock_set =
           _clutter_keymap_x11_get_caps_lock_state (backend_x11->keymap);
 
-        source_device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                             GINT_TO_POINTER (xev->sourceid));
+        source_device = get_device_by_id (manager_xi2, xev->sourceid);
         clutter_event_set_source_device (event, source_device);
 
-        device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                      GINT_TO_POINTER (xev->deviceid));
+        device = get_device_by_id (manager_xi2, xev->deviceid);
         clutter_event_set_device (event, device);
 
         /* XXX keep this in sync with the evdev device manager */
         n = print_keysym (event->key.keyval, buffer, sizeof (buffer));
         if (n == 0)
           {
-            /* not printable */
-            event->key.unicode_value = (gunichar) '\0';
+            /* not printable as Latin-1; use the character cached by
+             * the keymap, so that clutter_event_get_key_unicode() does
+             * not need to look it up for every key event
+             */
+            event->key.unicode_value = unicode;
           }
         else
           {
             event->key.unicode_value = g_utf8_get_char_validated (buffer, n);
             if (event->key.unicode_value == -1 ||
                 event->key.unicode_value == -2)
-              event->key.unicode_value = (gunichar) '\0';
+              event->key.unicode_value = unicode;
           }
 
         CLUTTER_NOTE (EVENT,
@@ -839,10 +949,8 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
       {
         XIDeviceEvent *xev = (XIDeviceEvent *) xi_event;
 
-        source_device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                             GINT_TO_POINTER (xev->sourceid));
-        device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                      GINT_TO_POINTER (xev->deviceid));
+        source_device = get_device_by_id (manager_xi2, xev->sourceid);
+        device = get_device_by_id (manager_xi2, xev->deviceid);
 
         /* Set the stage for core events coming out of nowhere (see bug #684509) */
         if (clutter_input_device_get_device_mode (device) == CLUTTER_INPUT_MODE_MASTER &&
@@ -884,7 +992,7 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
             clutter_event_set_source_device (event, source_device);
             clutter_event_set_device (event, device);
 
-            event->scroll.axes = translate_axes (event->scroll.device,
+            event->scroll.axes = translate_axes (get_device_slot (manager_xi2, xev->deviceid),
                                                  event->scroll.x,
                                                  event->scroll.y,
                                                  stage_x11,
@@ -933,7 +1041,7 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
             clutter_event_set_source_device (event, source_device);
             clutter_event_set_device (event, device);
 
-            event->button.axes = translate_axes (event->button.device,
+            event->button.axes = translate_axes (get_device_slot (manager_xi2, xev->deviceid),
                                                  event->button.x,
                                                  event->button.y,
                                                  stage_x11,
@@ -985,10 +1093,8 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
         XIDeviceEvent *xev = (XIDeviceEvent *) xi_event;
         gdouble delta_x, delta_y;
 
-        source_device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                             GINT_TO_POINTER (xev->sourceid));
-        device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                      GINT_TO_POINTER (xev->deviceid));
+        source_device = get_device_by_id (manager_xi2, xev->sourceid);
+        device = get_device_by_id (manager_xi2, xev->deviceid);
 
         /* Set the stage for core events coming out of nowhere (see bug #684509) */
         if (clutter_input_device_get_device_mode (device) == CLUTTER_INPUT_MODE_MASTER &&
@@ -996,7 +1102,7 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
             stage != NULL)
           _clutter_input_device_set_stage (device, stage);
 
-        if (scroll_valuators_changed (source_device,
+        if (scroll_valuators_changed (get_device_slot (manager_xi2, xev->sourceid),
                                       &xev->valuators,
                                       &delta_x, &delta_y))
           {
@@ -1044,7 +1150,7 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
         clutter_event_set_source_device (event, source_device);
         clutter_event_set_device (event, device);
 
-        event->motion.axes = translate_axes (event->motion.device,
+        event->motion.axes = translate_axes (get_device_slot (manager_xi2, xev->deviceid),
                                              event->motion.x,
                                              event->motion.y,
                                              stage_x11,
@@ -1076,8 +1182,7 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
       {
         XIDeviceEvent *xev = (XIDeviceEvent *) xi_event;
 
-        source_device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                             GINT_TO_POINTER (xev->sourceid));
+        source_device = get_device_by_id (manager_xi2, xev->sourceid);
 
         if (xi_event->evtype == XI_TouchBegin)
           event->touch.type = event->type = CLUTTER_TOUCH_BEGIN;
@@ -1095,11 +1200,10 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
 
         clutter_event_set_source_device (event, source_device);
 
-        device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                      GINT_TO_POINTER (xev->deviceid));
+        device = get_device_by_id (manager_xi2, xev->deviceid);
         clutter_event_set_device (event, device);
 
-        event->touch.axes = translate_axes (event->touch.device,
+        event->touch.axes = translate_axes (get_device_slot (manager_xi2, xev->deviceid),
                                             event->motion.x,
                                             event->motion.y,
                                             stage_x11,
@@ -1135,8 +1239,7 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
       {
         XIDeviceEvent *xev = (XIDeviceEvent *) xi_event;
 
-        source_device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                             GINT_TO_POINTER (xev->sourceid));
+        source_device = get_device_by_id (manager_xi2, xev->sourceid);
 
         event->touch.type = event->type = CLUTTER_TOUCH_UPDATE;
         event->touch.stage = stage;
@@ -1147,11 +1250,10 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
 
         clutter_event_set_source_device (event, source_device);
 
-        device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                      GINT_TO_POINTER (xev->deviceid));
+        device = get_device_by_id (manager_xi2, xev->deviceid);
         clutter_event_set_device (event, device);
 
-        event->touch.axes = translate_axes (event->touch.device,
+        event->touch.axes = translate_axes (get_device_slot (manager_xi2, xev->deviceid),
                                             event->motion.x,
                                             event->motion.y,
                                             stage_x11,
@@ -1185,11 +1287,9 @@ clutter_device_manager_xi2_translate_event (ClutterEventTranslator *translator,
       {
         XIEnterEvent *xev = (XIEnterEvent *) xi_event;
 
-        device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                      GINT_TO_POINTER (xev->deviceid));
+        device = get_device_by_id (manager_xi2, xev->deviceid);
 
-        source_device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                             GINT_TO_POINTER (xev->sourceid));
+        source_device = get_device_by_id (manager_xi2, xev->sourceid);
 
         if (xi_event->evtype == XI_Enter)
           {
@@ -1295,8 +1395,7 @@ clutter_device_manager_xi2_get_device (ClutterDeviceManager *manager,
 {
   ClutterDeviceManagerXI2 *manager_xi2 = CLUTTER_DEVICE_MANAGER_XI2 (manager);
 
-  return g_hash_table_lookup (manager_xi2->devices_by_id,
-                              GINT_TO_POINTER (id));
+  return get_device_by_id (manager_xi2, id);
 }
 
 static ClutterInputDevice *
@@ -1313,8 +1412,7 @@ clutter_device_manager_xi2_get_core_device (ClutterDeviceManager   *manager,
 
   XIGetClientPointer (backend_x11->xdpy, None, &device_id);
 
-  device = g_hash_table_lookup (manager_xi2->devices_by_id,
-                                GINT_TO_POINTER (device_id));
+  device = get_device_by_id (manager_xi2, device_id);
 
   switch (device_type)
     {
@@ -1483,4 +1581,5 @@ clutter_device_manager_xi2_init (ClutterDeviceManagerXI2 *self)
   self->devices_by_id = g_hash_table_new_full (NULL, NULL,
                                                NULL,
                                                (GDestroyNotify) g_object_unref);
+  self->device_slots = g_array_new (FALSE, TRUE, sizeof (ClutterDeviceSlotXI2));
 }
@@ -38,12 +38,38 @@ G_BEGIN_DECLS
 typedef struct _ClutterDeviceManagerXI2         ClutterDeviceManagerXI2;
 typedef struct _ClutterDeviceManagerXI2Class    ClutterDeviceManagerXI2Class;
 
+/* the translation of a valuator of a device into a Clutter axis */
+typedef struct _ClutterAxisEntryXI2
+{
+  ClutterInputAxis axis;
+
+  /* the value of the axis is value * scale + offset */
+  gdouble scale;
+  gdouble offset;
+
+  guint is_scroll : 1;
+} ClutterAxisEntryXI2;
+
+typedef struct _ClutterDeviceSlotXI2
+{
+  ClutterInputDevice *device;
+
+  guint n_axes;
+  ClutterAxisEntryXI2 *axes;
+} ClutterDeviceSlotXI2;
+
 struct _ClutterDeviceManagerXI2
 {
   ClutterDeviceManager parent_instance;
 
   GHashTable *devices_by_id;
 
+  /* ClutterDeviceSlotXI2, indexed by device id; the XI2 device ids
+   * are small integers, and this avoids a hash table lookup and the
+   * parsing of the axes of a device for each event
+   */
+  GArray *device_slots;
+
   GSList *all_devices;
 
   GList *master_devices;
@@ -220,8 +220,7 @@ clutter_x11_handle_event (XEvent *xevent)
   while (spin > 0 && (event = clutter_event_get ()))
     {
       /* forward the event into clutter for emission etc. */
-      clutter_do_event (event);
-      clutter_event_free (event);
+      _clutter_do_event (event, FALSE);
       --spin;
     }
 
@@ -321,8 +320,7 @@ clutter_event_dispatch (GSource     *source,
   if (event != NULL)
     {
       /* forward the event into clutter for emission etc. */
-      clutter_do_event (event);
-      clutter_event_free (event);
+      _clutter_do_event (event, FALSE);
     }
 
   _clutter_threads_release_lock ();
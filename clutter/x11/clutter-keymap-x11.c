@@ -30,6 +30,8 @@
 #include "clutter-event-translator.h"
 #include "clutter-private.h"
 
+#include <string.h>
+
 #include <X11/Xatom.h>
 
 #ifdef HAVE_XKB
@@ -37,6 +39,27 @@
 #endif
 
 typedef struct _ClutterKeymapX11Class   ClutterKeymapX11Class;
+typedef struct _KeyCacheEntry           KeyCacheEntry;
+
+/* the translations of the key events are kept in a direct mapped cache,
+ * indexed by the keycode and the modifiers and group that XKB uses to
+ * pick the shift level; the cache is cleared when the keyboard mapping
+ * changes
+ */
+#define KEY_CACHE_BITS  9
+#define KEY_CACHE_SIZE  (1 << KEY_CACHE_BITS)
+
+struct _KeyCacheEntry
+{
+  /* the keycode, and the state in the upper bits; keycodes start at 8,
+   * so 0 marks an unused entry
+   */
+  guint32 key;
+
+  guint32 keysym;
+  gunichar unicode;
+  ClutterModifierType unconsumed_modifiers;
+};
 
 struct _ClutterKeymapX11
 {
@@ -58,6 +81,9 @@ struct _ClutterKeymapX11
   guint xkb_map_serial;
 #endif
 
+  KeyCacheEntry *key_cache;
+  guint key_cache_serial;
+
   guint caps_lock_state : 1;
   guint num_lock_state  : 1;
 };
@@ -308,6 +334,8 @@ clutter_keymap_x11_finalize (GObject *gobject)
     XkbFreeKeyboard (keymap->xkb_desc, XkbAllComponentsMask, True);
 #endif
 
+  g_free (keymap->key_cache);
+
   G_OBJECT_CLASS (clutter_keymap_x11_parent_class)->finalize (gobject);
 }
 
@@ -438,48 +466,101 @@ translate_keysym (ClutterKeymapX11 *keymap,
 
 G_GNUC_END_IGNORE_DEPRECATIONS
 
-gint
-_clutter_keymap_x11_translate_key_state (ClutterKeymapX11    *keymap,
-                                         guint                hardware_keycode,
-                                         ClutterModifierType *modifier_state_p,
-                                         ClutterModifierType *mods_p)
+static KeyCacheEntry *
+lookup_key_cache (ClutterKeymapX11    *keymap,
+                  guint                hardware_keycode,
+                  ClutterModifierType  modifier_state)
 {
-  ClutterBackendX11 *backend_x11;
-  ClutterModifierType unconsumed_modifiers = 0;
-  ClutterModifierType modifier_state = *modifier_state_p;
-  gint retval;
+  ClutterBackendX11 *backend_x11 = CLUTTER_BACKEND_X11 (keymap->backend);
+  KeyCacheEntry *entry;
+  guint32 key;
 
-  g_return_val_if_fail (CLUTTER_IS_KEYMAP_X11 (keymap), 0);
+  if (keymap->key_cache == NULL)
+    {
+      keymap->key_cache = g_new0 (KeyCacheEntry, KEY_CACHE_SIZE);
+      keymap->key_cache_serial = backend_x11->keymap_serial;
+    }
+  else if (keymap->key_cache_serial != backend_x11->keymap_serial)
+    {
+      CLUTTER_NOTE (EVENT, "Clearing the key translation cache");
 
-  backend_x11 = CLUTTER_BACKEND_X11 (keymap->backend);
+      memset (keymap->key_cache, 0, sizeof (KeyCacheEntry) * KEY_CACHE_SIZE);
+      keymap->key_cache_serial = backend_x11->keymap_serial;
+    }
+
+  /* only the modifiers and the group take part in the translation;
+   * without XKB only the keycode does
+   */
+#ifdef HAVE_XKB
+  if (backend_x11->use_xkb)
+    modifier_state &= 0xff | (0x3 << 13);
+  else
+#endif
+    modifier_state = 0;
+
+  /* the protocol limits the keycodes to the 8..255 range */
+  key = (hardware_keycode & 0xff) | (modifier_state << 8);
+
+  /* Fibonacci hashing of the key */
+  entry = &keymap->key_cache[(key * 2654435761u) >> (32 - KEY_CACHE_BITS)];
+
+  if (entry->key == key)
+    return entry;
 
 #ifdef HAVE_XKB
   if (backend_x11->use_xkb)
     {
       XkbDescRec *xkb = get_xkb (keymap);
+      unsigned int unconsumed_modifiers = 0;
       KeySym tmp_keysym;
 
       if (XkbTranslateKeyCode (xkb, hardware_keycode, modifier_state,
                                &unconsumed_modifiers,
                                &tmp_keysym))
-        {
-          retval = tmp_keysym;
-        }
+        entry->keysym = tmp_keysym;
       else
-        retval = 0;
+        entry->keysym = 0;
+
+      entry->unconsumed_modifiers = unconsumed_modifiers;
     }
   else
 #endif /* HAVE_XKB */
-    retval = translate_keysym (keymap, hardware_keycode);
+    {
+      entry->keysym = translate_keysym (keymap, hardware_keycode);
+      entry->unconsumed_modifiers = 0;
+    }
+
+  entry->unicode = clutter_keysym_to_unicode (entry->keysym);
+  entry->key = key;
+
+  return entry;
+}
+
+gint
+_clutter_keymap_x11_translate_key_state (ClutterKeymapX11    *keymap,
+                                         guint                hardware_keycode,
+                                         ClutterModifierType *modifier_state_p,
+                                         ClutterModifierType *mods_p,
+                                         gunichar            *unicode_p)
+{
+  ClutterModifierType modifier_state = *modifier_state_p;
+  KeyCacheEntry *entry;
+
+  g_return_val_if_fail (CLUTTER_IS_KEYMAP_X11 (keymap), 0);
+
+  entry = lookup_key_cache (keymap, hardware_keycode, modifier_state);
 
   if (mods_p)
-    *mods_p = unconsumed_modifiers;
+    *mods_p = entry->unconsumed_modifiers;
+
+  if (unicode_p)
+    *unicode_p = entry->unicode;
 
   *modifier_state_p = modifier_state & ~(keymap->num_lock_mask |
                                          keymap->scroll_lock_mask |
                                          LockMask);
 
-  return retval;
+  return entry->keysym;
 }
 
 gboolean
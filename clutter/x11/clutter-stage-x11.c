@@ -409,6 +409,11 @@ clutter_stage_x11_unrealize (ClutterStageWindow *stage_window)
                            GINT_TO_POINTER (stage_x11->xwin));
     }
 
+  if (stage_x11->xwin != None)
+    _clutter_backend_remove_window_event_translator (CLUTTER_STAGE_COGL (stage_x11)->backend,
+                                                     stage_x11->xwin,
+                                                     CLUTTER_EVENT_TRANSLATOR (stage_x11));
+
   clutter_stage_window_parent_iface->unrealize (stage_window);
 }
 
@@ -619,6 +624,11 @@ clutter_stage_x11_realize (ClutterStageWindow *stage_window)
                        GINT_TO_POINTER (stage_x11->xwin),
                        stage_x11);
 
+  /* the backend will dispatch the events of the window to us */
+  _clutter_backend_add_window_event_translator (backend,
+                                                stage_x11->xwin,
+                                                CLUTTER_EVENT_TRANSLATOR (stage_x11));
+
   set_wm_pid (stage_x11);
   set_wm_title (stage_x11);
   set_cursor_visible (stage_x11);
@@ -853,8 +863,12 @@ clutter_stage_x11_dispose (GObject *gobject)
 {
   ClutterEventTranslator *translator = CLUTTER_EVENT_TRANSLATOR (gobject);
   ClutterBackend *backend = CLUTTER_STAGE_COGL (gobject)->backend;
+  ClutterStageX11 *stage_x11 = CLUTTER_STAGE_X11 (gobject);
 
-  _clutter_backend_remove_event_translator (backend, translator);
+  if (stage_x11->xwin != None)
+    _clutter_backend_remove_window_event_translator (backend,
+                                                     stage_x11->xwin,
+                                                     translator);
 
   G_OBJECT_CLASS (clutter_stage_x11_parent_class)->dispose (gobject);
 }
@@ -1332,6 +1346,11 @@ set_foreign_window_callback (ClutterActor *actor,
       XDestroyWindow (backend_x11->xdpy, fwd->stage_x11->xwin);
     }
 
+  if (fwd->stage_x11->xwin != None)
+    _clutter_backend_remove_window_event_translator (stage_cogl->backend,
+                                                     fwd->stage_x11->xwin,
+                                                     CLUTTER_EVENT_TRANSLATOR (fwd->stage_x11));
+
   fwd->stage_x11->xwin = fwd->xwindow;
   fwd->stage_x11->is_foreign_xwin = TRUE;
 
@@ -1347,6 +1366,10 @@ set_foreign_window_callback (ClutterActor *actor,
                        GINT_TO_POINTER (fwd->stage_x11->xwin),
                        fwd->stage_x11);
 
+  _clutter_backend_add_window_event_translator (stage_cogl->backend,
+                                                fwd->stage_x11->xwin,
+                                                CLUTTER_EVENT_TRANSLATOR (fwd->stage_x11));
+
   /* calling this with the stage unrealized will unset the stage
    * from the GL context; once the stage is realized the GL context
    * will be set again
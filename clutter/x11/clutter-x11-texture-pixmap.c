@@ -89,9 +89,6 @@ enum
   LAST_SIGNAL
 };
 
-static ClutterX11FilterReturn
-on_x_event_filter (XEvent *xev, ClutterEvent *cev, gpointer data);
-
 static void
 clutter_x11_texture_pixmap_update_area_real (ClutterX11TexturePixmap *texture,
                                              gint                     x,
@@ -121,6 +118,9 @@ struct _ClutterX11TexturePixmapPrivate
 
   Damage        damage;
 
+  /* the damage accumulated since the last frame */
+  cairo_region_t *damage_region;
+
   gint          window_x, window_y;
   gint          window_width, window_height;
 
@@ -136,6 +136,20 @@ struct _ClutterX11TexturePixmapPrivate
 
 static int _damage_event_base = 0;
 
+/* the textures with a Damage object, by Damage XID */
+static GHashTable *textures_by_damage = NULL;
+
+/* the lists of textures showing a window, by Window XID */
+static GHashTable *textures_by_window = NULL;
+
+static gboolean event_filter_installed = FALSE;
+
+/* the textures with accumulated damage, and the repaint function
+ * that queues their redraws at the beginning of the next frame
+ */
+static GSList *damaged_textures = NULL;
+static guint damage_repaint_id = 0;
+
 G_DEFINE_TYPE (ClutterX11TexturePixmap,
                clutter_x11_texture_pixmap,
                CLUTTER_TYPE_TEXTURE);
@@ -160,61 +174,95 @@ check_extensions (ClutterX11TexturePixmap *texture)
   return TRUE;
 }
 
-static void
-process_damage_event (ClutterX11TexturePixmap *texture,
-                      XDamageNotifyEvent *damage_event)
+static gboolean
+flush_damage (gpointer data G_GNUC_UNUSED)
 {
-  /* Cogl will deal with updating the texture and subtracting from the
-     damage region so we only need to queue a redraw */
-  g_signal_emit (texture, signals[QUEUE_DAMAGE_REDRAW],
-                 0,
-                 damage_event->area.x,
-                 damage_event->area.y,
-                 damage_event->area.width,
-                 damage_event->area.height);
-}
+  GSList *textures, *l;
 
-static ClutterX11FilterReturn
-on_x_event_filter (XEvent *xev, ClutterEvent *cev, gpointer data)
-{
-  ClutterX11TexturePixmap        *texture;
-  ClutterX11TexturePixmapPrivate *priv;
+  textures = damaged_textures;
+  damaged_textures = NULL;
+  damage_repaint_id = 0;
 
-  texture = CLUTTER_X11_TEXTURE_PIXMAP (data);
+  for (l = textures; l != NULL; l = l->next)
+    {
+      ClutterX11TexturePixmap *texture = l->data;
+      ClutterX11TexturePixmapPrivate *priv = texture->priv;
+      cairo_rectangle_int_t extents;
+
+      if (priv->damage_region == NULL)
+        continue;
+
+      cairo_region_get_extents (priv->damage_region, &extents);
+      cairo_region_destroy (priv->damage_region);
+      priv->damage_region = NULL;
+
+      g_object_ref (texture);
+      g_signal_emit (texture, signals[QUEUE_DAMAGE_REDRAW],
+                     0,
+                     extents.x,
+                     extents.y,
+                     extents.width,
+                     extents.height);
+      g_object_unref (texture);
+    }
 
-  g_return_val_if_fail (CLUTTER_X11_IS_TEXTURE_PIXMAP (texture), \
-                        CLUTTER_X11_FILTER_CONTINUE);
+  g_slist_free (textures);
 
-  priv = texture->priv;
+  return FALSE;
+}
 
-  if (xev->type == _damage_event_base + XDamageNotify)
-    {
-      XDamageNotifyEvent *dev = (XDamageNotifyEvent*)xev;
+static void
+discard_damage (ClutterX11TexturePixmap *texture)
+{
+  ClutterX11TexturePixmapPrivate *priv = texture->priv;
 
-      if (dev->damage != priv->damage)
-        return CLUTTER_X11_FILTER_CONTINUE;
+  if (priv->damage_region == NULL)
+    return;
 
-      process_damage_event (texture, dev);
-    }
+  cairo_region_destroy (priv->damage_region);
+  priv->damage_region = NULL;
 
-  return  CLUTTER_X11_FILTER_CONTINUE;
+  damaged_textures = g_slist_remove (damaged_textures, texture);
 }
 
-static ClutterX11FilterReturn
-on_x_event_filter_too (XEvent *xev, ClutterEvent *cev, gpointer data)
+static void
+process_damage_event (ClutterX11TexturePixmap *texture,
+                      XDamageNotifyEvent *damage_event)
 {
-  ClutterX11TexturePixmap        *texture;
-  ClutterX11TexturePixmapPrivate *priv;
-
-  texture = CLUTTER_X11_TEXTURE_PIXMAP (data);
+  ClutterX11TexturePixmapPrivate *priv = texture->priv;
+  cairo_rectangle_int_t area;
 
-  g_return_val_if_fail (CLUTTER_X11_IS_TEXTURE_PIXMAP (texture), \
-                        CLUTTER_X11_FILTER_CONTINUE);
+  /* Cogl will deal with updating the texture and subtracting from the
+   * damage region when the texture is painted, so we only need to
+   * queue a redraw; clients can send hundreds of damage events in a
+   * frame, so we accumulate them and queue a single redraw per
+   * texture before the stages are updated
+   */
+  if (priv->damage_region == NULL)
+    {
+      priv->damage_region = cairo_region_create ();
+      damaged_textures = g_slist_prepend (damaged_textures, texture);
+
+      if (damage_repaint_id == 0)
+        damage_repaint_id =
+          clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_PRE_PAINT |
+                                                 CLUTTER_REPAINT_FLAGS_QUEUE_REDRAW_ON_ADD,
+                                                 flush_damage,
+                                                 NULL, NULL);
+    }
 
-  priv = texture->priv;
+  area.x = damage_event->area.x;
+  area.y = damage_event->area.y;
+  area.width = damage_event->area.width;
+  area.height = damage_event->area.height;
+  cairo_region_union_rectangle (priv->damage_region, &area);
+}
 
-  if (xev->xany.window != priv->window)
-    return CLUTTER_X11_FILTER_CONTINUE;
+static void
+handle_window_event (ClutterX11TexturePixmap *texture,
+                     XEvent                  *xev)
+{
+  ClutterX11TexturePixmapPrivate *priv = texture->priv;
 
   switch (xev->type) {
   case MapNotify:
@@ -242,10 +290,152 @@ on_x_event_filter_too (XEvent *xev, ClutterEvent *cev, gpointer data)
   default:
     break;
   }
+}
+
+/* a single event filter is shared by all the texture pixmaps, and
+ * dispatches the events through the Damage and Window XIDs, instead
+ * of running every X event through one filter per texture
+ */
+static ClutterX11FilterReturn
+on_x_event_filter (XEvent *xev, ClutterEvent *cev, gpointer data)
+{
+  if (xev->type == _damage_event_base + XDamageNotify)
+    {
+      XDamageNotifyEvent *dev = (XDamageNotifyEvent*)xev;
+      ClutterX11TexturePixmap *texture;
+
+      if (textures_by_damage == NULL)
+        return CLUTTER_X11_FILTER_CONTINUE;
+
+      texture = g_hash_table_lookup (textures_by_damage,
+                                     GUINT_TO_POINTER (dev->damage));
+      if (texture != NULL)
+        process_damage_event (texture, dev);
+    }
+  else if (textures_by_window != NULL)
+    {
+      GSList *textures, *l;
+
+      switch (xev->type)
+        {
+        case MapNotify:
+        case ConfigureNotify:
+        case UnmapNotify:
+        case DestroyNotify:
+          break;
+
+        default:
+          return CLUTTER_X11_FILTER_CONTINUE;
+        }
+
+      textures = g_hash_table_lookup (textures_by_window,
+                                      GUINT_TO_POINTER (xev->xany.window));
+      if (textures == NULL)
+        return CLUTTER_X11_FILTER_CONTINUE;
+
+      /* the handlers can change the window of the textures */
+      textures = g_slist_copy (textures);
+      g_slist_foreach (textures, (GFunc) g_object_ref, NULL);
+
+      for (l = textures; l != NULL; l = l->next)
+        {
+          ClutterX11TexturePixmap *texture = l->data;
+
+          if (texture->priv->window == xev->xany.window)
+            handle_window_event (texture, xev);
+        }
+
+      g_slist_free_full (textures, g_object_unref);
+    }
 
   return CLUTTER_X11_FILTER_CONTINUE;
 }
 
+static void
+update_event_filter (void)
+{
+  gboolean needs_filter;
+
+  needs_filter =
+    (textures_by_damage != NULL && g_hash_table_size (textures_by_damage) > 0) ||
+    (textures_by_window != NULL && g_hash_table_size (textures_by_window) > 0);
+
+  if (needs_filter == event_filter_installed)
+    return;
+
+  if (needs_filter)
+    clutter_x11_add_filter (on_x_event_filter, NULL);
+  else
+    clutter_x11_remove_filter (on_x_event_filter, NULL);
+
+  event_filter_installed = needs_filter;
+}
+
+static void
+register_damage (ClutterX11TexturePixmap *texture)
+{
+  if (textures_by_damage == NULL)
+    textures_by_damage = g_hash_table_new (NULL, NULL);
+
+  g_hash_table_insert (textures_by_damage,
+                       GUINT_TO_POINTER (texture->priv->damage),
+                       texture);
+
+  update_event_filter ();
+}
+
+static void
+unregister_damage (ClutterX11TexturePixmap *texture)
+{
+  if (textures_by_damage == NULL)
+    return;
+
+  g_hash_table_remove (textures_by_damage,
+                       GUINT_TO_POINTER (texture->priv->damage));
+
+  update_event_filter ();
+}
+
+/* more than one texture can show the same window */
+static void
+register_window (ClutterX11TexturePixmap *texture)
+{
+  gpointer key = GUINT_TO_POINTER (texture->priv->window);
+  GSList *textures;
+
+  if (textures_by_window == NULL)
+    textures_by_window = g_hash_table_new (NULL, NULL);
+
+  textures = g_hash_table_lookup (textures_by_window, key);
+  if (g_slist_find (textures, texture) == NULL)
+    {
+      textures = g_slist_prepend (textures, texture);
+      g_hash_table_insert (textures_by_window, key, textures);
+    }
+
+  update_event_filter ();
+}
+
+static void
+unregister_window (ClutterX11TexturePixmap *texture)
+{
+  gpointer key = GUINT_TO_POINTER (texture->priv->window);
+  GSList *textures;
+
+  if (textures_by_window == NULL)
+    return;
+
+  textures = g_hash_table_lookup (textures_by_window, key);
+  textures = g_slist_remove (textures, texture);
+
+  if (textures != NULL)
+    g_hash_table_insert (textures_by_window, key, textures);
+  else
+    g_hash_table_remove (textures_by_window, key);
+
+  update_event_filter ();
+}
+
 static void
 update_pixmap_damage_object (ClutterX11TexturePixmap *texture)
 {
@@ -299,7 +489,7 @@ create_damage_resources (ClutterX11TexturePixmap *texture)
 
   if (priv->damage)
     {
-      clutter_x11_add_filter (on_x_event_filter, (gpointer)texture);
+      register_damage (texture);
 
       update_pixmap_damage_object (texture);
     }
@@ -316,14 +506,15 @@ free_damage_resources (ClutterX11TexturePixmap *texture)
 
   if (priv->damage)
     {
+      unregister_damage (texture);
+      discard_damage (texture);
+
       clutter_x11_trap_x_errors ();
       XDamageDestroy (dpy, priv->damage);
       XSync (dpy, FALSE);
       clutter_x11_untrap_x_errors ();
       priv->damage = None;
 
-      clutter_x11_remove_filter (on_x_event_filter, (gpointer)texture);
-
       update_pixmap_damage_object (texture);
     }
 }
@@ -417,7 +608,9 @@ clutter_x11_texture_pixmap_dispose (GObject *object)
 
   free_damage_resources (texture);
 
-  clutter_x11_remove_filter (on_x_event_filter_too, (gpointer)texture);
+  if (texture->priv->window != None)
+    unregister_window (texture);
+
   clutter_x11_texture_pixmap_set_pixmap (texture, None);
 
   G_OBJECT_CLASS (clutter_x11_texture_pixmap_parent_class)->dispose (object);
@@ -907,6 +1100,18 @@ clutter_x11_texture_pixmap_set_pixmap (ClutterX11TexturePixmap *texture,
         cogl_texture_pixmap_x11_new (ctx, pixmap, FALSE, &error);
       if (texture_pixmap)
         {
+          /* without texture_from_pixmap, CoglTexturePixmapX11 copies
+           * the bounding box of the damage of the pixmap into the
+           * texture when it is painted, using a shared memory XImage
+           * and XShmGetImage when MIT-SHM is available, or XGetImage
+           * otherwise
+           */
+          CLUTTER_NOTE (TEXTURE, "Pixmap 0x%x: %s",
+                        (guint32) pixmap,
+                        cogl_texture_pixmap_x11_is_using_tfp_texture (texture_pixmap)
+                          ? "using texture_from_pixmap"
+                          : "copying the damaged area");
+
           clutter_texture_set_cogl_texture (CLUTTER_TEXTURE (texture),
                                             COGL_TEXTURE (texture_pixmap));
           cogl_object_unref (texture_pixmap);
@@ -971,7 +1176,7 @@ clutter_x11_texture_pixmap_set_window (ClutterX11TexturePixmap *texture,
 
   if (priv->window)
     {
-      clutter_x11_remove_filter (on_x_event_filter_too, (gpointer)texture);
+      unregister_window (texture);
       clutter_x11_trap_x_errors ();
       XCompositeUnredirectWindow(clutter_x11_get_default_display (),
                                   priv->window,
@@ -1014,7 +1219,7 @@ clutter_x11_texture_pixmap_set_window (ClutterX11TexturePixmap *texture,
 
   XSelectInput (dpy, priv->window,
                 attr.your_event_mask | StructureNotifyMask);
-  clutter_x11_add_filter (on_x_event_filter_too, (gpointer)texture);
+  register_window (texture);
 
   g_object_ref (texture);
   g_object_notify (G_OBJECT (texture), "window");
@@ -0,0 +1,106 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define STAGE_WIDTH  640
+#define STAGE_HEIGHT 480
+#define ACTORS_X 8
+#define ACTORS_Y 6
+
+typedef struct {
+  ClutterActor *stage;
+  ClutterActor *over_actor;
+  gboolean pass;
+} State;
+
+static gboolean
+on_idle (gpointer data)
+{
+  State *state = data;
+  ClutterStage *stage = CLUTTER_STAGE (state->stage);
+  float actor_width = STAGE_WIDTH / ACTORS_X;
+  float actor_height = STAGE_HEIGHT / ACTORS_Y;
+  int x, y;
+
+  for (y = 0; y < ACTORS_Y; y++)
+    {
+      for (x = 0; x < ACTORS_X; x++)
+        {
+          gint pick_x = x * actor_width + actor_width / 2;
+          gint pick_y = y * actor_height + actor_height / 2;
+          ClutterActor *gpu_actor, *cpu_actor;
+
+          clutter_stage_set_geometry_pick_enabled (stage, FALSE);
+          gpu_actor = clutter_stage_get_actor_at_pos (stage,
+                                                      CLUTTER_PICK_REACTIVE,
+                                                      pick_x, pick_y);
+
+          clutter_stage_set_geometry_pick_enabled (stage, TRUE);
+          cpu_actor = clutter_stage_get_actor_at_pos (stage,
+                                                      CLUTTER_PICK_REACTIVE,
+                                                      pick_x, pick_y);
+
+          if (g_test_verbose ())
+            g_print ("% 3i,% 3i -> gpu: %p, cpu: %p: %s\n",
+                     x, y, gpu_actor, cpu_actor,
+                     gpu_actor == cpu_actor ? "pass" : "FAIL");
+
+          if (gpu_actor != cpu_actor)
+            state->pass = FALSE;
+        }
+    }
+
+  clutter_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+void
+actor_geometry_pick (TestConformSimpleFixture *fixture,
+                     gconstpointer             data)
+{
+  State state;
+  int x, y;
+
+  state.pass = TRUE;
+  state.stage = clutter_stage_new ();
+  clutter_actor_set_size (state.stage, STAGE_WIDTH, STAGE_HEIGHT);
+
+  for (y = 0; y < ACTORS_Y; y++)
+    for (x = 0; x < ACTORS_X; x++)
+      {
+        ClutterActor *actor = clutter_actor_new ();
+
+        clutter_actor_set_position (actor,
+                                    x * STAGE_WIDTH / ACTORS_X,
+                                    y * STAGE_HEIGHT / ACTORS_Y);
+        clutter_actor_set_size (actor,
+                                STAGE_WIDTH / ACTORS_X,
+                                STAGE_HEIGHT / ACTORS_Y);
+        clutter_actor_set_reactive (actor, (x + y) % 3 != 0);
+        clutter_actor_add_child (state.stage, actor);
+      }
+
+  /* a rotated, clipped actor covering part of the grid */
+  state.over_actor = clutter_actor_new ();
+  clutter_actor_set_reactive (state.over_actor, TRUE);
+  clutter_actor_set_position (state.over_actor, 120, 80);
+  clutter_actor_set_size (state.over_actor, 320, 240);
+  clutter_actor_set_pivot_point (state.over_actor, 0.5, 0.5);
+  clutter_actor_set_rotation_angle (state.over_actor, CLUTTER_Z_AXIS, 30);
+  clutter_actor_set_clip (state.over_actor, 40, 40, 200, 120);
+  clutter_actor_add_child (state.stage, state.over_actor);
+
+  clutter_actor_show (state.stage);
+
+  clutter_threads_add_idle (on_idle, &state);
+
+  clutter_main ();
+
+  if (g_test_verbose ())
+    g_print ("end result: %s\n", state.pass ? "pass" : "FAIL");
+
+  g_assert (state.pass);
+
+  clutter_actor_destroy (state.stage);
+}
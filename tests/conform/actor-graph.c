@@ -387,6 +387,53 @@ actor_remove_all (TestConformSimpleFixture *fixture,
   g_object_unref (actor);
 }
 
+void
+actor_add_children (TestConformSimpleFixture *fixture,
+                    gconstpointer dummy)
+{
+  ClutterActor *actor = clutter_actor_new ();
+  ClutterActor *children[3];
+  ClutterActor *iter;
+
+  g_object_ref_sink (actor);
+
+  children[0] = g_object_new (CLUTTER_TYPE_ACTOR, "name", "foo", NULL);
+  children[1] = g_object_new (CLUTTER_TYPE_ACTOR, "name", "bar", NULL);
+  children[2] = g_object_new (CLUTTER_TYPE_ACTOR, "name", "baz", NULL);
+
+  clutter_actor_add_children (actor, children, 3);
+
+  g_assert_cmpint (clutter_actor_get_n_children (actor), ==, 3);
+
+  iter = clutter_actor_get_first_child (actor);
+  g_assert_cmpstr (clutter_actor_get_name (iter), ==, "foo");
+
+  iter = clutter_actor_get_next_sibling (iter);
+  g_assert_cmpstr (clutter_actor_get_name (iter), ==, "bar");
+
+  iter = clutter_actor_get_next_sibling (iter);
+  g_assert_cmpstr (clutter_actor_get_name (iter), ==, "baz");
+  g_assert (iter == clutter_actor_get_last_child (actor));
+
+  /* keep "baz" and put it first */
+  children[0] = children[2];
+  children[1] = g_object_new (CLUTTER_TYPE_ACTOR, "name", "qux", NULL);
+
+  clutter_actor_replace_children (actor, children, 2);
+
+  g_assert_cmpint (clutter_actor_get_n_children (actor), ==, 2);
+
+  iter = clutter_actor_get_first_child (actor);
+  g_assert_cmpstr (clutter_actor_get_name (iter), ==, "baz");
+
+  iter = clutter_actor_get_next_sibling (iter);
+  g_assert_cmpstr (clutter_actor_get_name (iter), ==, "qux");
+  g_assert (iter == clutter_actor_get_last_child (actor));
+
+  clutter_actor_destroy (actor);
+  g_object_unref (actor);
+}
+
 static void
 actor_added (ClutterContainer *container,
              ClutterActor     *child,
@@ -0,0 +1,104 @@
+#include <glib.h>
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define TEST_DURATION   1000
+
+static const struct {
+  guint msecs;
+  guint opacity;
+} seeks[] = {
+  /* out of order, to check that the segment is not simply the next one */
+  { 875, 120 },
+  { 125,  50 },
+  { 500, 150 },
+  { 250, 100 },
+  { 750, 200 },
+  {   0,   0 },
+  { 1000, 40 },
+};
+
+/* the timeline is not driven by the master clock, so we emit the
+ * signals it would emit ourselves after moving it
+ */
+static guint
+seek_transition (ClutterTransition *transition,
+                 ClutterActor      *actor,
+                 guint              msecs)
+{
+  clutter_timeline_advance (CLUTTER_TIMELINE (transition), msecs);
+  g_signal_emit_by_name (transition, "new-frame", msecs);
+
+  return clutter_actor_get_opacity (actor);
+}
+
+void
+keyframe_transition_unsorted (TestConformSimpleFixture *fixture G_GNUC_UNUSED,
+                              gconstpointer             dummy G_GNUC_UNUSED)
+{
+  ClutterTransition *transition;
+  ClutterActor *actor;
+  guint i;
+
+  actor = clutter_actor_new ();
+  g_object_ref_sink (actor);
+
+  transition = clutter_keyframe_transition_new ("opacity");
+  clutter_transition_set_notify_mode (transition,
+                                      CLUTTER_TRANSITION_NOTIFY_EACH_FRAME);
+  clutter_timeline_set_duration (CLUTTER_TIMELINE (transition), TEST_DURATION);
+  clutter_transition_set_from (transition, G_TYPE_UINT, 0);
+  clutter_transition_set_to (transition, G_TYPE_UINT, 40);
+
+  /* the key frames are set out of order, and must be sorted by key
+   * when the transition starts, giving the segments
+   *
+   *   [0.0, 0.25]: 0 -> 100
+   *   [0.25, 0.75]: 100 -> 200
+   *   [0.75, 1.0]: 200 -> 40
+   */
+  clutter_keyframe_transition_set (CLUTTER_KEYFRAME_TRANSITION (transition),
+                                   G_TYPE_UINT, 2,
+                                   0.75, 200, CLUTTER_LINEAR,
+                                   0.25, 100, CLUTTER_LINEAR);
+
+  clutter_transition_set_animatable (transition, CLUTTER_ANIMATABLE (actor));
+  g_signal_emit_by_name (transition, "started");
+
+  for (i = 0; i < G_N_ELEMENTS (seeks); i++)
+    {
+      guint opacity = seek_transition (transition, actor, seeks[i].msecs);
+
+      if (g_test_verbose ())
+        g_print ("forward: %u msecs, opacity %u (expected %u)\n",
+                 seeks[i].msecs,
+                 opacity,
+                 seeks[i].opacity);
+
+      g_assert_cmpuint (opacity, ==, seeks[i].opacity);
+    }
+
+  /* the direction only changes where the search for the segment starts */
+  clutter_timeline_set_direction (CLUTTER_TIMELINE (transition),
+                                  CLUTTER_TIMELINE_BACKWARD);
+
+  for (i = 0; i < G_N_ELEMENTS (seeks); i++)
+    {
+      guint opacity = seek_transition (transition, actor, seeks[i].msecs);
+
+      if (g_test_verbose ())
+        g_print ("backward: %u msecs, opacity %u (expected %u)\n",
+                 seeks[i].msecs,
+                 opacity,
+                 seeks[i].opacity);
+
+      g_assert_cmpuint (opacity, ==, seeks[i].opacity);
+    }
+
+  clutter_transition_set_animatable (transition, NULL);
+  g_object_unref (transition);
+
+  clutter_actor_destroy (actor);
+  g_object_unref (actor);
+}
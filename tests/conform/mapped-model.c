@@ -0,0 +1,341 @@
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+enum
+{
+  COLUMN_NAME,   /* G_TYPE_STRING */
+  COLUMN_SIZE,   /* G_TYPE_INT */
+  COLUMN_WEIGHT, /* G_TYPE_FLOAT */
+
+  N_COLUMNS
+};
+
+static const struct {
+  const gchar *name;
+  gint size;
+  gfloat weight;
+} fixture_rows[] = {
+  { "Delta",   4, 0.25f },
+  { "Alpha",  -1, 1.5f  },
+  { NULL,      7, 0.0f  },
+  { "Charlie", 2, 3.0f  },
+  { "Bravo",   9, 2.25f },
+};
+
+static const gchar *column_names[N_COLUMNS] = { "name", "size", "weight" };
+
+#define N_ROWS          G_N_ELEMENTS (fixture_rows)
+#define HEADER_SIZE     (4 + 5 * sizeof (guint32))
+#define DESCRIPTOR_SIZE (3 * sizeof (guint32))
+#define CELLS_OFFSET    (HEADER_SIZE + N_COLUMNS * DESCRIPTOR_SIZE)
+#define STRINGS_OFFSET  (CELLS_OFFSET + N_COLUMNS * N_ROWS * sizeof (guint32))
+#define NULL_OFFSET     0xffffffff
+
+static void
+append_uint32 (GByteArray *data,
+               guint32     value)
+{
+  guint32 le_value = GUINT32_TO_LE (value);
+
+  g_byte_array_append (data, (const guint8 *) &le_value, sizeof (guint32));
+}
+
+static guint32
+append_string (GString     *strings,
+               const gchar *str)
+{
+  guint32 offset = strings->len;
+
+  if (str == NULL)
+    return NULL_OFFSET;
+
+  /* keep the nul byte, as the table is a sequence of C strings */
+  g_string_append_len (strings, str, strlen (str) + 1);
+
+  return offset;
+}
+
+/* writes the fixture rows into a new file, using the format described
+ * in the documentation of ClutterMappedModel; the returned path must be
+ * removed and freed by the caller
+ */
+static gchar *
+write_fixture (gboolean  corrupt_string,
+               gsize     truncate_to)
+{
+  GByteArray *data = g_byte_array_new ();
+  GString *strings = g_string_new (NULL);
+  guint32 names[N_COLUMNS];
+  guint32 cells[N_ROWS];
+  guint32 strings_size;
+  GError *error = NULL;
+  gchar *filename;
+  guint i;
+  gint fd;
+
+  for (i = 0; i < N_COLUMNS; i++)
+    names[i] = append_string (strings, column_names[i]);
+
+  g_byte_array_append (data, (const guint8 *) "CMDL", 4);
+  append_uint32 (data, 1);
+  append_uint32 (data, N_COLUMNS);
+  append_uint32 (data, N_ROWS);
+  append_uint32 (data, STRINGS_OFFSET);
+  append_uint32 (data, 0); /* patched once the strings are known */
+
+  append_uint32 (data, 2);
+  append_uint32 (data, names[COLUMN_NAME]);
+  append_uint32 (data, CELLS_OFFSET);
+
+  append_uint32 (data, 0);
+  append_uint32 (data, names[COLUMN_SIZE]);
+  append_uint32 (data, CELLS_OFFSET + N_ROWS * sizeof (guint32));
+
+  append_uint32 (data, 1);
+  append_uint32 (data, names[COLUMN_WEIGHT]);
+  append_uint32 (data, CELLS_OFFSET + 2 * N_ROWS * sizeof (guint32));
+
+  for (i = 0; i < N_ROWS; i++)
+    cells[i] = append_string (strings, fixture_rows[i].name);
+
+  /* an offset past the end of the string table */
+  if (corrupt_string)
+    cells[N_ROWS - 1] = strings->len;
+
+  for (i = 0; i < N_ROWS; i++)
+    append_uint32 (data, cells[i]);
+
+  for (i = 0; i < N_ROWS; i++)
+    append_uint32 (data, (guint32) fixture_rows[i].size);
+
+  for (i = 0; i < N_ROWS; i++)
+    {
+      guint32 bits;
+
+      memcpy (&bits, &fixture_rows[i].weight, sizeof (guint32));
+      append_uint32 (data, bits);
+    }
+
+  g_assert_cmpuint (data->len, ==, STRINGS_OFFSET);
+
+  g_byte_array_append (data, (const guint8 *) strings->str, strings->len);
+
+  /* the size of the string table is the last field of the header */
+  strings_size = GUINT32_TO_LE (strings->len);
+  memcpy (data->data + HEADER_SIZE - sizeof (guint32), &strings_size,
+          sizeof (guint32));
+
+  fd = g_file_open_tmp ("clutter-mapped-model-XXXXXX", &filename, &error);
+  g_assert_no_error (error);
+  close (fd);
+
+  g_file_set_contents (filename, (const gchar *) data->data,
+                       truncate_to != 0 ? MIN (truncate_to, data->len)
+                                        : data->len,
+                       &error);
+  g_assert_no_error (error);
+
+  g_string_free (strings, TRUE);
+  g_byte_array_free (data, TRUE);
+
+  return filename;
+}
+
+static gint
+sort_by_size (ClutterModel *model,
+              const GValue *a,
+              const GValue *b,
+              gpointer      dummy G_GNUC_UNUSED)
+{
+  return g_value_get_int (a) - g_value_get_int (b);
+}
+
+static gboolean
+filter_named (ClutterModel     *model,
+              ClutterModelIter *iter,
+              gpointer          dummy G_GNUC_UNUSED)
+{
+  return clutter_mapped_model_iter_get_string (iter, COLUMN_NAME) != NULL;
+}
+
+static void
+check_sizes (ClutterModel *model,
+             const gint   *expected,
+             guint         n_expected)
+{
+  guint i;
+
+  g_assert_cmpuint (clutter_model_get_n_rows (model), ==, n_expected);
+
+  for (i = 0; i < n_expected; i++)
+    {
+      ClutterModelIter *iter = clutter_model_get_iter_at_row (model, i);
+
+      if (g_test_verbose ())
+        g_print ("row %u: size %d (expected %d)\n",
+                 i,
+                 clutter_mapped_model_iter_get_int (iter, COLUMN_SIZE),
+                 expected[i]);
+
+      g_assert_cmpint (clutter_mapped_model_iter_get_int (iter, COLUMN_SIZE),
+                       ==,
+                       expected[i]);
+      g_object_unref (iter);
+    }
+}
+
+void
+mapped_model_load (TestConformSimpleFixture *fixture G_GNUC_UNUSED,
+                   gconstpointer             dummy G_GNUC_UNUSED)
+{
+  ClutterModel *model;
+  GError *error = NULL;
+  gchar *filename;
+  guint i;
+
+  filename = write_fixture (FALSE, 0);
+
+  model = clutter_mapped_model_new (filename, &error);
+  g_assert_no_error (error);
+  g_assert (CLUTTER_IS_MAPPED_MODEL (model));
+
+  g_assert_cmpuint (clutter_model_get_n_columns (model), ==, N_COLUMNS);
+  g_assert_cmpuint (clutter_model_get_n_rows (model), ==, N_ROWS);
+
+  g_assert (clutter_model_get_column_type (model, COLUMN_NAME) == G_TYPE_STRING);
+  g_assert (clutter_model_get_column_type (model, COLUMN_SIZE) == G_TYPE_INT);
+  g_assert (clutter_model_get_column_type (model, COLUMN_WEIGHT) == G_TYPE_FLOAT);
+
+  for (i = 0; i < N_COLUMNS; i++)
+    g_assert_cmpstr (clutter_model_get_column_name (model, i), ==, column_names[i]);
+
+  for (i = 0; i < N_ROWS; i++)
+    {
+      ClutterModelIter *iter = clutter_model_get_iter_at_row (model, i);
+      gchar *name = NULL;
+      gint size = 0;
+
+      g_assert_cmpstr (clutter_mapped_model_iter_get_string (iter, COLUMN_NAME),
+                       ==,
+                       fixture_rows[i].name);
+      g_assert_cmpint (clutter_mapped_model_iter_get_int (iter, COLUMN_SIZE),
+                       ==,
+                       fixture_rows[i].size);
+      g_assert_cmpfloat (clutter_mapped_model_iter_get_float (iter, COLUMN_WEIGHT),
+                         ==,
+                         fixture_rows[i].weight);
+
+      /* the generic accessors copy the same values */
+      clutter_model_iter_get (iter,
+                              COLUMN_NAME, &name,
+                              COLUMN_SIZE, &size,
+                              -1);
+      g_assert_cmpstr (name, ==, fixture_rows[i].name);
+      g_assert_cmpint (size, ==, fixture_rows[i].size);
+
+      g_free (name);
+      g_object_unref (iter);
+    }
+
+  g_object_unref (model);
+
+  g_unlink (filename);
+  g_free (filename);
+}
+
+void
+mapped_model_sort_filter (TestConformSimpleFixture *fixture G_GNUC_UNUSED,
+                          gconstpointer             dummy G_GNUC_UNUSED)
+{
+  static const gint file_order[] = { 4, -1, 7, 2, 9 };
+  static const gint sorted[] = { -1, 2, 4, 7, 9 };
+  static const gint sorted_named[] = { -1, 2, 4, 9 };
+  static const gint named[] = { 4, -1, 2, 9 };
+  ClutterModel *model;
+  GError *error = NULL;
+  gchar *filename;
+
+  filename = write_fixture (FALSE, 0);
+
+  model = clutter_mapped_model_new (filename, &error);
+  g_assert_no_error (error);
+
+  if (g_test_verbose ())
+    g_print ("sorting by size\n");
+
+  clutter_model_set_sort (model, COLUMN_SIZE, sort_by_size, NULL, NULL);
+  check_sizes (model, sorted, G_N_ELEMENTS (sorted));
+
+  if (g_test_verbose ())
+    g_print ("filtering the rows without a name\n");
+
+  clutter_model_set_filter (model, filter_named, NULL, NULL);
+  check_sizes (model, sorted_named, G_N_ELEMENTS (sorted_named));
+
+  if (g_test_verbose ())
+    g_print ("removing the sorting\n");
+
+  clutter_model_set_sort (model, -1, NULL, NULL, NULL);
+  check_sizes (model, named, G_N_ELEMENTS (named));
+
+  if (g_test_verbose ())
+    g_print ("removing the filter\n");
+
+  clutter_model_set_filter (model, NULL, NULL, NULL);
+  check_sizes (model, file_order, G_N_ELEMENTS (file_order));
+
+  g_object_unref (model);
+
+  g_unlink (filename);
+  g_free (filename);
+}
+
+void
+mapped_model_invalid (TestConformSimpleFixture *fixture G_GNUC_UNUSED,
+                      gconstpointer             dummy G_GNUC_UNUSED)
+{
+  ClutterModel *model;
+  GError *error = NULL;
+  gchar *filename;
+
+  if (g_test_verbose ())
+    g_print ("truncated header\n");
+
+  filename = write_fixture (FALSE, HEADER_SIZE - 1);
+  model = clutter_mapped_model_new (filename, &error);
+  g_assert (model == NULL);
+  g_assert_error (error, CLUTTER_MAPPED_MODEL_ERROR,
+                  CLUTTER_MAPPED_MODEL_ERROR_INVALID_DATA);
+  g_clear_error (&error);
+  g_unlink (filename);
+  g_free (filename);
+
+  if (g_test_verbose ())
+    g_print ("truncated string table\n");
+
+  filename = write_fixture (FALSE, STRINGS_OFFSET + 4);
+  model = clutter_mapped_model_new (filename, &error);
+  g_assert (model == NULL);
+  g_assert_error (error, CLUTTER_MAPPED_MODEL_ERROR,
+                  CLUTTER_MAPPED_MODEL_ERROR_INVALID_DATA);
+  g_clear_error (&error);
+  g_unlink (filename);
+  g_free (filename);
+
+  if (g_test_verbose ())
+    g_print ("string offset out of the table\n");
+
+  filename = write_fixture (TRUE, 0);
+  model = clutter_mapped_model_new (filename, &error);
+  g_assert (model == NULL);
+  g_assert_error (error, CLUTTER_MAPPED_MODEL_ERROR,
+                  CLUTTER_MAPPED_MODEL_ERROR_INVALID_DATA);
+  g_clear_error (&error);
+  g_unlink (filename);
+  g_free (filename);
+}
@@ -97,6 +97,19 @@ static const struct {
   { "String 2", 2 },
 };
 
+static ClutterModel *
+test_model_new (GType model_type)
+{
+  if (model_type == CLUTTER_TYPE_ARRAY_MODEL)
+    return clutter_array_model_new (N_COLUMNS,
+                                    G_TYPE_STRING, "Foo",
+                                    G_TYPE_INT,    "Bar");
+
+  return clutter_list_model_new (N_COLUMNS,
+                                 G_TYPE_STRING, "Foo",
+                                 G_TYPE_INT,    "Bar");
+}
+
 static inline void
 compare_iter (ClutterModelIter *iter,
               const gint        expected_row,
@@ -171,17 +184,14 @@ filter_odd_rows (ClutterModel     *model,
   return FALSE;
 }
 
-void
-list_model_filter (TestConformSimpleFixture *fixture,
-                   gconstpointer             data)
+static void
+model_filter (GType model_type)
 {
   ModelData test_data = { NULL, 0 };
   ClutterModelIter *iter;
   gint i;
 
-  test_data.model = clutter_list_model_new (N_COLUMNS,
-                                            G_TYPE_STRING, "Foo",
-                                            G_TYPE_INT,    "Bar");
+  test_data.model = test_model_new (model_type);
   test_data.n_row = 0;
 
   for (i = 1; i < 10; i++)
@@ -259,17 +269,14 @@ list_model_filter (TestConformSimpleFixture *fixture,
   g_object_unref (test_data.model);
 }
 
-void
-list_model_iterate (TestConformSimpleFixture *fixture,
-                    gconstpointer             data)
+static void
+model_iterate (GType model_type)
 {
   ModelData test_data = { NULL, 0 };
   ClutterModelIter *iter;
   gint i;
 
-  test_data.model = clutter_list_model_new (N_COLUMNS,
-                                            G_TYPE_STRING, "Foo",
-                                            G_TYPE_INT,    "Bar");
+  test_data.model = test_model_new (model_type);
   test_data.n_row = 0;
 
   g_signal_connect (test_data.model, "row-added",
@@ -334,16 +341,13 @@ list_model_iterate (TestConformSimpleFixture *fixture,
   g_object_unref (test_data.model);
 }
 
-void
-list_model_populate (TestConformSimpleFixture *fixture,
-                     gconstpointer             data)
+static void
+model_populate (GType model_type)
 {
   ModelData test_data = { NULL, 0 };
   gint i;
 
-  test_data.model = clutter_list_model_new (N_COLUMNS,
-                                            G_TYPE_STRING, "Foo",
-                                            G_TYPE_INT,    "Bar");
+  test_data.model = test_model_new (model_type);
   test_data.n_row = 0;
 
   g_signal_connect (test_data.model, "row-added",
@@ -406,7 +410,7 @@ list_model_from_script (TestConformSimpleFixture *fixture,
     g_print ("column[2]: %s, type: %s\n", name, g_type_name (type));
 
   g_assert (strcmp (name, "actor-column") == 0);
-  g_assert (type == CLUTTER_TYPE_RECTANGLE);
+  g_assert (type == CLUTTER_TYPE_ACTOR);
 
   g_assert (clutter_model_get_n_rows (CLUTTER_MODEL (model)) == 3);
 
@@ -429,17 +433,20 @@ list_model_from_script (TestConformSimpleFixture *fixture,
   iter = clutter_model_iter_next (iter);
   clutter_model_iter_get_value (iter, 2, &value);
   g_assert (G_VALUE_HOLDS_OBJECT (&value));
-  g_assert (CLUTTER_IS_RECTANGLE (g_value_get_object (&value)));
+  g_assert (CLUTTER_IS_ACTOR (g_value_get_object (&value)));
   g_value_unset (&value);
 
   iter = clutter_model_iter_next (iter);
   clutter_model_iter_get_value (iter, 2, &value);
   g_assert (G_VALUE_HOLDS_OBJECT (&value));
-  g_assert (CLUTTER_IS_RECTANGLE (g_value_get_object (&value)));
+  g_assert (CLUTTER_IS_ACTOR (g_value_get_object (&value)));
   g_assert (strcmp (clutter_actor_get_name (g_value_get_object (&value)),
                     "actor-row-3") == 0);
   g_value_unset (&value);
   g_object_unref (iter);
+
+  g_object_unref (script);
+  g_free (test_file);
 }
 
 static void
@@ -460,17 +467,14 @@ on_row_changed (ClutterModel *model,
   data->n_emissions += 1;
 }
 
-void
-list_model_row_changed (TestConformSimpleFixture *fixture,
-                        gconstpointer             data)
+static void
+model_row_changed (GType model_type)
 {
   ChangedData test_data = { NULL, NULL, 0, 0 };
   GValue value = { 0, };
   gint i;
 
-  test_data.model = clutter_list_model_new (N_COLUMNS,
-                                            G_TYPE_STRING, "Foo",
-                                            G_TYPE_INT,    "Bar");
+  test_data.model = test_model_new (model_type);
   for (i = 1; i < 10; i++)
     {
       gchar *foo = g_strdup_printf ("String %d", i);
@@ -524,3 +528,427 @@ list_model_row_changed (TestConformSimpleFixture *fixture,
   g_object_unref (test_data.iter);
   g_object_unref (test_data.model);
 }
+
+static void
+fill_values (GValue *values,
+             guint   n_rows,
+             gint    first_bar,
+             gint    step)
+{
+  guint i;
+
+  for (i = 0; i < n_rows; i++)
+    {
+      gint bar = first_bar + (gint) i * step;
+      gchar *foo = g_strdup_printf ("String %d", bar);
+
+      g_value_init (&values[i * N_COLUMNS + COLUMN_FOO], G_TYPE_STRING);
+      g_value_take_string (&values[i * N_COLUMNS + COLUMN_FOO], foo);
+
+      g_value_init (&values[i * N_COLUMNS + COLUMN_BAR], G_TYPE_INT);
+      g_value_set_int (&values[i * N_COLUMNS + COLUMN_BAR], bar);
+    }
+}
+
+static void
+unset_values (GValue *values,
+              guint   n_values)
+{
+  guint i;
+
+  for (i = 0; i < n_values; i++)
+    g_value_unset (&values[i]);
+}
+
+typedef struct _RowsChangedData
+{
+  guint n_emissions;
+  guint n_single_emissions;
+
+  guint position;
+  guint n_removed;
+  guint n_added;
+} RowsChangedData;
+
+static void
+on_rows_changed (ClutterModel    *model,
+                 guint            position,
+                 guint            n_removed,
+                 guint            n_added,
+                 RowsChangedData *data)
+{
+  if (g_test_verbose ())
+    g_print ("rows-changed: position %u, removed %u, added %u\n",
+             position, n_removed, n_added);
+
+  data->n_emissions += 1;
+  data->position = position;
+  data->n_removed = n_removed;
+  data->n_added = n_added;
+}
+
+static void
+on_single_row_changed (ClutterModel     *model,
+                       ClutterModelIter *iter,
+                       RowsChangedData  *data)
+{
+  data->n_single_emissions += 1;
+}
+
+static gint
+sort_bar_ascending (ClutterModel *model,
+                    const GValue *a,
+                    const GValue *b,
+                    gpointer      dummy G_GNUC_UNUSED)
+{
+  return g_value_get_int (a) - g_value_get_int (b);
+}
+
+static void
+model_replace_all (GType model_type)
+{
+  RowsChangedData changed = { 0, };
+  guint columns[N_COLUMNS] = { COLUMN_FOO, COLUMN_BAR };
+  GValue values[4 * N_COLUMNS] = { G_VALUE_INIT, };
+  ClutterModel *model;
+  ClutterModelIter *iter;
+  gint i;
+
+  model = test_model_new (model_type);
+
+  for (i = 1; i < 10; i++)
+    {
+      gchar *foo = g_strdup_printf ("String %d", i);
+
+      clutter_model_append (model,
+                            COLUMN_FOO, foo,
+                            COLUMN_BAR, i,
+                            -1);
+
+      g_free (foo);
+    }
+
+  g_signal_connect (model, "rows-changed",
+                    G_CALLBACK (on_rows_changed),
+                    &changed);
+  g_signal_connect (model, "row-added",
+                    G_CALLBACK (on_single_row_changed),
+                    &changed);
+  g_signal_connect (model, "row-removed",
+                    G_CALLBACK (on_single_row_changed),
+                    &changed);
+
+  if (g_test_verbose ())
+    g_print ("Replacing 9 rows with 4 rows...\n");
+
+  /* 40, 30, 20, 10 */
+  fill_values (values, 4, 40, -10);
+  clutter_model_replace_all (model, 4, N_COLUMNS, columns, values);
+  unset_values (values, G_N_ELEMENTS (values));
+
+  g_assert_cmpint (changed.n_emissions, ==, 1);
+  g_assert_cmpint (changed.n_single_emissions, ==, 0);
+  g_assert_cmpint (changed.position, ==, 0);
+  g_assert_cmpint (changed.n_removed, ==, 9);
+  g_assert_cmpint (changed.n_added, ==, 4);
+  g_assert_cmpint (clutter_model_get_n_rows (model), ==, 4);
+
+  for (i = 0; i < 4; i++)
+    {
+      gchar *foo = g_strdup_printf ("String %d", 40 - i * 10);
+
+      iter = clutter_model_get_iter_at_row (model, i);
+      compare_iter (iter, i, foo, 40 - i * 10);
+      g_object_unref (iter);
+
+      g_free (foo);
+    }
+
+  if (g_test_verbose ())
+    g_print ("Replacing the rows of a sorted model...\n");
+
+  clutter_model_set_sort (model, COLUMN_BAR, sort_bar_ascending, NULL, NULL);
+
+  /* 5, 10, 15, 20, inserted backward */
+  memset (&changed, 0, sizeof (RowsChangedData));
+  fill_values (values, 4, 20, -5);
+  clutter_model_replace_all (model, 4, N_COLUMNS, columns, values);
+  unset_values (values, G_N_ELEMENTS (values));
+
+  g_assert_cmpint (changed.n_emissions, ==, 1);
+  g_assert_cmpint (changed.n_single_emissions, ==, 0);
+  g_assert_cmpint (changed.n_removed, ==, 4);
+  g_assert_cmpint (changed.n_added, ==, 4);
+
+  for (i = 0; i < 4; i++)
+    {
+      gchar *foo = g_strdup_printf ("String %d", 5 + i * 5);
+
+      iter = clutter_model_get_iter_at_row (model, i);
+      compare_iter (iter, i, foo, 5 + i * 5);
+      g_object_unref (iter);
+
+      g_free (foo);
+    }
+
+  if (g_test_verbose ())
+    g_print ("Replacing the rows with no rows...\n");
+
+  memset (&changed, 0, sizeof (RowsChangedData));
+  clutter_model_replace_all (model, 0, N_COLUMNS, columns, NULL);
+
+  g_assert_cmpint (changed.n_emissions, ==, 1);
+  g_assert_cmpint (changed.n_removed, ==, 4);
+  g_assert_cmpint (changed.n_added, ==, 0);
+  g_assert_cmpint (clutter_model_get_n_rows (model), ==, 0);
+
+  g_object_unref (model);
+}
+
+#define TEST_WATCHDOG_TIMEOUT   5000
+
+typedef struct _SortAsyncData
+{
+  guint n_sort_changed;
+  guint n_notify;
+  gboolean finalized;
+} SortAsyncData;
+
+/* called from the worker threads */
+static gint
+compare_bar_descending (const GValue *a,
+                        const GValue *b,
+                        gpointer      user_data G_GNUC_UNUSED)
+{
+  return g_value_get_int (b) - g_value_get_int (a);
+}
+
+static void
+sort_async_notify (gpointer data)
+{
+  SortAsyncData *sort_data = data;
+
+  sort_data->n_notify += 1;
+}
+
+static void
+on_sort_changed (ClutterModel  *model,
+                 SortAsyncData *data)
+{
+  if (g_test_verbose ())
+    g_print ("sort-changed\n");
+
+  data->n_sort_changed += 1;
+
+  clutter_main_quit ();
+}
+
+static void
+on_model_finalized (gpointer  user_data,
+                    GObject  *where_the_object_was)
+{
+  SortAsyncData *data = user_data;
+
+  if (g_test_verbose ())
+    g_print ("model finalized\n");
+
+  data->finalized = TRUE;
+
+  clutter_main_quit ();
+}
+
+static gboolean
+sort_async_timeout (gpointer data G_GNUC_UNUSED)
+{
+  g_test_message ("Watchdog timer kicking in");
+  g_assert_not_reached ();
+
+  return G_SOURCE_REMOVE;
+}
+
+void
+array_model_sort_async_changed (TestConformSimpleFixture *fixture,
+                                gconstpointer             dummy)
+{
+  SortAsyncData data = { 0, };
+  ClutterModel *model;
+  ClutterModelIter *iter;
+  guint timeout_id;
+  gint i;
+
+  model = test_model_new (CLUTTER_TYPE_ARRAY_MODEL);
+
+  for (i = 1; i < 10; i++)
+    {
+      gchar *foo = g_strdup_printf ("String %d", i);
+
+      clutter_model_append (model,
+                            COLUMN_FOO, foo,
+                            COLUMN_BAR, i,
+                            -1);
+
+      g_free (foo);
+    }
+
+  g_signal_connect (model, "sort-changed",
+                    G_CALLBACK (on_sort_changed),
+                    &data);
+
+  clutter_array_model_sort_async (CLUTTER_ARRAY_MODEL (model), COLUMN_BAR,
+                                  compare_bar_descending,
+                                  &data,
+                                  sort_async_notify);
+
+  /* the job completes in the main loop, so it always sees these rows
+   * changing after it started, and has to run again
+   */
+  clutter_model_append (model, COLUMN_FOO, "String 10", COLUMN_BAR, 10, -1);
+  clutter_model_prepend (model, COLUMN_FOO, "String 0", COLUMN_BAR, 0, -1);
+
+  timeout_id = clutter_threads_add_timeout (TEST_WATCHDOG_TIMEOUT,
+                                            sort_async_timeout,
+                                            NULL);
+  clutter_main ();
+  g_source_remove (timeout_id);
+
+  g_assert_cmpint (data.n_sort_changed, ==, 1);
+  g_assert_cmpint (data.n_notify, ==, 0);
+  g_assert_cmpint (clutter_model_get_n_rows (model), ==, 11);
+
+  for (i = 0; i < 11; i++)
+    {
+      gchar *foo = g_strdup_printf ("String %d", 10 - i);
+
+      iter = clutter_model_get_iter_at_row (model, i);
+      compare_iter (iter, i, foo, 10 - i);
+      g_object_unref (iter);
+
+      g_free (foo);
+    }
+
+  /* once applied, the sort keeps the changed rows sorted */
+  clutter_model_append (model, COLUMN_FOO, "String 5", COLUMN_BAR, 5, -1);
+
+  iter = clutter_model_get_iter_at_row (model, 6);
+  compare_iter (iter, 6, "String 5", 5);
+  g_object_unref (iter);
+
+  g_object_unref (model);
+
+  /* the data of the sort is released with the model */
+  g_assert_cmpint (data.n_notify, ==, 1);
+}
+
+void
+array_model_sort_async_unref (TestConformSimpleFixture *fixture,
+                              gconstpointer             dummy)
+{
+  SortAsyncData data = { 0, };
+  ClutterModel *model;
+  guint timeout_id;
+  gint i;
+
+  model = test_model_new (CLUTTER_TYPE_ARRAY_MODEL);
+
+  for (i = 1; i < 10; i++)
+    {
+      gchar *foo = g_strdup_printf ("String %d", i);
+
+      clutter_model_append (model,
+                            COLUMN_FOO, foo,
+                            COLUMN_BAR, i,
+                            -1);
+
+      g_free (foo);
+    }
+
+  g_object_weak_ref (G_OBJECT (model), on_model_finalized, &data);
+
+  clutter_array_model_sort_async (CLUTTER_ARRAY_MODEL (model), COLUMN_BAR,
+                                  compare_bar_descending,
+                                  &data,
+                                  sort_async_notify);
+
+  /* the running job keeps the model alive until it completes */
+  g_object_unref (model);
+  g_assert (!data.finalized);
+
+  timeout_id = clutter_threads_add_timeout (TEST_WATCHDOG_TIMEOUT,
+                                            sort_async_timeout,
+                                            NULL);
+  clutter_main ();
+  g_source_remove (timeout_id);
+
+  g_assert (data.finalized);
+  g_assert_cmpint (data.n_notify, ==, 1);
+}
+
+void
+list_model_filter (TestConformSimpleFixture *fixture,
+                   gconstpointer             data)
+{
+  model_filter (CLUTTER_TYPE_LIST_MODEL);
+}
+
+void
+list_model_iterate (TestConformSimpleFixture *fixture,
+                    gconstpointer             data)
+{
+  model_iterate (CLUTTER_TYPE_LIST_MODEL);
+}
+
+void
+list_model_populate (TestConformSimpleFixture *fixture,
+                     gconstpointer             data)
+{
+  model_populate (CLUTTER_TYPE_LIST_MODEL);
+}
+
+void
+list_model_row_changed (TestConformSimpleFixture *fixture,
+                        gconstpointer             data)
+{
+  model_row_changed (CLUTTER_TYPE_LIST_MODEL);
+}
+
+void
+list_model_replace_all (TestConformSimpleFixture *fixture,
+                        gconstpointer             data)
+{
+  model_replace_all (CLUTTER_TYPE_LIST_MODEL);
+}
+
+void
+array_model_filter (TestConformSimpleFixture *fixture,
+                    gconstpointer             data)
+{
+  model_filter (CLUTTER_TYPE_ARRAY_MODEL);
+}
+
+void
+array_model_iterate (TestConformSimpleFixture *fixture,
+                     gconstpointer             data)
+{
+  model_iterate (CLUTTER_TYPE_ARRAY_MODEL);
+}
+
+void
+array_model_populate (TestConformSimpleFixture *fixture,
+                      gconstpointer             data)
+{
+  model_populate (CLUTTER_TYPE_ARRAY_MODEL);
+}
+
+void
+array_model_row_changed (TestConformSimpleFixture *fixture,
+                         gconstpointer             data)
+{
+  model_row_changed (CLUTTER_TYPE_ARRAY_MODEL);
+}
+
+void
+array_model_replace_all (TestConformSimpleFixture *fixture,
+                         gconstpointer             data)
+{
+  model_replace_all (CLUTTER_TYPE_ARRAY_MODEL);
+}
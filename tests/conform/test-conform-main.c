@@ -136,10 +136,13 @@ main (int argc, char **argv)
   TEST_CONFORM_SIMPLE ("/actor", actor_replace_child);
   TEST_CONFORM_SIMPLE ("/actor", actor_remove_child);
   TEST_CONFORM_SIMPLE ("/actor", actor_remove_all);
+  TEST_CONFORM_SIMPLE ("/actor", actor_add_children);
   TEST_CONFORM_SIMPLE ("/actor", actor_container_signals);
   TEST_CONFORM_SIMPLE ("/actor", actor_fixed_size);
   TEST_CONFORM_SIMPLE ("/actor", actor_preferred_size);
 
+  TEST_CONFORM_SIMPLE ("/actor/pick", actor_geometry_pick);
+
   TEST_CONFORM_SIMPLE ("/actor/iter", actor_iter_traverse_children);
   TEST_CONFORM_SIMPLE ("/actor/iter", actor_iter_traverse_remove);
   TEST_CONFORM_SIMPLE ("/actor/iter", actor_iter_assignment);
@@ -169,6 +172,11 @@ main (int argc, char **argv)
   TEST_CONFORM_SIMPLE ("/text", text_password_char);
   TEST_CONFORM_SIMPLE ("/text", text_idempotent_use_markup);
 
+  TEST_CONFORM_SIMPLE ("/text/buffer", text_buffer_gap_edits);
+  TEST_CONFORM_SIMPLE ("/text/buffer", text_buffer_gap_utf8);
+  TEST_CONFORM_SIMPLE ("/text/buffer", text_buffer_gap_get_text);
+  TEST_CONFORM_SIMPLE ("/text/buffer", text_buffer_gap_grow);
+
   TEST_CONFORM_SIMPLE ("/interval", interval_initial_state);
   TEST_CONFORM_SIMPLE ("/interval", interval_transform);
 
@@ -182,17 +190,41 @@ main (int argc, char **argv)
   TEST_CONFORM_SIMPLE ("/color", color_hls_roundtrip);
   TEST_CONFORM_SIMPLE ("/color", color_operators);
 
+  TEST_CONFORM_SIMPLE ("/model", list_model_populate);
+  TEST_CONFORM_SIMPLE ("/model", list_model_iterate);
+  TEST_CONFORM_SIMPLE ("/model", list_model_filter);
+  TEST_CONFORM_SIMPLE ("/model", list_model_row_changed);
+  TEST_CONFORM_SIMPLE ("/model", list_model_replace_all);
+  TEST_CONFORM_SIMPLE ("/model", list_model_from_script);
+
+  TEST_CONFORM_SIMPLE ("/model/array", array_model_populate);
+  TEST_CONFORM_SIMPLE ("/model/array", array_model_iterate);
+  TEST_CONFORM_SIMPLE ("/model/array", array_model_filter);
+  TEST_CONFORM_SIMPLE ("/model/array", array_model_row_changed);
+  TEST_CONFORM_SIMPLE ("/model/array", array_model_replace_all);
+  TEST_CONFORM_SIMPLE ("/model/array", array_model_sort_async_changed);
+  TEST_CONFORM_SIMPLE ("/model/array", array_model_sort_async_unref);
+
+  TEST_CONFORM_SIMPLE ("/model/mapped", mapped_model_load);
+  TEST_CONFORM_SIMPLE ("/model/mapped", mapped_model_sort_filter);
+  TEST_CONFORM_SIMPLE ("/model/mapped", mapped_model_invalid);
+
   TEST_CONFORM_SIMPLE ("/units", units_constructors);
   TEST_CONFORM_SIMPLE ("/units", units_string);
   TEST_CONFORM_SIMPLE ("/units", units_cache);
 
   TEST_CONFORM_SIMPLE ("/timeline", timeline_base);
   TEST_CONFORM_SIMPLE ("/timeline", timeline_markers_from_script);
+  TEST_CONFORM_SIMPLE ("/timeline", timeline_markers_backward);
+  TEST_CONFORM_SIMPLE ("/timeline", timeline_markers_relative);
+  TEST_CONFORM_SIMPLE ("/timeline", timeline_markers_remove_in_handler);
   TEST_CONFORM_SKIP (g_test_slow (), "/timeline", timeline_interpolation);
   TEST_CONFORM_SKIP (g_test_slow (), "/timeline", timeline_rewind);
   TEST_CONFORM_SIMPLE ("/timeline", timeline_progress_mode);
   TEST_CONFORM_SIMPLE ("/timeline", timeline_progress_step);
 
+  TEST_CONFORM_SIMPLE ("/transition/keyframe", keyframe_transition_unsorted);
+
   TEST_CONFORM_SIMPLE ("/events", events_touch);
 
   /* FIXME - see bug https://bugzilla.gnome.org/show_bug.cgi?id=655588 */
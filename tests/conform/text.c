@@ -502,3 +502,218 @@ text_idempotent_use_markup (void)
 
   clutter_actor_destroy (CLUTTER_ACTOR (text));
 }
+
+/* a copy of the contents of a ClutterTextBuffer, edited with the same
+ * operations, to check the gap buffer of the default implementation
+ */
+static void
+reference_insert (GString     *reference,
+                  guint        position,
+                  const gchar *chars)
+{
+  const gchar *at = g_utf8_offset_to_pointer (reference->str, position);
+
+  g_string_insert (reference, at - reference->str, chars);
+}
+
+static void
+reference_delete (GString *reference,
+                  guint    position,
+                  guint    n_chars)
+{
+  const gchar *start = g_utf8_offset_to_pointer (reference->str, position);
+  const gchar *end = g_utf8_offset_to_pointer (start, n_chars);
+
+  g_string_erase (reference, start - reference->str, end - start);
+}
+
+static void
+buffer_insert (ClutterTextBuffer *buffer,
+               GString           *reference,
+               guint              position,
+               const gchar       *chars)
+{
+  guint n_chars = g_utf8_strlen (chars, -1);
+
+  g_assert_cmpint (clutter_text_buffer_insert_text (buffer, position, chars, -1),
+                   ==,
+                   n_chars);
+  reference_insert (reference, position, chars);
+}
+
+static void
+buffer_delete (ClutterTextBuffer *buffer,
+               GString           *reference,
+               guint              position,
+               guint              n_chars)
+{
+  g_assert_cmpint (clutter_text_buffer_delete_text (buffer, position, n_chars),
+                   ==,
+                   n_chars);
+  reference_delete (reference, position, n_chars);
+}
+
+/* checks the length without retrieving the text, which moves the gap */
+static void
+check_buffer_length (ClutterTextBuffer *buffer,
+                     GString           *reference)
+{
+  g_assert_cmpint (clutter_text_buffer_get_length (buffer),
+                   ==,
+                   g_utf8_strlen (reference->str, -1));
+  g_assert_cmpint (clutter_text_buffer_get_bytes (buffer), ==, reference->len);
+}
+
+static void
+check_buffer_text (ClutterTextBuffer *buffer,
+                   GString           *reference)
+{
+  const gchar *contents;
+
+  check_buffer_length (buffer, reference);
+
+  contents = clutter_text_buffer_get_text (buffer);
+
+  if (g_test_verbose ())
+    g_print ("Contents: '%s' (expected: '%s')\n", contents, reference->str);
+
+  g_assert (g_utf8_validate (contents, -1, NULL));
+  g_assert_cmpstr (contents, ==, reference->str);
+}
+
+void
+text_buffer_gap_edits (void)
+{
+  ClutterTextBuffer *buffer = clutter_text_buffer_new ();
+  GString *reference = g_string_new (NULL);
+
+  buffer_insert (buffer, reference, 0, "Hello World");
+  check_buffer_text (buffer, reference);
+
+  /* the gap is now at the end of the text: edit before it */
+  buffer_insert (buffer, reference, 5, ",");
+  buffer_insert (buffer, reference, 6, " big");
+  check_buffer_length (buffer, reference);
+
+  /* the gap is after "Hello, big": edit on both sides of it */
+  buffer_insert (buffer, reference, 0, ">> ");
+  buffer_delete (buffer, reference, 14, 2);
+  buffer_insert (buffer, reference, clutter_text_buffer_get_length (buffer), "!");
+  buffer_delete (buffer, reference, 3, 1);
+  check_buffer_length (buffer, reference);
+  check_buffer_text (buffer, reference);
+
+  /* deleting around the gap merges the deleted text into it */
+  buffer_insert (buffer, reference, 4, "XYZ");
+  buffer_delete (buffer, reference, 2, 7);
+  check_buffer_text (buffer, reference);
+
+  buffer_delete (buffer, reference, 0, clutter_text_buffer_get_length (buffer));
+  check_buffer_text (buffer, reference);
+  g_assert_cmpstr (clutter_text_buffer_get_text (buffer), ==, "");
+
+  g_string_free (reference, TRUE);
+  g_object_unref (buffer);
+}
+
+void
+text_buffer_gap_utf8 (void)
+{
+  ClutterTextBuffer *buffer = clutter_text_buffer_new ();
+  GString *reference = g_string_new (NULL);
+  guint i;
+
+  /* two and three bytes characters */
+  buffer_insert (buffer, reference, 0, "a\xc3\xa4" "b\xe2\x99\xa5" "c\xc3\xa4" "d\xe2\x99\xa5");
+  check_buffer_text (buffer, reference);
+
+  /* move the cached position to the middle of the text, and then
+   * look up the positions around it, in both directions
+   */
+  for (i = 0; i < clutter_text_buffer_get_length (buffer); i += 3)
+    buffer_insert (buffer, reference, i, "\xe2\x99\xa5");
+  check_buffer_length (buffer, reference);
+
+  for (i = clutter_text_buffer_get_length (buffer); i > 1; i -= 2)
+    buffer_delete (buffer, reference, i - 2, 1);
+  check_buffer_length (buffer, reference);
+
+  buffer_insert (buffer, reference, 1, "\xc3\xa4\xc3\xa4");
+  buffer_delete (buffer, reference, 3, 2);
+  buffer_insert (buffer, reference, 2, "e");
+  check_buffer_text (buffer, reference);
+
+  g_string_free (reference, TRUE);
+  g_object_unref (buffer);
+}
+
+void
+text_buffer_gap_get_text (void)
+{
+  ClutterTextBuffer *buffer = clutter_text_buffer_new_with_text ("0123456789", -1);
+  GString *reference = g_string_new ("0123456789");
+
+  check_buffer_text (buffer, reference);
+
+  /* retrieving the text moves the gap at the end, and terminates it */
+  buffer_insert (buffer, reference, 3, "abc");
+  check_buffer_text (buffer, reference);
+
+  buffer_delete (buffer, reference, 1, 1);
+  check_buffer_text (buffer, reference);
+
+  buffer_insert (buffer, reference, 8, "\xe2\x99\xa5");
+  buffer_insert (buffer, reference, 2, "\xc3\xa4");
+  check_buffer_text (buffer, reference);
+
+  /* the text stays the same if retrieved twice */
+  check_buffer_text (buffer, reference);
+
+  g_string_free (reference, TRUE);
+  g_object_unref (buffer);
+}
+
+void
+text_buffer_gap_grow (void)
+{
+  ClutterTextBuffer *buffer = clutter_text_buffer_new ();
+  GString *reference = g_string_new (NULL);
+  guint i;
+
+  buffer_insert (buffer, reference, 0, "[]");
+
+  /* grow the buffer a few times, with the gap in the middle of the
+   * text, so that the text after it has to be moved when growing
+   */
+  for (i = 0; i < 200; i++)
+    {
+      guint middle = clutter_text_buffer_get_length (buffer) / 2;
+
+      buffer_insert (buffer, reference, middle,
+                     i % 2 == 0 ? "x\xe2\x99\xa5" : "yz");
+
+      if (i % 50 == 0)
+        check_buffer_text (buffer, reference);
+    }
+
+  check_buffer_text (buffer, reference);
+
+  /* a single insertion larger than the free space */
+  buffer_insert (buffer, reference, 1,
+                 "The quick brown fox jumps over the lazy dog. "
+                 "The quick brown fox jumps over the lazy dog. "
+                 "The quick brown fox jumps over the lazy dog. "
+                 "The quick brown fox jumps over the lazy dog. "
+                 "The quick brown fox jumps over the lazy dog. "
+                 "The quick brown fox jumps over the lazy dog. "
+                 "The quick brown fox jumps over the lazy dog. "
+                 "The quick brown fox jumps over the lazy dog. "
+                 "The quick brown fox jumps over the lazy dog. "
+                 "The quick brown fox jumps over the lazy dog. "
+                 "The quick brown fox jumps over the lazy dog. "
+                 "The quick brown fox jumps over the lazy dog. ");
+  check_buffer_text (buffer, reference);
+
+  g_string_free (reference, TRUE);
+  g_object_unref (buffer);
+}
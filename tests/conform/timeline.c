@@ -360,3 +360,211 @@ timeline_markers_from_script (TestConformSimpleFixture *fixture,
 
   g_free (test_file);
 }
+
+typedef struct _MarkersData
+{
+  /* the names of the markers reached, in order, separated by spaces */
+  GString *names;
+
+  /* the time at which each marker was reached */
+  GArray *msecs;
+
+  /* the markers to remove when reaching the first marker */
+  const gchar *remove_first;
+  const gchar *remove_second;
+} MarkersData;
+
+static void
+markers_data_init (MarkersData *data)
+{
+  memset (data, 0, sizeof (MarkersData));
+  data->names = g_string_new (NULL);
+  data->msecs = g_array_new (FALSE, FALSE, sizeof (gint));
+}
+
+static void
+markers_data_destroy (MarkersData *data)
+{
+  g_string_free (data->names, TRUE);
+  g_array_free (data->msecs, TRUE);
+}
+
+static void
+markers_reached_cb (ClutterTimeline *timeline,
+                    const gchar     *marker_name,
+                    gint             msecs,
+                    MarkersData     *data)
+{
+  if (g_test_verbose ())
+    g_print ("Marker '%s' (%d) reached, elapsed = %u\n",
+             marker_name, msecs,
+             clutter_timeline_get_elapsed_time (timeline));
+
+  if (data->names->len > 0)
+    g_string_append_c (data->names, ' ');
+  g_string_append (data->names, marker_name);
+  g_array_append_val (data->msecs, msecs);
+
+  if (data->remove_first != NULL &&
+      strcmp (marker_name, data->remove_first) == 0)
+    {
+      clutter_timeline_remove_marker (timeline, data->remove_first);
+      clutter_timeline_remove_marker (timeline, data->remove_second);
+    }
+}
+
+static void
+markers_stopped_cb (ClutterTimeline *timeline,
+                    gboolean         is_finished,
+                    gpointer         data G_GNUC_UNUSED)
+{
+  if (is_finished)
+    clutter_main_quit ();
+}
+
+static void
+run_markers_timeline (ClutterTimeline *timeline,
+                      MarkersData     *data)
+{
+  guint timeout_id;
+
+  g_signal_connect (timeline, "marker-reached",
+                    G_CALLBACK (markers_reached_cb),
+                    data);
+  g_signal_connect (timeline, "stopped",
+                    G_CALLBACK (markers_stopped_cb),
+                    NULL);
+
+  /* a watchdog, in case the timeline never stops */
+  timeout_id = clutter_threads_add_timeout (5000, timeout_cb, NULL);
+
+  clutter_timeline_start (timeline);
+  clutter_main ();
+
+  g_source_remove (timeout_id);
+
+  if (g_test_verbose ())
+    g_print ("Markers reached: '%s'\n", data->names->str);
+}
+
+void
+timeline_markers_backward (TestConformSimpleFixture *fixture G_GNUC_UNUSED,
+                           gconstpointer             dummy G_GNUC_UNUSED)
+{
+  /* NB: We have to ensure a stage is instantiated else the master
+   * clock wont run... */
+  ClutterActor *stage = clutter_stage_new ();
+  ClutterTimeline *timeline;
+  MarkersData data;
+
+  markers_data_init (&data);
+
+  timeline = clutter_timeline_new (300);
+  clutter_timeline_set_direction (timeline, CLUTTER_TIMELINE_BACKWARD);
+
+  /* added out of order, including both ends of the timeline */
+  clutter_timeline_add_marker_at_time (timeline, "m100", 100);
+  clutter_timeline_add_marker_at_time (timeline, "m0", 0);
+  clutter_timeline_add_marker_at_time (timeline, "m300", 300);
+  clutter_timeline_add_marker_at_time (timeline, "m200", 200);
+
+  run_markers_timeline (timeline, &data);
+
+  /* going backward, the later markers are reached first */
+  g_assert_cmpstr (data.names->str, ==, "m300 m200 m100 m0");
+
+  markers_data_destroy (&data);
+  g_object_unref (timeline);
+  clutter_actor_destroy (stage);
+}
+
+void
+timeline_markers_relative (TestConformSimpleFixture *fixture G_GNUC_UNUSED,
+                           gconstpointer             dummy G_GNUC_UNUSED)
+{
+  ClutterActor *stage = clutter_stage_new ();
+  ClutterTimeline *timeline;
+  MarkersData data;
+  gchar **markers;
+  gsize n_markers;
+
+  markers_data_init (&data);
+
+  timeline = clutter_timeline_new (300);
+
+  /* at 75, 150 and 200 msecs for the initial duration */
+  clutter_timeline_add_marker (timeline, "quarter", 0.25);
+  clutter_timeline_add_marker (timeline, "half", 0.5);
+  clutter_timeline_add_marker_at_time (timeline, "absolute", 200);
+
+  markers = clutter_timeline_list_markers (timeline, 150, &n_markers);
+  g_assert_cmpint (n_markers, ==, 1);
+  g_assert_cmpstr (markers[0], ==, "half");
+  g_strfreev (markers);
+
+  /* the relative markers move with the duration, the others don't;
+   * this changes the order of "half" and "absolute"
+   */
+  clutter_timeline_set_duration (timeline, 600);
+
+  markers = clutter_timeline_list_markers (timeline, 150, &n_markers);
+  g_assert_cmpint (n_markers, ==, 1);
+  g_assert_cmpstr (markers[0], ==, "quarter");
+  g_strfreev (markers);
+
+  markers = clutter_timeline_list_markers (timeline, 300, &n_markers);
+  g_assert_cmpint (n_markers, ==, 1);
+  g_assert_cmpstr (markers[0], ==, "half");
+  g_strfreev (markers);
+
+  markers = clutter_timeline_list_markers (timeline, 75, &n_markers);
+  g_assert_cmpint (n_markers, ==, 0);
+  g_strfreev (markers);
+
+  run_markers_timeline (timeline, &data);
+
+  g_assert_cmpstr (data.names->str, ==, "quarter absolute half");
+  g_assert_cmpint (data.msecs->len, ==, 3);
+  g_assert_cmpint (g_array_index (data.msecs, gint, 0), ==, 150);
+  g_assert_cmpint (g_array_index (data.msecs, gint, 1), ==, 200);
+  g_assert_cmpint (g_array_index (data.msecs, gint, 2), ==, 300);
+
+  markers_data_destroy (&data);
+  g_object_unref (timeline);
+  clutter_actor_destroy (stage);
+}
+
+void
+timeline_markers_remove_in_handler (TestConformSimpleFixture *fixture G_GNUC_UNUSED,
+                                    gconstpointer             dummy G_GNUC_UNUSED)
+{
+  ClutterActor *stage = clutter_stage_new ();
+  ClutterTimeline *timeline;
+  MarkersData data;
+
+  markers_data_init (&data);
+
+  /* the reached marker removes itself and a later marker; running the
+   * timeline twice checks that neither is reached afterwards, while
+   * the marker that was left alone is reached on each run
+   */
+  data.remove_first = "first";
+  data.remove_second = "removed";
+
+  timeline = clutter_timeline_new (600);
+  clutter_timeline_set_repeat_count (timeline, 1);
+  clutter_timeline_add_marker_at_time (timeline, "first", 50);
+  clutter_timeline_add_marker_at_time (timeline, "kept", 300);
+  clutter_timeline_add_marker_at_time (timeline, "removed", 550);
+
+  run_markers_timeline (timeline, &data);
+
+  g_assert_cmpstr (data.names->str, ==, "first kept kept");
+  g_assert (!clutter_timeline_has_marker (timeline, "first"));
+  g_assert (!clutter_timeline_has_marker (timeline, "removed"));
+  g_assert (clutter_timeline_has_marker (timeline, "kept"));
+
+  markers_data_destroy (&data);
+  g_object_unref (timeline);
+  clutter_actor_destroy (stage);
+}
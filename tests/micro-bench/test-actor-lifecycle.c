@@ -0,0 +1,294 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib/gstdio.h>
+#include <clutter/clutter.h>
+
+/* Measures the cost of the operations on the actors that dominate list
+ * virtualization and screen transitions, for scenes of increasing size.
+ *
+ * Each operation is run once on every actor of the scene, and its cost
+ * is reported per actor, together with the number of allocations and
+ * the number of bytes allocated through GLib per actor. When the
+ * CLUTTER_PERFORMANCE_JSON environment variable is set, the results are
+ * appended to the file it names, one JSON object per line, in the same
+ * format used by the tests in tests/performance.
+ */
+
+static gint min_actors = 1000;
+static gint max_actors = 1000000;
+
+static GOptionEntry entries[] = {
+  {
+    "min-actors", 'm',
+    0,
+    G_OPTION_ARG_INT, &min_actors,
+    "Number of actors of the smallest scene", "ACTORS"
+  },
+  {
+    "max-actors", 'M',
+    0,
+    G_OPTION_ARG_INT, &max_actors,
+    "Number of actors of the largest scene", "ACTORS"
+  },
+  { NULL }
+};
+
+/* the counting allocator; the slice allocator is disabled in main(),
+ * so that the slices are counted as well
+ */
+static gsize n_allocs = 0;
+static gsize n_bytes = 0;
+
+static gpointer
+counting_malloc (gsize n_bytes_)
+{
+  n_allocs += 1;
+  n_bytes += n_bytes_;
+
+  return malloc (n_bytes_);
+}
+
+static gpointer
+counting_realloc (gpointer mem,
+                  gsize    n_bytes_)
+{
+  if (mem == NULL)
+    n_allocs += 1;
+
+  n_bytes += n_bytes_;
+
+  return realloc (mem, n_bytes_);
+}
+
+static gpointer
+counting_calloc (gsize n_blocks,
+                 gsize n_block_bytes)
+{
+  n_allocs += 1;
+  n_bytes += n_blocks * n_block_bytes;
+
+  return calloc (n_blocks, n_block_bytes);
+}
+
+static GMemVTable counting_vtable = {
+  counting_malloc,
+  counting_realloc,
+  free,
+  counting_calloc,
+  counting_malloc,
+  counting_realloc
+};
+
+typedef struct {
+  GTimer *timer;
+  gsize allocs_start;
+  gsize bytes_start;
+} Measure;
+
+static void
+measure_start (Measure *measure)
+{
+  measure->allocs_start = n_allocs;
+  measure->bytes_start = n_bytes;
+
+  g_timer_start (measure->timer);
+}
+
+static void
+measure_report (Measure     *measure,
+                const gchar *operation,
+                gint         n_actors)
+{
+  const gchar *filename = g_getenv ("CLUTTER_PERFORMANCE_JSON");
+  gdouble ns_per_op, allocs_per_op, bytes_per_op;
+  gchar *id;
+
+  g_timer_stop (measure->timer);
+
+  ns_per_op = g_timer_elapsed (measure->timer, NULL) * 1e9 / n_actors;
+  allocs_per_op = (gdouble) (n_allocs - measure->allocs_start) / n_actors;
+  bytes_per_op = (gdouble) (n_bytes - measure->bytes_start) / n_actors;
+
+  id = g_strdup_printf ("actor-%s-%d", operation, n_actors);
+
+  printf ("%-32s %10.1f ns/op %8.2f allocs/op %10.1f bytes/op\n",
+          id, ns_per_op, allocs_per_op, bytes_per_op);
+
+  if (filename != NULL && *filename != '\0')
+    {
+      FILE *file = g_fopen (filename, "a");
+
+      if (file != NULL)
+        {
+          fprintf (file,
+                   "{ \"id\": \"%s\", \"actors\": %d, "
+                   "\"ns_per_op\": %.1f, \"allocs_per_op\": %.2f, "
+                   "\"bytes_per_op\": %.1f }\n",
+                   id, n_actors, ns_per_op, allocs_per_op, bytes_per_op);
+          fclose (file);
+        }
+      else
+        g_warning ("Unable to open '%s' for writing", filename);
+    }
+
+  g_free (id);
+}
+
+static void
+on_after_paint (ClutterActor *stage,
+                gboolean     *painted)
+{
+  *painted = TRUE;
+}
+
+/* transitions are only created for actors that have been painted */
+static void
+paint_once (ClutterActor *stage)
+{
+  gboolean painted = FALSE;
+  gulong id;
+
+  id = g_signal_connect (stage, "after-paint",
+                         G_CALLBACK (on_after_paint),
+                         &painted);
+
+  clutter_actor_queue_redraw (stage);
+
+  while (!painted)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_signal_handler_disconnect (stage, id);
+}
+
+static gboolean
+on_button_press (ClutterActor *actor,
+                 ClutterEvent *event,
+                 gpointer      data)
+{
+  return CLUTTER_EVENT_PROPAGATE;
+}
+
+static void
+run_scene (ClutterActor *stage,
+           gint          n_actors)
+{
+  ClutterActor **actors;
+  ClutterActor *container, *child;
+  ClutterActorIter iter;
+  Measure measure;
+  gulong *handlers;
+  gint i, n_children;
+
+  actors = g_new (ClutterActor *, n_actors);
+  handlers = g_new (gulong, n_actors);
+  measure.timer = g_timer_new ();
+
+  container = clutter_actor_new ();
+  clutter_actor_add_child (stage, container);
+
+  measure_start (&measure);
+  for (i = 0; i < n_actors; i++)
+    actors[i] = g_object_ref_sink (clutter_actor_new ());
+  measure_report (&measure, "new", n_actors);
+
+  measure_start (&measure);
+  for (i = 0; i < n_actors; i++)
+    clutter_actor_add_child (container, actors[i]);
+  measure_report (&measure, "add-child", n_actors);
+
+  measure_start (&measure);
+  for (i = 0; i < n_actors; i++)
+    handlers[i] = g_signal_connect (actors[i], "button-press-event",
+                                    G_CALLBACK (on_button_press),
+                                    NULL);
+  measure_report (&measure, "signal-connect", n_actors);
+
+  measure_start (&measure);
+  for (i = 0; i < n_actors; i++)
+    g_signal_handler_disconnect (actors[i], handlers[i]);
+  measure_report (&measure, "signal-disconnect", n_actors);
+
+  measure_start (&measure);
+  for (i = 0; i < n_actors; i++)
+    clutter_actor_set_size (actors[i], 1, 1);
+  measure_report (&measure, "set-size", n_actors);
+
+  paint_once (stage);
+
+  measure_start (&measure);
+  for (i = 0; i < n_actors; i++)
+    {
+      clutter_actor_save_easing_state (actors[i]);
+      clutter_actor_set_easing_duration (actors[i], 250);
+      clutter_actor_set_x (actors[i], 10);
+      clutter_actor_restore_easing_state (actors[i]);
+    }
+  measure_report (&measure, "transition-start", n_actors);
+
+  for (i = 0; i < n_actors; i++)
+    clutter_actor_remove_all_transitions (actors[i]);
+
+  n_children = 0;
+  measure_start (&measure);
+  clutter_actor_iter_init (&iter, container);
+  while (clutter_actor_iter_next (&iter, &child))
+    n_children += 1;
+  measure_report (&measure, "iter", n_actors);
+
+  g_assert_cmpint (n_children, ==, n_actors);
+
+  measure_start (&measure);
+  for (i = 0; i < n_actors; i++)
+    clutter_actor_destroy (actors[i]);
+  measure_report (&measure, "destroy", n_actors);
+
+  for (i = 0; i < n_actors; i++)
+    g_object_unref (actors[i]);
+
+  clutter_actor_destroy (container);
+
+  g_timer_destroy (measure.timer);
+  g_free (handlers);
+  g_free (actors);
+}
+
+int
+main (int argc, char **argv)
+{
+  ClutterActor *stage;
+  GError *error = NULL;
+  gint n_actors;
+
+  /* the vtable must be set before anything is allocated */
+  g_mem_set_vtable (&counting_vtable);
+  g_setenv ("G_SLICE", "always-malloc", TRUE);
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
+
+  if (clutter_init_with_args (&argc, &argv,
+                              NULL,
+                              entries,
+                              NULL,
+                              &error) != CLUTTER_INIT_SUCCESS)
+    {
+      g_printerr ("Unable to initialize Clutter: %s\n",
+                  error != NULL ? error->message : "unknown error");
+      return EXIT_FAILURE;
+    }
+
+  stage = clutter_stage_new ();
+  clutter_actor_set_size (stage, 512, 512);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Actor lifecycle");
+  clutter_actor_show (stage);
+
+  for (n_actors = MAX (min_actors, 1);
+       n_actors <= max_actors;
+       n_actors *= 10)
+    run_scene (stage, n_actors);
+
+  clutter_actor_destroy (stage);
+
+  return EXIT_SUCCESS;
+}
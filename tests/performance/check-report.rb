@@ -0,0 +1,85 @@
+#!/usr/bin/env ruby
+#
+# Compares the results written by the performance tests when the
+# CLUTTER_PERFORMANCE_JSON environment variable is set against a
+# baseline; exits with a non-zero status if any of the per-frame
+# percentiles, or any of the per-operation costs written by the
+# micro-benchmarks, regressed by more than the threshold.
+#
+# usage: check-report.rb RESULTS BASELINE [THRESHOLD-PERCENT]
+
+require 'json'
+
+def load_results(filename)
+    results = Hash.new
+    File.readlines(filename).each do |line|
+        line = line.strip
+        next if line.empty?
+        entry = JSON.parse(line)
+        results[entry['id']] = entry
+    end
+    results
+end
+
+if ARGV.length < 2
+    $stderr.puts "usage: #{$0} RESULTS BASELINE [THRESHOLD-PERCENT]"
+    exit 2
+end
+
+results_file, baseline_file = ARGV[0], ARGV[1]
+threshold = (ARGV[2] || 10).to_f
+
+results = load_results(results_file)
+
+if not File.exist?(baseline_file)
+    puts "No baseline in #{baseline_file}; run 'make perf-baseline' to create one"
+    exit 0
+end
+
+baseline = load_results(baseline_file)
+regressions = 0
+
+results.each do |id, result|
+    base = baseline[id]
+    if base.nil?
+        puts "#{id}: no baseline, skipping"
+        next
+    end
+
+    [ 'frame', 'relayout', 'paint', 'gpu' ].each do |phase|
+        next if result[phase].nil? or base[phase].nil?
+
+        [ 'p50', 'p95', 'p99' ].each do |percentile|
+            value = result[phase][percentile].to_f
+            reference = base[phase][percentile].to_f
+            next if reference <= 0
+
+            change = (value - reference) * 100.0 / reference
+            status = change > threshold ? 'REGRESSED' : 'ok'
+            regressions += 1 if change > threshold
+
+            printf("%-20s %-8s %-3s %8d us (baseline %8d us, %+6.1f%%) %s\n",
+                   id, phase, percentile, value, reference, change, status)
+        end
+    end
+
+    [ 'ns_per_op', 'allocs_per_op' ].each do |key|
+        next if result[key].nil? or base[key].nil?
+
+        value = result[key].to_f
+        reference = base[key].to_f
+        next if reference <= 0
+
+        change = (value - reference) * 100.0 / reference
+        status = change > threshold ? 'REGRESSED' : 'ok'
+        regressions += 1 if change > threshold
+
+        printf("%-20s %-12s %10.2f (baseline %10.2f, %+6.1f%%) %s\n",
+               id, key, value, reference, change, status)
+    end
+end
+
+if regressions > 0
+    puts "#{regressions} value(s) regressed by more than #{threshold}%"
+    exit 1
+end
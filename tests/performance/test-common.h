@@ -1,11 +1,26 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <clutter/clutter.h>
 
 static GTimer *testtimer = NULL;
 static gint testframes = 0;
 static float testmaxtime = 1.0;
 
+/* when CLUTTER_REPLAY_EVENTS is set, the recorded input drives the test
+ * and Clutter quits once it has been replayed
+ */
+static gboolean testreplay = FALSE;
+
+/* per-frame samples collected from ClutterStage::frame-stats */
+static GArray *testframe_samples = NULL;
+static GArray *testrelayout_samples = NULL;
+static GArray *testpaint_samples = NULL;
+static GArray *testgpu_samples = NULL;
+static guint testpicks = 0;
+static guint testrelayouts = 0;
+
 /* initialize environment to be suitable for fps testing */
 void clutter_perf_fps_init (void)
 {
@@ -21,26 +36,123 @@ void clutter_perf_fps_init (void)
   else
     testmaxtime = 10.0;
 
+  testreplay = g_getenv ("CLUTTER_REPLAY_EVENTS") != NULL;
+
   g_random_set_seed (12345678);
 }
 
 static void perf_stage_paint_cb (ClutterStage *stage, gpointer *data);
+static void perf_stage_frame_stats_cb (ClutterStage *stage,
+                                       const ClutterFrameStats *stats,
+                                       gpointer data);
 static gboolean perf_fake_mouse_cb (gpointer stage);
 
 void clutter_perf_fps_start (ClutterStage *stage)
 {
+  testframe_samples = g_array_new (FALSE, FALSE, sizeof (gint64));
+  testrelayout_samples = g_array_new (FALSE, FALSE, sizeof (gint64));
+  testpaint_samples = g_array_new (FALSE, FALSE, sizeof (gint64));
+  testgpu_samples = g_array_new (FALSE, FALSE, sizeof (gint64));
+
   g_signal_connect (stage, "paint", G_CALLBACK (perf_stage_paint_cb), NULL);
+  g_signal_connect (stage, "frame-stats",
+                    G_CALLBACK (perf_stage_frame_stats_cb),
+                    NULL);
 }
 
 void clutter_perf_fake_mouse (ClutterStage *stage)
 {
+  if (testreplay)
+    return;
+
   clutter_threads_add_timeout (1000/60, perf_fake_mouse_cb, stage);
 }
 
+static gint perf_compare_samples (gconstpointer a, gconstpointer b)
+{
+  gint64 va = *(const gint64 *) a;
+  gint64 vb = *(const gint64 *) b;
+
+  return va < vb ? -1 : (va > vb ? 1 : 0);
+}
+
+/* nearest-rank percentile of a sorted array of samples */
+static gint64 perf_percentile (GArray *samples, gint percent)
+{
+  guint rank;
+
+  if (samples == NULL || samples->len == 0)
+    return 0;
+
+  rank = (samples->len * percent + 99) / 100;
+  if (rank > 0)
+    rank -= 1;
+
+  return g_array_index (samples, gint64, MIN (rank, samples->len - 1));
+}
+
+static void perf_write_distribution (FILE *file,
+                                     const gchar *name,
+                                     GArray *samples)
+{
+  if (samples != NULL)
+    g_array_sort (samples, perf_compare_samples);
+
+  fprintf (file,
+           "\"%s\": { \"p50\": %" G_GINT64_FORMAT
+           ", \"p95\": %" G_GINT64_FORMAT
+           ", \"p99\": %" G_GINT64_FORMAT " }",
+           name,
+           perf_percentile (samples, 50),
+           perf_percentile (samples, 95),
+           perf_percentile (samples, 99));
+}
+
+/* appends one JSON object per line to the file named by the
+ * CLUTTER_PERFORMANCE_JSON environment variable; the times are
+ * in microseconds
+ */
+static void perf_write_json (const gchar *id, gdouble fps)
+{
+  const gchar *filename = g_getenv ("CLUTTER_PERFORMANCE_JSON");
+  FILE *file;
+
+  if (filename == NULL || *filename == '\0')
+    return;
+
+  file = g_fopen (filename, "a");
+  if (file == NULL)
+    {
+      g_warning ("Unable to open '%s' for writing", filename);
+      return;
+    }
+
+  fprintf (file, "{ \"id\": \"%s\", \"fps\": %.2f, \"frames\": %d, ",
+           id, fps, testframes);
+  fprintf (file, "\"picks\": %u, \"relayouts\": %u, ",
+           testpicks, testrelayouts);
+  perf_write_distribution (file, "frame", testframe_samples);
+  fprintf (file, ", ");
+  perf_write_distribution (file, "relayout", testrelayout_samples);
+  fprintf (file, ", ");
+  perf_write_distribution (file, "paint", testpaint_samples);
+  fprintf (file, ", ");
+  perf_write_distribution (file, "gpu", testgpu_samples);
+  fprintf (file, " }\n");
+
+  fclose (file);
+}
+
 void clutter_perf_fps_report (const gchar *id)
 {
-  g_print ("\n@ %s: %.2f fps \n",
-       id, testframes / g_timer_elapsed (testtimer, NULL));
+  gdouble fps = 0.0;
+
+  if (testtimer != NULL)
+    fps = testframes / g_timer_elapsed (testtimer, NULL);
+
+  g_print ("\n@ %s: %.2f fps \n", id, fps);
+
+  perf_write_json (id, fps);
 }
 
 static void perf_stage_paint_cb (ClutterStage *stage, gpointer *data)
@@ -48,12 +160,37 @@ static void perf_stage_paint_cb (ClutterStage *stage, gpointer *data)
   if (!testtimer)
     testtimer = g_timer_new ();
   testframes ++;
-  if (g_timer_elapsed (testtimer, NULL) > testmaxtime)
+  if (!testreplay && g_timer_elapsed (testtimer, NULL) > testmaxtime)
     {
       clutter_main_quit ();
     }
 }
 
+static void perf_stage_frame_stats_cb (ClutterStage *stage,
+                                       const ClutterFrameStats *stats,
+                                       gpointer data)
+{
+  gint64 frame;
+
+  frame = stats->events_time
+        + stats->timelines_time
+        + stats->relayout_time
+        + stats->paint_time
+        + stats->swap_wait_time;
+
+  g_array_append_val (testframe_samples, frame);
+  g_array_append_val (testrelayout_samples, stats->relayout_time);
+  g_array_append_val (testpaint_samples, stats->paint_time);
+
+  /* not every driver can measure the GPU time */
+  if (stats->gpu_time >= 0)
+    g_array_append_val (testgpu_samples, stats->gpu_time);
+
+  testpicks += stats->n_picks;
+  if (stats->relayout_time > 0)
+    testrelayouts += 1;
+}
+
 static void wrap (gfloat *value, gfloat min, gfloat max)
 {
   if (*value > max)
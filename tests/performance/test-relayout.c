@@ -0,0 +1,105 @@
+#include <stdlib.h>
+#include <clutter/clutter.h>
+#include "test-common.h"
+
+#define N_ACTORS 400
+
+static gint n_actors = N_ACTORS;
+
+static GOptionEntry entries[] = {
+  {
+    "num-actors", 'a',
+    0,
+    G_OPTION_ARG_INT, &n_actors,
+    "Number of actors", "ACTORS"
+  },
+  { NULL }
+};
+
+/* resizes one child of the flow layout every frame, so that every
+ * frame has to reflow the whole container
+ */
+static gboolean
+resize_child (gpointer data)
+{
+  ClutterActor *box = data;
+  static gint index_ = 0;
+  ClutterActor *child;
+
+  child = clutter_actor_get_child_at_index (box, index_);
+  if (child != NULL)
+    {
+      gfloat width = clutter_actor_get_width (child);
+
+      clutter_actor_set_width (child, width > 20.0f ? 10.0f : 30.0f);
+    }
+
+  index_ = (index_ + 1) % clutter_actor_get_n_children (box);
+
+  return G_SOURCE_CONTINUE;
+}
+
+int
+main (int argc, char **argv)
+{
+  ClutterActor *stage, *box, *actor;
+  ClutterLayoutManager *layout;
+  gint i;
+
+  clutter_perf_fps_init ();
+
+  if (CLUTTER_INIT_SUCCESS !=
+        clutter_init_with_args (&argc, &argv,
+                                NULL,
+                                entries,
+                                NULL,
+                                NULL))
+    {
+      g_warning ("Failed to initialize clutter");
+      return -1;
+    }
+
+  n_actors = MAX (n_actors, 1);
+
+  stage = clutter_stage_new ();
+  clutter_actor_set_size (stage, 512, 512);
+  clutter_actor_set_background_color (stage, CLUTTER_COLOR_Black);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Relayout Performance");
+  g_signal_connect (stage, "destroy", G_CALLBACK (clutter_main_quit), NULL);
+
+  printf ("Relayout performance test with %d actors\n", n_actors);
+
+  layout = clutter_flow_layout_new (CLUTTER_FLOW_HORIZONTAL);
+  clutter_flow_layout_set_column_spacing (CLUTTER_FLOW_LAYOUT (layout), 2);
+  clutter_flow_layout_set_row_spacing (CLUTTER_FLOW_LAYOUT (layout), 2);
+
+  box = clutter_actor_new ();
+  clutter_actor_set_layout_manager (box, layout);
+  clutter_actor_add_constraint (box, clutter_bind_constraint_new (stage,
+                                                                  CLUTTER_BIND_SIZE,
+                                                                  0.0));
+  clutter_actor_add_child (stage, box);
+
+  for (i = 0; i < n_actors; i++)
+    {
+      ClutterColor color;
+
+      clutter_color_from_hls (&color, (360.0f * i) / n_actors, 0.5f, 0.8f);
+
+      actor = clutter_actor_new ();
+      clutter_actor_set_background_color (actor, &color);
+      clutter_actor_set_size (actor, 10.0f + (i % 3) * 10.0f, 14.0f);
+      clutter_actor_set_reactive (actor, TRUE);
+      clutter_actor_add_child (box, actor);
+    }
+
+  clutter_actor_show (stage);
+
+  clutter_perf_fps_start (CLUTTER_STAGE (stage));
+  clutter_perf_fake_mouse (CLUTTER_STAGE (stage));
+  clutter_threads_add_timeout (1000 / 60, resize_child, box);
+  clutter_main ();
+  clutter_perf_fps_report ("test-relayout");
+
+  return 0;
+}
@@ -0,0 +1,540 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <clutter/clutter.h>
+#include "test-common.h"
+
+#define STAGE_WIDTH     800
+#define STAGE_HEIGHT    600
+
+#define WARMUP_FRAMES   3
+
+static gchar *scene_name = NULL;
+static gint min_actors = 100;
+static gint max_actors = 100000;
+static gint n_frames = 60;
+static gint depth = 32;
+static gchar *output_file = NULL;
+
+static GOptionEntry entries[] = {
+  {
+    "scene", 's',
+    0,
+    G_OPTION_ARG_STRING, &scene_name,
+    "Scene to generate (wide, deep, scroll, effects, text)", "SCENE"
+  },
+  {
+    "min-actors", 'm',
+    0,
+    G_OPTION_ARG_INT, &min_actors,
+    "Number of actors of the smallest scene", "ACTORS"
+  },
+  {
+    "max-actors", 'M',
+    0,
+    G_OPTION_ARG_INT, &max_actors,
+    "Number of actors of the largest scene", "ACTORS"
+  },
+  {
+    "num-frames", 'f',
+    0,
+    G_OPTION_ARG_INT, &n_frames,
+    "Number of frames measured for each scene", "FRAMES"
+  },
+  {
+    "depth", 'd',
+    0,
+    G_OPTION_ARG_INT, &depth,
+    "Depth of the trees of the deep scene", "DEPTH"
+  },
+  {
+    "output", 'o',
+    0,
+    G_OPTION_ARG_FILENAME, &output_file,
+    "Append the scaling curve to a CSV file", "FILE"
+  },
+  { NULL }
+};
+
+typedef ClutterActor *(* SceneFunc) (gint  n_actors,
+                                     gint *n_created);
+
+typedef struct {
+  ClutterActor *stage;
+  ClutterActor *scene;
+
+  const gchar *name;
+  SceneFunc func;
+
+  gint n_actors;
+  gint n_created;
+  gint frame;
+
+  glong resident_before;
+  glong resident_after;
+
+  GArray *frame_samples;
+  GArray *pick_samples;
+  GArray *relayout_samples;
+} SceneScale;
+
+static glong
+get_resident_bytes (void)
+{
+  glong size = 0, resident = 0;
+  FILE *file;
+
+  file = fopen ("/proc/self/statm", "r");
+  if (file == NULL)
+    return 0;
+
+  if (fscanf (file, "%ld %ld", &size, &resident) != 2)
+    resident = 0;
+
+  fclose (file);
+
+  return resident * sysconf (_SC_PAGESIZE);
+}
+
+static ClutterActor *
+make_root (void)
+{
+  ClutterLayoutManager *layout;
+  ClutterActor *root;
+
+  layout = clutter_flow_layout_new (CLUTTER_FLOW_HORIZONTAL);
+  clutter_flow_layout_set_column_spacing (CLUTTER_FLOW_LAYOUT (layout), 1);
+  clutter_flow_layout_set_row_spacing (CLUTTER_FLOW_LAYOUT (layout), 1);
+
+  root = clutter_actor_new ();
+  clutter_actor_set_layout_manager (root, layout);
+  clutter_actor_set_size (root, STAGE_WIDTH, STAGE_HEIGHT);
+
+  return root;
+}
+
+static ClutterActor *
+make_leaf (gint   index_,
+           gfloat width,
+           gfloat height)
+{
+  ClutterActor *actor;
+  ClutterColor color;
+
+  clutter_color_from_hls (&color, (index_ * 7) % 360, 0.5f, 0.8f);
+
+  actor = clutter_actor_new ();
+  clutter_actor_set_background_color (actor, &color);
+  clutter_actor_set_size (actor, width, height);
+  clutter_actor_set_reactive (actor, TRUE);
+
+  return actor;
+}
+
+/* a single container with every actor as a direct child */
+static ClutterActor *
+scene_wide (gint  n_actors,
+            gint *n_created)
+{
+  ClutterActor *root = make_root ();
+  gint i;
+
+  for (i = 0; i < n_actors; i++)
+    clutter_actor_add_child (root, make_leaf (i, 8, 8));
+
+  *n_created = n_actors + 1;
+
+  return root;
+}
+
+/* chains of nested actors, each @depth levels deep */
+static ClutterActor *
+scene_deep (gint  n_actors,
+            gint *n_created)
+{
+  ClutterActor *root = make_root ();
+  gint i, created = 1;
+
+  for (i = 0; i < n_actors; )
+    {
+      ClutterActor *parent = make_leaf (i++, 24, 24);
+      gint level;
+
+      clutter_actor_add_child (root, parent);
+      created += 1;
+
+      for (level = 1; level < depth && i < n_actors; level++)
+        {
+          ClutterActor *child = make_leaf (i++, 24, 24);
+
+          clutter_actor_set_layout_manager (parent, clutter_bin_layout_new ());
+          clutter_actor_set_margin_left (child, 0.25f);
+          clutter_actor_add_child (parent, child);
+
+          parent = child;
+          created += 1;
+        }
+    }
+
+  *n_created = created;
+
+  return root;
+}
+
+/* clipped scroll views, each containing a vertical list */
+static ClutterActor *
+scene_scroll (gint  n_actors,
+              gint *n_created)
+{
+  ClutterActor *root = make_root ();
+  gint i, created = 1;
+
+  for (i = 0; i < n_actors; )
+    {
+      ClutterLayoutManager *layout;
+      ClutterActor *view;
+      gint row;
+
+      layout = clutter_box_layout_new ();
+      clutter_box_layout_set_orientation (CLUTTER_BOX_LAYOUT (layout),
+                                          CLUTTER_ORIENTATION_VERTICAL);
+
+      view = clutter_scroll_actor_new ();
+      clutter_actor_set_layout_manager (view, layout);
+      clutter_actor_set_size (view, 64, 64);
+      clutter_actor_set_clip_to_allocation (view, TRUE);
+      clutter_actor_add_child (root, view);
+      created += 1;
+      i += 1;
+
+      for (row = 0; row < 50 && i < n_actors; row++)
+        {
+          clutter_actor_add_child (view, make_leaf (i++, 60, 12));
+          created += 1;
+        }
+    }
+
+  *n_created = created;
+
+  return root;
+}
+
+/* groups of ten actors, each group painted through an offscreen effect */
+static ClutterActor *
+scene_effects (gint  n_actors,
+               gint *n_created)
+{
+  ClutterActor *root = make_root ();
+  gint i, created = 1;
+
+  for (i = 0; i < n_actors; )
+    {
+      ClutterActor *group;
+      gint j;
+
+      group = clutter_actor_new ();
+      clutter_actor_set_layout_manager (group,
+                                        clutter_flow_layout_new (CLUTTER_FLOW_HORIZONTAL));
+      clutter_actor_set_width (group, 40);
+      clutter_actor_add_effect (group,
+                                clutter_colorize_effect_new (CLUTTER_COLOR_LightSkyBlue));
+      clutter_actor_add_child (root, group);
+      created += 1;
+      i += 1;
+
+      for (j = 0; j < 10 && i < n_actors; j++)
+        {
+          clutter_actor_add_child (group, make_leaf (i++, 8, 8));
+          created += 1;
+        }
+    }
+
+  *n_created = created;
+
+  return root;
+}
+
+/* short labels, each with its own layout */
+static ClutterActor *
+scene_text (gint  n_actors,
+            gint *n_created)
+{
+  ClutterActor *root = make_root ();
+  gint i;
+
+  for (i = 0; i < n_actors; i++)
+    {
+      ClutterActor *text;
+      gchar *label;
+
+      label = g_strdup_printf ("Label %d", i);
+      text = clutter_text_new_full ("Sans 8", label, CLUTTER_COLOR_White);
+      clutter_actor_set_reactive (text, TRUE);
+      clutter_actor_add_child (root, text);
+      g_free (label);
+    }
+
+  *n_created = n_actors + 1;
+
+  return root;
+}
+
+static const struct {
+  const gchar *name;
+  SceneFunc func;
+} scenes[] = {
+  { "wide", scene_wide },
+  { "deep", scene_deep },
+  { "scroll", scene_scroll },
+  { "effects", scene_effects },
+  { "text", scene_text },
+};
+
+static void
+scene_scale_report (SceneScale *scale)
+{
+  gdouble bytes_per_actor, accounted_bytes_per_actor;
+  guint n_actors = 0;
+  gsize actor_bytes;
+
+  g_array_sort (scale->frame_samples, perf_compare_samples);
+  g_array_sort (scale->pick_samples, perf_compare_samples);
+  g_array_sort (scale->relayout_samples, perf_compare_samples);
+
+  bytes_per_actor = (gdouble) (scale->resident_after - scale->resident_before)
+                  / scale->n_created;
+
+  /* the memory Clutter accounts to the actors alive, i.e. the scene,
+   * the stage and the root
+   */
+  actor_bytes = clutter_get_memory_usage (CLUTTER_MEMORY_ACTORS, &n_actors);
+  accounted_bytes_per_actor = n_actors > 0 ? (gdouble) actor_bytes / n_actors : 0;
+
+  g_print ("@ %s %d actors: "
+           "frame %" G_GINT64_FORMAT "/%" G_GINT64_FORMAT " us, "
+           "pick %" G_GINT64_FORMAT "/%" G_GINT64_FORMAT " us, "
+           "relayout %" G_GINT64_FORMAT "/%" G_GINT64_FORMAT " us, "
+           "%.0f bytes/actor (%.0f accounted)\n",
+           scale->name,
+           scale->n_created,
+           perf_percentile (scale->frame_samples, 50),
+           perf_percentile (scale->frame_samples, 95),
+           perf_percentile (scale->pick_samples, 50),
+           perf_percentile (scale->pick_samples, 95),
+           perf_percentile (scale->relayout_samples, 50),
+           perf_percentile (scale->relayout_samples, 95),
+           bytes_per_actor,
+           accounted_bytes_per_actor);
+
+  if (output_file != NULL)
+    {
+      FILE *file = fopen (output_file, "a");
+
+      if (file == NULL)
+        {
+          g_warning ("Unable to open '%s' for writing", output_file);
+          return;
+        }
+
+      fprintf (file,
+               "%s,%d,"
+               "%" G_GINT64_FORMAT ",%" G_GINT64_FORMAT ","
+               "%" G_GINT64_FORMAT ",%" G_GINT64_FORMAT ","
+               "%" G_GINT64_FORMAT ",%" G_GINT64_FORMAT ","
+               "%.0f,%.0f\n",
+               scale->name,
+               scale->n_created,
+               perf_percentile (scale->frame_samples, 50),
+               perf_percentile (scale->frame_samples, 95),
+               perf_percentile (scale->pick_samples, 50),
+               perf_percentile (scale->pick_samples, 95),
+               perf_percentile (scale->relayout_samples, 50),
+               perf_percentile (scale->relayout_samples, 95),
+               bytes_per_actor,
+               accounted_bytes_per_actor);
+      fclose (file);
+    }
+}
+
+/* 100, 300, 1000, 3000, ... */
+static gint
+next_size (gint n_actors)
+{
+  gint decade = 1;
+
+  while (decade * 10 <= n_actors)
+    decade *= 10;
+
+  if (n_actors < decade * 3)
+    return decade * 3;
+
+  return decade * 10;
+}
+
+static gboolean
+scene_scale_step (gpointer data)
+{
+  SceneScale *scale = data;
+
+  if (scale->scene != NULL)
+    {
+      clutter_actor_destroy (scale->scene);
+      scale->scene = NULL;
+
+      scene_scale_report (scale);
+
+      scale->n_actors = next_size (scale->n_actors);
+    }
+
+  if (scale->n_actors > max_actors)
+    {
+      clutter_main_quit ();
+      return G_SOURCE_REMOVE;
+    }
+
+  g_array_set_size (scale->frame_samples, 0);
+  g_array_set_size (scale->pick_samples, 0);
+  g_array_set_size (scale->relayout_samples, 0);
+
+  scale->frame = 0;
+  scale->resident_before = get_resident_bytes ();
+
+  scale->scene = scale->func (scale->n_actors, &scale->n_created);
+  clutter_actor_add_child (scale->stage, scale->scene);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+scroll_views (ClutterActor *scene,
+              gint          frame)
+{
+  ClutterActorIter iter;
+  ClutterActor *child;
+  ClutterPoint point;
+
+  clutter_point_init (&point, 0, (frame * 4) % 500);
+
+  clutter_actor_iter_init (&iter, scene);
+  while (clutter_actor_iter_next (&iter, &child))
+    clutter_scroll_actor_scroll_to_point (CLUTTER_SCROLL_ACTOR (child), &point);
+}
+
+static void
+frame_stats_cb (ClutterStage            *stage,
+                const ClutterFrameStats *stats,
+                SceneScale              *scale)
+{
+  gint64 frame, pick_start, pick;
+
+  if (scale->scene == NULL || scale->frame >= WARMUP_FRAMES + n_frames)
+    return;
+
+  scale->frame += 1;
+
+  /* the first frames allocate the resources of the scene */
+  if (scale->frame == WARMUP_FRAMES)
+    scale->resident_after = get_resident_bytes ();
+
+  if (scale->frame > WARMUP_FRAMES)
+    {
+      frame = stats->events_time
+            + stats->timelines_time
+            + stats->relayout_time
+            + stats->paint_time
+            + stats->swap_wait_time;
+
+      g_array_append_val (scale->frame_samples, frame);
+      g_array_append_val (scale->relayout_samples, stats->relayout_time);
+
+      /* the frame invalidated the pick buffer, so this is a full pick */
+      pick_start = g_get_monotonic_time ();
+      clutter_stage_get_actor_at_pos (stage, CLUTTER_PICK_REACTIVE,
+                                      g_random_int_range (0, STAGE_WIDTH),
+                                      g_random_int_range (0, STAGE_HEIGHT));
+      pick = g_get_monotonic_time () - pick_start;
+      g_array_append_val (scale->pick_samples, pick);
+    }
+
+  if (scale->frame >= WARMUP_FRAMES + n_frames)
+    {
+      clutter_threads_add_idle (scene_scale_step, scale);
+      return;
+    }
+
+  /* resizing the root of the scene reflows it on the next frame */
+  clutter_actor_set_width (scale->scene,
+                           scale->frame % 2 ? STAGE_WIDTH - 1 : STAGE_WIDTH);
+
+  if (scale->func == scene_scroll)
+    scroll_views (scale->scene, scale->frame);
+}
+
+int
+main (int argc, char **argv)
+{
+  SceneScale scale = { NULL, };
+  guint i;
+
+  clutter_perf_fps_init ();
+
+  if (CLUTTER_INIT_SUCCESS !=
+        clutter_init_with_args (&argc, &argv,
+                                NULL,
+                                entries,
+                                NULL,
+                                NULL))
+    {
+      g_warning ("Failed to initialize clutter");
+      return -1;
+    }
+
+  if (scene_name == NULL)
+    scene_name = g_strdup ("wide");
+
+  for (i = 0; i < G_N_ELEMENTS (scenes); i++)
+    {
+      if (strcmp (scenes[i].name, scene_name) == 0)
+        {
+          scale.name = scenes[i].name;
+          scale.func = scenes[i].func;
+          break;
+        }
+    }
+
+  if (scale.func == NULL)
+    {
+      g_warning ("Unknown scene '%s'", scene_name);
+      return -1;
+    }
+
+  depth = MAX (depth, 1);
+  n_frames = MAX (n_frames, 1);
+  scale.n_actors = MAX (min_actors, 1);
+
+  scale.frame_samples = g_array_new (FALSE, FALSE, sizeof (gint64));
+  scale.pick_samples = g_array_new (FALSE, FALSE, sizeof (gint64));
+  scale.relayout_samples = g_array_new (FALSE, FALSE, sizeof (gint64));
+
+  scale.stage = clutter_stage_new ();
+  clutter_actor_set_size (scale.stage, STAGE_WIDTH, STAGE_HEIGHT);
+  clutter_actor_set_background_color (scale.stage, CLUTTER_COLOR_Black);
+  clutter_stage_set_title (CLUTTER_STAGE (scale.stage), "Scene Scale");
+  g_signal_connect (scale.stage, "destroy", G_CALLBACK (clutter_main_quit), NULL);
+  g_signal_connect (scale.stage, "frame-stats", G_CALLBACK (frame_stats_cb), &scale);
+
+  printf ("Scene scale test of the '%s' scene from %d to %d actors\n",
+          scale.name, scale.n_actors, max_actors);
+
+  clutter_actor_show (scale.stage);
+
+  clutter_threads_add_idle (scene_scale_step, &scale);
+  clutter_main ();
+
+  g_array_unref (scale.frame_samples);
+  g_array_unref (scale.pick_samples);
+  g_array_unref (scale.relayout_samples);
+
+  return 0;
+}
@@ -0,0 +1,442 @@
+#include <clutter/clutter.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include "test-common.h"
+
+/* A set of micro-benchmarks for ClutterText, measuring each of the
+ * expensive operations in isolation, over a configurable set of text
+ * sizes and scripts.
+ *
+ * Every result is printed as a "@ name: value" line, which is what
+ * create-report.rb extracts from the reports; --json=FILE writes the
+ * same results to FILE for other tools.
+ */
+
+#define STAGE_WIDTH  800
+#define STAGE_HEIGHT 600
+
+/* number of distinct strings cycled through by the benchmarks which
+ * replace the contents; it is larger than the caches of laid out text,
+ * so that every iteration measures an actual layout
+ */
+#define N_STRINGS       128
+
+static gchar *opt_sizes = NULL;
+static gchar *opt_scripts = NULL;
+static gchar *opt_json = NULL;
+static gdouble opt_duration = 0.0;
+
+static GOptionEntry entries[] = {
+  { "sizes", 0, 0, G_OPTION_ARG_STRING, &opt_sizes,
+    "Comma separated list of text lengths, in characters", "SIZES" },
+  { "scripts", 0, 0, G_OPTION_ARG_STRING, &opt_scripts,
+    "Comma separated list of scripts (latin, cyrillic, greek, arabic, cjk, mixed)", "SCRIPTS" },
+  { "duration", 0, 0, G_OPTION_ARG_DOUBLE, &opt_duration,
+    "Duration of each benchmark, in seconds", "SECONDS" },
+  { "json", 0, 0, G_OPTION_ARG_FILENAME, &opt_json,
+    "Write the results to FILE as JSON", "FILE" },
+  { NULL }
+};
+
+typedef struct {
+  gunichar first_letter;
+  gint n_letters;
+} CharRange;
+
+typedef struct {
+  const gchar *name;
+  const CharRange *ranges;
+  gint n_ranges;
+} Script;
+
+static const CharRange latin_ranges[] = { { 'a', 26 }, { 'A', 26 } };
+static const CharRange cyrillic_ranges[] = { { 0x430, 32 }, { 0x410, 32 } };
+static const CharRange greek_ranges[] = { { 0x3b1, 25 }, { 0x391, 17 } };
+static const CharRange arabic_ranges[] = { { 0x627, 20 }, { 0x641, 10 } };
+static const CharRange cjk_ranges[] = { { 0x4e00, 0x400 } };
+static const CharRange mixed_ranges[] = {
+  { 'a', 26 },
+  { 0x430, 32 },
+  { 0x3b1, 25 },
+  { 0x627, 20 },
+  { 0x4e00, 0x40 }
+};
+
+static const Script scripts[] = {
+  { "latin", latin_ranges, G_N_ELEMENTS (latin_ranges) },
+  { "cyrillic", cyrillic_ranges, G_N_ELEMENTS (cyrillic_ranges) },
+  { "greek", greek_ranges, G_N_ELEMENTS (greek_ranges) },
+  { "arabic", arabic_ranges, G_N_ELEMENTS (arabic_ranges) },
+  { "cjk", cjk_ranges, G_N_ELEMENTS (cjk_ranges) },
+  { "mixed", mixed_ranges, G_N_ELEMENTS (mixed_ranges) },
+};
+
+typedef struct {
+  const Script *script;
+  gint n_chars;
+
+  ClutterActor *stage;
+  ClutterActor *text;
+
+  gchar *strings[N_STRINGS];
+  gchar *markup[N_STRINGS];
+
+  guint n_paints;
+} BenchData;
+
+typedef void (* BenchFunc) (BenchData *data,
+                            guint      iteration);
+
+static GString *json = NULL;
+
+static gunichar
+get_character (const Script *script,
+               gint          ch)
+{
+  gint total_letters = 0;
+  gint i;
+
+  for (i = 0; i < script->n_ranges; i++)
+    total_letters += script->ranges[i].n_letters;
+
+  ch %= total_letters;
+
+  for (i = 0; i < script->n_ranges - 1; i++)
+    if (ch < script->ranges[i].n_letters)
+      return ch + script->ranges[i].first_letter;
+    else
+      ch -= script->ranges[i].n_letters;
+
+  return ch + script->ranges[i].first_letter;
+}
+
+/* builds a string of n_chars characters of the given script, with words
+ * of random length, so that wrapping and ellipsization have something
+ * to work with
+ */
+static gchar *
+create_string (const Script *script,
+               gint          n_chars,
+               gboolean      markup)
+{
+  GString *str = g_string_new (NULL);
+  gint word_len = 0, i;
+
+  for (i = 0; i < n_chars; i++)
+    {
+      if (word_len > 0 && g_random_int_range (0, 8) == 0)
+        {
+          g_string_append_c (str, ' ');
+          word_len = 0;
+          continue;
+        }
+
+      if (markup && word_len == 0 && g_random_int_range (0, 4) == 0)
+        {
+          g_string_append (str, "<b>");
+          g_string_append_unichar (str, get_character (script, g_random_int ()));
+          g_string_append (str, "</b>");
+        }
+      else
+        g_string_append_unichar (str, get_character (script, g_random_int ()));
+
+      word_len += 1;
+    }
+
+  return g_string_free (str, FALSE);
+}
+
+static void
+ensure_layout (BenchData *data)
+{
+  PangoLayout *layout;
+  PangoRectangle logical;
+
+  layout = clutter_text_get_layout (CLUTTER_TEXT (data->text));
+  pango_layout_get_extents (layout, NULL, &logical);
+}
+
+static void
+bench_set_text (BenchData *data,
+                guint      iteration)
+{
+  clutter_text_set_text (CLUTTER_TEXT (data->text),
+                         data->strings[iteration % N_STRINGS]);
+  ensure_layout (data);
+}
+
+static void
+bench_insert_at_cursor (BenchData *data,
+                        guint      iteration)
+{
+  ClutterText *text = CLUTTER_TEXT (data->text);
+
+  /* alternate between inserting and deleting, to keep the length of
+   * the contents constant over the whole benchmark
+   */
+  if (iteration % 2 == 0)
+    clutter_text_insert_unichar (text, get_character (data->script, iteration));
+  else
+    clutter_text_delete_cursor (text);
+
+  ensure_layout (data);
+}
+
+static void
+bench_ellipsize_resize (BenchData *data,
+                        guint      iteration)
+{
+  ClutterActorBox box;
+
+  box.x1 = 0;
+  box.y1 = 0;
+  box.x2 = STAGE_WIDTH / 4 + (iteration * 7) % (STAGE_WIDTH / 2);
+  box.y2 = STAGE_HEIGHT;
+
+  clutter_actor_allocate (data->text, &box, CLUTTER_ALLOCATION_NONE);
+  ensure_layout (data);
+}
+
+static void
+bench_markup (BenchData *data,
+              guint      iteration)
+{
+  clutter_text_set_markup (CLUTTER_TEXT (data->text),
+                           data->markup[iteration % N_STRINGS]);
+  ensure_layout (data);
+}
+
+static void
+on_paint (ClutterActor *stage,
+          BenchData    *data)
+{
+  data->n_paints += 1;
+}
+
+static void
+bench_paint_selection (BenchData *data,
+                       guint      iteration)
+{
+  ClutterText *text = CLUTTER_TEXT (data->text);
+  guint n_paints = data->n_paints;
+
+  /* moving the selection bound forces the selection to be painted
+   * again on every frame
+   */
+  clutter_text_set_selection (text, iteration % 2, -1);
+  clutter_actor_queue_redraw (data->stage);
+
+  while (data->n_paints == n_paints)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+report_result (const gchar *bench,
+               BenchData   *data,
+               gdouble      value,
+               const gchar *unit)
+{
+  g_print ("@ text-%s-%s-%d: %.2f %s\n",
+           bench,
+           data->script->name,
+           data->n_chars,
+           value,
+           unit);
+
+  if (json != NULL)
+    {
+      if (json->len > 1)
+        g_string_append (json, ",");
+
+      g_string_append_printf (json,
+                              "\n  { \"name\": \"%s\", \"script\": \"%s\", "
+                              "\"chars\": %d, \"value\": %.2f, \"unit\": \"%s\" }",
+                              bench,
+                              data->script->name,
+                              data->n_chars,
+                              value,
+                              unit);
+    }
+}
+
+static void
+run_bench (const gchar *name,
+           BenchFunc    func,
+           BenchData   *data)
+{
+  GTimer *timer;
+  gdouble elapsed;
+  guint iteration = 0;
+
+  /* warm up the font caches, so that the first run is not penalized */
+  func (data, iteration++);
+
+  timer = g_timer_new ();
+
+  do
+    {
+      func (data, iteration++);
+      elapsed = g_timer_elapsed (timer, NULL);
+    }
+  while (elapsed < opt_duration);
+
+  g_timer_destroy (timer);
+
+  report_result (name, data, (iteration - 1) / elapsed, "ops/s");
+}
+
+static ClutterActor *
+create_text (BenchData *data,
+             gboolean   editable)
+{
+  ClutterColor text_color = { 0xff, 0xff, 0xff, 0xff };
+  ClutterActor *text;
+
+  text = clutter_text_new ();
+  clutter_text_set_font_name (CLUTTER_TEXT (text), "Sans 16px");
+  clutter_text_set_color (CLUTTER_TEXT (text), &text_color);
+  clutter_text_set_line_wrap (CLUTTER_TEXT (text), TRUE);
+  clutter_text_set_editable (CLUTTER_TEXT (text), editable);
+  clutter_text_set_selectable (CLUTTER_TEXT (text), editable);
+  clutter_text_set_text (CLUTTER_TEXT (text), data->strings[0]);
+  clutter_actor_set_width (text, STAGE_WIDTH);
+  clutter_actor_add_child (data->stage, text);
+
+  return text;
+}
+
+static void
+run_benchmarks (BenchData *data)
+{
+  gint i;
+
+  for (i = 0; i < N_STRINGS; i++)
+    {
+      data->strings[i] = create_string (data->script, data->n_chars, FALSE);
+      data->markup[i] = create_string (data->script, data->n_chars, TRUE);
+    }
+
+  data->text = create_text (data, FALSE);
+  run_bench ("set-text", bench_set_text, data);
+  run_bench ("markup", bench_markup, data);
+  clutter_actor_destroy (data->text);
+
+  data->text = create_text (data, FALSE);
+  clutter_text_set_line_wrap (CLUTTER_TEXT (data->text), FALSE);
+  clutter_text_set_ellipsize (CLUTTER_TEXT (data->text), PANGO_ELLIPSIZE_END);
+  run_bench ("ellipsize-resize", bench_ellipsize_resize, data);
+  clutter_actor_destroy (data->text);
+
+  data->text = create_text (data, TRUE);
+  clutter_text_set_cursor_position (CLUTTER_TEXT (data->text), data->n_chars / 2);
+  run_bench ("insert-at-cursor", bench_insert_at_cursor, data);
+
+  clutter_stage_set_key_focus (CLUTTER_STAGE (data->stage), data->text);
+  run_bench ("paint-selection", bench_paint_selection, data);
+  clutter_actor_destroy (data->text);
+
+  for (i = 0; i < N_STRINGS; i++)
+    {
+      g_free (data->strings[i]);
+      g_free (data->markup[i]);
+    }
+}
+
+static const Script *
+find_script (const gchar *name)
+{
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (scripts); i++)
+    if (strcmp (scripts[i].name, name) == 0)
+      return &scripts[i];
+
+  return NULL;
+}
+
+int
+main (int argc, char *argv[])
+{
+  ClutterColor stage_color = { 0x00, 0x00, 0x00, 0xff };
+  gchar **sizes, **script_names;
+  BenchData data;
+  GError *error = NULL;
+  gint i, j;
+
+  clutter_perf_fps_init ();
+
+  if (clutter_init_with_args (&argc, &argv,
+                              NULL,
+                              entries,
+                              NULL,
+                              &error) != CLUTTER_INIT_SUCCESS)
+    {
+      g_printerr ("Failed to initialize Clutter: %s\n",
+                  error != NULL ? error->message : "unknown error");
+      return EXIT_FAILURE;
+    }
+
+  /* the performance tests are run with a long duration by default,
+   * which is meant for a whole run rather than for every single case
+   */
+  if (opt_duration <= 0.0)
+    opt_duration = g_getenv ("CLUTTER_PERFORMANCE_TEST_DURATION") != NULL
+                 ? testmaxtime
+                 : 1.0;
+
+  sizes = g_strsplit (opt_sizes != NULL ? opt_sizes : "10,100,1000", ",", -1);
+  script_names = g_strsplit (opt_scripts != NULL ? opt_scripts : "latin,cjk,mixed", ",", -1);
+
+  if (opt_json != NULL)
+    json = g_string_new ("[");
+
+  memset (&data, 0, sizeof (data));
+
+  data.stage = clutter_stage_new ();
+  clutter_actor_set_size (data.stage, STAGE_WIDTH, STAGE_HEIGHT);
+  clutter_stage_set_color (CLUTTER_STAGE (data.stage), &stage_color);
+  clutter_stage_set_title (CLUTTER_STAGE (data.stage), "Text Benchmarks");
+  g_signal_connect_after (data.stage, "paint", G_CALLBACK (on_paint), &data);
+  clutter_actor_show (data.stage);
+
+  for (i = 0; script_names[i] != NULL; i++)
+    {
+      data.script = find_script (script_names[i]);
+      if (data.script == NULL)
+        {
+          g_printerr ("Unknown script '%s'\n", script_names[i]);
+          continue;
+        }
+
+      for (j = 0; sizes[j] != NULL; j++)
+        {
+          data.n_chars = atoi (sizes[j]);
+          if (data.n_chars <= 0)
+            continue;
+
+          g_random_set_seed (12345678);
+          run_benchmarks (&data);
+        }
+    }
+
+  clutter_actor_destroy (data.stage);
+
+  if (json != NULL)
+    {
+      g_string_append (json, "\n]\n");
+
+      if (!g_file_set_contents (opt_json, json->str, json->len, &error))
+        {
+          g_printerr ("Unable to write '%s': %s\n", opt_json, error->message);
+          g_error_free (error);
+        }
+
+      g_string_free (json, TRUE);
+    }
+
+  g_strfreev (sizes);
+  g_strfreev (script_names);
+
+  return EXIT_SUCCESS;
+}
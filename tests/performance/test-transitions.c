@@ -0,0 +1,97 @@
+#include <math.h>
+#include <stdlib.h>
+#include <clutter/clutter.h>
+#include "test-common.h"
+
+#define N_ACTORS 400
+
+static gint n_actors = N_ACTORS;
+
+static GOptionEntry entries[] = {
+  {
+    "num-actors", 'a',
+    0,
+    G_OPTION_ARG_INT, &n_actors,
+    "Number of actors", "ACTORS"
+  },
+  { NULL }
+};
+
+static void
+add_rotation (ClutterActor *actor,
+              gint          index_)
+{
+  ClutterTransition *transition;
+
+  transition = clutter_property_transition_new ("rotation-angle-z");
+  clutter_transition_set_from (transition, G_TYPE_DOUBLE, 0.0);
+  clutter_transition_set_to (transition, G_TYPE_DOUBLE, 360.0);
+  clutter_timeline_set_duration (CLUTTER_TIMELINE (transition),
+                                 1000 + (index_ % 7) * 250);
+  clutter_timeline_set_repeat_count (CLUTTER_TIMELINE (transition), -1);
+  clutter_timeline_set_progress_mode (CLUTTER_TIMELINE (transition),
+                                      CLUTTER_EASE_IN_OUT_SINE);
+
+  clutter_actor_add_transition (actor, "rotate", transition);
+  g_object_unref (transition);
+}
+
+int
+main (int argc, char **argv)
+{
+  ClutterActor *stage, *actor;
+  gint i, n_columns;
+  gfloat size;
+
+  clutter_perf_fps_init ();
+
+  if (CLUTTER_INIT_SUCCESS !=
+        clutter_init_with_args (&argc, &argv,
+                                NULL,
+                                entries,
+                                NULL,
+                                NULL))
+    {
+      g_warning ("Failed to initialize clutter");
+      return -1;
+    }
+
+  stage = clutter_stage_new ();
+  clutter_actor_set_size (stage, 512, 512);
+  clutter_actor_set_background_color (stage, CLUTTER_COLOR_Black);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Transitions Performance");
+  g_signal_connect (stage, "destroy", G_CALLBACK (clutter_main_quit), NULL);
+
+  printf ("Transitions performance test with %d actors\n", n_actors);
+
+  n_columns = MAX (1, (gint) ceil (sqrt (n_actors)));
+  size = 512.0f / n_columns;
+
+  for (i = 0; i < n_actors; i++)
+    {
+      ClutterColor color;
+
+      clutter_color_from_hls (&color, (360.0f * i) / n_actors, 0.5f, 0.8f);
+
+      actor = clutter_actor_new ();
+      clutter_actor_set_background_color (actor, &color);
+      clutter_actor_set_size (actor, size * 0.8f, size * 0.8f);
+      clutter_actor_set_position (actor,
+                                  (i % n_columns) * size + size * 0.1f,
+                                  (i / n_columns) * size + size * 0.1f);
+      clutter_actor_set_pivot_point (actor, 0.5f, 0.5f);
+      clutter_actor_set_reactive (actor, TRUE);
+      clutter_actor_add_child (stage, actor);
+
+      add_rotation (actor, i);
+    }
+
+  clutter_actor_show (stage);
+
+  clutter_perf_fps_start (CLUTTER_STAGE (stage));
+  clutter_perf_fake_mouse (CLUTTER_STAGE (stage));
+  clutter_main ();
+  clutter_perf_fps_report ("test-transitions");
+
+  return 0;
+}